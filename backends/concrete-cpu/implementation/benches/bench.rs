@@ -1,8 +1,18 @@
+use concrete_cpu::c_api::bootstrap::{
+    concrete_cpu_bootstrap_lwe_ciphertext_u64, concrete_cpu_bootstrap_lwe_ciphertext_u64_scratch,
+    concrete_cpu_fourier_bootstrap_key_size_u64,
+};
+use concrete_cpu::c_api::fft::{
+    concrete_cpu_construct_concrete_fft, concrete_cpu_destroy_concrete_fft, simd_path, Fft,
+    CONCRETE_FFT_ALIGN, CONCRETE_FFT_SIZE,
+};
 use concrete_cpu::c_api::linear_op::{
     concrete_cpu_add_lwe_ciphertext_u64, concrete_cpu_add_plaintext_lwe_ciphertext_u64,
     concrete_cpu_mul_cleartext_lwe_ciphertext_u64, concrete_cpu_negate_lwe_ciphertext_u64,
 };
+use concrete_fft::c64;
 use criterion::{criterion_group, criterion_main, Criterion};
+use std::alloc::{alloc, dealloc, Layout};
 
 pub fn criterion_benchmark(c: &mut Criterion) {
     for lwe_dimension in [128, 256, 512] {
@@ -63,5 +73,71 @@ pub fn criterion_benchmark(c: &mut Criterion) {
     }
 }
 
-criterion_group!(benches, criterion_benchmark);
+// The external product dominates the bootstrap, so the benchmark is labelled with the SIMD path
+// selected at runtime to compare the results across ISAs.
+pub fn bootstrap_benchmark(c: &mut Criterion) {
+    let simd = format!("{:?}", simd_path());
+    let (input_lwe_dimension, glwe_dimension, level, base_log) = (512, 1, 2, 15);
+    for polynomial_size in [1024, 2048] {
+        let output_lwe_size = glwe_dimension * polynomial_size + 1;
+        c.bench_function(
+            &format!("bootstrap-lwe-ciphertext-u64-{polynomial_size}-{simd}"),
+            |b| unsafe {
+                let fft_layout =
+                    Layout::from_size_align(CONCRETE_FFT_SIZE, CONCRETE_FFT_ALIGN).unwrap();
+                let fft = alloc(fft_layout) as *mut Fft;
+                concrete_cpu_construct_concrete_fft(fft, polynomial_size);
+
+                let bsk = vec![
+                    c64::default();
+                    concrete_cpu_fourier_bootstrap_key_size_u64(
+                        level,
+                        glwe_dimension,
+                        polynomial_size,
+                        input_lwe_dimension,
+                    )
+                ];
+                let accumulator = vec![0_u64; (glwe_dimension + 1) * polynomial_size];
+                // A non-zero mask makes sure every cmux is actually computed.
+                let ct_in = vec![1_u64 << 50; input_lwe_dimension + 1];
+                let mut ct_out = vec![0_u64; output_lwe_size];
+
+                let mut stack_size = 0;
+                let mut stack_align = 0;
+                let _ = concrete_cpu_bootstrap_lwe_ciphertext_u64_scratch(
+                    &mut stack_size,
+                    &mut stack_align,
+                    glwe_dimension,
+                    polynomial_size,
+                    fft,
+                );
+                let stack_layout = Layout::from_size_align(stack_size, stack_align).unwrap();
+                let stack = alloc(stack_layout);
+
+                b.iter(|| {
+                    concrete_cpu_bootstrap_lwe_ciphertext_u64(
+                        ct_out.as_mut_ptr(),
+                        ct_in.as_ptr(),
+                        accumulator.as_ptr(),
+                        bsk.as_ptr(),
+                        level,
+                        base_log,
+                        glwe_dimension,
+                        polynomial_size,
+                        input_lwe_dimension,
+                        fft,
+                        stack,
+                        stack_size,
+                    );
+                });
+
+                dealloc(stack, stack_layout);
+                concrete_cpu_destroy_concrete_fft(fft);
+                dealloc(fft as *mut u8, fft_layout);
+            },
+        );
+    }
+}
+
+criterion_group!(benches, criterion_benchmark, bootstrap_benchmark);
 criterion_main!(benches);
@@ -0,0 +1,160 @@
+//! Measures the keyswitch and the bootstrap on this machine for a grid of parameters, and writes
+//! the cost table used by the measured cost model of the concrete-optimizer, e.g.
+//!
+//! cargo run --release --example calibrate_cost_model > cost_table.txt
+//! concretecompiler --optimizer-cost-table=cost_table.txt ...
+use concrete_cpu::c_api::bootstrap::{
+    concrete_cpu_bootstrap_lwe_ciphertext_u64, concrete_cpu_bootstrap_lwe_ciphertext_u64_scratch,
+    concrete_cpu_fourier_bootstrap_key_size_u64,
+};
+use concrete_cpu::c_api::fft::{
+    concrete_cpu_construct_concrete_fft, concrete_cpu_destroy_concrete_fft, Fft,
+    CONCRETE_FFT_ALIGN, CONCRETE_FFT_SIZE,
+};
+use concrete_cpu::c_api::keyswitch::{
+    concrete_cpu_keyswitch_key_size_u64, concrete_cpu_keyswitch_lwe_ciphertext_u64,
+};
+use concrete_fft::c64;
+use std::alloc::{alloc, dealloc, Layout};
+use std::time::Instant;
+
+const REPETITIONS: usize = 11;
+
+/// Returns the median duration of `f` in nanoseconds, after a warm up run.
+fn median_ns(mut f: impl FnMut()) -> u128 {
+    f();
+    let mut durations: Vec<u128> = (0..REPETITIONS)
+        .map(|_| {
+            let start = Instant::now();
+            f();
+            start.elapsed().as_nanos()
+        })
+        .collect();
+    durations.sort_unstable();
+    durations[REPETITIONS / 2]
+}
+
+fn keyswitch_ns(
+    input_dimension: usize,
+    output_dimension: usize,
+    level: usize,
+    base_log: usize,
+) -> u128 {
+    let ksk = vec![
+        0_u64;
+        unsafe {
+            concrete_cpu_keyswitch_key_size_u64(level, input_dimension, output_dimension)
+        }
+    ];
+    // A non-zero mask makes sure every key ciphertext is actually used.
+    let ct_in = vec![1_u64 << 50; input_dimension + 1];
+    let mut ct_out = vec![0_u64; output_dimension + 1];
+    median_ns(|| unsafe {
+        concrete_cpu_keyswitch_lwe_ciphertext_u64(
+            ct_out.as_mut_ptr(),
+            ct_in.as_ptr(),
+            ksk.as_ptr(),
+            level,
+            base_log,
+            input_dimension,
+            output_dimension,
+        );
+    })
+}
+
+fn bootstrap_ns(
+    input_lwe_dimension: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    level: usize,
+    base_log: usize,
+) -> u128 {
+    unsafe {
+        let fft_layout = Layout::from_size_align(CONCRETE_FFT_SIZE, CONCRETE_FFT_ALIGN).unwrap();
+        let fft = alloc(fft_layout) as *mut Fft;
+        concrete_cpu_construct_concrete_fft(fft, polynomial_size);
+
+        let bsk = vec![
+            c64::default();
+            concrete_cpu_fourier_bootstrap_key_size_u64(
+                level,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+            )
+        ];
+        let accumulator = vec![0_u64; (glwe_dimension + 1) * polynomial_size];
+        // A non-zero mask makes sure every cmux is actually computed.
+        let ct_in = vec![1_u64 << 50; input_lwe_dimension + 1];
+        let mut ct_out = vec![0_u64; glwe_dimension * polynomial_size + 1];
+
+        let mut stack_size = 0;
+        let mut stack_align = 0;
+        let _ = concrete_cpu_bootstrap_lwe_ciphertext_u64_scratch(
+            &mut stack_size,
+            &mut stack_align,
+            glwe_dimension,
+            polynomial_size,
+            fft,
+        );
+        let stack_layout = Layout::from_size_align(stack_size, stack_align).unwrap();
+        let stack = alloc(stack_layout);
+
+        let ns = median_ns(|| {
+            concrete_cpu_bootstrap_lwe_ciphertext_u64(
+                ct_out.as_mut_ptr(),
+                ct_in.as_ptr(),
+                accumulator.as_ptr(),
+                bsk.as_ptr(),
+                level,
+                base_log,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+                fft,
+                stack,
+                stack_size,
+            );
+        });
+
+        dealloc(stack, stack_layout);
+        concrete_cpu_destroy_concrete_fft(fft);
+        dealloc(fft as *mut u8, fft_layout);
+        ns
+    }
+}
+
+fn main() {
+    println!("# ks <input_lwe_dimension> <output_lwe_dimension> <level> <log2_base> <ns>");
+    for input_dimension in [1024, 2048, 4096] {
+        for output_dimension in [600, 800] {
+            for (level, base_log) in [(2, 7), (3, 4), (5, 3)] {
+                let ns = keyswitch_ns(input_dimension, output_dimension, level, base_log);
+                println!("ks {input_dimension} {output_dimension} {level} {base_log} {ns}");
+            }
+        }
+    }
+
+    println!(
+        "# pbs <internal_lwe_dimension> <glwe_dimension> <log2_polynomial_size> <level> \
+         <log2_base> <ns>"
+    );
+    let input_lwe_dimension = 700;
+    for glwe_dimension in [1, 2] {
+        for log2_polynomial_size in [9, 10, 11, 12] {
+            for (level, base_log) in [(1, 23), (2, 15), (3, 11)] {
+                let ns = bootstrap_ns(
+                    input_lwe_dimension,
+                    glwe_dimension,
+                    1 << log2_polynomial_size,
+                    level,
+                    base_log,
+                );
+                println!(
+                    "pbs {input_lwe_dimension} {glwe_dimension} {log2_polynomial_size} {level} \
+                     {base_log} {ns}"
+                );
+            }
+        }
+    }
+}
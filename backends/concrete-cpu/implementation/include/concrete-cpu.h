@@ -38,6 +38,32 @@ enum ScratchStatus
 typedef uint32_t ScratchStatus;
 #endif // __cplusplus
 
+enum SimdPath
+#ifdef __cplusplus
+  : uint32_t
+#endif // __cplusplus
+ {
+  SimdScalar = 0,
+  SimdAvx2 = 1,
+  SimdAvx512 = 2,
+  SimdNeon = 3,
+};
+#ifndef __cplusplus
+typedef uint32_t SimdPath;
+#endif // __cplusplus
+
+/**
+ * Selects how `concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64` computes a single
+ * bootstrap.
+ */
+typedef struct BootstrapParams {
+  /**
+   * Number of tasks of the rayon pool sharing each external product, 1 to run it on the
+   * calling thread only.
+   */
+  size_t thread_count;
+} BootstrapParams;
+
 typedef struct Csprng Csprng;
 
 typedef struct EncCsprng EncCsprng;
@@ -70,16 +96,133 @@ extern const size_t SECRET_CSPRNG_ALIGN;
 
 extern const size_t SECRET_CSPRNG_SIZE;
 
+/**
+ * Adds two ciphertexts of the 32 bits torus like `concrete_cpu_add_lwe_ciphertext_u64`.
+ */
+void concrete_cpu_add_lwe_ciphertext_u32(uint32_t *ct_out,
+                                         const uint32_t *ct_in0,
+                                         const uint32_t *ct_in1,
+                                         size_t lwe_dimension);
+
 void concrete_cpu_add_lwe_ciphertext_u64(uint64_t *ct_out,
                                          const uint64_t *ct_in0,
                                          const uint64_t *ct_in1,
                                          size_t lwe_dimension);
 
+void concrete_cpu_add_plaintext_lwe_ciphertext_u32(uint32_t *ct_out,
+                                                   const uint32_t *ct_in,
+                                                   uint32_t plaintext,
+                                                   size_t lwe_dimension);
+
 void concrete_cpu_add_plaintext_lwe_ciphertext_u64(uint64_t *ct_out,
                                                    const uint64_t *ct_in,
                                                    uint64_t plaintext,
                                                    size_t lwe_dimension);
 
+/**
+ * Adds `ct_count` pairs of ciphertexts, the ciphertext `i` of a buffer starting `i * stride`
+ * elements after its pointer. The whole batch runs in a single dispatch, so that the loops are
+ * vectorized once for all the ciphertexts.
+ */
+void concrete_cpu_batched_add_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                 size_t out_stride,
+                                                 const uint64_t *ct_in0,
+                                                 size_t in0_stride,
+                                                 const uint64_t *ct_in1,
+                                                 size_t in1_stride,
+                                                 size_t ct_count,
+                                                 size_t lwe_dimension);
+
+/**
+ * Adds the plaintext `plaintexts[i * plaintext_stride]` to the ciphertext `i` of the batch, a
+ * zero `plaintext_stride` adding the same plaintext to all of them.
+ */
+void concrete_cpu_batched_add_plaintext_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                           size_t out_stride,
+                                                           const uint64_t *ct_in,
+                                                           size_t in_stride,
+                                                           const uint64_t *plaintexts,
+                                                           size_t plaintext_stride,
+                                                           size_t ct_count,
+                                                           size_t lwe_dimension);
+
+void concrete_cpu_batched_bootstrap_lwe_ciphertext_u64(uint64_t *ct_out_vec,
+                                                       const uint64_t *ct_in_vec,
+                                                       size_t ct_count,
+                                                       const uint64_t *accumulators,
+                                                       size_t accumulator_count,
+                                                       const c64 *fourier_bsk,
+                                                       size_t decomposition_level_count,
+                                                       size_t decomposition_base_log,
+                                                       size_t glwe_dimension,
+                                                       size_t polynomial_size,
+                                                       size_t input_lwe_dimension,
+                                                       const struct Fft *fft,
+                                                       uint8_t *stack,
+                                                       size_t stack_size);
+
+ScratchStatus concrete_cpu_batched_bootstrap_lwe_ciphertext_u64_scratch(size_t *stack_size,
+                                                                        size_t *stack_align,
+                                                                        size_t glwe_dimension,
+                                                                        size_t polynomial_size,
+                                                                        const struct Fft *fft);
+
+void concrete_cpu_batched_keyswitch_lwe_ciphertext_u64(uint64_t *ct_out_vec,
+                                                       const uint64_t *ct_in_vec,
+                                                       size_t ct_count,
+                                                       const uint64_t *keyswitch_key,
+                                                       size_t decomposition_level_count,
+                                                       size_t decomposition_base_log,
+                                                       size_t input_dimension,
+                                                       size_t output_dimension);
+
+/**
+ * Multiplies the ciphertext `i` of the batch by the cleartext `cleartexts[i *
+ * cleartext_stride]`, a zero `cleartext_stride` multiplying all of them by the same cleartext.
+ */
+void concrete_cpu_batched_mul_cleartext_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                           size_t out_stride,
+                                                           const uint64_t *ct_in,
+                                                           size_t in_stride,
+                                                           const uint64_t *cleartexts,
+                                                           size_t cleartext_stride,
+                                                           size_t ct_count,
+                                                           size_t lwe_dimension);
+
+/**
+ * Negates the `ct_count` ciphertexts of the batch.
+ */
+void concrete_cpu_batched_negate_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                    size_t out_stride,
+                                                    const uint64_t *ct_in,
+                                                    size_t in_stride,
+                                                    size_t ct_count,
+                                                    size_t lwe_dimension);
+
+void concrete_cpu_bootstrap_key_convert_u128_to_fourier128(const uint64_t *standard_bsk,
+                                                           double *fourier_bsk,
+                                                           size_t decomposition_level_count,
+                                                           size_t decomposition_base_log,
+                                                           size_t glwe_dimension,
+                                                           size_t polynomial_size,
+                                                           size_t input_lwe_dimension);
+
+/**
+ * Converts a bootstrap key of the 32 bits torus to the fourier domain, in a buffer of
+ * `concrete_cpu_fourier_bootstrap_key_size_u64` elements. The scratch is the one of
+ * `concrete_cpu_bootstrap_key_convert_u64_to_fourier`.
+ */
+void concrete_cpu_bootstrap_key_convert_u32_to_fourier(const uint32_t *standard_bsk,
+                                                       c64 *fourier_bsk,
+                                                       size_t decomposition_level_count,
+                                                       size_t decomposition_base_log,
+                                                       size_t glwe_dimension,
+                                                       size_t polynomial_size,
+                                                       size_t input_lwe_dimension,
+                                                       const struct Fft *fft,
+                                                       uint8_t *stack,
+                                                       size_t stack_size);
+
 void concrete_cpu_bootstrap_key_convert_u64_to_fourier(const uint64_t *standard_bsk,
                                                        c64 *fourier_bsk,
                                                        size_t decomposition_level_count,
@@ -95,11 +238,59 @@ ScratchStatus concrete_cpu_bootstrap_key_convert_u64_to_fourier_scratch(size_t *
                                                                         size_t *stack_align,
                                                                         const struct Fft *fft);
 
+/**
+ * The 128 bits bootstrap works on the 128 bits torus, its FFT splitting each coefficient in two
+ * f64 to keep the precision of the products. It lets the parameter sets of high precision
+ * bootstrap natively instead of being decomposed. All its integers are stored as pairs of words,
+ * the least significant one first, and its secret keys are the binary keys of the 64 bits
+ * functions.
+ *
+ * Returns the number of words of a 128 bits bootstrap key.
+ */
+size_t concrete_cpu_bootstrap_key_size_u128(size_t decomposition_level_count,
+                                            size_t glwe_dimension,
+                                            size_t polynomial_size,
+                                            size_t input_lwe_dimension);
+
 size_t concrete_cpu_bootstrap_key_size_u64(size_t decomposition_level_count,
                                            size_t glwe_dimension,
                                            size_t polynomial_size,
                                            size_t input_lwe_dimension);
 
+void concrete_cpu_bootstrap_lwe_ciphertext_u128(uint64_t *ct_out,
+                                                const uint64_t *ct_in,
+                                                const uint64_t *accumulator,
+                                                const double *fourier_bsk,
+                                                size_t decomposition_level_count,
+                                                size_t decomposition_base_log,
+                                                size_t glwe_dimension,
+                                                size_t polynomial_size,
+                                                size_t input_lwe_dimension);
+
+/**
+ * Bootstraps a ciphertext of the 32 bits torus like `concrete_cpu_bootstrap_lwe_ciphertext_u64`.
+ * The fourier key is the same size, but the decomposed GLWEs and the accumulator are half the
+ * size of the u64 ones.
+ */
+void concrete_cpu_bootstrap_lwe_ciphertext_u32(uint32_t *ct_out,
+                                               const uint32_t *ct_in,
+                                               const uint32_t *accumulator,
+                                               const c64 *fourier_bsk,
+                                               size_t decomposition_level_count,
+                                               size_t decomposition_base_log,
+                                               size_t glwe_dimension,
+                                               size_t polynomial_size,
+                                               size_t input_lwe_dimension,
+                                               const struct Fft *fft,
+                                               uint8_t *stack,
+                                               size_t stack_size);
+
+ScratchStatus concrete_cpu_bootstrap_lwe_ciphertext_u32_scratch(size_t *stack_size,
+                                                                size_t *stack_align,
+                                                                size_t glwe_dimension,
+                                                                size_t polynomial_size,
+                                                                const struct Fft *fft);
+
 void concrete_cpu_bootstrap_lwe_ciphertext_u64(uint64_t *ct_out,
                                                const uint64_t *ct_in,
                                                const uint64_t *accumulator,
@@ -119,6 +310,28 @@ ScratchStatus concrete_cpu_bootstrap_lwe_ciphertext_u64_scratch(size_t *stack_si
                                                                 size_t polynomial_size,
                                                                 const struct Fft *fft);
 
+/**
+ * Bootstraps a ciphertext like `concrete_cpu_bootstrap_lwe_ciphertext_u64`, with the intra
+ * bootstrap parallelism selected by `params`. The `(glwe_dimension + 1) * level_count`
+ * decomposed polynomials of each external product are shared between `params.thread_count`
+ * tasks of the rayon pool, each one computing their forward FFT and accumulating their
+ * products with the rows of the GGSW. The partial sums are then reduced and brought back by
+ * one task per GLWE polynomial. This lowers the latency of a single bootstrap when there are
+ * not enough bootstraps to occupy the cores. No scratch is needed, the buffers of the tasks
+ * being allocated once per call.
+ */
+void concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64(uint64_t *ct_out,
+                                                           const uint64_t *ct_in,
+                                                           const uint64_t *accumulator,
+                                                           const c64 *fourier_bsk,
+                                                           size_t decomposition_level_count,
+                                                           size_t decomposition_base_log,
+                                                           size_t glwe_dimension,
+                                                           size_t polynomial_size,
+                                                           size_t input_lwe_dimension,
+                                                           const struct Fft *fft,
+                                                           struct BootstrapParams params);
+
 void concrete_cpu_circuit_bootstrap_boolean_vertical_packing_lwe_ciphertext_u64(uint64_t *ct_out_vec,
                                                                                 const uint64_t *ct_in_vec,
                                                                                 const uint64_t *lut,
@@ -180,11 +393,29 @@ void concrete_cpu_decompress_seeded_lwe_bootstrap_key_u64(uint64_t *lwe_bsk,
                                                           struct Uint128 compression_seed,
                                                           Parallelism parallelism);
 
+/**
+ * Decompresses a list of `count` seeded ciphertexts, each one stored as its compression seed, in
+ * two little-endian words, followed by its body.
+ */
+void concrete_cpu_decompress_seeded_lwe_ciphertext_list_u64(uint64_t *lwe_out,
+                                                            const uint64_t *seeded_lwe_in,
+                                                            size_t lwe_dimension,
+                                                            size_t count,
+                                                            Parallelism parallelism);
+
 void concrete_cpu_decompress_seeded_lwe_ciphertext_u64(uint64_t *lwe_out,
                                                        const uint64_t *seeded_lwe_in,
                                                        size_t lwe_dimension,
                                                        struct Uint128 compression_seed);
 
+void concrete_cpu_decompress_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(uint64_t *lwe_pksk,
+                                                                                                        const uint64_t *seeded_lwe_pksk,
+                                                                                                        size_t input_lwe_dimension,
+                                                                                                        size_t output_polynomial_size,
+                                                                                                        size_t output_glwe_dimension,
+                                                                                                        size_t decomposition_level_count,
+                                                                                                        struct Uint128 compression_seed);
+
 void concrete_cpu_decompress_seeded_lwe_keyswitch_key_u64(uint64_t *lwe_ksk,
                                                           const uint64_t *seeded_lwe_ksk,
                                                           size_t input_lwe_dimension,
@@ -200,6 +431,26 @@ void concrete_cpu_decrypt_glwe_ciphertext_u64(const uint64_t *glwe_sk,
                                               size_t glwe_dimension,
                                               size_t polynomial_size);
 
+/**
+ * Decrypts a list of `count` ciphertexts.
+ */
+void concrete_cpu_decrypt_lwe_ciphertext_list_u64(const uint64_t *lwe_sk,
+                                                  const uint64_t *lwe_ct_in,
+                                                  size_t lwe_dimension,
+                                                  size_t count,
+                                                  uint64_t *plaintexts,
+                                                  Parallelism parallelism);
+
+void concrete_cpu_decrypt_lwe_ciphertext_u128(const uint64_t *lwe_sk,
+                                              const uint64_t *lwe_ct_in,
+                                              size_t lwe_dimension,
+                                              struct Uint128 *plaintext);
+
+void concrete_cpu_decrypt_lwe_ciphertext_u32(const uint64_t *lwe_sk,
+                                             const uint32_t *lwe_ct_in,
+                                             size_t lwe_dimension,
+                                             uint32_t *plaintext);
+
 void concrete_cpu_decrypt_lwe_ciphertext_u64(const uint64_t *lwe_sk,
                                              const uint64_t *lwe_ct_in,
                                              size_t lwe_dimension,
@@ -213,6 +464,19 @@ void concrete_cpu_destroy_encryption_csprng(struct EncCsprng *mem);
 
 void concrete_cpu_destroy_secret_csprng(struct SecCsprng *mem);
 
+/**
+ * Writes `sum(ct_in[i] * cleartexts[i * cleartext_stride])` over the `ct_count` ciphertexts of
+ * the batch to `ct_out`, fusing the multiplications and the additions of a dot product in a
+ * single pass, without any intermediate ciphertext.
+ */
+void concrete_cpu_dot_product_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                 const uint64_t *ct_in,
+                                                 size_t in_stride,
+                                                 const uint64_t *cleartexts,
+                                                 size_t cleartext_stride,
+                                                 size_t ct_count,
+                                                 size_t lwe_dimension);
+
 void concrete_cpu_encrypt_ggsw_ciphertext_u64(const uint64_t *glwe_sk,
                                               uint64_t *ggsw_out,
                                               uint64_t input,
@@ -223,6 +487,43 @@ void concrete_cpu_encrypt_ggsw_ciphertext_u64(const uint64_t *glwe_sk,
                                               double variance,
                                               struct EncCsprng *csprng);
 
+/**
+ * Encrypts `count` plaintexts in a list of ciphertexts.
+ *
+ * Each ciphertext gets its own stream forked from `csprng`, so that the ciphertexts only depend
+ * on the state of `csprng`, whatever the parallelism.
+ */
+void concrete_cpu_encrypt_lwe_ciphertext_list_u64(const uint64_t *lwe_sk,
+                                                  uint64_t *lwe_out,
+                                                  const uint64_t *input,
+                                                  size_t lwe_dimension,
+                                                  size_t count,
+                                                  double variance,
+                                                  struct EncCsprng *csprng,
+                                                  Parallelism parallelism);
+
+/**
+ * Encrypts a plaintext of the 128 bits torus, the ciphertext being stored as pairs of words as in
+ * `concrete_cpu_bootstrap_lwe_ciphertext_u128`.
+ */
+void concrete_cpu_encrypt_lwe_ciphertext_u128(const uint64_t *lwe_sk,
+                                              uint64_t *lwe_out,
+                                              struct Uint128 input,
+                                              size_t lwe_dimension,
+                                              double variance,
+                                              struct EncCsprng *csprng);
+
+/**
+ * Encrypts a plaintext of the 32 bits torus, the ciphertext having as many elements as with
+ * `concrete_cpu_encrypt_lwe_ciphertext_u64`.
+ */
+void concrete_cpu_encrypt_lwe_ciphertext_u32(const uint64_t *lwe_sk,
+                                             uint32_t *lwe_out,
+                                             uint32_t input,
+                                             size_t lwe_dimension,
+                                             double variance,
+                                             struct EncCsprng *csprng);
+
 void concrete_cpu_encrypt_lwe_ciphertext_u64(const uint64_t *lwe_sk,
                                              uint64_t *lwe_out,
                                              uint64_t input,
@@ -267,16 +568,86 @@ ScratchStatus concrete_cpu_extract_bit_lwe_ciphertext_u64_scratch(size_t *stack_
                                                                   size_t bsk_polynomial_size,
                                                                   const struct Fft *fft);
 
+void concrete_cpu_fast_keyswitch_key_convert_u64_to_fourier(const uint64_t *standard_fast_ksk,
+                                                            c64 *fourier_fast_ksk,
+                                                            size_t decomposition_level_count,
+                                                            size_t input_dimension,
+                                                            size_t output_glwe_dimension,
+                                                            size_t output_polynomial_size,
+                                                            const struct Fft *fft);
+
+/**
+ * Size of a fast keyswitch key, converting LWE ciphertexts of `input_dimension` to the sample
+ * extraction of GLWE ciphertexts of `output_glwe_dimension` polynomials of
+ * `output_polynomial_size` coefficients.
+ *
+ * The input key is split in chunks of `output_polynomial_size` coefficients, the last one padded
+ * with zeros, and the key has for each chunk and each level a GLWE encryption of the chunk seen
+ * as a polynomial.
+ */
+size_t concrete_cpu_fast_keyswitch_key_size_u64(size_t decomposition_level_count,
+                                                size_t input_dimension,
+                                                size_t output_glwe_dimension,
+                                                size_t output_polynomial_size);
+
+/**
+ * Keyswitches a ciphertext with a fast keyswitch key in the Fourier domain, writing an LWE
+ * ciphertext of dimension `output_glwe_dimension * output_polynomial_size`.
+ *
+ * Each chunk of the input mask is turned into a polynomial whose product with the chunk of the
+ * input key has their inner product as constant coefficient. The polynomials are keyswitched
+ * together as the masks of a GLWE ciphertext, with one forward FFT per level and chunk and one
+ * backward FFT per output polynomial, and the constant coefficient is sample extracted. This
+ * costs about `input_dimension * level_count * (log2(N) + output_glwe_dimension + 1)`
+ * operations instead of the `input_dimension * level_count * (output_dimension + 1)` of the
+ * classical keyswitch. No scratch is needed, the buffers being allocated once per call.
+ */
+void concrete_cpu_fast_keyswitch_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                    const uint64_t *ct_in,
+                                                    const c64 *fourier_fast_ksk,
+                                                    size_t decomposition_level_count,
+                                                    size_t decomposition_base_log,
+                                                    size_t input_dimension,
+                                                    size_t output_glwe_dimension,
+                                                    size_t output_polynomial_size,
+                                                    const struct Fft *fft);
+
 void concrete_cpu_fill_with_random_gaussian(uint64_t *buffer,
                                             size_t size,
                                             double variance,
                                             struct Csprng *csprng);
 
+/**
+ * Constructs in `mem` an encryption csprng seeded from the mask of `csprng`, so that the child
+ * can be used concurrently with its parent while staying reproducible from the parent seed.
+ */
+void concrete_cpu_fork_encryption_csprng(struct EncCsprng *csprng, struct EncCsprng *mem);
+
+/**
+ * Returns the number of f64 of a 128 bits bootstrap key in the fourier domain, in four
+ * consecutive parts: the high and low words of the real parts, then of the imaginary parts.
+ */
+size_t concrete_cpu_fourier128_bootstrap_key_size(size_t decomposition_level_count,
+                                                  size_t glwe_dimension,
+                                                  size_t polynomial_size,
+                                                  size_t input_lwe_dimension);
+
 size_t concrete_cpu_fourier_bootstrap_key_size_u64(size_t decomposition_level_count,
                                                    size_t glwe_dimension,
                                                    size_t polynomial_size,
                                                    size_t input_lwe_dimension);
 
+size_t concrete_cpu_fourier_fast_keyswitch_key_size_u64(size_t decomposition_level_count,
+                                                        size_t input_dimension,
+                                                        size_t output_glwe_dimension,
+                                                        size_t output_polynomial_size);
+
+size_t concrete_cpu_fourier_multi_bit_bootstrap_key_size_u64(size_t decomposition_level_count,
+                                                             size_t glwe_dimension,
+                                                             size_t polynomial_size,
+                                                             size_t input_lwe_dimension,
+                                                             size_t grouping_factor);
+
 size_t concrete_cpu_ggsw_ciphertext_size_u64(size_t glwe_dimension,
                                              size_t polynomial_size,
                                              size_t decomposition_level_count);
@@ -285,6 +656,35 @@ size_t concrete_cpu_glwe_ciphertext_size_u64(size_t glwe_dimension, size_t polyn
 
 size_t concrete_cpu_glwe_secret_key_size_u64(size_t lwe_dimension, size_t polynomial_size);
 
+void concrete_cpu_init_lwe_bootstrap_key_u128(uint64_t *lwe_bsk,
+                                              const uint64_t *input_lwe_sk,
+                                              const uint64_t *output_glwe_sk,
+                                              size_t input_lwe_dimension,
+                                              size_t output_polynomial_size,
+                                              size_t output_glwe_dimension,
+                                              size_t decomposition_level_count,
+                                              size_t decomposition_base_log,
+                                              double variance,
+                                              Parallelism parallelism,
+                                              struct EncCsprng *csprng);
+
+/**
+ * Generates a bootstrap key of the 32 bits torus, of `concrete_cpu_bootstrap_key_size_u64`
+ * elements. The 32 bits functions are meant for the circuits whose parameters are optimized for
+ * a 32 bits ciphertext modulus, their keys and ciphertexts being half the size of the u64 ones.
+ */
+void concrete_cpu_init_lwe_bootstrap_key_u32(uint32_t *lwe_bsk,
+                                             const uint64_t *input_lwe_sk,
+                                             const uint64_t *output_glwe_sk,
+                                             size_t input_lwe_dimension,
+                                             size_t output_polynomial_size,
+                                             size_t output_glwe_dimension,
+                                             size_t decomposition_level_count,
+                                             size_t decomposition_base_log,
+                                             double variance,
+                                             Parallelism parallelism,
+                                             struct EncCsprng *csprng);
+
 void concrete_cpu_init_lwe_bootstrap_key_u64(uint64_t *lwe_bsk,
                                              const uint64_t *input_lwe_sk,
                                              const uint64_t *output_glwe_sk,
@@ -309,6 +709,44 @@ void concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitc
                                                                                            Parallelism parallelism,
                                                                                            struct EncCsprng *csprng);
 
+void concrete_cpu_init_lwe_fast_keyswitch_key_u64(uint64_t *fast_ksk,
+                                                  const uint64_t *input_lwe_sk,
+                                                  const uint64_t *output_glwe_sk,
+                                                  size_t input_lwe_dimension,
+                                                  size_t output_glwe_dimension,
+                                                  size_t output_polynomial_size,
+                                                  size_t decomposition_level_count,
+                                                  size_t decomposition_base_log,
+                                                  double variance,
+                                                  struct EncCsprng *csprng);
+
+void concrete_cpu_init_lwe_multi_bit_bootstrap_key_u64(uint64_t *lwe_multi_bit_bsk,
+                                                       const uint64_t *input_lwe_sk,
+                                                       const uint64_t *output_glwe_sk,
+                                                       size_t input_lwe_dimension,
+                                                       size_t output_polynomial_size,
+                                                       size_t output_glwe_dimension,
+                                                       size_t decomposition_level_count,
+                                                       size_t decomposition_base_log,
+                                                       size_t grouping_factor,
+                                                       double variance,
+                                                       Parallelism parallelism,
+                                                       struct EncCsprng *csprng);
+
+/**
+ * Generates a keyswitch key of the 32 bits torus, of
+ * `concrete_cpu_keyswitch_key_size_u64` elements.
+ */
+void concrete_cpu_init_lwe_keyswitch_key_u32(uint32_t *lwe_ksk,
+                                             const uint64_t *input_lwe_sk,
+                                             const uint64_t *output_lwe_sk,
+                                             size_t input_lwe_dimension,
+                                             size_t output_lwe_dimension,
+                                             size_t decomposition_level_count,
+                                             size_t decomposition_base_log,
+                                             double variance,
+                                             struct EncCsprng *csprng);
+
 void concrete_cpu_init_lwe_keyswitch_key_u64(uint64_t *lwe_ksk,
                                              const uint64_t *input_lwe_sk,
                                              const uint64_t *output_lwe_sk,
@@ -333,6 +771,27 @@ void concrete_cpu_init_seeded_lwe_bootstrap_key_u64(uint64_t *seeded_lwe_bsk,
                                                     double variance,
                                                     Parallelism parallelism);
 
+/**
+ * Generates the packing keyswitch keys of a circuit bootstrap in their seeded form: the masks of
+ * their GLWE ciphertexts are drawn from `compression_seed`, and only the bodies are stored.
+ *
+ * The keys are generated as by
+ * `concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64`,
+ * before their masks are replaced, the bodies being updated to keep the phases.
+ */
+void concrete_cpu_init_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(uint64_t *seeded_lwe_pksk,
+                                                                                                  const uint64_t *input_lwe_sk,
+                                                                                                  const uint64_t *output_glwe_sk,
+                                                                                                  size_t input_lwe_dimension,
+                                                                                                  size_t output_polynomial_size,
+                                                                                                  size_t output_glwe_dimension,
+                                                                                                  size_t decomposition_level_count,
+                                                                                                  size_t decomposition_base_log,
+                                                                                                  struct Uint128 compression_seed,
+                                                                                                  double variance,
+                                                                                                  Parallelism parallelism,
+                                                                                                  struct EncCsprng *csprng);
+
 void concrete_cpu_init_seeded_lwe_keyswitch_key_u64(uint64_t *seeded_lwe_ksk,
                                                     const uint64_t *input_lwe_sk,
                                                     const uint64_t *output_lwe_sk,
@@ -347,6 +806,18 @@ size_t concrete_cpu_keyswitch_key_size_u64(size_t decomposition_level_count,
                                            size_t input_dimension,
                                            size_t output_dimension);
 
+/**
+ * Keyswitches a ciphertext of the 32 bits torus. Its elements are half the size of the ones of
+ * `concrete_cpu_keyswitch_lwe_ciphertext_u64`, which halves the memory traffic of the key.
+ */
+void concrete_cpu_keyswitch_lwe_ciphertext_u32(uint32_t *ct_out,
+                                               const uint32_t *ct_in,
+                                               const uint32_t *keyswitch_key,
+                                               size_t decomposition_level_count,
+                                               size_t decomposition_base_log,
+                                               size_t input_dimension,
+                                               size_t output_dimension);
+
 void concrete_cpu_keyswitch_lwe_ciphertext_u64(uint64_t *ct_out,
                                                const uint64_t *ct_in,
                                                const uint64_t *keyswitch_key,
@@ -364,11 +835,72 @@ size_t concrete_cpu_lwe_packing_keyswitch_key_size(size_t output_glwe_dimension,
 
 size_t concrete_cpu_lwe_secret_key_size_u64(size_t lwe_dimension);
 
+void concrete_cpu_many_lut_bootstrap_lwe_ciphertext_u64(uint64_t *ct_out_vec,
+                                                        const uint64_t *ct_in,
+                                                        const uint64_t *accumulator,
+                                                        size_t lut_count,
+                                                        const c64 *fourier_bsk,
+                                                        size_t decomposition_level_count,
+                                                        size_t decomposition_base_log,
+                                                        size_t glwe_dimension,
+                                                        size_t polynomial_size,
+                                                        size_t input_lwe_dimension,
+                                                        const struct Fft *fft,
+                                                        uint8_t *stack,
+                                                        size_t stack_size);
+
+void concrete_cpu_mul_cleartext_lwe_ciphertext_u32(uint32_t *ct_out,
+                                                   const uint32_t *ct_in,
+                                                   uint32_t cleartext,
+                                                   size_t lwe_dimension);
+
 void concrete_cpu_mul_cleartext_lwe_ciphertext_u64(uint64_t *ct_out,
                                                    const uint64_t *ct_in,
                                                    uint64_t cleartext,
                                                    size_t lwe_dimension);
 
+void concrete_cpu_multi_bit_bootstrap_key_convert_u64_to_fourier(const uint64_t *standard_bsk,
+                                                                 c64 *fourier_bsk,
+                                                                 size_t decomposition_level_count,
+                                                                 size_t decomposition_base_log,
+                                                                 size_t glwe_dimension,
+                                                                 size_t polynomial_size,
+                                                                 size_t input_lwe_dimension,
+                                                                 size_t grouping_factor,
+                                                                 Parallelism parallelism);
+
+/**
+ * The multi-bit bootstrap key holds 2^grouping_factor GGSW ciphertexts per
+ * group of grouping_factor input key bits.
+ */
+size_t concrete_cpu_multi_bit_bootstrap_key_size_u64(size_t decomposition_level_count,
+                                                     size_t glwe_dimension,
+                                                     size_t polynomial_size,
+                                                     size_t input_lwe_dimension,
+                                                     size_t grouping_factor);
+
+/**
+ * Bootstraps a ciphertext with a multi-bit key. The GGSW of each group of key bits is computed
+ * from its 2^grouping_factor GGSW by `thread_count` threads, the blind rotation consuming them as
+ * they come, so that a single bootstrap runs on several cores. No scratch is needed, each thread
+ * allocating its own buffers.
+ */
+void concrete_cpu_multi_bit_bootstrap_lwe_ciphertext_u64(uint64_t *ct_out,
+                                                         const uint64_t *ct_in,
+                                                         const uint64_t *accumulator,
+                                                         const c64 *fourier_bsk,
+                                                         size_t decomposition_level_count,
+                                                         size_t decomposition_base_log,
+                                                         size_t glwe_dimension,
+                                                         size_t polynomial_size,
+                                                         size_t input_lwe_dimension,
+                                                         size_t grouping_factor,
+                                                         size_t thread_count);
+
+void concrete_cpu_negate_lwe_ciphertext_u32(uint32_t *ct_out,
+                                            const uint32_t *ct_in,
+                                            size_t lwe_dimension);
+
 void concrete_cpu_negate_lwe_ciphertext_u64(uint64_t *ct_out,
                                             const uint64_t *ct_in,
                                             size_t lwe_dimension);
@@ -381,6 +913,17 @@ size_t concrete_cpu_seeded_bootstrap_key_size_u64(size_t decomposition_level_cou
 size_t concrete_cpu_seeded_keyswitch_key_size_u64(size_t decomposition_level_count,
                                                   size_t input_dimension);
 
+/**
+ * Returns the size of the seeded packing keyswitch keys of a circuit bootstrap, all of them,
+ * that is the bodies of their GLWE ciphertexts.
+ */
+size_t concrete_cpu_seeded_lwe_packing_keyswitch_keys_size_u64(size_t output_glwe_dimension,
+                                                               size_t polynomial_size,
+                                                               size_t decomposition_level_count,
+                                                               size_t input_lwe_dimension);
+
+SimdPath concrete_cpu_simd_path(void);
+
 void simulation_circuit_bootstrap_boolean_vertical_packing_lwe_ciphertext_u64(const uint64_t *lwe_list_in,
                                                                               uint64_t *lwe_list_out,
                                                                               size_t ct_in_count,
@@ -28,6 +28,29 @@ mod utils {
         val
     }
 
+    /// Reads the 128 bits integers stored as pairs of words, the least significant one first, as
+    /// they are in the buffers of the u128 functions. The C side has no portable 128 bits type.
+    pub fn read_u128(words: &[u64]) -> Vec<u128> {
+        words
+            .chunks_exact(2)
+            .map(|pair| pair[0] as u128 | (pair[1] as u128) << 64)
+            .collect()
+    }
+
+    /// Writes 128 bits integers as pairs of words, the least significant one first.
+    pub fn write_u128(words: &mut [u64], values: &[u128]) {
+        for (pair, &value) in words.chunks_exact_mut(2).zip(values) {
+            pair[0] = value as u64;
+            pair[1] = (value >> 64) as u64;
+        }
+    }
+
+    /// Converts a binary secret key to the 32 bits scalars of the u32 functions, the keys being
+    /// generated and stored as u64 whatever the torus.
+    pub fn secret_key_u32(key: &[u64]) -> Vec<u32> {
+        key.iter().map(|&s| s as u32).collect()
+    }
+
     const __ASSERT_USIZE_SAME_AS_SIZE_T: () = {
         let _: libc::size_t = 0_usize;
     };
@@ -42,5 +65,15 @@ mod utils {
             // so we just test the successful path
             assert_eq!(nounwind(|| 1), 1);
         }
+
+        #[test]
+        fn test_u128_words_roundtrip() {
+            let values = [0, 1, u64::MAX as u128 + 1, u128::MAX - 2];
+            let mut words = [0; 8];
+            write_u128(&mut words, &values);
+            assert_eq!(words[2..4], [1, 0]);
+            assert_eq!(words[4..6], [0, 1]);
+            assert_eq!(read_u128(&words), values);
+        }
     }
 }
@@ -1,18 +1,19 @@
-use concrete_csprng::generators::SoftwareRandomGenerator;
+use crate::implementation::generator::DynamicRandomGenerator;
 use concrete_fft::c64;
 use tfhe::core_crypto::commons::math::random::{CompressionSeed, Seed};
 use tfhe::core_crypto::prelude::*;
 
-use crate::c_api::types::{EncCsprng, Parallelism, ScratchStatus, Uint128};
+use crate::c_api::types::{BootstrapParams, EncCsprng, Parallelism, ScratchStatus, Uint128};
 use core::slice;
-use dyn_stack::PodStack;
+use dyn_stack::{GlobalPodBuffer, PodStack, StackReq};
+use tfhe::core_crypto::fft_impl::fft64::math::polynomial::FourierPolynomial;
 
 use super::csprng::new_dyn_seeder;
 use super::secret_key::{
     concrete_cpu_glwe_ciphertext_size_u64, concrete_cpu_glwe_secret_key_size_u64,
     concrete_cpu_lwe_secret_key_size_u64,
 };
-use super::utils::nounwind;
+use super::utils::{nounwind, read_u128, secret_key_u32, write_u128};
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_init_lwe_bootstrap_key_u64(
@@ -74,14 +75,90 @@ pub unsafe extern "C" fn concrete_cpu_init_lwe_bootstrap_key_u64(
                 &glwe_sk,
                 &mut bsk,
                 Variance::from_variance(variance),
-                &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+                &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
             ),
             Parallelism::Rayon => par_generate_lwe_bootstrap_key(
                 &lwe_sk,
                 &glwe_sk,
                 &mut bsk,
                 Variance::from_variance(variance),
-                &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+                &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
+            ),
+        }
+    });
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_init_lwe_multi_bit_bootstrap_key_u64(
+    // multi-bit bootstrap key
+    lwe_multi_bit_bsk: *mut u64,
+    // secret keys
+    input_lwe_sk: *const u64,
+    output_glwe_sk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_polynomial_size: usize,
+    output_glwe_dimension: usize,
+    // bootstrap key parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    grouping_factor: usize,
+    // noise parameters
+    variance: f64,
+    // parallelism
+    parallelism: Parallelism,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let mut bsk = LweMultiBitBootstrapKey::from_container(
+            slice::from_raw_parts_mut(
+                lwe_multi_bit_bsk,
+                concrete_cpu_multi_bit_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    output_glwe_dimension,
+                    output_polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                ),
+            ),
+            GlweDimension(output_glwe_dimension).to_glwe_size(),
+            PolynomialSize(output_polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            LweBskGroupingFactor(grouping_factor),
+            CiphertextModulus::new_native(),
+        );
+
+        let lwe_sk = LweSecretKey::from_container(slice::from_raw_parts(
+            input_lwe_sk,
+            concrete_cpu_lwe_secret_key_size_u64(input_lwe_dimension),
+        ));
+        let glwe_sk = GlweSecretKey::from_container(
+            slice::from_raw_parts(
+                output_glwe_sk,
+                concrete_cpu_glwe_secret_key_size_u64(
+                    output_glwe_dimension,
+                    output_polynomial_size,
+                ),
+            ),
+            PolynomialSize(output_polynomial_size),
+        );
+
+        match parallelism {
+            Parallelism::No => generate_lwe_multi_bit_bootstrap_key(
+                &lwe_sk,
+                &glwe_sk,
+                &mut bsk,
+                Variance::from_variance(variance),
+                &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
+            ),
+            Parallelism::Rayon => par_generate_lwe_multi_bit_bootstrap_key(
+                &lwe_sk,
+                &glwe_sk,
+                &mut bsk,
+                Variance::from_variance(variance),
+                &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
             ),
         }
     });
@@ -221,13 +298,13 @@ pub unsafe extern "C" fn concrete_cpu_decompress_seeded_lwe_bootstrap_key_u64(
         );
         match parallelism {
             Parallelism::No => {
-                decompress_seeded_lwe_bootstrap_key::<_, _, _, SoftwareRandomGenerator>(
+                decompress_seeded_lwe_bootstrap_key::<_, _, _, DynamicRandomGenerator>(
                     &mut output_bsk,
                     &input_bsk,
                 )
             }
             Parallelism::Rayon => {
-                par_decompress_seeded_lwe_bootstrap_key::<_, _, _, SoftwareRandomGenerator>(
+                par_decompress_seeded_lwe_bootstrap_key::<_, _, _, DynamicRandomGenerator>(
                     &mut output_bsk,
                     &input_bsk,
                 )
@@ -413,47 +490,1792 @@ pub unsafe extern "C" fn concrete_cpu_bootstrap_lwe_ciphertext_u64(
     })
 }
 
+/// Writes in `digits` the signed digits of level `level`, 1 being the most significant one, of the
+/// decomposition of the coefficients of `poly` rounded to `base_log * level_count` bits.
+pub(crate) fn decompose_level(
+    poly: &[u64],
+    digits: &mut [u64],
+    base_log: usize,
+    level_count: usize,
+    level: usize,
+) {
+    let non_rep_bit_count = 64 - base_log * level_count;
+    let rep_mask = (1_u64 << (base_log * level_count)) - 1;
+    let digit_mask = (1_u64 << base_log) - 1;
+    for (digit, &value) in digits.iter_mut().zip(poly) {
+        let rounding = (value >> (non_rep_bit_count - 1)) & 1;
+        let mut state = ((value >> non_rep_bit_count) + rounding) & rep_mask;
+        // The digits are balanced from the least significant one, the carries propagating up.
+        for current_level in (level..=level_count).rev() {
+            let res = state & digit_mask;
+            state >>= base_log;
+            let carry = ((res.wrapping_sub(1) | state) & res) >> (base_log - 1);
+            state += carry;
+            if current_level == level {
+                *digit = res.wrapping_sub(carry << base_log);
+            }
+        }
+    }
+}
+
+/// The buffers of a task of the parallel bootstrap, reused by all its external products.
+struct ExternalProductTask {
+    fourier_acc: Vec<c64>,
+    digits: Vec<u64>,
+    fourier_digits: Vec<c64>,
+    mem: GlobalPodBuffer,
+}
+
+/// Bootstraps a ciphertext like `concrete_cpu_bootstrap_lwe_ciphertext_u64`, with the intra
+/// bootstrap parallelism selected by `params`. The `(glwe_dimension + 1) * level_count`
+/// decomposed polynomials of each external product are shared between `params.thread_count`
+/// tasks of the rayon pool, each one computing their forward FFT and accumulating their
+/// products with the rows of the GGSW. The partial sums are then reduced and brought back by
+/// one task per GLWE polynomial. This lowers the latency of a single bootstrap when there are
+/// not enough bootstraps to occupy the cores. No scratch is needed, the buffers of the tasks
+/// being allocated once per call.
 #[no_mangle]
-pub unsafe extern "C" fn concrete_cpu_bootstrap_key_size_u64(
+pub unsafe extern "C" fn concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64(
+    // ciphertexts
+    ct_out: *mut u64,
+    ct_in: *const u64,
+    // accumulator
+    accumulator: *const u64,
+    // bootstrap key
+    fourier_bsk: *const c64,
+    // bootstrap parameters
     decomposition_level_count: usize,
+    decomposition_base_log: usize,
     glwe_dimension: usize,
     polynomial_size: usize,
     input_lwe_dimension: usize,
-) -> usize {
-    input_lwe_dimension
-        * ggsw_ciphertext_size(
-            GlweDimension(glwe_dimension).to_glwe_size(),
+    // side resources
+    fft: *const Fft,
+    params: BootstrapParams,
+) {
+    #[cfg(feature = "parallel")]
+    use rayon::prelude::*;
+
+    nounwind(|| {
+        assert!(decomposition_base_log * decomposition_level_count < 64);
+        let glwe_size = glwe_dimension + 1;
+        let fourier_size = polynomial_size / 2;
+        let glwe_len = concrete_cpu_glwe_ciphertext_size_u64(glwe_dimension, polynomial_size);
+        let fft = (*fft).as_view();
+
+        let fourier_bsk = slice::from_raw_parts(
+            fourier_bsk,
+            concrete_cpu_fourier_bootstrap_key_size_u64(
+                decomposition_level_count,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+            ),
+        );
+        let ggsw_len = fourier_bsk.len() / input_lwe_dimension;
+        let ct_in = slice::from_raw_parts(ct_in, input_lwe_dimension + 1);
+
+        let term_count = decomposition_level_count * glwe_size;
+        let task_count = params.thread_count.clamp(1, term_count);
+        let scratch = StackReq::try_any_of([
+            fft.forward_scratch().unwrap(),
+            fft.backward_scratch().unwrap(),
+        ])
+        .unwrap();
+        let mut tasks: Vec<_> = (0..task_count)
+            .map(|_| ExternalProductTask {
+                fourier_acc: vec![c64::default(); glwe_size * fourier_size],
+                digits: vec![0; polynomial_size],
+                fourier_digits: vec![c64::default(); fourier_size],
+                mem: GlobalPodBuffer::new(scratch),
+            })
+            .collect();
+        let mut sums = vec![c64::default(); glwe_size * fourier_size];
+        let mut sum_mems: Vec<_> = (0..glwe_size)
+            .map(|_| GlobalPodBuffer::new(scratch))
+            .collect();
+
+        // The accumulator is rotated by the body of the ciphertext.
+        let mut acc = slice::from_raw_parts(accumulator, glwe_len).to_vec();
+        let mut diff = vec![0_u64; glwe_len];
+        let body = pbs_modulus_switch(ct_in[input_lwe_dimension], polynomial_size);
+        for poly in acc.chunks_exact_mut(polynomial_size) {
+            polynomial_wrapping_monic_monomial_div_assign(
+                &mut Polynomial::from_container(poly),
+                MonomialDegree(body),
+            );
+        }
+
+        for (i, ggsw) in fourier_bsk.chunks_exact(ggsw_len).enumerate() {
+            let mask = pbs_modulus_switch(ct_in[i], polynomial_size);
+            if mask == 0 {
+                continue;
+            }
+
+            // The cmux adds to the accumulator the external product of the GGSW with
+            // X^mask * acc - acc.
+            diff.copy_from_slice(&acc);
+            for poly in diff.chunks_exact_mut(polynomial_size) {
+                polynomial_wrapping_monic_monomial_mul_assign(
+                    &mut Polynomial::from_container(poly),
+                    MonomialDegree(mask),
+                );
+            }
+            for (d, a) in diff.iter_mut().zip(&acc) {
+                *d = d.wrapping_sub(*a);
+            }
+
+            let diff = &diff;
+            let accumulate = |(t, task): (usize, &mut ExternalProductTask)| {
+                task.fourier_acc.fill(c64::default());
+                for term in (t..term_count).step_by(task_count) {
+                    let (level, column) = (term / glwe_size, term % glwe_size);
+                    decompose_level(
+                        &diff[column * polynomial_size..][..polynomial_size],
+                        &mut task.digits,
+                        decomposition_base_log,
+                        decomposition_level_count,
+                        level + 1,
+                    );
+                    fft.forward_as_integer(
+                        FourierPolynomial {
+                            data: &mut *task.fourier_digits,
+                        },
+                        Polynomial::from_container(&*task.digits),
+                        PodStack::new(&mut task.mem),
+                    );
+                    // The row of the GGSW multiplying this column at this level.
+                    let row = &ggsw[(level * glwe_size + column) * glwe_size * fourier_size..]
+                        [..glwe_size * fourier_size];
+                    for (out, row) in task
+                        .fourier_acc
+                        .chunks_exact_mut(fourier_size)
+                        .zip(row.chunks_exact(fourier_size))
+                    {
+                        for ((out, digit), key) in out.iter_mut().zip(&task.fourier_digits).zip(row)
+                        {
+                            *out += digit * key;
+                        }
+                    }
+                }
+            };
+
+            #[cfg(feature = "parallel")]
+            tasks.par_iter_mut().enumerate().for_each(accumulate);
+            #[cfg(not(feature = "parallel"))]
+            tasks.iter_mut().enumerate().for_each(accumulate);
+
+            let tasks_view = &tasks;
+            let reduce = |(c, (acc_poly, (sum, mem))): (
+                usize,
+                (&mut [u64], (&mut [c64], &mut GlobalPodBuffer)),
+            )| {
+                sum.copy_from_slice(&tasks_view[0].fourier_acc[c * fourier_size..][..fourier_size]);
+                for task in &tasks_view[1..] {
+                    for (s, p) in sum
+                        .iter_mut()
+                        .zip(&task.fourier_acc[c * fourier_size..][..fourier_size])
+                    {
+                        *s += p;
+                    }
+                }
+                fft.add_backward_as_torus(
+                    Polynomial::from_container(acc_poly),
+                    FourierPolynomial { data: &*sum },
+                    PodStack::new(mem),
+                );
+            };
+
+            #[cfg(feature = "parallel")]
+            {
+                acc.par_chunks_exact_mut(polynomial_size)
+                    .zip(
+                        sums.par_chunks_exact_mut(fourier_size)
+                            .zip(sum_mems.par_iter_mut()),
+                    )
+                    .enumerate()
+                    .for_each(reduce);
+            }
+            #[cfg(not(feature = "parallel"))]
+            {
+                acc.chunks_exact_mut(polynomial_size)
+                    .zip(sums.chunks_exact_mut(fourier_size).zip(sum_mems.iter_mut()))
+                    .enumerate()
+                    .for_each(reduce);
+            }
+        }
+
+        let acc = GlweCiphertext::from_container(
+            &*acc,
             PolynomialSize(polynomial_size),
-            DecompositionLevelCount(decomposition_level_count),
-        )
+            CiphertextModulus::new_native(),
+        );
+        let mut lwe_out = LweCiphertext::from_container(
+            slice::from_raw_parts_mut(ct_out, glwe_dimension * polynomial_size + 1),
+            CiphertextModulus::new_native(),
+        );
+        extract_lwe_sample_from_glwe_ciphertext(&acc, &mut lwe_out, MonomialDegree(0));
+    })
 }
 
 #[no_mangle]
-pub unsafe extern "C" fn concrete_cpu_fourier_bootstrap_key_size_u64(
+pub unsafe extern "C" fn concrete_cpu_multi_bit_bootstrap_key_convert_u64_to_fourier(
+    // multi-bit bootstrap key
+    standard_bsk: *const u64,
+    fourier_bsk: *mut c64,
+    // bootstrap parameters
     decomposition_level_count: usize,
+    decomposition_base_log: usize,
     glwe_dimension: usize,
     polynomial_size: usize,
     input_lwe_dimension: usize,
-) -> usize {
-    input_lwe_dimension
-        * fourier_ggsw_ciphertext_size(
+    grouping_factor: usize,
+    // parallelism
+    parallelism: Parallelism,
+) {
+    nounwind(|| {
+        let standard = LweMultiBitBootstrapKey::from_container(
+            slice::from_raw_parts(
+                standard_bsk,
+                concrete_cpu_multi_bit_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                ),
+            ),
             GlweDimension(glwe_dimension).to_glwe_size(),
-            PolynomialSize(polynomial_size).to_fourier_polynomial_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
             DecompositionLevelCount(decomposition_level_count),
-        )
+            LweBskGroupingFactor(grouping_factor),
+            CiphertextModulus::new_native(),
+        );
+
+        let mut fourier = FourierLweMultiBitBootstrapKey::from_container(
+            slice::from_raw_parts_mut(
+                fourier_bsk,
+                concrete_cpu_fourier_multi_bit_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                ),
+            ),
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            LweBskGroupingFactor(grouping_factor),
+        );
+
+        match parallelism {
+            Parallelism::No => {
+                convert_standard_lwe_multi_bit_bootstrap_key_to_fourier(&standard, &mut fourier)
+            }
+            Parallelism::Rayon => {
+                par_convert_standard_lwe_multi_bit_bootstrap_key_to_fourier(&standard, &mut fourier)
+            }
+        }
+    })
 }
 
+/// Bootstraps a ciphertext with a multi-bit key. The GGSW of each group of key bits is computed
+/// from its 2^grouping_factor GGSW by `thread_count` threads, the blind rotation consuming them as
+/// they come, so that a single bootstrap runs on several cores. No scratch is needed, each thread
+/// allocating its own buffers.
 #[no_mangle]
-pub unsafe extern "C" fn concrete_cpu_seeded_bootstrap_key_size_u64(
+pub unsafe extern "C" fn concrete_cpu_multi_bit_bootstrap_lwe_ciphertext_u64(
+    // ciphertexts
+    ct_out: *mut u64,
+    ct_in: *const u64,
+    // accumulator
+    accumulator: *const u64,
+    // multi-bit bootstrap key
+    fourier_bsk: *const c64,
+    // bootstrap parameters
     decomposition_level_count: usize,
+    decomposition_base_log: usize,
     glwe_dimension: usize,
     polynomial_size: usize,
     input_lwe_dimension: usize,
-) -> usize {
-    input_lwe_dimension
-        * seeded_ggsw_ciphertext_size(
+    grouping_factor: usize,
+    // parallelism
+    thread_count: usize,
+) {
+    nounwind(|| {
+        let output_lwe_dimension = glwe_dimension * polynomial_size;
+
+        let fourier = FourierLweMultiBitBootstrapKey::from_container(
+            slice::from_raw_parts(
+                fourier_bsk,
+                concrete_cpu_fourier_multi_bit_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                ),
+            ),
+            LweDimension(input_lwe_dimension),
             GlweDimension(glwe_dimension).to_glwe_size(),
             PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
             DecompositionLevelCount(decomposition_level_count),
-        )
+            LweBskGroupingFactor(grouping_factor),
+        );
+
+        let lwe_in = LweCiphertext::from_container(
+            slice::from_raw_parts(ct_in, input_lwe_dimension + 1),
+            CiphertextModulus::new_native(),
+        );
+
+        let mut lwe_out = LweCiphertext::from_container(
+            slice::from_raw_parts_mut(ct_out, output_lwe_dimension + 1),
+            CiphertextModulus::new_native(),
+        );
+
+        let accumulator = GlweCiphertext::from_container(
+            slice::from_raw_parts(
+                accumulator,
+                concrete_cpu_glwe_ciphertext_size_u64(glwe_dimension, polynomial_size),
+            ),
+            PolynomialSize(polynomial_size),
+            CiphertextModulus::new_native(),
+        );
+
+        // The deterministic execution keeps the outputs independent of the thread count.
+        multi_bit_programmable_bootstrap_lwe_ciphertext(
+            &lwe_in,
+            &mut lwe_out,
+            &accumulator,
+            &fourier,
+            ThreadCount(thread_count.max(1)),
+            true,
+        );
+    })
+}
+
+/// Number of ciphertexts blind rotated together by the batched bootstrap. Each GGSW of the
+/// bootstrap key is loaded once per tile and applied to all the accumulators of the tile.
+const BATCHED_BOOTSTRAP_TILE_SIZE: usize = 8;
+
+/// Rounds a torus element to the closest multiple of 1/2N, returned as an integer in [0, 2N).
+fn pbs_modulus_switch(input: u64, polynomial_size: usize) -> usize {
+    let log_2n = (2 * polynomial_size).ilog2() as u64;
+    // We keep one more bit than needed to round to the closest value.
+    let shifted = input >> (64 - log_2n - 1);
+    (((shifted + 1) >> 1) as usize) % (2 * polynomial_size)
+}
+
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn concrete_cpu_batched_bootstrap_lwe_ciphertext_u64_scratch(
+    stack_size: *mut usize,
+    stack_align: *mut usize,
+    // bootstrap parameters
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    // side resources
+    fft: *const Fft,
+) -> ScratchStatus {
+    nounwind(|| {
+        let scratch = cmux_assign_mem_optimized_requirement::<u64>(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            (*fft).as_view(),
+        );
+        if let Ok(scratch) = scratch {
+            *stack_size = scratch.size_bytes();
+            *stack_align = scratch.align_bytes();
+            ScratchStatus::Valid
+        } else {
+            ScratchStatus::SizeOverflow
+        }
+    })
+}
+
+/// Bootstraps `ct_count` ciphertexts stored contiguously in `ct_in_vec`, writing them
+/// contiguously in `ct_out_vec`. `accumulator_count` must be either 1, in which case all the
+/// ciphertexts are bootstrapped with the same accumulator, or `ct_count`.
+///
+/// The ciphertexts are blind rotated by tiles, iterating over the GGSWs of the bootstrap key in
+/// the outer loop, which loads the whole fourier bootstrap key once per tile instead of once per
+/// ciphertext.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_batched_bootstrap_lwe_ciphertext_u64(
+    // ciphertexts
+    ct_out_vec: *mut u64,
+    ct_in_vec: *const u64,
+    ct_count: usize,
+    // accumulators
+    accumulators: *const u64,
+    accumulator_count: usize,
+    // bootstrap key
+    fourier_bsk: *const c64,
+    // bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+    // side resources
+    fft: *const Fft,
+    stack: *mut u8,
+    stack_size: usize,
+) {
+    nounwind(|| {
+        assert!(accumulator_count == 1 || accumulator_count == ct_count);
+
+        let output_lwe_size = glwe_dimension * polynomial_size + 1;
+        let input_lwe_size = input_lwe_dimension + 1;
+        let glwe_len = concrete_cpu_glwe_ciphertext_size_u64(glwe_dimension, polynomial_size);
+        let fft = (*fft).as_view();
+
+        let fourier = FourierLweBootstrapKey::from_container(
+            slice::from_raw_parts(
+                fourier_bsk,
+                concrete_cpu_fourier_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                ),
+            ),
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+
+        let ct_in_vec = slice::from_raw_parts(ct_in_vec, ct_count * input_lwe_size);
+        let ct_out_vec = slice::from_raw_parts_mut(ct_out_vec, ct_count * output_lwe_size);
+        let accumulators = slice::from_raw_parts(accumulators, accumulator_count * glwe_len);
+
+        // The accumulators of a tile are reused for all the tiles of the batch.
+        let mut tile_acc = vec![0_u64; BATCHED_BOOTSTRAP_TILE_SIZE * glwe_len];
+        let mut tile_rotated = vec![0_u64; BATCHED_BOOTSTRAP_TILE_SIZE * glwe_len];
+
+        for tile_start in (0..ct_count).step_by(BATCHED_BOOTSTRAP_TILE_SIZE) {
+            let tile_len = BATCHED_BOOTSTRAP_TILE_SIZE.min(ct_count - tile_start);
+            let tile_in = &ct_in_vec[tile_start * input_lwe_size..][..tile_len * input_lwe_size];
+
+            // The accumulators of the tile are rotated by the body of their ciphertext.
+            for (j, (acc, lwe_in)) in tile_acc
+                .chunks_exact_mut(glwe_len)
+                .zip(tile_in.chunks_exact(input_lwe_size))
+                .enumerate()
+            {
+                let acc_index = if accumulator_count == 1 {
+                    0
+                } else {
+                    tile_start + j
+                };
+                acc.copy_from_slice(&accumulators[acc_index * glwe_len..][..glwe_len]);
+                let body = pbs_modulus_switch(lwe_in[input_lwe_dimension], polynomial_size);
+                let mut acc = GlweCiphertext::from_container(
+                    acc,
+                    PolynomialSize(polynomial_size),
+                    CiphertextModulus::new_native(),
+                );
+                for mut poly in acc.as_mut_polynomial_list().iter_mut() {
+                    polynomial_wrapping_monic_monomial_div_assign(&mut poly, MonomialDegree(body));
+                }
+            }
+
+            // Each GGSW is applied to all the accumulators of the tile while it is hot.
+            for (i, ggsw) in fourier.as_view().into_ggsw_iter().enumerate() {
+                for ((acc, rotated), lwe_in) in tile_acc
+                    .chunks_exact_mut(glwe_len)
+                    .zip(tile_rotated.chunks_exact_mut(glwe_len))
+                    .zip(tile_in.chunks_exact(input_lwe_size))
+                {
+                    let mask = pbs_modulus_switch(lwe_in[i], polynomial_size);
+                    if mask == 0 {
+                        continue;
+                    }
+                    rotated.copy_from_slice(acc);
+                    let mut rotated = GlweCiphertext::from_container(
+                        rotated,
+                        PolynomialSize(polynomial_size),
+                        CiphertextModulus::new_native(),
+                    );
+                    for mut poly in rotated.as_mut_polynomial_list().iter_mut() {
+                        polynomial_wrapping_monic_monomial_mul_assign(
+                            &mut poly,
+                            MonomialDegree(mask),
+                        );
+                    }
+                    let mut acc = GlweCiphertext::from_container(
+                        acc,
+                        PolynomialSize(polynomial_size),
+                        CiphertextModulus::new_native(),
+                    );
+                    cmux_assign_mem_optimized(
+                        &mut acc,
+                        &mut rotated,
+                        &ggsw,
+                        fft,
+                        PodStack::new(slice::from_raw_parts_mut(stack as _, stack_size)),
+                    );
+                }
+            }
+
+            // The results are extracted from the constant coefficients of the accumulators.
+            let tile_out =
+                &mut ct_out_vec[tile_start * output_lwe_size..][..tile_len * output_lwe_size];
+            for (acc, lwe_out) in tile_acc
+                .chunks_exact(glwe_len)
+                .zip(tile_out.chunks_exact_mut(output_lwe_size))
+            {
+                let acc = GlweCiphertext::from_container(
+                    acc,
+                    PolynomialSize(polynomial_size),
+                    CiphertextModulus::new_native(),
+                );
+                let mut lwe_out =
+                    LweCiphertext::from_container(lwe_out, CiphertextModulus::new_native());
+                extract_lwe_sample_from_glwe_ciphertext(&acc, &mut lwe_out, MonomialDegree(0));
+            }
+        }
+    })
+}
+
+/// Same as `pbs_modulus_switch`, but rounds the result to a multiple of `lut_count`, so that the
+/// `lut_count` consecutive coefficients packed for a message are rotated together.
+fn pbs_modulus_switch_many_lut(input: u64, polynomial_size: usize, lut_count: usize) -> usize {
+    let log_2n = (2 * polynomial_size).ilog2() as u64;
+    let log_lut_count = lut_count.ilog2() as u64;
+    let shifted = input >> (64 - (log_2n - log_lut_count) - 1);
+    ((((shifted + 1) >> 1) as usize) << log_lut_count) % (2 * polynomial_size)
+}
+
+/// Bootstraps `ct_in` with an accumulator packing `lut_count` lookup tables, writing the
+/// `lut_count` resulting ciphertexts contiguously in `ct_out_vec`.
+///
+/// The tables are interleaved in the accumulator, the i-th one on the coefficients congruent to i
+/// modulo `lut_count`. The blind rotation is done once, with a modulus switch rounding to a
+/// multiple of `lut_count`, and the i-th result is extracted from the i-th coefficient.
+/// `lut_count` must be a power of two. The scratch is the one of the batched bootstrap.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_many_lut_bootstrap_lwe_ciphertext_u64(
+    // ciphertexts
+    ct_out_vec: *mut u64,
+    ct_in: *const u64,
+    // accumulator
+    accumulator: *const u64,
+    lut_count: usize,
+    // bootstrap key
+    fourier_bsk: *const c64,
+    // bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+    // side resources
+    fft: *const Fft,
+    stack: *mut u8,
+    stack_size: usize,
+) {
+    nounwind(|| {
+        assert!(lut_count.is_power_of_two() && lut_count <= polynomial_size);
+
+        let output_lwe_size = glwe_dimension * polynomial_size + 1;
+        let input_lwe_size = input_lwe_dimension + 1;
+        let glwe_len = concrete_cpu_glwe_ciphertext_size_u64(glwe_dimension, polynomial_size);
+        let fft = (*fft).as_view();
+
+        let fourier = FourierLweBootstrapKey::from_container(
+            slice::from_raw_parts(
+                fourier_bsk,
+                concrete_cpu_fourier_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                ),
+            ),
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+
+        let lwe_in = slice::from_raw_parts(ct_in, input_lwe_size);
+        let ct_out_vec = slice::from_raw_parts_mut(ct_out_vec, lut_count * output_lwe_size);
+
+        let mut acc = slice::from_raw_parts(accumulator, glwe_len).to_vec();
+        let mut rotated = vec![0_u64; glwe_len];
+
+        let body =
+            pbs_modulus_switch_many_lut(lwe_in[input_lwe_dimension], polynomial_size, lut_count);
+        {
+            let mut acc = GlweCiphertext::from_container(
+                acc.as_mut_slice(),
+                PolynomialSize(polynomial_size),
+                CiphertextModulus::new_native(),
+            );
+            for mut poly in acc.as_mut_polynomial_list().iter_mut() {
+                polynomial_wrapping_monic_monomial_div_assign(&mut poly, MonomialDegree(body));
+            }
+        }
+
+        for (i, ggsw) in fourier.as_view().into_ggsw_iter().enumerate() {
+            let mask = pbs_modulus_switch_many_lut(lwe_in[i], polynomial_size, lut_count);
+            if mask == 0 {
+                continue;
+            }
+            rotated.copy_from_slice(&acc);
+            let mut rotated = GlweCiphertext::from_container(
+                rotated.as_mut_slice(),
+                PolynomialSize(polynomial_size),
+                CiphertextModulus::new_native(),
+            );
+            for mut poly in rotated.as_mut_polynomial_list().iter_mut() {
+                polynomial_wrapping_monic_monomial_mul_assign(&mut poly, MonomialDegree(mask));
+            }
+            let mut acc = GlweCiphertext::from_container(
+                acc.as_mut_slice(),
+                PolynomialSize(polynomial_size),
+                CiphertextModulus::new_native(),
+            );
+            cmux_assign_mem_optimized(
+                &mut acc,
+                &mut rotated,
+                &ggsw,
+                fft,
+                PodStack::new(slice::from_raw_parts_mut(stack as _, stack_size)),
+            );
+        }
+
+        let acc = GlweCiphertext::from_container(
+            acc.as_slice(),
+            PolynomialSize(polynomial_size),
+            CiphertextModulus::new_native(),
+        );
+        for (i, lwe_out) in ct_out_vec.chunks_exact_mut(output_lwe_size).enumerate() {
+            let mut lwe_out =
+                LweCiphertext::from_container(lwe_out, CiphertextModulus::new_native());
+            extract_lwe_sample_from_glwe_ciphertext(&acc, &mut lwe_out, MonomialDegree(i));
+        }
+    })
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_key_size_u64(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) -> usize {
+    input_lwe_dimension
+        * ggsw_ciphertext_size(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionLevelCount(decomposition_level_count),
+        )
+}
+
+/// The multi-bit bootstrap key holds 2^grouping_factor GGSW ciphertexts per
+/// group of grouping_factor input key bits.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_multi_bit_bootstrap_key_size_u64(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+    grouping_factor: usize,
+) -> usize {
+    input_lwe_dimension / grouping_factor
+        * (1 << grouping_factor)
+        * ggsw_ciphertext_size(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionLevelCount(decomposition_level_count),
+        )
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fourier_bootstrap_key_size_u64(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) -> usize {
+    input_lwe_dimension
+        * fourier_ggsw_ciphertext_size(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size).to_fourier_polynomial_size(),
+            DecompositionLevelCount(decomposition_level_count),
+        )
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fourier_multi_bit_bootstrap_key_size_u64(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+    grouping_factor: usize,
+) -> usize {
+    input_lwe_dimension / grouping_factor
+        * (1 << grouping_factor)
+        * fourier_ggsw_ciphertext_size(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size).to_fourier_polynomial_size(),
+            DecompositionLevelCount(decomposition_level_count),
+        )
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_seeded_bootstrap_key_size_u64(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) -> usize {
+    input_lwe_dimension
+        * seeded_ggsw_ciphertext_size(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionLevelCount(decomposition_level_count),
+        )
+}
+
+/// The 128 bits bootstrap works on the 128 bits torus, its FFT splitting each coefficient in two
+/// f64 to keep the precision of the products. It lets the parameter sets of high precision
+/// bootstrap natively instead of being decomposed. All its integers are stored as pairs of words,
+/// the least significant one first, and its secret keys are the binary keys of the 64 bits
+/// functions.
+///
+/// Returns the number of words of a 128 bits bootstrap key.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_key_size_u128(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) -> usize {
+    2 * concrete_cpu_bootstrap_key_size_u64(
+        decomposition_level_count,
+        glwe_dimension,
+        polynomial_size,
+        input_lwe_dimension,
+    )
+}
+
+/// Returns the number of f64 of a 128 bits bootstrap key in the fourier domain, in four
+/// consecutive parts: the high and low words of the real parts, then of the imaginary parts.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fourier128_bootstrap_key_size(
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) -> usize {
+    concrete_cpu_bootstrap_key_size_u128(
+        decomposition_level_count,
+        glwe_dimension,
+        polynomial_size,
+        input_lwe_dimension,
+    )
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_init_lwe_bootstrap_key_u128(
+    // bootstrap key
+    lwe_bsk: *mut u64,
+    // secret keys
+    input_lwe_sk: *const u64,
+    output_glwe_sk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_polynomial_size: usize,
+    output_glwe_dimension: usize,
+    // bootstrap key parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    // noise parameters
+    variance: f64,
+    // parallelism
+    parallelism: Parallelism,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let words = slice::from_raw_parts_mut(
+            lwe_bsk,
+            concrete_cpu_bootstrap_key_size_u128(
+                decomposition_level_count,
+                output_glwe_dimension,
+                output_polynomial_size,
+                input_lwe_dimension,
+            ),
+        );
+        let mut bsk = LweBootstrapKey::new(
+            0_u128,
+            GlweDimension(output_glwe_dimension).to_glwe_size(),
+            PolynomialSize(output_polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            LweDimension(input_lwe_dimension),
+            CiphertextModulus::new_native(),
+        );
+
+        let lwe_sk = LweSecretKey::from_container(
+            slice::from_raw_parts(input_lwe_sk, input_lwe_dimension)
+                .iter()
+                .map(|&s| s as u128)
+                .collect::<Vec<_>>(),
+        );
+        let glwe_sk = GlweSecretKey::from_container(
+            slice::from_raw_parts(
+                output_glwe_sk,
+                concrete_cpu_glwe_secret_key_size_u64(
+                    output_glwe_dimension,
+                    output_polynomial_size,
+                ),
+            )
+            .iter()
+            .map(|&s| s as u128)
+            .collect::<Vec<_>>(),
+            PolynomialSize(output_polynomial_size),
+        );
+
+        let generator = &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>);
+        match parallelism {
+            Parallelism::No => generate_lwe_bootstrap_key(
+                &lwe_sk,
+                &glwe_sk,
+                &mut bsk,
+                Variance::from_variance(variance),
+                generator,
+            ),
+            Parallelism::Rayon => par_generate_lwe_bootstrap_key(
+                &lwe_sk,
+                &glwe_sk,
+                &mut bsk,
+                Variance::from_variance(variance),
+                generator,
+            ),
+        }
+        write_u128(words, bsk.as_ref());
+    });
+}
+
+/// Splits a 128 bits fourier bootstrap key in its four parts.
+unsafe fn fourier128_bootstrap_key_parts<'a>(
+    fourier_bsk: *const f64,
+    decomposition_level_count: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) -> [&'a [f64]; 4] {
+    let size = concrete_cpu_fourier128_bootstrap_key_size(
+        decomposition_level_count,
+        glwe_dimension,
+        polynomial_size,
+        input_lwe_dimension,
+    );
+    let data = slice::from_raw_parts(fourier_bsk, size);
+    let (re, im) = data.split_at(size / 2);
+    let (re0, re1) = re.split_at(size / 4);
+    let (im0, im1) = im.split_at(size / 4);
+    [re0, re1, im0, im1]
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_key_convert_u128_to_fourier128(
+    // bootstrap key
+    standard_bsk: *const u64,
+    fourier_bsk: *mut f64,
+    // bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) {
+    nounwind(|| {
+        let standard = LweBootstrapKey::from_container(
+            read_u128(slice::from_raw_parts(
+                standard_bsk,
+                concrete_cpu_bootstrap_key_size_u128(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                ),
+            )),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            CiphertextModulus::new_native(),
+        );
+
+        let size = concrete_cpu_fourier128_bootstrap_key_size(
+            decomposition_level_count,
+            glwe_dimension,
+            polynomial_size,
+            input_lwe_dimension,
+        );
+        let data = slice::from_raw_parts_mut(fourier_bsk, size);
+        let (re, im) = data.split_at_mut(size / 2);
+        let (re0, re1) = re.split_at_mut(size / 4);
+        let (im0, im1) = im.split_at_mut(size / 4);
+        let mut fourier = Fourier128LweBootstrapKey::from_container(
+            re0,
+            re1,
+            im0,
+            im1,
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+        convert_standard_lwe_bootstrap_key_to_fourier_128(&standard, &mut fourier);
+    });
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_lwe_ciphertext_u128(
+    // ciphertexts
+    ct_out: *mut u64,
+    ct_in: *const u64,
+    // accumulator
+    accumulator: *const u64,
+    // bootstrap key
+    fourier_bsk: *const f64,
+    // bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+) {
+    nounwind(|| {
+        let [re0, re1, im0, im1] = fourier128_bootstrap_key_parts(
+            fourier_bsk,
+            decomposition_level_count,
+            glwe_dimension,
+            polynomial_size,
+            input_lwe_dimension,
+        );
+        let fourier = Fourier128LweBootstrapKey::from_container(
+            re0,
+            re1,
+            im0,
+            im1,
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+
+        let ct_in = LweCiphertext::from_container(
+            read_u128(slice::from_raw_parts(ct_in, 2 * (input_lwe_dimension + 1))),
+            CiphertextModulus::new_native(),
+        );
+        let accumulator = GlweCiphertext::from_container(
+            read_u128(slice::from_raw_parts(
+                accumulator,
+                2 * concrete_cpu_glwe_ciphertext_size_u64(glwe_dimension, polynomial_size),
+            )),
+            PolynomialSize(polynomial_size),
+            CiphertextModulus::new_native(),
+        );
+        let out_words =
+            slice::from_raw_parts_mut(ct_out, 2 * (glwe_dimension * polynomial_size + 1));
+        let mut out = LweCiphertext::new(
+            0_u128,
+            LweSize(glwe_dimension * polynomial_size + 1),
+            CiphertextModulus::new_native(),
+        );
+
+        programmable_bootstrap_f128_lwe_ciphertext(&ct_in, &mut out, &accumulator, &fourier);
+        write_u128(out_words, out.as_ref());
+    });
+}
+
+/// Generates a bootstrap key of the 32 bits torus, of `concrete_cpu_bootstrap_key_size_u64`
+/// elements. The 32 bits functions are meant for the circuits whose parameters are optimized for
+/// a 32 bits ciphertext modulus, their keys and ciphertexts being half the size of the u64 ones.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_init_lwe_bootstrap_key_u32(
+    // bootstrap key
+    lwe_bsk: *mut u32,
+    // secret keys
+    input_lwe_sk: *const u64,
+    output_glwe_sk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_polynomial_size: usize,
+    output_glwe_dimension: usize,
+    // bootstrap key parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    // noise parameters
+    variance: f64,
+    // parallelism
+    parallelism: Parallelism,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let mut bsk = LweBootstrapKey::from_container(
+            slice::from_raw_parts_mut(
+                lwe_bsk,
+                concrete_cpu_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    output_glwe_dimension,
+                    output_polynomial_size,
+                    input_lwe_dimension,
+                ),
+            ),
+            GlweDimension(output_glwe_dimension).to_glwe_size(),
+            PolynomialSize(output_polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            CiphertextModulus::new_native(),
+        );
+
+        let lwe_sk = LweSecretKey::from_container(secret_key_u32(slice::from_raw_parts(
+            input_lwe_sk,
+            concrete_cpu_lwe_secret_key_size_u64(input_lwe_dimension),
+        )));
+        let glwe_sk = GlweSecretKey::from_container(
+            secret_key_u32(slice::from_raw_parts(
+                output_glwe_sk,
+                concrete_cpu_glwe_secret_key_size_u64(
+                    output_glwe_dimension,
+                    output_polynomial_size,
+                ),
+            )),
+            PolynomialSize(output_polynomial_size),
+        );
+
+        let generator = &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>);
+        match parallelism {
+            Parallelism::No => generate_lwe_bootstrap_key(
+                &lwe_sk,
+                &glwe_sk,
+                &mut bsk,
+                Variance::from_variance(variance),
+                generator,
+            ),
+            Parallelism::Rayon => par_generate_lwe_bootstrap_key(
+                &lwe_sk,
+                &glwe_sk,
+                &mut bsk,
+                Variance::from_variance(variance),
+                generator,
+            ),
+        }
+    });
+}
+
+/// Converts a bootstrap key of the 32 bits torus to the fourier domain, in a buffer of
+/// `concrete_cpu_fourier_bootstrap_key_size_u64` elements. The scratch is the one of
+/// `concrete_cpu_bootstrap_key_convert_u64_to_fourier`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_key_convert_u32_to_fourier(
+    // bootstrap key
+    standard_bsk: *const u32,
+    fourier_bsk: *mut c64,
+    // bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+    // side resources
+    fft: *const Fft,
+    stack: *mut u8,
+    stack_size: usize,
+) {
+    nounwind(|| {
+        let standard = LweBootstrapKey::from_container(
+            slice::from_raw_parts(
+                standard_bsk,
+                concrete_cpu_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                ),
+            ),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            CiphertextModulus::new_native(),
+        );
+
+        let mut fourier = FourierLweBootstrapKey::from_container(
+            slice::from_raw_parts_mut(
+                fourier_bsk,
+                concrete_cpu_fourier_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                ),
+            ),
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+
+        convert_standard_lwe_bootstrap_key_to_fourier_mem_optimized(
+            &standard,
+            &mut fourier,
+            (*fft).as_view(),
+            PodStack::new(slice::from_raw_parts_mut(stack as _, stack_size)),
+        );
+    })
+}
+
+#[no_mangle]
+#[must_use]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_lwe_ciphertext_u32_scratch(
+    stack_size: *mut usize,
+    stack_align: *mut usize,
+    // bootstrap parameters
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    // side resources
+    fft: *const Fft,
+) -> ScratchStatus {
+    nounwind(|| {
+        if let Ok(scratch) = programmable_bootstrap_lwe_ciphertext_mem_optimized_requirement::<u32>(
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            (*fft).as_view(),
+        ) {
+            *stack_size = scratch.size_bytes();
+            *stack_align = scratch.align_bytes();
+            ScratchStatus::Valid
+        } else {
+            ScratchStatus::SizeOverflow
+        }
+    })
+}
+
+/// Bootstraps a ciphertext of the 32 bits torus like `concrete_cpu_bootstrap_lwe_ciphertext_u64`.
+/// The fourier key is the same size, but the decomposed GLWEs and the accumulator are half the
+/// size of the u64 ones.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_bootstrap_lwe_ciphertext_u32(
+    // ciphertexts
+    ct_out: *mut u32,
+    ct_in: *const u32,
+    // accumulator
+    accumulator: *const u32,
+    // bootstrap key
+    fourier_bsk: *const c64,
+    // bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    input_lwe_dimension: usize,
+    // side resources
+    fft: *const Fft,
+    stack: *mut u8,
+    stack_size: usize,
+) {
+    nounwind(|| {
+        let output_lwe_dimension = glwe_dimension * polynomial_size;
+
+        let fourier = FourierLweBootstrapKey::from_container(
+            slice::from_raw_parts(
+                fourier_bsk,
+                concrete_cpu_fourier_bootstrap_key_size_u64(
+                    decomposition_level_count,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                ),
+            ),
+            LweDimension(input_lwe_dimension),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+
+        let lwe_in = LweCiphertext::from_container(
+            slice::from_raw_parts(ct_in, input_lwe_dimension + 1),
+            CiphertextModulus::new_native(),
+        );
+
+        let mut lwe_out = LweCiphertext::from_container(
+            slice::from_raw_parts_mut(ct_out, output_lwe_dimension + 1),
+            CiphertextModulus::new_native(),
+        );
+
+        let accumulator = GlweCiphertext::from_container(
+            slice::from_raw_parts(
+                accumulator,
+                concrete_cpu_glwe_ciphertext_size_u64(glwe_dimension, polynomial_size),
+            ),
+            PolynomialSize(polynomial_size),
+            CiphertextModulus::new_native(),
+        );
+
+        programmable_bootstrap_lwe_ciphertext_mem_optimized(
+            &lwe_in,
+            &mut lwe_out,
+            &accumulator,
+            &fourier,
+            (*fft).as_view(),
+            PodStack::new(slice::from_raw_parts_mut(stack as _, stack_size)),
+        );
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn parallel_decompression_is_deterministic() {
+        let (input_lwe_dimension, polynomial_size, glwe_dimension) = (8, 256, 1);
+        let (level, base_log) = (2, 8);
+        let lwe_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let glwe_sk: Vec<u64> = (0..(glwe_dimension * polynomial_size) as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let seed = Uint128 {
+            little_endian_bytes: [3; 16],
+        };
+        unsafe {
+            let mut seeded_bsk = vec![
+                0_u64;
+                concrete_cpu_seeded_bootstrap_key_size_u64(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                )
+            ];
+            concrete_cpu_init_seeded_lwe_bootstrap_key_u64(
+                seeded_bsk.as_mut_ptr(),
+                lwe_sk.as_ptr(),
+                glwe_sk.as_ptr(),
+                input_lwe_dimension,
+                polynomial_size,
+                glwe_dimension,
+                level,
+                base_log,
+                seed,
+                1e-20,
+                Parallelism::No,
+            );
+            let decompress = |parallelism| {
+                let mut bsk = vec![
+                    0_u64;
+                    concrete_cpu_bootstrap_key_size_u64(
+                        level,
+                        glwe_dimension,
+                        polynomial_size,
+                        input_lwe_dimension,
+                    )
+                ];
+                concrete_cpu_decompress_seeded_lwe_bootstrap_key_u64(
+                    bsk.as_mut_ptr(),
+                    seeded_bsk.as_ptr(),
+                    input_lwe_dimension,
+                    polynomial_size,
+                    glwe_dimension,
+                    level,
+                    base_log,
+                    seed,
+                    parallelism,
+                );
+                bsk
+            };
+            assert_eq!(decompress(Parallelism::No), decompress(Parallelism::Rayon));
+        }
+    }
+
+    #[test]
+    fn parallel_bootstrap_matches_sequential() {
+        let (input_lwe_dimension, polynomial_size, glwe_dimension) = (8, 256, 2);
+        let (level, base_log) = (3, 6);
+        let lwe_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let glwe_sk: Vec<u64> = (0..(glwe_dimension * polynomial_size) as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let mut csprng = EncryptionRandomGenerator::<DynamicRandomGenerator>::new(
+            Seed(7),
+            new_dyn_seeder().as_mut(),
+        );
+        let fft = Fft::new(PolynomialSize(polynomial_size));
+        unsafe {
+            let mut bsk = vec![
+                0_u64;
+                concrete_cpu_bootstrap_key_size_u64(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                )
+            ];
+            concrete_cpu_init_lwe_bootstrap_key_u64(
+                bsk.as_mut_ptr(),
+                lwe_sk.as_ptr(),
+                glwe_sk.as_ptr(),
+                input_lwe_dimension,
+                polynomial_size,
+                glwe_dimension,
+                level,
+                base_log,
+                1e-20,
+                Parallelism::No,
+                &mut csprng as *mut _ as *mut EncCsprng,
+            );
+            let mut fourier_bsk = vec![
+                c64::default();
+                concrete_cpu_fourier_bootstrap_key_size_u64(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                )
+            ];
+            let mut mem = GlobalPodBuffer::new(StackReq::any_of([
+                fft.as_view().forward_scratch().unwrap(),
+                programmable_bootstrap_lwe_ciphertext_mem_optimized_requirement::<u64>(
+                    GlweDimension(glwe_dimension).to_glwe_size(),
+                    PolynomialSize(polynomial_size),
+                    fft.as_view(),
+                )
+                .unwrap(),
+            ]));
+            concrete_cpu_bootstrap_key_convert_u64_to_fourier(
+                bsk.as_ptr(),
+                fourier_bsk.as_mut_ptr(),
+                level,
+                base_log,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+                &fft,
+                mem.as_mut_ptr(),
+                mem.len(),
+            );
+            let ct_in: Vec<u64> = (0..=input_lwe_dimension as u64)
+                .map(|i| i.wrapping_mul(0x9e37_79b9_7f4a_7c15))
+                .collect();
+            let mut accumulator = vec![0_u64; (glwe_dimension + 1) * polynomial_size];
+            for (i, coefficient) in accumulator[glwe_dimension * polynomial_size..]
+                .iter_mut()
+                .enumerate()
+            {
+                *coefficient = (i as u64) << 48;
+            }
+
+            let mut expected = vec![0_u64; glwe_dimension * polynomial_size + 1];
+            concrete_cpu_bootstrap_lwe_ciphertext_u64(
+                expected.as_mut_ptr(),
+                ct_in.as_ptr(),
+                accumulator.as_ptr(),
+                fourier_bsk.as_ptr(),
+                level,
+                base_log,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+                &fft,
+                mem.as_mut_ptr(),
+                mem.len(),
+            );
+            for thread_count in [1, 4] {
+                let mut ct_out = vec![0_u64; glwe_dimension * polynomial_size + 1];
+                concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64(
+                    ct_out.as_mut_ptr(),
+                    ct_in.as_ptr(),
+                    accumulator.as_ptr(),
+                    fourier_bsk.as_ptr(),
+                    level,
+                    base_log,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    &fft,
+                    BootstrapParams { thread_count },
+                );
+                // The FFTs only differ by the order of their floating point sums.
+                for (a, b) in ct_out.iter().zip(&expected) {
+                    assert!((a.wrapping_sub(*b) as i64).unsigned_abs() < 1 << 40);
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn multi_bit_bootstrap_is_independent_of_thread_count() {
+        let (input_lwe_dimension, polynomial_size, glwe_dimension) = (8, 256, 1);
+        let (level, base_log, grouping_factor) = (2, 8, 2);
+        let lwe_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let glwe_sk: Vec<u64> = (0..(glwe_dimension * polynomial_size) as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let mut csprng = EncryptionRandomGenerator::<DynamicRandomGenerator>::new(
+            Seed(5),
+            new_dyn_seeder().as_mut(),
+        );
+        unsafe {
+            let mut bsk = vec![
+                0_u64;
+                concrete_cpu_multi_bit_bootstrap_key_size_u64(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                )
+            ];
+            concrete_cpu_init_lwe_multi_bit_bootstrap_key_u64(
+                bsk.as_mut_ptr(),
+                lwe_sk.as_ptr(),
+                glwe_sk.as_ptr(),
+                input_lwe_dimension,
+                polynomial_size,
+                glwe_dimension,
+                level,
+                base_log,
+                grouping_factor,
+                1e-20,
+                Parallelism::Rayon,
+                &mut csprng as *mut _ as *mut EncCsprng,
+            );
+            let mut fourier_bsk = vec![
+                c64::default();
+                concrete_cpu_fourier_multi_bit_bootstrap_key_size_u64(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                )
+            ];
+            concrete_cpu_multi_bit_bootstrap_key_convert_u64_to_fourier(
+                bsk.as_ptr(),
+                fourier_bsk.as_mut_ptr(),
+                level,
+                base_log,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+                grouping_factor,
+                Parallelism::Rayon,
+            );
+            let ct_in: Vec<u64> = (0..=input_lwe_dimension as u64)
+                .map(|i| i.wrapping_mul(0x9e37_79b9_7f4a_7c15))
+                .collect();
+            let mut accumulator = vec![0_u64; (glwe_dimension + 1) * polynomial_size];
+            for (i, coefficient) in accumulator[glwe_dimension * polynomial_size..]
+                .iter_mut()
+                .enumerate()
+            {
+                *coefficient = (i as u64) << 48;
+            }
+            let bootstrap = |thread_count| {
+                let mut ct_out = vec![0_u64; glwe_dimension * polynomial_size + 1];
+                concrete_cpu_multi_bit_bootstrap_lwe_ciphertext_u64(
+                    ct_out.as_mut_ptr(),
+                    ct_in.as_ptr(),
+                    accumulator.as_ptr(),
+                    fourier_bsk.as_ptr(),
+                    level,
+                    base_log,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                    grouping_factor,
+                    thread_count,
+                );
+                ct_out
+            };
+            assert_eq!(bootstrap(1), bootstrap(4));
+        }
+    }
+
+    #[test]
+    fn u128_bootstrap_computes_the_lut() {
+        use crate::c_api::secret_key::{
+            concrete_cpu_decrypt_lwe_ciphertext_u128, concrete_cpu_encrypt_lwe_ciphertext_u128,
+        };
+
+        let (input_lwe_dimension, polynomial_size, glwe_dimension) = (8, 256, 1);
+        let (level, base_log) = (3, 16);
+        let lwe_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let glwe_sk: Vec<u64> = (0..(glwe_dimension * polynomial_size) as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let mut csprng = EncryptionRandomGenerator::<DynamicRandomGenerator>::new(
+            Seed(9),
+            new_dyn_seeder().as_mut(),
+        );
+        let csprng = &mut csprng as *mut _ as *mut EncCsprng;
+        unsafe {
+            let mut bsk = vec![
+                0_u64;
+                concrete_cpu_bootstrap_key_size_u128(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                )
+            ];
+            concrete_cpu_init_lwe_bootstrap_key_u128(
+                bsk.as_mut_ptr(),
+                lwe_sk.as_ptr(),
+                glwe_sk.as_ptr(),
+                input_lwe_dimension,
+                polynomial_size,
+                glwe_dimension,
+                level,
+                base_log,
+                1e-40,
+                Parallelism::Rayon,
+                csprng,
+            );
+            let mut fourier_bsk = vec![
+                0_f64;
+                concrete_cpu_fourier128_bootstrap_key_size(
+                    level,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                )
+            ];
+            concrete_cpu_bootstrap_key_convert_u128_to_fourier128(
+                bsk.as_ptr(),
+                fourier_bsk.as_mut_ptr(),
+                level,
+                base_log,
+                glwe_dimension,
+                polynomial_size,
+                input_lwe_dimension,
+            );
+
+            // Identity on 2 bits, with a padding bit: the box of m is centered on the rotation
+            // of m * 2N / 8.
+            let box_size = 2 * polynomial_size / 8;
+            let mut accumulator = vec![0_u128; (glwe_dimension + 1) * polynomial_size];
+            for (i, coefficient) in accumulator[glwe_dimension * polynomial_size..]
+                .iter_mut()
+                .enumerate()
+            {
+                *coefficient = (((i + box_size / 2) / box_size) as u128) << 125;
+            }
+            let mut accumulator_words = vec![0_u64; 2 * accumulator.len()];
+            write_u128(&mut accumulator_words, &accumulator);
+
+            for message in 1..4_u128 {
+                let mut ct_in = vec![0_u64; 2 * (input_lwe_dimension + 1)];
+                concrete_cpu_encrypt_lwe_ciphertext_u128(
+                    lwe_sk.as_ptr(),
+                    ct_in.as_mut_ptr(),
+                    Uint128 {
+                        little_endian_bytes: (message << 125).to_le_bytes(),
+                    },
+                    input_lwe_dimension,
+                    1e-40,
+                    csprng,
+                );
+                let mut ct_out = vec![0_u64; 2 * (glwe_dimension * polynomial_size + 1)];
+                concrete_cpu_bootstrap_lwe_ciphertext_u128(
+                    ct_out.as_mut_ptr(),
+                    ct_in.as_ptr(),
+                    accumulator_words.as_ptr(),
+                    fourier_bsk.as_ptr(),
+                    level,
+                    base_log,
+                    glwe_dimension,
+                    polynomial_size,
+                    input_lwe_dimension,
+                );
+                let mut decrypted = Uint128 {
+                    little_endian_bytes: [0; 16],
+                };
+                concrete_cpu_decrypt_lwe_ciphertext_u128(
+                    glwe_sk.as_ptr(),
+                    ct_out.as_ptr(),
+                    glwe_dimension * polynomial_size,
+                    &mut decrypted,
+                );
+                let decrypted = u128::from_le_bytes(decrypted.little_endian_bytes);
+                assert_eq!(decrypted.wrapping_add(1 << 124) >> 125, message);
+            }
+        }
+    }
+
+    #[test]
+    fn keyswitch_and_bootstrap_u32() {
+        use crate::c_api::keyswitch::{
+            concrete_cpu_init_lwe_keyswitch_key_u32, concrete_cpu_keyswitch_key_size_u64,
+            concrete_cpu_keyswitch_lwe_ciphertext_u32,
+        };
+        use crate::c_api::secret_key::{
+            concrete_cpu_decrypt_lwe_ciphertext_u32, concrete_cpu_encrypt_lwe_ciphertext_u32,
+        };
+
+        let (small_lwe_dimension, polynomial_size, glwe_dimension) = (8, 512, 1);
+        let big_lwe_dimension = glwe_dimension * polynomial_size;
+        let (bsk_level, bsk_base_log, ksk_level, ksk_base_log) = (2, 8, 3, 4);
+        let small_sk: Vec<u64> = (0..small_lwe_dimension as u64).map(|i| i % 2).collect();
+        let big_sk: Vec<u64> = (0..big_lwe_dimension as u64).map(|i| (i / 3) % 2).collect();
+        let mut csprng = EncryptionRandomGenerator::<DynamicRandomGenerator>::new(
+            Seed(11),
+            new_dyn_seeder().as_mut(),
+        );
+        let csprng = &mut csprng as *mut _ as *mut EncCsprng;
+        let fft = Fft::new(PolynomialSize(polynomial_size));
+        // 2 bits messages and their padding bit
+        let (message_count, delta) = (4_u32, 1_u32 << 29);
+        unsafe {
+            let mut ksk = vec![
+                0_u32;
+                concrete_cpu_keyswitch_key_size_u64(
+                    ksk_level,
+                    big_lwe_dimension,
+                    small_lwe_dimension,
+                )
+            ];
+            concrete_cpu_init_lwe_keyswitch_key_u32(
+                ksk.as_mut_ptr(),
+                big_sk.as_ptr(),
+                small_sk.as_ptr(),
+                big_lwe_dimension,
+                small_lwe_dimension,
+                ksk_level,
+                ksk_base_log,
+                1e-20,
+                csprng,
+            );
+            let mut bsk = vec![
+                0_u32;
+                concrete_cpu_bootstrap_key_size_u64(
+                    bsk_level,
+                    glwe_dimension,
+                    polynomial_size,
+                    small_lwe_dimension,
+                )
+            ];
+            concrete_cpu_init_lwe_bootstrap_key_u32(
+                bsk.as_mut_ptr(),
+                small_sk.as_ptr(),
+                big_sk.as_ptr(),
+                small_lwe_dimension,
+                polynomial_size,
+                glwe_dimension,
+                bsk_level,
+                bsk_base_log,
+                1e-20,
+                Parallelism::No,
+                csprng,
+            );
+            let mut fourier_bsk = vec![
+                c64::default();
+                concrete_cpu_fourier_bootstrap_key_size_u64(
+                    bsk_level,
+                    glwe_dimension,
+                    polynomial_size,
+                    small_lwe_dimension,
+                )
+            ];
+            let mut mem = GlobalPodBuffer::new(StackReq::any_of([
+                convert_standard_lwe_bootstrap_key_to_fourier_mem_optimized_requirement(
+                    fft.as_view(),
+                )
+                .unwrap(),
+                programmable_bootstrap_lwe_ciphertext_mem_optimized_requirement::<u32>(
+                    GlweDimension(glwe_dimension).to_glwe_size(),
+                    PolynomialSize(polynomial_size),
+                    fft.as_view(),
+                )
+                .unwrap(),
+            ]));
+            concrete_cpu_bootstrap_key_convert_u32_to_fourier(
+                bsk.as_ptr(),
+                fourier_bsk.as_mut_ptr(),
+                bsk_level,
+                bsk_base_log,
+                glwe_dimension,
+                polynomial_size,
+                small_lwe_dimension,
+                &fft,
+                mem.as_mut_ptr(),
+                mem.len(),
+            );
+
+            // The identity table, each box being rotated by half its width so that the noise
+            // rounds to the nearest message, wrapping negacyclically around the first one
+            let box_size = polynomial_size / message_count as usize;
+            let mut accumulator = vec![0_u32; (glwe_dimension + 1) * polynomial_size];
+            for (i, coefficient) in accumulator[big_lwe_dimension..].iter_mut().enumerate() {
+                let message = ((i + box_size / 2) / box_size) as u32 % message_count;
+                *coefficient = message * delta;
+            }
+
+            for message in 0..message_count {
+                let mut big_ct = vec![0_u32; big_lwe_dimension + 1];
+                concrete_cpu_encrypt_lwe_ciphertext_u32(
+                    big_sk.as_ptr(),
+                    big_ct.as_mut_ptr(),
+                    message * delta,
+                    big_lwe_dimension,
+                    1e-20,
+                    csprng,
+                );
+                let mut small_ct = vec![0_u32; small_lwe_dimension + 1];
+                concrete_cpu_keyswitch_lwe_ciphertext_u32(
+                    small_ct.as_mut_ptr(),
+                    big_ct.as_ptr(),
+                    ksk.as_ptr(),
+                    ksk_level,
+                    ksk_base_log,
+                    big_lwe_dimension,
+                    small_lwe_dimension,
+                );
+                concrete_cpu_bootstrap_lwe_ciphertext_u32(
+                    big_ct.as_mut_ptr(),
+                    small_ct.as_ptr(),
+                    accumulator.as_ptr(),
+                    fourier_bsk.as_ptr(),
+                    bsk_level,
+                    bsk_base_log,
+                    glwe_dimension,
+                    polynomial_size,
+                    small_lwe_dimension,
+                    &fft,
+                    mem.as_mut_ptr(),
+                    mem.len(),
+                );
+                let mut decrypted = 0_u32;
+                concrete_cpu_decrypt_lwe_ciphertext_u32(
+                    big_sk.as_ptr(),
+                    big_ct.as_ptr(),
+                    big_lwe_dimension,
+                    &mut decrypted,
+                );
+                assert_eq!(decrypted.wrapping_add(delta / 2) / delta, message);
+            }
+        }
+    }
 }
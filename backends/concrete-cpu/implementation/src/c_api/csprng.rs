@@ -1,11 +1,15 @@
 use std::io::Read;
 
 use super::types::{Csprng, EncCsprng, SecCsprng, Uint128};
-use concrete_csprng::generators::SoftwareRandomGenerator;
+use crate::implementation::generator::DynamicRandomGenerator;
 use concrete_csprng::seeders::Seed;
 use libc::c_int;
+use super::utils::nounwind;
 use tfhe::core_crypto::commons::math::random::RandomGenerator;
-use tfhe::core_crypto::prelude::{EncryptionRandomGenerator, SecretRandomGenerator};
+use tfhe::core_crypto::prelude::{
+    encrypt_lwe_ciphertext, CiphertextModulus, EncryptionRandomGenerator, LweCiphertext,
+    LweDimension, LweSecretKey, LweSize, Plaintext, SecretRandomGenerator, Variance,
+};
 use tfhe::core_crypto::seeders::Seeder;
 
 pub struct DynamicSeeder;
@@ -31,57 +35,57 @@ pub fn new_dyn_seeder() -> Box<dyn Seeder> {
 }
 
 #[no_mangle]
-pub static CSPRNG_SIZE: usize = core::mem::size_of::<RandomGenerator<SoftwareRandomGenerator>>();
+pub static CSPRNG_SIZE: usize = core::mem::size_of::<RandomGenerator<DynamicRandomGenerator>>();
 
 #[no_mangle]
-pub static CSPRNG_ALIGN: usize = core::mem::align_of::<RandomGenerator<SoftwareRandomGenerator>>();
+pub static CSPRNG_ALIGN: usize = core::mem::align_of::<RandomGenerator<DynamicRandomGenerator>>();
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_construct_csprng(mem: *mut Csprng, seed: Uint128) {
-    let mem = mem as *mut RandomGenerator<SoftwareRandomGenerator>;
+    let mem = mem as *mut RandomGenerator<DynamicRandomGenerator>;
     let seed = Seed(u128::from_le_bytes(seed.little_endian_bytes));
     mem.write(RandomGenerator::new(seed));
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_destroy_csprng(mem: *mut Csprng) {
-    core::ptr::drop_in_place(mem as *mut RandomGenerator<SoftwareRandomGenerator>);
+    core::ptr::drop_in_place(mem as *mut RandomGenerator<DynamicRandomGenerator>);
 }
 
 #[no_mangle]
 pub static SECRET_CSPRNG_SIZE: usize =
-    core::mem::size_of::<SecretRandomGenerator<SoftwareRandomGenerator>>();
+    core::mem::size_of::<SecretRandomGenerator<DynamicRandomGenerator>>();
 
 #[no_mangle]
 pub static SECRET_CSPRNG_ALIGN: usize =
-    core::mem::align_of::<SecretRandomGenerator<SoftwareRandomGenerator>>();
+    core::mem::align_of::<SecretRandomGenerator<DynamicRandomGenerator>>();
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_construct_secret_csprng(mem: *mut SecCsprng, seed: Uint128) {
-    let mem = mem as *mut SecretRandomGenerator<SoftwareRandomGenerator>;
+    let mem = mem as *mut SecretRandomGenerator<DynamicRandomGenerator>;
     let seed = Seed(u128::from_le_bytes(seed.little_endian_bytes));
     mem.write(SecretRandomGenerator::new(seed));
 }
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_destroy_secret_csprng(mem: *mut SecCsprng) {
-    core::ptr::drop_in_place(mem as *mut SecretRandomGenerator<SoftwareRandomGenerator>);
+    core::ptr::drop_in_place(mem as *mut SecretRandomGenerator<DynamicRandomGenerator>);
 }
 
 #[no_mangle]
 pub static ENCRYPTION_CSPRNG_SIZE: usize =
-    core::mem::size_of::<EncryptionRandomGenerator<SoftwareRandomGenerator>>();
+    core::mem::size_of::<EncryptionRandomGenerator<DynamicRandomGenerator>>();
 
 #[no_mangle]
 pub static ENCRYPTION_CSPRNG_ALIGN: usize =
-    core::mem::align_of::<EncryptionRandomGenerator<SoftwareRandomGenerator>>();
+    core::mem::align_of::<EncryptionRandomGenerator<DynamicRandomGenerator>>();
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_construct_encryption_csprng(
     mem: *mut EncCsprng,
     seed: Uint128,
 ) {
-    let mem = mem as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>;
+    let mem = mem as *mut EncryptionRandomGenerator<DynamicRandomGenerator>;
     let seed = Seed(u128::from_le_bytes(seed.little_endian_bytes));
     let mut boxed_seeder = new_dyn_seeder();
     let seeder = boxed_seeder.as_mut();
@@ -90,7 +94,31 @@ pub unsafe extern "C" fn concrete_cpu_construct_encryption_csprng(
 
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_destroy_encryption_csprng(mem: *mut EncCsprng) {
-    core::ptr::drop_in_place(mem as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>);
+    core::ptr::drop_in_place(mem as *mut EncryptionRandomGenerator<DynamicRandomGenerator>);
+}
+
+/// Constructs in `mem` an encryption csprng seeded from the mask of `csprng`, so that the child
+/// can be used concurrently with its parent while staying reproducible from the parent seed.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fork_encryption_csprng(
+    csprng: *mut EncCsprng,
+    mem: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let csprng = &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>);
+        // the mask of an encryption under a zero key is two words of the mask stream
+        let key = LweSecretKey::new_empty_key(0_u64, LweDimension(2));
+        let mut ct = LweCiphertext::new(0_u64, LweSize(3), CiphertextModulus::new_native());
+        encrypt_lwe_ciphertext(&key, &mut ct, Plaintext(0), Variance(0.0), csprng);
+        let mask = ct.get_mask();
+        let mask = mask.as_ref();
+        let seed = Seed(mask[0] as u128 | ((mask[1] as u128) << 64));
+
+        let mem = mem as *mut EncryptionRandomGenerator<DynamicRandomGenerator>;
+        let mut boxed_seeder = new_dyn_seeder();
+        let seeder = boxed_seeder.as_mut();
+        mem.write(EncryptionRandomGenerator::new(seed, seeder));
+    });
 }
 
 // Randomly fill a uint128.
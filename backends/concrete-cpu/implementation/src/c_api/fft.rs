@@ -1,5 +1,7 @@
 use tfhe::core_crypto::commons::parameters::PolynomialSize;
 
+use crate::c_api::types::SimdPath;
+
 type FftImpl = tfhe::core_crypto::fft_impl::fft64::math::fft::Fft;
 
 pub struct Fft {
@@ -25,3 +27,31 @@ pub unsafe extern "C" fn concrete_cpu_construct_concrete_fft(
 pub unsafe extern "C" fn concrete_cpu_destroy_concrete_fft(mem: *mut Fft) {
     core::ptr::drop_in_place(mem);
 }
+
+/// Returns the SIMD instruction set selected at runtime for the FFT, and thus for the external
+/// products of the bootstrap and the cmux trees.
+///
+/// The kernels are dispatched with CPUID at the first use. AVX-512 kernels are only available
+/// when built with the `nightly` feature.
+pub fn simd_path() -> SimdPath {
+    #[cfg(all(feature = "std", any(target_arch = "x86", target_arch = "x86_64")))]
+    {
+        #[cfg(feature = "nightly")]
+        if pulp::x86::V4::try_new().is_some() {
+            return SimdPath::SimdAvx512;
+        }
+        if pulp::x86::V3::try_new().is_some() {
+            return SimdPath::SimdAvx2;
+        }
+    }
+    #[cfg(all(feature = "std", target_arch = "aarch64"))]
+    if std::arch::is_aarch64_feature_detected!("neon") {
+        return SimdPath::SimdNeon;
+    }
+    SimdPath::SimdScalar
+}
+
+#[no_mangle]
+pub extern "C" fn concrete_cpu_simd_path() -> SimdPath {
+    simd_path()
+}
@@ -1,10 +1,16 @@
-use concrete_csprng::generators::SoftwareRandomGenerator;
+use crate::implementation::generator::DynamicRandomGenerator;
+use concrete_fft::c64;
+use dyn_stack::{GlobalPodBuffer, PodStack, StackReq};
+use tfhe::core_crypto::algorithms::slice_algorithms::slice_wrapping_sub_scalar_mul_assign;
+use tfhe::core_crypto::commons::math::decomposition::SignedDecomposer;
 use tfhe::core_crypto::commons::math::random::{CompressionSeed, Seed};
+use tfhe::core_crypto::fft_impl::fft64::math::polynomial::FourierPolynomial;
 use tfhe::core_crypto::prelude::*;
 
+use super::bootstrap::decompose_level;
 use super::csprng::new_dyn_seeder;
 use super::types::{EncCsprng, Uint128};
-use super::utils::nounwind;
+use super::utils::{nounwind, secret_key_u32};
 use crate::c_api::types::Parallelism;
 
 #[no_mangle]
@@ -54,7 +60,7 @@ pub unsafe extern "C" fn concrete_cpu_init_lwe_keyswitch_key_u64(
             &output_key,
             &mut ksk,
             Variance::from_variance(variance),
-            &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+            &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
         )
     });
 }
@@ -166,13 +172,13 @@ pub unsafe extern "C" fn concrete_cpu_decompress_seeded_lwe_keyswitch_key_u64(
         );
         match parallelism {
             Parallelism::No => {
-                decompress_seeded_lwe_keyswitch_key::<_, _, _, SoftwareRandomGenerator>(
+                decompress_seeded_lwe_keyswitch_key::<_, _, _, DynamicRandomGenerator>(
                     &mut output_ksk,
                     &input_ksk,
                 )
             }
             Parallelism::Rayon => {
-                par_decompress_seeded_lwe_keyswitch_key::<_, _, _, SoftwareRandomGenerator>(
+                par_decompress_seeded_lwe_keyswitch_key::<_, _, _, DynamicRandomGenerator>(
                     &mut output_ksk,
                     &input_ksk,
                 )
@@ -193,18 +199,90 @@ pub unsafe extern "C" fn concrete_cpu_keyswitch_lwe_ciphertext_u64(
     decomposition_base_log: usize,
     input_dimension: usize,
     output_dimension: usize,
+) {
+    // A single keyswitch is a batch of one, so that it also goes through the kernels specialized
+    // for the level count.
+    concrete_cpu_batched_keyswitch_lwe_ciphertext_u64(
+        ct_out,
+        ct_in,
+        1,
+        keyswitch_key,
+        decomposition_level_count,
+        decomposition_base_log,
+        input_dimension,
+        output_dimension,
+    )
+}
+
+/// Generates a keyswitch key of the 32 bits torus, of
+/// `concrete_cpu_keyswitch_key_size_u64` elements.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_init_lwe_keyswitch_key_u32(
+    // keyswitch key
+    lwe_ksk: *mut u32,
+    // secret keys
+    input_lwe_sk: *const u64,
+    output_lwe_sk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_lwe_dimension: usize,
+    // keyswitch key parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    // noise parameters
+    variance: f64,
+    // csprng
+    csprng: *mut EncCsprng,
 ) {
     nounwind(|| {
-        let mut ct_out = LweCiphertext::from_container(
-            core::slice::from_raw_parts_mut(ct_out, output_dimension + 1),
-            CiphertextModulus::new_native(),
-        );
-        let ct_in = LweCiphertext::from_container(
-            core::slice::from_raw_parts(ct_in, input_dimension + 1),
+        let input_key = LweSecretKey::from_container(secret_key_u32(
+            core::slice::from_raw_parts(input_lwe_sk, input_lwe_dimension),
+        ));
+        let output_key = LweSecretKey::from_container(secret_key_u32(
+            core::slice::from_raw_parts(output_lwe_sk, output_lwe_dimension),
+        ));
+        let mut ksk = LweKeyswitchKey::from_container(
+            core::slice::from_raw_parts_mut(
+                lwe_ksk,
+                concrete_cpu_keyswitch_key_size_u64(
+                    decomposition_level_count,
+                    input_lwe_dimension,
+                    output_lwe_dimension,
+                ),
+            ),
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+            LweDimension(output_lwe_dimension).to_lwe_size(),
             CiphertextModulus::new_native(),
         );
 
-        let keyswitch_key = LweKeyswitchKey::from_container(
+        generate_lwe_keyswitch_key(
+            &input_key,
+            &output_key,
+            &mut ksk,
+            Variance::from_variance(variance),
+            &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
+        )
+    });
+}
+
+/// Keyswitches a ciphertext of the 32 bits torus. Its elements are half the size of the ones of
+/// `concrete_cpu_keyswitch_lwe_ciphertext_u64`, which halves the memory traffic of the key.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_keyswitch_lwe_ciphertext_u32(
+    // ciphertexts
+    ct_out: *mut u32,
+    ct_in: *const u32,
+    // keyswitch key
+    keyswitch_key: *const u32,
+    // keyswitch parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    input_dimension: usize,
+    output_dimension: usize,
+) {
+    nounwind(|| {
+        let ksk = LweKeyswitchKey::from_container(
             core::slice::from_raw_parts(
                 keyswitch_key,
                 concrete_cpu_keyswitch_key_size_u64(
@@ -218,7 +296,166 @@ pub unsafe extern "C" fn concrete_cpu_keyswitch_lwe_ciphertext_u64(
             LweDimension(output_dimension).to_lwe_size(),
             CiphertextModulus::new_native(),
         );
-        keyswitch_lwe_ciphertext(&keyswitch_key, &ct_in, &mut ct_out);
+        let ct_in = LweCiphertext::from_container(
+            core::slice::from_raw_parts(ct_in, input_dimension + 1),
+            CiphertextModulus::new_native(),
+        );
+        let mut ct_out = LweCiphertext::from_container(
+            core::slice::from_raw_parts_mut(ct_out, output_dimension + 1),
+            CiphertextModulus::new_native(),
+        );
+        keyswitch_lwe_ciphertext(&ksk, &ct_in, &mut ct_out);
+    })
+}
+
+/// Number of ciphertexts keyswitched together by the batched keyswitch.
+const BATCHED_KEYSWITCH_TILE_SIZE: usize = 16;
+
+/// Size in bytes of the slice of the keyswitch key applied to a tile of ciphertexts before moving
+/// to the next one. It is meant to fit in the L2 cache along with the outputs of the tile.
+const BATCHED_KEYSWITCH_KEY_CHUNK_BYTES: usize = 256 * 1024;
+
+/// Subtracts from `ct_out` the key ciphertexts of `key_chunk` multiplied by the decompositions of
+/// the mask elements of `ct_in_chunk`, with `LEVELS` levels per element.
+///
+/// The level count is fixed by the optimizer when the circuit is compiled, so the kernels for the
+/// usual level counts are monomorphized: the decomposition of an element is kept in registers and
+/// the loop over its levels is unrolled.
+fn keyswitch_key_chunk<const LEVELS: usize>(
+    ct_out: &mut [u64],
+    ct_in_chunk: &[u64],
+    key_chunk: &[u64],
+    decomposer: &SignedDecomposer<u64>,
+) {
+    let output_size = ct_out.len();
+    for (key_block, &input_mask_element) in key_chunk
+        .chunks_exact(LEVELS * output_size)
+        .zip(ct_in_chunk)
+    {
+        let mut decomposed = [0u64; LEVELS];
+        for (value, term) in decomposed
+            .iter_mut()
+            .zip(decomposer.decompose(input_mask_element))
+        {
+            *value = term.value();
+        }
+        for (level_key_ciphertext, &value) in key_block.chunks_exact(output_size).zip(&decomposed) {
+            slice_wrapping_sub_scalar_mul_assign(ct_out, level_key_ciphertext, value);
+        }
+    }
+}
+
+/// Same as [`keyswitch_key_chunk`] for any level count.
+fn keyswitch_key_chunk_dyn(
+    ct_out: &mut [u64],
+    ct_in_chunk: &[u64],
+    key_chunk: &[u64],
+    decomposer: &SignedDecomposer<u64>,
+) {
+    let output_size = ct_out.len();
+    let key_block_size = decomposer.level_count().0 * output_size;
+    for (key_block, &input_mask_element) in key_chunk.chunks_exact(key_block_size).zip(ct_in_chunk)
+    {
+        let decomposition_iter = decomposer.decompose(input_mask_element);
+        for (level_key_ciphertext, decomposed) in
+            key_block.chunks_exact(output_size).zip(decomposition_iter)
+        {
+            slice_wrapping_sub_scalar_mul_assign(ct_out, level_key_ciphertext, decomposed.value());
+        }
+    }
+}
+
+type KeyswitchKeyChunkFn = fn(&mut [u64], &[u64], &[u64], &SignedDecomposer<u64>);
+
+/// Returns the kernel specialized for `decomposition_level_count`, if any, and the generic one
+/// otherwise.
+fn select_keyswitch_kernel(decomposition_level_count: usize) -> KeyswitchKeyChunkFn {
+    match decomposition_level_count {
+        1 => keyswitch_key_chunk::<1>,
+        2 => keyswitch_key_chunk::<2>,
+        3 => keyswitch_key_chunk::<3>,
+        4 => keyswitch_key_chunk::<4>,
+        5 => keyswitch_key_chunk::<5>,
+        6 => keyswitch_key_chunk::<6>,
+        _ => keyswitch_key_chunk_dyn,
+    }
+}
+
+/// Keyswitches `ct_count` ciphertexts stored contiguously in `ct_in_vec`, writing them contiguously
+/// in `ct_out_vec`.
+///
+/// The keyswitch key is stored with the key ciphertexts of each input coefficient next to each
+/// other, so the key is walked in chunks of consecutive input coefficients. Each chunk is applied
+/// to all the ciphertexts of a tile while it is hot in cache, instead of streaming the whole key
+/// once per ciphertext.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_batched_keyswitch_lwe_ciphertext_u64(
+    // ciphertexts
+    ct_out_vec: *mut u64,
+    ct_in_vec: *const u64,
+    ct_count: usize,
+    // keyswitch key
+    keyswitch_key: *const u64,
+    // keyswitch parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    input_dimension: usize,
+    output_dimension: usize,
+) {
+    nounwind(|| {
+        let input_size = input_dimension + 1;
+        let output_size = output_dimension + 1;
+        let ct_in_vec = core::slice::from_raw_parts(ct_in_vec, ct_count * input_size);
+        let ct_out_vec = core::slice::from_raw_parts_mut(ct_out_vec, ct_count * output_size);
+        let keyswitch_key = core::slice::from_raw_parts(
+            keyswitch_key,
+            concrete_cpu_keyswitch_key_size_u64(
+                decomposition_level_count,
+                input_dimension,
+                output_dimension,
+            ),
+        );
+
+        let decomposer = SignedDecomposer::<u64>::new(
+            DecompositionBaseLog(decomposition_base_log),
+            DecompositionLevelCount(decomposition_level_count),
+        );
+        let key_block_size = decomposition_level_count * output_size;
+        let chunk_inputs =
+            (BATCHED_KEYSWITCH_KEY_CHUNK_BYTES / (key_block_size * 8)).clamp(1, input_dimension);
+        let kernel = select_keyswitch_kernel(decomposition_level_count);
+
+        for (tile_in, tile_out) in ct_in_vec
+            .chunks(BATCHED_KEYSWITCH_TILE_SIZE * input_size)
+            .zip(ct_out_vec.chunks_mut(BATCHED_KEYSWITCH_TILE_SIZE * output_size))
+        {
+            // The outputs start as trivial encryptions of the input bodies.
+            for (ct_in, ct_out) in tile_in
+                .chunks_exact(input_size)
+                .zip(tile_out.chunks_exact_mut(output_size))
+            {
+                ct_out.fill(0);
+                ct_out[output_dimension] = ct_in[input_dimension];
+            }
+
+            for chunk_start in (0..input_dimension).step_by(chunk_inputs) {
+                let chunk_end = (chunk_start + chunk_inputs).min(input_dimension);
+                let key_chunk =
+                    &keyswitch_key[chunk_start * key_block_size..chunk_end * key_block_size];
+
+                for (ct_in, ct_out) in tile_in
+                    .chunks_exact(input_size)
+                    .zip(tile_out.chunks_exact_mut(output_size))
+                {
+                    kernel(
+                        ct_out,
+                        &ct_in[chunk_start..chunk_end],
+                        key_chunk,
+                        &decomposer,
+                    );
+                }
+            }
+        }
     })
 }
 
@@ -245,3 +482,397 @@ pub unsafe extern "C" fn concrete_cpu_seeded_keyswitch_key_size_u64(
             decomposition_level_count,
         ))
 }
+
+/// Number of chunks of the input mask of a fast keyswitch, one per polynomial of the input key.
+fn fast_keyswitch_chunk_count(input_dimension: usize, output_polynomial_size: usize) -> usize {
+    (input_dimension + output_polynomial_size - 1) / output_polynomial_size
+}
+
+/// Size of a fast keyswitch key, converting LWE ciphertexts of `input_dimension` to the sample
+/// extraction of GLWE ciphertexts of `output_glwe_dimension` polynomials of
+/// `output_polynomial_size` coefficients.
+///
+/// The input key is split in chunks of `output_polynomial_size` coefficients, the last one padded
+/// with zeros, and the key has for each chunk and each level a GLWE encryption of the chunk seen
+/// as a polynomial.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fast_keyswitch_key_size_u64(
+    decomposition_level_count: usize,
+    input_dimension: usize,
+    output_glwe_dimension: usize,
+    output_polynomial_size: usize,
+) -> usize {
+    fast_keyswitch_chunk_count(input_dimension, output_polynomial_size)
+        * decomposition_level_count
+        * (output_glwe_dimension + 1)
+        * output_polynomial_size
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fourier_fast_keyswitch_key_size_u64(
+    decomposition_level_count: usize,
+    input_dimension: usize,
+    output_glwe_dimension: usize,
+    output_polynomial_size: usize,
+) -> usize {
+    concrete_cpu_fast_keyswitch_key_size_u64(
+        decomposition_level_count,
+        input_dimension,
+        output_glwe_dimension,
+        output_polynomial_size,
+    ) / 2
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_init_lwe_fast_keyswitch_key_u64(
+    // keyswitch key
+    fast_ksk: *mut u64,
+    // secret keys
+    input_lwe_sk: *const u64,
+    output_glwe_sk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_glwe_dimension: usize,
+    output_polynomial_size: usize,
+    // keyswitch key parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    // noise parameters
+    variance: f64,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        assert!(decomposition_base_log * decomposition_level_count < 64);
+        let input_key = core::slice::from_raw_parts(input_lwe_sk, input_lwe_dimension);
+        let output_key = GlweSecretKey::from_container(
+            core::slice::from_raw_parts(
+                output_glwe_sk,
+                output_glwe_dimension * output_polynomial_size,
+            ),
+            PolynomialSize(output_polynomial_size),
+        );
+        let fast_ksk = core::slice::from_raw_parts_mut(
+            fast_ksk,
+            concrete_cpu_fast_keyswitch_key_size_u64(
+                decomposition_level_count,
+                input_lwe_dimension,
+                output_glwe_dimension,
+                output_polynomial_size,
+            ),
+        );
+        let generator = &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>);
+
+        let glwe_len = (output_glwe_dimension + 1) * output_polynomial_size;
+        let mut plaintexts = vec![0_u64; output_polynomial_size];
+        for (chunk_ksk, key_chunk) in fast_ksk
+            .chunks_exact_mut(decomposition_level_count * glwe_len)
+            .zip(input_key.chunks(output_polynomial_size))
+        {
+            for (level, glwe) in chunk_ksk.chunks_exact_mut(glwe_len).enumerate() {
+                let shift = 64 - decomposition_base_log * (level + 1);
+                plaintexts.fill(0);
+                for (plaintext, &s) in plaintexts.iter_mut().zip(key_chunk) {
+                    *plaintext = s << shift;
+                }
+                encrypt_glwe_ciphertext(
+                    &output_key,
+                    &mut GlweCiphertext::from_container(
+                        glwe,
+                        PolynomialSize(output_polynomial_size),
+                        CiphertextModulus::new_native(),
+                    ),
+                    &PlaintextList::from_container(&*plaintexts),
+                    Variance::from_variance(variance),
+                    generator,
+                );
+            }
+        }
+    });
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fast_keyswitch_key_convert_u64_to_fourier(
+    // keyswitch key
+    standard_fast_ksk: *const u64,
+    fourier_fast_ksk: *mut c64,
+    // keyswitch parameters
+    decomposition_level_count: usize,
+    input_dimension: usize,
+    output_glwe_dimension: usize,
+    output_polynomial_size: usize,
+    // side resources
+    fft: *const Fft,
+) {
+    nounwind(|| {
+        let fft = (*fft).as_view();
+        let size = concrete_cpu_fast_keyswitch_key_size_u64(
+            decomposition_level_count,
+            input_dimension,
+            output_glwe_dimension,
+            output_polynomial_size,
+        );
+        let standard = core::slice::from_raw_parts(standard_fast_ksk, size);
+        let fourier = core::slice::from_raw_parts_mut(fourier_fast_ksk, size / 2);
+
+        let mut mem = GlobalPodBuffer::new(fft.forward_scratch().unwrap());
+        for (poly, fourier_poly) in standard
+            .chunks_exact(output_polynomial_size)
+            .zip(fourier.chunks_exact_mut(output_polynomial_size / 2))
+        {
+            fft.forward_as_torus(
+                FourierPolynomial { data: fourier_poly },
+                Polynomial::from_container(poly),
+                PodStack::new(&mut mem),
+            );
+        }
+    });
+}
+
+/// Keyswitches a ciphertext with a fast keyswitch key in the Fourier domain, writing an LWE
+/// ciphertext of dimension `output_glwe_dimension * output_polynomial_size`.
+///
+/// Each chunk of the input mask is turned into a polynomial whose product with the chunk of the
+/// input key has their inner product as constant coefficient. The polynomials are keyswitched
+/// together as the masks of a GLWE ciphertext, with one forward FFT per level and chunk and one
+/// backward FFT per output polynomial, and the constant coefficient is sample extracted. This
+/// costs about `input_dimension * level_count * (log2(N) + output_glwe_dimension + 1)`
+/// operations instead of the `input_dimension * level_count * (output_dimension + 1)` of the
+/// classical keyswitch. No scratch is needed, the buffers being allocated once per call.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_fast_keyswitch_lwe_ciphertext_u64(
+    // ciphertexts
+    ct_out: *mut u64,
+    ct_in: *const u64,
+    // keyswitch key
+    fourier_fast_ksk: *const c64,
+    // keyswitch parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    input_dimension: usize,
+    output_glwe_dimension: usize,
+    output_polynomial_size: usize,
+    // side resources
+    fft: *const Fft,
+) {
+    nounwind(|| {
+        assert!(decomposition_base_log * decomposition_level_count < 64);
+        let polynomial_size = output_polynomial_size;
+        let fourier_size = polynomial_size / 2;
+        let glwe_size = output_glwe_dimension + 1;
+        let fft = (*fft).as_view();
+
+        let fourier_ksk = core::slice::from_raw_parts(
+            fourier_fast_ksk,
+            concrete_cpu_fourier_fast_keyswitch_key_size_u64(
+                decomposition_level_count,
+                input_dimension,
+                output_glwe_dimension,
+                output_polynomial_size,
+            ),
+        );
+        let ct_in = core::slice::from_raw_parts(ct_in, input_dimension + 1);
+
+        let scratch = StackReq::try_any_of([
+            fft.forward_scratch().unwrap(),
+            fft.backward_scratch().unwrap(),
+        ])
+        .unwrap();
+        let mut mem = GlobalPodBuffer::new(scratch);
+        let mut mask = vec![0_u64; polynomial_size];
+        let mut digits = vec![0_u64; polynomial_size];
+        let mut fourier_digits = vec![c64::default(); fourier_size];
+        let mut fourier_acc = vec![c64::default(); glwe_size * fourier_size];
+
+        for (chunk_ksk, chunk) in fourier_ksk
+            .chunks_exact(decomposition_level_count * glwe_size * fourier_size)
+            .zip(ct_in[..input_dimension].chunks(polynomial_size))
+        {
+            // In the negacyclic ring, the constant coefficient of A * S is
+            // A[0] * S[0] - sum(A[N - j] * S[j]).
+            mask.fill(0);
+            mask[0] = chunk[0];
+            for (j, &a) in chunk.iter().enumerate().skip(1) {
+                mask[polynomial_size - j] = a.wrapping_neg();
+            }
+            for (level, level_ksk) in chunk_ksk.chunks_exact(glwe_size * fourier_size).enumerate() {
+                decompose_level(
+                    &mask,
+                    &mut digits,
+                    decomposition_base_log,
+                    decomposition_level_count,
+                    level + 1,
+                );
+                fft.forward_as_integer(
+                    FourierPolynomial {
+                        data: &mut *fourier_digits,
+                    },
+                    Polynomial::from_container(&*digits),
+                    PodStack::new(&mut mem),
+                );
+                for (out, key) in fourier_acc
+                    .chunks_exact_mut(fourier_size)
+                    .zip(level_ksk.chunks_exact(fourier_size))
+                {
+                    for ((out, digit), key) in out.iter_mut().zip(&fourier_digits).zip(key) {
+                        *out += digit * key;
+                    }
+                }
+            }
+        }
+
+        // The output is the trivial encryption of the body minus the keyswitched masks.
+        let mut glwe = vec![0_u64; glwe_size * polynomial_size];
+        for (poly, fourier_poly) in glwe
+            .chunks_exact_mut(polynomial_size)
+            .zip(fourier_acc.chunks_exact(fourier_size))
+        {
+            fft.add_backward_as_torus(
+                Polynomial::from_container(poly),
+                FourierPolynomial { data: fourier_poly },
+                PodStack::new(&mut mem),
+            );
+        }
+        for value in &mut glwe {
+            *value = value.wrapping_neg();
+        }
+        let body = &mut glwe[output_glwe_dimension * polynomial_size];
+        *body = body.wrapping_add(ct_in[input_dimension]);
+
+        let glwe = GlweCiphertext::from_container(
+            &*glwe,
+            PolynomialSize(polynomial_size),
+            CiphertextModulus::new_native(),
+        );
+        let mut lwe_out = LweCiphertext::from_container(
+            core::slice::from_raw_parts_mut(ct_out, output_glwe_dimension * polynomial_size + 1),
+            CiphertextModulus::new_native(),
+        );
+        extract_lwe_sample_from_glwe_ciphertext(&glwe, &mut lwe_out, MonomialDegree(0));
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn parallel_decompression_is_deterministic() {
+        let (input_lwe_dimension, output_lwe_dimension) = (64, 16);
+        let (level, base_log) = (3, 4);
+        let input_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let output_sk: Vec<u64> = (0..output_lwe_dimension as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let seed = Uint128 {
+            little_endian_bytes: [5; 16],
+        };
+        unsafe {
+            let mut seeded_ksk =
+                vec![0_u64; concrete_cpu_seeded_keyswitch_key_size_u64(level, input_lwe_dimension)];
+            concrete_cpu_init_seeded_lwe_keyswitch_key_u64(
+                seeded_ksk.as_mut_ptr(),
+                input_sk.as_ptr(),
+                output_sk.as_ptr(),
+                input_lwe_dimension,
+                output_lwe_dimension,
+                level,
+                base_log,
+                seed,
+                1e-20,
+            );
+            let decompress = |parallelism| {
+                let mut ksk = vec![
+                    0_u64;
+                    concrete_cpu_keyswitch_key_size_u64(
+                        level,
+                        input_lwe_dimension,
+                        output_lwe_dimension,
+                    )
+                ];
+                concrete_cpu_decompress_seeded_lwe_keyswitch_key_u64(
+                    ksk.as_mut_ptr(),
+                    seeded_ksk.as_ptr(),
+                    input_lwe_dimension,
+                    output_lwe_dimension,
+                    level,
+                    base_log,
+                    seed,
+                    parallelism,
+                );
+                ksk
+            };
+            assert_eq!(decompress(Parallelism::No), decompress(Parallelism::Rayon));
+        }
+    }
+
+    #[test]
+    fn fast_keyswitch_keeps_the_phase() {
+        // The last chunk of the input is padded.
+        let (input_lwe_dimension, output_glwe_dimension, output_polynomial_size) = (600, 2, 256);
+        let (level, base_log) = (3, 10);
+        let input_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let output_sk: Vec<u64> = (0..(output_glwe_dimension * output_polynomial_size) as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let phase = |ct: &[u64], sk: &[u64]| {
+            sk.iter().zip(ct).fold(ct[sk.len()], |phase, (s, a)| {
+                phase.wrapping_sub(s.wrapping_mul(*a))
+            })
+        };
+        let mut csprng = EncryptionRandomGenerator::<DynamicRandomGenerator>::new(
+            Seed(11),
+            new_dyn_seeder().as_mut(),
+        );
+        let fft = Fft::new(PolynomialSize(output_polynomial_size));
+        unsafe {
+            let size = concrete_cpu_fast_keyswitch_key_size_u64(
+                level,
+                input_lwe_dimension,
+                output_glwe_dimension,
+                output_polynomial_size,
+            );
+            let mut ksk = vec![0_u64; size];
+            concrete_cpu_init_lwe_fast_keyswitch_key_u64(
+                ksk.as_mut_ptr(),
+                input_sk.as_ptr(),
+                output_sk.as_ptr(),
+                input_lwe_dimension,
+                output_glwe_dimension,
+                output_polynomial_size,
+                level,
+                base_log,
+                1e-20,
+                &mut csprng as *mut _ as *mut EncCsprng,
+            );
+            let mut fourier_ksk = vec![c64::default(); size / 2];
+            concrete_cpu_fast_keyswitch_key_convert_u64_to_fourier(
+                ksk.as_ptr(),
+                fourier_ksk.as_mut_ptr(),
+                level,
+                input_lwe_dimension,
+                output_glwe_dimension,
+                output_polynomial_size,
+                &fft,
+            );
+
+            let ct_in: Vec<u64> = (0..=input_lwe_dimension as u64)
+                .map(|i| i.wrapping_mul(0x9e37_79b9_7f4a_7c15))
+                .collect();
+            let mut ct_out = vec![0_u64; output_sk.len() + 1];
+            concrete_cpu_fast_keyswitch_lwe_ciphertext_u64(
+                ct_out.as_mut_ptr(),
+                ct_in.as_ptr(),
+                fourier_ksk.as_ptr(),
+                level,
+                base_log,
+                input_lwe_dimension,
+                output_glwe_dimension,
+                output_polynomial_size,
+                &fft,
+            );
+            let error = phase(&ct_out, &output_sk).wrapping_sub(phase(&ct_in, &input_sk));
+            assert!((error as i64).unsigned_abs() < 1 << 48);
+        }
+    }
+}
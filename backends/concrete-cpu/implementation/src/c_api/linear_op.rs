@@ -122,3 +122,436 @@ pub unsafe extern "C" fn concrete_cpu_negate_lwe_ciphertext_u64(
         });
     })
 }
+
+/// Adds two ciphertexts of the 32 bits torus like `concrete_cpu_add_lwe_ciphertext_u64`.
+///
+/// # Safety
+///
+/// Same as `concrete_cpu_add_lwe_ciphertext_u64`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_add_lwe_ciphertext_u32(
+    ct_out: *mut u32,
+    ct_in0: *const u32,
+    ct_in1: *const u32,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        fn implementation(ct_out: &mut [u32], ct_in0: &[u32], ct_in1: &[u32]) {
+            for ((out, &c0), &c1) in ct_out.iter_mut().zip(ct_in0).zip(ct_in1) {
+                *out = c0.wrapping_add(c1)
+            }
+        }
+
+        let lwe_size = lwe_dimension + 1;
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                slice::from_raw_parts_mut(ct_out, lwe_size),
+                slice::from_raw_parts(ct_in0, lwe_size),
+                slice::from_raw_parts(ct_in1, lwe_size),
+            )
+        });
+    })
+}
+
+/// # Safety
+///
+/// Same as `concrete_cpu_add_plaintext_lwe_ciphertext_u64`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_add_plaintext_lwe_ciphertext_u32(
+    ct_out: *mut u32,
+    ct_in: *const u32,
+    plaintext: u32,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        let lwe_size = lwe_dimension + 1;
+        let ct_out = slice::from_raw_parts_mut(ct_out, lwe_size);
+        ct_out.copy_from_slice(slice::from_raw_parts(ct_in, lwe_size));
+        let last = ct_out.last_mut().unwrap();
+        *last = last.wrapping_add(plaintext);
+    })
+}
+
+/// # Safety
+///
+/// Same as `concrete_cpu_mul_cleartext_lwe_ciphertext_u64`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_mul_cleartext_lwe_ciphertext_u32(
+    ct_out: *mut u32,
+    ct_in: *const u32,
+    cleartext: u32,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        fn implementation(ct_out: &mut [u32], ct_in: &[u32], cleartext: u32) {
+            for (out, &c) in ct_out.iter_mut().zip(ct_in) {
+                *out = c.wrapping_mul(cleartext)
+            }
+        }
+
+        let lwe_size = lwe_dimension + 1;
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                slice::from_raw_parts_mut(ct_out, lwe_size),
+                slice::from_raw_parts(ct_in, lwe_size),
+                cleartext,
+            )
+        });
+    })
+}
+
+/// # Safety
+///
+/// Same as `concrete_cpu_negate_lwe_ciphertext_u64`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_negate_lwe_ciphertext_u32(
+    ct_out: *mut u32,
+    ct_in: *const u32,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        fn implementation(ct_out: &mut [u32], ct_in: &[u32]) {
+            for (out, &c) in ct_out.iter_mut().zip(ct_in) {
+                *out = c.wrapping_neg();
+            }
+        }
+
+        let lwe_size = lwe_dimension + 1;
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                slice::from_raw_parts_mut(ct_out, lwe_size),
+                slice::from_raw_parts(ct_in, lwe_size),
+            )
+        });
+    })
+}
+
+/// Adds `ct_count` pairs of ciphertexts, the ciphertext `i` of a buffer starting `i * stride`
+/// elements after its pointer. The whole batch runs in a single dispatch, so that the loops are
+/// vectorized once for all the ciphertexts.
+///
+/// # Safety
+///
+/// For each `i < ct_count`, `[ct_out + i * out_stride, ct_out + i * out_stride + lwe_dimension +
+/// 1[` must be a valid mutable range, and must not alias any of the ranges of the inputs, the
+/// ranges `[ct_in0 + i * in0_stride, ct_in0 + i * in0_stride + lwe_dimension + 1[` and
+/// `[ct_in1 + i * in1_stride, ct_in1 + i * in1_stride + lwe_dimension + 1[` being valid ranges
+/// for reads.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_batched_add_lwe_ciphertext_u64(
+    ct_out: *mut u64,
+    out_stride: usize,
+    ct_in0: *const u64,
+    in0_stride: usize,
+    ct_in1: *const u64,
+    in1_stride: usize,
+    ct_count: usize,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        unsafe fn implementation(
+            ct_out: *mut u64,
+            out_stride: usize,
+            ct_in0: *const u64,
+            in0_stride: usize,
+            ct_in1: *const u64,
+            in1_stride: usize,
+            ct_count: usize,
+            lwe_size: usize,
+        ) {
+            for i in 0..ct_count {
+                let out = slice::from_raw_parts_mut(ct_out.add(i * out_stride), lwe_size);
+                let in0 = slice::from_raw_parts(ct_in0.add(i * in0_stride), lwe_size);
+                let in1 = slice::from_raw_parts(ct_in1.add(i * in1_stride), lwe_size);
+                for ((out, &c0), &c1) in out.iter_mut().zip(in0).zip(in1) {
+                    *out = c0.wrapping_add(c1)
+                }
+            }
+        }
+
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                ct_out,
+                out_stride,
+                ct_in0,
+                in0_stride,
+                ct_in1,
+                in1_stride,
+                ct_count,
+                lwe_dimension + 1,
+            )
+        });
+    })
+}
+
+/// Adds the plaintext `plaintexts[i * plaintext_stride]` to the ciphertext `i` of the batch, a
+/// zero `plaintext_stride` adding the same plaintext to all of them.
+///
+/// # Safety
+///
+/// Same as [`concrete_cpu_batched_add_lwe_ciphertext_u64`] for `ct_out` and `ct_in`, and
+/// `plaintexts + i * plaintext_stride` must be valid for reads for each `i < ct_count`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_batched_add_plaintext_lwe_ciphertext_u64(
+    ct_out: *mut u64,
+    out_stride: usize,
+    ct_in: *const u64,
+    in_stride: usize,
+    plaintexts: *const u64,
+    plaintext_stride: usize,
+    ct_count: usize,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        unsafe fn implementation(
+            ct_out: *mut u64,
+            out_stride: usize,
+            ct_in: *const u64,
+            in_stride: usize,
+            plaintexts: *const u64,
+            plaintext_stride: usize,
+            ct_count: usize,
+            lwe_size: usize,
+        ) {
+            for i in 0..ct_count {
+                let out = slice::from_raw_parts_mut(ct_out.add(i * out_stride), lwe_size);
+                out.copy_from_slice(slice::from_raw_parts(ct_in.add(i * in_stride), lwe_size));
+                let last = out.last_mut().unwrap();
+                *last = last.wrapping_add(*plaintexts.add(i * plaintext_stride));
+            }
+        }
+
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                ct_out,
+                out_stride,
+                ct_in,
+                in_stride,
+                plaintexts,
+                plaintext_stride,
+                ct_count,
+                lwe_dimension + 1,
+            )
+        });
+    })
+}
+
+/// Multiplies the ciphertext `i` of the batch by the cleartext `cleartexts[i *
+/// cleartext_stride]`, a zero `cleartext_stride` multiplying all of them by the same cleartext.
+///
+/// # Safety
+///
+/// Same as [`concrete_cpu_batched_add_plaintext_lwe_ciphertext_u64`], with the cleartexts in
+/// place of the plaintexts.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_batched_mul_cleartext_lwe_ciphertext_u64(
+    ct_out: *mut u64,
+    out_stride: usize,
+    ct_in: *const u64,
+    in_stride: usize,
+    cleartexts: *const u64,
+    cleartext_stride: usize,
+    ct_count: usize,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        unsafe fn implementation(
+            ct_out: *mut u64,
+            out_stride: usize,
+            ct_in: *const u64,
+            in_stride: usize,
+            cleartexts: *const u64,
+            cleartext_stride: usize,
+            ct_count: usize,
+            lwe_size: usize,
+        ) {
+            for i in 0..ct_count {
+                let out = slice::from_raw_parts_mut(ct_out.add(i * out_stride), lwe_size);
+                let ct = slice::from_raw_parts(ct_in.add(i * in_stride), lwe_size);
+                let cleartext = *cleartexts.add(i * cleartext_stride);
+                for (out, &c) in out.iter_mut().zip(ct) {
+                    *out = c.wrapping_mul(cleartext)
+                }
+            }
+        }
+
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                ct_out,
+                out_stride,
+                ct_in,
+                in_stride,
+                cleartexts,
+                cleartext_stride,
+                ct_count,
+                lwe_dimension + 1,
+            )
+        });
+    })
+}
+
+/// Negates the `ct_count` ciphertexts of the batch.
+///
+/// # Safety
+///
+/// Same as [`concrete_cpu_batched_add_lwe_ciphertext_u64`] for `ct_out` and `ct_in`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_batched_negate_lwe_ciphertext_u64(
+    ct_out: *mut u64,
+    out_stride: usize,
+    ct_in: *const u64,
+    in_stride: usize,
+    ct_count: usize,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        unsafe fn implementation(
+            ct_out: *mut u64,
+            out_stride: usize,
+            ct_in: *const u64,
+            in_stride: usize,
+            ct_count: usize,
+            lwe_size: usize,
+        ) {
+            for i in 0..ct_count {
+                let out = slice::from_raw_parts_mut(ct_out.add(i * out_stride), lwe_size);
+                let ct = slice::from_raw_parts(ct_in.add(i * in_stride), lwe_size);
+                for (out, &c) in out.iter_mut().zip(ct) {
+                    *out = c.wrapping_neg();
+                }
+            }
+        }
+
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                ct_out,
+                out_stride,
+                ct_in,
+                in_stride,
+                ct_count,
+                lwe_dimension + 1,
+            )
+        });
+    })
+}
+
+/// Writes `sum(ct_in[i] * cleartexts[i * cleartext_stride])` over the `ct_count` ciphertexts of
+/// the batch to `ct_out`, fusing the multiplications and the additions of a dot product in a
+/// single pass, without any intermediate ciphertext.
+///
+/// # Safety
+///
+/// `[ct_out, ct_out + lwe_dimension + 1[` must be a valid mutable range, and must not alias any of
+/// the `[ct_in + i * in_stride, ct_in + i * in_stride + lwe_dimension + 1[` ranges, which must be
+/// valid for reads along with `cleartexts + i * cleartext_stride` for each `i < ct_count`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_dot_product_lwe_ciphertext_u64(
+    ct_out: *mut u64,
+    ct_in: *const u64,
+    in_stride: usize,
+    cleartexts: *const u64,
+    cleartext_stride: usize,
+    ct_count: usize,
+    lwe_dimension: usize,
+) {
+    nounwind(|| {
+        #[inline]
+        unsafe fn implementation(
+            ct_out: &mut [u64],
+            ct_in: *const u64,
+            in_stride: usize,
+            cleartexts: *const u64,
+            cleartext_stride: usize,
+            ct_count: usize,
+        ) {
+            let lwe_size = ct_out.len();
+            ct_out.fill(0);
+            for i in 0..ct_count {
+                let ct = slice::from_raw_parts(ct_in.add(i * in_stride), lwe_size);
+                let cleartext = *cleartexts.add(i * cleartext_stride);
+                for (out, &c) in ct_out.iter_mut().zip(ct) {
+                    *out = out.wrapping_add(c.wrapping_mul(cleartext))
+                }
+            }
+        }
+
+        pulp::Arch::new().dispatch(|| {
+            implementation(
+                slice::from_raw_parts_mut(ct_out, lwe_dimension + 1),
+                ct_in,
+                in_stride,
+                cleartexts,
+                cleartext_stride,
+                ct_count,
+            )
+        });
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn batched_ops_match_the_single_ones() {
+        let lwe_dimension = 5;
+        let lwe_size = lwe_dimension + 1;
+        let count = 3;
+        // The inputs are rows of a larger buffer, to check the strides
+        let stride = lwe_size + 2;
+        let ct: Vec<u64> = (0..(count * stride) as u64)
+            .map(|x| x.wrapping_mul(0x9e37_79b9_7f4a_7c15))
+            .collect();
+        let weights = [3u64, u64::MAX, 7];
+
+        let mut batched = vec![0u64; count * lwe_size];
+        let mut single = vec![0u64; lwe_size];
+        unsafe {
+            concrete_cpu_batched_mul_cleartext_lwe_ciphertext_u64(
+                batched.as_mut_ptr(),
+                lwe_size,
+                ct.as_ptr(),
+                stride,
+                weights.as_ptr(),
+                1,
+                count,
+                lwe_dimension,
+            );
+            for i in 0..count {
+                concrete_cpu_mul_cleartext_lwe_ciphertext_u64(
+                    single.as_mut_ptr(),
+                    ct.as_ptr().add(i * stride),
+                    weights[i],
+                    lwe_dimension,
+                );
+                assert_eq!(single, batched[i * lwe_size..(i + 1) * lwe_size]);
+            }
+
+            let mut dot = vec![0u64; lwe_size];
+            concrete_cpu_dot_product_lwe_ciphertext_u64(
+                dot.as_mut_ptr(),
+                ct.as_ptr(),
+                stride,
+                weights.as_ptr(),
+                1,
+                count,
+                lwe_dimension,
+            );
+            let mut sum = batched[..lwe_size].to_vec();
+            for i in 1..count {
+                let row = &batched[i * lwe_size..(i + 1) * lwe_size];
+                for (s, &r) in sum.iter_mut().zip(row) {
+                    *s = s.wrapping_add(r);
+                }
+            }
+            assert_eq!(dot, sum);
+        }
+    }
+}
@@ -1,10 +1,10 @@
-use concrete_csprng::generators::SoftwareRandomGenerator;
+use crate::implementation::generator::DynamicRandomGenerator;
 use tfhe::core_crypto::commons::math::random::{CompressionSeed, Seed};
 use tfhe::core_crypto::prelude::*;
 
 use super::csprng::new_dyn_seeder;
-use super::types::{EncCsprng, SecCsprng, Uint128};
-use super::utils::nounwind;
+use super::types::{EncCsprng, Parallelism, SecCsprng, Uint128};
+use super::utils::{nounwind, read_u128, secret_key_u32, write_u128};
 use core::slice;
 
 #[no_mangle]
@@ -20,7 +20,7 @@ pub unsafe extern "C" fn concrete_cpu_init_secret_key_u64(
         ));
         tfhe::core_crypto::algorithms::generate_binary_lwe_secret_key(
             &mut sk,
-            &mut *(csprng as *mut SecretRandomGenerator<SoftwareRandomGenerator>),
+            &mut *(csprng as *mut SecretRandomGenerator<DynamicRandomGenerator>),
         );
     })
 }
@@ -54,11 +54,151 @@ pub unsafe extern "C" fn concrete_cpu_encrypt_lwe_ciphertext_u64(
             &mut lwe_out,
             Plaintext(input),
             Variance::from_variance(variance),
-            &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+            &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
         );
     });
 }
 
+/// Encrypts a plaintext of the 128 bits torus, the ciphertext being stored as pairs of words as in
+/// `concrete_cpu_bootstrap_lwe_ciphertext_u128`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_encrypt_lwe_ciphertext_u128(
+    // secret key
+    lwe_sk: *const u64,
+    // ciphertext
+    lwe_out: *mut u64,
+    // plaintext
+    input: Uint128,
+    // lwe dimension
+    lwe_dimension: usize,
+    // encryption parameters
+    variance: f64,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let lwe_sk = LweSecretKey::from_container(
+            slice::from_raw_parts(lwe_sk, concrete_cpu_lwe_secret_key_size_u64(lwe_dimension))
+                .iter()
+                .map(|&s| s as u128)
+                .collect::<Vec<_>>(),
+        );
+        let mut ct = LweCiphertext::new(
+            0_u128,
+            LweDimension(lwe_dimension).to_lwe_size(),
+            CiphertextModulus::new_native(),
+        );
+        encrypt_lwe_ciphertext(
+            &lwe_sk,
+            &mut ct,
+            Plaintext(u128::from_le_bytes(input.little_endian_bytes)),
+            Variance::from_variance(variance),
+            &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
+        );
+        write_u128(
+            slice::from_raw_parts_mut(
+                lwe_out,
+                2 * concrete_cpu_lwe_ciphertext_size_u64(lwe_dimension),
+            ),
+            ct.as_ref(),
+        );
+    });
+}
+
+/// Encrypts a plaintext of the 32 bits torus, the ciphertext having as many elements as with
+/// `concrete_cpu_encrypt_lwe_ciphertext_u64`.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_encrypt_lwe_ciphertext_u32(
+    // secret key
+    lwe_sk: *const u64,
+    // ciphertext
+    lwe_out: *mut u32,
+    // plaintext
+    input: u32,
+    // lwe dimension
+    lwe_dimension: usize,
+    // encryption parameters
+    variance: f64,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let lwe_sk = LweSecretKey::from_container(secret_key_u32(slice::from_raw_parts(
+            lwe_sk,
+            concrete_cpu_lwe_secret_key_size_u64(lwe_dimension),
+        )));
+        let mut lwe_out = LweCiphertext::from_container(
+            slice::from_raw_parts_mut(lwe_out, concrete_cpu_lwe_ciphertext_size_u64(lwe_dimension)),
+            CiphertextModulus::new_native(),
+        );
+        encrypt_lwe_ciphertext(
+            &lwe_sk,
+            &mut lwe_out,
+            Plaintext(input),
+            Variance::from_variance(variance),
+            &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
+        );
+    });
+}
+
+/// Encrypts `count` plaintexts in a list of ciphertexts.
+///
+/// Each ciphertext gets its own stream forked from `csprng`, so that the ciphertexts only depend
+/// on the state of `csprng`, whatever the parallelism.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_encrypt_lwe_ciphertext_list_u64(
+    // secret key
+    lwe_sk: *const u64,
+    // ciphertexts
+    lwe_out: *mut u64,
+    // plaintexts
+    input: *const u64,
+    // lwe dimension
+    lwe_dimension: usize,
+    // number of ciphertexts
+    count: usize,
+    // encryption parameters
+    variance: f64,
+    // csprng
+    csprng: *mut EncCsprng,
+    // parallelism
+    parallelism: Parallelism,
+) {
+    nounwind(|| {
+        if count == 0 {
+            return;
+        }
+        let lwe_sk = LweSecretKey::from_container(slice::from_raw_parts(
+            lwe_sk,
+            concrete_cpu_lwe_secret_key_size_u64(lwe_dimension),
+        ));
+        let lwe_size = LweDimension(lwe_dimension).to_lwe_size();
+        let mut lwe_out = LweCiphertextList::from_container(
+            slice::from_raw_parts_mut(lwe_out, count * lwe_size.0),
+            lwe_size,
+            CiphertextModulus::new_native(),
+        );
+        let input = PlaintextList::from_container(slice::from_raw_parts(input, count));
+        let csprng = &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>);
+        match parallelism {
+            Parallelism::No => encrypt_lwe_ciphertext_list(
+                &lwe_sk,
+                &mut lwe_out,
+                &input,
+                Variance::from_variance(variance),
+                csprng,
+            ),
+            Parallelism::Rayon => par_encrypt_lwe_ciphertext_list(
+                &lwe_sk,
+                &mut lwe_out,
+                &input,
+                Variance::from_variance(variance),
+                csprng,
+            ),
+        }
+    });
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_encrypt_seeded_lwe_ciphertext_u64(
     // secret key
@@ -146,7 +286,7 @@ pub unsafe extern "C" fn concrete_cpu_encrypt_ggsw_ciphertext_u64(
             &mut ggsw_out,
             Plaintext(input),
             Variance::from_variance(variance),
-            &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+            &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
         );
     });
 }
@@ -178,6 +318,166 @@ pub unsafe extern "C" fn concrete_cpu_decrypt_lwe_ciphertext_u64(
     });
 }
 
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_decrypt_lwe_ciphertext_u128(
+    // secret key
+    lwe_sk: *const u64,
+    // ciphertext
+    lwe_ct_in: *const u64,
+    // lwe size
+    lwe_dimension: usize,
+    // plaintext
+    plaintext: *mut Uint128,
+) {
+    nounwind(|| {
+        let lwe_sk = LweSecretKey::from_container(
+            slice::from_raw_parts(lwe_sk, concrete_cpu_lwe_secret_key_size_u64(lwe_dimension))
+                .iter()
+                .map(|&s| s as u128)
+                .collect::<Vec<_>>(),
+        );
+        let lwe_ct_in = LweCiphertext::from_container(
+            read_u128(slice::from_raw_parts(
+                lwe_ct_in,
+                2 * concrete_cpu_lwe_ciphertext_size_u64(lwe_dimension),
+            )),
+            CiphertextModulus::new_native(),
+        );
+        let decrypted = decrypt_lwe_ciphertext(&lwe_sk, &lwe_ct_in).0;
+        (*plaintext).little_endian_bytes = decrypted.to_le_bytes();
+    });
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_decrypt_lwe_ciphertext_u32(
+    // secret key
+    lwe_sk: *const u64,
+    // ciphertext
+    lwe_ct_in: *const u32,
+    // lwe size
+    lwe_dimension: usize,
+    // plaintext
+    plaintext: *mut u32,
+) {
+    nounwind(|| {
+        let lwe_sk = LweSecretKey::from_container(secret_key_u32(slice::from_raw_parts(
+            lwe_sk,
+            concrete_cpu_lwe_secret_key_size_u64(lwe_dimension),
+        )));
+        let lwe_ct_in = LweCiphertext::from_container(
+            slice::from_raw_parts(
+                lwe_ct_in,
+                concrete_cpu_lwe_ciphertext_size_u64(lwe_dimension),
+            ),
+            CiphertextModulus::new_native(),
+        );
+        *plaintext = decrypt_lwe_ciphertext(&lwe_sk, &lwe_ct_in).0;
+    });
+}
+
+/// Decrypts a list of `count` ciphertexts.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_decrypt_lwe_ciphertext_list_u64(
+    // secret key
+    lwe_sk: *const u64,
+    // ciphertexts
+    lwe_ct_in: *const u64,
+    // lwe dimension
+    lwe_dimension: usize,
+    // number of ciphertexts
+    count: usize,
+    // plaintexts
+    plaintexts: *mut u64,
+    // parallelism
+    parallelism: Parallelism,
+) {
+    nounwind(|| {
+        if count == 0 {
+            return;
+        }
+        let lwe_sk = LweSecretKey::from_container(slice::from_raw_parts(
+            lwe_sk,
+            concrete_cpu_lwe_secret_key_size_u64(lwe_dimension),
+        ));
+        let lwe_size = concrete_cpu_lwe_ciphertext_size_u64(lwe_dimension);
+        let lwe_ct_in = slice::from_raw_parts(lwe_ct_in, count * lwe_size);
+        let plaintexts = slice::from_raw_parts_mut(plaintexts, count);
+        let decrypt = |(lwe_ct_in, plaintext): (&[u64], &mut u64)| {
+            let lwe_ct_in =
+                LweCiphertext::from_container(lwe_ct_in, CiphertextModulus::new_native());
+            *plaintext = decrypt_lwe_ciphertext(&lwe_sk, &lwe_ct_in).0;
+        };
+        match parallelism {
+            #[cfg(feature = "parallel")]
+            Parallelism::Rayon => {
+                use rayon::prelude::*;
+                lwe_ct_in
+                    .par_chunks_exact(lwe_size)
+                    .zip(plaintexts.par_iter_mut())
+                    .for_each(decrypt);
+            }
+            _ => lwe_ct_in
+                .chunks_exact(lwe_size)
+                .zip(plaintexts.iter_mut())
+                .for_each(decrypt),
+        }
+    });
+}
+
+/// Decompresses a list of `count` seeded ciphertexts, each one stored as its compression seed, in
+/// two little-endian words, followed by its body.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_decompress_seeded_lwe_ciphertext_list_u64(
+    // ciphertexts
+    lwe_out: *mut u64,
+    // seeded ciphertexts
+    seeded_lwe_in: *const u64,
+    // lwe dimension
+    lwe_dimension: usize,
+    // number of ciphertexts
+    count: usize,
+    // parallelism
+    parallelism: Parallelism,
+) {
+    nounwind(|| {
+        if count == 0 {
+            return;
+        }
+        let lwe_size = concrete_cpu_lwe_ciphertext_size_u64(lwe_dimension);
+        let lwe_out = slice::from_raw_parts_mut(lwe_out, count * lwe_size);
+        let seeded_lwe_in = slice::from_raw_parts(seeded_lwe_in, count * 3);
+        let decompress = |(lwe_out, seeded_lwe_in): (&mut [u64], &[u64])| {
+            let mut lwe_out =
+                LweCiphertext::from_container(lwe_out, CiphertextModulus::new_native());
+            let seed = Seed(seeded_lwe_in[0] as u128 | ((seeded_lwe_in[1] as u128) << 64));
+            let seeded_lwe_in = SeededLweCiphertext::from_scalar(
+                seeded_lwe_in[2],
+                LweDimension(lwe_dimension).to_lwe_size(),
+                CompressionSeed { seed },
+                CiphertextModulus::new_native(),
+            );
+            decompress_seeded_lwe_ciphertext::<_, _, DynamicRandomGenerator>(
+                &mut lwe_out,
+                &seeded_lwe_in,
+            );
+        };
+        match parallelism {
+            #[cfg(feature = "parallel")]
+            Parallelism::Rayon => {
+                use rayon::prelude::*;
+                lwe_out
+                    .par_chunks_exact_mut(lwe_size)
+                    .zip(seeded_lwe_in.par_chunks_exact(3))
+                    .for_each(decompress);
+            }
+            _ => lwe_out
+                .chunks_exact_mut(lwe_size)
+                .zip(seeded_lwe_in.chunks_exact(3))
+                .for_each(decompress),
+        }
+    });
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_decompress_seeded_lwe_ciphertext_u64(
     // ciphertext
@@ -204,7 +504,7 @@ pub unsafe extern "C" fn concrete_cpu_decompress_seeded_lwe_ciphertext_u64(
             CiphertextModulus::new_native(),
         );
 
-        decompress_seeded_lwe_ciphertext::<_, _, SoftwareRandomGenerator>(
+        decompress_seeded_lwe_ciphertext::<_, _, DynamicRandomGenerator>(
             &mut lwe_out,
             &seeded_lwe_in,
         )
@@ -285,3 +585,43 @@ pub unsafe extern "C" fn concrete_cpu_ggsw_ciphertext_size_u64(
         DecompositionLevelCount(decomposition_level_count),
     )
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::c_api::csprng::concrete_cpu_construct_encryption_csprng;
+
+    #[test]
+    fn parallel_encryption_is_deterministic() {
+        let lwe_dimension = 16;
+        let count = 64;
+        let lwe_sk: Vec<u64> = (0..lwe_dimension as u64).map(|i| i % 2).collect();
+        let input: Vec<u64> = (0..count as u64).map(|i| i << 60).collect();
+        let encrypt = |parallelism| unsafe {
+            let mut csprng = core::mem::MaybeUninit::<
+                EncryptionRandomGenerator<DynamicRandomGenerator>,
+            >::uninit();
+            let csprng = csprng.as_mut_ptr() as *mut EncCsprng;
+            let seed = Uint128 {
+                little_endian_bytes: [7; 16],
+            };
+            concrete_cpu_construct_encryption_csprng(csprng, seed);
+            let mut lwe_out = vec![0_u64; count * (lwe_dimension + 1)];
+            concrete_cpu_encrypt_lwe_ciphertext_list_u64(
+                lwe_sk.as_ptr(),
+                lwe_out.as_mut_ptr(),
+                input.as_ptr(),
+                lwe_dimension,
+                count,
+                1e-20,
+                csprng,
+                parallelism,
+            );
+            core::ptr::drop_in_place(
+                csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>,
+            );
+            lwe_out
+        };
+        assert_eq!(encrypt(Parallelism::No), encrypt(Parallelism::Rayon));
+    }
+}
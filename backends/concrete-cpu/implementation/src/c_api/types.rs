@@ -15,6 +15,16 @@ pub struct Csprng {
     __private: (),
 }
 
+/// Selects how `concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64` computes a single
+/// bootstrap.
+#[repr(C)]
+#[derive(Copy, Clone, Debug)]
+pub struct BootstrapParams {
+    /// Number of tasks of the rayon pool sharing each external product, 1 to run it on the
+    /// calling thread only.
+    pub thread_count: usize,
+}
+
 pub struct SecCsprng {
     __private: (),
 }
@@ -36,3 +46,12 @@ pub enum Parallelism {
     No = 0,
     Rayon = 1,
 }
+
+#[repr(u32)]
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum SimdPath {
+    SimdScalar = 0,
+    SimdAvx2 = 1,
+    SimdAvx512 = 2,
+    SimdNeon = 3,
+}
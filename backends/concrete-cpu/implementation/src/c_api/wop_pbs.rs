@@ -1,5 +1,13 @@
-use concrete_csprng::generators::SoftwareRandomGenerator;
+use crate::implementation::generator::DynamicRandomGenerator;
 use concrete_fft::c64;
+use tfhe::core_crypto::algorithms::slice_algorithms::slice_wrapping_sub_scalar_mul_assign;
+use tfhe::core_crypto::commons::math::decomposition::SignedDecomposer;
+use tfhe::core_crypto::commons::math::random::{RandomGenerator, Seed};
+use tfhe::core_crypto::fft_impl::fft64::crypto::ggsw::FourierGgswCiphertextList;
+use tfhe::core_crypto::fft_impl::fft64::crypto::wop_pbs::{
+    homomorphic_shift_boolean, vertical_packing,
+};
+use tfhe::core_crypto::fft_impl::fft64::math::fft::FftView;
 use tfhe::core_crypto::prelude::*;
 
 use crate::c_api::bootstrap::concrete_cpu_fourier_bootstrap_key_size_u64;
@@ -72,19 +80,163 @@ pub unsafe extern "C" fn concrete_cpu_init_lwe_circuit_bootstrap_private_functio
                 &input_key,
                 &output_key,
                 Variance::from_variance(variance),
-                &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+                &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
             ),
             Parallelism::Rayon => par_generate_circuit_bootstrap_lwe_pfpksk_list(
                 &mut fpksk_list,
                 &input_key,
                 &output_key,
                 Variance::from_variance(variance),
-                &mut *(csprng as *mut EncryptionRandomGenerator<SoftwareRandomGenerator>),
+                &mut *(csprng as *mut EncryptionRandomGenerator<DynamicRandomGenerator>),
             ),
         }
     })
 }
 
+/// Calls `f` on the index and the mask drawn from `seed` of each of the GLWE ciphertexts of a
+/// seeded packing keyswitch key, in order.
+fn for_each_seeded_mask(
+    glwe_ciphertext_count: usize,
+    mask_size: usize,
+    seed: Seed,
+    mut f: impl FnMut(usize, &[u64]),
+) {
+    let mut generator = RandomGenerator::<DynamicRandomGenerator>::new(seed);
+    let mut mask = vec![0_u64; mask_size];
+    for i in 0..glwe_ciphertext_count {
+        generator.fill_slice_with_random_uniform(&mut mask);
+        f(i, &mask);
+    }
+}
+
+/// Generates the packing keyswitch keys of a circuit bootstrap in their seeded form: the masks of
+/// their GLWE ciphertexts are drawn from `compression_seed`, and only the bodies are stored.
+///
+/// The keys are generated as by
+/// `concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64`,
+/// before their masks are replaced, the bodies being updated to keep the phases.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_init_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+    // seeded packing keyswitch key
+    seeded_lwe_pksk: *mut u64,
+    // secret keys
+    input_lwe_sk: *const u64,
+    output_glwe_sk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_polynomial_size: usize,
+    output_glwe_dimension: usize,
+    // circuit bootstrap parameters
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+    compression_seed: Uint128,
+    // noise parameters
+    variance: f64,
+    parallelism: Parallelism,
+    // csprng
+    csprng: *mut EncCsprng,
+) {
+    nounwind(|| {
+        let seeded_size = concrete_cpu_seeded_lwe_packing_keyswitch_keys_size_u64(
+            output_glwe_dimension,
+            output_polynomial_size,
+            decomposition_level_count,
+            input_lwe_dimension,
+        );
+        let glwe_size = (output_glwe_dimension + 1) * output_polynomial_size;
+        let mask_size = output_glwe_dimension * output_polynomial_size;
+
+        let mut pksk = vec![0_u64; seeded_size * (output_glwe_dimension + 1)];
+        concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+            pksk.as_mut_ptr(),
+            input_lwe_sk,
+            output_glwe_sk,
+            input_lwe_dimension,
+            output_polynomial_size,
+            output_glwe_dimension,
+            decomposition_level_count,
+            decomposition_base_log,
+            variance,
+            parallelism,
+            csprng,
+        );
+
+        let polynomial_size = PolynomialSize(output_polynomial_size);
+        let output_key = PolynomialList::from_container(
+            slice::from_raw_parts(output_glwe_sk, mask_size),
+            polynomial_size,
+        );
+        let seeded_pksk = slice::from_raw_parts_mut(seeded_lwe_pksk, seeded_size);
+        let seed = Seed(u128::from_le_bytes(compression_seed.little_endian_bytes));
+
+        for_each_seeded_mask(
+            seeded_size / output_polynomial_size,
+            mask_size,
+            seed,
+            |i, seeded_mask| {
+                let (mask, body) = pksk[i * glwe_size..(i + 1) * glwe_size].split_at(mask_size);
+                let mut seeded_body = Polynomial::from_container(
+                    &mut seeded_pksk[i * output_polynomial_size..(i + 1) * output_polynomial_size],
+                );
+                seeded_body.as_mut().copy_from_slice(body);
+                polynomial_wrapping_sub_multisum_assign(
+                    &mut seeded_body,
+                    &PolynomialList::from_container(mask, polynomial_size),
+                    &output_key,
+                );
+                polynomial_wrapping_add_multisum_assign(
+                    &mut seeded_body,
+                    &PolynomialList::from_container(seeded_mask, polynomial_size),
+                    &output_key,
+                );
+            },
+        );
+    })
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_decompress_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+    // packing keyswitch key
+    lwe_pksk: *mut u64,
+    // seeded packing keyswitch key
+    seeded_lwe_pksk: *const u64,
+    // secret key dimensions
+    input_lwe_dimension: usize,
+    output_polynomial_size: usize,
+    output_glwe_dimension: usize,
+    // circuit bootstrap parameters
+    decomposition_level_count: usize,
+    compression_seed: Uint128,
+) {
+    nounwind(|| {
+        let seeded_size = concrete_cpu_seeded_lwe_packing_keyswitch_keys_size_u64(
+            output_glwe_dimension,
+            output_polynomial_size,
+            decomposition_level_count,
+            input_lwe_dimension,
+        );
+        let glwe_size = (output_glwe_dimension + 1) * output_polynomial_size;
+        let mask_size = output_glwe_dimension * output_polynomial_size;
+
+        let pksk = slice::from_raw_parts_mut(lwe_pksk, seeded_size * (output_glwe_dimension + 1));
+        let seeded_pksk = slice::from_raw_parts(seeded_lwe_pksk, seeded_size);
+        let seed = Seed(u128::from_le_bytes(compression_seed.little_endian_bytes));
+
+        for_each_seeded_mask(
+            seeded_size / output_polynomial_size,
+            mask_size,
+            seed,
+            |i, seeded_mask| {
+                let (mask, body) = pksk[i * glwe_size..(i + 1) * glwe_size].split_at_mut(mask_size);
+                mask.copy_from_slice(seeded_mask);
+                body.copy_from_slice(
+                    &seeded_pksk[i * output_polynomial_size..(i + 1) * output_polynomial_size],
+                );
+            },
+        );
+    })
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_extract_bit_lwe_ciphertext_u64_scratch(
     stack_size: *mut usize,
@@ -263,6 +415,183 @@ pub unsafe extern "C" fn concrete_cpu_circuit_bootstrap_boolean_vertical_packing
     })
 }
 
+/// Packing keyswitches the `level_cbs` bootstrapped ciphertexts of a circuit bootstrap with each
+/// of the `glwe_size` private functional packing keyswitch keys of `pfpksk_list`, writing the
+/// rows of the GGSW ciphertext `ggsw_out`: the row of key `r` in the level matrix `l` is the
+/// keyswitch of the `l`-th ciphertext by the `r`-th key.
+///
+/// The keys are stored with the level key ciphertexts of each input coefficient next to each
+/// other, so each key is streamed once, each of its blocks being applied to all the
+/// ciphertexts while it is hot in cache, instead of once per ciphertext. The decompositions of
+/// the ciphertexts are shared by the keys, which are applied by one task each.
+fn circuit_bootstrap_packing_keyswitch(
+    ggsw_out: &mut [u64],
+    lwe_list_in: &[u64],
+    pfpksk_list: &[u64],
+    input_lwe_dimension: usize,
+    glwe_dimension: usize,
+    polynomial_size: usize,
+    decomposition_level_count: usize,
+    decomposition_base_log: usize,
+) {
+    #[cfg(feature = "parallel")]
+    use rayon::prelude::*;
+
+    let input_size = input_lwe_dimension + 1;
+    let glwe_size = glwe_dimension + 1;
+    let glwe_len = glwe_size * polynomial_size;
+    let key_block_len = decomposition_level_count * glwe_len;
+    let ct_count = lwe_list_in.len() / input_size;
+    assert_eq!(pfpksk_list.len(), glwe_size * input_size * key_block_len);
+    assert_eq!(ggsw_out.len(), ct_count * glwe_size * glwe_len);
+
+    let decomposer = SignedDecomposer::<u64>::new(
+        DecompositionBaseLog(decomposition_base_log),
+        DecompositionLevelCount(decomposition_level_count),
+    );
+    // The digits of the ciphertexts for a coefficient are next to each other, in the order of
+    // the level key ciphertexts.
+    let mut digits = vec![0_u64; input_size * ct_count * decomposition_level_count];
+    for (c, ct) in lwe_list_in.chunks_exact(input_size).enumerate() {
+        for (i, &value) in ct.iter().enumerate() {
+            let offset = (i * ct_count + c) * decomposition_level_count;
+            for term in decomposer.decompose(decomposer.closest_representable(value)) {
+                digits[offset + term.level().0 - 1] = term.value();
+            }
+        }
+    }
+
+    let digits = &digits;
+    let apply_key = |(key, rows): (&[u64], &mut [u64])| {
+        for (key_block, block_digits) in key
+            .chunks_exact(key_block_len)
+            .zip(digits.chunks_exact(ct_count * decomposition_level_count))
+        {
+            for (row, ct_digits) in rows
+                .chunks_exact_mut(glwe_len)
+                .zip(block_digits.chunks_exact(decomposition_level_count))
+            {
+                for (level_key_ciphertext, &digit) in
+                    key_block.chunks_exact(glwe_len).zip(ct_digits)
+                {
+                    if digit != 0 {
+                        slice_wrapping_sub_scalar_mul_assign(row, level_key_ciphertext, digit);
+                    }
+                }
+            }
+        }
+    };
+
+    // The rows of each key, for all the ciphertexts
+    let mut rows = vec![0_u64; glwe_size * ct_count * glwe_len];
+    let key_len = input_size * key_block_len;
+    #[cfg(feature = "parallel")]
+    pfpksk_list
+        .par_chunks_exact(key_len)
+        .zip(rows.par_chunks_exact_mut(ct_count * glwe_len))
+        .for_each(apply_key);
+    #[cfg(not(feature = "parallel"))]
+    pfpksk_list
+        .chunks_exact(key_len)
+        .zip(rows.chunks_exact_mut(ct_count * glwe_len))
+        .for_each(apply_key);
+
+    for (r, key_rows) in rows.chunks_exact(ct_count * glwe_len).enumerate() {
+        for (l, row) in key_rows.chunks_exact(glwe_len).enumerate() {
+            ggsw_out[(l * glwe_size + r) * glwe_len..][..glwe_len].copy_from_slice(row);
+        }
+    }
+}
+
+/// Circuit bootstraps the ciphertexts and evaluates the lookup tables on them by vertical
+/// packing, as `circuit_bootstrap_boolean_vertical_packing_lwe_ciphertext_list_mem_optimized`
+/// does, with the packing keyswitches of each circuit bootstrap done by
+/// [`circuit_bootstrap_packing_keyswitch`]. The GGSW ciphertexts are allocated on the heap, the
+/// stack being only used by the bootstraps and the vertical packing.
+#[allow(clippy::too_many_arguments)]
+fn circuit_bootstrap_boolean_vertical_packing(
+    lwe_list_in: &LweCiphertextList<&[u64]>,
+    lwe_list_out: &mut LweCiphertextList<&mut [u64]>,
+    luts: &PolynomialList<&[u64]>,
+    fourier_bsk: &FourierLweBootstrapKey<&[c64]>,
+    pfpksk_list: &LwePrivateFunctionalPackingKeyswitchKeyList<&[u64]>,
+    cbs_base_log: DecompositionBaseLog,
+    cbs_level_count: DecompositionLevelCount,
+    fft: FftView<'_>,
+    mut stack: PodStack<'_>,
+) {
+    let glwe_size = pfpksk_list.output_key_glwe_dimension().to_glwe_size();
+    let polynomial_size = pfpksk_list.output_polynomial_size();
+    let bs_output_size = fourier_bsk.output_lwe_dimension().to_lwe_size();
+    let ct_in_count = lwe_list_in.lwe_ciphertext_count().0;
+
+    let mut ggsw_list_data =
+        vec![
+            c64::default();
+            ct_in_count * cbs_level_count.0 * glwe_size.0 * glwe_size.0 * (polynomial_size.0 / 2)
+        ];
+    let mut ggsw_list = FourierGgswCiphertextList::new(
+        &mut *ggsw_list_data,
+        ct_in_count,
+        glwe_size,
+        polynomial_size,
+        cbs_base_log,
+        cbs_level_count,
+    );
+    let mut ggsw_data =
+        vec![0_u64; cbs_level_count.0 * glwe_size.0 * glwe_size.0 * polynomial_size.0];
+    let mut bs_buffer = vec![0_u64; cbs_level_count.0 * bs_output_size.0];
+
+    for (lwe_in, fourier_ggsw) in lwe_list_in
+        .iter()
+        .zip(ggsw_list.as_mut_view().into_ggsw_iter())
+    {
+        // The bootstrapped ciphertext encrypting the bit shifted at each level
+        for (index, lwe_out) in bs_buffer.chunks_exact_mut(bs_output_size.0).enumerate() {
+            homomorphic_shift_boolean(
+                fourier_bsk.as_view(),
+                LweCiphertext::from_container(lwe_out, CiphertextModulus::new_native()),
+                lwe_in.as_view(),
+                DecompositionLevel(cbs_level_count.0 - index),
+                cbs_base_log,
+                DeltaLog(u64::BITS as usize - 1),
+                fft,
+                stack.rb_mut(),
+            );
+        }
+        circuit_bootstrap_packing_keyswitch(
+            &mut ggsw_data,
+            &bs_buffer,
+            pfpksk_list.as_ref(),
+            pfpksk_list.input_key_lwe_dimension().0,
+            glwe_size.to_glwe_dimension().0,
+            polynomial_size.0,
+            pfpksk_list.decomposition_level_count().0,
+            pfpksk_list.decomposition_base_log().0,
+        );
+        fourier_ggsw.fill_with_forward_fourier(
+            GgswCiphertext::from_container(
+                &*ggsw_data,
+                glwe_size,
+                polynomial_size,
+                cbs_base_log,
+                CiphertextModulus::new_native(),
+            )
+            .as_view(),
+            fft,
+            stack.rb_mut(),
+        );
+    }
+
+    let lut_polynomial_count = luts.polynomial_count().0 / lwe_list_out.lwe_ciphertext_count().0;
+    for (lut, lwe_out) in luts
+        .chunks_exact(lut_polynomial_count)
+        .zip(lwe_list_out.iter_mut())
+    {
+        vertical_packing(lut, lwe_out, ggsw_list.as_view(), fft, stack.rb_mut());
+    }
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn concrete_cpu_circuit_bootstrap_boolean_vertical_packing_lwe_ciphertext_u64(
     // ciphertexts
@@ -382,7 +711,7 @@ pub unsafe extern "C" fn concrete_cpu_circuit_bootstrap_boolean_vertical_packing
             CiphertextModulus::new_native(),
         );
 
-        circuit_bootstrap_boolean_vertical_packing_lwe_ciphertext_list_mem_optimized(
+        circuit_bootstrap_boolean_vertical_packing(
             &lwe_list_in,
             &mut lwe_list_out,
             &luts,
@@ -410,3 +739,203 @@ pub unsafe extern "C" fn concrete_cpu_lwe_packing_keyswitch_key_size(
         PolynomialSize(polynomial_size),
     )
 }
+
+/// Returns the size of the seeded packing keyswitch keys of a circuit bootstrap, all of them,
+/// that is the bodies of their GLWE ciphertexts.
+#[no_mangle]
+pub unsafe extern "C" fn concrete_cpu_seeded_lwe_packing_keyswitch_keys_size_u64(
+    output_glwe_dimension: usize,
+    polynomial_size: usize,
+    decomposition_level_count: usize,
+    input_lwe_dimension: usize,
+) -> usize {
+    concrete_cpu_lwe_packing_keyswitch_key_size(
+        output_glwe_dimension,
+        polynomial_size,
+        decomposition_level_count,
+        input_lwe_dimension,
+    )
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tfhe::core_crypto::seeders::Seeder;
+
+    // Draws the same noise for both keys
+    struct ConstantSeeder;
+
+    impl Seeder for ConstantSeeder {
+        fn seed(&mut self) -> Seed {
+            Seed(17)
+        }
+
+        fn is_available() -> bool {
+            true
+        }
+    }
+
+    #[test]
+    fn seeded_packing_keyswitch_keys_keep_the_phases() {
+        let (input_lwe_dimension, output_glwe_dimension, output_polynomial_size) = (32, 2, 64);
+        let (level, base_log) = (2, 8);
+        let input_sk: Vec<u64> = (0..input_lwe_dimension as u64).map(|i| i % 2).collect();
+        let output_sk: Vec<u64> = (0..(output_glwe_dimension * output_polynomial_size) as u64)
+            .map(|i| (i / 3) % 2)
+            .collect();
+        let seed = Uint128 {
+            little_endian_bytes: [7; 16],
+        };
+        let polynomial_size = PolynomialSize(output_polynomial_size);
+        let glwe_size = (output_glwe_dimension + 1) * output_polynomial_size;
+        let mask_size = output_glwe_dimension * output_polynomial_size;
+        let phases = |pksk: &[u64]| {
+            let output_key = PolynomialList::from_container(output_sk.as_slice(), polynomial_size);
+            pksk.chunks(glwe_size)
+                .flat_map(|ct| {
+                    let (mask, body) = ct.split_at(mask_size);
+                    let mut phase = Polynomial::from_container(body.to_vec());
+                    polynomial_wrapping_sub_multisum_assign(
+                        &mut phase,
+                        &PolynomialList::from_container(mask, polynomial_size),
+                        &output_key,
+                    );
+                    phase.into_container()
+                })
+                .collect::<Vec<_>>()
+        };
+        let keys = |seeded: bool| unsafe {
+            let mut csprng = EncryptionRandomGenerator::<DynamicRandomGenerator>::new(
+                Seed(3),
+                &mut ConstantSeeder,
+            );
+            let csprng = &mut csprng as *mut _ as *mut EncCsprng;
+            let seeded_size = concrete_cpu_seeded_lwe_packing_keyswitch_keys_size_u64(
+                output_glwe_dimension,
+                output_polynomial_size,
+                level,
+                input_lwe_dimension,
+            );
+            let mut pksk = vec![0_u64; seeded_size * (output_glwe_dimension + 1)];
+            if !seeded {
+                concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+                    pksk.as_mut_ptr(),
+                    input_sk.as_ptr(),
+                    output_sk.as_ptr(),
+                    input_lwe_dimension,
+                    output_polynomial_size,
+                    output_glwe_dimension,
+                    level,
+                    base_log,
+                    1e-20,
+                    Parallelism::No,
+                    csprng,
+                );
+                return pksk;
+            }
+            let mut seeded_pksk = vec![0_u64; seeded_size];
+            concrete_cpu_init_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+                seeded_pksk.as_mut_ptr(),
+                input_sk.as_ptr(),
+                output_sk.as_ptr(),
+                input_lwe_dimension,
+                output_polynomial_size,
+                output_glwe_dimension,
+                level,
+                base_log,
+                seed,
+                1e-20,
+                Parallelism::No,
+                csprng,
+            );
+            concrete_cpu_decompress_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+                pksk.as_mut_ptr(),
+                seeded_pksk.as_ptr(),
+                input_lwe_dimension,
+                output_polynomial_size,
+                output_glwe_dimension,
+                level,
+                seed,
+            );
+            pksk
+        };
+        let (pksk, decompressed) = (keys(false), keys(true));
+        assert_ne!(pksk, decompressed);
+        assert_eq!(phases(&pksk), phases(&decompressed));
+    }
+
+    #[test]
+    fn circuit_bootstrap_packing_keyswitch_matches_tfhe() {
+        let (input_lwe_dimension, glwe_dimension, polynomial_size) = (16, 1, 32);
+        let (level, base_log, cbs_level) = (3, 6, 2);
+        let glwe_size = glwe_dimension + 1;
+        let glwe_len = glwe_size * polynomial_size;
+        let mut state = 0x9e37_79b9_7f4a_7c15_u64;
+        let mut random = |len: usize| -> Vec<u64> {
+            (0..len)
+                .map(|_| {
+                    state = state
+                        .wrapping_mul(6364136223846793005)
+                        .wrapping_add(1442695040888963407);
+                    state
+                })
+                .collect()
+        };
+        let key_len = unsafe {
+            concrete_cpu_lwe_packing_keyswitch_key_size(
+                glwe_dimension,
+                polynomial_size,
+                level,
+                input_lwe_dimension,
+            )
+        };
+        let pfpksk_list = random(key_len * glwe_size);
+        let lwe_list_in = random((input_lwe_dimension + 1) * cbs_level);
+
+        let mut ggsw = vec![0_u64; cbs_level * glwe_size * glwe_len];
+        circuit_bootstrap_packing_keyswitch(
+            &mut ggsw,
+            &lwe_list_in,
+            &pfpksk_list,
+            input_lwe_dimension,
+            glwe_dimension,
+            polynomial_size,
+            level,
+            base_log,
+        );
+
+        let keys = LwePrivateFunctionalPackingKeyswitchKeyList::from_container(
+            pfpksk_list.as_slice(),
+            DecompositionBaseLog(base_log),
+            DecompositionLevelCount(level),
+            LweDimension(input_lwe_dimension).to_lwe_size(),
+            GlweDimension(glwe_dimension).to_glwe_size(),
+            PolynomialSize(polynomial_size),
+            CiphertextModulus::new_native(),
+        );
+        let inputs = LweCiphertextList::from_container(
+            lwe_list_in.as_slice(),
+            LweDimension(input_lwe_dimension).to_lwe_size(),
+            CiphertextModulus::new_native(),
+        );
+        for (l, lwe_in) in inputs.iter().enumerate() {
+            for (r, key) in keys.iter().enumerate() {
+                let mut glwe_out = GlweCiphertext::new(
+                    0_u64,
+                    GlweDimension(glwe_dimension).to_glwe_size(),
+                    PolynomialSize(polynomial_size),
+                    CiphertextModulus::new_native(),
+                );
+                private_functional_keyswitch_lwe_ciphertext_into_glwe_ciphertext(
+                    &key,
+                    &mut glwe_out,
+                    &lwe_in,
+                );
+                assert_eq!(
+                    &ggsw[(l * glwe_size + r) * glwe_len..][..glwe_len],
+                    glwe_out.as_ref()
+                );
+            }
+        }
+    }
+}
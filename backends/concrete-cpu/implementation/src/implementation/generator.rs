@@ -0,0 +1,147 @@
+//! The AES-CTR byte generator of the csprngs, using the AES instructions of the CPU when it has
+//! them. All the generators output the same bytes from the same seed, so that a key seeded on a
+//! machine can be decompressed on any other.
+
+use concrete_csprng::generators::{
+    ByteCount, BytesPerChild, ChildrenCount, ForkError, RandomGenerator, SoftwareRandomGenerator,
+};
+use concrete_csprng::seeders::Seed;
+
+#[cfg(feature = "parallel")]
+use concrete_csprng::generators::ParallelRandomGenerator;
+#[cfg(feature = "parallel")]
+use rayon::iter::{Either, ParallelIterator};
+
+#[cfg(target_arch = "x86_64")]
+type HardwareRandomGenerator = concrete_csprng::generators::AesniRandomGenerator;
+
+#[cfg(target_arch = "aarch64")]
+type HardwareRandomGenerator = concrete_csprng::generators::NeonAesRandomGenerator;
+
+#[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+type HardwareRandomGenerator = SoftwareRandomGenerator;
+
+/// Returns whether the CPU has the instructions of `HardwareRandomGenerator`.
+fn has_hardware_aes() -> bool {
+    #[cfg(target_arch = "x86_64")]
+    {
+        is_x86_feature_detected!("aes") && is_x86_feature_detected!("sse2")
+    }
+    #[cfg(target_arch = "aarch64")]
+    {
+        std::arch::is_aarch64_feature_detected!("aes")
+            && std::arch::is_aarch64_feature_detected!("neon")
+    }
+    #[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+    {
+        false
+    }
+}
+
+/// A generator picking its implementation on construction, its children using the same one.
+pub enum DynamicRandomGenerator {
+    Software(SoftwareRandomGenerator),
+    Hardware(HardwareRandomGenerator),
+}
+
+pub enum DynamicChildrenIterator {
+    Software(<SoftwareRandomGenerator as RandomGenerator>::ChildrenIter),
+    Hardware(<HardwareRandomGenerator as RandomGenerator>::ChildrenIter),
+}
+
+impl Iterator for DynamicChildrenIterator {
+    type Item = DynamicRandomGenerator;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        match self {
+            Self::Software(children) => children.next().map(DynamicRandomGenerator::Software),
+            Self::Hardware(children) => children.next().map(DynamicRandomGenerator::Hardware),
+        }
+    }
+}
+
+impl Iterator for DynamicRandomGenerator {
+    type Item = u8;
+
+    #[inline]
+    fn next(&mut self) -> Option<u8> {
+        match self {
+            Self::Software(generator) => generator.next(),
+            Self::Hardware(generator) => generator.next(),
+        }
+    }
+}
+
+impl RandomGenerator for DynamicRandomGenerator {
+    type ChildrenIter = DynamicChildrenIterator;
+
+    fn new(seed: Seed) -> Self {
+        if has_hardware_aes() {
+            Self::Hardware(HardwareRandomGenerator::new(seed))
+        } else {
+            Self::Software(SoftwareRandomGenerator::new(seed))
+        }
+    }
+
+    fn remaining_bytes(&self) -> ByteCount {
+        match self {
+            Self::Software(generator) => generator.remaining_bytes(),
+            Self::Hardware(generator) => generator.remaining_bytes(),
+        }
+    }
+
+    fn try_fork(
+        &mut self,
+        n_children: ChildrenCount,
+        n_bytes: BytesPerChild,
+    ) -> Result<Self::ChildrenIter, ForkError> {
+        match self {
+            Self::Software(generator) => generator
+                .try_fork(n_children, n_bytes)
+                .map(DynamicChildrenIterator::Software),
+            Self::Hardware(generator) => generator
+                .try_fork(n_children, n_bytes)
+                .map(DynamicChildrenIterator::Hardware),
+        }
+    }
+}
+
+#[cfg(feature = "parallel")]
+type ParChildren<G> = rayon::iter::Map<
+    <G as ParallelRandomGenerator>::ParChildrenIter,
+    fn(G) -> DynamicRandomGenerator,
+>;
+
+#[cfg(feature = "parallel")]
+impl ParallelRandomGenerator for DynamicRandomGenerator {
+    type ParChildrenIter =
+        Either<ParChildren<SoftwareRandomGenerator>, ParChildren<HardwareRandomGenerator>>;
+
+    fn par_try_fork(
+        &mut self,
+        n_children: ChildrenCount,
+        n_bytes: BytesPerChild,
+    ) -> Result<Self::ParChildrenIter, ForkError> {
+        match self {
+            Self::Software(generator) => generator
+                .par_try_fork(n_children, n_bytes)
+                .map(|c| Either::Left(c.map(DynamicRandomGenerator::Software as fn(_) -> _))),
+            Self::Hardware(generator) => generator
+                .par_try_fork(n_children, n_bytes)
+                .map(|c| Either::Right(c.map(DynamicRandomGenerator::Hardware as fn(_) -> _))),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_same_bytes_as_software() {
+        let seed = Seed(0x0123_4567_89ab_cdef_0123_4567_89ab_cdef);
+        let dynamic = DynamicRandomGenerator::new(seed).take(1 << 12);
+        let software = SoftwareRandomGenerator::new(seed).take(1 << 12);
+        assert!(dynamic.eq(software));
+    }
+}
@@ -1,3 +1,4 @@
+pub mod generator;
 pub mod wop_simulation;
 
 #[inline]
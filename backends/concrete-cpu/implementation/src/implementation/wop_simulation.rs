@@ -2,12 +2,12 @@
 
 use std::cmp::Ordering;
 
+use crate::implementation::generator::DynamicRandomGenerator;
 use crate::implementation::{from_torus, zip_eq};
 use concrete_cpu_noise_model::gaussian_noise::noise::blind_rotate::variance_blind_rotate;
 use concrete_cpu_noise_model::gaussian_noise::noise::keyswitch::variance_keyswitch;
 use concrete_cpu_noise_model::gaussian_noise::noise::modulus_switching::estimate_modulus_switching_noise_with_binary_key;
 use concrete_cpu_noise_model::gaussian_noise::noise::private_packing_keyswitch::estimate_packing_private_keyswitch;
-use concrete_csprng::generators::SoftwareRandomGenerator;
 use tfhe::core_crypto::commons::math::random::RandomGenerator;
 use tfhe::core_crypto::commons::parameters::*;
 
@@ -18,7 +18,7 @@ use tfhe::core_crypto::entities::{Polynomial, PolynomialList};
 
 pub fn random_gaussian_pair(
     variance: f64,
-    csprng: &mut RandomGenerator<SoftwareRandomGenerator>,
+    csprng: &mut RandomGenerator<DynamicRandomGenerator>,
 ) -> (f64, f64) {
     let mut buff = [0_f64, 0_f64];
     csprng.fill_slice_with_random_gaussian(buff.as_mut_slice(), 0.0, variance);
@@ -72,7 +72,7 @@ pub fn extract_bits(
     ciphertext_modulus_log: u32,
     security_level: u64,
 ) {
-    let mut csprng = RandomGenerator::<SoftwareRandomGenerator>::new(Seed(0));
+    let mut csprng = RandomGenerator::<DynamicRandomGenerator>::new(Seed(0));
 
     let polynomial_size = 1 << log_poly_size;
     let mut lookup_table = vec![0_u64; polynomial_size as usize];
@@ -194,7 +194,7 @@ pub fn circuit_bootstrap_boolean(
     log_poly_size: u64,
     lwe_dimension: u64,
     ciphertext_modulus_log: u32,
-    csprng: &mut RandomGenerator<SoftwareRandomGenerator>,
+    csprng: &mut RandomGenerator<DynamicRandomGenerator>,
 ) -> u64 {
     //  homomorphic_shift_boolean outputs the LUT evaluation without the blind rotate noise
     // nor the packing keyswitch noise. There will be added latter during the vertical packing.
@@ -218,7 +218,7 @@ pub fn homomorphic_shift_boolean(
     log_poly_size: u64,
     delta_log: usize,
     ciphertext_modulus_log: u32,
-    csprng: &mut RandomGenerator<SoftwareRandomGenerator>,
+    csprng: &mut RandomGenerator<DynamicRandomGenerator>,
 ) -> u64 {
     let ciphertext_n_bits = ciphertext_modulus_log;
     let polynomial_size = 1 << log_poly_size;
@@ -400,7 +400,7 @@ pub fn blind_rotate(
     ggsw_list: &[u64],
     ciphertext_modulus_log: u32,
     security_level: u64,
-    csprng: &mut RandomGenerator<SoftwareRandomGenerator>,
+    csprng: &mut RandomGenerator<DynamicRandomGenerator>,
 ) -> u64 {
     let polynomial_size = 1 << log_poly_size;
     let mut monomial_degree = 1;
@@ -484,7 +484,7 @@ pub fn vertical_packing(
     pbs_level: u64,
     ciphertext_modulus_log: u32,
     security_level: u64,
-    csprng: &mut RandomGenerator<SoftwareRandomGenerator>,
+    csprng: &mut RandomGenerator<DynamicRandomGenerator>,
 ) -> u64 {
     let polynomial_size = 1 << log_poly_size;
 
@@ -578,7 +578,7 @@ pub fn circuit_bootstrap_boolean_vertical_packing(
     ciphertext_modulus_log: u32,
     security_level: u64,
 ) {
-    let sw_csprng = &mut RandomGenerator::<SoftwareRandomGenerator>::new(Seed(0));
+    let sw_csprng = &mut RandomGenerator::<DynamicRandomGenerator>::new(Seed(0));
 
     let mut ggsw_list = vec![0_u64; lwe_list_in.len()];
     let delta_log = u64::BITS as usize - 1;
@@ -32,6 +32,17 @@ double concrete_cpu_variance_blind_rotate(uint64_t in_lwe_dimension,
                                           uint32_t fft_precision,
                                           double variance_bsk);
 
+double concrete_cpu_variance_multi_bit_blind_rotate(uint64_t in_lwe_dimension,
+                                                    uint64_t out_glwe_dimension,
+                                                    uint64_t out_polynomial_size,
+                                                    uint64_t log2_base,
+                                                    uint64_t level,
+                                                    uint32_t ciphertext_modulus_log,
+                                                    uint32_t fft_precision,
+                                                    double variance_bsk,
+                                                    uint32_t grouping_factor,
+                                                    bool jit_fft);
+
 double concrete_cpu_variance_keyswitch(uint64_t input_lwe_dimension,
                                        uint64_t log2_base,
                                        uint64_t level,
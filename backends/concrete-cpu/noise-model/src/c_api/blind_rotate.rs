@@ -1,4 +1,5 @@
 use crate::gaussian_noise::noise::blind_rotate::variance_blind_rotate;
+use crate::gaussian_noise::noise::multi_bit_blind_rotate::variance_multi_bit_blind_rotate;
 
 #[no_mangle]
 pub extern "C" fn concrete_cpu_variance_blind_rotate(
@@ -22,3 +23,31 @@ pub extern "C" fn concrete_cpu_variance_blind_rotate(
         variance_bsk,
     )
 }
+
+#[no_mangle]
+#[allow(clippy::too_many_arguments)]
+pub extern "C" fn concrete_cpu_variance_multi_bit_blind_rotate(
+    in_lwe_dimension: u64,
+    out_glwe_dimension: u64,
+    out_polynomial_size: u64,
+    log2_base: u64,
+    level: u64,
+    ciphertext_modulus_log: u32,
+    fft_precision: u32,
+    variance_bsk: f64,
+    grouping_factor: u32,
+    jit_fft: bool,
+) -> f64 {
+    variance_multi_bit_blind_rotate(
+        in_lwe_dimension,
+        out_glwe_dimension,
+        out_polynomial_size,
+        log2_base,
+        level,
+        ciphertext_modulus_log,
+        fft_precision,
+        variance_bsk,
+        grouping_factor,
+        jit_fft,
+    )
+}
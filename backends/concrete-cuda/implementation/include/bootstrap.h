@@ -3,12 +3,24 @@
 
 #include <cstdint>
 
+enum POLYNOMIAL_MUL_BACKEND { FFT_F64 = 0, NTT_U64 = 1 };
+
 extern "C" {
 void cuda_fourier_polynomial_mul(void *input1, void *input2, void *output,
                                  void *v_stream, uint32_t gpu_index,
                                  uint32_t polynomial_size,
                                  uint32_t total_polynomials);
 
+void cuda_ntt_polynomial_mul_64(void *input1, void *input2, void *output,
+                                void *v_stream, uint32_t gpu_index,
+                                uint32_t polynomial_size,
+                                uint32_t total_polynomials);
+
+POLYNOMIAL_MUL_BACKEND cuda_get_polynomial_mul_backend(uint32_t gpu_index);
+
+void cuda_set_polynomial_mul_backend(uint32_t gpu_index,
+                                     POLYNOMIAL_MUL_BACKEND backend);
+
 void cuda_convert_lwe_bootstrap_key_32(void *dest, void *src, void *v_stream,
                                        uint32_t gpu_index,
                                        uint32_t input_lwe_dim,
@@ -56,6 +68,16 @@ void cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
 void cleanup_cuda_bootstrap_amortized(void *v_stream, uint32_t gpu_index,
                                       int8_t **pbs_buffer);
 
+void cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_array_in, void *lwe_array_ks,
+    void *ksk, void *bootstrapping_key, int8_t *pbs_buffer,
+    uint32_t ks_lwe_dimension_in, uint32_t lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t ks_base_log,
+    uint32_t ks_level_count, uint32_t base_log, uint32_t level_count,
+    uint32_t num_samples, uint32_t num_lut_vectors, uint32_t lwe_idx,
+    uint32_t max_shared_memory);
+
 void scratch_cuda_bootstrap_low_latency_32(
     void *v_stream, uint32_t gpu_index, int8_t **pbs_buffer,
     uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t level_count,
@@ -121,6 +143,14 @@ void scratch_cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index,
                              uint32_t max_shared_memory,
                              bool allocate_gpu_memory);
 
+void scratch_cuda_wop_pbs_many_lut_64(
+    void *v_stream, uint32_t gpu_index, int8_t **wop_pbs_buffer,
+    uint32_t *delta_log_array, uint32_t *cbs_delta_log, uint32_t glwe_dimension,
+    uint32_t lwe_dimension, uint32_t polynomial_size, uint32_t level_count_cbs,
+    uint32_t level_count_bsk, uint32_t *number_of_bits_to_extract_array,
+    uint32_t crt_decomposition_size, uint32_t number_of_luts,
+    uint32_t max_shared_memory, bool allocate_gpu_memory);
+
 void cuda_circuit_bootstrap_vertical_packing_64(
     void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lwe_array_in,
     void *fourier_bsk, void *cbs_fpksk, void *lut_vector, int8_t *cbs_vp_buffer,
@@ -143,6 +173,17 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
                      uint32_t *delta_log_array, uint32_t crt_decomposition_size,
                      uint32_t max_shared_memory);
 
+void cuda_wop_pbs_many_lut_64(
+    void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lwe_array_in,
+    void *lut_vector, void *fourier_bsk, void *ksk, void *cbs_fpksk,
+    int8_t *wop_pbs_buffer, uint32_t cbs_delta_log, uint32_t glwe_dimension,
+    uint32_t lwe_dimension, uint32_t polynomial_size, uint32_t base_log_bsk,
+    uint32_t level_count_bsk, uint32_t base_log_ksk, uint32_t level_count_ksk,
+    uint32_t base_log_pksk, uint32_t level_count_pksk, uint32_t base_log_cbs,
+    uint32_t level_count_cbs, uint32_t *number_of_bits_to_extract_array,
+    uint32_t *delta_log_array, uint32_t crt_decomposition_size,
+    uint32_t number_of_luts, uint32_t max_shared_memory);
+
 void cleanup_cuda_wop_pbs(void *v_stream, uint32_t gpu_index,
                           int8_t **wop_pbs_buffer);
 
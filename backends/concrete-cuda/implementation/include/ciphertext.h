@@ -14,5 +14,9 @@ void cuda_convert_lwe_ciphertext_vector_to_cpu_64(void *dest, void *src,
                                                   uint32_t gpu_index,
                                                   uint32_t number_of_cts,
                                                   uint32_t lwe_dimension);
+void cuda_glwe_trivial_encrypt_lut_vector_64(
+    void *v_stream, uint32_t gpu_index, void *lut_vector, void *lut_bodies,
+    uint32_t number_of_luts, uint32_t glwe_dimension,
+    uint32_t polynomial_size);
 };
 #endif
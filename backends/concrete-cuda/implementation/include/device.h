@@ -48,6 +48,9 @@ int cuda_drop_async(void *ptr, cudaStream_t *stream, uint32_t gpu_index);
 
 int cuda_get_max_shared_memory(uint32_t gpu_index);
 
+int cuda_set_mem_pool_release_threshold(uint64_t threshold,
+                                        uint32_t gpu_index);
+
 int cuda_synchronize_stream(void *v_stream);
 
 #define check_cuda_error(ans)                                                  \
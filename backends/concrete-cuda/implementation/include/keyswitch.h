@@ -15,6 +15,11 @@ void cuda_keyswitch_lwe_ciphertext_vector_64(
     void *ksk, uint32_t lwe_dimension_in, uint32_t lwe_dimension_out,
     uint32_t base_log, uint32_t level_count, uint32_t num_samples);
 
+void cuda_keyswitch_lwe_ciphertext_vector_128(
+    void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lwe_array_in,
+    void *ksk, uint32_t lwe_dimension_in, uint32_t lwe_dimension_out,
+    uint32_t base_log, uint32_t level_count, uint32_t num_samples);
+
 void cuda_fp_keyswitch_lwe_to_glwe_32(
     void *v_stream, uint32_t gpu_index, void *glwe_array_out,
     void *lwe_array_in, void *fp_ksk_array, uint32_t input_lwe_dimension,
@@ -46,6 +46,13 @@ void cuda_mult_lwe_ciphertext_vector_cleartext_vector_64(
     void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lwe_array_in,
     void *cleartext_array_in, uint32_t input_lwe_dimension,
     uint32_t input_lwe_ciphertext_count);
+void cuda_affine_lwe_ciphertext_vector_64(void *v_stream, uint32_t gpu_index,
+                                          void *lwe_array_out,
+                                          void *lwe_array_in,
+                                          uint64_t cleartext,
+                                          uint64_t plaintext,
+                                          uint32_t input_lwe_dimension,
+                                          uint32_t input_lwe_ciphertext_count);
 
 void scratch_cuda_integer_mult_radix_ciphertext_kb_64(
     void *v_stream, uint32_t gpu_index, void *mem_ptr, uint32_t message_modulus,
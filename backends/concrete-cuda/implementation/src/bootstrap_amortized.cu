@@ -1,4 +1,5 @@
 #include "bootstrap_amortized.cuh"
+#include "keyswitch.h"
 
 /*
  * Returns the buffer size for 64 bits executions
@@ -367,3 +368,37 @@ void cleanup_cuda_bootstrap_amortized(void *v_stream, uint32_t gpu_index,
   // Free memory
   cuda_drop_async(*pbs_buffer, stream, gpu_index);
 }
+
+/* Perform a keyswitch followed by an amortized bootstrap on a batch of 64 bits
+ * input LWE ciphertexts, which is the lowering of most of the table lookups.
+ * The keyswitched ciphertexts never leave the device: they are written to
+ * lwe_array_ks, which must hold num_samples * (lwe_dimension + 1) elements,
+ * and the bootstrap reads them from there in stream order.
+ *
+ * - ks_lwe_dimension_in is the dimension of the input ciphertexts, and
+ *   lwe_dimension the dimension after the keyswitch, i.e. the input dimension
+ *   of the bootstrap
+ * - ks_base_log, ks_level_count are the decomposition parameters of the
+ *   keyswitch, base_log, level_count the ones of the bootstrap
+ * - the other arguments are the ones of
+ *   cuda_bootstrap_amortized_lwe_ciphertext_vector_64
+ */
+void cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+    void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lut_vector,
+    void *lut_vector_indexes, void *lwe_array_in, void *lwe_array_ks,
+    void *ksk, void *bootstrapping_key, int8_t *pbs_buffer,
+    uint32_t ks_lwe_dimension_in, uint32_t lwe_dimension,
+    uint32_t glwe_dimension, uint32_t polynomial_size, uint32_t ks_base_log,
+    uint32_t ks_level_count, uint32_t base_log, uint32_t level_count,
+    uint32_t num_samples, uint32_t num_lut_vectors, uint32_t lwe_idx,
+    uint32_t max_shared_memory) {
+  cuda_keyswitch_lwe_ciphertext_vector_64(
+      v_stream, gpu_index, lwe_array_ks, lwe_array_in, ksk,
+      ks_lwe_dimension_in, lwe_dimension, ks_base_log, ks_level_count,
+      num_samples);
+  cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
+      v_stream, gpu_index, lwe_array_out, lut_vector, lut_vector_indexes,
+      lwe_array_ks, bootstrapping_key, pbs_buffer, lwe_dimension,
+      glwe_dimension, polynomial_size, base_log, level_count, num_samples,
+      num_lut_vectors, lwe_idx, max_shared_memory);
+}
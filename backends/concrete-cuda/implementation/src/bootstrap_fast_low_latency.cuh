@@ -326,9 +326,64 @@ __host__ void scratch_bootstrap_fast_low_latency(
   }
 }
 
+// Returns the maximum number of samples that can be bootstrapped by a single
+// cooperative launch of the low latency kernel, i.e. such that all the blocks
+// of the grid are resident at the same time. Returns 0 if cooperative groups
+// are not supported or if not even one sample fits.
+template <typename Torus, class params>
+__host__ uint32_t get_max_samples_per_launch_fast_low_latency(
+    int glwe_dimension, int level_count, uint32_t max_shared_memory) {
+
+  // If Cooperative Groups is not supported, no need to check anything else
+  if (!cuda_check_support_cooperative_groups())
+    return 0;
+
+  // Calculate the dimension of the kernel
+  uint64_t full_sm =
+      get_buffer_size_full_sm_bootstrap_fast_low_latency<Torus>(params::degree);
+
+  uint64_t partial_sm =
+      get_buffer_size_partial_sm_bootstrap_fast_low_latency<Torus>(
+          params::degree);
+
+  int thds = params::degree / params::opt;
+
+  // Get the maximum number of active blocks per streaming multiprocessors,
+  // taking the dynamic shared memory of each variant into account
+  int max_active_blocks_per_sm = 0;
+
+  if (max_shared_memory < partial_sm) {
+    cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+        &max_active_blocks_per_sm,
+        (void *)device_bootstrap_fast_low_latency<Torus, params, NOSM>, thds,
+        0);
+  } else if (max_shared_memory < full_sm) {
+    cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+        &max_active_blocks_per_sm,
+        (void *)device_bootstrap_fast_low_latency<Torus, params, PARTIALSM>,
+        thds, partial_sm);
+  } else {
+    cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+        &max_active_blocks_per_sm,
+        (void *)device_bootstrap_fast_low_latency<Torus, params, FULLSM>, thds,
+        full_sm);
+  }
+
+  // Get the number of streaming multiprocessors
+  int number_of_sm = 0;
+  cudaDeviceGetAttribute(&number_of_sm, cudaDevAttrMultiProcessorCount, 0);
+  int blocks_per_sample = level_count * (glwe_dimension + 1);
+  return max_active_blocks_per_sm * number_of_sm / blocks_per_sample;
+}
+
 /*
  * Host wrapper to the low latency version
  * of bootstrapping
+ *
+ * The blocks of a cooperative launch must all be resident at the same time,
+ * so batches that are too large for the device are bootstrapped by successive
+ * launches on slices of the batch. The launches being serialized on the
+ * stream, they share the same scratch buffer.
  */
 template <typename Torus, class params>
 __host__ void host_bootstrap_fast_low_latency(
@@ -365,88 +420,72 @@ __host__ void host_bootstrap_fast_low_latency(
                       input_lwe_ciphertext_count * polynomial_size / 2);
 
   int thds = polynomial_size / params::opt;
-  dim3 grid(level_count, glwe_dimension + 1, input_lwe_ciphertext_count);
-
-  void *kernel_args[12];
-  kernel_args[0] = &lwe_array_out;
-  kernel_args[1] = &lut_vector;
-  kernel_args[2] = &lut_vector_indexes;
-  kernel_args[3] = &lwe_array_in;
-  kernel_args[4] = &bootstrapping_key;
-  kernel_args[5] = &buffer_fft;
-  kernel_args[6] = &lwe_dimension;
-  kernel_args[7] = &polynomial_size;
-  kernel_args[8] = &base_log;
-  kernel_args[9] = &level_count;
-  kernel_args[10] = &d_mem;
+  uint32_t max_samples_per_launch =
+      get_max_samples_per_launch_fast_low_latency<Torus, params>(
+          glwe_dimension, level_count, max_shared_memory);
+  assert(("Error (GPU low latency PBS): the grid of a single sample should "
+           "fit on the device with cooperative groups",
+           max_samples_per_launch > 0));
+
+  for (uint32_t first_sample = 0; first_sample < input_lwe_ciphertext_count;
+       first_sample += max_samples_per_launch) {
+    uint32_t num_samples = std::min(max_samples_per_launch,
+                                    input_lwe_ciphertext_count - first_sample);
+    dim3 grid(level_count, glwe_dimension + 1, num_samples);
+
+    Torus *slice_lwe_array_out =
+        lwe_array_out +
+        (ptrdiff_t)first_sample * (glwe_dimension * polynomial_size + 1);
+    Torus *slice_lut_vector_indexes = lut_vector_indexes + first_sample;
+    Torus *slice_lwe_array_in =
+        lwe_array_in + (ptrdiff_t)first_sample * (lwe_dimension + 1);
+
+    void *kernel_args[12];
+    kernel_args[0] = &slice_lwe_array_out;
+    kernel_args[1] = &lut_vector;
+    kernel_args[2] = &slice_lut_vector_indexes;
+    kernel_args[3] = &slice_lwe_array_in;
+    kernel_args[4] = &bootstrapping_key;
+    kernel_args[5] = &buffer_fft;
+    kernel_args[6] = &lwe_dimension;
+    kernel_args[7] = &polynomial_size;
+    kernel_args[8] = &base_log;
+    kernel_args[9] = &level_count;
+    kernel_args[10] = &d_mem;
+
+    if (max_shared_memory < partial_sm) {
+      kernel_args[11] = &full_dm;
+      check_cuda_error(cudaLaunchCooperativeKernel(
+          (void *)device_bootstrap_fast_low_latency<Torus, params, NOSM>, grid,
+          thds, (void **)kernel_args, 0, *stream));
+    } else if (max_shared_memory < full_sm) {
+      kernel_args[11] = &partial_dm;
+      check_cuda_error(cudaLaunchCooperativeKernel(
+          (void *)device_bootstrap_fast_low_latency<Torus, params, PARTIALSM>,
+          grid, thds, (void **)kernel_args, partial_sm, *stream));
+    } else {
+      int no_dm = 0;
+      kernel_args[11] = &no_dm;
+      check_cuda_error(cudaLaunchCooperativeKernel(
+          (void *)device_bootstrap_fast_low_latency<Torus, params, FULLSM>,
+          grid, thds, (void **)kernel_args, full_sm, *stream));
+    }
 
-  if (max_shared_memory < partial_sm) {
-    kernel_args[11] = &full_dm;
-    check_cuda_error(cudaLaunchCooperativeKernel(
-        (void *)device_bootstrap_fast_low_latency<Torus, params, NOSM>, grid,
-        thds, (void **)kernel_args, 0, *stream));
-  } else if (max_shared_memory < full_sm) {
-    kernel_args[11] = &partial_dm;
-    check_cuda_error(cudaLaunchCooperativeKernel(
-        (void *)device_bootstrap_fast_low_latency<Torus, params, PARTIALSM>,
-        grid, thds, (void **)kernel_args, partial_sm, *stream));
-  } else {
-    int no_dm = 0;
-    kernel_args[11] = &no_dm;
-    check_cuda_error(cudaLaunchCooperativeKernel(
-        (void *)device_bootstrap_fast_low_latency<Torus, params, FULLSM>, grid,
-        thds, (void **)kernel_args, full_sm, *stream));
+    check_cuda_error(cudaGetLastError());
   }
-
-  check_cuda_error(cudaGetLastError());
 }
 
 // Verify if the grid size for the low latency kernel satisfies the cooperative
-// group constraints
+// group constraints. Batches larger than what fits in a single cooperative
+// launch are split by host_bootstrap_fast_low_latency, so only the grid of one
+// sample needs to fit.
 template <typename Torus, class params>
 __host__ bool verify_cuda_bootstrap_fast_low_latency_grid_size(
     int glwe_dimension, int level_count, int num_samples,
     uint32_t max_shared_memory) {
-
-  // If Cooperative Groups is not supported, no need to check anything else
-  if (!cuda_check_support_cooperative_groups())
-    return false;
-
-  // Calculate the dimension of the kernel
-  uint64_t full_sm =
-      get_buffer_size_full_sm_bootstrap_fast_low_latency<Torus>(params::degree);
-
-  uint64_t partial_sm =
-      get_buffer_size_partial_sm_bootstrap_fast_low_latency<Torus>(
-          params::degree);
-
-  int thds = params::degree / params::opt;
-
-  // Get the maximum number of active blocks per streaming multiprocessors
-  int number_of_blocks = level_count * (glwe_dimension + 1) * num_samples;
-  int max_active_blocks_per_sm;
-
-  if (max_shared_memory < partial_sm) {
-    cudaOccupancyMaxActiveBlocksPerMultiprocessor(
-        &max_active_blocks_per_sm,
-        (void *)device_bootstrap_fast_low_latency<Torus, params, NOSM>, thds,
-        0);
-  } else if (max_shared_memory < full_sm) {
-    cudaOccupancyMaxActiveBlocksPerMultiprocessor(
-        &max_active_blocks_per_sm,
-        (void *)device_bootstrap_fast_low_latency<Torus, params, PARTIALSM>,
-        thds, 0);
-  } else {
-    cudaOccupancyMaxActiveBlocksPerMultiprocessor(
-        &max_active_blocks_per_sm,
-        (void *)device_bootstrap_fast_low_latency<Torus, params, FULLSM>, thds,
-        0);
-  }
-
-  // Get the number of streaming multiprocessors
-  int number_of_sm = 0;
-  cudaDeviceGetAttribute(&number_of_sm, cudaDevAttrMultiProcessorCount, 0);
-  return number_of_blocks <= max_active_blocks_per_sm * number_of_sm;
+  return num_samples > 0 &&
+         get_max_samples_per_launch_fast_low_latency<Torus, params>(
+             glwe_dimension, level_count, max_shared_memory) > 0;
 }
 
 #endif // LOWLAT_FAST_PBS_H
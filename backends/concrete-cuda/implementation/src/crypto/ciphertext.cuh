@@ -47,4 +47,35 @@ void cuda_convert_lwe_ciphertext_vector_to_cpu_64(void *dest, void *src,
       lwe_dimension);
 }
 
+/*
+ * Expands the polynomials of lut_bodies, already on the device, into trivial
+ * GLWE encryptions in lut_vector, as expected by the bootstraps. Each block
+ * handles one polynomial of one GLWE, the mask polynomials being zeros.
+ */
+template <typename T>
+__global__ void device_glwe_trivial_encrypt(T *lut_vector, T *lut_bodies,
+                                            uint32_t glwe_dimension,
+                                            uint32_t polynomial_size) {
+  T *polynomial = &lut_vector[(blockIdx.x * (glwe_dimension + 1) + blockIdx.y) *
+                              polynomial_size];
+  T *body = &lut_bodies[blockIdx.x * polynomial_size];
+  bool is_body = blockIdx.y == glwe_dimension;
+  for (int i = threadIdx.x; i < polynomial_size; i += blockDim.x)
+    polynomial[i] = is_body ? body[i] : 0;
+}
+
+void cuda_glwe_trivial_encrypt_lut_vector_64(
+    void *v_stream, uint32_t gpu_index, void *lut_vector, void *lut_bodies,
+    uint32_t number_of_luts, uint32_t glwe_dimension,
+    uint32_t polynomial_size) {
+  cudaSetDevice(gpu_index);
+  cudaStream_t *stream = static_cast<cudaStream_t *>(v_stream);
+  dim3 grid(number_of_luts, glwe_dimension + 1);
+  int thds = min(polynomial_size, 1024u);
+  device_glwe_trivial_encrypt<uint64_t><<<grid, thds, 0, *stream>>>(
+      (uint64_t *)lut_vector, (uint64_t *)lut_bodies, glwe_dimension,
+      polynomial_size);
+  check_cuda_error(cudaGetLastError());
+}
+
 #endif
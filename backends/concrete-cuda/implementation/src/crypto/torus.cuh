@@ -30,7 +30,7 @@ template <typename T>
 __device__ inline T round_to_closest_multiple(T x, uint32_t base_log,
                                               uint32_t level_count) {
   T shift = sizeof(T) * 8 - level_count * base_log;
-  T mask = 1ll << (shift - 1);
+  T mask = (T)1 << (shift - 1);
   T b = (x & mask) >> (shift - 1);
   T res = x >> shift;
   res += b;
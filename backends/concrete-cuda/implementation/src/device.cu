@@ -218,6 +218,36 @@ int cuda_drop_async(void *ptr, cudaStream_t *stream, uint32_t gpu_index) {
   return 0;
 }
 
+/// Set the amount of memory the default memory pool of the device keeps
+/// reserved when it is freed, instead of releasing it to the OS at the next
+/// synchronization. Allocations made through cuda_malloc_async of up to that
+/// size are then served by the pool without trips to the driver.
+/// 0: success
+/// -1: memory pools not supported by the device
+/// -2: invalid, gpu index doesn't exist
+int cuda_set_mem_pool_release_threshold(uint64_t threshold,
+                                        uint32_t gpu_index) {
+  if (gpu_index >= cuda_get_number_of_gpus()) {
+    // error code: invalid gpu_index
+    return -2;
+  }
+  cudaSetDevice(gpu_index);
+#if (CUDART_VERSION >= 11020)
+  int support_async_alloc;
+  check_cuda_error(cudaDeviceGetAttribute(
+      &support_async_alloc, cudaDevAttrMemoryPoolsSupported, gpu_index));
+  if (!support_async_alloc)
+    return -1;
+  cudaMemPool_t pool;
+  check_cuda_error(cudaDeviceGetDefaultMemPool(&pool, gpu_index));
+  check_cuda_error(cudaMemPoolSetAttribute(
+      pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+  return 0;
+#else
+  return -1;
+#endif
+}
+
 /// Get the maximum size for the shared memory
 int cuda_get_max_shared_memory(uint32_t gpu_index) {
   if (gpu_index >= cuda_get_number_of_gpus()) {
@@ -43,6 +43,20 @@ void cuda_keyswitch_lwe_ciphertext_vector_64(
       lwe_dimension_in, lwe_dimension_out, base_log, level_count, num_samples);
 }
 
+/* Perform keyswitch on a batch of 128 bits input LWE ciphertexts, each
+ * coefficient being a little endian __uint128_t. Head out to the equivalent
+ * operation on 64 bits for more details.
+ */
+void cuda_keyswitch_lwe_ciphertext_vector_128(
+    void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lwe_array_in,
+    void *ksk, uint32_t lwe_dimension_in, uint32_t lwe_dimension_out,
+    uint32_t base_log, uint32_t level_count, uint32_t num_samples) {
+  cuda_keyswitch_lwe_ciphertext_vector(
+      v_stream, gpu_index, static_cast<__uint128_t *>(lwe_array_out),
+      static_cast<__uint128_t *>(lwe_array_in), static_cast<__uint128_t *>(ksk),
+      lwe_dimension_in, lwe_dimension_out, base_log, level_count, num_samples);
+}
+
 /* Perform functional packing keyswitch on a batch of 32 bits input LWE
  * ciphertexts. See the equivalent function on 64 bit inputs for more details.
  */
@@ -161,6 +161,84 @@ __global__ void keyswitch(Torus *lwe_array_out, Torus *lwe_array_in, Torus *ksk,
   }
 }
 
+/*
+ * batched keyswitch kernel
+ * Same computation as `keyswitch`, for a tile of `tile_size` ciphertexts,
+ * blockIdx.y being the index of the tile. Each thread computes one output
+ * coefficient, blockIdx.x being the chunk of output coefficients, for all the
+ * ciphertexts of the tile: every element of the key read from global memory
+ * is applied to the whole tile instead of a single ciphertext. The input
+ * coefficients of the tile are decomposed cooperatively, `input_chunk_size` at
+ * a time, into shared memory.
+ */
+template <typename Torus, int tile_size, int input_chunk_size>
+__global__ void batched_keyswitch(Torus *lwe_array_out, Torus *lwe_array_in,
+                                  Torus *ksk, uint32_t lwe_dimension_in,
+                                  uint32_t lwe_dimension_out,
+                                  uint32_t base_log, uint32_t level_count,
+                                  uint32_t num_samples) {
+  extern __shared__ int8_t sharedmem[];
+
+  // decomposition of the input coefficients of the chunk, laid out as
+  // [input coefficient][ciphertext][level]
+  Torus *decomposed_chunk = (Torus *)sharedmem;
+
+  int out_idx = blockIdx.x * blockDim.x + threadIdx.x;
+  int first_ciphertext = blockIdx.y * tile_size;
+  int tile_count = min(tile_size, (int)num_samples - first_ciphertext);
+  int lwe_size_in = lwe_dimension_in + 1;
+  int lwe_size_out = lwe_dimension_out + 1;
+  Torus *tile_lwe_array_in = &lwe_array_in[first_ciphertext * lwe_size_in];
+
+  Torus acc[tile_size];
+  for (int c = 0; c < tile_size; c++) {
+    acc[c] = (out_idx == lwe_dimension_out && c < tile_count)
+                 ? tile_lwe_array_in[c * lwe_size_in + lwe_dimension_in]
+                 : 0;
+  }
+
+  Torus mask_mod_b = (1ll << base_log) - 1ll;
+  for (int chunk = 0; chunk < lwe_dimension_in; chunk += input_chunk_size) {
+    __syncthreads();
+    for (int p = threadIdx.x; p < input_chunk_size * tile_size;
+         p += blockDim.x) {
+      int i = chunk + p / tile_size;
+      int c = p % tile_size;
+      Torus *decomposed = &decomposed_chunk[p * level_count];
+      if (i < lwe_dimension_in && c < tile_count) {
+        Torus a_i = round_to_closest_multiple(
+            tile_lwe_array_in[c * lwe_size_in + i], base_log, level_count);
+        Torus state = a_i >> (sizeof(Torus) * 8 - base_log * level_count);
+        for (int j = 0; j < level_count; j++)
+          decomposed[j] = decompose_one<Torus>(state, mask_mod_b, base_log);
+      } else {
+        for (int j = 0; j < level_count; j++)
+          decomposed[j] = 0;
+      }
+    }
+    __syncthreads();
+
+    if (out_idx >= lwe_size_out)
+      continue;
+    int chunk_end = min(chunk + input_chunk_size, (int)lwe_dimension_in);
+    for (int i = chunk; i < chunk_end; i++) {
+      Torus *decomposed =
+          &decomposed_chunk[(i - chunk) * tile_size * level_count];
+      for (int j = 0; j < level_count; j++) {
+        Torus ksk_coef =
+            get_ith_block(ksk, i, j, lwe_dimension_out, level_count)[out_idx];
+        for (int c = 0; c < tile_size; c++)
+          acc[c] -= ksk_coef * decomposed[c * level_count + j];
+      }
+    }
+  }
+
+  if (out_idx < lwe_size_out) {
+    for (int c = 0; c < tile_count; c++)
+      lwe_array_out[(first_ciphertext + c) * lwe_size_out + out_idx] = acc[c];
+  }
+}
+
 /// assume lwe_array_in in the gpu
 template <typename Torus>
 __host__ void cuda_keyswitch_lwe_ciphertext_vector(
@@ -171,6 +249,25 @@ __host__ void cuda_keyswitch_lwe_ciphertext_vector(
 
   cudaSetDevice(gpu_index);
   constexpr int ideal_threads = 128;
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+
+  // Batches share the reads of the key between the ciphertexts of a tile
+  if (num_samples > 1) {
+    constexpr int tile_size = 8;
+    constexpr int input_chunk_size = 32;
+    int shared_mem = sizeof(Torus) * input_chunk_size * tile_size * level_count;
+    dim3 grid((lwe_dimension_out + ideal_threads) / ideal_threads,
+              (num_samples + tile_size - 1) / tile_size, 1);
+    dim3 threads(ideal_threads, 1, 1);
+    auto kernel = batched_keyswitch<Torus, tile_size, input_chunk_size>;
+    cudaFuncSetAttribute(kernel, cudaFuncAttributeMaxDynamicSharedMemorySize,
+                         shared_mem);
+    kernel<<<grid, threads, shared_mem, *stream>>>(
+        lwe_array_out, lwe_array_in, ksk, lwe_dimension_in, lwe_dimension_out,
+        base_log, level_count, num_samples);
+    check_cuda_error(cudaGetLastError());
+    return;
+  }
 
   int lwe_dim = lwe_dimension_out + 1;
   int lwe_lower, lwe_upper, cutoff;
@@ -190,7 +287,6 @@ __host__ void cuda_keyswitch_lwe_ciphertext_vector(
 
   int shared_mem = sizeof(Torus) * (lwe_dimension_out + 1);
 
-  auto stream = static_cast<cudaStream_t *>(v_stream);
   cudaMemsetAsync(lwe_array_out, 0, sizeof(Torus) * lwe_size_after, *stream);
 
   dim3 grid(num_samples, 1, 1);
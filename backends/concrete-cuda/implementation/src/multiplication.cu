@@ -55,6 +55,44 @@ void cuda_mult_lwe_ciphertext_vector_cleartext_vector_64(
       input_lwe_ciphertext_count);
 }
 
+/*
+ * Apply the same affine transformation to all the ciphertexts of a u64 input
+ * LWE ciphertext vector.
+ * - `v_stream` is a void pointer to the Cuda stream to be used in the kernel
+ * launch
+ * - `gpu_index` is the index of the GPU to be used in the kernel launch
+ * - `lwe_array_out` is an array of size
+ * `(input_lwe_dimension + 1) * input_lwe_ciphertext_count` that should have
+ * been allocated on the GPU before calling this function, and that will hold
+ * the result of the computation. It may be the input array.
+ * - `lwe_array_in` is the LWE ciphertext vector used as input, it should have
+ * been allocated and initialized before calling this function. It has the same
+ * size as the output array.
+ * - `cleartext` is multiplied to the mask and body of every ciphertext
+ * - `plaintext` is then added to the body of every ciphertext
+ * - `input_lwe_dimension` is the number of mask elements in the input and
+ * output LWE ciphertext vectors
+ * - `input_lwe_ciphertext_count` is the number of ciphertexts contained in the
+ * input LWE ciphertext vector, as well as in the output.
+ *
+ * A chain of multiplications by constant cleartexts, additions of constant
+ * plaintexts and negations composes into a single such transformation, that is
+ * then applied in a single kernel launch.
+ */
+void cuda_affine_lwe_ciphertext_vector_64(void *v_stream, uint32_t gpu_index,
+                                          void *lwe_array_out,
+                                          void *lwe_array_in,
+                                          uint64_t cleartext,
+                                          uint64_t plaintext,
+                                          uint32_t input_lwe_dimension,
+                                          uint32_t input_lwe_ciphertext_count) {
+
+  host_affine_transformation(
+      v_stream, gpu_index, static_cast<uint64_t *>(lwe_array_out),
+      static_cast<uint64_t *>(lwe_array_in), cleartext, plaintext,
+      input_lwe_dimension, input_lwe_ciphertext_count);
+}
+
 
 /*
  * This scratch function allocates the necessary amount of data on the GPU for
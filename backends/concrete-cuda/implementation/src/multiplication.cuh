@@ -60,6 +60,46 @@ host_cleartext_multiplication(void *v_stream, uint32_t gpu_index, T *output,
   check_cuda_error(cudaGetLastError());
 }
 
+template <typename T>
+__global__ void affine_transformation(T *output, T *lwe_input, T cleartext,
+                                      T plaintext,
+                                      uint32_t input_lwe_dimension,
+                                      uint32_t num_entries) {
+
+  int tid = threadIdx.x;
+  int index = blockIdx.x * blockDim.x + tid;
+  if (index < num_entries) {
+    bool is_body = index % (input_lwe_dimension + 1) == input_lwe_dimension;
+    // Here we take advantage of the wrapping behaviour of uint
+    output[index] = lwe_input[index] * cleartext + (is_body ? plaintext : 0);
+  }
+}
+
+template <typename T>
+__host__ void
+host_affine_transformation(void *v_stream, uint32_t gpu_index, T *output,
+                           T *lwe_input, T cleartext, T plaintext,
+                           uint32_t input_lwe_dimension,
+                           uint32_t input_lwe_ciphertext_count) {
+
+  cudaSetDevice(gpu_index);
+  // lwe_size includes the presence of the body
+  // whereas lwe_dimension is the number of elements in the mask
+  int lwe_size = input_lwe_dimension + 1;
+  // Create a 1-dimensional grid of threads
+  int num_blocks = 0, num_threads = 0;
+  int num_entries = input_lwe_ciphertext_count * lwe_size;
+  getNumBlocksAndThreads(num_entries, 512, num_blocks, num_threads);
+  dim3 grid(num_blocks, 1, 1);
+  dim3 thds(num_threads, 1, 1);
+
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  affine_transformation<<<grid, thds, 0, *stream>>>(
+      output, lwe_input, cleartext, plaintext, input_lwe_dimension,
+      num_entries);
+  check_cuda_error(cudaGetLastError());
+}
+
 template <typename Torus, class params>
 __global__ void fill(Torus *array, Torus value, int N) {
   int idx = blockIdx.x * blockDim.x + threadIdx.x;
@@ -0,0 +1,188 @@
+#include "bootstrap.h"
+#include "device.h"
+#include "ntt.cuh"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// The torus operand of the multiplication is split in limbs of this many bits,
+// so that every partial product fits in the field without wrapping.
+#define NTT_LIMB_BITS 16
+
+namespace {
+
+uint64_t ntt_pow(uint64_t base, uint64_t exponent) {
+  uint64_t result = 1;
+  while (exponent != 0) {
+    if (exponent & 1)
+      result = ntt_mul(result, base);
+    base = ntt_mul(base, base);
+    exponent >>= 1;
+  }
+  return result;
+}
+
+uint32_t bit_reverse(uint32_t value, uint32_t log_n) {
+  uint32_t result = 0;
+  for (uint32_t i = 0; i < log_n; i++) {
+    result = (result << 1) | (value & 1);
+    value >>= 1;
+  }
+  return result;
+}
+
+/// The forward and inverse twiddles of a polynomial size, on a device.
+struct NTTTwiddles {
+  uint64_t *psi;
+  uint64_t *psi_inv;
+  uint64_t n_inv;
+};
+
+/// Returns the twiddles of the negacyclic NTT of size n on the device,
+/// computing and uploading them on the first use.
+NTTTwiddles get_ntt_twiddles(uint32_t n, uint32_t gpu_index) {
+  static std::mutex guard;
+  static std::map<std::pair<uint32_t, uint32_t>, NTTTwiddles> twiddles;
+  const std::lock_guard<std::mutex> lock(guard);
+  auto it = twiddles.find({gpu_index, n});
+  if (it != twiddles.end())
+    return it->second;
+
+  uint32_t log_n = 0;
+  while ((1u << log_n) < n)
+    log_n++;
+  // 7 generates the multiplicative group of the field
+  uint64_t psi = ntt_pow(7, (NTT_PRIME - 1) / (2 * (uint64_t)n));
+  uint64_t psi_inv = ntt_pow(psi, NTT_PRIME - 2);
+  std::vector<uint64_t> h_psi(n), h_psi_inv(n);
+  for (uint32_t k = 0; k < n; k++) {
+    h_psi[k] = ntt_pow(psi, bit_reverse(k, log_n));
+    h_psi_inv[k] = ntt_pow(psi_inv, bit_reverse(k, log_n));
+  }
+  NTTTwiddles result;
+  result.psi = (uint64_t *)cuda_malloc(n * sizeof(uint64_t), gpu_index);
+  result.psi_inv = (uint64_t *)cuda_malloc(n * sizeof(uint64_t), gpu_index);
+  cuda_memcpy_to_gpu(result.psi, h_psi.data(), n * sizeof(uint64_t),
+                     gpu_index);
+  cuda_memcpy_to_gpu(result.psi_inv, h_psi_inv.data(), n * sizeof(uint64_t),
+                     gpu_index);
+  result.n_inv = ntt_pow(n, NTT_PRIME - 2);
+  twiddles[{gpu_index, n}] = result;
+  return result;
+}
+
+} // namespace
+
+/*
+ * Each block computes the negacyclic product of one pair of polynomials: the
+ * integer polynomial is transformed once, and each limb of the torus
+ * polynomial is transformed, multiplied, transformed back and accumulated in
+ * the output at its position.
+ */
+__global__ void batch_ntt_polynomial_mul(const int64_t *input1,
+                                         const uint64_t *input2,
+                                         uint64_t *output, const uint64_t *psi,
+                                         const uint64_t *psi_inv,
+                                         uint64_t n_inv, uint32_t n,
+                                         uint64_t *device_mem) {
+  extern __shared__ uint64_t sharedmem[];
+  uint64_t *a = (device_mem == nullptr) ? sharedmem
+                                        : &device_mem[blockIdx.x * 2 * n];
+  uint64_t *b = a + n;
+  auto in1 = &input1[blockIdx.x * n];
+  auto in2 = &input2[blockIdx.x * n];
+  auto out = &output[blockIdx.x * n];
+
+  for (uint32_t k = threadIdx.x; k < n; k += blockDim.x) {
+    a[k] = ntt_from_signed(in1[k]);
+    out[k] = 0;
+  }
+  NTT_direct(a, psi, n);
+
+  for (uint32_t shift = 0; shift < 64; shift += NTT_LIMB_BITS) {
+    for (uint32_t k = threadIdx.x; k < n; k += blockDim.x)
+      b[k] = (in2[k] >> shift) & ((1ULL << NTT_LIMB_BITS) - 1);
+    NTT_direct(b, psi, n);
+    for (uint32_t k = threadIdx.x; k < n; k += blockDim.x)
+      b[k] = ntt_mul(a[k], b[k]);
+    NTT_inverse(b, psi_inv, n_inv, n);
+    // The partial product is exact, its wrapping shift is the product modulo
+    // 2^64.
+    for (uint32_t k = threadIdx.x; k < n; k += blockDim.x)
+      out[k] += ntt_to_signed(b[k]) << shift;
+  }
+}
+
+/*
+ * Exact negacyclic product modulo 2^64 of total_polynomials pairs of
+ * polynomials, without any floating point arithmetic.
+ *  - input1: integer polynomials (e.g. decomposed ones) whose coefficients
+ *    have a magnitude lower than 2^(63 - 16) / polynomial_size
+ *  - input2: torus polynomials
+ *  - output: the products, as torus polynomials
+ */
+void cuda_ntt_polynomial_mul_64(void *input1, void *input2, void *output,
+                                void *v_stream, uint32_t gpu_index,
+                                uint32_t polynomial_size,
+                                uint32_t total_polynomials) {
+  auto stream = static_cast<cudaStream_t *>(v_stream);
+  auto twiddles = get_ntt_twiddles(polynomial_size, gpu_index);
+
+  size_t shared_memory_size = 2 * polynomial_size * sizeof(uint64_t);
+  int gridSize = total_polynomials;
+  int blockSize = std::min(polynomial_size / 2, 512u);
+
+  cudaSetDevice(gpu_index);
+  uint64_t *device_mem = nullptr;
+  if (shared_memory_size <= cuda_get_max_shared_memory(gpu_index)) {
+    check_cuda_error(cudaFuncSetAttribute(
+        batch_ntt_polynomial_mul, cudaFuncAttributeMaxDynamicSharedMemorySize,
+        shared_memory_size));
+    batch_ntt_polynomial_mul<<<gridSize, blockSize, shared_memory_size,
+                               *stream>>>(
+        (int64_t *)input1, (uint64_t *)input2, (uint64_t *)output,
+        twiddles.psi, twiddles.psi_inv, twiddles.n_inv, polynomial_size,
+        nullptr);
+  } else {
+    device_mem = (uint64_t *)cuda_malloc_async(
+        shared_memory_size * total_polynomials, stream, gpu_index);
+    batch_ntt_polynomial_mul<<<gridSize, blockSize, 0, *stream>>>(
+        (int64_t *)input1, (uint64_t *)input2, (uint64_t *)output,
+        twiddles.psi, twiddles.psi_inv, twiddles.n_inv, polynomial_size,
+        device_mem);
+  }
+  check_cuda_error(cudaGetLastError());
+  if (device_mem != nullptr)
+    cuda_drop_async(device_mem, stream, gpu_index);
+}
+
+namespace {
+std::mutex backends_guard;
+std::map<uint32_t, POLYNOMIAL_MUL_BACKEND> backends;
+} // namespace
+
+/*
+ * Returns the polynomial multiplication backend of a device. Unless set with
+ * cuda_set_polynomial_mul_backend, the NTT is preferred on the devices whose
+ * FP64 throughput is lower than an eighth of their FP32 one.
+ */
+POLYNOMIAL_MUL_BACKEND cuda_get_polynomial_mul_backend(uint32_t gpu_index) {
+  const std::lock_guard<std::mutex> lock(backends_guard);
+  auto it = backends.find(gpu_index);
+  if (it != backends.end())
+    return it->second;
+  int ratio = 1;
+  cudaDeviceGetAttribute(&ratio, cudaDevAttrSingleToDoublePrecisionPerfRatio,
+                         gpu_index);
+  POLYNOMIAL_MUL_BACKEND backend = (ratio > 8) ? NTT_U64 : FFT_F64;
+  backends[gpu_index] = backend;
+  return backend;
+}
+
+void cuda_set_polynomial_mul_backend(uint32_t gpu_index,
+                                     POLYNOMIAL_MUL_BACKEND backend) {
+  const std::lock_guard<std::mutex> lock(backends_guard);
+  backends[gpu_index] = backend;
+}
@@ -0,0 +1,120 @@
+#ifndef GPU_BOOTSTRAP_NTT_CUH
+#define GPU_BOOTSTRAP_NTT_CUH
+
+#include <cstdint>
+
+/*
+ * Negacyclic number theoretic transform over the prime field of
+ * p = 2^64 - 2^32 + 1, used as an integer-only alternative to the double
+ * precision negacyclic FFT on devices with a low FP64 throughput.
+ *
+ * p - 1 = 2^32 (2^32 - 1), so the field holds the 2N-th roots of unity needed
+ * for the negacyclic transform of every supported polynomial size, and the
+ * modular reduction only needs 64 bits additions, subtractions and shifts
+ * since 2^64 = 2^32 - 1 mod p.
+ *
+ *   - the forward transform is a Cooley-Tukey one taking its input in
+ *     natural order and producing its output in bit reversed order
+ *   - the inverse transform is a Gentleman-Sande one taking its input in
+ *     bit reversed order and producing its output in natural order
+ *   - instead of twisting the coefficients by the powers of the 2N-th root of
+ *     unity psi before and after the transforms, the twiddles of each level
+ *     are the psi^(2 bitrev(j) + 1), stored in bit reversed order
+ */
+
+#define NTT_PRIME 0xFFFFFFFF00000001ULL
+// 2^64 mod p
+#define NTT_EPSILON 0xFFFFFFFFULL
+
+__host__ __device__ inline uint64_t ntt_reduce(uint64_t lo, uint64_t hi) {
+  uint64_t hi_hi = hi >> 32;
+  uint64_t hi_lo = hi & NTT_EPSILON;
+  // lo - hi_hi, as 2^96 = -1 mod p
+  uint64_t t0 = lo - hi_hi;
+  if (lo < hi_hi)
+    t0 -= NTT_EPSILON;
+  // + hi_lo * 2^64
+  uint64_t t1 = hi_lo * NTT_EPSILON;
+  uint64_t t2 = t0 + t1;
+  if (t2 < t1)
+    t2 += NTT_EPSILON;
+  return (t2 >= NTT_PRIME) ? t2 - NTT_PRIME : t2;
+}
+
+__host__ __device__ inline uint64_t ntt_add(uint64_t a, uint64_t b) {
+  uint64_t s = a + b;
+  if (s < a)
+    s += NTT_EPSILON;
+  return (s >= NTT_PRIME) ? s - NTT_PRIME : s;
+}
+
+__host__ __device__ inline uint64_t ntt_sub(uint64_t a, uint64_t b) {
+  return (a >= b) ? a - b : a + (NTT_PRIME - b);
+}
+
+__host__ __device__ inline uint64_t ntt_mul(uint64_t a, uint64_t b) {
+#ifdef __CUDA_ARCH__
+  return ntt_reduce(a * b, __umul64hi(a, b));
+#else
+  unsigned __int128 r = (unsigned __int128)a * b;
+  return ntt_reduce((uint64_t)r, (uint64_t)(r >> 64));
+#endif
+}
+
+/// Maps a signed integer of magnitude lower than p / 2 to the field.
+__host__ __device__ inline uint64_t ntt_from_signed(int64_t a) {
+  return (a >= 0) ? (uint64_t)a : NTT_PRIME + (uint64_t)a;
+}
+
+/// Maps a field element back to the signed integer of minimal magnitude, as
+/// a two's complement word.
+__host__ __device__ inline uint64_t ntt_to_signed(uint64_t a) {
+  return (a > NTT_PRIME / 2) ? a - NTT_PRIME : a;
+}
+
+/*
+ * Forward negacyclic NTT of the n coefficients of A, done by the whole block.
+ * `psi` holds the n forward twiddles in bit reversed order.
+ */
+__device__ inline void NTT_direct(uint64_t *A, const uint64_t *psi,
+                                  uint32_t n) {
+  __syncthreads();
+  for (uint32_t m = 1, t = n / 2; m < n; m *= 2, t /= 2) {
+    for (uint32_t k = threadIdx.x; k < n / 2; k += blockDim.x) {
+      uint32_t i = k / t;
+      uint32_t j = 2 * i * t + (k % t);
+      uint64_t u = A[j];
+      uint64_t v = ntt_mul(A[j + t], psi[m + i]);
+      A[j] = ntt_add(u, v);
+      A[j + t] = ntt_sub(u, v);
+    }
+    __syncthreads();
+  }
+}
+
+/*
+ * Inverse negacyclic NTT of the n coefficients of A, done by the whole block.
+ * `psi_inv` holds the n inverse twiddles in bit reversed order and `n_inv` is
+ * the inverse of n in the field.
+ */
+__device__ inline void NTT_inverse(uint64_t *A, const uint64_t *psi_inv,
+                                   uint64_t n_inv, uint32_t n) {
+  __syncthreads();
+  for (uint32_t m = n, t = 1; m > 1; m /= 2, t *= 2) {
+    uint32_t h = m / 2;
+    for (uint32_t k = threadIdx.x; k < n / 2; k += blockDim.x) {
+      uint32_t i = k / t;
+      uint32_t j = 2 * i * t + (k % t);
+      uint64_t u = A[j];
+      uint64_t v = A[j + t];
+      A[j] = ntt_add(u, v);
+      A[j + t] = ntt_mul(ntt_sub(u, v), psi_inv[h + i]);
+    }
+    __syncthreads();
+  }
+  for (uint32_t k = threadIdx.x; k < n; k += blockDim.x)
+    A[k] = ntt_mul(A[k], n_inv);
+  __syncthreads();
+}
+
+#endif // GPU_BOOTSTRAP_NTT_CUH
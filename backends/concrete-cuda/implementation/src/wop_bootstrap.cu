@@ -200,42 +200,48 @@ void scratch_cuda_wop_pbs_32(void *v_stream, uint32_t gpu_index,
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, crt_decomposition_size, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 512:
     scratch_wop_pbs<uint32_t, int32_t, Degree<512>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, crt_decomposition_size, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 1024:
     scratch_wop_pbs<uint32_t, int32_t, Degree<1024>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, crt_decomposition_size, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 2048:
     scratch_wop_pbs<uint32_t, int32_t, Degree<2048>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, crt_decomposition_size, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 4096:
     scratch_wop_pbs<uint32_t, int32_t, Degree<4096>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, crt_decomposition_size, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 8192:
     scratch_wop_pbs<uint32_t, int32_t, Degree<8192>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, crt_decomposition_size, max_shared_memory,
+        allocate_gpu_memory);
     break;
   default:
     break;
@@ -246,17 +252,16 @@ void scratch_cuda_wop_pbs_32(void *v_stream, uint32_t gpu_index,
  * This scratch function allocates the necessary amount of data on the GPU for
  * the wop PBS on 64 bits inputs, into `wop_pbs_buffer`. It also fills the value
  * of delta_log and cbs_delta_log to be used in the bit extract and circuit
- * bootstrap.
+ * bootstrap. `number_of_luts` lookup tables, which may be more than the
+ * blocks of the CRT decomposition, are evaluated on the same extracted bits.
  */
-void scratch_cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index,
-                             int8_t **wop_pbs_buffer, uint32_t *delta_log_array,
-                             uint32_t *cbs_delta_log, uint32_t glwe_dimension,
-                             uint32_t lwe_dimension, uint32_t polynomial_size,
-                             uint32_t level_count_cbs, uint32_t level_count_bsk,
-                             uint32_t *number_of_bits_to_extract_array,
-                             uint32_t crt_decomposition_size,
-                             uint32_t max_shared_memory,
-                             bool allocate_gpu_memory) {
+void scratch_cuda_wop_pbs_many_lut_64(
+    void *v_stream, uint32_t gpu_index, int8_t **wop_pbs_buffer,
+    uint32_t *delta_log_array, uint32_t *cbs_delta_log, uint32_t glwe_dimension,
+    uint32_t lwe_dimension, uint32_t polynomial_size, uint32_t level_count_cbs,
+    uint32_t level_count_bsk, uint32_t *number_of_bits_to_extract_array,
+    uint32_t crt_decomposition_size, uint32_t number_of_luts,
+    uint32_t max_shared_memory, bool allocate_gpu_memory) {
   checks_wop_pbs(glwe_dimension, polynomial_size, level_count_bsk,
                  crt_decomposition_size, number_of_bits_to_extract_array);
   switch (polynomial_size) {
@@ -265,48 +270,75 @@ void scratch_cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index,
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 512:
     scratch_wop_pbs<uint64_t, int64_t, Degree<512>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 1024:
     scratch_wop_pbs<uint64_t, int64_t, Degree<1024>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 2048:
     scratch_wop_pbs<uint64_t, int64_t, Degree<2048>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 4096:
     scratch_wop_pbs<uint64_t, int64_t, Degree<4096>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory,
+        allocate_gpu_memory);
     break;
   case 8192:
     scratch_wop_pbs<uint64_t, int64_t, Degree<8192>>(
         v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
         glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
         level_count_bsk, number_of_bits_to_extract_array,
-        crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory,
+        allocate_gpu_memory);
     break;
   default:
     break;
   }
 }
 
+/*
+ * This scratch function allocates the necessary amount of data on the GPU for
+ * the wop PBS on 64 bits inputs with one lookup table per block of the CRT
+ * decomposition, see scratch_cuda_wop_pbs_many_lut_64.
+ */
+void scratch_cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index,
+                             int8_t **wop_pbs_buffer, uint32_t *delta_log_array,
+                             uint32_t *cbs_delta_log, uint32_t glwe_dimension,
+                             uint32_t lwe_dimension, uint32_t polynomial_size,
+                             uint32_t level_count_cbs, uint32_t level_count_bsk,
+                             uint32_t *number_of_bits_to_extract_array,
+                             uint32_t crt_decomposition_size,
+                             uint32_t max_shared_memory,
+                             bool allocate_gpu_memory) {
+  scratch_cuda_wop_pbs_many_lut_64(
+      v_stream, gpu_index, wop_pbs_buffer, delta_log_array, cbs_delta_log,
+      glwe_dimension, lwe_dimension, polynomial_size, level_count_cbs,
+      level_count_bsk, number_of_bits_to_extract_array, crt_decomposition_size,
+      crt_decomposition_size, max_shared_memory, allocate_gpu_memory);
+}
+
 /*
  * Entry point for cuda circuit bootstrap + vertical packing for batches of
  * input 64 bit LWE ciphertexts.
@@ -449,18 +481,16 @@ void cuda_circuit_bootstrap_vertical_packing_64(
  *  bootstrapping kernel
  *
  */
-void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
-                     void *lwe_array_in, void *lut_vector, void *fourier_bsk,
-                     void *ksk, void *cbs_fpksk, int8_t *wop_pbs_buffer,
-                     uint32_t cbs_delta_log, uint32_t glwe_dimension,
-                     uint32_t lwe_dimension, uint32_t polynomial_size,
-                     uint32_t base_log_bsk, uint32_t level_count_bsk,
-                     uint32_t base_log_ksk, uint32_t level_count_ksk,
-                     uint32_t base_log_pksk, uint32_t level_count_pksk,
-                     uint32_t base_log_cbs, uint32_t level_count_cbs,
-                     uint32_t *number_of_bits_to_extract_array,
-                     uint32_t *delta_log_array, uint32_t crt_decomposition_size,
-                     uint32_t max_shared_memory) {
+void cuda_wop_pbs_many_lut_64(
+    void *v_stream, uint32_t gpu_index, void *lwe_array_out, void *lwe_array_in,
+    void *lut_vector, void *fourier_bsk, void *ksk, void *cbs_fpksk,
+    int8_t *wop_pbs_buffer, uint32_t cbs_delta_log, uint32_t glwe_dimension,
+    uint32_t lwe_dimension, uint32_t polynomial_size, uint32_t base_log_bsk,
+    uint32_t level_count_bsk, uint32_t base_log_ksk, uint32_t level_count_ksk,
+    uint32_t base_log_pksk, uint32_t level_count_pksk, uint32_t base_log_cbs,
+    uint32_t level_count_cbs, uint32_t *number_of_bits_to_extract_array,
+    uint32_t *delta_log_array, uint32_t crt_decomposition_size,
+    uint32_t number_of_luts, uint32_t max_shared_memory) {
   checks_wop_pbs(glwe_dimension, polynomial_size, level_count_bsk,
                  crt_decomposition_size, number_of_bits_to_extract_array);
   switch (polynomial_size) {
@@ -473,7 +503,7 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
         polynomial_size, base_log_bsk, level_count_bsk, base_log_ksk,
         level_count_ksk, base_log_pksk, level_count_pksk, base_log_cbs,
         level_count_cbs, number_of_bits_to_extract_array, delta_log_array,
-        crt_decomposition_size, max_shared_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory);
     break;
   case 512:
     host_wop_pbs<uint64_t, int64_t, Degree<512>>(
@@ -484,7 +514,7 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
         polynomial_size, base_log_bsk, level_count_bsk, base_log_ksk,
         level_count_ksk, base_log_pksk, level_count_pksk, base_log_cbs,
         level_count_cbs, number_of_bits_to_extract_array, delta_log_array,
-        crt_decomposition_size, max_shared_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory);
     break;
   case 1024:
     host_wop_pbs<uint64_t, int64_t, Degree<1024>>(
@@ -495,7 +525,7 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
         polynomial_size, base_log_bsk, level_count_bsk, base_log_ksk,
         level_count_ksk, base_log_pksk, level_count_pksk, base_log_cbs,
         level_count_cbs, number_of_bits_to_extract_array, delta_log_array,
-        crt_decomposition_size, max_shared_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory);
     break;
   case 2048:
     host_wop_pbs<uint64_t, int64_t, Degree<2048>>(
@@ -506,7 +536,7 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
         polynomial_size, base_log_bsk, level_count_bsk, base_log_ksk,
         level_count_ksk, base_log_pksk, level_count_pksk, base_log_cbs,
         level_count_cbs, number_of_bits_to_extract_array, delta_log_array,
-        crt_decomposition_size, max_shared_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory);
     break;
   case 4096:
     host_wop_pbs<uint64_t, int64_t, Degree<4096>>(
@@ -517,7 +547,7 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
         polynomial_size, base_log_bsk, level_count_bsk, base_log_ksk,
         level_count_ksk, base_log_pksk, level_count_pksk, base_log_cbs,
         level_count_cbs, number_of_bits_to_extract_array, delta_log_array,
-        crt_decomposition_size, max_shared_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory);
     break;
   case 8192:
     host_wop_pbs<uint64_t, int64_t, Degree<8192>>(
@@ -528,13 +558,39 @@ void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
         polynomial_size, base_log_bsk, level_count_bsk, base_log_ksk,
         level_count_ksk, base_log_pksk, level_count_pksk, base_log_cbs,
         level_count_cbs, number_of_bits_to_extract_array, delta_log_array,
-        crt_decomposition_size, max_shared_memory);
+        crt_decomposition_size, number_of_luts, max_shared_memory);
     break;
   default:
     break;
   }
 }
 
+/*
+ * Entry point for the wop PBS on 64 bits inputs with one lookup table per
+ * block of the CRT decomposition, see cuda_wop_pbs_many_lut_64.
+ */
+void cuda_wop_pbs_64(void *v_stream, uint32_t gpu_index, void *lwe_array_out,
+                     void *lwe_array_in, void *lut_vector, void *fourier_bsk,
+                     void *ksk, void *cbs_fpksk, int8_t *wop_pbs_buffer,
+                     uint32_t cbs_delta_log, uint32_t glwe_dimension,
+                     uint32_t lwe_dimension, uint32_t polynomial_size,
+                     uint32_t base_log_bsk, uint32_t level_count_bsk,
+                     uint32_t base_log_ksk, uint32_t level_count_ksk,
+                     uint32_t base_log_pksk, uint32_t level_count_pksk,
+                     uint32_t base_log_cbs, uint32_t level_count_cbs,
+                     uint32_t *number_of_bits_to_extract_array,
+                     uint32_t *delta_log_array, uint32_t crt_decomposition_size,
+                     uint32_t max_shared_memory) {
+  cuda_wop_pbs_many_lut_64(
+      v_stream, gpu_index, lwe_array_out, lwe_array_in, lut_vector, fourier_bsk,
+      ksk, cbs_fpksk, wop_pbs_buffer, cbs_delta_log, glwe_dimension,
+      lwe_dimension, polynomial_size, base_log_bsk, level_count_bsk,
+      base_log_ksk, level_count_ksk, base_log_pksk, level_count_pksk,
+      base_log_cbs, level_count_cbs, number_of_bits_to_extract_array,
+      delta_log_array, crt_decomposition_size, crt_decomposition_size,
+      max_shared_memory);
+}
+
 /*
  * This cleanup function frees the data for the wop PBS on GPU in wop_pbs_buffer
  * for 32 or 64 bits inputs.
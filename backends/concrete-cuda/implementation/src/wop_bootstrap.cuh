@@ -208,8 +208,8 @@ __host__ void scratch_wop_pbs(
     uint32_t *delta_log_array, uint32_t *cbs_delta_log, uint32_t glwe_dimension,
     uint32_t lwe_dimension, uint32_t polynomial_size, uint32_t level_count_cbs,
     uint32_t level_count_bsk, uint32_t *number_of_bits_to_extract_array,
-    uint32_t crt_decomposition_size, uint32_t max_shared_memory,
-    bool allocate_gpu_memory) {
+    uint32_t crt_decomposition_size, uint32_t number_of_luts,
+    uint32_t max_shared_memory, bool allocate_gpu_memory) {
 
   cudaSetDevice(gpu_index);
   auto stream = static_cast<cudaStream_t *>(v_stream);
@@ -237,7 +237,7 @@ __host__ void scratch_wop_pbs(
         bit_extract_buffer_size +
         get_buffer_size_wop_pbs<Torus>(lwe_dimension, total_bits_to_extract) +
         get_buffer_size_cbs_vp<Torus>(glwe_dimension, polynomial_size,
-                                      level_count_cbs, crt_decomposition_size,
+                                      level_count_cbs, number_of_luts,
                                       cbs_vp_number_of_inputs) +
         get_buffer_size_cbs<Torus>(glwe_dimension, lwe_dimension,
                                    polynomial_size, level_count_cbs,
@@ -247,11 +247,10 @@ __host__ void scratch_wop_pbs(
             cbs_vp_number_of_inputs * level_count_cbs, max_shared_memory) +
         get_buffer_size_cmux_tree<Torus, params>(
             glwe_dimension, polynomial_size, level_count_cbs,
-            (1 << cbs_vp_number_of_inputs), crt_decomposition_size,
-            max_shared_memory) +
+            (1 << cbs_vp_number_of_inputs), number_of_luts, max_shared_memory) +
         get_buffer_size_blind_rotation_sample_extraction<Torus>(
             glwe_dimension, polynomial_size, level_count_cbs, mbr_size,
-            crt_decomposition_size, max_shared_memory);
+            number_of_luts, max_shared_memory);
 
     *wop_pbs_buffer =
         (int8_t *)cuda_malloc_async(buffer_size, stream, gpu_index);
@@ -270,7 +269,7 @@ __host__ void scratch_wop_pbs(
   scratch_circuit_bootstrap_vertical_packing<Torus, STorus, params>(
       v_stream, gpu_index, &cbs_vp_buffer, cbs_delta_log, glwe_dimension,
       lwe_dimension, polynomial_size, level_count_bsk, level_count_cbs,
-      total_bits_to_extract, crt_decomposition_size, max_shared_memory, false);
+      total_bits_to_extract, number_of_luts, max_shared_memory, false);
 }
 
 template <typename Torus, typename STorus, class params>
@@ -283,7 +282,8 @@ __host__ void host_wop_pbs(
     uint32_t level_count_ksk, uint32_t base_log_pksk, uint32_t level_count_pksk,
     uint32_t base_log_cbs, uint32_t level_count_cbs,
     uint32_t *number_of_bits_to_extract_array, uint32_t *delta_log_array,
-    uint32_t crt_decomposition_size, uint32_t max_shared_memory) {
+    uint32_t crt_decomposition_size, uint32_t number_of_luts,
+    uint32_t max_shared_memory) {
 
   int total_bits_to_extract = 0;
   for (int i = 0; i < crt_decomposition_size; i++) {
@@ -315,7 +315,7 @@ __host__ void host_wop_pbs(
       lut_vector, fourier_bsk, cbs_fpksk, cbs_vp_buffer, cbs_delta_log,
       glwe_dimension, lwe_dimension, polynomial_size, base_log_bsk,
       level_count_bsk, base_log_pksk, level_count_pksk, base_log_cbs,
-      level_count_cbs, total_bits_to_extract, crt_decomposition_size,
+      level_count_cbs, total_bits_to_extract, number_of_luts,
       max_shared_memory);
   check_cuda_error(cudaGetLastError());
 }
@@ -168,8 +168,66 @@ BENCHMARK_DEFINE_F(Bootstrap_u64, ConcreteCuda_LowLatencyPBS)
                          benchmark::Counter::kIsIterationInvariantRate);
 }
 
+BENCHMARK_DEFINE_F(Bootstrap_u64, ConcreteCuda_AmortizedPBS)
+(benchmark::State &st) {
+  // The fixture only allocates the low latency buffers
+  std::vector<int8_t *> amortized_pbs_buffer(num_gpus);
+  for (int gpu_index = 0; gpu_index < num_gpus; gpu_index++) {
+    cudaSetDevice(gpu_index);
+    scratch_cuda_bootstrap_amortized_64(
+        streams[gpu_index], gpu_index, &amortized_pbs_buffer[gpu_index],
+        glwe_dimension, polynomial_size,
+        input_lwe_ciphertext_count_per_gpu[gpu_index],
+        cuda_get_max_shared_memory(gpu_index), true);
+  }
+
+  for (auto _ : st) {
+#pragma omp parallel for
+    for (int gpu_index = 0; gpu_index < num_gpus; gpu_index++) {
+      // Execute PBS
+      cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
+          streams[gpu_index], gpu_index, (void *)d_lwe_ct_out_array[gpu_index],
+          (void *)d_lut_pbs_identity[gpu_index],
+          (void *)d_lut_pbs_indexes[gpu_index],
+          (void *)d_lwe_ct_in_array[gpu_index],
+          (void *)d_fourier_bsk_array[gpu_index],
+          amortized_pbs_buffer[gpu_index], lwe_dimension, glwe_dimension,
+          polynomial_size, pbs_base_log, pbs_level,
+          input_lwe_ciphertext_count_per_gpu[gpu_index], 1, 0,
+          cuda_get_max_shared_memory(gpu_index));
+    }
+    for (int gpu_index = 0; gpu_index < num_gpus; gpu_index++) {
+      cudaSetDevice(gpu_index);
+      cuda_synchronize_stream(streams[gpu_index]);
+    }
+  }
+  st.counters["Throughput"] =
+      benchmark::Counter(input_lwe_ciphertext_count / get_aws_cost_per_second(),
+                         benchmark::Counter::kIsIterationInvariantRate);
+
+  for (int gpu_index = 0; gpu_index < num_gpus; gpu_index++) {
+    cudaSetDevice(gpu_index);
+    cleanup_cuda_bootstrap_amortized(streams[gpu_index], gpu_index,
+                                     &amortized_pbs_buffer[gpu_index]);
+  }
+}
+
 static void
 BootstrapBenchmarkGenerateParams(benchmark::internal::Benchmark *b) {
+  // The parameter list given by BENCHMARK_PARAMETERS replaces the default one
+  std::vector<BenchmarkParameterSet> parameter_sets =
+      get_benchmark_parameter_sets();
+  if (!parameter_sets.empty()) {
+    for (auto x : parameter_sets) {
+      if (x.grouping_factor != 0)
+        continue;
+      for (int count : get_benchmark_batch_sizes({1, 128, 1024}))
+        b->Args({x.lwe_dimension, x.glwe_dimension, x.polynomial_size,
+                 x.pbs_base_log, x.pbs_level, count});
+    }
+    return;
+  }
+
   // Define the parameters to benchmark
   // lwe_dimension, glwe_dimension, polynomial_size, pbs_base_log, pbs_level,
   // input_lwe_ciphertext_count
@@ -224,3 +282,6 @@ BootstrapBenchmarkGenerateParams(benchmark::internal::Benchmark *b) {
 
 BENCHMARK_REGISTER_F(Bootstrap_u64, ConcreteCuda_LowLatencyPBS)
     ->Apply(BootstrapBenchmarkGenerateParams);
+
+BENCHMARK_REGISTER_F(Bootstrap_u64, ConcreteCuda_AmortizedPBS)
+    ->Apply(BootstrapBenchmarkGenerateParams);
@@ -108,6 +108,21 @@ BENCHMARK_DEFINE_F(Keyswitch_u64, ConcreteCuda_CopiesPlusKeyswitch)
 
 static void
 KeyswitchBenchmarkGenerateParams(benchmark::internal::Benchmark *b) {
+  // The parameter list given by BENCHMARK_PARAMETERS replaces the default one,
+  // the keyswitch going from the big key of the PBS to its small key
+  std::vector<BenchmarkParameterSet> parameter_sets =
+      get_benchmark_parameter_sets();
+  if (!parameter_sets.empty()) {
+    for (auto x : parameter_sets) {
+      if (x.grouping_factor != 0)
+        continue;
+      for (int count : get_benchmark_batch_sizes({1, 128, 1024}))
+        b->Args({x.glwe_dimension * x.polynomial_size, x.lwe_dimension,
+                 x.ks_base_log, x.ks_level, count});
+    }
+    return;
+  }
+
   // Define the parameters to benchmark
   // na, nb, base_log, level, number_of_inputs
   std::vector<KeyswitchBenchmarkParams> params = {
@@ -157,6 +157,20 @@ BENCHMARK_DEFINE_F(MultiBitBootstrap_u64, ConcreteCuda_MultiBit)
 
 static void
 MultiBitPBSBenchmarkGenerateParams(benchmark::internal::Benchmark *b) {
+  // The parameter list given by BENCHMARK_PARAMETERS replaces the default one
+  std::vector<BenchmarkParameterSet> parameter_sets =
+      get_benchmark_parameter_sets();
+  if (!parameter_sets.empty()) {
+    for (auto x : parameter_sets) {
+      if (x.grouping_factor == 0)
+        continue;
+      for (int count : get_benchmark_batch_sizes({1, 128, 1024}))
+        b->Args({x.lwe_dimension, x.glwe_dimension, x.polynomial_size,
+                 x.pbs_base_log, x.pbs_level, count, x.grouping_factor, 0});
+    }
+    return;
+  }
+
   // Define the parameters to benchmark
   // lwe_dimension, glwe_dimension, polynomial_size, pbs_base_log, pbs_level,
   // input_lwe_ciphertext_count
@@ -0,0 +1,56 @@
+"""
+v0_parameters_to_benchmark
+--------------------------
+
+Convert the output of v0-parameters into a benchmark parameter list, read by
+benchmark_concrete_cuda from the file named by BENCHMARK_PARAMETERS.
+"""
+import argparse
+import pathlib
+import re
+
+# - <log norm2> : k, log2(N), n, br_l, br_b, ks_l, ks_b, ...
+SOLUTION = re.compile(r"^\s*-\s*\d+\s*:((?:\s*\d+\s*,){7})")
+
+parser = argparse.ArgumentParser()
+parser.add_argument('v0_parameters_output', type=pathlib.Path,
+                    help='Output of v0-parameters, for the classical or the wop PBS')
+parser.add_argument('parameter_list', type=pathlib.Path,
+                    help='File storing the benchmark parameter list')
+parser.add_argument('--grouping-factors', type=int, nargs='*', default=[],
+                    help=('Also benchmark the multi-bit PBS with these grouping factors,'
+                          ' on the parameter sets whose LWE dimension they divide'))
+
+
+def parameter_sets(v0_parameters_output):
+    """
+    Parse the parameter sets of v0-parameters output, without duplicates.
+
+    :param v0_parameters_output: text written by v0-parameters
+
+    :return: :class:`list` of (lwe_dimension, glwe_dimension, polynomial_size, pbs_base_log,
+        pbs_level, ks_base_log, ks_level)
+    """
+    sets = []
+    for line in v0_parameters_output.splitlines():
+        match = SOLUTION.match(line)
+        if match is None:
+            continue
+        k, log2_n, n, br_l, br_b, ks_l, ks_b = (
+            int(field) for field in match.group(1).split(",")[:7])
+        parameter_set = (n, k, 2 ** log2_n, br_b, br_l, ks_b, ks_l)
+        if parameter_set not in sets:
+            sets.append(parameter_set)
+    return sets
+
+
+if __name__ == "__main__":
+    args = parser.parse_args()
+    lines = ["# lwe_dimension glwe_dimension polynomial_size pbs_base_log pbs_level"
+             " ks_base_log ks_level grouping_factor"]
+    for parameter_set in parameter_sets(args.v0_parameters_output.read_text()):
+        for grouping_factor in [0] + args.grouping_factors:
+            if grouping_factor and parameter_set[0] % grouping_factor:
+                continue
+            lines.append(" ".join(str(p) for p in parameter_set + (grouping_factor,)))
+    args.parameter_list.write_text("\n".join(lines) + "\n")
@@ -5,12 +5,34 @@
 #include <device.h>
 #include <functional>
 #include <tfhe.h>
+#include <vector>
 
 // This is the price per hour of a p3.2xlarge instance on Amazon AWS
 #define AWS_VM_COST_PER_HOUR (double)3.06
 
 double get_aws_cost_per_second();
 
+// A parameter set of the list given by the BENCHMARK_PARAMETERS environment
+// variable, a grouping factor of 0 standing for the classical PBS
+typedef struct {
+  int lwe_dimension;
+  int glwe_dimension;
+  int polynomial_size;
+  int pbs_base_log;
+  int pbs_level;
+  int ks_base_log;
+  int ks_level;
+  int grouping_factor;
+} BenchmarkParameterSet;
+
+// Reads the file named by BENCHMARK_PARAMETERS, empty if it is not set
+std::vector<BenchmarkParameterSet> get_benchmark_parameter_sets();
+
+// The comma separated BENCHMARK_BATCH_SIZES, default_batch_sizes if it is not
+// set
+std::vector<int>
+get_benchmark_batch_sizes(std::vector<int> default_batch_sizes);
+
 uint64_t *generate_plaintexts(uint64_t payload_modulus, uint64_t delta,
                               int number_of_inputs, const unsigned repetitions,
                               const unsigned samples);
@@ -108,6 +108,60 @@ TEST_P(FourierTransformTestPrimitives_u64, cuda_fft_mult) {
   }
 }
 
+TEST_P(FourierTransformTestPrimitives_u64, cuda_ntt_mult) {
+  // Decomposed-like integer polynomials times torus polynomials
+  std::mt19937_64 re;
+  std::uniform_int_distribution<int64_t> unif(-(1 << 21), (1 << 21) - 1);
+  size_t total_size = polynomial_size * samples;
+  int64_t *h_left = (int64_t *)malloc(total_size * sizeof(int64_t));
+  uint64_t *h_right = (uint64_t *)malloc(total_size * sizeof(uint64_t));
+  uint64_t *h_result = (uint64_t *)malloc(total_size * sizeof(uint64_t));
+  for (size_t i = 0; i < total_size; i++) {
+    h_left[i] = unif(re);
+    h_right[i] = re();
+  }
+
+  void *d_left = cuda_malloc_async(total_size * sizeof(int64_t), stream,
+                                   gpu_index);
+  void *d_right = cuda_malloc_async(total_size * sizeof(uint64_t), stream,
+                                    gpu_index);
+  void *d_result = cuda_malloc_async(total_size * sizeof(uint64_t), stream,
+                                     gpu_index);
+  cuda_memcpy_async_to_gpu(d_left, h_left, total_size * sizeof(int64_t),
+                           stream, gpu_index);
+  cuda_memcpy_async_to_gpu(d_right, h_right, total_size * sizeof(uint64_t),
+                           stream, gpu_index);
+
+  cuda_ntt_polynomial_mul_64(d_left, d_right, d_result, stream, gpu_index,
+                             polynomial_size, samples);
+
+  cuda_memcpy_async_to_cpu(h_result, d_result, total_size * sizeof(uint64_t),
+                           stream, gpu_index);
+  cuda_synchronize_stream(stream);
+
+  // The multiplication is exact modulo 2^64
+  for (size_t p = 0; p < (size_t)samples; p++) {
+    auto left = &h_left[p * polynomial_size];
+    auto right = &h_right[p * polynomial_size];
+    for (size_t k = 0; k < polynomial_size; k++) {
+      uint64_t expected = 0;
+      for (size_t i = 0; i <= k; i++)
+        expected += (uint64_t)left[i] * right[k - i];
+      for (size_t i = k + 1; i < polynomial_size; i++)
+        expected -= (uint64_t)left[i] * right[k + polynomial_size - i];
+      EXPECT_EQ(h_result[p * polynomial_size + k], expected);
+    }
+  }
+
+  cuda_drop_async(d_left, stream, gpu_index);
+  cuda_drop_async(d_right, stream, gpu_index);
+  cuda_drop_async(d_result, stream, gpu_index);
+  cuda_synchronize_stream(stream);
+  free(h_left);
+  free(h_right);
+  free(h_result);
+}
+
 ::testing::internal::ParamGenerator<FourierTransformTestParams> fft_params_u64 =
     ::testing::Values((FourierTransformTestParams){256, 100},
                       (FourierTransformTestParams){512, 100},
@@ -123,6 +123,8 @@ TEST_P(KeyswitchTestPrimitives_u64, keyswitch) {
     ::testing::Values(
         // n, k*N, noise_variance, ks_base_log, ks_level,
         // message_modulus, carry_modulus, number_of_inputs
+        (KeyswitchTestParams){567, 1280, 2.9802322387695312e-18, 3, 3, 2, 1,
+                              1},
         (KeyswitchTestParams){567, 1280, 2.9802322387695312e-18, 3, 3, 2, 1,
                               10},
         (KeyswitchTestParams){694, 1536, 2.9802322387695312e-18, 4, 3, 2, 1,
@@ -142,7 +144,8 @@ std::string printParamName(::testing::TestParamInfo<KeyswitchTestParams> p) {
   return "na_" + std::to_string(params.input_lwe_dimension) + "_nb_" +
          std::to_string(params.output_lwe_dimension) + "_baselog_" +
          std::to_string(params.ksk_base_log) + "_ksk_level_" +
-         std::to_string(params.ksk_level);
+         std::to_string(params.ksk_level) + "_inputs_" +
+         std::to_string(params.number_of_inputs);
 }
 
 INSTANTIATE_TEST_CASE_P(KeyswitchInstantiation, KeyswitchTestPrimitives_u64,
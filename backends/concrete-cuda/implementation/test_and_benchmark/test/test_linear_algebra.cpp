@@ -250,6 +250,45 @@ TEST_P(LinearAlgebraTestPrimitives_u64, negate) {
   }
 }
 
+TEST_P(LinearAlgebraTestPrimitives_u64, affine_transformation) {
+  void *v_stream = (void *)stream;
+  uint64_t cleartext = 3;
+  for (uint r = 0; r < REPETITIONS; r++) {
+    uint64_t *lwe_sk = lwe_sk_array + (ptrdiff_t)(r * lwe_dimension);
+    for (uint s = 0; s < SAMPLES; s++) {
+      uint64_t *d_lwe_1_slice =
+          d_lwe_in_1_ct +
+          (ptrdiff_t)((r * SAMPLES * number_of_inputs + s * number_of_inputs) *
+                      (lwe_dimension + 1));
+      // Execute the multiplication by 3 followed by the addition of 1
+      cuda_affine_lwe_ciphertext_vector_64(
+          stream, gpu_index, (void *)d_lwe_out_ct, (void *)d_lwe_1_slice,
+          cleartext, delta, lwe_dimension, number_of_inputs);
+      // Copy result back
+      cuda_memcpy_async_to_cpu(lwe_out_ct, d_lwe_out_ct,
+                               number_of_inputs * (lwe_dimension + 1) *
+                                   sizeof(uint64_t),
+                               stream, gpu_index);
+      cuda_synchronize_stream(v_stream);
+      for (int i = 0; i < number_of_inputs; i++) {
+        uint64_t plaintext = plaintexts_1[r * SAMPLES * number_of_inputs +
+                                          s * number_of_inputs + i];
+        uint64_t decrypted = 0;
+        concrete_cpu_decrypt_lwe_ciphertext_u64(
+            lwe_sk, lwe_out_ct + i * (lwe_dimension + 1), lwe_dimension,
+            &decrypted);
+        // The bit before the message
+        uint64_t rounding_bit = delta >> 1;
+        // Compute the rounding bit
+        uint64_t rounding = (decrypted & rounding_bit) << 1;
+        uint64_t decoded = (decrypted + rounding) / delta;
+        EXPECT_EQ(decoded, cleartext * (plaintext / delta) + 1)
+            << "Repetition: " << r << ", sample: " << s << " i: " << i;
+      }
+    }
+  }
+}
+
 // Defines for which parameters set the linear algebra operations will be
 // tested. It executes each test for all pairs on phis X qs (Cartesian product)
 ::testing::internal::ParamGenerator<LinearAlgebraTestParams>
@@ -4,14 +4,59 @@
 #include <cmath>
 #include <concrete-cpu.h>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <device.h>
+#include <fstream>
 #include <functional>
 #include <random>
+#include <sstream>
 #include <utils.h>
 
 double get_aws_cost_per_second() { return AWS_VM_COST_PER_HOUR / 3600; }
 
+// One parameter set per line, '#' starting a comment:
+//   lwe_dimension glwe_dimension polynomial_size pbs_base_log pbs_level
+//   ks_base_log ks_level grouping_factor
+std::vector<BenchmarkParameterSet> get_benchmark_parameter_sets() {
+  std::vector<BenchmarkParameterSet> parameter_sets;
+  const char *path = std::getenv("BENCHMARK_PARAMETERS");
+  if (path == nullptr)
+    return parameter_sets;
+  std::ifstream file(path);
+  if (!file) {
+    fprintf(stderr, "Cannot open the benchmark parameters %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  std::string line;
+  for (int line_number = 1; std::getline(file, line); line_number++) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    BenchmarkParameterSet p;
+    if (!(fields >> p.lwe_dimension))
+      continue;
+    if (!(fields >> p.glwe_dimension >> p.polynomial_size >> p.pbs_base_log >>
+          p.pbs_level >> p.ks_base_log >> p.ks_level >> p.grouping_factor)) {
+      fprintf(stderr, "%s:%d: expected 8 parameters\n", path, line_number);
+      exit(EXIT_FAILURE);
+    }
+    parameter_sets.push_back(p);
+  }
+  return parameter_sets;
+}
+
+std::vector<int>
+get_benchmark_batch_sizes(std::vector<int> default_batch_sizes) {
+  const char *sizes = std::getenv("BENCHMARK_BATCH_SIZES");
+  if (sizes == nullptr)
+    return default_batch_sizes;
+  std::vector<int> batch_sizes;
+  std::istringstream fields(sizes);
+  std::string size;
+  while (std::getline(fields, size, ','))
+    batch_sizes.push_back(std::stoi(size));
+  return batch_sizes;
+}
+
 // For each sample and repetition, create a plaintext
 // The payload_modulus is the message modulus times the carry modulus
 // (so the total message modulus)
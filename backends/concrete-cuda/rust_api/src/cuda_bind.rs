@@ -330,6 +330,21 @@ extern "C" {
         num_samples: u32,
     );
 
+    /// Perform keyswitch on a batch of 128 bits input LWE ciphertexts, see the 64 bits
+    /// version for the parameters.
+    pub fn cuda_keyswitch_lwe_ciphertext_vector_128(
+        v_stream: *mut c_void,
+        gpu_index: u32,
+        lwe_array_out: *mut c_void,
+        lwe_array_in: *const c_void,
+        keyswitch_key: *const c_void,
+        input_lwe_dimension: u32,
+        output_lwe_dimension: u32,
+        base_log: u32,
+        level_count: u32,
+        num_samples: u32,
+    );
+
 
     /// Perform functional packing keyswitch on a batch of 64 bits input LWE ciphertexts.
     ///
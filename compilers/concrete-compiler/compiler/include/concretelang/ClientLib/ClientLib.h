@@ -44,7 +44,7 @@ public:
 
   Result<TransportValue> prepareInput(Value arg, size_t pos);
 
-  Result<Value> processOutput(TransportValue result, size_t pos);
+  Result<Value> processOutput(const TransportValue &result, size_t pos);
 
   std::string getName();
 
@@ -0,0 +1,71 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_COMMON_ARENA_H
+#define CONCRETELANG_COMMON_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+namespace concretelang {
+namespace values {
+
+/// A bump allocator for the temporaries of a circuit call, all freed at once
+/// by `reset`. The chunks are kept across resets, so that a thread calling
+/// circuits in a loop stops allocating once its arena fits a call, and a
+/// reset is then O(1).
+class Arena {
+public:
+  Arena() = default;
+  Arena(const Arena &other) = delete;
+  Arena &operator=(const Arena &other) = delete;
+  ~Arena();
+
+  /// Returns `size` zeroed bytes aligned on `alignment`, a power of two.
+  void *allocate(size_t size, size_t alignment);
+
+  /// Returns `count` zeroed elements of type `T`.
+  template <typename T> T *allocate(size_t count) {
+    return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /// Frees everything allocated so far. The chunks are merged in one large
+  /// enough for all of them, for the next call not to need more.
+  void reset();
+
+  /// The bytes held by the chunks.
+  size_t capacity() const;
+
+  /// Returns the arena of the calling thread if a `Scope` is active on it.
+  static Arena *current();
+
+  /// Makes the arena of the calling thread current for the lifetime of the
+  /// object, and resets it at the end. A nested scope keeps the allocations
+  /// of the outer one.
+  class Scope {
+  public:
+    Scope();
+    Scope(const Scope &other) = delete;
+    ~Scope();
+
+  private:
+    bool outermost;
+  };
+
+private:
+  struct Chunk {
+    char *data;
+    size_t size;
+  };
+
+  /// The chunks, only the last one being allocated from.
+  std::vector<Chunk> chunks;
+  size_t offset = 0;
+};
+
+} // namespace values
+} // namespace concretelang
+
+#endif
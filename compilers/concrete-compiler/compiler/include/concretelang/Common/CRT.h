@@ -31,6 +31,14 @@ std::vector<int64_t> crt(std::vector<int64_t> moduli, uint64_t val);
 /// \param remainders The remainders of the decomposition.
 uint64_t iCrt(std::vector<int64_t> moduli, std::vector<int64_t> remainders);
 
+/// Compute the coefficients of the inverse crt decomposition, i.e. the value
+/// of `iCrt` is the sum of the remainders times their coefficient modulo the
+/// product of moduli.
+///
+/// \param moduli The moduli used to compute the inverse decomposition.
+/// \returns A coefficient per modulus.
+std::vector<uint64_t> iCrtCoefficients(const std::vector<int64_t> &moduli);
+
 /// Encode the plaintext with the given modulus and the product of moduli of the
 /// crt decomposition
 uint64_t encode(int64_t plaintext, uint64_t modulus, uint64_t product);
@@ -55,6 +55,13 @@ public:
   EncryptionCSPRNG(EncryptionCSPRNG &) = delete;
   EncryptionCSPRNG(EncryptionCSPRNG &&other);
   ~EncryptionCSPRNG();
+
+  /// Returns a new csprng seeded from this one, which can be used
+  /// concurrently with it while staying reproducible from its seed.
+  EncryptionCSPRNG fork();
+
+private:
+  EncryptionCSPRNG(EncCsprng *ptr) : CSPRNG<EncCsprng>(ptr){};
 };
 
 void writeSeed(struct Uint128 seed, uint64_t *buffer);
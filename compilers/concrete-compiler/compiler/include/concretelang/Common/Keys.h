@@ -52,6 +52,7 @@ public:
 
   static LweSecretKey
   fromProto(const Message<concreteprotocol::LweSecretKey> &proto);
+  static LweSecretKey fromProto(concreteprotocol::LweSecretKey::Reader proto);
 
   Message<concreteprotocol::LweSecretKey> toProto() const;
 
@@ -95,6 +96,17 @@ public:
   static LweBootstrapKey
   fromProto(const Message<concreteprotocol::LweBootstrapKey> &proto);
 
+  /// @brief Initialize the key from a protocol reader, copying its payload
+  /// only once, e.g. from a message read in place.
+  static LweBootstrapKey
+  fromProto(concreteprotocol::LweBootstrapKey::Reader proto);
+
+  /// @brief Initialize the key from its transport buffer, seeded or not
+  /// depending on the compression of the key.
+  static LweBootstrapKey
+  fromTransportBuffer(std::shared_ptr<std::vector<uint64_t>> buffer,
+                      Message<concreteprotocol::LweBootstrapKeyInfo> info);
+
   /// @brief Returns the serialized form of the key.
   Message<concreteprotocol::LweBootstrapKey> toProto() const;
 
@@ -104,6 +116,11 @@ public:
 
   const std::vector<uint64_t> &getTransportBuffer() const;
 
+  /// @brief Returns the standard buffer of the key without making it resident
+  /// in the key: a seeded key which is not decompressed yet is decompressed in
+  /// a fresh buffer, released as soon as the caller drops it.
+  std::shared_ptr<std::vector<uint64_t>> getTransientBuffer() const;
+
   void decompress();
 
 private:
@@ -147,6 +164,17 @@ public:
   static LweKeyswitchKey
   fromProto(const Message<concreteprotocol::LweKeyswitchKey> &proto);
 
+  /// @brief Initialize the key from a protocol reader, copying its payload
+  /// only once, e.g. from a message read in place.
+  static LweKeyswitchKey
+  fromProto(concreteprotocol::LweKeyswitchKey::Reader proto);
+
+  /// @brief Initialize the key from its transport buffer, seeded or not
+  /// depending on the compression of the key.
+  static LweKeyswitchKey
+  fromTransportBuffer(std::shared_ptr<std::vector<uint64_t>> buffer,
+                      Message<concreteprotocol::LweKeyswitchKeyInfo> info);
+
   /// @brief Returns the serialized form of the key.
   Message<concreteprotocol::LweKeyswitchKey> toProto() const;
 
@@ -194,28 +222,57 @@ public:
   PackingKeyswitchKey() = delete;
   PackingKeyswitchKey(std::shared_ptr<std::vector<uint64_t>> buffer,
                       Message<concreteprotocol::PackingKeyswitchKeyInfo> info)
-      : buffer(buffer), info(info){};
+      : seededBuffer(std::make_shared<std::vector<uint64_t>>()), buffer(buffer),
+        info(info), decompress_mutext(std::make_shared<std::mutex>()),
+        decompressed(false){};
 
   static PackingKeyswitchKey
   fromProto(const Message<concreteprotocol::PackingKeyswitchKey> &proto);
+  static PackingKeyswitchKey
+  fromProto(concreteprotocol::PackingKeyswitchKey::Reader proto);
+
+  /// @brief Initialize the key from its transport buffer, seeded or not
+  /// depending on the compression of the key.
+  static PackingKeyswitchKey
+  fromTransportBuffer(std::shared_ptr<std::vector<uint64_t>> buffer,
+                      Message<concreteprotocol::PackingKeyswitchKeyInfo> info);
 
   Message<concreteprotocol::PackingKeyswitchKey> toProto() const;
 
-  const uint64_t *getRawPtr() const;
+  const uint64_t *getRawPtr();
 
-  size_t getSize() const;
+  size_t getSize();
 
   const Message<concreteprotocol::PackingKeyswitchKeyInfo> &getInfo() const;
 
-  const std::vector<uint64_t> &getBuffer() const;
+  const std::vector<uint64_t> &getBuffer();
 
-  const std::vector<uint64_t> &getTransportBuffer() const {
-    return getBuffer();
-  };
+  const std::vector<uint64_t> &getTransportBuffer() const;
+
+  void decompress();
 
 private:
+  PackingKeyswitchKey(Message<concreteprotocol::PackingKeyswitchKeyInfo> info)
+      : seededBuffer(std::make_shared<std::vector<uint64_t>>()),
+        buffer(std::make_shared<std::vector<uint64_t>>()), info(info),
+        decompress_mutext(std::make_shared<std::mutex>()),
+        decompressed(false){};
+
+  /// @brief The buffer of the seeded key if needed, the seed followed by the
+  /// bodies of the GLWE ciphertexts.
+  std::shared_ptr<std::vector<uint64_t>> seededBuffer;
+
+  /// @brief The buffer of the actual packing keyswitch key.
   std::shared_ptr<std::vector<uint64_t>> buffer;
+
+  /// @brief The metadata of the packing keyswitch key.
   Message<concreteprotocol::PackingKeyswitchKeyInfo> info;
+
+  /// @brief Mutex to guard the decompression
+  std::shared_ptr<std::mutex> decompress_mutext;
+
+  /// @brief A boolean that indicates if the decompression is done or not
+  bool decompressed;
 };
 
 } // namespace keys
@@ -10,6 +10,7 @@
 #include "concretelang/Common/Csprng.h"
 #include "concretelang/Common/Error.h"
 #include "concretelang/Common/Keys.h"
+#include "llvm/ADT/SmallString.h"
 #include <functional>
 #include <memory>
 #include <stdlib.h>
@@ -30,6 +31,7 @@ struct ClientKeyset {
 
   static ClientKeyset
   fromProto(const Message<concreteprotocol::ClientKeyset> &proto);
+  static ClientKeyset fromProto(concreteprotocol::ClientKeyset::Reader reader);
 
   Message<concreteprotocol::ClientKeyset> toProto() const;
 };
@@ -41,8 +43,32 @@ struct ServerKeyset {
 
   static ServerKeyset
   fromProto(const Message<concreteprotocol::ServerKeyset> &proto);
+  static ServerKeyset fromProto(concreteprotocol::ServerKeyset::Reader reader);
+
+  /// Reads a serialized keyset from a regular file, mapping it rather than
+  /// reading it in a message, so that each key payload is copied once,
+  /// straight into its buffer. The file is read from its start, whatever the
+  /// offset of `fd`, and `fd` is left open.
+  static Result<ServerKeyset> fromFd(int fd);
+
+  /// Reads a serialized keyset from the file at `path`, see `fromFd`.
+  static Result<ServerKeyset> load(const std::string &path);
 
   Message<concreteprotocol::ServerKeyset> toProto() const;
+
+  /// Serializes the keys used by a circuit only, the other keys keeping their
+  /// info but an empty payload. Such a partial keyset is enough to call the
+  /// circuit, the missing keys can be uploaded later and added with `merge`.
+  Message<concreteprotocol::ServerKeyset>
+  toProto(concreteprotocol::CircuitKeysInfo::Reader circuitKeys) const;
+
+  /// Checks that none of the keys used by a circuit is missing.
+  Result<void>
+  checkKeys(concreteprotocol::CircuitKeysInfo::Reader circuitKeys) const;
+
+  /// Fills the keys missing from this keyset with those of `other`, a keyset
+  /// of the same program.
+  Result<void> merge(const ServerKeyset &other);
 };
 
 struct Keyset {
@@ -59,22 +85,50 @@ struct Keyset {
       : server(server), client(client) {}
 
   static Keyset fromProto(const Message<concreteprotocol::Keyset> &proto);
+  static Keyset fromProto(concreteprotocol::Keyset::Reader reader);
+
+  /// Reads a serialized keyset from the file at `path`, mapping it as
+  /// `ServerKeyset::fromFd` does.
+  static Result<Keyset> load(const std::string &path);
 
   Message<concreteprotocol::Keyset> toProto() const;
 };
 
+/// A directory of generated keysets, each one in an entry named by a BLAKE3
+/// digest of the keyset info and the seeds, so that a directory can be shared
+/// between machines and builds.
+///
+/// Complete entries are renamed into place, so they are read without locking,
+/// only the generation of a missing entry being serialized between processes.
+/// If `maxSize` is not zero, the least recently used entries are removed once
+/// a new one makes the directory hold more than `maxSize` bytes.
 class KeysetCache {
   std::string backingDirectoryPath;
+  uint64_t maxSize = 0;
 
 public:
-  KeysetCache(std::string backingDirectoryPath);
+  KeysetCache(std::string backingDirectoryPath, uint64_t maxSize = 0);
 
   Result<Keyset>
   getKeyset(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
             __uint128_t secret_seed, __uint128_t encryption_seed);
 
+  /// Returns the path where the prepared form of the server keyset of
+  /// `getKeyset` is stored alongside it, see `PreparedKeyset::openOrWrite`.
+  std::string
+  getPreparedKeysetPath(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
+                        __uint128_t secret_seed, __uint128_t encryption_seed);
+
 private:
   KeysetCache() = default;
+
+  llvm::SmallString<0>
+  getEntryPath(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
+               __uint128_t secret_seed, __uint128_t encryption_seed);
+
+  /// Removes the least recently used entries but `keptEntry` until the
+  /// directory fits in `maxSize`.
+  void evictEntries(llvm::StringRef keptEntry);
 };
 
 } // namespace keysets
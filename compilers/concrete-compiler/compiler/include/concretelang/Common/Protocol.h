@@ -244,19 +244,19 @@ template struct Message<concreteprotocol::ProgramEncodingInfo>;
 template struct Message<concreteprotocol::Value>;
 template struct Message<concreteprotocol::GateInfo>;
 
-/// Helper function turning a vector of integers to a payload.
+/// Helper function writing the `size` integers at `input` to a payload
+/// builder.
 template <typename T>
-Message<concreteprotocol::Payload>
-vectorToProtoPayload(const std::vector<T> &input) {
-  auto output = Message<concreteprotocol::Payload>();
+void arrayToProtoPayload(const T *input, size_t size,
+                         concreteprotocol::Payload::Builder output) {
   auto elmsPerBlob = capnp::MAX_TEXT_SIZE / sizeof(T);
-  auto remainingElms = input.size() % elmsPerBlob;
-  auto nbBlobs = (input.size() / elmsPerBlob) + (remainingElms > 0);
-  auto dataBuilder = output.asBuilder().initData(nbBlobs);
+  auto remainingElms = size % elmsPerBlob;
+  auto nbBlobs = (size / elmsPerBlob) + (remainingElms > 0);
+  auto dataBuilder = output.initData(nbBlobs);
   // Process all but the last blob, which store as much as `Data` allow.
   if (nbBlobs > 1) {
     for (size_t blobIndex = 0; blobIndex < nbBlobs - 1; blobIndex++) {
-      auto blobPtr = input.data() + blobIndex * elmsPerBlob;
+      auto blobPtr = input + blobIndex * elmsPerBlob;
       auto blobLen = elmsPerBlob * sizeof(T);
       dataBuilder.set(
           blobIndex,
@@ -268,22 +268,38 @@ vectorToProtoPayload(const std::vector<T> &input) {
   // Process the last blob which store the remainder.
   if (nbBlobs > 0) {
     auto lastBlobIndex = nbBlobs - 1;
-    auto lastBlobPtr = input.data() + lastBlobIndex * elmsPerBlob;
+    auto lastBlobPtr = input + lastBlobIndex * elmsPerBlob;
     auto lastBlobLen = remainingElms * sizeof(T);
     dataBuilder.set(
         lastBlobIndex,
         capnp::Data::Reader(
             reinterpret_cast<const unsigned char *>(lastBlobPtr), lastBlobLen));
   }
+}
+
+/// Helper function writing a vector of integers to a payload builder.
+template <typename T>
+void vectorToProtoPayload(const std::vector<T> &input,
+                          concreteprotocol::Payload::Builder output) {
+  arrayToProtoPayload(input.data(), input.size(), output);
+}
 
+/// Helper function turning a vector of integers to a payload.
+template <typename T>
+Message<concreteprotocol::Payload>
+vectorToProtoPayload(const std::vector<T> &input) {
+  auto output = Message<concreteprotocol::Payload>();
+  vectorToProtoPayload(input, output.asBuilder());
   return output;
 }
 
 /// Helper function turning a payload to a vector of integers.
+///
+/// The payload is read in place, taking a reader rather than a message avoids
+/// a copy of the whole payload when it is part of a larger message.
 template <typename T>
-std::vector<T>
-protoPayloadToVector(const Message<concreteprotocol::Payload> &input) {
-  auto payloadData = input.asReader().getData();
+std::vector<T> protoPayloadToVector(concreteprotocol::Payload::Reader input) {
+  auto payloadData = input.getData();
   auto elmsPerBlob = capnp::MAX_TEXT_SIZE / sizeof(T);
   auto totalPayloadSize = 0;
   for (auto blob : payloadData) {
@@ -301,12 +317,35 @@ protoPayloadToVector(const Message<concreteprotocol::Payload> &input) {
   return output;
 }
 
+template <typename T>
+std::vector<T>
+protoPayloadToVector(const Message<concreteprotocol::Payload> &input) {
+  return protoPayloadToVector<T>(input.asReader());
+}
+
+/// Returns the integers of a payload borrowed from its message, setting `size`
+/// to their number, or null if they cannot be read in place, their data being
+/// split in several blobs or not aligned for `T`.
+template <typename T>
+const T *protoPayloadData(concreteprotocol::Payload::Reader input,
+                          size_t &size) {
+  auto payloadData = input.getData();
+  if (payloadData.size() != 1)
+    return nullptr;
+  auto blob = payloadData[0];
+  if (blob.size() % sizeof(T) != 0 ||
+      reinterpret_cast<uintptr_t>(blob.begin()) % alignof(T) != 0)
+    return nullptr;
+  size = blob.size() / sizeof(T);
+  return reinterpret_cast<const T *>(blob.begin());
+}
+
 /// Helper function turning a payload to a shared vector of integers on the
-/// heap.
+/// heap, read in place as by `protoPayloadToVector`.
 template <typename T>
 std::shared_ptr<std::vector<T>>
-protoPayloadToSharedVector(const Message<concreteprotocol::Payload> &input) {
-  auto payloadData = input.asReader().getData();
+protoPayloadToSharedVector(concreteprotocol::Payload::Reader input) {
+  auto payloadData = input.getData();
   size_t elmsPerBlob = capnp::MAX_TEXT_SIZE / sizeof(T);
   size_t totalPayloadSize = 0;
   for (auto blob : payloadData) {
@@ -324,6 +363,12 @@ protoPayloadToSharedVector(const Message<concreteprotocol::Payload> &input) {
   return output;
 }
 
+template <typename T>
+std::shared_ptr<std::vector<T>>
+protoPayloadToSharedVector(const Message<concreteprotocol::Payload> &input) {
+  return protoPayloadToSharedVector<T>(input.asReader());
+}
+
 /// Helper function turning a protocol `Shape` object into a vector of
 /// dimensions.
 std::vector<size_t>
@@ -334,6 +379,15 @@ protoShapeToDimensions(const Message<concreteprotocol::Shape> &shape);
 Message<concreteprotocol::Shape>
 dimensionsToProtoShape(const std::vector<size_t> &input);
 
+/// The value of a dynamic dimension in a protocol `Shape`, whose actual size
+/// is only known from the values.
+const uint32_t DYNAMIC_DIMENSION = UINT32_MAX;
+
+/// Returns true if a value of dimensions `dimensions` has the shape `shape`,
+/// the dynamic dimensions of `shape` matching any size.
+bool isCompatibleWithShape(const std::vector<size_t> &dimensions,
+                           concreteprotocol::Shape::Reader shape);
+
 template <typename MessageType> size_t hashMessage(Message<MessageType> &mess);
 
 } // namespace protocol
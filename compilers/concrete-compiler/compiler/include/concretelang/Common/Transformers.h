@@ -28,13 +28,15 @@ typedef std::function<Result<TransportValue>(Value)> InputTransformer;
 
 /// A type for output transformers, that is, functions running on the client
 /// side, that process a TransportValue fetched from the server to be used as a
-/// Value.
-typedef std::function<Result<Value>(TransportValue)> OutputTransformer;
+/// Value. The transport value is borrowed, so that a large ciphertext is not
+/// copied before being processed.
+typedef std::function<Result<Value>(const TransportValue &)> OutputTransformer;
 
 /// A type for arguments transformers, that is, functions running on the server
 /// side, that transform a TransportValue fetched from the client, to be used as
-/// argument in a circuit call.
-typedef std::function<Result<Value>(TransportValue)> ArgTransformer;
+/// argument in a circuit call. The transport value is borrowed as for the
+/// output transformers.
+typedef std::function<Result<Value>(const TransportValue &)> ArgTransformer;
 
 /// A type for return transformers, that is, functions running on the server
 /// side, that transform a value returned from circuit call into a
@@ -7,13 +7,19 @@
 #define CONCRETELANG_COMMON_VALUES_H
 
 #include "concrete-protocol.capnp.h"
+#include "concretelang/Common/Arena.h"
 #include "concretelang/Common/Error.h"
 #include "concretelang/Common/Protocol.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include <istream>
+#include <memory>
 #include <optional>
+#include <ostream>
 #include <stdlib.h>
+#include <utility>
 #include <variant>
 
 using concretelang::error::Result;
@@ -36,22 +42,74 @@ template <typename T> struct Tensor {
   std::vector<T> values;
   std::vector<size_t> dimensions;
 
+  /// The read-only data of a tensor borrowing it, e.g. from the payload of a
+  /// transport value, instead of owning it in `values`. It is kept alive by
+  /// `owner` if set, and must otherwise outlive the tensor. A borrowed tensor
+  /// is only read through `data` and `size`, and must be turned into an owned
+  /// one with `own` before anything else.
+  const T *borrowed = nullptr;
+  size_t borrowedSize = 0;
+  std::shared_ptr<const void> owner;
+
   Tensor<T>() = default;
   Tensor<T>(std::vector<T> values, std::vector<size_t> dimensions)
-      : values(values), dimensions(dimensions) {}
+      : values(std::move(values)), dimensions(std::move(dimensions)) {}
 
   /// Creates an tensor with the shape described by the input dimensions, filled
   /// with zeros.
-  static Tensor<T> fromDimensions(std::vector<size_t> &dimensions) {
-    uint32_t length = 1;
+  static Tensor<T> fromDimensions(std::vector<size_t> dimensions) {
+    size_t length = 1;
     for (auto dim : dimensions) {
       length *= dim;
     }
-    auto values = std::vector<T>(length);
-    for (auto &val : values) {
-      *val = 0;
+    return Tensor{std::vector<T>(length), std::move(dimensions)};
+  }
+
+  /// Creates a tensor of dimensions `dimensions` whose zeroed data is written
+  /// by `fill(data, size)`. The data is allocated in the arena of the current
+  /// call if there is one, which the tensor then borrows it from.
+  template <typename Fill>
+  static Tensor<T> build(std::vector<size_t> dimensions, Fill fill) {
+    size_t size = 1;
+    for (auto dim : dimensions) {
+      size *= dim;
+    }
+    if (Arena *arena = Arena::current()) {
+      T *data = arena->allocate<T>(size);
+      fill(data, size);
+      return borrow(data, size, std::move(dimensions));
     }
-    return Tensor{values, dimensions};
+    auto output = fromDimensions(std::move(dimensions));
+    fill(output.values.data(), size);
+    return output;
+  }
+
+  /// Creates a tensor borrowing the `size` elements at `data`.
+  static Tensor<T> borrow(const T *data, size_t size,
+                          std::vector<size_t> dimensions,
+                          std::shared_ptr<const void> owner = nullptr) {
+    Tensor<T> output;
+    output.dimensions = std::move(dimensions);
+    output.borrowed = data;
+    output.borrowedSize = size;
+    output.owner = std::move(owner);
+    return output;
+  }
+
+  bool isBorrowed() const { return borrowed != nullptr; }
+
+  const T *data() const { return isBorrowed() ? borrowed : values.data(); }
+
+  size_t size() const { return isBorrowed() ? borrowedSize : values.size(); }
+
+  /// Copies the borrowed data, if any, so that the tensor owns it.
+  void own() {
+    if (!isBorrowed())
+      return;
+    values.assign(borrowed, borrowed + borrowedSize);
+    borrowed = nullptr;
+    borrowedSize = 0;
+    owner.reset();
   }
 
   /// Conversion constructor from a scalar value.
@@ -74,11 +132,13 @@ template <typename T> struct Tensor {
   }
 
   bool operator==(const Tensor<T> &b) const {
-    return this->values == b.values && this->dimensions == b.dimensions;
+    return this->dimensions == b.dimensions &&
+           std::equal(data(), data() + size(), b.data(), b.data() + b.size());
   }
 
   Tensor<T> operator-(T b) const {
     Tensor<T> out = *this;
+    out.own();
     for (size_t i = 0; i < out.values.size(); i++) {
       out.values[i] -= b;
     }
@@ -88,14 +148,16 @@ template <typename T> struct Tensor {
   Tensor<T> operator-(Tensor<T> b) const {
     assert(this->dimensions == b.dimensions);
     Tensor<T> out = *this;
+    out.own();
     for (size_t i = 0; i < out.values.size(); i++) {
-      out.values[i] -= b.values[i];
+      out.values[i] -= b.data()[i];
     }
     return out;
   }
 
   Tensor<T> operator+(T b) const {
     Tensor<T> out = *this;
+    out.own();
     for (size_t i = 0; i < out.values.size(); i++) {
       out.values[i] += b;
     }
@@ -105,14 +167,16 @@ template <typename T> struct Tensor {
   Tensor<T> operator+(Tensor<T> b) const {
     assert(this->dimensions == b.dimensions);
     Tensor<T> out = *this;
+    out.own();
     for (size_t i = 0; i < out.values.size(); i++) {
-      out.values[i] += b.values[i];
+      out.values[i] += b.data()[i];
     }
     return out;
   }
 
   Tensor<T> operator*(T b) const {
     Tensor<T> out = *this;
+    out.own();
     for (size_t i = 0; i < out.values.size(); i++) {
       out.values[i] *= b;
     }
@@ -122,19 +186,24 @@ template <typename T> struct Tensor {
   Tensor<T> operator*(Tensor<T> b) const {
     assert(this->dimensions == b.dimensions);
     Tensor<T> out = *this;
+    out.own();
     for (size_t i = 0; i < out.values.size(); i++) {
-      out.values[i] *= b.values[i];
+      out.values[i] *= b.data()[i];
     }
     return out;
   }
 
-  T &operator[](int index) { return this->values[index]; }
+  T &operator[](int index) {
+    own();
+    return this->values[index];
+  }
 
   template <typename U> explicit operator Tensor<U>() const {
     Tensor<U> output;
     output.dimensions = this->dimensions;
-    for (auto v : this->values) {
-      output.values.push_back((U)v);
+    output.values.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+      output.values.push_back((U)data()[i]);
     }
     return output;
   }
@@ -151,18 +220,23 @@ struct Value {
                Tensor<uint64_t>, Tensor<int64_t>>
       inner;
   Value() = default;
-  Value(Tensor<uint8_t> inner) : inner(inner){};
-  Value(Tensor<uint16_t> inner) : inner(inner){};
-  Value(Tensor<uint32_t> inner) : inner(inner){};
-  Value(Tensor<uint64_t> inner) : inner(inner){};
-  Value(Tensor<int8_t> inner) : inner(inner){};
-  Value(Tensor<int16_t> inner) : inner(inner){};
-  Value(Tensor<int32_t> inner) : inner(inner){};
-  Value(Tensor<int64_t> inner) : inner(inner){};
+  Value(Tensor<uint8_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<uint16_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<uint32_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<uint64_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<int8_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<int16_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<int32_t> inner) : inner(std::move(inner)){};
+  Value(Tensor<int64_t> inner) : inner(std::move(inner)){};
 
   /// Turns a server value to a client value, without interpreting the kind of
   /// value.
-  static Value fromRawTransportValue(TransportValue transportVal);
+  static Value fromRawTransportValue(const TransportValue &transportVal);
+
+  /// Turns a server value to a client value borrowing its payload whenever it
+  /// can be read in place, so that the value must not outlive `transportVal`.
+  /// The payload is copied as by `fromRawTransportValue` otherwise.
+  static Value borrowRawTransportValue(const TransportValue &transportVal);
 
   /// Turns a client value to a raw (without kind info attached) server value.
   TransportValue intoRawTransportValue() const;
@@ -213,6 +287,116 @@ struct Value {
 
 size_t getCorrespondingPrecision(size_t originalPrecision);
 
+/// Switches the `lweSize` coefficients of a ciphertext to the modulus
+/// `2^modulusLog`, rounding them, and packs them in the
+/// `(lweSize * modulusLog + 63) / 64` words of `out`, which must be zeroed.
+void modulusSwitchCompress(const uint64_t *in, size_t lweSize,
+                           uint32_t modulusLog, uint64_t *out);
+
+/// Unpacks the `lweSize` coefficients of a ciphertext compressed by
+/// `modulusSwitchCompress` back to the native modulus.
+void modulusSwitchDecompress(const uint64_t *in, size_t lweSize,
+                             uint32_t modulusLog, uint64_t *out);
+
+/// The default size in bytes of the payload chunks of a streamed transport
+/// value.
+const size_t TRANSPORT_VALUE_CHUNK_SIZE = 1 << 24;
+
+/// Writes a transport value to a stream incrementally.
+///
+/// The stream holds the value without its payload, as a capnp message,
+/// followed by the payload split in chunks, each one preceded by its size in
+/// bytes as a little-endian 64 bits integer. The size of the whole payload is
+/// given by the raw info of the value, so that the payload can be produced and
+/// consumed chunk by chunk, and neither side ever holds the whole serialized
+/// value in memory.
+class TransportValueWriter {
+public:
+  /// Writes the header of a value to `ostream`. The payload of `header` is
+  /// ignored, the payload announced by its raw info having to be written
+  /// with `write`.
+  static Result<TransportValueWriter> open(std::ostream &ostream,
+                                           const TransportValue &header);
+
+  /// Writes the next `size` bytes of the payload as one chunk.
+  Result<void> write(const void *data, size_t size);
+
+  /// Checks that the whole payload was written, and flushes the stream.
+  Result<void> close();
+
+  /// The number of bytes of the payload left to write.
+  size_t getRemaining() const { return remaining; }
+
+private:
+  TransportValueWriter(std::ostream &ostream, size_t remaining)
+      : ostream(ostream), remaining(remaining) {}
+
+  std::ostream &ostream;
+  size_t remaining;
+};
+
+/// Reads a transport value written by a `TransportValueWriter` incrementally.
+class TransportValueReader {
+public:
+  /// Reads the header of a value from `istream`.
+  static Result<TransportValueReader>
+  open(std::istream &istream,
+       capnp::ReaderOptions options = capnp::ReaderOptions());
+
+  /// The value without its payload.
+  const TransportValue &getHeader() const { return header; }
+
+  /// Reads the next `size` bytes of the payload to `data`, whatever the chunks
+  /// they were written in. Returns the number of bytes read, which is only
+  /// smaller than `size` at the end of the payload.
+  Result<size_t> read(void *data, size_t size);
+
+  /// The number of bytes of the payload left to read.
+  size_t getRemaining() const { return remaining; }
+
+private:
+  TransportValueReader(std::istream &istream, TransportValue header,
+                       size_t remaining)
+      : istream(istream), header(std::move(header)), remaining(remaining),
+        chunkRemaining(0) {}
+
+  std::istream &istream;
+  TransportValue header;
+  size_t remaining;
+  size_t chunkRemaining;
+};
+
+/// Writes a whole transport value to a stream in the chunked format of
+/// `TransportValueWriter`, straight from its payload.
+Result<void>
+writeTransportValueChunked(const TransportValue &value, std::ostream &ostream,
+                           size_t chunkSize = TRANSPORT_VALUE_CHUNK_SIZE);
+
+/// Reads a whole transport value written in the chunked format of
+/// `TransportValueWriter`, straight into its payload.
+Result<TransportValue>
+readTransportValueChunked(std::istream &istream,
+                          capnp::ReaderOptions options = capnp::ReaderOptions());
+
+/// Writes a value to be stored at rest, as a small header followed by the
+/// value in the chunked format of `TransportValueWriter`.
+///
+/// The ciphertexts are stored in their compressed form, seeded when freshly
+/// encrypted with a seeded input, or modulus switched when output by a
+/// circuit compressing its outputs. If `compressedModulusLog` is not 0, the
+/// uncompressed ciphertexts are also modulus switched to that many bits,
+/// which adds the rounding noise of the switch to them, and restored on read.
+Result<void>
+writeValueAtRest(const TransportValue &value, std::ostream &ostream,
+                 uint32_t compressedModulusLog = 0,
+                 size_t chunkSize = TRANSPORT_VALUE_CHUNK_SIZE);
+
+/// Reads a value written by `writeValueAtRest`, with the compression it had
+/// when written.
+Result<TransportValue>
+readValueAtRest(std::istream &istream,
+                capnp::ReaderOptions options = capnp::ReaderOptions());
+
 } // namespace values
 } // namespace concretelang
 
@@ -10,9 +10,15 @@
 
 namespace mlir {
 namespace concretelang {
-/// Create a pass to convert `Concrete` dialect to CAPI calls.
+/// Create a pass to convert `Concrete` dialect to CAPI calls. If
+/// `inlineLeveledOps` is set, the leveled operations on a single ciphertext
+/// are lowered to loops in the module instead. If `pipelineChunkSize` is
+/// positive, the batched keyswitches followed by a batched bootstrap are
+/// lowered on CPU to a call pipelining them in chunks of that many
+/// ciphertexts.
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertConcreteToCAPIPass(bool gpu);
+createConvertConcreteToCAPIPass(bool gpu, bool inlineLeveledOps = false,
+                                int64_t pipelineChunkSize = 0);
 } // namespace concretelang
 } // namespace mlir
 
@@ -12,7 +12,7 @@
 namespace mlir {
 namespace concretelang {
 std::unique_ptr<OperationPass<mlir::func::FuncOp>>
-createExtractSDFGOpsPass(bool unroll);
+createExtractSDFGOpsPass(bool unroll, int64_t maxUnrolledOps = 0);
 } // namespace concretelang
 } // namespace mlir
 
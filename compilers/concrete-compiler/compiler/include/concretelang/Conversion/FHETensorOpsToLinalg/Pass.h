@@ -12,9 +12,16 @@
 namespace mlir {
 namespace concretelang {
 /// Create a pass to convert `FHE` tensor operators to linal.generic
-/// operators.
+/// operators. The dots and full sums of at least `treeReductionMinSize`
+/// elements are reduced by independent chunks, never if it is 0. With
+/// `conv2dIm2col`, the convolutions of a single group are lowered to a copy
+/// of their input windows to patches followed by a matrix product. With
+/// `sparseMatmul`, the products by constant matrices of mostly zeros are
+/// lowered to loops over their non zero weights.
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
-createConvertFHETensorOpsToLinalg();
+createConvertFHETensorOpsToLinalg(int64_t treeReductionMinSize = 0,
+                                  bool conv2dIm2col = false,
+                                  bool sparseMatmul = false);
 } // namespace concretelang
 } // namespace mlir
 
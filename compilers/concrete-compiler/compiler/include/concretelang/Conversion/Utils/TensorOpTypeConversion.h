@@ -59,6 +59,10 @@ populateWithTensorTypeConverterPatterns(mlir::RewritePatternSet &patterns,
       .add<TypeConvertingReinstantiationPattern<mlir::tensor::ExpandShapeOp>>(
           patterns.getContext(), typeConverter);
   addDynamicallyLegalTypeOp<mlir::tensor::ExpandShapeOp>(target, typeConverter);
+  // DimOp
+  patterns.add<TypeConvertingReinstantiationPattern<mlir::tensor::DimOp>>(
+      patterns.getContext(), typeConverter);
+  addDynamicallyLegalTypeOp<mlir::tensor::DimOp>(target, typeConverter);
 }
 } // namespace concretelang
 } // namespace mlir
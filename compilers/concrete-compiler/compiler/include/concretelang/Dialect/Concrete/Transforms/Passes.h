@@ -6,6 +6,8 @@
 #ifndef CONCRETELANG_DIALECT_CONCRETE_TRANSFORMS_PASSES_H_
 #define CONCRETELANG_DIALECT_CONCRETE_TRANSFORMS_PASSES_H_
 
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Pass/Pass.h"
 
 #define GEN_PASS_CLASSES
@@ -14,6 +16,7 @@
 namespace mlir {
 namespace concretelang {
 std::unique_ptr<OperationPass<ModuleOp>> createAddRuntimeContext();
+std::unique_ptr<OperationPass<func::FuncOp>> createBufferReusePass();
 } // namespace concretelang
 } // namespace mlir
 
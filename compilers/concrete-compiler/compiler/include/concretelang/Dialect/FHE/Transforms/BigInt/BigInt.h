@@ -15,8 +15,13 @@
 namespace mlir {
 namespace concretelang {
 
+/// Decomposes the operations on integers wider than `chunkSize` bits into
+/// operations on chunks of `chunkWidth` bits. The additions of at least
+/// `carryLookaheadMinChunks` chunks compute their carries with a logarithmic
+/// depth of table lookups rather than rippling them, never if it is 0.
 std::unique_ptr<mlir::OperationPass<>>
-createFHEBigIntTransformPass(unsigned int chunkSize, unsigned int chunkWidth);
+createFHEBigIntTransformPass(unsigned int chunkSize, unsigned int chunkWidth,
+                             unsigned int carryLookaheadMinChunks = 0);
 
 } // namespace concretelang
 } // namespace mlir
@@ -0,0 +1,29 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_FHE_ROUND_TO_TLU_PASS_H
+#define CONCRETELANG_FHE_ROUND_TO_TLU_PASS_H
+
+#include <concretelang/Dialect/FHE/IR/FHEDialect.h>
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgDialect.h>
+#include <functional>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Pass/Pass.h>
+
+#define GEN_PASS_CLASSES
+#include <concretelang/Dialect/FHE/Transforms/RoundToTLU/RoundToTLU.h.inc>
+
+namespace mlir {
+namespace concretelang {
+
+/// `tluCost` gives the cost of a table lookup of the given precision, 2^p if
+/// not provided.
+std::unique_ptr<mlir::OperationPass<>>
+createFHERoundToTLUPass(std::function<double(unsigned)> tluCost = nullptr);
+
+} // namespace concretelang
+} // namespace mlir
+
+#endif
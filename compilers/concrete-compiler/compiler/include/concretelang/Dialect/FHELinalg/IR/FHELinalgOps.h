@@ -120,6 +120,10 @@ getDilationsFromConv2d(mlir::concretelang::FHELinalg::Conv2dOp &convOp);
 /// Get group from the Conv2dOp if defined, or return default value
 int64_t getGroupFromConv2d(mlir::concretelang::FHELinalg::Conv2dOp &convOp);
 
+/// Returns true if `type` is a shaped type whose only dynamic dimension, if
+/// any, is the leading batch dimension
+bool hasStaticShapeOrDynamicBatch(mlir::Type type);
+
 } // namespace FHELinalg
 } // namespace concretelang
 } // namespace mlir
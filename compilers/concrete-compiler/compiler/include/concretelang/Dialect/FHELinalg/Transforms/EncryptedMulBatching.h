@@ -0,0 +1,25 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_FHELINALG_ENCRYPTED_MUL_BATCHING_PASS_H
+#define CONCRETELANG_FHELINALG_ENCRYPTED_MUL_BATCHING_PASS_H
+
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgDialect.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Pass/Pass.h>
+
+#define GEN_PASS_CLASSES
+#include <concretelang/Dialect/FHELinalg/Transforms/EncryptedMulBatching.h.inc>
+
+namespace mlir {
+namespace concretelang {
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createFHELinalgEncryptedMulBatchingPass();
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -18,7 +18,21 @@ namespace concretelang {
 std::unique_ptr<mlir::OperationPass<>>
 createFHELinalgTilingMarkerPass(llvm::ArrayRef<int64_t> tileSizes);
 
+/// Creates a tiling marker pass blocking the reduction of the operations
+/// for a cache of `cacheSize` bytes, given the size of a ciphertext in
+/// bytes.
+std::unique_ptr<mlir::OperationPass<>>
+createFHELinalgTilingMarkerPass(int64_t cacheSize, int64_t ciphertextSize);
+
 std::unique_ptr<mlir::OperationPass<>> createLinalgTilingPass();
+
+std::unique_ptr<mlir::OperationPass<>>
+createLinalgLayerStreamingPass(int64_t tileSize = 16);
+
+/// Creates a pass marking the costly Linalg operations for tiling in tiles
+/// of about `taskCost` bootstraps, and in at least `workers` tiles.
+std::unique_ptr<mlir::OperationPass<>>
+createLinalgTaskTilingMarkerPass(double taskCost = 64, int64_t workers = 0);
 } // namespace concretelang
 } // namespace mlir
 
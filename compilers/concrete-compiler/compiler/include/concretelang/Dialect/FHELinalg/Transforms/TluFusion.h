@@ -0,0 +1,26 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_FHELINALG_TLU_FUSION_PASS_H
+#define CONCRETELANG_FHELINALG_TLU_FUSION_PASS_H
+
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgDialect.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Pass/Pass.h>
+
+#define GEN_PASS_CLASSES
+#include <concretelang/Dialect/FHELinalg/Transforms/TluFusion.h.inc>
+
+namespace mlir {
+namespace concretelang {
+/// Creates the table lookup fusion pass. If `report` is set, the number of
+/// bootstraps it removed is printed on the standard error.
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createFHELinalgTluFusionPass(bool report = false);
+} // namespace concretelang
+} // namespace mlir
+
+#endif
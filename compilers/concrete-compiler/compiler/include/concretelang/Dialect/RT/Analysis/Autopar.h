@@ -19,6 +19,11 @@ class RewritePatternSet;
 namespace concretelang {
 std::unique_ptr<mlir::Pass>
 createBuildDataflowTaskGraphPass(bool debug = false);
+std::unique_ptr<mlir::Pass>
+createCoarsenDataflowTasksPass(double circuitComplexity,
+                               double targetComplexity, bool debug = false);
+std::unique_ptr<mlir::Pass>
+createFuseDataflowTaskChainsPass(bool debug = false);
 std::unique_ptr<mlir::Pass> createLowerDataflowTasksPass(bool debug = false);
 std::unique_ptr<mlir::Pass>
 createBufferizeDataflowTaskOpsPass(bool debug = false);
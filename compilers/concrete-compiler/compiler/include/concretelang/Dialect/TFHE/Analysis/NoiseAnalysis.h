@@ -0,0 +1,28 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_DIALECT_TFHE_ANALYSIS_NOISE_ANALYSIS_H
+#define CONCRETELANG_DIALECT_TFHE_ANALYSIS_NOISE_ANALYSIS_H
+
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Pass/Pass.h>
+
+#include <concretelang/Support/CompilationFeedback.h>
+
+namespace mlir {
+namespace concretelang {
+
+/// Propagates the noise variances through the parametrized and normalized
+/// TFHE program, with the variances of the keys and the fresh encryptions of
+/// `programInfo`, and fills the error probabilities of the outputs of the
+/// circuit feedbacks.
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createNoiseAnalysisPass(ProgramCompilationFeedback &feedback,
+                        const Message<concreteprotocol::ProgramInfo> &info,
+                        uint32_t fftPrecision);
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -8,7 +8,10 @@
 
 #include "concrete-optimizer.hpp"
 #include "concretelang/Dialect/TFHE/IR/TFHEDialect.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Pass/Pass.h"
+#include <limits>
 
 #define GEN_PASS_CLASSES
 #include "concretelang/Dialect/TFHE/Transforms/Transforms.h.inc"
@@ -16,6 +19,14 @@
 namespace mlir {
 namespace concretelang {
 std::unique_ptr<mlir::OperationPass<>> createTFHEOptimizationPass();
+std::unique_ptr<mlir::OperationPass<>> createTFHEKeyswitchSharingPass();
+std::unique_ptr<mlir::OperationPass<>> createTFHEWopPBSSharingPass();
+std::unique_ptr<mlir::OperationPass<>> createTFHEStraightLineBatchingPass(
+    int64_t maxBatchSize = std::numeric_limits<int64_t>::max());
+std::unique_ptr<mlir::OperationPass<>>
+createTFHEMemorySchedulingPass(int64_t maxLiveBytes = 0);
+std::unique_ptr<mlir::OperationPass<>> createTFHEConstantLutEncodingPass();
+std::unique_ptr<mlir::OperationPass<>> createTFHELutEncodingHoistingPass();
 std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
     createTFHECircuitSolutionParametrizationPass(
         std::optional<concrete_optimizer::dag::CircuitSolution>);
@@ -10,7 +10,9 @@
 #include <cstdint>
 #include <dlfcn.h>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "concretelang/Runtime/runtime_api.h"
 
@@ -26,6 +28,39 @@ bool _dfr_is_root_node();
 bool _dfr_use_omp();
 bool _dfr_is_distributed();
 
+/// The counters of the dataflow runtime on this node, since it started or
+/// since the last reset.
+struct DFRStatistics {
+  /// Tasks created by this node, and executed by it, the ones sent by the
+  /// other nodes included.
+  uint64_t tasks_created = 0;
+  uint64_t tasks_executed = 0;
+  /// Tasks sent by this node to each node, itself included, and the input
+  /// bytes sent with them, which are 0 for itself.
+  std::vector<uint64_t> node_tasks;
+  std::vector<uint64_t> node_bytes_sent;
+  /// Input bytes of the tasks received from the other nodes.
+  uint64_t bytes_received = 0;
+  /// Keys fetched from the root node on first use, with lazy key transfer,
+  /// and the total and maximum latencies of the fetches in nanoseconds.
+  uint64_t key_fetches = 0;
+  uint64_t key_fetch_total_ns = 0;
+  uint64_t key_fetch_max_ns = 0;
+  /// Threads ready to run and waiting for a worker, at the time of the call.
+  uint64_t pending_threads = 0;
+  /// Time spent in the computation phases, between _dfr_start and _dfr_stop,
+  /// and time spent executing tasks in each worker thread, in nanoseconds.
+  uint64_t compute_ns = 0;
+  std::vector<uint64_t> worker_busy_ns;
+};
+
+DFRStatistics _dfr_get_statistics();
+void _dfr_reset_statistics();
+/// Returns the statistics in the Prometheus text exposition format.
+std::string _dfr_statistics_prometheus();
+/// Accounts a key fetched from the root node in `ns` nanoseconds.
+void _dfr_record_key_fetch(uint64_t ns);
+
 typedef enum _dfr_task_arg_type {
   _DFR_TASK_ARG_BASE = 0,
   _DFR_TASK_ARG_MEMREF = 1,
@@ -36,15 +71,24 @@ static inline _dfr_task_arg_type _dfr_get_arg_type(uint64_t val) {
   return (_dfr_task_arg_type)(val & 0xFF);
 }
 static inline uint64_t _dfr_get_memref_element_size(uint64_t val) {
-  return val >> 8;
+  return (val >> 8) & ((((uint64_t)1) << 40) - 1);
+}
+/// The number of most significant bits of the mask elements of the memref
+/// of ciphertexts sent between nodes, or 0 if the elements are sent whole.
+static inline uint64_t _dfr_get_memref_wire_bits(uint64_t val) {
+  return val >> 48;
 }
 static inline uint64_t _dfr_set_arg_type(uint64_t val,
                                          _dfr_task_arg_type type) {
   return (val & ~(0xFF)) | type;
 }
 static inline uint64_t _dfr_set_memref_element_size(uint64_t val, size_t size) {
-  assert(size < (((uint64_t)1) << 48));
-  return (val & 0xFF) | (((uint64_t)size) << 8);
+  assert(size < (((uint64_t)1) << 40));
+  return (val & ~((((uint64_t)1) << 48) - 1 - 0xFF)) | (((uint64_t)size) << 8);
+}
+static inline uint64_t _dfr_set_memref_wire_bits(uint64_t val, size_t bits) {
+  assert(bits < 64);
+  return (val & ((((uint64_t)1) << 48) - 1)) | (((uint64_t)bits) << 48);
 }
 
 } // namespace dfr
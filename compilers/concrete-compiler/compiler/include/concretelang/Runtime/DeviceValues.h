@@ -0,0 +1,105 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_DEVICEVALUES_H
+#define CONCRETELANG_RUNTIME_DEVICEVALUES_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace mlir {
+namespace concretelang {
+
+/// A copy of a host buffer resident in the memory of a device, released with
+/// the last reference to it.
+class DeviceBuffer {
+public:
+  DeviceBuffer(void *ptr, size_t size, int32_t gpuIdx,
+               std::function<void(void *, int32_t)> release)
+      : ptr(ptr), size(size), gpuIdx(gpuIdx), release(release) {}
+  DeviceBuffer(const DeviceBuffer &other) = delete;
+  ~DeviceBuffer() { release(ptr, gpuIdx); }
+
+  void *ptr;
+  size_t size;
+  int32_t gpuIdx;
+
+private:
+  std::function<void(void *, int32_t)> release;
+};
+
+typedef std::vector<std::shared_ptr<DeviceBuffer>> DeviceBuffers;
+
+/// The device copies of the host buffers of a circuit invocation, for the
+/// calling thread.
+///
+/// While a scope is alive, the GPU dataflow runtime uses the device copy bound
+/// to a host buffer put on one of its streams instead of uploading the buffer,
+/// and binds a device copy of the buffers it gets from its streams before
+/// releasing the device memory of the computation. Without a scope, the
+/// runtime neither looks up nor keeps any device copy.
+class DeviceValueScope {
+public:
+  DeviceValueScope();
+  DeviceValueScope(const DeviceValueScope &other) = delete;
+  ~DeviceValueScope();
+
+  /// Binds `buffer` as the device copy of the host buffer at `host`.
+  void bind(const void *host, std::shared_ptr<DeviceBuffer> buffer);
+
+  /// Returns the device copy of the `size` bytes at `host`, if any.
+  std::shared_ptr<DeviceBuffer> lookup(const void *host, size_t size) const;
+
+  /// Returns the innermost scope of the calling thread, if any.
+  static DeviceValueScope *current();
+
+private:
+  std::map<const void *, std::shared_ptr<DeviceBuffer>> buffers;
+  DeviceValueScope *previous;
+};
+
+/// How the GPU dataflow runtime may use the devices for a circuit invocation.
+struct DeviceSettings {
+  /// The devices the computation is scheduled on, all of them if empty.
+  std::vector<int32_t> devices;
+  /// The bytes of device memory the chunks of a subgraph are sized for, the
+  /// free memory of the device if 0.
+  uint64_t memoryLimit = 0;
+  /// The maximum number of samples of a chunk sent to a device, as many as fit
+  /// in memory if 0.
+  uint64_t batchSize = 0;
+
+  bool isDefault() const {
+    return devices.empty() && memoryLimit == 0 && batchSize == 0;
+  }
+};
+
+/// The device settings of the circuit invocations of the calling thread.
+///
+/// The GPU dataflow runtime reads the settings of the innermost scope when a
+/// dataflow graph is created, and uses the default ones without a scope.
+class DeviceSettingsScope {
+public:
+  DeviceSettingsScope(const DeviceSettings &settings);
+  DeviceSettingsScope(const DeviceSettingsScope &other) = delete;
+  ~DeviceSettingsScope();
+
+  /// Returns the settings of the innermost scope of the calling thread, if
+  /// any.
+  static const DeviceSettings *current();
+
+private:
+  const DeviceSettings &settings;
+  DeviceSettingsScope *previous;
+};
+
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -0,0 +1,68 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_GPUTUNING_H
+#define CONCRETELANG_RUNTIME_GPUTUNING_H
+
+#include <stdint.h>
+
+namespace mlir {
+namespace concretelang {
+namespace gpu_tuning {
+
+enum class PBSVariant { Amortized = 0, LowLatency = 1, MultiBit = 2 };
+
+/// A configuration of the PBS kernels: the variant, the shared memory the
+/// kernels are allowed to use, from which they pick their shared memory
+/// degree, and the grouping factor of the bootstrap key for the multi-bit
+/// PBS.
+struct PBSConfig {
+  PBSVariant variant;
+  uint32_t max_shared_memory;
+  uint32_t grouping_factor;
+};
+
+/// Returns the configuration of the PBS kernels to use for a batch of
+/// `num_samples` bootstraps with the given parameters on the device.
+///
+/// The configurations are looked up in a tuning table, keyed by the device
+/// name, the parameters and the batch size rounded up to a power of two. The
+/// table is loaded from and saved to the file given by
+/// `GPU_PBS_TUNING_FILE`. When `GPU_PBS_AUTOTUNE` is set, the missing entries
+/// are filled by benchmarking every configuration once with the given
+/// bootstrap key, otherwise they default to the amortized PBS using all the
+/// shared memory of the device.
+///
+/// Bootstrap keys with a grouping factor greater than 1 always use the
+/// multi-bit PBS, which is not tuned as it sizes its own chunks.
+PBSConfig select_pbs_config(uint32_t gpu_idx, void *stream,
+                            uint32_t input_lwe_dim, uint32_t poly_size,
+                            uint32_t level, uint32_t base_log,
+                            uint32_t glwe_dim, uint32_t grouping_factor,
+                            uint32_t num_samples, void *fbsk_gpu);
+
+/// Allocates the scratch buffer of the PBS kernels of `config`.
+void scratch_pbs(PBSConfig config, void *stream, uint32_t gpu_idx,
+                 int8_t **pbs_buffer, uint32_t input_lwe_dim,
+                 uint32_t glwe_dim, uint32_t poly_size, uint32_t level,
+                 uint32_t num_samples);
+
+/// Runs the PBS kernels of `config`.
+void run_pbs(PBSConfig config, void *stream, uint32_t gpu_idx, void *out_gpu,
+             void *glwe_ct_gpu, void *test_vector_idxes_gpu, void *ct0_gpu,
+             void *fbsk_gpu, int8_t *pbs_buffer, uint32_t input_lwe_dim,
+             uint32_t glwe_dim, uint32_t poly_size, uint32_t base_log,
+             uint32_t level, uint32_t num_samples, uint32_t num_test_vectors,
+             uint32_t lwe_idx);
+
+/// Frees the scratch buffer of the PBS kernels of `config`.
+void cleanup_pbs(PBSConfig config, void *stream, uint32_t gpu_idx,
+                 int8_t **pbs_buffer);
+
+} // namespace gpu_tuning
+} // namespace concretelang
+} // namespace mlir
+
+#endif
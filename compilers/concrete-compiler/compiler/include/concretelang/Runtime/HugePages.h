@@ -0,0 +1,86 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_HUGEPAGES_H
+#define CONCRETELANG_RUNTIME_HUGEPAGES_H
+
+#include <new>
+#include <stddef.h>
+
+namespace mlir {
+namespace concretelang {
+namespace huge_pages {
+
+/// How the large buffers of the runtime are backed, set by
+/// `RUNTIME_HUGE_PAGES`:
+///  - unset or `0`: the default allocator, i.e. normal pages,
+///  - `thp`: anonymous memory advised as transparent huge pages
+///    (`MADV_HUGEPAGE`),
+///  - `2m` or `1g`: pages of the hugetlbfs pool of this size, falling back to
+///    transparent huge pages when the pool is exhausted or not configured.
+/// The ciphertext tensors being allocated by the compiled circuits through
+/// `malloc`, the glibc tunable `glibc.malloc.hugetlb` is the way to back
+/// them with huge pages.
+enum class Mode {
+  NONE,
+  TRANSPARENT,
+  HUGETLB_2M,
+  HUGETLB_1G,
+};
+
+Mode mode();
+
+/// Allocates `size` bytes following `mode()`, to be released with `free`.
+/// Returns null if the allocation fails.
+void *alloc(size_t size);
+
+/// Releases `size` bytes allocated by `alloc`.
+void free(void *ptr, size_t size);
+
+/// Advises the page aligned range `[ptr, ptr + size[` allocated elsewhere as
+/// transparent huge pages, if huge pages are enabled.
+void advise(void *ptr, size_t size);
+
+/// An allocator for the containers of keys, the buffers of at least
+/// `threshold` bytes going through `alloc`.
+template <typename T> struct Allocator {
+  using value_type = T;
+
+  static const size_t threshold = 1 << 21;
+
+  Allocator() = default;
+  template <typename U> Allocator(const Allocator<U> &) {}
+
+  T *allocate(size_t n) {
+    size_t size = n * sizeof(T);
+    void *ptr = (mode() != Mode::NONE && size >= threshold)
+                    ? huge_pages::alloc(size)
+                    : ::operator new(size);
+    if (ptr == nullptr)
+      throw std::bad_alloc();
+    return (T *)ptr;
+  }
+
+  void deallocate(T *ptr, size_t n) {
+    size_t size = n * sizeof(T);
+    if (mode() != Mode::NONE && size >= threshold)
+      huge_pages::free(ptr, size);
+    else
+      ::operator delete(ptr);
+  }
+
+  template <typename U> bool operator==(const Allocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const Allocator<U> &) const {
+    return false;
+  }
+};
+
+} // namespace huge_pages
+} // namespace concretelang
+} // namespace mlir
+
+#endif
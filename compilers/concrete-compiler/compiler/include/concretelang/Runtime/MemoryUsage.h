@@ -0,0 +1,83 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_MEMORYUSAGE_H
+#define CONCRETELANG_RUNTIME_MEMORYUSAGE_H
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mlir {
+namespace concretelang {
+namespace memory {
+
+/// The memory accounted by the runtime, across all its contexts and calls.
+enum class Category {
+  /// Evaluation keys held by the runtime contexts on the host, in the
+  /// standard and fourier domains.
+  KEYS,
+  /// Arguments and results of the circuit calls.
+  CIPHERTEXTS,
+  /// Buffers of the primitives, e.g. the scratch arenas of the threads.
+  SCRATCH,
+  /// Evaluation keys uploaded on the devices.
+  GPU,
+};
+
+const size_t num_categories = 4;
+
+const char *category_name(Category category);
+
+struct Usage {
+  uint64_t live_bytes = 0;
+  uint64_t peak_bytes = 0;
+};
+
+/// Accounts `bytes` allocated in `category`. The process aborts if it makes
+/// the host memory exceed the limit, as the allocations of the primitives
+/// cannot report an error to the caller.
+void allocate(Category category, size_t bytes);
+
+/// Accounts `bytes` released in `category`.
+void release(Category category, size_t bytes);
+
+/// Returns the usage of each category, indexed by `Category`.
+std::array<Usage, num_categories> usage();
+
+/// Sets the peak of each category to its live bytes.
+void reset_peaks();
+
+/// Sets the limit, in bytes, on the host memory i.e. on every category but
+/// GPU, or removes it if 0. The limit is initialized from
+/// `RUNTIME_MEMORY_LIMIT`.
+void set_limit(uint64_t bytes);
+
+uint64_t limit();
+
+/// Returns whether `bytes` more host bytes fit in the limit.
+bool fits(size_t bytes);
+
+/// Accounts `bytes` in `category` for the lifetime of the object.
+class Allocation {
+public:
+  Allocation(Category category, size_t bytes)
+      : category(category), bytes(bytes) {
+    allocate(category, bytes);
+  }
+  Allocation(const Allocation &other) = delete;
+
+  ~Allocation() { release(category, bytes); }
+
+private:
+  Category category;
+  size_t bytes;
+};
+
+} // namespace memory
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -0,0 +1,45 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_NUMA_H
+#define CONCRETELANG_RUNTIME_NUMA_H
+
+#include <stddef.h>
+
+namespace mlir {
+namespace concretelang {
+namespace numa {
+
+/// Returns the number of NUMA nodes of the machine, 1 if it cannot be
+/// determined.
+size_t num_nodes();
+
+/// Returns the NUMA node of the core the calling thread currently runs on.
+size_t current_node();
+
+/// Returns true if the evaluation keys are to be replicated on each NUMA
+/// node (`RUNTIME_NUMA_REPLICATE_KEYS`), which requires several nodes.
+bool replicate_keys();
+
+/// Returns true if the workers of the runtime are to be pinned to the NUMA
+/// nodes (`RUNTIME_NUMA_BIND`).
+bool bind_workers();
+
+/// Binds the calling thread, the `index`-th of `count` workers, to the cores
+/// of a NUMA node, the workers being spread evenly over the nodes.
+void bind_worker(size_t index, size_t count);
+
+/// Allocates `size` bytes bound to the memory of the NUMA node `node`, to be
+/// released with `free_on_node`.
+void *alloc_on_node(size_t size, size_t node);
+
+/// Releases `size` bytes allocated by `alloc_on_node`.
+void free_on_node(void *ptr, size_t size);
+
+} // namespace numa
+} // namespace concretelang
+} // namespace mlir
+
+#endif
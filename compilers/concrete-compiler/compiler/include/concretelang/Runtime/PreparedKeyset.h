@@ -0,0 +1,71 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_PREPAREDKEYSET_H
+#define CONCRETELANG_RUNTIME_PREPAREDKEYSET_H
+
+#include "concretelang/Common/Error.h"
+#include "concretelang/Common/Keysets.h"
+#include <complex>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using ::concretelang::keysets::ServerKeyset;
+
+namespace mlir {
+namespace concretelang {
+
+/// The evaluation keys of a server keyset in the exact form used by the
+/// runtime, i.e. the bootstrap keys in the fourier domain and the decompressed
+/// keyswitch keys, stored in a file meant to be memory mapped.
+///
+/// The file starts with a header followed by one section descriptor per key
+/// (bootstrap keys first), and every section payload is aligned on a page:
+///
+///   magic[8] | version | bsk_count | ksk_count | (offset, size)* | payloads
+///
+/// All the integers are native 64 bits words. Mapping the file read-only lets
+/// the server start without loading, decompressing or converting the keys, and
+/// lets all the processes of a host share a single copy of them through the
+/// page cache.
+class PreparedKeyset {
+public:
+  PreparedKeyset(const PreparedKeyset &other) = delete;
+  ~PreparedKeyset();
+
+  /// Writes the prepared form of the keyset at the given path.
+  static ::concretelang::error::Result<void>
+  write(const ServerKeyset &serverKeyset, const std::string &path);
+
+  /// Maps the prepared keyset at the given path, checking that it matches the
+  /// parameters of the keys of `serverKeyset`.
+  static ::concretelang::error::Result<std::shared_ptr<PreparedKeyset>>
+  open(const std::string &path, const ServerKeyset &serverKeyset);
+
+  /// Maps the prepared keyset at the given path, writing it first if it is
+  /// missing or does not match `serverKeyset`, e.g. to store it in a
+  /// `KeysetCache` entry.
+  static ::concretelang::error::Result<std::shared_ptr<PreparedKeyset>>
+  openOrWrite(const std::string &path, const ServerKeyset &serverKeyset);
+
+  const std::complex<double> *fourierBootstrapKey(size_t keyId) const;
+
+  const uint64_t *keyswitchKey(size_t keyId) const;
+
+private:
+  PreparedKeyset() = default;
+
+  const uint8_t *mapping = nullptr;
+  size_t mappingSize = 0;
+  std::vector<const std::complex<double> *> fourierBootstrapKeys;
+  std::vector<const uint64_t *> keyswitchKeys;
+};
+
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -0,0 +1,135 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_PROFILER_H
+#define CONCRETELANG_RUNTIME_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace mlir {
+namespace concretelang {
+namespace profiler {
+
+/// The runtime primitives whose calls are recorded. The host/device copies
+/// of the CUDA primitives are also accounted in the primitives themselves.
+enum class Primitive {
+  KEYSWITCH,
+  BOOTSTRAP,
+  LEVELED,
+  TRANSFORMER,
+  COPY,
+  DEVICE_COPY,
+};
+
+const size_t num_primitives = 6;
+
+const char *primitive_name(Primitive primitive);
+
+/// The calls of a primitive recorded by all the threads.
+struct Statistics {
+  uint64_t calls = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+};
+
+/// The parameters of a keyswitch (input and output dimensions, level and
+/// base log, then 0) or of a bootstrap (input dimension, GLWE dimension, log2
+/// of the polynomial size, level and base log), in the order of the lines of
+/// the cost tables read by the optimizer.
+using CostParameters = std::array<uint64_t, 5>;
+
+/// A recorded call of a primitive, timestamped in nanoseconds of the steady
+/// clock.
+struct Event {
+  Primitive primitive;
+  uint32_t thread;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+};
+
+/// Starts or stops recording the calls of the primitives, which is off by
+/// default so that they only pay for a relaxed load. Each call is also kept
+/// as an event if `trace` is set.
+void set_enabled(bool enabled, bool trace = false);
+
+bool enabled();
+
+/// Records a call of `primitive` on the calling thread.
+void record(Primitive primitive, uint64_t start_ns, uint64_t duration_ns);
+
+/// Records that `count` ciphertexts of `primitive`, KEYSWITCH or BOOTSTRAP,
+/// were computed with `parameters` in `thread_ns`, summed over the threads
+/// computing them.
+void record_cost(Primitive primitive, const CostParameters &parameters,
+                 uint64_t count, uint64_t thread_ns);
+
+/// Returns the mean time per ciphertext of the keyswitches and bootstraps
+/// recorded so far, by parameters, as a cost table for the
+/// `--optimizer-cost-table` of the next compilations.
+std::string cost_table();
+
+/// Returns the statistics of each primitive, indexed by `Primitive`.
+std::array<Statistics, num_primitives> statistics();
+
+/// Returns the events recorded since the last call, and forgets them.
+std::vector<Event> take_events();
+
+/// Forgets the statistics and the events recorded so far.
+void reset();
+
+/// Returns `events` in the Chrome trace event format, which is also read by
+/// Perfetto.
+std::string chrome_trace(const std::vector<Event> &events);
+
+/// Records the call of the enclosing scope, if enabled when entering it.
+class Scope {
+public:
+  Scope(Primitive primitive) : primitive(primitive), active(enabled()) {
+    if (active)
+      start = std::chrono::steady_clock::now();
+  }
+
+  /// Also records the cost of the `count` ciphertexts computed by the scope
+  /// on `threads` threads with `parameters`.
+  void cost(const CostParameters &parameters, uint64_t count,
+            uint64_t threads = 1) {
+    costParameters = parameters;
+    costCount = count;
+    costThreads = threads;
+  }
+
+  ~Scope() {
+    if (!active)
+      return;
+    auto end = std::chrono::steady_clock::now();
+    auto ns = [](std::chrono::steady_clock::duration d) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    };
+    uint64_t duration = ns(end - start);
+    record(primitive, ns(start.time_since_epoch()), duration);
+    if (costCount > 0)
+      record_cost(primitive, costParameters, costCount,
+                  duration * costThreads);
+  }
+
+private:
+  Primitive primitive;
+  bool active;
+  std::chrono::steady_clock::time_point start;
+  CostParameters costParameters = {};
+  uint64_t costCount = 0;
+  uint64_t costThreads = 1;
+};
+
+} // namespace profiler
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -0,0 +1,49 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_RUNTIME_TRACEBUFFER_H
+#define CONCRETELANG_RUNTIME_TRACEBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mlir {
+namespace concretelang {
+namespace tracing {
+
+/// The traces of the Tracing dialect, written by default to stdout by the
+/// calling thread. If `RUNTIME_TRACE_FILE` is set, they are instead recorded
+/// in a lock-free ring buffer of the calling thread, and appended to this
+/// file, or to stdout if it is `-`, by a background thread. One trace out of
+/// `RUNTIME_TRACE_SAMPLING` of each thread is then recorded, all by default,
+/// so that the tracing can stay enabled on production circuits.
+enum class Kind : uint8_t {
+  CIPHERTEXT,
+  PLAINTEXT,
+  MESSAGE,
+};
+
+/// Whether the traces are recorded in the buffers.
+bool buffered();
+
+/// Records a trace on the calling thread if it is sampled. The value is the
+/// body of a ciphertext or a plaintext of `width` bits, printed with a space
+/// after `msb` bits. Nothing is recorded when the buffer is full, as the
+/// compiled circuits cannot wait for the background thread.
+void record(Kind kind, uint64_t value, uint32_t width, uint32_t msb,
+            const char *message, uint32_t message_len);
+
+/// Writes the traces recorded so far, as the background thread does
+/// periodically and at exit.
+void flush();
+
+/// Returns the number of traces dropped as their buffer was full.
+uint64_t dropped();
+
+} // namespace tracing
+} // namespace concretelang
+} // namespace mlir
+
+#endif
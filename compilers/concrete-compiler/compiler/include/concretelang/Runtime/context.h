@@ -9,17 +9,27 @@
 #include "concrete-cpu.h"
 #include "concretelang/Common/Error.h"
 #include "concretelang/Common/Keysets.h"
+#include "concretelang/Runtime/HugePages.h"
+#include "concretelang/Runtime/MemoryUsage.h"
+#include "concretelang/Runtime/PreparedKeyset.h"
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <complex>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <pthread.h>
+#include <thread>
 #include <vector>
 
 using ::concretelang::keysets::ServerKeyset;
 
 #ifdef CONCRETELANG_CUDA_SUPPORT
 #include "bootstrap.h"
+#include "bootstrap_multibit.h"
 #include "device.h"
 #include "keyswitch.h"
 #endif
@@ -35,31 +45,88 @@ typedef struct FFT {
   FFT(FFT &&other);
   ~FFT();
 
+  /// Returns the plan of `polynomial_size` shared by the whole process. The
+  /// plans are immutable and used concurrently by all the runtime contexts,
+  /// they live until the process exits.
+  static std::shared_ptr<const FFT> shared(size_t polynomial_size);
+
   struct Fft *fft;
   size_t polynomial_size;
 } FFT;
 
+/// A key in the fourier domain, backed by huge pages if they are enabled as
+/// the bootstraps stream through the whole key.
+using FourierKey =
+    std::vector<std::complex<double>,
+                huge_pages::Allocator<std::complex<double>>>;
+
+/// Scratch memory of a thread, reused across the calls of the runtime
+/// wrappers to avoid allocating and freeing it for every primitive. Buffers
+/// only grow, so a thread ends up holding the largest scratch it ever needed.
+/// They are accounted as `memory::Category::SCRATCH`.
+struct ScratchArena {
+  ScratchArena() = default;
+  ScratchArena(const ScratchArena &other) = delete;
+  ~ScratchArena();
+
+  /// Returns a buffer of at least `size` bytes aligned on `align`.
+  uint8_t *scratch(size_t size, size_t align);
+
+  /// Returns a buffer of at least `size` words used to hold GLWE
+  /// accumulators.
+  uint64_t *glwe(size_t size);
+
+private:
+  uint8_t *scratchBuffer = nullptr;
+  size_t scratchSize = 0;
+  size_t scratchAlign = 0;
+  std::vector<uint64_t> glweBuffer;
+};
+
 typedef struct RuntimeContext {
 
   RuntimeContext() = delete;
-  RuntimeContext(ServerKeyset serverKeyset);
+  /// Builds a context on the given keyset. Bootstrap keys are converted to the
+  /// fourier domain on their first use. If `dropStandardBootstrapKeys` is set,
+  /// the standard domain keys are not kept resident by the context once
+  /// converted, i.e. seeded keys are decompressed in a transient buffer (keys
+  /// which are not seeded are owned by the keyset and cannot be dropped).
+  ///
+  /// If a `preparedKeyset` is given, the fourier bootstrap keys and the
+  /// keyswitch keys are read from it instead of being derived from the keyset.
+  ///
+  /// When `RUNTIME_NUMA_REPLICATE_KEYS` is set on a machine with several NUMA
+  /// nodes, the fourier bootstrap keys are copied on each node and every
+  /// bootstrap reads the copy local to the core it runs on.
+  RuntimeContext(ServerKeyset serverKeyset,
+                 bool dropStandardBootstrapKeys = false,
+                 std::shared_ptr<PreparedKeyset> preparedKeyset = nullptr);
   virtual ~RuntimeContext() {
+    memory::release(memory::Category::KEYS, host_keys_size);
 #ifdef CONCRETELANG_CUDA_SUPPORT
     for (int i = 0; i < num_devices; ++i) {
-      if (bsk_gpu[i] != nullptr)
-        cuda_drop(bsk_gpu[i], i);
-      if (ksk_gpu[i] != nullptr)
-        cuda_drop(ksk_gpu[i], i);
+      for (auto &key : gpu_keys[i]) {
+        cudaEventDestroy(key.second.ready);
+        cuda_drop(key.second.ptr, i);
+      }
+      memory::release(memory::Category::GPU, gpu_keys_size[i]);
     }
 #endif
   };
 
   virtual const uint64_t *keyswitch_key_buffer(size_t keyId) {
+    if (preparedKeyset != nullptr)
+      return preparedKeyset->keyswitchKey(keyId);
     return serverKeyset.lweKeyswitchKeys[keyId].getBuffer().data();
   }
 
   virtual const std::complex<double> *
   fourier_bootstrap_key_buffer(size_t keyId) {
+    ensure_fourier_bootstrap_key(keyId);
+    if (!fourier_bootstrap_key_replicas[keyId].empty())
+      return local_fourier_bootstrap_key_replica(keyId);
+    if (preparedKeyset != nullptr)
+      return preparedKeyset->fourierBootstrapKey(keyId);
     return fourier_bootstrap_keys[keyId]->data();
   }
 
@@ -67,83 +134,141 @@ typedef struct RuntimeContext {
     return serverKeyset.packingKeyswitchKeys[keyId].getRawPtr();
   }
 
-  virtual const struct Fft *fft(size_t keyId) { return ffts[keyId].fft; }
+  virtual const struct Fft *fft(size_t keyId) {
+    ensure_fourier_bootstrap_key(keyId);
+    return ffts[keyId]->fft;
+  }
+
+  /// Returns the grouping factor of the bootstrap key `keyId`, i.e. 1 for a
+  /// classical bootstrap key.
+  uint32_t bootstrap_key_grouping_factor(size_t keyId) const {
+    auto params =
+        serverKeyset.lweBootstrapKeys[keyId].getInfo().asReader().getParams();
+    return std::max<uint32_t>(params.getGroupingFactor(), 1);
+  }
+
+  /// Returns the polynomial size of the output key of the keyswitch key
+  /// `keyId`, i.e. 0 for a classical keyswitch key.
+  uint32_t keyswitch_key_output_polynomial_size(size_t keyId) const {
+    auto params =
+        serverKeyset.lweKeyswitchKeys[keyId].getInfo().asReader().getParams();
+    return params.getOutputPolynomialSize();
+  }
+
+  /// Returns the fast keyswitch key `keyId` in the fourier domain, converting
+  /// it on its first use.
+  const std::complex<double> *fourier_fast_keyswitch_key_buffer(size_t keyId) {
+    ensure_fourier_fast_keyswitch_key(keyId);
+    return fourier_fast_keyswitch_keys[keyId]->data();
+  }
+
+  /// Returns the fft of the output polynomials of the fast keyswitch key
+  /// `keyId`.
+  const struct Fft *fast_keyswitch_fft(size_t keyId) {
+    ensure_fourier_fast_keyswitch_key(keyId);
+    return fast_keyswitch_ffts[keyId]->fft;
+  }
 
   const ServerKeyset getKeys() const { return serverKeyset; }
 
+  /// Returns the scratch arena of the calling thread.
+  ScratchArena &scratch_arena();
+
 protected:
   ServerKeyset serverKeyset;
-  std::vector<std::shared_ptr<std::vector<std::complex<double>>>>
-      fourier_bootstrap_keys;
-  std::vector<FFT> ffts;
-  std::pair<FFT, std::shared_ptr<std::vector<std::complex<double>>>>
+  std::vector<std::shared_ptr<FourierKey>> fourier_bootstrap_keys;
+  std::vector<std::shared_ptr<const FFT>> ffts;
+  std::pair<std::shared_ptr<const FFT>, std::shared_ptr<FourierKey>>
   convert_to_fourier_domain(LweBootstrapKey &bsk);
 
-#ifdef CONCRETELANG_CUDA_SUPPORT
-public:
-  void *get_bsk_gpu(uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
-                    uint32_t glwe_dim, uint32_t gpu_idx, void *stream) {
+private:
+  /// Converts the bootstrap key to the fourier domain if it is not yet.
+  void ensure_fourier_bootstrap_key(size_t keyId);
 
-    if (bsk_gpu[gpu_idx] != nullptr) {
-      return bsk_gpu[gpu_idx];
-    }
-    const std::lock_guard<std::mutex> guard(*bsk_gpu_mutex[gpu_idx]);
+  /// Converts the fast keyswitch key to the fourier domain if it is not yet.
+  void ensure_fourier_fast_keyswitch_key(size_t keyId);
 
-    if (bsk_gpu[gpu_idx] != nullptr) {
-      return bsk_gpu[gpu_idx];
-    }
+  /// Copies the fourier bootstrap key `keyId` on each NUMA node.
+  void replicate_fourier_bootstrap_key(size_t keyId);
 
-    auto bsk = serverKeyset.lweBootstrapKeys[0];
-
-    size_t bsk_buffer_len = bsk.getBuffer().size();
-    size_t bsk_gpu_buffer_size = bsk_buffer_len * sizeof(double);
-
-    void *bsk_gpu_tmp =
-        cuda_malloc_async(bsk_gpu_buffer_size, (cudaStream_t *)stream, gpu_idx);
-    cuda_convert_lwe_bootstrap_key_64(
-        bsk_gpu_tmp, const_cast<uint64_t *>(bsk.getBuffer().data()),
-        (cudaStream_t *)stream, gpu_idx, input_lwe_dim, glwe_dim, level,
-        poly_size);
-    // Synchronization here is not optional as it works with mutex to
-    // prevent other GPU streams from reading partially copied keys.
-    cudaStreamSynchronize(*(cudaStream_t *)stream);
-    bsk_gpu[gpu_idx] = bsk_gpu_tmp;
-    return bsk_gpu[gpu_idx];
-  }
+  /// Returns the copy of the fourier bootstrap key `keyId` on the NUMA node
+  /// of the calling thread.
+  const std::complex<double> *local_fourier_bootstrap_key_replica(size_t keyId);
 
-  void *get_ksk_gpu(uint32_t level, uint32_t input_lwe_dim,
-                    uint32_t output_lwe_dim, uint32_t gpu_idx, void *stream) {
+  bool dropStandardBootstrapKeys;
+  std::shared_ptr<PreparedKeyset> preparedKeyset;
+  std::vector<std::once_flag> fourier_conversion_flags;
+  /// The copies of the fourier bootstrap keys on each NUMA node, by key then
+  /// node, empty if the keys are not replicated.
+  std::vector<std::vector<std::shared_ptr<std::complex<double>>>>
+      fourier_bootstrap_key_replicas;
 
-    if (ksk_gpu[gpu_idx] != nullptr) {
-      return ksk_gpu[gpu_idx];
-    }
+  /// The fast keyswitch keys in the fourier domain, null for the classical
+  /// keyswitch keys and until their first use.
+  std::vector<std::shared_ptr<FourierKey>> fourier_fast_keyswitch_keys;
+  std::vector<std::shared_ptr<const FFT>> fast_keyswitch_ffts;
+  std::vector<std::once_flag> fast_keyswitch_conversion_flags;
 
-    const std::lock_guard<std::mutex> guard(*ksk_gpu_mutex[gpu_idx]);
-    if (ksk_gpu[gpu_idx] != nullptr) {
-      return ksk_gpu[gpu_idx];
-    }
-    auto ksk = serverKeyset.lweKeyswitchKeys[0];
+  /// The bytes of the host keys accounted by the context: the standard keys
+  /// of its keyset, and the fourier keys and their replicas it converted.
+  std::atomic<size_t> host_keys_size{0};
 
-    size_t ksk_buffer_size = sizeof(uint64_t) * ksk.getBuffer().size();
+  std::mutex scratch_arenas_guard;
+  std::map<std::thread::id, std::unique_ptr<ScratchArena>> scratch_arenas;
 
-    void *ksk_gpu_tmp =
-        cuda_malloc_async(ksk_buffer_size, (cudaStream_t *)stream, gpu_idx);
+public:
+  /// Uploads all the evaluation keys on every device, so that the first
+  /// computations do not wait for them. It returns once the keys are resident.
+  /// Does nothing without GPU support.
+  void prefetch_keys_to_gpu();
 
-    cuda_memcpy_async_to_gpu(ksk_gpu_tmp,
-                             const_cast<uint64_t *>(ksk.getBuffer().data()),
-                             ksk_buffer_size, (cudaStream_t *)stream, gpu_idx);
-    // Synchronization here is not optional as it works with mutex to
-    // prevent other GPU streams from reading partially copied keys.
-    cudaStreamSynchronize(*(cudaStream_t *)stream);
-    ksk_gpu[gpu_idx] = ksk_gpu_tmp;
-    return ksk_gpu[gpu_idx];
-  }
+#ifdef CONCRETELANG_CUDA_SUPPORT
+  /// Returns the bootstrap key `bsk_index` in the fourier domain on the
+  /// device `gpu_idx`, uploading it on first use. Multi-bit bootstrap keys
+  /// are uploaded in the standard domain, as expected by the multi-bit PBS.
+  void *get_bsk_gpu(uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+                    uint32_t glwe_dim, uint32_t bsk_index, uint32_t gpu_idx,
+                    void *stream);
+
+  /// Returns the keyswitch key `ksk_index` on the device `gpu_idx`, uploading
+  /// it on first use.
+  void *get_ksk_gpu(uint32_t level, uint32_t input_lwe_dim,
+                    uint32_t output_lwe_dim, uint32_t ksk_index,
+                    uint32_t gpu_idx, void *stream);
+
+  /// Returns the packing keyswitch key `pksk_index` on the device `gpu_idx`,
+  /// uploading it on first use.
+  void *get_pksk_gpu(uint32_t pksk_index, uint32_t gpu_idx, void *stream);
 
 private:
-  std::vector<std::unique_ptr<std::mutex>> bsk_gpu_mutex;
-  std::vector<void *> bsk_gpu;
-  std::vector<std::unique_ptr<std::mutex>> ksk_gpu_mutex;
-  std::vector<void *> ksk_gpu;
+  enum class GpuKeyKind { BSK, KSK, PKSK };
+  typedef std::pair<GpuKeyKind, uint32_t> GpuKeyId;
+  struct GpuKey {
+    void *ptr;
+    size_t size;
+    uint64_t last_use;
+    /// Recorded on the uploading stream once the key is filled.
+    cudaEvent_t ready;
+  };
+
+  /// Returns the key `id` resident on the device `gpu_idx`, allocating
+  /// `size` bytes and filling them with `upload` on miss. The upload is not
+  /// waited for on the host, `stream` is instead ordered after it.
+  void *get_gpu_key(GpuKeyId id, size_t size, uint32_t gpu_idx, void *stream,
+                    std::function<void(void *)> upload);
+
+  /// Evicts the least recently used keys of the device until `size` more
+  /// bytes fit in the budget. Must be called with the device mutex held.
+  void evict_gpu_keys(uint32_t gpu_idx, size_t size);
+
+  /// The keys resident on each device, guarded by the mutex of the device.
+  std::vector<std::unique_ptr<std::mutex>> gpu_keys_mutex;
+  std::vector<std::map<GpuKeyId, GpuKey>> gpu_keys;
+  std::vector<size_t> gpu_keys_size;
+  /// The device memory, in bytes, the keys can use on each device, or 0 if
+  /// unbounded (`GPU_KEYS_MEMORY_BUDGET`).
+  size_t gpu_keys_budget;
+  std::atomic<uint64_t> gpu_keys_clock{0};
   int num_devices;
 #endif
 } RuntimeContext;
@@ -151,19 +276,88 @@ private:
 struct DistributedRuntimeContext : public RuntimeContext {
 
   using RuntimeContext::RuntimeContext;
+  /// Waits for the keys still being fetched in the background.
+  ~DistributedRuntimeContext();
   const uint64_t *keyswitch_key_buffer(size_t keyId) override;
   const std::complex<double> *
   fourier_bootstrap_key_buffer(size_t keyId) override;
   const uint64_t *fp_keyswitch_key_buffer(size_t keyId) override;
   const struct Fft *fft(size_t keyId) override;
 
+  /// Starts fetching the key `keyId` of `kind` (a `dfr::KeyKind`) from the
+  /// root node in the background, unless it has already been requested.
+  void prefetch(uint64_t kind, size_t keyId);
+
+  /// The id of the keyset of the context on the root node, from which the
+  /// keys are fetched.
+  uint64_t context_id = 0;
+
 private:
-  void getBSKonNode(size_t keyId);
+  using FourierBootstrapKey =
+      std::pair<std::shared_ptr<const FFT>, std::shared_ptr<FourierKey>>;
+
+  /// Returns the key `keyId` of `keys`, requesting it with `fetch` if it has
+  /// not been yet, on the calling thread if `wait` is set or in the
+  /// background otherwise. The mutex only guards the maps, so that threads
+  /// only wait for the keys they use, and each key is fetched once.
+  template <typename Key>
+  std::shared_future<Key>
+  requestKey(std::map<size_t, std::shared_future<Key>> &keys, size_t keyId,
+             std::function<Key()> fetch, bool wait);
+
+  std::shared_future<std::shared_ptr<LweKeyswitchKey>> requestKSK(size_t keyId,
+                                                                  bool wait);
+  std::shared_future<FourierBootstrapKey> requestBSK(size_t keyId, bool wait);
+  std::shared_future<std::shared_ptr<PackingKeyswitchKey>>
+  requestPKSK(size_t keyId, bool wait);
+
   std::mutex cm_guard;
-  std::map<size_t, LweKeyswitchKey> ksks;
-  std::map<size_t, std::shared_ptr<std::vector<std::complex<double>>>> fbks;
-  std::map<size_t, FFT> dffts;
-  std::map<size_t, PackingKeyswitchKey> pksks;
+  std::map<size_t, std::shared_future<std::shared_ptr<LweKeyswitchKey>>> ksks;
+  std::map<size_t, std::shared_future<FourierBootstrapKey>> fbks;
+  std::map<size_t, std::shared_future<std::shared_ptr<PackingKeyswitchKey>>>
+      pksks;
+};
+
+/// A process-wide cache of runtime contexts keyed by the identity of the
+/// server keyset they have been built from. A `RuntimeContext` converts the
+/// bootstrap keys it uses to the fourier domain, which largely dominates the
+/// cost of small circuit calls, so calls made with the same keyset share a
+/// single context until it is explicitly evicted.
+///
+/// The identity of a keyset is the set of key buffers it points to. Copies of
+/// a keyset share those buffers and hence hit the same entry. The cached
+/// context itself holds a copy of the keyset, which guarantees that the
+/// buffers (and their addresses) stay alive as long as the entry does.
+class RuntimeContextCache {
+public:
+  /// Returns the cache shared by the whole process.
+  static RuntimeContextCache &global();
+
+  /// Returns the context associated to the keyset, building it on miss.
+  std::shared_ptr<RuntimeContext> get(const ServerKeyset &serverKeyset);
+
+  /// Associates to the keyset a context reading its keys from the prepared
+  /// keyset, replacing the cached one if any.
+  std::shared_ptr<RuntimeContext>
+  preload(const ServerKeyset &serverKeyset,
+          std::shared_ptr<PreparedKeyset> preparedKeyset);
+
+  /// Drops the context associated to the keyset, if any. Contexts still in use
+  /// by running calls are released when the last of them finishes.
+  void evict(const ServerKeyset &serverKeyset);
+
+  /// Drops all the cached contexts.
+  void clear();
+
+  /// Returns the number of cached contexts.
+  size_t size();
+
+private:
+  typedef std::vector<const void *> KeysetIdentity;
+  static KeysetIdentity identityOf(const ServerKeyset &serverKeyset);
+
+  std::mutex guard;
+  std::map<KeysetIdentity, std::shared_ptr<RuntimeContext>> contexts;
 };
 
 } // namespace concretelang
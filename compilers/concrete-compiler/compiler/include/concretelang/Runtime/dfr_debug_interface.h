@@ -14,5 +14,9 @@ size_t _dfr_debug_get_node_id();
 size_t _dfr_debug_get_worker_id();
 void _dfr_debug_print_task(const char *name, size_t inputs, size_t outputs);
 void _dfr_print_debug(size_t val);
+/// Writes the statistics of the dataflow runtime on this node, in the
+/// Prometheus text exposition format and null terminated, to `buffer` if
+/// they fit in `size` bytes. Returns their length.
+size_t _dfr_get_statistics_prometheus(char *buffer, size_t size);
 }
 #endif
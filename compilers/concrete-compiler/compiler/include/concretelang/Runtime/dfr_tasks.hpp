@@ -7,6 +7,11 @@
 #define CONCRETELANG_DFR_TASKS_HPP
 #ifdef CONCRETELANG_DATAFLOW_EXECUTION_ENABLED
 
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
 namespace mlir {
 namespace concretelang {
 namespace dfr {
@@ -20,15 +25,147 @@ typedef struct dfr_refcounted_future {
       : future(f), count(c), cloned_memref_p(clone_p) {}
 } dfr_refcounted_future_t, *dfr_refcounted_future_p;
 
-// Determine where new task should run.  For now just round-robin
-// distribution - TODO: optimise.
-static inline size_t dfr_get_next_execution_locality() {
-  static std::atomic<std::size_t> next_locality{1};
+/// Chooses the node on which each task runs and keeps per node counters of
+/// the tasks and of the input bytes sent to them.
+///
+/// By default, tasks are distributed round-robin over the nodes. With
+/// `DFR_TASK_PLACEMENT=locality`, the node is chosen once the inputs of the
+/// task are ready, from their actual size. As the outputs of every task are
+/// returned to the node creating it, all inputs are local to that node:
+/// tasks whose inputs are smaller than `DFR_LOCAL_TASK_BYTES` (64 KiB by
+/// default) run locally, and the other ones run on the node with the fewest
+/// pending input bytes, the local one first among equally loaded nodes. A
+/// node which falls behind stops receiving work until the others have caught
+/// up, which balances the load without moving tasks once dispatched.
+///
+/// With `DFR_TASK_RETRIES` set to a positive count, a task failing on a
+/// remote node, e.g. because the node was lost, is re-executed up to that
+/// many times from the inputs retained on the creating node. The failing
+/// node no longer receives work, and the task runs locally once no remote
+/// node is left.
+///
+/// With `DFR_TASK_PLACEMENT_STATS` set, the counters are printed at the end
+/// of each computation phase. They are also part of _dfr_get_statistics.
+struct TaskPlacement {
+  TaskPlacement()
+      : tasks(num_nodes), bytes(num_nodes), pending_bytes(num_nodes),
+        alive(num_nodes) {
+    char *env = getenv("DFR_TASK_PLACEMENT");
+    locality_aware = env != nullptr && !strncmp(env, "locality", 8);
+    env = getenv("DFR_LOCAL_TASK_BYTES");
+    if (env != nullptr)
+      local_task_bytes = strtoull(env, NULL, 10);
+    env = getenv("DFR_TASK_RETRIES");
+    if (env != nullptr)
+      max_retries = strtoull(env, NULL, 10);
+    for (auto &a : alive)
+      a = true;
+  }
 
-  size_t next_loc = next_locality.fetch_add(1);
+  static TaskPlacement &get() {
+    static TaskPlacement placement;
+    return placement;
+  }
 
-  return next_loc % num_nodes;
-}
+  hpx::future<OpaqueOutputData> execute_task(const OpaqueInputData &oid) {
+    return dispatch(oid, max_retries);
+  }
+
+  void print_stats() {
+    static bool enabled = getenv("DFR_TASK_PLACEMENT_STATS") != nullptr;
+    if (!enabled)
+      return;
+    for (size_t node = 0; node < tasks.size(); ++node)
+      std::cout << "[NODE \t" << node << "] \ttasks : \t" << tasks[node]
+                << " \tinput bytes sent : \t" << bytes[node] << "\n"
+                << std::flush;
+  }
+
+  void get_statistics(DFRStatistics &statistics) {
+    for (size_t node = 0; node < tasks.size(); ++node) {
+      statistics.node_tasks.push_back(tasks[node]);
+      statistics.node_bytes_sent.push_back(bytes[node]);
+    }
+  }
+
+  void reset() {
+    for (size_t node = 0; node < tasks.size(); ++node) {
+      tasks[node] = 0;
+      bytes[node] = 0;
+    }
+  }
+
+private:
+  hpx::future<OpaqueOutputData> dispatch(const OpaqueInputData &oid,
+                                         size_t retries) {
+    size_t task_bytes = dfr_get_task_input_bytes(oid);
+    size_t node =
+        locality_aware ? select_node(task_bytes) : next_alive_node();
+    size_t local = hpx::get_locality_id();
+    size_t sent = (node == local) ? 0 : task_bytes;
+    tasks[node].fetch_add(1);
+    bytes[node].fetch_add(sent);
+    hpx::future<OpaqueOutputData> result = gcc[node].execute_task(oid);
+    if (locality_aware) {
+      pending_bytes[node].fetch_add(task_bytes);
+      result = result.then(
+          [this, node, task_bytes](hpx::future<OpaqueOutputData> f) {
+            pending_bytes[node].fetch_sub(task_bytes);
+            return f.get();
+          });
+    }
+    if (retries == 0 || node == local)
+      return result;
+    // The inputs stay alive on this node until the outputs are consumed,
+    // the retained descriptor is enough to run the task again.
+    auto retried = result.then(
+        [this, node, oid, retries](hpx::future<OpaqueOutputData> f)
+            -> hpx::future<OpaqueOutputData> {
+          if (!f.has_exception())
+            return f;
+          try {
+            f.get();
+          } catch (std::exception const &e) {
+            if (alive[node].exchange(false))
+              std::cerr << "WARNING: task failed on node " << node << " ("
+                        << e.what() << "), re-executing its tasks on the "
+                        << "remaining nodes.\n"
+                        << std::flush;
+          }
+          return dispatch(oid, retries - 1);
+        });
+    return hpx::future<OpaqueOutputData>(std::move(retried));
+  }
+
+  size_t next_alive_node() {
+    for (size_t i = 0; i < num_nodes; ++i) {
+      size_t node = next_locality.fetch_add(1) % num_nodes;
+      if (alive[node])
+        return node;
+    }
+    return hpx::get_locality_id();
+  }
+
+  size_t select_node(size_t task_bytes) {
+    size_t local = hpx::get_locality_id();
+    if (task_bytes < local_task_bytes)
+      return local;
+    size_t best = local;
+    for (size_t node = 0; node < pending_bytes.size(); ++node)
+      if (alive[node] && pending_bytes[node] < pending_bytes[best])
+        best = node;
+    return best;
+  }
+
+  bool locality_aware = false;
+  size_t local_task_bytes = 64 << 10;
+  std::atomic<std::size_t> next_locality{1};
+  std::vector<std::atomic<uint64_t>> tasks;
+  std::vector<std::atomic<uint64_t>> bytes;
+  std::vector<std::atomic<uint64_t>> pending_bytes;
+  size_t max_retries = 0;
+  std::vector<std::atomic<bool>> alive;
+};
 
 void dfr_create_async_task_impl(wfnptr wfn, void *ctx,
                                 std::vector<void *> &refcounted_futures,
@@ -37,6 +174,8 @@ void dfr_create_async_task_impl(wfnptr wfn, void *ctx,
                                 std::vector<void *> &outputs,
                                 std::vector<size_t> &output_sizes,
                                 std::vector<uint64_t> &output_types) {
+  Telemetry::get().tasks_created.fetch_add(1, std::memory_order_relaxed);
+
   // Take a reference on each future argument
   for (auto rcf : refcounted_futures)
     ((dfr_refcounted_future_p)rcf)->count.fetch_add(1);
@@ -55,15 +194,24 @@ void dfr_create_async_task_impl(wfnptr wfn, void *ctx,
   // satisfied, which generates a future on a tuple of outputs, which
   // is then further split into a tuple of futures and provide
   // individual synchronization for each return independently.
-  GenericComputeClient *gcc_target = &gcc[dfr_get_next_execution_locality()];
-  switch (refcounted_futures.size()) {
-
-#include "concretelang/Runtime/generated/dfr_dataflow_inputs_cases.h"
-
-  default:
-    HPX_THROW_EXCEPTION(hpx::error::no_success, "_dfr_create_async_task",
-                        "Error: number of task parameters not supported.");
-  }
+  TaskPlacement *placement = &TaskPlacement::get();
+  std::vector<hpx::shared_future<void *>> param_futures;
+  param_futures.reserve(refcounted_futures.size());
+  for (auto rcf : refcounted_futures)
+    param_futures.push_back(*((dfr_refcounted_future_p)rcf)->future);
+  oodf = hpx::dataflow(
+      [wfnname, param_sizes, param_types, output_sizes, output_types, placement,
+       ctx](std::vector<hpx::shared_future<void *>> &&param_futures)
+          -> hpx::future<OpaqueOutputData> {
+        std::vector<void *> params;
+        params.reserve(param_futures.size());
+        for (auto &param : param_futures)
+          params.push_back(param.get());
+        OpaqueInputData oid(wfnname, params, param_sizes, param_types,
+                            output_sizes, output_types, ctx);
+        return placement->execute_task(oid);
+      },
+      std::move(param_futures));
 
   switch (outputs.size()) {
   case 1:
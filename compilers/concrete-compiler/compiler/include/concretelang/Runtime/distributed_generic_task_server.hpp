@@ -6,10 +6,14 @@
 #ifndef CONCRETELANG_DFR_DISTRIBUTED_GENERIC_TASK_SERVER_HPP
 #define CONCRETELANG_DFR_DISTRIBUTED_GENERIC_TASK_SERVER_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdlib>
 #include <malloc.h>
 #include <string>
+#include <vector>
 
 #include <hpx/async_colocated/get_colocation_id.hpp>
 #include <hpx/include/actions.hpp>
@@ -21,6 +25,8 @@
 #include <hpx/serialization/detail/serialize_collection.hpp>
 #include <hpx/serialization/serialization_fwd.hpp>
 #include <hpx/serialization/serialize.hpp>
+#include <hpx/serialization/serialize_buffer.hpp>
+#include <hpx/serialization/vector.hpp>
 
 #include <hpx/async_colocated/get_colocation_id.hpp>
 #include <hpx/include/client.hpp>
@@ -49,6 +55,8 @@ static inline size_t _dfr_get_memref_rank(size_t size) {
          (2 * sizeof(int64_t) /*size&stride/rank*/);
 }
 
+typedef hpx::serialization::serialize_buffer<char> dfr_memref_buffer_t;
+
 static inline void _dfr_checked_aligned_alloc(void **out, size_t align,
                                               size_t size) {
   int res = posix_memalign(out, align, size);
@@ -60,6 +68,79 @@ static inline void _dfr_checked_aligned_alloc(void **out, size_t align,
                         "Error: invalid memory alignment.");
 }
 
+/// Returns the number of bits of the mask elements of a memref of
+/// ciphertexts sent between nodes, or 0 if it is sent whole.
+static inline size_t _dfr_get_wire_bits(uint64_t type, size_t elementSize,
+                                        size_t rank) {
+  if (elementSize != sizeof(uint64_t) || rank == 0)
+    return 0;
+  return _dfr_get_memref_wire_bits(type);
+}
+
+/// Packs `size` ciphertexts elements of `row` elements each, keeping the
+/// `bits` most significant bits of the mask elements, rounded to the
+/// closest, followed by the bodies. A keyswitch only uses these bits of the
+/// mask elements of its input (level count times base log), and copies the
+/// body, so that the unpacked ciphertexts keyswitch to the same result.
+static inline std::vector<uint64_t>
+_dfr_pack_ciphertexts(const uint64_t *data, size_t size, size_t row,
+                      size_t bits) {
+  assert(bits > 0 && bits < 64 && row > 0 && size % row == 0);
+  size_t shift = 64 - bits;
+  uint64_t mask = (((uint64_t)1) << bits) - 1;
+  std::vector<uint64_t> packed;
+  packed.reserve((size * bits + 63) / 64 + size / row);
+  uint64_t word = 0;
+  size_t used = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (i % row == row - 1)
+      continue;
+    uint64_t x = data[i];
+    uint64_t rounded = ((x >> shift) + ((x >> (shift - 1)) & 1)) & mask;
+    word |= rounded << used;
+    used += bits;
+    if (used >= 64) {
+      packed.push_back(word);
+      used -= 64;
+      word = used == 0 ? 0 : rounded >> (bits - used);
+    }
+  }
+  if (used > 0)
+    packed.push_back(word);
+  for (size_t i = row - 1; i < size; i += row)
+    packed.push_back(data[i]);
+  return packed;
+}
+
+/// Unpacks the ciphertexts packed by `_dfr_pack_ciphertexts`, the dropped
+/// bits of the mask elements being zeros.
+static inline void _dfr_unpack_ciphertexts(const std::vector<uint64_t> &packed,
+                                           uint64_t *data, size_t size,
+                                           size_t row, size_t bits) {
+  assert(bits > 0 && bits < 64 && row > 0 && size % row == 0);
+  size_t shift = 64 - bits;
+  uint64_t mask = (((uint64_t)1) << bits) - 1;
+  size_t masks = size - size / row;
+  size_t mask_words = (masks * bits + 63) / 64;
+  assert(packed.size() == mask_words + size / row);
+  size_t w = 0, used = 0;
+  for (size_t i = 0; i < size; ++i) {
+    if (i % row == row - 1) {
+      data[i] = packed[mask_words + i / row];
+      continue;
+    }
+    uint64_t rounded = packed[w] >> used;
+    if (used + bits > 64)
+      rounded |= packed[w + 1] << (64 - used);
+    data[i] = (rounded & mask) << shift;
+    used += bits;
+    if (used >= 64) {
+      used -= 64;
+      ++w;
+    }
+  }
+}
+
 struct OpaqueInputData {
   OpaqueInputData() = default;
 
@@ -82,12 +163,14 @@ struct OpaqueInputData {
         param_sizes(std::move(oid.param_sizes)),
         param_types(std::move(oid.param_types)),
         output_sizes(std::move(oid.output_sizes)),
-        output_types(std::move(oid.output_types)), context(oid.context) {}
+        output_types(std::move(oid.output_types)), context(oid.context),
+        buffers(oid.buffers) {}
 
   friend class hpx::serialization::access;
   template <class Archive> void load(Archive &ar, const unsigned int version) {
     bool has_context;
-    ar >> wfn_name >> has_context;
+    uint64_t context_id;
+    ar >> wfn_name >> has_context >> context_id;
     ar >> param_sizes >> param_types;
     ar >> output_sizes >> output_types;
     for (size_t p = 0; p < param_sizes.size(); ++p) {
@@ -108,11 +191,40 @@ struct OpaqueInputData {
         size_t size = 1;
         for (size_t r = 0; r < rank; ++r)
           size *= mref.sizes[r];
-        size_t alloc_size = (size + mref.offset) * elementSize;
+        size_t bits = _dfr_get_wire_bits(param_types[p], elementSize, rank);
+        if (bits != 0 && size != 0) {
+          std::vector<uint64_t> packed;
+          ar >> packed;
+          char *data;
+          _dfr_checked_aligned_alloc((void **)&data, 512,
+                                     (size + mref.offset) * elementSize);
+          _dfr_unpack_ciphertexts(
+              packed, (uint64_t *)data + mref.offset, size,
+              mref.sizes[rank - 1], bits);
+          buffers.push_back(dfr_memref_buffer_t());
+          static_cast<StridedMemRefType<char, 1> *>(params[p])->basePtr =
+              nullptr;
+          static_cast<StridedMemRefType<char, 1> *>(params[p])->data = data;
+          break;
+        }
+        // The payload of large memrefs is received in place by the
+        // parcel layer, use it directly unless it is misaligned for the
+        // elements.
+        dfr_memref_buffer_t buffer;
+        ar >> buffer;
+        assert(buffer.size() == size * elementSize);
         char *data;
-        _dfr_checked_aligned_alloc((void **)&data, 512, alloc_size);
-        ar >> hpx::serialization::make_array(data + mref.offset * elementSize,
-                                             size * elementSize);
+        if (buffer.size() != 0 &&
+            (uintptr_t)buffer.data() % elementSize == 0) {
+          data = buffer.data() - mref.offset * elementSize;
+          buffers.push_back(std::move(buffer));
+        } else {
+          size_t alloc_size = (size + mref.offset) * elementSize;
+          _dfr_checked_aligned_alloc((void **)&data, 512, alloc_size);
+          std::copy(buffer.data(), buffer.data() + buffer.size(),
+                    data + mref.offset * elementSize);
+          buffers.push_back(dfr_memref_buffer_t());
+        }
         static_cast<StridedMemRefType<char, 1> *>(params[p])->basePtr = nullptr;
         static_cast<StridedMemRefType<char, 1> *>(params[p])->data = data;
       } break;
@@ -123,12 +235,19 @@ struct OpaqueInputData {
     }
     if (has_context)
       params.push_back(
-          (void *)_dfr_node_level_runtime_context_manager->getContext());
+          (void *)_dfr_node_level_runtime_context_manager->getContext(
+              context_id));
   }
   template <class Archive>
   void save(Archive &ar, const unsigned int version) const {
     bool has_context = (bool)(context != nullptr);
-    ar << wfn_name << has_context;
+    // Tasks name the keyset of their context, as the nodes may hold the
+    // contexts of several keysets.
+    uint64_t context_id =
+        has_context
+            ? _dfr_node_level_runtime_context_manager->getContextId(context)
+            : 0;
+    ar << wfn_name << has_context << context_id;
     ar << param_sizes << param_types;
     ar << output_sizes << output_types;
     for (size_t p = 0; p < param_sizes.size(); ++p) {
@@ -146,8 +265,18 @@ struct OpaqueInputData {
         size_t size = 1;
         for (size_t r = 0; r < rank; ++r)
           size *= mref.sizes[r];
-        ar << hpx::serialization::make_array(
-            mref.data + mref.offset * elementSize, size * elementSize);
+        size_t bits = _dfr_get_wire_bits(param_types[p], elementSize, rank);
+        if (bits != 0 && size != 0) {
+          ar << _dfr_pack_ciphertexts(
+              (const uint64_t *)mref.data + mref.offset, size,
+              mref.sizes[rank - 1], bits);
+          break;
+        }
+        // Reference the payload without copying it in the archive, so that
+        // large memrefs are sent as zero-copy chunks.
+        ar << dfr_memref_buffer_t(mref.data + mref.offset * elementSize,
+                                  size * elementSize,
+                                  dfr_memref_buffer_t::reference);
       } break;
       default:
         HPX_THROW_EXCEPTION(hpx::error::no_success, "DFR: OpaqueInputData save",
@@ -164,6 +293,10 @@ struct OpaqueInputData {
   std::vector<size_t> output_sizes;
   std::vector<uint64_t> output_types;
   void *context;
+  // The receive buffers holding the payload of the memref parameters of a
+  // deserialized task, in order, or empty buffers for the payloads copied
+  // to a fresh allocation.
+  std::vector<dfr_memref_buffer_t> buffers;
 };
 
 struct OpaqueOutputData {
@@ -203,8 +336,16 @@ struct OpaqueOutputData {
         size_t alloc_size = (size + mref.offset) * elementSize;
         char *data;
         _dfr_checked_aligned_alloc((void **)&data, 512, alloc_size);
-        ar >> hpx::serialization::make_array(data + mref.offset * elementSize,
-                                             size * elementSize);
+        size_t bits = _dfr_get_wire_bits(output_types[p], elementSize, rank);
+        if (bits != 0 && size != 0) {
+          std::vector<uint64_t> packed;
+          ar >> packed;
+          _dfr_unpack_ciphertexts(packed, (uint64_t *)data + mref.offset,
+                                  size, mref.sizes[rank - 1], bits);
+        } else {
+          ar >> hpx::serialization::make_array(
+              data + mref.offset * elementSize, size * elementSize);
+        }
         static_cast<StridedMemRefType<char, 1> *>(outputs[p])->basePtr =
             nullptr;
         static_cast<StridedMemRefType<char, 1> *>(outputs[p])->data = data;
@@ -232,8 +373,14 @@ struct OpaqueOutputData {
         size_t size = 1;
         for (size_t r = 0; r < rank; ++r)
           size *= mref.sizes[r];
-        ar << hpx::serialization::make_array(
-            mref.data + mref.offset * elementSize, size * elementSize);
+        size_t bits = _dfr_get_wire_bits(output_types[p], elementSize, rank);
+        if (bits != 0 && size != 0)
+          ar << _dfr_pack_ciphertexts(
+              (const uint64_t *)mref.data + mref.offset, size,
+              mref.sizes[rank - 1], bits);
+        else
+          ar << hpx::serialization::make_array(
+              mref.data + mref.offset * elementSize, size * elementSize);
       } break;
       default:
         HPX_THROW_EXCEPTION(hpx::error::no_success, "DFR: OpaqueInputData save",
@@ -248,11 +395,37 @@ struct OpaqueOutputData {
   std::vector<uint64_t> output_types;
 };
 
+/// Returns the number of bytes sent to a remote node to run a task with
+/// these inputs.
+static inline size_t dfr_get_task_input_bytes(const OpaqueInputData &oid) {
+  size_t bytes = 0;
+  for (size_t p = 0; p < oid.param_sizes.size(); ++p) {
+    bytes += oid.param_sizes[p];
+    if (_dfr_get_arg_type(oid.param_types[p]) != _DFR_TASK_ARG_MEMREF)
+      continue;
+    size_t rank = _dfr_get_memref_rank(oid.param_sizes[p]);
+    UnrankedMemRefType<char> umref = {(int64_t)rank, oid.params[p]};
+    DynamicMemRefType<char> mref(umref);
+    size_t size = _dfr_get_memref_element_size(oid.param_types[p]);
+    for (size_t r = 0; r < rank; ++r)
+      size *= mref.sizes[r];
+    bytes += size;
+  }
+  return bytes;
+}
+
+/// Accounts a task executed by the current worker in `ns` nanoseconds, whose
+/// inputs of `bytes_received` bytes came from another node.
+void _dfr_record_task_execution(uint64_t bytes_received, uint64_t ns);
+
 struct GenericComputeServer : component_base<GenericComputeServer> {
   GenericComputeServer() = default;
 
   // Component actions exposed
   OpaqueOutputData execute_task(const OpaqueInputData &inputs) {
+    auto start = std::chrono::steady_clock::now();
+    size_t received =
+        _dfr_is_root_node() ? 0 : dfr_get_task_input_bytes(inputs);
     auto wfn = _dfr_node_level_work_function_registry->getWorkFunctionPointer(
         inputs.wfn_name);
     std::vector<void *> outputs;
@@ -267,16 +440,22 @@ struct GenericComputeServer : component_base<GenericComputeServer> {
                           "Error: number of task outputs not supported.");
     }
 
-    // Deallocate input data buffers from OID deserialization (load)
+    // Deallocate input data buffers from OID deserialization (load),
+    // the receive buffers are released with the OID.
     if (!_dfr_is_root_node()) {
-      for (size_t p = 0; p < inputs.param_sizes.size(); ++p) {
-        if (_dfr_get_arg_type(inputs.param_types[p]) == _DFR_TASK_ARG_MEMREF)
+      for (size_t p = 0, m = 0; p < inputs.param_sizes.size(); ++p) {
+        if (_dfr_get_arg_type(inputs.param_types[p]) == _DFR_TASK_ARG_MEMREF &&
+            inputs.buffers[m++].size() == 0)
           delete (static_cast<StridedMemRefType<char, 1> *>(inputs.params[p])
                       ->data);
         delete ((char *)inputs.params[p]);
       }
     }
 
+    _dfr_record_task_execution(
+        received, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count());
     return OpaqueOutputData(std::move(outputs), std::move(inputs.output_sizes),
                             std::move(inputs.output_types));
   }
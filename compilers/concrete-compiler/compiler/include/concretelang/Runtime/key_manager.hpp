@@ -6,11 +6,17 @@
 #ifndef CONCRETELANG_DFR_KEY_MANAGER_HPP
 #define CONCRETELANG_DFR_KEY_MANAGER_HPP
 
+#include <algorithm>
+#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <stdlib.h>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include <hpx/future.hpp>
 #include <hpx/include/runtime.hpp>
 #include <hpx/modules/collectives.hpp>
 #include <hpx/modules/serialization.hpp>
@@ -80,7 +86,7 @@ template <typename LweKeyType> struct KeyWrapper {
       auto buffer = std::make_shared<std::vector<uint64_t>>();
       buffer->resize(key_size);
       ar >> hpx::serialization::make_array(buffer->data(), key_size);
-      keys.push_back(LweKeyType(buffer, info));
+      keys.push_back(LweKeyType::fromTransportBuffer(buffer, info));
     }
   }
   HPX_SERIALIZATION_SPLIT_MEMBER()
@@ -98,91 +104,345 @@ bool operator==(const KeyWrapper<LweKeyType> &lhs,
   return true;
 }
 
+/// The kinds of evaluation keys, in the order they are broadcast.
+enum KeyKind { KEY_KIND_BSK = 0, KEY_KIND_KSK = 1, KEY_KIND_PKSK = 2 };
+const size_t KEY_KINDS = 3;
+
+/// Describes the evaluation keys of a keyset broadcast in chunks: the
+/// serialized info and the size of the transport buffer of each key, by kind,
+/// and the size of the chunks in words.
+struct KeysetHeader {
+  std::vector<std::string> infos[KEY_KINDS];
+  std::vector<size_t> sizes[KEY_KINDS];
+  size_t chunk_words = 0;
+
+  template <typename LweKeyType>
+  void add(KeyKind kind, const std::vector<LweKeyType> &keys) {
+    for (auto &k : keys) {
+      auto maybe_info_string = k.getInfo().writeBinaryToString();
+      assert(maybe_info_string.has_value());
+      infos[kind].push_back(maybe_info_string.value());
+      sizes[kind].push_back(k.getTransportBuffer().size());
+    }
+  }
+
+  /// Builds the keys of `kind` on zeroed transport buffers, which are
+  /// appended to `buffers` to be filled as the chunks are received.
+  template <typename LweKeyType>
+  std::vector<LweKeyType>
+  makeKeys(KeyKind kind,
+           std::vector<std::shared_ptr<std::vector<uint64_t>>> &buffers) const {
+    std::vector<LweKeyType> keys;
+    for (size_t i = 0; i < infos[kind].size(); ++i) {
+      typename LweKeyType::InfoType info;
+      assert(info.readBinaryFromString(infos[kind][i]).has_value());
+      auto buffer = std::make_shared<std::vector<uint64_t>>(sizes[kind][i]);
+      buffers.push_back(buffer);
+      keys.push_back(LweKeyType::fromTransportBuffer(buffer, info));
+    }
+    return keys;
+  }
+
+  size_t numChunks() const {
+    size_t chunks = 0;
+    for (size_t kind = 0; kind < KEY_KINDS; ++kind)
+      for (auto size : sizes[kind])
+        chunks += (size + chunk_words - 1) / chunk_words;
+    return chunks;
+  }
+
+  friend class hpx::serialization::access;
+  template <class Archive>
+  void serialize(Archive &ar, const unsigned int version) {
+    for (size_t kind = 0; kind < KEY_KINDS; ++kind)
+      ar &infos[kind] & sizes[kind];
+    ar &chunk_words;
+  }
+};
+
+/// A slice of the transport buffer of a key.
+struct KeyChunk {
+  uint32_t kind = 0;
+  size_t key = 0;
+  size_t offset = 0;
+  std::vector<uint64_t> words;
+
+  friend class hpx::serialization::access;
+  template <class Archive>
+  void serialize(Archive &ar, const unsigned int version) {
+    ar &kind &key &offset &words;
+  }
+};
+
 /************************/
 /* Context management.  */
 /************************/
 
+/// Identifies the evaluation keys of a context across the nodes. The id is
+/// derived from the sizes of the keys and from samples of their random
+/// material at both ends of their buffers, which is enough to tell apart the
+/// keysets of different clients without hashing whole keys at each phase.
+uint64_t keysetId(const ServerKeyset &keyset);
+
 struct RuntimeContextManager {
-  // TODO: this is only ok so long as we don't change keys. Once we
-  // use multiple keys, should have a map.
-  RuntimeContext *context;
-  bool allocated = false;
   bool lazy_key_transfer = false;
 
   RuntimeContextManager(bool lazy = false) : lazy_key_transfer(lazy) {
-    context = nullptr;
+    char *env = getenv("DFR_CONTEXT_CACHE_SIZE");
+    if (env != nullptr && strtoul(env, NULL, 10) != 0)
+      max_cached_contexts = strtoul(env, NULL, 10);
+    env = getenv("DFR_KEY_CHUNK_SIZE");
+    if (env != nullptr && strtoul(env, NULL, 10) >= sizeof(uint64_t))
+      key_chunk_words = strtoul(env, NULL, 10) / sizeof(uint64_t);
     _dfr_node_level_runtime_context_manager = this;
   }
 
+  ~RuntimeContextManager() {
+    for (auto &ctx : contexts)
+      release(ctx.first);
+  }
+
+  /// Makes the context of the calling phase current on every node.
+  ///
+  /// The root node broadcasts the id of the keyset of `ctx`, followed by the
+  /// evaluation keys if the remote nodes do not hold them yet (see
+  /// `broadcastKeys`). With lazy key transfer, the keys are never broadcast
+  /// since remote nodes fetch the keys they need on first use. Remote nodes keep the contexts of the last keysets they
+  /// received, up to `DFR_CONTEXT_CACHE_SIZE` (8 by default), so that the
+  /// evaluation keys of several tenants stay resident at the same time and
+  /// switching between them does not broadcast the keys again. The root node
+  /// mirrors the same least recently used policy to know which keysets the
+  /// remote nodes hold.
   void setContext(void *ctx) {
-    assert(context == nullptr &&
-           "Only one RuntimeContext can be used at a time.");
-    context = (RuntimeContext *)ctx;
-
-    if (lazy_key_transfer) {
-      if (!_dfr_is_root_node()) {
-        context =
-            new mlir::concretelang::DistributedRuntimeContext(ServerKeyset());
+    const std::lock_guard<std::mutex> lock(guard);
+    if (_dfr_is_root_node()) {
+      // When the root node does not require a context, we still need to
+      // broadcast an empty keyset to remote nodes as they cannot know
+      // ahead of time and avoid waiting for the broadcast. Instantiate
+      // an empty context for this.
+      bool allocated = false;
+      if (ctx == nullptr) {
+        ctx = new mlir::concretelang::RuntimeContext(ServerKeyset());
         allocated = true;
       }
+      RuntimeContext *context = (RuntimeContext *)ctx;
+      uint64_t id = keysetId(context->getKeys());
+      bool cached = contexts.find(id) != contexts.end();
+      if (cached && allocated) {
+        delete context;
+      } else {
+        if (cached)
+          release(id);
+        contexts[id] = {context, allocated};
+      }
+      ids[contexts[id].first] = id;
+      touch(id);
+      current = id;
+
+      bool send_keys = !cached && !lazy_key_transfer;
+      hpx::collectives::broadcast_to("ctx_id_store",
+                                     std::make_pair(id, send_keys));
+      if (send_keys)
+        broadcastKeys(context->getKeys());
+      evict();
       return;
     }
 
-    // When the root node does not require a context, we still need to
-    // broadcast an empty keyset to remote nodes as they cannot know
-    // ahead of time and avoid waiting for the broadcast. Instantiate
-    // an empty context for this.
-    if (_dfr_is_root_node() && ctx == nullptr) {
-      context = new mlir::concretelang::RuntimeContext(ServerKeyset());
-      allocated = true;
+    auto idFut = hpx::collectives::broadcast_from<std::pair<uint64_t, bool>>(
+        "ctx_id_store");
+    auto msg = idFut.get();
+    uint64_t id = msg.first;
+    if (msg.second) {
+      auto context = receiveKeys();
+      if (contexts.find(id) != contexts.end())
+        release(id);
+      contexts[id] = {context, true};
+    } else if (contexts.find(id) == contexts.end()) {
+      // Lazy key transfer: the keys are fetched from the root node on
+      // first use.
+      assert(lazy_key_transfer &&
+             "DFR: keys of a keyset missing from the node cache.");
+      auto context =
+          new mlir::concretelang::DistributedRuntimeContext(ServerKeyset());
+      context->context_id = id;
+      contexts[id] = {context, true};
+      for (auto &key : pending_prefetches[id])
+        context->prefetch(key.first, key.second);
     }
+    pending_prefetches.erase(id);
+    ids[contexts[id].first] = id;
+    touch(id);
+    current = id;
+    evict();
+  }
 
-    // Root node broadcasts the evaluation keys and each remote
-    // instantiates a local RuntimeContext.
-    if (_dfr_is_root_node()) {
-      KeyWrapper<LweKeyswitchKey> kskw(context->getKeys().lweKeyswitchKeys);
-      KeyWrapper<LweBootstrapKey> bskw(context->getKeys().lweBootstrapKeys);
-      KeyWrapper<PackingKeyswitchKey> pkskw(
-          context->getKeys().packingKeyswitchKeys);
-      hpx::collectives::broadcast_to("ksk_keystore", kskw);
-      hpx::collectives::broadcast_to("bsk_keystore", bskw);
-      hpx::collectives::broadcast_to("pksk_keystore", pkskw);
-    } else {
-      auto kskFut =
-          hpx::collectives::broadcast_from<KeyWrapper<LweKeyswitchKey>>(
-              "ksk_keystore");
-      auto bskFut =
-          hpx::collectives::broadcast_from<KeyWrapper<LweBootstrapKey>>(
-              "bsk_keystore");
-      auto pkskFut =
-          hpx::collectives::broadcast_from<KeyWrapper<PackingKeyswitchKey>>(
-              "pksk_keystore");
-      KeyWrapper<LweKeyswitchKey> kskw = kskFut.get();
-      KeyWrapper<LweBootstrapKey> bskw = bskFut.get();
-      KeyWrapper<PackingKeyswitchKey> pkskw = pkskFut.get();
-      context = new mlir::concretelang::RuntimeContext(
-          ServerKeyset{bskw.keys, kskw.keys, pkskw.keys});
-    }
+  /// Returns the context of the current phase.
+  RuntimeContext *getContext() { return getContext(current); }
+
+  /// Returns the context of the keyset `id`, which must be cached.
+  RuntimeContext *getContext(uint64_t id) {
+    const std::lock_guard<std::mutex> lock(guard);
+    auto it = contexts.find(id);
+    assert(it != contexts.end() && "DFR: unknown runtime context.");
+    return it->second.first;
   }
 
-  RuntimeContext *getContext() { return context; }
+  /// Returns the id of the keyset of a context made current by `setContext`.
+  uint64_t getContextId(void *ctx) {
+    const std::lock_guard<std::mutex> lock(guard);
+    auto it = ids.find((RuntimeContext *)ctx);
+    assert(it != ids.end() && "DFR: unknown runtime context.");
+    return it->second;
+  }
+
+  /// Ends the current phase. The contexts stay cached for the next phases.
+  void clearContext() {}
 
-  void clearContext() {
+  /// Starts fetching the key `keyId` of `kind` of the keyset `id` on a remote
+  /// node with lazy key transfer. The hint can arrive before the context of
+  /// the keyset is set, it is then applied when the context is created.
+  void prefetch(uint64_t id, uint64_t kind, size_t keyId) {
+    const std::lock_guard<std::mutex> lock(guard);
+    if (_dfr_is_root_node() || !lazy_key_transfer)
+      return;
+    auto it = contexts.find(id);
+    if (it == contexts.end()) {
+      pending_prefetches[id].push_back({kind, keyId});
+      return;
+    }
+    auto context =
+        dynamic_cast<DistributedRuntimeContext *>(it->second.first);
     if (context != nullptr)
-      // On root node deallocate only if allocated independently here
-      if (!_dfr_is_root_node() || allocated)
-        delete context;
-    context = nullptr;
+      context->prefetch(kind, keyId);
+  }
+
+private:
+  // Broadcasts the evaluation keys of `keyset` in their transport form, that
+  // is seeded keys stay compressed, as a header followed by chunks of at most
+  // `DFR_KEY_CHUNK_SIZE` bytes (64 MiB by default). Bootstrap keys are sent
+  // first so that remote nodes convert them while the others are received.
+  void broadcastKeys(const ServerKeyset &keyset) {
+    KeysetHeader header;
+    header.add(KEY_KIND_BSK, keyset.lweBootstrapKeys);
+    header.add(KEY_KIND_KSK, keyset.lweKeyswitchKeys);
+    header.add(KEY_KIND_PKSK, keyset.packingKeyswitchKeys);
+    header.chunk_words = key_chunk_words;
+    hpx::collectives::broadcast_to("keyset_header_store", header);
+    broadcastChunks(KEY_KIND_BSK, keyset.lweBootstrapKeys);
+    broadcastChunks(KEY_KIND_KSK, keyset.lweKeyswitchKeys);
+    broadcastChunks(KEY_KIND_PKSK, keyset.packingKeyswitchKeys);
   }
+
+  template <typename LweKeyType>
+  void broadcastChunks(KeyKind kind, const std::vector<LweKeyType> &keys) {
+    for (size_t k = 0; k < keys.size(); ++k) {
+      auto &buffer = keys[k].getTransportBuffer();
+      for (size_t offset = 0; offset < buffer.size();
+           offset += key_chunk_words) {
+        size_t end = std::min(buffer.size(), offset + key_chunk_words);
+        KeyChunk chunk;
+        chunk.kind = kind;
+        chunk.key = k;
+        chunk.offset = offset;
+        chunk.words.assign(buffer.begin() + offset, buffer.begin() + end);
+        hpx::collectives::broadcast_to("key_chunk_store", std::move(chunk));
+      }
+    }
+  }
+
+  // Receives the keys broadcast by `broadcastKeys` and returns a context on
+  // them. Each bootstrap key is decompressed and converted to the fourier
+  // domain as soon as its last chunk is received, concurrently with the
+  // reception of the next ones.
+  RuntimeContext *receiveKeys() {
+    auto header = hpx::collectives::broadcast_from<KeysetHeader>(
+                      "keyset_header_store")
+                      .get();
+    std::vector<std::shared_ptr<std::vector<uint64_t>>> buffers[KEY_KINDS];
+    ServerKeyset keyset;
+    keyset.lweBootstrapKeys =
+        header.makeKeys<LweBootstrapKey>(KEY_KIND_BSK, buffers[KEY_KIND_BSK]);
+    keyset.lweKeyswitchKeys =
+        header.makeKeys<LweKeyswitchKey>(KEY_KIND_KSK, buffers[KEY_KIND_KSK]);
+    keyset.packingKeyswitchKeys = header.makeKeys<PackingKeyswitchKey>(
+        KEY_KIND_PKSK, buffers[KEY_KIND_PKSK]);
+    auto context = new mlir::concretelang::RuntimeContext(keyset);
+
+    std::vector<size_t> missing[KEY_KINDS];
+    for (size_t kind = 0; kind < KEY_KINDS; ++kind)
+      missing[kind] = header.sizes[kind];
+    std::vector<hpx::future<void>> conversions;
+    for (size_t c = 0, n = header.numChunks(); c < n; ++c) {
+      KeyChunk chunk =
+          hpx::collectives::broadcast_from<KeyChunk>("key_chunk_store").get();
+      assert(chunk.kind < KEY_KINDS && chunk.key < buffers[chunk.kind].size());
+      auto &buffer = *buffers[chunk.kind][chunk.key];
+      assert(chunk.offset + chunk.words.size() <= buffer.size());
+      std::copy(chunk.words.begin(), chunk.words.end(),
+                buffer.begin() + chunk.offset);
+      size_t &left = missing[chunk.kind][chunk.key];
+      left -= chunk.words.size();
+      if (left == 0 && chunk.kind == KEY_KIND_BSK &&
+          context->bootstrap_key_grouping_factor(chunk.key) == 1) {
+        size_t keyId = chunk.key;
+        conversions.push_back(hpx::async([context, keyId]() {
+          context->fourier_bootstrap_key_buffer(keyId);
+        }));
+      }
+    }
+    hpx::wait_all(conversions);
+    return context;
+  }
+
+  // Moves `id` to the most recently used end.
+  void touch(uint64_t id) {
+    lru.remove(id);
+    lru.push_back(id);
+  }
+
+  // Releases the least recently used contexts beyond the cache size, but
+  // never the current one.
+  void evict() {
+    while (lru.size() > max_cached_contexts && lru.front() != current) {
+      uint64_t id = lru.front();
+      lru.pop_front();
+      release(id);
+      contexts.erase(id);
+    }
+  }
+
+  // Forgets the context of `id`, deleting it if it is owned by the manager.
+  void release(uint64_t id) {
+    auto &ctx = contexts[id];
+    ids.erase(ctx.first);
+    if (ctx.second)
+      delete ctx.first;
+  }
+
+  std::mutex guard;
+  // The cached contexts and whether they are owned by the manager. On the
+  // root node, the contexts of the callers are not.
+  std::map<uint64_t, std::pair<RuntimeContext *, bool>> contexts;
+  std::map<RuntimeContext *, uint64_t> ids;
+  std::list<uint64_t> lru;
+  // The keys to prefetch, by kind and id, of the keysets whose context has
+  // not been set yet on a remote node.
+  std::map<uint64_t, std::vector<std::pair<uint64_t, size_t>>>
+      pending_prefetches;
+  size_t max_cached_contexts = 8;
+  size_t key_chunk_words = (64 << 20) / sizeof(uint64_t);
+  uint64_t current = 0;
 };
 
-KeyWrapper<LweKeyswitchKey> getKsk(size_t keyId);
-KeyWrapper<LweBootstrapKey> getBsk(size_t keyId);
-KeyWrapper<PackingKeyswitchKey> getPKsk(size_t keyId);
+KeyWrapper<LweKeyswitchKey> getKsk(uint64_t contextId, size_t keyId);
+KeyWrapper<LweBootstrapKey> getBsk(uint64_t contextId, size_t keyId);
+KeyWrapper<PackingKeyswitchKey> getPKsk(uint64_t contextId, size_t keyId);
+void prefetchKey(uint64_t contextId, uint64_t kind, size_t keyId);
 
 HPX_DEFINE_PLAIN_ACTION(getKsk, _get_ksk_action);
 HPX_DEFINE_PLAIN_ACTION(getBsk, _get_bsk_action);
 HPX_DEFINE_PLAIN_ACTION(getPKsk, _get_pksk_action);
+HPX_DEFINE_PLAIN_ACTION(prefetchKey, _prefetch_key_action);
 
 } // namespace dfr
 } // namespace concretelang
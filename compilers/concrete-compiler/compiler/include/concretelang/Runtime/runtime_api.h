@@ -16,18 +16,27 @@ typedef void (*wfnptr)(...);
 
 void *_dfr_make_ready_future(void *, size_t);
 void _dfr_create_async_task(wfnptr, void *, size_t, size_t, ...);
+void _dfr_create_async_task_desc(wfnptr, void *, const uint64_t *, void **,
+                                 void **);
 void _dfr_register_work_function(wfnptr);
 void *_dfr_await_future(void *);
 
 /*  Memory management:
     _dfr_make_ready_future allocates the future, not the underlying storage.
-    _dfr_create_async_task allocates both future and storage for outputs.  */
+    _dfr_create_async_task allocates both future and storage for outputs.
+    _dfr_arena_alloc allocates the storage of the outputs only consumed by
+    other tasks, released with their future.  */
 void _dfr_deallocate_future(void *);
+void *_dfr_arena_alloc(size_t);
+void _dfr_reserve_task_arena(size_t);
 
 /*  Initialisation & termination.  */
 void _dfr_start(int64_t, void *);
 void _dfr_stop(int64_t);
 
+/*  Hint that the current phase uses an evaluation key, by kind and id.  */
+void _dfr_prefetch_key(void *, int64_t, int64_t);
+
 void _dfr_terminate();
 }
 
@@ -57,6 +57,57 @@ uint64_t sim_bootstrap_lwe_u64(uint64_t plaintext, uint64_t *tlu_allocated,
                                uint32_t level, uint32_t base_log,
                                uint32_t glwe_dim);
 
+/// \brief simulate a batch of keyswitches on noisy plaintexts
+///
+/// The noise of the whole batch is sampled at once.
+void sim_batched_keyswitch_lwe_u64(
+    // Output 1D memref
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size, uint64_t out_stride,
+    // Input 1D memref
+    uint64_t *in_allocated, uint64_t *in_aligned, uint64_t in_offset,
+    uint64_t in_size, uint64_t in_stride,
+    // Keyswitch parameters
+    uint32_t level, uint32_t base_log, uint32_t input_lwe_dim,
+    uint32_t output_lwe_dim);
+
+/// \brief simulate a batch of bootstraps of noisy plaintexts with the same
+/// lookup table
+///
+/// The noise of the whole batch is sampled at once.
+void sim_batched_bootstrap_lwe_u64(
+    // Output 1D memref
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size, uint64_t out_stride,
+    // Input 1D memref
+    uint64_t *in_allocated, uint64_t *in_aligned, uint64_t in_offset,
+    uint64_t in_size, uint64_t in_stride,
+    // Lookup table 1D memref
+    uint64_t *tlu_allocated, uint64_t *tlu_aligned, uint64_t tlu_offset,
+    uint64_t tlu_size, uint64_t tlu_stride,
+    // Bootstrap parameters
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim);
+
+/// \brief simulate a batch of bootstraps of noisy plaintexts, each with its
+/// own lookup table
+///
+/// The noise of the whole batch is sampled at once.
+void sim_batched_mapped_bootstrap_lwe_u64(
+    // Output 1D memref
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size, uint64_t out_stride,
+    // Input 1D memref
+    uint64_t *in_allocated, uint64_t *in_aligned, uint64_t in_offset,
+    uint64_t in_size, uint64_t in_stride,
+    // Lookup tables 2D memref, one row per ciphertext
+    uint64_t *tlu_allocated, uint64_t *tlu_aligned, uint64_t tlu_offset,
+    uint64_t tlu_size0, uint64_t tlu_size1, uint64_t tlu_stride0,
+    uint64_t tlu_stride1,
+    // Bootstrap parameters
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim);
+
 /// simulate a WoP PBS
 void sim_wop_pbs_crt(
     // Output 1D memref
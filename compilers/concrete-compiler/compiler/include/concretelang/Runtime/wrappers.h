@@ -29,6 +29,28 @@ void memref_encode_expand_lut_for_bootstrap(
     uint64_t input_lut_size, uint64_t input_lut_stride, uint32_t poly_size,
     uint32_t out_MESSAGE_BITS, bool is_signed);
 
+/// \brief Encode and expand lookup tables packed in a single bootstrap.
+///
+/// The tables are interleaved in the output lut, the i-th coefficient
+/// holding the value of the `i % k`-th table, where `k` is the number of
+/// tables, for the message of its mega case. Each mega case must hold at
+/// least `2 * k` coefficients.
+///
+/// \param output where to write the expanded LUT
+/// \param output_size
+/// \param out_MESSAGE_BITS number of bits of message to be used
+/// \param luts original LUTs, one per row
+/// \param luts_size0 the number of LUTs
+/// \param luts_size1 the size of the LUTs
+void memref_encode_expand_many_lut_for_bootstrap(
+    uint64_t *output_lut_allocated, uint64_t *output_lut_aligned,
+    uint64_t output_lut_offset, uint64_t output_lut_size,
+    uint64_t output_lut_stride, uint64_t *input_luts_allocated,
+    uint64_t *input_luts_aligned, uint64_t input_luts_offset,
+    uint64_t input_luts_size0, uint64_t input_luts_size1,
+    uint64_t input_luts_stride0, uint64_t input_luts_stride1,
+    uint32_t poly_size, uint32_t out_MESSAGE_BITS, bool is_signed);
+
 void memref_encode_lut_for_crt_woppbs(
     uint64_t *output_lut_allocated, uint64_t *output_lut_aligned,
     uint64_t output_lut_offset, uint64_t output_lut_size0,
@@ -181,6 +203,32 @@ void memref_batched_mapped_bootstrap_lwe_u64(
     uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context);
 
+/// \brief Run a keyswitch followed by a bootstrap on chunks of `chunk_size`
+/// ciphertexts, so that the keyswitch of a chunk overlaps the bootstrap of the
+/// others.
+void memref_batched_keyswitch_bootstrap_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint32_t ks_level, uint32_t ks_base_log,
+    uint32_t ks_input_lwe_dim, uint32_t ks_output_lwe_dim, uint32_t ksk_index,
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    uint32_t chunk_size, mlir::concretelang::RuntimeContext *context);
+
+void memref_many_lut_bootstrap_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size, uint64_t ct0_stride,
+    uint64_t *tlu_allocated, uint64_t *tlu_aligned, uint64_t tlu_offset,
+    uint64_t tlu_size, uint64_t tlu_stride, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t bsk_index, mlir::concretelang::RuntimeContext *context);
+
 void *memref_bootstrap_async_lwe_u64(
     uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
     uint64_t out_size, uint64_t out_stride, uint64_t *ct0_allocated,
@@ -233,6 +281,12 @@ void memref_copy_one_rank(uint64_t *src_allocated, uint64_t *src_aligned,
                           uint64_t *dst_aligned, uint64_t dst_offset,
                           uint64_t dst_size, uint64_t dst_stride);
 
+// CUDA transfers /////////////////////////////////////////////////////////////
+
+/// \brief Returns the number of bytes the CUDA wrappers moved to and from the
+/// devices since the start of the process.
+void cuda_transfer_counters(uint64_t *bytes_to_gpu, uint64_t *bytes_to_cpu);
+
 // Single ciphertext CUDA functions ///////////////////////////////////////////
 
 /// \brief Run Keyswitch on GPU.
@@ -283,6 +337,37 @@ void memref_batched_bootstrap_lwe_cuda_u64(
     uint32_t level, uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context);
 
+/// \brief Run a keyswitch followed by a bootstrap on GPU, without moving the
+/// keyswitched ciphertexts back to the host.
+void memref_batched_keyswitch_bootstrap_lwe_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint32_t ks_level, uint32_t ks_base_log,
+    uint32_t ks_input_lwe_dim, uint32_t ks_output_lwe_dim, uint32_t ksk_index,
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    mlir::concretelang::RuntimeContext *context);
+
+/// \brief Run a keyswitch followed by a bootstrap on GPU, first multiplying
+/// the input ciphertexts by `cleartext` and adding `plaintext` to their
+/// bodies on device.
+void memref_batched_affine_keyswitch_bootstrap_lwe_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint64_t cleartext, uint64_t plaintext,
+    uint32_t ks_level, uint32_t ks_base_log, uint32_t ks_input_lwe_dim,
+    uint32_t ks_output_lwe_dim, uint32_t ksk_index, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t bsk_index, mlir::concretelang::RuntimeContext *context);
+
 void memref_batched_mapped_bootstrap_lwe_cuda_u64(
     uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
     uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
@@ -294,6 +379,28 @@ void memref_batched_mapped_bootstrap_lwe_cuda_u64(
     uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
     uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context);
+
+/// \brief Run a WoP-PBS on the CRT blocks of a ciphertext on GPU, with the
+/// arguments of `memref_wop_pbs_crt_buffer`.
+///
+/// The keys stay resident on the device across the calls. Parameters the
+/// CUDA WoP-PBS does not support fall back to `memref_wop_pbs_crt_buffer`.
+void memref_wop_pbs_crt_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size_0, uint64_t out_size_1, uint64_t out_stride_0,
+    uint64_t out_stride_1, uint64_t *in_allocated, uint64_t *in_aligned,
+    uint64_t in_offset, uint64_t in_size_0, uint64_t in_size_1,
+    uint64_t in_stride_0, uint64_t in_stride_1, uint64_t *lut_ct_allocated,
+    uint64_t *lut_ct_aligned, uint64_t lut_ct_offset, uint64_t lut_ct_size0,
+    uint64_t lut_ct_size1, uint64_t lut_ct_stride0, uint64_t lut_ct_stride1,
+    uint64_t *crt_decomp_allocated, uint64_t *crt_decomp_aligned,
+    uint64_t crt_decomp_offset, uint64_t crt_decomp_size,
+    uint64_t crt_decomp_stride, uint32_t lwe_small_dim,
+    uint32_t cbs_level_count, uint32_t cbs_base_log, uint32_t ksk_level_count,
+    uint32_t ksk_base_log, uint32_t bsk_level_count, uint32_t bsk_base_log,
+    uint32_t fpksk_level_count, uint32_t fpksk_base_log,
+    uint32_t polynomial_size, uint32_t ksk_index, uint32_t bsk_index,
+    uint32_t pksk_index, mlir::concretelang::RuntimeContext *context);
 // Tracing ////////////////////////////////////////////////////////////////////
 void memref_trace_ciphertext(uint64_t *ct0_allocated, uint64_t *ct0_aligned,
                              uint64_t ct0_offset, uint64_t ct0_size,
@@ -13,11 +13,19 @@
 #include "concretelang/Common/Protocol.h"
 #include "concretelang/Common/Transformers.h"
 #include "concretelang/Common/Values.h"
+#include "concretelang/Runtime/DFRuntime.hpp"
+#include "concretelang/Runtime/DeviceValues.h"
+#include "concretelang/Runtime/MemoryUsage.h"
+#include "concretelang/Runtime/Profiler.h"
+#include "concretelang/ServerLib/StaticCircuits.h"
 #include "llvm/ADT/ArrayRef.h"
 #include <cassert>
 #include <dlfcn.h>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <optional>
 #include <vector>
 
 using concretelang::keysets::ServerKeyset;
@@ -38,8 +46,25 @@ public:
   static Result<std::shared_ptr<DynamicModule>>
   open(const std::string &outputPath);
 
+  /// Returns a module resolving the circuits in the table of a registered
+  /// static program, see `StaticProgramRegistration`.
+  static std::shared_ptr<DynamicModule>
+  fromStaticCircuits(const StaticCircuit *circuits, size_t count);
+
 private:
-  void *libraryHandle;
+  /// Returns the entry point of the circuit `name`.
+  Result<CircuitFunction> lookup(const std::string &name) const;
+
+  void *libraryHandle = nullptr;
+  std::map<std::string, CircuitFunction> staticCircuits;
+};
+
+/// A value passed to or returned by a device call of a circuit: the transport
+/// value, along with the copy of its ciphertexts kept on the GPU by the
+/// runtime, if any.
+struct DeviceValue {
+  TransportValue value;
+  std::shared_ptr<mlir::concretelang::DeviceBuffer> device;
 };
 
 class ServerCircuit {
@@ -47,12 +72,130 @@ class ServerCircuit {
 
 public:
   /// Call the circuit with public arguments.
-  Result<std::vector<TransportValue>> call(const ServerKeyset &serverKeyset,
-                                           std::vector<TransportValue> &args);
+  ///
+  /// The circuit does not hold any per-call state, it is thus safe to call the
+  /// same circuit from multiple threads concurrently. If `SERVER_CALL_ARENA`
+  /// is set, the ciphertexts the call handles are allocated in an arena of
+  /// the calling thread, reused by its next calls, rather than with malloc.
+  Result<std::vector<TransportValue>>
+  call(const ServerKeyset &serverKeyset,
+       const std::vector<TransportValue> &args) const;
+
+  /// Call the circuit on a batch of independent requests sharing the same
+  /// keyset.
+  ///
+  /// The requests are dispatched on up to `maxThreads` threads (all the
+  /// hardware threads if 0) which share the runtime context of the keyset. The
+  /// results are returned in the order of the requests. If any request fails,
+  /// the error of the first failing one is returned.
+  Result<std::vector<std::vector<TransportValue>>>
+  callBatch(const ServerKeyset &serverKeyset,
+            const std::vector<std::vector<TransportValue>> &batch,
+            size_t maxThreads = 0) const;
+
+  /// The callback of an asynchronous call, invoked with its result.
+  typedef std::function<void(Result<std::vector<TransportValue>>)>
+      CallCallback;
+
+  /// Call the circuit with public arguments without waiting for the result.
+  ///
+  /// The call is queued on a pool of threads shared by all the circuits of
+  /// the process, sized by `SERVER_CALL_NUM_THREADS` (all the hardware
+  /// threads by default), and `callback` is invoked on the pool thread once
+  /// the call finishes. The circuit, keyset and arguments are copied, the
+  /// caller does not need to keep them alive.
+  void callAsync(const ServerKeyset &serverKeyset,
+                 std::vector<TransportValue> args,
+                 CallCallback callback) const;
+
+  /// Call the circuit with public arguments without waiting for the result,
+  /// which is delivered through the returned future.
+  std::future<Result<std::vector<TransportValue>>>
+  callAsync(const ServerKeyset &serverKeyset,
+            std::vector<TransportValue> args) const;
+
+  /// Call the circuit with public arguments, keeping the outputs resident on
+  /// the GPU.
+  ///
+  /// The GPU dataflow runtime keeps a device copy of every ciphertext output
+  /// it computes, returned along with the transport value. When such a return
+  /// is passed back as the argument of another device call, the runtime uses
+  /// its device copy instead of uploading it again, so that chained circuits
+  /// on the same GPU exchange their ciphertexts in device memory. Arguments
+  /// without device copy are uploaded as by `call`.
+  Result<std::vector<DeviceValue>>
+  callOnDevice(const ServerKeyset &serverKeyset,
+               const std::vector<DeviceValue> &args) const;
 
   /// Simulate the circuit with public arguments.
   Result<std::vector<TransportValue>>
-  simulate(std::vector<TransportValue> &args);
+  simulate(const std::vector<TransportValue> &args) const;
+
+  /// Releases the evaluation keys prepared for a keyset by previous calls.
+  ///
+  /// Calls made with the same keyset share a runtime context holding the keys
+  /// converted to the fourier domain. This context lives until it is evicted.
+  static void evictKeyset(const ServerKeyset &serverKeyset);
+
+  /// Prepares the evaluation keys of a keyset for the next calls, reading
+  /// them from the prepared keyset at `preparedKeysetPath`, which is written
+  /// first if it is missing or does not match the keyset.
+  ///
+  /// The keys are then used as mapped from the file rather than converted to
+  /// the fourier domain on the first call.
+  static Result<void> prepareKeyset(const ServerKeyset &serverKeyset,
+                                    const std::string &preparedKeysetPath);
+
+  /// Starts or stops recording the calls of the runtime primitives (e.g. the
+  /// bootstraps or the copies) made by the circuits of the process. Each call
+  /// is also kept as a trace event if `trace` is set.
+  ///
+  /// The recording is off by default, and then only costs a relaxed load per
+  /// primitive.
+  static void recordRuntimeStatistics(bool enabled, bool trace = false);
+
+  /// Returns the number of calls, and their total and maximum durations in
+  /// nanoseconds, of the runtime primitives recorded so far, by name.
+  static std::map<std::string, mlir::concretelang::profiler::Statistics>
+  runtimeStatistics();
+
+  /// Forgets the statistics and the trace events recorded so far.
+  static void resetRuntimeStatistics();
+
+  /// Returns the trace events recorded since the last call, in the Chrome
+  /// trace event format (which Perfetto reads too), and forgets them.
+  static std::string takeRuntimeTrace();
+
+  /// Returns the mean time per ciphertext of the keyswitches and bootstraps
+  /// recorded so far, by parameters, in the format of the cost tables of the
+  /// optimizer.
+  static std::string runtimeCostTable();
+
+  /// Returns the live and peak bytes accounted by the runtime, by category:
+  /// the keys held by the runtime contexts, the ciphertexts of the running
+  /// calls, the scratch of the primitives and the keys on the devices.
+  static std::map<std::string, mlir::concretelang::memory::Usage>
+  memoryUsage();
+
+  /// Sets the peak bytes of each category to its live bytes, e.g. to measure
+  /// the peak of the next calls.
+  static void resetMemoryPeaks();
+
+  /// Limits the host memory accounted by the runtime to `bytes`, or removes
+  /// the limit if 0. A call whose arguments do not fit fails, and the process
+  /// aborts if an allocation made during a call exceeds the limit.
+  static void setMemoryLimit(uint64_t bytes);
+
+  /// Returns the counters of the dataflow runtime on this node, which are all
+  /// 0 until a circuit compiled with dataflow parallelization is called.
+  static mlir::concretelang::dfr::DFRStatistics dataflowStatistics();
+
+  /// Sets the counters of the dataflow runtime on this node to 0.
+  static void resetDataflowStatistics();
+
+  /// Returns the counters of the dataflow runtime on this node in the
+  /// Prometheus text exposition format.
+  static std::string dataflowMetrics();
 
   /// Returns the name of this circuit.
   std::string getName();
@@ -65,7 +208,20 @@ private:
                     std::shared_ptr<DynamicModule> dynamicModule,
                     bool useSimulation);
 
-  void invoke(const ServerKeyset &serverKeyset);
+  /// Checks that the keyset holds the keys used by the circuit, which may be
+  /// the only ones uploaded, see `ServerKeyset::toProto`.
+  Result<void> checkKeys(const ServerKeyset &serverKeyset) const;
+
+  /// Invokes the circuit function on the processed arguments, and stores the
+  /// results in the returns buffer. Both buffers are owned by the caller.
+  ///
+  /// If `returnsDevice` is given, the invocation runs in a device value scope
+  /// where the `argsDevice` copies, if any, are bound to the arguments, and the
+  /// device copies of the results are stored in `returnsDevice`.
+  void invoke(const ServerKeyset &serverKeyset, std::vector<Value> &argsBuffer,
+              std::vector<Value> &returnsBuffer,
+              const mlir::concretelang::DeviceBuffers *argsDevice = nullptr,
+              mlir::concretelang::DeviceBuffers *returnsDevice = nullptr) const;
 
   Message<concreteprotocol::CircuitInfo> circuitInfo;
   bool useSimulation;
@@ -73,12 +229,33 @@ private:
   std::shared_ptr<DynamicModule> dynamicModule;
   std::vector<ArgTransformer> argTransformers;
   std::vector<ReturnTransformer> returnTransformers;
-  std::vector<Value> argsBuffer;
-  std::vector<Value> returnsBuffer;
   std::vector<size_t> argDescriptorSizes;
   std::vector<size_t> returnDescriptorSizes;
   size_t argRawSize;
   size_t returnRawSize;
+  mlir::concretelang::DeviceSettings deviceSettings;
+};
+
+/// A chain of calls of the circuits of a program, whose intermediate values
+/// stay on the server, see `ServerProgram::callGraph`.
+struct CallGraph {
+  /// The value of an argument of a stage or of an output of the graph: the
+  /// argument `index` of the graph if `stage` is unset, the return `index` of
+  /// the stage `stage` otherwise, which must come before.
+  struct Source {
+    std::optional<size_t> stage;
+    size_t index;
+  };
+
+  /// A call of the circuit `circuit` on `args`.
+  struct Stage {
+    std::string circuit;
+    std::vector<Source> args;
+  };
+
+  std::vector<Stage> stages;
+  /// The outputs of the graph, all the returns of the last stage if empty.
+  std::vector<Source> outputs;
 };
 
 /// ServerProgram contains multiple
@@ -89,8 +266,54 @@ public:
   load(const Message<concreteprotocol::ProgramInfo> &programInfo,
        const std::string &outputPath, bool useSimulation);
 
+  /// Loads the program of the static library linked in the binary, with the
+  /// program info embedded in its table. Fails unless exactly one program is
+  /// registered.
+  static Result<ServerProgram> loadStatic(bool useSimulation);
+
+  /// Returns the program info of the program `loadStatic` loads.
+  static Result<Message<concreteprotocol::ProgramInfo>> staticProgramInfo();
+
   Result<ServerCircuit> getServerCircuit(const std::string &circuitName);
 
+  /// Prepares the runtime context of a keyset for the calls of all the
+  /// circuits of the program, converting the bootstrap and fast keyswitch keys
+  /// they use to the fourier domain concurrently, one thread per key.
+  ///
+  /// The circuits share the context of the keyset, see `evictKeyset`, so that
+  /// none of their first calls pays for the conversion.
+  Result<void> warmUpKeyset(const ServerKeyset &serverKeyset);
+
+  /// Sets how the GPU dataflow runtime uses the devices for the calls of all
+  /// the circuits of the program. The circuits returned by `getServerCircuit`
+  /// before are copies, which keep their previous settings.
+  void setDeviceSettings(const mlir::concretelang::DeviceSettings &settings);
+
+  /// The callback of the outputs of a call graph, invoked with the index of
+  /// an output and its value.
+  typedef std::function<void(size_t, const TransportValue &)> OutputCallback;
+
+  /// Calls the stages of a call graph with public arguments, the returns of a
+  /// stage being passed to the next ones without leaving the server.
+  ///
+  /// The stages whose arguments are ready run concurrently, on up to
+  /// `maxThreads` threads (all the hardware threads if 0) sharing the runtime
+  /// context of the keyset, and the returns of a stage are released once its
+  /// last user finishes. If a stage fails, the error of the first failing one
+  /// is returned. The circuits are simulated on simulated programs, the
+  /// keyset being then ignored.
+  ///
+  /// If `onOutput` is set, each output is also passed to it as soon as the
+  /// stage computing it finishes, while the other stages still run, e.g. so
+  /// that the client decrypts the first scores of a model before the last
+  /// ones are computed. The outputs taken from the arguments of the graph are
+  /// passed before the first stage runs. The callback is invoked on the
+  /// thread of the stage, but never concurrently.
+  Result<std::vector<TransportValue>>
+  callGraph(const ServerKeyset &serverKeyset, const CallGraph &graph,
+            const std::vector<TransportValue> &args, size_t maxThreads = 0,
+            OutputCallback onOutput = nullptr) const;
+
 private:
   ServerProgram() = default;
 
@@ -0,0 +1,39 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_SERVERLIB_STATICCIRCUITS_H
+#define CONCRETELANG_SERVERLIB_STATICCIRCUITS_H
+
+#include <stddef.h>
+
+namespace concretelang {
+namespace serverlib {
+
+/// The entry point of a compiled circuit.
+typedef void (*CircuitFunction)(void *, ...);
+
+/// A circuit of a static library linked in the binary.
+struct StaticCircuit {
+  const char *name;
+  CircuitFunction function;
+};
+
+/// Registers the program of a static library linked in the binary, for
+/// `ServerProgram::loadStatic` to load it without opening a shared library.
+///
+/// The table emitted along the static library, `static_circuits.cpp`, holds
+/// one of them, so that the program is registered by the static initializers
+/// of the binary it is compiled in. The program info and the circuits are
+/// not copied and must be static.
+class StaticProgramRegistration {
+public:
+  StaticProgramRegistration(const char *programInfoJson,
+                            const StaticCircuit *circuits, size_t count);
+};
+
+} // namespace serverlib
+} // namespace concretelang
+
+#endif
@@ -13,6 +13,7 @@
 #include "concrete-protocol.capnp.h"
 #include "concretelang/Common/Error.h"
 #include "concretelang/Common/Protocol.h"
+#include "concretelang/Support/CostTable.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/JSON.h"
 
@@ -46,6 +47,10 @@ struct Statistic {
   PrimitiveOperation operation;
   std::vector<std::pair<KeyType, int64_t>> keys;
   std::optional<int64_t> count;
+  /// The number of bootstraps on the longest path from the inputs to the
+  /// operation, a keyswitch counting with the bootstrap it feeds. Only set on
+  /// the keyswitches and bootstraps.
+  std::optional<int64_t> depth = std::nullopt;
 };
 
 struct CircuitCompilationFeedback {
@@ -67,8 +72,25 @@ struct CircuitCompilationFeedback {
   /// @brief memory usage per location
   std::map<std::string, std::optional<int64_t>> memoryUsagePerLoc;
 
+  /// @brief predicted seconds of a call, if a cost table is given
+  std::optional<double> predictedLatency;
+
+  /// @brief predicted calls per second of the workers running independent
+  /// calls, if a cost table is given
+  std::optional<double> predictedThroughput;
+
+  /// @brief analytic probability that each output decrypts to a wrong value,
+  /// empty unless the noise analysis is enabled
+  std::vector<double> outputErrorProbabilities;
+
   /// Fill the sizes from the program info.
   void fillFromCircuitInfo(concreteprotocol::CircuitInfo::Reader params);
+
+  /// Predict the runtime of the circuit on `workers` parallel workers, i.e.
+  /// cores or concurrent GPU bootstraps. The keyswitches and bootstraps of a
+  /// depth run in parallel, and the depths one after the other.
+  void predictRuntime(concreteprotocol::KeysetInfo::Reader keyset,
+                      const CostTable &costTable, uint64_t workers);
 };
 
 struct ProgramCompilationFeedback {
@@ -89,12 +111,20 @@ struct ProgramCompilationFeedback {
   /// @brief the total number of bytes of keyswitch keys
   uint64_t totalKeyswitchKeysSize;
 
+  /// @brief the representation of the integers: native, crt or chunked
+  std::string integerRepresentation;
+
   /// @brief the feedback for each circuit
   std::vector<CircuitCompilationFeedback> circuitFeedbacks;
 
   /// Fill the sizes from the program info.
   void fillFromProgramInfo(const Message<protocol::ProgramInfo> &params);
 
+  /// Predict the runtime of the circuits, see
+  /// `CircuitCompilationFeedback::predictRuntime`.
+  void predictRuntime(const Message<protocol::ProgramInfo> &params,
+                      const CostTable &costTable, uint64_t workers);
+
   /// Load the compilation feedback from a path
   static outcome::checked<ProgramCompilationFeedback, StringError>
   load(std::string path);
@@ -11,6 +11,7 @@
 #include "concretelang/Common/Protocol.h"
 #include "concretelang/Conversion/Utils/GlobalFHEContext.h"
 #include "concretelang/Support/Encodings.h"
+#include "concretelang/Support/LLVMEmitFile.h"
 #include "concretelang/Support/ProgramInfoGeneration.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
@@ -71,10 +72,22 @@ struct CompilationOptions {
   bool autoParallelize;
   bool loopParallelize;
   bool dataflowParallelize;
+  /// Target complexity of a dataflow task, in the unit of the complexity
+  /// computed by the optimizer: adjacent tasks are merged until they reach
+  /// it. Tasks are not merged if it is 0.
+  double dataflowTaskComplexity;
 
   /// Compression options
   bool compressEvaluationKeys;
   bool compressInputCiphertexts;
+  bool compressOutputCiphertexts;
+
+  /// The bootstrap keys are generated as multi-bit keys of this grouping
+  /// factor, bootstrapping a group of key bits at once with a threaded
+  /// bootstrap. The keys are classical if it is 1. The multi-bit keys are
+  /// never compressed, and the parameters remain those the optimizer chose
+  /// for a classical bootstrap.
+  uint32_t bootstrapGroupingFactor;
 
   /// Optimizer options
   optimizer::Config optimizerConfig;
@@ -85,12 +98,45 @@ struct CompilationOptions {
   /// Other options
   bool batchTFHEOps;
   int64_t maxBatchSize;
+  /// The batched keyswitches followed by a batched bootstrap are run on CPU
+  /// in chunks of this many ciphertexts, the keyswitch of a chunk overlapping
+  /// the bootstrap of the others. 0 disables the pipelining.
+  int64_t pipelineChunkSize;
   bool emitSDFGOps;
   bool unrollLoopsWithSDFGConvertibleOps;
+  /// Loop nests whose unrolling would produce more SDFG-convertible
+  /// operations than this are not unrolled, but streamed iteration by
+  /// iteration. 0 means no limit.
+  int64_t maxUnrolledSDFGOps;
   bool optimizeTFHE;
 
   std::optional<std::vector<int64_t>> fhelinalgTileSizes;
 
+  /// When no tile sizes are given, the reduction of the FHELinalg operations
+  /// is blocked so that the ciphertexts of a tile fit in this many bytes.
+  std::optional<int64_t> fhelinalgTileCacheSize;
+
+  /// When no tile sizes are given, the matrix multiplications, convolutions
+  /// and table lookups costing more than this many bootstraps are tiled in
+  /// tiles of about this cost, each becoming a dataflow task, and in at
+  /// least `fhelinalgTileWorkers` tiles. Operations are not tiled if it is 0.
+  double fhelinalgTileTaskCost;
+
+  /// Minimum number of tiles of the operations tiled by task cost, 0 for
+  /// all the cores.
+  int64_t fhelinalgTileWorkers;
+
+  /// Number of rows of the tiles in which the table lookups over the results
+  /// of dot products are computed together with their producers. Layers are
+  /// not streamed if it is 0.
+  int64_t layerStreamingTileSize;
+
+  /// Minimum number of elements of the dots and of the sums of all the
+  /// elements of a tensor lowered to a reduction of independent chunks
+  /// followed by the addition of their partial sums, rather than to a chain
+  /// of accumulations. Never if it is 0.
+  int64_t treeReductionMinSize;
+
   /// When decomposing big integers into chunks, chunkSize is the total number
   /// of bits used for the message, including the carry, while chunkWidth is
   /// only the number of bits used during encoding and decoding of a big integer
@@ -98,6 +144,17 @@ struct CompilationOptions {
   unsigned int chunkSize;
   unsigned int chunkWidth;
 
+  /// Minimum number of chunks of the additions of chunked integers whose
+  /// carries are computed by a parallel prefix network, in a logarithmic
+  /// depth of table lookups but with more of them than when rippling the
+  /// carries. The carries are always rippled if it is 0.
+  unsigned int carryLookaheadMinChunks;
+
+  /// When chunkIntegers is not set, decompose integers into chunks if the
+  /// optimizer finds the chunked circuit cheaper than the native or CRT one,
+  /// or if it only finds parameters for the chunked circuit.
+  bool autoChunkIntegers;
+
   /// When compiling from a dialect lower than FHE, one needs to provide
   /// encodings info manually to allow the client lib to be generated.
   std::optional<Message<concreteprotocol::ProgramEncodingInfo>> encodings;
@@ -107,24 +164,118 @@ struct CompilationOptions {
   bool enableTluFusing;
   bool printTluFusing;
 
+  /// Pack the table lookups applied to the same ciphertext in a single
+  /// bootstrap. Not supported by the simulation nor on GPU.
+  bool enableManyLut;
+
+  /// Round the inputs of the table lookups to a lower precision when it is
+  /// cheaper and moves no result of the tables by more than
+  /// `autoRoundingMaxError`.
+  bool enableAutoRounding;
+  uint64_t autoRoundingMaxError;
+
+  /// Replace the roundings by a single table lookup on their input, composed
+  /// with the table lookup using them if any, when it is cheaper than
+  /// truncating their bits one by one.
+  bool enableSingleBootstrapRounding;
+
+  /// Lower the encrypted by encrypted matrix multiplications to table lookups
+  /// squaring the sums of their operands, sharing the squares of the
+  /// operands.
+  bool enableMatMulSquares;
+
+  /// Lower the leveled operations on single ciphertexts to loops in the
+  /// compiled module instead of calls to the runtime.
+  bool inlineLeveledOps;
+
+  /// Reuse the buffers of dead ciphertexts for the following allocations
+  /// and hoist the buffers of loop iterations out of the loops.
+  bool reuseBuffers;
+
+  /// Lower the convolutions of a single group to the copy of the windows of
+  /// their input to contiguous patches, followed by a matrix product with
+  /// their weights. The ciphertexts of the input are copied once per
+  /// element of a kernel.
+  bool conv2dIm2col;
+
+  /// Lower the matrix products by constant matrices of which at least half
+  /// of the weights are zeros to loops over the non zero weights of each
+  /// column, the weights of 1 and -1 being added or subtracted without a
+  /// multiplication.
+  bool sparseMatmul;
+
+  /// Reorder the independent TFHE operations of each block so that their
+  /// live ciphertexts stay under this many bytes when possible, 0 minimizing
+  /// them. The source order, or the batching one, is kept if unset.
+  std::optional<int64_t> maxLiveCiphertextBytes;
+
+  /// Directory caching the objects of the compiled functions, the unchanged
+  /// functions of a recompiled module reusing them. Empty if disabled.
+  std::string objectCacheDir;
+
+  /// Directory caching the artifacts of the compiled libraries, keyed by
+  /// their source, these options and the build of the compiler. A library
+  /// compiled again is copied from the cache instead. Empty if disabled.
+  std::string libraryCacheDir;
+
+  /// Number of threads compiling the functions of the LLVM module in
+  /// parallel, 0 for all the cores.
+  unsigned codegenThreads;
+
+  /// The functions with more LLVM instructions, e.g. huge unrolled
+  /// straight-line code, are compiled without optimization. 0 if unlimited.
+  uint64_t codegenMaxOptimizedSize;
+
+  /// Cost table measured on the target backend, from which the compilation
+  /// feedback predicts the latency and throughput of the circuits. Empty if
+  /// no prediction.
+  std::string predictionCostTable;
+
+  /// Number of parallel workers, i.e. cores or concurrent GPU bootstraps, of
+  /// the prediction, 0 for all the cores.
+  uint64_t predictionWorkers;
+
+  /// Propagate the noise variances through the TFHE program to fill the
+  /// error probabilities of the outputs in the compilation feedback.
+  bool analyzeNoise;
+
+  /// Bitcode of the runtime wrappers, linked in the circuits before codegen
+  /// for their leveled operations to be inlined in the loops. Empty if none.
+  std::string runtimeBitcode;
+
   CompilationOptions()
       : v0FHEConstraints(std::nullopt), verifyDiagnostics(false),
         /// Simulate options
         simulate(false),
         // Parallelization options
         autoParallelize(false), loopParallelize(true),
-        dataflowParallelize(false),
+        dataflowParallelize(false), dataflowTaskComplexity(0),
         /// Compression options
         compressEvaluationKeys(false), compressInputCiphertexts(false),
+        compressOutputCiphertexts(false), bootstrapGroupingFactor(1),
         /// Optimizer options
         optimizerConfig(optimizer::DEFAULT_CONFIG),
         /// GPU
         emitGPUOps(false),
         /// Other options
         batchTFHEOps(false), maxBatchSize(std::numeric_limits<int64_t>::max()),
-        emitSDFGOps(false), unrollLoopsWithSDFGConvertibleOps(false),
-        optimizeTFHE(true), chunkIntegers(false), chunkSize(4), chunkWidth(2),
-        encodings(std::nullopt), enableTluFusing(true), printTluFusing(false){};
+        pipelineChunkSize(0), emitSDFGOps(false),
+        unrollLoopsWithSDFGConvertibleOps(false),
+        maxUnrolledSDFGOps(1 << 16), optimizeTFHE(true),
+        fhelinalgTileTaskCost(0), fhelinalgTileWorkers(0),
+        layerStreamingTileSize(0), treeReductionMinSize(0),
+        chunkIntegers(false), chunkSize(4),
+        chunkWidth(2), carryLookaheadMinChunks(0), autoChunkIntegers(false),
+        encodings(std::nullopt), enableTluFusing(true), printTluFusing(false),
+        enableManyLut(false), enableAutoRounding(false),
+        autoRoundingMaxError(0), enableSingleBootstrapRounding(false),
+        enableMatMulSquares(false),
+        inlineLeveledOps(false), reuseBuffers(false), conv2dIm2col(false),
+        sparseMatmul(false),
+        objectCacheDir(""),
+        libraryCacheDir(""), codegenThreads(1), codegenMaxOptimizedSize(0),
+        predictionCostTable(""), predictionWorkers(0), analyzeNoise(false),
+        runtimeBitcode(""){};
 
   /// @brief Constructor for CompilationOptions with default parameters for a
   /// specific backend.
@@ -192,11 +343,23 @@ public:
         : outputDirPath(outputDirPath), runtimeLibraryPath(runtimeLibraryPath),
           cleanUp(cleanUp), programInfo() {}
     /// Sets the compilation result used by the library
+    /// The object of the compilation is emitted following `emitOptions`.
     llvm::Expected<std::string>
-    setCompilationResult(CompilationResult &compilation);
+    setCompilationResult(CompilationResult &compilation,
+                         const EmitObjectOptions &emitOptions = {});
     /// Emit the library artifacts with the previously added compilation result
     llvm::Error emitArtifacts(bool sharedLib, bool staticLib,
                               bool clientParameters, bool compilationFeedback);
+    /// Copies the emitted artifacts to the library cache entry `entryPath`,
+    /// with the program info and the compilation feedback.
+    llvm::Error cacheArtifacts(std::string entryPath);
+    /// Copies the requested artifacts of the library cache entry `entryPath`
+    /// to the output directory and loads its program info and compilation
+    /// feedback. Returns false if the entry misses an artifact.
+    llvm::Expected<bool> loadCachedArtifacts(std::string entryPath,
+                                             bool sharedLib, bool staticLib,
+                                             bool clientParameters,
+                                             bool compilationFeedback);
     /// After a shared library has been emitted, its path is here
     std::string sharedLibraryPath;
     /// After a static library has been emitted, its path is here
@@ -214,6 +377,9 @@ public:
     /// Returns the path of the static library
     static std::string getStaticLibraryPath(std::string outputDirPath);
 
+    /// Returns the path of the table of the circuits of the static library
+    static std::string getStaticCircuitsPath(std::string outputDirPath);
+
     /// Returns the path of the program info
     static std::string getProgramInfoPath(std::string outputDirPath);
 
@@ -232,12 +398,19 @@ public:
   private:
     /// Emit a shared library with the previously added compilation result
     llvm::Expected<std::string> emitStatic();
+    /// Emit the source of the table registering the circuits of the static
+    /// library and its program info in `dirPath`, to compile in the binary
+    /// the library is linked in
+    llvm::Expected<std::string>
+    emitStaticCircuitsTable(const std::string &dirPath);
     /// Emit a shared library with the previously added compilation result
     llvm::Expected<std::string> emitShared();
-    /// Emit a json ProgramInfo corresponding to library content
-    llvm::Expected<std::string> emitProgramInfoJSON();
-    /// Emit a json CompilationFeedback corresponding to library content
-    llvm::Expected<std::string> emitCompilationFeedbackJSON();
+    /// Emit a json ProgramInfo corresponding to library content in `dirPath`
+    llvm::Expected<std::string> emitProgramInfoJSON(const std::string &dirPath);
+    /// Emit a json CompilationFeedback corresponding to library content in
+    /// `dirPath`
+    llvm::Expected<std::string>
+    emitCompilationFeedbackJSON(const std::string &dirPath);
   };
 
   /// Specification of the exit stage of the compilation pipeline
@@ -357,6 +530,12 @@ public:
 
   CompilationOptions &getCompilationOptions() { return compilerOptions; }
 
+  /// Returns the key in the library cache of the library compiled from
+  /// `source` and linked to `runtimeLibraryPath`, i.e. the hash of the
+  /// source, of the options and of the build of the compiler.
+  std::string libraryCacheKey(llvm::StringRef source,
+                              llvm::StringRef runtimeLibraryPath);
+
   void setFHEConstraints(const mlir::concretelang::V0FHEConstraint &c);
   void setMaxEintPrecision(size_t v);
   void setMaxMANP(size_t v);
@@ -374,7 +553,9 @@ protected:
 
 private:
   llvm::Expected<std::optional<optimizer::Description>>
-  getConcreteOptimizerDescription(CompilationResult &res);
+  getConcreteOptimizerDescription(mlir::ModuleOp module);
+  std::optional<double> getOptimizedComplexity(mlir::ModuleOp module);
+  llvm::Expected<bool> selectChunkedIntegers(mlir::ModuleOp module);
   llvm::Error determineFHEParameters(CompilationResult &res);
   mlir::LogicalResult
   materializeOptimizerPartitionFrontiers(CompilationResult &res);
@@ -9,6 +9,10 @@
 namespace mlir {
 namespace concretelang {
 constexpr unsigned DEFAULT_PATTERN_BENEFIT = 1;
+
+/// Attribute marking the loops over the tiles of a streamed layer, which
+/// operations are not batched across.
+constexpr const char *STREAMING_TILE_LOOP_ATTR = "streaming-tile-loop";
 } // namespace concretelang
 } // namespace mlir
 
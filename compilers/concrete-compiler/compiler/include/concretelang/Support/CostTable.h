@@ -0,0 +1,59 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_SUPPORT_COSTTABLE_H_
+#define CONCRETELANG_SUPPORT_COSTTABLE_H_
+
+#include <string>
+#include <vector>
+
+#include "boost/outcome.h"
+#include "concretelang/Common/Error.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace mlir {
+namespace concretelang {
+
+using StringError = ::concretelang::error::StringError;
+
+/// The timings of the keyswitches and bootstraps measured on the target
+/// backend. The table has one measure per line, `#` starting a comment:
+///   ks <input_lwe_dimension> <output_lwe_dimension> <level> <log2_base>
+///      <nanoseconds>
+///   pbs <internal_lwe_dimension> <glwe_dimension> <log2_polynomial_size>
+///       <level> <log2_base> <nanoseconds>
+/// as written by the `calibrate_cost_model` example of concrete-cpu.
+class CostTable {
+public:
+  static outcome::checked<CostTable, StringError> parse(llvm::StringRef table);
+
+  static outcome::checked<CostTable, StringError> load(std::string path);
+
+  /// The nanoseconds of a keyswitch, scaled from the closest measure.
+  double keyswitchNs(uint64_t inputLweDimension, uint64_t outputLweDimension,
+                     uint64_t level) const;
+
+  /// The nanoseconds of a bootstrap, scaled from the closest measure.
+  double bootstrapNs(uint64_t internalLweDimension, uint64_t glweDimension,
+                     uint64_t polynomialSize, uint64_t level) const;
+
+private:
+  /// A measure and the number of multiply-accumulates it does, the costs of
+  /// the unmeasured parameters being proportional to it.
+  struct Measure {
+    double work;
+    double ns;
+  };
+
+  static double scale(const std::vector<Measure> &measures, double work);
+
+  std::vector<Measure> keyswitches;
+  std::vector<Measure> bootstraps;
+};
+
+} // namespace concretelang
+} // namespace mlir
+
+#endif
@@ -11,7 +11,21 @@
 namespace mlir {
 namespace concretelang {
 
-llvm::Error emitObject(llvm::Module &module, std::string objectPath);
+struct EmitObjectOptions {
+  /// Directory caching the objects of the functions, the unchanged functions
+  /// not being compiled again. Empty if disabled.
+  std::string cacheDir = "";
+  /// Number of threads compiling the functions in parallel, 0 for all cores
+  unsigned codegenThreads = 1;
+  /// Functions with more instructions are compiled without optimization, 0
+  /// if unlimited
+  uint64_t maxOptimizedSize = 0;
+};
+
+/// Emits the object file of `module`. Its functions are compiled separately
+/// when they are cached or compiled in parallel.
+llvm::Error emitObject(llvm::Module &module, std::string objectPath,
+                       const EmitObjectOptions &options = {});
 
 llvm::Error callCmd(std::string cmd);
 
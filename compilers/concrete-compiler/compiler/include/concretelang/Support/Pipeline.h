@@ -16,7 +16,11 @@ namespace mlir {
 namespace concretelang {
 namespace pipeline {
 
+/// Builds the dataflow task graph and lowers it to RT. If `taskComplexity`
+/// is strictly positive, adjacent tasks are merged until they reach this
+/// share of the `circuitComplexity` computed by the optimizer.
 mlir::LogicalResult autopar(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                            double circuitComplexity, double taskComplexity,
                             std::function<bool(mlir::Pass *)> enablePass);
 
 mlir::LogicalResult materializeOptimizerPartitionFrontiers(
@@ -34,18 +38,36 @@ markFHELinalgForTiling(mlir::MLIRContext &context, mlir::ModuleOp &module,
                        llvm::ArrayRef<int64_t> tileSizes,
                        std::function<bool(mlir::Pass *)> enablePass);
 
+mlir::LogicalResult
+markFHELinalgForCacheBlocking(mlir::MLIRContext &context,
+                              mlir::ModuleOp &module, int64_t cacheSize,
+                              int64_t ciphertextSize,
+                              std::function<bool(mlir::Pass *)> enablePass);
+
 mlir::LogicalResult
 transformHighLevelFHEOps(mlir::MLIRContext &context, mlir::ModuleOp &module,
                          std::function<bool(mlir::Pass *)> enablePass);
 
 mlir::LogicalResult
 lowerFHELinalgToLinalg(mlir::MLIRContext &context, mlir::ModuleOp &module,
-                       std::function<bool(mlir::Pass *)> enablePass);
+                       std::function<bool(mlir::Pass *)> enablePass,
+                       int64_t treeReductionMinSize, bool conv2dIm2col,
+                       bool sparseMatmul);
 
 mlir::LogicalResult
 tileMarkedLinalg(mlir::MLIRContext &context, mlir::ModuleOp &module,
                  std::function<bool(mlir::Pass *)> enablePass);
 
+mlir::LogicalResult
+markLinalgForTaskTiling(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                        double taskCost, int64_t workers,
+                        std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+streamLinalgLayers(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   int64_t tileSize,
+                   std::function<bool(mlir::Pass *)> enablePass);
+
 mlir::LogicalResult
 lowerLinalgToLoops(mlir::MLIRContext &context, mlir::ModuleOp &module,
                    std::function<bool(mlir::Pass *)> enablePass,
@@ -55,10 +77,38 @@ mlir::LogicalResult
 transformFHEBoolean(mlir::MLIRContext &context, mlir::ModuleOp &module,
                     std::function<bool(mlir::Pass *)> enablePass);
 
+mlir::LogicalResult
+shareMatMulSquares(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+batchEncryptedMuls(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+fuseTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                 bool report, std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+autoRoundTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      uint64_t maxError,
+                      std::function<double(unsigned)> tluCost,
+                      std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+roundWithTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      std::function<double(unsigned)> tluCost,
+                      std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+packTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                 std::function<bool(mlir::Pass *)> enablePass);
+
 mlir::LogicalResult
 transformFHEBigInt(mlir::MLIRContext &context, mlir::ModuleOp &module,
                    std::function<bool(mlir::Pass *)> enablePass,
-                   unsigned int chunkSize, unsigned int chunkWidth);
+                   unsigned int chunkSize, unsigned int chunkWidth,
+                   unsigned int carryLookaheadMinChunks);
 
 mlir::LogicalResult
 lowerFHEToTFHE(mlir::MLIRContext &context, mlir::ModuleOp &module,
@@ -75,6 +125,11 @@ mlir::LogicalResult batchTFHE(mlir::MLIRContext &context,
                               std::function<bool(mlir::Pass *)> enablePass,
                               int64_t maxBatchSize);
 
+mlir::LogicalResult
+scheduleTFHEForMemory(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      std::function<bool(mlir::Pass *)> enablePass,
+                      int64_t maxLiveBytes);
+
 mlir::LogicalResult
 normalizeTFHEKeys(mlir::MLIRContext &context, mlir::ModuleOp &module,
                   std::function<bool(mlir::Pass *)> enablePass);
@@ -84,6 +139,13 @@ extractTFHEStatistics(mlir::MLIRContext &context, mlir::ModuleOp &module,
                       std::function<bool(mlir::Pass *)> enablePass,
                       ProgramCompilationFeedback &feedback);
 
+mlir::LogicalResult
+analyzeTFHENoise(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                 std::function<bool(mlir::Pass *)> enablePass,
+                 ProgramCompilationFeedback &feedback,
+                 const Message<concreteprotocol::ProgramInfo> &programInfo,
+                 uint32_t fftPrecision);
+
 mlir::LogicalResult
 lowerTFHEToConcrete(mlir::MLIRContext &context, mlir::ModuleOp &module,
                     std::function<bool(mlir::Pass *)> enablePass);
@@ -102,6 +164,22 @@ mlir::LogicalResult optimizeTFHE(mlir::MLIRContext &context,
                                  mlir::ModuleOp &module,
                                  std::function<bool(mlir::Pass *)> enablePass);
 
+mlir::LogicalResult
+shareTFHEKeyswitches(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                     std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+shareTFHEWopPBS(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+encodeTFHEConstantLuts(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                       std::function<bool(mlir::Pass *)> enablePass);
+
+mlir::LogicalResult
+hoistTFHELutEncodings(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      std::function<bool(mlir::Pass *)> enablePass);
+
 mlir::LogicalResult simulateTFHE(mlir::MLIRContext &context,
                                  mlir::ModuleOp &module,
                                  std::function<bool(mlir::Pass *)> enablePass);
@@ -109,7 +187,8 @@ mlir::LogicalResult simulateTFHE(mlir::MLIRContext &context,
 mlir::LogicalResult extractSDFGOps(mlir::MLIRContext &context,
                                    mlir::ModuleOp &module,
                                    std::function<bool(mlir::Pass *)> enablePass,
-                                   bool unrollLoops);
+                                   bool unrollLoops,
+                                   int64_t maxUnrolledOps = 0);
 
 mlir::LogicalResult
 addRuntimeContext(mlir::MLIRContext &context, mlir::ModuleOp &module,
@@ -128,10 +207,15 @@ mlir::LogicalResult lowerToStd(mlir::MLIRContext &context,
                                std::function<bool(mlir::Pass *)> enablePass,
                                bool parallelizeLoops);
 
+mlir::LogicalResult reuseBuffers(mlir::MLIRContext &context,
+                                 mlir::ModuleOp &module,
+                                 std::function<bool(mlir::Pass *)> enablePass);
+
 mlir::LogicalResult lowerToCAPI(mlir::MLIRContext &context,
                                 mlir::ModuleOp &module,
                                 std::function<bool(mlir::Pass *)> enablePass,
-                                bool gpu);
+                                bool gpu, bool inlineLeveledOps,
+                                int64_t pipelineChunkSize);
 
 mlir::LogicalResult optimizeLLVMModule(llvm::LLVMContext &llvmContext,
                                        llvm::Module &module);
@@ -141,6 +225,13 @@ lowerLLVMDialectToLLVMIR(mlir::MLIRContext &context,
                          llvm::LLVMContext &llvmContext,
                          mlir::ModuleOp &module);
 
+/// Links the functions of the runtime bitcode at `bitcodePath` called by the
+/// circuits in `module`, with an internal linkage so that they get inlined.
+/// The functions using the state of the runtime, i.e. its mutable globals,
+/// are kept as calls to the runtime library.
+llvm::Error linkRuntimeBitcode(llvm::Module &module,
+                               const std::string &bitcodePath);
+
 } // namespace pipeline
 } // namespace concretelang
 } // namespace mlir
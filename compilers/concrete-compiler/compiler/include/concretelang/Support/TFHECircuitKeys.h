@@ -29,7 +29,9 @@ struct TFHECircuitKeys {
 
 llvm::raw_ostream &operator<<(llvm::raw_ostream &OS, const TFHECircuitKeys cks);
 
-TFHECircuitKeys extractCircuitKeys(mlir::ModuleOp moduleOp);
+/// Gathers the keys used by the operations nested in `moduleOp`, which is
+/// either a whole module or a single function of it.
+TFHECircuitKeys extractCircuitKeys(mlir::Operation *moduleOp);
 
 } // namespace TFHE
 } // namespace concretelang
@@ -81,6 +81,14 @@ constexpr bool DEFAULT_CACHE_ON_DISK = true;
 constexpr uint32_t DEFAULT_CIPHERTEXT_MODULUS_LOG = 64;
 constexpr uint32_t DEFAULT_FFT_PRECISION = 53;
 constexpr bool DEFAULT_COMPOSABLE = false;
+/// No maximum size of the evaluation keys.
+constexpr uint64_t DEFAULT_MAXIMUM_EVALUATION_KEYS_SIZE = 0;
+/// The total complexity is minimized rather than the latency.
+constexpr uint64_t DEFAULT_LATENCY_WORKERS = 0;
+/// No cost table, the analytic cost model is used.
+constexpr const char *DEFAULT_COST_TABLE = "";
+/// No solution cache, every compilation runs the optimizer.
+constexpr const char *DEFAULT_SOLUTION_CACHE = "";
 
 /// The strategy of the crypto optimization
 enum Strategy {
@@ -116,6 +124,16 @@ struct Config {
   uint32_t ciphertext_modulus_log;
   uint32_t fft_precision;
   bool composable;
+  /// Maximum size in bytes of the bootstrap and keyswitch keys, 0 if unlimited
+  uint64_t maximum_evaluation_keys_size;
+  /// Number of parallel workers on which the latency is minimized, 0 to
+  /// minimize the total complexity
+  uint64_t latency_workers;
+  /// Path of a cost table measured by the calibration tool of concrete-cpu
+  const char *cost_table;
+  /// Directory where the optimizer saves the solutions of the circuits, to
+  /// reuse them when a circuit is recompiled
+  const char *solution_cache;
 };
 
 constexpr Config DEFAULT_CONFIG = {
@@ -133,6 +151,10 @@ constexpr Config DEFAULT_CONFIG = {
     DEFAULT_CIPHERTEXT_MODULUS_LOG,
     DEFAULT_FFT_PRECISION,
     DEFAULT_COMPOSABLE,
+    DEFAULT_MAXIMUM_EVALUATION_KEYS_SIZE,
+    DEFAULT_LATENCY_WORKERS,
+    DEFAULT_COST_TABLE,
+    DEFAULT_SOLUTION_CACHE,
 };
 
 using Dag = rust::Box<concrete_optimizer::OperationDag>;
@@ -157,6 +179,10 @@ llvm::Expected<optimizer::Solution>
 getSolution(optimizer::Description &descr, ProgramCompilationFeedback &feedback,
             optimizer::Config optimizerConfig);
 
+/// The complexity of a bootstrap on `precision` bits of a ciphertext of norm
+/// 1, as estimated by the V0 optimization. Infinite if no parameters exist.
+double getBootstrapComplexity(size_t precision, optimizer::Config config);
+
 // As for now the solution which contains a crt encoding is mono parameter only
 // we have some parts of the pipeline that rely on that.
 // TODO: Remove this function
@@ -180,6 +206,19 @@ inline size_t getPolynomialSizeFromSolution(optimizer::Solution solution) {
   return 42;
 }
 
+// Returns the largest dimension of the ciphertexts of the leveled
+// operations, i.e. the dimension of the outputs of the bootstraps.
+inline size_t getMaxBigLweDimensionFromSolution(optimizer::Solution solution) {
+  if (auto mono = std::get_if<V0Parameter>(&solution); mono != nullptr) {
+    return mono->getNBigLweDimension();
+  }
+  size_t dimension = 0;
+  for (auto &key : std::get<CircuitSolution>(solution).circuit_keys.secret_keys)
+    dimension = std::max<size_t>(dimension,
+                                 key.glwe_dimension * key.polynomial_size);
+  return dimension;
+}
+
 } // namespace concretelang
 } // namespace mlir
 
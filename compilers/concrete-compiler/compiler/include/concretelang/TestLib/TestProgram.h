@@ -170,6 +170,14 @@ public:
     return serverCircuit;
   }
 
+  /// Returns the keyset generated last.
+  Result<Keyset> getKeyset() {
+    if (!keyset.has_value()) {
+      return StringError("TestProgram: keyset has not been generated\n");
+    }
+    return *keyset;
+  }
+
 private:
   std::string getArtifactDirectory() { return artifactDirectory; }
 
@@ -180,13 +188,6 @@ private:
     return *library;
   }
 
-  Result<Keyset> getKeyset() {
-    if (!keyset.has_value()) {
-      return StringError("TestProgram: keyset has not been generated\n");
-    }
-    return *keyset;
-  }
-
   bool isSimulation() { return compiler.getCompilationOptions().simulate; }
 
   std::string artifactDirectory;
@@ -0,0 +1,29 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#ifndef CONCRETELANG_TRANSFORMS_LOOPCOST_H
+#define CONCRETELANG_TRANSFORMS_LOOPCOST_H
+
+#include <mlir/IR/Region.h>
+
+namespace mlir {
+namespace concretelang {
+
+/// Costs of the operations on ciphertexts relative to a bootstrap, which
+/// dominates the cost of the circuits.
+const double KEYSWITCH_COST = 0.1;
+const double LEVELED_OP_COST = 1e-3;
+/// Cost of the wop-PBS of a single block of a CRT decomposition.
+const double WOP_PBS_BLOCK_COST = 10;
+
+/// Returns the estimated cost of one execution of `region`, in bootstraps,
+/// from the Concrete buffer operations it holds. The nested loops with
+/// static bounds count their body once per iteration, the others once.
+double estimateRegionCost(mlir::Region &region);
+
+} // namespace concretelang
+} // namespace mlir
+
+#endif
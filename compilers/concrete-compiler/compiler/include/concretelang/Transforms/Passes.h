@@ -6,9 +6,11 @@
 #ifndef CONCRETELANG_TRANSFORMS_PASS_H
 #define CONCRETELANG_TRANSFORMS_PASS_H
 
+#include <mlir/Dialect/Arith/IR/Arith.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/Linalg/IR/Linalg.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/OpenMP/OpenMPDialect.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Pass/Pass.h>
 
@@ -20,7 +22,10 @@ namespace concretelang {
 
 std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
 createCollapseParallelLoops();
-std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>> createForLoopToParallel();
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createForLoopToParallel(double minParallelCost = 0.05);
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createOpenMPLoopSchedulePass(double minDynamicCost = 0.05);
 std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
 createBatchingPass(int64_t maxBatchSize = std::numeric_limits<int64_t>::max());
 std::unique_ptr<OperationPass<ModuleOp>> createSCFForallToSCFForPass();
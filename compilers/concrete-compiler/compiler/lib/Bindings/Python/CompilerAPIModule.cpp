@@ -14,19 +14,26 @@
 #include "concretelang/ServerLib/ServerLib.h"
 #include "concretelang/Support/logging.h"
 #include <llvm/Support/Debug.h>
+#include <llvm/Support/Parallel.h>
 #include <mlir-c/Bindings/Python/Interop.h>
 #include <mlir/CAPI/IR.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/ExecutionEngine/OptUtils.h>
+#include <mutex>
+#include <optional>
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
 #include <pybind11/stl.h>
+#include <set>
 #include <signal.h>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 
+using concretelang::serverlib::CallGraph;
 using mlir::concretelang::CompilationOptions;
 using mlir::concretelang::LambdaArgument;
 
@@ -315,6 +322,23 @@ evaluationKeysUnserialize(const std::string &buffer) {
   return output;
 }
 
+/// Loads evaluation keys with `load`, which reads them from a file without the
+/// GIL, then prepares them if a prepared keyset path is given.
+concretelang::clientlib::EvaluationKeys evaluationKeysLoad(
+    std::function<concretelang::error::Result<ServerKeyset>()> load,
+    std::optional<std::string> preparedKeysetPath) {
+  pybind11::gil_scoped_release release;
+  GET_OR_THROW_RESULT(auto serverKeyset, load());
+  if (preparedKeysetPath.has_value()) {
+    auto maybePrepared = ServerCircuit::prepareKeyset(
+        serverKeyset, preparedKeysetPath.value());
+    if (maybePrepared.has_failure()) {
+      throw std::runtime_error(maybePrepared.as_failure().error().mesg);
+    }
+  }
+  return concretelang::clientlib::EvaluationKeys{serverKeyset};
+}
+
 std::string evaluationKeysSerialize(
     concretelang::clientlib::EvaluationKeys &evaluationKeys) {
   auto serverKeysetProto = evaluationKeys.keyset.toProto();
@@ -366,6 +390,28 @@ valueSerialize(const concretelang::clientlib::SharedScalarOrTensorData &value) {
   return maybeString.value();
 }
 
+std::string valueSerializeAtRest(
+    const concretelang::clientlib::SharedScalarOrTensorData &value,
+    uint32_t compressedModulusLog) {
+  std::ostringstream ostream;
+  auto maybeError = concretelang::values::writeValueAtRest(
+      value.value, ostream, compressedModulusLog);
+  if (maybeError.has_failure()) {
+    throw std::runtime_error(maybeError.as_failure().error().mesg);
+  }
+  return ostream.str();
+}
+
+concretelang::clientlib::SharedScalarOrTensorData
+valueUnserializeAtRest(const std::string &buffer) {
+  std::istringstream istream(buffer);
+  auto maybeValue = concretelang::values::readValueAtRest(istream);
+  if (maybeValue.has_failure()) {
+    throw std::runtime_error(maybeValue.as_failure().error().mesg);
+  }
+  return {maybeValue.value()};
+}
+
 concretelang::clientlib::ValueExporter
 createValueExporter(concretelang::clientlib::KeySet &keySet,
                     concretelang::clientlib::ClientParameters &clientParameters,
@@ -478,6 +524,197 @@ std::string roundTrip(const char *module) {
   return os.str();
 }
 
+/// The values of a tensor to export, read through the buffer protocol. Arrays
+/// of another type or layout, as well as python lists, are converted by numpy.
+typedef pybind11::array_t<int64_t, pybind11::array::c_style |
+                                       pybind11::array::forcecast>
+    NumpyInt64Array;
+
+/// Copies the values of the array straight into a tensor of the given
+/// dimensions.
+Tensor<int64_t> numpyArrayToTensor(const NumpyInt64Array &values,
+                                   std::vector<size_t> dimensions) {
+  std::vector<int64_t> data(values.data(), values.data() + values.size());
+  return Tensor<int64_t>(std::move(data), std::move(dimensions));
+}
+
+/// Exports the samples stacked along the first dimension of `values`, each
+/// sample being a tensor of the given shape, or a scalar if it is empty.
+///
+/// The samples share the csprng of the exporter, they are thus encrypted one
+/// after the other, the ciphertexts of a sample being encrypted in parallel.
+template <typename Exporter>
+std::vector<::concretelang::clientlib::SharedScalarOrTensorData>
+exportBatch(Exporter &exporter, size_t position, const NumpyInt64Array &values,
+            const std::vector<int64_t> &shape) {
+  std::vector<size_t> dimensions(shape.begin(), shape.end());
+  size_t sampleSize = 1;
+  for (auto dimension : dimensions) {
+    sampleSize *= dimension;
+  }
+  size_t batchSize = values.ndim() == 0 ? 0 : values.shape(0);
+  if ((size_t)values.size() != batchSize * sampleSize) {
+    throw std::runtime_error(
+        "Tried to export a batch of samples of an incorrect shape.");
+  }
+  auto info =
+      exporter.circuit.getCircuitInfo().asReader().getInputs()[position];
+  auto typeTransformer = getPythonTypeTransformer(info);
+  const int64_t *data = values.data();
+
+  pybind11::gil_scoped_release release;
+  std::vector<::concretelang::clientlib::SharedScalarOrTensorData> exported;
+  exported.reserve(batchSize);
+  for (size_t i = 0; i < batchSize; i++) {
+    const int64_t *sample = data + i * sampleSize;
+    auto tensor = dimensions.empty()
+                      ? Tensor<int64_t>(*sample)
+                      : Tensor<int64_t>(std::vector<int64_t>(
+                                            sample, sample + sampleSize),
+                                        dimensions);
+    auto result = exporter.circuit.prepareInput(
+        typeTransformer({std::move(tensor)}), position);
+    if (result.has_error()) {
+      throw std::runtime_error(result.error().mesg);
+    }
+    exported.push_back({result.value()});
+  }
+  return exported;
+}
+
+/// Returns the source of a value of a call graph: the argument of the graph
+/// at an index, or the return (stage, index) of a stage.
+CallGraph::Source callGraphSource(const pybind11::handle &source) {
+  if (pybind11::isinstance<pybind11::tuple>(source)) {
+    auto pair = source.cast<std::pair<size_t, size_t>>();
+    return {pair.first, pair.second};
+  }
+  return {std::nullopt, source.cast<size_t>()};
+}
+
+/// Calls a call graph on public arguments, or simulates it if there is no
+/// keyset. Each stage is a (circuit, sources of the arguments) pair. The
+/// outputs are passed to `onOutput`, if any, as soon as they are computed.
+std::unique_ptr<::concretelang::clientlib::PublicResult>
+callGraph(ServerProgram &program, const pybind11::list &stages,
+          const pybind11::list &outputs,
+          ::concretelang::clientlib::PublicArguments &publicArguments,
+          const ServerKeyset *serverKeyset, size_t maxThreads,
+          std::optional<pybind11::function> onOutput = std::nullopt) {
+  CallGraph graph;
+  for (auto stage : stages) {
+    auto pair = stage.cast<pybind11::tuple>();
+    CallGraph::Stage converted{pair[0].cast<std::string>(), {}};
+    for (auto source : pair[1].cast<pybind11::list>()) {
+      converted.args.push_back(callGraphSource(source));
+    }
+    graph.stages.push_back(std::move(converted));
+  }
+  for (auto source : outputs) {
+    graph.outputs.push_back(callGraphSource(source));
+  }
+
+  // An exception of the callback can't cross the threads of the stages, the
+  // first one is raised once the graph returns.
+  std::optional<std::string> callbackError;
+  ServerProgram::OutputCallback outputCallback;
+  if (onOutput.has_value()) {
+    outputCallback = [&](size_t index, const TransportValue &value) {
+      pybind11::gil_scoped_acquire acquire;
+      if (callbackError.has_value()) {
+        return;
+      }
+      try {
+        (*onOutput)(index,
+                    ::concretelang::clientlib::SharedScalarOrTensorData{value});
+      } catch (pybind11::error_already_set &error) {
+        callbackError = error.what();
+      }
+    };
+  }
+
+  std::optional<Result<std::vector<TransportValue>>> maybeOutput;
+  {
+    pybind11::gil_scoped_release release;
+    ServerKeyset emptyKeyset;
+    maybeOutput =
+        program.callGraph(serverKeyset ? *serverKeyset : emptyKeyset, graph,
+                          publicArguments.values, maxThreads, outputCallback);
+  }
+  if (callbackError.has_value()) {
+    throw std::runtime_error(*callbackError);
+  }
+  GET_OR_THROW_RESULT(auto output, std::move(*maybeOutput));
+  return std::make_unique<::concretelang::clientlib::PublicResult>(
+      ::concretelang::clientlib::PublicResult{std::move(output)});
+}
+
+/// Calls the circuit on a batch of public arguments, or simulates it if there
+/// is no keyset.
+std::vector<std::unique_ptr<::concretelang::clientlib::PublicResult>>
+callBatch(ServerCircuit &circuit, const pybind11::list &batch,
+          const ServerKeyset *serverKeyset, size_t maxThreads) {
+  std::vector<const ::concretelang::clientlib::PublicArguments *> arguments;
+  for (auto publicArguments : batch) {
+    arguments.push_back(
+        &publicArguments.cast<::concretelang::clientlib::PublicArguments &>());
+  }
+
+  pybind11::gil_scoped_release release;
+  std::vector<std::vector<TransportValue>> values;
+  values.reserve(arguments.size());
+  for (auto publicArguments : arguments) {
+    values.push_back(publicArguments->values);
+  }
+  ServerKeyset emptyKeyset;
+  GET_OR_THROW_RESULT(
+      auto outputs,
+      circuit.callBatch(serverKeyset ? *serverKeyset : emptyKeyset, values,
+                        maxThreads));
+
+  std::vector<std::unique_ptr<::concretelang::clientlib::PublicResult>>
+      results;
+  results.reserve(outputs.size());
+  for (auto &output : outputs) {
+    results.push_back(
+        std::make_unique<::concretelang::clientlib::PublicResult>(
+            ::concretelang::clientlib::PublicResult{std::move(output)}));
+  }
+  return results;
+}
+
+/// Decrypts values of the output at `position` in parallel, the secret keys
+/// being only read.
+template <typename Decrypter>
+std::vector<lambdaArgument> decryptBatch(Decrypter &decrypter, size_t position,
+                                         const pybind11::list &values) {
+  std::vector<const TransportValue *> transportValues;
+  for (auto value : values) {
+    transportValues.push_back(
+        &value.cast<::concretelang::clientlib::SharedScalarOrTensorData &>()
+             .value);
+  }
+
+  pybind11::gil_scoped_release release;
+  std::vector<std::optional<concretelang::error::Result<Value>>> results(
+      transportValues.size());
+  llvm::parallelFor(0, transportValues.size(), [&](size_t i) {
+    results[i] = decrypter.circuit.processOutput(*transportValues[i], position);
+  });
+
+  std::vector<lambdaArgument> decrypted;
+  decrypted.reserve(results.size());
+  for (auto &result : results) {
+    if (result->has_error()) {
+      throw std::runtime_error(result->error().mesg);
+    }
+    decrypted.push_back(
+        lambdaArgument{std::make_shared<mlir::concretelang::LambdaArgument>(
+            mlir::concretelang::LambdaArgument{result->value()})});
+  }
+  return decrypted;
+}
+
 bool lambdaArgumentIsTensor(lambdaArgument &lambda_arg) {
   return !lambda_arg.ptr->value.isScalar();
 }
@@ -522,6 +759,52 @@ lambdaArgumentGetSignedTensorData(lambdaArgument &lambda_arg) {
   }
 }
 
+/// Copies the values of a tensor of `U` in a new numpy array of `T` with its
+/// shape, returns false if the value is not such a tensor.
+template <typename T, typename U>
+bool tensorToArray(Value &value, pybind11::array_t<T> &array) {
+  auto tensor = value.getTensorPtr<U>();
+  if (tensor == nullptr) {
+    return false;
+  }
+  std::vector<ssize_t> shape(tensor->dimensions.begin(),
+                             tensor->dimensions.end());
+  array = pybind11::array_t<T>(shape);
+  std::copy(tensor->values.begin(), tensor->values.end(),
+            array.mutable_data());
+  return true;
+}
+
+/// Unsigned values are returned as int64, the dtype numpy gives to the list of
+/// `get_tensor_data`.
+pybind11::array_t<int64_t>
+lambdaArgumentGetTensorArray(lambdaArgument &lambda_arg) {
+  pybind11::array_t<int64_t> array;
+  auto &value = lambda_arg.ptr->value;
+  if (tensorToArray<int64_t, uint8_t>(value, array) ||
+      tensorToArray<int64_t, uint16_t>(value, array) ||
+      tensorToArray<int64_t, uint32_t>(value, array) ||
+      tensorToArray<int64_t, uint64_t>(value, array)) {
+    return array;
+  }
+  throw std::invalid_argument(
+      "LambdaArgument isn't a tensor or has an unsupported bitwidth");
+}
+
+pybind11::array_t<int64_t>
+lambdaArgumentGetSignedTensorArray(lambdaArgument &lambda_arg) {
+  pybind11::array_t<int64_t> array;
+  auto &value = lambda_arg.ptr->value;
+  if (tensorToArray<int64_t, int8_t>(value, array) ||
+      tensorToArray<int64_t, int16_t>(value, array) ||
+      tensorToArray<int64_t, int32_t>(value, array) ||
+      tensorToArray<int64_t, int64_t>(value, array)) {
+    return array;
+  }
+  throw std::invalid_argument(
+      "LambdaArgument isn't a tensor or has an unsupported bitwidth");
+}
+
 std::vector<int64_t>
 lambdaArgumentGetTensorDimensions(lambdaArgument &lambda_arg) {
   std::vector<size_t> dims = lambda_arg.ptr->value.getDimensions();
@@ -718,6 +1001,14 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
            [](CompilationOptions &options, bool b) {
              options.compressInputCiphertexts = b;
            })
+      .def("set_compress_output_ciphertexts",
+           [](CompilationOptions &options, bool b) {
+             options.compressOutputCiphertexts = b;
+           })
+      .def("set_bootstrap_grouping_factor",
+           [](CompilationOptions &options, uint32_t groupingFactor) {
+             options.bootstrapGroupingFactor = groupingFactor;
+           })
       .def("set_optimize_concrete", [](CompilationOptions &options,
                                        bool b) { options.optimizeTFHE = b; })
       .def("set_p_error",
@@ -745,6 +1036,28 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
            [](CompilationOptions &options, bool composable) {
              options.optimizerConfig.composable = composable;
            })
+      .def("set_max_evaluation_keys_size",
+           [](CompilationOptions &options, uint64_t size) {
+             options.optimizerConfig.maximum_evaluation_keys_size = size;
+           })
+      .def("set_latency_workers",
+           [](CompilationOptions &options, uint64_t workers) {
+             options.optimizerConfig.latency_workers = workers;
+           })
+      .def("set_ciphertext_modulus_log",
+           [](CompilationOptions &options, uint32_t log) {
+             options.optimizerConfig.ciphertext_modulus_log = log;
+           })
+      .def("set_optimizer_cost_table",
+           [](CompilationOptions &options, std::string costTable) {
+             // The config only points to the path, which is kept alive by
+             // the set for the whole process.
+             static std::mutex mutex;
+             static std::set<std::string> costTables;
+             std::lock_guard<std::mutex> lock(mutex);
+             options.optimizerConfig.cost_table =
+                 costTables.insert(costTable).first->c_str();
+           })
       .def("set_security_level",
            [](CompilationOptions &options, int security_level) {
              options.optimizerConfig.security = security_level;
@@ -800,6 +1113,50 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
       .def("set_print_tlu_fusing",
            [](CompilationOptions &options, bool printTluFusing) {
              options.printTluFusing = printTluFusing;
+           })
+      .def("set_auto_rounding",
+           [](CompilationOptions &options, bool enableAutoRounding) {
+             options.enableAutoRounding = enableAutoRounding;
+           })
+      .def("set_auto_rounding_max_error",
+           [](CompilationOptions &options, uint64_t maxError) {
+             options.autoRoundingMaxError = maxError;
+           })
+      .def("set_single_bootstrap_rounding",
+           [](CompilationOptions &options, bool enable) {
+             options.enableSingleBootstrapRounding = enable;
+           })
+      .def("set_object_cache_dir",
+           [](CompilationOptions &options, std::string objectCacheDir) {
+             options.objectCacheDir = objectCacheDir;
+           })
+      .def("set_library_cache_dir",
+           [](CompilationOptions &options, std::string libraryCacheDir) {
+             options.libraryCacheDir = libraryCacheDir;
+           })
+      .def("set_codegen_threads",
+           [](CompilationOptions &options, unsigned threads) {
+             options.codegenThreads = threads;
+           })
+      .def("set_codegen_max_optimized_size",
+           [](CompilationOptions &options, uint64_t size) {
+             options.codegenMaxOptimizedSize = size;
+           })
+      .def("set_prediction_cost_table",
+           [](CompilationOptions &options, std::string costTable) {
+             options.predictionCostTable = costTable;
+           })
+      .def("set_prediction_workers",
+           [](CompilationOptions &options, uint64_t workers) {
+             options.predictionWorkers = workers;
+           })
+      .def("set_analyze_noise",
+           [](CompilationOptions &options, bool analyzeNoise) {
+             options.analyzeNoise = analyzeNoise;
+           })
+      .def("set_runtime_bitcode",
+           [](CompilationOptions &options, std::string bitcodePath) {
+             options.runtimeBitcode = bitcodePath;
            });
 
   pybind11::enum_<mlir::concretelang::PrimitiveOperation>(m,
@@ -829,7 +1186,8 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
       .def_readonly("operation", &mlir::concretelang::Statistic::operation)
       .def_readonly("location", &mlir::concretelang::Statistic::location)
       .def_readonly("keys", &mlir::concretelang::Statistic::keys)
-      .def_readonly("count", &mlir::concretelang::Statistic::count);
+      .def_readonly("count", &mlir::concretelang::Statistic::count)
+      .def_readonly("depth", &mlir::concretelang::Statistic::depth);
 
   pybind11::class_<mlir::concretelang::ProgramCompilationFeedback>(
       m, "ProgramCompilationFeedback")
@@ -849,6 +1207,9 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
       .def_readonly("total_keyswitch_keys_size",
                     &mlir::concretelang::ProgramCompilationFeedback::
                         totalKeyswitchKeysSize)
+      .def_readonly("integer_representation",
+                    &mlir::concretelang::ProgramCompilationFeedback::
+                        integerRepresentation)
       .def_readonly(
           "circuit_feedbacks",
           &mlir::concretelang::ProgramCompilationFeedback::circuitFeedbacks);
@@ -870,7 +1231,16 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
                     &mlir::concretelang::CircuitCompilationFeedback::statistics)
       .def_readonly(
           "memory_usage_per_location",
-          &mlir::concretelang::CircuitCompilationFeedback::memoryUsagePerLoc);
+          &mlir::concretelang::CircuitCompilationFeedback::memoryUsagePerLoc)
+      .def_readonly(
+          "predicted_latency",
+          &mlir::concretelang::CircuitCompilationFeedback::predictedLatency)
+      .def_readonly(
+          "predicted_throughput",
+          &mlir::concretelang::CircuitCompilationFeedback::predictedThroughput)
+      .def_readonly("output_error_probabilities",
+                    &mlir::concretelang::CircuitCompilationFeedback::
+                        outputErrorProbabilities);
 
   pybind11::class_<mlir::concretelang::CompilationContext,
                    std::shared_ptr<mlir::concretelang::CompilationContext>>(
@@ -1177,6 +1547,17 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
                         keySetUnserialize(buffer);
                     return result;
                   })
+      .def_static(
+          "load",
+          [](std::string path) {
+            pybind11::gil_scoped_release release;
+            GET_OR_THROW_RESULT(auto keyset,
+                                concretelang::keysets::Keyset::load(path));
+            return std::make_unique<::concretelang::clientlib::KeySet>(
+                ::concretelang::clientlib::KeySet{keyset});
+          },
+          "Load a keyset from a file, without copying it in memory.",
+          pybind11::arg("path"))
       .def("serialize",
            [](::concretelang::clientlib::KeySet &keySet) {
              return pybind11::bytes(keySetSerialize(keySet));
@@ -1197,7 +1578,19 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
           "serialize",
           [](const ::concretelang::clientlib::SharedScalarOrTensorData &value) {
             return pybind11::bytes(valueSerialize(value));
-          });
+          })
+      .def_static("deserialize_at_rest",
+                  [](const pybind11::bytes &buffer) {
+                    return valueUnserializeAtRest(buffer);
+                  })
+      .def(
+          "serialize_at_rest",
+          [](const ::concretelang::clientlib::SharedScalarOrTensorData &value,
+             uint32_t compressedModulusLog) {
+            return pybind11::bytes(
+                valueSerializeAtRest(value, compressedModulusLog));
+          },
+          pybind11::arg("compressed_modulus_log") = 0);
 
   pybind11::class_<ServerProgram>(m, "ServerProgram")
       .def_static("load",
@@ -1215,7 +1608,45 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
                                     const std::string &circuitName) {
         GET_OR_THROW_RESULT(auto result, program.getServerCircuit(circuitName));
         return result;
-      });
+      })
+      .def("warm_up_keyset",
+           [](ServerProgram &program,
+              ::concretelang::clientlib::EvaluationKeys &evaluationKeys) {
+             pybind11::gil_scoped_release release;
+             auto maybeError = program.warmUpKeyset(evaluationKeys.keyset);
+             if (maybeError.has_failure()) {
+               throw std::runtime_error(maybeError.as_failure().error().mesg);
+             }
+           })
+      .def(
+          "set_device_settings",
+          [](ServerProgram &program, std::vector<int32_t> devices,
+             uint64_t memoryLimit, uint64_t batchSize) {
+            mlir::concretelang::DeviceSettings settings;
+            settings.devices = devices;
+            settings.memoryLimit = memoryLimit;
+            settings.batchSize = batchSize;
+            program.setDeviceSettings(settings);
+          },
+          pybind11::arg("devices"), pybind11::arg("memory_limit") = 0,
+          pybind11::arg("batch_size") = 0)
+      .def(
+          "call_graph",
+          [](ServerProgram &program, pybind11::list stages,
+             pybind11::list outputs,
+             ::concretelang::clientlib::PublicArguments &publicArguments,
+             ::concretelang::clientlib::EvaluationKeys *evaluationKeys,
+             size_t maxThreads, std::optional<pybind11::function> onOutput) {
+            SignalGuard signalGuard;
+            return callGraph(program, stages, outputs, publicArguments,
+                             evaluationKeys ? &evaluationKeys->keyset : nullptr,
+                             maxThreads, onOutput);
+          },
+          pybind11::arg("stages"), pybind11::arg("outputs"),
+          pybind11::arg("public_arguments"),
+          pybind11::arg("evaluation_keys") = nullptr,
+          pybind11::arg("max_threads") = 0,
+          pybind11::arg("on_output") = pybind11::none());
 
   pybind11::class_<ServerCircuit>(m, "ServerCircuit")
       .def("call",
@@ -1223,23 +1654,128 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
               ::concretelang::clientlib::PublicArguments &publicArguments,
               ::concretelang::clientlib::EvaluationKeys &evaluationKeys) {
              SignalGuard signalGuard;
-             auto keyset = evaluationKeys.keyset;
-             auto values = publicArguments.values;
-             GET_OR_THROW_RESULT(auto output, circuit.call(keyset, values));
+             pybind11::gil_scoped_release release;
+             GET_OR_THROW_RESULT(auto output,
+                                 circuit.call(evaluationKeys.keyset,
+                                              publicArguments.values));
              ::concretelang::clientlib::PublicResult res{output};
              return std::make_unique<::concretelang::clientlib::PublicResult>(
                  std::move(res));
            })
+      .def(
+          "call_batch",
+          [](ServerCircuit &circuit, pybind11::list batch,
+             ::concretelang::clientlib::EvaluationKeys &evaluationKeys,
+             size_t maxThreads) {
+            SignalGuard signalGuard;
+            return callBatch(circuit, batch, &evaluationKeys.keyset,
+                             maxThreads);
+          },
+          pybind11::arg("batch"), pybind11::arg("evaluation_keys"),
+          pybind11::arg("max_threads") = 0)
+      .def("call_async",
+           [](ServerCircuit &circuit,
+              ::concretelang::clientlib::PublicArguments &publicArguments,
+              ::concretelang::clientlib::EvaluationKeys &evaluationKeys,
+              pybind11::function done) {
+             // The callback is released by a thread of the executor, which
+             // must hold the GIL to do so.
+             std::shared_ptr<pybind11::function> callback(
+                 new pybind11::function(std::move(done)),
+                 [](pybind11::function *f) {
+                   pybind11::gil_scoped_acquire acquire;
+                   delete f;
+                 });
+             // The arguments are copied as the call outlives the Python
+             // objects, the keyset being copied by callAsync itself.
+             auto values = publicArguments.values;
+             pybind11::gil_scoped_release release;
+             circuit.callAsync(
+                 evaluationKeys.keyset, std::move(values),
+                 [callback](auto output) {
+                   pybind11::gil_scoped_acquire acquire;
+                   if (output.has_failure()) {
+                     (*callback)(pybind11::none(),
+                                 output.as_failure().error().mesg);
+                     return;
+                   }
+                   ::concretelang::clientlib::PublicResult res{output.value()};
+                   (*callback)(
+                       std::make_unique<
+                           ::concretelang::clientlib::PublicResult>(
+                           std::move(res)),
+                       pybind11::none());
+                 });
+           })
       .def("simulate",
            [](ServerCircuit &circuit,
               ::concretelang::clientlib::PublicArguments &publicArguments) {
              pybind11::gil_scoped_release release;
-             auto values = publicArguments.values;
-             GET_OR_THROW_RESULT(auto output, circuit.simulate(values));
+             GET_OR_THROW_RESULT(auto output,
+                                 circuit.simulate(publicArguments.values));
              ::concretelang::clientlib::PublicResult res{output};
              return std::make_unique<::concretelang::clientlib::PublicResult>(
                  std::move(res));
-           });
+           })
+      .def(
+          "simulate_batch",
+          [](ServerCircuit &circuit, pybind11::list batch, size_t maxThreads) {
+            return callBatch(circuit, batch, nullptr, maxThreads);
+          },
+          pybind11::arg("batch"), pybind11::arg("max_threads") = 0)
+      .def_static("record_runtime_statistics",
+                  &ServerCircuit::recordRuntimeStatistics,
+                  pybind11::arg("enabled"), pybind11::arg("trace") = false)
+      .def_static("runtime_statistics",
+                  []() {
+                    pybind11::dict statistics;
+                    for (auto &entry : ServerCircuit::runtimeStatistics()) {
+                      pybind11::dict primitive;
+                      primitive["calls"] = entry.second.calls;
+                      primitive["total_ns"] = entry.second.total_ns;
+                      primitive["max_ns"] = entry.second.max_ns;
+                      statistics[entry.first.c_str()] = primitive;
+                    }
+                    return statistics;
+                  })
+      .def_static("reset_runtime_statistics",
+                  &ServerCircuit::resetRuntimeStatistics)
+      .def_static("take_runtime_trace", &ServerCircuit::takeRuntimeTrace)
+      .def_static("runtime_cost_table", &ServerCircuit::runtimeCostTable)
+      .def_static("memory_usage",
+                  []() {
+                    pybind11::dict usage;
+                    for (auto &entry : ServerCircuit::memoryUsage()) {
+                      pybind11::dict category;
+                      category["live_bytes"] = entry.second.live_bytes;
+                      category["peak_bytes"] = entry.second.peak_bytes;
+                      usage[entry.first.c_str()] = category;
+                    }
+                    return usage;
+                  })
+      .def_static("reset_memory_peaks", &ServerCircuit::resetMemoryPeaks)
+      .def_static("set_memory_limit", &ServerCircuit::setMemoryLimit,
+                  pybind11::arg("bytes"))
+      .def_static("dataflow_statistics",
+                  []() {
+                    auto stats = ServerCircuit::dataflowStatistics();
+                    pybind11::dict statistics;
+                    statistics["tasks_created"] = stats.tasks_created;
+                    statistics["tasks_executed"] = stats.tasks_executed;
+                    statistics["node_tasks"] = stats.node_tasks;
+                    statistics["node_bytes_sent"] = stats.node_bytes_sent;
+                    statistics["bytes_received"] = stats.bytes_received;
+                    statistics["key_fetches"] = stats.key_fetches;
+                    statistics["key_fetch_total_ns"] = stats.key_fetch_total_ns;
+                    statistics["key_fetch_max_ns"] = stats.key_fetch_max_ns;
+                    statistics["pending_threads"] = stats.pending_threads;
+                    statistics["compute_ns"] = stats.compute_ns;
+                    statistics["worker_busy_ns"] = stats.worker_busy_ns;
+                    return statistics;
+                  })
+      .def_static("reset_dataflow_statistics",
+                  &ServerCircuit::resetDataflowStatistics)
+      .def_static("dataflow_metrics", &ServerCircuit::dataflowMetrics);
 
   pybind11::class_<::concretelang::clientlib::ValueExporter>(m, "ValueExporter")
       .def_static(
@@ -1268,17 +1804,25 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
              return ::concretelang::clientlib::SharedScalarOrTensorData{
                  result.value()};
            })
+      .def("export_batch",
+           [](::concretelang::clientlib::ValueExporter &exporter,
+              size_t position, NumpyInt64Array values,
+              std::vector<int64_t> shape) {
+             SignalGuard signalGuard;
+             return exportBatch(exporter, position, values, shape);
+           })
       .def("export_tensor", [](::concretelang::clientlib::ValueExporter
                                    &exporter,
-                               size_t position, std::vector<int64_t> values,
+                               size_t position, NumpyInt64Array values,
                                std::vector<int64_t> shape) {
         SignalGuard signalGuard;
         std::vector<size_t> dimensions(shape.begin(), shape.end());
+        auto tensor = numpyArrayToTensor(values, dimensions);
         auto info =
             exporter.circuit.getCircuitInfo().asReader().getInputs()[position];
         auto typeTransformer = getPythonTypeTransformer(info);
         auto result = exporter.circuit.prepareInput(
-            typeTransformer({Tensor<int64_t>(values, dimensions)}), position);
+            typeTransformer({std::move(tensor)}), position);
 
         if (result.has_error()) {
           throw std::runtime_error(result.error().mesg);
@@ -1314,17 +1858,25 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
              return ::concretelang::clientlib::SharedScalarOrTensorData{
                  result.value()};
            })
+      .def("export_batch",
+           [](::concretelang::clientlib::SimulatedValueExporter &exporter,
+              size_t position, NumpyInt64Array values,
+              std::vector<int64_t> shape) {
+             SignalGuard signalGuard;
+             return exportBatch(exporter, position, values, shape);
+           })
       .def("export_tensor", [](::concretelang::clientlib::SimulatedValueExporter
                                    &exporter,
-                               size_t position, std::vector<int64_t> values,
+                               size_t position, NumpyInt64Array values,
                                std::vector<int64_t> shape) {
         SignalGuard signalGuard;
         std::vector<size_t> dimensions(shape.begin(), shape.end());
+        auto tensor = numpyArrayToTensor(values, dimensions);
         auto info =
             exporter.circuit.getCircuitInfo().asReader().getInputs()[position];
         auto typeTransformer = getPythonTypeTransformer(info);
         auto result = exporter.circuit.prepareInput(
-            typeTransformer({Tensor<int64_t>(values, dimensions)}), position);
+            typeTransformer({std::move(tensor)}), position);
 
         if (result.has_error()) {
           throw std::runtime_error(result.error().mesg);
@@ -1343,6 +1895,12 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
              const std::string &circuitName) {
             return createValueDecrypter(keySet, clientParameters, circuitName);
           })
+      .def("decrypt_batch",
+           [](::concretelang::clientlib::ValueDecrypter &decrypter,
+              size_t position, pybind11::list values) {
+             SignalGuard signalGuard;
+             return decryptBatch(decrypter, position, values);
+           })
       .def("decrypt",
            [](::concretelang::clientlib::ValueDecrypter &decrypter,
               size_t position,
@@ -1368,6 +1926,12 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
              const std::string &circuitName) {
             return createSimulatedValueDecrypter(clientParameters, circuitName);
           })
+      .def("decrypt_batch",
+           [](::concretelang::clientlib::SimulatedValueDecrypter &decrypter,
+              size_t position, pybind11::list values) {
+             SignalGuard signalGuard;
+             return decryptBatch(decrypter, position, values);
+           })
       .def("decrypt",
            [](::concretelang::clientlib::SimulatedValueDecrypter &decrypter,
               size_t position,
@@ -1441,6 +2005,25 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
                   [](const pybind11::bytes &buffer) {
                     return evaluationKeysUnserialize(buffer);
                   })
+      .def_static(
+          "load",
+          [](std::string path, std::optional<std::string> preparedKeysetPath) {
+            return evaluationKeysLoad(
+                [&]() { return ServerKeyset::load(path); }, preparedKeysetPath);
+          },
+          "Load evaluation keys from a file, without copying it in memory, "
+          "and prepare them with the given prepared keyset if any.",
+          pybind11::arg("path"),
+          pybind11::arg("prepared_keyset_path") = pybind11::none())
+      .def_static(
+          "load_fd",
+          [](int fd, std::optional<std::string> preparedKeysetPath) {
+            return evaluationKeysLoad(
+                [&]() { return ServerKeyset::fromFd(fd); }, preparedKeysetPath);
+          },
+          "Load evaluation keys from an open regular file, see `load`.",
+          pybind11::arg("fd"),
+          pybind11::arg("prepared_keyset_path") = pybind11::none())
       .def("serialize",
            [](::concretelang::clientlib::EvaluationKeys &evaluationKeys) {
              return pybind11::bytes(evaluationKeysSerialize(evaluationKeys));
@@ -1493,6 +2076,14 @@ void mlir::concretelang::python::populateCompilerAPISubmodule(
            [](lambdaArgument &lambda_arg) {
              return lambdaArgumentGetSignedTensorData(lambda_arg);
            })
+      .def("get_tensor_array",
+           [](lambdaArgument &lambda_arg) {
+             return lambdaArgumentGetTensorArray(lambda_arg);
+           })
+      .def("get_signed_tensor_array",
+           [](lambdaArgument &lambda_arg) {
+             return lambdaArgumentGetSignedTensorArray(lambda_arg);
+           })
       .def("get_tensor_shape",
            [](lambdaArgument &lambda_arg) {
              return lambdaArgumentGetTensorDimensions(lambda_arg);
@@ -38,6 +38,7 @@ from .simulated_value_decrypter import SimulatedValueDecrypter
 from .simulated_value_exporter import SimulatedValueExporter
 from .parameter import Parameter
 from .server_program import ServerProgram
+from .server_circuit import ServerCircuit
 
 
 def init_dfr():
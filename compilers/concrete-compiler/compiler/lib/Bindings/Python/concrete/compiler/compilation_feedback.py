@@ -68,6 +68,11 @@ class CircuitCompilationFeedback(WrapperCpp):
         self.memory_usage_per_location = (
             circuit_compilation_feedback.memory_usage_per_location
         )
+        self.predicted_latency = circuit_compilation_feedback.predicted_latency
+        self.predicted_throughput = circuit_compilation_feedback.predicted_throughput
+        self.output_error_probabilities = (
+            circuit_compilation_feedback.output_error_probabilities
+        )
 
         super().__init__(circuit_compilation_feedback)
 
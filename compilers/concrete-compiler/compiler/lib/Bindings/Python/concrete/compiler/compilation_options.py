@@ -126,6 +126,36 @@ class CompilationOptions(WrapperCpp):
             raise TypeError("can't set the option to a non-boolean value")
         self.cpp().set_compress_input_ciphertexts(compress_input_ciphertexts)
 
+    def set_compress_output_ciphertexts(self, compress_output_ciphertexts: bool):
+        """Set option for compression of output ciphertexts.
+
+        Args:
+            compress_output_ciphertexts (bool): whether to turn it on or off
+
+        Raises:
+            TypeError: if the value to set is not boolean
+        """
+        if not isinstance(compress_output_ciphertexts, bool):
+            raise TypeError("can't set the option to a non-boolean value")
+        self.cpp().set_compress_output_ciphertexts(compress_output_ciphertexts)
+
+    def set_bootstrap_grouping_factor(self, grouping_factor: int):
+        """Set the grouping factor of the multi-bit bootstrap keys.
+
+        Args:
+            grouping_factor (int): number of key bits bootstrapped at once, 1 for classical
+                bootstrap keys
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is not positive
+        """
+        if not isinstance(grouping_factor, int):
+            raise TypeError("can't set the bootstrap grouping factor to a non-int value")
+        if grouping_factor < 1:
+            raise ValueError("the bootstrap grouping factor must be positive")
+        self.cpp().set_bootstrap_grouping_factor(grouping_factor)
+
     def set_verify_diagnostics(self, verify_diagnostics: bool):
         """Set option for diagnostics verification.
 
@@ -269,6 +299,76 @@ class CompilationOptions(WrapperCpp):
             raise TypeError("can't set security_level to a non-int value")
         self.cpp().set_security_level(security_level)
 
+    def set_max_evaluation_keys_size(self, size: int):
+        """Set the maximum size of the evaluation keys.
+
+        Args:
+            size (int): maximum size in bytes of all the bootstrap and keyswitch keys, 0 for no
+                maximum
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is negative
+        """
+        if not isinstance(size, int):
+            raise TypeError("can't set the maximum evaluation keys size to a non-int value")
+        if size < 0:
+            raise ValueError("the maximum evaluation keys size can't be negative")
+        self.cpp().set_max_evaluation_keys_size(size)
+
+    def set_latency_workers(self, workers: int):
+        """Set the number of parallel workers on which the optimizer minimizes the latency.
+
+        Args:
+            workers (int): number of cores, or of concurrent GPU bootstraps, running the circuit,
+                0 to minimize the total complexity instead
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is negative
+        """
+        if not isinstance(workers, int):
+            raise TypeError("can't set the latency workers to a non-int value")
+        if workers < 0:
+            raise ValueError("the latency workers can't be negative")
+        self.cpp().set_latency_workers(workers)
+
+    def set_ciphertext_modulus_log(self, log: int):
+        """Set the ciphertext modulus for which the optimizer picks the parameters.
+
+        The parameters optimized for a 32 bits modulus also fit the u32 functions of concrete-cpu,
+        whose keys and ciphertexts are half the size of the 64 bits ones.
+
+        Args:
+            log (int): logarithm of the ciphertext modulus, 32 or 64
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is neither 32 nor 64
+        """
+        if not isinstance(log, int):
+            raise TypeError("can't set the ciphertext modulus log to a non-int value")
+        if log not in (32, 64):
+            raise ValueError("the ciphertext modulus log must be 32 or 64")
+        self.cpp().set_ciphertext_modulus_log(log)
+
+    def set_optimizer_cost_table(self, cost_table: str):
+        """Set the cost table the optimizer picks the parameters with.
+
+        The table is measured on the target backend by the calibrate_cost_model tool of
+        concrete-cpu, or recorded by the runtime while running circuits (see
+        `ServerCircuit.runtime_cost_table`), instead of the analytic cost model of the optimizer.
+
+        Args:
+            cost_table (str): path of the cost table, empty for the analytic cost model
+
+        Raises:
+            TypeError: if the value to set is not str
+        """
+        if not isinstance(cost_table, str):
+            raise TypeError("need to pass a string value")
+        self.cpp().set_optimizer_cost_table(cost_table)
+
     def set_v0_parameter(
         self,
         glwe_dim: int,
@@ -481,3 +581,184 @@ class CompilationOptions(WrapperCpp):
         if not isinstance(print_tlu_fusing, bool):
             raise TypeError("need to pass a boolean value")
         self.cpp().set_print_tlu_fusing(print_tlu_fusing)
+
+    def set_auto_rounding(self, auto_rounding: bool):
+        """Enable or disable rounding the inputs of the table lookups to a lower precision.
+
+        The inputs are rounded when the table lookup on the rounded input is cheaper, and its
+        results are within the auto rounding max error of the original ones.
+
+        Args:
+            auto_rounding (bool): flag to enable or disable auto rounding
+
+        Raises:
+            TypeError: if the value to set is not bool
+        """
+        if not isinstance(auto_rounding, bool):
+            raise TypeError("need to pass a boolean value")
+        self.cpp().set_auto_rounding(auto_rounding)
+
+    def set_auto_rounding_max_error(self, max_error: int):
+        """Set the maximum error on the results of a table lookup with a rounded input.
+
+        Args:
+            max_error (int): maximum absolute error, 0 to keep the results exact
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is negative
+        """
+        if not isinstance(max_error, int):
+            raise TypeError("can't set the auto rounding max error to a non-int value")
+        if max_error < 0:
+            raise ValueError("the auto rounding max error can't be negative")
+        self.cpp().set_auto_rounding_max_error(max_error)
+
+    def set_single_bootstrap_rounding(self, single_bootstrap_rounding: bool):
+        """Enable or disable rounding with a single table lookup on the input precision.
+
+        A rounding is replaced by the table lookup, composed with the table lookup using it if
+        any, when it is cheaper than truncating its bits one by one.
+
+        Args:
+            single_bootstrap_rounding (bool): flag to enable or disable single bootstrap rounding
+
+        Raises:
+            TypeError: if the value to set is not bool
+        """
+        if not isinstance(single_bootstrap_rounding, bool):
+            raise TypeError("need to pass a boolean value")
+        self.cpp().set_single_bootstrap_rounding(single_bootstrap_rounding)
+
+    def set_object_cache_dir(self, object_cache_dir: str):
+        """Set the directory caching the objects of the compiled functions.
+
+        The unchanged functions of a recompiled module reuse their objects instead of being compiled
+        again.
+
+        Args:
+            object_cache_dir (str): path of the directory, empty to disable the cache
+
+        Raises:
+            TypeError: if the value to set is not str
+        """
+        if not isinstance(object_cache_dir, str):
+            raise TypeError("need to pass a string value")
+        self.cpp().set_object_cache_dir(object_cache_dir)
+
+    def set_library_cache_dir(self, library_cache_dir: str):
+        """Set the directory caching the artifacts of the compiled libraries.
+
+        They are keyed by the hash of the source, of the options and of the build of the compiler,
+        the compilation of a cached library only copying its artifacts to the output directory.
+
+        Args:
+            library_cache_dir (str): path of the directory, empty to disable the cache
+
+        Raises:
+            TypeError: if the value to set is not str
+        """
+        if not isinstance(library_cache_dir, str):
+            raise TypeError("need to pass a string value")
+        self.cpp().set_library_cache_dir(library_cache_dir)
+
+    def set_codegen_threads(self, threads: int):
+        """Set the number of threads compiling the functions of the LLVM module in parallel.
+
+        Args:
+            threads (int): number of threads, 0 for all the cores
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is negative
+        """
+        if not isinstance(threads, int):
+            raise TypeError("can't set the codegen threads to a non-int value")
+        if threads < 0:
+            raise ValueError("the codegen threads can't be negative")
+        self.cpp().set_codegen_threads(threads)
+
+    def set_codegen_max_optimized_size(self, size: int):
+        """Set the size of the largest function compiled with optimization.
+
+        Compiling huge straight-line functions, e.g. from fully unrolled circuits, without
+        optimization saves most of their compilation time.
+
+        Args:
+            size (int): maximum number of LLVM instructions, 0 for no maximum
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is negative
+        """
+        if not isinstance(size, int):
+            raise TypeError("can't set the codegen max optimized size to a non-int value")
+        if size < 0:
+            raise ValueError("the codegen max optimized size can't be negative")
+        self.cpp().set_codegen_max_optimized_size(size)
+
+    def set_prediction_cost_table(self, cost_table: str):
+        """Set the cost table from which the compilation feedback predicts the runtime.
+
+        The table is measured on the target backend by the calibrate_cost_model tool of
+        concrete-cpu, the feedback of each circuit then holding its predicted latency and
+        throughput.
+
+        Args:
+            cost_table (str): path of the cost table, empty for no prediction
+
+        Raises:
+            TypeError: if the value to set is not str
+        """
+        if not isinstance(cost_table, str):
+            raise TypeError("need to pass a string value")
+        self.cpp().set_prediction_cost_table(cost_table)
+
+    def set_prediction_workers(self, workers: int):
+        """Set the number of parallel workers on which the runtime is predicted.
+
+        Args:
+            workers (int): number of cores, or of concurrent GPU bootstraps, running the circuit,
+                0 for all the cores
+
+        Raises:
+            TypeError: if the value to set is not int
+            ValueError: if the value to set is negative
+        """
+        if not isinstance(workers, int):
+            raise TypeError("can't set the prediction workers to a non-int value")
+        if workers < 0:
+            raise ValueError("the prediction workers can't be negative")
+        self.cpp().set_prediction_workers(workers)
+
+    def set_analyze_noise(self, analyze_noise: bool):
+        """Enable or disable the analytic noise analysis of the compilation feedback.
+
+        The noise variances are propagated through the parametrized program, which gives the
+        error probability of each output without running a noisy simulation.
+
+        Args:
+            analyze_noise (bool): whether to fill the error probabilities of the outputs
+
+        Raises:
+            TypeError: if the value to set is not bool
+        """
+        if not isinstance(analyze_noise, bool):
+            raise TypeError("can't set the option to a non-boolean value")
+        self.cpp().set_analyze_noise(analyze_noise)
+
+    def set_runtime_bitcode(self, bitcode_path: str):
+        """Set the bitcode of the runtime wrappers to link in the circuits.
+
+        The wrappers called by the circuits are then inlined in their loops, rather than called
+        in the runtime library. The bitcode is built with CONCRETELANG_RUNTIME_BITCODE.
+
+        Args:
+            bitcode_path (str): path of the bitcode, empty to call the runtime library
+
+        Raises:
+            TypeError: if the value to set is not str
+        """
+        if not isinstance(bitcode_path, str):
+            raise TypeError("need to pass a string value")
+        self.cpp().set_runtime_bitcode(bitcode_path)
@@ -3,6 +3,9 @@
 
 """EvaluationKeys."""
 
+import os
+from typing import Optional, Union
+
 # pylint: disable=no-name-in-module,import-error
 from mlir._mlir_libs._concretelang._compiler import (
     EvaluationKeys as _EvaluationKeys,
@@ -61,3 +64,38 @@ class EvaluationKeys(WrapperCpp):
         return EvaluationKeys.wrap(
             _EvaluationKeys.deserialize(serialized_evaluation_keys)
         )
+
+    @staticmethod
+    def load(
+        file: Union[str, os.PathLike, int],
+        prepared_keyset_path: Optional[Union[str, os.PathLike]] = None,
+    ) -> "EvaluationKeys":
+        """Load serialized EvaluationKeys from a file, without going through bytes.
+
+        The file is mapped and read in place with the GIL released, so the serialized
+        keys are never copied in memory.
+
+        Args:
+            file (Union[str, os.PathLike, int]): path of the file, or file descriptor of
+                an open regular file, holding previously serialized EvaluationKeys
+            prepared_keyset_path (Optional[Union[str, os.PathLike]]): path of the
+                prepared form of the keys, written if missing, to use them as mapped
+                from this file rather than converting them on the first execution
+
+        Raises:
+            TypeError: if file is not a path or a file descriptor
+            RuntimeError: if the keys cannot be loaded
+
+        Returns:
+            EvaluationKeys: loaded object
+        """
+        prepared = None
+        if prepared_keyset_path is not None:
+            prepared = os.fspath(prepared_keyset_path)
+        if isinstance(file, int):
+            return EvaluationKeys.wrap(_EvaluationKeys.load_fd(file, prepared))
+        if not isinstance(file, (str, os.PathLike)):
+            raise TypeError(
+                f"file must be a path or a file descriptor, not {type(file)}"
+            )
+        return EvaluationKeys.wrap(_EvaluationKeys.load(os.fspath(file), prepared))
@@ -7,6 +7,9 @@
 Store for the different keys required for an encrypted computation.
 """
 
+import os
+from typing import Union
+
 # pylint: disable=no-name-in-module,import-error
 from mlir._mlir_libs._concretelang._compiler import (
     KeySet as _KeySet,
@@ -63,6 +66,23 @@ class KeySet(WrapperCpp):
             )
         return KeySet.wrap(_KeySet.deserialize(serialized_key_set))
 
+    @staticmethod
+    def load(path: Union[str, os.PathLike]) -> "KeySet":
+        """Load a serialized KeySet from a file, without going through bytes.
+
+        The file is mapped and read in place with the GIL released.
+
+        Args:
+            path (Union[str, os.PathLike]): path of a previously serialized KeySet
+
+        Raises:
+            RuntimeError: if the keyset cannot be loaded
+
+        Returns:
+            KeySet: loaded object
+        """
+        return KeySet.wrap(_KeySet.load(os.fspath(path)))
+
     def get_evaluation_keys(self) -> EvaluationKeys:
         """
         Get evaluation keys for execution.
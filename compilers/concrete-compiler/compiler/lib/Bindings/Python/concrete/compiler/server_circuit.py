@@ -3,6 +3,9 @@
 
 """ServerCircuit."""
 
+import asyncio
+from typing import Dict, List, Union
+
 # pylint: disable=no-name-in-module,import-error
 from mlir._mlir_libs._concretelang._compiler import (
     ServerCircuit as _ServerCircuit,
@@ -65,6 +68,97 @@ class ServerCircuit(WrapperCpp):
             self.cpp().call(public_arguments.cpp(), evaluation_keys.cpp())
         )
 
+    def call_batch(
+        self,
+        batch: List[PublicArguments],
+        evaluation_keys: EvaluationKeys,
+        max_threads: int = 0,
+    ) -> List[PublicResult]:
+        """Executes the circuit on a batch of independent public arguments.
+
+        The calls run in parallel in the runtime and share the runtime context of the keys.
+
+        Args:
+            batch (List[PublicArguments]): public arguments of each call
+            evaluation_keys (EvaluationKeys): evaluation keys to use for execution.
+            max_threads (int): maximum number of threads to use, all the hardware ones if 0
+
+        Raises:
+            TypeError: if an element of batch is not of type PublicArguments, or if
+                evaluation_keys is not of type EvaluationKeys
+
+        Returns:
+            List[PublicResult]: the results of the calls, in the order of the batch.
+        """
+        for public_arguments in batch:
+            if not isinstance(public_arguments, PublicArguments):
+                raise TypeError(
+                    f"public_arguments must be of type PublicArguments, not "
+                    f"{type(public_arguments)}"
+                )
+        if not isinstance(evaluation_keys, EvaluationKeys):
+            raise TypeError(
+                f"simulation must be of type EvaluationKeys, not "
+                f"{type(evaluation_keys)}"
+            )
+        results = self.cpp().call_batch(
+            [public_arguments.cpp() for public_arguments in batch],
+            evaluation_keys.cpp(),
+            max_threads,
+        )
+        return [PublicResult.wrap(result) for result in results]
+
+    async def call_async(
+        self,
+        public_arguments: PublicArguments,
+        evaluation_keys: EvaluationKeys,
+    ) -> PublicResult:
+        """Executes the circuit on the public arguments, without blocking the event loop.
+
+        The execution runs on the thread pool of the runtime, so that many calls can be in
+        flight in a single event loop.
+
+        Args:
+            public_arguments (PublicArguments): public arguments to execute on
+            execution_keys (EvaluationKeys): evaluation keys to use for execution.
+
+        Raises:
+            TypeError: if public_arguments is not of type PublicArguments, or if evaluation_keys is
+                not of type EvaluationKeys
+            RuntimeError: if the execution fails
+
+        Returns:
+            PublicResult: A public result object containing the results.
+        """
+        if not isinstance(public_arguments, PublicArguments):
+            raise TypeError(
+                f"public_arguments must be of type PublicArguments, not "
+                f"{type(public_arguments)}"
+            )
+        if not isinstance(evaluation_keys, EvaluationKeys):
+            raise TypeError(
+                f"simulation must be of type EvaluationKeys, not "
+                f"{type(evaluation_keys)}"
+            )
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+
+        def resolve(result, error):
+            # The awaiting task may have been cancelled in the meantime
+            if future.done():
+                return
+            if error is not None:
+                future.set_exception(RuntimeError(error))
+            else:
+                future.set_result(PublicResult.wrap(result))
+
+        def done(result, error):
+            # Invoked from a thread of the runtime
+            loop.call_soon_threadsafe(resolve, result, error)
+
+        self.cpp().call_async(public_arguments.cpp(), evaluation_keys.cpp(), done)
+        return await future
+
     def simulate(
         self,
         public_arguments: PublicArguments,
@@ -86,3 +180,130 @@ class ServerCircuit(WrapperCpp):
                 f"{type(public_arguments)}"
             )
         return PublicResult.wrap(self.cpp().simulate(public_arguments.cpp()))
+
+    def simulate_batch(
+        self,
+        batch: List[PublicArguments],
+        max_threads: int = 0,
+    ) -> List[PublicResult]:
+        """Simulates the circuit on a batch of independent public arguments, in parallel.
+
+        Args:
+            batch (List[PublicArguments]): public arguments of each call
+            max_threads (int): maximum number of threads to use, all the hardware ones if 0
+
+        Raises:
+            TypeError: if an element of batch is not of type PublicArguments
+
+        Returns:
+            List[PublicResult]: the results of the calls, in the order of the batch.
+        """
+        for public_arguments in batch:
+            if not isinstance(public_arguments, PublicArguments):
+                raise TypeError(
+                    f"public_arguments must be of type PublicArguments, not "
+                    f"{type(public_arguments)}"
+                )
+        results = self.cpp().simulate_batch(
+            [public_arguments.cpp() for public_arguments in batch], max_threads
+        )
+        return [PublicResult.wrap(result) for result in results]
+
+    @staticmethod
+    def record_runtime_statistics(enabled: bool, trace: bool = False):
+        """Starts or stops recording the calls of the runtime primitives of all the circuits.
+
+        The recording is off by default, and then costs next to nothing.
+
+        Args:
+            enabled (bool): whether to record the calls
+            trace (bool): whether to also keep each call as a trace event
+        """
+        _ServerCircuit.record_runtime_statistics(enabled, trace)
+
+    @staticmethod
+    def runtime_statistics() -> Dict[str, Dict[str, int]]:
+        """Returns the statistics of the runtime primitives recorded so far.
+
+        Returns:
+            Dict[str, Dict[str, int]]: the number of calls ("calls"), and their total ("total_ns")
+                and maximum ("max_ns") durations in nanoseconds, by primitive name.
+        """
+        return _ServerCircuit.runtime_statistics()
+
+    @staticmethod
+    def reset_runtime_statistics():
+        """Forgets the statistics and the trace events recorded so far."""
+        _ServerCircuit.reset_runtime_statistics()
+
+    @staticmethod
+    def take_runtime_trace() -> str:
+        """Returns the trace events recorded since the last call, and forgets them.
+
+        Returns:
+            str: the events in the Chrome trace event format, which Perfetto reads too.
+        """
+        return _ServerCircuit.take_runtime_trace()
+
+    @staticmethod
+    def runtime_cost_table() -> str:
+        """Returns the mean time per ciphertext of the recorded keyswitches and bootstraps.
+
+        Returns:
+            str: the times by parameters, as a cost table for the optimizer of the next
+                compilations.
+        """
+        return _ServerCircuit.runtime_cost_table()
+
+    @staticmethod
+    def memory_usage() -> Dict[str, Dict[str, int]]:
+        """Returns the memory accounted by the runtime.
+
+        Returns:
+            Dict[str, Dict[str, int]]: the live ("live_bytes") and peak ("peak_bytes") bytes of
+                the keys, the ciphertexts, the scratch and the device keys, by category name.
+        """
+        return _ServerCircuit.memory_usage()
+
+    @staticmethod
+    def reset_memory_peaks():
+        """Sets the peak bytes of each category to its live bytes."""
+        _ServerCircuit.reset_memory_peaks()
+
+    @staticmethod
+    def set_memory_limit(limit: int):
+        """Limits the host memory accounted by the runtime.
+
+        A call whose arguments do not fit in the limit fails, and the process aborts if an
+        allocation made during a call exceeds it.
+
+        Args:
+            limit (int): the limit in bytes, or 0 to remove it
+        """
+        _ServerCircuit.set_memory_limit(limit)
+
+    @staticmethod
+    def dataflow_statistics() -> Dict[str, Union[int, List[int]]]:
+        """Returns the counters of the dataflow runtime on this node.
+
+        Returns:
+            Dict[str, Union[int, List[int]]]: the tasks created and executed, the tasks and input
+                bytes sent to each node, the input bytes received, the key fetches and their
+                latencies, the threads waiting for a worker, the time spent in the computation
+                phases and the time spent executing tasks by each worker thread.
+        """
+        return _ServerCircuit.dataflow_statistics()
+
+    @staticmethod
+    def reset_dataflow_statistics():
+        """Sets the counters of the dataflow runtime on this node to 0."""
+        _ServerCircuit.reset_dataflow_statistics()
+
+    @staticmethod
+    def dataflow_metrics() -> str:
+        """Returns the counters of the dataflow runtime on this node.
+
+        Returns:
+            str: the counters in the Prometheus text exposition format.
+        """
+        return _ServerCircuit.dataflow_metrics()
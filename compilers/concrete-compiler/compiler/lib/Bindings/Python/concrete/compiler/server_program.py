@@ -3,6 +3,8 @@
 
 """ServerProgram."""
 
+from typing import Callable, List, Optional, Tuple, Union
+
 # pylint: disable=no-name-in-module,import-error
 from mlir._mlir_libs._concretelang._compiler import (
     ServerProgram as _ServerProgram,
@@ -10,8 +12,12 @@ from mlir._mlir_libs._concretelang._compiler import (
 
 # pylint: enable=no-name-in-module,import-error
 from .wrapper import WrapperCpp
+from .evaluation_keys import EvaluationKeys
 from .library_support import LibrarySupport
+from .public_arguments import PublicArguments
+from .public_result import PublicResult
 from .server_circuit import ServerCircuit
+from .value import Value
 
 
 class ServerProgram(WrapperCpp):
@@ -78,3 +84,99 @@ class ServerProgram(WrapperCpp):
             )
 
         return ServerCircuit.wrap(self.cpp().get_server_circuit(circuit_name))
+
+    def warm_up_keyset(self, evaluation_keys: EvaluationKeys):
+        """Prepares the evaluation keys for the next calls of all the circuits.
+
+        Args:
+            evaluation_keys (EvaluationKeys): evaluation keys to prepare
+
+        Raises:
+            TypeError: if evaluation_keys is not of type EvaluationKeys
+        """
+        if not isinstance(evaluation_keys, EvaluationKeys):
+            raise TypeError(
+                f"evaluation_keys must be of type EvaluationKeys, not "
+                f"{type(evaluation_keys)}"
+            )
+        self.cpp().warm_up_keyset(evaluation_keys.cpp())
+
+    def set_device_settings(
+        self,
+        devices: List[int],
+        memory_limit: int = 0,
+        batch_size: int = 0,
+    ):
+        """Sets how the GPU runtime uses the devices for the next calls of the circuits.
+
+        The circuits retrieved before keep their previous settings.
+
+        Args:
+            devices (List[int]): devices to schedule on, all of them if empty
+            memory_limit (int): bytes of device memory to size the chunks of the
+                computations for, the free memory of the device if 0
+            batch_size (int): maximum number of samples of a chunk sent to a device,
+                as many as fit in memory if 0
+        """
+        self.cpp().set_device_settings(devices, memory_limit, batch_size)
+
+    def call_graph(
+        self,
+        stages: List[Tuple[str, List[Union[int, Tuple[int, int]]]]],
+        outputs: List[Union[int, Tuple[int, int]]],
+        public_arguments: PublicArguments,
+        evaluation_keys: Optional[EvaluationKeys] = None,
+        max_threads: int = 0,
+        on_output: Optional[Callable[[int, Value], None]] = None,
+    ) -> PublicResult:
+        """Calls a chain of circuits, their intermediate values staying in the runtime.
+
+        The value of an argument of a stage, or of an output, is given by its source: the
+        argument of the graph at an index, or the return (stage, index) of an earlier stage.
+
+        Args:
+            stages (List[Tuple[str, List[Union[int, Tuple[int, int]]]]]): circuit and sources
+                of the arguments of each stage
+            outputs (List[Union[int, Tuple[int, int]]]): sources of the outputs, all the
+                returns of the last stage if empty
+            public_arguments (PublicArguments): arguments of the graph
+            evaluation_keys (Optional[EvaluationKeys]): evaluation keys to use for execution,
+                None for simulation
+            max_threads (int): maximum number of threads to use, all the hardware ones if 0
+            on_output (Optional[Callable[[int, Value], None]]): called with the index and the
+                value of each output as soon as the stage computing it finishes, never
+                concurrently
+
+        Raises:
+            TypeError: if public_arguments is not of type PublicArguments, or if
+                evaluation_keys is not of type EvaluationKeys
+
+        Returns:
+            PublicResult: the outputs of the graph.
+        """
+        if not isinstance(public_arguments, PublicArguments):
+            raise TypeError(
+                f"public_arguments must be of type PublicArguments, not "
+                f"{type(public_arguments)}"
+            )
+        if evaluation_keys is not None and not isinstance(
+            evaluation_keys, EvaluationKeys
+        ):
+            raise TypeError(
+                f"evaluation_keys must be of type EvaluationKeys, not "
+                f"{type(evaluation_keys)}"
+            )
+        return PublicResult.wrap(
+            self.cpp().call_graph(
+                stages,
+                outputs,
+                public_arguments.cpp(),
+                evaluation_keys.cpp() if evaluation_keys is not None else None,
+                max_threads,
+                (
+                    (lambda index, value: on_output(index, Value(value)))
+                    if on_output is not None
+                    else None
+                ),
+            )
+        )
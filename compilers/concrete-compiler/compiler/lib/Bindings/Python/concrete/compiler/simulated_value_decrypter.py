@@ -2,7 +2,7 @@
 
 # pylint: disable=no-name-in-module,import-error
 
-from typing import Union
+from typing import List, Union
 
 import numpy as np
 from mlir._mlir_libs._concretelang._compiler import (
@@ -65,16 +65,41 @@ class SimulatedValueDecrypter(WrapperCpp):
                 decrypted value
         """
 
-        lambda_arg = self.cpp().decrypt(position, value.cpp())
-        is_signed = lambda_arg.is_signed()
-        if lambda_arg.is_scalar():
-            return (
-                lambda_arg.get_signed_scalar() if is_signed else lambda_arg.get_scalar()
-            )
+        return _to_python(self.cpp().decrypt(position, value.cpp()))
+
+    def decrypt_batch(
+        self, position: int, values: List[Value]
+    ) -> List[Union[int, np.ndarray]]:
+        """
+        Decrypt values of the same output, in parallel.
+
+        Args:
+            position (int):
+                position of the output within the circuit
+
+            values (List[Value]):
+                values to decrypt
 
-        shape = lambda_arg.get_tensor_shape()
-        return (
-            np.array(lambda_arg.get_signed_tensor_data()).reshape(shape)
-            if is_signed
-            else np.array(lambda_arg.get_tensor_data()).reshape(shape)
+        Returns:
+            List[Union[int, np.ndarray]]:
+                decrypted values, in the order of `values`
+        """
+
+        lambda_args = self.cpp().decrypt_batch(
+            position, [value.cpp() for value in values]
         )
+        return [_to_python(lambda_arg) for lambda_arg in lambda_args]
+
+
+def _to_python(lambda_arg) -> Union[int, np.ndarray]:
+    """Convert a decrypted lambda argument to a python integer or a numpy array."""
+
+    is_signed = lambda_arg.is_signed()
+    if lambda_arg.is_scalar():
+        return lambda_arg.get_signed_scalar() if is_signed else lambda_arg.get_scalar()
+
+    return (
+        lambda_arg.get_signed_tensor_array()
+        if is_signed
+        else lambda_arg.get_tensor_array()
+    )
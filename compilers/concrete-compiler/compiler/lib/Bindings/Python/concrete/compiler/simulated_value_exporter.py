@@ -2,7 +2,9 @@
 
 # pylint: disable=no-name-in-module,import-error
 
-from typing import List
+from typing import List, Union
+
+import numpy as np
 
 from mlir._mlir_libs._concretelang._compiler import (
     SimulatedValueExporter as _SimulatedValueExporter,
@@ -69,7 +71,7 @@ class SimulatedValueExporter(WrapperCpp):
         return Value(self.cpp().export_scalar(position, value))
 
     def export_tensor(
-        self, position: int, values: List[int], shape: List[int]
+        self, position: int, values: Union[np.ndarray, List[int]], shape: List[int]
     ) -> Value:
         """
         Export tensor.
@@ -78,8 +80,9 @@ class SimulatedValueExporter(WrapperCpp):
             position (int):
                 position of the argument within the circuit
 
-            values (List[int]):
-                tensor elements to export
+            values (Union[np.ndarray, List[int]]):
+                tensor elements to export, a numpy array being read in place
+                without going through a list
 
             shape (List[int]):
                 tensor shape to export
@@ -90,3 +93,28 @@ class SimulatedValueExporter(WrapperCpp):
         """
 
         return Value(self.cpp().export_tensor(position, values, shape))
+
+    def export_batch(
+        self, position: int, values: np.ndarray, shape: List[int]
+    ) -> List[Value]:
+        """
+        Export samples of the same argument, stacked along the first dimension.
+
+        Args:
+            position (int):
+                position of the argument within the circuit
+
+            values (np.ndarray):
+                samples to export, of shape `[batch_size] + shape`
+
+            shape (List[int]):
+                shape of a sample, empty for scalars
+
+        Returns:
+            List[Value]:
+                exported samples, in the order of `values`
+        """
+
+        return [
+            Value(value) for value in self.cpp().export_batch(position, values, shape)
+        ]
@@ -86,10 +86,11 @@ Result<TransportValue> ClientCircuit::prepareInput(Value arg, size_t pos) {
   if (pos >= inputTransformers.size()) {
     return StringError("Tried to prepare a Value for incorrect position.");
   }
-  return inputTransformers[pos](arg);
+  return inputTransformers[pos](std::move(arg));
 }
 
-Result<Value> ClientCircuit::processOutput(TransportValue result, size_t pos) {
+Result<Value> ClientCircuit::processOutput(const TransportValue &result,
+                                           size_t pos) {
   if (pos >= outputTransformers.size()) {
     return StringError(
         "Tried to process a TransportValue for incorrect position.");
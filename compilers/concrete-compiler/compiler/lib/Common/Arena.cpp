@@ -0,0 +1,88 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Common/Arena.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace concretelang {
+namespace values {
+
+namespace {
+const size_t min_chunk_size = 1 << 20;
+
+thread_local Arena thread_arena;
+thread_local bool thread_arena_active = false;
+} // namespace
+
+Arena::~Arena() {
+  for (auto &chunk : chunks)
+    free(chunk.data);
+}
+
+void *Arena::allocate(size_t size, size_t alignment) {
+  assert((alignment & (alignment - 1)) == 0);
+  if (!chunks.empty()) {
+    auto &chunk = chunks.back();
+    uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+    size_t start = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (start + size <= chunk.size) {
+      offset = start + size;
+      return memset(chunk.data + start, 0, size);
+    }
+  }
+  // Growing geometrically keeps the number of chunks of a call logarithmic
+  size_t chunkSize = std::max(size + alignment, min_chunk_size);
+  if (!chunks.empty())
+    chunkSize = std::max(chunkSize, 2 * chunks.back().size);
+  char *data = static_cast<char *>(malloc(chunkSize));
+  if (data == nullptr)
+    abort();
+  chunks.push_back({data, chunkSize});
+  offset = 0;
+  return allocate(size, alignment);
+}
+
+void Arena::reset() {
+  offset = 0;
+  if (chunks.size() <= 1)
+    return;
+  size_t size = capacity();
+  for (auto &chunk : chunks)
+    free(chunk.data);
+  chunks.clear();
+  char *data = static_cast<char *>(malloc(size));
+  if (data == nullptr)
+    abort();
+  chunks.push_back({data, size});
+}
+
+size_t Arena::capacity() const {
+  size_t size = 0;
+  for (auto &chunk : chunks)
+    size += chunk.size;
+  return size;
+}
+
+Arena *Arena::current() {
+  return thread_arena_active ? &thread_arena : nullptr;
+}
+
+Arena::Scope::Scope() : outermost(!thread_arena_active) {
+  thread_arena_active = true;
+}
+
+Arena::Scope::~Scope() {
+  if (!outermost)
+    return;
+  thread_arena_active = false;
+  thread_arena.reset();
+}
+
+} // namespace values
+} // namespace concretelang
@@ -62,16 +62,27 @@ int64_t modInverse(int64_t a, int64_t m) {
   return x;
 }
 
+std::vector<uint64_t> iCrtCoefficients(const std::vector<int64_t> &moduli) {
+  uint64_t product = productOfModuli(moduli);
+  std::vector<uint64_t> coefficients;
+  coefficients.reserve(moduli.size());
+  for (auto modulus : moduli) {
+    uint64_t quotient = product / modulus;
+    uint64_t inverse = modInverse(quotient % modulus, modulus);
+    coefficients.push_back((__uint128_t)quotient * inverse % product);
+  }
+  return coefficients;
+}
+
 uint64_t iCrt(std::vector<int64_t> moduli, std::vector<int64_t> remainders) {
   // Compute the product of moduli
-  int64_t product = productOfModuli(moduli);
-
-  int64_t result = 0;
+  uint64_t product = productOfModuli(moduli);
+  auto coefficients = iCrtCoefficients(moduli);
 
   // Apply above formula
+  __uint128_t result = 0;
   for (size_t i = 0; i < remainders.size(); i++) {
-    int tmp = product / moduli[i];
-    result += remainders[i] * modInverse(tmp, moduli[i]) * tmp;
+    result += (__uint128_t)remainders[i] * coefficients[i];
   }
 
   return result % product;
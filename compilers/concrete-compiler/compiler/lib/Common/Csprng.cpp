@@ -103,6 +103,13 @@ EncryptionCSPRNG::~EncryptionCSPRNG() {
   }
 }
 
+EncryptionCSPRNG EncryptionCSPRNG::fork() {
+  auto child = (EncCsprng *)aligned_alloc(ENCRYPTION_CSPRNG_ALIGN,
+                                          ENCRYPTION_CSPRNG_SIZE);
+  concrete_cpu_fork_encryption_csprng(ptr, child);
+  return EncryptionCSPRNG(child);
+}
+
 void writeSeed(struct Uint128 seed, uint64_t *buffer) {
   buffer[0] = (uint64_t)seed.little_endian_bytes[0];
   buffer[0] += (uint64_t)seed.little_endian_bytes[1] << 8;
@@ -64,11 +64,13 @@ LweSecretKey::LweSecretKey(Message<concreteprotocol::LweSecretKeyInfo> info,
 
 LweSecretKey
 LweSecretKey::fromProto(const Message<concreteprotocol::LweSecretKey> &proto) {
+  return fromProto(proto.asReader());
+}
 
-  auto info =
-      Message<concreteprotocol::LweSecretKeyInfo>(proto.asReader().getInfo());
-  auto vector =
-      protoPayloadToSharedVector<uint64_t>(proto.asReader().getPayload());
+LweSecretKey
+LweSecretKey::fromProto(concreteprotocol::LweSecretKey::Reader proto) {
+  auto info = Message<concreteprotocol::LweSecretKeyInfo>(proto.getInfo());
+  auto vector = protoPayloadToSharedVector<uint64_t>(proto.getPayload());
   return LweSecretKey(vector, info);
 }
 
@@ -90,6 +92,21 @@ const std::vector<uint64_t> &LweSecretKey::getBuffer() const {
   return *this->buffer;
 }
 
+void decompressSeededBootstrapKey(
+    const Message<concreteprotocol::LweBootstrapKeyInfo> &info,
+    std::vector<uint64_t> &seededBuffer, std::vector<uint64_t> &buffer) {
+  auto params = info.asReader().getParams();
+  buffer.resize(concrete_cpu_bootstrap_key_size_u64(
+      params.getLevelCount(), params.getGlweDimension(),
+      params.getPolynomialSize(), params.getInputLweDimension()));
+  struct Uint128 seed;
+  readSeed(seed, seededBuffer);
+  concrete_cpu_decompress_seeded_lwe_bootstrap_key_u64(
+      buffer.data(), seededBuffer.data() + 2, params.getInputLweDimension(),
+      params.getPolynomialSize(), params.getGlweDimension(),
+      params.getLevelCount(), params.getBaseLog(), seed, Parallelism::Rayon);
+}
+
 LweBootstrapKey::LweBootstrapKey(
     Message<concreteprotocol::LweBootstrapKeyInfo> info,
     const LweSecretKey &inputKey, const LweSecretKey &outputKey,
@@ -104,6 +121,22 @@ LweBootstrapKey::LweBootstrapKey(
   auto params = info.asReader().getParams();
   auto compression = info.asReader().getCompression();
 
+  if (params.getGroupingFactor() > 1) {
+    assert(compression == concreteprotocol::Compression::NONE &&
+           "Unsupported compression type for multi-bit bootstrap key");
+    buffer->resize(concrete_cpu_multi_bit_bootstrap_key_size_u64(
+        params.getLevelCount(), params.getGlweDimension(),
+        params.getPolynomialSize(), params.getInputLweDimension(),
+        params.getGroupingFactor()));
+    concrete_cpu_init_lwe_multi_bit_bootstrap_key_u64(
+        buffer->data(), inputKey.buffer->data(), outputKey.buffer->data(),
+        params.getInputLweDimension(), params.getPolynomialSize(),
+        params.getGlweDimension(), params.getLevelCount(), params.getBaseLog(),
+        params.getGroupingFactor(), params.getVariance(), Parallelism::Rayon,
+        csprng.ptr);
+    return;
+  }
+
   switch (compression) {
   case concreteprotocol::Compression::NONE:
     buffer->resize(concrete_cpu_bootstrap_key_size_u64(
@@ -138,17 +171,26 @@ LweBootstrapKey::LweBootstrapKey(
 
 LweBootstrapKey LweBootstrapKey::fromProto(
     const Message<concreteprotocol::LweBootstrapKey> &proto) {
-  auto info = Message<concreteprotocol::LweBootstrapKeyInfo>(
-      proto.asReader().getInfo());
-  auto vector =
-      protoPayloadToSharedVector<uint64_t>(proto.asReader().getPayload());
+  return fromProto(proto.asReader());
+}
+
+LweBootstrapKey
+LweBootstrapKey::fromProto(concreteprotocol::LweBootstrapKey::Reader proto) {
+  auto info = Message<concreteprotocol::LweBootstrapKeyInfo>(proto.getInfo());
+  auto vector = protoPayloadToSharedVector<uint64_t>(proto.getPayload());
+  return fromTransportBuffer(vector, info);
+}
+
+LweBootstrapKey LweBootstrapKey::fromTransportBuffer(
+    std::shared_ptr<std::vector<uint64_t>> buffer,
+    Message<concreteprotocol::LweBootstrapKeyInfo> info) {
   LweBootstrapKey key(info);
   switch (info.asReader().getCompression()) {
   case concreteprotocol::Compression::NONE:
-    key.buffer = vector;
+    key.buffer = buffer;
     break;
   case concreteprotocol::Compression::SEED:
-    key.seededBuffer = vector;
+    key.seededBuffer = buffer;
     break;
   default:
     assert(false && "Unsupported compression type for bootstrap key");
@@ -172,7 +214,7 @@ const std::vector<uint64_t> &LweBootstrapKey::getTransportBuffer() const {
   case concreteprotocol::Compression::NONE:
     return *buffer;
   case concreteprotocol::Compression::SEED:
-    assert(!seededBuffer->empty());
+    // Empty for a key not uploaded yet, see ServerKeyset::toProto
     return *seededBuffer;
   default:
     assert(false && "Unsupported compression type for bootstrap key");
@@ -194,16 +236,7 @@ void LweBootstrapKey::decompress() {
     const std::lock_guard<std::mutex> guard(*decompress_mutext);
     if (decompressed)
       return;
-    auto params = info.asReader().getParams();
-    buffer->resize(concrete_cpu_bootstrap_key_size_u64(
-        params.getLevelCount(), params.getGlweDimension(),
-        params.getPolynomialSize(), params.getInputLweDimension()));
-    struct Uint128 seed;
-    readSeed(seed, *seededBuffer);
-    concrete_cpu_decompress_seeded_lwe_bootstrap_key_u64(
-        buffer->data(), seededBuffer->data() + 2, params.getInputLweDimension(),
-        params.getPolynomialSize(), params.getGlweDimension(),
-        params.getLevelCount(), params.getBaseLog(), seed, Parallelism::Rayon);
+    decompressSeededBootstrapKey(info, *seededBuffer, *buffer);
     decompressed = true;
     return;
   }
@@ -212,6 +245,23 @@ void LweBootstrapKey::decompress() {
   }
 }
 
+std::shared_ptr<std::vector<uint64_t>>
+LweBootstrapKey::getTransientBuffer() const {
+  switch (info.asReader().getCompression()) {
+  case concreteprotocol::Compression::NONE:
+    return buffer;
+  case concreteprotocol::Compression::SEED: {
+    if (decompressed)
+      return buffer;
+    auto transient = std::make_shared<std::vector<uint64_t>>();
+    decompressSeededBootstrapKey(info, *seededBuffer, *transient);
+    return transient;
+  }
+  default:
+    assert(false && "Unsupported compression type for bootstrap key");
+  }
+}
+
 LweKeyswitchKey::LweKeyswitchKey(
     Message<concreteprotocol::LweKeyswitchKeyInfo> info,
     const LweSecretKey &inputKey, const LweSecretKey &outputKey,
@@ -225,6 +275,22 @@ LweKeyswitchKey::LweKeyswitchKey(
   auto params = info.asReader().getParams();
   auto compression = info.asReader().getCompression();
 
+  if (params.getOutputPolynomialSize() > 0) {
+    assert(compression == concreteprotocol::Compression::NONE &&
+           "Unsupported compression type for fast keyswitch key");
+    auto outputPolySize = params.getOutputPolynomialSize();
+    auto outputGlweDim = params.getOutputLweDimension() / outputPolySize;
+    buffer->resize(concrete_cpu_fast_keyswitch_key_size_u64(
+        params.getLevelCount(), params.getInputLweDimension(), outputGlweDim,
+        outputPolySize));
+    concrete_cpu_init_lwe_fast_keyswitch_key_u64(
+        buffer->data(), inputKey.buffer->data(), outputKey.buffer->data(),
+        params.getInputLweDimension(), outputGlweDim, outputPolySize,
+        params.getLevelCount(), params.getBaseLog(), params.getVariance(),
+        csprng.ptr);
+    return;
+  }
+
   switch (compression) {
   case concreteprotocol::Compression::NONE:
     buffer->resize(concrete_cpu_keyswitch_key_size_u64(
@@ -258,20 +324,29 @@ LweKeyswitchKey::LweKeyswitchKey(
 
 LweKeyswitchKey LweKeyswitchKey::fromProto(
     const Message<concreteprotocol::LweKeyswitchKey> &proto) {
-  auto info = Message<concreteprotocol::LweKeyswitchKeyInfo>(
-      proto.asReader().getInfo());
-  auto vector =
-      protoPayloadToSharedVector<uint64_t>(proto.asReader().getPayload());
+  return fromProto(proto.asReader());
+}
+
+LweKeyswitchKey
+LweKeyswitchKey::fromProto(concreteprotocol::LweKeyswitchKey::Reader proto) {
+  auto info = Message<concreteprotocol::LweKeyswitchKeyInfo>(proto.getInfo());
+  auto vector = protoPayloadToSharedVector<uint64_t>(proto.getPayload());
+  return fromTransportBuffer(vector, info);
+}
+
+LweKeyswitchKey LweKeyswitchKey::fromTransportBuffer(
+    std::shared_ptr<std::vector<uint64_t>> buffer,
+    Message<concreteprotocol::LweKeyswitchKeyInfo> info) {
   LweKeyswitchKey key(info);
   switch (info.asReader().getCompression()) {
   case concreteprotocol::Compression::NONE:
-    key.buffer = vector;
+    key.buffer = buffer;
     break;
   case concreteprotocol::Compression::SEED:
-    key.seededBuffer = vector;
+    key.seededBuffer = buffer;
     break;
   default:
-    assert(false && "Unsupported compression type for bootstrap key");
+    assert(false && "Unsupported compression type for keyswitch key");
   }
   return key;
 }
@@ -297,7 +372,7 @@ const std::vector<uint64_t> &LweKeyswitchKey::getTransportBuffer() const {
   case concreteprotocol::Compression::NONE:
     return *buffer;
   case concreteprotocol::Compression::SEED:
-    assert(!seededBuffer->empty());
+    // Empty for a key not uploaded yet, see ServerKeyset::toProto
     return *seededBuffer;
   default:
     assert(false && "Unsupported compression type for bootstrap key");
@@ -335,38 +410,75 @@ void LweKeyswitchKey::decompress() {
 PackingKeyswitchKey::PackingKeyswitchKey(
     Message<concreteprotocol::PackingKeyswitchKeyInfo> info,
     const LweSecretKey &inputKey, const LweSecretKey &outputKey,
-    EncryptionCSPRNG &csprng) {
+    EncryptionCSPRNG &csprng)
+    : PackingKeyswitchKey(info) {
   assert(info.asReader().getParams().getGlweDimension() *
              info.asReader().getParams().getPolynomialSize() ==
          outputKey.info.asReader().getParams().getLweDimension());
 
-  // Allocate the buffer
   auto params = info.asReader().getParams();
-  auto bufferSize = concrete_cpu_lwe_packing_keyswitch_key_size(
-                        params.getGlweDimension(), params.getPolynomialSize(),
-                        params.getLevelCount(), params.getInputLweDimension()) *
-                    (params.getGlweDimension() + 1);
-  buffer = std::make_shared<std::vector<uint64_t>>();
-  (*buffer).resize(bufferSize);
-
-  // We copy the informations.
-  this->info = info;
-
-  // Initialize the keyswitch key buffer
-  concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
-      buffer->data(), inputKey.buffer->data(), outputKey.buffer->data(),
-      params.getInputLweDimension(), params.getPolynomialSize(),
-      params.getGlweDimension(), params.getLevelCount(), params.getBaseLog(),
-      params.getVariance(), Parallelism::Rayon, csprng.ptr);
+  switch (info.asReader().getCompression()) {
+  case concreteprotocol::Compression::NONE:
+    buffer->resize(concrete_cpu_lwe_packing_keyswitch_key_size(
+                       params.getGlweDimension(), params.getPolynomialSize(),
+                       params.getLevelCount(), params.getInputLweDimension()) *
+                   (params.getGlweDimension() + 1));
+    concrete_cpu_init_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+        buffer->data(), inputKey.buffer->data(), outputKey.buffer->data(),
+        params.getInputLweDimension(), params.getPolynomialSize(),
+        params.getGlweDimension(), params.getLevelCount(), params.getBaseLog(),
+        params.getVariance(), Parallelism::Rayon, csprng.ptr);
+    return;
+  case concreteprotocol::Compression::SEED: {
+    seededBuffer->resize(
+        concrete_cpu_seeded_lwe_packing_keyswitch_keys_size_u64(
+            params.getGlweDimension(), params.getPolynomialSize(),
+            params.getLevelCount(), params.getInputLweDimension()) +
+        2 /* for seed*/);
+    struct Uint128 seed;
+    csprng::getRandomSeed(&seed);
+    writeSeed(seed, *seededBuffer);
+    concrete_cpu_init_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+        seededBuffer->data() + 2, inputKey.buffer->data(),
+        outputKey.buffer->data(), params.getInputLweDimension(),
+        params.getPolynomialSize(), params.getGlweDimension(),
+        params.getLevelCount(), params.getBaseLog(), seed,
+        params.getVariance(), Parallelism::Rayon, csprng.ptr);
+    return;
+  }
+  default:
+    assert(false && "Unsupported compression type for packing keyswitch key");
+  }
 }
 
 PackingKeyswitchKey PackingKeyswitchKey::fromProto(
     const Message<concreteprotocol::PackingKeyswitchKey> &proto) {
-  auto info = Message<concreteprotocol::PackingKeyswitchKeyInfo>(
-      proto.asReader().getInfo());
-  auto vector =
-      protoPayloadToSharedVector<uint64_t>(proto.asReader().getPayload());
-  return PackingKeyswitchKey(vector, info);
+  return fromProto(proto.asReader());
+}
+
+PackingKeyswitchKey PackingKeyswitchKey::fromProto(
+    concreteprotocol::PackingKeyswitchKey::Reader proto) {
+  auto info =
+      Message<concreteprotocol::PackingKeyswitchKeyInfo>(proto.getInfo());
+  auto vector = protoPayloadToSharedVector<uint64_t>(proto.getPayload());
+  return fromTransportBuffer(vector, info);
+}
+
+PackingKeyswitchKey PackingKeyswitchKey::fromTransportBuffer(
+    std::shared_ptr<std::vector<uint64_t>> buffer,
+    Message<concreteprotocol::PackingKeyswitchKeyInfo> info) {
+  PackingKeyswitchKey key(info);
+  switch (info.asReader().getCompression()) {
+  case concreteprotocol::Compression::NONE:
+    key.buffer = buffer;
+    break;
+  case concreteprotocol::Compression::SEED:
+    key.seededBuffer = buffer;
+    break;
+  default:
+    assert(false && "Unsupported compression type for packing keyswitch key");
+  }
+  return key;
 }
 
 Message<concreteprotocol::PackingKeyswitchKey>
@@ -376,19 +488,60 @@ PackingKeyswitchKey::toProto() const {
                     PackingKeyswitchKey>(*this);
 }
 
-const uint64_t *PackingKeyswitchKey::getRawPtr() const {
-  return this->buffer->data();
+const uint64_t *PackingKeyswitchKey::getRawPtr() {
+  return getBuffer().data();
 }
 
-size_t PackingKeyswitchKey::getSize() const { return this->buffer->size(); }
+size_t PackingKeyswitchKey::getSize() { return getBuffer().size(); }
 
 const Message<concreteprotocol::PackingKeyswitchKeyInfo> &
 PackingKeyswitchKey::getInfo() const {
   return this->info;
 }
 
-const std::vector<uint64_t> &PackingKeyswitchKey::getBuffer() const {
-  return *this->buffer;
+const std::vector<uint64_t> &PackingKeyswitchKey::getBuffer() {
+  decompress();
+  return *buffer;
+}
+
+const std::vector<uint64_t> &PackingKeyswitchKey::getTransportBuffer() const {
+  switch (info.asReader().getCompression()) {
+  case concreteprotocol::Compression::NONE:
+    return *buffer;
+  case concreteprotocol::Compression::SEED:
+    return *seededBuffer;
+  default:
+    assert(false && "Unsupported compression type for packing keyswitch key");
+  }
+}
+
+void PackingKeyswitchKey::decompress() {
+  switch (info.asReader().getCompression()) {
+  case concreteprotocol::Compression::NONE:
+    return;
+  case concreteprotocol::Compression::SEED: {
+    if (decompressed)
+      return;
+    const std::lock_guard<std::mutex> guard(*decompress_mutext);
+    if (decompressed)
+      return;
+    auto params = info.asReader().getParams();
+    buffer->resize(concrete_cpu_lwe_packing_keyswitch_key_size(
+                       params.getGlweDimension(), params.getPolynomialSize(),
+                       params.getLevelCount(), params.getInputLweDimension()) *
+                   (params.getGlweDimension() + 1));
+    struct Uint128 seed;
+    readSeed(seed, *seededBuffer);
+    concrete_cpu_decompress_seeded_lwe_circuit_bootstrap_private_functional_packing_keyswitch_keys_u64(
+        buffer->data(), seededBuffer->data() + 2,
+        params.getInputLweDimension(), params.getPolynomialSize(),
+        params.getGlweDimension(), params.getLevelCount(), seed);
+    decompressed = true;
+    return;
+  }
+  default:
+    assert(false && "Unsupported compression type for packing keyswitch key");
+  }
 }
 
 } // namespace keys
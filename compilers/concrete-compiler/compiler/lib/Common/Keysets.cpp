@@ -5,6 +5,7 @@
 
 #include "concretelang/Common/Keysets.h"
 #include "capnp/message.h"
+#include "capnp/serialize.h"
 #include "concrete-cpu.h"
 #include "concrete-protocol.capnp.h"
 #include "concretelang/Common/Csprng.h"
@@ -13,13 +14,21 @@
 #include "kj/common.h"
 #include "kj/io.h"
 #include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/BLAKE3.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
+#include <functional>
 #include <iostream>
+#include <optional>
 #include <stdlib.h>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
 #include <unistd.h>
 #include <utime.h>
 
@@ -41,8 +50,13 @@ namespace keysets {
 
 ClientKeyset
 ClientKeyset::fromProto(const Message<concreteprotocol::ClientKeyset> &proto) {
+  return fromProto(proto.asReader());
+}
+
+ClientKeyset
+ClientKeyset::fromProto(concreteprotocol::ClientKeyset::Reader reader) {
   auto output = ClientKeyset();
-  for (auto skProto : proto.asReader().getLweSecretKeys()) {
+  for (auto skProto : reader.getLweSecretKeys()) {
     output.lweSecretKeys.push_back(LweSecretKey::fromProto(skProto));
   }
 
@@ -62,16 +76,21 @@ Message<concreteprotocol::ClientKeyset> ClientKeyset::toProto() const {
 
 ServerKeyset
 ServerKeyset::fromProto(const Message<concreteprotocol::ServerKeyset> &proto) {
+  return fromProto(proto.asReader());
+}
+
+ServerKeyset
+ServerKeyset::fromProto(concreteprotocol::ServerKeyset::Reader reader) {
   auto output = ServerKeyset();
-  for (auto bskProto : proto.asReader().getLweBootstrapKeys()) {
+  for (auto bskProto : reader.getLweBootstrapKeys()) {
     output.lweBootstrapKeys.push_back(LweBootstrapKey::fromProto(bskProto));
   }
 
-  for (auto kskProto : proto.asReader().getLweKeyswitchKeys()) {
+  for (auto kskProto : reader.getLweKeyswitchKeys()) {
     output.lweKeyswitchKeys.push_back(LweKeyswitchKey::fromProto(kskProto));
   }
 
-  for (auto pkskProto : proto.asReader().getPackingKeyswitchKeys()) {
+  for (auto pkskProto : reader.getPackingKeyswitchKeys()) {
     output.packingKeyswitchKeys.push_back(
         PackingKeyswitchKey::fromProto(pkskProto));
   }
@@ -102,31 +121,184 @@ Message<concreteprotocol::ServerKeyset> ServerKeyset::toProto() const {
   return output;
 }
 
+namespace {
+bool containsId(capnp::List<uint32_t>::Reader ids, uint32_t id) {
+  for (auto usedId : ids) {
+    if (usedId == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Serializes the key if it is used, its info only otherwise.
+template <typename ProtoKey, typename Key>
+Message<ProtoKey> usedKeyToProto(const Key &key,
+                                 capnp::List<uint32_t>::Reader usedIds) {
+  if (containsId(usedIds, key.getInfo().asReader().getId())) {
+    return key.toProto();
+  }
+  Message<ProtoKey> output;
+  output.asBuilder().setInfo(key.getInfo().asReader());
+  output.asBuilder().initPayload();
+  return output;
+}
+
+/// A key without payload has not been uploaded yet.
+template <typename Key> bool isMissing(const Key &key) {
+  return key.getTransportBuffer().empty();
+}
+
+template <typename Key>
+Result<void> checkUsedKeys(const std::vector<Key> &keys,
+                           capnp::List<uint32_t>::Reader usedIds,
+                           const char *kind) {
+  for (auto id : usedIds) {
+    if (id >= keys.size() || isMissing(keys[id])) {
+      return StringError("The ")
+             << kind << " key " << id << " is missing from the server keyset";
+    }
+  }
+  return outcome::success();
+}
+
+template <typename Key>
+Result<void> mergeKeys(std::vector<Key> &keys, const std::vector<Key> &others,
+                       const char *kind) {
+  if (keys.size() != others.size()) {
+    return StringError("Cannot merge server keysets with different numbers "
+                       "of ")
+           << kind << " keys";
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (isMissing(keys[i])) {
+      keys[i] = others[i];
+    }
+  }
+  return outcome::success();
+}
+} // namespace
+
+Message<concreteprotocol::ServerKeyset> ServerKeyset::toProto(
+    concreteprotocol::CircuitKeysInfo::Reader circuitKeys) const {
+  auto output = Message<concreteprotocol::ServerKeyset>();
+  output.asBuilder().initLweBootstrapKeys(lweBootstrapKeys.size());
+  for (size_t i = 0; i < lweBootstrapKeys.size(); i++) {
+    output.asBuilder().getLweBootstrapKeys().setWithCaveats(
+        i, usedKeyToProto<concreteprotocol::LweBootstrapKey>(
+               lweBootstrapKeys[i], circuitKeys.getLweBootstrapKeys())
+               .asReader());
+  }
+
+  output.asBuilder().initLweKeyswitchKeys(lweKeyswitchKeys.size());
+  for (size_t i = 0; i < lweKeyswitchKeys.size(); i++) {
+    output.asBuilder().getLweKeyswitchKeys().setWithCaveats(
+        i, usedKeyToProto<concreteprotocol::LweKeyswitchKey>(
+               lweKeyswitchKeys[i], circuitKeys.getLweKeyswitchKeys())
+               .asReader());
+  }
+
+  output.asBuilder().initPackingKeyswitchKeys(packingKeyswitchKeys.size());
+  for (size_t i = 0; i < packingKeyswitchKeys.size(); i++) {
+    output.asBuilder().getPackingKeyswitchKeys().setWithCaveats(
+        i, usedKeyToProto<concreteprotocol::PackingKeyswitchKey>(
+               packingKeyswitchKeys[i], circuitKeys.getPackingKeyswitchKeys())
+               .asReader());
+  }
+
+  return output;
+}
+
+Result<void> ServerKeyset::checkKeys(
+    concreteprotocol::CircuitKeysInfo::Reader circuitKeys) const {
+  OUTCOME_TRYV(checkUsedKeys(lweBootstrapKeys,
+                             circuitKeys.getLweBootstrapKeys(), "bootstrap"));
+  OUTCOME_TRYV(checkUsedKeys(lweKeyswitchKeys,
+                             circuitKeys.getLweKeyswitchKeys(), "keyswitch"));
+  OUTCOME_TRYV(checkUsedKeys(packingKeyswitchKeys,
+                             circuitKeys.getPackingKeyswitchKeys(),
+                             "packing keyswitch"));
+  return outcome::success();
+}
+
+Result<void> ServerKeyset::merge(const ServerKeyset &other) {
+  OUTCOME_TRYV(
+      mergeKeys(lweBootstrapKeys, other.lweBootstrapKeys, "bootstrap"));
+  OUTCOME_TRYV(
+      mergeKeys(lweKeyswitchKeys, other.lweKeyswitchKeys, "keyswitch"));
+  OUTCOME_TRYV(mergeKeys(packingKeyswitchKeys, other.packingKeyswitchKeys,
+                         "packing keyswitch"));
+  return outcome::success();
+}
+
 Keyset::Keyset(const Message<concreteprotocol::KeysetInfo> &info,
                SecretCSPRNG &secretCsprng, EncryptionCSPRNG &encryptionCsprng) {
   for (auto keyInfo : info.asReader().getLweSecretKeys()) {
     client.lweSecretKeys.push_back(LweSecretKey(keyInfo, secretCsprng));
   }
-  for (auto keyInfo : info.asReader().getLweBootstrapKeys()) {
-    server.lweBootstrapKeys.push_back(LweBootstrapKey(
-        keyInfo, client.lweSecretKeys[keyInfo.getInputId()],
-        client.lweSecretKeys[keyInfo.getOutputId()], encryptionCsprng));
+
+  // The evaluation keys are generated concurrently, each one from its own
+  // csprng. The csprngs are forked in the order of the keys, so that the
+  // keyset stays reproducible from the seeds.
+  auto bskInfos = info.asReader().getLweBootstrapKeys();
+  auto kskInfos = info.asReader().getLweKeyswitchKeys();
+  auto pkskInfos = info.asReader().getPackingKeyswitchKeys();
+  std::vector<EncryptionCSPRNG> csprngs;
+  size_t keysCount = bskInfos.size() + kskInfos.size() + pkskInfos.size();
+  csprngs.reserve(keysCount);
+  for (size_t i = 0; i < keysCount; i++) {
+    csprngs.push_back(encryptionCsprng.fork());
+  }
+
+  std::vector<std::optional<LweBootstrapKey>> bsks(bskInfos.size());
+  std::vector<std::optional<LweKeyswitchKey>> ksks(kskInfos.size());
+  std::vector<std::optional<PackingKeyswitchKey>> pksks(pkskInfos.size());
+  std::vector<std::thread> workers;
+  workers.reserve(keysCount);
+  auto csprng = csprngs.begin();
+  for (size_t i = 0; i < bskInfos.size(); i++, csprng++) {
+    workers.emplace_back([&, i, csprng]() {
+      auto keyInfo = bskInfos[i];
+      bsks[i].emplace(keyInfo, client.lweSecretKeys[keyInfo.getInputId()],
+                      client.lweSecretKeys[keyInfo.getOutputId()], *csprng);
+    });
+  }
+  for (size_t i = 0; i < kskInfos.size(); i++, csprng++) {
+    workers.emplace_back([&, i, csprng]() {
+      auto keyInfo = kskInfos[i];
+      ksks[i].emplace(keyInfo, client.lweSecretKeys[keyInfo.getInputId()],
+                      client.lweSecretKeys[keyInfo.getOutputId()], *csprng);
+    });
+  }
+  for (size_t i = 0; i < pkskInfos.size(); i++, csprng++) {
+    workers.emplace_back([&, i, csprng]() {
+      auto keyInfo = pkskInfos[i];
+      pksks[i].emplace(keyInfo, client.lweSecretKeys[keyInfo.getInputId()],
+                       client.lweSecretKeys[keyInfo.getOutputId()], *csprng);
+    });
   }
-  for (auto keyInfo : info.asReader().getLweKeyswitchKeys()) {
-    server.lweKeyswitchKeys.push_back(LweKeyswitchKey(
-        keyInfo, client.lweSecretKeys[keyInfo.getInputId()],
-        client.lweSecretKeys[keyInfo.getOutputId()], encryptionCsprng));
+  for (auto &worker : workers) {
+    worker.join();
   }
-  for (auto keyInfo : info.asReader().getPackingKeyswitchKeys()) {
-    server.packingKeyswitchKeys.push_back(PackingKeyswitchKey(
-        keyInfo, client.lweSecretKeys[keyInfo.getInputId()],
-        client.lweSecretKeys[keyInfo.getOutputId()], encryptionCsprng));
+
+  for (auto &bsk : bsks) {
+    server.lweBootstrapKeys.push_back(std::move(*bsk));
+  }
+  for (auto &ksk : ksks) {
+    server.lweKeyswitchKeys.push_back(std::move(*ksk));
+  }
+  for (auto &pksk : pksks) {
+    server.packingKeyswitchKeys.push_back(std::move(*pksk));
   }
 }
 
 Keyset Keyset::fromProto(const Message<concreteprotocol::Keyset> &proto) {
-  auto server = ServerKeyset::fromProto(proto.asReader().getServer());
-  auto client = ClientKeyset::fromProto(proto.asReader().getClient());
+  return fromProto(proto.asReader());
+}
+
+Keyset Keyset::fromProto(concreteprotocol::Keyset::Reader reader) {
+  auto server = ServerKeyset::fromProto(reader.getServer());
+  auto client = ClientKeyset::fromProto(reader.getClient());
 
   return {server, client};
 }
@@ -140,23 +312,72 @@ Message<concreteprotocol::Keyset> Keyset::toProto() const {
   return output;
 }
 
-template <typename ProtoKey>
-Result<Message<ProtoKey>> loadKeyProto(std::string path) {
-  std::ifstream in((std::string)path, std::ofstream::binary);
-  if (in.fail()) {
-    return StringError("Cannot load key at path " + (std::string)path +
-                       " Error: " + strerror(errno));
+/// Reads the message stored in the file `fd` and builds an object from it.
+///
+/// The file is mapped and the message read in place, so that the payloads are
+/// copied once, straight into the buffers of the keys, instead of being read in
+/// a message then copied out of it. `what` names the file in errors.
+template <typename ProtoMessage, typename T>
+Result<T> readMappedMessage(int fd, const std::string &what) {
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return StringError("Cannot load " + what + " Error: " + strerror(errno));
+  }
+  size_t size = st.st_size;
+  if (size == 0 || size % sizeof(capnp::word) != 0) {
+    return StringError("Invalid " + what);
+  }
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    return StringError("Cannot map " + what + " Error: " + strerror(errno));
+  }
+  auto unmapAtReturn = llvm::make_scope_exit([&]() { munmap(mapping, size); });
+  // The payload is read once, sequentially.
+  madvise(mapping, size, MADV_SEQUENTIAL);
+
+  try {
+    capnp::FlatArrayMessageReader reader(
+        kj::ArrayPtr<const capnp::word>((const capnp::word *)mapping,
+                                        size / sizeof(capnp::word)),
+        KEY_READER_OPTS);
+    return T::fromProto(reader.getRoot<ProtoMessage>());
+  } catch (const kj::Exception &e) {
+    return StringError("Failed to read " + what + ": " +
+                       e.getDescription().cStr());
   }
-  Message<ProtoKey> keyBlob;
-  OUTCOME_TRYV(keyBlob.readBinaryFromIstream(in, KEY_READER_OPTS));
-  return keyBlob;
 }
 
+/// Opens the file at `path` and reads it with `readMappedMessage`.
+template <typename ProtoMessage, typename T>
+Result<T> loadMappedMessage(const std::string &path, const std::string &what) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return StringError("Cannot load " + what + " Error: " + strerror(errno));
+  }
+  // The mapping stays valid once the file descriptor is closed.
+  auto closeAtReturn = llvm::make_scope_exit([&]() { close(fd); });
+  return readMappedMessage<ProtoMessage, T>(fd, what);
+}
+
+/// Loads a key saved by `saveKey`.
 template <typename ProtoKey, typename Key>
 Result<Key> loadKey(std::string path) {
-  Message<ProtoKey> proto;
-  OUTCOME_TRY(auto keyProto, loadKeyProto<ProtoKey>(path));
-  return Key::fromProto(keyProto);
+  return loadMappedMessage<ProtoKey, Key>(path, "key at path " + path);
+}
+
+Result<ServerKeyset> ServerKeyset::fromFd(int fd) {
+  return readMappedMessage<concreteprotocol::ServerKeyset, ServerKeyset>(
+      fd, "server keyset from file descriptor " + std::to_string(fd));
+}
+
+Result<ServerKeyset> ServerKeyset::load(const std::string &path) {
+  return loadMappedMessage<concreteprotocol::ServerKeyset, ServerKeyset>(
+      path, "server keyset at path " + path);
+}
+
+Result<Keyset> Keyset::load(const std::string &path) {
+  return loadMappedMessage<concreteprotocol::Keyset, Keyset>(
+      path, "keyset at path " + path);
 }
 
 template <typename ProtoKey>
@@ -180,6 +401,77 @@ Result<void> saveKey(Key key, std::string path) {
   return outcome::success();
 }
 
+namespace {
+/// Runs the tasks concurrently, one thread each, as the keys of a keyset are
+/// few and of very different sizes. Returns the first failure, once all the
+/// tasks are done.
+Result<void>
+runConcurrently(const std::vector<std::function<Result<void>()>> &tasks) {
+  std::vector<Result<void>> results(tasks.size(), outcome::success());
+  std::vector<std::thread> workers;
+  workers.reserve(tasks.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    workers.emplace_back([&, i]() { results[i] = tasks[i](); });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  for (auto &result : results) {
+    if (result.has_failure()) {
+      return result.as_failure();
+    }
+  }
+  return outcome::success();
+}
+
+/// Adds to `tasks` the loading of the keys of `infos`, saved in `folderPath`
+/// under `prefix` followed by their id, to the same index of `keys`.
+template <typename ProtoKey, typename Key, typename Infos>
+void addLoadTasks(Infos infos, const std::string &folderPath,
+                  const std::string &prefix,
+                  std::vector<std::optional<Key>> &keys,
+                  std::vector<std::function<Result<void>()>> &tasks) {
+  keys.resize(infos.size());
+  for (size_t i = 0; i < infos.size(); i++) {
+    // TODO - Check parameters?
+    llvm::SmallString<0> path(folderPath);
+    llvm::sys::path::append(path, prefix + std::to_string(infos[i].getId()));
+    tasks.push_back([&keys, i, path = std::string(path)]() -> Result<void> {
+      OUTCOME_TRY(auto key, loadKey<ProtoKey, Key>(path));
+      keys[i].emplace(std::move(key));
+      return outcome::success();
+    });
+  }
+}
+
+template <typename Key>
+std::vector<Key> takeLoadedKeys(std::vector<std::optional<Key>> &keys) {
+  std::vector<Key> output;
+  output.reserve(keys.size());
+  for (auto &key : keys) {
+    output.push_back(std::move(*key));
+  }
+  return output;
+}
+
+/// Adds to `tasks` the saving of `keys` in `folderPath`, under `prefix`
+/// followed by their id.
+template <typename ProtoKey, typename Key>
+void addSaveTasks(const std::vector<Key> &keys,
+                  const llvm::SmallString<0> &folderPath,
+                  const std::string &prefix,
+                  std::vector<std::function<Result<void>()>> &tasks) {
+  for (auto &key : keys) {
+    llvm::SmallString<0> path = folderPath;
+    llvm::sys::path::append(
+        path, prefix + std::to_string(key.getInfo().asReader().getId()));
+    tasks.push_back([&key, path = std::string(path)]() {
+      return saveKey<ProtoKey, Key>(key, path);
+    });
+  }
+}
+} // namespace
+
 Result<Keyset>
 loadKeysFromFiles(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
                   __uint128_t secret_seed, __uint128_t encryption_seed,
@@ -192,60 +484,29 @@ loadKeysFromFiles(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
   // e.g. so the CI can do some cleanup of unused keys.
   utime(folderPath.c_str(), nullptr);
 
-  std::vector<LweSecretKey> secretKeys;
-  std::vector<LweBootstrapKey> bootstrapKeys;
-  std::vector<LweKeyswitchKey> keyswitchKeys;
-  std::vector<PackingKeyswitchKey> packingKeyswitchKeys;
-
-  // Load secret keys
-  for (auto keyInfo : keysetInfo.asReader().getLweSecretKeys()) {
-    // TODO - Check parameters?
-    // auto param = secretKeyParam.second;
-    llvm::SmallString<0> path(folderPath);
-    llvm::sys::path::append(path,
-                            "secretKey_" + std::to_string(keyInfo.getId()));
-    OUTCOME_TRY(auto key, loadKey<concreteprotocol::LweSecretKey, LweSecretKey>(
-                              (std::string)path));
-    secretKeys.push_back(key);
-  }
-  // Load bootstrap keys
-  for (auto keyInfo : keysetInfo.asReader().getLweBootstrapKeys()) {
-    // TODO - Check parameters?
-    // auto param = p.value();
-    llvm::SmallString<0> path(folderPath);
-    llvm::sys::path::append(path, "pbsKey_" + std::to_string(keyInfo.getId()));
-    OUTCOME_TRY(auto key,
-                loadKey<concreteprotocol::LweBootstrapKey, LweBootstrapKey>(
-                    (std::string)path));
-    bootstrapKeys.push_back(key);
-  }
-  // Load keyswitch keys
-  for (auto keyInfo : keysetInfo.asReader().getLweKeyswitchKeys()) {
-    // TODO - Check parameters?
-    // auto param = p.value();
-    llvm::SmallString<0> path(folderPath);
-    llvm::sys::path::append(path, "ksKey_" + std::to_string(keyInfo.getId()));
-    OUTCOME_TRY(auto key,
-                loadKey<concreteprotocol::LweKeyswitchKey, LweKeyswitchKey>(
-                    (std::string)path));
-    keyswitchKeys.push_back(key);
-  }
-  // Load packing keyswitch keys
-  for (auto keyInfo : keysetInfo.asReader().getPackingKeyswitchKeys()) {
-    // TODO - Check parameters?
-    // auto param = p.value();
-    llvm::SmallString<0> path(folderPath);
-    llvm::sys::path::append(path, "pksKey_" + std::to_string(keyInfo.getId()));
-    OUTCOME_TRY(
-        auto key,
-        loadKey<concreteprotocol::PackingKeyswitchKey, PackingKeyswitchKey>(
-            (std::string)path));
-    packingKeyswitchKeys.push_back(key);
-  }
-
-  ClientKeyset clientKeyset = ClientKeyset{secretKeys};
-  ServerKeyset serverKeyset =
-      ServerKeyset{bootstrapKeys, keyswitchKeys, packingKeyswitchKeys};
+  // The keys are loaded concurrently, their deserialization being bound by
+  // the copy of their payloads rather than by the disk.
+  std::vector<std::optional<LweSecretKey>> secretKeys;
+  std::vector<std::optional<LweBootstrapKey>> bootstrapKeys;
+  std::vector<std::optional<LweKeyswitchKey>> keyswitchKeys;
+  std::vector<std::optional<PackingKeyswitchKey>> packingKeyswitchKeys;
+  std::vector<std::function<Result<void>()>> tasks;
+  auto info = keysetInfo.asReader();
+  addLoadTasks<concreteprotocol::LweSecretKey>(
+      info.getLweSecretKeys(), folderPath, "secretKey_", secretKeys, tasks);
+  addLoadTasks<concreteprotocol::LweBootstrapKey>(
+      info.getLweBootstrapKeys(), folderPath, "pbsKey_", bootstrapKeys, tasks);
+  addLoadTasks<concreteprotocol::LweKeyswitchKey>(
+      info.getLweKeyswitchKeys(), folderPath, "ksKey_", keyswitchKeys, tasks);
+  addLoadTasks<concreteprotocol::PackingKeyswitchKey>(
+      info.getPackingKeyswitchKeys(), folderPath, "pksKey_",
+      packingKeyswitchKeys, tasks);
+  OUTCOME_TRYV(runConcurrently(tasks));
+
+  ClientKeyset clientKeyset = ClientKeyset{takeLoadedKeys(secretKeys)};
+  ServerKeyset serverKeyset = ServerKeyset{
+      takeLoadedKeys(bootstrapKeys), takeLoadedKeys(keyswitchKeys),
+      takeLoadedKeys(packingKeyswitchKeys)};
   Keyset keyset = Keyset{serverKeyset, clientKeyset};
 
   return keyset;
@@ -265,41 +526,24 @@ Result<void> saveKeys(Keyset &keyset, llvm::SmallString<0> &folderPath) {
            << std::string(folderIncompletePath) << "\": " << err.message();
   }
 
-  auto clientKeyset = keyset.client;
-  auto serverKeyset = keyset.server;
-
-  // Save LWE secret keys
-  for (auto key : clientKeyset.lweSecretKeys) {
-    llvm::SmallString<0> path = folderIncompletePath;
-    llvm::sys::path::append(
-        path, "secretKey_" + std::to_string(key.getInfo().asReader().getId()));
-    OUTCOME_TRYV(saveKey<concreteprotocol::LweSecretKey, LweSecretKey>(
-        key, path.c_str()));
-  }
-  // Save bootstrap keys
-  for (auto key : serverKeyset.lweBootstrapKeys) {
-    llvm::SmallString<0> path = folderIncompletePath;
-    llvm::sys::path::append(
-        path, "pbsKey_" + std::to_string(key.getInfo().asReader().getId()));
-    OUTCOME_TRYV(saveKey<concreteprotocol::LweBootstrapKey, LweBootstrapKey>(
-        key, path.c_str()));
-  }
-  // Save keyswitch keys
-  for (auto key : serverKeyset.lweKeyswitchKeys) {
-    llvm::SmallString<0> path = folderIncompletePath;
-    llvm::sys::path::append(
-        path, "ksKey_" + std::to_string(key.getInfo().asReader().getId()));
-    OUTCOME_TRYV(saveKey<concreteprotocol::LweKeyswitchKey, LweKeyswitchKey>(
-        key, path.c_str()));
-  }
-  // Save packing keyswitch keys
-  for (auto key : serverKeyset.packingKeyswitchKeys) {
-    llvm::SmallString<0> path = folderIncompletePath;
-    llvm::sys::path::append(
-        path, "pksKey_" + std::to_string(key.getInfo().asReader().getId()));
-    OUTCOME_TRYV(
-        saveKey<concreteprotocol::PackingKeyswitchKey, PackingKeyswitchKey>(
-            key, path.c_str()));
+  auto &clientKeyset = keyset.client;
+  auto &serverKeyset = keyset.server;
+
+  // The keys are saved concurrently, each one to its own file
+  std::vector<std::function<Result<void>()>> tasks;
+  addSaveTasks<concreteprotocol::LweSecretKey>(
+      clientKeyset.lweSecretKeys, folderIncompletePath, "secretKey_", tasks);
+  addSaveTasks<concreteprotocol::LweBootstrapKey>(
+      serverKeyset.lweBootstrapKeys, folderIncompletePath, "pbsKey_", tasks);
+  addSaveTasks<concreteprotocol::LweKeyswitchKey>(
+      serverKeyset.lweKeyswitchKeys, folderIncompletePath, "ksKey_", tasks);
+  addSaveTasks<concreteprotocol::PackingKeyswitchKey>(
+      serverKeyset.packingKeyswitchKeys, folderIncompletePath, "pksKey_",
+      tasks);
+  auto saved = runConcurrently(tasks);
+  if (saved.has_failure()) {
+    llvm::sys::fs::remove_directories(folderIncompletePath);
+    return saved.as_failure();
   }
 
   err = llvm::sys::fs::rename(folderIncompletePath, folderPath);
@@ -314,28 +558,104 @@ Result<void> saveKeys(Keyset &keyset, llvm::SmallString<0> &folderPath) {
   return outcome::success();
 }
 
-KeysetCache::KeysetCache(std::string backingDirectoryPath) {
-  // check key;
+KeysetCache::KeysetCache(std::string backingDirectoryPath, uint64_t maxSize) {
   this->backingDirectoryPath = backingDirectoryPath;
+  this->maxSize = maxSize;
 }
 
-Result<Keyset>
-KeysetCache::getKeyset(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
-                       __uint128_t secret_seed, __uint128_t encryption_seed) {
+llvm::SmallString<0> KeysetCache::getEntryPath(
+    const Message<concreteprotocol::KeysetInfo> &keysetInfo,
+    __uint128_t secret_seed, __uint128_t encryption_seed) {
   std::string hashString = keysetInfo.asReader().toString().flatten().cStr() +
                            std::to_string((uint64_t)secret_seed) +
                            std::to_string((uint64_t)(secret_seed >> 64)) +
                            std::to_string((uint64_t)encryption_seed) +
                            std::to_string((uint64_t)(encryption_seed >> 64));
 
-  size_t hash = std::hash<std::string>{}(hashString);
+  // Unlike std::hash, the digest does not depend on the standard library.
+  llvm::BLAKE3 hasher;
+  hasher.update(hashString);
+  auto digest = hasher.final();
+
+  llvm::SmallString<0> folderPath =
+      llvm::SmallString<0>(this->backingDirectoryPath);
+  llvm::sys::path::append(folderPath, llvm::toHex(digest, true));
+  return folderPath;
+}
+
+std::string KeysetCache::getPreparedKeysetPath(
+    const Message<concreteprotocol::KeysetInfo> &keysetInfo,
+    __uint128_t secret_seed, __uint128_t encryption_seed) {
+  auto path = getEntryPath(keysetInfo, secret_seed, encryption_seed);
+  llvm::sys::path::append(path, "preparedKeyset");
+  return std::string(path);
+}
+
+void KeysetCache::evictEntries(llvm::StringRef keptEntry) {
+  struct Entry {
+    std::string path;
+    llvm::sys::TimePoint<> lastUse;
+    uint64_t size;
+  };
+  std::vector<Entry> entries;
+  uint64_t totalSize = 0;
+  std::error_code err;
+  for (llvm::sys::fs::directory_iterator it(backingDirectoryPath, err), end;
+       !err && it != end; it.increment(err)) {
+    llvm::sys::fs::file_status status;
+    // Lock files and entries being generated are left alone
+    if (llvm::StringRef(it->path()).endswith(".incomplete") ||
+        llvm::sys::fs::status(it->path(), status) ||
+        status.type() != llvm::sys::fs::file_type::directory_file) {
+      continue;
+    }
+    uint64_t size = 0;
+    std::error_code fileErr;
+    for (llvm::sys::fs::directory_iterator file(it->path(), fileErr);
+         !fileErr && file != end; file.increment(fileErr)) {
+      uint64_t fileSize;
+      if (!llvm::sys::fs::file_size(file->path(), fileSize)) {
+        size += fileSize;
+      }
+    }
+    totalSize += size;
+    if (it->path() != keptEntry) {
+      // The folder time is updated on each load, see loadKeysFromFiles
+      entries.push_back({it->path(), status.getLastModificationTime(), size});
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), [](auto &a, auto &b) {
+    return a.lastUse < b.lastUse;
+  });
+  for (auto &entry : entries) {
+    if (totalSize <= maxSize) {
+      break;
+    }
+    std::cerr << "KeySetCache: evicting " << entry.path << "\n";
+    llvm::sys::fs::remove_directories(entry.path);
+    totalSize -= entry.size;
+  }
+}
+
+Result<Keyset>
+KeysetCache::getKeyset(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
+                       __uint128_t secret_seed, __uint128_t encryption_seed) {
 #ifdef CONCRETELANG_GENERATE_UNSECURE_SECRET_KEYS
   getApproval();
 #endif
 
-  llvm::SmallString<0> folderPath =
-      llvm::SmallString<0>(this->backingDirectoryPath);
-  llvm::sys::path::append(folderPath, std::to_string(hash));
+  auto folderPath = getEntryPath(keysetInfo, secret_seed, encryption_seed);
+
+  // Entries are complete once they exist, so a hit does not need the lock and
+  // is not blocked by the generation of other keysets.
+  if (llvm::sys::fs::exists(folderPath)) {
+    auto keys = loadKeysFromFiles(keysetInfo, secret_seed, encryption_seed,
+                                  std::string(folderPath));
+    if (keys.has_value()) {
+      return keys;
+    }
+  }
 
   // Creating a lock for concurrent generation
   llvm::SmallString<0> lockPath(folderPath);
@@ -386,6 +706,10 @@ KeysetCache::getKeyset(const Message<concreteprotocol::KeysetInfo> &keysetInfo,
 
   OUTCOME_TRYV(saveKeys(keyset, folderPath));
 
+  if (maxSize != 0) {
+    evictEntries(folderPath);
+  }
+
   return std::move(keyset);
 }
 
@@ -36,6 +36,20 @@ dimensionsToProtoShape(const std::vector<size_t> &input) {
   return output;
 }
 
+bool isCompatibleWithShape(const std::vector<size_t> &dimensions,
+                           concreteprotocol::Shape::Reader shape) {
+  if ((uint32_t)shape.getDimensions().size() != dimensions.size()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < dimensions.size(); i++) {
+    if (shape.getDimensions()[i] != DYNAMIC_DIMENSION &&
+        shape.getDimensions()[i] != dimensions[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <typename Message> size_t hashMessage(Message &mess) {
   return llvm::hash_value(MessageToJSONString(mess));
 }
@@ -12,13 +12,17 @@
 #include "concretelang/Common/Keysets.h"
 #include "concretelang/Common/Values.h"
 #include "concretelang/Runtime/simulation.h"
+#include <cassert>
 #include <memory>
 #include <stdlib.h>
 #include <string>
+#include <utility>
 
 using concretelang::error::Result;
 using concretelang::keysets::ClientKeyset;
 using concretelang::values::getCorrespondingPrecision;
+using concretelang::values::modulusSwitchCompress;
+using concretelang::values::modulusSwitchDecompress;
 using concretelang::values::Tensor;
 using concretelang::values::TransportValue;
 using concretelang::values::Value;
@@ -33,9 +37,36 @@ typedef std::function<Result<void>(const Value &)> ValueVerifier;
 typedef std::function<Result<void>(const TransportValue &)>
     TransportValueVerifier;
 
-/// A private type for transformers working purely on values.
+/// A private type for transformers working purely on values. The values are
+/// moved through the transformers, which work in place or allocate their
+/// output once.
 typedef std::function<Value(Value)> Transformer;
 
+/// Moves the tensor out of a value holding a `Tensor<T>`.
+template <typename T> Tensor<T> takeTensor(Value &value) {
+  auto tensor = value.getTensorPtr<T>();
+  assert(tensor != nullptr);
+  tensor->own();
+  return std::move(*tensor);
+}
+
+/// Moves the tensor out of an unsigned value, or converts the tensor of a
+/// signed one.
+Tensor<uint64_t> takeUnsignedTensor(Value &value, bool isSigned) {
+  if (isSigned) {
+    return (Tensor<uint64_t>)takeTensor<int64_t>(value);
+  }
+  return takeTensor<uint64_t>(value);
+}
+
+/// Turns a tensor of decoded integers into a value, signed if `isSigned`.
+Value intoIntegerValue(Tensor<uint64_t> tensor, bool isSigned) {
+  if (isSigned) {
+    return Value{(Tensor<int64_t>)tensor};
+  }
+  return Value{std::move(tensor)};
+}
+
 Result<ValueVerifier> getIndexInputValueVerifier(
     const Message<concreteprotocol::GateInfo> &gateInfo) {
   if (!gateInfo.asReader().getTypeInfo().hasIndex()) {
@@ -195,8 +226,14 @@ getTransportValueVerifier(const Message<concreteprotocol::GateInfo> &gateInfo) {
       return StringError(
           "Tried to transform a transport value without raw infos.");
     }
-    if (!((capnp::AnyStruct::Reader)gateInfo.asReader().getRawInfo() ==
-          (capnp::AnyStruct::Reader)transportVal.asReader().getRawInfo())) {
+    auto expectedRawInfo = gateInfo.asReader().getRawInfo();
+    auto actualRawInfo = transportVal.asReader().getRawInfo();
+    if (expectedRawInfo.getIntegerPrecision() !=
+            actualRawInfo.getIntegerPrecision() ||
+        expectedRawInfo.getIsSigned() != actualRawInfo.getIsSigned() ||
+        !protocol::isCompatibleWithShape(
+            protocol::protoShapeToDimensions(actualRawInfo.getShape()),
+            expectedRawInfo.getShape())) {
       std::string expected =
           gateInfo.asReader().getRawInfo().toString().flatten().cStr();
       std::string actual =
@@ -241,14 +278,11 @@ getTransportValueVerifier(const Message<concreteprotocol::GateInfo> &gateInfo) {
 
 Result<Transformer> getBooleanEncodingTransformer() {
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-
-    for (size_t i = 0; i < inputTensor.values.size(); i++) {
-      outputTensor.values[i] = inputTensor.values[i] << 61;
+    auto tensor = takeTensor<uint64_t>(input);
+    for (auto &value : tensor.values) {
+      value <<= 61;
     }
-
-    return Value{outputTensor};
+    return Value{std::move(tensor)};
   };
 }
 
@@ -258,18 +292,11 @@ Result<Transformer> getNativeModeIntegerEncodingTransformer(
   auto isSigned = info.asReader().getIsSigned();
 
   return [=](Value input) {
-    Tensor<uint64_t> inputTensor;
-    if (isSigned) {
-      inputTensor = (Tensor<uint64_t>)input.getTensor<int64_t>().value();
-    } else {
-      inputTensor = input.getTensor<uint64_t>().value();
+    auto tensor = takeUnsignedTensor(input, isSigned);
+    for (auto &value : tensor.values) {
+      value <<= (64 - (width + 1));
     }
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-
-    for (size_t i = 0; i < inputTensor.values.size(); i++) {
-      outputTensor.values[i] = inputTensor.values[i] << (64 - (width + 1));
-    }
-    return Value{outputTensor};
+    return Value{std::move(tensor)};
   };
 }
 
@@ -279,11 +306,10 @@ Result<Transformer> getNativeModeIntegerDecodingTransformer(
   auto isSigned = info.asReader().getIsSigned();
 
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
+    auto tensor = takeTensor<uint64_t>(input);
 
-    for (size_t i = 0; i < inputTensor.values.size(); i++) {
-      auto input = inputTensor.values[i];
+    for (auto &value : tensor.values) {
+      auto input = value;
 
       // Decode unsigned integer
       uint64_t output = input >> (64 - precision - 2);
@@ -302,18 +328,10 @@ Result<Transformer> getNativeModeIntegerDecodingTransformer(
         };
       }
 
-      outputTensor.values[i] = output;
+      value = output;
     }
 
-    Value output;
-    if (isSigned) {
-      auto signedOutputTensor = (Tensor<int64_t>)outputTensor;
-      output = Value{signedOutputTensor};
-    } else {
-      output = Value{outputTensor};
-    }
-
-    return output;
+    return intoIntegerValue(std::move(tensor), isSigned);
   };
 }
 
@@ -325,15 +343,10 @@ Result<Transformer> getChunkedModeIntegerEncodingTransformer(
   uint64_t mask = (1 << chunkWidth) - 1;
 
   return [=](Value input) {
-    Tensor<uint64_t> inputTensor;
-    if (isSigned) {
-      inputTensor = (Tensor<uint64_t>)input.getTensor<int64_t>().value();
-    } else {
-      inputTensor = input.getTensor<uint64_t>().value();
-    }
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.push_back(size);
-    outputTensor.values.resize(outputTensor.values.size() * size);
+    auto inputTensor = takeUnsignedTensor(input, isSigned);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.push_back(size);
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
 
     for (size_t i = 0; i < inputTensor.values.size(); i++) {
       auto value = inputTensor.values[i];
@@ -345,7 +358,7 @@ Result<Transformer> getChunkedModeIntegerEncodingTransformer(
       }
     }
 
-    return Value{outputTensor};
+    return Value{std::move(outputTensor)};
   };
 }
 
@@ -357,10 +370,10 @@ Result<Transformer> getChunkedModeIntegerDecodingTransformer(
   uint64_t mask = (1 << chunkWidth) - 1;
 
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.pop_back();
-    outputTensor.values.resize(outputTensor.values.size() / chunkSize);
+    auto inputTensor = takeTensor<uint64_t>(input);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.pop_back();
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
 
     for (size_t i = 0; i < outputTensor.values.size(); i++) {
       uint64_t output = 0;
@@ -390,15 +403,7 @@ Result<Transformer> getChunkedModeIntegerDecodingTransformer(
       outputTensor.values[i] = output;
     }
 
-    Value output;
-    if (isSigned) {
-      auto signedOutputTensor = (Tensor<int64_t>)outputTensor;
-      output = Value{signedOutputTensor};
-    } else {
-      output = Value{outputTensor};
-    }
-
-    return output;
+    return intoIntegerValue(std::move(outputTensor), isSigned);
   };
 }
 
@@ -413,15 +418,10 @@ Result<Transformer> getCrtModeIntegerEncodingTransformer(
   auto isSigned = info.asReader().getIsSigned();
 
   return [=](Value input) {
-    Tensor<uint64_t> inputTensor;
-    if (isSigned) {
-      inputTensor = (Tensor<uint64_t>)input.getTensor<int64_t>().value();
-    } else {
-      inputTensor = input.getTensor<uint64_t>().value();
-    }
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.push_back(size);
-    outputTensor.values.resize(outputTensor.values.size() * size);
+    auto inputTensor = takeUnsignedTensor(input, isSigned);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.push_back(size);
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
 
     for (size_t i = 0; i < inputTensor.values.size(); i++) {
       auto value = inputTensor.values[i];
@@ -431,7 +431,7 @@ Result<Transformer> getCrtModeIntegerEncodingTransformer(
       }
     }
 
-    return Value{outputTensor};
+    return Value{std::move(outputTensor)};
   };
 }
 
@@ -441,49 +441,37 @@ Result<Transformer> getCrtModeIntegerDecodingTransformer(
   for (auto modulus : info.asReader().getMode().getCrt().getModuli()) {
     moduli.push_back(modulus);
   }
-  std::vector<int64_t> remainders(
-      info.asReader().getMode().getCrt().getModuli().size());
-  auto size = info.asReader().getMode().getCrt().getModuli().size();
+  auto size = moduli.size();
   auto isSigned = info.asReader().getIsSigned();
+  // The inverse crt only depends on the moduli, so it is computed once
+  uint64_t product = crt::productOfModuli(moduli);
+  auto coefficients = crt::iCrtCoefficients(moduli);
 
-  return [=](Value input) mutable {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.pop_back();
-    outputTensor.values.resize(outputTensor.values.size() / size);
+  return [=](Value input) {
+    auto inputTensor = takeTensor<uint64_t>(input);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.pop_back();
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
+    uint64_t maxPos = product / 2;
 
     for (size_t i = 0; i < outputTensor.values.size(); i++) {
-      for (size_t j = 0; j < (size_t)size; j++) {
-        remainders[j] =
-            crt::decode(inputTensor.values[i * size + j], moduli[j]);
-      }
-
       // Compute the inverse crt
-      uint64_t output = crt::iCrt(moduli, remainders);
+      __uint128_t sum = 0;
+      for (size_t j = 0; j < size; j++) {
+        sum += (__uint128_t)crt::decode(inputTensor.values[i * size + j],
+                                        moduli[j]) *
+               coefficients[j];
+      }
+      uint64_t output = sum % product;
 
       // Further decode signed integers
-      if (isSigned) {
-        uint64_t maxPos = 1;
-        for (auto prime : moduli) {
-          maxPos *= prime;
-        }
-        maxPos /= 2;
-        if (output >= maxPos) {
-          output -= maxPos * 2;
-        }
+      if (isSigned && output >= maxPos) {
+        output -= maxPos * 2;
       }
       outputTensor.values[i] = output;
     }
 
-    Value output;
-    if (isSigned) {
-      auto signedOutputTensor = (Tensor<int64_t>)outputTensor;
-      output = Value{signedOutputTensor};
-    } else {
-      output = Value{outputTensor};
-    }
-
-    return output;
+    return intoIntegerValue(std::move(outputTensor), isSigned);
   };
 }
 
@@ -498,18 +486,19 @@ Result<Transformer> getEncryptionTransformer(
   auto variance = info.asReader().getVariance();
 
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.push_back(lweSize);
-    outputTensor.values.resize(outputTensor.values.size() * lweSize);
-
-    for (size_t i = 0; i < inputTensor.values.size(); i++) {
-      concrete_cpu_encrypt_lwe_ciphertext_u64(
-          key.getRawPtr(), &outputTensor.values[i * lweSize],
-          inputTensor.values[i], lweDimension, variance, csprng->ptr);
-    }
-
-    return Value{outputTensor};
+    auto inputTensor = takeTensor<uint64_t>(input);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.push_back(lweSize);
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
+
+    // The ciphertexts are encrypted in parallel on streams forked from the
+    // csprng, so that they only depend on its seed.
+    concrete_cpu_encrypt_lwe_ciphertext_list_u64(
+        key.getRawPtr(), outputTensor.values.data(), inputTensor.values.data(),
+        lweDimension, inputTensor.values.size(), variance, csprng->ptr,
+        Parallelism::Rayon);
+
+    return Value{std::move(outputTensor)};
   };
 }
 
@@ -522,12 +511,12 @@ Result<Transformer> getSeededEncryptionTransformer(
   auto variance = info.asReader().getVariance();
 
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
+    auto inputTensor = takeTensor<uint64_t>(input);
     // 3 = 2 (seed) + 1 (encrypted scalar)
     auto const ciphertextSize = 3;
-    outputTensor.dimensions.push_back(ciphertextSize);
-    outputTensor.values.resize(outputTensor.values.size() * ciphertextSize);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.push_back(ciphertextSize);
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
     struct Uint128 seed;
     for (size_t i = 0; i < inputTensor.values.size(); i++) {
       csprng::getRandomSeed(&seed);
@@ -538,7 +527,7 @@ Result<Transformer> getSeededEncryptionTransformer(
           key.getRawPtr(), &outputTensor.values[i * 3 + 2],
           inputTensor.values[i], lweDimension, seed, variance);
     }
-    return Value{outputTensor};
+    return Value{std::move(outputTensor)};
   };
 }
 
@@ -549,15 +538,11 @@ Result<Transformer> getEncryptionSimulationTransformer(
   auto lweDimension = info.asReader().getLweDimension();
 
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-
-    for (size_t i = 0; i < inputTensor.values.size(); i++) {
-      outputTensor.values[i] = sim_encrypt_lwe_u64(
-          inputTensor.values[i], lweDimension, (void *)(*csprng).ptr);
+    auto tensor = takeTensor<uint64_t>(input);
+    for (auto &value : tensor.values) {
+      value = sim_encrypt_lwe_u64(value, lweDimension, (void *)(*csprng).ptr);
     }
-
-    return Value{outputTensor};
+    return Value{std::move(tensor)};
   };
 }
 
@@ -567,21 +552,19 @@ Result<Transformer> getDecryptionTransformer(
 
   auto key = keyset.lweSecretKeys[info.asReader().getKeyId()];
   auto lweDimension = info.asReader().getLweDimension();
-  auto lweSize = lweDimension + 1;
 
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.pop_back();
-    outputTensor.values.resize(outputTensor.values.size() / lweSize);
+    auto inputTensor = takeTensor<uint64_t>(input);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.pop_back();
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
 
-    for (size_t i = 0; i < outputTensor.values.size(); i++) {
-      concrete_cpu_decrypt_lwe_ciphertext_u64(
-          key.getRawPtr(), &inputTensor.values[i * lweSize], lweDimension,
-          &outputTensor.values[i]);
-    }
+    concrete_cpu_decrypt_lwe_ciphertext_list_u64(
+        key.getRawPtr(), inputTensor.values.data(), lweDimension,
+        outputTensor.values.size(), outputTensor.values.data(),
+        Parallelism::Rayon);
 
-    return Value{outputTensor};
+    return Value{std::move(outputTensor)};
   };
 }
 
@@ -597,21 +580,77 @@ Result<Transformer> getNoneDecompressionTransformer() {
   return [](auto input) { return input; };
 }
 
+/// Returns a transformer switching the coefficients of the ciphertexts of
+/// `info` to its compressed modulus, and packing them in the last dimension of
+/// its concrete shape.
+Result<Transformer> getModulusSwitchCompressionTransformer(
+    const Message<concreteprotocol::LweCiphertextTypeInfo> &info) {
+  size_t lweSize = info.asReader().getEncryption().getLweDimension() + 1;
+  uint32_t modulusLog = info.asReader().getCompressedModulusLog();
+  auto shape = info.asReader().getConcreteShape().getDimensions();
+  size_t compressedSize = shape[shape.size() - 1];
+  if (modulusLog == 0 || modulusLog >= 64 ||
+      compressedSize != (lweSize * modulusLog + 63) / 64) {
+    return StringError("Invalid modulus switch compression of ciphertexts.");
+  }
+
+  return [=](Value input) -> Value {
+    // Read in place, as it may live in the arena of the call
+    auto &inputTensor = *input.getTensorPtr<uint64_t>();
+    auto dimensions = inputTensor.dimensions;
+    dimensions.back() = compressedSize;
+
+    size_t count = inputTensor.size() / lweSize;
+    auto outputTensor = Tensor<uint64_t>::build(
+        dimensions, [&](uint64_t *output, size_t) {
+          for (size_t i = 0; i < count; i++) {
+            modulusSwitchCompress(&inputTensor.data()[i * lweSize], lweSize,
+                                  modulusLog, &output[i * compressedSize]);
+          }
+        });
+    return Value{std::move(outputTensor)};
+  };
+}
+
+Result<Transformer> getModulusSwitchDecompressionTransformer(
+    const Message<concreteprotocol::LweCiphertextTypeInfo> &info) {
+  size_t lweSize = info.asReader().getEncryption().getLweDimension() + 1;
+  uint32_t modulusLog = info.asReader().getCompressedModulusLog();
+  auto shape = info.asReader().getConcreteShape().getDimensions();
+  size_t compressedSize = shape[shape.size() - 1];
+  if (modulusLog == 0 || modulusLog >= 64 ||
+      compressedSize != (lweSize * modulusLog + 63) / 64) {
+    return StringError("Invalid modulus switch compression of ciphertexts.");
+  }
+
+  return [=](Value input) -> Value {
+    auto inputTensor = takeTensor<uint64_t>(input);
+    auto dimensions = inputTensor.dimensions;
+    dimensions.back() = lweSize;
+    auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
+
+    size_t count = inputTensor.values.size() / compressedSize;
+    for (size_t i = 0; i < count; i++) {
+      modulusSwitchDecompress(&inputTensor.values[i * compressedSize], lweSize,
+                              modulusLog, &outputTensor.values[i * lweSize]);
+    }
+    return Value{std::move(outputTensor)};
+  };
+}
+
 Result<Transformer> getBooleanDecodingTransformer() {
   return [=](Value input) {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
+    auto tensor = takeTensor<uint64_t>(input);
 
-    for (size_t i = 0; i < inputTensor.values.size(); i++) {
-      auto input = inputTensor.values[i];
-      uint64_t output = input >> 60;
+    for (auto &value : tensor.values) {
+      uint64_t output = value >> 60;
       uint64_t carry = output % 2;
       uint64_t mod = 1 << 3;
       output = ((output >> 1) + carry) % mod;
-      outputTensor.values[i] = output;
+      value = output;
     }
 
-    return Value{outputTensor};
+    return Value{std::move(tensor)};
   };
 }
 
@@ -669,7 +708,7 @@ Result<OutputTransformer> TransformerFactory::getIndexOutputTransformer(
         "Tried to get index output transformer from non-index gate info.");
   }
   OUTCOME_TRY(auto verify, getTransportValueVerifier(gateInfo));
-  return [=](TransportValue transportVal) -> Result<Value> {
+  return [=](const TransportValue &transportVal) -> Result<Value> {
     OUTCOME_TRYV(verify(transportVal));
     return Value::fromRawTransportValue(transportVal);
   };
@@ -721,7 +760,7 @@ Result<OutputTransformer> TransformerFactory::getPlaintextOutputTransformer(
                        "non-plaintext gate info.");
   }
   OUTCOME_TRY(auto verify, getTransportValueVerifier(gateInfo));
-  return [=](TransportValue transportVal) -> Result<Value> {
+  return [=](const TransportValue &transportVal) -> Result<Value> {
     OUTCOME_TRYV(verify(transportVal));
     return Value::fromRawTransportValue(transportVal);
   };
@@ -826,8 +865,8 @@ Result<InputTransformer> TransformerFactory::getLweCiphertextInputTransformer(
   OUTCOME_TRY(auto verify, getLweCiphertextInputValueVerifier(gateInfo));
   return [=](Value val) -> Result<TransportValue> {
     OUTCOME_TRYV(verify(val));
-    auto output =
-        encryptionTransformer(encodingTransformer(val)).intoRawTransportValue();
+    auto output = encryptionTransformer(encodingTransformer(std::move(val)))
+                      .intoRawTransportValue();
     output.asBuilder().initTypeInfo().setLweCiphertext(
         gateInfo.asReader().getTypeInfo().getLweCiphertext());
     return output;
@@ -840,23 +879,20 @@ Result<Transformer> getSeededLweCiphertextDecompressionTransformer(
   auto lweDimension = info.asReader().getLweDimension();
   auto lweSize = lweDimension + 1;
   return [=](Value input) -> Value {
-    auto inputTensor = input.getTensor<uint64_t>().value();
-    auto outputTensor = Tensor<uint64_t>(inputTensor);
-    outputTensor.dimensions.back() = lweSize;
-    auto size = 1;
-    for (auto d : outputTensor.dimensions) {
-      size *= d;
-    }
-    outputTensor.values.resize(size);
-
-    for (size_t i = 0; i < inputTensor.values.size(); i += 3) {
-      Uint128 seed;
-      csprng::readSeed(seed, &inputTensor.values[i]);
-      concrete_cpu_decompress_seeded_lwe_ciphertext_u64(
-          &outputTensor.values[(i / 3) * lweSize], &inputTensor.values[i + 2],
-          lweDimension, seed);
-    }
-    return Value{outputTensor};
+    // Read in place, as it may be borrowed from the transport value
+    auto &inputTensor = *input.getTensorPtr<uint64_t>();
+    auto dimensions = inputTensor.dimensions;
+    dimensions.back() = lweSize;
+
+    // The output tensor is the buffer later handed to the circuit, so the
+    // ciphertexts are decompressed right where they are used.
+    auto outputTensor = Tensor<uint64_t>::build(
+        dimensions, [&](uint64_t *output, size_t) {
+          concrete_cpu_decompress_seeded_lwe_ciphertext_list_u64(
+              output, inputTensor.data(), lweDimension,
+              inputTensor.size() / 3, Parallelism::Rayon);
+        });
+    return Value{std::move(outputTensor)};
   };
 }
 
@@ -891,9 +927,12 @@ Result<ArgTransformer> TransformerFactory::getLweCiphertextArgTransformer(
     OUTCOME_TRY(verify, getTransportValueVerifier(gateInfo));
   }
 
-  return [=](TransportValue transportVal) -> Result<Value> {
+  return [=](const TransportValue &transportVal) -> Result<Value> {
     OUTCOME_TRYV(verify(transportVal));
-    return decompressionTransformer(Value::fromRawTransportValue(transportVal));
+    // The arguments are only used while the circuit is called, so that the
+    // ciphertexts are handed to it straight from the payload
+    return decompressionTransformer(
+        Value::borrowRawTransportValue(transportVal));
   };
 }
 
@@ -906,13 +945,16 @@ Result<ReturnTransformer> TransformerFactory::getLweCiphertextReturnTransformer(
 
   /// Generating the compression transformer.
   Transformer compressionTransformer;
-  if (gateInfo.asReader().getTypeInfo().getLweCiphertext().getCompression() ==
-      concreteprotocol::Compression::NONE) {
+  auto lweCiphertextInfo = gateInfo.asReader().getTypeInfo().getLweCiphertext();
+  auto compression = lweCiphertextInfo.getCompression();
+  if (compression == concreteprotocol::Compression::NONE || useSimulation) {
     OUTCOME_TRY(compressionTransformer, getNoneCompressionTransformer());
+  } else if (compression == concreteprotocol::Compression::MODULUS_SWITCH) {
+    OUTCOME_TRY(compressionTransformer,
+                getModulusSwitchCompressionTransformer(lweCiphertextInfo));
   } else {
-    return StringError(
-        "Only none compression is currently supported for lwe ciphertext "
-        "currently.");
+    return StringError("Only none and modulus switch compressions are "
+                       "supported for output lwe ciphertexts.");
   }
 
   // Generating the verifier.
@@ -924,8 +966,10 @@ Result<ReturnTransformer> TransformerFactory::getLweCiphertextReturnTransformer(
   }
 
   return [=](Value val) -> Result<TransportValue> {
-    OUTCOME_TRYV(verify(val));
-    auto output = compressionTransformer(val).intoRawTransportValue();
+    // The concrete shape is the one of the compressed ciphertexts
+    auto compressed = compressionTransformer(std::move(val));
+    OUTCOME_TRYV(verify(compressed));
+    auto output = compressed.intoRawTransportValue();
     output.asBuilder().initTypeInfo().setLweCiphertext(
         gateInfo.asReader().getTypeInfo().getLweCiphertext());
     return output;
@@ -954,13 +998,16 @@ Result<OutputTransformer> TransformerFactory::getLweCiphertextOutputTransformer(
 
   /// Generating the decompression transformer.
   Transformer decompressionTransformer;
-  if (gateInfo.asReader().getTypeInfo().getLweCiphertext().getCompression() ==
-      concreteprotocol::Compression::NONE) {
+  auto lweCiphertextInfo = gateInfo.asReader().getTypeInfo().getLweCiphertext();
+  auto compression = lweCiphertextInfo.getCompression();
+  if (compression == concreteprotocol::Compression::NONE || useSimulation) {
     OUTCOME_TRY(decompressionTransformer, getNoneDecompressionTransformer());
+  } else if (compression == concreteprotocol::Compression::MODULUS_SWITCH) {
+    OUTCOME_TRY(decompressionTransformer,
+                getModulusSwitchDecompressionTransformer(lweCiphertextInfo));
   } else {
-    return StringError(
-        "Only none compression is currently supported for lwe ciphertext "
-        "currently.");
+    return StringError("Only none and modulus switch compressions are "
+                       "supported for output lwe ciphertexts.");
   }
 
   /// Generating the decryption transformer.
@@ -1006,7 +1053,7 @@ Result<OutputTransformer> TransformerFactory::getLweCiphertextOutputTransformer(
     OUTCOME_TRY(verify, getTransportValueVerifier(gateInfo));
   }
 
-  return [=](TransportValue transportVal) -> Result<Value> {
+  return [=](const TransportValue &transportVal) -> Result<Value> {
     OUTCOME_TRYV(verify(transportVal));
     return decodingTransformer(decryptionTransformer(
         decompressionTransformer(Value::fromRawTransportValue(transportVal))));
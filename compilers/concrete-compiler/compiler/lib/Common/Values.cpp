@@ -10,6 +10,7 @@
 #include "concretelang/Common/Error.h"
 #include "concretelang/Common/Protocol.h"
 #include <cstddef>
+#include <algorithm>
 #include <cstdint>
 #include <stdlib.h>
 #include <string>
@@ -25,7 +26,19 @@ using concretelang::protocol::vectorToProtoPayload;
 namespace concretelang {
 namespace values {
 
-Value Value::fromRawTransportValue(TransportValue transportVal) {
+namespace {
+template <typename T>
+Tensor<T> payloadToTensor(concreteprotocol::Payload::Reader payload,
+                          std::vector<size_t> dimensions, bool borrow) {
+  size_t size = 0;
+  const T *data =
+      borrow ? protocol::protoPayloadData<T>(payload, size) : nullptr;
+  if (data != nullptr)
+    return Tensor<T>::borrow(data, size, std::move(dimensions));
+  return Tensor<T>{protoPayloadToVector<T>(payload), std::move(dimensions)};
+}
+
+Value readRawTransportValue(const TransportValue &transportVal, bool borrow) {
   Value output;
   auto integerPrecision =
       transportVal.asReader().getRawInfo().getIntegerPrecision();
@@ -34,35 +47,36 @@ Value Value::fromRawTransportValue(TransportValue transportVal) {
       protoShapeToDimensions(transportVal.asReader().getRawInfo().getShape());
   auto data = transportVal.asReader().getPayload();
   if (integerPrecision == 8 && isSigned) {
-    auto values = protoPayloadToVector<int8_t>(data);
-    output.inner = Tensor<int8_t>{values, dimensions};
+    output.inner = payloadToTensor<int8_t>(data, dimensions, borrow);
   } else if (integerPrecision == 16 && isSigned) {
-    auto values = protoPayloadToVector<int16_t>(data);
-    output.inner = Tensor<int16_t>{values, dimensions};
+    output.inner = payloadToTensor<int16_t>(data, dimensions, borrow);
   } else if (integerPrecision == 32 && isSigned) {
-    auto values = protoPayloadToVector<int32_t>(data);
-    output.inner = Tensor<int32_t>{values, dimensions};
+    output.inner = payloadToTensor<int32_t>(data, dimensions, borrow);
   } else if (integerPrecision == 64 && isSigned) {
-    auto values = protoPayloadToVector<int64_t>(data);
-    output.inner = Tensor<int64_t>{values, dimensions};
+    output.inner = payloadToTensor<int64_t>(data, dimensions, borrow);
   } else if (integerPrecision == 8 && !isSigned) {
-    auto values = protoPayloadToVector<uint8_t>(data);
-    output.inner = Tensor<uint8_t>{values, dimensions};
+    output.inner = payloadToTensor<uint8_t>(data, dimensions, borrow);
   } else if (integerPrecision == 16 && !isSigned) {
-    auto values = protoPayloadToVector<uint16_t>(data);
-    output.inner = Tensor<uint16_t>{values, dimensions};
+    output.inner = payloadToTensor<uint16_t>(data, dimensions, borrow);
   } else if (integerPrecision == 32 && !isSigned) {
-    auto values = protoPayloadToVector<uint32_t>(data);
-    output.inner = Tensor<uint32_t>{values, dimensions};
+    output.inner = payloadToTensor<uint32_t>(data, dimensions, borrow);
   } else if (integerPrecision == 64 && !isSigned) {
-    auto values = protoPayloadToVector<uint64_t>(data);
-    output.inner = Tensor<uint64_t>{values, dimensions};
+    output.inner = payloadToTensor<uint64_t>(data, dimensions, borrow);
   } else {
     assert(false);
   }
 
   return output;
 }
+} // namespace
+
+Value Value::fromRawTransportValue(const TransportValue &transportVal) {
+  return readRawTransportValue(transportVal, false);
+}
+
+Value Value::borrowRawTransportValue(const TransportValue &transportVal) {
+  return readRawTransportValue(transportVal, true);
+}
 
 TransportValue Value::intoRawTransportValue() const {
   auto output = Message<concreteprotocol::Value>();
@@ -70,7 +84,13 @@ TransportValue Value::intoRawTransportValue() const {
   rawInfo.setShape(intoProtoShape().asReader());
   rawInfo.setIntegerPrecision(getIntegerPrecision());
   rawInfo.setIsSigned(isSigned());
-  output.asBuilder().setPayload(intoProtoPayload().asReader());
+  // The payload is written in place rather than copied from a message
+  auto payload = output.asBuilder().initPayload();
+  std::visit(
+      [&](const auto &tensor) {
+        protocol::arrayToProtoPayload(tensor.data(), tensor.size(), payload);
+      },
+      inner);
   return output;
 }
 
@@ -128,105 +148,24 @@ Message<concreteprotocol::Shape> Value::intoProtoShape() const {
 }
 
 std::vector<size_t> Value::getDimensions() const {
-  if (auto tensor = getTensor<uint8_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<uint16_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<uint32_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<uint64_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<int8_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<int16_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<int32_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else if (auto tensor = getTensor<int64_t>(); tensor) {
-    return tensor.value().dimensions;
-  } else {
-    assert(false);
-  }
+  return std::visit([](const auto &tensor) { return tensor.dimensions; },
+                    inner);
 }
 
 size_t Value::getLength() const {
-  if (auto tensor = getTensor<uint8_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<uint16_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<uint32_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<uint64_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<int8_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<int16_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<int32_t>(); tensor) {
-    return tensor.value().values.size();
-  } else if (auto tensor = getTensor<int64_t>(); tensor) {
-    return tensor.value().values.size();
-  } else {
-    assert(false);
-  }
+  return std::visit([](const auto &tensor) { return tensor.size(); }, inner);
 }
 
 bool Value::isCompatibleWithShape(
     const Message<concreteprotocol::Shape> &shape) const {
-  auto dimensions = getDimensions();
-  if ((uint32_t)shape.asReader().getDimensions().size() != dimensions.size()) {
-    return false;
-  }
-  for (uint32_t i = 0; i < dimensions.size(); i++) {
-    if (shape.asReader().getDimensions()[i] != dimensions[i]) {
-      return false;
-    }
-  }
-  return true;
+  return protocol::isCompatibleWithShape(getDimensions(), shape.asReader());
 }
 
-bool Value::operator==(const Value &b) const {
-  if (auto tensor = getTensor<uint8_t>(); tensor) {
-    return tensor == b.getTensor<uint8_t>();
-  } else if (auto tensor = getTensor<uint16_t>(); tensor) {
-    return tensor == b.getTensor<uint16_t>();
-  } else if (auto tensor = getTensor<uint32_t>(); tensor) {
-    return tensor == b.getTensor<uint32_t>();
-  } else if (auto tensor = getTensor<uint64_t>(); tensor) {
-    return tensor == b.getTensor<uint64_t>();
-  } else if (auto tensor = getTensor<int8_t>(); tensor) {
-    return tensor == b.getTensor<int8_t>();
-  } else if (auto tensor = getTensor<int16_t>(); tensor) {
-    return tensor == b.getTensor<int16_t>();
-  } else if (auto tensor = getTensor<int32_t>(); tensor) {
-    return tensor == b.getTensor<int32_t>();
-  } else if (auto tensor = getTensor<int64_t>(); tensor) {
-    return tensor == b.getTensor<int64_t>();
-  } else {
-    assert(false);
-  }
-}
+bool Value::operator==(const Value &b) const { return inner == b.inner; }
 
 bool Value::isScalar() const {
-  if (auto tensor = getTensor<int8_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<int16_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<int32_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<int64_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<uint8_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<uint16_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<uint32_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else if (auto tensor = getTensor<uint64_t>(); tensor) {
-    return tensor.value().isScalar();
-  } else {
-    assert(false);
-  }
+  return std::visit([](const auto &tensor) { return tensor.isScalar(); },
+                    inner);
 }
 
 Value Value::toUnsigned() const {
@@ -314,5 +253,296 @@ size_t getCorrespondingPrecision(size_t originalPrecision) {
   assert(false);
 }
 
+/// Returns the size in bytes of the payload described by `rawInfo`.
+void modulusSwitchCompress(const uint64_t *in, size_t lweSize,
+                           uint32_t modulusLog, uint64_t *out) {
+  uint64_t mask = (((uint64_t)1) << modulusLog) - 1;
+  for (size_t j = 0; j < lweSize; j++) {
+    // Round to the closest multiple of the new step
+    uint64_t coefficient = (((in[j] >> (63 - modulusLog)) + 1) >> 1) & mask;
+    size_t bit = j * modulusLog;
+    out[bit / 64] |= coefficient << (bit % 64);
+    if (bit % 64 + modulusLog > 64) {
+      out[bit / 64 + 1] |= coefficient >> (64 - bit % 64);
+    }
+  }
+}
+
+void modulusSwitchDecompress(const uint64_t *in, size_t lweSize,
+                             uint32_t modulusLog, uint64_t *out) {
+  uint64_t mask = (((uint64_t)1) << modulusLog) - 1;
+  for (size_t j = 0; j < lweSize; j++) {
+    size_t bit = j * modulusLog;
+    uint64_t coefficient = in[bit / 64] >> (bit % 64);
+    if (bit % 64 + modulusLog > 64) {
+      coefficient |= in[bit / 64 + 1] << (64 - bit % 64);
+    }
+    out[j] = (coefficient & mask) << (64 - modulusLog);
+  }
+}
+
+Result<size_t> getPayloadSize(concreteprotocol::RawInfo::Reader rawInfo) {
+  auto precision = rawInfo.getIntegerPrecision();
+  if (precision != 8 && precision != 16 && precision != 32 && precision != 64) {
+    return StringError("Unsupported transport value precision: ") << precision;
+  }
+  size_t size = precision / 8;
+  for (auto dim : rawInfo.getShape().getDimensions()) {
+    size *= dim;
+  }
+  return size;
+}
+
+Result<TransportValueWriter>
+TransportValueWriter::open(std::ostream &ostream,
+                           const TransportValue &header) {
+  auto rawInfo = header.asReader().getRawInfo();
+  OUTCOME_TRY(auto size, getPayloadSize(rawInfo));
+  auto output = TransportValue();
+  output.asBuilder().setRawInfo(rawInfo);
+  output.asBuilder().setTypeInfo(header.asReader().getTypeInfo());
+  OUTCOME_TRYV(output.writeBinaryToOstream(ostream));
+  return TransportValueWriter(ostream, size);
+}
+
+Result<void> TransportValueWriter::write(const void *data, size_t size) {
+  if (size > remaining) {
+    return StringError("Tried to write ")
+           << size << " bytes to a transport value expecting " << remaining
+           << " more.";
+  }
+  if (size == 0) {
+    return outcome::success();
+  }
+  unsigned char sizeBytes[8];
+  for (size_t i = 0; i < 8; i++) {
+    sizeBytes[i] = (uint64_t)size >> (8 * i);
+  }
+  ostream.write(reinterpret_cast<const char *>(sizeBytes), 8);
+  ostream.write(static_cast<const char *>(data), size);
+  if (!ostream.good()) {
+    return StringError("Failed to write transport value chunk to ostream.");
+  }
+  remaining -= size;
+  return outcome::success();
+}
+
+Result<void> TransportValueWriter::close() {
+  if (remaining != 0) {
+    return StringError("Transport value closed with ")
+           << remaining << " bytes of payload left to write.";
+  }
+  ostream.flush();
+  if (!ostream.good()) {
+    return StringError("Failed to flush transport value to ostream.");
+  }
+  return outcome::success();
+}
+
+Result<TransportValueReader>
+TransportValueReader::open(std::istream &istream,
+                           capnp::ReaderOptions options) {
+  auto header = TransportValue();
+  OUTCOME_TRYV(header.readBinaryFromIstream(istream, options));
+  OUTCOME_TRY(auto size, getPayloadSize(header.asReader().getRawInfo()));
+  return TransportValueReader(istream, std::move(header), size);
+}
+
+Result<size_t> TransportValueReader::read(void *data, size_t size) {
+  size = std::min(size, remaining);
+  size_t done = 0;
+  while (done < size) {
+    if (chunkRemaining == 0) {
+      unsigned char sizeBytes[8];
+      istream.read(reinterpret_cast<char *>(sizeBytes), 8);
+      if (istream.gcount() != 8) {
+        return StringError("Truncated transport value chunk size.");
+      }
+      for (size_t i = 0; i < 8; i++) {
+        chunkRemaining |= (uint64_t)sizeBytes[i] << (8 * i);
+      }
+      if (chunkRemaining == 0 || chunkRemaining > remaining - done) {
+        return StringError("Invalid transport value chunk size: ")
+               << chunkRemaining;
+      }
+    }
+    size_t length = std::min(size - done, chunkRemaining);
+    istream.read(static_cast<char *>(data) + done, length);
+    if ((size_t)istream.gcount() != length) {
+      return StringError("Truncated transport value chunk.");
+    }
+    done += length;
+    chunkRemaining -= length;
+  }
+  remaining -= done;
+  return done;
+}
+
+Result<void> writeTransportValueChunked(const TransportValue &value,
+                                        std::ostream &ostream,
+                                        size_t chunkSize) {
+  OUTCOME_TRY(auto writer, TransportValueWriter::open(ostream, value));
+  for (auto blob : value.asReader().getPayload().getData()) {
+    for (size_t offset = 0; offset < blob.size(); offset += chunkSize) {
+      OUTCOME_TRYV(writer.write(blob.begin() + offset,
+                                std::min(chunkSize, blob.size() - offset)));
+    }
+  }
+  return writer.close();
+}
+
+Result<TransportValue> readTransportValueChunked(std::istream &istream,
+                                                 capnp::ReaderOptions options) {
+  OUTCOME_TRY(auto reader, TransportValueReader::open(istream, options));
+  auto output = reader.getHeader();
+  // The blobs are laid out as by `vectorToProtoPayload`
+  size_t elementSize =
+      output.asReader().getRawInfo().getIntegerPrecision() / 8;
+  size_t blobSize = capnp::MAX_TEXT_SIZE / elementSize * elementSize;
+  size_t size = reader.getRemaining();
+  size_t nbBlobs = (size + blobSize - 1) / blobSize;
+  auto data = output.asBuilder().initPayload().initData(nbBlobs);
+  for (size_t i = 0; i < nbBlobs; i++) {
+    auto blob = data.init(i, std::min(blobSize, size - i * blobSize));
+    OUTCOME_TRY(auto length, reader.read(blob.begin(), blob.size()));
+    if (length != blob.size()) {
+      return StringError("Truncated transport value payload.");
+    }
+  }
+  return output;
+}
+
+namespace {
+const char AT_REST_MAGIC[8] = {'C', 'N', 'C', 'R', 'V', 'A', 'L', '1'};
+
+/// The ciphertexts were modulus switched by `writeValueAtRest`, and are
+/// restored on read.
+const uint64_t AT_REST_MODULUS_SWITCHED = 1;
+
+/// Sets the last dimension of the raw and concrete shapes of a ciphertext.
+void setLweSize(TransportValue &value, size_t size) {
+  auto rawDims = value.asBuilder().getRawInfo().getShape().getDimensions();
+  rawDims.set(rawDims.size() - 1, size);
+  auto concreteDims = value.asBuilder()
+                          .getTypeInfo()
+                          .getLweCiphertext()
+                          .getConcreteShape()
+                          .getDimensions();
+  concreteDims.set(concreteDims.size() - 1, size);
+}
+} // namespace
+
+Result<void> writeValueAtRest(const TransportValue &value,
+                              std::ostream &ostream,
+                              uint32_t compressedModulusLog,
+                              size_t chunkSize) {
+  if (compressedModulusLog >= 64) {
+    return StringError("Invalid modulus switch compression of ciphertexts.");
+  }
+  auto typeInfo = value.asReader().getTypeInfo();
+  bool modulusSwitch =
+      compressedModulusLog != 0 && typeInfo.hasLweCiphertext() &&
+      typeInfo.getLweCiphertext().getCompression() ==
+          concreteprotocol::Compression::NONE;
+  uint64_t flags = modulusSwitch ? AT_REST_MODULUS_SWITCHED : 0;
+  unsigned char flagsBytes[8];
+  for (size_t i = 0; i < 8; i++) {
+    flagsBytes[i] = flags >> (8 * i);
+  }
+  ostream.write(AT_REST_MAGIC, 8);
+  ostream.write(reinterpret_cast<const char *>(flagsBytes), 8);
+  if (!ostream.good()) {
+    return StringError("Failed to write value header to ostream.");
+  }
+  if (!modulusSwitch) {
+    return writeTransportValueChunked(value, ostream, chunkSize);
+  }
+
+  size_t lweSize =
+      typeInfo.getLweCiphertext().getEncryption().getLweDimension() + 1;
+  size_t compressedSize = (lweSize * compressedModulusLog + 63) / 64;
+  auto input = Value::borrowRawTransportValue(value);
+  if (!input.hasElementType<uint64_t>() || input.getDimensions().empty() ||
+      input.getDimensions().back() != lweSize) {
+    return StringError("Invalid ciphertext value to store at rest.");
+  }
+  auto &tensor = *input.getTensorPtr<uint64_t>();
+
+  auto header = TransportValue();
+  header.asBuilder().setRawInfo(value.asReader().getRawInfo());
+  header.asBuilder().setTypeInfo(typeInfo);
+  auto lweInfo = header.asBuilder().getTypeInfo().getLweCiphertext();
+  lweInfo.setCompression(concreteprotocol::Compression::MODULUS_SWITCH);
+  lweInfo.setCompressedModulusLog(compressedModulusLog);
+  setLweSize(header, compressedSize);
+  OUTCOME_TRY(auto writer, TransportValueWriter::open(ostream, header));
+
+  // The ciphertexts are compressed one chunk at a time
+  size_t count = tensor.size() / lweSize;
+  size_t chunkCount = std::max<size_t>(chunkSize / 8 / compressedSize, 1);
+  std::vector<uint64_t> chunk;
+  for (size_t i = 0; i < count; i += chunkCount) {
+    size_t n = std::min(chunkCount, count - i);
+    chunk.assign(n * compressedSize, 0);
+    for (size_t j = 0; j < n; j++) {
+      modulusSwitchCompress(&tensor.data()[(i + j) * lweSize], lweSize,
+                            compressedModulusLog, &chunk[j * compressedSize]);
+    }
+    OUTCOME_TRYV(writer.write(chunk.data(), chunk.size() * 8));
+  }
+  return writer.close();
+}
+
+Result<TransportValue> readValueAtRest(std::istream &istream,
+                                       capnp::ReaderOptions options) {
+  char magic[8];
+  unsigned char flagsBytes[8];
+  istream.read(magic, 8);
+  istream.read(reinterpret_cast<char *>(flagsBytes), 8);
+  if (istream.gcount() != 8 || !std::equal(magic, magic + 8, AT_REST_MAGIC)) {
+    return StringError("Not a value stored at rest.");
+  }
+  uint64_t flags = 0;
+  for (size_t i = 0; i < 8; i++) {
+    flags |= (uint64_t)flagsBytes[i] << (8 * i);
+  }
+  OUTCOME_TRY(auto stored, readTransportValueChunked(istream, options));
+  if ((flags & AT_REST_MODULUS_SWITCHED) == 0) {
+    return stored;
+  }
+
+  auto typeInfo = stored.asReader().getTypeInfo();
+  if (!typeInfo.hasLweCiphertext()) {
+    return StringError("Invalid ciphertext value stored at rest.");
+  }
+  auto lweInfo = typeInfo.getLweCiphertext();
+  size_t lweSize = lweInfo.getEncryption().getLweDimension() + 1;
+  uint32_t modulusLog = lweInfo.getCompressedModulusLog();
+  size_t compressedSize = (lweSize * modulusLog + 63) / 64;
+  auto input = Value::borrowRawTransportValue(stored);
+  if (modulusLog == 0 || modulusLog >= 64 ||
+      !input.hasElementType<uint64_t>() || input.getDimensions().empty() ||
+      input.getDimensions().back() != compressedSize) {
+    return StringError("Invalid ciphertext value stored at rest.");
+  }
+  auto &tensor = *input.getTensorPtr<uint64_t>();
+  auto dimensions = tensor.dimensions;
+  dimensions.back() = lweSize;
+  auto outputTensor = Tensor<uint64_t>::fromDimensions(dimensions);
+  size_t count = tensor.size() / compressedSize;
+  for (size_t i = 0; i < count; i++) {
+    modulusSwitchDecompress(&tensor.data()[i * compressedSize], lweSize,
+                            modulusLog, &outputTensor.values[i * lweSize]);
+  }
+
+  auto output = Value{std::move(outputTensor)}.intoRawTransportValue();
+  output.asBuilder().setTypeInfo(typeInfo);
+  auto outputLweInfo = output.asBuilder().getTypeInfo().getLweCiphertext();
+  outputLweInfo.setCompression(concreteprotocol::Compression::NONE);
+  outputLweInfo.setCompressedModulusLog(0);
+  setLweSize(output, lweSize);
+  return output;
+}
+
 } // namespace values
 } // namespace concretelang
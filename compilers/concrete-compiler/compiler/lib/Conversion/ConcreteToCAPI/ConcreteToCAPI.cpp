@@ -3,6 +3,7 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Pass/Pass.h>
 #include <mlir/Transforms/DialectConversion.h>
 
@@ -19,6 +20,7 @@ namespace Concrete = mlir::concretelang::Concrete;
 namespace arith = mlir::arith;
 namespace func = mlir::func;
 namespace memref = mlir::memref;
+namespace scf = mlir::scf;
 
 char memref_add_lwe_ciphertexts_u64[] = "memref_add_lwe_ciphertexts_u64";
 char memref_add_plaintext_lwe_ciphertext_u64[] =
@@ -44,6 +46,7 @@ char memref_batched_keyswitch_lwe_u64[] = "memref_batched_keyswitch_lwe_u64";
 char memref_batched_bootstrap_lwe_u64[] = "memref_batched_bootstrap_lwe_u64";
 char memref_batched_mapped_bootstrap_lwe_u64[] =
     "memref_batched_mapped_bootstrap_lwe_u64";
+char memref_many_lut_bootstrap_lwe_u64[] = "memref_many_lut_bootstrap_lwe_u64";
 
 char memref_keyswitch_async_lwe_u64[] = "memref_keyswitch_async_lwe_u64";
 char memref_bootstrap_async_lwe_u64[] = "memref_bootstrap_async_lwe_u64";
@@ -56,14 +59,23 @@ char memref_batched_bootstrap_lwe_cuda_u64[] =
     "memref_batched_bootstrap_lwe_cuda_u64";
 char memref_batched_mapped_bootstrap_lwe_cuda_u64[] =
     "memref_batched_mapped_bootstrap_lwe_cuda_u64";
+char memref_batched_keyswitch_bootstrap_lwe_cuda_u64[] =
+    "memref_batched_keyswitch_bootstrap_lwe_cuda_u64";
+char memref_batched_affine_keyswitch_bootstrap_lwe_cuda_u64[] =
+    "memref_batched_affine_keyswitch_bootstrap_lwe_cuda_u64";
+char memref_batched_keyswitch_bootstrap_lwe_u64[] =
+    "memref_batched_keyswitch_bootstrap_lwe_u64";
 char memref_expand_lut_in_trivial_glwe_ct_u64[] =
     "memref_expand_lut_in_trivial_glwe_ct_u64";
 
 char memref_wop_pbs_crt_buffer[] = "memref_wop_pbs_crt_buffer";
+char memref_wop_pbs_crt_cuda_u64[] = "memref_wop_pbs_crt_cuda_u64";
 
 char memref_encode_plaintext_with_crt[] = "memref_encode_plaintext_with_crt";
 char memref_encode_expand_lut_for_bootstrap[] =
     "memref_encode_expand_lut_for_bootstrap";
+char memref_encode_expand_many_lut_for_bootstrap[] =
+    "memref_encode_expand_many_lut_for_bootstrap";
 char memref_encode_lut_for_crt_woppbs[] = "memref_encode_lut_for_crt_woppbs";
 char memref_trace[] = "memref_trace";
 
@@ -162,6 +174,34 @@ mlir::LogicalResult insertForwardDeclarationOfTheCAPI(
                                         memref2DType, i32Type, i32Type, i32Type,
                                         i32Type, i32Type, i32Type, contextType},
                                        {});
+  } else if (funcName == memref_many_lut_bootstrap_lwe_u64) {
+    funcType = mlir::FunctionType::get(rewriter.getContext(),
+                                       {memref2DType, memref1DType,
+                                        memref1DType, i32Type, i32Type, i32Type,
+                                        i32Type, i32Type, i32Type, contextType},
+                                       {});
+  } else if (funcName == memref_batched_keyswitch_bootstrap_lwe_cuda_u64) {
+    funcType = mlir::FunctionType::get(
+        rewriter.getContext(),
+        {memref2DType, memref2DType, memref1DType, i32Type, i32Type, i32Type,
+         i32Type, i32Type, i32Type, i32Type, i32Type, i32Type, i32Type, i32Type,
+         contextType},
+        {});
+  } else if (funcName == memref_batched_keyswitch_bootstrap_lwe_u64) {
+    funcType = mlir::FunctionType::get(
+        rewriter.getContext(),
+        {memref2DType, memref2DType, memref1DType, i32Type, i32Type, i32Type,
+         i32Type, i32Type, i32Type, i32Type, i32Type, i32Type, i32Type, i32Type,
+         i32Type, contextType},
+        {});
+  } else if (funcName ==
+             memref_batched_affine_keyswitch_bootstrap_lwe_cuda_u64) {
+    funcType = mlir::FunctionType::get(
+        rewriter.getContext(),
+        {memref2DType, memref2DType, memref1DType, rewriter.getI64Type(),
+         rewriter.getI64Type(), i32Type, i32Type, i32Type, i32Type, i32Type,
+         i32Type, i32Type, i32Type, i32Type, i32Type, i32Type, contextType},
+        {});
   } else if (funcName == memref_await_future) {
     funcType = mlir::FunctionType::get(
         rewriter.getContext(),
@@ -176,7 +216,8 @@ mlir::LogicalResult insertForwardDeclarationOfTheCAPI(
                                            memref1DType,
                                        },
                                        {});
-  } else if (funcName == memref_wop_pbs_crt_buffer) {
+  } else if (funcName == memref_wop_pbs_crt_buffer ||
+             funcName == memref_wop_pbs_crt_cuda_u64) {
     funcType = mlir::FunctionType::get(rewriter.getContext(),
                                        {
                                            memref2DType,
@@ -211,6 +252,12 @@ mlir::LogicalResult insertForwardDeclarationOfTheCAPI(
         {memref1DType, memref1DType, rewriter.getI32Type(),
          rewriter.getI32Type(), rewriter.getI1Type()},
         {});
+  } else if (funcName == memref_encode_expand_many_lut_for_bootstrap) {
+    funcType = mlir::FunctionType::get(
+        rewriter.getContext(),
+        {memref1DType, memref2DType, rewriter.getI32Type(),
+         rewriter.getI32Type(), rewriter.getI1Type()},
+        {});
   } else if (funcName == memref_encode_lut_for_crt_woppbs) {
     funcType = mlir::FunctionType::get(
         rewriter.getContext(),
@@ -332,6 +379,162 @@ void bootstrapAddOperands(BootstrapOp op,
   operands.push_back(getContextArgument(op));
 }
 
+/// Returns the batched multiplication by a scalar cleartext, addition of a
+/// scalar plaintext or negation writing `buffer`, if it is a local allocation
+/// only written by it and only read by `reader` later in the same block.
+mlir::Operation *getScalarLeveledWriter(mlir::Value buffer,
+                                        mlir::Operation *reader) {
+  if (!buffer.getDefiningOp<memref::AllocOp>()) {
+    return nullptr;
+  }
+  mlir::Operation *writer = nullptr;
+  for (auto *user : buffer.getUsers()) {
+    if (user == reader || mlir::isa<memref::DeallocOp>(user)) {
+      continue;
+    }
+    if (writer ||
+        !mlir::isa<Concrete::BatchedMulCleartextCstLweBufferOp,
+                   Concrete::BatchedAddPlaintextCstLweBufferOp,
+                   Concrete::BatchedNegateLweBufferOp>(user) ||
+        user->getOperand(0) != buffer || user->getOperand(1) == buffer ||
+        user->getBlock() != reader->getBlock() ||
+        !user->isBeforeInBlock(reader)) {
+      return nullptr;
+    }
+    writer = user;
+  }
+  return writer;
+}
+
+/// Lowers a batched keyswitch whose result buffer is only read by a batched
+/// bootstrap to a single call of a fused keyswitch-bootstrap. On GPU, the
+/// keyswitched ciphertexts never leave the device, and if `affineFuncName` is
+/// given, the chain of scalar leveled operations computing the keyswitch input
+/// is composed into a single affine transformation applied on device by a call
+/// to it instead. On CPU, the batch is pipelined in chunks of `chunkSize`
+/// ciphertexts, which is passed to the call.
+struct BatchedKeySwitchBootstrapPattern
+    : public mlir::OpRewritePattern<Concrete::BatchedKeySwitchLweBufferOp> {
+  BatchedKeySwitchBootstrapPattern(::mlir::MLIRContext *context,
+                                   const char *funcName, int64_t chunkSize = 0,
+                                   const char *affineFuncName = nullptr,
+                                   mlir::PatternBenefit benefit = 2)
+      : ::mlir::OpRewritePattern<Concrete::BatchedKeySwitchLweBufferOp>(
+            context, benefit),
+        funcName(funcName), affineFuncName(affineFuncName),
+        chunkSize(chunkSize) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(Concrete::BatchedKeySwitchLweBufferOp ksOp,
+                  ::mlir::PatternRewriter &rewriter) const override {
+    // The intermediate buffer must be a local allocation only written by the
+    // keyswitch, read by a single bootstrap and then deallocated.
+    mlir::Value intermediate = ksOp.getResult();
+    auto allocOp = intermediate.getDefiningOp<memref::AllocOp>();
+    if (!allocOp) {
+      return mlir::failure();
+    }
+    Concrete::BatchedBootstrapLweBufferOp bsOp;
+    for (auto *user : intermediate.getUsers()) {
+      if (user == ksOp || mlir::isa<memref::DeallocOp>(user)) {
+        continue;
+      }
+      auto bootstrap =
+          mlir::dyn_cast<Concrete::BatchedBootstrapLweBufferOp>(user);
+      if (!bootstrap || bsOp ||
+          bootstrap.getInputCiphertext() != intermediate ||
+          bootstrap->getBlock() != ksOp->getBlock() ||
+          !ksOp->isBeforeInBlock(bootstrap)) {
+        return mlir::failure();
+      }
+      bsOp = bootstrap;
+    }
+    if (!bsOp || bsOp.getInputLweDim() != ksOp.getLweDimOut()) {
+      return mlir::failure();
+    }
+    // The leveled operations of the prologue, from the keyswitch backwards.
+    mlir::SmallVector<mlir::Operation *> prologue;
+    mlir::Value source = ksOp.getCiphertext();
+    if (affineFuncName != nullptr) {
+      mlir::Operation *reader = ksOp;
+      while (auto *writer = getScalarLeveledWriter(source, reader)) {
+        prologue.push_back(writer);
+        source = writer->getOperand(1);
+        reader = writer;
+      }
+    }
+    // The source of the call must not be touched until the bootstrap.
+    mlir::Operation *first = prologue.empty() ? ksOp : prologue.back();
+    for (auto *user : source.getUsers()) {
+      if (user->getBlock() == ksOp->getBlock() &&
+          first->isBeforeInBlock(user) && user->isBeforeInBlock(bsOp)) {
+        return mlir::failure();
+      }
+    }
+
+    rewriter.setInsertionPoint(bsOp);
+    mlir::SmallVector<mlir::Value> operands{
+        mlir::concretelang::getCastedMemRef(rewriter, bsOp.getResult()),
+        mlir::concretelang::getCastedMemRef(rewriter, source),
+        mlir::concretelang::getCastedMemRef(rewriter, bsOp.getLookupTable())};
+    if (!prologue.empty()) {
+      // Compose the prologue into a multiplication by a cleartext followed by
+      // the addition of a plaintext.
+      mlir::Location loc = bsOp.getLoc();
+      mlir::Value zero = rewriter.create<arith::ConstantIntOp>(loc, 0, 64);
+      mlir::Value cleartext =
+          rewriter.create<arith::ConstantIntOp>(loc, 1, 64);
+      mlir::Value plaintext = zero;
+      for (auto *op : llvm::reverse(prologue)) {
+        if (auto mulOp =
+                mlir::dyn_cast<Concrete::BatchedMulCleartextCstLweBufferOp>(
+                    op)) {
+          cleartext =
+              rewriter.create<arith::MulIOp>(loc, cleartext, mulOp.getRhs());
+          plaintext =
+              rewriter.create<arith::MulIOp>(loc, plaintext, mulOp.getRhs());
+        } else if (auto addOp = mlir::dyn_cast<
+                       Concrete::BatchedAddPlaintextCstLweBufferOp>(op)) {
+          plaintext =
+              rewriter.create<arith::AddIOp>(loc, plaintext, addOp.getRhs());
+        } else {
+          cleartext = rewriter.create<arith::SubIOp>(loc, zero, cleartext);
+          plaintext = rewriter.create<arith::SubIOp>(loc, zero, plaintext);
+        }
+      }
+      operands.push_back(cleartext);
+      operands.push_back(plaintext);
+    }
+    keyswitchAddOperands(ksOp, operands, rewriter);
+    // The context is passed once, after the bootstrap parameters.
+    operands.pop_back();
+    bootstrapAddOperands(bsOp, operands, rewriter);
+    if (chunkSize > 0) {
+      // chunk_size, before the context
+      mlir::Value chunk = rewriter.create<arith::ConstantOp>(
+          bsOp.getLoc(), rewriter.getI32IntegerAttr(chunkSize));
+      operands.insert(std::prev(operands.end()), chunk);
+    }
+
+    const char *callee = prologue.empty() ? funcName : affineFuncName;
+    if (insertForwardDeclarationOfTheCAPI(bsOp, rewriter, callee).failed()) {
+      return mlir::failure();
+    }
+    rewriter.replaceOpWithNewOp<func::CallOp>(bsOp, callee, mlir::TypeRange{},
+                                              operands);
+    rewriter.eraseOp(ksOp);
+    for (auto *op : prologue) {
+      rewriter.eraseOp(op);
+    }
+    return ::mlir::success();
+  };
+
+private:
+  const char *funcName;
+  const char *affineFuncName;
+  int64_t chunkSize;
+};
+
 void wopPBSAddOperands(Concrete::WopPBSCRTLweBufferOp op,
                        mlir::SmallVector<mlir::Value> &operands,
                        mlir::RewriterBase &rewriter) {
@@ -440,6 +643,20 @@ void encodeExpandLutForBootstrapAddOperands(
       op.getLoc(), op.getIsSignedAttr()));
 }
 
+void encodeExpandManyLutForBootstrapAddOperands(
+    Concrete::EncodeExpandManyLutForBootstrapBufferOp op,
+    mlir::SmallVector<mlir::Value> &operands, mlir::RewriterBase &rewriter) {
+  // poly_size
+  operands.push_back(rewriter.create<mlir::arith::ConstantOp>(
+      op.getLoc(), op.getPolySizeAttr()));
+  // output bits
+  operands.push_back(rewriter.create<mlir::arith::ConstantOp>(
+      op.getLoc(), op.getOutputBitsAttr()));
+  // is_signed
+  operands.push_back(rewriter.create<mlir::arith::ConstantOp>(
+      op.getLoc(), op.getIsSignedAttr()));
+}
+
 void encodeLutForWopPBSAddOperands(Concrete::EncodeLutForCrtWopPBSBufferOp op,
                                    mlir::SmallVector<mlir::Value> &operands,
                                    mlir::RewriterBase &rewriter) {
@@ -492,9 +709,92 @@ void encodeLutForWopPBSAddOperands(Concrete::EncodeLutForCrtWopPBSBufferOp op,
       op.getLoc(), op.getIsSignedAttr()));
 }
 
+/// Lowers a leveled operation on a ciphertext to a loop over the elements
+/// of its result buffer, which LLVM can vectorize and fuse with the loops of
+/// the neighbouring leveled operations, instead of a call to the runtime.
+/// `computeElement` returns the element of the result at an index, given the
+/// index of the body of the ciphertext.
+template <typename ConcreteOp>
+struct ConcreteToInlineLoopPattern : public mlir::OpRewritePattern<ConcreteOp> {
+  typedef std::function<mlir::Value(ConcreteOp, mlir::OpBuilder &,
+                                    mlir::Location, mlir::Value, mlir::Value)>
+      ElementBuilder;
+
+  ConcreteToInlineLoopPattern(::mlir::MLIRContext *context,
+                              ElementBuilder computeElement,
+                              mlir::PatternBenefit benefit = 2)
+      : ::mlir::OpRewritePattern<ConcreteOp>(context, benefit),
+        computeElement(computeElement) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(ConcreteOp op,
+                  ::mlir::PatternRewriter &rewriter) const override {
+    mlir::Location loc = op.getLoc();
+    mlir::Value result = op.getResult();
+    mlir::Value zero = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    mlir::Value one = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    mlir::Value size = rewriter.create<memref::DimOp>(loc, result, 0);
+    mlir::Value body = rewriter.create<arith::SubIOp>(loc, size, one);
+    rewriter.create<scf::ForOp>(
+        loc, zero, size, one, std::nullopt,
+        [&](mlir::OpBuilder &builder, mlir::Location loc, mlir::Value index,
+            mlir::ValueRange) {
+          mlir::Value element = computeElement(op, builder, loc, index, body);
+          builder.create<memref::StoreOp>(loc, element, result, index);
+          builder.create<scf::YieldOp>(loc);
+        });
+    rewriter.eraseOp(op);
+    return ::mlir::success();
+  }
+
+private:
+  ElementBuilder computeElement;
+};
+
+mlir::Value addLweElement(Concrete::AddLweBufferOp op, mlir::OpBuilder &builder,
+                          mlir::Location loc, mlir::Value index, mlir::Value) {
+  mlir::Value lhs = builder.create<memref::LoadOp>(loc, op.getLhs(), index);
+  mlir::Value rhs = builder.create<memref::LoadOp>(loc, op.getRhs(), index);
+  return builder.create<arith::AddIOp>(loc, lhs, rhs);
+}
+
+/// The plaintext is only added to the body of the ciphertext.
+mlir::Value addPlaintextLweElement(Concrete::AddPlaintextLweBufferOp op,
+                                   mlir::OpBuilder &builder,
+                                   mlir::Location loc, mlir::Value index,
+                                   mlir::Value body) {
+  mlir::Value lhs = builder.create<memref::LoadOp>(loc, op.getLhs(), index);
+  mlir::Value isBody = builder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, index, body);
+  mlir::Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 64);
+  mlir::Value rhs =
+      builder.create<arith::SelectOp>(loc, isBody, op.getRhs(), zero);
+  return builder.create<arith::AddIOp>(loc, lhs, rhs);
+}
+
+mlir::Value mulCleartextLweElement(Concrete::MulCleartextLweBufferOp op,
+                                   mlir::OpBuilder &builder,
+                                   mlir::Location loc, mlir::Value index,
+                                   mlir::Value) {
+  mlir::Value lhs = builder.create<memref::LoadOp>(loc, op.getLhs(), index);
+  return builder.create<arith::MulIOp>(loc, lhs, op.getRhs());
+}
+
+mlir::Value negateLweElement(Concrete::NegateLweBufferOp op,
+                             mlir::OpBuilder &builder, mlir::Location loc,
+                             mlir::Value index, mlir::Value) {
+  mlir::Value ct =
+      builder.create<memref::LoadOp>(loc, op.getCiphertext(), index);
+  mlir::Value zero = builder.create<arith::ConstantIntOp>(loc, 0, 64);
+  return builder.create<arith::SubIOp>(loc, zero, ct);
+}
+
 struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
 
-  ConcreteToCAPIPass(bool gpu) : gpu(gpu) {}
+  ConcreteToCAPIPass(bool gpu, bool inlineLeveledOps,
+                     int64_t pipelineChunkSize)
+      : gpu(gpu), inlineLeveledOps(inlineLeveledOps),
+        pipelineChunkSize(pipelineChunkSize) {}
 
   void runOnOperation() override {
     auto op = this->getOperation();
@@ -507,10 +807,26 @@ struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
     target.addLegalDialect<memref::MemRefDialect>();
     target.addLegalDialect<arith::ArithDialect>();
     target.addLegalDialect<mlir::LLVM::LLVMDialect>();
+    target.addLegalDialect<scf::SCFDialect>();
 
     // Make sure that no ops from `FHE` remain after the lowering
     target.addIllegalDialect<Concrete::ConcreteDialect>();
 
+    // The leveled operations inlined as loops take precedence over their
+    // CAPI calls
+    if (inlineLeveledOps) {
+      patterns.add<ConcreteToInlineLoopPattern<Concrete::AddLweBufferOp>>(
+          &getContext(), addLweElement);
+      patterns.add<
+          ConcreteToInlineLoopPattern<Concrete::AddPlaintextLweBufferOp>>(
+          &getContext(), addPlaintextLweElement);
+      patterns.add<
+          ConcreteToInlineLoopPattern<Concrete::MulCleartextLweBufferOp>>(
+          &getContext(), mulCleartextLweElement);
+      patterns.add<ConcreteToInlineLoopPattern<Concrete::NegateLweBufferOp>>(
+          &getContext(), negateLweElement);
+    }
+
     // Add patterns to transform Concrete operators to CAPI call
     patterns.add<ConcreteToCAPICallPattern<Concrete::AddLweBufferOp,
                                            memref_add_lwe_ciphertexts_u64>>(
@@ -534,6 +850,10 @@ struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
         ConcreteToCAPICallPattern<Concrete::EncodeExpandLutForBootstrapBufferOp,
                                   memref_encode_expand_lut_for_bootstrap>>(
         &getContext(), encodeExpandLutForBootstrapAddOperands);
+    patterns.add<ConcreteToCAPICallPattern<
+        Concrete::EncodeExpandManyLutForBootstrapBufferOp,
+        memref_encode_expand_many_lut_for_bootstrap>>(
+        &getContext(), encodeExpandManyLutForBootstrapAddOperands);
     patterns
         .add<ConcreteToCAPICallPattern<Concrete::EncodeLutForCrtWopPBSBufferOp,
                                        memref_encode_lut_for_crt_woppbs>>(
@@ -559,6 +879,9 @@ struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
                                   memref_batched_negate_lwe_ciphertext_u64>>(
         &getContext());
     if (gpu) {
+      patterns.add<BatchedKeySwitchBootstrapPattern>(
+          &getContext(), memref_batched_keyswitch_bootstrap_lwe_cuda_u64, 0,
+          memref_batched_affine_keyswitch_bootstrap_lwe_cuda_u64);
       patterns.add<ConcreteToCAPICallPattern<Concrete::KeySwitchLweBufferOp,
                                              memref_keyswitch_lwe_cuda_u64>>(
           &getContext(), keyswitchAddOperands<Concrete::KeySwitchLweBufferOp>);
@@ -581,6 +904,11 @@ struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
           &getContext(),
           bootstrapAddOperands<Concrete::BatchedMappedBootstrapLweBufferOp>);
     } else {
+      if (pipelineChunkSize > 0) {
+        patterns.add<BatchedKeySwitchBootstrapPattern>(
+            &getContext(), memref_batched_keyswitch_bootstrap_lwe_u64,
+            pipelineChunkSize);
+      }
       patterns.add<ConcreteToCAPICallPattern<Concrete::KeySwitchLweBufferOp,
                                              memref_keyswitch_lwe_u64>>(
           &getContext(), keyswitchAddOperands<Concrete::KeySwitchLweBufferOp>);
@@ -602,11 +930,23 @@ struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
                                     memref_batched_mapped_bootstrap_lwe_u64>>(
           &getContext(),
           bootstrapAddOperands<Concrete::BatchedMappedBootstrapLweBufferOp>);
+      // Table lookups are not packed when targeting GPUs
+      patterns
+          .add<ConcreteToCAPICallPattern<Concrete::ManyLutBootstrapLweBufferOp,
+                                         memref_many_lut_bootstrap_lwe_u64>>(
+              &getContext(),
+              bootstrapAddOperands<Concrete::ManyLutBootstrapLweBufferOp>);
     }
 
-    patterns.add<ConcreteToCAPICallPattern<Concrete::WopPBSCRTLweBufferOp,
-                                           memref_wop_pbs_crt_buffer>>(
-        &getContext(), wopPBSAddOperands);
+    if (gpu) {
+      patterns.add<ConcreteToCAPICallPattern<Concrete::WopPBSCRTLweBufferOp,
+                                             memref_wop_pbs_crt_cuda_u64>>(
+          &getContext(), wopPBSAddOperands);
+    } else {
+      patterns.add<ConcreteToCAPICallPattern<Concrete::WopPBSCRTLweBufferOp,
+                                             memref_wop_pbs_crt_buffer>>(
+          &getContext(), wopPBSAddOperands);
+    }
 
     // Apply conversion
     if (mlir::applyPartialConversion(op, target, std::move(patterns))
@@ -617,6 +957,8 @@ struct ConcreteToCAPIPass : public ConcreteToCAPIBase<ConcreteToCAPIPass> {
 
 private:
   bool gpu;
+  bool inlineLeveledOps;
+  int64_t pipelineChunkSize;
 };
 
 } // namespace
@@ -624,8 +966,10 @@ private:
 namespace mlir {
 namespace concretelang {
 std::unique_ptr<OperationPass<ModuleOp>>
-createConvertConcreteToCAPIPass(bool gpu) {
-  return std::make_unique<ConcreteToCAPIPass>(gpu);
+createConvertConcreteToCAPIPass(bool gpu, bool inlineLeveledOps,
+                                int64_t pipelineChunkSize) {
+  return std::make_unique<ConcreteToCAPIPass>(gpu, inlineLeveledOps,
+                                              pipelineChunkSize);
 }
 } // namespace concretelang
 } // namespace mlir
@@ -3,6 +3,7 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include "concretelang/Analysis/StaticLoops.h"
 #include "concretelang/Conversion/Passes.h"
 #include "concretelang/Dialect/SDFG/IR/SDFGDialect.h"
 #include "concretelang/Dialect/SDFG/IR/SDFGOps.h"
@@ -17,6 +18,7 @@
 #include "mlir/Transforms/RegionUtils.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include <mlir/Dialect/Arith/IR/Arith.h>
@@ -37,54 +39,65 @@ SDFG::MakeStream makeStream(mlir::ImplicitLocOpBuilder &builder,
   return builder.create<SDFG::MakeStream>(streamType, dfg, name, kind);
 }
 
-/// Unrolls entirely all scf loops, which directly contain an
-/// SDFG-convertible operation and whose bounds are static.
-void unrollLoopsWithSDFGConvertibleOps(mlir::func::FuncOp func) {
-  mlir::DenseSet<mlir::scf::ForOp> unrollCandidates;
+/// Returns the number of iterations of `forOp` if it can be fully
+/// unrolled, i.e., if its bounds are static and positive.
+std::optional<int64_t> getFullUnrollFactor(mlir::scf::ForOp forOp) {
+  int64_t ilb, iub, istep;
 
-  // Identify loops with SDFG-convertible ops
-  func.walk([&](SDFG::SDFGConvertibleOpInterface convertible) {
-    for (mlir::Operation *parent = convertible->getParentOp(); parent;
-         parent = parent->getParentOp()) {
-      if (mlir::scf::ForOp forOp = llvm::dyn_cast<mlir::scf::ForOp>(parent)) {
-        unrollCandidates.insert(forOp);
-      }
-    }
-  });
+  if (!mlir::concretelang::isStaticLoop(forOp, &ilb, &iub, &istep))
+    return std::nullopt;
 
-  // Fully unroll all the loops if its bounds are static
-  for (mlir::scf::ForOp forOp : unrollCandidates) {
-    mlir::arith::ConstantIndexOp lb =
-        forOp.getLowerBound().getDefiningOp<mlir::arith::ConstantIndexOp>();
-    mlir::arith::ConstantIndexOp ub =
-        forOp.getUpperBound().getDefiningOp<mlir::arith::ConstantIndexOp>();
-    mlir::arith::ConstantIndexOp step =
-        forOp.getStep().getDefiningOp<mlir::arith::ConstantIndexOp>();
+  // Unrolling requires positive bounds and step
+  if (ilb < 0 || iub < 0 || istep <= 0)
+    return std::nullopt;
 
-    if (!lb || !ub || !step)
-      continue;
+  return mlir::concretelang::getStaticTripCount(ilb, iub, istep);
+}
 
-    int64_t ilb = lb.value();
-    int64_t iub = ub.value();
-    int64_t istep = step.value();
+/// Returns the outermost scf loop containing `op`, if any.
+mlir::scf::ForOp getOutermostLoop(mlir::Operation *op) {
+  mlir::scf::ForOp outermost;
 
-    // Unrolling requires positive bounds and step
-    if (ilb < 0 || iub < 0 || istep <= 0)
-      continue;
+  for (mlir::Operation *parent = op->getParentOp(); parent;
+       parent = parent->getParentOp())
+    if (mlir::scf::ForOp forOp = llvm::dyn_cast<mlir::scf::ForOp>(parent))
+      outermost = forOp;
 
-    int64_t unrollFactor = ((iub - ilb) + (istep - 1)) / istep;
+  return outermost;
+}
 
-    if (unrollFactor == 0)
-      continue;
+/// Returns the number of SDFG-convertible operations that unrolling all
+/// the static loops enclosed in `root` would produce, saturated at
+/// `limit + 1`.
+int64_t getUnrolledOpCount(mlir::scf::ForOp root, int64_t limit) {
+  int64_t count = 0;
 
-    if (mlir::loopUnrollByFactor(forOp, (uint64_t)unrollFactor).failed())
-      continue;
-  }
+  root.walk([&](SDFG::SDFGConvertibleOpInterface convertible) {
+    int64_t copies = 1;
+
+    for (mlir::Operation *parent = convertible->getParentOp(); parent;
+         parent = parent->getParentOp()) {
+      if (mlir::scf::ForOp forOp = llvm::dyn_cast<mlir::scf::ForOp>(parent)) {
+        std::optional<int64_t> factor = getFullUnrollFactor(forOp);
+
+        if (factor.has_value() && *factor > 0)
+          copies = (*factor > (limit + 1) / copies) ? limit + 1
+                                                     : copies * *factor;
+      }
+
+      if (parent == root.getOperation())
+        break;
+    }
+
+    count = std::min(count + copies, limit + 1);
+  });
+
+  return count;
 }
 
-void restrictParallelLoopsWithSDFGConvertibleOps(mlir::func::FuncOp func,
+void restrictParallelLoopsWithSDFGConvertibleOps(mlir::Operation *root,
                                                  mlir::IRRewriter &rewriter) {
-  func.walk([&](SDFG::SDFGConvertibleOpInterface convertible) {
+  root->walk([&](SDFG::SDFGConvertibleOpInterface convertible) {
     for (mlir::Operation *parent = convertible->getParentOp(); parent;
          parent = parent->getParentOp())
       if (mlir::scf::ForOp forOp = llvm::dyn_cast<mlir::scf::ForOp>(parent))
@@ -92,6 +105,57 @@ void restrictParallelLoopsWithSDFGConvertibleOps(mlir::func::FuncOp func,
   });
 }
 
+/// Unrolls entirely all scf loops, which contain an SDFG-convertible
+/// operation and whose bounds are static.
+///
+/// A loop nest whose unrolling would produce more than `maxUnrolledOps`
+/// SDFG-convertible operations is left as is and its loops are made
+/// sequential, such that the operations stream their operands iteration
+/// by iteration instead of blowing up the size of the IR. A limit of 0
+/// unrolls all loop nests.
+void unrollLoopsWithSDFGConvertibleOps(mlir::func::FuncOp func,
+                                       int64_t maxUnrolledOps,
+                                       mlir::IRRewriter &rewriter) {
+  llvm::SetVector<mlir::scf::ForOp> roots;
+
+  // Identify loop nests with SDFG-convertible ops
+  func.walk([&](SDFG::SDFGConvertibleOpInterface convertible) {
+    if (mlir::scf::ForOp root = getOutermostLoop(convertible))
+      roots.insert(root);
+  });
+
+  for (mlir::scf::ForOp root : roots) {
+    if (maxUnrolledOps > 0 &&
+        getUnrolledOpCount(root, maxUnrolledOps) > maxUnrolledOps) {
+      restrictParallelLoopsWithSDFGConvertibleOps(root, rewriter);
+      continue;
+    }
+
+    // Unroll innermost loops first, such that the loops collected
+    // before any unrolling are still valid when they are unrolled
+    llvm::SmallVector<mlir::scf::ForOp> unrollCandidates;
+
+    root.walk<mlir::WalkOrder::PostOrder>([&](mlir::scf::ForOp forOp) {
+      if (forOp
+              .walk([](SDFG::SDFGConvertibleOpInterface) {
+                return mlir::WalkResult::interrupt();
+              })
+              .wasInterrupted())
+        unrollCandidates.push_back(forOp);
+    });
+
+    for (mlir::scf::ForOp forOp : unrollCandidates) {
+      std::optional<int64_t> unrollFactor = getFullUnrollFactor(forOp);
+
+      if (!unrollFactor.has_value() || *unrollFactor == 0)
+        continue;
+
+      if (mlir::loopUnrollByFactor(forOp, (uint64_t)*unrollFactor).failed())
+        continue;
+    }
+  }
+}
+
 StreamMappingKind determineStreamMappingKind(mlir::Value v) {
   // Determine stream type for operands:
   //
@@ -149,15 +213,17 @@ void setInsertionPointAfterValueOrRestore(mlir::OpBuilder &builder,
 
 struct ExtractSDFGOpsPass : public ExtractSDFGOpsBase<ExtractSDFGOpsPass> {
   bool unroll;
+  int64_t maxUnrolledOps;
 
-  ExtractSDFGOpsPass(bool unroll) : unroll(unroll) {}
+  ExtractSDFGOpsPass(bool unroll, int64_t maxUnrolledOps)
+      : unroll(unroll), maxUnrolledOps(maxUnrolledOps) {}
 
   void runOnOperation() override {
     mlir::func::FuncOp func = getOperation();
     mlir::IRRewriter rewriter(func.getContext());
 
     if (unroll)
-      unrollLoopsWithSDFGConvertibleOps(func);
+      unrollLoopsWithSDFGConvertibleOps(func, maxUnrolledOps, rewriter);
     else
       restrictParallelLoopsWithSDFGConvertibleOps(func, rewriter);
 
@@ -272,8 +338,8 @@ namespace mlir {
 namespace concretelang {
 
 std::unique_ptr<OperationPass<mlir::func::FuncOp>>
-createExtractSDFGOpsPass(bool unroll) {
-  return std::make_unique<ExtractSDFGOpsPass>(unroll);
+createExtractSDFGOpsPass(bool unroll, int64_t maxUnrolledOps) {
+  return std::make_unique<ExtractSDFGOpsPass>(unroll, maxUnrolledOps);
 }
 } // namespace concretelang
 } // namespace mlir
@@ -7,6 +7,7 @@
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Tensor/Utils/Utils.h"
 #include "mlir/IR/BuiltinTypes.h"
@@ -26,6 +27,7 @@
 #include "concretelang/Support/Constants.h"
 #include "concretelang/Support/logging.h"
 
+#include <cmath>
 #include <unordered_set>
 
 namespace arith = mlir::arith;
@@ -46,6 +48,100 @@ inline void forwardOptimizerID(mlir::Operation *source,
   destination->setAttr("TFHE.OId", optimizerIdAttr);
 }
 
+/// Builds the value accumulated by a reduction from the block arguments of
+/// its `linalg.generic`, the accumulator being the last one.
+using ReductionBodyBuilder = std::function<mlir::Value(
+    mlir::OpBuilder &, mlir::Location, mlir::ValueRange)>;
+
+/// Creates a `linalg.generic` reducing the last dimension of the `inputs`, of
+/// the same shape, into `init`, whose shape is the one of the inputs without
+/// their last dimension, or `1` for one dimensional inputs.
+mlir::Value createLastDimReduction(mlir::PatternRewriter &rewriter,
+                                   mlir::Location loc, mlir::ValueRange inputs,
+                                   mlir::Value init,
+                                   const ReductionBodyBuilder &body) {
+  int64_t rank = inputs[0].getType().cast<mlir::RankedTensorType>().getRank();
+  llvm::SmallVector<mlir::AffineMap> maps(
+      inputs.size(),
+      mlir::AffineMap::getMultiDimIdentityMap(rank, rewriter.getContext()));
+  llvm::SmallVector<mlir::AffineExpr> outputExprs;
+  for (int64_t i = 0; i < rank - 1; i++)
+    outputExprs.push_back(rewriter.getAffineDimExpr(i));
+  if (outputExprs.empty())
+    outputExprs.push_back(rewriter.getAffineConstantExpr(0));
+  maps.push_back(
+      mlir::AffineMap::get(rank, 0, outputExprs, rewriter.getContext()));
+
+  llvm::SmallVector<mlir::utils::IteratorType> iteratorTypes(
+      rank - 1, mlir::utils::IteratorType::parallel);
+  iteratorTypes.push_back(mlir::utils::IteratorType::reduction);
+
+  auto genericOp = rewriter.create<linalg::GenericOp>(
+      loc, init.getType(), inputs, init, maps, iteratorTypes,
+      [&](mlir::OpBuilder &nestedBuilder, mlir::Location nestedLoc,
+          mlir::ValueRange blockArgs) {
+        mlir::Value accumulated = body(nestedBuilder, nestedLoc, blockArgs);
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, accumulated);
+      });
+  return genericOp.getResult(0);
+}
+
+/// Creates a reduction of the one dimensional `inputs`, of the same static
+/// size, into a tensor of shape `1` of `elementType`, as a tree of depth two
+/// instead of a chain of accumulations. The inputs are reduced by chunks of
+/// about the square root of their size, the chunks being independent so that
+/// their reductions can be parallelized, then the partial sums of the chunks
+/// are added by `combine`, starting from the reduction of the elements left
+/// over by the chunks.
+mlir::Value createTreeReduction(mlir::PatternRewriter &rewriter,
+                                mlir::Location loc, mlir::ValueRange inputs,
+                                mlir::Type elementType,
+                                const ReductionBodyBuilder &body,
+                                const ReductionBodyBuilder &combine) {
+  int64_t size =
+      inputs[0].getType().cast<mlir::RankedTensorType>().getDimSize(0);
+  int64_t chunkSize = (int64_t)std::ceil(std::sqrt((double)size));
+  int64_t chunkCount = size / chunkSize;
+  int64_t chunkedSize = chunkCount * chunkSize;
+
+  auto slice = [&](mlir::Value input, int64_t offset, int64_t sliceSize) {
+    llvm::SmallVector<mlir::OpFoldResult> offsets{
+        rewriter.getIndexAttr(offset)};
+    llvm::SmallVector<mlir::OpFoldResult> sizes{
+        rewriter.getIndexAttr(sliceSize)};
+    llvm::SmallVector<mlir::OpFoldResult> strides{rewriter.getIndexAttr(1)};
+    return rewriter
+        .create<tensor::ExtractSliceOp>(loc, input, offsets, sizes, strides)
+        .getResult();
+  };
+  llvm::SmallVector<mlir::Value> chunks, leftovers;
+  for (mlir::Value input : inputs) {
+    auto inputType = input.getType().cast<mlir::RankedTensorType>();
+    mlir::Value chunked = input;
+    if (chunkedSize != size) {
+      chunked = slice(input, 0, chunkedSize);
+      leftovers.push_back(slice(input, chunkedSize, size - chunkedSize));
+    }
+    chunks.push_back(rewriter.create<tensor::ExpandShapeOp>(
+        loc,
+        mlir::RankedTensorType::get({chunkCount, chunkSize},
+                                    inputType.getElementType()),
+        chunked, llvm::SmallVector<mlir::ReassociationIndices>{{0, 1}}));
+  }
+
+  mlir::Value partials = createLastDimReduction(
+      rewriter, loc, chunks,
+      rewriter.create<FHE::ZeroTensorOp>(
+          loc, mlir::RankedTensorType::get({chunkCount}, elementType)),
+      body);
+  mlir::Value accumulator = rewriter.create<FHE::ZeroTensorOp>(
+      loc, mlir::RankedTensorType::get({1}, elementType));
+  if (!leftovers.empty())
+    accumulator =
+        createLastDimReduction(rewriter, loc, leftovers, accumulator, body);
+  return createLastDimReduction(rewriter, loc, partials, accumulator, combine);
+}
+
 template <typename DotOp, typename FHEMulOp>
 struct DotToLinalgGeneric : public ::mlir::OpRewritePattern<DotOp> {
   DotToLinalgGeneric(
@@ -54,10 +150,12 @@ struct DotToLinalgGeneric : public ::mlir::OpRewritePattern<DotOp> {
                              mlir::Value, mlir::Value)>
           createMulOp,
       std::function<void(DotOp &, FHE::AddEintOp &, FHEMulOp &)>
-          forwardOptimizerID)
+          forwardOptimizerID,
+      int64_t treeReductionMinSize = 0)
       : ::mlir::OpRewritePattern<DotOp>(
             context, mlir::concretelang::DEFAULT_PATTERN_BENEFIT),
-        createMulOp(createMulOp), forwardOptimizerID(forwardOptimizerID) {}
+        createMulOp(createMulOp), forwardOptimizerID(forwardOptimizerID),
+        treeReductionMinSize(treeReductionMinSize) {}
 
   /// This rewrite pattern transforms any instance of
   /// `FHELinalg.dot_eint_int` to an instance of `linalg.generic` with an
@@ -94,10 +192,47 @@ struct DotToLinalgGeneric : public ::mlir::OpRewritePattern<DotOp> {
   ///   %c0 = constant 0 : index
   ///   %o = tensor.extract %1[%c0] : tensor<1x!FHE.eint<0>>
   ///
+  /// Dots of at least `treeReductionMinSize` elements are reduced by
+  /// `createTreeReduction` instead.
   ::mlir::LogicalResult
   matchAndRewrite(DotOp dotOp,
                   ::mlir::PatternRewriter &rewriter) const override {
 
+    auto lhsType = dotOp.getLhs().getType().template cast<mlir::TensorType>();
+    if (treeReductionMinSize > 0 && lhsType.hasStaticShape() &&
+        lhsType.getDimSize(0) >= treeReductionMinSize) {
+      // The additions of the partial sums are the ones of the dot
+      mlir::Attribute addOptimizerID;
+      ReductionBodyBuilder body = [&](mlir::OpBuilder &builder,
+                                      mlir::Location loc,
+                                      mlir::ValueRange args) {
+        auto mul = this->createMulOp(builder, loc, dotOp.getResult().getType(),
+                                     args[0], args[1]);
+        auto add = builder.create<FHE::AddEintOp>(loc, mul, args[2]);
+        forwardOptimizerID(dotOp, add, mul);
+        addOptimizerID = add->getAttr("TFHE.OId");
+        return add.getResult();
+      };
+      ReductionBodyBuilder combine = [&](mlir::OpBuilder &builder,
+                                         mlir::Location loc,
+                                         mlir::ValueRange args) {
+        auto add = builder.create<FHE::AddEintOp>(loc, args[0], args[1]);
+        if (addOptimizerID)
+          add->setAttr("TFHE.OId", addOptimizerID);
+        return add.getResult();
+      };
+      llvm::SmallVector<mlir::Value, 2> operands{dotOp.getLhs(),
+                                                 dotOp.getRhs()};
+      mlir::Value reduction =
+          createTreeReduction(rewriter, dotOp.getLoc(), operands,
+                              dotOp.getType(), body, combine);
+      mlir::Value idx0 =
+          rewriter.create<mlir::arith::ConstantIndexOp>(dotOp.getLoc(), 0);
+      rewriter.replaceOpWithNewOp<mlir::tensor::ExtractOp>(dotOp, reduction,
+                                                           idx0);
+      return ::mlir::success();
+    }
+
     auto zeroTensorOp = rewriter.create<mlir::concretelang::FHE::ZeroTensorOp>(
         dotOp.getLoc(), mlir::RankedTensorType::get({1}, dotOp.getType()));
 
@@ -153,6 +288,7 @@ private:
                          mlir::Value, mlir::Value)>
       createMulOp;
   std::function<void(DotOp &, FHE::AddEintOp &, FHEMulOp &)> forwardOptimizerID;
+  int64_t treeReductionMinSize;
 };
 
 mlir::AffineMap
@@ -175,6 +311,39 @@ getBroadcastedAffineMap(const mlir::RankedTensorType &resultType,
                               rewriter.getContext());
 }
 
+/// Creates the initial value of the result of an element-wise operation
+/// following the broadcasting rules. A result with dynamic dimensions is
+/// initialized with a `tensor.empty`, whose sizes are the ones of the
+/// operands with the same dynamic dimensions, as element-wise operations do
+/// not read the initial value of their result.
+mlir::Value createElementwiseInit(mlir::PatternRewriter &rewriter,
+                                  mlir::Location loc,
+                                  mlir::RankedTensorType resultTy,
+                                  mlir::ValueRange operands) {
+  if (resultTy.hasStaticShape())
+    return rewriter.create<FHE::ZeroTensorOp>(loc, resultTy,
+                                              mlir::ValueRange{});
+
+  llvm::SmallVector<mlir::Value> dynamicSizes;
+  for (int64_t i = 0; i < resultTy.getRank(); i++) {
+    if (!resultTy.isDynamicDim(i))
+      continue;
+    for (mlir::Value operand : operands) {
+      auto operandTy = operand.getType().dyn_cast<mlir::RankedTensorType>();
+      if (!operandTy)
+        continue;
+      int64_t dim = i - (resultTy.getRank() - operandTy.getRank());
+      if (dim >= 0 && operandTy.isDynamicDim(dim)) {
+        dynamicSizes.push_back(
+            rewriter.create<mlir::tensor::DimOp>(loc, operand, dim));
+        break;
+      }
+    }
+  }
+  return rewriter.create<mlir::tensor::EmptyOp>(
+      loc, resultTy.getShape(), resultTy.getElementType(), dynamicSizes);
+}
+
 /// This create an affine map following the broadcasting rules, but also takes
 /// out one specific element of the LUT from the LUT dimension, which should be
 /// the last.
@@ -266,8 +435,9 @@ struct FHELinalgOpToLinalgGeneric : public mlir::OpRewritePattern<FHELinalgOp> {
     mlir::RankedTensorType rhsTy = ((mlir::Type)linalgOp.getRhs().getType())
                                        .cast<mlir::RankedTensorType>();
     //  linalg.init_tensor for initial value
-    mlir::Value init = rewriter.create<FHE::ZeroTensorOp>(
-        linalgOp.getLoc(), resultTy, mlir::ValueRange{});
+    mlir::Value init = createElementwiseInit(
+        rewriter, linalgOp.getLoc(), resultTy,
+        mlir::ValueRange{linalgOp.getLhs(), linalgOp.getRhs()});
 
     // Create the affine #maps_0
     llvm::SmallVector<mlir::AffineMap, 3> maps{
@@ -656,8 +826,8 @@ struct FHELinalgApplyLookupTableToLinalgGeneric
         ((mlir::Type)lutOp.getT().getType()).cast<mlir::RankedTensorType>();
 
     //  linalg.init_tensor for initial value
-    mlir::Value init = rewriter.create<FHE::ZeroTensorOp>(
-        lutOp.getLoc(), resultTy, mlir::ValueRange{});
+    mlir::Value init = createElementwiseInit(rewriter, lutOp.getLoc(),
+                                             resultTy, lutOp.getT());
 
     // Create the affine #maps_0
     llvm::SmallVector<mlir::AffineMap, 2> maps{
@@ -1013,6 +1183,185 @@ private:
       forwardOptimizerID;
 };
 
+/// This rewrite pattern transforms the instances of
+/// `FHELinalg.matmul_eint_int` by a constant matrix of which at least half of
+/// the weights are zeros to loops over the non zero weights of each column,
+/// given by constant tensors in a compressed sparse column layout. The
+/// weights of 1 and -1 are kept apart, and accumulated by an `FHE.add_eint`
+/// or an `FHE.sub_eint` of the encrypted element without a multiplication.
+///
+/// Example:
+///
+///   "FHELinalg.matmul_eint_int(%a, %b) :
+///      (tensor<MxKx!FHE.eint<p>>, tensor<KxNxip'>) ->
+///          tensor<MxNx!FHE.eint<p>>"
+///
+/// becomes, for the weights of 1:
+///
+///   %init = "FHE.zero_tensor"() : () -> tensor<MxNx!FHE.eint<p>>
+///   scf.for %m = 0 to M iter_args(%t = %init) {
+///     scf.for %n = 0 to N iter_args(%u = %t) {
+///       %begin = tensor.extract %offsets[%n]
+///       %end = tensor.extract %offsets[%n + 1]
+///       %acc = scf.for %j = %begin to %end iter_args(%v = %zero) {
+///         %row = tensor.extract %rows[%j]
+///         %x = tensor.extract %a[%m, %row]
+///         %w = "FHE.add_eint"(%v, %x)
+///         scf.yield %w
+///       }
+///       ...
+///       %r = tensor.insert %acc into %u[%m, %n]
+///       scf.yield %r
+///     }
+///   }
+///
+struct FHELinalgSparseMatmulToLoops
+    : public mlir::OpRewritePattern<FHELinalg::MatMulEintIntOp> {
+  FHELinalgSparseMatmulToLoops(mlir::MLIRContext *context)
+      : mlir::OpRewritePattern<FHELinalg::MatMulEintIntOp>(
+            context, mlir::concretelang::DEFAULT_PATTERN_BENEFIT + 1) {}
+
+  /// The non zero weights of a kind, per column of the weight matrix
+  struct SparseWeights {
+    llvm::SmallVector<int64_t> offsets;
+    llvm::SmallVector<int64_t> rows;
+    llvm::SmallVector<llvm::APInt> weights;
+  };
+
+  mlir::LogicalResult
+  matchAndRewrite(FHELinalg::MatMulEintIntOp matmulOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    mlir::Location loc = matmulOp.getLoc();
+    mlir::Value lhs = matmulOp.getLhs();
+    auto lhsTy = lhs.getType().cast<mlir::RankedTensorType>();
+    auto rhsTy = matmulOp.getRhs().getType().cast<mlir::RankedTensorType>();
+    auto outTy = matmulOp.getType().cast<mlir::RankedTensorType>();
+    mlir::DenseIntElementsAttr rhsAttr;
+    if (lhsTy.getRank() != 2 || rhsTy.getRank() != 2 ||
+        matmulOp->hasAttr("tile-sizes") ||
+        !mlir::matchPattern(matmulOp.getRhs(), mlir::m_Constant(&rhsAttr)))
+      return mlir::failure();
+
+    int64_t M = lhsTy.getDimSize(0);
+    int64_t K = rhsTy.getDimSize(0);
+    int64_t N = rhsTy.getDimSize(1);
+    // The kinds of weights: 1, -1 and the others
+    SparseWeights kinds[3];
+    for (SparseWeights &kind : kinds)
+      kind.offsets.push_back(0);
+    auto values = rhsAttr.getValues<llvm::APInt>();
+    int64_t zeros = 0;
+    for (int64_t n = 0; n < N; n++) {
+      for (int64_t k = 0; k < K; k++) {
+        llvm::APInt weight = values[k * N + n];
+        if (weight.isZero()) {
+          zeros++;
+          continue;
+        }
+        int64_t value = weight.getSExtValue();
+        SparseWeights &kind = kinds[value == 1 ? 0 : value == -1 ? 1 : 2];
+        kind.rows.push_back(k);
+        kind.weights.push_back(weight);
+      }
+      for (SparseWeights &kind : kinds)
+        kind.offsets.push_back(kind.rows.size());
+    }
+    if (2 * zeros < K * N)
+      return mlir::failure();
+
+    auto indexTensor = [&](llvm::ArrayRef<int64_t> indices) -> mlir::Value {
+      auto type = mlir::RankedTensorType::get({(int64_t)indices.size()},
+                                              rewriter.getIndexType());
+      return rewriter.create<arith::ConstantOp>(
+          loc, mlir::DenseIntElementsAttr::get(type, indices));
+    };
+    struct KindTensors {
+      mlir::Value offsets, rows, weights;
+    };
+    KindTensors tensors[3];
+    for (int kind = 0; kind < 3; kind++) {
+      if (kinds[kind].rows.empty())
+        continue;
+      tensors[kind].offsets = indexTensor(kinds[kind].offsets);
+      tensors[kind].rows = indexTensor(kinds[kind].rows);
+      if (kind == 2) {
+        auto type = mlir::RankedTensorType::get(
+            {(int64_t)kinds[kind].weights.size()}, rhsTy.getElementType());
+        tensors[kind].weights = rewriter.create<arith::ConstantOp>(
+            loc, mlir::DenseIntElementsAttr::get(type, kinds[kind].weights));
+      }
+    }
+
+    mlir::Type outElementTy = outTy.getElementType();
+    mlir::Value init = rewriter.create<FHE::ZeroTensorOp>(loc, outTy);
+    mlir::Value c0 = rewriter.create<arith::ConstantIndexOp>(loc, 0);
+    mlir::Value c1 = rewriter.create<arith::ConstantIndexOp>(loc, 1);
+    mlir::Value cM = rewriter.create<arith::ConstantIndexOp>(loc, M);
+    mlir::Value cN = rewriter.create<arith::ConstantIndexOp>(loc, N);
+
+    // Accumulates the weights of a kind of the column `n` on `acc`
+    auto accumulate = [&](mlir::OpBuilder &builder, int kind, mlir::Value m,
+                          mlir::Value n, mlir::Value acc) -> mlir::Value {
+      mlir::Value next = builder.create<arith::AddIOp>(loc, n, c1);
+      mlir::Value begin =
+          builder.create<tensor::ExtractOp>(loc, tensors[kind].offsets, n);
+      mlir::Value end =
+          builder.create<tensor::ExtractOp>(loc, tensors[kind].offsets, next);
+      auto loop = builder.create<mlir::scf::ForOp>(
+          loc, begin, end, c1, mlir::ValueRange{acc},
+          [&](mlir::OpBuilder &builder, mlir::Location loc, mlir::Value j,
+              mlir::ValueRange args) {
+            mlir::Value row =
+                builder.create<tensor::ExtractOp>(loc, tensors[kind].rows, j);
+            mlir::Value x = builder.create<tensor::ExtractOp>(
+                loc, lhs, mlir::ValueRange{m, row});
+            mlir::Operation *sum;
+            if (kind == 0) {
+              sum = builder.create<FHE::AddEintOp>(loc, outElementTy, args[0],
+                                                   x);
+            } else if (kind == 1) {
+              sum = builder.create<FHE::SubEintOp>(loc, outElementTy, args[0],
+                                                   x);
+            } else {
+              mlir::Value weight = builder.create<tensor::ExtractOp>(
+                  loc, tensors[kind].weights, j);
+              auto product = builder.create<FHE::MulEintIntOp>(
+                  loc, outElementTy, x, weight);
+              forwardOptimizerID(matmulOp, product);
+              sum = builder.create<FHE::AddEintOp>(loc, outElementTy, args[0],
+                                                   product.getResult());
+            }
+            forwardOptimizerID(matmulOp, sum);
+            builder.create<mlir::scf::YieldOp>(loc, sum->getResult(0));
+          });
+      return loop.getResult(0);
+    };
+
+    auto rowsLoop = rewriter.create<mlir::scf::ForOp>(
+        loc, c0, cM, c1, mlir::ValueRange{init},
+        [&](mlir::OpBuilder &builder, mlir::Location loc, mlir::Value m,
+            mlir::ValueRange rowsArgs) {
+          auto columnsLoop = builder.create<mlir::scf::ForOp>(
+              loc, c0, cN, c1, rowsArgs,
+              [&](mlir::OpBuilder &builder, mlir::Location loc, mlir::Value n,
+                  mlir::ValueRange columnsArgs) {
+                mlir::Value acc =
+                    builder.create<FHE::ZeroEintOp>(loc, outElementTy);
+                for (int kind = 0; kind < 3; kind++)
+                  if (tensors[kind].offsets)
+                    acc = accumulate(builder, kind, m, n, acc);
+                mlir::Value result = builder.create<tensor::InsertOp>(
+                    loc, acc, columnsArgs[0], mlir::ValueRange{m, n});
+                builder.create<mlir::scf::YieldOp>(loc, result);
+              });
+          builder.create<mlir::scf::YieldOp>(loc, columnsLoop.getResult(0));
+        });
+
+    rewriter.replaceOp(matmulOp, rowsLoop.getResult(0));
+    return mlir::success();
+  }
+};
+
 /// This rewrite pattern transforms any instance of operators
 /// `FHELinalg.sum` to an instance of `linalg.generic`.
 ///
@@ -1044,11 +1393,16 @@ private:
 ///   %index = arith.constant 0 : index
 ///   %result = tensor.extract %index : tensor<1x!FHE.eint<7>>
 ///
+/// Sums of all the elements of static tensors of at least
+/// `treeReductionMinSize` elements are reduced by `createTreeReduction`
+/// instead, over the flattened input.
 struct SumToLinalgGeneric
     : public ::mlir::OpRewritePattern<mlir::concretelang::FHELinalg::SumOp> {
-  SumToLinalgGeneric(::mlir::MLIRContext *context)
+  SumToLinalgGeneric(::mlir::MLIRContext *context,
+                     int64_t treeReductionMinSize = 0)
       : ::mlir::OpRewritePattern<::mlir::concretelang::FHELinalg::SumOp>(
-            context, mlir::concretelang::DEFAULT_PATTERN_BENEFIT) {}
+            context, mlir::concretelang::DEFAULT_PATTERN_BENEFIT),
+        treeReductionMinSize(treeReductionMinSize) {}
 
   ::mlir::LogicalResult
   matchAndRewrite(::mlir::concretelang::FHELinalg::SumOp sumOp,
@@ -1092,6 +1446,32 @@ struct SumToLinalgGeneric
       }
     }
 
+    if (!outputIsTensor && treeReductionMinSize > 0 &&
+        inputType.hasStaticShape() &&
+        inputType.getNumElements() >= treeReductionMinSize) {
+      ReductionBodyBuilder add = [&](mlir::OpBuilder &builder,
+                                     mlir::Location loc,
+                                     mlir::ValueRange args) {
+        auto addition = builder.create<FHE::AddEintOp>(loc, args[0], args[1]);
+        forwardOptimizerID(sumOp, addition);
+        return addition.getResult();
+      };
+      mlir::Value flattened = input;
+      if (inputDimensions > 1) {
+        mlir::ReassociationIndices allDimensions;
+        for (int64_t i = 0; i < inputDimensions; i++)
+          allDimensions.push_back(i);
+        flattened = rewriter.create<tensor::CollapseShapeOp>(
+            location, input,
+            llvm::SmallVector<mlir::ReassociationIndices>{allDimensions});
+      }
+      mlir::Value reduction = createTreeReduction(rewriter, location, flattened,
+                                                  outputType, add, add);
+      mlir::Value idx0 = rewriter.create<arith::ConstantIndexOp>(location, 0);
+      rewriter.replaceOpWithNewOp<tensor::ExtractOp>(sumOp, reduction, idx0);
+      return mlir::success();
+    }
+
     mlir::Type accumulatorType = outputType;
     if (!outputIsTensor) {
       int64_t accumulatorShape[1] = {1};
@@ -1165,6 +1545,9 @@ struct SumToLinalgGeneric
     rewriter.replaceOp(sumOp, {result});
     return mlir::success();
   };
+
+private:
+  int64_t treeReductionMinSize;
 };
 
 /// This rewrite pattern transforms any instance of operators
@@ -1579,6 +1962,104 @@ mlir::LogicalResult createGroupedConv2D(
   return mlir::success();
 }
 
+/// Lowers a convolution of a single group to the copy of the windows of the
+/// padded input to a tensor of patches, followed by their product with the
+/// weights:
+///
+///   patches[n][oh * OW + ow][(c * KH + kh) * KW + kw] =
+///     input[n][c][oh * SH + kh * DH][ow * SW + kw * DW]
+///   output[n][f][oh * OW + ow] +=
+///     patches[n][oh * OW + ow][k] * weight[f][k]
+///
+/// The ciphertexts of a patch are then contiguous in the reduction, rather
+/// than strided across the rows of the input, and the result is produced in
+/// the layout of the output, so that its TLUs need no transposition.
+mlir::LogicalResult createIm2colConv2D(
+    mlir::PatternRewriter &rewriter,
+    mlir::concretelang::FHELinalg::Conv2dOp &conv2dOp, mlir::Value paddedInput,
+    mlir::Value weight, mlir::Value outputTensor,
+    llvm::ArrayRef<int64_t> strides, llvm::ArrayRef<int64_t> dilations) {
+  mlir::Location loc = conv2dOp.getLoc();
+  mlir::Type inputElemTy =
+      paddedInput.getType().cast<mlir::RankedTensorType>().getElementType();
+  mlir::RankedTensorType resultTy =
+      outputTensor.getType().cast<mlir::RankedTensorType>();
+  llvm::ArrayRef<int64_t> weightShape =
+      weight.getType().cast<mlir::RankedTensorType>().getShape();
+  llvm::ArrayRef<int64_t> resultShape = resultTy.getShape();
+
+  auto dim = [&](unsigned position) {
+    return rewriter.getAffineDimExpr(position);
+  };
+
+  // patches[n][oh][ow][c][kh][kw], copied without any FHE operation
+  llvm::SmallVector<int64_t, 6> patchesShape{
+      resultShape[0], resultShape[2], resultShape[3],
+      weightShape[1], weightShape[2], weightShape[3]};
+  llvm::SmallVector<mlir::AffineMap, 2> patchesMaps{
+      mlir::AffineMap::get(6, 0,
+                           {dim(0), dim(3),
+                            dim(1) * strides[0] + dim(4) * dilations[0],
+                            dim(2) * strides[1] + dim(5) * dilations[1]},
+                           rewriter.getContext()),
+      mlir::AffineMap::getMultiDimIdentityMap(6, rewriter.getContext())};
+  mlir::Value patchesInit =
+      rewriter.create<mlir::tensor::EmptyOp>(loc, patchesShape, inputElemTy);
+  mlir::Value patches =
+      rewriter
+          .create<mlir::linalg::GenericOp>(
+              loc, patchesInit.getType(), paddedInput, patchesInit,
+              patchesMaps, parallelIteratorType(6),
+              [&](mlir::OpBuilder &b, mlir::Location loc,
+                  mlir::ValueRange args) {
+                b.create<mlir::linalg::YieldOp>(loc, args[0]);
+              })
+          .getResult(0);
+  patches = rewriter.create<mlir::tensor::CollapseShapeOp>(
+      loc, patches,
+      llvm::SmallVector<mlir::ReassociationIndices>{{0}, {1, 2}, {3, 4, 5}});
+  mlir::Value weightMatrix = rewriter.create<mlir::tensor::CollapseShapeOp>(
+      loc, weight,
+      llvm::SmallVector<mlir::ReassociationIndices>{{0}, {1, 2, 3}});
+  llvm::SmallVector<mlir::ReassociationIndices> outputReassociation{
+      {0}, {1}, {2, 3}};
+  mlir::Value outputMatrix = rewriter.create<mlir::tensor::CollapseShapeOp>(
+      loc, outputTensor, outputReassociation);
+
+  // output[n][f][p] += patches[n][p][k] * weight[f][k]
+  llvm::SmallVector<mlir::AffineMap, 3> productMaps{
+      mlir::AffineMap::get(4, 0, {dim(0), dim(2), dim(3)},
+                           rewriter.getContext()),
+      mlir::AffineMap::get(4, 0, {dim(1), dim(3)}, rewriter.getContext()),
+      mlir::AffineMap::get(4, 0, {dim(0), dim(1), dim(2)},
+                           rewriter.getContext())};
+  llvm::SmallVector<mlir::utils::IteratorType> productIteratorTypes =
+      parallelIteratorType(3);
+  productIteratorTypes.push_back(mlir::utils::IteratorType::reduction);
+  mlir::Value product =
+      rewriter
+          .create<mlir::linalg::GenericOp>(
+              loc, outputMatrix.getType(),
+              mlir::ValueRange{patches, weightMatrix}, outputMatrix,
+              productMaps, productIteratorTypes,
+              [&](mlir::OpBuilder &b, mlir::Location loc,
+                  mlir::ValueRange args) {
+                auto mul =
+                    b.create<mlir::concretelang::FHE::MulEintIntOp>(
+                        loc, args[0], args[1]);
+                forwardOptimizerID(conv2dOp, mul);
+                auto add = b.create<mlir::concretelang::FHE::AddEintOp>(
+                    loc, args[2], mul);
+                forwardOptimizerID(conv2dOp, add);
+                b.create<mlir::linalg::YieldOp>(loc, add.getResult());
+              })
+          .getResult(0);
+
+  rewriter.replaceOpWithNewOp<mlir::tensor::ExpandShapeOp>(
+      conv2dOp, resultTy, product, outputReassociation);
+  return mlir::success();
+}
+
 bool isZeroConstant(mlir::Value value) {
   auto cst =
       mlir::dyn_cast_or_null<mlir::arith::ConstantOp>(value.getDefiningOp());
@@ -1599,12 +2080,15 @@ bool isZeroConstant(mlir::Value value) {
 /// `linalg.conv_2d_nchw_fchw`. The transformation consists of padding the input
 /// tensor, and initializing the output tensor with bias values if any. Multiple
 /// linalng conv operations can be generated, and their output concatenated in
-/// the case of grouped convolution
+/// the case of grouped convolution. With `im2col`, the convolutions of a
+/// single group are instead lowered by `createIm2colConv2D`.
 struct FHELinalgConv2dToLinalgConv2d
     : public ::mlir::OpRewritePattern<mlir::concretelang::FHELinalg::Conv2dOp> {
-  FHELinalgConv2dToLinalgConv2d(::mlir::MLIRContext *context)
+  FHELinalgConv2dToLinalgConv2d(::mlir::MLIRContext *context,
+                                bool im2col = false)
       : ::mlir::OpRewritePattern<::mlir::concretelang::FHELinalg::Conv2dOp>(
-            context, mlir::concretelang::DEFAULT_PATTERN_BENEFIT) {}
+            context, mlir::concretelang::DEFAULT_PATTERN_BENEFIT),
+        im2col(im2col) {}
 
   ::mlir::LogicalResult
   matchAndRewrite(::mlir::concretelang::FHELinalg::Conv2dOp conv2dOp,
@@ -1723,6 +2207,10 @@ struct FHELinalgConv2dToLinalgConv2d
     // but since there is no support for groups in linalg conv operations, we
     // need to slice the different tensors and apply multiple convolution in
     // case group is greater than 1
+    if (group == 1 && im2col) {
+      return createIm2colConv2D(rewriter, conv2dOp, paddedInput, weight,
+                                biasInitTensor, stridesInts, dilationsInts);
+    }
     if (group == 1) {
       rewriter.replaceOpWithNewOp<mlir::linalg::Conv2DNchwFchwOp>(
           conv2dOp, biasInitTensor.getType(),
@@ -1734,10 +2222,38 @@ struct FHELinalgConv2dToLinalgConv2d
                                biasInitTensor, stridesAttr, dilationsAttr,
                                namedAttr, group);
   };
+
+private:
+  bool im2col;
 };
 
-/// This rewrite pattern transforms all instances
-/// of `FHELinalg.maxpool2d` to `linalg.pooling_ncw_max`.
+/// This rewrite pattern transforms all instances of `FHELinalg.maxpool2d` to a
+/// `linalg.generic` reading the elements of each window as separate inputs,
+/// and computing their maximum with a balanced tree of `FHE.max_eint`. The
+/// bootstraps of a window are then in ceil(log2(size)) sequential levels
+/// instead of size. The signed maxpools also take the maximum with the lowest
+/// value, so that the result stays the same as the one of
+/// `linalg.pooling_nchw_max`, while the unsigned ones can skip the one with 0.
+///
+/// Example:
+///
+///   %res = "FHELinalg.maxpool2d"(%input) { kernel_shape = dense<[1, 3]> }
+///     : (tensor<1x1x4x4x!FHE.eint<5>>) -> tensor<1x1x4x2x!FHE.eint<5>>
+///
+/// becomes:
+///
+///   #map0 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+///   #map1 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3 + 1)>
+///   #map2 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3 + 2)>
+///
+///   %init = tensor.empty() : tensor<1x1x4x2x!FHE.eint<5>>
+///   %res = linalg.generic {indexing_maps = [#map0, #map1, #map2, #map0], ...}
+///     ins(%input, %input, %input : ...) outs(%init : ...) {
+///     ^bb0(%a: !FHE.eint<5>, %b: !FHE.eint<5>, %c: !FHE.eint<5>, %o: ...):
+///       %ab = "FHE.max_eint"(%a, %b)
+///       %abc = "FHE.max_eint"(%ab, %c)
+///       linalg.yield %abc : !FHE.eint<5>
+///   }
 struct FHELinalgMaxpool2dToLinalgMaxpool2d
     : public mlir::OpRewritePattern<FHELinalg::Maxpool2dOp> {
 
@@ -1752,27 +2268,15 @@ struct FHELinalgMaxpool2dToLinalgMaxpool2d
 
     const mlir::Location loc = maxpool2dOp->getLoc();
 
-    std::vector<mlir::NamedAttribute> maxOpDict = {rewriter.getNamedAttr(
-        "op", rewriter.getStringAttr(
-                  mlir::concretelang::FHE::MaxEintOp::getOperationName()))};
-    std::vector<mlir::NamedAttribute> opAttrs;
-    if (optimizerIdAttr != nullptr) {
-      opAttrs.push_back(rewriter.getNamedAttr("TFHE.OId", optimizerIdAttr));
-    }
-    auto opNamedAttrs =
-        rewriter.getNamedAttr("op_attrs", rewriter.getDictionaryAttr(opAttrs));
-    maxOpDict.push_back(opNamedAttrs);
-    const mlir::NamedAttribute maxOpAttr = rewriter.getNamedAttr(
-        "max_signed", rewriter.getDictionaryAttr(maxOpDict));
-
     const auto outputTy =
         maxpool2dOp->getResult(0).getType().cast<mlir::RankedTensorType>();
     const auto outputElementTy =
         outputTy.getElementType().cast<FHE::FheIntegerInterface>();
 
-    auto output = rewriter.create<FHE::ZeroTensorOp>(loc, outputTy).getResult();
-
+    mlir::Value output;
     if (outputElementTy.isSigned()) {
+      output = rewriter.create<FHE::ZeroTensorOp>(loc, outputTy).getResult();
+
       const int64_t outputBitWidth = outputElementTy.getWidth();
       const int64_t offsetValue = 1 << (outputBitWidth - 2);
 
@@ -1800,10 +2304,9 @@ struct FHELinalgMaxpool2dToLinalgMaxpool2d
       }
       output = subOp.getResult();
     } else {
-      if (optimizerIdAttr != nullptr) {
-        output.getDefiningOp()->setAttr(
-            "TFHE.OId", rewriter.getI32IntegerAttr(optimizerIdAttr[0]));
-      }
+      // Only written by the yields of the generic
+      output = rewriter.create<mlir::tensor::EmptyOp>(
+          loc, outputTy.getShape(), outputTy.getElementType());
     }
 
     const mlir::DenseElementsAttr kernelShapeAttr =
@@ -1812,25 +2315,71 @@ struct FHELinalgMaxpool2dToLinalgMaxpool2d
         llvm::SmallVector<int64_t, 2>(kernelShapeAttr.value_begin<int64_t>(),
                                       kernelShapeAttr.value_end<int64_t>());
 
-    const mlir::Value kernel =
-        rewriter
-            .create<mlir::tensor::EmptyOp>(
-                loc, kernelShape,
-                mlir::IntegerType::get(this->getContext(), 64))
-            .getResult();
-
     const mlir::DenseIntElementsAttr defaultAttr =
         rewriter.getI64VectorAttr({1, 1});
 
     const mlir::DenseIntElementsAttr stridesAttr =
-        maxpool2dOp.getDilations().value_or(defaultAttr);
+        maxpool2dOp.getStrides().value_or(defaultAttr);
     const mlir::DenseIntElementsAttr dilationsAttr =
         maxpool2dOp.getDilations().value_or(defaultAttr);
+    const auto strides =
+        llvm::SmallVector<int64_t, 2>(stridesAttr.value_begin<int64_t>(),
+                                      stridesAttr.value_end<int64_t>());
+    const auto dilations =
+        llvm::SmallVector<int64_t, 2>(dilationsAttr.value_begin<int64_t>(),
+                                      dilationsAttr.value_end<int64_t>());
+
+    // One input per element of the window
+    llvm::SmallVector<mlir::Value> ins;
+    llvm::SmallVector<mlir::AffineMap> maps;
+    for (int64_t i = 0; i < kernelShape[0]; i++) {
+      for (int64_t j = 0; j < kernelShape[1]; j++) {
+        llvm::SmallVector<mlir::AffineExpr, 4> exprs{
+            rewriter.getAffineDimExpr(0), rewriter.getAffineDimExpr(1),
+            rewriter.getAffineDimExpr(2) * strides[0] + i * dilations[0],
+            rewriter.getAffineDimExpr(3) * strides[1] + j * dilations[1]};
+        maps.push_back(
+            mlir::AffineMap::get(4, 0, exprs, rewriter.getContext()));
+        ins.push_back(maxpool2dOp.getInput());
+      }
+    }
+    maps.push_back(
+        mlir::AffineMap::getMultiDimIdentityMap(4, rewriter.getContext()));
+
+    auto bodyBuilder = [&](mlir::OpBuilder &nestedBuilder,
+                           mlir::Location nestedLoc,
+                           mlir::ValueRange blockArgs) {
+      llvm::SmallVector<mlir::Value> level(blockArgs.begin(),
+                                           blockArgs.end());
+      if (!outputElementTy.isSigned())
+        level.pop_back();
+      // The odd one out of a level stays the last one of the next, so that
+      // this less noisy value ends up as the `y` of a `max(x - y, 0) + y`,
+      // the operand whose noise is added to the result
+      while (level.size() > 1) {
+        llvm::SmallVector<mlir::Value> next;
+        for (size_t i = 0; i + 1 < level.size(); i += 2) {
+          auto maxOp = nestedBuilder.create<FHE::MaxEintOp>(
+              nestedLoc, outputTy.getElementType(), level[i], level[i + 1]);
+          if (optimizerIdAttr != nullptr)
+            maxOp->setAttr("TFHE.OId", optimizerIdAttr);
+          next.push_back(maxOp.getResult());
+        }
+        if (level.size() % 2 == 1)
+          next.push_back(level.back());
+        level = next;
+      }
+      nestedBuilder.create<mlir::linalg::YieldOp>(nestedLoc, level[0]);
+    };
 
-    rewriter.replaceOpWithNewOp<mlir::linalg::PoolingNchwMaxOp>(
-        maxpool2dOp, outputTy, mlir::ValueRange{maxpool2dOp.getInput(), kernel},
-        output, stridesAttr, dilationsAttr,
-        llvm::ArrayRef<mlir::NamedAttribute>({maxOpAttr}));
+    llvm::SmallVector<mlir::Type, 1> resTypes{outputTy};
+    llvm::SmallVector<mlir::Value, 1> outs{output};
+    llvm::StringRef doc{""};
+    llvm::StringRef call{""};
+
+    rewriter.replaceOpWithNewOp<mlir::linalg::GenericOp>(
+        maxpool2dOp, resTypes, ins, outs, maps, parallelIteratorType(4), doc,
+        call, bodyBuilder);
 
     return mlir::success();
   };
@@ -1893,7 +2442,7 @@ struct FHELinalgUnaryOpToLinalgGeneric
 
     //  linalg.init_tensor for initial value
     mlir::Value init =
-        rewriter.create<FHE::ZeroTensorOp>(loc, resultTy, mlir::ValueRange{});
+        createElementwiseInit(rewriter, loc, resultTy, linalgOp.getInput());
 
     // Create the affine #maps_0
     llvm::SmallVector<mlir::AffineMap, 2> maps{
@@ -2011,6 +2560,12 @@ struct TensorPartitionFrontierOpToLinalgGeneric
 namespace {
 struct FHETensorOpsToLinalg
     : public FHETensorOpsToLinalgBase<FHETensorOpsToLinalg> {
+  FHETensorOpsToLinalg(int64_t treeReductionMinSize, bool conv2dIm2col,
+                       bool sparseMatmul) {
+    this->treeReductionMinSize = treeReductionMinSize;
+    this->conv2dIm2col = conv2dIm2col;
+    this->sparseMatmul = sparseMatmul;
+  }
 
   void runOnOperation() final;
 };
@@ -2025,6 +2580,7 @@ void FHETensorOpsToLinalg::runOnOperation() {
   target.addLegalDialect<mlir::concretelang::FHE::FHEDialect>();
   target.addLegalDialect<mlir::tensor::TensorDialect>();
   target.addLegalDialect<mlir::arith::ArithDialect>();
+  target.addLegalDialect<mlir::scf::SCFDialect>();
   target.addIllegalOp<mlir::concretelang::FHELinalg::Dot>();
   target.addIllegalDialect<mlir::concretelang::FHELinalg::FHELinalgDialect>();
 
@@ -2048,7 +2604,8 @@ void FHETensorOpsToLinalg::runOnOperation() {
       [](FHELinalg::Dot &dot, FHE::AddEintOp &add, FHE::MulEintIntOp &mul) {
         forwardOptimizerID(dot, add);
         forwardOptimizerID(dot, mul);
-      });
+      },
+      treeReductionMinSize);
   patterns.insert<DotToLinalgGeneric<mlir::concretelang::FHELinalg::DotEint,
                                      mlir::concretelang::FHE::MulEintOp>>(
       &getContext(),
@@ -2070,7 +2627,8 @@ void FHETensorOpsToLinalg::runOnOperation() {
                      builder.getI32IntegerAttr(optimizerIds.back()));
         mul->setAttr("TFHE.OId",
                      builder.getDenseI32ArrayAttr(optimizerIds.drop_back()));
-      });
+      },
+      treeReductionMinSize);
   patterns.insert<
       FHELinalgOpToLinalgGeneric<mlir::concretelang::FHELinalg::AddEintOp,
                                  mlir::concretelang::FHE::AddEintOp>>(
@@ -2141,6 +2699,8 @@ void FHETensorOpsToLinalg::runOnOperation() {
         forwardOptimizerID(dot, add);
         forwardOptimizerID(dot, mul);
       });
+  if (sparseMatmul)
+    patterns.insert<FHELinalgSparseMatmulToLoops>(&getContext());
   patterns.insert<FHELinalgMatmulToLinalgGeneric<
       mlir::concretelang::FHELinalg::MatMulIntEintOp,
       mlir::concretelang::FHE::MulEintIntOp>>(
@@ -2182,9 +2742,9 @@ void FHETensorOpsToLinalg::runOnOperation() {
   patterns.insert<FHELinalgApplyMultiLookupTableToLinalgGeneric>(&getContext());
   patterns.insert<FHELinalgApplyMappedLookupTableToLinalgGeneric>(
       &getContext());
-  patterns.insert<SumToLinalgGeneric>(&getContext());
+  patterns.insert<SumToLinalgGeneric>(&getContext(), treeReductionMinSize);
   patterns.insert<ConcatRewritePattern>(&getContext());
-  patterns.insert<FHELinalgConv2dToLinalgConv2d>(&getContext());
+  patterns.insert<FHELinalgConv2dToLinalgConv2d>(&getContext(), conv2dIm2col);
   patterns.insert<FHELinalgMaxpool2dToLinalgMaxpool2d>(&getContext());
   patterns.insert<TransposeToLinalgGeneric>(&getContext());
   patterns.insert<FromElementToTensorFromElements>(&getContext());
@@ -2200,8 +2760,10 @@ void FHETensorOpsToLinalg::runOnOperation() {
 namespace mlir {
 namespace concretelang {
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
-createConvertFHETensorOpsToLinalg() {
-  return std::make_unique<FHETensorOpsToLinalg>();
+createConvertFHETensorOpsToLinalg(int64_t treeReductionMinSize,
+                                  bool conv2dIm2col, bool sparseMatmul) {
+  return std::make_unique<FHETensorOpsToLinalg>(treeReductionMinSize,
+                                                conv2dIm2col, sparseMatmul);
 }
 } // namespace concretelang
 } // namespace mlir
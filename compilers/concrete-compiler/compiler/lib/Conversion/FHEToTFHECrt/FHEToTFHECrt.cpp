@@ -8,6 +8,7 @@
 #include <mlir/Dialect/Bufferization/IR/Bufferization.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
 #include <mlir/IR/Operation.h>
 
 #include "concretelang/Conversion/Utils/GenericOpTypeConversionPattern.h"
@@ -585,7 +586,7 @@ struct ApplyLookupTableEintOpPattern
         op.getLoc(), converter->convertType(op.getType()), adaptor.getA(),
         newLut,
         TFHE::GLWEKeyswitchKeyAttr::get(op.getContext(), TFHE::GLWESecretKey(),
-                                        TFHE::GLWESecretKey(), -1, -1, -1),
+                                        TFHE::GLWESecretKey(), -1, -1, -1, 0),
         TFHE::GLWEBootstrapKeyAttr::get(op.getContext(), TFHE::GLWESecretKey(),
                                         TFHE::GLWESecretKey(), -1, -1, -1, -1,
                                         -1),
@@ -941,6 +942,33 @@ struct ZeroOpPattern : public CrtOpPattern<FHE::ZeroEintOp> {
 
 } // namespace lowering
 
+/// The lookup tables packed in a single bootstrap gain nothing with the wop
+/// pbs, they are split back into one table lookup each.
+static void splitManyLookupTables(mlir::Operation *root) {
+  root->walk([&](FHE::ApplyManyLookupTablesEintOp op) {
+    mlir::OpBuilder builder(op);
+    auto lutsType = op.getLuts().getType().cast<mlir::RankedTensorType>();
+    int64_t lutSize = lutsType.getShape()[1];
+    auto lutType =
+        mlir::RankedTensorType::get({lutSize}, lutsType.getElementType());
+    for (auto result : llvm::enumerate(op.getResults())) {
+      int64_t index = result.index();
+      mlir::Value lut = builder.create<mlir::tensor::ExtractSliceOp>(
+          op.getLoc(), lutType, op.getLuts(),
+          mlir::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(index),
+                                             builder.getIndexAttr(0)},
+          mlir::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(1),
+                                             builder.getIndexAttr(lutSize)},
+          mlir::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(1),
+                                             builder.getIndexAttr(1)});
+      mlir::Value tlu = builder.create<FHE::ApplyLookupTableEintOp>(
+          op.getLoc(), result.value().getType(), op.getA(), lut);
+      result.value().replaceAllUsesWith(tlu);
+    }
+    op->erase();
+  });
+}
+
 struct FHEToTFHECrtPass : public FHEToTFHECrtBase<FHEToTFHECrtPass> {
 
   FHEToTFHECrtPass(mlir::concretelang::CrtLoweringParameters params)
@@ -949,6 +977,8 @@ struct FHEToTFHECrtPass : public FHEToTFHECrtBase<FHEToTFHECrtPass> {
   void runOnOperation() override {
     auto op = this->getOperation();
 
+    splitManyLookupTables(op);
+
     mlir::ConversionTarget target(getContext());
     typing::TypeConverter converter(loweringParameters);
 
@@ -1002,6 +1032,8 @@ struct FHEToTFHECrtPass : public FHEToTFHECrtBase<FHEToTFHECrtPass> {
         mlir::concretelang::Optimizer::PartitionFrontierOp>(target, converter);
     mlir::concretelang::addDynamicallyLegalTypeOp<mlir::tensor::EmptyOp>(
         target, converter);
+    mlir::concretelang::addDynamicallyLegalTypeOp<mlir::tensor::DimOp>(
+        target, converter);
     mlir::concretelang::addDynamicallyLegalTypeOp<
         mlir::tensor::ParallelInsertSliceOp>(target, converter);
 
@@ -1094,7 +1126,9 @@ struct FHEToTFHECrtPass : public FHEToTFHECrtBase<FHEToTFHECrtPass> {
         &getContext(), converter);
 
     patterns.add<mlir::concretelang::TypeConvertingReinstantiationPattern<
-        mlir::tensor::EmptyOp>>(&getContext(), converter);
+                     mlir::tensor::EmptyOp>,
+                 mlir::concretelang::TypeConvertingReinstantiationPattern<
+                     mlir::tensor::DimOp>>(&getContext(), converter);
 
     mlir::concretelang::populateWithRTTypeConverterPatterns(patterns, target,
                                                             converter);
@@ -393,7 +393,7 @@ struct ApplyLookupTableEintOpPattern
         op.getLoc(), getTypeConverter()->convertType(adaptor.getA().getType()),
         input,
         TFHE::GLWEKeyswitchKeyAttr::get(op.getContext(), TFHE::GLWESecretKey(),
-                                        TFHE::GLWESecretKey(), -1, -1, -1));
+                                        TFHE::GLWESecretKey(), -1, -1, -1, 0));
     if (operatorIndexes != nullptr) {
       ksOp->setAttr("TFHE.OId",
                     rewriter.getI32IntegerAttr(
@@ -418,6 +418,101 @@ private:
   mlir::concretelang::ScalarLoweringParameters loweringParameters;
 };
 
+/// Rewriter for the `FHE::apply_many_lookup_tables` operation.
+struct ApplyManyLookupTablesEintOpPattern
+    : public ScalarOpPattern<FHE::ApplyManyLookupTablesEintOp> {
+  ApplyManyLookupTablesEintOpPattern(
+      mlir::TypeConverter &converter, mlir::MLIRContext *context,
+      mlir::concretelang::ScalarLoweringParameters loweringParams,
+      mlir::PatternBenefit benefit = 1)
+      : ScalarOpPattern<FHE::ApplyManyLookupTablesEintOp>(converter, context,
+                                                          benefit),
+        loweringParameters(loweringParams) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(FHE::ApplyManyLookupTablesEintOp op,
+                  FHE::ApplyManyLookupTablesEintOp::Adaptor adaptor,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+
+    auto inputType = op.getA().getType().cast<FHE::FheIntegerInterface>();
+    size_t outputBits =
+        op.getResult(0).getType().cast<FHE::FheIntegerInterface>().getWidth();
+    mlir::Value newLut =
+        rewriter
+            .create<TFHE::EncodeExpandManyLutForBootstrapOp>(
+                op.getLoc(),
+                mlir::RankedTensorType::get(
+                    mlir::ArrayRef<int64_t>(loweringParameters.polynomialSize),
+                    rewriter.getI64Type()),
+                op.getLuts(),
+                rewriter.getI32IntegerAttr(loweringParameters.polynomialSize),
+                rewriter.getI32IntegerAttr(outputBits),
+                rewriter.getBoolAttr(inputType.isSigned()))
+            .getResult();
+
+    typing::TypeConverter converter;
+    mlir::Value input = adaptor.getA();
+
+    // See `addManyLut` in ConcreteOptimizer.cpp, the packed bootstrap is
+    // the last operator.
+    auto operatorIndexes =
+        op->getAttrOfType<mlir::DenseI32ArrayAttr>("TFHE.OId");
+
+    if (inputType.isSigned()) {
+      // Same as for `FHE::apply_lookup_table`, the signed input is offset so
+      // that the (virtual) msb is 0.
+      uint64_t constantRaw = (uint64_t)1 << (inputType.getWidth() - 1);
+      mlir::Value constant = rewriter.create<mlir::arith::ConstantOp>(
+          op.getLoc(),
+          rewriter.getIntegerAttr(
+              rewriter.getIntegerType(inputType.getWidth() + 1), constantRaw));
+      mlir::Value encodedConstant = writePlaintextShiftEncoding(
+          op.getLoc(), constant, inputType.getWidth(), rewriter);
+      auto inputOp = rewriter.create<TFHE::AddGLWEIntOp>(
+          op.getLoc(), converter.convertType(input.getType()), input,
+          encodedConstant);
+      if (operatorIndexes != nullptr) {
+        inputOp->setAttr("TFHE.OId",
+                         rewriter.getI32IntegerAttr(operatorIndexes[0]));
+      }
+      input = inputOp;
+    }
+
+    // Insert keyswitch
+    auto ksOp = rewriter.create<TFHE::KeySwitchGLWEOp>(
+        op.getLoc(), getTypeConverter()->convertType(adaptor.getA().getType()),
+        input,
+        TFHE::GLWEKeyswitchKeyAttr::get(op.getContext(), TFHE::GLWESecretKey(),
+                                        TFHE::GLWESecretKey(), -1, -1, -1, 0));
+    if (operatorIndexes != nullptr) {
+      ksOp->setAttr("TFHE.OId",
+                    rewriter.getI32IntegerAttr(
+                        operatorIndexes[operatorIndexes.size() - 1]));
+    }
+
+    // Insert bootstrap
+    mlir::SmallVector<mlir::Type> resultTypes;
+    if (getTypeConverter()
+            ->convertTypes(op.getResultTypes(), resultTypes)
+            .failed())
+      return mlir::failure();
+    auto bsOp = rewriter.replaceOpWithNewOp<TFHE::ManyLutBootstrapGLWEOp>(
+        op, resultTypes, ksOp, newLut,
+        TFHE::GLWEBootstrapKeyAttr::get(op.getContext(), TFHE::GLWESecretKey(),
+                                        TFHE::GLWESecretKey(), -1, -1, -1, -1,
+                                        -1));
+    if (operatorIndexes != nullptr) {
+      bsOp->setAttr("TFHE.OId",
+                    rewriter.getI32IntegerAttr(
+                        operatorIndexes[operatorIndexes.size() - 1]));
+    }
+    return mlir::success();
+  };
+
+private:
+  mlir::concretelang::ScalarLoweringParameters loweringParameters;
+};
+
 template <typename Op>
 std::vector<mlir::Value> extractBitWithClearedLowerBits(
     Op op, mlir::Type inputType, uint64_t inputBitwidth,
@@ -522,7 +617,7 @@ std::vector<mlir::Value> extractBitWithClearedLowerBits(
   auto context = op.getContext();
   auto secretKey = TFHE::GLWESecretKey();
   auto ksk = TFHE::GLWEKeyswitchKeyAttr::get(context, secretKey, secretKey, -1,
-                                             -1, -1);
+                                             -1, -1, 0);
   auto bsk = TFHE::GLWEBootstrapKeyAttr::get(context, secretKey, secretKey, -1,
                                              -1, -1, -1, -1);
 
@@ -838,6 +933,8 @@ struct FHEToTFHEScalarPass : public FHEToTFHEScalarBase<FHEToTFHEScalarPass> {
                                                                 &getContext());
     //    |_ `FHE::apply_lookup_table`
     patterns.add<lowering::ApplyLookupTableEintOpPattern,
+                 //    |_ `FHE::apply_many_lookup_tables`
+                 lowering::ApplyManyLookupTablesEintOpPattern,
                  //    |_ `FHE::round`
                  lowering::RoundEintOpPattern,
                  //    |_ `FHE::lsb`
@@ -4,6 +4,7 @@
 // for license information.
 
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
 
@@ -522,6 +523,292 @@ struct KeySwitchGLWEOpPattern
   }
 };
 
+/// Builds an elementwise `linalg.generic` over the tensor operands of a
+/// batched operation, whose scalar operands are broadcast. `buildScalar`
+/// builds the scalar operation from the operands of an element.
+mlir::Value createElementwiseOp(
+    mlir::ConversionPatternRewriter &rewriter, mlir::Location loc,
+    mlir::RankedTensorType resultType, mlir::ValueRange operands,
+    std::function<mlir::Value(mlir::OpBuilder &, mlir::Location,
+                              mlir::ValueRange)>
+        buildScalar) {
+  llvm::SmallVector<mlir::Value> tensorOperands;
+  for (mlir::Value operand : operands)
+    if (operand.getType().isa<mlir::RankedTensorType>())
+      tensorOperands.push_back(operand);
+
+  llvm::SmallVector<mlir::Value> dynamicSizes;
+  if (resultType.isDynamicDim(0))
+    dynamicSizes.push_back(
+        rewriter.create<mlir::tensor::DimOp>(loc, tensorOperands[0], 0));
+  mlir::Value init =
+      rewriter.create<mlir::tensor::EmptyOp>(loc, resultType, dynamicSizes);
+
+  llvm::SmallVector<mlir::AffineMap> maps(
+      tensorOperands.size() + 1, rewriter.getMultiDimIdentityMap(1));
+  llvm::SmallVector<mlir::utils::IteratorType> iteratorTypes{
+      mlir::utils::IteratorType::parallel};
+
+  auto genericOp = rewriter.create<mlir::linalg::GenericOp>(
+      loc, resultType, tensorOperands, init, maps, iteratorTypes,
+      [&](mlir::OpBuilder &builder, mlir::Location nestedLoc,
+          mlir::ValueRange blockArgs) {
+        llvm::SmallVector<mlir::Value> elements;
+        size_t tensorIdx = 0;
+        for (mlir::Value operand : operands)
+          elements.push_back(operand.getType().isa<mlir::RankedTensorType>()
+                                 ? blockArgs[tensorIdx++]
+                                 : operand);
+        mlir::Value result = buildScalar(builder, nestedLoc, elements);
+        builder.create<mlir::linalg::YieldOp>(nestedLoc, result);
+      });
+
+  return genericOp.getResult(0);
+}
+
+/// Lowers a batched levelled operation to the elementwise application of
+/// `ArithOp` on the plaintexts
+template <typename BatchedOp, typename ArithOp>
+struct BatchedBinaryOpPattern : public mlir::OpConversionPattern<BatchedOp> {
+
+  BatchedBinaryOpPattern(mlir::MLIRContext *context,
+                         mlir::TypeConverter &typeConverter)
+      : mlir::OpConversionPattern<BatchedOp>(
+            typeConverter, context,
+            mlir::concretelang::DEFAULT_PATTERN_BENEFIT) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(BatchedOp batchedOp, typename BatchedOp::Adaptor adaptor,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+    auto resultType = this->getTypeConverter()
+                          ->convertType(batchedOp.getType())
+                          .template cast<mlir::RankedTensorType>();
+
+    rewriter.replaceOp(
+        batchedOp,
+        createElementwiseOp(
+            rewriter, batchedOp.getLoc(), resultType, adaptor.getOperands(),
+            [](mlir::OpBuilder &builder, mlir::Location loc,
+               mlir::ValueRange elements) -> mlir::Value {
+              return builder.create<ArithOp>(loc, elements[0], elements[1]);
+            }));
+
+    return mlir::success();
+  }
+};
+
+struct BatchedNegOpPattern
+    : public mlir::OpConversionPattern<TFHE::BatchedNegGLWEOp> {
+
+  BatchedNegOpPattern(mlir::MLIRContext *context,
+                      mlir::TypeConverter &typeConverter)
+      : mlir::OpConversionPattern<TFHE::BatchedNegGLWEOp>(
+            typeConverter, context,
+            mlir::concretelang::DEFAULT_PATTERN_BENEFIT) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(TFHE::BatchedNegGLWEOp negOp,
+                  TFHE::BatchedNegGLWEOp::Adaptor adaptor,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+    auto resultType = this->getTypeConverter()
+                          ->convertType(negOp.getType())
+                          .cast<mlir::RankedTensorType>();
+
+    // same as sim_neg_lwe_u64, without a call per ciphertext
+    rewriter.replaceOp(
+        negOp, createElementwiseOp(
+                   rewriter, negOp.getLoc(), resultType, adaptor.getOperands(),
+                   [](mlir::OpBuilder &builder, mlir::Location loc,
+                      mlir::ValueRange elements) -> mlir::Value {
+                     mlir::Value zero =
+                         builder.create<mlir::arith::ConstantIntOp>(loc, 0, 64);
+                     return builder.create<mlir::arith::SubIOp>(loc, zero,
+                                                                elements[0]);
+                   }));
+
+    return mlir::success();
+  }
+};
+
+struct BatchedKeySwitchGLWEOpPattern
+    : public mlir::OpConversionPattern<TFHE::BatchedKeySwitchGLWEOp> {
+
+  BatchedKeySwitchGLWEOpPattern(mlir::MLIRContext *context,
+                                mlir::TypeConverter &typeConverter)
+      : mlir::OpConversionPattern<TFHE::BatchedKeySwitchGLWEOp>(
+            typeConverter, context,
+            mlir::concretelang::DEFAULT_PATTERN_BENEFIT) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(TFHE::BatchedKeySwitchGLWEOp ksOp,
+                  TFHE::BatchedKeySwitchGLWEOp::Adaptor adaptor,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+
+    const std::string funcName = "sim_batched_keyswitch_lwe_u64";
+
+    auto resultType = ksOp.getType().cast<mlir::RankedTensorType>();
+    auto inputType =
+        ksOp.getCiphertexts().getType().cast<mlir::RankedTensorType>();
+    auto resultGlwe =
+        resultType.getElementType().cast<TFHE::GLWECipherTextType>();
+    auto inputGlwe =
+        inputType.getElementType().cast<TFHE::GLWECipherTextType>();
+
+    auto levels = adaptor.getKey().getLevels();
+    auto baseLog = adaptor.getKey().getBaseLog();
+    auto inputDim = inputGlwe.getKey().getNormalized().value().dimension;
+    auto outputDim = resultGlwe.getKey().getNormalized().value().dimension;
+
+    mlir::Value levelCst =
+        rewriter.create<mlir::arith::ConstantIntOp>(ksOp.getLoc(), levels, 32);
+    mlir::Value baseLogCst =
+        rewriter.create<mlir::arith::ConstantIntOp>(ksOp.getLoc(), baseLog, 32);
+    mlir::Value inputDimCst = rewriter.create<mlir::arith::ConstantIntOp>(
+        ksOp.getLoc(), inputDim, 32);
+    mlir::Value outputDimCst = rewriter.create<mlir::arith::ConstantIntOp>(
+        ksOp.getLoc(), outputDim, 32);
+
+    mlir::Value outputBuffer =
+        rewriter.create<mlir::bufferization::AllocTensorOp>(
+            ksOp.getLoc(),
+            this->getTypeConverter()
+                ->convertType(resultType)
+                .cast<mlir::RankedTensorType>(),
+            mlir::ValueRange{});
+
+    auto dynamicResultType = toDynamicTensorType(this->getTypeConverter()
+                                                     ->convertType(resultType)
+                                                     .cast<mlir::TensorType>());
+    auto dynamicInputType = toDynamicTensorType(this->getTypeConverter()
+                                                    ->convertType(inputType)
+                                                    .cast<mlir::TensorType>());
+
+    mlir::Value castedOutputBuffer = rewriter.create<mlir::tensor::CastOp>(
+        ksOp.getLoc(), dynamicResultType, outputBuffer);
+    mlir::Value castedCiphertexts = rewriter.create<mlir::tensor::CastOp>(
+        ksOp.getLoc(), dynamicInputType, adaptor.getCiphertexts());
+
+    // void sim_batched_keyswitch_lwe_u64(uint64_t *out, ..., uint64_t *in,
+    // ..., uint32_t level, uint32_t base_log, uint32_t input_lwe_dim,
+    // uint32_t output_lwe_dim)
+    if (insertForwardDeclaration(
+            ksOp, rewriter, funcName,
+            rewriter.getFunctionType(
+                {dynamicResultType, dynamicInputType,
+                 rewriter.getIntegerType(32), rewriter.getIntegerType(32),
+                 rewriter.getIntegerType(32), rewriter.getIntegerType(32)},
+                {}))
+            .failed()) {
+      return mlir::failure();
+    }
+
+    rewriter.create<mlir::func::CallOp>(
+        ksOp.getLoc(), funcName, mlir::TypeRange{},
+        mlir::ValueRange({castedOutputBuffer, castedCiphertexts, levelCst,
+                          baseLogCst, inputDimCst, outputDimCst}));
+
+    rewriter.replaceOp(ksOp, outputBuffer);
+
+    return mlir::success();
+  }
+};
+
+/// Lowers the batched bootstraps, with one lookup table for all the
+/// ciphertexts or one per ciphertext
+template <typename BatchedBootstrapOp>
+struct BatchedBootstrapGLWEOpPattern
+    : public mlir::OpConversionPattern<BatchedBootstrapOp> {
+
+  BatchedBootstrapGLWEOpPattern(mlir::MLIRContext *context,
+                                mlir::TypeConverter &typeConverter,
+                                llvm::StringRef funcName)
+      : mlir::OpConversionPattern<BatchedBootstrapOp>(
+            typeConverter, context,
+            mlir::concretelang::DEFAULT_PATTERN_BENEFIT),
+        funcName(funcName) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(BatchedBootstrapOp bsOp,
+                  typename BatchedBootstrapOp::Adaptor adaptor,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+
+    auto resultType = bsOp.getType().template cast<mlir::RankedTensorType>();
+    auto inputType = bsOp.getCiphertexts()
+                         .getType()
+                         .template cast<mlir::RankedTensorType>();
+    auto inputGlwe =
+        inputType.getElementType().template cast<TFHE::GLWECipherTextType>();
+
+    auto polySize = adaptor.getKey().getPolySize();
+    auto glweDimension = adaptor.getKey().getGlweDim();
+    auto levels = adaptor.getKey().getLevels();
+    auto baseLog = adaptor.getKey().getBaseLog();
+    auto inputLweDimension =
+        inputGlwe.getKey().getNormalized().value().dimension;
+
+    auto polySizeCst = rewriter.create<mlir::arith::ConstantIntOp>(
+        bsOp.getLoc(), polySize, 32);
+    auto glweDimensionCst = rewriter.create<mlir::arith::ConstantIntOp>(
+        bsOp.getLoc(), glweDimension, 32);
+    auto levelsCst =
+        rewriter.create<mlir::arith::ConstantIntOp>(bsOp.getLoc(), levels, 32);
+    auto baseLogCst =
+        rewriter.create<mlir::arith::ConstantIntOp>(bsOp.getLoc(), baseLog, 32);
+    auto inputLweDimensionCst = rewriter.create<mlir::arith::ConstantIntOp>(
+        bsOp.getLoc(), inputLweDimension, 32);
+
+    auto convertedResultType = this->getTypeConverter()
+                                   ->convertType(resultType)
+                                   .template cast<mlir::RankedTensorType>();
+    mlir::Value outputBuffer =
+        rewriter.create<mlir::bufferization::AllocTensorOp>(
+            bsOp.getLoc(), convertedResultType, mlir::ValueRange{});
+
+    auto dynamicResultType = toDynamicTensorType(convertedResultType);
+    auto dynamicInputType =
+        toDynamicTensorType(this->getTypeConverter()
+                                ->convertType(inputType)
+                                .template cast<mlir::TensorType>());
+    auto dynamicLutType = toDynamicTensorType(bsOp.getLookupTable().getType());
+
+    mlir::Value castedOutputBuffer = rewriter.create<mlir::tensor::CastOp>(
+        bsOp.getLoc(), dynamicResultType, outputBuffer);
+    mlir::Value castedCiphertexts = rewriter.create<mlir::tensor::CastOp>(
+        bsOp.getLoc(), dynamicInputType, adaptor.getCiphertexts());
+    mlir::Value castedLUT = rewriter.create<mlir::tensor::CastOp>(
+        bsOp.getLoc(), dynamicLutType, adaptor.getLookupTable());
+
+    // void sim_batched_[mapped_]bootstrap_lwe_u64(uint64_t *out, ...,
+    // uint64_t *in, ..., uint64_t *tlu, ..., uint32_t input_lwe_dim,
+    // uint32_t poly_size, uint32_t level, uint32_t base_log,
+    // uint32_t glwe_dim)
+    if (insertForwardDeclaration(
+            bsOp, rewriter, funcName,
+            rewriter.getFunctionType(
+                {dynamicResultType, dynamicInputType, dynamicLutType,
+                 rewriter.getIntegerType(32), rewriter.getIntegerType(32),
+                 rewriter.getIntegerType(32), rewriter.getIntegerType(32),
+                 rewriter.getIntegerType(32)},
+                {}))
+            .failed()) {
+      return mlir::failure();
+    }
+
+    rewriter.create<mlir::func::CallOp>(
+        bsOp.getLoc(), funcName, mlir::TypeRange{},
+        mlir::ValueRange({castedOutputBuffer, castedCiphertexts, castedLUT,
+                          inputLweDimensionCst, polySizeCst, levelsCst,
+                          baseLogCst, glweDimensionCst}));
+
+    rewriter.replaceOp(bsOp, outputBuffer);
+
+    return mlir::success();
+  }
+
+private:
+  std::string funcName;
+};
+
 struct ZeroOpPattern : public mlir::OpConversionPattern<TFHE::ZeroGLWEOp> {
   ZeroOpPattern(mlir::MLIRContext *context, mlir::TypeConverter &typeConverter)
       : mlir::OpConversionPattern<TFHE::ZeroGLWEOp>(
@@ -609,7 +896,9 @@ void SimulateTFHEPass::runOnOperation() {
                   mlir::concretelang::TypeConvertingReinstantiationPattern<
                       mlir::tensor::YieldOp>,
                   mlir::concretelang::TypeConvertingReinstantiationPattern<
-                      mlir::tensor::EmptyOp>>(&getContext(), converter);
+                      mlir::tensor::EmptyOp>,
+                  mlir::concretelang::TypeConvertingReinstantiationPattern<
+                      mlir::tensor::DimOp>>(&getContext(), converter);
   // legalize ops only if operand and result types are legal
   target.addDynamicallyLegalOp<
       mlir::tensor::YieldOp, mlir::scf::YieldOp, mlir::tensor::GenerateOp,
@@ -617,7 +906,7 @@ void SimulateTFHEPass::runOnOperation() {
       mlir::tensor::InsertOp, mlir::tensor::InsertSliceOp,
       mlir::tensor::FromElementsOp, mlir::tensor::ExpandShapeOp,
       mlir::tensor::CollapseShapeOp, mlir::bufferization::AllocTensorOp,
-      mlir::tensor::EmptyOp>([&](mlir::Operation *op) {
+      mlir::tensor::EmptyOp, mlir::tensor::DimOp>([&](mlir::Operation *op) {
     return converter.isLegal(op->getResultTypes()) &&
            converter.isLegal(op->getOperandTypes());
   });
@@ -647,6 +936,27 @@ void SimulateTFHEPass::runOnOperation() {
                                                                  converter);
   patterns.insert<SubIntGLWEOpPattern>(&getContext());
 
+  // Batched operations, as formed by the batching pass
+  patterns.insert<
+      BatchedBinaryOpPattern<TFHE::ABatchedAddGLWEIntOp, mlir::arith::AddIOp>,
+      BatchedBinaryOpPattern<TFHE::ABatchedAddGLWEIntCstOp,
+                             mlir::arith::AddIOp>,
+      BatchedBinaryOpPattern<TFHE::ABatchedAddGLWECstIntOp,
+                             mlir::arith::AddIOp>,
+      BatchedBinaryOpPattern<TFHE::ABatchedAddGLWEOp, mlir::arith::AddIOp>,
+      BatchedBinaryOpPattern<TFHE::BatchedMulGLWEIntOp, mlir::arith::MulIOp>,
+      BatchedBinaryOpPattern<TFHE::BatchedMulGLWECstIntOp,
+                             mlir::arith::MulIOp>,
+      BatchedBinaryOpPattern<TFHE::BatchedMulGLWEIntCstOp,
+                             mlir::arith::MulIOp>,
+      BatchedNegOpPattern, BatchedKeySwitchGLWEOpPattern>(&getContext(),
+                                                          converter);
+  patterns.insert<BatchedBootstrapGLWEOpPattern<TFHE::BatchedBootstrapGLWEOp>>(
+      &getContext(), converter, "sim_batched_bootstrap_lwe_u64");
+  patterns.insert<
+      BatchedBootstrapGLWEOpPattern<TFHE::BatchedMappedBootstrapGLWEOp>>(
+      &getContext(), converter, "sim_batched_mapped_bootstrap_lwe_u64");
+
   patterns.add<mlir::concretelang::TypeConvertingReinstantiationPattern<
                    mlir::func::ReturnOp>,
                mlir::concretelang::TypeConvertingReinstantiationPattern<
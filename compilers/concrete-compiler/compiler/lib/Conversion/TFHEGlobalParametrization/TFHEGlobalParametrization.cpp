@@ -123,7 +123,7 @@ struct KeySwitchGLWEOpPattern
     auto newOutputKey = converter.getIntraPBSKey();
     auto keyswitchKey = TFHE::GLWEKeyswitchKeyAttr::get(
         ksOp->getContext(), newInputKey, newOutputKey, cryptoParameters.ksLevel,
-        cryptoParameters.ksLogBase, -1);
+        cryptoParameters.ksLogBase, -1, 0);
     auto newOp = rewriter.replaceOpWithNewOp<TFHE::KeySwitchGLWEOp>(
         ksOp, newOutputTy, ksOp.getCiphertext(), keyswitchKey);
     rewriter.startRootUpdate(newOp);
@@ -176,6 +176,46 @@ private:
   const mlir::concretelang::V0Parameter cryptoParameters;
 };
 
+struct ManyLutBootstrapGLWEOpPattern
+    : public mlir::OpRewritePattern<TFHE::ManyLutBootstrapGLWEOp> {
+  ManyLutBootstrapGLWEOpPattern(
+      mlir::MLIRContext *context,
+      TFHEGlobalParametrizationTypeConverter &converter,
+      const mlir::concretelang::V0Parameter cryptoParameters,
+      mlir::PatternBenefit benefit =
+          mlir::concretelang::DEFAULT_PATTERN_BENEFIT)
+      : mlir::OpRewritePattern<TFHE::ManyLutBootstrapGLWEOp>(context, benefit),
+        converter(converter), cryptoParameters(cryptoParameters) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(TFHE::ManyLutBootstrapGLWEOp bsOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto inputTy =
+        bsOp.getCiphertext().getType().cast<TFHE::GLWECipherTextType>();
+    auto newInputTy = converter.glweIntraPBSType(inputTy);
+    mlir::SmallVector<mlir::Type> newOutputTys;
+    for (auto outputTy : bsOp.getResultTypes())
+      newOutputTys.push_back(converter.convertType(outputTy));
+    auto newInputKey = converter.getIntraPBSKey();
+    auto newOutputKey = converter.getInterPBSKey();
+    auto bootstrapKey = TFHE::GLWEBootstrapKeyAttr::get(
+        bsOp->getContext(), newInputKey, newOutputKey,
+        cryptoParameters.getPolynomialSize(), cryptoParameters.glweDimension,
+        cryptoParameters.brLevel, cryptoParameters.brLogBase, -1);
+    auto newOp = rewriter.replaceOpWithNewOp<TFHE::ManyLutBootstrapGLWEOp>(
+        bsOp, newOutputTys, bsOp.getCiphertext(), bsOp.getLookupTable(),
+        bootstrapKey);
+    rewriter.startRootUpdate(newOp);
+    newOp.getCiphertext().setType(newInputTy);
+    rewriter.finalizeRootUpdate(newOp);
+    return mlir::success();
+  };
+
+private:
+  TFHEGlobalParametrizationTypeConverter &converter;
+  const mlir::concretelang::V0Parameter cryptoParameters;
+};
+
 struct WopPBSGLWEOpPattern : public mlir::OpRewritePattern<TFHE::WopPBSGLWEOp> {
   WopPBSGLWEOpPattern(mlir::MLIRContext *context,
                       TFHEGlobalParametrizationTypeConverter &converter,
@@ -198,7 +238,7 @@ struct WopPBSGLWEOpPattern : public mlir::OpRewritePattern<TFHE::WopPBSGLWEOp> {
     auto intraKey = converter.getIntraPBSKey();
     auto keyswitchKey = TFHE::GLWEKeyswitchKeyAttr::get(
         wopPBSOp->getContext(), interKey, intraKey, cryptoParameters.ksLevel,
-        cryptoParameters.ksLogBase, -1);
+        cryptoParameters.ksLogBase, -1, 0);
     auto bootstrapKey = TFHE::GLWEBootstrapKeyAttr::get(
         wopPBSOp->getContext(), intraKey, interKey,
         cryptoParameters.getPolynomialSize(), cryptoParameters.glweDimension,
@@ -318,6 +358,19 @@ void TFHEGlobalParametrizationPass::runOnOperation() {
                  op.getKeyAttr().getPolySize() != -1;
         });
 
+    // Parametrize many lut bootstrap
+    patterns.add<ManyLutBootstrapGLWEOpPattern>(&getContext(), converter,
+                                                cryptoParameters);
+    target.addDynamicallyLegalOp<TFHE::ManyLutBootstrapGLWEOp>(
+        [&](TFHE::ManyLutBootstrapGLWEOp op) {
+          return op.getKeyAttr().getInputKey().isParameterized() &&
+                 op.getKeyAttr().getOutputKey().isParameterized() &&
+                 op.getKeyAttr().getLevels() != -1 &&
+                 op.getKeyAttr().getBaseLog() != -1 &&
+                 op.getKeyAttr().getGlweDim() != -1 &&
+                 op.getKeyAttr().getPolySize() != -1;
+        });
+
     // Parametrize wop pbs
     patterns.add<WopPBSGLWEOpPattern>(&getContext(), converter,
                                       cryptoParameters);
@@ -59,7 +59,7 @@ public:
     return TFHE::GLWEKeyswitchKeyAttr::get(
         ksk.getContext(), convertSecretKey(ksk.getInputKey()),
         convertSecretKey(ksk.getOutputKey()), ksk.getLevels(), ksk.getBaseLog(),
-        circuitKeys.getKeyswitchKeyIndex(ksk).value());
+        circuitKeys.getKeyswitchKeyIndex(ksk).value(), ksk.getFastPolySize());
   }
 
   TFHE::GLWEPackingKeyswitchKeyAttr
@@ -204,6 +204,39 @@ private:
   conversion::TypeConverter &typeConverter;
 };
 
+struct ManyLutBootstrapGLWEOpPattern
+    : public mlir::OpRewritePattern<TFHE::ManyLutBootstrapGLWEOp> {
+  ManyLutBootstrapGLWEOpPattern(mlir::MLIRContext *context,
+                                conversion::TypeConverter &typeConverter,
+                                conversion::KeyConverter &keyConverter,
+                                mlir::PatternBenefit benefit =
+                                    mlir::concretelang::DEFAULT_PATTERN_BENEFIT)
+      : mlir::OpRewritePattern<TFHE::ManyLutBootstrapGLWEOp>(context, benefit),
+        keyConverter(keyConverter), typeConverter(typeConverter) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(TFHE::ManyLutBootstrapGLWEOp bsOp,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto newInputTy = typeConverter.convertType(bsOp.getCiphertext().getType())
+                          .cast<GLWECipherTextType>();
+    mlir::SmallVector<mlir::Type> newOutputTys;
+    for (auto outputTy : bsOp.getResultTypes())
+      newOutputTys.push_back(typeConverter.convertType(outputTy));
+    auto newBootstrapKey = keyConverter.convertBootstrapKey(bsOp.getKeyAttr());
+    auto newOp = rewriter.replaceOpWithNewOp<TFHE::ManyLutBootstrapGLWEOp>(
+        bsOp, newOutputTys, bsOp.getCiphertext(), bsOp.getLookupTable(),
+        newBootstrapKey);
+    rewriter.startRootUpdate(newOp);
+    newOp.getCiphertext().setType(newInputTy);
+    rewriter.finalizeRootUpdate(newOp);
+    return mlir::success();
+  };
+
+private:
+  conversion::KeyConverter &keyConverter;
+  conversion::TypeConverter &typeConverter;
+};
+
 struct WopPBSGLWEOpPattern : public mlir::OpRewritePattern<TFHE::WopPBSGLWEOp> {
   WopPBSGLWEOpPattern(mlir::MLIRContext *context,
                       conversion::TypeConverter &typeConverter,
@@ -341,6 +374,16 @@ void TFHEKeyNormalizationPass::runOnOperation() {
                  op.getKeyAttr().getIndex() != -1;
         });
 
+    // Parametrize many lut bootstrap
+    patterns.add<patterns::ManyLutBootstrapGLWEOpPattern>(
+        &getContext(), typeConverter, keyConverter);
+    target.addDynamicallyLegalOp<TFHE::ManyLutBootstrapGLWEOp>(
+        [&](TFHE::ManyLutBootstrapGLWEOp op) {
+          return op.getKeyAttr().getInputKey().isNormalized() &&
+                 op.getKeyAttr().getOutputKey().isNormalized() &&
+                 op.getKeyAttr().getIndex() != -1;
+        });
+
     // Parametrize wop pbs
     patterns.add<patterns::WopPBSGLWEOpPattern>(&getContext(), typeConverter,
                                                 keyConverter);
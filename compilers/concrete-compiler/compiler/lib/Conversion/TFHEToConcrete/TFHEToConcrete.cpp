@@ -143,6 +143,61 @@ struct BootstrapGLWEOpPattern
   }
 };
 
+struct ManyLutBootstrapGLWEOpPattern
+    : public mlir::OpConversionPattern<TFHE::ManyLutBootstrapGLWEOp> {
+
+  ManyLutBootstrapGLWEOpPattern(mlir::MLIRContext *context,
+                                mlir::TypeConverter &typeConverter)
+      : mlir::OpConversionPattern<TFHE::ManyLutBootstrapGLWEOp>(
+            typeConverter, context,
+            mlir::concretelang::DEFAULT_PATTERN_BENEFIT) {}
+
+  ::mlir::LogicalResult
+  matchAndRewrite(TFHE::ManyLutBootstrapGLWEOp bsOp,
+                  TFHE::ManyLutBootstrapGLWEOp::Adaptor adaptor,
+                  mlir::ConversionPatternRewriter &rewriter) const override {
+    TFHE::GLWECipherTextType inputType =
+        bsOp.getCiphertext().getType().cast<TFHE::GLWECipherTextType>();
+    mlir::RankedTensorType resultType =
+        this->getTypeConverter()
+            ->convertType(bsOp.getResult(0).getType())
+            .cast<mlir::RankedTensorType>();
+    int64_t lweSize = resultType.getDimSize(0);
+    int64_t numResults = bsOp.getNumResults();
+
+    auto polySize = adaptor.getKey().getPolySize();
+    auto glweDimension = adaptor.getKey().getGlweDim();
+    auto levels = adaptor.getKey().getLevels();
+    auto baseLog = adaptor.getKey().getBaseLog();
+    auto inputLweDimension =
+        inputType.getKey().getNormalized().value().dimension;
+    auto bskIndex = bsOp.getKeyAttr().getIndex();
+
+    // All the results are computed at once, one row per lookup table
+    mlir::Value batch = rewriter.create<Concrete::ManyLutBootstrapLweTensorOp>(
+        bsOp.getLoc(),
+        mlir::RankedTensorType::get({numResults, lweSize},
+                                    resultType.getElementType()),
+        adaptor.getCiphertext(), adaptor.getLookupTable(), inputLweDimension,
+        polySize, levels, baseLog, glweDimension, bskIndex);
+
+    llvm::SmallVector<mlir::Value> results;
+    for (int64_t i = 0; i < numResults; i++) {
+      results.push_back(rewriter.create<mlir::tensor::ExtractSliceOp>(
+          bsOp.getLoc(), resultType, batch,
+          llvm::ArrayRef<mlir::OpFoldResult>{rewriter.getIndexAttr(i),
+                                             rewriter.getIndexAttr(0)},
+          llvm::ArrayRef<mlir::OpFoldResult>{rewriter.getIndexAttr(1),
+                                             rewriter.getIndexAttr(lweSize)},
+          llvm::ArrayRef<mlir::OpFoldResult>{rewriter.getIndexAttr(1),
+                                             rewriter.getIndexAttr(1)}));
+    }
+    rewriter.replaceOp(bsOp, results);
+
+    return mlir::success();
+  }
+};
+
 struct WopPBSGLWEOpPattern
     : public mlir::OpConversionPattern<TFHE::WopPBSGLWEOp> {
 
@@ -831,6 +886,11 @@ void TFHEToConcretePass::runOnOperation() {
           mlir::concretelang::TFHE::EncodeExpandLutForBootstrapOp,
           mlir::concretelang::Concrete::EncodeExpandLutForBootstrapTensorOp,
           true>,
+      mlir::concretelang::GenericOneToOneOpConversionPattern<
+          mlir::concretelang::TFHE::EncodeExpandManyLutForBootstrapOp,
+          mlir::concretelang::Concrete::
+              EncodeExpandManyLutForBootstrapTensorOp,
+          true>,
       mlir::concretelang::GenericOneToOneOpConversionPattern<
           mlir::concretelang::TFHE::EncodeLutForCrtWopPBSOp,
           mlir::concretelang::Concrete::EncodeLutForCrtWopPBSTensorOp, true>,
@@ -864,7 +924,8 @@ void TFHEToConcretePass::runOnOperation() {
                   ZeroOpPattern<mlir::concretelang::TFHE::ZeroTensorGLWEOp>,
                   SubIntGLWEOpPattern, BootstrapGLWEOpPattern,
                   BatchedBootstrapGLWEOpPattern,
-                  BatchedMappedBootstrapGLWEOpPattern, KeySwitchGLWEOpPattern,
+                  BatchedMappedBootstrapGLWEOpPattern,
+                  ManyLutBootstrapGLWEOpPattern, KeySwitchGLWEOpPattern,
                   BatchedKeySwitchGLWEOpPattern, WopPBSGLWEOpPattern>(
       &getContext(), converter);
 
@@ -891,11 +952,11 @@ void TFHEToConcretePass::runOnOperation() {
       mlir::tensor::ExtractSliceOp, mlir::tensor::ExtractOp,
       mlir::tensor::InsertSliceOp, mlir::tensor::ParallelInsertSliceOp,
       mlir::tensor::ExpandShapeOp, mlir::tensor::CollapseShapeOp,
-      mlir::tensor::EmptyOp, mlir::bufferization::AllocTensorOp>(
-      [&](mlir::Operation *op) {
-        return converter.isLegal(op->getResultTypes()) &&
-               converter.isLegal(op->getOperandTypes());
-      });
+      mlir::tensor::EmptyOp, mlir::tensor::DimOp,
+      mlir::bufferization::AllocTensorOp>([&](mlir::Operation *op) {
+    return converter.isLegal(op->getResultTypes()) &&
+           converter.isLegal(op->getOperandTypes());
+  });
 
   // rewrite scf for loops if working on illegal types
   patterns.add<mlir::concretelang::TypeConvertingReinstantiationPattern<
@@ -931,7 +992,9 @@ void TFHEToConcretePass::runOnOperation() {
                mlir::concretelang::TypeConvertingReinstantiationPattern<
                    mlir::bufferization::AllocTensorOp, true>,
                mlir::concretelang::TypeConvertingReinstantiationPattern<
-                   mlir::tensor::EmptyOp, true>>(&getContext(), converter);
+                   mlir::tensor::EmptyOp, true>,
+               mlir::concretelang::TypeConvertingReinstantiationPattern<
+                   mlir::tensor::DimOp>>(&getContext(), converter);
 
   mlir::concretelang::populateWithRTTypeConverterPatterns(patterns, target,
                                                           converter);
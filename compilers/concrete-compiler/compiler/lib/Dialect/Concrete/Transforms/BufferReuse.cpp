@@ -0,0 +1,148 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+
+#include "concretelang/Dialect/Concrete/Transforms/Passes.h"
+#include "concretelang/Support/logging.h"
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+/// Returns true if `alloc` allocates a buffer of a static size which can be
+/// reused or hoisted.
+static bool isReusable(memref::AllocOp alloc) {
+  return alloc.getType().hasStaticShape() && alloc.getDynamicSizes().empty() &&
+         alloc.getSymbolOperands().empty();
+}
+
+/// Returns the size in bytes of the buffers allocated by `alloc`, and 0 if it
+/// is not known statically.
+static int64_t getAllocatedBytes(memref::AllocOp alloc) {
+  MemRefType type = alloc.getType();
+  if (!isReusable(alloc) || !type.getElementType().isIntOrIndex())
+    return 0;
+  int64_t elementBytes =
+      type.getElementType().isIndex()
+          ? 8
+          : (type.getElementType().getIntOrFloatBitWidth() + 7) / 8;
+  return type.getNumElements() * elementBytes;
+}
+
+/// Returns the deallocation of `alloc` in the block of `alloc`, if any.
+static memref::DeallocOp getDeallocInBlock(memref::AllocOp alloc) {
+  for (Operation *user : alloc->getUsers())
+    if (auto dealloc = dyn_cast<memref::DeallocOp>(user))
+      if (dealloc->getBlock() == alloc->getBlock())
+        return dealloc;
+  return nullptr;
+}
+
+/// Returns an estimate of the peak number of bytes allocated while running
+/// `block`, a loop body counting for a single iteration.
+static int64_t getPeakBytes(Block &block) {
+  int64_t live = 0, peak = 0;
+  for (Operation &op : block) {
+    if (auto alloc = dyn_cast<memref::AllocOp>(op)) {
+      live += getAllocatedBytes(alloc);
+    } else if (auto dealloc = dyn_cast<memref::DeallocOp>(op)) {
+      if (auto alloc = dealloc.getMemref().getDefiningOp<memref::AllocOp>())
+        live -= getAllocatedBytes(alloc);
+    }
+    for (Region &region : op.getRegions())
+      for (Block &nested : region)
+        peak = std::max(peak, live + getPeakBytes(nested));
+    peak = std::max(peak, live);
+  }
+  return peak;
+}
+
+/// For documentation see Passes.td
+struct BufferReusePass : public BufferReuseBase<BufferReusePass> {
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (func.isExternal())
+      return;
+    int64_t peakBefore = getPeakBytes(func.getBody().front());
+
+    // Hoisting the buffers out of loops first lets them be reused by the
+    // allocations following the loops.
+    func.walk<WalkOrder::PostOrder>([&](scf::ForOp forOp) { hoist(forOp); });
+    func.walk([&](Block *block) { reuse(*block); });
+
+    int64_t peakAfter = getPeakBytes(func.getBody().front());
+    numReusedBuffers += reusedBuffers;
+    numHoistedBuffers += hoistedBuffers;
+    log_verbose() << "Buffer reuse on " << func.getName() << ": peak memory "
+                  << peakBefore << " bytes before, " << peakAfter
+                  << " bytes after\n";
+  }
+
+private:
+  /// Moves the buffers allocated and deallocated by each iteration of
+  /// `forOp` out of it, so that the iterations share them.
+  void hoist(scf::ForOp forOp) {
+    SmallVector<memref::AllocOp> allocs(
+        forOp.getBody()->getOps<memref::AllocOp>());
+    for (auto alloc : allocs) {
+      memref::DeallocOp dealloc = getDeallocInBlock(alloc);
+      if (!isReusable(alloc) || dealloc == nullptr)
+        continue;
+      alloc->moveBefore(forOp);
+      dealloc->moveAfter(forOp);
+      hoistedBuffers++;
+    }
+  }
+
+  /// Replaces the allocations of `block` by the buffers of the same type
+  /// deallocated before them in the block, the latter having no uses left
+  /// once deallocated.
+  void reuse(Block &block) {
+    llvm::DenseMap<Type, SmallVector<memref::DeallocOp>> freed;
+    for (Operation &op : llvm::make_early_inc_range(block)) {
+      if (auto dealloc = dyn_cast<memref::DeallocOp>(op)) {
+        auto alloc = dealloc.getMemref().getDefiningOp<memref::AllocOp>();
+        if (alloc && alloc->getBlock() == &block && isReusable(alloc))
+          freed[alloc.getType()].push_back(dealloc);
+        continue;
+      }
+      auto alloc = dyn_cast<memref::AllocOp>(op);
+      if (!alloc || !isReusable(alloc))
+        continue;
+      auto it = freed.find(alloc.getType());
+      if (it == freed.end() || it->second.empty())
+        continue;
+      memref::DeallocOp dealloc = it->second.pop_back_val();
+      auto buffer = dealloc.getMemref().getDefiningOp<memref::AllocOp>();
+      if (buffer.getAlignment() != alloc.getAlignment()) {
+        it->second.push_back(dealloc);
+        continue;
+      }
+      // The deallocation of `alloc` now frees the reused buffer.
+      dealloc->erase();
+      alloc.getResult().replaceAllUsesWith(buffer.getResult());
+      alloc->erase();
+      reusedBuffers++;
+    }
+  }
+
+  uint64_t reusedBuffers = 0;
+  uint64_t hoistedBuffers = 0;
+};
+
+} // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>> createBufferReusePass() {
+  return std::make_unique<BufferReusePass>();
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -164,6 +164,10 @@ void mlir::concretelang::Concrete::
     Concrete::BatchedMappedBootstrapLweTensorOp::attachInterface<
         TensorToMemrefOp<Concrete::BatchedMappedBootstrapLweTensorOp,
                          Concrete::BatchedMappedBootstrapLweBufferOp>>(*ctx);
+    // many_lut_bootstrap_lwe_tensor => many_lut_bootstrap_lwe_buffer
+    Concrete::ManyLutBootstrapLweTensorOp::attachInterface<
+        TensorToMemrefOp<Concrete::ManyLutBootstrapLweTensorOp,
+                         Concrete::ManyLutBootstrapLweBufferOp>>(*ctx);
     // wop_pbs_crt_lwe_tensor => wop_pbs_crt_lwe_buffer
     Concrete::WopPBSCRTLweTensorOp::attachInterface<TensorToMemrefOp<
         Concrete::WopPBSCRTLweTensorOp, Concrete::WopPBSCRTLweBufferOp>>(*ctx);
@@ -176,6 +180,12 @@ void mlir::concretelang::Concrete::
     Concrete::EncodeExpandLutForBootstrapTensorOp::attachInterface<
         TensorToMemrefOp<Concrete::EncodeExpandLutForBootstrapTensorOp,
                          Concrete::EncodeExpandLutForBootstrapBufferOp>>(*ctx);
+    // encode_expand_many_lut_for_bootstrap_tensor =>
+    // encode_expand_many_lut_for_bootstrap_buffer
+    Concrete::EncodeExpandManyLutForBootstrapTensorOp::attachInterface<
+        TensorToMemrefOp<Concrete::EncodeExpandManyLutForBootstrapTensorOp,
+                         Concrete::EncodeExpandManyLutForBootstrapBufferOp>>(
+        *ctx);
     // encode_lut_for_crt_woppbs_tensor =>
     // encode_lut_for_crt_woppbs_buffer
     Concrete::EncodeLutForCrtWopPBSTensorOp::attachInterface<
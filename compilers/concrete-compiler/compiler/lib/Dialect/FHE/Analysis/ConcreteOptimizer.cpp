@@ -143,6 +143,11 @@ struct FunctionToDag {
       return;
     }
 
+    if (auto manyLut = asManyLut(op)) {
+      addManyLut(dag, manyLut, encrypted_inputs);
+      return;
+    }
+
     assert(op.getNumResults() == 1);
     auto val = op.getResult(0);
     auto precision = fhe::utils::getEintPrecision(val);
@@ -226,6 +231,37 @@ struct FunctionToDag {
     index[val] = lutIndex;
   }
 
+  /// The tables are packed in a single bootstrap, whose input is rounded
+  /// with `log2(k)` more bits than the operand.
+  void addManyLut(optimizer::Dag &dag, FHE::ApplyManyLookupTablesEintOp &op,
+                  Inputs &encrypted_inputs) {
+    assert(encrypted_inputs.size() == 1);
+    auto encrypted_input = encrypted_inputs[0];
+    auto inputType = op.getA().getType().cast<FHE::FheIntegerInterface>();
+    auto packedPrecision =
+        inputType.getWidth() + llvm::Log2_64(op.getNumResults());
+    auto precision = fhe::utils::getEintPrecision(op.getResult(0));
+    std::vector<std::uint64_t> unknowFunction;
+    std::vector<int32_t> operatorIndexes;
+    if (inputType.isSigned()) {
+      auto addIndex = dag->add_dot(slice(encrypted_inputs),
+                                   concrete_optimizer::weights::number(1));
+      encrypted_input = addIndex;
+      operatorIndexes.push_back(addIndex.index);
+    }
+    auto packedIndex =
+        dag->add_unsafe_cast_op(encrypted_input, packedPrecision);
+    operatorIndexes.push_back(packedIndex.index);
+    auto lutIndex =
+        dag->add_lut(packedIndex, slice(unknowFunction), precision);
+    operatorIndexes.push_back(lutIndex.index);
+    mlir::Builder builder(op.getContext());
+    if (setOptimizerID)
+      op->setAttr("TFHE.OId", builder.getDenseI32ArrayAttr(operatorIndexes));
+    for (auto result : op.getResults())
+      index[result] = lutIndex;
+  }
+
   concrete_optimizer::dag::OperatorIndex addRound(optimizer::Dag &dag,
                                                   mlir::Value &val,
                                                   Inputs &encrypted_inputs,
@@ -716,10 +752,12 @@ struct FunctionToDag {
     // to create a single TLU node in optimizer dag
     std::vector<uint64_t> fakeShape = resultShape;
 
-    uint64_t numberOfComparisons = 1;
-    for (auto dimensionSize :
-         maxpool2dOp.getKernelShape().getValues<int64_t>()) {
-      numberOfComparisons *= dimensionSize;
+    // the maximums of a window are computed with a balanced tree
+    const uint64_t numberOfComparisons = maxpool2dOp.getMaxTreeLeaves() - 1;
+    const uint64_t depth = maxpool2dOp.getMaxTreeDepth();
+    if (numberOfComparisons == 0) {
+      index[result] = inputs[0];
+      return;
     }
     fakeShape.push_back(numberOfComparisons);
 
@@ -736,7 +774,9 @@ struct FunctionToDag {
       inputSmanp = inputSmanpAttr.getValue();
     }
 
-    const double subManp = sqrt(2 * inputSmanp.roundToDouble() + 1);
+    // the operands of the last level are maximums of `depth - 1` levels
+    const double operandSmanp = inputSmanp.roundToDouble() + depth - 1;
+    const double subManp = sqrt(2 * operandSmanp);
 
     auto loc = loc_to_string(maxpool2dOp.getLoc());
     auto comment =
@@ -749,7 +789,7 @@ struct FunctionToDag {
     const std::vector<std::uint64_t> unknownFunction;
     auto tluNode = dag->add_lut(subNode, slice(unknownFunction), precision);
 
-    const double addManp = sqrt(inputSmanp.roundToDouble() + 1);
+    const double addManp = sqrt(operandSmanp + 1);
     const std::vector<concrete_optimizer::dag::OperatorIndex> addInputs = {
         tluNode, inputs[0]};
 
@@ -802,6 +842,10 @@ struct FunctionToDag {
     return eint;
   }
 
+  FHE::ApplyManyLookupTablesEintOp asManyLut(mlir::Operation &op) {
+    return llvm::dyn_cast<FHE::ApplyManyLookupTablesEintOp>(op);
+  }
+
   // Returns the FHE integer type on which the lut is performed else return a
   // nullptr
   FHE::FheIntegerInterface isLut(mlir::Operation &op) {
@@ -940,7 +984,9 @@ struct FunctionToDag {
     if (auto ranked_tensor = type_.dyn_cast_or_null<mlir::RankedTensorType>()) {
       std::vector<std::uint64_t> shape;
       for (auto v : ranked_tensor.getShape()) {
-        shape.push_back(v);
+        // The parameters of a dynamic dimension are optimized for a single
+        // element
+        shape.push_back(mlir::ShapedType::isDynamic(v) ? 1 : v);
       }
       return shape;
     } else {
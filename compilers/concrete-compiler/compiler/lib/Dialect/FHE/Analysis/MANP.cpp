@@ -172,6 +172,14 @@ static llvm::APInt APIntUMax(const llvm::APInt &lhs, const llvm::APInt &rhs) {
   return lhs;
 }
 
+/// Returns `i` on the number of bits of its value, at least one. The helpers
+/// above extend the bit width at each operation, such that the values of long
+/// chains of operations would otherwise be held on ever growing `APInt`s,
+/// allocated out of line once past 64 bits.
+static llvm::APInt APIntShrink(const llvm::APInt &i) {
+  return i.trunc(std::max(1u, i.getActiveBits()));
+}
+
 /// Calculates the square of `i`. The bit width `i` is extended in
 /// order to guarantee that the product fits into the resulting
 /// `APInt`.
@@ -225,31 +233,31 @@ static llvm::APInt conservativeIntNorm2Sq(mlir::Type t) {
 }
 
 static llvm::APInt
-getNoOpSqMANP(llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+getNoOpSqMANP(llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
   // Come from block arg as example
   if (operandMANPs.size() == 0) {
     return llvm::APInt{1, 1, false};
   }
-  assert(operandMANPs[0]->getValue().getMANP().has_value() &&
+  assert(operandMANPs[0].getMANP().has_value() &&
          "Missing squared Minimal Arithmetic Noise Padding for encrypted "
          "operands");
 
-  llvm::APInt eNorm = operandMANPs[0]->getValue().getMANP().value();
+  llvm::APInt eNorm = operandMANPs[0].getMANP().value();
   return eNorm;
 }
 
 /// Calculates the squared Minimal Arithmetic Noise Padding of an
 /// `FHELinalg.dot_eint_eint` operation.
 static llvm::APInt getSqMANP(mlir::concretelang::FHELinalg::DotEint op,
-                             llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+                             llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
   assert(operandMANPs.size() == 2 &&
-         operandMANPs[0]->getValue().getMANP().has_value() &&
-         operandMANPs[1]->getValue().getMANP().has_value() &&
+         operandMANPs[0].getMANP().has_value() &&
+         operandMANPs[1].getMANP().has_value() &&
          "Missing squared Minimal Arithmetic Noise Padding for encrypted "
          "operands");
 
-  llvm::APInt lhsNorm = operandMANPs[0]->getValue().getMANP().value();
-  llvm::APInt rhsNorm = operandMANPs[1]->getValue().getMANP().value();
+  llvm::APInt lhsNorm = operandMANPs[0].getMANP().value();
+  llvm::APInt rhsNorm = operandMANPs[1].getMANP().value();
 
   auto rhsType =
       ((mlir::Type)op.getRhs().getType()).cast<mlir::RankedTensorType>();
@@ -281,16 +289,16 @@ static llvm::APInt getSqMANP(mlir::concretelang::FHELinalg::DotEint op,
 /// operation.
 static std::optional<llvm::APInt>
 getSqMANP(mlir::concretelang::FHE::UnaryEint op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
   // not all unary ops taking an encrypted operand have a type signature
   // reflecting that, a check might be required (FHELinalg.TransposeOp is one
   // such known op)
   if (op.operandIntType().isa<mlir::concretelang::FHE::FheIntegerInterface>()) {
     assert(operandMANPs.size() == 1 &&
-           operandMANPs[0]->getValue().getMANP().has_value() &&
+           operandMANPs[0].getMANP().has_value() &&
            "Missing squared Minimal Arithmetic Noise Padding for encrypted "
            "operand");
-    return op.sqMANP(operandMANPs[0]->getValue().getMANP().value());
+    return op.sqMANP(operandMANPs[0].getMANP().value());
   } else
     return {};
 }
@@ -300,12 +308,12 @@ getSqMANP(mlir::concretelang::FHE::UnaryEint op,
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::concretelang::FHE::BinaryEintInt op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
   assert(operandMANPs.size() >= 2 && // conv2d has an optional 3rd operand
-         operandMANPs[0]->getValue().getMANP().has_value() &&
+         operandMANPs[0].getMANP().has_value() &&
          "Missing squared Minimal Arithmetic Noise Padding for encrypted "
          "operand");
-  return op.sqMANP(operandMANPs[0]->getValue().getMANP().value());
+  return op.sqMANP(operandMANPs[0].getMANP().value());
 }
 
 /// Calculates the squared Minimal Arithmetic Noise Padding of a binary FHE
@@ -313,12 +321,12 @@ getSqMANP(mlir::concretelang::FHE::BinaryEintInt op,
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::concretelang::FHE::BinaryIntEint op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
   assert(
       operandMANPs.size() == 2 &&
-      operandMANPs[1]->getValue().getMANP().has_value() &&
+      operandMANPs[1].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
-  return op.sqMANP(operandMANPs[1]->getValue().getMANP().value());
+  return op.sqMANP(operandMANPs[1].getMANP().value());
 }
 
 /// Calculates the squared Minimal Arithmetic Noise Padding of a binary FHE
@@ -326,15 +334,15 @@ getSqMANP(mlir::concretelang::FHE::BinaryIntEint op,
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::concretelang::FHE::BinaryEint op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
   assert(operandMANPs.size() == 2 &&
-         operandMANPs[0]->getValue().getMANP().has_value() &&
-         operandMANPs[1]->getValue().getMANP().has_value() &&
+         operandMANPs[0].getMANP().has_value() &&
+         operandMANPs[1].getMANP().has_value() &&
          "Missing squared Minimal Arithmetic Noise Padding for encrypted "
          "operands");
 
-  return op.sqMANP(operandMANPs[0]->getValue().getMANP().value(),
-                   operandMANPs[1]->getValue().getMANP().value());
+  return op.sqMANP(operandMANPs[0].getMANP().value(),
+                   operandMANPs[1].getMANP().value());
 }
 
 static llvm::APInt sqMANP_mul_eint_int(llvm::APInt a, mlir::Type iTy,
@@ -496,7 +504,7 @@ sqMANP_matmul(llvm::APInt encryptedOperandNorm,
 /// Calculates the squared Minimal Arithmetic Noise Padding of a matmul
 /// operation
 static llvm::APInt getSqMANP(mlir::concretelang::FHELinalg::MatMulEintEintOp op,
-                             llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+                             llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   auto rhsType =
       ((mlir::Type)op.getRhs().getType()).cast<mlir::RankedTensorType>();
@@ -507,11 +515,11 @@ static llvm::APInt getSqMANP(mlir::concretelang::FHELinalg::MatMulEintEintOp op,
 
   assert(
       operandMANPs.size() == 2 &&
-      operandMANPs[0]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  llvm::APInt lhsNorm = operandMANPs[0]->getValue().getMANP().value();
-  llvm::APInt rhsNorm = operandMANPs[1]->getValue().getMANP().value();
+  llvm::APInt lhsNorm = operandMANPs[0].getMANP().value();
+  llvm::APInt rhsNorm = operandMANPs[1].getMANP().value();
 
   int64_t N = rhsDims <= 2 ? rhsShape[0] : rhsShape[rhsDims - 2];
 
@@ -534,96 +542,95 @@ static llvm::APInt getSqMANP(mlir::concretelang::FHELinalg::MatMulEintEintOp op,
 }
 
 static llvm::APInt getSqMANP(mlir::tensor::ExtractOp op,
-                             llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+                             llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   assert(
-      operandMANPs[0]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  llvm::APInt eNorm = operandMANPs[0]->getValue().getMANP().value();
+  llvm::APInt eNorm = operandMANPs[0].getMANP().value();
 
   return eNorm;
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::tensor::FromElementsOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
-
-  auto max = std::max_element(operandMANPs.begin(), operandMANPs.end(),
-                              [](const MANPLattice *a, const MANPLattice *b) {
-                                return APIntWidthExtendULT(
-                                    a->getValue().getMANP().value(),
-                                    b->getValue().getMANP().value());
-                              });
-  return (*max)->getValue().getMANP().value();
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
+
+  auto max = std::max_element(
+      operandMANPs.begin(), operandMANPs.end(),
+      [](const MANPLatticeValue &a, const MANPLatticeValue &b) {
+        return APIntWidthExtendULT(a.getMANP().value(), b.getMANP().value());
+      });
+  return max->getMANP().value();
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::tensor::ExtractSliceOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   assert(
-      operandMANPs[0]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  return operandMANPs[0]->getValue().getMANP().value();
+  return operandMANPs[0].getMANP().value();
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::tensor::InsertSliceOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   assert(
       operandMANPs.size() >= 2 &&
-      operandMANPs[0]->getValue().getMANP().has_value() &&
-      operandMANPs[1]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
+      operandMANPs[1].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  return APIntUMax(operandMANPs[0]->getValue().getMANP().value(),
-                   operandMANPs[1]->getValue().getMANP().value());
+  return APIntUMax(operandMANPs[0].getMANP().value(),
+                   operandMANPs[1].getMANP().value());
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::tensor::InsertOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   assert(
       operandMANPs.size() >= 2 &&
-      operandMANPs[0]->getValue().getMANP().has_value() &&
-      operandMANPs[1]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
+      operandMANPs[1].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  return APIntUMax(operandMANPs[0]->getValue().getMANP().value(),
-                   operandMANPs[1]->getValue().getMANP().value());
+  return APIntUMax(operandMANPs[0].getMANP().value(),
+                   operandMANPs[1].getMANP().value());
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::tensor::CollapseShapeOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   assert(
       operandMANPs.size() >= 1 &&
-      operandMANPs[0]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  return operandMANPs[0]->getValue().getMANP().value();
+  return operandMANPs[0].getMANP().value();
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::tensor::ExpandShapeOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   assert(
       operandMANPs.size() >= 1 &&
-      operandMANPs[0]->getValue().getMANP().has_value() &&
+      operandMANPs[0].getMANP().has_value() &&
       "Missing squared Minimal Arithmetic Noise Padding for encrypted operand");
 
-  return operandMANPs[0]->getValue().getMANP().value();
+  return operandMANPs[0].getMANP().value();
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::concretelang::FHELinalg::SumOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   auto inputType = op.getOperand().getType().dyn_cast<mlir::TensorType>();
 
@@ -655,22 +662,22 @@ getSqMANP(mlir::concretelang::FHELinalg::SumOp op,
   };
 
   assert(operandMANPs.size() == 1 &&
-         operandMANPs[0]->getValue().getMANP().has_value() &&
+         operandMANPs[0].getMANP().has_value() &&
          "Missing squared Minimal Arithmetic Noise Padding for encrypted "
          "operands");
 
-  llvm::APInt operandMANP = operandMANPs[0]->getValue().getMANP().value();
+  llvm::APInt operandMANP = operandMANPs[0].getMANP().value();
 
   return APIntWidthExtendUMul(noiseMultiplier, operandMANP);
 }
 
 static std::optional<llvm::APInt>
 getSqMANP(mlir::concretelang::FHELinalg::ConcatOp op,
-          llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+          llvm::ArrayRef<MANPLatticeValue> operandMANPs) {
 
   llvm::APInt result = llvm::APInt{1, 0, false};
-  for (const MANPLattice *operandMANP : operandMANPs) {
-    llvm::APInt candidate = operandMANP->getValue().getMANP().value();
+  for (const MANPLatticeValue &operandMANP : operandMANPs) {
+    llvm::APInt candidate = operandMANP.getMANP().value();
     if (candidate.getLimitedValue() >= result.getLimitedValue()) {
       result = candidate;
     }
@@ -770,8 +777,13 @@ public:
     }
   }
 
-  std::optional<llvm::APInt>
-  norm2SqEquivFromOp(Operation *op, ArrayRef<const MANPLattice *> operands) {
+  /// Returns the squared MANP of the results of `op` from the one of its
+  /// operands, the linalg.generic operations being computed by
+  /// `emulateGeneric`.
+  static std::optional<llvm::APInt> norm2SqEquivFromOp(
+      Operation *op, ArrayRef<MANPLatticeValue> operands,
+      llvm::function_ref<std::optional<llvm::APInt>(mlir::linalg::GenericOp)>
+          emulateGeneric) {
     std::optional<llvm::APInt> norm2SqEquiv;
     if (auto cstNoiseOp =
             llvm::dyn_cast<mlir::concretelang::FHE::ConstantNoise>(op)) {
@@ -814,8 +826,8 @@ public:
     } else if (auto fromElementOp =
                    llvm::dyn_cast<mlir::concretelang::FHELinalg::FromElementOp>(
                        op)) {
-      if (operands[0]->getValue().getMANP().has_value()) {
-        norm2SqEquiv = operands[0]->getValue().getMANP().value();
+      if (operands[0].getMANP().has_value()) {
+        norm2SqEquiv = operands[0].getMANP().value();
       } else
         norm2SqEquiv = llvm::APInt{1, 1, false};
     }
@@ -908,7 +920,7 @@ public:
     // Linalg Generic
     else if (auto linalgGenericOp =
                  llvm::dyn_cast<mlir::linalg::GenericOp>(op)) {
-      norm2SqEquiv = emulateLinalgGenric(linalgGenericOp, operands);
+      norm2SqEquiv = emulateGeneric(linalgGenericOp);
     } else if (llvm::isa<mlir::arith::ConstantOp>(op)) {
       norm2SqEquiv = {};
     } else if (llvm::isa<mlir::concretelang::FHE::FHEDialect>(
@@ -918,40 +930,57 @@ public:
     } else {
       norm2SqEquiv = {};
     }
+    if (norm2SqEquiv.has_value())
+      norm2SqEquiv = APIntShrink(norm2SqEquiv.value());
     return norm2SqEquiv;
   }
 
+  /// Sets the attributes of the squared MANP `norm2SqEquiv` of `op` and its
+  /// square root.
+  static void setMANPAttributes(Operation *op, const llvm::APInt &norm2SqEquiv,
+                                bool debug) {
+    op->setAttr("SMANP",
+                mlir::IntegerAttr::get(
+                    mlir::IntegerType::get(
+                        op->getContext(), norm2SqEquiv.getBitWidth(),
+                        mlir::IntegerType::SignednessSemantics::Unsigned),
+                    norm2SqEquiv));
+
+    llvm::APInt norm2Equiv = APIntShrink(APIntCeilSqrt(norm2SqEquiv));
+
+    op->setAttr("MANP",
+                mlir::IntegerAttr::get(
+                    mlir::IntegerType::get(
+                        op->getContext(), norm2Equiv.getBitWidth(),
+                        mlir::IntegerType::SignednessSemantics::Unsigned),
+                    norm2Equiv));
+
+    if (debug) {
+      op->emitRemark("Squared Minimal Arithmetic Noise Padding: ")
+          << APIntToStringValUnsigned(norm2SqEquiv) << "\n";
+    }
+  }
+
   void visitOperation(Operation *op, ArrayRef<const MANPLattice *> operands,
                       ArrayRef<MANPLattice *> results) override {
-    MANPLattice *latticeRes = results[0];
-
-    std::optional<llvm::APInt> norm2SqEquiv = norm2SqEquivFromOp(op, operands);
+    llvm::SmallVector<MANPLatticeValue> operandMANPs;
+    for (const MANPLattice *operand : operands)
+      operandMANPs.push_back(operand->getValue());
+    std::optional<llvm::APInt> norm2SqEquiv = norm2SqEquivFromOp(
+        op, operandMANPs, [&](mlir::linalg::GenericOp genericOp) {
+          return emulateLinalgGenric(genericOp);
+        });
 
     if (norm2SqEquiv.has_value()) {
-      latticeRes->join(MANPLatticeValue{norm2SqEquiv});
-
-      op->setAttr("SMANP",
-                  mlir::IntegerAttr::get(
-                      mlir::IntegerType::get(
-                          op->getContext(), norm2SqEquiv.value().getBitWidth(),
-                          mlir::IntegerType::SignednessSemantics::Unsigned),
-                      norm2SqEquiv.value()));
-
-      llvm::APInt norm2Equiv = APIntCeilSqrt(norm2SqEquiv.value());
-
-      op->setAttr("MANP",
-                  mlir::IntegerAttr::get(
-                      mlir::IntegerType::get(
-                          op->getContext(), norm2Equiv.getBitWidth(),
-                          mlir::IntegerType::SignednessSemantics::Unsigned),
-                      norm2Equiv));
-
-      if (debug) {
-        op->emitRemark("Squared Minimal Arithmetic Noise Padding: ")
-            << APIntToStringValUnsigned(norm2SqEquiv.value()) << "\n";
-      }
+      // Operations with several results, like the packed lookup tables,
+      // produce them with the same noise.
+      for (MANPLattice *latticeRes : results)
+        latticeRes->join(MANPLatticeValue{norm2SqEquiv});
+
+      setMANPAttributes(op, norm2SqEquiv.value(), debug);
     } else {
-      latticeRes->join(MANPLatticeValue{});
+      for (MANPLattice *latticeRes : results)
+        latticeRes->join(MANPLatticeValue{});
     }
   }
 
@@ -978,11 +1007,30 @@ public:
     return index;
   }
 
+  /// Returns whether all the elements of the output of `genericOp` have the
+  /// same MANP, which happens when no input is a constant, whose elements
+  /// give different noises, and each element is written by the same number of
+  /// iterations, that is when the output is indexed by its parallel loops.
+  static bool hasUniformOutputMANP(mlir::linalg::GenericOp genericOp) {
+    for (mlir::Value input : genericOp.getInputs())
+      if (input.getDefiningOp<mlir::arith::ConstantOp>())
+        return false;
+    mlir::AffineMap outputMap = genericOp.getIndexingMapsArray().back();
+    if (!outputMap.isProjectedPermutation())
+      return false;
+    auto iteratorTypes = genericOp.getIteratorTypesArray();
+    for (size_t d = 0; d < iteratorTypes.size(); d++) {
+      bool parallel = iteratorTypes[d] == mlir::utils::IteratorType::parallel;
+      if (parallel != outputMap.isFunctionOfDim(d))
+        return false;
+    }
+    return true;
+  }
+
   // Compute the MANP value of a linalg.generic operation by emulating its
   // execution
   std::optional<llvm::APInt>
-  emulateLinalgGenric(mlir::linalg::GenericOp genericOp,
-                      llvm::ArrayRef<const MANPLattice *> operandMANPs) {
+  emulateLinalgGenric(mlir::linalg::GenericOp genericOp) {
     assert(genericOp.getOutputs().size() == 1 &&
            "MANP doesn't support linalg.genric with more than one output");
 
@@ -1003,6 +1051,15 @@ public:
     };
     auto loopRange =
         mlir::concretelang::fhe::utils::getLinalgGenericLoopRange(genericOp);
+    // When all the output elements get the same MANP, only the iterations
+    // computing the first one are emulated, instead of the whole loop nest
+    bool uniform = hasUniformOutputMANP(genericOp);
+    if (uniform) {
+      auto iteratorTypes = genericOp.getIteratorTypesArray();
+      for (size_t d = 0; d < loopRange.size(); d++)
+        if (iteratorTypes[d] == mlir::utils::IteratorType::parallel)
+          loopRange[d] = 1;
+    }
     auto iterCount = std::accumulate(loopRange.begin(), loopRange.end(), 1,
                                      std::multiplies<int64_t>());
     llvm::SmallVector<int64_t> strides;
@@ -1032,9 +1089,11 @@ public:
     auto outputArg = genericOpClone.getBlock()->getArguments().back();
     auto outputType =
         genericOpClone.getOutputs().front().getType().cast<RankedTensorType>();
-    auto outputSize = std::accumulate(outputType.getShape().begin(),
-                                      outputType.getShape().end(), 1,
-                                      std::multiplies<int64_t>());
+    auto outputSize =
+        uniform ? 1
+                : std::accumulate(outputType.getShape().begin(),
+                                  outputType.getShape().end(), 1,
+                                  std::multiplies<int64_t>());
     std::vector<llvm::APInt> outputMANPs(
         outputSize, fetchOrFallbackToAnalysis(outputArg)->getMANP().value());
 
@@ -1090,10 +1149,13 @@ public:
       // we want to replace the MANP of the block argument corresponding to the
       // output with the MANP value corresponding to the currently accessed
       // tensor element
-      size_t outputIndex = indexFromLoopRange(
-          indices,
-          genericOpClone.getIndexingMapsArray()[outputArg.getArgNumber()],
-          outputType.getShape());
+      size_t outputIndex =
+          uniform
+              ? 0
+              : indexFromLoopRange(indices,
+                                   genericOpClone.getIndexingMapsArray()
+                                       [outputArg.getArgNumber()],
+                                   outputType.getShape());
       valueToManp[outputArg] = MANPLatticeValue(outputMANPs[outputIndex]);
       genericOpClone.getBody()->walk([&](mlir::Operation *op) {
         // we update the appropriate element's MANP value using the index of the
@@ -1104,23 +1166,18 @@ public:
           return;
         }
         // compute using the op and operand manp values
-        mlir::SmallVector<const MANPLattice *> latticeOperands;
-        for (auto operand : op->getOperands()) {
-          auto lattice = new MANPLattice(operand);
-          lattice->join(*fetchOrFallbackToAnalysis(operand));
-          latticeOperands.push_back(lattice);
-        }
-        std::optional<llvm::APInt> norm2SqEquiv =
-            norm2SqEquivFromOp(op, latticeOperands);
+        mlir::SmallVector<MANPLatticeValue> operandMANPs;
+        for (auto operand : op->getOperands())
+          operandMANPs.push_back(*fetchOrFallbackToAnalysis(operand));
+        std::optional<llvm::APInt> norm2SqEquiv = norm2SqEquivFromOp(
+            op, operandMANPs, [&](mlir::linalg::GenericOp nestedOp) {
+              return emulateLinalgGenric(nestedOp);
+            });
         // update the MANP of the result value
         if (op->getNumResults() > 0) {
           valueToManp[op->getResult(0).cast<mlir::Value>()] =
               MANPLatticeValue(norm2SqEquiv);
         }
-        // free space of lattice elements
-        for (auto toFree : latticeOperands) {
-          delete toFree;
-        }
       });
 
       // replace back the uses of block arguments which were replaced by
@@ -1184,7 +1241,7 @@ llvm::APInt RoundEintOp::sqMANP(llvm::APInt a) {
       this->getResult().getType().cast<FHE::FheIntegerInterface>().getWidth();
   uint64_t clearedBits = inputWidth - outputWidth;
 
-  return a + clearedBits;
+  return APIntWidthExtendUAdd(a, llvm::APInt{64, clearedBits, false});
 }
 } // namespace FHE
 
@@ -1258,12 +1315,20 @@ llvm::APInt Maxpool2dOp::sqMANP(llvm::APInt a) {
   // max is calculated with a TLU so MANP is {1, 1, false}
   // y on the other hand comes from the input or from the previous result
 
-  // in the current implementation, it's the input
-  // so the resulting MANP is `{1, 1, false} + MANP input`
+  // the maximums are computed with a balanced tree, so a value of level `l`
+  // has a MANP of at most `l + MANP input`, the TLUs of the last level
+  // taking the difference of two values of level `depth - 1`
+
+  const int64_t depth = this->getMaxTreeDepth();
+  if (depth == 0)
+    return a;
 
+  const llvm::APInt levels = {64, (uint64_t)depth - 1, false};
+  const llvm::APInt forOperands = APIntWidthExtendUAdd(levels, a);
   const llvm::APInt tlu = {1, 1, false};
-  const llvm::APInt forResult = APIntWidthExtendUAdd(tlu, a);
-  const llvm::APInt forIntermediate = APIntWidthExtendUAdd(forResult, a);
+  const llvm::APInt forResult = APIntWidthExtendUAdd(tlu, forOperands);
+  const llvm::APInt forIntermediate =
+      APIntWidthExtendUAdd(forOperands, forOperands);
 
   return APIntUMax(forIntermediate, forResult);
 }
@@ -1285,7 +1350,7 @@ llvm::APInt RoundOp::sqMANP(llvm::APInt a) {
 
   const uint64_t clearedBits = inputWidth - outputWidth;
 
-  return a + clearedBits;
+  return APIntWidthExtendUAdd(a, llvm::APInt{64, clearedBits, false});
 }
 
 } // namespace FHELinalg
@@ -1296,6 +1361,9 @@ struct MANPPass : public MANPBase<MANPPass> {
   void runOnOperation() override {
     mlir::func::FuncOp func = getOperation();
 
+    if (isStraightLine(func))
+      return runOnStraightLine(func);
+
     mlir::DataFlowSolver solver;
     solver.load<mlir::dataflow::DeadCodeAnalysis>();
     solver.load<MANPAnalysis>(debug);
@@ -1308,6 +1376,52 @@ struct MANPPass : public MANPBase<MANPPass> {
 
 protected:
   bool debug;
+
+  /// Returns whether `func` is a single block without nested regions, where
+  /// the operations are reached in program order after their operands.
+  static bool isStraightLine(mlir::func::FuncOp func) {
+    if (!func.getBody().hasOneBlock())
+      return false;
+    for (mlir::Operation &op : func.getBody().front())
+      if (op.getNumRegions() != 0)
+        return false;
+    return true;
+  }
+
+  /// Computes the MANP of a straight line function in a single walk, as the
+  /// data flow solver would. The fully unrolled circuits are made of
+  /// millions of operations, for which the solver keeps a lattice, a set of
+  /// dependents and a work item per value.
+  void runOnStraightLine(mlir::func::FuncOp func) {
+    mlir::Block &body = func.getBody().front();
+    mlir::DenseMap<mlir::Value, llvm::APInt> manps;
+    manps.reserve(body.getNumArguments() + body.getOperations().size());
+    for (mlir::BlockArgument arg : body.getArguments())
+      if (isEncryptedFunctionParameter(arg))
+        manps.try_emplace(arg, llvm::APInt(1, 1));
+
+    llvm::SmallVector<MANPLatticeValue> operandMANPs;
+    for (mlir::Operation &op : body) {
+      operandMANPs.clear();
+      for (mlir::Value operand : op.getOperands()) {
+        auto manp = manps.find(operand);
+        operandMANPs.push_back(manp != manps.end()
+                                   ? MANPLatticeValue(manp->second)
+                                   : MANPLatticeValue());
+      }
+      std::optional<llvm::APInt> norm2SqEquiv =
+          MANPAnalysis::norm2SqEquivFromOp(
+              &op, operandMANPs, [](mlir::linalg::GenericOp) {
+                llvm_unreachable("linalg.generic has a region");
+                return std::optional<llvm::APInt>{};
+              });
+      if (!norm2SqEquiv.has_value())
+        continue;
+      for (mlir::Value result : op.getResults())
+        manps.try_emplace(result, norm2SqEquiv.value());
+      MANPAnalysis::setMANPAttributes(&op, norm2SqEquiv.value(), debug);
+    }
+  }
 };
 } // end anonymous namespace
 
@@ -1379,6 +1493,14 @@ protected:
         this->updateMax(manp.getZExtValue(), eTy.getWidth());
       }
     }
+
+    // Packing `k` lookup tables in a single bootstrap requires the noise of
+    // the operand to fit in `log2(k)` more bits.
+    if (auto manyLut = llvm::dyn_cast<
+            mlir::concretelang::FHE::ApplyManyLookupTablesEintOp>(op)) {
+      unsigned int width = fhe::utils::getEintPrecision(manyLut.getA());
+      this->updateMax(1, width + llvm::Log2_64(manyLut.getNumResults()));
+    }
   }
 
   std::function<void(const uint64_t, unsigned)> updateMax;
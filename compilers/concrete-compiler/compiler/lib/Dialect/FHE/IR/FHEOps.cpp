@@ -247,6 +247,41 @@ mlir::LogicalResult GenGateOp::verify() {
   return mlir::success();
 }
 
+::mlir::LogicalResult ApplyManyLookupTablesEintOp::verify() {
+  auto ct = this->getA().getType().cast<FheIntegerInterface>();
+  auto luts = this->getLuts().getType().cast<TensorType>();
+
+  // Check the shape of luts argument
+  auto width = ct.getWidth();
+  int64_t count = this->getResults().size();
+  int64_t expectedSize = 1 << width;
+  if (count == 0 || (count & (count - 1)) != 0) {
+    this->emitOpError() << "should have a power of two number of results, "
+                           "got "
+                        << count;
+    return mlir::failure();
+  }
+  mlir::SmallVector<int64_t, 2> expectedShape{count, expectedSize};
+  if (!luts.hasStaticShape(expectedShape)) {
+    this->emitOpError() << "should have as operand `luts` a tensor of shape <"
+                        << count << "x" << expectedSize << ">";
+    return mlir::failure();
+  }
+  auto elmType = luts.getElementType();
+  if (!elmType.isSignlessInteger() || elmType.getIntOrFloatBitWidth() > 64) {
+    this->emitOpError() << "luts must have signless integer elements, with "
+                           "precision not bigger than 64.";
+    return mlir::failure();
+  }
+  for (auto type : this->getResultTypes()) {
+    if (type != this->getResult(0).getType()) {
+      this->emitOpError() << "should have results of the same type";
+      return mlir::failure();
+    }
+  }
+  return mlir::success();
+}
+
 mlir::LogicalResult RoundEintOp::verify() {
   auto input = this->getInput().getType().cast<FheIntegerInterface>();
   auto output = this->getResult().getType().cast<FheIntegerInterface>();
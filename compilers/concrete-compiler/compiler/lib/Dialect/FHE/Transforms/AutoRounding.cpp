@@ -0,0 +1,181 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Matchers.h>
+#include <mlir/IR/TypeUtilities.h>
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHE/Transforms/AutoRounding/AutoRounding.h>
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgOps.h>
+
+namespace FHE = mlir::concretelang::FHE;
+namespace FHELinalg = mlir::concretelang::FHELinalg;
+
+namespace {
+
+/// Returns the largest distance between an entry of `table` and the middle of
+/// its group of 2^`droppedBits` entries.
+uint64_t roundingError(llvm::ArrayRef<int64_t> table, unsigned droppedBits) {
+  size_t groupSize = size_t(1) << droppedBits;
+  uint64_t error = 0;
+  for (size_t begin = 0; begin < table.size(); begin += groupSize) {
+    auto group = table.slice(begin, groupSize);
+    auto [min, max] = std::minmax_element(group.begin(), group.end());
+    // The middle is rounded down, so the largest entry is the farthest
+    error = std::max(error, ((uint64_t)*max - (uint64_t)*min + 1) / 2);
+  }
+  return error;
+}
+
+/// Returns the table on the rounded input, each entry being the middle of the
+/// group of 2^`droppedBits` entries it replaces.
+llvm::SmallVector<int64_t> roundTable(llvm::ArrayRef<int64_t> table,
+                                      unsigned droppedBits) {
+  size_t groupSize = size_t(1) << droppedBits;
+  llvm::SmallVector<int64_t> rounded;
+  for (size_t begin = 0; begin < table.size(); begin += groupSize) {
+    auto group = table.slice(begin, groupSize);
+    auto [min, max] = std::minmax_element(group.begin(), group.end());
+    rounded.push_back(*min + (int64_t)(((uint64_t)*max - (uint64_t)*min) / 2));
+  }
+  return rounded;
+}
+
+/// For documentation see AutoRounding.td
+struct FHEAutoRoundingPass : public FHEAutoRoundingBase<FHEAutoRoundingPass> {
+  FHEAutoRoundingPass(uint64_t maxError,
+                      std::function<double(unsigned)> tluCost)
+      : tluCost(tluCost) {
+    this->maxError = maxError;
+  }
+
+  void runOnOperation() final {
+    llvm::SmallVector<mlir::Operation *> tlus;
+    getOperation()->walk([&](mlir::Operation *op) {
+      if (llvm::isa<FHE::ApplyLookupTableEintOp,
+                    FHELinalg::ApplyLookupTableEintOp>(op))
+        tlus.push_back(op);
+    });
+    for (mlir::Operation *tlu : tlus)
+      roundInput(tlu);
+  }
+
+private:
+  std::function<double(unsigned)> tluCost;
+
+  /// The cost of a table lookup on `precision` bits, an unfeasible one being
+  /// the most expensive.
+  double cost(unsigned precision) {
+    double cost = tluCost ? tluCost(precision) : std::exp2(precision);
+    return std::isfinite(cost) ? cost : std::numeric_limits<double>::max();
+  }
+
+  /// Returns the number of bits to drop from the input of a table lookup on
+  /// `width` bits, 0 if it is not worth it.
+  unsigned droppedBits(llvm::ArrayRef<int64_t> table, unsigned width) {
+    unsigned best = 0;
+    double bestCost = cost(width);
+    for (unsigned k = 1; k < width; k++) {
+      // The error only grows with the number of dropped bits
+      if (roundingError(table, k) > maxError)
+        break;
+      double roundedCost = cost(width - k) + k * cost(1);
+      if (roundedCost < bestCost) {
+        best = k;
+        bestCost = roundedCost;
+      }
+    }
+    return best;
+  }
+
+  /// Replaces a table lookup by the lookup of a smaller table on its rounded
+  /// input, if it is cheaper and accurate enough.
+  void roundInput(mlir::Operation *tlu) {
+    mlir::Value input = tlu->getOperand(0);
+    mlir::DenseIntElementsAttr tableAttr;
+    if (!mlir::matchPattern(tlu->getOperand(1), mlir::m_Constant(&tableAttr)))
+      return;
+    // FHELinalg.round only supports static shapes
+    auto tensorTy = input.getType().dyn_cast<mlir::RankedTensorType>();
+    if (tensorTy && !tensorTy.hasStaticShape())
+      return;
+    auto inputTy = mlir::getElementTypeOrSelf(input.getType())
+                       .cast<FHE::FheIntegerInterface>();
+    unsigned width = inputTy.getWidth();
+    if (inputTy.isSigned() || width < 2 ||
+        tableAttr.getNumElements() != (int64_t(1) << width))
+      return;
+
+    mlir::Type resultTy = tlu->getResult(0).getType();
+    bool signedOutput = mlir::getElementTypeOrSelf(resultTy)
+                            .cast<FHE::FheIntegerInterface>()
+                            .isSigned();
+    llvm::SmallVector<int64_t> table;
+    for (const mlir::APInt &value : tableAttr.getValues<mlir::APInt>())
+      table.push_back(signedOutput ? value.getSExtValue()
+                                   : (int64_t)value.getZExtValue());
+
+    unsigned k = droppedBits(table, width);
+    if (k == 0)
+      return;
+
+    mlir::OpBuilder builder(tlu);
+    mlir::Location loc = tlu->getLoc();
+    // Rounding x - 2^(k-1) gives the truncation of x, which never overflows
+    mlir::Type carryTy = builder.getIntegerType(width + 1);
+    mlir::APInt carry = mlir::APInt::getOneBitSet(width + 1, k - 1);
+    mlir::Type roundedTy =
+        FHE::EncryptedUnsignedIntegerType::get(&getContext(), width - k);
+    mlir::Value lut = builder.create<mlir::arith::ConstantOp>(
+        loc, builder.getI64TensorAttr(roundTable(table, k)));
+
+    mlir::Operation *rounded;
+    if (tensorTy) {
+      auto carryTensorTy =
+          mlir::RankedTensorType::get(tensorTy.getShape(), carryTy);
+      auto cst = builder.create<mlir::arith::ConstantOp>(
+          loc, mlir::DenseElementsAttr::get(carryTensorTy, carry));
+      auto sub = builder.create<FHELinalg::SubEintIntOp>(loc, tensorTy, input,
+                                                         cst);
+      auto round = builder.create<FHELinalg::RoundOp>(
+          loc, mlir::RankedTensorType::get(tensorTy.getShape(), roundedTy),
+          sub);
+      rounded = builder.create<FHELinalg::ApplyLookupTableEintOp>(
+          loc, resultTy, round, lut);
+    } else {
+      auto cst = builder.create<mlir::arith::ConstantOp>(
+          loc, builder.getIntegerAttr(carryTy, carry));
+      auto sub = builder.create<FHE::SubEintIntOp>(loc, input.getType(), input,
+                                                   cst);
+      auto round = builder.create<FHE::RoundEintOp>(loc, roundedTy, sub);
+      rounded = builder.create<FHE::ApplyLookupTableEintOp>(loc, resultTy,
+                                                            round, lut);
+    }
+    tlu->replaceAllUsesWith(rounded);
+    tlu->erase();
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace concretelang {
+
+std::unique_ptr<mlir::OperationPass<>>
+createFHEAutoRoundingPass(uint64_t maxError,
+                          std::function<double(unsigned)> tluCost) {
+  return std::make_unique<FHEAutoRoundingPass>(maxError, tluCost);
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -45,6 +45,28 @@ mlir::Value getTruthTableCarryExtract(mlir::PatternRewriter &rewriter,
 
 namespace {
 
+/// Construct a table lookup mapping each value of a chunk with `fn`
+mlir::Value getTruthTable(mlir::PatternRewriter &rewriter, mlir::Location loc,
+                          unsigned int chunkSize,
+                          llvm::function_ref<uint64_t(uint64_t)> fn) {
+  auto tableSize = 1 << chunkSize;
+  std::vector<llvm::APInt> values;
+  values.reserve(tableSize);
+  for (auto i = 0; i < tableSize; i++)
+    values.push_back(llvm::APInt(64, fn(i), false));
+  auto truthTableAttr = mlir::DenseElementsAttr::get(
+      mlir::RankedTensorType::get({tableSize}, rewriter.getIntegerType(64)),
+      values);
+  return rewriter.create<mlir::arith::ConstantOp>(loc, truthTableAttr)
+      .getResult();
+}
+
+/// The carry status of a group of chunks: whether it outputs a carry, passes
+/// its incoming carry through, or outputs no carry in any case. The status of
+/// two adjacent groups is looked up from `2 * high + low`, the only collisions
+/// of this packing being between pairs of the same status.
+enum CarryStatus : uint64_t { KILL = 0, PROPAGATE = 1, GENERATE = 2 };
+
 namespace typing {
 
 /// Converts `FHE::ChunkedEncryptedInteger` into a tensor of
@@ -86,10 +108,12 @@ class AddEintPattern
     : public mlir::OpConversionPattern<mlir::concretelang::FHE::AddEintOp> {
 public:
   AddEintPattern(mlir::TypeConverter &converter, mlir::MLIRContext *context,
-                 unsigned int chunkSize, unsigned int chunkWidth)
+                 unsigned int chunkSize, unsigned int chunkWidth,
+                 unsigned int carryLookaheadMinChunks)
       : mlir::OpConversionPattern<mlir::concretelang::FHE::AddEintOp>(
             converter, context, ::mlir::concretelang::DEFAULT_PATTERN_BENEFIT),
-        chunkSize(chunkSize), chunkWidth(chunkWidth) {}
+        chunkSize(chunkSize), chunkWidth(chunkWidth),
+        carryLookaheadMinChunks(carryLookaheadMinChunks) {}
 
   mlir::LogicalResult
   matchAndRewrite(FHE::AddEintOp op, FHE::AddEintOp::Adaptor adaptor,
@@ -106,6 +130,14 @@ public:
     assert(eintChunkWidth == chunkSize && "wrong tensor elements width");
     auto numberOfChunks = shape[0];
 
+    // The packed status of two groups needs 3 bits
+    if (carryLookaheadMinChunks != 0 && chunkSize >= 3 &&
+        numberOfChunks >= carryLookaheadMinChunks) {
+      rewriter.replaceOp(op, addWithCarryLookahead(op, adaptor, rewriter,
+                                                   numberOfChunks));
+      return mlir::success();
+    }
+
     mlir::Value carry =
         rewriter
             .create<FHE::ZeroEintOp>(op.getLoc(),
@@ -166,15 +198,101 @@ public:
   }
 
 private:
-  unsigned int chunkSize, chunkWidth;
+  /// Adds the chunks with their carries computed by a Sklansky parallel
+  /// prefix network over the carry status of the chunks. The carries are known
+  /// after ceil(log2(n)) + 2 table lookups in depth, instead of n when rippling
+  /// them, at the price of about n * log2(n) / 2 + 3 * n table lookups instead
+  /// of n.
+  mlir::Value
+  addWithCarryLookahead(FHE::AddEintOp op, FHE::AddEintOp::Adaptor adaptor,
+                        mlir::ConversionPatternRewriter &rewriter,
+                        int64_t numberOfChunks) const {
+    auto loc = op.getLoc();
+    auto chunkType = FHE::EncryptedUnsignedIntegerType::get(
+        rewriter.getContext(), chunkSize);
+    auto lookup = [&](mlir::Value input,
+                      llvm::function_ref<uint64_t(uint64_t)> fn) {
+      return rewriter
+          .create<FHE::ApplyLookupTableEintOp>(
+              loc, chunkType, input,
+              getTruthTable(rewriter, loc, chunkSize, fn))
+          .getResult();
+    };
+    uint64_t base = 1 << chunkWidth;
+
+    // The sums of the chunks without carry, and their status
+    std::vector<mlir::Value> sums, prefixes;
+    for (int64_t i = 0; i < numberOfChunks; i++) {
+      mlir::Value index =
+          rewriter.create<mlir::arith::ConstantIndexOp>(loc, i).getResult();
+      mlir::Value leftEint =
+          rewriter.create<mlir::tensor::ExtractOp>(loc, adaptor.getA(), index);
+      mlir::Value rightEint =
+          rewriter.create<mlir::tensor::ExtractOp>(loc, adaptor.getB(), index);
+      sums.push_back(rewriter.create<FHE::AddEintOp>(loc, leftEint, rightEint)
+                         .getResult());
+      prefixes.push_back(lookup(sums.back(), [base](uint64_t sum) {
+        if (sum >= base)
+          return GENERATE;
+        return sum == base - 1 ? PROPAGATE : KILL;
+      }));
+    }
+
+    // At each level, the chunks of the odd blocks of `span` chunks combine
+    // their prefix with the one of the last chunk of the previous block, so
+    // that the prefix of a chunk finally covers all the chunks up to it.
+    mlir::Value twoCst =
+        rewriter.create<mlir::arith::ConstantIntOp>(loc, 2, chunkSize + 1)
+            .getResult();
+    for (int64_t span = 1; span < numberOfChunks; span *= 2) {
+      for (int64_t i = 0; i < numberOfChunks; i++) {
+        if ((i / span) % 2 == 0)
+          continue;
+        mlir::Value low = prefixes[i / span * span - 1];
+        mlir::Value high =
+            rewriter.create<FHE::MulEintIntOp>(loc, prefixes[i], twoCst)
+                .getResult();
+        mlir::Value packed =
+            rewriter.create<FHE::AddEintOp>(loc, high, low).getResult();
+        prefixes[i] = lookup(packed, [](uint64_t packed) {
+          if (packed >= 2 * PROPAGATE + GENERATE)
+            return GENERATE;
+          return packed == 2 * PROPAGATE + PROPAGATE ? PROPAGATE : KILL;
+        });
+      }
+    }
+
+    // No carry enters the first chunk, so the prefixes never propagate
+    std::vector<mlir::Value> results;
+    for (int64_t i = 0; i < numberOfChunks; i++) {
+      mlir::Value resultWithCarry = sums[i];
+      if (i > 0) {
+        mlir::Value carry = lookup(prefixes[i - 1], [](uint64_t status) {
+          return (uint64_t)(status == GENERATE);
+        });
+        resultWithCarry =
+            rewriter.create<FHE::AddEintOp>(loc, sums[i], carry).getResult();
+      }
+      results.push_back(lookup(
+          resultWithCarry, [base](uint64_t value) { return value % base; }));
+    }
+    return rewriter
+        .create<mlir::tensor::FromElementsOp>(loc, adaptor.getA().getType(),
+                                              results)
+        .getResult();
+  }
+
+  unsigned int chunkSize, chunkWidth, carryLookaheadMinChunks;
 };
 
 /// Perfoms the transformation of big integer operations
 class FHEBigIntTransformPass
     : public FHEBigIntTransformBase<FHEBigIntTransformPass> {
 public:
-  FHEBigIntTransformPass(unsigned int chunkSize, unsigned int chunkWidth)
-      : chunkSize(chunkSize), chunkWidth(chunkWidth){};
+  FHEBigIntTransformPass(unsigned int chunkSize, unsigned int chunkWidth,
+                         unsigned int carryLookaheadMinChunks)
+      : chunkSize(chunkSize), chunkWidth(chunkWidth),
+        carryLookaheadMinChunks(carryLookaheadMinChunks){};
 
   void runOnOperation() override {
     mlir::Operation *op = getOperation();
@@ -188,7 +306,7 @@ public:
                       FHE::ZeroEintOp, FHE::ZeroTensorOp, FHE::AddEintOp,
                       FHE::MulEintIntOp, FHE::SubEintOp,
                       FHE::ApplyLookupTableEintOp, mlir::tensor::ExtractOp,
-                      mlir::tensor::InsertOp>();
+                      mlir::tensor::InsertOp, mlir::tensor::FromElementsOp>();
     concretelang::addDynamicallyLegalTypeOp<FHE::AddEintOp>(target, converter);
     // Func ops are only legal with converted types
     target.addDynamicallyLegalOp<mlir::func::FuncOp>(
@@ -204,7 +322,7 @@ public:
                                                                   converter);
 
     patterns.add<AddEintPattern>(converter, &getContext(), chunkSize,
-                                 chunkWidth);
+                                 chunkWidth, carryLookaheadMinChunks);
 
     if (mlir::applyPartialConversion(op, target, std::move(patterns))
             .failed()) {
@@ -213,16 +331,18 @@ public:
   }
 
 private:
-  unsigned int chunkSize, chunkWidth;
+  unsigned int chunkSize, chunkWidth, carryLookaheadMinChunks;
 };
 
 } // end anonymous namespace
 
 std::unique_ptr<mlir::OperationPass<>>
-createFHEBigIntTransformPass(unsigned int chunkSize, unsigned int chunkWidth) {
+createFHEBigIntTransformPass(unsigned int chunkSize, unsigned int chunkWidth,
+                             unsigned int carryLookaheadMinChunks) {
   assert(chunkSize >= chunkWidth + 1 &&
          "chunkSize must be greater than chunkWidth");
-  return std::make_unique<FHEBigIntTransformPass>(chunkSize, chunkWidth);
+  return std::make_unique<FHEBigIntTransformPass>(chunkSize, chunkWidth,
+                                                  carryLookaheadMinChunks);
 }
 
 } // namespace concretelang
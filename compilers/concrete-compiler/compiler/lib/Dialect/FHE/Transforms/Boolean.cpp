@@ -5,6 +5,7 @@
 
 #include "concretelang/Dialect/Tracing/IR/TracingOps.h"
 #include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/IR/Matchers.h>
 #include <mlir/IR/PatternMatch.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 
@@ -18,8 +19,27 @@ namespace concretelang {
 
 namespace {
 
+/// Returns the truth table of `gate` with the index `left + right`, if its
+/// truth table is constant and does not depend on the order of the inputs.
+static std::optional<llvm::SmallVector<uint64_t, 4>>
+symmetricTruthTable(mlir::concretelang::FHE::GenGateOp gate) {
+  mlir::DenseIntElementsAttr truthTable;
+  if (!mlir::matchPattern(gate.getTruthTable(), mlir::m_Constant(&truthTable)))
+    return std::nullopt;
+  llvm::SmallVector<uint64_t, 4> values;
+  for (const llvm::APInt &value : truthTable.getValues<llvm::APInt>())
+    values.push_back(value.getZExtValue());
+  if (values[1] != values[2])
+    return std::nullopt;
+  // The last entry is unreachable as the index is at most 2
+  return llvm::SmallVector<uint64_t, 4>({values[0], values[1], values[3],
+                                         values[3]});
+}
+
 /// Rewrite an `FHE.gen_gate` operation as an LUT operation by composing a
-/// single index from the two boolean inputs.
+/// single index from the two boolean inputs. Symmetric gates (e.g. and, or,
+/// xor) only need the sum of the inputs, which spares a multiplication and
+/// lowers the noise going into the bootstrap.
 class GenGatePattern
     : public mlir::OpRewritePattern<mlir::concretelang::FHE::GenGateOp> {
 public:
@@ -40,6 +60,24 @@ public:
                      .create<mlir::concretelang::FHE::FromBoolOp>(
                          op.getLoc(), eint2, op.getRight())
                      .getResult();
+    if (auto symmetric = symmetricTruthTable(op)) {
+      auto sum = rewriter
+                     .create<mlir::concretelang::FHE::AddEintOp>(op.getLoc(),
+                                                                 left, right)
+                     .getResult();
+      auto truthTable = rewriter.create<mlir::arith::ConstantOp>(
+          op.getLoc(), rewriter.getI64TensorAttr(llvm::SmallVector<int64_t, 4>(
+                           symmetric->begin(), symmetric->end())));
+      auto lut_result =
+          rewriter.create<mlir::concretelang::FHE::ApplyLookupTableEintOp>(
+              op.getLoc(), eint2, sum, truthTable);
+      rewriter.replaceOpWithNewOp<mlir::concretelang::FHE::ToBoolOp>(
+          op,
+          mlir::concretelang::FHE::EncryptedBooleanType::get(
+              rewriter.getContext()),
+          lut_result);
+      return mlir::success();
+    }
     auto cst_two =
         rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), 2, 3)
             .getResult();
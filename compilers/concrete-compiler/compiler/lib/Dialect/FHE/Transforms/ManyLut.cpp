@@ -0,0 +1,115 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/Support/MathExtras.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Matchers.h>
+#include <tuple>
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHE/Transforms/ManyLut/ManyLut.h>
+
+namespace FHE = mlir::concretelang::FHE;
+
+namespace {
+
+/// For documentation see ManyLut.td
+struct FHEManyLutPass : public FHEManyLutBase<FHEManyLutPass> {
+  void runOnOperation() final {
+    llvm::SmallVector<mlir::Block *> blocks;
+    getOperation()->walk([&](mlir::Block *block) { blocks.push_back(block); });
+    for (mlir::Block *block : blocks)
+      packBlock(*block);
+  }
+
+private:
+  /// Table lookups are packed if they apply tables of the same type to the
+  /// same ciphertext and return the same type.
+  typedef std::tuple<mlir::Value, mlir::Type, mlir::Type> Key;
+
+  void packBlock(mlir::Block &block) {
+    llvm::MapVector<Key, llvm::SmallVector<FHE::ApplyLookupTableEintOp>>
+        groups;
+    for (auto tlu : block.getOps<FHE::ApplyLookupTableEintOp>()) {
+      if (!mlir::matchPattern(tlu.getLut(), mlir::m_Constant()))
+        continue;
+      Key key(tlu.getA(), tlu.getLut().getType(), tlu.getType());
+      groups[key].push_back(tlu);
+    }
+
+    for (auto &entry : groups) {
+      auto &tlus = entry.second;
+      unsigned width = tlus.front()
+                           .getA()
+                           .getType()
+                           .cast<FHE::FheIntegerInterface>()
+                           .getWidth();
+      if (width >= maxPrecision)
+        continue;
+      // The largest power of two of tables fitting in the precision
+      size_t maxCount = std::min<size_t>(llvm::PowerOf2Floor(maxLuts),
+                                         size_t(1) << (maxPrecision - width));
+      if (maxCount < 2)
+        continue;
+      for (size_t begin = 0; begin < tlus.size(); begin += maxCount) {
+        size_t end = std::min(tlus.size(), begin + maxCount);
+        pack(llvm::ArrayRef<FHE::ApplyLookupTableEintOp>(tlus).slice(
+            begin, end - begin));
+      }
+    }
+  }
+
+  /// Replaces `tlus`, which are in block order, by a single
+  /// `FHE.apply_many_lookup_tables` at the position of the first one.
+  void pack(llvm::ArrayRef<FHE::ApplyLookupTableEintOp> tlus) {
+    if (tlus.size() < 2)
+      return;
+    size_t count = llvm::PowerOf2Ceil(tlus.size());
+
+    llvm::SmallVector<mlir::APInt> values;
+    for (size_t i = 0; i < count; i++) {
+      // Groups are padded with their last table
+      auto tlu = tlus[std::min(i, tlus.size() - 1)];
+      mlir::DenseIntElementsAttr table;
+      mlir::matchPattern(tlu.getLut(), mlir::m_Constant(&table));
+      for (auto v : table.getValues<mlir::APInt>())
+        values.push_back(v);
+    }
+
+    auto first = tlus.front();
+    auto lutType = first.getLut().getType().cast<mlir::RankedTensorType>();
+    auto lutsType = mlir::RankedTensorType::get(
+        {(int64_t)count, lutType.getDimSize(0)}, lutType.getElementType());
+
+    mlir::OpBuilder builder(first);
+    auto luts = builder.create<mlir::arith::ConstantOp>(
+        first.getLoc(), mlir::DenseIntElementsAttr::get(lutsType, values));
+    llvm::SmallVector<mlir::Type> resultTypes(count, first.getType());
+    auto packed = builder.create<FHE::ApplyManyLookupTablesEintOp>(
+        first.getLoc(), resultTypes, first.getA(), luts);
+
+    for (auto tlu : llvm::enumerate(tlus)) {
+      tlu.value().getResult().replaceAllUsesWith(
+          packed.getResult(tlu.index()));
+      tlu.value()->erase();
+    }
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace concretelang {
+
+std::unique_ptr<mlir::OperationPass<>> createFHEManyLutPass() {
+  return std::make_unique<FHEManyLutPass>();
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -0,0 +1,152 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <cmath>
+#include <limits>
+
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Matchers.h>
+#include <mlir/IR/TypeUtilities.h>
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHE/Transforms/RoundToTLU/RoundToTLU.h>
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgOps.h>
+
+namespace FHE = mlir::concretelang::FHE;
+namespace FHELinalg = mlir::concretelang::FHELinalg;
+
+namespace {
+
+/// Returns the table rounding the integers of `width` bits to `width -
+/// droppedBits` bits. The entry of a signed integer x is the one of its two's
+/// complement, as for the table lookups.
+llvm::SmallVector<int64_t> roundingTable(unsigned width, unsigned droppedBits,
+                                         bool isSigned) {
+  int64_t size = int64_t(1) << width;
+  int64_t roundedSize = int64_t(1) << (width - droppedBits);
+  llvm::SmallVector<int64_t> table;
+  for (int64_t i = 0; i < size; i++) {
+    int64_t x = isSigned && i >= size / 2 ? i - size : i;
+    int64_t rounded = (x + (int64_t(1) << (droppedBits - 1))) >> droppedBits;
+    // Wraps around, the signed ones staying in [-roundedSize/2, roundedSize/2)
+    rounded = rounded & (roundedSize - 1);
+    if (isSigned && rounded >= roundedSize / 2)
+      rounded -= roundedSize;
+    table.push_back(rounded);
+  }
+  return table;
+}
+
+/// For documentation see RoundToTLU.td
+struct FHERoundToTLUPass : public FHERoundToTLUBase<FHERoundToTLUPass> {
+  FHERoundToTLUPass(std::function<double(unsigned)> tluCost)
+      : tluCost(tluCost) {}
+
+  void runOnOperation() final {
+    llvm::SmallVector<mlir::Operation *> rounds;
+    getOperation()->walk([&](mlir::Operation *op) {
+      if (llvm::isa<FHE::RoundEintOp, FHELinalg::RoundOp>(op))
+        rounds.push_back(op);
+    });
+    for (mlir::Operation *round : rounds)
+      replaceRound(round);
+  }
+
+private:
+  std::function<double(unsigned)> tluCost;
+
+  /// The cost of a table lookup on `precision` bits, an unfeasible one being
+  /// the most expensive.
+  double cost(unsigned precision) {
+    double cost = tluCost ? tluCost(precision) : std::exp2(precision);
+    return std::isfinite(cost) ? cost : std::numeric_limits<double>::max();
+  }
+
+  /// Returns the table lookup of constant table using the rounded value, if
+  /// it is its only use, nullptr otherwise. Its table is put in `table`.
+  mlir::Operation *getComposableTableLookup(mlir::Operation *round,
+                                            llvm::SmallVector<int64_t> &table) {
+    if (!round->hasOneUse())
+      return nullptr;
+    mlir::Operation *user = *round->getUsers().begin();
+    mlir::DenseIntElementsAttr tableAttr;
+    if (!llvm::isa<FHE::ApplyLookupTableEintOp,
+                   FHELinalg::ApplyLookupTableEintOp>(user) ||
+        user->getOperand(0) != round->getResult(0) ||
+        !mlir::matchPattern(user->getOperand(1), mlir::m_Constant(&tableAttr)))
+      return nullptr;
+    bool signedOutput = mlir::getElementTypeOrSelf(user->getResult(0))
+                            .cast<FHE::FheIntegerInterface>()
+                            .isSigned();
+    for (const mlir::APInt &value : tableAttr.getValues<mlir::APInt>())
+      table.push_back(signedOutput ? value.getSExtValue()
+                                   : (int64_t)value.getZExtValue());
+    return user;
+  }
+
+  /// Replaces a rounding by a table lookup on its input, composed with the
+  /// table lookup using it if possible, if it is cheaper.
+  void replaceRound(mlir::Operation *round) {
+    mlir::Value input = round->getOperand(0);
+    auto inputTy = mlir::getElementTypeOrSelf(input.getType())
+                       .cast<FHE::FheIntegerInterface>();
+    unsigned width = inputTy.getWidth();
+    unsigned roundedWidth = mlir::getElementTypeOrSelf(round->getResult(0))
+                                .cast<FHE::FheIntegerInterface>()
+                                .getWidth();
+    unsigned droppedBits = width - roundedWidth;
+
+    llvm::SmallVector<int64_t> usingTable;
+    mlir::Operation *tlu = getComposableTableLookup(round, usingTable);
+    double roundingCost = droppedBits * cost(1);
+    if (tlu != nullptr)
+      roundingCost += cost(roundedWidth);
+    if (cost(width) >= roundingCost)
+      return;
+
+    llvm::SmallVector<int64_t> table =
+        roundingTable(width, droppedBits, inputTy.isSigned());
+    mlir::Operation *replaced = round;
+    if (tlu != nullptr) {
+      int64_t mask = (int64_t(1) << roundedWidth) - 1;
+      for (int64_t &entry : table)
+        entry = usingTable[entry & mask];
+      replaced = tlu;
+    }
+
+    mlir::OpBuilder builder(replaced);
+    mlir::Location loc = replaced->getLoc();
+    mlir::Type resultTy = replaced->getResult(0).getType();
+    mlir::Value lut = builder.create<mlir::arith::ConstantOp>(
+        loc, builder.getI64TensorAttr(table));
+    mlir::Value lookup;
+    if (input.getType().isa<mlir::RankedTensorType>())
+      lookup = builder.create<FHELinalg::ApplyLookupTableEintOp>(loc, resultTy,
+                                                                 input, lut);
+    else
+      lookup = builder.create<FHE::ApplyLookupTableEintOp>(loc, resultTy,
+                                                           input, lut);
+    replaced->replaceAllUsesWith(mlir::ValueRange{lookup});
+    if (tlu != nullptr)
+      tlu->erase();
+    round->erase();
+  }
+};
+
+} // namespace
+
+namespace mlir {
+namespace concretelang {
+
+std::unique_ptr<mlir::OperationPass<>>
+createFHERoundToTLUPass(std::function<double(unsigned)> tluCost) {
+  return std::make_unique<FHERoundToTLUPass>(tluCost);
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -15,6 +15,7 @@
 #include "concretelang/Dialect/FHELinalg/IR/FHELinalgTypes.h"
 #include "concretelang/Support/CompilerEngine.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MathExtras.h"
 
 namespace mlir {
 namespace OpTrait {
@@ -52,6 +53,22 @@ LogicalResult verifyTensorBroadcastingRules(
       }
       auto k = i - (maxOperandsDim - operandsShapes[j].size());
       auto operandDim = operandsShapes[j][k];
+      // Dynamic dimensions are not broadcast, they must be dynamic on all
+      // the operands with more than one element on that dimension
+      if (mlir::ShapedType::isDynamic(operandDim) ||
+          mlir::ShapedType::isDynamic(expectedResultDim)) {
+        if (operandDim != 1 && expectedResultDim != 1 &&
+            operandDim != expectedResultDim) {
+          op->emitOpError() << "has the dimension #"
+                            << (operandsShapes[j].size() - k)
+                            << " of the operand #" << j
+                            << " incompatible with the dynamic dimension of "
+                               "other operands";
+          return mlir::failure();
+        }
+        expectedResultDim = mlir::ShapedType::kDynamic;
+        continue;
+      }
       if (expectedResultDim != 1 && operandDim != 1 &&
           operandDim != expectedResultDim) {
         op->emitOpError() << "has the dimension #"
@@ -71,8 +88,14 @@ LogicalResult verifyTensorBroadcastingRules(
     if (resultShape[i] != expectedResultDim) {
       op->emitOpError() << "has the dimension #" << (maxOperandsDim - i)
                         << " of the result incompatible with operands dimension"
-                        << ", got " << resultShape[i] << " expect "
-                        << expectedResultDim;
+                        << ", got "
+                        << (mlir::ShapedType::isDynamic(resultShape[i])
+                                ? "?"
+                                : std::to_string(resultShape[i]))
+                        << " expect "
+                        << (mlir::ShapedType::isDynamic(expectedResultDim)
+                                ? "?"
+                                : std::to_string(expectedResultDim));
       return mlir::failure();
     }
   }
@@ -279,7 +302,7 @@ mlir::LogicalResult ApplyLookupTableEintOp::verify() {
                         << "xi{8,16,32,64}>";
     return mlir::failure();
   }
-  if (!resultTy.hasStaticShape(tTy.getShape())) {
+  if (resultTy.getShape() != tTy.getShape()) {
     this->emitOpError()
         << " should have same shapes for operand #1 and the result";
   }
@@ -890,6 +913,15 @@ int64_t getGroupFromConv2d(mlir::concretelang::FHELinalg::Conv2dOp &convOp) {
   return 1;
 }
 
+bool hasStaticShapeOrDynamicBatch(mlir::Type type) {
+  auto shapedTy = type.dyn_cast<mlir::ShapedType>();
+  if (!shapedTy || !shapedTy.hasRank())
+    return false;
+  auto shape = shapedTy.getShape();
+  return std::none_of(shape.begin() + std::min<size_t>(shape.size(), 1),
+                      shape.end(), mlir::ShapedType::isDynamic);
+}
+
 /// Verify the Conv2d shapes, attributes, and expected output dimensions
 mlir::LogicalResult Conv2dOp::verify() {
   auto inputTy =
@@ -1074,6 +1106,20 @@ mlir::LogicalResult Conv2dOp::verify() {
   return mlir::success();
 }
 
+int64_t Maxpool2dOp::getMaxTreeLeaves() {
+  int64_t leaves = 1;
+  for (int64_t size : this->getKernelShape().getValues<int64_t>())
+    leaves *= size;
+  const mlir::RankedTensorType inputTy =
+      this->getInput().getType().cast<mlir::RankedTensorType>();
+  const FHE::FheIntegerInterface inputElementTy = inputTy.getElementType();
+  return inputElementTy.isSigned() ? leaves + 1 : leaves;
+}
+
+int64_t Maxpool2dOp::getMaxTreeDepth() {
+  return llvm::Log2_64_Ceil(this->getMaxTreeLeaves());
+}
+
 mlir::LogicalResult Maxpool2dOp::verify() {
   const mlir::RankedTensorType inputTy =
       this->getInput().getType().cast<mlir::RankedTensorType>();
@@ -0,0 +1,199 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <optional>
+
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgOps.h>
+#include <concretelang/Dialect/FHELinalg/Transforms/EncryptedMulBatching.h>
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+/// Appends the table computing x^2/4 on the integers of `width` bits to
+/// `values`, signed ones indexing it in two's complement, as for the double
+/// table lookup lowering of `FHE.mul_eint`.
+static void appendQuarterSquareTable(SmallVector<int64_t> &values,
+                                     unsigned width, bool isSigned) {
+  int64_t size = int64_t(1) << width;
+  for (int64_t i = 0; i < size; i++) {
+    int64_t x = (isSigned && i >= size / 2) ? size - i : i;
+    values.push_back((x * x) / 4);
+  }
+}
+
+/// For documentation see EncryptedMulBatching.td
+struct FHELinalgEncryptedMulBatchingPass
+    : public FHELinalgEncryptedMulBatchingBase<
+          FHELinalgEncryptedMulBatchingPass> {
+
+  void runOnOperation() override {
+    SmallVector<FHELinalg::MatMulEintEintOp> matmuls;
+    getOperation().walk(
+        [&](FHELinalg::MatMulEintEintOp op) { matmuls.push_back(op); });
+    for (auto matmul : matmuls)
+      rewriteMatMul(matmul);
+
+    SmallVector<FHELinalg::MulEintOp> muls;
+    getOperation().walk([&](FHELinalg::MulEintOp op) { muls.push_back(op); });
+    for (auto mul : muls)
+      rewriteMul(mul);
+  }
+
+private:
+  /// Returns whether the operands and the result of `op` are tensors of
+  /// static shapes and non-zero ranks, of the same precision and signedness.
+  static bool isSupported(Operation *op) {
+    std::optional<FHE::FheIntegerInterface> first;
+    for (Type type : llvm::concat<Type>(op->getOperandTypes(),
+                                        op->getResultTypes())) {
+      auto tensorType = type.dyn_cast<RankedTensorType>();
+      if (!tensorType || !tensorType.hasStaticShape() ||
+          tensorType.getRank() == 0)
+        return false;
+      auto elt = tensorType.getElementType().cast<FHE::FheIntegerInterface>();
+      if (!first)
+        first = elt;
+      else if (elt.getWidth() != first->getWidth() ||
+               elt.isSigned() != first->isSigned())
+        return false;
+    }
+    return true;
+  }
+
+  /// Rewrites c = a.b into c_ij = sum_k (a_ik * b_kj), the products being
+  /// computed by a single `FHELinalg.mul_eint`.
+  void rewriteMatMul(FHELinalg::MatMulEintEintOp matmul) {
+    auto lhsType = matmul.getLhs().getType().cast<RankedTensorType>();
+    auto rhsType = matmul.getRhs().getType().cast<RankedTensorType>();
+    if (lhsType.getRank() != 2 || rhsType.getRank() != 2 ||
+        !isSupported(matmul))
+      return;
+
+    int64_t m = lhsType.getDimSize(0);
+    int64_t n = lhsType.getDimSize(1);
+    int64_t p = rhsType.getDimSize(1);
+    Type elt = lhsType.getElementType();
+    Location loc = matmul.getLoc();
+    OpBuilder builder(matmul);
+    auto lhs = builder.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get({m, n, 1}, elt), matmul.getLhs(),
+        ArrayRef<ReassociationIndices>{{0}, {1, 2}});
+    auto rhs = builder.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get({1, n, p}, elt), matmul.getRhs(),
+        ArrayRef<ReassociationIndices>{{0, 1}, {2}});
+    auto products = builder.create<FHELinalg::MulEintOp>(
+        loc, RankedTensorType::get({m, n, p}, elt), lhs, rhs);
+    Value result = builder.create<FHELinalg::SumOp>(
+        loc, matmul.getType(), products, builder.getI64ArrayAttr({1}),
+        builder.getBoolAttr(false));
+
+    matmul.getResult().replaceAllUsesWith(result);
+    matmul->erase();
+  }
+
+  /// Rewrites c = a * b into c = (a + b)^2/4 - (a - b)^2/4, both squares
+  /// being computed by a single mapped table lookup on the concatenation of
+  /// the sums and the differences.
+  void rewriteMul(FHELinalg::MulEintOp mul) {
+    if (!isSupported(mul))
+      return;
+
+    MLIRContext *context = &getContext();
+    auto resultType = mul.getType().cast<RankedTensorType>();
+    auto elt = resultType.getElementType().cast<FHE::FheIntegerInterface>();
+    unsigned width = elt.getWidth();
+    bool isSigned = elt.isSigned();
+    ArrayRef<int64_t> shape = resultType.getShape();
+    int64_t rank = resultType.getRank();
+    int64_t count = resultType.getNumElements();
+    Type operandType = resultType.clone(
+        mul.getLhs().getType().cast<RankedTensorType>().getElementType());
+    Type signedElt = FHE::EncryptedSignedIntegerType::get(context, width);
+    auto signedType = resultType.clone(signedElt);
+
+    Location loc = mul.getLoc();
+    OpBuilder builder(mul);
+    Value sum = builder.create<FHELinalg::AddEintOp>(
+        loc, operandType, mul.getLhs(), mul.getRhs());
+    Value diff = builder.create<FHELinalg::SubEintOp>(
+        loc, operandType, mul.getLhs(), mul.getRhs());
+    // The differences must be looked up with a signed encoding, only the
+    // table of the sums then depending on the signedness of the operands
+    if (!isSigned) {
+      sum = builder.create<FHELinalg::ToSignedOp>(loc, signedType, sum);
+      diff = builder.create<FHELinalg::ToSignedOp>(loc, signedType, diff);
+    }
+
+    SmallVector<int64_t> batchedShape{2};
+    batchedShape.append(shape.begin(), shape.end());
+    SmallVector<ReassociationIndices> reassociation{{0, 1}};
+    for (int64_t i = 1; i < rank; i++)
+      reassociation.push_back({i + 1});
+    SmallVector<int64_t> halfShape{1};
+    halfShape.append(shape.begin(), shape.end());
+    auto expand = [&](Value value) -> Value {
+      return builder.create<tensor::ExpandShapeOp>(
+          loc, RankedTensorType::get(halfShape, signedElt), value,
+          reassociation);
+    };
+    Value batched = builder.create<FHELinalg::ConcatOp>(
+        loc, RankedTensorType::get(batchedShape, signedElt),
+        ValueRange{expand(sum), expand(diff)}, builder.getI64IntegerAttr(0));
+
+    SmallVector<int64_t> tables;
+    appendQuarterSquareTable(tables, width, isSigned);
+    appendQuarterSquareTable(tables, width, true);
+    int64_t tableSize = int64_t(1) << width;
+    auto luts = builder.create<arith::ConstantOp>(
+        loc, DenseIntElementsAttr::get(
+                 RankedTensorType::get({2, tableSize}, builder.getI64Type()),
+                 tables));
+    SmallVector<int64_t> indices(count, 0);
+    indices.append(count, 1);
+    auto map = builder.create<arith::ConstantOp>(
+        loc, DenseElementsAttr::get(
+                 RankedTensorType::get(batchedShape, builder.getIndexType()),
+                 ArrayRef<int64_t>(indices)));
+    Value squares = builder.create<FHELinalg::ApplyMappedLookupTableEintOp>(
+        loc, RankedTensorType::get(batchedShape, elt), batched, luts, map);
+
+    auto half = [&](int64_t index) -> Value {
+      SmallVector<OpFoldResult> offsets(rank + 1, builder.getIndexAttr(0));
+      offsets[0] = builder.getIndexAttr(index);
+      SmallVector<OpFoldResult> sizes{builder.getIndexAttr(1)};
+      for (int64_t size : shape)
+        sizes.push_back(builder.getIndexAttr(size));
+      SmallVector<OpFoldResult> strides(rank + 1, builder.getIndexAttr(1));
+      return builder.create<tensor::ExtractSliceOp>(loc, resultType, squares,
+                                                    offsets, sizes, strides);
+    };
+    Value result = builder.create<FHELinalg::SubEintOp>(loc, resultType,
+                                                        half(0), half(1));
+
+    mul.getResult().replaceAllUsesWith(result);
+    mul->erase();
+    numRewrittenOps++;
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createFHELinalgEncryptedMulBatchingPass() {
+  return std::make_unique<FHELinalgEncryptedMulBatchingPass>();
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -0,0 +1,135 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgOps.h>
+#include <concretelang/Dialect/FHELinalg/Transforms/MatMulSquares.h>
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+/// Returns the table squaring the integers of `width` bits, signed ones
+/// indexing it in two's complement, modulo 2^(width + 2), the message space
+/// of the `width + 1` bits results including their padding bit.
+static DenseIntElementsAttr getSquareTable(MLIRContext *context,
+                                           unsigned width, bool isSigned) {
+  int64_t size = int64_t(1) << width;
+  uint64_t mask = (uint64_t(1) << (width + 2)) - 1;
+  SmallVector<int64_t> values;
+  for (int64_t i = 0; i < size; i++) {
+    int64_t x = (isSigned && i >= size / 2) ? i - size : i;
+    values.push_back((uint64_t)(x * x) & mask);
+  }
+  auto type = RankedTensorType::get({size}, IntegerType::get(context, 64));
+  return DenseIntElementsAttr::get(type, values);
+}
+
+/// For documentation see MatMulSquares.td
+struct FHELinalgMatMulSquaresPass
+    : public FHELinalgMatMulSquaresBase<FHELinalgMatMulSquaresPass> {
+
+  void runOnOperation() override {
+    SmallVector<FHELinalg::MatMulEintEintOp> matmuls;
+    getOperation().walk(
+        [&](FHELinalg::MatMulEintEintOp op) { matmuls.push_back(op); });
+    for (auto matmul : matmuls)
+      rewrite(matmul);
+  }
+
+private:
+  void rewrite(FHELinalg::MatMulEintEintOp matmul) {
+    auto lhsType = matmul.getLhs().getType().cast<RankedTensorType>();
+    auto rhsType = matmul.getRhs().getType().cast<RankedTensorType>();
+    auto resultType = matmul.getType().cast<RankedTensorType>();
+    if (lhsType.getRank() != 2 || rhsType.getRank() != 2)
+      return;
+    auto lhsElt = lhsType.getElementType().cast<FHE::FheIntegerInterface>();
+    auto rhsElt = rhsType.getElementType().cast<FHE::FheIntegerInterface>();
+    auto resultElt =
+        resultType.getElementType().cast<FHE::FheIntegerInterface>();
+    unsigned width = lhsElt.getWidth();
+    if (width > maxPrecision || rhsElt.getWidth() != width ||
+        resultElt.getWidth() != width ||
+        lhsElt.isSigned() != rhsElt.isSigned())
+      return;
+
+    int64_t m = lhsType.getDimSize(0);
+    int64_t n = lhsType.getDimSize(1);
+    int64_t p = rhsType.getDimSize(1);
+    int64_t before = 2 * m * n * p;
+    int64_t after = m * n * p + m * n + n * p;
+    if (after >= before)
+      return;
+
+    MLIRContext *context = &getContext();
+    Location loc = matmul.getLoc();
+    OpBuilder builder(matmul);
+    bool isSigned = lhsElt.isSigned();
+    auto lut = builder.create<arith::ConstantOp>(
+        loc, getSquareTable(context, width, isSigned));
+    Type squareElt = FHE::EncryptedUnsignedIntegerType::get(context, width + 1);
+    auto squares = [&](Value value) {
+      auto type = value.getType().cast<RankedTensorType>().clone(squareElt);
+      return builder.create<FHELinalg::ApplyLookupTableEintOp>(loc, type,
+                                                               value, lut);
+    };
+    auto sum = [&](Value value, ArrayRef<int64_t> shape, int64_t axis,
+                   bool keepDims) {
+      auto type = RankedTensorType::get(shape, squareElt);
+      return builder.create<FHELinalg::SumOp>(loc, type, value,
+                                              builder.getI64ArrayAttr({axis}),
+                                              builder.getBoolAttr(keepDims));
+    };
+
+    // (a_ik + b_kj) for all i, j, k, as a MxNxP tensor
+    auto lhs = builder.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get({m, n, 1}, lhsType.getElementType()),
+        matmul.getLhs(), ArrayRef<ReassociationIndices>{{0}, {1, 2}});
+    auto rhs = builder.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get({1, n, p}, rhsType.getElementType()),
+        matmul.getRhs(), ArrayRef<ReassociationIndices>{{0, 1}, {2}});
+    auto pairs = builder.create<FHELinalg::AddEintOp>(
+        loc, RankedTensorType::get({m, n, p}, lhsType.getElementType()), lhs,
+        rhs);
+
+    Value pairSquares = sum(squares(pairs), {m, p}, 1, false);
+    Value lhsSquares = sum(squares(matmul.getLhs()), {m, 1}, 1, true);
+    Value rhsSquares = sum(squares(matmul.getRhs()), {1, p}, 0, true);
+    auto doubleType = RankedTensorType::get({m, p}, squareElt);
+    Value result = builder.create<FHELinalg::SubEintOp>(
+        loc, doubleType, pairSquares, lhsSquares);
+    result = builder.create<FHELinalg::SubEintOp>(loc, doubleType, result,
+                                                  rhsSquares);
+
+    // The low bit of 2.c_ij is zero, dropping it divides by two
+    Type halfElt = FHE::EncryptedUnsignedIntegerType::get(context, width);
+    result = builder.create<FHELinalg::ReinterpretPrecisionEintOp>(
+        loc, resultType.clone(halfElt), result);
+    if (resultElt.isSigned())
+      result = builder.create<FHELinalg::ToSignedOp>(loc, resultType, result);
+
+    matmul.getResult().replaceAllUsesWith(result);
+    matmul->erase();
+    numSavedPbs += before - after;
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createFHELinalgMatMulSquaresPass() {
+  return std::make_unique<FHELinalgMatMulSquaresPass>();
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -5,6 +5,9 @@
 
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include <cmath>
+#include <thread>
 #include <mlir/Dialect/Affine/IR/AffineOps.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
@@ -12,11 +15,13 @@
 #include <mlir/Dialect/Linalg/Transforms/Transforms.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/Dialect/SCF/Transforms/TileUsingInterface.h>
 #include <mlir/Dialect/Tensor/IR/Tensor.h>
 #include <mlir/IR/PatternMatch.h>
 #include <mlir/Support/LogicalResult.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 
+#include <concretelang/Dialect/FHE/IR/FHEDialect.h>
 #include <concretelang/Dialect/FHE/IR/FHEOps.h>
 #include <concretelang/Dialect/FHE/IR/FHETypes.h>
 #include <concretelang/Dialect/FHELinalg/IR/FHELinalgOps.h>
@@ -87,10 +92,12 @@ public:
 
     assert(tileableOp);
 
-    // If the iterator types are all parallel, just use a tiled
+    // If the tiled iterator types are all parallel, just use a tiled
     // parallel loop
-    if (llvm::all_of(iteratorTypes, [](mlir::utils::IteratorType itty) {
-          return itty == mlir::utils::IteratorType::parallel;
+    if (llvm::all_of(llvm::enumerate(iteratorTypes), [&](auto itty) {
+          return itty.value() == mlir::utils::IteratorType::parallel ||
+                 itty.index() >= tileSizes.size() ||
+                 mlir::isConstantIntValue(tileSizes[itty.index()], 0);
         })) {
       mlir::FailureOr<mlir::linalg::ForallTilingResult> res =
           mlir::linalg::tileToForallOpUsingTileSizes(rewriter, tileableOp,
@@ -171,27 +178,257 @@ public:
   }
 };
 
+/// Returns the tile sizes blocking the reduction dimension of `matmulOp`,
+/// so that the ciphertexts of the slice of the left operand and of the
+/// partial results of a tile, of `ciphertextSize` bytes each, fit in
+/// `cacheSize` bytes. Returns an empty vector if the operation does not
+/// need to be tiled, or if its reduction is not its innermost loop.
+static llvm::SmallVector<int64_t>
+getCacheBlockingTileSizes(FHELinalg::MatMulEintIntOp matmulOp,
+                          int64_t cacheSize, int64_t ciphertextSize) {
+  auto lhsType = matmulOp.getLhs().getType().cast<mlir::RankedTensorType>();
+  auto outType = matmulOp.getType().cast<mlir::RankedTensorType>();
+  if (lhsType.getRank() < 2)
+    return {};
+
+  int64_t reduction = lhsType.getShape().back();
+  int64_t lhsRows = lhsType.getNumElements() / reduction;
+  int64_t outElements = outType.getNumElements();
+  int64_t budget = cacheSize / ciphertextSize - outElements;
+
+  // The largest divisor of the reduction dimension fitting in the budget
+  int64_t block = 1;
+  for (int64_t size = 1; size <= reduction; size++)
+    if (reduction % size == 0 && size * lhsRows <= budget)
+      block = size;
+  if (block == reduction)
+    return {};
+
+  llvm::SmallVector<int64_t> tileSizes(outType.getRank() + 1, 0);
+  tileSizes.back() = block;
+  return tileSizes;
+}
+
 /// Marks all `FHELinalg.matmul_eint_int` operations that with a
-/// "tile-sizes" attribute containing the specified tile sizes.
+/// "tile-sizes" attribute containing the specified tile sizes, or the tile
+/// sizes blocking their reduction for a cache of `cacheSize` bytes if no
+/// tile sizes are specified.
 class FHELinalgTilingMarkerPass
     : public FHELinalgTilingMarkerBase<FHELinalgTilingMarkerPass> {
 public:
   FHELinalgTilingMarkerPass(llvm::ArrayRef<int64_t> tileSizes)
-      : tileSizes(tileSizes.vec()) {}
+      : tileSizes(tileSizes.vec()), cacheSize(0), ciphertextSize(0) {}
+
+  FHELinalgTilingMarkerPass(int64_t cacheSize, int64_t ciphertextSize)
+      : cacheSize(cacheSize), ciphertextSize(ciphertextSize) {}
 
   void runOnOperation() override {
     mlir::Operation *op = getOperation();
+    mlir::Builder builder(&this->getContext());
 
-    mlir::ArrayAttr tileAttr =
-        mlir::Builder(&this->getContext()).getI64ArrayAttr(tileSizes);
+    mlir::ArrayAttr tileAttr = builder.getI64ArrayAttr(tileSizes);
 
     op->walk([&](mlir::concretelang::FHELinalg::MatMulEintIntOp matmulOp) {
-      matmulOp.getOperation()->setAttr("tile-sizes", tileAttr);
+      if (!tileSizes.empty()) {
+        matmulOp.getOperation()->setAttr("tile-sizes", tileAttr);
+        return;
+      }
+      auto blocking =
+          getCacheBlockingTileSizes(matmulOp, cacheSize, ciphertextSize);
+      if (!blocking.empty())
+        matmulOp.getOperation()->setAttr("tile-sizes",
+                                         builder.getI64ArrayAttr(blocking));
     });
   }
 
 protected:
   std::vector<int64_t> tileSizes;
+  int64_t cacheSize;
+  int64_t ciphertextSize;
+};
+
+/// Returns true if `value` is the result of a `linalg.generic` with a
+/// reduction, possibly through `depth` elementwise `linalg.generic`
+/// operations.
+static bool isComputedByDotProduct(mlir::Value value, unsigned depth) {
+  auto genericOp = value.getDefiningOp<mlir::linalg::GenericOp>();
+  if (!genericOp)
+    return false;
+  if (genericOp.getNumReductionLoops() > 0)
+    return true;
+  if (depth == 0)
+    return false;
+  return llvm::any_of(genericOp.getDpsInputOperands(),
+                      [&](mlir::OpOperand *operand) {
+                        return isComputedByDotProduct(operand->get(),
+                                                      depth - 1);
+                      });
+}
+
+/// Returns true if `genericOp` applies a table lookup to each element of
+/// its operand.
+static bool isElementwiseTableLookup(mlir::linalg::GenericOp genericOp) {
+  if (genericOp.getNumReductionLoops() > 0 || genericOp.getNumLoops() == 0)
+    return false;
+  return llvm::any_of(genericOp.getBody()->getOperations(),
+                      [](mlir::Operation &op) {
+                        return llvm::isa<FHE::ApplyLookupTableEintOp>(op);
+                      });
+}
+
+/// The cost of a leveled operation, in bootstraps
+static const double kLeveledOpCost = 0.01;
+
+/// Returns the cost of an iteration of `genericOp`, in bootstraps.
+static double getIterationCost(mlir::linalg::GenericOp genericOp) {
+  double cost = 0;
+  genericOp.getBody()->walk([&](mlir::Operation *op) {
+    if (llvm::isa<FHE::ApplyLookupTableEintOp, FHE::ApplyManyLookupTablesEintOp,
+                  FHE::RoundEintOp, FHE::LsbEintOp>(op))
+      cost += 1;
+    else if (llvm::isa<FHE::MulEintOp, FHE::MaxEintOp>(op))
+      cost += 2;
+    else if (llvm::isa<FHE::FHEDialect>(op->getDialect()))
+      cost += kLeveledOpCost;
+  });
+  return cost;
+}
+
+/// For documentation see Tiling.td
+class LinalgTaskTilingMarkerPass
+    : public LinalgTaskTilingMarkerBase<LinalgTaskTilingMarkerPass> {
+public:
+  LinalgTaskTilingMarkerPass(double taskCost, int64_t workers) {
+    this->taskCost = taskCost;
+    this->workers = workers;
+  }
+
+  void runOnOperation() override {
+    mlir::Builder builder(&getContext());
+    int64_t minTiles = workers;
+    if (minTiles == 0)
+      minTiles = std::max(1u, std::thread::hardware_concurrency());
+
+    getOperation()->walk([&](mlir::linalg::GenericOp genericOp) {
+      if (genericOp->hasAttr("tile-sizes"))
+        return;
+      llvm::SmallVector<int64_t> tileSizes = getTileSizes(genericOp, minTiles);
+      if (!tileSizes.empty())
+        genericOp->setAttr("tile-sizes", builder.getI64ArrayAttr(tileSizes));
+    });
+  }
+
+private:
+  /// Returns the tile sizes of the parallel dimensions splitting
+  /// `genericOp` in tiles of about `taskCost` bootstraps, and in at least
+  /// `minTiles` tiles if it costs more than a tile. Returns an empty vector
+  /// if it is not to be tiled.
+  llvm::SmallVector<int64_t> getTileSizes(mlir::linalg::GenericOp genericOp,
+                                          int64_t minTiles) {
+    llvm::SmallVector<int64_t> ranges = genericOp.getStaticLoopRanges();
+    llvm::SmallVector<mlir::utils::IteratorType> iteratorTypes =
+        genericOp.getIteratorTypesArray();
+    if (llvm::any_of(ranges, mlir::ShapedType::isDynamic))
+      return {};
+
+    double cost = getIterationCost(genericOp);
+    int64_t parallelIterations = 1;
+    for (auto it : llvm::zip(ranges, iteratorTypes)) {
+      cost *= std::get<0>(it);
+      if (std::get<1>(it) == mlir::utils::IteratorType::parallel)
+        parallelIterations *= std::get<0>(it);
+    }
+    if (cost <= taskCost)
+      return {};
+    int64_t tiles = std::max((int64_t)std::ceil(cost / taskCost), minTiles);
+    tiles = std::min(tiles, parallelIterations);
+
+    // Split the outermost dimensions first, the last tile of a dimension
+    // being smaller if the tile size does not divide it.
+    llvm::SmallVector<int64_t> tileSizes(ranges.size(), 0);
+    bool tiled = false;
+    for (size_t d = 0; d < ranges.size() && tiles > 1; d++) {
+      if (iteratorTypes[d] != mlir::utils::IteratorType::parallel)
+        continue;
+      int64_t tileSize =
+          llvm::divideCeil(ranges[d], std::min(ranges[d], tiles));
+      int64_t dimTiles = llvm::divideCeil(ranges[d], tileSize);
+      if (dimTiles == 1)
+        continue;
+      tileSizes[d] = tileSize;
+      tiled = true;
+      tiles = llvm::divideCeil(tiles, dimTiles);
+    }
+    if (!tiled)
+      return {};
+    return tileSizes;
+  }
+};
+
+/// For documentation see Tiling.td
+class LinalgLayerStreamingPass
+    : public LinalgLayerStreamingBase<LinalgLayerStreamingPass> {
+public:
+  LinalgLayerStreamingPass(int64_t tileSize) { this->tileSize = tileSize; }
+
+  void runOnOperation() override {
+    llvm::SmallVector<mlir::linalg::GenericOp> tlus;
+    getOperation()->walk([&](mlir::linalg::GenericOp genericOp) {
+      // The table lookup, the bias and the dot product
+      if (isElementwiseTableLookup(genericOp) &&
+          llvm::any_of(genericOp.getDpsInputOperands(),
+                       [](mlir::OpOperand *operand) {
+                         return isComputedByDotProduct(operand->get(), 1);
+                       }))
+        tlus.push_back(genericOp);
+    });
+
+    mlir::IRRewriter rewriter(&getContext());
+    for (auto tlu : tlus)
+      stream(rewriter, tlu);
+  }
+
+private:
+  void stream(mlir::IRRewriter &rewriter, mlir::linalg::GenericOp tlu) {
+    // Tiles of the same size keep the loops in the tiles static, which the
+    // batching requires.
+    int64_t rows = tlu.getStaticLoopRanges()[0];
+    if (mlir::ShapedType::isDynamic(rows))
+      return;
+    int64_t rowsPerTile = 1;
+    for (int64_t size = 1; size <= std::min(rows, (int64_t)tileSize); size++)
+      if (rows % size == 0)
+        rowsPerTile = size;
+    if (rowsPerTile == rows)
+      return;
+
+    llvm::SmallVector<int64_t> tileSizes(tlu.getNumLoops(), 0);
+    tileSizes[0] = rowsPerTile;
+    mlir::scf::SCFTileAndFuseOptions options;
+    options.tilingOptions.setTileSizes(tileSizes);
+
+    rewriter.setInsertionPoint(tlu);
+    auto tilingInterface =
+        llvm::cast<mlir::TilingInterface>(tlu.getOperation());
+    mlir::FailureOr<mlir::scf::SCFTileAndFuseResult> res =
+        mlir::scf::tileConsumerAndFuseProducerGreedilyUsingSCFForOp(
+            rewriter, tilingInterface, options);
+    if (mlir::failed(res))
+      return;
+
+    for (auto loop : res->loops)
+      loop->setAttr(STREAMING_TILE_LOOP_ATTR, rewriter.getUnitAttr());
+    for (mlir::OpResult result : tlu->getResults())
+      if (mlir::Value replacement = res->replacements.lookup(result))
+        result.replaceAllUsesWith(replacement);
+
+    // The producers fused in the tiles are no longer used
+    llvm::SmallVector<mlir::Operation *> dead{tlu};
+    dead.append(res->fusedProducers.begin(), res->fusedProducers.end());
+    for (mlir::Operation *op : dead)
+      if (op->use_empty())
+        rewriter.eraseOp(op);
+  }
 };
 
 std::unique_ptr<mlir::OperationPass<>> createLinalgTilingPass() {
@@ -202,5 +439,21 @@ std::unique_ptr<mlir::OperationPass<>>
 createFHELinalgTilingMarkerPass(llvm::ArrayRef<int64_t> tileSizes) {
   return std::make_unique<FHELinalgTilingMarkerPass>(tileSizes);
 }
+
+std::unique_ptr<mlir::OperationPass<>>
+createLinalgLayerStreamingPass(int64_t tileSize) {
+  return std::make_unique<LinalgLayerStreamingPass>(tileSize);
+}
+
+std::unique_ptr<mlir::OperationPass<>>
+createLinalgTaskTilingMarkerPass(double taskCost, int64_t workers) {
+  return std::make_unique<LinalgTaskTilingMarkerPass>(taskCost, workers);
+}
+
+std::unique_ptr<mlir::OperationPass<>>
+createFHELinalgTilingMarkerPass(int64_t cacheSize, int64_t ciphertextSize) {
+  return std::make_unique<FHELinalgTilingMarkerPass>(cacheSize,
+                                                     ciphertextSize);
+}
 } // namespace concretelang
 } // namespace mlir
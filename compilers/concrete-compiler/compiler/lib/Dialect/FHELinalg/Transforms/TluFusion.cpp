@@ -0,0 +1,225 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/IR/Matchers.h>
+#include <tuple>
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHELinalg/IR/FHELinalgOps.h>
+#include <concretelang/Dialect/FHELinalg/Transforms/TluFusion.h>
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+/// Returns the number of elements the values of `type` hold, i.e. the
+/// number of bootstraps of a table lookup returning it.
+static int64_t getNumElements(Type type) {
+  if (auto tensor = type.dyn_cast<RankedTensorType>())
+    return tensor.getNumElements();
+  return 1;
+}
+
+static Type withElementType(Type type, Type elementType) {
+  return type.cast<RankedTensorType>().clone(elementType);
+}
+
+/// Returns the encrypted tensor operands of `op` if it only rearranges their
+/// elements, and an empty list otherwise.
+static SmallVector<Value> getLayoutOperands(Operation *op) {
+  if (auto transpose = dyn_cast<FHELinalg::TransposeOp>(op))
+    return {transpose.getTensor()};
+  if (auto collapse = dyn_cast<tensor::CollapseShapeOp>(op))
+    return {collapse.getSrc()};
+  if (auto expand = dyn_cast<tensor::ExpandShapeOp>(op))
+    return {expand.getSrc()};
+  if (auto slice = dyn_cast<tensor::ExtractSliceOp>(op))
+    return {slice.getSource()};
+  if (auto concat = dyn_cast<FHELinalg::ConcatOp>(op))
+    return SmallVector<Value>(concat.getIns().begin(), concat.getIns().end());
+  return {};
+}
+
+/// Collects the tree of layout operations computing `value` from the
+/// results of table lookups with constant tables, each value of the tree
+/// being used only once. Layout operations are collected users first.
+static bool collectLayoutTree(Value value, SmallVector<Operation *> &layoutOps,
+                              SmallVector<FHELinalg::ApplyLookupTableEintOp>
+                                  &leaves) {
+  Operation *op = value.getDefiningOp();
+  if (op == nullptr || !value.hasOneUse())
+    return false;
+  if (auto tlu = dyn_cast<FHELinalg::ApplyLookupTableEintOp>(op)) {
+    if (!matchPattern(tlu.getLut(), m_Constant()))
+      return false;
+    leaves.push_back(tlu);
+    return true;
+  }
+  auto operands = getLayoutOperands(op);
+  if (operands.empty())
+    return false;
+  layoutOps.push_back(op);
+  for (Value operand : operands)
+    if (!collectLayoutTree(operand, layoutOps, leaves))
+      return false;
+  return true;
+}
+
+/// Returns the table applying `second` on the results of `first`.
+static DenseIntElementsAttr composeTables(DenseIntElementsAttr first,
+                                          DenseIntElementsAttr second) {
+  SmallVector<int64_t> secondValues;
+  for (auto v : second.getValues<APInt>())
+    secondValues.push_back(v.getSExtValue());
+  int64_t size = secondValues.size();
+  SmallVector<APInt> values;
+  for (auto v : first.getValues<APInt>()) {
+    // Signed results index the table in two's complement.
+    int64_t index = ((v.getSExtValue() % size) + size) % size;
+    values.push_back(
+        APInt(first.getElementType().getIntOrFloatBitWidth(),
+              secondValues[index], /*isSigned=*/true));
+  }
+  return DenseIntElementsAttr::get(first.getType(), values);
+}
+
+/// For documentation see TluFusion.td
+struct FHELinalgTluFusionPass
+    : public FHELinalgTluFusionBase<FHELinalgTluFusionPass> {
+
+  FHELinalgTluFusionPass(bool report) : report(report) {}
+
+  void runOnOperation() override {
+    // Fusing a table lookup may make the layout operations using its result
+    // fusible in turn.
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      SmallVector<FHELinalg::ApplyLookupTableEintOp> tlus;
+      getOperation().walk(
+          [&](FHELinalg::ApplyLookupTableEintOp tlu) { tlus.push_back(tlu); });
+      erased.clear();
+      for (auto tlu : tlus)
+        if (!erased.contains(tlu))
+          changed |= fuse(tlu);
+    }
+    deduplicate();
+    numFusedPbs += fusedPbs;
+    numDeduplicatedPbs += deduplicatedPbs;
+    if (report)
+      llvm::errs() << "TLU fusion removed " << fusedPbs + deduplicatedPbs
+                   << " PBS (" << fusedPbs << " fused, " << deduplicatedPbs
+                   << " deduplicated)\n";
+  }
+
+private:
+  /// Composes `tlu` into the table lookups computing its input through
+  /// layout operations.
+  bool fuse(FHELinalg::ApplyLookupTableEintOp tlu) {
+    DenseIntElementsAttr table;
+    if (!matchPattern(tlu.getLut(), m_Constant(&table)))
+      return false;
+    SmallVector<Operation *> layoutOps;
+    SmallVector<FHELinalg::ApplyLookupTableEintOp> leaves;
+    if (!collectLayoutTree(tlu.getT(), layoutOps, leaves))
+      return false;
+
+    Type elementType = tlu.getType().cast<RankedTensorType>().getElementType();
+    OpBuilder builder(tlu);
+    IRMapping mapping;
+    for (auto leaf : leaves) {
+      DenseIntElementsAttr leafTable;
+      matchPattern(leaf.getLut(), m_Constant(&leafTable));
+      builder.setInsertionPointAfter(leaf);
+      auto lut = builder.create<arith::ConstantOp>(
+          leaf.getLoc(), composeTables(leafTable, table));
+      auto fused = builder.create<FHELinalg::ApplyLookupTableEintOp>(
+          leaf.getLoc(), withElementType(leaf.getType(), elementType),
+          leaf.getT(), lut);
+      mapping.map(leaf.getResult(), fused.getResult());
+    }
+    // The layout operations are now applied to the results of the fused
+    // table lookups, producers first.
+    builder.setInsertionPoint(tlu);
+    for (Operation *op : llvm::reverse(layoutOps)) {
+      Operation *clone = builder.clone(*op, mapping);
+      clone->getResult(0).setType(
+          withElementType(op->getResult(0).getType(), elementType));
+    }
+    tlu.getResult().replaceAllUsesWith(mapping.lookup(tlu.getT()));
+
+    fusedPbs += getNumElements(tlu.getType());
+    erased.insert(tlu);
+    tlu->erase();
+    for (Operation *op : layoutOps)
+      op->erase();
+    for (auto leaf : leaves) {
+      erased.insert(leaf);
+      leaf->erase();
+    }
+    return true;
+  }
+
+  /// Replaces the table lookups applying the same table to the same value
+  /// as a previous table lookup of their block by the result of the latter.
+  void deduplicate() {
+    typedef std::tuple<Value, Attribute, Type> Key;
+    SmallVector<Block *> blocks;
+    getOperation().walk([&](Block *block) { blocks.push_back(block); });
+    for (Block *block : blocks) {
+      llvm::DenseMap<Key, Operation *> seen;
+      for (Operation &op : llvm::make_early_inc_range(*block)) {
+        Value input, lut;
+        if (auto tlu = dyn_cast<FHELinalg::ApplyLookupTableEintOp>(op)) {
+          input = tlu.getT();
+          lut = tlu.getLut();
+        } else if (auto tlu = dyn_cast<FHE::ApplyLookupTableEintOp>(op)) {
+          input = tlu.getA();
+          lut = tlu.getLut();
+        } else {
+          continue;
+        }
+        Attribute table;
+        if (!matchPattern(lut, m_Constant(&table)))
+          continue;
+        Key key(input, table, op.getResult(0).getType());
+        auto it = seen.find(key);
+        if (it == seen.end()) {
+          seen[key] = &op;
+          continue;
+        }
+        op.getResult(0).replaceAllUsesWith(it->second->getResult(0));
+        deduplicatedPbs += getNumElements(op.getResult(0).getType());
+        op.erase();
+      }
+    }
+  }
+
+  bool report;
+  uint64_t fusedPbs = 0;
+  uint64_t deduplicatedPbs = 0;
+  /// The table lookups erased by the current round of fusions.
+  llvm::DenseSet<Operation *> erased;
+};
+
+} // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+createFHELinalgTluFusionPass(bool report) {
+  return std::make_unique<FHELinalgTluFusionPass>(report);
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -23,8 +23,11 @@
 #include <mlir/Dialect/Bufferization/Transforms/Passes.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/Dialect/Utils/StaticValueUtils.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/IRMapping.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
 #include <mlir/Transforms/RegionUtils.h>
 
 #define GEN_PASS_CLASSES
@@ -61,6 +64,67 @@ public:
   }
 };
 
+/// Allocates the outputs of `workFunction` only consumed by other tasks in
+/// the task arena, if their size is static, and returns their bytes.
+static int64_t allocateOutputsInArena(func::FuncOp workFunction) {
+  auto outputs =
+      workFunction->getAttrOfType<DenseI64ArrayAttr>("_dfr_arena_outputs");
+  if (!outputs)
+    return 0;
+  int64_t bytes = 0;
+  workFunction.walk([&](RT::WorkFunctionReturnOp op) {
+    auto output = op.getOperand(1).dyn_cast<BlockArgument>();
+    auto alloc = op.getOperand(0).getDefiningOp<mlir::memref::AllocOp>();
+    if (!output || !alloc ||
+        !llvm::is_contained(outputs.asArrayRef(), output.getArgNumber()))
+      return;
+    MemRefType type = alloc.getType();
+    if (!type.hasStaticShape() || !type.getLayout().isIdentity() ||
+        alloc.getAlignment().has_value())
+      return;
+    alloc->setAttr("_dfr_arena", UnitAttr::get(alloc.getContext()));
+    DataLayout dataLayout = DataLayout::closest(alloc);
+    size_t elementSize = dataLayout.getTypeSize(type.getElementType());
+    bytes += type.getNumElements() * elementSize;
+  });
+  return bytes;
+}
+
+/// Returns the bytes of the task arena needed by an execution of `func`,
+/// or nullopt if the number of tasks it creates is not static.
+static std::optional<int64_t>
+getTaskArenaBytes(func::FuncOp func,
+                  const llvm::StringMap<int64_t> &outputBytes) {
+  int64_t bytes = 0;
+  bool dynamic = false;
+  func.walk([&](RT::CreateAsyncTaskOp op) {
+    auto sym = op->getAttrOfType<SymbolRefAttr>("workfn");
+    auto it = outputBytes.find(sym.getLeafReference());
+    if (it == outputBytes.end() || it->second == 0)
+      return;
+    int64_t count = 1;
+    for (Operation *parent = op->getParentOp(); parent != func;
+         parent = parent->getParentOp()) {
+      auto loop = dyn_cast<scf::ForOp>(parent);
+      std::optional<int64_t> lb, ub, step;
+      if (loop) {
+        lb = getConstantIntValue(loop.getLowerBound());
+        ub = getConstantIntValue(loop.getUpperBound());
+        step = getConstantIntValue(loop.getStep());
+      }
+      if (!lb || !ub || !step) {
+        dynamic = true;
+        return;
+      }
+      count *= std::max<int64_t>(0, (*ub - *lb + *step - 1) / *step);
+    }
+    bytes += count * it->second;
+  });
+  if (dynamic)
+    return std::nullopt;
+  return bytes;
+}
+
 } // namespace
 
 namespace {
@@ -95,8 +159,26 @@ struct BufferizeDataflowTaskOpsPass
     mlir::concretelang::populateWithRTTypeConverterPatterns(patterns, target,
                                                             typeConverter);
 
-    if (failed(applyPartialConversion(module, target, std::move(patterns))))
+    if (failed(applyPartialConversion(module, target, std::move(patterns)))) {
       signalPassFailure();
+      return;
+    }
+
+    // Size the task arena of each function from the static outputs of
+    // the tasks it creates.
+    llvm::StringMap<int64_t> outputBytes;
+    module.walk([&](mlir::func::FuncOp func) {
+      if (func->getAttr("_dfr_work_function_attribute"))
+        outputBytes[func.getName()] = allocateOutputsInArena(func);
+    });
+    module.walk([&](mlir::func::FuncOp func) {
+      if (func->getAttr("_dfr_work_function_attribute"))
+        return;
+      std::optional<int64_t> bytes = getTaskArenaBytes(func, outputBytes);
+      if (bytes && *bytes > 0)
+        func->setAttr("_dfr_task_arena_bytes",
+                      IntegerAttr::get(IntegerType::get(context, 64), *bytes));
+    });
   }
 
   BufferizeDataflowTaskOpsPass(bool debug) : debug(debug){};
@@ -0,0 +1,272 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <concretelang/Dialect/FHE/IR/FHEOps.h>
+#include <concretelang/Dialect/FHE/Interfaces/FHEInterfaces.h>
+#include <concretelang/Dialect/RT/Analysis/Autopar.h>
+#include <concretelang/Dialect/RT/IR/RTOps.h>
+
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/Dialect/Linalg/IR/Linalg.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/Support/LLVM.h>
+#include <mlir/Transforms/RegionUtils.h>
+
+#define GEN_PASS_CLASSES
+#include <concretelang/Dialect/RT/Analysis/Autopar.h.inc>
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+// Cost of a leveled operation on a ciphertext relative to a table
+// lookup, which dominates the cost of the circuits.
+const double LEVELED_OP_COST = 1e-3;
+
+static bool isEncrypted(Type type) {
+  if (auto shaped = type.dyn_cast<ShapedType>())
+    type = shaped.getElementType();
+  return type.isa<FHE::FheIntegerInterface>();
+}
+
+/// Returns the cost of the operations of `region`, in table lookups,
+/// each operation counting `multiplicity` times.
+static double getRegionCost(Region &region, double multiplicity) {
+  double cost = 0;
+  for (Operation &op : region.getOps()) {
+    double opMultiplicity = multiplicity;
+    if (auto genericOp = dyn_cast<linalg::GenericOp>(op)) {
+      for (int64_t range : genericOp.getStaticLoopRanges())
+        if (!ShapedType::isDynamic(range))
+          opMultiplicity *= range;
+    }
+    if (isa<FHE::ApplyLookupTableEintOp>(op)) {
+      cost += opMultiplicity;
+    } else if (llvm::any_of(op.getResultTypes(), isEncrypted)) {
+      double elements = opMultiplicity;
+      if (op.getNumRegions() == 0)
+        for (Type type : op.getResultTypes())
+          if (auto shaped = type.dyn_cast<ShapedType>())
+            if (shaped.hasStaticShape())
+              elements *= shaped.getNumElements();
+      cost += LEVELED_OP_COST * elements;
+    }
+    for (Region &nested : op.getRegions())
+      cost += getRegionCost(nested, opMultiplicity);
+  }
+  return cost;
+}
+
+/// Returns true if one of the results of `producer` is used by an
+/// operation between `producer` and `consumer`, other than `consumer`.
+static bool isUsedBefore(RT::DataflowTaskOp producer,
+                         RT::DataflowTaskOp consumer) {
+  for (Operation *op = producer->getNextNode(); op != consumer;
+       op = op->getNextNode()) {
+    bool used = false;
+    op->walk([&](Operation *nested) {
+      for (Value operand : nested->getOperands())
+        if (operand.getDefiningOp() == producer)
+          used = true;
+    });
+    if (used)
+      return true;
+  }
+  return false;
+}
+
+/// Merges `first` into `second`, which follows it in the same block,
+/// and returns the merged task, which replaces `second`.  The results
+/// of `first` only used by `second` are no longer returned.
+static RT::DataflowTaskOp mergeTasks(RT::DataflowTaskOp first,
+                                     RT::DataflowTaskOp second) {
+  auto isInSecond = [&](OpOperand &use) {
+    return second->isAncestor(use.getOwner());
+  };
+  SmallVector<unsigned, 4> keptFirstResults;
+  for (auto result : llvm::enumerate(first->getResults()))
+    if (!llvm::all_of(result.value().getUses(), isInSecond))
+      keptFirstResults.push_back(result.index());
+
+  SmallVector<Type, 4> resultTypes;
+  for (unsigned i : keptFirstResults)
+    resultTypes.push_back(first->getResult(i).getType());
+  resultTypes.append(second->getResultTypes().begin(),
+                     second->getResultTypes().end());
+
+  OpBuilder builder(second);
+  auto merged = builder.create<RT::DataflowTaskOp>(
+      second.getLoc(), resultTypes, mlir::ValueRange());
+  OpBuilder body(merged.getBody());
+  IRMapping map;
+  auto firstYield =
+      cast<RT::DataflowYieldOp>(first.getBody().front().getTerminator());
+  for (Operation &op : first.getBody().front().without_terminator())
+    body.clone(op, map);
+  for (auto pair : llvm::zip(first->getResults(), firstYield.getOperands()))
+    map.map(std::get<0>(pair), map.lookupOrDefault(std::get<1>(pair)));
+  auto secondYield =
+      cast<RT::DataflowYieldOp>(second.getBody().front().getTerminator());
+  for (Operation &op : second.getBody().front().without_terminator())
+    body.clone(op, map);
+
+  SmallVector<Value, 4> yielded;
+  for (unsigned i : keptFirstResults)
+    yielded.push_back(map.lookup(first->getResult(i)));
+  for (Value value : secondYield.getOperands())
+    yielded.push_back(map.lookupOrDefault(value));
+  body.create<RT::DataflowYieldOp>(merged.getLoc(), mlir::TypeRange(),
+                                   yielded);
+
+  SetVector<Value> deps;
+  getUsedValuesDefinedAbove(merged.getBody(), deps);
+  merged->setOperands(deps.takeVector());
+
+  for (auto pair : llvm::enumerate(keptFirstResults))
+    first->getResult(pair.value())
+        .replaceAllUsesWith(merged->getResult(pair.index()));
+  for (auto pair : llvm::enumerate(second->getResults()))
+    pair.value().replaceAllUsesWith(
+        merged->getResult(keptFirstResults.size() + pair.index()));
+  second->erase();
+  first->erase();
+  return merged;
+}
+
+/// For documentation see Autopar.td
+struct CoarsenDataflowTasksPass
+    : public CoarsenDataflowTasksBase<CoarsenDataflowTasksPass> {
+
+  void runOnOperation() override {
+    if (targetComplexity <= 0 || circuitComplexity <= 0)
+      return;
+    auto module = getOperation();
+
+    // The complexity of the circuit computed by the optimizer is
+    // distributed over the tasks in proportion to their estimated cost.
+    double totalCost = 0;
+    module.walk([&](RT::DataflowTaskOp task) {
+      totalCost += getRegionCost(task.getBody(), 1);
+    });
+    if (totalCost <= 0)
+      return;
+    double complexityPerCost = circuitComplexity / totalCost;
+
+    // Tasks are not nested, their blocks are not affected by merges.
+    SetVector<Block *> blocks;
+    module.walk([&](RT::DataflowTaskOp task) {
+      blocks.insert(task->getBlock());
+    });
+    for (Block *block : blocks) {
+      RT::DataflowTaskOp current = nullptr;
+      double currentComplexity = 0;
+      for (Operation *op = &block->front(); op != nullptr;) {
+        Operation *next = op->getNextNode();
+        auto task = dyn_cast<RT::DataflowTaskOp>(op);
+        if (!task) {
+          op = next;
+          continue;
+        }
+        double complexity =
+            getRegionCost(task.getBody(), 1) * complexityPerCost;
+        if (current != nullptr && !isUsedBefore(current, task) &&
+            currentComplexity + complexity <= targetComplexity) {
+          current = mergeTasks(current, task);
+          currentComplexity += complexity;
+        } else {
+          current = task;
+          currentComplexity = complexity;
+        }
+        // Tasks reaching the target are not merged further.
+        if (currentComplexity >= targetComplexity)
+          current = nullptr;
+        op = next;
+      }
+    }
+  }
+
+  CoarsenDataflowTasksPass(double circuitComplexity, double targetComplexity,
+                           bool debug)
+      : circuitComplexity(circuitComplexity),
+        targetComplexity(targetComplexity), debug(debug){};
+
+protected:
+  double circuitComplexity;
+  double targetComplexity;
+  bool debug;
+};
+} // end anonymous namespace
+
+std::unique_ptr<mlir::Pass>
+createCoarsenDataflowTasksPass(double circuitComplexity,
+                               double targetComplexity, bool debug) {
+  return std::make_unique<CoarsenDataflowTasksPass>(circuitComplexity,
+                                                    targetComplexity, debug);
+}
+
+namespace {
+
+/// Returns the last task producing operands of `consumer`, if its results
+/// are only used by `consumer` and merging it into `consumer` delays none
+/// of them: the other operands of `consumer` are either operands of the
+/// producer, or defined before it by operations other than tasks.
+static RT::DataflowTaskOp getChainedProducer(RT::DataflowTaskOp consumer) {
+  RT::DataflowTaskOp producer = nullptr;
+  for (Value operand : consumer->getOperands()) {
+    auto task = operand.getDefiningOp<RT::DataflowTaskOp>();
+    if (task && task->getBlock() == consumer->getBlock() &&
+        (producer == nullptr || producer->isBeforeInBlock(task)))
+      producer = task;
+  }
+  if (producer == nullptr)
+    return nullptr;
+  for (Operation *user : producer->getUsers())
+    if (!consumer->isAncestor(user))
+      return nullptr;
+  for (Value operand : consumer->getOperands()) {
+    if (operand.getDefiningOp() == producer ||
+        llvm::is_contained(producer->getOperands(), operand))
+      continue;
+    Operation *def = operand.getDefiningOp();
+    if (isa_and_nonnull<RT::DataflowTaskOp>(def))
+      return nullptr;
+    if (def != nullptr && def->getBlock() == producer->getBlock() &&
+        !def->isBeforeInBlock(producer))
+      return nullptr;
+  }
+  return producer;
+}
+
+/// For documentation see Autopar.td
+struct FuseDataflowTaskChainsPass
+    : public FuseDataflowTaskChainsBase<FuseDataflowTaskChainsPass> {
+
+  void runOnOperation() override {
+    // The producers precede their consumers, which are never erased
+    // before being visited.
+    SmallVector<RT::DataflowTaskOp> tasks;
+    getOperation().walk(
+        [&](RT::DataflowTaskOp task) { tasks.push_back(task); });
+    for (RT::DataflowTaskOp task : tasks)
+      while (RT::DataflowTaskOp producer = getChainedProducer(task))
+        task = mergeTasks(producer, task);
+  }
+
+  FuseDataflowTaskChainsPass(bool debug) : debug(debug){};
+
+protected:
+  bool debug;
+};
+} // end anonymous namespace
+
+std::unique_ptr<mlir::Pass> createFuseDataflowTaskChainsPass(bool debug) {
+  return std::make_unique<FuseDataflowTaskChainsPass>(debug);
+}
+
+} // end namespace concretelang
+} // end namespace mlir
@@ -4,6 +4,7 @@
 // for license information.
 
 #include <iostream>
+#include <set>
 
 #include <concretelang/Conversion/Tools.h>
 #include <concretelang/Conversion/Utils/GenericOpTypeConversionPattern.h>
@@ -136,7 +137,8 @@ static mlir::Type stripType(mlir::Type type) {
 
 // TODO: Fix type sizes. For now we're using some default values.
 static std::pair<Value, Value>
-getTaskArgumentSizeAndType(Value val, Location loc, OpBuilder builder) {
+getTaskArgumentSizeAndType(Value val, Location loc, OpBuilder builder,
+                           uint64_t wireBits = 0) {
   DataLayout dataLayout = DataLayout::closest(val.getDefiningOp());
   Type type = stripType(val.getType());
 
@@ -167,6 +169,7 @@ getTaskArgumentSizeAndType(Value val, Location loc, OpBuilder builder) {
     elementAttr =
         dfr::_dfr_set_arg_type(elementAttr, dfr::_DFR_TASK_ARG_MEMREF);
     elementAttr = dfr::_dfr_set_memref_element_size(elementAttr, element_size);
+    elementAttr = dfr::_dfr_set_memref_wire_bits(elementAttr, wireBits);
     Value arg_type = builder.create<arith::ConstantOp>(
         loc, builder.getI64IntegerAttr(elementAttr));
     return std::pair<mlir::Value, mlir::Value>(typeSize, arg_type);
@@ -262,7 +265,11 @@ static void lowerDataflowTaskOp(RT::DataflowTaskOp DFTOp,
   // other DFTs as those will need to be waited on explicitly.
   // We also create the DerefReturnPtrPlaceholderOp after the
   // CreateAsyncTaskOp.  These also need propagating.
+  // The results which are not waited on are only ever read by other
+  // tasks, their storage can come from the task arena.
+  SmallVector<int64_t, 4> arenaOutputs;
   for (auto result : DFTOp.getResults()) {
+    bool awaited = false;
     Type futType = RT::FutureType::get(result.getType());
     Value futptr = map.lookupOrNull(result);
     assert(futptr);
@@ -292,12 +299,19 @@ static void lowerDataflowTaskOp(RT::DataflowTaskOp DFTOp,
             DFTOp.getLoc(), result.getType(), drpp.getResult());
         assert(opBody.isAncestor(use.getOwner()->getParentRegion()));
         use.set(af->getResult(0));
+        awaited = true;
       }
     }
+    if (!awaited)
+      arenaOutputs.push_back(result.getResultNumber());
     // All leftover uses (i.e. those within DFTs should use the future)
     replaceAllUsesInRegionWith(result, futptr, opBody);
   }
 
+  if (!arenaOutputs.empty())
+    workFunction->setAttr("_dfr_arena_outputs",
+                          builder.getDenseI64ArrayAttr(arenaOutputs));
+
   // Finally erase the DFT.
   DFTOp.erase();
 }
@@ -450,6 +464,20 @@ struct StartStopPass : public StartStopBase<StartStopPass> {
       }
     });
 
+    // The evaluation keys used by the work functions, by kind (as the
+    // `KeyKind` of the runtime) and index
+    std::set<std::pair<int64_t, int64_t>> keys;
+    module.walk([&](mlir::Operation *op) {
+      auto func = op->getParentOfType<mlir::func::FuncOp>();
+      if (!func || !func->getAttr("_dfr_work_function_attribute"))
+        return;
+      const std::pair<int64_t, const char *> indices[] = {
+          {0, "bskIndex"}, {1, "kskIndex"}, {2, "pkskIndex"}};
+      for (auto index : indices)
+        if (auto attr = op->getAttrOfType<IntegerAttr>(index.second))
+          keys.insert({index.first, attr.getInt()});
+    });
+
     for (auto entryPoint : entryPoints) {
       // Issue _dfr_start/stop calls for this function
       OpBuilder builder(entryPoint.getBody());
@@ -478,6 +506,38 @@ struct StartStopPass : public StartStopBase<StartStopPass> {
       builder.create<mlir::func::CallOp>(entryPoint.getLoc(), "_dfr_start",
                                          mlir::TypeRange(),
                                          mlir::ValueRange({useDFRVal, ctx}));
+      // Reserve the task arena needed by the static task outputs
+      if (auto bytes =
+              entryPoint->getAttrOfType<IntegerAttr>("_dfr_task_arena_bytes")) {
+        Value bytesVal =
+            builder.create<arith::ConstantOp>(entryPoint.getLoc(), bytes);
+        auto reserveFunTy = mlir::FunctionType::get(
+            entryPoint->getContext(), {bytesVal.getType()}, {});
+        (void)insertForwardDeclaration(entryPoint, builder,
+                                       "_dfr_reserve_task_arena", reserveFunTy);
+        builder.create<mlir::func::CallOp>(entryPoint.getLoc(),
+                                           "_dfr_reserve_task_arena",
+                                           mlir::TypeRange(), bytesVal);
+      }
+      // Hint the remote nodes about the keys the tasks use, so that they
+      // start fetching them as soon as the task graph is being created
+      if (useDFR &&
+          ctx.getType().isa<mlir::concretelang::Concrete::ContextType>()) {
+        auto i64Ty = builder.getI64Type();
+        auto prefetchFunTy = mlir::FunctionType::get(
+            entryPoint->getContext(), {ctx.getType(), i64Ty, i64Ty}, {});
+        (void)insertForwardDeclaration(entryPoint, builder,
+                                       "_dfr_prefetch_key", prefetchFunTy);
+        for (auto key : keys) {
+          Value kind = builder.create<arith::ConstantOp>(
+              entryPoint.getLoc(), builder.getI64IntegerAttr(key.first));
+          Value index = builder.create<arith::ConstantOp>(
+              entryPoint.getLoc(), builder.getI64IntegerAttr(key.second));
+          builder.create<mlir::func::CallOp>(
+              entryPoint.getLoc(), "_dfr_prefetch_key", mlir::TypeRange(),
+              mlir::ValueRange({ctx, kind, index}));
+        }
+      }
       builder.setInsertionPoint(entryPoint.getBody().back().getTerminator());
       auto stopFunTy = mlir::FunctionType::get(entryPoint->getContext(),
                                                {useDFRVal.getType()}, {});
@@ -499,6 +559,107 @@ std::unique_ptr<mlir::Pass> createStartStopPass(bool debug) {
 }
 
 namespace {
+static void getAliasedUses(Value val, DenseSet<OpOperand *> &aliasedUses) {
+  for (auto &use : val.getUses()) {
+    aliasedUses.insert(&use);
+    if (dyn_cast<ViewLikeOpInterface>(use.getOwner()))
+      getAliasedUses(use.getOwner()->getResult(0), aliasedUses);
+  }
+}
+
+/// Whether the future made by `mrf` can take the ownership of its memref
+/// instead of a copy, i.e. if the memref is allocated in the same block
+/// and neither it nor its aliases are used after.
+static bool canPassOwnership(RT::MakeReadyFutureOp mrf) {
+  auto alloc = mrf.getOperand(0).getDefiningOp<mlir::memref::AllocOp>();
+  if (!alloc || alloc->getBlock() != mrf->getBlock() ||
+      alloc.getAlignment().has_value() ||
+      !alloc.getType().getLayout().isIdentity())
+    return false;
+  DenseSet<OpOperand *> aliasedUses;
+  getAliasedUses(alloc, aliasedUses);
+  for (auto use : aliasedUses) {
+    if (use->getOwner() == mrf)
+      continue;
+    Operation *user = mrf->getBlock()->findAncestorOpInBlock(*use->getOwner());
+    if (user == nullptr || !user->isBeforeInBlock(mrf))
+      return false;
+  }
+  return true;
+}
+
+/// Returns the work function of a task.
+static func::FuncOp getWorkFunction(RT::CreateAsyncTaskOp catOp) {
+  SymbolRefAttr sym =
+      catOp->getAttr("workfn").dyn_cast_or_null<SymbolRefAttr>();
+  assert(sym && "Work function symbol attribute missing.");
+  func::FuncOp workfn = dyn_cast_or_null<func::FuncOp>(
+      SymbolTable::lookupNearestSymbolFrom(catOp, sym));
+  assert(workfn && "Task work function missing.");
+  return workfn;
+}
+
+/// Returns the number of most significant bits of the mask elements of the
+/// ciphertexts of `val`, a work function argument or one of its aliases, the
+/// work function needs, or 0 if it needs them whole. Only the keyswitches
+/// need part of them, the level count times the base log.
+static uint64_t getKeyswitchedWireBits(Value val) {
+  uint64_t bits = 0;
+  for (auto &use : val.getUses()) {
+    Operation *user = use.getOwner();
+    uint64_t userBits = 0;
+    if (isa<RT::DerefWorkFunctionArgumentPtrPlaceholderOp,
+            ViewLikeOpInterface>(user))
+      userBits = getKeyswitchedWireBits(user->getResult(0));
+    else if (auto ks = dyn_cast<Concrete::KeySwitchLweBufferOp>(user))
+      userBits = use.get() == ks.getCiphertext()
+                     ? ks.getLevel() * ks.getBaseLog()
+                     : 0;
+    else if (auto ks = dyn_cast<Concrete::BatchedKeySwitchLweBufferOp>(user))
+      userBits = use.get() == ks.getCiphertext()
+                     ? ks.getLevel() * ks.getBaseLog()
+                     : 0;
+    if (userBits == 0 || userBits >= 64)
+      return 0;
+    bits = std::max(bits, userBits);
+  }
+  return bits;
+}
+
+/// Returns the number of most significant bits of the mask elements of the
+/// ciphertexts of the task operand `operand` that are sent between nodes, or
+/// 0 if they are sent whole. An input is used by the work function, an
+/// output by the tasks its future is passed to.
+static uint64_t getTaskOperandWireBits(RT::CreateAsyncTaskOp catOp,
+                                       unsigned operand) {
+  Value val = catOp.getOperand(operand);
+  auto brpp = val.getDefiningOp<RT::BuildReturnPtrPlaceholderOp>();
+  if (!brpp)
+    return getKeyswitchedWireBits(
+        getWorkFunction(catOp).getArgument(operand - 3));
+
+  uint64_t bits = 0;
+  for (Operation *user : brpp->getUsers()) {
+    if (user == catOp)
+      continue;
+    auto deref = dyn_cast<RT::DerefReturnPtrPlaceholderOp>(user);
+    if (!deref)
+      return 0;
+    for (auto &use : deref->getResult(0).getUses()) {
+      if (isa<RT::DeallocateFutureOp>(use.getOwner()))
+        continue;
+      auto consumer = dyn_cast<RT::CreateAsyncTaskOp>(use.getOwner());
+      if (!consumer || use.getOperandNumber() < 3)
+        return 0;
+      uint64_t consumerBits = getKeyswitchedWireBits(
+          getWorkFunction(consumer).getArgument(use.getOperandNumber() - 3));
+      if (consumerBits == 0)
+        return 0;
+      bits = std::max(bits, consumerBits);
+    }
+  }
+  return bits;
+}
 
 // For documentation see Autopar.td
 struct FinalizeTaskCreationPass
@@ -508,6 +669,16 @@ struct FinalizeTaskCreationPass
     auto module = getOperation();
     std::vector<Operation *> ops;
 
+    // The ciphertexts only keyswitched by the tasks consuming them are sent
+    // between nodes with the bits the keyswitches use. This is decided
+    // before the tasks are rewritten, as it looks at their consumers.
+    DenseMap<Operation *, SmallVector<uint64_t>> wireBits;
+    module.walk([&](RT::CreateAsyncTaskOp catOp) {
+      auto &bits = wireBits[catOp];
+      for (unsigned operand = 3; operand < catOp.getNumOperands(); ++operand)
+        bits.push_back(getTaskOperandWireBits(catOp, operand));
+    });
+
     module.walk([&](RT::CreateAsyncTaskOp catOp) {
       OpBuilder builder(catOp);
       SmallVector<Value, 4> operands;
@@ -516,10 +687,7 @@ struct FinalizeTaskCreationPass
       Value ctx = nullptr;
       SymbolRefAttr sym =
           catOp->getAttr("workfn").dyn_cast_or_null<SymbolRefAttr>();
-      assert(sym && "Work function symbol attribute missing.");
-      func::FuncOp workfn = dyn_cast_or_null<func::FuncOp>(
-          SymbolTable::lookupNearestSymbolFrom(catOp, sym));
-      assert(workfn && "Task work function missing.");
+      func::FuncOp workfn = getWorkFunction(catOp);
       if (workfn.getNumArguments() > catOp.getNumOperands() - 3)
         ctx = *catOp->getParentOfType<func::FuncOp>().getArguments().rbegin();
       else
@@ -536,7 +704,8 @@ struct FinalizeTaskCreationPass
         // and number outputs - nothing further to do.
         if (++index <= 3)
           continue;
-        auto op_size = getTaskArgumentSizeAndType(op, catOp.getLoc(), builder);
+        auto op_size = getTaskArgumentSizeAndType(
+            op, catOp.getLoc(), builder, wireBits[catOp][index - 4]);
         operands.push_back(op_size.first);
         operands.push_back(op_size.second);
       }
@@ -558,7 +727,12 @@ struct FinalizeTaskCreationPass
 
       Value val = op.getOperand(0);
       Value clone = op.getOperand(1);
-      if (val.getType().isa<mlir::MemRefType>()) {
+      if (val.getType().isa<mlir::MemRefType>() && canPassOwnership(op)) {
+        // The future frees the memref once it is no longer referenced
+        clone = builder.create<arith::ConstantOp>(op.getLoc(),
+                                                  builder.getI64IntegerAttr(1));
+        op->setOperand(1, clone);
+      } else if (val.getType().isa<mlir::MemRefType>()) {
         MemRefType mrType_base = val.getType().dyn_cast<mlir::MemRefType>();
         MemRefType mrType = mrType_base;
         if (!mrType_base.getLayout().isIdentity()) {
@@ -593,14 +767,6 @@ std::unique_ptr<mlir::Pass> createFinalizeTaskCreationPass(bool debug) {
 }
 
 namespace {
-static void getAliasedUses(Value val, DenseSet<OpOperand *> &aliasedUses) {
-  for (auto &use : val.getUses()) {
-    aliasedUses.insert(&use);
-    if (dyn_cast<ViewLikeOpInterface>(use.getOwner()))
-      getAliasedUses(use.getOwner()->getResult(0), aliasedUses);
-  }
-}
-
 // For documentation see Autopar.td
 struct FixupBufferDeallocationPass
     : public FixupBufferDeallocationBase<FixupBufferDeallocationPass> {
@@ -19,10 +19,13 @@
 #include <mlir/IR/BuiltinOps.h>
 
 #include <concretelang/Conversion/Utils/GenericOpTypeConversionPattern.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/StringExtras.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/Support/Compiler.h>
 #include <mlir/Analysis/DataFlowFramework.h>
 #include <mlir/Conversion/LLVMCommon/ConversionTarget.h>
+#include <mlir/Conversion/LLVMCommon/MemRefBuilder.h>
 #include <mlir/Conversion/LLVMCommon/Pattern.h>
 #include <mlir/Conversion/LLVMCommon/VectorPattern.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
@@ -35,6 +38,7 @@
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/BuiltinAttributes.h>
 #include <mlir/IR/IRMapping.h>
+#include <mlir/IR/Matchers.h>
 #include <mlir/IR/SymbolTable.h>
 #include <mlir/Pass/PassManager.h>
 #include <mlir/Support/LLVM.h>
@@ -165,6 +169,14 @@ struct CreateAsyncTaskOpInterfaceLowering
   matchAndRewrite(RT::CreateAsyncTaskOp catOp,
                   RT::CreateAsyncTaskOp::Adaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
+    // Tasks whose arguments have constant sizes and types, which is
+    // the case of all tasks generated by the dataflow lowering, are
+    // created from a static descriptor rather than through a variadic
+    // call the runtime needs to unpack.
+    SmallVector<int64_t, 16> desc;
+    if (getTaskDescriptor(catOp, desc))
+      return lowerWithDescriptor(catOp, adaptor, desc, rewriter);
+
     auto catFuncType =
         LLVM::LLVMFunctionType::get(getVoidType(), {}, /*isVariadic=*/true);
     auto catFuncOp = getOrInsertFuncOpDecl(catOp, "_dfr_create_async_task",
@@ -173,6 +185,127 @@ struct CreateAsyncTaskOpInterfaceLowering
                                               adaptor.getOperands());
     return success();
   }
+
+private:
+  // The operands are the work function, the context, the number of
+  // inputs and outputs, then a triplet of value, size and type for
+  // each output and each input.  Collects the numbers of inputs and
+  // outputs followed by the size and type pairs if they are constant.
+  static bool getTaskDescriptor(RT::CreateAsyncTaskOp catOp,
+                                SmallVectorImpl<int64_t> &desc) {
+    auto operands = catOp.getOperands();
+    APInt numIns, numOuts;
+    if (operands.size() < 4 ||
+        !matchPattern(operands[2], m_ConstantInt(&numIns)) ||
+        !matchPattern(operands[3], m_ConstantInt(&numOuts)))
+      return false;
+    size_t numArgs = numIns.getZExtValue() + numOuts.getZExtValue();
+    if (operands.size() != 4 + 3 * numArgs)
+      return false;
+    desc.push_back(numIns.getZExtValue());
+    desc.push_back(numOuts.getZExtValue());
+    for (size_t i = 0; i < numArgs; ++i) {
+      APInt size, type;
+      if (!matchPattern(operands[4 + 3 * i + 1], m_ConstantInt(&size)) ||
+          !matchPattern(operands[4 + 3 * i + 2], m_ConstantInt(&type)))
+        return false;
+      desc.push_back(size.getZExtValue());
+      desc.push_back(type.getZExtValue());
+    }
+    return true;
+  }
+
+  // Returns the internal constant holding `desc`, shared by all the
+  // task creations with the same descriptor.
+  LLVM::GlobalOp
+  getOrInsertDescriptor(RT::CreateAsyncTaskOp catOp, ArrayRef<int64_t> desc,
+                        ConversionPatternRewriter &rewriter) const {
+    auto module = catOp->getParentOfType<ModuleOp>();
+    auto i64Type = rewriter.getI64Type();
+    auto value = DenseElementsAttr::get(
+        RankedTensorType::get({(int64_t)desc.size()}, i64Type), desc);
+    std::string base =
+        "_dfr_task_descriptor_" +
+        llvm::utohexstr(llvm::hash_combine_range(desc.begin(), desc.end()));
+    std::string name = base;
+    for (unsigned suffix = 0;; ++suffix) {
+      auto global = module.lookupSymbol<LLVM::GlobalOp>(name);
+      if (!global)
+        break;
+      if (global.getValueAttr() == value)
+        return global;
+      name = base + "_" + std::to_string(suffix);
+    }
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPointToStart(module.getBody());
+    return rewriter.create<LLVM::GlobalOp>(
+        catOp.getLoc(), LLVM::LLVMArrayType::get(i64Type, desc.size()),
+        /*isConstant=*/true, LLVM::Linkage::Internal, name, value);
+  }
+
+  // Stores `values` in a stack allocated array of pointers.
+  Value buildPointerArray(Location loc, ValueRange values,
+                          ConversionPatternRewriter &rewriter) const {
+    auto ptrType = getVoidPtrI64Type(rewriter);
+    auto arrayType = mlir::LLVM::LLVMPointerType::get(ptrType);
+    if (values.empty())
+      return rewriter.create<LLVM::NullOp>(loc, arrayType);
+    auto i64Type = rewriter.getI64Type();
+    Value count = rewriter.create<LLVM::ConstantOp>(
+        loc, i64Type, rewriter.getI64IntegerAttr(values.size()));
+    Value array = rewriter.create<LLVM::AllocaOp>(loc, arrayType, count, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+      Value index = rewriter.create<LLVM::ConstantOp>(
+          loc, i64Type, rewriter.getI64IntegerAttr(i));
+      Value slot = rewriter.create<LLVM::GEPOp>(loc, arrayType, array, index);
+      Value ptr = rewriter.create<LLVM::BitcastOp>(loc, ptrType, values[i]);
+      rewriter.create<LLVM::StoreOp>(loc, ptr, slot);
+    }
+    return array;
+  }
+
+  mlir::LogicalResult
+  lowerWithDescriptor(RT::CreateAsyncTaskOp catOp,
+                      RT::CreateAsyncTaskOp::Adaptor adaptor,
+                      ArrayRef<int64_t> desc,
+                      ConversionPatternRewriter &rewriter) const {
+    auto loc = catOp.getLoc();
+    auto ptrType = getVoidPtrI64Type(rewriter);
+    auto arrayType = mlir::LLVM::LLVMPointerType::get(ptrType);
+    auto operands = adaptor.getOperands();
+    size_t numIns = desc[0];
+    size_t numOuts = desc[1];
+    SmallVector<Value, 4> outputs, params;
+    for (size_t i = 0; i < numOuts; ++i)
+      outputs.push_back(operands[4 + 3 * i]);
+    for (size_t i = numOuts; i < numOuts + numIns; ++i)
+      params.push_back(operands[4 + 3 * i]);
+
+    auto catFuncType = LLVM::LLVMFunctionType::get(
+        getVoidType(), {operands[0].getType(), operands[1].getType(), ptrType,
+                        arrayType, arrayType});
+    auto catFuncOp = getOrInsertFuncOpDecl(
+        catOp, "_dfr_create_async_task_desc", catFuncType, rewriter);
+    if (!catFuncOp)
+      return failure();
+
+    Value descPtr = rewriter.create<LLVM::BitcastOp>(
+        loc, ptrType,
+        rewriter.create<LLVM::AddressOfOp>(
+            loc, getOrInsertDescriptor(catOp, desc, rewriter)));
+    // The arrays are copied by the runtime before the call returns, so
+    // that their stack space can be released right after it.
+    Value stack = rewriter.create<LLVM::StackSaveOp>(
+        loc, mlir::LLVM::LLVMPointerType::get(rewriter.getI8Type()));
+    Value outputsPtr = buildPointerArray(loc, outputs, rewriter);
+    Value paramsPtr = buildPointerArray(loc, params, rewriter);
+    rewriter.create<LLVM::CallOp>(
+        loc, catFuncOp,
+        ValueRange{operands[0], operands[1], descPtr, outputsPtr, paramsPtr});
+    rewriter.create<LLVM::StackRestoreOp>(loc, stack);
+    rewriter.eraseOp(catOp);
+    return success();
+  }
 };
 struct RegisterTaskWorkFunctionOpInterfaceLowering
     : public ConvertOpToLLVMPattern<RT::RegisterTaskWorkFunctionOp> {
@@ -303,6 +436,41 @@ struct WorkFunctionReturnOpInterfaceLowering
     return success();
   }
 };
+/// Allocates the task outputs marked by BufferizeDataflowTaskOps in the
+/// task arena instead of with malloc. These are never deallocated in the
+/// generated code, but released with their future by the runtime.
+struct ArenaAllocOpLowering
+    : public ConvertOpToLLVMPattern<mlir::memref::AllocOp> {
+  using ConvertOpToLLVMPattern<mlir::memref::AllocOp>::ConvertOpToLLVMPattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::memref::AllocOp allocOp,
+                  mlir::memref::AllocOp::Adaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    MemRefType type = allocOp.getType();
+    if (!allocOp->hasAttr("_dfr_arena") || !type.hasStaticShape())
+      return failure();
+
+    SmallVector<Value, 4> sizes;
+    SmallVector<Value, 4> strides;
+    Value sizeBytes;
+    getMemRefDescriptorSizes(allocOp.getLoc(), type, {}, rewriter, sizes,
+                             strides, sizeBytes);
+    auto allocFuncType = LLVM::LLVMFunctionType::get(
+        getVoidPtrType(), {getIndexType()}, /*isVariadic=*/false);
+    auto allocFuncOp = getOrInsertFuncOpDecl(allocOp, "_dfr_arena_alloc",
+                                             allocFuncType, rewriter);
+    auto call =
+        rewriter.create<LLVM::CallOp>(allocOp.getLoc(), allocFuncOp, sizeBytes);
+    Value ptr = rewriter.create<LLVM::BitcastOp>(
+        allocOp.getLoc(), getElementPtrType(type), call.getResult());
+    rewriter.replaceOp(allocOp,
+                       {MemRefDescriptor::fromStaticShape(
+                           rewriter, allocOp.getLoc(), *getTypeConverter(),
+                           type, ptr)});
+    return success();
+  }
+};
 } // end anonymous namespace
 } // namespace concretelang
 } // namespace mlir
@@ -322,4 +490,6 @@ void mlir::concretelang::populateRTToLLVMConversionPatterns(
     DeallocateFutureDataOpInterfaceLowering,
     WorkFunctionReturnOpInterfaceLowering>(converter);
   // clang-format on
+  // Takes precedence over the lowering of memref.alloc to malloc
+  patterns.add<ArenaAllocOpLowering>(converter, /*benefit=*/2);
 }
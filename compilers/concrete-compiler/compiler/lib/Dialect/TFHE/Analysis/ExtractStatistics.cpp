@@ -40,6 +40,10 @@ struct ExtractTFHEStatisticsPass
   ProgramCompilationFeedback &feedback;
   CircuitCompilationFeedback *circuitFeedback;
 
+  /// The number of bootstraps on the longest path from the inputs to each
+  /// value, the iterations of the loops being considered independent.
+  llvm::DenseMap<mlir::Value, int64_t> depths;
+
   ExtractTFHEStatisticsPass(ProgramCompilationFeedback &feedback)
       : feedback{feedback}, circuitFeedback{nullptr} {};
 
@@ -53,6 +57,7 @@ struct ExtractTFHEStatisticsPass
       });
       assert(funcOp != funcs.end());
       this->circuitFeedback = &circuitFeedback;
+      this->depths.clear();
 
       WalkResult walk =
           (*funcOp)->walk([&](Operation *op, const WalkStage &stage) {
@@ -82,12 +87,34 @@ struct ExtractTFHEStatisticsPass
     }
   }
 
+  int64_t operandsDepth(mlir::Operation *op) {
+    int64_t depth = 0;
+    for (mlir::Value operand : op->getOperands())
+      depth = std::max(depth, depths.lookup(operand));
+    return depth;
+  }
+
+  /// Returns the depth of the bootstrap `op`, which is also the one of its
+  /// results.
+  int64_t bootstrapDepth(mlir::Operation *op) {
+    int64_t depth = operandsDepth(op) + 1;
+    for (mlir::Value result : op->getResults())
+      depths[result] = depth;
+    return depth;
+  }
+
   std::optional<StringError> enter(mlir::Operation *op) {
+    // By default, the results are as deep as the deepest operand
+    int64_t depth = operandsDepth(op);
+    for (mlir::Value result : op->getResults())
+      depths[result] = depth;
+
     DISPATCH_ENTER(scf::ForOp)
     DISPATCH_ENTER(TFHE::AddGLWEOp)
     DISPATCH_ENTER(TFHE::AddGLWEIntOp)
     DISPATCH_ENTER(TFHE::BootstrapGLWEOp)
     DISPATCH_ENTER(TFHE::KeySwitchGLWEOp)
+    DISPATCH_ENTER(TFHE::ManyLutBootstrapGLWEOp)
     DISPATCH_ENTER(TFHE::MulGLWEIntOp)
     DISPATCH_ENTER(TFHE::NegGLWEOp)
     DISPATCH_ENTER(TFHE::SubGLWEIntOp)
@@ -110,6 +137,9 @@ struct ExtractTFHEStatisticsPass
 
     pass.pushTripCount(op, tripCount);
 
+    for (auto [arg, init] : llvm::zip(op.getRegionIterArgs(), op.getInitArgs()))
+      pass.depths[arg] = pass.depths.lookup(init);
+
     return std::nullopt;
   }
 
@@ -118,6 +148,13 @@ struct ExtractTFHEStatisticsPass
     std::optional<int64_t> tripCount = tryGetStaticTripCount(op);
     pass.popTripCount(op, tripCount);
 
+    auto yield = op.getBody()->getTerminator();
+    for (auto [result, value] :
+         llvm::zip(op.getResults(), yield->getOperands())) {
+      pass.depths[result] =
+          std::max(pass.depths[result], pass.depths.lookup(value));
+    }
+
     return std::nullopt;
   }
 
@@ -187,6 +224,37 @@ struct ExtractTFHEStatisticsPass
     auto operation = PrimitiveOperation::PBS;
     auto keys = std::vector<std::pair<KeyType, int64_t>>();
     auto count = pass.getTripCount();
+    int64_t depth = pass.bootstrapDepth(op);
+
+    std::pair<KeyType, int64_t> key =
+        std::make_pair(KeyType::BOOTSTRAP, (int64_t)bsk.getIndex());
+    keys.push_back(key);
+
+    pass.circuitFeedback->statistics.push_back(concretelang::Statistic{
+        location,
+        operation,
+        keys,
+        count,
+        depth,
+    });
+
+    return std::nullopt;
+  }
+
+  // ############################
+  // TFHE.many_lut_bootstrap_glwe
+  // ############################
+
+  static std::optional<StringError> on_enter(TFHE::ManyLutBootstrapGLWEOp &op,
+                                             ExtractTFHEStatisticsPass &pass) {
+    auto bsk = op.getKey();
+
+    auto location = locationString(op.getLoc());
+    // All the tables are computed by a single bootstrap
+    auto operation = PrimitiveOperation::PBS;
+    auto keys = std::vector<std::pair<KeyType, int64_t>>();
+    auto count = pass.getTripCount();
+    int64_t depth = pass.bootstrapDepth(op);
 
     std::pair<KeyType, int64_t> key =
         std::make_pair(KeyType::BOOTSTRAP, (int64_t)bsk.getIndex());
@@ -197,6 +265,7 @@ struct ExtractTFHEStatisticsPass
         operation,
         keys,
         count,
+        depth,
     });
 
     return std::nullopt;
@@ -214,6 +283,8 @@ struct ExtractTFHEStatisticsPass
     auto operation = PrimitiveOperation::KEY_SWITCH;
     auto keys = std::vector<std::pair<KeyType, int64_t>>();
     auto count = pass.getTripCount();
+    // The keyswitch counts with the bootstrap it feeds
+    int64_t depth = pass.operandsDepth(op) + 1;
 
     std::pair<KeyType, int64_t> key =
         std::make_pair(KeyType::KEY_SWITCH, (int64_t)ksk.getIndex());
@@ -224,6 +295,7 @@ struct ExtractTFHEStatisticsPass
         operation,
         keys,
         count,
+        depth,
     });
 
     return std::nullopt;
@@ -334,6 +406,7 @@ struct ExtractTFHEStatisticsPass
     auto operation = PrimitiveOperation::WOP_PBS;
     auto keys = std::vector<std::pair<KeyType, int64_t>>();
     auto count = pass.getTripCount();
+    int64_t depth = pass.bootstrapDepth(op);
 
     std::pair<KeyType, int64_t> key =
         std::make_pair(KeyType::BOOTSTRAP, (int64_t)bsk.getIndex());
@@ -350,6 +423,7 @@ struct ExtractTFHEStatisticsPass
         operation,
         keys,
         count,
+        depth,
     });
 
     return std::nullopt;
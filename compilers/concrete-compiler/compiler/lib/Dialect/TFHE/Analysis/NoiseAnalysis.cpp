@@ -0,0 +1,343 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <cmath>
+#include <limits>
+
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Matchers.h>
+#include <mlir/IR/Operation.h>
+
+#include "concrete-cpu-noise-model.h"
+#include <concretelang/Analysis/StaticLoops.h>
+#include <concretelang/Dialect/TFHE/Analysis/NoiseAnalysis.h>
+#include <concretelang/Dialect/TFHE/IR/TFHEOps.h>
+
+namespace mlir {
+namespace concretelang {
+namespace TFHE {
+
+namespace {
+
+const double infinity = std::numeric_limits<double>::infinity();
+
+/// The noise of a ciphertext, or the largest one of a tensor, and the
+/// probability that a bootstrap of its history, or of any of the history of
+/// the elements of a tensor, went wrong.
+struct Noise {
+  double variance = 0;
+  double pError = 0;
+};
+
+double unionProbability(double p, double q) { return p + q - p * q; }
+
+/// The probability that a centered gaussian of `variance` exceeds
+/// `halfStep`, i.e. that a message decrypts or bootstraps to its neighbour.
+double errorProbability(double variance, double halfStep) {
+  return std::erfc(halfStep / std::sqrt(2 * variance));
+}
+
+/// The half of the distance between two messages of `precision` bits, with a
+/// bit of padding, on the torus.
+double halfStep(uint64_t precision) {
+  return std::exp2(-(double)precision - 2);
+}
+
+bool isCiphertext(mlir::Type type) {
+  if (auto shaped = type.dyn_cast<mlir::ShapedType>())
+    type = shaped.getElementType();
+  return type.isa<TFHE::GLWECipherTextType>();
+}
+
+/// The largest absolute value of the cleartext `value`, if it is a constant
+/// or an element of a constant tensor.
+std::optional<double> maxAbsCleartext(mlir::Value value) {
+  llvm::APInt constant;
+  if (matchPattern(value, m_ConstantInt(&constant)))
+    return std::abs((double)constant.getSExtValue());
+  auto extract = value.getDefiningOp<mlir::tensor::ExtractOp>();
+  if (!extract)
+    return std::nullopt;
+  mlir::DenseIntElementsAttr elements;
+  if (!matchPattern(extract.getTensor(), m_Constant(&elements)))
+    return std::nullopt;
+  double max = 0;
+  for (llvm::APInt element : elements)
+    max = std::max(max, std::abs((double)element.getSExtValue()));
+  return max;
+}
+
+/// The number of bits of the messages bootstrapped with `lut`, the size of
+/// the table before its expansion, or the expanded one if it is not known,
+/// which overestimates the error probability.
+uint64_t lookupPrecision(mlir::Value lut) {
+  auto log2Size = [](int64_t size) {
+    return (uint64_t)std::ceil(std::log2((double)std::max<int64_t>(size, 2)));
+  };
+  if (auto encode = lut.getDefiningOp<TFHE::EncodeExpandLutForBootstrapOp>())
+    lut = encode.getInputLookupTable();
+  if (auto encode =
+          lut.getDefiningOp<TFHE::EncodeExpandManyLutForBootstrapOp>()) {
+    // The tables share the message space of a single bootstrap
+    auto shape =
+        encode.getInputLookupTables().getType().cast<mlir::ShapedType>();
+    return log2Size(shape.getDimSize(0)) + log2Size(shape.getDimSize(1));
+  }
+  auto shape = lut.getType().cast<mlir::ShapedType>();
+  return shape.hasStaticShape() ? log2Size(shape.getNumElements()) : 64;
+}
+
+struct TFHENoiseAnalysisPass
+    : public PassWrapper<TFHENoiseAnalysisPass, OperationPass<ModuleOp>> {
+
+  ProgramCompilationFeedback &feedback;
+  const Message<concreteprotocol::ProgramInfo> &info;
+  uint32_t fftPrecision;
+
+  llvm::DenseMap<mlir::Value, Noise> noises;
+
+  TFHENoiseAnalysisPass(ProgramCompilationFeedback &feedback,
+                        const Message<concreteprotocol::ProgramInfo> &info,
+                        uint32_t fftPrecision)
+      : feedback{feedback}, info{info}, fftPrecision{fftPrecision} {};
+
+  void runOnOperation() override {
+    auto module = getOperation();
+    auto funcs = module.getOps<mlir::func::FuncOp>();
+    for (CircuitCompilationFeedback &circuitFeedback :
+         feedback.circuitFeedbacks) {
+      auto funcOp = llvm::find_if(funcs, [&](mlir::func::FuncOp op) {
+        return op.getName() == circuitFeedback.name;
+      });
+      auto circuits = info.asReader().getCircuits();
+      auto circuit = llvm::find_if(circuits, [&](auto circuit) {
+        return circuit.getName().cStr() == circuitFeedback.name;
+      });
+      assert(funcOp != funcs.end() && circuit != circuits.end());
+      noises.clear();
+      analyze(*funcOp, *circuit, circuitFeedback);
+    }
+  }
+
+  void analyze(mlir::func::FuncOp func,
+               concreteprotocol::CircuitInfo::Reader circuit,
+               CircuitCompilationFeedback &circuitFeedback) {
+    auto inputs = circuit.getInputs();
+    for (size_t i = 0; i < func.getNumArguments() && i < inputs.size(); i++) {
+      auto typeInfo = inputs[i].getTypeInfo();
+      if (typeInfo.hasLweCiphertext())
+        noises[func.getArgument(i)].variance =
+            typeInfo.getLweCiphertext().getEncryption().getVariance();
+    }
+
+    func->walk([&](Operation *op, const WalkStage &stage) {
+      if (op == func.getOperation())
+        return;
+      if (stage.isBeforeAllRegions())
+        enter(op);
+      if (stage.isAfterAllRegions())
+        exit(op);
+    });
+
+    circuitFeedback.outputErrorProbabilities.clear();
+    auto outputs = circuit.getOutputs();
+    func.walk([&](mlir::func::ReturnOp ret) {
+      for (size_t i = 0; i < ret.getNumOperands(); i++) {
+        if (i >= outputs.size())
+          break;
+        Noise noise = noises.lookup(ret.getOperand(i));
+        double pError = noise.pError;
+        auto typeInfo = outputs[i].getTypeInfo();
+        if (typeInfo.hasLweCiphertext() &&
+            typeInfo.getLweCiphertext().getEncoding().hasInteger() &&
+            typeInfo.getLweCiphertext()
+                .getEncoding()
+                .getInteger()
+                .getMode()
+                .hasNative()) {
+          auto ciphertext = typeInfo.getLweCiphertext();
+          double elements = 1;
+          for (auto dim : ciphertext.getAbstractShape().getDimensions()) {
+            // A dynamic dimension counts for a single element
+            if (dim != concretelang::protocol::DYNAMIC_DIMENSION)
+              elements *= dim;
+          }
+          double pDecryption = errorProbability(
+              noise.variance,
+              halfStep(ciphertext.getEncoding().getInteger().getWidth()));
+          pError = unionProbability(
+              pError, -std::expm1(elements * std::log1p(-pDecryption)));
+        }
+        circuitFeedback.outputErrorProbabilities.push_back(pError);
+      }
+    });
+  }
+
+  /// The noise of the ciphertext operands, the largest variance and any of
+  /// the errors.
+  Noise operandsNoise(mlir::Operation *op) {
+    Noise noise;
+    for (mlir::Value operand : op->getOperands()) {
+      if (!isCiphertext(operand.getType()))
+        continue;
+      Noise operandNoise = noises.lookup(operand);
+      noise.variance = std::max(noise.variance, operandNoise.variance);
+      noise.pError = unionProbability(noise.pError, operandNoise.pError);
+    }
+    return noise;
+  }
+
+  /// Sets the noise of the ciphertext results of `op`.
+  void setResults(mlir::Operation *op, Noise noise) {
+    for (mlir::Value result : op->getResults())
+      if (isCiphertext(result.getType()))
+        noises[result] = noise;
+  }
+
+  /// Returns the noise of a bootstrap of `ciphertext` with `bsk` on
+  /// messages of `precision` bits.
+  Noise bootstrap(mlir::Value ciphertext, TFHE::GLWEBootstrapKeyAttr bsk,
+                  uint64_t precision) {
+    Noise input = noises.lookup(ciphertext);
+    auto params =
+        info.asReader().getKeyset().getLweBootstrapKeys()[bsk.getIndex()]
+            .getParams();
+    double modulusSwitching =
+        concrete_cpu_estimate_modulus_switching_noise_with_binary_key(
+            params.getInputLweDimension(),
+            std::log2(params.getPolynomialSize()), 64);
+    double pBootstrap = errorProbability(input.variance + modulusSwitching,
+                                         halfStep(precision));
+    Noise noise;
+    noise.pError = unionProbability(input.pError, pBootstrap);
+    noise.variance =
+        (params.getGroupingFactor() > 1)
+            ? concrete_cpu_variance_multi_bit_blind_rotate(
+                  params.getInputLweDimension(), params.getGlweDimension(),
+                  params.getPolynomialSize(), params.getBaseLog(),
+                  params.getLevelCount(), 64, fftPrecision,
+                  params.getVariance(), params.getGroupingFactor(), false)
+            : concrete_cpu_variance_blind_rotate(
+                  params.getInputLweDimension(), params.getGlweDimension(),
+                  params.getPolynomialSize(), params.getBaseLog(),
+                  params.getLevelCount(), 64, fftPrecision,
+                  params.getVariance());
+    return noise;
+  }
+
+  void enter(mlir::Operation *op) {
+    if (auto forOp = llvm::dyn_cast<scf::ForOp>(op)) {
+      for (auto [arg, init] :
+           llvm::zip(forOp.getRegionIterArgs(), forOp.getInitArgs()))
+        noises[arg] = noises.lookup(init);
+      return;
+    }
+    if (op->getNumRegions() > 0) {
+      // The arguments of the other regions, e.g. the elements of a generic,
+      // are as noisy as the noisiest operand
+      Noise noise = operandsNoise(op);
+      for (mlir::Region &region : op->getRegions())
+        for (mlir::BlockArgument arg : region.getArguments())
+          if (isCiphertext(arg.getType()))
+            noises[arg] = noise;
+      return;
+    }
+
+    Noise noise = operandsNoise(op);
+    if (auto add = llvm::dyn_cast<TFHE::AddGLWEOp>(op)) {
+      noise.variance = noises.lookup(add.getA()).variance +
+                       noises.lookup(add.getB()).variance;
+    } else if (auto mul = llvm::dyn_cast<TFHE::MulGLWEIntOp>(op)) {
+      std::optional<double> cleartext = maxAbsCleartext(mul.getB());
+      noise.variance = cleartext.has_value()
+                           ? noise.variance * *cleartext * *cleartext
+                           : infinity;
+    } else if (auto ks = llvm::dyn_cast<TFHE::KeySwitchGLWEOp>(op)) {
+      // The fast keyswitches are estimated as the classical ones
+      auto params = info.asReader()
+                        .getKeyset()
+                        .getLweKeyswitchKeys()[ks.getKey().getIndex()]
+                        .getParams();
+      noise.variance += concrete_cpu_variance_keyswitch(
+          params.getInputLweDimension(), params.getBaseLog(),
+          params.getLevelCount(), 64, params.getVariance());
+    } else if (auto bs = llvm::dyn_cast<TFHE::BootstrapGLWEOp>(op)) {
+      noise = bootstrap(bs.getCiphertext(), bs.getKey(),
+                        lookupPrecision(bs.getLookupTable()));
+    } else if (auto bs = llvm::dyn_cast<TFHE::ManyLutBootstrapGLWEOp>(op)) {
+      noise = bootstrap(bs.getCiphertext(), bs.getKey(),
+                        lookupPrecision(bs.getLookupTable()));
+    } else if (llvm::isa<TFHE::WopPBSGLWEOp>(op)) {
+      // Not modeled, reported as always failing
+      noise = {infinity, 1};
+    }
+    setResults(op, noise);
+  }
+
+  void exit(mlir::Operation *op) {
+    if (auto forOp = llvm::dyn_cast<scf::ForOp>(op)) {
+      // The loop carried values accumulate the noise of an iteration once per
+      // iteration
+      std::optional<int64_t> tripCount = tryGetStaticTripCount(forOp);
+      if (!tripCount.has_value())
+        emitWarning(op->getLoc(), "Cannot determine static trip count, the "
+                                  "noise of the loop is unbounded");
+      auto yield = forOp.getBody()->getTerminator();
+      for (auto [result, init, value] : llvm::zip(
+               forOp.getResults(), forOp.getInitArgs(), yield->getOperands())) {
+        if (!isCiphertext(result.getType()))
+          continue;
+        Noise initNoise = noises.lookup(init);
+        Noise iteration = noises.lookup(value);
+        if (!tripCount.has_value() || initNoise.pError >= 1) {
+          noises[result] = {infinity, 1};
+          continue;
+        }
+        double growth = std::max(iteration.variance - initNoise.variance, 0.);
+        double success = (1 - iteration.pError) / (1 - initNoise.pError);
+        Noise noise;
+        noise.variance = initNoise.variance + *tripCount * growth;
+        noise.pError = -std::expm1(std::log1p(-initNoise.pError) +
+                                   *tripCount * std::log(success));
+        noises[result] = noise;
+      }
+      return;
+    }
+    if (op->getNumRegions() == 0)
+      return;
+    // The results of the other regions are as noisy as any ciphertext of
+    // their body
+    Noise noise = operandsNoise(op);
+    op->walk([&](mlir::Operation *nested) {
+      for (mlir::Value result : nested->getResults()) {
+        if (!isCiphertext(result.getType()))
+          continue;
+        Noise nestedNoise = noises.lookup(result);
+        noise.variance = std::max(noise.variance, nestedNoise.variance);
+        noise.pError = std::max(noise.pError, nestedNoise.pError);
+      }
+    });
+    setResults(op, noise);
+  }
+};
+
+} // namespace
+
+} // namespace TFHE
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createNoiseAnalysisPass(ProgramCompilationFeedback &feedback,
+                        const Message<concreteprotocol::ProgramInfo> &info,
+                        uint32_t fftPrecision) {
+  return std::make_unique<TFHE::TFHENoiseAnalysisPass>(feedback, info,
+                                                       fftPrecision);
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -135,6 +135,36 @@ mlir::LogicalResult EncodeExpandLutForBootstrapOp::verify() {
   return mlir::success();
 }
 
+mlir::LogicalResult EncodeExpandManyLutForBootstrapOp::verify() {
+  mlir::IntegerAttr polySizeAttr = this->getPolySizeAttr();
+
+  mlir::RankedTensorType rtt =
+      this->getResult().getType().template cast<mlir::RankedTensorType>();
+  mlir::RankedTensorType lutsRtt =
+      this->getInputLookupTables().getType().cast<mlir::RankedTensorType>();
+
+  if (rtt.getNumElements() != polySizeAttr.getInt()) {
+    this->emitError("The number of elements of the output tensor of ")
+        << rtt.getNumElements()
+        << " does not match the size of the polynomial of "
+        << polySizeAttr.getInt();
+
+    return mlir::failure();
+  }
+
+  // Each entry of a table spreads over a box holding one coefficient per
+  // table on each side of its center.
+  if (lutsRtt.getNumElements() * 2 > polySizeAttr.getInt()) {
+    this->emitError("The polynomial of size ")
+        << polySizeAttr.getInt() << " cannot pack " << lutsRtt.getShape()[0]
+        << " lookup tables of " << lutsRtt.getShape()[1] << " elements";
+
+    return mlir::failure();
+  }
+
+  return mlir::success();
+}
+
 template <typename BootstrapOpT>
 mlir::LogicalResult verifyBootstrapSingleLUTConstraints(BootstrapOpT &op) {
   GLWEBootstrapKeyAttr keyAttr = op.getKeyAttr();
@@ -165,6 +195,17 @@ mlir::LogicalResult BootstrapGLWEOp::verify() {
   return verifyBootstrapSingleLUTConstraints(*this);
 }
 
+mlir::LogicalResult ManyLutBootstrapGLWEOp::verify() {
+  size_t count = this->getResults().size();
+  if (count == 0 || (count & (count - 1)) != 0) {
+    this->emitError("Number of results of ")
+        << count << " is not a power of two";
+
+    return mlir::failure();
+  }
+  return verifyBootstrapSingleLUTConstraints(*this);
+}
+
 mlir::LogicalResult BatchedBootstrapGLWEOp::verify() {
   return verifyBootstrapSingleLUTConstraints(*this);
 }
@@ -3,14 +3,25 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/SetVector.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Tensor/IR/Tensor.h>
+#include <mlir/IR/Dominance.h>
+#include <mlir/IR/Matchers.h>
 #include <mlir/IR/PatternMatch.h>
+#include <mlir/Interfaces/LoopLikeInterface.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <mlir/Transforms/RegionUtils.h>
 
 #include <concretelang/Dialect/TFHE/IR/TFHEOps.h>
 #include <concretelang/Dialect/TFHE/Transforms/Transforms.h>
 #include <concretelang/Support/Constants.h>
 
+#include <set>
+
 namespace mlir {
 namespace concretelang {
 
@@ -79,11 +90,751 @@ public:
   }
 };
 
+/// For documentation see Transforms.td
+class TFHEKeyswitchSharingPass
+    : public TFHEKeyswitchSharingBase<TFHEKeyswitchSharingPass> {
+public:
+  void runOnOperation() override {
+    // Keyswitches are identical if they apply the same key to the same
+    // ciphertext.
+    typedef std::pair<mlir::Value, mlir::Attribute> Key;
+    llvm::DenseMap<Key, llvm::SmallVector<TFHE::KeySwitchGLWEOp>> seen;
+    llvm::SmallVector<TFHE::KeySwitchGLWEOp> shared;
+    auto &dominance = getAnalysis<mlir::DominanceInfo>();
+
+    // Operations are walked in program order, so that the keyswitches
+    // dominating a keyswitch are seen before it.
+    getOperation()->walk<mlir::WalkOrder::PreOrder>(
+        [&](TFHE::KeySwitchGLWEOp ksOp) {
+          auto &candidates = seen[{ksOp.getCiphertext(), ksOp.getKeyAttr()}];
+          for (auto candidate : candidates) {
+            if (candidate.getType() == ksOp.getType() &&
+                dominance.properlyDominates(candidate.getOperation(), ksOp)) {
+              ksOp.getResult().replaceAllUsesWith(candidate.getResult());
+              shared.push_back(ksOp);
+              return;
+            }
+          }
+          candidates.push_back(ksOp);
+        });
+
+    for (auto ksOp : shared)
+      ksOp->erase();
+    numSharedKeyswitches += shared.size();
+  }
+};
+
+/// For documentation see Transforms.td
+class TFHEWopPBSSharingPass
+    : public TFHEWopPBSSharingBase<TFHEWopPBSSharingPass> {
+public:
+  void runOnOperation() override {
+    auto &dominance = getAnalysis<mlir::DominanceInfo>();
+    llvm::SmallVector<llvm::SmallVector<TFHE::WopPBSGLWEOp>> groups;
+    getOperation()->walk([&](mlir::Block *block) {
+      llvm::SmallVector<llvm::SmallVector<TFHE::WopPBSGLWEOp>> blockGroups;
+      for (auto wopOp : block->getOps<TFHE::WopPBSGLWEOp>()) {
+        auto group = llvm::find_if(blockGroups, [&](auto &group) {
+          return canShare(group.front(), wopOp, dominance);
+        });
+        if (group == blockGroups.end()) {
+          blockGroups.push_back({wopOp});
+          continue;
+        }
+        // The merged wop pbs replaces the first one, which the lookup table
+        // of the others must then dominate
+        mlir::Value lut = wopOp.getLookupTable();
+        if (!dominance.properlyDominates(lut, group->front()))
+          lut.getDefiningOp()->moveBefore(group->front());
+        group->push_back(wopOp);
+      }
+      for (auto &group : blockGroups)
+        if (group.size() > 1)
+          groups.push_back(group);
+    });
+
+    for (auto &group : groups)
+      merge(group);
+  }
+
+private:
+  /// Returns whether `wopOp` can be evaluated by the merged wop pbs replacing
+  /// `first`, i.e. whether it bootstraps the same ciphertexts with the same
+  /// parameters and its lookup table is, or can be moved, before `first`.
+  static bool canShare(TFHE::WopPBSGLWEOp first, TFHE::WopPBSGLWEOp wopOp,
+                       mlir::DominanceInfo &dominance) {
+    auto resultTy = first.getType().dyn_cast<mlir::RankedTensorType>();
+    if (!resultTy || resultTy.getRank() != 1 ||
+        wopOp.getCiphertexts() != first.getCiphertexts() ||
+        wopOp.getType() != first.getType() ||
+        wopOp.getLookupTable().getType() != first.getLookupTable().getType() ||
+        wopOp.getKskAttr() != first.getKskAttr() ||
+        wopOp.getBskAttr() != first.getBskAttr() ||
+        wopOp.getPkskAttr() != first.getPkskAttr() ||
+        wopOp.getCrtDecompositionAttr() != first.getCrtDecompositionAttr() ||
+        wopOp.getCbsLevelsAttr() != first.getCbsLevelsAttr() ||
+        wopOp.getCbsBaseLogAttr() != first.getCbsBaseLogAttr())
+      return false;
+    mlir::Value lut = wopOp.getLookupTable();
+    if (dominance.properlyDominates(lut, first))
+      return true;
+    // Only the pure operation computing the lookup table, e.g. its encoding,
+    // is moved
+    mlir::Operation *lutOp = lut.getDefiningOp();
+    return lutOp && lutOp->getBlock() == first->getBlock() &&
+           mlir::isPure(lutOp) && lutOp->getNumRegions() == 0 &&
+           llvm::all_of(lutOp->getOperands(), [&](mlir::Value operand) {
+             return dominance.properlyDominates(operand, first);
+           });
+  }
+
+  /// Replaces the wop pbs of `group` by a single one evaluating all their
+  /// lookup tables, so that the bits of the ciphertexts are extracted and
+  /// circuit bootstrapped once for all of them.
+  void merge(llvm::ArrayRef<TFHE::WopPBSGLWEOp> group) {
+    TFHE::WopPBSGLWEOp first = group.front();
+    mlir::OpBuilder builder(first);
+    mlir::Location loc = first.getLoc();
+    auto resultTy = first.getType().cast<mlir::RankedTensorType>();
+    auto lutTy =
+        first.getLookupTable().getType().cast<mlir::RankedTensorType>();
+    int64_t blocks = resultTy.getDimSize(0);
+    int64_t count = group.size();
+
+    // The lookup tables are stacked, one per output block
+    mlir::Value luts = builder.create<mlir::tensor::EmptyOp>(
+        loc,
+        llvm::ArrayRef<int64_t>{count * lutTy.getDimSize(0),
+                                lutTy.getDimSize(1)},
+        lutTy.getElementType());
+    for (int64_t i = 0; i < count; i++) {
+      mlir::Value lut = group[i].getLookupTable();
+      luts = builder.create<mlir::tensor::InsertSliceOp>(
+          loc, lut, luts,
+          llvm::ArrayRef<mlir::OpFoldResult>{
+              builder.getIndexAttr(i * lutTy.getDimSize(0)),
+              builder.getIndexAttr(0)},
+          llvm::ArrayRef<mlir::OpFoldResult>{
+              builder.getIndexAttr(lutTy.getDimSize(0)),
+              builder.getIndexAttr(lutTy.getDimSize(1))},
+          llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(1),
+                                             builder.getIndexAttr(1)});
+    }
+
+    auto merged = builder.create<TFHE::WopPBSGLWEOp>(
+        loc,
+        mlir::RankedTensorType::get({count * blocks},
+                                    resultTy.getElementType()),
+        first.getCiphertexts(), luts, first.getKskAttr(), first.getBskAttr(),
+        first.getPkskAttr(), first.getCrtDecompositionAttr(),
+        first.getCbsLevelsAttr(), first.getCbsBaseLogAttr());
+    for (int64_t i = 0; i < count; i++) {
+      auto slice = builder.create<mlir::tensor::ExtractSliceOp>(
+          loc, resultTy, merged.getResult(),
+          llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(i * blocks)},
+          llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(blocks)},
+          llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(1)});
+      group[i].getResult().replaceAllUsesWith(slice.getResult());
+      group[i]->erase();
+    }
+    numSharedWopPBS += count - 1;
+  }
+};
+
+/// For documentation see Transforms.td
+class TFHEStraightLineBatchingPass
+    : public TFHEStraightLineBatchingBase<TFHEStraightLineBatchingPass> {
+public:
+  TFHEStraightLineBatchingPass(int64_t maxBatchSize) {
+    this->maxBatchSize = maxBatchSize;
+  }
+
+  void runOnOperation() override {
+    llvm::SmallVector<mlir::Block *> blocks;
+    getOperation()->walk([&](mlir::Block *block) { blocks.push_back(block); });
+    for (mlir::Block *block : blocks)
+      batchBlock(*block);
+  }
+
+private:
+  /// The depth, the key, the input type and the lookup table, if batched with
+  /// a single one, shared by the operations of a batch
+  typedef std::tuple<int64_t, mlir::Attribute, mlir::Type, mlir::Value>
+      BatchKey;
+
+  /// Returns the depth of each operation of `block` in its dependency graph,
+  /// the operations having side effects being chained in their order. The
+  /// operations of a same depth are then independent of each other.
+  static llvm::DenseMap<mlir::Operation *, int64_t>
+  depths(mlir::Block &block) {
+    llvm::DenseMap<mlir::Operation *, int64_t> depths;
+    int64_t lastEffectDepth = 0;
+    for (mlir::Operation &op : block) {
+      llvm::SetVector<mlir::Value> operands;
+      operands.insert(op.operand_begin(), op.operand_end());
+      mlir::getUsedValuesDefinedAbove(op.getRegions(), operands);
+      int64_t depth = 0;
+      for (mlir::Value operand : operands) {
+        auto def = depths.find(operand.getDefiningOp());
+        if (def != depths.end())
+          depth = std::max(depth, def->second);
+      }
+      if (!mlir::isMemoryEffectFree(&op)) {
+        depth = std::max(depth, lastEffectDepth);
+        lastEffectDepth = depth + 1;
+      }
+      depths[&op] = depth + 1;
+    }
+    return depths;
+  }
+
+  void batchBlock(mlir::Block &block) {
+    auto depth = depths(block);
+    llvm::MapVector<BatchKey, llvm::SmallVector<mlir::Operation *>> batches;
+    for (mlir::Operation &op : block) {
+      if (auto ksOp = llvm::dyn_cast<TFHE::KeySwitchGLWEOp>(op)) {
+        batches[{depth[&op], ksOp.getKeyAttr(), ksOp.getCiphertext().getType(),
+                 mlir::Value()}]
+            .push_back(&op);
+      } else if (auto bsOp = llvm::dyn_cast<TFHE::BootstrapGLWEOp>(op)) {
+        batches[{depth[&op], bsOp.getKeyAttr(), bsOp.getCiphertext().getType(),
+                 bsOp.getLookupTable()}]
+            .push_back(&op);
+      }
+    }
+    // The bootstraps left alone with their lookup table are batched with the
+    // others of their depth and key, each one with its lookup table
+    llvm::MapVector<BatchKey, llvm::SmallVector<mlir::Operation *>> mapped;
+    for (auto &batch : batches) {
+      if (batch.second.size() > 1 || !std::get<3>(batch.first))
+        continue;
+      BatchKey key = batch.first;
+      std::get<3>(key) = mlir::Value();
+      mapped[key].push_back(batch.second.front());
+    }
+
+    size_t batchSize = std::max<int64_t>(maxBatchSize, 1);
+    llvm::SmallVector<llvm::SmallVector<mlir::Operation *>> chunks;
+    for (auto *group : {&batches, &mapped}) {
+      for (auto &batch : *group) {
+        if (group == &batches && std::get<3>(batch.first) &&
+            batch.second.size() == 1)
+          continue;
+        auto ops = llvm::ArrayRef<mlir::Operation *>(batch.second);
+        for (size_t begin = 0; begin < ops.size(); begin += batchSize) {
+          auto chunk =
+              ops.slice(begin, std::min(batchSize, ops.size() - begin));
+          if (chunk.size() > 1)
+            chunks.emplace_back(chunk.begin(), chunk.end());
+        }
+      }
+    }
+    if (chunks.empty())
+      return;
+
+    schedule(block, depth);
+    for (auto &chunk : chunks)
+      batch(chunk);
+  }
+
+  /// Orders the operations of `block` by depth, so that a batch placed before
+  /// the first of its operations follows their operands and precedes their
+  /// users.
+  static void schedule(mlir::Block &block,
+                       llvm::DenseMap<mlir::Operation *, int64_t> &depth) {
+    mlir::Operation *terminator =
+        block.mightHaveTerminator() ? block.getTerminator() : nullptr;
+    llvm::SmallVector<mlir::Operation *> ops;
+    for (mlir::Operation &op : block)
+      if (&op != terminator)
+        ops.push_back(&op);
+    std::stable_sort(ops.begin(), ops.end(),
+                     [&](mlir::Operation *a, mlir::Operation *b) {
+                       return depth[a] < depth[b];
+                     });
+    for (mlir::Operation *op : ops)
+      op->moveBefore(&block, block.end());
+    if (terminator)
+      terminator->moveBefore(&block, block.end());
+  }
+
+  /// Replaces the keyswitches or the bootstraps of `ops` by a single batched
+  /// one, the bootstraps being mapped if their lookup tables differ.
+  void batch(llvm::ArrayRef<mlir::Operation *> ops) {
+    mlir::Operation *first = ops.front();
+    mlir::OpBuilder builder(first);
+    mlir::Location loc = first->getLoc();
+    int64_t count = ops.size();
+
+    llvm::SmallVector<mlir::Value> ciphertexts;
+    for (mlir::Operation *op : ops)
+      ciphertexts.push_back(op->getOperand(0));
+    mlir::Value inputs =
+        builder.create<mlir::tensor::FromElementsOp>(loc, ciphertexts);
+    auto resultTy =
+        mlir::RankedTensorType::get({count}, first->getResult(0).getType());
+
+    mlir::Value batched;
+    if (auto ksOp = llvm::dyn_cast<TFHE::KeySwitchGLWEOp>(first)) {
+      batched = builder.create<TFHE::BatchedKeySwitchGLWEOp>(
+          loc, resultTy, inputs, ksOp.getKeyAttr());
+    } else {
+      auto bsOp = llvm::cast<TFHE::BootstrapGLWEOp>(first);
+      mlir::Value lut = bsOp.getLookupTable();
+      if (llvm::all_of(ops, [&](mlir::Operation *op) {
+            return op->getOperand(1) == lut;
+          })) {
+        batched = builder.create<TFHE::BatchedBootstrapGLWEOp>(
+            loc, resultTy, inputs, lut, bsOp.getKeyAttr());
+      } else {
+        // The lookup tables are stacked, one per ciphertext
+        auto lutTy = lut.getType().cast<mlir::RankedTensorType>();
+        int64_t lutSize = lutTy.getDimSize(0);
+        mlir::Value luts = builder.create<mlir::tensor::EmptyOp>(
+            loc, llvm::ArrayRef<int64_t>{count, lutSize},
+            lutTy.getElementType());
+        for (int64_t i = 0; i < count; i++) {
+          luts = builder.create<mlir::tensor::InsertSliceOp>(
+              loc, ops[i]->getOperand(1), luts,
+              llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(i),
+                                                 builder.getIndexAttr(0)},
+              llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(1),
+                                                 builder.getIndexAttr(lutSize)},
+              llvm::ArrayRef<mlir::OpFoldResult>{builder.getIndexAttr(1),
+                                                 builder.getIndexAttr(1)});
+        }
+        batched = builder.create<TFHE::BatchedMappedBootstrapGLWEOp>(
+            loc, resultTy, inputs, luts, bsOp.getKeyAttr());
+      }
+    }
+
+    for (int64_t i = 0; i < count; i++) {
+      mlir::Value index = builder.create<mlir::arith::ConstantIndexOp>(loc, i);
+      mlir::Value result =
+          builder.create<mlir::tensor::ExtractOp>(loc, batched, index);
+      ops[i]->getResult(0).replaceAllUsesWith(result);
+      ops[i]->erase();
+    }
+    numBatchedOps += count;
+  }
+};
+
+/// For documentation see Transforms.td
+class TFHEMemorySchedulingPass
+    : public TFHEMemorySchedulingBase<TFHEMemorySchedulingPass> {
+public:
+  TFHEMemorySchedulingPass(int64_t maxLiveBytes) {
+    this->maxLiveBytes = maxLiveBytes;
+  }
+
+  void runOnOperation() override {
+    llvm::SmallVector<mlir::Block *> blocks;
+    getOperation()->walk([&](mlir::Block *block) { blocks.push_back(block); });
+    for (mlir::Block *block : blocks)
+      scheduleBlock(*block);
+  }
+
+private:
+  /// Returns the size in bytes of the ciphertexts of `type`, 0 if none.
+  static int64_t ciphertextBytes(mlir::Type type) {
+    int64_t count = 1;
+    if (auto tensorTy = type.dyn_cast<mlir::RankedTensorType>()) {
+      if (!tensorTy.hasStaticShape())
+        return 0;
+      count = tensorTy.getNumElements();
+      type = tensorTy.getElementType();
+    }
+    auto glweTy = type.dyn_cast<TFHE::GLWECipherTextType>();
+    if (!glweTy)
+      return 0;
+    TFHE::GLWESecretKey key = glweTy.getKey();
+    int64_t size = 1;
+    if (auto params = key.getParameterized())
+      size = params->dimension * params->polySize + 1;
+    else if (auto params = key.getNormalized())
+      size = params->dimension * params->polySize + 1;
+    return count * size * sizeof(uint64_t);
+  }
+
+  /// The dependencies of an operation of a block on the ones before it
+  struct Node {
+    mlir::Operation *op;
+    int64_t bytes = 0;
+    /// The operations using the results, and the following operation with
+    /// side effects
+    llvm::SmallVector<unsigned> successors;
+    /// The operations whose results are used
+    llvm::SmallVector<unsigned> operands;
+    /// The users not scheduled yet, the results being freed at the last one
+    /// unless they are used out of the block
+    unsigned pendingUsers = 0;
+    bool escapes = false;
+    unsigned pendingPredecessors = 0;
+    int64_t delta = 0;
+  };
+
+  /// Returns the dependency graph of the operations of `block` but its
+  /// terminator, in their order.
+  static std::vector<Node> dependencies(mlir::Block &block,
+                                        mlir::Operation *terminator) {
+    std::vector<Node> nodes;
+    llvm::DenseMap<mlir::Operation *, unsigned> position;
+    std::optional<unsigned> lastEffect;
+    for (mlir::Operation &op : block) {
+      if (&op == terminator)
+        break;
+      unsigned index = nodes.size();
+      position[&op] = index;
+      nodes.push_back(Node{&op});
+      Node &node = nodes.back();
+      for (mlir::Value result : op.getResults())
+        node.bytes += ciphertextBytes(result.getType());
+
+      llvm::SetVector<mlir::Value> operands;
+      operands.insert(op.operand_begin(), op.operand_end());
+      mlir::getUsedValuesDefinedAbove(op.getRegions(), operands);
+      llvm::SetVector<unsigned> predecessors;
+      for (mlir::Value operand : operands) {
+        auto def = position.find(operand.getDefiningOp());
+        if (def != position.end())
+          predecessors.insert(def->second);
+      }
+      for (unsigned predecessor : predecessors) {
+        node.operands.push_back(predecessor);
+        nodes[predecessor].pendingUsers++;
+      }
+      if (!mlir::isMemoryEffectFree(&op)) {
+        if (lastEffect)
+          predecessors.insert(*lastEffect);
+        lastEffect = index;
+      }
+      for (unsigned predecessor : predecessors)
+        nodes[predecessor].successors.push_back(index);
+      node.pendingPredecessors = predecessors.size();
+    }
+    for (Node &node : nodes)
+      for (mlir::Value result : node.op->getResults())
+        for (mlir::Operation *user : result.getUsers()) {
+          mlir::Operation *ancestor = block.findAncestorOpInBlock(*user);
+          if (ancestor == nullptr || ancestor == terminator)
+            node.escapes = true;
+        }
+    return nodes;
+  }
+
+  /// Returns the bytes of live ciphertexts added by scheduling `node` next.
+  static int64_t delta(std::vector<Node> &nodes, Node &node) {
+    int64_t delta = node.bytes;
+    for (unsigned operand : node.operands)
+      if (nodes[operand].pendingUsers == 1 && !nodes[operand].escapes)
+        delta -= nodes[operand].bytes;
+    return delta;
+  }
+
+  void scheduleBlock(mlir::Block &block) {
+    mlir::Operation *terminator =
+        block.mightHaveTerminator() ? block.getTerminator() : nullptr;
+    std::vector<Node> nodes = dependencies(block, terminator);
+    if (llvm::all_of(nodes, [](Node &node) { return node.bytes == 0; }))
+      return;
+
+    // The operations whose operands are computed, by position and by the
+    // bytes they add
+    std::set<unsigned> byPosition;
+    std::set<std::pair<int64_t, unsigned>> byDelta;
+    auto makeReady = [&](unsigned index) {
+      nodes[index].delta = delta(nodes, nodes[index]);
+      byPosition.insert(index);
+      byDelta.insert({nodes[index].delta, index});
+    };
+    for (unsigned index = 0; index < nodes.size(); index++)
+      if (nodes[index].pendingPredecessors == 0)
+        makeReady(index);
+
+    int64_t liveBytes = 0;
+    llvm::SmallVector<unsigned> order;
+    while (!byPosition.empty()) {
+      unsigned next = *byPosition.begin();
+      if (maxLiveBytes <= 0 || liveBytes + nodes[next].delta > maxLiveBytes)
+        next = byDelta.begin()->second;
+      Node &node = nodes[next];
+      byPosition.erase(next);
+      byDelta.erase({node.delta, next});
+      order.push_back(next);
+
+      liveBytes += node.bytes;
+      if (node.pendingUsers == 0 && !node.escapes)
+        liveBytes -= node.bytes;
+      for (unsigned operand : node.operands) {
+        Node &producer = nodes[operand];
+        producer.pendingUsers--;
+        if (producer.pendingUsers == 0 && !producer.escapes)
+          liveBytes -= producer.bytes;
+        if (producer.pendingUsers != 1)
+          continue;
+        // The last user of the operand frees it, if ready its delta changes
+        for (unsigned user : producer.successors) {
+          if (!byPosition.count(user))
+            continue;
+          byDelta.erase({nodes[user].delta, user});
+          nodes[user].delta = delta(nodes, nodes[user]);
+          byDelta.insert({nodes[user].delta, user});
+        }
+      }
+      for (unsigned successor : node.successors)
+        if (--nodes[successor].pendingPredecessors == 0)
+          makeReady(successor);
+    }
+
+    for (unsigned i = 0; i < order.size(); i++) {
+      if (order[i] != i)
+        numMovedOps++;
+      nodes[order[i]].op->moveBefore(&block, block.end());
+    }
+    if (terminator)
+      terminator->moveBefore(&block, block.end());
+  }
+};
+
+/// For documentation see Transforms.td
+class TFHEConstantLutEncodingPass
+    : public TFHEConstantLutEncodingBase<TFHEConstantLutEncodingPass> {
+public:
+  void runOnOperation() override {
+    llvm::SmallVector<mlir::Operation *> encodings;
+    getOperation()->walk([&](mlir::Operation *op) {
+      if (llvm::isa<TFHE::EncodeExpandLutForBootstrapOp,
+                    TFHE::EncodeExpandManyLutForBootstrapOp,
+                    TFHE::EncodeLutForCrtWopPBSOp>(op))
+        encodings.push_back(op);
+    });
+    for (mlir::Operation *op : encodings) {
+      if (auto encodeWopPBSOp =
+              llvm::dyn_cast<TFHE::EncodeLutForCrtWopPBSOp>(op)) {
+        encodeForCrtWopPBS(encodeWopPBSOp);
+      } else if (auto encodeOp =
+                     llvm::dyn_cast<TFHE::EncodeExpandLutForBootstrapOp>(
+                         op)) {
+        encode(op, encodeOp.getInputLookupTable(), encodeOp.getPolySize(),
+               encodeOp.getOutputBits(), encodeOp.getIsSigned());
+      } else {
+        auto encodeManyOp =
+            llvm::cast<TFHE::EncodeExpandManyLutForBootstrapOp>(op);
+        encode(op, encodeManyOp.getInputLookupTables(),
+               encodeManyOp.getPolySize(), encodeManyOp.getOutputBits(),
+               encodeManyOp.getIsSigned());
+      }
+    }
+  }
+
+private:
+  /// Replaces `op` by the constant encoding of `luts`, one lut or a 2D tensor
+  /// of luts, if they are constant. The encoding is the one of
+  /// `memref_encode_expand_many_lut_for_bootstrap` in the runtime.
+  void encode(mlir::Operation *op, mlir::Value luts, uint32_t polySize,
+              uint32_t outputBits, bool isSigned) {
+    mlir::DenseIntElementsAttr lutsAttr;
+    if (!mlir::matchPattern(luts, mlir::m_Constant(&lutsAttr)))
+      return;
+    auto shape = lutsAttr.getType().getShape();
+    size_t lutCount = shape.size() == 2 ? shape[0] : 1;
+    size_t lutSize = shape.back();
+    // Left to the runtime, which asserts on them
+    if (lutSize == 0 || polySize % (2 * lutSize * lutCount) != 0)
+      return;
+
+    auto range = lutsAttr.getValues<int64_t>();
+    llvm::SmallVector<int64_t> values(range.begin(), range.end());
+    size_t megaCaseSize = polySize / lutSize;
+    auto lutValue = [&](size_t lut, size_t idx) -> uint64_t {
+      // Signed bootstraps need the lut to be half-rotated
+      if (isSigned)
+        idx = idx < lutSize / 2 ? idx + lutSize / 2 : idx - lutSize / 2;
+      return (uint64_t)values[lut * lutSize + idx] << (64 - outputBits - 1);
+    };
+    // The first value is centered over zero, its second half being negated
+    // at the end of the test polynomial
+    llvm::SmallVector<int64_t> encoded(polySize);
+    for (size_t idx = 0; idx < polySize; idx++) {
+      size_t lut = idx % lutCount;
+      size_t message = (idx + megaCaseSize / 2) / megaCaseSize;
+      encoded[idx] = message == lutSize ? -lutValue(lut, 0)
+                                        : lutValue(lut, message);
+    }
+
+    mlir::OpBuilder builder(op);
+    auto resultTy = op->getResult(0).getType().cast<mlir::RankedTensorType>();
+    auto cst = builder.create<mlir::arith::ConstantOp>(
+        op->getLoc(), mlir::DenseIntElementsAttr::get(resultTy, encoded));
+    op->replaceAllUsesWith(cst);
+    op->erase();
+    numEncodedLuts++;
+  }
+
+  /// Replaces `op` by the constant encoding of its lut if it is constant, and
+  /// if the encoding is small enough to be embedded in the binary. The
+  /// encoding is the one of `memref_encode_lut_for_crt_woppbs` in the runtime.
+  void encodeForCrtWopPBS(TFHE::EncodeLutForCrtWopPBSOp op) {
+    // 512KiB, the larger encodings being left to the runtime rather than
+    // weighing megabytes each in the binary
+    constexpr int64_t maxEncodedSize = 1 << 16;
+
+    mlir::DenseIntElementsAttr lutAttr;
+    if (!mlir::matchPattern(op.getInputLookupTable(),
+                            mlir::m_Constant(&lutAttr)))
+      return;
+    auto resultTy = op.getResult().getType().cast<mlir::RankedTensorType>();
+    if (resultTy.getNumElements() > maxEncodedSize)
+      return;
+
+    llvm::SmallVector<uint64_t> moduli, bits;
+    for (auto attr : op.getCrtDecomposition())
+      moduli.push_back(attr.cast<mlir::IntegerAttr>().getInt());
+    for (auto attr : op.getCrtBits())
+      bits.push_back(attr.cast<mlir::IntegerAttr>().getInt());
+    uint64_t totalBits = 0;
+    for (uint64_t blockBits : bits)
+      totalBits += blockBits;
+    uint64_t product = op.getModulusProduct();
+    auto range = lutAttr.getValues<int64_t>();
+    llvm::SmallVector<int64_t> values(range.begin(), range.end());
+    uint64_t lutSize = values.size();
+    uint64_t crtSize = uint64_t(1) << totalBits;
+    // Left to the runtime, which asserts on them
+    if (moduli.size() != bits.size() || product < lutSize ||
+        resultTy.getDimSize(0) != (int64_t)moduli.size() ||
+        resultTy.getDimSize(1) != (int64_t)crtSize)
+      return;
+
+    // The signed values are encoded as in the two's complement, the negative
+    // ones being at the end of [0, product)
+    auto plaintext = [&](uint64_t index) {
+      if (op.getIsSigned() && index >= lutSize / 2)
+        return index + product - lutSize;
+      return index;
+    };
+    // The cases of the lut which are not supposed to be reached are 0
+    llvm::SmallVector<int64_t> encoded(moduli.size() * crtSize, 0);
+    for (uint64_t in = 0; in < lutSize; in++) {
+      uint64_t out = 0, shift = 0;
+      for (size_t block = 0; block < moduli.size(); block++) {
+        out += (((plaintext(in) % moduli[block]) << bits[block]) /
+                moduli[block])
+               << shift;
+        shift += bits[block];
+      }
+      // As crt::encode, on the interval [0, product)
+      int64_t value = values[in];
+      uint64_t positive = value < 0 ? product + value : value;
+      for (size_t block = 0; block < moduli.size(); block++) {
+        __uint128_t m = positive % moduli[block];
+        encoded[block * crtSize + out] =
+            (uint64_t)(m * ((__uint128_t)(1) << 64) / moduli[block]);
+      }
+    }
+
+    mlir::OpBuilder builder(op);
+    auto cst = builder.create<mlir::arith::ConstantOp>(
+        op.getLoc(), mlir::DenseIntElementsAttr::get(resultTy, encoded));
+    op.replaceAllUsesWith(cst.getResult());
+    op.erase();
+    numEncodedLuts++;
+  }
+};
+
+/// For documentation see Transforms.td
+class TFHELutEncodingHoistingPass
+    : public TFHELutEncodingHoistingBase<TFHELutEncodingHoistingPass> {
+public:
+  void runOnOperation() override {
+    llvm::SmallVector<mlir::Operation *> encodings;
+    getOperation()->walk([&](mlir::Operation *op) {
+      if (llvm::isa<TFHE::EncodeExpandLutForBootstrapOp,
+                    TFHE::EncodeExpandManyLutForBootstrapOp,
+                    TFHE::EncodeLutForCrtWopPBSOp>(op))
+        encodings.push_back(op);
+    });
+
+    for (mlir::Operation *op : encodings) {
+      bool hoisted = false;
+      while (auto loop = llvm::dyn_cast_or_null<mlir::LoopLikeOpInterface>(
+                 op->getParentOp())) {
+        if (!hoist(op, loop))
+          break;
+        hoisted = true;
+      }
+      if (hoisted)
+        numHoistedEncodings++;
+    }
+
+    // Identical encodings of a block, the first one dominating the others
+    llvm::DenseMap<mlir::Block *, llvm::SmallVector<mlir::Operation *>> kept;
+    for (mlir::Operation *op : encodings) {
+      auto &blockEncodings = kept[op->getBlock()];
+      auto same = llvm::find_if(blockEncodings, [&](mlir::Operation *other) {
+        return mlir::OperationEquivalence::isEquivalentTo(
+            op, other, mlir::OperationEquivalence::IgnoreLocations);
+      });
+      if (same == blockEncodings.end()) {
+        blockEncodings.push_back(op);
+        continue;
+      }
+      if (op->isBeforeInBlock(*same))
+        std::swap(op, *same);
+      op->replaceAllUsesWith(*same);
+      op->erase();
+      numMergedEncodings++;
+    }
+  }
+
+private:
+  /// Moves `op` before `loop`, along with the pure operations of the loop
+  /// computing its operands, if none of them depends on the loop.
+  static bool hoist(mlir::Operation *op, mlir::LoopLikeOpInterface loop) {
+    for (mlir::Value operand : op->getOperands()) {
+      if (loop.isDefinedOutsideOfLoop(operand))
+        continue;
+      mlir::Operation *def = operand.getDefiningOp();
+      if (def == nullptr || !mlir::isPure(def) || def->getNumRegions() != 0 ||
+          def->getParentOp() != loop.getOperation() || !hoist(def, loop))
+        return false;
+    }
+    loop.moveOutOfLoop(op);
+    return true;
+  }
+};
+
 } // end anonymous namespace
 
 std::unique_ptr<mlir::OperationPass<>> createTFHEOptimizationPass() {
   return std::make_unique<TFHEOptimizationPass>();
 }
 
+std::unique_ptr<mlir::OperationPass<>> createTFHEKeyswitchSharingPass() {
+  return std::make_unique<TFHEKeyswitchSharingPass>();
+}
+
+std::unique_ptr<mlir::OperationPass<>> createTFHEWopPBSSharingPass() {
+  return std::make_unique<TFHEWopPBSSharingPass>();
+}
+
+std::unique_ptr<mlir::OperationPass<>>
+createTFHEStraightLineBatchingPass(int64_t maxBatchSize) {
+  return std::make_unique<TFHEStraightLineBatchingPass>(maxBatchSize);
+}
+
+std::unique_ptr<mlir::OperationPass<>>
+createTFHEMemorySchedulingPass(int64_t maxLiveBytes) {
+  return std::make_unique<TFHEMemorySchedulingPass>(maxLiveBytes);
+}
+
+std::unique_ptr<mlir::OperationPass<>> createTFHEConstantLutEncodingPass() {
+  return std::make_unique<TFHEConstantLutEncodingPass>();
+}
+
+std::unique_ptr<mlir::OperationPass<>> createTFHELutEncodingHoistingPass() {
+  return std::make_unique<TFHELutEncodingHoistingPass>();
+}
+
 } // namespace concretelang
 } // namespace mlir
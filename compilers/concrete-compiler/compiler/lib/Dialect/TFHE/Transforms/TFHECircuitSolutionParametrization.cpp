@@ -76,6 +76,17 @@ public:
     return solution.instructions_keys[oid];
   }
 
+  // Returns the polynomial size of the output key of a fast keyswitch, or 0
+  // for a classical keyswitch
+  static int fastPolySize(const ::concrete_optimizer::dag::KeySwitchKey &) {
+    return 0;
+  }
+
+  static int
+  fastPolySize(const ::concrete_optimizer::dag::ConversionKeySwitchKey &ksk) {
+    return ksk.fast_keyswitch ? ksk.output_key.polynomial_size : 0;
+  }
+
   // Returns a `GLWEKeyswitchKeyAttr` for a given keyswitch key
   // (either of type `KeySwitchKey` or `ConversionKeySwitchKey`)
   template <typename KeyT>
@@ -84,7 +95,7 @@ public:
     return TFHE::GLWEKeyswitchKeyAttr::get(
         ctx, toGLWESecretKey(ksk.input_key), toGLWESecretKey(ksk.output_key),
         ksk.ks_decomposition_parameter.level,
-        ksk.ks_decomposition_parameter.log2_base, -1);
+        ksk.ks_decomposition_parameter.log2_base, -1, fastPolySize(ksk));
   }
 
   // Returns a `GLWEKeyswitchKeyAttr` for the keyswitch key of an
@@ -226,6 +237,8 @@ public:
               mlir::bufferization::AllocTensorOp, TFHE::KeySwitchGLWEOp,
               TFHE::BootstrapGLWEOp, TFHE::BatchedKeySwitchGLWEOp,
               TFHE::BatchedBootstrapGLWEOp, TFHE::EncodeExpandLutForBootstrapOp,
+              TFHE::ManyLutBootstrapGLWEOp,
+              TFHE::EncodeExpandManyLutForBootstrapOp,
               TFHE::EncodeLutForCrtWopPBSOp, TFHE::EncodePlaintextWithCrtOp,
               TFHE::WopPBSGLWEOp, mlir::func::ReturnOp,
               Tracing::TraceCiphertextOp, mlir::tensor::EmptyOp>([&](auto op) {
@@ -391,11 +404,10 @@ protected:
                 applyKeyswitch(op, resolver, currState, prevState,
                                oid.getInt());
               })
-          .Case<TFHE::BootstrapGLWEOp, TFHE::BatchedBootstrapGLWEOp>(
-              [&](auto op) {
-                applyBootstrap(op, resolver, currState, prevState,
-                               oid.getInt());
-              })
+          .Case<TFHE::BootstrapGLWEOp, TFHE::BatchedBootstrapGLWEOp,
+                TFHE::ManyLutBootstrapGLWEOp>([&](auto op) {
+            applyBootstrap(op, resolver, currState, prevState, oid.getInt());
+          })
           .Default([&](auto op) {
             applyGeneric(op, resolver, currState, prevState, oid.getInt());
           });
@@ -596,6 +608,12 @@ public:
         return mlir::failure();
     }
 
+    if (TFHE::ManyLutBootstrapGLWEOp newBSOp =
+            llvm::dyn_cast<TFHE::ManyLutBootstrapGLWEOp>(newOp)) {
+      if (checkFixupManyLutBootstrapLUTs(rewriter, newBSOp).failed())
+        return mlir::failure();
+    }
+
     return mlir::success();
   }
 
@@ -767,6 +785,50 @@ protected:
     return mlir::success();
   }
 
+  // Same as `checkFixupBootstrapLUTs`, but for the packed lookup
+  // tables of a many lut bootstrap, which are always encoded within
+  // function scope.
+  mlir::LogicalResult
+  checkFixupManyLutBootstrapLUTs(mlir::IRRewriter &rewriter,
+                                 TFHE::ManyLutBootstrapGLWEOp newBSOp) {
+    TFHE::GLWEBootstrapKeyAttr newBSKeyAttr = newBSOp.getKeyAttr();
+    mlir::Value lut = newBSOp.getLookupTable();
+
+    if (lut.getType().cast<mlir::RankedTensorType>().getShape()[0] ==
+        newBSKeyAttr.getPolySize()) {
+      return mlir::success();
+    }
+
+    TFHE::EncodeExpandManyLutForBootstrapOp oldEncodeOp =
+        llvm::dyn_cast_or_null<TFHE::EncodeExpandManyLutForBootstrapOp>(
+            lut.getDefiningOp());
+
+    if (!oldEncodeOp) {
+      newBSOp->emitError(
+          "Cannot update lookup tables after parametrization, only tables "
+          "generated through TFHE.encode_expand_many_lut_for_bootstrap are "
+          "supported");
+
+      return mlir::failure();
+    }
+
+    mlir::RankedTensorType newLUTType = mlir::RankedTensorType::get(
+        mlir::ArrayRef<int64_t>{newBSKeyAttr.getPolySize()},
+        rewriter.getI64Type());
+
+    rewriter.setInsertionPointAfter(oldEncodeOp);
+
+    TFHE::EncodeExpandManyLutForBootstrapOp newEncodeOp =
+        rewriter.create<TFHE::EncodeExpandManyLutForBootstrapOp>(
+            oldEncodeOp.getLoc(), newLUTType,
+            oldEncodeOp.getInputLookupTables(), newBSKeyAttr.getPolySize(),
+            oldEncodeOp.getOutputBits(), oldEncodeOp.getIsSigned());
+
+    newBSOp.setOperand(1, newEncodeOp);
+
+    return mlir::success();
+  }
+
   TFHEParametrizationTypeResolver &typeResolver;
   const std::optional<CircuitSolutionWrapper> &solution;
 };
@@ -11,15 +11,19 @@
 
 #ifdef CONCRETELANG_DATAFLOW_EXECUTION_ENABLED
 
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <hpx/barrier.hpp>
 #include <hpx/future.hpp>
 #include <hpx/hpx_start.hpp>
 #include <hpx/hpx_suspend.hpp>
 #include <hwloc.h>
+#include <mutex>
 #include <omp.h>
 
 #include "concretelang/Runtime/DFRuntime.hpp"
+#include "concretelang/Runtime/Numa.h"
 #include "concretelang/Runtime/distributed_generic_task_server.hpp"
 #include "concretelang/Runtime/runtime_api.h"
 #include "concretelang/Runtime/time_util.h"
@@ -35,6 +39,132 @@ static size_t num_nodes = 0;
 #if CONCRETELANG_TIMING_ENABLED
 static struct timespec init_timer, broadcast_timer, compute_timer, whole_timer;
 #endif
+
+/// The arena holding the outputs of the tasks which are only consumed by
+/// other tasks, so that allocating them does not go through malloc, and
+/// that they are released in bulk at the end of an execution.
+///
+/// The outputs are allocated from a single chunk, sized from the bytes
+/// reserved by the compiler for an execution or else from the bytes
+/// requested by the previous one, up to `DFR_TASK_ARENA_LIMIT` bytes (1 GiB
+/// by default, 0 disabling the arena). Outputs which do not fit fall back
+/// to malloc. The chunk is only reused once all of its outputs have been
+/// released, which is checked by _dfr_stop.
+struct TaskArena {
+  TaskArena() {
+    char *env = getenv("DFR_TASK_ARENA_LIMIT");
+    if (env != nullptr)
+      limit = strtoull(env, NULL, 10);
+  }
+
+  static TaskArena &get() {
+    static TaskArena arena;
+    return arena;
+  }
+
+  void *allocate(size_t bytes) {
+    size_t size = (bytes + alignment - 1) & ~(alignment - 1);
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      requested += size;
+      if (used + size <= capacity) {
+        void *ptr = base + used;
+        used += size;
+        live++;
+        return ptr;
+      }
+    }
+    void *ptr;
+    _dfr_checked_aligned_alloc(&ptr, alignment, size);
+    return ptr;
+  }
+
+  /// Releases `ptr` if it is an output allocated in the arena.
+  bool release(void *ptr) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (ptr < base || ptr >= base + capacity)
+      return false;
+    live--;
+    return true;
+  }
+
+  void reserve(size_t bytes) {
+    std::lock_guard<std::mutex> guard(mutex);
+    reserved = std::max(reserved, bytes);
+    if (live == 0 && used == 0)
+      resize(reserved);
+  }
+
+  /// Makes the whole chunk available again if all its outputs have been
+  /// released, growing it to the bytes requested so far.
+  void reset() {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (live != 0)
+      return;
+    resize(std::max(reserved, requested));
+    used = 0;
+    requested = 0;
+  }
+
+private:
+  void resize(size_t bytes) {
+    bytes = std::min(bytes, limit);
+    if (bytes <= capacity || _dfr_is_distributed())
+      return;
+    free(base);
+    _dfr_checked_aligned_alloc((void **)&base, alignment, bytes);
+    capacity = bytes;
+  }
+
+  static const size_t alignment = 64;
+  size_t limit = (size_t)1 << 30;
+  std::mutex mutex;
+  char *base = nullptr;
+  size_t capacity = 0;
+  size_t used = 0;
+  size_t live = 0;
+  size_t reserved = 0;
+  size_t requested = 0;
+};
+
+/// The counters of _dfr_get_statistics other than the ones of the task
+/// placement, built on first use once the runtime is started.
+struct Telemetry {
+  Telemetry() : worker_busy_ns(hpx::get_num_worker_threads()) {}
+
+  static Telemetry &get() {
+    static Telemetry telemetry;
+    return telemetry;
+  }
+
+  void reset() {
+    tasks_created = 0;
+    tasks_executed = 0;
+    bytes_received = 0;
+    key_fetches = 0;
+    key_fetch_total_ns = 0;
+    key_fetch_max_ns = 0;
+    compute_ns = 0;
+    for (auto &busy : worker_busy_ns)
+      busy = 0;
+  }
+
+  std::atomic<uint64_t> tasks_created{0};
+  std::atomic<uint64_t> tasks_executed{0};
+  std::atomic<uint64_t> bytes_received{0};
+  std::atomic<uint64_t> key_fetches{0};
+  std::atomic<uint64_t> key_fetch_total_ns{0};
+  std::atomic<uint64_t> key_fetch_max_ns{0};
+  std::atomic<uint64_t> compute_ns{0};
+  std::chrono::steady_clock::time_point phase_start;
+  std::vector<std::atomic<uint64_t>> worker_busy_ns;
+};
+
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
 } // namespace
 } // namespace dfr
 } // namespace concretelang
@@ -62,16 +192,43 @@ void _dfr_deallocate_future(void *in) {
   size_t prev_count = drf->count.fetch_sub(1);
   if (prev_count == 1) {
     // If this was a memref for which a clone was needed, deallocate first.
-    if (drf->cloned_memref_p)
-      free(
-          (void *)(static_cast<StridedMemRefType<char, 1> *>(drf->future->get())
-                       ->data));
+    if (drf->cloned_memref_p) {
+      void *data =
+          static_cast<StridedMemRefType<char, 1> *>(drf->future->get())->data;
+      if (!TaskArena::get().release(data))
+        free(data);
+    }
     free(drf->future->get());
     delete (drf->future);
     delete drf;
   }
 }
 
+void *_dfr_arena_alloc(size_t bytes) {
+  return TaskArena::get().allocate(bytes);
+}
+
+void _dfr_reserve_task_arena(size_t bytes) {
+  TaskArena::get().reserve(bytes);
+}
+
+HPX_PLAIN_ACTION(mlir::concretelang::dfr::prefetchKey,
+                 _dfr_prefetch_key_action)
+
+/// Hints the remote nodes that the tasks of the current phase use the key
+/// `key_id` of `kind` (a `KeyKind`), so that with lazy key transfer they
+/// start fetching it before the first of these tasks needs it.
+void _dfr_prefetch_key(void *ctx, int64_t kind, int64_t key_id) {
+  if (num_nodes <= 1 || ctx == nullptr || !_dfr_is_root_node() ||
+      !_dfr_node_level_runtime_context_manager->lazy_key_transfer)
+    return;
+
+  uint64_t id = _dfr_node_level_runtime_context_manager->getContextId(ctx);
+  for (auto locality : hpx::find_remote_localities())
+    hpx::post<_dfr_prefetch_key_action>(locality, id, (uint64_t)kind,
+                                        (size_t)key_id);
+}
+
 /// Runtime generic async_task.  Each first NUM_PARAMS pairs of
 /// arguments in the variadic list corresponds to a void* pointer on a
 /// hpx::future<void*> and the size of data within the future.  After
@@ -153,6 +310,38 @@ void _dfr_create_async_task_vec(wfnptr wfn, void *ctx, size_t num_params,
                              param_types, outputs, output_sizes, output_types);
 }
 
+/// Runtime generic async_task on a static task descriptor emitted by
+/// the compiler for each task creation site.  DESC holds the number of
+/// parameters and the number of outputs, followed by a pair of size
+/// and type for each output then for each parameter.  OUTPUTS and
+/// PARAMS are the arrays of pointers to the output futures and of
+/// parameter futures, in the same order.
+void _dfr_create_async_task_desc(wfnptr wfn, void *ctx, const uint64_t *desc,
+                                 void **outputs, void **params) {
+  size_t num_params = desc[0];
+  size_t num_outputs = desc[1];
+  const uint64_t *output_desc = desc + 2;
+  const uint64_t *param_desc = output_desc + 2 * num_outputs;
+
+  std::vector<void *> refcounted_futures(params, params + num_params);
+  std::vector<size_t> param_sizes(num_params);
+  std::vector<uint64_t> param_types(num_params);
+  std::vector<void *> outs(outputs, outputs + num_outputs);
+  std::vector<size_t> output_sizes(num_outputs);
+  std::vector<uint64_t> output_types(num_outputs);
+  for (size_t i = 0; i < num_outputs; ++i) {
+    output_sizes[i] = output_desc[2 * i];
+    output_types[i] = output_desc[2 * i + 1];
+  }
+  for (size_t i = 0; i < num_params; ++i) {
+    param_sizes[i] = param_desc[2 * i];
+    param_types[i] = param_desc[2 * i + 1];
+  }
+
+  dfr_create_async_task_impl(wfn, ctx, refcounted_futures, param_sizes,
+                             param_types, outs, output_sizes, output_types);
+}
+
 /***************************/
 /* JIT execution support.  */
 /***************************/
@@ -221,6 +410,9 @@ static inline void _dfr_start_impl(int argc, char *argv[]) {
     {
 #pragma omp critical
       use_omp_p = true;
+      if (mlir::concretelang::numa::bind_workers())
+        mlir::concretelang::numa::bind_worker(omp_get_thread_num(),
+                                              omp_get_num_threads());
     }
   }
 
@@ -271,6 +463,11 @@ static inline void _dfr_start_impl(int argc, char *argv[]) {
     if (nHPXThreads < 1)
       nHPXThreads = 1;
 
+    // Spread the HPX workers evenly over the NUMA domains, so that each
+    // worker reads the evaluation keys replicated on its own node.
+    if (mlir::concretelang::numa::bind_workers())
+      parameters.push_back(const_cast<char *>("--hpx:bind=numa-balanced"));
+
     // If the user does not provide their own config file, one is by
     // default located at the root of the concrete-compiler directory.
     env = getenv("HPX_CONFIG_FILE");
@@ -372,6 +569,7 @@ void _dfr_start(int64_t use_dfr_p, void *ctx) {
     if (num_nodes > 1 && ctx) {
       END_TIME(&broadcast_timer, "Key broadcasting");
     }
+    Telemetry::get().phase_start = std::chrono::steady_clock::now();
   }
   BEGIN_TIME(&compute_timer);
 }
@@ -382,6 +580,8 @@ void _dfr_start(int64_t use_dfr_p, void *ctx) {
 // called on exit from "main" when not using the main wrapper library.
 void _dfr_stop(int64_t use_dfr_p) {
   if (use_dfr_p) {
+    Telemetry &telemetry = Telemetry::get();
+    telemetry.compute_ns += elapsed_ns(telemetry.phase_start);
     if (num_nodes > 1) {
       // Non-root nodes synchronize here with the root to mark the point
       // where the root is free to send work out (only needed in JIT).
@@ -396,6 +596,9 @@ void _dfr_stop(int64_t use_dfr_p) {
       _dfr_node_level_runtime_context_manager->clearContext();
       _dfr_node_level_work_function_registry->clearRegistry();
     }
+    if (_dfr_is_root_node())
+      TaskPlacement::get().print_stats();
+    TaskArena::get().reset();
   }
   END_TIME(&compute_timer, "Compute");
   END_TIME(&whole_timer, "Total execution");
@@ -460,9 +663,73 @@ void _dfr_print_debug(size_t val) {
   hpx::cout << "_dfr_print_debug : " << val << "\n" << std::flush;
 }
 
+/*****************/
+/*  Statistics.  */
+/*****************/
+namespace mlir {
+namespace concretelang {
+namespace dfr {
+
+void _dfr_record_task_execution(uint64_t bytes_received, uint64_t ns) {
+  Telemetry &telemetry = Telemetry::get();
+  telemetry.tasks_executed.fetch_add(1, std::memory_order_relaxed);
+  telemetry.bytes_received.fetch_add(bytes_received,
+                                     std::memory_order_relaxed);
+  size_t worker = hpx::get_worker_thread_num();
+  if (worker < telemetry.worker_busy_ns.size())
+    telemetry.worker_busy_ns[worker].fetch_add(ns, std::memory_order_relaxed);
+}
+
+void _dfr_record_key_fetch(uint64_t ns) {
+  Telemetry &telemetry = Telemetry::get();
+  telemetry.key_fetches.fetch_add(1, std::memory_order_relaxed);
+  telemetry.key_fetch_total_ns.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t max = telemetry.key_fetch_max_ns.load(std::memory_order_relaxed);
+  while (max < ns && !telemetry.key_fetch_max_ns.compare_exchange_weak(
+                         max, ns, std::memory_order_relaxed))
+    ;
+}
+
+DFRStatistics _dfr_get_statistics() {
+  DFRStatistics statistics;
+  if (init_guard != active)
+    return statistics;
+
+  Telemetry &telemetry = Telemetry::get();
+  statistics.tasks_created = telemetry.tasks_created;
+  statistics.tasks_executed = telemetry.tasks_executed;
+  statistics.bytes_received = telemetry.bytes_received;
+  statistics.key_fetches = telemetry.key_fetches;
+  statistics.key_fetch_total_ns = telemetry.key_fetch_total_ns;
+  statistics.key_fetch_max_ns = telemetry.key_fetch_max_ns;
+  statistics.compute_ns = telemetry.compute_ns;
+  for (auto &busy : telemetry.worker_busy_ns)
+    statistics.worker_busy_ns.push_back(busy);
+  statistics.pending_threads = hpx::threads::get_thread_count(
+      hpx::threads::thread_schedule_state::pending);
+  if (_dfr_is_root_node())
+    TaskPlacement::get().get_statistics(statistics);
+  return statistics;
+}
+
+void _dfr_reset_statistics() {
+  if (init_guard != active)
+    return;
+  Telemetry::get().reset();
+  if (_dfr_is_root_node())
+    TaskPlacement::get().reset();
+}
+
+} // namespace dfr
+} // namespace concretelang
+} // namespace mlir
+
 #else // CONCRETELANG_DATAFLOW_EXECUTION_ENABLED
 
+#include <string.h>
+
 #include "concretelang/Runtime/DFRuntime.hpp"
+#include "concretelang/Runtime/dfr_debug_interface.h"
 #include "concretelang/Runtime/time_util.h"
 
 namespace mlir {
@@ -493,6 +760,87 @@ using namespace mlir::concretelang::dfr;
 
 void _dfr_start(int64_t use_dfr_p, void *ctx) { BEGIN_TIME(&compute_timer); }
 void _dfr_stop(int64_t use_dfr_p) { END_TIME(&compute_timer, "Compute"); }
+void _dfr_prefetch_key(void *ctx, int64_t kind, int64_t key_id) {}
 
 void _dfr_terminate() {}
+
+namespace mlir {
+namespace concretelang {
+namespace dfr {
+
+DFRStatistics _dfr_get_statistics() { return DFRStatistics(); }
+void _dfr_reset_statistics() {}
+void _dfr_record_key_fetch(uint64_t ns) {}
+
+} // namespace dfr
+} // namespace concretelang
+} // namespace mlir
 #endif
+
+namespace mlir {
+namespace concretelang {
+namespace dfr {
+
+std::string _dfr_statistics_prometheus() {
+  DFRStatistics statistics = _dfr_get_statistics();
+  std::string text;
+  auto metric = [&](const char *name, const char *type, const char *help) {
+    text += std::string("# HELP concrete_dfr_") + name + " " + help + "\n";
+    text += std::string("# TYPE concrete_dfr_") + name + " " + type + "\n";
+  };
+  auto sample = [&](const char *name, const std::string &labels,
+                    uint64_t value) {
+    text += std::string("concrete_dfr_") + name + labels + " " +
+            std::to_string(value) + "\n";
+  };
+
+  metric("tasks_created_total", "counter", "Tasks created by this node.");
+  sample("tasks_created_total", "", statistics.tasks_created);
+  metric("tasks_executed_total", "counter", "Tasks executed by this node.");
+  sample("tasks_executed_total", "", statistics.tasks_executed);
+  metric("node_tasks_total", "counter", "Tasks sent to each node.");
+  for (size_t node = 0; node < statistics.node_tasks.size(); ++node)
+    sample("node_tasks_total", "{node=\"" + std::to_string(node) + "\"}",
+           statistics.node_tasks[node]);
+  metric("node_sent_bytes_total", "counter",
+         "Input bytes of the tasks sent to each node.");
+  for (size_t node = 0; node < statistics.node_bytes_sent.size(); ++node)
+    sample("node_sent_bytes_total", "{node=\"" + std::to_string(node) + "\"}",
+           statistics.node_bytes_sent[node]);
+  metric("received_bytes_total", "counter",
+         "Input bytes of the tasks received from the other nodes.");
+  sample("received_bytes_total", "", statistics.bytes_received);
+  metric("key_fetches_total", "counter",
+         "Keys fetched from the root node on first use.");
+  sample("key_fetches_total", "", statistics.key_fetches);
+  metric("key_fetch_nanoseconds_total", "counter",
+         "Total latency of the key fetches.");
+  sample("key_fetch_nanoseconds_total", "", statistics.key_fetch_total_ns);
+  metric("key_fetch_max_nanoseconds", "gauge",
+         "Maximum latency of the key fetches.");
+  sample("key_fetch_max_nanoseconds", "", statistics.key_fetch_max_ns);
+  metric("pending_threads", "gauge",
+         "Threads ready to run and waiting for a worker.");
+  sample("pending_threads", "", statistics.pending_threads);
+  metric("compute_nanoseconds_total", "counter",
+         "Time spent in the computation phases.");
+  sample("compute_nanoseconds_total", "", statistics.compute_ns);
+  metric("worker_busy_nanoseconds_total", "counter",
+         "Time spent executing tasks by each worker thread.");
+  for (size_t w = 0; w < statistics.worker_busy_ns.size(); ++w)
+    sample("worker_busy_nanoseconds_total",
+           "{worker=\"" + std::to_string(w) + "\"}",
+           statistics.worker_busy_ns[w]);
+  return text;
+}
+
+} // namespace dfr
+} // namespace concretelang
+} // namespace mlir
+
+size_t _dfr_get_statistics_prometheus(char *buffer, size_t size) {
+  std::string text = _dfr_statistics_prometheus();
+  if (buffer != nullptr && text.size() < size)
+    memcpy(buffer, text.c_str(), text.size() + 1);
+  return text.size();
+}
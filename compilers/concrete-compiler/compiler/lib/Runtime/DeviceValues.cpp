@@ -0,0 +1,51 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/DeviceValues.h"
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+thread_local DeviceValueScope *currentScope = nullptr;
+thread_local DeviceSettingsScope *currentSettingsScope = nullptr;
+} // namespace
+
+DeviceValueScope::DeviceValueScope() : previous(currentScope) {
+  currentScope = this;
+}
+
+DeviceValueScope::~DeviceValueScope() { currentScope = previous; }
+
+void DeviceValueScope::bind(const void *host,
+                            std::shared_ptr<DeviceBuffer> buffer) {
+  buffers[host] = buffer;
+}
+
+std::shared_ptr<DeviceBuffer> DeviceValueScope::lookup(const void *host,
+                                                       size_t size) const {
+  auto it = buffers.find(host);
+  if (it == buffers.end() || it->second->size != size)
+    return nullptr;
+  return it->second;
+}
+
+DeviceValueScope *DeviceValueScope::current() { return currentScope; }
+
+DeviceSettingsScope::DeviceSettingsScope(const DeviceSettings &settings)
+    : settings(settings), previous(currentSettingsScope) {
+  currentSettingsScope = this;
+}
+
+DeviceSettingsScope::~DeviceSettingsScope() {
+  currentSettingsScope = previous;
+}
+
+const DeviceSettings *DeviceSettingsScope::current() {
+  return currentSettingsScope ? &currentSettingsScope->settings : nullptr;
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -4,20 +4,25 @@
 // for license information.
 
 #include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdarg>
+#include <deque>
 #include <err.h>
 #include <hwloc.h>
 #include <iostream>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <numeric>
 #include <queue>
 #include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include <concretelang/Runtime/DeviceValues.h>
 #include <concretelang/Runtime/stream_emulator_api.h>
 #include <concretelang/Runtime/wrappers.h>
 
@@ -46,9 +51,28 @@ static std::atomic<size_t> next_device = {0};
 // available resources.
 static size_t num_devices = 0;            // Set SDFG_NUM_GPUS to configure
 static size_t num_cores = 1;              // Set SDFG_NUM_THREADS to configure
-static size_t device_compute_factor = 16; // Set SDFG_DEVICE_TO_CORE_RATIO
+static double device_compute_factor = 16; // Set SDFG_DEVICE_TO_CORE_RATIO
+// Whether the ratio of the throughput of a device over that of a core is
+// measured on each execution of a subgraph, rather than fixed by
+// SDFG_DEVICE_TO_CORE_RATIO.
+static bool adaptive_device_ratio = true;
 // How much more memory than just input size is required on GPU to execute
 static float gpu_memory_inflation_factor = 1.5;
+// How much freed device memory each device keeps in its memory pool
+// (defaults to all of it, so that repeated executions of an SDFG do not
+// allocate). Set SDFG_GPU_POOL_RELEASE_THRESHOLD to configure (bytes).
+static uint64_t gpu_pool_release_threshold = UINT64_MAX;
+static std::once_flag gpu_pool_init;
+
+// Round the number of samples a PBS buffer is sized for to the next power
+// of two, so that a PBS buffer is not reallocated for every slightly larger
+// batch.
+static inline uint32_t pbs_buffer_samples(uint32_t num_samples) {
+  uint32_t samples = 1;
+  while (samples < num_samples)
+    samples <<= 1;
+  return samples;
+}
 
 // Get the byte size of a rank 2 MemRef
 static inline size_t memref_get_data_size(MemRef2 &m) {
@@ -160,8 +184,9 @@ struct GPU_state {
       pbs_buffer = nullptr;
     }
     if (pbs_buffer == nullptr)
-      pbs_buffer = new PBS_buffer(get_gpu_stream(), gpu_idx, glwe_dimension,
-                                  polynomial_size, input_lwe_ciphertext_count);
+      pbs_buffer = new PBS_buffer(
+          get_gpu_stream(), gpu_idx, glwe_dimension, polynomial_size,
+          pbs_buffer_samples(input_lwe_ciphertext_count));
     return pbs_buffer->get_pbs_buffer(get_gpu_stream(), gpu_idx, glwe_dimension,
                                       polynomial_size,
                                       input_lwe_ciphertext_count);
@@ -182,6 +207,11 @@ struct GPU_DFG {
   std::vector<GPU_state> gpus;
   uint32_t gpu_idx;
   void *gpu_stream;
+  // The devices the subgraphs are scheduled on and the limits of their
+  // chunks, as set by the device settings of the invocation.
+  std::vector<int32_t> devices;
+  uint64_t memory_limit = 0;
+  uint64_t batch_size = 0;
   GPU_DFG(uint32_t idx) : gpu_idx(idx), pbs_buffer(nullptr) {
     for (uint32_t i = 0; i < num_devices; ++i)
       gpus.push_back(std::move(GPU_state(i)));
@@ -252,6 +282,15 @@ struct Dependence {
   int32_t chunk_id;
   size_t stream_generation;
   std::vector<Dependence *> chunks;
+  // Whether the device data is owned by the dependence, and not a view in
+  // the device copy of a value.
+  bool deviceAllocated = true;
+  // Device copy of the whole data, bound to the device value scope of the
+  // calling thread.
+  std::shared_ptr<DeviceBuffer> device_copy;
+  // Device to core ratio with which the chunks of a split dependence were
+  // sized, later splits of the other inputs of its consumers must match.
+  double split_ratio = 0;
   Dependence(int32_t l, MemRef2 hd, void *dd, bool ohr, bool alloc = false,
              int32_t chunk_id = single_chunk, size_t gen = 0)
       : location(l), host_data(hd), device_data(dd), onHostReady(ohr),
@@ -265,7 +304,7 @@ struct Dependence {
   // Split a dependence into a number of chunks either to run on
   // multiple GPUs or execute concurrently on the host.
   void split_dependence(size_t num_chunks, size_t num_gpu_chunks,
-                        size_t chunk_dim, bool constant) {
+                        size_t chunk_dim, bool constant, double device_ratio) {
     // If this dependence is already split, check that the split
     // matches the new request
     if (chunk_id == split_chunks) {
@@ -299,10 +338,11 @@ struct Dependence {
       }
       return;
     }
+    split_ratio = device_ratio;
+    size_t gpu_chunk_size = num_samples * device_ratio /
+                            (num_chunks + num_gpu_chunks * device_ratio);
     size_t chunk_size =
-        num_samples / (num_chunks + num_gpu_chunks * device_compute_factor);
-    size_t gpu_chunk_size = chunk_size * device_compute_factor;
-    chunk_size = (num_samples - gpu_chunk_size * num_gpu_chunks) / num_chunks;
+        (num_samples - gpu_chunk_size * num_gpu_chunks) / num_chunks;
     size_t chunk_remainder =
         (num_samples - gpu_chunk_size * num_gpu_chunks) % num_chunks;
     uint64_t offset = 0;
@@ -323,6 +363,16 @@ struct Dependence {
       m.offset = offset + host_data.offset;
       void *dd = (device_data == nullptr) ? device_data
                                           : (uint64_t *)device_data + offset;
+      // The chunks of a value with a device copy start on its device, they
+      // are only uploaded if they get scheduled on another one.
+      if (device_copy != nullptr && chunk_dim == 0) {
+        chunks[i] = new Dependence(device_copy->gpuIdx, m,
+                                   (uint64_t *)device_copy->ptr + offset,
+                                   onHostReady, false, i, stream_generation);
+        chunks[i]->deviceAllocated = false;
+        offset += gpu_chunk_size * host_data.strides[chunk_dim];
+        continue;
+      }
       offset += gpu_chunk_size * host_data.strides[chunk_dim];
       chunks[i] = new Dependence(location, m, dd, onHostReady, false, i,
                                  stream_generation);
@@ -381,10 +431,12 @@ struct Dependence {
   }
   void move_chunk_off_device(int32_t chunk_id, GPU_DFG *dfg) {
     chunks[chunk_id]->copy(host_location, dfg);
-    cuda_drop_async(
-        chunks[chunk_id]->device_data,
-        (cudaStream_t *)dfg->get_gpu_stream(chunks[chunk_id]->location),
-        chunks[chunk_id]->location);
+    if (chunks[chunk_id]->deviceAllocated)
+      cuda_drop_async(
+          chunks[chunk_id]->device_data,
+          (cudaStream_t *)dfg->get_gpu_stream(chunks[chunk_id]->location),
+          chunks[chunk_id]->location);
+    chunks[chunk_id]->device_data = nullptr;
     chunks[chunk_id]->location = host_location;
   }
   void free_chunk_host_data(int32_t chunk_id, GPU_DFG *dfg) {
@@ -398,14 +450,15 @@ struct Dependence {
   void free_chunk_device_data(int32_t chunk_id, GPU_DFG *dfg) {
     assert(chunks[chunk_id]->location > host_location &&
            chunks[chunk_id]->device_data != nullptr);
-    cuda_drop_async(
-        chunks[chunk_id]->device_data,
-        (cudaStream_t *)dfg->get_gpu_stream(chunks[chunk_id]->location),
-        chunks[chunk_id]->location);
+    if (chunks[chunk_id]->deviceAllocated)
+      cuda_drop_async(
+          chunks[chunk_id]->device_data,
+          (cudaStream_t *)dfg->get_gpu_stream(chunks[chunk_id]->location),
+          chunks[chunk_id]->location);
     chunks[chunk_id]->device_data = nullptr;
   }
   inline void free_data(GPU_DFG *dfg, bool immediate = false) {
-    if (location >= 0 && device_data != nullptr) {
+    if (location >= 0 && device_data != nullptr && deviceAllocated) {
       cuda_drop_async(device_data,
                       (cudaStream_t *)dfg->get_gpu_stream(location), location);
     }
@@ -442,15 +495,56 @@ struct Dependence {
     } else {
       assert(onHostReady &&
              "Device-to-device data transfers not supported yet.");
+      if (device_copy != nullptr && device_copy->gpuIdx == loc &&
+          device_data == nullptr) {
+        device_data = device_copy->ptr;
+        deviceAllocated = false;
+        location = loc;
+        return;
+      }
       cudaStream_t *s = (cudaStream_t *)dfg->get_gpu_stream(loc);
-      if (device_data != nullptr)
+      if (device_data != nullptr && deviceAllocated)
         cuda_drop_async(device_data, s, location);
       device_data = cuda_malloc_async(data_size, s, loc);
+      deviceAllocated = true;
       cuda_memcpy_async_to_gpu(
           device_data, host_data.aligned + host_data.offset, data_size, s, loc);
       location = loc;
     }
   }
+  // Gathers a copy of the whole data on the device `loc`, from the device
+  // data of the dependence or of its chunks where they have some, and from
+  // the host data otherwise.
+  std::shared_ptr<DeviceBuffer> gather_on_device(int32_t loc, GPU_DFG *dfg) {
+    std::vector<Dependence *> pieces;
+    if (chunks.empty())
+      pieces.push_back(this);
+    else
+      pieces = chunks;
+    size_t data_size = 0;
+    for (auto p : pieces)
+      data_size += memref_get_data_size(p->host_data);
+    cudaStream_t *s = (cudaStream_t *)dfg->get_gpu_stream(loc);
+    char *ptr = (char *)cuda_malloc_async(data_size, s, loc);
+    size_t pos = 0;
+    for (auto p : pieces) {
+      size_t size = memref_get_data_size(p->host_data);
+      if (p->location > host_location && p->device_data != nullptr) {
+        cudaMemcpyPeerAsync(ptr + pos, loc, p->device_data, p->location, size,
+                            *s);
+      } else {
+        assert(p->onHostReady && "Data of a dependence is not available.");
+        cuda_memcpy_async_to_gpu(ptr + pos,
+                                 p->host_data.aligned + p->host_data.offset,
+                                 size, s, loc);
+      }
+      pos += size;
+    }
+    cudaStreamSynchronize(*s);
+    return std::make_shared<DeviceBuffer>(
+        ptr, data_size, loc,
+        [](void *ptr, int32_t gpu_idx) { cuda_drop(ptr, gpu_idx); });
+  }
 };
 
 // Set of input/output streams required to execute a process'
@@ -494,6 +588,64 @@ static inline void schedule_kernel(Process *p, int32_t loc, int32_t chunk_id,
                                    uint64_t *out_ptr) {
   p->fun(p, loc, chunk_id, out_ptr);
 }
+
+// Ratio of the throughput of a device over that of a host core, measured on
+// the previous executions of each kind of subgraph. Subgraphs are told apart
+// by the number of bootstraps, keyswitches and other processes they run, the
+// parameters of their bootstraps and their batch size rounded up to a power
+// of two.
+struct DeviceRatioTable {
+  typedef std::tuple<size_t, size_t, size_t, uint32_t, uint32_t, uint32_t,
+                     size_t>
+      Key;
+
+  static DeviceRatioTable &global() {
+    static DeviceRatioTable table;
+    return table;
+  }
+
+  static Key get_key(std::list<Process *> &queue, size_t num_samples) {
+    size_t bootstraps = 0, keyswitches = 0, others = 0;
+    uint32_t poly_size = 0, glwe_dim = 0, level = 0;
+    for (auto p : queue) {
+      if (p->fun == memref_bootstrap_lwe_u64_process) {
+        bootstraps++;
+        poly_size = p->poly_size.val;
+        glwe_dim = p->glwe_dim.val;
+        level = p->level.val;
+      } else if (p->fun == memref_keyswitch_lwe_u64_process) {
+        keyswitches++;
+      } else {
+        others++;
+      }
+    }
+    size_t bucket = 1;
+    while (bucket < num_samples)
+      bucket <<= 1;
+    return Key(bootstraps, keyswitches, others, poly_size, glwe_dim, level,
+               bucket);
+  }
+
+  double get(const Key &key) {
+    const std::lock_guard<std::mutex> lock(guard);
+    auto it = ratios.find(key);
+    return (it == ratios.end()) ? device_compute_factor : it->second;
+  }
+
+  // Blends the ratio measured on the last execution in the current one, so
+  // that a single noisy execution does not unbalance the next ones. A
+  // device is never given less work than a core.
+  void update(const Key &key, double measured) {
+    const std::lock_guard<std::mutex> lock(guard);
+    auto it = ratios.find(key);
+    double ratio = (it == ratios.end()) ? device_compute_factor : it->second;
+    ratios[key] = std::max(1.0, 0.5 * ratio + 0.5 * measured);
+  }
+
+private:
+  std::mutex guard;
+  std::map<Key, double> ratios;
+};
 struct Stream {
   Dependence *dep;
   Dependence *saved_dependence;
@@ -657,6 +809,20 @@ struct Stream {
     size_t num_chunks = 1;
     size_t num_gpu_chunks = 0;
     int32_t num_devices_to_use = 0;
+    const std::vector<int32_t> &devices = dfg->devices;
+    // The chunks of all inputs must match, inputs already split by the
+    // subgraph producing them impose their device to core ratio.
+    auto ratio_key = DeviceRatioTable::get_key(queue, num_samples);
+    double device_ratio = DeviceRatioTable::global().get(ratio_key);
+    Stream *samples_stream = nullptr;
+    for (auto s : inputs) {
+      if (s->const_stream || !s->ct_stream)
+        continue;
+      if (samples_stream == nullptr)
+        samples_stream = s;
+      if (s->dep->chunk_id == split_chunks && s->dep->split_ratio > 0)
+        device_ratio = s->dep->split_ratio;
+    }
     // If the subgraph does not have sufficient computational
     // intensity (which we approximate by whether it bootstraps), then
     // we assume (TODO: confirm with profiling) that it is not
@@ -667,33 +833,37 @@ struct Stream {
       size_t gpu_total_mem;
       // TODO: this could be improved
       // Force deallocation with a synchronization point
-      for (size_t g = 0; g < num_devices; ++g)
+      for (auto g : devices)
         cudaStreamSynchronize(*(cudaStream_t *)dfg->get_gpu_stream(g));
       auto status = cudaMemGetInfo(&gpu_free_mem, &gpu_total_mem);
       assert(status == cudaSuccess);
       // TODO - for now assume each device on the system has roughly same
       // available memory.
       size_t available_mem = gpu_free_mem;
+      if (dfg->memory_limit > 0)
+        available_mem = std::min(available_mem, (size_t)dfg->memory_limit);
       // Further assume (TODO) that kernel execution requires some
       // magic factor more meory per sample to execute
       size_t max_samples_per_chunk =
           (available_mem - const_mem_per_sample) /
           ((mem_per_sample ? mem_per_sample : 1) * gpu_memory_inflation_factor);
+      if (dfg->batch_size > 0)
+        max_samples_per_chunk =
+            std::min(max_samples_per_chunk, (size_t)dfg->batch_size);
+      max_samples_per_chunk = std::max(max_samples_per_chunk, (size_t)1);
 
-      if (num_samples < num_cores + device_compute_factor * num_devices) {
+      if (num_samples < num_cores + device_ratio * devices.size()) {
         num_devices_to_use = 0;
         num_chunks = std::min(num_cores, num_samples);
       } else {
-        num_devices_to_use = num_devices;
-        size_t compute_resources =
-            num_cores + num_devices * device_compute_factor;
+        num_devices_to_use = devices.size();
+        double compute_resources = num_cores + devices.size() * device_ratio;
         size_t gpu_chunk_size =
-            std::ceil((double)num_samples / compute_resources) *
-            device_compute_factor;
+            std::ceil(num_samples / compute_resources) * device_ratio;
         size_t scale_factor =
             std::ceil((double)gpu_chunk_size / max_samples_per_chunk);
         num_chunks = num_cores * scale_factor;
-        num_gpu_chunks = num_devices * scale_factor;
+        num_gpu_chunks = devices.size() * scale_factor;
       }
     } else {
       num_chunks = std::min(num_cores, num_samples);
@@ -701,13 +871,15 @@ struct Stream {
 
     for (auto i : inputs)
       i->dep->split_dependence(num_chunks, num_gpu_chunks,
-                               (i->ct_stream) ? 0 : 1, i->const_stream);
+                               (i->ct_stream) ? 0 : 1, i->const_stream,
+                               device_ratio);
     for (auto iv : intermediate_values) {
       if (iv->need_new_gen()) {
         iv->put(new Dependence(split_location,
                                {nullptr, nullptr, 0, {0, 0}, {0, 0}}, nullptr,
                                false, false, split_chunks));
         iv->dep->chunks.resize(num_chunks + num_gpu_chunks, nullptr);
+        iv->dep->split_ratio = device_ratio;
       }
     }
     for (auto o : outputs) {
@@ -716,54 +888,94 @@ struct Stream {
                               {nullptr, nullptr, 0, {0, 0}, {0, 0}}, nullptr,
                               false, false, split_chunks));
         o->dep->chunks.resize(num_chunks + num_gpu_chunks, nullptr);
+        o->dep->split_ratio = device_ratio;
       }
     }
 
-    // Execute graph
+    // When the calling thread keeps device copies of the values it gets, the
+    // outputs stay on their devices until they are gathered.
+    bool keep_outputs_on_device = DeviceValueScope::current() != nullptr;
+
+    // Execute graph. The host workers and the device schedulers pull the
+    // chunks from shared queues: host chunks are picked by the first idle
+    // worker and a device that runs out of chunks steals those of the other
+    // devices, then the host chunks not started yet. The host workers do
+    // not steal the chunks sized for devices, which they would finish after
+    // the devices.
+    std::atomic<size_t> next_host_chunk = {0};
+    std::mutex gpu_chunk_guard;
+    std::vector<std::deque<size_t>> gpu_chunk_list;
+    gpu_chunk_list.resize(devices.size());
+    for (size_t c = num_chunks; c < num_chunks + num_gpu_chunks; ++c)
+      gpu_chunk_list[(c - num_chunks) % devices.size()].push_back(c);
+    // The chunks of the devices are listed by position in `devices`.
+    auto next_gpu_chunk = [&](int32_t pos, size_t &c) {
+      {
+        const std::lock_guard<std::mutex> lock(gpu_chunk_guard);
+        for (size_t d = 0; d < devices.size(); ++d) {
+          auto &chunks = gpu_chunk_list[(pos + d) % devices.size()];
+          if (chunks.empty())
+            continue;
+          // Steal from the back, the owner takes its chunks from the front
+          if (d == 0) {
+            c = chunks.front();
+            chunks.pop_front();
+          } else {
+            c = chunks.back();
+            chunks.pop_back();
+          }
+          return true;
+        }
+      }
+      c = next_host_chunk++;
+      return c < num_chunks;
+    };
+    auto chunk_samples = [&](size_t c) -> size_t {
+      if (samples_stream == nullptr)
+        return 0;
+      return samples_stream->dep->chunks[c]->host_data.sizes[0];
+    };
+
+    // Busy time and samples processed by the host cores and the devices
+    typedef std::chrono::steady_clock clock;
+    std::mutex timing_guard;
+    double host_time = 0, device_time = 0;
+    size_t host_samples = 0, device_samples = 0;
+
     std::list<std::thread> workers;
     std::list<std::thread> gpu_schedulers;
-    std::vector<std::list<size_t>> gpu_chunk_list;
-    gpu_chunk_list.resize(num_devices);
-    int32_t dev = 0;
-    for (size_t c = 0; c < num_chunks + num_gpu_chunks; ++c) {
-      if (!subgraph_bootstraps) {
-        workers.push_back(std::thread(
-            [&](std::list<Process *> queue, size_t c, int32_t host_location) {
-              for (auto p : queue)
-                schedule_kernel(p, host_location, c, nullptr);
-              for (auto iv : intermediate_values)
-                if (iv->consumers.size() == 1)
-                  iv->dep->free_chunk_host_data(c, dfg);
-            },
-            queue, c, host_location));
-      } else {
-        if (c < num_chunks) {
-          workers.push_back(std::thread(
-              [&](std::list<Process *> queue, size_t c, int32_t host_location) {
-                for (auto p : queue) {
-                  schedule_kernel(p, host_location, c, nullptr);
-                }
-                for (auto iv : intermediate_values)
-                  if (iv->consumers.size() == 1)
-                    iv->dep->free_chunk_host_data(c, dfg);
-              },
-              queue, c, host_location));
-        } else {
-          // Gather per-device chunk list
-          gpu_chunk_list[dev++ % num_devices].push_back(c);
+    size_t num_workers = std::min(num_cores, num_chunks);
+    for (size_t w = 0; w < num_workers; ++w) {
+      workers.push_back(std::thread([&]() {
+        double time = 0;
+        size_t samples = 0;
+        for (size_t c = next_host_chunk++; c < num_chunks;
+             c = next_host_chunk++) {
+          auto start = clock::now();
+          for (auto p : queue)
+            schedule_kernel(p, host_location, c, nullptr);
+          for (auto iv : intermediate_values)
+            if (iv->consumers.size() == 1)
+              iv->dep->free_chunk_host_data(c, dfg);
+          time += std::chrono::duration<double>(clock::now() - start).count();
+          samples += chunk_samples(c);
         }
-      }
+        const std::lock_guard<std::mutex> lock(timing_guard);
+        host_time += time;
+        host_samples += samples;
+      }));
     }
-    for (dev = 0; dev < num_devices; ++dev) {
+    for (int32_t pos = 0; pos < num_devices_to_use; ++pos) {
       gpu_schedulers.push_back(std::thread(
-          [&](std::list<Process *> queue, int32_t dev) {
-            for (size_t c : gpu_chunk_list[dev]) {
-              size_t gpu_free_mem;
-              size_t gpu_total_mem;
+          [&](int32_t pos) {
+            int32_t dev = devices[pos];
+            double time = 0;
+            size_t samples = 0;
+            size_t c;
+            while (next_gpu_chunk(pos, c)) {
+              auto start = clock::now();
               auto status = cudaSetDevice(dev);
               assert(status == cudaSuccess);
-              cudaMemGetInfo(&gpu_free_mem, &gpu_total_mem);
-              assert(status == cudaSuccess);
               for (auto p : queue)
                 schedule_kernel(p, dev, c, nullptr);
               for (auto iv : intermediate_values)
@@ -772,11 +984,20 @@ struct Stream {
                 else
                   iv->dep->free_chunk_device_data(c, dfg);
               for (auto o : outputs)
-                o->dep->move_chunk_off_device(c, dfg);
+                if (keep_outputs_on_device)
+                  o->dep->chunks[c]->copy(host_location, dfg);
+                else
+                  o->dep->move_chunk_off_device(c, dfg);
               cudaStreamSynchronize(*(cudaStream_t *)dfg->get_gpu_stream(dev));
+              time +=
+                  std::chrono::duration<double>(clock::now() - start).count();
+              samples += chunk_samples(c);
             }
+            const std::lock_guard<std::mutex> lock(timing_guard);
+            device_time += time;
+            device_samples += samples;
           },
-          queue, dev));
+          pos));
     }
     for (auto &w : workers)
       w.join();
@@ -784,10 +1005,19 @@ struct Stream {
     for (auto &gs : gpu_schedulers)
       gs.join();
     gpu_schedulers.clear();
+    // Re-balance the next executions of this kind of subgraph on the
+    // throughputs measured on this one.
+    if (adaptive_device_ratio && host_samples > 0 && device_samples > 0 &&
+        host_time > 0 && device_time > 0)
+      DeviceRatioTable::global().update(
+          ratio_key,
+          (device_samples / device_time) / (host_samples / host_time));
     // Build output out of the separate chunks processed
     for (auto o : outputs) {
       assert(o->batched_stream && o->ct_stream &&
              "Only operations with ciphertext output supported.");
+      if (keep_outputs_on_device)
+        o->dep->device_copy = o->dep->gather_on_device(dfg->gpu_idx, dfg);
       o->dep->merge_dependence(dfg);
     }
     // We will assume that only one subgraph is being processed per
@@ -801,6 +1031,7 @@ struct Stream {
     // If this was already copied to host, copy out
     if (dep->onHostReady) {
       memref_copy_contiguous(out, dep->host_data);
+      bind_device_copy(out);
       return dep;
     } else if (dep->location == split_location) {
       char *pos = (char *)(out.aligned + out.offset);
@@ -833,8 +1064,19 @@ struct Stream {
       dep->host_data = memref_copy_alloc(out);
     dep->onHostReady = true;
     dep->hostAllocated = true;
+    bind_device_copy(out);
     return dep;
   }
+  // Binds the device copy of the ciphertexts got in `out` to the device value
+  // scope of the calling thread, if any.
+  void bind_device_copy(MemRef2 &out) {
+    DeviceValueScope *scope = DeviceValueScope::current();
+    if (scope == nullptr || !ct_stream)
+      return;
+    if (dep->device_copy == nullptr)
+      dep->device_copy = dep->gather_on_device(dfg->gpu_idx, dfg);
+    scope->bind(out.aligned + out.offset, dep->device_copy);
+  }
   Dependence *get(int32_t location, int32_t chunk_id = single_chunk) {
     assert(dep != nullptr && "Dependence could not be computed.");
     assert(chunk_id != split_chunks);
@@ -954,7 +1196,6 @@ sdfg_gpu_debug_compare_memref(MemRef2 &a, MemRef2 &b, char const *msg) {
 // Stream emulator processes
 void memref_keyswitch_lwe_u64_process(Process *p, int32_t loc, int32_t chunk_id,
                                       uint64_t *out_ptr) {
-  assert(p->sk_index.val == 0 && "multiple ksk is not yet implemented on GPU");
   auto sched = [&](Dependence *d) {
     uint64_t num_samples = d->host_data.sizes[0];
     MemRef2 out = {
@@ -981,7 +1222,8 @@ void memref_keyswitch_lwe_u64_process(Process *p, int32_t loc, int32_t chunk_id,
       void *ct0_gpu = d->device_data;
       void *out_gpu = cuda_malloc_async(data_size, s, loc);
       void *ksk_gpu = p->ctx.val->get_ksk_gpu(
-          p->level.val, p->input_lwe_dim.val, p->output_lwe_dim.val, loc, s);
+          p->level.val, p->input_lwe_dim.val, p->output_lwe_dim.val,
+          p->sk_index.val, loc, s);
       cuda_keyswitch_lwe_ciphertext_vector_64(
           s, loc, out_gpu, ct0_gpu, ksk_gpu, p->input_lwe_dim.val,
           p->output_lwe_dim.val, p->base_log.val, p->level.val, num_samples);
@@ -997,7 +1239,6 @@ void memref_keyswitch_lwe_u64_process(Process *p, int32_t loc, int32_t chunk_id,
 
 void memref_bootstrap_lwe_u64_process(Process *p, int32_t loc, int32_t chunk_id,
                                       uint64_t *out_ptr) {
-  assert(p->sk_index.val == 0 && "multiple bsk is not yet implemented on GPU");
   assert(p->output_size.val == p->glwe_dim.val * p->poly_size.val + 1);
 
   Dependence *idep1 = p->input_streams[1]->get(host_location, chunk_id);
@@ -1070,6 +1311,8 @@ void memref_bootstrap_lwe_u64_process(Process *p, int32_t loc, int32_t chunk_id,
       free(glwe_ct);
       return dep;
     } else {
+      assert(p->ctx.val->bootstrap_key_grouping_factor(p->sk_index.val) == 1 &&
+             "Multi-bit bootstrap keys are not supported by the GPU DFG");
       // Schedule the bootstrap kernel on the GPU
       void *glwe_ct_gpu = cuda_malloc_async(glwe_ct_size, s, loc);
       cuda_memcpy_async_to_gpu(glwe_ct_gpu, glwe_ct, glwe_ct_size, s, loc);
@@ -1081,9 +1324,9 @@ void memref_bootstrap_lwe_u64_process(Process *p, int32_t loc, int32_t chunk_id,
           p->glwe_dim.val, p->poly_size.val, num_samples);
       void *ct0_gpu = d0->device_data;
       void *out_gpu = cuda_malloc_async(data_size, s, loc);
-      void *fbsk_gpu =
-          p->ctx.val->get_bsk_gpu(p->input_lwe_dim.val, p->poly_size.val,
-                                  p->level.val, p->glwe_dim.val, loc, s);
+      void *fbsk_gpu = p->ctx.val->get_bsk_gpu(
+          p->input_lwe_dim.val, p->poly_size.val, p->level.val,
+          p->glwe_dim.val, p->sk_index.val, loc, s);
       cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
           s, loc, out_gpu, glwe_ct_gpu, test_vector_idxes_gpu, ct0_gpu,
           fbsk_gpu, (int8_t *)pbs_buffer, p->input_lwe_dim.val, p->glwe_dim.val,
@@ -1550,6 +1793,10 @@ void stream_emulator_put_memref(void *stream, uint64_t *allocated,
   MemRef2 m = {allocated, aligned, offset, {1, size}, {size, stride}};
   Dependence *dep =
       new Dependence(host_location, memref_copy_alloc(m), nullptr, true, true);
+  // Reuse the device copy of the value kept by a previous call, if any
+  if (DeviceValueScope *scope = DeviceValueScope::current())
+    dep->device_copy =
+        scope->lookup(aligned + offset, memref_get_data_size(m));
   s->put(dep);
   s->generation++;
 }
@@ -1579,6 +1826,10 @@ void stream_emulator_put_memref_batch(void *stream, uint64_t *allocated,
   MemRef2 m = {allocated, aligned, offset, {size0, size1}, {stride0, stride1}};
   Dependence *dep =
       new Dependence(host_location, memref_copy_alloc(m), nullptr, true, true);
+  // Reuse the device copy of the value kept by a previous call, if any
+  if (DeviceValueScope *scope = DeviceValueScope::current())
+    dep->device_copy =
+        scope->lookup(aligned + offset, memref_get_data_size(m));
   s->put(dep);
   s->generation++;
 }
@@ -1618,8 +1869,10 @@ void *stream_emulator_init() {
   }
 
   env = getenv("SDFG_DEVICE_TO_CORE_RATIO");
-  if (env != nullptr)
-    device_compute_factor = strtoul(env, NULL, 10);
+  if (env != nullptr && strtod(env, NULL) >= 1) {
+    device_compute_factor = strtod(env, NULL);
+    adaptive_device_ratio = false;
+  }
 
   hwloc_topology_t topology;
   hwloc_topology_init(&topology);
@@ -1634,8 +1887,39 @@ void *stream_emulator_init() {
   if (num_cores < 1)
     num_cores = 1;
 
-  int device = next_device.fetch_add(1) % num_devices;
-  return new GPU_DFG(device);
+  // Keep freed device memory in the memory pools of the devices, device
+  // buffers of the dependences are then recycled across executions.
+  std::call_once(gpu_pool_init, []() {
+    char *env = getenv("SDFG_GPU_POOL_RELEASE_THRESHOLD");
+    if (env != nullptr)
+      gpu_pool_release_threshold = strtoull(env, NULL, 10);
+    for (size_t i = 0; i < num_devices; ++i)
+      cuda_set_mem_pool_release_threshold(gpu_pool_release_threshold, i);
+  });
+
+  // The graph runs on the devices of the settings of the invocation, if any,
+  // its default device being assigned round-robin among them.
+  std::vector<int32_t> devices;
+  const DeviceSettings *settings = DeviceSettingsScope::current();
+  if (settings != nullptr) {
+    for (auto d : settings->devices) {
+      if (d >= 0 && (size_t)d < num_devices)
+        devices.push_back(d);
+      else
+        warnx("WARNING: ignoring device %d (%lu available).", d, num_devices);
+    }
+  }
+  if (devices.empty())
+    for (size_t d = 0; d < num_devices; ++d)
+      devices.push_back(d);
+  int device = devices[next_device.fetch_add(1) % devices.size()];
+  GPU_DFG *dfg = new GPU_DFG(device);
+  dfg->devices = devices;
+  if (settings != nullptr) {
+    dfg->memory_limit = settings->memoryLimit;
+    dfg->batch_size = settings->batchSize;
+  }
+  return dfg;
 }
 void stream_emulator_run(void *dfg) {}
 void stream_emulator_delete(void *dfg) { delete (GPU_DFG *)dfg; }
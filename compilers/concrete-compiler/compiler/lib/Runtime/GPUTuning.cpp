@@ -0,0 +1,268 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/GPUTuning.h"
+#include "bootstrap.h"
+#include "bootstrap_multibit.h"
+#include "device.h"
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mlir {
+namespace concretelang {
+namespace gpu_tuning {
+
+namespace {
+
+// Device name, polynomial size, glwe dimension, level, base log, and batch
+// size rounded up to a power of two.
+typedef std::tuple<std::string, uint32_t, uint32_t, uint32_t, uint32_t,
+                   uint32_t>
+    TuningKey;
+
+const uint32_t BENCHMARK_RUNS = 3;
+
+uint32_t batch_bucket(uint32_t num_samples) {
+  uint32_t bucket = 1;
+  while (bucket < num_samples)
+    bucket <<= 1;
+  return bucket;
+}
+
+std::string device_name(uint32_t gpu_idx) {
+  cudaDeviceProp prop;
+  cudaGetDeviceProperties(&prop, gpu_idx);
+  std::string name(prop.name);
+  // The table is whitespace separated
+  for (auto &c : name)
+    if (c == ' ')
+      c = '_';
+  return name;
+}
+
+/// The tuning table, shared by all the devices of the process.
+struct TuningTable {
+  static TuningTable &global() {
+    static TuningTable table;
+    return table;
+  }
+
+  std::mutex guard;
+  std::map<TuningKey, PBSConfig> configs;
+
+  TuningTable() {
+    char *env = getenv("GPU_PBS_TUNING_FILE");
+    if (env == nullptr)
+      return;
+    path = env;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream fields(line);
+      std::string name;
+      uint32_t poly_size, glwe_dim, level, base_log, bucket, variant,
+          max_shared_memory;
+      if (fields >> name >> poly_size >> glwe_dim >> level >> base_log >>
+          bucket >> variant >> max_shared_memory) {
+        configs[{name, poly_size, glwe_dim, level, base_log, bucket}] = {
+            (PBSVariant)variant, max_shared_memory, 1};
+      }
+    }
+  }
+
+  /// Appends an entry to the tuning file, if any.
+  void save(const TuningKey &key, PBSConfig config) {
+    if (path.empty())
+      return;
+    std::ofstream out(path, std::ofstream::app);
+    out << std::get<0>(key) << " " << std::get<1>(key) << " "
+        << std::get<2>(key) << " " << std::get<3>(key) << " "
+        << std::get<4>(key) << " " << std::get<5>(key) << " "
+        << (uint32_t)config.variant << " " << config.max_shared_memory
+        << "\n";
+  }
+
+private:
+  std::string path;
+};
+
+/// Returns the time in milliseconds of a run of the PBS kernels of `config`
+/// on `num_samples` trivial ciphertexts.
+float benchmark_pbs(PBSConfig config, uint32_t gpu_idx, void *stream,
+                    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+                    uint32_t base_log, uint32_t glwe_dim, uint32_t num_samples,
+                    void *fbsk_gpu) {
+  auto s = (cudaStream_t *)stream;
+  uint64_t ct0_size = num_samples * (input_lwe_dim + 1) * sizeof(uint64_t);
+  uint64_t out_size =
+      num_samples * (glwe_dim * poly_size + 1) * sizeof(uint64_t);
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1) * sizeof(uint64_t);
+  uint64_t idxes_size = num_samples * sizeof(uint64_t);
+  void *ct0_gpu = cuda_malloc_async(ct0_size, s, gpu_idx);
+  void *out_gpu = cuda_malloc_async(out_size, s, gpu_idx);
+  void *glwe_ct_gpu = cuda_malloc_async(glwe_ct_size, s, gpu_idx);
+  void *idxes_gpu = cuda_malloc_async(idxes_size, s, gpu_idx);
+  cuda_memset_async(ct0_gpu, 0, ct0_size, s, gpu_idx);
+  cuda_memset_async(glwe_ct_gpu, 0, glwe_ct_size, s, gpu_idx);
+  cuda_memset_async(idxes_gpu, 0, idxes_size, s, gpu_idx);
+
+  int8_t *pbs_buffer = nullptr;
+  scratch_pbs(config, stream, gpu_idx, &pbs_buffer, input_lwe_dim, glwe_dim,
+              poly_size, level, num_samples);
+  auto run = [&]() {
+    run_pbs(config, stream, gpu_idx, out_gpu, glwe_ct_gpu, idxes_gpu, ct0_gpu,
+            fbsk_gpu, pbs_buffer, input_lwe_dim, glwe_dim, poly_size, base_log,
+            level, num_samples, 1, 0);
+  };
+  // Warm up, so that the one time kernel configuration is not measured
+  run();
+  cudaEvent_t start, stop;
+  cudaEventCreate(&start);
+  cudaEventCreate(&stop);
+  cudaEventRecord(start, *s);
+  for (uint32_t i = 0; i < BENCHMARK_RUNS; i++)
+    run();
+  cudaEventRecord(stop, *s);
+  cudaEventSynchronize(stop);
+  float elapsed = 0;
+  cudaEventElapsedTime(&elapsed, start, stop);
+  cudaEventDestroy(start);
+  cudaEventDestroy(stop);
+
+  cleanup_pbs(config, stream, gpu_idx, &pbs_buffer);
+  cuda_drop_async(ct0_gpu, s, gpu_idx);
+  cuda_drop_async(out_gpu, s, gpu_idx);
+  cuda_drop_async(glwe_ct_gpu, s, gpu_idx);
+  cuda_drop_async(idxes_gpu, s, gpu_idx);
+  cudaStreamSynchronize(*s);
+  return elapsed / BENCHMARK_RUNS;
+}
+
+} // namespace
+
+PBSConfig select_pbs_config(uint32_t gpu_idx, void *stream,
+                            uint32_t input_lwe_dim, uint32_t poly_size,
+                            uint32_t level, uint32_t base_log,
+                            uint32_t glwe_dim, uint32_t grouping_factor,
+                            uint32_t num_samples, void *fbsk_gpu) {
+  static bool autotune = getenv("GPU_PBS_AUTOTUNE") != nullptr;
+  uint32_t max_shared_memory = cuda_get_max_shared_memory(gpu_idx);
+  if (grouping_factor > 1)
+    return {PBSVariant::MultiBit, max_shared_memory, grouping_factor};
+  PBSConfig config = {PBSVariant::Amortized, max_shared_memory, 1};
+
+  auto &table = TuningTable::global();
+  // Tuning holds the lock, so that concurrent launches do not benchmark the
+  // same entry or disturb each other's measurements.
+  const std::lock_guard<std::mutex> lock(table.guard);
+  TuningKey key(device_name(gpu_idx), poly_size, glwe_dim, level, base_log,
+                batch_bucket(num_samples));
+  auto it = table.configs.find(key);
+  if (it != table.configs.end())
+    return it->second;
+  if (!autotune)
+    return config;
+
+  // Benchmark each variant, with and without shared memory.
+  std::vector<PBSConfig> candidates;
+  for (auto variant : {PBSVariant::Amortized, PBSVariant::LowLatency}) {
+    candidates.push_back({variant, max_shared_memory, 1});
+    candidates.push_back({variant, 0, 1});
+  }
+  float best = -1;
+  for (auto candidate : candidates) {
+    float elapsed =
+        benchmark_pbs(candidate, gpu_idx, stream, input_lwe_dim, poly_size,
+                      level, base_log, glwe_dim, std::get<5>(key), fbsk_gpu);
+    if (best < 0 || elapsed < best) {
+      best = elapsed;
+      config = candidate;
+    }
+  }
+  table.configs[key] = config;
+  table.save(key, config);
+  return config;
+}
+
+void scratch_pbs(PBSConfig config, void *stream, uint32_t gpu_idx,
+                 int8_t **pbs_buffer, uint32_t input_lwe_dim,
+                 uint32_t glwe_dim, uint32_t poly_size, uint32_t level,
+                 uint32_t num_samples) {
+  switch (config.variant) {
+  case PBSVariant::Amortized:
+    scratch_cuda_bootstrap_amortized_64(stream, gpu_idx, pbs_buffer, glwe_dim,
+                                        poly_size, num_samples,
+                                        config.max_shared_memory, true);
+    break;
+  case PBSVariant::LowLatency:
+    scratch_cuda_bootstrap_low_latency_64(stream, gpu_idx, pbs_buffer,
+                                          glwe_dim, poly_size, level,
+                                          num_samples,
+                                          config.max_shared_memory, true);
+    break;
+  case PBSVariant::MultiBit:
+    scratch_cuda_multi_bit_pbs_64(stream, gpu_idx, pbs_buffer, input_lwe_dim,
+                                  glwe_dim, poly_size, level,
+                                  config.grouping_factor, num_samples,
+                                  config.max_shared_memory, true);
+    break;
+  }
+}
+
+void run_pbs(PBSConfig config, void *stream, uint32_t gpu_idx, void *out_gpu,
+             void *glwe_ct_gpu, void *test_vector_idxes_gpu, void *ct0_gpu,
+             void *fbsk_gpu, int8_t *pbs_buffer, uint32_t input_lwe_dim,
+             uint32_t glwe_dim, uint32_t poly_size, uint32_t base_log,
+             uint32_t level, uint32_t num_samples, uint32_t num_test_vectors,
+             uint32_t lwe_idx) {
+  switch (config.variant) {
+  case PBSVariant::Amortized:
+    cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
+        stream, gpu_idx, out_gpu, glwe_ct_gpu, test_vector_idxes_gpu, ct0_gpu,
+        fbsk_gpu, pbs_buffer, input_lwe_dim, glwe_dim, poly_size, base_log,
+        level, num_samples, num_test_vectors, lwe_idx,
+        config.max_shared_memory);
+    break;
+  case PBSVariant::LowLatency:
+    cuda_bootstrap_low_latency_lwe_ciphertext_vector_64(
+        stream, gpu_idx, out_gpu, glwe_ct_gpu, test_vector_idxes_gpu, ct0_gpu,
+        fbsk_gpu, pbs_buffer, input_lwe_dim, glwe_dim, poly_size, base_log,
+        level, num_samples, num_test_vectors, lwe_idx,
+        config.max_shared_memory);
+    break;
+  case PBSVariant::MultiBit:
+    cuda_multi_bit_pbs_lwe_ciphertext_vector_64(
+        stream, gpu_idx, out_gpu, glwe_ct_gpu, test_vector_idxes_gpu, ct0_gpu,
+        fbsk_gpu, pbs_buffer, input_lwe_dim, glwe_dim, poly_size,
+        config.grouping_factor, base_log, level, num_samples, num_test_vectors,
+        lwe_idx, config.max_shared_memory);
+    break;
+  }
+}
+
+void cleanup_pbs(PBSConfig config, void *stream, uint32_t gpu_idx,
+                 int8_t **pbs_buffer) {
+  switch (config.variant) {
+  case PBSVariant::Amortized:
+    cleanup_cuda_bootstrap_amortized(stream, gpu_idx, pbs_buffer);
+    break;
+  case PBSVariant::LowLatency:
+    cleanup_cuda_bootstrap_low_latency(stream, gpu_idx, pbs_buffer);
+    break;
+  case PBSVariant::MultiBit:
+    cleanup_cuda_multi_bit_pbs(stream, gpu_idx, pbs_buffer);
+    break;
+  }
+}
+
+} // namespace gpu_tuning
+} // namespace concretelang
+} // namespace mlir
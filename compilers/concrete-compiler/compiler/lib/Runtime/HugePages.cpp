@@ -0,0 +1,106 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/HugePages.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+namespace mlir {
+namespace concretelang {
+namespace huge_pages {
+
+namespace {
+
+/// The transparent huge pages are only used by the kernel for the aligned
+/// 2 MiB ranges.
+size_t page_size(Mode mode) {
+  return (mode == Mode::HUGETLB_1G) ? size_t(1) << 30 : size_t(1) << 21;
+}
+
+size_t round_up(size_t size, size_t page) {
+  return (size + page - 1) / page * page;
+}
+
+/// Maps `size` bytes of the hugetlbfs pool, null if it has not enough pages.
+void *map_hugetlb(size_t size, Mode mode) {
+#ifdef MAP_HUGETLB
+  int log_page = (mode == Mode::HUGETLB_1G) ? 30 : 21;
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                       (log_page << MAP_HUGE_SHIFT),
+                   -1, 0);
+  return (ptr != MAP_FAILED) ? ptr : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+/// Maps `size` bytes advised as transparent huge pages.
+void *map_transparent(size_t size) {
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+  advise(ptr, size);
+  return ptr;
+}
+
+} // namespace
+
+Mode mode() {
+  static Mode mode = []() {
+    char *env = getenv("RUNTIME_HUGE_PAGES");
+    if (env == nullptr || strcmp(env, "0") == 0 || strcmp(env, "") == 0)
+      return Mode::NONE;
+    if (strcmp(env, "thp") == 0)
+      return Mode::TRANSPARENT;
+    if (strcmp(env, "2m") == 0)
+      return Mode::HUGETLB_2M;
+    if (strcmp(env, "1g") == 0)
+      return Mode::HUGETLB_1G;
+    fprintf(stderr,
+            "Runtime: unknown RUNTIME_HUGE_PAGES %s, using transparent huge "
+            "pages\n",
+            env);
+    return Mode::TRANSPARENT;
+  }();
+  return mode;
+}
+
+void *alloc(size_t size) {
+  // The fallback is rounded as the hugetlbfs pages, so that `free` unmaps
+  // the same range whichever backing was used. The untouched pages of the
+  // rounding are never faulted in.
+  Mode current = mode();
+  size = round_up(size, page_size(current));
+  if (current == Mode::HUGETLB_2M || current == Mode::HUGETLB_1G) {
+    void *ptr = map_hugetlb(size, current);
+    if (ptr != nullptr)
+      return ptr;
+  }
+  return map_transparent(size);
+}
+
+void free(void *ptr, size_t size) {
+  if (ptr != nullptr)
+    munmap(ptr, round_up(size, page_size(mode())));
+}
+
+void advise(void *ptr, size_t size) {
+#ifdef MADV_HUGEPAGE
+  if (mode() != Mode::NONE)
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+}
+
+} // namespace huge_pages
+} // namespace concretelang
+} // namespace mlir
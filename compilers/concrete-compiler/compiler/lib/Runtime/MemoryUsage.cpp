@@ -0,0 +1,106 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/MemoryUsage.h"
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace mlir {
+namespace concretelang {
+namespace memory {
+
+namespace {
+
+struct Counter {
+  std::atomic<uint64_t> live{0};
+  std::atomic<uint64_t> peak{0};
+};
+
+// Never destroyed, as keys may be released after the static destructors
+std::array<Counter, num_categories> &counters() {
+  static auto *counters = new std::array<Counter, num_categories>;
+  return *counters;
+}
+
+std::atomic<uint64_t> host_live{0};
+
+std::atomic<uint64_t> &host_limit() {
+  static std::atomic<uint64_t> limit{[]() -> uint64_t {
+    char *env = getenv("RUNTIME_MEMORY_LIMIT");
+    return env != nullptr ? strtoull(env, nullptr, 10) : 0;
+  }()};
+  return limit;
+}
+
+bool is_host(Category category) { return category != Category::GPU; }
+
+} // namespace
+
+const char *category_name(Category category) {
+  switch (category) {
+  case Category::KEYS:
+    return "keys";
+  case Category::CIPHERTEXTS:
+    return "ciphertexts";
+  case Category::SCRATCH:
+    return "scratch";
+  case Category::GPU:
+    return "gpu";
+  }
+  return "unknown";
+}
+
+void allocate(Category category, size_t bytes) {
+  auto &counter = counters()[(size_t)category];
+  uint64_t live = counter.live.fetch_add(bytes) + bytes;
+  uint64_t peak = counter.peak.load();
+  while (peak < live && !counter.peak.compare_exchange_weak(peak, live))
+    ;
+  if (!is_host(category))
+    return;
+  uint64_t host = host_live.fetch_add(bytes) + bytes;
+  uint64_t limit = host_limit().load(std::memory_order_relaxed);
+  if (limit != 0 && host > limit) {
+    fprintf(stderr,
+            "Runtime: allocating %zu bytes of %s exceeds the memory limit of "
+            "%llu bytes\n",
+            bytes, category_name(category), (unsigned long long)limit);
+    abort();
+  }
+}
+
+void release(Category category, size_t bytes) {
+  counters()[(size_t)category].live -= bytes;
+  if (is_host(category))
+    host_live -= bytes;
+}
+
+std::array<Usage, num_categories> usage() {
+  std::array<Usage, num_categories> usage;
+  for (size_t i = 0; i < num_categories; i++) {
+    usage[i].live_bytes = counters()[i].live;
+    usage[i].peak_bytes = counters()[i].peak;
+  }
+  return usage;
+}
+
+void reset_peaks() {
+  for (auto &counter : counters())
+    counter.peak = counter.live.load();
+}
+
+void set_limit(uint64_t bytes) { host_limit() = bytes; }
+
+uint64_t limit() { return host_limit(); }
+
+bool fits(size_t bytes) {
+  uint64_t limit = host_limit();
+  return limit == 0 || host_live + bytes <= limit;
+}
+
+} // namespace memory
+} // namespace concretelang
+} // namespace mlir
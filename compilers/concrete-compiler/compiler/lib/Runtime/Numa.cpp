@@ -0,0 +1,107 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/Numa.h"
+#include <hwloc.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace mlir {
+namespace concretelang {
+namespace numa {
+
+namespace {
+
+/// The topology of the machine, with the NUMA node of each processing unit.
+struct Topology {
+  static Topology &global() {
+    static Topology topology;
+    return topology;
+  }
+
+  hwloc_topology_t topology;
+  std::vector<hwloc_obj_t> nodes;
+  std::vector<size_t> node_of_pu;
+
+  Topology() {
+    hwloc_topology_init(&topology);
+    hwloc_topology_load(topology);
+    int count = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_NUMANODE);
+    for (int i = 0; i < count; i++) {
+      hwloc_obj_t node = hwloc_get_obj_by_type(topology, HWLOC_OBJ_NUMANODE, i);
+      unsigned pu;
+      hwloc_bitmap_foreach_begin(pu, node->cpuset) {
+        if (pu >= node_of_pu.size())
+          node_of_pu.resize(pu + 1, 0);
+        node_of_pu[pu] = i;
+      }
+      hwloc_bitmap_foreach_end();
+      nodes.push_back(node);
+    }
+  }
+
+  ~Topology() { hwloc_topology_destroy(topology); }
+};
+
+bool env_enabled(const char *name) {
+  char *env = getenv(name);
+  return env != nullptr && strtoul(env, NULL, 10) != 0;
+}
+
+} // namespace
+
+size_t num_nodes() {
+  size_t count = Topology::global().nodes.size();
+  return (count > 0) ? count : 1;
+}
+
+size_t current_node() {
+  auto &topology = Topology::global();
+  int pu = sched_getcpu();
+  if (pu < 0 || (size_t)pu >= topology.node_of_pu.size())
+    return 0;
+  return topology.node_of_pu[pu];
+}
+
+bool replicate_keys() {
+  static bool replicate =
+      env_enabled("RUNTIME_NUMA_REPLICATE_KEYS") && num_nodes() > 1;
+  return replicate;
+}
+
+bool bind_workers() {
+  static bool bind = env_enabled("RUNTIME_NUMA_BIND");
+  return bind;
+}
+
+void bind_worker(size_t index, size_t count) {
+  auto &topology = Topology::global();
+  if (topology.nodes.empty() || count == 0)
+    return;
+  // Consecutive workers share a node, as they tend to share data.
+  size_t node = index * topology.nodes.size() / count;
+  hwloc_set_cpubind(topology.topology, topology.nodes[node]->cpuset,
+                    HWLOC_CPUBIND_THREAD);
+}
+
+void *alloc_on_node(size_t size, size_t node) {
+  auto &topology = Topology::global();
+  if (node >= topology.nodes.size())
+    return hwloc_alloc(topology.topology, size);
+  void *ptr = hwloc_alloc_membind(topology.topology, size,
+                                  topology.nodes[node]->nodeset,
+                                  HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET);
+  // Fall back to the default policy if the binding is not supported.
+  return (ptr != nullptr) ? ptr : hwloc_alloc(topology.topology, size);
+}
+
+void free_on_node(void *ptr, size_t size) {
+  hwloc_free(Topology::global().topology, ptr, size);
+}
+
+} // namespace numa
+} // namespace concretelang
+} // namespace mlir
@@ -0,0 +1,232 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/PreparedKeyset.h"
+#include "concrete-cpu.h"
+#include "concretelang/Runtime/context.h"
+#include <fcntl.h>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using ::concretelang::error::Result;
+using ::concretelang::error::StringError;
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+const char PREPARED_KEYSET_MAGIC[8] = {'C', 'O', 'N', 'C', 'P', 'R', 'E', 'P'};
+const uint64_t PREPARED_KEYSET_VERSION = 1;
+const uint64_t PREPARED_KEYSET_ALIGN = 4096;
+
+struct Header {
+  char magic[8];
+  uint64_t version;
+  uint64_t bskCount;
+  uint64_t kskCount;
+};
+
+struct Section {
+  uint64_t offset;
+  uint64_t size;
+};
+
+uint64_t alignUp(uint64_t value) {
+  return (value + PREPARED_KEYSET_ALIGN - 1) / PREPARED_KEYSET_ALIGN *
+         PREPARED_KEYSET_ALIGN;
+}
+
+uint64_t fourierBootstrapKeySize(const LweBootstrapKey &bsk) {
+  auto params = bsk.getInfo().asReader().getParams();
+  if (params.getGroupingFactor() > 1) {
+    return concrete_cpu_fourier_multi_bit_bootstrap_key_size_u64(
+               params.getLevelCount(), params.getGlweDimension(),
+               params.getPolynomialSize(), params.getInputLweDimension(),
+               params.getGroupingFactor()) *
+           sizeof(std::complex<double>);
+  }
+  // Two words of the standard key fold in a single complex.
+  return concrete_cpu_bootstrap_key_size_u64(
+             params.getLevelCount(), params.getGlweDimension(),
+             params.getPolynomialSize(), params.getInputLweDimension()) /
+         2 * sizeof(std::complex<double>);
+}
+
+uint64_t keyswitchKeySize(const LweKeyswitchKey &ksk) {
+  auto params = ksk.getInfo().asReader().getParams();
+  // The fast keyswitch keys are kept in the standard domain as well, they are
+  // converted by the contexts on their first use.
+  if (params.getOutputPolynomialSize() > 0) {
+    return concrete_cpu_fast_keyswitch_key_size_u64(
+               params.getLevelCount(), params.getInputLweDimension(),
+               params.getOutputLweDimension() /
+                   params.getOutputPolynomialSize(),
+               params.getOutputPolynomialSize()) *
+           sizeof(uint64_t);
+  }
+  return concrete_cpu_keyswitch_key_size_u64(params.getLevelCount(),
+                                             params.getInputLweDimension(),
+                                             params.getOutputLweDimension()) *
+         sizeof(uint64_t);
+}
+
+/// Returns the expected size of the sections, bootstrap keys first.
+std::vector<uint64_t> expectedSectionSizes(const ServerKeyset &serverKeyset) {
+  std::vector<uint64_t> sizes;
+  for (auto &bsk : serverKeyset.lweBootstrapKeys) {
+    sizes.push_back(fourierBootstrapKeySize(bsk));
+  }
+  for (auto &ksk : serverKeyset.lweKeyswitchKeys) {
+    sizes.push_back(keyswitchKeySize(ksk));
+  }
+  return sizes;
+}
+} // namespace
+
+PreparedKeyset::~PreparedKeyset() {
+  if (mapping != nullptr) {
+    munmap((void *)mapping, mappingSize);
+  }
+}
+
+Result<void> PreparedKeyset::write(const ServerKeyset &serverKeyset,
+                                   const std::string &path) {
+  RuntimeContext context(serverKeyset);
+  auto sizes = expectedSectionSizes(serverKeyset);
+  size_t bskCount = serverKeyset.lweBootstrapKeys.size();
+
+  Header header;
+  memcpy(header.magic, PREPARED_KEYSET_MAGIC, sizeof(header.magic));
+  header.version = PREPARED_KEYSET_VERSION;
+  header.bskCount = bskCount;
+  header.kskCount = serverKeyset.lweKeyswitchKeys.size();
+
+  std::vector<Section> sections;
+  uint64_t offset = sizeof(Header) + sizes.size() * sizeof(Section);
+  for (auto size : sizes) {
+    offset = alignUp(offset);
+    sections.push_back({offset, size});
+    offset += size;
+  }
+
+  std::ofstream out(path, std::ofstream::binary);
+  if (!out) {
+    return StringError("Cannot save prepared keyset at path: ") << path;
+  }
+  out.write((const char *)&header, sizeof(header));
+  out.write((const char *)sections.data(), sections.size() * sizeof(Section));
+  for (size_t i = 0; i < sections.size(); i++) {
+    const char *payload =
+        i < bskCount
+            ? (const char *)context.fourier_bootstrap_key_buffer(i)
+            : (const char *)context.keyswitch_key_buffer(i - bskCount);
+    out.seekp(sections[i].offset);
+    out.write(payload, sections[i].size);
+  }
+  out.close();
+  if (out.fail()) {
+    return StringError("Cannot save prepared keyset at path: ") << path;
+  }
+  return outcome::success();
+}
+
+Result<std::shared_ptr<PreparedKeyset>>
+PreparedKeyset::open(const std::string &path,
+                     const ServerKeyset &serverKeyset) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return StringError("Cannot open prepared keyset at path: ") << path;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+    ::close(fd);
+    return StringError("Invalid prepared keyset at path: ") << path;
+  }
+  void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid once the file descriptor is closed.
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return StringError("Cannot map prepared keyset at path: ") << path;
+  }
+
+  std::shared_ptr<PreparedKeyset> prepared(new PreparedKeyset());
+  prepared->mapping = (const uint8_t *)mapping;
+  prepared->mappingSize = st.st_size;
+
+  auto header = (const Header *)prepared->mapping;
+  if (memcmp(header->magic, PREPARED_KEYSET_MAGIC, sizeof(header->magic)) !=
+          0 ||
+      header->version != PREPARED_KEYSET_VERSION) {
+    return StringError("Invalid prepared keyset at path: ") << path;
+  }
+  if (header->bskCount != serverKeyset.lweBootstrapKeys.size() ||
+      header->kskCount != serverKeyset.lweKeyswitchKeys.size()) {
+    return StringError("The prepared keyset at path ")
+           << path << " does not match the server keyset";
+  }
+
+  auto sizes = expectedSectionSizes(serverKeyset);
+  if (sizeof(Header) + sizes.size() * sizeof(Section) > prepared->mappingSize) {
+    return StringError("Invalid prepared keyset at path: ") << path;
+  }
+  auto sections = (const Section *)(prepared->mapping + sizeof(Header));
+  for (size_t i = 0; i < sizes.size(); i++) {
+    auto section = sections[i];
+    if (section.offset % PREPARED_KEYSET_ALIGN != 0 ||
+        section.offset > prepared->mappingSize ||
+        section.size > prepared->mappingSize - section.offset) {
+      return StringError("Invalid prepared keyset at path: ") << path;
+    }
+    if (section.size != sizes[i]) {
+      return StringError("The prepared keyset at path ")
+             << path << " does not match the server keyset";
+    }
+    auto payload = prepared->mapping + section.offset;
+    if (i < header->bskCount) {
+      prepared->fourierBootstrapKeys.push_back(
+          (const std::complex<double> *)payload);
+    } else {
+      prepared->keyswitchKeys.push_back((const uint64_t *)payload);
+    }
+  }
+  return prepared;
+}
+
+Result<std::shared_ptr<PreparedKeyset>>
+PreparedKeyset::openOrWrite(const std::string &path,
+                            const ServerKeyset &serverKeyset) {
+  auto prepared = open(path, serverKeyset);
+  if (prepared.has_value()) {
+    return prepared;
+  }
+  // Written aside then renamed, so that a concurrent reader never maps a
+  // partial file.
+  std::string incompletePath =
+      path + ".incomplete." + std::to_string(getpid());
+  OUTCOME_TRYV(write(serverKeyset, incompletePath));
+  if (::rename(incompletePath.c_str(), path.c_str()) != 0) {
+    ::unlink(incompletePath.c_str());
+    return StringError("Cannot save prepared keyset at path: ") << path;
+  }
+  return open(path, serverKeyset);
+}
+
+const std::complex<double> *
+PreparedKeyset::fourierBootstrapKey(size_t keyId) const {
+  assert(keyId < fourierBootstrapKeys.size());
+  return fourierBootstrapKeys[keyId];
+}
+
+const uint64_t *PreparedKeyset::keyswitchKey(size_t keyId) const {
+  assert(keyId < keyswitchKeys.size());
+  return keyswitchKeys[keyId];
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -0,0 +1,239 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <unistd.h>
+
+namespace mlir {
+namespace concretelang {
+namespace profiler {
+
+namespace {
+
+std::atomic<bool> is_enabled{false};
+std::atomic<bool> is_tracing{false};
+
+/// The ciphertexts of a primitive computed with some parameters.
+struct Cost {
+  uint64_t count = 0;
+  uint64_t thread_ns = 0;
+};
+
+using CostKey = std::pair<Primitive, CostParameters>;
+
+/// The calls recorded by a thread. Its mutex is only contended while the
+/// statistics are collected.
+struct Recorder {
+  std::mutex mutex;
+  std::array<Statistics, num_primitives> stats;
+  std::vector<Event> events;
+  std::map<CostKey, Cost> costs;
+  uint32_t thread = 0;
+
+  void merge(Recorder &other) {
+    for (size_t i = 0; i < num_primitives; i++) {
+      stats[i].calls += other.stats[i].calls;
+      stats[i].total_ns += other.stats[i].total_ns;
+      stats[i].max_ns = std::max(stats[i].max_ns, other.stats[i].max_ns);
+    }
+    events.insert(events.end(), other.events.begin(), other.events.end());
+    mergeCosts(other);
+  }
+
+  void mergeCosts(Recorder &other) {
+    for (auto &[key, cost] : other.costs) {
+      costs[key].count += cost.count;
+      costs[key].thread_ns += cost.thread_ns;
+    }
+  }
+
+  void clear() {
+    stats = {};
+    events.clear();
+    costs.clear();
+  }
+};
+
+/// The recorders of the live threads, and what the exited ones recorded.
+struct Registry {
+  // Never destroyed, as the threads may exit after the static destructors
+  static Registry &global() {
+    static Registry *registry = new Registry;
+    return *registry;
+  }
+
+  std::mutex mutex;
+  std::vector<Recorder *> live;
+  Recorder exited;
+  uint32_t next_thread = 0;
+};
+
+/// Registers the recorder of the thread on its first call.
+struct ThreadRecorder {
+  ThreadRecorder() {
+    auto &registry = Registry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    recorder.thread = registry.next_thread++;
+    registry.live.push_back(&recorder);
+  }
+
+  ~ThreadRecorder() {
+    auto &registry = Registry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto &live = registry.live;
+    live.erase(std::find(live.begin(), live.end(), &recorder));
+    std::lock_guard<std::mutex> recorderLock(recorder.mutex);
+    registry.exited.merge(recorder);
+  }
+
+  Recorder recorder;
+};
+
+Recorder &thread_recorder() {
+  thread_local ThreadRecorder thread_recorder;
+  return thread_recorder.recorder;
+}
+
+} // namespace
+
+const char *primitive_name(Primitive primitive) {
+  switch (primitive) {
+  case Primitive::KEYSWITCH:
+    return "keyswitch";
+  case Primitive::BOOTSTRAP:
+    return "bootstrap";
+  case Primitive::LEVELED:
+    return "leveled";
+  case Primitive::TRANSFORMER:
+    return "transformer";
+  case Primitive::COPY:
+    return "copy";
+  case Primitive::DEVICE_COPY:
+    return "device_copy";
+  }
+  return "unknown";
+}
+
+void set_enabled(bool enabled, bool trace) {
+  is_tracing = enabled && trace;
+  is_enabled = enabled;
+}
+
+bool enabled() { return is_enabled.load(std::memory_order_relaxed); }
+
+void record(Primitive primitive, uint64_t start_ns, uint64_t duration_ns) {
+  auto &recorder = thread_recorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  auto &stats = recorder.stats[(size_t)primitive];
+  stats.calls++;
+  stats.total_ns += duration_ns;
+  stats.max_ns = std::max(stats.max_ns, duration_ns);
+  if (is_tracing.load(std::memory_order_relaxed))
+    recorder.events.push_back(
+        {primitive, recorder.thread, start_ns, duration_ns});
+}
+
+void record_cost(Primitive primitive, const CostParameters &parameters,
+                 uint64_t count, uint64_t thread_ns) {
+  auto &recorder = thread_recorder();
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  auto &cost = recorder.costs[{primitive, parameters}];
+  cost.count += count;
+  cost.thread_ns += thread_ns;
+}
+
+std::string cost_table() {
+  auto &registry = Registry::global();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Recorder total;
+  total.mergeCosts(registry.exited);
+  for (auto recorder : registry.live) {
+    std::lock_guard<std::mutex> recorderLock(recorder->mutex);
+    total.mergeCosts(*recorder);
+  }
+  std::ostringstream table;
+  table << "# ks <input_lwe_dimension> <output_lwe_dimension> <level> "
+           "<log2_base> <ns>\n"
+           "# pbs <internal_lwe_dimension> <glwe_dimension> "
+           "<log2_polynomial_size> <level> <log2_base> <ns>\n";
+  for (auto &[key, cost] : total.costs) {
+    bool keyswitch = key.first == Primitive::KEYSWITCH;
+    table << (keyswitch ? "ks" : "pbs");
+    for (size_t i = 0; i < (keyswitch ? 4 : 5); i++)
+      table << " " << key.second[i];
+    table << " " << cost.thread_ns / cost.count << "\n";
+  }
+  return table.str();
+}
+
+std::array<Statistics, num_primitives> statistics() {
+  auto &registry = Registry::global();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  Recorder total;
+  total.stats = registry.exited.stats;
+  for (auto recorder : registry.live) {
+    std::lock_guard<std::mutex> recorderLock(recorder->mutex);
+    for (size_t i = 0; i < num_primitives; i++) {
+      total.stats[i].calls += recorder->stats[i].calls;
+      total.stats[i].total_ns += recorder->stats[i].total_ns;
+      total.stats[i].max_ns =
+          std::max(total.stats[i].max_ns, recorder->stats[i].max_ns);
+    }
+  }
+  return total.stats;
+}
+
+std::vector<Event> take_events() {
+  auto &registry = Registry::global();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<Event> events;
+  events.swap(registry.exited.events);
+  for (auto recorder : registry.live) {
+    std::lock_guard<std::mutex> recorderLock(recorder->mutex);
+    events.insert(events.end(), recorder->events.begin(),
+                  recorder->events.end());
+    recorder->events.clear();
+  }
+  std::sort(events.begin(), events.end(), [](auto &a, auto &b) {
+    return a.start_ns < b.start_ns;
+  });
+  return events;
+}
+
+void reset() {
+  auto &registry = Registry::global();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.exited.clear();
+  for (auto recorder : registry.live) {
+    std::lock_guard<std::mutex> recorderLock(recorder->mutex);
+    recorder->clear();
+  }
+}
+
+std::string chrome_trace(const std::vector<Event> &events) {
+  std::ostringstream trace;
+  trace.precision(3);
+  trace << std::fixed << "{\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); i++) {
+    auto &event = events[i];
+    // Complete events, timestamped in microseconds
+    trace << (i == 0 ? "" : ",") << "\n{\"name\":\""
+          << primitive_name(event.primitive)
+          << "\",\"cat\":\"runtime\",\"ph\":\"X\",\"ts\":"
+          << event.start_ns * 1e-3 << ",\"dur\":" << event.duration_ns * 1e-3
+          << ",\"pid\":" << getpid() << ",\"tid\":" << event.thread << "}";
+  }
+  trace << "\n],\"displayTimeUnit\":\"ns\"}\n";
+  return trace.str();
+}
+
+} // namespace profiler
+} // namespace concretelang
+} // namespace mlir
@@ -5,13 +5,17 @@
 
 #include "concretelang/Runtime/stream_emulator_api.h"
 #include "concretelang/Runtime/wrappers.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
 #include <cstdarg>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <numeric>
-#include <queue>
-#include <sched.h>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -21,26 +25,196 @@ namespace concretelang {
 namespace stream_emulator {
 namespace {
 
-template <typename T> struct StreamBase {
-  void put(T e) { q.push(e); }
+struct Process;
+void schedule(Process *p);
+
+/// The synchronization of the two ends of a stream. The processes are only
+/// scheduled once their inputs are available and their outputs have room,
+/// but the host parks, when the stream is respectively empty or full, until
+/// the other end makes progress.
+struct StreamChannel {
+  StreamChannel(size_t capacity) : capacity(capacity) {}
+
+  /// Wakes up the parked host, every later put and the gets of the empty
+  /// stream then failing.
+  void close() {
+    closed = true;
+    std::lock_guard<std::mutex> lock(mutex);
+    cv.notify_all();
+  }
+
+  bool empty() const { return tail.load() == head.load(); }
+  bool full() const { return tail.load() - head.load() == capacity; }
+
+  // The processes at the ends of the stream, null for the host
+  Process *producer = nullptr;
+  Process *consumer = nullptr;
+
+protected:
+  /// Parks the calling thread until `ready` holds or the stream is closed.
+  template <typename Pred> void park(Pred ready) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Counted before checking `ready`, so that a concurrent wakeUp either
+    // sees the parked thread or made `ready` hold
+    parked++;
+    cv.wait(lock, [&] { return ready() || closed; });
+    parked--;
+  }
+
+  /// Wakes up or schedules the other end of the stream, which may now be
+  /// able to make progress.
+  void wakeUp(Process *other) {
+    if (other != nullptr)
+      schedule(other);
+    if (parked == 0)
+      return;
+    std::lock_guard<std::mutex> lock(mutex);
+    cv.notify_all();
+  }
+
+  const size_t capacity;
+  // Only written by the consumer and the producer respectively
+  std::atomic<size_t> head{0};
+  std::atomic<size_t> tail{0};
+  std::atomic<bool> closed{false};
+
+private:
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::atomic<unsigned> parked{0};
+};
+
+/// A bounded single producer, single consumer stream. The ends only
+/// synchronize through the head and tail indices of the ring buffer, and
+/// only wait when it is empty or full, which back-pressures the producers
+/// running ahead of their consumers.
+template <typename T, size_t Capacity = 64>
+struct StreamBase : StreamChannel {
+  StreamBase() : StreamChannel(Capacity) {}
+
+  /// Pushes `e`, waiting for a free slot, and returns false if the stream is
+  /// closed.
+  bool put(T e) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == Capacity)
+      park([&] { return t - head.load() < Capacity; });
+    if (closed)
+      return false;
+    buffer[t % Capacity] = e;
+    tail.store(t + 1);
+    wakeUp(consumer);
+    return true;
+  }
+
+  /// Pops into `e`, waiting for an element, and returns false if the stream
+  /// is closed and empty.
+  bool get(T &e) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (tail.load(std::memory_order_acquire) == h)
+      park([&] { return tail.load() != h; });
+    if (tail.load(std::memory_order_acquire) == h)
+      return false;
+    e = buffer[h % Capacity];
+    head.store(h + 1);
+    wakeUp(producer);
+    return true;
+  }
+
   T get() {
-    while (q.empty())
-      sched_yield();
-    T ret = q.front();
-    q.pop();
-    return ret;
+    T e;
+    bool ok = get(e);
+    assert(ok && "get from a closed stream");
+    (void)ok;
+    return e;
+  }
+
+  /// Pushes `e` if there is a free slot, without waiting.
+  bool tryPut(T e) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == Capacity)
+      return false;
+    buffer[t % Capacity] = e;
+    tail.store(t + 1);
+    wakeUp(consumer);
+    return true;
+  }
+
+  /// Pops into `e` if the stream is not empty, without waiting.
+  bool tryGet(T &e) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (tail.load(std::memory_order_acquire) == h)
+      return false;
+    e = buffer[h % Capacity];
+    head.store(h + 1);
+    wakeUp(producer);
+    return true;
+  }
+
+private:
+  T buffer[Capacity];
+};
+
+/// A stream of ciphertexts, or of batches of ciphertexts for N = 2, whose
+/// consumer hands the buffers of the consumed elements back to the producer,
+/// rather than an allocation per element on the producer thread and its
+/// release on the consumer one.
+template <size_t N> struct MemRefStream : StreamBase<MemRefDescriptor<N>> {
+  ~MemRefStream() {
+    uint64_t *buffer;
+    while (freeBuffers.tryGet(buffer))
+      free(buffer);
+  }
+
+  /// Returns a contiguous element of `sizes` to be put in the stream, from a
+  /// recycled buffer if any. Only called by the producer, whose elements all
+  /// have the same size.
+  MemRefDescriptor<N> acquire(std::array<size_t, N> sizes) {
+    MemRefDescriptor<N> out;
+    size_t size = 1;
+    for (size_t i = N; i-- > 0;) {
+      out.sizes[i] = sizes[i];
+      out.strides[i] = size;
+      size *= sizes[i];
+    }
+    assert((bufferSize == 0 || bufferSize == size) &&
+           "elements of a stream have different sizes");
+    bufferSize = size;
+    pooled = true;
+    uint64_t *buffer;
+    if (!freeBuffers.tryGet(buffer))
+      buffer = (uint64_t *)malloc(size * sizeof(uint64_t));
+    out.allocated = out.aligned = buffer;
+    out.offset = 0;
+    return out;
+  }
+
+  /// Hands the buffer of an element got from the stream back to the
+  /// producer, if it comes from `acquire` and not from the caller of the
+  /// circuit. Only called by the consumer.
+  void release(const MemRefDescriptor<N> &e) {
+    if (!pooled)
+      return;
+    if (!freeBuffers.tryPut(e.allocated))
+      free(e.allocated);
   }
-  bool empty() { return q.empty(); }
 
 private:
-  std::queue<T> q;
+  // Larger than the stream, to hold the buffers of the ciphertexts in the
+  // stream and of the ones being produced and consumed
+  StreamBase<uint64_t *, 128> freeBuffers;
+  size_t bufferSize = 0;
+  std::atomic<bool> pooled{false};
 };
-union Stream {
-  StreamBase<uint64_t> *uint64_stream;
-  StreamBase<MemRefDescriptor<1>> *memref_stream;
 
-  Stream(StreamBase<uint64_t> *s) : uint64_stream(s) {}
-  Stream(StreamBase<MemRefDescriptor<1>> *s) : memref_stream(s) {}
+struct Stream {
+  StreamBase<uint64_t> *uint64_stream = nullptr;
+  MemRefStream<1> *memref_stream = nullptr;
+  MemRefStream<2> *batch_stream = nullptr;
+  StreamChannel *channel;
+
+  Stream(StreamBase<uint64_t> *s) : uint64_stream(s), channel(s) {}
+  Stream(MemRefStream<1> *s) : memref_stream(s), channel(s) {}
+  Stream(MemRefStream<2> *s) : batch_stream(s), channel(s) {}
 };
 
 struct Void {};
@@ -52,9 +226,20 @@ union Context {
   Void _;
   mlir::concretelang::RuntimeContext *val;
 };
+struct DFGraph;
 struct Process {
-  void terminate() { terminate_p = true; }
-  bool terminate_p = false;
+  /// Returns whether a step of the process can run without waiting, i.e.
+  /// every input has a token and every output has room for one.
+  bool ready() const {
+    for (auto s : input_streams)
+      if (s.channel->empty())
+        return false;
+    for (auto s : output_streams)
+      if (s.channel->full())
+        return false;
+    return true;
+  }
+
   std::vector<Stream> input_streams;
   std::vector<Stream> output_streams;
   Param level;
@@ -68,128 +253,377 @@ struct Process {
   Param ksk_index;
   Param bsk_index;
   Context ctx;
+  // Consumes one token of each input and produces one on each output
   void (*fun)(Process *);
+  DFGraph *dfg = nullptr;
+  // Whether the process is queued or running, so that its steps never run
+  // concurrently
+  std::atomic<bool> scheduled{false};
 };
 
+/// The processes run as tasks on a pool of workers, one per hardware thread,
+/// each task being a step of a process whose inputs are ready.
 struct DFGraph {
   ~DFGraph() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopped = true;
+    }
+    cv.notify_all();
+    for (auto &worker : workers)
+      worker.join();
+    for (auto p : dfg_processes) {
+      for (auto s : p->input_streams)
+        s.channel->close();
+      for (auto s : p->output_streams)
+        s.channel->close();
+    }
     for (auto p : dfg_processes)
-      p->terminate();
+      delete p;
   }
+
   void run() {
+    for (auto p : dfg_processes)
+      for (auto s : p->input_streams)
+        s.channel->consumer = p;
     for (auto p : dfg_processes) {
-      std::thread process_thread(p->fun, p);
-      process_thread.detach();
+      p->dfg = this;
+      for (auto s : p->output_streams)
+        s.channel->producer = p;
+    }
+    unsigned num_workers = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < num_workers; i++)
+      workers.emplace_back([this] { work(); });
+    // The host may have put the inputs before starting the graph
+    for (auto p : dfg_processes)
+      schedule(p);
+  }
+
+  /// Queues a step of `p` if it is ready and not already queued or running.
+  void schedule(Process *p) {
+    if (!p->ready() || p->scheduled.exchange(true))
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(p);
     }
+    cv.notify_one();
   }
+
   std::vector<Process *> dfg_processes;
+
+private:
+  void work() {
+    while (true) {
+      Process *p;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return stopped || !queue.empty(); });
+        if (stopped)
+          return;
+        p = queue.front();
+        queue.pop_front();
+      }
+      p->fun(p);
+      // A token put or got during the step did not schedule the process,
+      // which is checked again once it is done
+      p->scheduled = false;
+      schedule(p);
+    }
+  }
+
+  std::vector<std::thread> workers;
+  std::deque<Process *> queue;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopped = false;
 };
 
+void schedule(Process *p) {
+  if (p->dfg != nullptr)
+    p->dfg->schedule(p);
+}
+
 // Stream emulator processes
 void memref_keyswitch_lwe_u64_process(Process *p) {
-  while (!p->terminate_p) {
-    MemRefDescriptor<1> ct0 = (p->input_streams[0]).memref_stream->get();
-    MemRefDescriptor<1> out;
-    out.sizes[0] = p->output_size.val;
-    out.strides[0] = 1;
-    out.offset = 0;
-    out.allocated = out.aligned =
-        (uint64_t *)malloc(out.sizes[0] * sizeof(uint64_t));
+  MemRefDescriptor<1> ct0;
+  if ((p->input_streams[0]).memref_stream->get(ct0)) {
+    MemRefDescriptor<1> out =
+        (p->output_streams[0]).memref_stream->acquire({p->output_size.val});
     memref_keyswitch_lwe_u64(
         out.allocated, out.aligned, out.offset, out.sizes[0], out.strides[0],
         ct0.allocated, ct0.aligned, ct0.offset, ct0.sizes[0], ct0.strides[0],
         p->level.val, p->base_log.val, p->input_lwe_dim.val,
         p->output_lwe_dim.val, p->ksk_index.val, p->ctx.val);
+    (p->input_streams[0]).memref_stream->release(ct0);
     (p->output_streams[0]).memref_stream->put(out);
   }
-  delete p;
 }
 
 void memref_bootstrap_lwe_u64_process(Process *p) {
-  while (!p->terminate_p) {
-    MemRefDescriptor<1> ct0 = (p->input_streams[0]).memref_stream->get();
-    MemRefDescriptor<1> tlu = (p->input_streams[1]).memref_stream->get();
-    MemRefDescriptor<1> out;
-    out.sizes[0] = p->output_size.val;
-    out.strides[0] = 1;
-    out.offset = 0;
-    out.allocated = out.aligned =
-        (uint64_t *)malloc(out.sizes[0] * sizeof(uint64_t));
+  MemRefDescriptor<1> ct0;
+  MemRefDescriptor<1> tlu;
+  if ((p->input_streams[0]).memref_stream->get(ct0) &&
+         (p->input_streams[1]).memref_stream->get(tlu)) {
+    MemRefDescriptor<1> out =
+        (p->output_streams[0]).memref_stream->acquire({p->output_size.val});
     memref_bootstrap_lwe_u64(
         out.allocated, out.aligned, out.offset, out.sizes[0], out.strides[0],
         ct0.allocated, ct0.aligned, ct0.offset, ct0.sizes[0], ct0.strides[0],
         tlu.allocated, tlu.aligned, tlu.offset, tlu.sizes[0], tlu.strides[0],
         p->input_lwe_dim.val, p->poly_size.val, p->level.val, p->base_log.val,
         p->glwe_dim.val, p->bsk_index.val, p->ctx.val);
+    (p->input_streams[0]).memref_stream->release(ct0);
+    (p->input_streams[1]).memref_stream->release(tlu);
     (p->output_streams[0]).memref_stream->put(out);
   }
-  delete p;
 }
 
 void memref_add_lwe_ciphertexts_u64_process(Process *p) {
-  while (!p->terminate_p) {
-    MemRefDescriptor<1> ct0 = (p->input_streams[0]).memref_stream->get();
-    MemRefDescriptor<1> ct1 = (p->input_streams[1]).memref_stream->get();
-    MemRefDescriptor<1> out = ct0;
-    out.allocated = out.aligned =
-        (uint64_t *)malloc(ct0.sizes[0] * sizeof(uint64_t));
-    out.offset = 0;
+  MemRefDescriptor<1> ct0;
+  MemRefDescriptor<1> ct1;
+  if ((p->input_streams[0]).memref_stream->get(ct0) &&
+         (p->input_streams[1]).memref_stream->get(ct1)) {
+    MemRefDescriptor<1> out =
+        (p->output_streams[0]).memref_stream->acquire({ct0.sizes[0]});
     memref_add_lwe_ciphertexts_u64(
         out.allocated, out.aligned, out.offset, out.sizes[0], out.strides[0],
         ct0.allocated, ct0.aligned, ct0.offset, ct0.sizes[0], ct0.strides[0],
         ct1.allocated, ct1.aligned, ct1.offset, ct1.sizes[0], ct1.strides[0]);
+    (p->input_streams[0]).memref_stream->release(ct0);
+    (p->input_streams[1]).memref_stream->release(ct1);
     (p->output_streams[0]).memref_stream->put(out);
   }
-  delete p;
 }
 
 void memref_add_plaintext_lwe_ciphertext_u64_process(Process *p) {
-  while (!p->terminate_p) {
-    MemRefDescriptor<1> ct0 = (p->input_streams[0]).memref_stream->get();
-    uint64_t plaintext = (p->input_streams[1]).uint64_stream->get();
-    MemRefDescriptor<1> out = ct0;
-    out.allocated = out.aligned =
-        (uint64_t *)malloc(ct0.sizes[0] * sizeof(uint64_t));
-    out.offset = 0;
+  MemRefDescriptor<1> ct0;
+  uint64_t plaintext;
+  if ((p->input_streams[0]).memref_stream->get(ct0) &&
+         (p->input_streams[1]).uint64_stream->get(plaintext)) {
+    MemRefDescriptor<1> out =
+        (p->output_streams[0]).memref_stream->acquire({ct0.sizes[0]});
     memref_add_plaintext_lwe_ciphertext_u64(
         out.allocated, out.aligned, out.offset, out.sizes[0], out.strides[0],
         ct0.allocated, ct0.aligned, ct0.offset, ct0.sizes[0], ct0.strides[0],
         plaintext);
+    (p->input_streams[0]).memref_stream->release(ct0);
     (p->output_streams[0]).memref_stream->put(out);
   }
-  delete p;
 }
 
 void memref_mul_cleartext_lwe_ciphertext_u64_process(Process *p) {
-  while (!p->terminate_p) {
-    MemRefDescriptor<1> ct0 = (p->input_streams[0]).memref_stream->get();
-    uint64_t cleartext = (p->input_streams[1]).uint64_stream->get();
-    MemRefDescriptor<1> out = ct0;
-    out.allocated = out.aligned =
-        (uint64_t *)malloc(ct0.sizes[0] * sizeof(uint64_t));
-    out.offset = 0;
+  MemRefDescriptor<1> ct0;
+  uint64_t cleartext;
+  if ((p->input_streams[0]).memref_stream->get(ct0) &&
+         (p->input_streams[1]).uint64_stream->get(cleartext)) {
+    MemRefDescriptor<1> out =
+        (p->output_streams[0]).memref_stream->acquire({ct0.sizes[0]});
     memref_mul_cleartext_lwe_ciphertext_u64(
         out.allocated, out.aligned, out.offset, out.sizes[0], out.strides[0],
         ct0.allocated, ct0.aligned, ct0.offset, ct0.sizes[0], ct0.strides[0],
         cleartext);
+    (p->input_streams[0]).memref_stream->release(ct0);
     (p->output_streams[0]).memref_stream->put(out);
   }
-  delete p;
 }
 
 void memref_negate_lwe_ciphertext_u64_process(Process *p) {
-  while (!p->terminate_p) {
-    MemRefDescriptor<1> ct0 = (p->input_streams[0]).memref_stream->get();
-    MemRefDescriptor<1> out = ct0;
-    out.allocated = out.aligned =
-        (uint64_t *)malloc(ct0.sizes[0] * sizeof(uint64_t));
-    out.offset = 0;
+  MemRefDescriptor<1> ct0;
+  if ((p->input_streams[0]).memref_stream->get(ct0)) {
+    MemRefDescriptor<1> out =
+        (p->output_streams[0]).memref_stream->acquire({ct0.sizes[0]});
     memref_negate_lwe_ciphertext_u64(
         out.allocated, out.aligned, out.offset, out.sizes[0], out.strides[0],
         ct0.allocated, ct0.aligned, ct0.offset, ct0.sizes[0], ct0.strides[0]);
+    (p->input_streams[0]).memref_stream->release(ct0);
     (p->output_streams[0]).memref_stream->put(out);
   }
-  delete p;
+}
+
+// Processes of the batched operations, whose tokens are batches of
+// ciphertexts evaluated by a single call to the batched wrappers
+void memref_batched_keyswitch_lwe_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  if ((p->input_streams[0]).batch_stream->get(ct0)) {
+    MemRefDescriptor<2> out = (p->output_streams[0])
+                                  .batch_stream->acquire(
+                                      {ct0.sizes[0], p->output_size.val});
+    memref_batched_keyswitch_lwe_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], p->level.val, p->base_log.val, p->input_lwe_dim.val,
+        p->output_lwe_dim.val, p->ksk_index.val, p->ctx.val);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_bootstrap_lwe_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  MemRefDescriptor<1> tlu;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).memref_stream->get(tlu)) {
+    MemRefDescriptor<2> out = (p->output_streams[0])
+                                  .batch_stream->acquire(
+                                      {ct0.sizes[0], p->output_size.val});
+    memref_batched_bootstrap_lwe_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], tlu.allocated, tlu.aligned, tlu.offset, tlu.sizes[0],
+        tlu.strides[0], p->input_lwe_dim.val, p->poly_size.val, p->level.val,
+        p->base_log.val, p->glwe_dim.val, p->bsk_index.val, p->ctx.val);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->input_streams[1]).memref_stream->release(tlu);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_mapped_bootstrap_lwe_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  MemRefDescriptor<2> tlu;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).batch_stream->get(tlu)) {
+    MemRefDescriptor<2> out = (p->output_streams[0])
+                                  .batch_stream->acquire(
+                                      {ct0.sizes[0], p->output_size.val});
+    memref_batched_mapped_bootstrap_lwe_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], tlu.allocated, tlu.aligned, tlu.offset, tlu.sizes[0],
+        tlu.sizes[1], tlu.strides[0], tlu.strides[1], p->input_lwe_dim.val,
+        p->poly_size.val, p->level.val, p->base_log.val, p->glwe_dim.val,
+        p->bsk_index.val, p->ctx.val);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->input_streams[1]).batch_stream->release(tlu);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_add_lwe_ciphertexts_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  MemRefDescriptor<2> ct1;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).batch_stream->get(ct1)) {
+    MemRefDescriptor<2> out =
+        (p->output_streams[0])
+            .batch_stream->acquire({ct0.sizes[0], ct0.sizes[1]});
+    memref_batched_add_lwe_ciphertexts_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], ct1.allocated, ct1.aligned, ct1.offset, ct1.sizes[0],
+        ct1.sizes[1], ct1.strides[0], ct1.strides[1]);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->input_streams[1]).batch_stream->release(ct1);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_add_plaintext_lwe_ciphertext_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  MemRefDescriptor<1> ct1;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).memref_stream->get(ct1)) {
+    MemRefDescriptor<2> out =
+        (p->output_streams[0])
+            .batch_stream->acquire({ct0.sizes[0], ct0.sizes[1]});
+    memref_batched_add_plaintext_lwe_ciphertext_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], ct1.allocated, ct1.aligned, ct1.offset, ct1.sizes[0],
+        ct1.strides[0]);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->input_streams[1]).memref_stream->release(ct1);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_add_plaintext_cst_lwe_ciphertext_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  uint64_t plaintext;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).uint64_stream->get(plaintext)) {
+    MemRefDescriptor<2> out =
+        (p->output_streams[0])
+            .batch_stream->acquire({ct0.sizes[0], ct0.sizes[1]});
+    memref_batched_add_plaintext_cst_lwe_ciphertext_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], plaintext);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_mul_cleartext_lwe_ciphertext_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  MemRefDescriptor<1> ct1;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).memref_stream->get(ct1)) {
+    MemRefDescriptor<2> out =
+        (p->output_streams[0])
+            .batch_stream->acquire({ct0.sizes[0], ct0.sizes[1]});
+    memref_batched_mul_cleartext_lwe_ciphertext_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], ct1.allocated, ct1.aligned, ct1.offset, ct1.sizes[0],
+        ct1.strides[0]);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->input_streams[1]).memref_stream->release(ct1);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_mul_cleartext_cst_lwe_ciphertext_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  uint64_t cleartext;
+  if ((p->input_streams[0]).batch_stream->get(ct0) &&
+         (p->input_streams[1]).uint64_stream->get(cleartext)) {
+    MemRefDescriptor<2> out =
+        (p->output_streams[0])
+            .batch_stream->acquire({ct0.sizes[0], ct0.sizes[1]});
+    memref_batched_mul_cleartext_cst_lwe_ciphertext_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1], cleartext);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+void memref_batched_negate_lwe_ciphertext_u64_process(Process *p) {
+  MemRefDescriptor<2> ct0;
+  if ((p->input_streams[0]).batch_stream->get(ct0)) {
+    MemRefDescriptor<2> out =
+        (p->output_streams[0])
+            .batch_stream->acquire({ct0.sizes[0], ct0.sizes[1]});
+    memref_batched_negate_lwe_ciphertext_u64(
+        out.allocated, out.aligned, out.offset, out.sizes[0], out.sizes[1],
+        out.strides[0], out.strides[1], ct0.allocated, ct0.aligned,
+        ct0.offset, ct0.sizes[0], ct0.sizes[1], ct0.strides[0],
+        ct0.strides[1]);
+    (p->input_streams[0]).batch_stream->release(ct0);
+    (p->output_streams[0]).batch_stream->put(out);
+  }
+}
+
+/// Adds a process running `fun` on `inputs` and `output` to `dfg`.
+Process *make_process(void *dfg, void (*fun)(Process *),
+                      std::initializer_list<Stream> inputs, Stream output) {
+  Process *p = new Process;
+  p->input_streams.assign(inputs);
+  p->output_streams.push_back(output);
+  p->fun = fun;
+  ((DFGraph *)dfg)->dfg_processes.push_back(p);
+  return p;
 }
 
 } // namespace
@@ -205,14 +639,11 @@ void stream_emulator_make_memref_add_lwe_ciphertexts_u64_process(void *dfg,
   mlir::concretelang::stream_emulator::Process *p =
       new mlir::concretelang::stream_emulator::Process;
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin1);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin1);
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin2);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin2);
   p->output_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sout);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sout);
   p->fun = mlir::concretelang::stream_emulator::
       memref_add_lwe_ciphertexts_u64_process;
   ((mlir::concretelang::stream_emulator::DFGraph *)dfg)
@@ -224,13 +655,11 @@ void stream_emulator_make_memref_add_plaintext_lwe_ciphertext_u64_process(
   mlir::concretelang::stream_emulator::Process *p =
       new mlir::concretelang::stream_emulator::Process;
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin1);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin1);
   p->input_streams.push_back(
       (mlir::concretelang::stream_emulator::StreamBase<uint64_t> *)sin2);
   p->output_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sout);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sout);
   p->fun = mlir::concretelang::stream_emulator::
       memref_add_plaintext_lwe_ciphertext_u64_process;
   ((mlir::concretelang::stream_emulator::DFGraph *)dfg)
@@ -242,13 +671,11 @@ void stream_emulator_make_memref_mul_cleartext_lwe_ciphertext_u64_process(
   mlir::concretelang::stream_emulator::Process *p =
       new mlir::concretelang::stream_emulator::Process;
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin1);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin1);
   p->input_streams.push_back(
       (mlir::concretelang::stream_emulator::StreamBase<uint64_t> *)sin2);
   p->output_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sout);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sout);
   p->fun = mlir::concretelang::stream_emulator::
       memref_mul_cleartext_lwe_ciphertext_u64_process;
   ((mlir::concretelang::stream_emulator::DFGraph *)dfg)
@@ -261,11 +688,9 @@ void stream_emulator_make_memref_negate_lwe_ciphertext_u64_process(void *dfg,
   mlir::concretelang::stream_emulator::Process *p =
       new mlir::concretelang::stream_emulator::Process;
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin1);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin1);
   p->output_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sout);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sout);
   p->fun = mlir::concretelang::stream_emulator::
       memref_negate_lwe_ciphertext_u64_process;
   ((mlir::concretelang::stream_emulator::DFGraph *)dfg)
@@ -279,11 +704,9 @@ void stream_emulator_make_memref_keyswitch_lwe_u64_process(
   mlir::concretelang::stream_emulator::Process *p =
       new mlir::concretelang::stream_emulator::Process;
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin1);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin1);
   p->output_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sout);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sout);
   p->level.val = level;
   p->base_log.val = base_log;
   p->input_lwe_dim.val = input_lwe_dim;
@@ -304,14 +727,11 @@ void stream_emulator_make_memref_bootstrap_lwe_u64_process(
   mlir::concretelang::stream_emulator::Process *p =
       new mlir::concretelang::stream_emulator::Process;
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin1);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin1);
   p->input_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sin2);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sin2);
   p->output_streams.push_back(
-      (mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-          sout);
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)sout);
   p->input_lwe_dim.val = input_lwe_dim;
   p->poly_size.val = poly_size;
   p->level.val = level;
@@ -326,6 +746,106 @@ void stream_emulator_make_memref_bootstrap_lwe_u64_process(
       ->dfg_processes.push_back(p);
 }
 
+namespace se = mlir::concretelang::stream_emulator;
+
+void stream_emulator_make_memref_batched_add_lwe_ciphertexts_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout) {
+  se::make_process(dfg, se::memref_batched_add_lwe_ciphertexts_u64_process,
+                   {(se::MemRefStream<2> *)sin1, (se::MemRefStream<2> *)sin2},
+                   (se::MemRefStream<2> *)sout);
+}
+
+void stream_emulator_make_memref_batched_add_plaintext_lwe_ciphertext_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout) {
+  se::make_process(
+      dfg, se::memref_batched_add_plaintext_lwe_ciphertext_u64_process,
+      {(se::MemRefStream<2> *)sin1, (se::MemRefStream<1> *)sin2},
+      (se::MemRefStream<2> *)sout);
+}
+
+void stream_emulator_make_memref_batched_add_plaintext_cst_lwe_ciphertext_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout) {
+  se::make_process(
+      dfg, se::memref_batched_add_plaintext_cst_lwe_ciphertext_u64_process,
+      {(se::MemRefStream<2> *)sin1, (se::StreamBase<uint64_t> *)sin2},
+      (se::MemRefStream<2> *)sout);
+}
+
+void stream_emulator_make_memref_batched_mul_cleartext_lwe_ciphertext_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout) {
+  se::make_process(
+      dfg, se::memref_batched_mul_cleartext_lwe_ciphertext_u64_process,
+      {(se::MemRefStream<2> *)sin1, (se::MemRefStream<1> *)sin2},
+      (se::MemRefStream<2> *)sout);
+}
+
+void stream_emulator_make_memref_batched_mul_cleartext_cst_lwe_ciphertext_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout) {
+  se::make_process(
+      dfg, se::memref_batched_mul_cleartext_cst_lwe_ciphertext_u64_process,
+      {(se::MemRefStream<2> *)sin1, (se::StreamBase<uint64_t> *)sin2},
+      (se::MemRefStream<2> *)sout);
+}
+
+void stream_emulator_make_memref_batched_negate_lwe_ciphertext_u64_process(
+    void *dfg, void *sin1, void *sout) {
+  se::make_process(dfg, se::memref_batched_negate_lwe_ciphertext_u64_process,
+                   {(se::MemRefStream<2> *)sin1},
+                   (se::MemRefStream<2> *)sout);
+}
+
+void stream_emulator_make_memref_batched_keyswitch_lwe_u64_process(
+    void *dfg, void *sin1, void *sout, uint32_t level, uint32_t base_log,
+    uint32_t input_lwe_dim, uint32_t output_lwe_dim, uint32_t output_size,
+    uint32_t ksk_index, void *context) {
+  se::Process *p = se::make_process(
+      dfg, se::memref_batched_keyswitch_lwe_u64_process,
+      {(se::MemRefStream<2> *)sin1}, (se::MemRefStream<2> *)sout);
+  p->level.val = level;
+  p->base_log.val = base_log;
+  p->input_lwe_dim.val = input_lwe_dim;
+  p->output_lwe_dim.val = output_lwe_dim;
+  p->output_size.val = output_size;
+  p->ksk_index.val = ksk_index;
+  p->ctx.val = (mlir::concretelang::RuntimeContext *)context;
+}
+
+void stream_emulator_make_memref_batched_bootstrap_lwe_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t output_size, uint32_t bsk_index, void *context) {
+  se::Process *p = se::make_process(
+      dfg, se::memref_batched_bootstrap_lwe_u64_process,
+      {(se::MemRefStream<2> *)sin1, (se::MemRefStream<1> *)sin2},
+      (se::MemRefStream<2> *)sout);
+  p->input_lwe_dim.val = input_lwe_dim;
+  p->poly_size.val = poly_size;
+  p->level.val = level;
+  p->base_log.val = base_log;
+  p->glwe_dim.val = glwe_dim;
+  p->output_size.val = output_size;
+  p->bsk_index.val = bsk_index;
+  p->ctx.val = (mlir::concretelang::RuntimeContext *)context;
+}
+
+void stream_emulator_make_memref_batched_mapped_bootstrap_lwe_u64_process(
+    void *dfg, void *sin1, void *sin2, void *sout, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t output_size, uint32_t bsk_index, void *context) {
+  se::Process *p = se::make_process(
+      dfg, se::memref_batched_mapped_bootstrap_lwe_u64_process,
+      {(se::MemRefStream<2> *)sin1, (se::MemRefStream<2> *)sin2},
+      (se::MemRefStream<2> *)sout);
+  p->input_lwe_dim.val = input_lwe_dim;
+  p->poly_size.val = poly_size;
+  p->level.val = level;
+  p->base_log.val = base_log;
+  p->glwe_dim.val = glwe_dim;
+  p->output_size.val = output_size;
+  p->bsk_index.val = bsk_index;
+  p->ctx.val = (mlir::concretelang::RuntimeContext *)context;
+}
+
 void *stream_emulator_make_uint64_stream(const char *name, stream_type stype) {
   return (void *)new mlir::concretelang::stream_emulator::StreamBase<uint64_t>;
 }
@@ -338,45 +858,51 @@ uint64_t stream_emulator_get_uint64(void *stream) {
 }
 
 void *stream_emulator_make_memref_stream(const char *name, stream_type stype) {
-  return (void *)new mlir::concretelang::stream_emulator::StreamBase<
-      MemRefDescriptor<1>>;
+  return (void *)new mlir::concretelang::stream_emulator::MemRefStream<1>;
 }
 void stream_emulator_put_memref(void *stream, uint64_t *allocated,
                                 uint64_t *aligned, uint64_t offset,
                                 uint64_t size, uint64_t stride) {
-  ((mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-       stream)
+  ((mlir::concretelang::stream_emulator::MemRefStream<1> *)stream)
       ->put({allocated, aligned, offset, {size}, {stride}});
 }
 void stream_emulator_get_memref(void *stream, uint64_t *out_allocated,
                                 uint64_t *out_aligned, uint64_t out_offset,
                                 uint64_t out_size, uint64_t out_stride) {
-  MemRefDescriptor<1> mref =
-      ((mlir::concretelang::stream_emulator::StreamBase<MemRefDescriptor<1>> *)
-           stream)
-          ->get();
+  auto memref_stream =
+      (mlir::concretelang::stream_emulator::MemRefStream<1> *)stream;
+  MemRefDescriptor<1> mref = memref_stream->get();
   memref_copy_one_rank(mref.allocated, mref.aligned, mref.offset, mref.sizes[0],
                        mref.strides[0], out_allocated, out_aligned, out_offset,
                        out_size, out_stride);
-  free(mref.allocated);
+  memref_stream->release(mref);
 }
 
 void *stream_emulator_make_memref_batch_stream(const char *name,
                                                stream_type stype) {
-  assert(0 && "Batched operations not implemented in the StreamEmulator.");
+  return (void *)new se::MemRefStream<2>;
 }
 void stream_emulator_put_memref_batch(void *stream, uint64_t *allocated,
                                       uint64_t *aligned, uint64_t offset,
                                       uint64_t size0, uint64_t size1,
                                       uint64_t stride0, uint64_t stride1) {
-  assert(0 && "Batched operations not implemented in the StreamEmulator.");
+  ((se::MemRefStream<2> *)stream)
+      ->put({allocated, aligned, offset, {size0, size1}, {stride0, stride1}});
 }
 void stream_emulator_get_memref_batch(void *stream, uint64_t *out_allocated,
                                       uint64_t *out_aligned,
                                       uint64_t out_offset, uint64_t out_size0,
                                       uint64_t out_size1, uint64_t out_stride0,
                                       uint64_t out_stride1) {
-  assert(0 && "Batched operations not implemented in the StreamEmulator.");
+  auto batch_stream = (se::MemRefStream<2> *)stream;
+  MemRefDescriptor<2> mref = batch_stream->get();
+  assert(mref.sizes[0] == out_size0 && "batch sizes differ");
+  for (size_t i = 0; i < out_size0; i++)
+    memref_copy_one_rank(mref.allocated, mref.aligned,
+                         mref.offset + i * mref.strides[0], mref.sizes[1],
+                         mref.strides[1], out_allocated, out_aligned,
+                         out_offset + i * out_stride0, out_size1, out_stride1);
+  batch_stream->release(mref);
 }
 
 void *stream_emulator_init() {
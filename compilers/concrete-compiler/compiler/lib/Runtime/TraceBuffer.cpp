@@ -0,0 +1,236 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include "concretelang/Runtime/TraceBuffer.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mlir {
+namespace concretelang {
+namespace tracing {
+
+namespace {
+
+const size_t message_chunk = 40;
+
+/// A trace, formatted by the background thread. A message longer than a
+/// record is split in consecutive records of the same timestamp, all but the
+/// last one being of kind MESSAGE.
+struct Record {
+  uint64_t timestamp_ns;
+  uint64_t value;
+  uint32_t thread;
+  Kind kind;
+  uint8_t width;
+  uint8_t msb;
+  uint8_t message_len;
+  char message[message_chunk];
+};
+
+/// A single-producer single-consumer queue of records, written by its
+/// thread and read under the mutex of the registry.
+struct RingBuffer {
+  static const uint64_t capacity = 1 << 12;
+
+  std::array<Record, capacity> records;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  std::atomic<bool> exited{false};
+  uint32_t thread = 0;
+
+  /// Sets `index` to the first of `count` free records, if there are enough
+  /// of them.
+  bool reserve(size_t count, uint64_t &index) {
+    index = head.load(std::memory_order_relaxed);
+    return index + count - tail.load(std::memory_order_acquire) <= capacity;
+  }
+
+  Record &at(size_t index) { return records[index % capacity]; }
+
+  /// Publishes the reserved records.
+  void commit(uint64_t index, size_t count) {
+    head.store(index + count, std::memory_order_release);
+  }
+
+  void drain(std::vector<Record> &out) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t h = head.load(std::memory_order_acquire);
+    for (; t < h; t++)
+      out.push_back(records[t % capacity]);
+    tail.store(h, std::memory_order_release);
+  }
+};
+
+struct Config {
+  FILE *file = nullptr;
+  uint64_t sampling = 1;
+};
+
+/// The buffers of the threads, the exited ones being forgotten once drained.
+struct Registry {
+  // Never destroyed, as the threads may exit after the static destructors
+  static Registry &global() {
+    static Registry *registry = new Registry;
+    return *registry;
+  }
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<RingBuffer>> buffers;
+  uint32_t next_thread = 0;
+  std::atomic<uint64_t> dropped{0};
+  uint64_t reported_dropped = 0;
+  // Set by the last flush at exit, after which the file may be closed
+  bool stopped = false;
+};
+
+const Config &config();
+
+void write_records(bool last) {
+  auto &registry = Registry::global();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (registry.stopped)
+    return;
+  registry.stopped = last;
+
+  std::vector<Record> records;
+  for (size_t i = 0; i < registry.buffers.size();) {
+    auto &buffer = registry.buffers[i];
+    // Nothing is pushed once exited
+    bool exited = buffer->exited.load(std::memory_order_acquire);
+    buffer->drain(records);
+    if (exited) {
+      registry.buffers.erase(registry.buffers.begin() + i);
+      continue;
+    }
+    i++;
+  }
+  std::stable_sort(records.begin(), records.end(), [](auto &a, auto &b) {
+    return a.timestamp_ns < b.timestamp_ns ||
+           (a.timestamp_ns == b.timestamp_ns && a.thread < b.thread);
+  });
+
+  std::string text;
+  for (auto &record : records) {
+    text.append(record.message, record.message_len);
+    if (record.kind == Kind::MESSAGE)
+      continue;
+    std::string bits = std::bitset<64>{record.value}.to_string();
+    if (record.kind == Kind::PLAINTEXT)
+      bits.erase(0, 64 - std::min<size_t>(record.width, 64));
+    bits.insert(std::min<size_t>(record.msb, bits.size()), 1, ' ');
+    text += " : " + bits + "\n";
+  }
+  uint64_t dropped = registry.dropped.load();
+  if (dropped != registry.reported_dropped) {
+    text += "[runtime] " + std::to_string(dropped - registry.reported_dropped) +
+            " traces dropped\n";
+    registry.reported_dropped = dropped;
+  }
+  if (text.empty())
+    return;
+  fwrite(text.data(), 1, text.size(), config().file);
+  fflush(config().file);
+}
+
+const Config &config() {
+  static Config config = []() {
+    Config config;
+    char *path = getenv("RUNTIME_TRACE_FILE");
+    if (path == nullptr)
+      return config;
+    config.file = strcmp(path, "-") == 0 ? stdout : fopen(path, "a");
+    if (config.file == nullptr) {
+      fprintf(stderr,
+              "Runtime: cannot open the trace file %s, tracing to stdout\n",
+              path);
+      return config;
+    }
+    char *sampling = getenv("RUNTIME_TRACE_SAMPLING");
+    if (sampling != nullptr)
+      config.sampling = std::max(strtoull(sampling, nullptr, 10), 1ull);
+    std::thread([]() {
+      while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        write_records(false);
+      }
+    }).detach();
+    atexit([]() { write_records(true); });
+    return config;
+  }();
+  return config;
+}
+
+/// Registers the buffer of the thread on its first trace.
+struct ThreadBuffer {
+  ThreadBuffer() : buffer(std::make_shared<RingBuffer>()) {
+    auto &registry = Registry::global();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffer->thread = registry.next_thread++;
+    registry.buffers.push_back(buffer);
+  }
+
+  ~ThreadBuffer() { buffer->exited.store(true, std::memory_order_release); }
+
+  std::shared_ptr<RingBuffer> buffer;
+  uint64_t traces = 0;
+};
+
+} // namespace
+
+bool buffered() { return config().file != nullptr; }
+
+void record(Kind kind, uint64_t value, uint32_t width, uint32_t msb,
+            const char *message, uint32_t message_len) {
+  thread_local ThreadBuffer thread_buffer;
+  if (thread_buffer.traces++ % config().sampling != 0)
+    return;
+  auto &buffer = *thread_buffer.buffer;
+  size_t count = std::max<size_t>(
+      1, (message_len + message_chunk - 1) / message_chunk);
+  uint64_t index;
+  if (!buffer.reserve(count, index)) {
+    Registry::global().dropped++;
+    return;
+  }
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  uint64_t timestamp_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+  for (size_t i = 0; i < count; i++) {
+    Record &record = buffer.at(index + i);
+    size_t offset = i * message_chunk;
+    size_t len = std::min<size_t>(message_len - offset, message_chunk);
+    record.timestamp_ns = timestamp_ns;
+    record.value = value;
+    record.thread = buffer.thread;
+    record.kind = i + 1 == count ? kind : Kind::MESSAGE;
+    record.width = (uint8_t)width;
+    record.msb = (uint8_t)msb;
+    record.message_len = (uint8_t)len;
+    memcpy(record.message, message + offset, len);
+  }
+  buffer.commit(index, count);
+}
+
+void flush() {
+  if (buffered())
+    write_records(false);
+}
+
+uint64_t dropped() { return Registry::global().dropped.load(); }
+
+} // namespace tracing
+} // namespace concretelang
+} // namespace mlir
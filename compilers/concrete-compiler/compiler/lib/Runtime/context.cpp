@@ -6,8 +6,13 @@
 #include "concretelang/Runtime/context.h"
 #include "concretelang/Common/Error.h"
 #include "concretelang/Common/Keysets.h"
+#include "concretelang/Runtime/Numa.h"
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 namespace mlir {
 namespace concretelang {
@@ -29,29 +34,323 @@ FFT::~FFT() {
   }
 }
 
-RuntimeContext::RuntimeContext(ServerKeyset serverKeyset)
-    : serverKeyset(serverKeyset) {
+std::shared_ptr<const FFT> FFT::shared(size_t polynomial_size) {
+  static std::mutex guard;
+  // Never destroyed, as the contexts may outlive the static destructors
+  static auto *plans = new std::map<size_t, std::shared_ptr<const FFT>>();
+  const std::lock_guard<std::mutex> lock(guard);
+  auto &plan = (*plans)[polynomial_size];
+  if (plan == nullptr)
+    plan = std::make_shared<const FFT>(polynomial_size);
+  return plan;
+}
+
+ScratchArena::~ScratchArena() {
+  if (scratchBuffer != nullptr) {
+    free(scratchBuffer);
+  }
+  memory::release(memory::Category::SCRATCH,
+                  scratchSize + glweBuffer.capacity() * sizeof(uint64_t));
+}
+
+uint8_t *ScratchArena::scratch(size_t size, size_t align) {
+  if (scratchBuffer != nullptr && size <= scratchSize &&
+      align <= scratchAlign) {
+    return scratchBuffer;
+  }
+  if (scratchBuffer != nullptr) {
+    free(scratchBuffer);
+    memory::release(memory::Category::SCRATCH, scratchSize);
+  }
+  scratchAlign = std::max(align, scratchAlign);
+  // aligned_alloc requires the size to be a multiple of the alignment.
+  scratchSize = std::max(size, scratchSize);
+  scratchSize = (scratchSize + scratchAlign - 1) / scratchAlign * scratchAlign;
+  memory::allocate(memory::Category::SCRATCH, scratchSize);
+  scratchBuffer = (uint8_t *)aligned_alloc(scratchAlign, scratchSize);
+  return scratchBuffer;
+}
+
+uint64_t *ScratchArena::glwe(size_t size) {
+  if (glweBuffer.size() < size) {
+    size_t capacity = glweBuffer.capacity();
+    glweBuffer.resize(size);
+    memory::allocate(memory::Category::SCRATCH,
+                     (glweBuffer.capacity() - capacity) * sizeof(uint64_t));
+  }
+  return glweBuffer.data();
+}
 
-  // Initialize for each bootstrap key the fourier one
-  for (size_t i = 0; i < serverKeyset.lweBootstrapKeys.size(); i++) {
-    auto fdbsk = convert_to_fourier_domain(serverKeyset.lweBootstrapKeys[i]);
-    // Store the fourier_bootstrap_key in the context
-    fourier_bootstrap_keys.push_back(fdbsk.second);
-    ffts.push_back(std::move(fdbsk.first));
+ScratchArena &RuntimeContext::scratch_arena() {
+  const std::lock_guard<std::mutex> guard(scratch_arenas_guard);
+  auto &arena = scratch_arenas[std::this_thread::get_id()];
+  if (arena == nullptr) {
+    arena = std::make_unique<ScratchArena>();
   }
+  return *arena;
+}
+
+RuntimeContext::RuntimeContext(ServerKeyset serverKeyset,
+                               bool dropStandardBootstrapKeys,
+                               std::shared_ptr<PreparedKeyset> preparedKeyset)
+    : serverKeyset(serverKeyset),
+      fourier_bootstrap_keys(serverKeyset.lweBootstrapKeys.size()),
+      ffts(serverKeyset.lweBootstrapKeys.size()),
+      dropStandardBootstrapKeys(dropStandardBootstrapKeys),
+      preparedKeyset(preparedKeyset),
+      fourier_conversion_flags(serverKeyset.lweBootstrapKeys.size()),
+      fourier_bootstrap_key_replicas(serverKeyset.lweBootstrapKeys.size()),
+      fourier_fast_keyswitch_keys(serverKeyset.lweKeyswitchKeys.size()),
+      fast_keyswitch_ffts(serverKeyset.lweKeyswitchKeys.size()),
+      fast_keyswitch_conversion_flags(serverKeyset.lweKeyswitchKeys.size()) {
+  // The standard keys are shared with the keyset, they are accounted as long
+  // as the context keeps them alive
+  for (auto &bsk : serverKeyset.lweBootstrapKeys)
+    host_keys_size += bsk.getTransportBuffer().size() * sizeof(uint64_t);
+  for (auto &ksk : serverKeyset.lweKeyswitchKeys)
+    host_keys_size += ksk.getTransportBuffer().size() * sizeof(uint64_t);
+  for (auto &pksk : serverKeyset.packingKeyswitchKeys)
+    host_keys_size += pksk.getTransportBuffer().size() * sizeof(uint64_t);
+  memory::allocate(memory::Category::KEYS, host_keys_size);
 
 #ifdef CONCRETELANG_CUDA_SUPPORT
   assert(cudaGetDeviceCount(&num_devices) == cudaSuccess);
-  bsk_gpu.resize(num_devices, nullptr);
-  ksk_gpu.resize(num_devices, nullptr);
+  gpu_keys.resize(num_devices);
+  gpu_keys_size.resize(num_devices, 0);
   for (int i = 0; i < num_devices; ++i) {
-    bsk_gpu_mutex.push_back(std::make_unique<std::mutex>());
-    ksk_gpu_mutex.push_back(std::make_unique<std::mutex>());
+    gpu_keys_mutex.push_back(std::make_unique<std::mutex>());
   }
+  char *env = getenv("GPU_KEYS_MEMORY_BUDGET");
+  gpu_keys_budget = env != nullptr ? strtoull(env, nullptr, 10) : 0;
 #endif
 }
 
-std::pair<FFT, std::shared_ptr<std::vector<std::complex<double>>>>
+#ifdef CONCRETELANG_CUDA_SUPPORT
+void *RuntimeContext::get_bsk_gpu(uint32_t input_lwe_dim, uint32_t poly_size,
+                                  uint32_t level, uint32_t glwe_dim,
+                                  uint32_t bsk_index, uint32_t gpu_idx,
+                                  void *stream) {
+  auto &bsk = serverKeyset.lweBootstrapKeys[bsk_index];
+  uint32_t grouping_factor = bootstrap_key_grouping_factor(bsk_index);
+  if (grouping_factor > 1) {
+    size_t bsk_gpu_buffer_size = bsk.getBuffer().size() * sizeof(uint64_t);
+    return get_gpu_key(
+        {GpuKeyKind::BSK, bsk_index}, bsk_gpu_buffer_size, gpu_idx, stream,
+        [&](void *bsk_gpu) {
+          cuda_convert_lwe_multi_bit_bootstrap_key_64(
+              bsk_gpu, const_cast<uint64_t *>(bsk.getBuffer().data()),
+              (cudaStream_t *)stream, gpu_idx, input_lwe_dim, glwe_dim, level,
+              poly_size, grouping_factor);
+        });
+  }
+  size_t bsk_gpu_buffer_size = bsk.getBuffer().size() * sizeof(double);
+  return get_gpu_key(
+      {GpuKeyKind::BSK, bsk_index}, bsk_gpu_buffer_size, gpu_idx, stream,
+      [&](void *bsk_gpu) {
+        cuda_convert_lwe_bootstrap_key_64(
+            bsk_gpu, const_cast<uint64_t *>(bsk.getBuffer().data()),
+            (cudaStream_t *)stream, gpu_idx, input_lwe_dim, glwe_dim, level,
+            poly_size);
+      });
+}
+
+void *RuntimeContext::get_ksk_gpu(uint32_t level, uint32_t input_lwe_dim,
+                                  uint32_t output_lwe_dim, uint32_t ksk_index,
+                                  uint32_t gpu_idx, void *stream) {
+  auto &ksk = serverKeyset.lweKeyswitchKeys[ksk_index];
+  size_t ksk_buffer_size = sizeof(uint64_t) * ksk.getBuffer().size();
+  return get_gpu_key({GpuKeyKind::KSK, ksk_index}, ksk_buffer_size, gpu_idx,
+                     stream, [&](void *ksk_gpu) {
+                       cuda_memcpy_async_to_gpu(
+                           ksk_gpu,
+                           const_cast<uint64_t *>(ksk.getBuffer().data()),
+                           ksk_buffer_size, (cudaStream_t *)stream, gpu_idx);
+                     });
+}
+
+void *RuntimeContext::get_pksk_gpu(uint32_t pksk_index, uint32_t gpu_idx,
+                                   void *stream) {
+  auto &pksk = serverKeyset.packingKeyswitchKeys[pksk_index];
+  size_t pksk_buffer_size = sizeof(uint64_t) * pksk.getBuffer().size();
+  return get_gpu_key({GpuKeyKind::PKSK, pksk_index}, pksk_buffer_size, gpu_idx,
+                     stream, [&](void *pksk_gpu) {
+                       cuda_memcpy_async_to_gpu(
+                           pksk_gpu,
+                           const_cast<uint64_t *>(pksk.getBuffer().data()),
+                           pksk_buffer_size, (cudaStream_t *)stream, gpu_idx);
+                     });
+}
+
+void *RuntimeContext::get_gpu_key(GpuKeyId id, size_t size, uint32_t gpu_idx,
+                                  void *stream,
+                                  std::function<void(void *)> upload) {
+  const std::lock_guard<std::mutex> guard(*gpu_keys_mutex[gpu_idx]);
+  auto &keys = gpu_keys[gpu_idx];
+  auto it = keys.find(id);
+  if (it != keys.end()) {
+    it->second.last_use = ++gpu_keys_clock;
+    // The key may still be uploading on another stream.
+    check_cuda_error(
+        cudaStreamWaitEvent(*(cudaStream_t *)stream, it->second.ready, 0));
+    return it->second.ptr;
+  }
+  if (gpu_keys_budget != 0) {
+    evict_gpu_keys(gpu_idx, size);
+  }
+  memory::allocate(memory::Category::GPU, size);
+  void *ptr = cuda_malloc_async(size, (cudaStream_t *)stream, gpu_idx);
+  upload(ptr);
+  // Other streams wait for the event on the device rather than the host
+  // waiting for the upload, the mutex only guards the registration.
+  cudaEvent_t ready;
+  check_cuda_error(cudaEventCreateWithFlags(&ready, cudaEventDisableTiming));
+  check_cuda_error(cudaEventRecord(ready, *(cudaStream_t *)stream));
+  keys[id] = {ptr, size, ++gpu_keys_clock, ready};
+  gpu_keys_size[gpu_idx] += size;
+  return ptr;
+}
+
+void RuntimeContext::evict_gpu_keys(uint32_t gpu_idx, size_t size) {
+  auto &keys = gpu_keys[gpu_idx];
+  while (!keys.empty() && gpu_keys_size[gpu_idx] + size > gpu_keys_budget) {
+    auto lru = std::min_element(keys.begin(), keys.end(),
+                                [](const auto &a, const auto &b) {
+                                  return a.second.last_use < b.second.last_use;
+                                });
+    // Kernels already scheduled on the device may still read the key.
+    cuda_synchronize_device(gpu_idx);
+    cudaEventDestroy(lru->second.ready);
+    cuda_drop(lru->second.ptr, gpu_idx);
+    gpu_keys_size[gpu_idx] -= lru->second.size;
+    memory::release(memory::Category::GPU, lru->second.size);
+    keys.erase(lru);
+  }
+}
+#endif
+
+void RuntimeContext::prefetch_keys_to_gpu() {
+#ifdef CONCRETELANG_CUDA_SUPPORT
+  // The devices are filled concurrently, each from its own stream.
+  std::vector<void *> streams;
+  for (int gpu_idx = 0; gpu_idx < num_devices; gpu_idx++) {
+    void *stream = cuda_create_stream(gpu_idx);
+    streams.push_back(stream);
+    for (uint32_t i = 0; i < serverKeyset.lweBootstrapKeys.size(); i++) {
+      auto params =
+          serverKeyset.lweBootstrapKeys[i].getInfo().asReader().getParams();
+      get_bsk_gpu(params.getInputLweDimension(), params.getPolynomialSize(),
+                  params.getLevelCount(), params.getGlweDimension(), i,
+                  gpu_idx, stream);
+    }
+    for (uint32_t i = 0; i < serverKeyset.lweKeyswitchKeys.size(); i++) {
+      auto params =
+          serverKeyset.lweKeyswitchKeys[i].getInfo().asReader().getParams();
+      // The fast keyswitches run on the host
+      if (params.getOutputPolynomialSize() > 0)
+        continue;
+      get_ksk_gpu(params.getLevelCount(), params.getInputLweDimension(),
+                  params.getOutputLweDimension(), i, gpu_idx, stream);
+    }
+    for (uint32_t i = 0; i < serverKeyset.packingKeyswitchKeys.size(); i++)
+      get_pksk_gpu(i, gpu_idx, stream);
+  }
+  for (int gpu_idx = 0; gpu_idx < num_devices; gpu_idx++) {
+    cudaStreamSynchronize(*(cudaStream_t *)streams[gpu_idx]);
+    cuda_destroy_stream((cudaStream_t *)streams[gpu_idx], gpu_idx);
+  }
+#endif
+}
+
+void RuntimeContext::ensure_fourier_bootstrap_key(size_t keyId) {
+  assert(keyId < fourier_conversion_flags.size());
+  std::call_once(fourier_conversion_flags[keyId], [&]() {
+    if (preparedKeyset != nullptr) {
+      // The key is already in the fourier domain, only the fft is needed.
+      auto info = serverKeyset.lweBootstrapKeys[keyId].getInfo().asReader();
+      ffts[keyId] = FFT::shared(info.getParams().getPolynomialSize());
+    } else {
+      auto fdbsk =
+          convert_to_fourier_domain(serverKeyset.lweBootstrapKeys[keyId]);
+      size_t size = fdbsk.second->size() * sizeof(std::complex<double>);
+      memory::allocate(memory::Category::KEYS, size);
+      host_keys_size += size;
+      fourier_bootstrap_keys[keyId] = fdbsk.second;
+      ffts[keyId] = fdbsk.first;
+    }
+    if (numa::replicate_keys())
+      replicate_fourier_bootstrap_key(keyId);
+  });
+}
+
+void RuntimeContext::ensure_fourier_fast_keyswitch_key(size_t keyId) {
+  assert(keyId < fast_keyswitch_conversion_flags.size());
+  std::call_once(fast_keyswitch_conversion_flags[keyId], [&]() {
+    auto params =
+        serverKeyset.lweKeyswitchKeys[keyId].getInfo().asReader().getParams();
+    size_t polynomial_size = params.getOutputPolynomialSize();
+    assert(polynomial_size > 0 && "Not a fast keyswitch key");
+    size_t glwe_dimension = params.getOutputLweDimension() / polynomial_size;
+    auto fft = FFT::shared(polynomial_size);
+    auto fourier = std::make_shared<FourierKey>(
+        concrete_cpu_fourier_fast_keyswitch_key_size_u64(
+            params.getLevelCount(), params.getInputLweDimension(),
+            glwe_dimension, polynomial_size));
+    size_t size = fourier->size() * sizeof(std::complex<double>);
+    memory::allocate(memory::Category::KEYS, size);
+    host_keys_size += size;
+    concrete_cpu_fast_keyswitch_key_convert_u64_to_fourier(
+        keyswitch_key_buffer(keyId), fourier->data(),
+        params.getLevelCount(), params.getInputLweDimension(), glwe_dimension,
+        polynomial_size, fft->fft);
+    fourier_fast_keyswitch_keys[keyId] = fourier;
+    fast_keyswitch_ffts[keyId] = fft;
+  });
+}
+
+void RuntimeContext::replicate_fourier_bootstrap_key(size_t keyId) {
+  auto params =
+      serverKeyset.lweBootstrapKeys[keyId].getInfo().asReader().getParams();
+  // Two words of the standard key fold in a single complex.
+  size_t size = (bootstrap_key_grouping_factor(keyId) > 1
+                     ? concrete_cpu_multi_bit_bootstrap_key_size_u64(
+                           params.getLevelCount(), params.getGlweDimension(),
+                           params.getPolynomialSize(),
+                           params.getInputLweDimension(),
+                           params.getGroupingFactor())
+                     : concrete_cpu_bootstrap_key_size_u64(
+                           params.getLevelCount(), params.getGlweDimension(),
+                           params.getPolynomialSize(),
+                           params.getInputLweDimension())) /
+                2 * sizeof(std::complex<double>);
+  const std::complex<double> *source =
+      (preparedKeyset != nullptr) ? preparedKeyset->fourierBootstrapKey(keyId)
+                                  : fourier_bootstrap_keys[keyId]->data();
+  auto &replicas = fourier_bootstrap_key_replicas[keyId];
+  memory::allocate(memory::Category::KEYS, size * numa::num_nodes());
+  host_keys_size += size * numa::num_nodes();
+  for (size_t node = 0; node < numa::num_nodes(); node++) {
+    auto replica = (std::complex<double> *)numa::alloc_on_node(size, node);
+    huge_pages::advise(replica, size);
+    memcpy(replica, source, size);
+    replicas.push_back(std::shared_ptr<std::complex<double>>(
+        replica,
+        [size](std::complex<double> *ptr) { numa::free_on_node(ptr, size); }));
+  }
+  // Every bootstrap reads a replica, the converted key is not needed anymore.
+  if (fourier_bootstrap_keys[keyId] != nullptr) {
+    memory::release(memory::Category::KEYS, size);
+    host_keys_size -= size;
+  }
+  fourier_bootstrap_keys[keyId].reset();
+}
+
+const std::complex<double> *
+RuntimeContext::local_fourier_bootstrap_key_replica(size_t keyId) {
+  auto &replicas = fourier_bootstrap_key_replicas[keyId];
+  return replicas[std::min(numa::current_node(), replicas.size() - 1)].get();
+}
+
+std::pair<std::shared_ptr<const FFT>, std::shared_ptr<FourierKey>>
 RuntimeContext::convert_to_fourier_domain(LweBootstrapKey &bsk) {
   auto info = bsk.getInfo().asReader();
 
@@ -61,32 +360,116 @@ RuntimeContext::convert_to_fourier_domain(LweBootstrapKey &bsk) {
   size_t polynomial_size = info.getParams().getPolynomialSize();
   size_t input_lwe_dimension = info.getParams().getInputLweDimension();
 
-  // Create the FFT
-  FFT fft(polynomial_size);
+  size_t grouping_factor = std::max<uint32_t>(
+      info.getParams().getGroupingFactor(), 1);
+
+  auto fft = FFT::shared(polynomial_size);
 
   // Allocate scratch for key conversion
   size_t scratch_size;
   size_t scratch_align;
   concrete_cpu_bootstrap_key_convert_u64_to_fourier_scratch(
-      &scratch_size, &scratch_align, fft.fft);
+      &scratch_size, &scratch_align, fft->fft);
+  memory::Allocation scratch_usage(memory::Category::SCRATCH, scratch_size);
   auto scratch = (uint8_t *)aligned_alloc(scratch_align, scratch_size);
 
   // Allocate the fourier_bootstrap_key
-  auto &bsk_buffer = bsk.getBuffer();
-  auto fourier_data = std::make_shared<std::vector<std::complex<double>>>();
+  // A transient standard buffer is released at the end of the conversion.
+  std::shared_ptr<std::vector<uint64_t>> transient_buffer;
+  if (dropStandardBootstrapKeys) {
+    transient_buffer = bsk.getTransientBuffer();
+  }
+  auto &bsk_buffer =
+      dropStandardBootstrapKeys ? *transient_buffer : bsk.getBuffer();
+  memory::Allocation transient_usage(
+      memory::Category::KEYS,
+      transient_buffer ? bsk_buffer.size() * sizeof(uint64_t) : 0);
+  auto fourier_data = std::make_shared<FourierKey>();
   fourier_data->resize(bsk_buffer.size() / 2);
   auto bsk_data = bsk_buffer.data();
 
   // Convert bootstrap_key to the fourier domain
-  concrete_cpu_bootstrap_key_convert_u64_to_fourier(
-      bsk_data, fourier_data->data(), decomposition_level_count,
-      decomposition_base_log, glwe_dimension, polynomial_size,
-      input_lwe_dimension, fft.fft, scratch, scratch_size);
+  if (grouping_factor > 1) {
+    // The multi-bit conversion allocates its own scratch.
+    concrete_cpu_multi_bit_bootstrap_key_convert_u64_to_fourier(
+        bsk_data, fourier_data->data(), decomposition_level_count,
+        decomposition_base_log, glwe_dimension, polynomial_size,
+        input_lwe_dimension, grouping_factor, Parallelism::Rayon);
+  } else {
+    concrete_cpu_bootstrap_key_convert_u64_to_fourier(
+        bsk_data, fourier_data->data(), decomposition_level_count,
+        decomposition_base_log, glwe_dimension, polynomial_size,
+        input_lwe_dimension, fft->fft, scratch, scratch_size);
+  }
   free(scratch);
 
-  return std::pair<FFT, std::shared_ptr<std::vector<std::complex<double>>>>(
-      std::move(fft), fourier_data);
+  return std::make_pair(fft, fourier_data);
+}
+
+RuntimeContextCache &RuntimeContextCache::global() {
+  static RuntimeContextCache cache;
+  return cache;
 }
+
+RuntimeContextCache::KeysetIdentity
+RuntimeContextCache::identityOf(const ServerKeyset &serverKeyset) {
+  KeysetIdentity identity;
+  for (auto &bsk : serverKeyset.lweBootstrapKeys) {
+    identity.push_back(&bsk.getTransportBuffer());
+  }
+  // Separators make sure keysets with different key kinds never collide.
+  identity.push_back(nullptr);
+  for (auto &ksk : serverKeyset.lweKeyswitchKeys) {
+    identity.push_back(&ksk.getTransportBuffer());
+  }
+  identity.push_back(nullptr);
+  for (auto &pksk : serverKeyset.packingKeyswitchKeys) {
+    identity.push_back(&pksk.getTransportBuffer());
+  }
+  return identity;
+}
+
+std::shared_ptr<RuntimeContext>
+RuntimeContextCache::get(const ServerKeyset &serverKeyset) {
+  auto identity = identityOf(serverKeyset);
+  const std::lock_guard<std::mutex> lock(guard);
+  auto it = contexts.find(identity);
+  if (it != contexts.end()) {
+    return it->second;
+  }
+  auto context = std::make_shared<RuntimeContext>(
+      serverKeyset, getenv("RUNTIME_DROP_STANDARD_BSK") != nullptr);
+  contexts.insert({identity, context});
+  return context;
+}
+
+std::shared_ptr<RuntimeContext>
+RuntimeContextCache::preload(const ServerKeyset &serverKeyset,
+                             std::shared_ptr<PreparedKeyset> preparedKeyset) {
+  auto identity = identityOf(serverKeyset);
+  auto context =
+      std::make_shared<RuntimeContext>(serverKeyset, false, preparedKeyset);
+  const std::lock_guard<std::mutex> lock(guard);
+  contexts[identity] = context;
+  return context;
+}
+
+void RuntimeContextCache::evict(const ServerKeyset &serverKeyset) {
+  auto identity = identityOf(serverKeyset);
+  const std::lock_guard<std::mutex> lock(guard);
+  contexts.erase(identity);
+}
+
+void RuntimeContextCache::clear() {
+  const std::lock_guard<std::mutex> lock(guard);
+  contexts.clear();
+}
+
+size_t RuntimeContextCache::size() {
+  const std::lock_guard<std::mutex> lock(guard);
+  return contexts.size();
+}
+
 } // namespace concretelang
 } // namespace mlir
 
@@ -101,34 +484,116 @@ HPX_PLAIN_ACTION(mlir::concretelang::dfr::getPKsk, _dfr_get_pksk_action)
 
 namespace mlir {
 namespace concretelang {
-const uint64_t *DistributedRuntimeContext::keyswitch_key_buffer(size_t keyId) {
+DistributedRuntimeContext::~DistributedRuntimeContext() {
+  std::lock_guard<std::mutex> guard(cm_guard);
+  for (auto &key : ksks)
+    key.second.wait();
+  for (auto &key : fbks)
+    key.second.wait();
+  for (auto &key : pksks)
+    key.second.wait();
+}
+
+template <typename Key>
+std::shared_future<Key> DistributedRuntimeContext::requestKey(
+    std::map<size_t, std::shared_future<Key>> &keys, size_t keyId,
+    std::function<Key()> fetch, bool wait) {
+  auto promise = std::make_shared<std::promise<Key>>();
+  std::shared_future<Key> future;
+  {
+    std::lock_guard<std::mutex> guard(cm_guard);
+    auto it = keys.find(keyId);
+    if (it != keys.end())
+      return it->second;
+    future = promise->get_future().share();
+    keys.emplace(keyId, future);
+  }
+  auto run = [promise, fetch]() {
+    try {
+      auto start = std::chrono::steady_clock::now();
+      Key key = fetch();
+      dfr::_dfr_record_key_fetch(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+      promise->set_value(std::move(key));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  };
+  if (wait)
+    run();
+  else
+    hpx::post(run);
+  return future;
+}
+
+std::shared_future<std::shared_ptr<LweKeyswitchKey>>
+DistributedRuntimeContext::requestKSK(size_t keyId, bool wait) {
+  uint64_t id = context_id;
+  return requestKey<std::shared_ptr<LweKeyswitchKey>>(
+      ksks, keyId,
+      [id, keyId]() {
+        _dfr_get_ksk_action getKskAction;
+        dfr::KeyWrapper<LweKeyswitchKey> kskw =
+            getKskAction(hpx::find_root_locality(), id, keyId);
+        return std::make_shared<LweKeyswitchKey>(kskw.keys[0]);
+      },
+      wait);
+}
+
+std::shared_future<DistributedRuntimeContext::FourierBootstrapKey>
+DistributedRuntimeContext::requestBSK(size_t keyId, bool wait) {
+  uint64_t id = context_id;
+  return requestKey<FourierBootstrapKey>(
+      fbks, keyId,
+      [this, id, keyId]() {
+        _dfr_get_bsk_action getBskAction;
+        dfr::KeyWrapper<LweBootstrapKey> bskw =
+            getBskAction(hpx::find_root_locality(), id, keyId);
+        return convert_to_fourier_domain(bskw.keys[0]);
+      },
+      wait);
+}
+
+std::shared_future<std::shared_ptr<PackingKeyswitchKey>>
+DistributedRuntimeContext::requestPKSK(size_t keyId, bool wait) {
+  uint64_t id = context_id;
+  return requestKey<std::shared_ptr<PackingKeyswitchKey>>(
+      pksks, keyId,
+      [id, keyId]() {
+        _dfr_get_pksk_action getPKskAction;
+        dfr::KeyWrapper<PackingKeyswitchKey> pkskw =
+            getPKskAction(hpx::find_root_locality(), id, keyId);
+        return std::make_shared<PackingKeyswitchKey>(pkskw.keys[0]);
+      },
+      wait);
+}
+
+void DistributedRuntimeContext::prefetch(uint64_t kind, size_t keyId) {
   if (dfr::_dfr_is_root_node())
-    return RuntimeContext::keyswitch_key_buffer(keyId);
+    return;
 
-  std::lock_guard<std::mutex> guard(cm_guard);
-  if (ksks.find(keyId) == ksks.end()) {
-    _dfr_get_ksk_action getKskAction;
-    dfr::KeyWrapper<LweKeyswitchKey> kskw =
-        getKskAction(hpx::find_root_locality(), keyId);
-    ksks.insert(std::pair<size_t, LweKeyswitchKey>(keyId, kskw.keys[0]));
+  switch (kind) {
+  case dfr::KEY_KIND_BSK:
+    requestBSK(keyId, false);
+    break;
+  case dfr::KEY_KIND_KSK:
+    requestKSK(keyId, false);
+    break;
+  case dfr::KEY_KIND_PKSK:
+    requestPKSK(keyId, false);
+    break;
+  default:
+    assert(false && "DFR: unknown kind of key to prefetch.");
   }
-  auto it = ksks.find(keyId);
-  assert(it != ksks.end());
-  return it->second.getBuffer().data();
 }
 
-void DistributedRuntimeContext::getBSKonNode(size_t keyId) {
-  assert(fbks.find(keyId) == fbks.end());
-  assert(dffts.find(keyId) == dffts.end());
-  _dfr_get_bsk_action getBskAction;
-  dfr::KeyWrapper<LweBootstrapKey> bskw =
-      getBskAction(hpx::find_root_locality(), keyId);
+const uint64_t *DistributedRuntimeContext::keyswitch_key_buffer(size_t keyId) {
+  if (dfr::_dfr_is_root_node())
+    return RuntimeContext::keyswitch_key_buffer(keyId);
 
-  auto fdbsk = convert_to_fourier_domain(bskw.keys[0]);
-  fbks.insert(
-      std::pair<size_t, std::shared_ptr<std::vector<std::complex<double>>>>(
-          keyId, fdbsk.second));
-  dffts.insert(std::pair<size_t, FFT>(keyId, std::move(fdbsk.first)));
+  return requestKSK(keyId, true).get()->getBuffer().data();
 }
 
 const std::complex<double> *
@@ -136,12 +601,7 @@ DistributedRuntimeContext::fourier_bootstrap_key_buffer(size_t keyId) {
   if (dfr::_dfr_is_root_node())
     return RuntimeContext::fourier_bootstrap_key_buffer(keyId);
 
-  std::lock_guard<std::mutex> guard(cm_guard);
-  if (fbks.find(keyId) == fbks.end())
-    getBSKonNode(keyId);
-  auto it = fbks.find(keyId);
-  assert(it != fbks.end());
-  return it->second->data();
+  return requestBSK(keyId, true).get().second->data();
 }
 
 const uint64_t *
@@ -149,28 +609,14 @@ DistributedRuntimeContext::fp_keyswitch_key_buffer(size_t keyId) {
   if (dfr::_dfr_is_root_node())
     return RuntimeContext::fp_keyswitch_key_buffer(keyId);
 
-  std::lock_guard<std::mutex> guard(cm_guard);
-  if (ksks.find(keyId) == ksks.end()) {
-    _dfr_get_pksk_action getPKskAction;
-    dfr::KeyWrapper<PackingKeyswitchKey> pkskw =
-        getPKskAction(hpx::find_root_locality(), keyId);
-    pksks.insert(std::pair<size_t, PackingKeyswitchKey>(keyId, pkskw.keys[0]));
-  }
-  auto it = pksks.find(keyId);
-  assert(it != pksks.end());
-  return it->second.getRawPtr();
+  return requestPKSK(keyId, true).get()->getRawPtr();
 }
 
 const struct Fft *DistributedRuntimeContext::fft(size_t keyId) {
   if (dfr::_dfr_is_root_node())
     return RuntimeContext::fft(keyId);
 
-  std::lock_guard<std::mutex> guard(cm_guard);
-  if (dffts.find(keyId) == dffts.end())
-    getBSKonNode(keyId);
-  auto it = dffts.find(keyId);
-  assert(it != dffts.end());
-  return it->second.fft;
+  return requestBSK(keyId, true).get().first->fft;
 }
 
 } // namespace concretelang
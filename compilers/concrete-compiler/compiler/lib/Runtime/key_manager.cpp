@@ -8,6 +8,7 @@
 #include "concretelang/Runtime/key_manager.hpp"
 #include "concretelang/Common/Keysets.h"
 #include "concretelang/Runtime/context.h"
+#include <algorithm>
 
 namespace mlir {
 namespace concretelang {
@@ -15,24 +16,66 @@ namespace dfr {
 
 RuntimeContextManager *_dfr_node_level_runtime_context_manager;
 
-KeyWrapper<LweKeyswitchKey> getKsk(size_t keyId) {
+namespace {
+// Number of words of each key buffer sampled at both ends by keysetId.
+const size_t KEYSET_ID_SAMPLES = 64;
+
+// FNV-1a
+void hashWords(uint64_t &hash, const uint64_t *words, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    hash ^= words[i];
+    hash *= 0x100000001b3ULL;
+  }
+}
+
+template <typename KeyType>
+void hashKeys(uint64_t &hash, const std::vector<KeyType> &keys) {
+  uint64_t count = keys.size();
+  hashWords(hash, &count, 1);
+  for (auto &key : keys) {
+    auto &buffer = key.getTransportBuffer();
+    uint64_t size = buffer.size();
+    hashWords(hash, &size, 1);
+    size_t samples = std::min(size, (uint64_t)KEYSET_ID_SAMPLES);
+    hashWords(hash, buffer.data(), samples);
+    hashWords(hash, buffer.data() + size - samples, samples);
+  }
+}
+} // namespace
+
+uint64_t keysetId(const ServerKeyset &keyset) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hashKeys(hash, keyset.lweBootstrapKeys);
+  hashKeys(hash, keyset.lweKeyswitchKeys);
+  hashKeys(hash, keyset.packingKeyswitchKeys);
+  return hash;
+}
+
+KeyWrapper<LweKeyswitchKey> getKsk(uint64_t contextId, size_t keyId) {
   return KeyWrapper<LweKeyswitchKey>(std::vector<LweKeyswitchKey>{
-      _dfr_node_level_runtime_context_manager->context->getKeys()
+      _dfr_node_level_runtime_context_manager->getContext(contextId)
+          ->getKeys()
           .lweKeyswitchKeys[keyId]});
 }
 
-KeyWrapper<LweBootstrapKey> getBsk(size_t keyId) {
+KeyWrapper<LweBootstrapKey> getBsk(uint64_t contextId, size_t keyId) {
   return KeyWrapper<LweBootstrapKey>(std::vector<LweBootstrapKey>{
-      _dfr_node_level_runtime_context_manager->context->getKeys()
+      _dfr_node_level_runtime_context_manager->getContext(contextId)
+          ->getKeys()
           .lweBootstrapKeys[keyId]});
 }
 
-KeyWrapper<PackingKeyswitchKey> getPKsk(size_t keyId) {
+KeyWrapper<PackingKeyswitchKey> getPKsk(uint64_t contextId, size_t keyId) {
   return KeyWrapper<PackingKeyswitchKey>(std::vector<PackingKeyswitchKey>{
-      _dfr_node_level_runtime_context_manager->context->getKeys()
+      _dfr_node_level_runtime_context_manager->getContext(contextId)
+          ->getKeys()
           .packingKeyswitchKeys[keyId]});
 }
 
+void prefetchKey(uint64_t contextId, uint64_t kind, size_t keyId) {
+  _dfr_node_level_runtime_context_manager->prefetch(contextId, kind, keyId);
+}
+
 } // namespace dfr
 } // namespace concretelang
 } // namespace mlir
@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <cmath>
 #include <random>
+#include <vector>
 
 using concretelang::csprng::SoftCSPRNG;
 
@@ -46,12 +47,70 @@ uint64_t sim_encrypt_lwe_u64(uint64_t message, uint32_t lwe_dim, void *csprng) {
   return message + encryption_noise;
 }
 
+namespace {
+
+double keyswitch_variance(uint32_t level, uint32_t base_log,
+                          uint32_t input_lwe_dim, uint32_t output_lwe_dim) {
+  double variance_ksk = security_curve()->getVariance(1, output_lwe_dim, 64);
+  return concrete_cpu_variance_keyswitch(input_lwe_dim, base_log, level, 64,
+                                         variance_ksk);
+}
+
+double modulus_switching_variance(uint32_t input_lwe_dim, uint32_t poly_size) {
+  return concrete_cpu_estimate_modulus_switching_noise_with_binary_key(
+      input_lwe_dim, log2(poly_size), 64);
+}
+
+double blind_rotate_variance(uint32_t input_lwe_dim, uint32_t poly_size,
+                             uint32_t level, uint32_t base_log,
+                             uint32_t glwe_dim) {
+  double variance_bsk = security_curve()->getVariance(glwe_dim, poly_size, 64);
+  return concrete_cpu_variance_blind_rotate(
+      input_lwe_dim, glwe_dim, poly_size, base_log, level, 64,
+      mlir::concretelang::optimizer::DEFAULT_FFT_PRECISION, variance_bsk);
+}
+
+/// Fills `noises` with `size` samples of a centered gaussian, with a single
+/// call to the csprng for the whole buffer.
+void fill_gaussian_noise(std::vector<uint64_t> &noises, size_t size,
+                         double variance) {
+  // samples are generated by pairs
+  noises.resize(size + (size & 1));
+  concrete_cpu_fill_with_random_gaussian(noises.data(), noises.size(),
+                                         variance, csprng.ptr);
+}
+
+/// Switches the modulus of `plaintext` to 2 * `poly_size` with the noise
+/// `ms_noise`, and looks the result up in `tlu`.
+uint64_t mod_switch_and_lookup(uint64_t plaintext, uint64_t ms_noise,
+                               const uint64_t *tlu, uint32_t poly_size) {
+  uint64_t shift = (64 - log2(poly_size) - 2);
+  // mod_switch noise
+  ms_noise >>= shift;
+  ms_noise += ms_noise & 1;
+  ms_noise >>= 1;
+  // mod_switch
+  uint64_t mod_switched = plaintext >> shift;
+  mod_switched += mod_switched & 1;
+  mod_switched >>= 1;
+  mod_switched += ms_noise;
+  mod_switched %= 2 * poly_size;
+
+  // blind rotate & sample extract:
+  // instead of doing a plynomial multiplication, then extracting the first
+  // coeff, we directly extract the appropriate coeff from the tlu.
+  if (mod_switched < poly_size)
+    return tlu[mod_switched];
+  return -tlu[mod_switched % poly_size];
+}
+
+} // namespace
+
 uint64_t sim_keyswitch_lwe_u64(uint64_t plaintext, uint32_t level,
                                uint32_t base_log, uint32_t input_lwe_dim,
                                uint32_t output_lwe_dim) {
-  double variance_ksk = security_curve()->getVariance(1, output_lwe_dim, 64);
-  double variance = concrete_cpu_variance_keyswitch(input_lwe_dim, base_log,
-                                                    level, 64, variance_ksk);
+  double variance =
+      keyswitch_variance(level, base_log, input_lwe_dim, output_lwe_dim);
   uint64_t ks_noise = gaussian_noise(0, variance);
   return plaintext + ks_noise;
 }
@@ -65,38 +124,75 @@ uint64_t sim_bootstrap_lwe_u64(uint64_t plaintext, uint64_t *tlu_allocated,
   auto tlu = tlu_aligned + tlu_offset;
 
   // modulus switching
-  double variance_ms =
-      concrete_cpu_estimate_modulus_switching_noise_with_binary_key(
-          input_lwe_dim, log2(poly_size), 64);
-  uint64_t shift = (64 - log2(poly_size) - 2);
-  // mod_switch noise
+  double variance_ms = modulus_switching_variance(input_lwe_dim, poly_size);
   auto noise = gaussian_noise(0, variance_ms);
-  noise >>= shift;
-  noise += noise & 1;
-  noise >>= 1;
-  // mod_switch
-  uint64_t mod_switched = plaintext >> shift;
-  mod_switched += mod_switched & 1;
-  mod_switched >>= 1;
-  mod_switched += noise;
-  mod_switched %= 2 * poly_size;
-
-  uint64_t out;
-  // blind rotate & sample extract:
-  // instead of doing a plynomial multiplication, then extracting the first
-  // coeff, we directly extract the appropriate coeff from the tlu.
-  if (mod_switched < poly_size)
-    out = tlu[mod_switched];
-  else
-    out = -tlu[mod_switched % poly_size];
+  uint64_t out = mod_switch_and_lookup(plaintext, noise, tlu, poly_size);
 
-  double variance_bsk = security_curve()->getVariance(glwe_dim, poly_size, 64);
-  double variance = concrete_cpu_variance_blind_rotate(
-      input_lwe_dim, glwe_dim, poly_size, base_log, level, 64,
-      mlir::concretelang::optimizer::DEFAULT_FFT_PRECISION, variance_bsk);
+  double variance = blind_rotate_variance(input_lwe_dim, poly_size, level,
+                                          base_log, glwe_dim);
   return out + gaussian_noise(0, variance);
 }
 
+void sim_batched_keyswitch_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size, uint64_t out_stride, uint64_t *in_allocated,
+    uint64_t *in_aligned, uint64_t in_offset, uint64_t in_size,
+    uint64_t in_stride, uint32_t level, uint32_t base_log,
+    uint32_t input_lwe_dim, uint32_t output_lwe_dim) {
+  assert(out_size == in_size);
+
+  double variance =
+      keyswitch_variance(level, base_log, input_lwe_dim, output_lwe_dim);
+  std::vector<uint64_t> noises;
+  fill_gaussian_noise(noises, in_size, variance);
+  for (size_t i = 0; i < in_size; i++)
+    out_aligned[out_offset + i * out_stride] =
+        in_aligned[in_offset + i * in_stride] + noises[i];
+}
+
+void sim_batched_bootstrap_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size, uint64_t out_stride, uint64_t *in_allocated,
+    uint64_t *in_aligned, uint64_t in_offset, uint64_t in_size,
+    uint64_t in_stride, uint64_t *tlu_allocated, uint64_t *tlu_aligned,
+    uint64_t tlu_offset, uint64_t tlu_size, uint64_t tlu_stride,
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim) {
+  // the same lookup table for every ciphertext
+  sim_batched_mapped_bootstrap_lwe_u64(
+      out_allocated, out_aligned, out_offset, out_size, out_stride,
+      in_allocated, in_aligned, in_offset, in_size, in_stride, tlu_allocated,
+      tlu_aligned, tlu_offset, in_size, tlu_size, 0, tlu_stride, input_lwe_dim,
+      poly_size, level, base_log, glwe_dim);
+}
+
+void sim_batched_mapped_bootstrap_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size, uint64_t out_stride, uint64_t *in_allocated,
+    uint64_t *in_aligned, uint64_t in_offset, uint64_t in_size,
+    uint64_t in_stride, uint64_t *tlu_allocated, uint64_t *tlu_aligned,
+    uint64_t tlu_offset, uint64_t tlu_size0, uint64_t tlu_size1,
+    uint64_t tlu_stride0, uint64_t tlu_stride1, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log,
+    uint32_t glwe_dim) {
+  assert(out_size == in_size && tlu_size0 == in_size);
+  assert(tlu_size1 == poly_size && tlu_stride1 == 1);
+
+  std::vector<uint64_t> ms_noises, br_noises;
+  fill_gaussian_noise(ms_noises, in_size,
+                      modulus_switching_variance(input_lwe_dim, poly_size));
+  fill_gaussian_noise(br_noises, in_size,
+                      blind_rotate_variance(input_lwe_dim, poly_size, level,
+                                            base_log, glwe_dim));
+  for (size_t i = 0; i < in_size; i++) {
+    auto tlu = tlu_aligned + tlu_offset + i * tlu_stride0;
+    out_aligned[out_offset + i * out_stride] =
+        mod_switch_and_lookup(in_aligned[in_offset + i * in_stride],
+                              ms_noises[i], tlu, poly_size) +
+        br_noises[i];
+  }
+}
+
 void sim_wop_pbs_crt(
     // Output 1D memref
     uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
@@ -118,8 +214,8 @@ void sim_wop_pbs_crt(
     uint32_t bsk_base_log, uint32_t polynomial_size, uint32_t pksk_base_log,
     uint32_t pksk_level_count, uint32_t glwe_dim) {
 
-  // Check number of blocks
-  assert(out_size == in_size && out_size == crt_decomp_size);
+  // Check number of blocks, several lookup tables can share the extracted bits
+  assert(in_size == crt_decomp_size && out_size % crt_decomp_size == 0);
 
   uint64_t log_poly_size =
       static_cast<uint64_t>(ceil(log2(static_cast<double>(polynomial_size))));
@@ -6,55 +6,243 @@
 #include "concretelang/Runtime/wrappers.h"
 #include "concrete-cpu.h"
 #include "concretelang/Common/Error.h"
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <bitset>
 #include <cmath>
 #include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <tuple>
 #include <vector>
 
 #include "concretelang/Common/CRT.h"
+#include "concretelang/Runtime/Numa.h"
+#include "concretelang/Runtime/Profiler.h"
+#include "concretelang/Runtime/TraceBuffer.h"
 #include "concretelang/Runtime/wrappers.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace profiler = mlir::concretelang::profiler;
+
+// Returns the number of threads used to process the batched CPU primitives.
+// It defaults to the OpenMP one and can be set with `BATCH_NUM_THREADS`. The
+// batch is processed sequentially when called from an already parallel
+// region (e.g. from a parallelized loop), to avoid oversubscription. With
+// `RUNTIME_NUMA_BIND`, the threads are pinned to the NUMA nodes on first use.
+static int batch_num_threads(uint64_t batch_size) {
+#ifdef _OPENMP
+  static int num_threads = []() {
+    char *env = getenv("BATCH_NUM_THREADS");
+    int num_threads = omp_get_max_threads();
+    if (env != nullptr && strtoul(env, NULL, 10) != 0)
+      num_threads = (int)strtoul(env, NULL, 10);
+    if (mlir::concretelang::numa::bind_workers() && !omp_in_parallel()) {
+#pragma omp parallel num_threads(num_threads)
+      mlir::concretelang::numa::bind_worker(omp_get_thread_num(),
+                                            omp_get_num_threads());
+    }
+    return num_threads;
+  }();
+  if (omp_in_parallel() || batch_size < 2)
+    return 1;
+  return (int)std::min<uint64_t>(num_threads, batch_size);
+#else
+  return 1;
+#endif
+}
+
+// Returns the number of threads given to each classical CPU bootstrap of a
+// batch of `batch_size` ciphertexts: the ones the batch leaves idle, up to
+// `BOOTSTRAP_NUM_THREADS`. It defaults to 1, the intra bootstrap parallelism
+// only paying off for latency bound circuits with few bootstraps per layer.
+static int bootstrap_num_threads(uint64_t batch_size) {
+  static int max_threads = []() {
+    char *env = getenv("BOOTSTRAP_NUM_THREADS");
+    if (env == nullptr)
+      return 1;
+    return std::max(1, (int)strtol(env, NULL, 10));
+  }();
+  if (max_threads == 1)
+    return 1;
+  int idle_threads =
+      batch_num_threads(UINT64_MAX) / batch_num_threads(batch_size);
+  return std::max(1, std::min(max_threads, idle_threads));
+}
+
+// Returns the parameters of a bootstrap as in the cost tables of the
+// optimizer, which take the log2 of the polynomial size.
+static profiler::CostParameters
+bootstrap_cost_parameters(uint32_t input_lwe_dim, uint32_t glwe_dim,
+                          uint32_t poly_size, uint32_t level,
+                          uint32_t base_log) {
+  uint64_t log_poly_size = 0;
+  while ((uint64_t(1) << log_poly_size) < poly_size)
+    log_poly_size++;
+  return {input_lwe_dim, glwe_dim, log_poly_size, level, base_log};
+}
+
 #ifdef CONCRETELANG_CUDA_SUPPORT
 
+#include "ciphertext.h"
+#include "concretelang/Runtime/GPUTuning.h"
+#include "linear_algebra.h"
+
+namespace gpu_tuning = mlir::concretelang::gpu_tuning;
+
 // CUDA memory utils function /////////////////////////////////////////////////
 
 void *memcpy_async_bsk_to_gpu(mlir::concretelang::RuntimeContext *context,
                               uint32_t input_lwe_dim, uint32_t poly_size,
                               uint32_t level, uint32_t glwe_dim,
-                              uint32_t gpu_idx, void *stream) {
+                              uint32_t bsk_index, uint32_t gpu_idx,
+                              void *stream) {
   return context->get_bsk_gpu(input_lwe_dim, poly_size, level, glwe_dim,
-                              gpu_idx, stream);
+                              bsk_index, gpu_idx, stream);
 }
 
 void *memcpy_async_ksk_to_gpu(mlir::concretelang::RuntimeContext *context,
                               uint32_t level, uint32_t input_lwe_dim,
-                              uint32_t output_lwe_dim, uint32_t gpu_idx,
-                              void *stream) {
-  return context->get_ksk_gpu(level, input_lwe_dim, output_lwe_dim, gpu_idx,
-                              stream);
+                              uint32_t output_lwe_dim, uint32_t ksk_index,
+                              uint32_t gpu_idx, void *stream) {
+  return context->get_ksk_gpu(level, input_lwe_dim, output_lwe_dim, ksk_index,
+                              gpu_idx, stream);
+}
+
+// Bytes moved between the host and the devices by the CUDA wrappers.
+static std::atomic<uint64_t> cuda_bytes_to_gpu = {0};
+static std::atomic<uint64_t> cuda_bytes_to_cpu = {0};
+
+void cuda_transfer_counters(uint64_t *bytes_to_gpu, uint64_t *bytes_to_cpu) {
+  *bytes_to_gpu = cuda_bytes_to_gpu.load();
+  *bytes_to_cpu = cuda_bytes_to_cpu.load();
+}
+
+/// Returns whether the transfers of memrefs are staged through page-locked
+/// host memory, enabled by setting `GPU_PINNED_STAGING`. Copies from pageable
+/// memory are synchronous and run at a fraction of the bus bandwidth, while
+/// staged copies overlap with the kernels already queued on the stream.
+static bool cuda_pinned_staging() {
+  static bool enabled = getenv("GPU_PINNED_STAGING") != nullptr;
+  return enabled;
 }
 
-void *alloc_and_memcpy_async_to_gpu(uint64_t *buf_ptr, uint64_t buf_offset,
+/// Page-locked host buffers reused across the calls of the CUDA wrappers,
+/// binned by power of two capacities.
+struct PinnedHostPool {
+  static PinnedHostPool &global() {
+    static PinnedHostPool pool;
+    return pool;
+  }
+
+  /// Returns a buffer of at least `size` bytes, and its capacity.
+  void *acquire(size_t size, size_t &capacity) {
+    capacity = 4096;
+    while (capacity < size)
+      capacity <<= 1;
+    {
+      const std::lock_guard<std::mutex> lock(guard);
+      auto &buffers = free_buffers[capacity];
+      if (!buffers.empty()) {
+        void *ptr = buffers.back();
+        buffers.pop_back();
+        return ptr;
+      }
+    }
+    void *ptr;
+    cudaMallocHost(&ptr, capacity);
+    return ptr;
+  }
+
+  void release(void *ptr, size_t capacity) {
+    const std::lock_guard<std::mutex> lock(guard);
+    free_buffers[capacity].push_back(ptr);
+  }
+
+private:
+  std::mutex guard;
+  std::map<size_t, std::vector<void *>> free_buffers;
+};
+
+/// The host/device transfers of a wrapper call. Copies to the host through
+/// a staging buffer only land in their destination on `finish`, which must
+/// be called once the streams they were queued on are synchronized.
+struct CudaTransfers {
+  ~CudaTransfers() {
+    assert(copies_to_cpu.empty() && "CudaTransfers not finished");
+    for (auto &buffer : staging_buffers)
+      PinnedHostPool::global().release(buffer.first, buffer.second);
+  }
+
+  void to_gpu(void *device, const void *host, size_t size, uint32_t gpu_idx,
+              void *stream) {
+    profiler::Scope scope(profiler::Primitive::DEVICE_COPY);
+    cuda_bytes_to_gpu += size;
+    if (cuda_pinned_staging()) {
+      void *staging = acquire(size);
+      memcpy(staging, host, size);
+      host = staging;
+    }
+    cuda_memcpy_async_to_gpu(device, const_cast<void *>(host), size,
+                             (cudaStream_t *)stream, gpu_idx);
+  }
+
+  void to_cpu(void *host, const void *device, size_t size, uint32_t gpu_idx,
+              void *stream) {
+    profiler::Scope scope(profiler::Primitive::DEVICE_COPY);
+    cuda_bytes_to_cpu += size;
+    if (cuda_pinned_staging()) {
+      void *staging = acquire(size);
+      copies_to_cpu.push_back({host, staging, size});
+      host = staging;
+    }
+    cuda_memcpy_async_to_cpu(host, device, size, (cudaStream_t *)stream,
+                             gpu_idx);
+  }
+
+  void finish() {
+    profiler::Scope scope(profiler::Primitive::DEVICE_COPY);
+    for (auto &copy : copies_to_cpu)
+      memcpy(std::get<0>(copy), std::get<1>(copy), std::get<2>(copy));
+    copies_to_cpu.clear();
+  }
+
+private:
+  void *acquire(size_t size) {
+    size_t capacity;
+    void *ptr = PinnedHostPool::global().acquire(size, capacity);
+    staging_buffers.push_back({ptr, capacity});
+    return ptr;
+  }
+
+  std::vector<std::pair<void *, size_t>> staging_buffers;
+  std::vector<std::tuple<void *, void *, size_t>> copies_to_cpu;
+};
+
+void *alloc_and_memcpy_async_to_gpu(CudaTransfers &transfers,
+                                    uint64_t *buf_ptr, uint64_t buf_offset,
                                     uint64_t buf_size, uint32_t gpu_idx,
                                     void *stream) {
   size_t buf_size_ = buf_size * sizeof(uint64_t);
   void *ct_gpu = cuda_malloc_async(buf_size_, (cudaStream_t *)stream, gpu_idx);
-  cuda_memcpy_async_to_gpu(ct_gpu, buf_ptr + buf_offset, buf_size_,
-                           (cudaStream_t *)stream, gpu_idx);
+  transfers.to_gpu(ct_gpu, buf_ptr + buf_offset, buf_size_, gpu_idx, stream);
   return ct_gpu;
 }
 
-void memcpy_async_to_cpu(uint64_t *buf_ptr, uint64_t buf_offset,
-                         uint64_t buf_size, void *buf_gpu, uint32_t gpu_idx,
-                         void *stream) {
-  cuda_memcpy_async_to_cpu(buf_ptr + buf_offset, buf_gpu,
-                           buf_size * sizeof(uint64_t), (cudaStream_t *)stream,
-                           gpu_idx);
+void memcpy_async_to_cpu(CudaTransfers &transfers, uint64_t *buf_ptr,
+                         uint64_t buf_offset, uint64_t buf_size, void *buf_gpu,
+                         uint32_t gpu_idx, void *stream) {
+  transfers.to_cpu(buf_ptr + buf_offset, buf_gpu, buf_size * sizeof(uint64_t),
+                   gpu_idx, stream);
 }
 
 void free_from_gpu(void *gpu_ptr, uint32_t gpu_idx = 0) {
@@ -111,7 +299,16 @@ void memref_batched_keyswitch_lwe_cuda_u64(
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint32_t level,
     uint32_t base_log, uint32_t input_lwe_dim, uint32_t output_lwe_dim,
     uint32_t ksk_index, mlir::concretelang::RuntimeContext *context) {
-  assert(ksk_index == 0 && "multiple ksk is not yet implemented on GPU");
+  if (context->keyswitch_key_output_polynomial_size(ksk_index) > 0) {
+    // There is no CUDA kernel for the fast keyswitch, it runs on the host
+    memref_batched_keyswitch_lwe_u64(
+        out_allocated, out_aligned, out_offset, out_size0, out_size1,
+        out_stride0, out_stride1, ct0_allocated, ct0_aligned, ct0_offset,
+        ct0_size0, ct0_size1, ct0_stride0, ct0_stride1, level, base_log,
+        input_lwe_dim, output_lwe_dim, ksk_index, context);
+    return;
+  }
+  profiler::Scope scope(profiler::Primitive::KEYSWITCH);
   assert(out_size0 == ct0_size0);
   assert(out_size1 == output_lwe_dim + 1);
   assert(ct0_size1 == input_lwe_dim + 1);
@@ -126,11 +323,13 @@ void memref_batched_keyswitch_lwe_cuda_u64(
   void *stream = cuda_create_stream(gpu_idx);
   // Get the pointer on the keyswitching key on the GPU
   void *ksk_gpu = memcpy_async_ksk_to_gpu(context, level, input_lwe_dim,
-                                          output_lwe_dim, gpu_idx, stream);
+                                          output_lwe_dim, ksk_index, gpu_idx,
+                                          stream);
   // Move the input and output batch of ciphertexts to the GPU
   // TODO: The allocation should be done by the compiler codegen
+  CudaTransfers transfers;
   void *ct0_gpu = alloc_and_memcpy_async_to_gpu(
-      ct0_aligned, ct0_offset, ct0_batch_size, gpu_idx, (cudaStream_t *)stream);
+      transfers, ct0_aligned, ct0_offset, ct0_batch_size, gpu_idx, stream);
   void *out_gpu = cuda_malloc_async(out_batch_size * sizeof(uint64_t),
                                     (cudaStream_t *)stream, gpu_idx);
   // Run the keyswitch kernel on the GPU
@@ -138,53 +337,287 @@ void memref_batched_keyswitch_lwe_cuda_u64(
       stream, gpu_idx, out_gpu, ct0_gpu, ksk_gpu, input_lwe_dim, output_lwe_dim,
       base_log, level, num_samples);
   // Copy the output batch of ciphertext back to CPU
-  memcpy_async_to_cpu(out_aligned, out_offset, out_batch_size, out_gpu, gpu_idx,
-                      stream);
+  memcpy_async_to_cpu(transfers, out_aligned, out_offset, out_batch_size,
+                      out_gpu, gpu_idx, stream);
   cuda_synchronize_device(gpu_idx);
+  transfers.finish();
   // free memory that we allocated on gpu
   cuda_drop(ct0_gpu, gpu_idx);
   cuda_drop(out_gpu, gpu_idx);
   cuda_destroy_stream((cudaStream_t *)stream, gpu_idx);
 }
 
-void memref_batched_bootstrap_lwe_cuda_u64(
-    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
-    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
-    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
-    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
-    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
-    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
-    uint64_t tlu_stride, uint32_t input_lwe_dim, uint32_t poly_size,
-    uint32_t level, uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+/// Number of streams a device splits its shard of a batched bootstrap on, so
+/// that the copies of one part overlap with the computation of the other.
+static const uint32_t CUDA_STREAMS_PER_DEVICE = 2;
+
+/// Returns the number of devices a batch of `num_samples` ciphertexts is
+/// sharded on. All the devices are used unless `GPU_NUM_DEVICES` caps it.
+static uint32_t cuda_num_devices_for_batch(uint32_t num_samples) {
+  int num_devices = cuda_get_number_of_gpus();
+  char *env = getenv("GPU_NUM_DEVICES");
+  if (env != nullptr) {
+    num_devices = std::min(num_devices, atoi(env));
+  }
+  return std::max(1u, std::min((uint32_t)num_devices, num_samples));
+}
+
+/// The part of a batched bootstrap scheduled on one stream of a device.
+struct CudaBootstrapShard {
+  uint32_t gpu_idx;
+  void *stream;
+  uint64_t begin;
+  uint32_t num_samples;
+  void *ct0_gpu;
+  void *out_gpu;
+  void *glwe_ct_gpu;
+  void *test_vector_idxes_gpu;
+  int8_t *pbs_buffer;
+};
+
+/// Returns whether the shards of the batched bootstraps are captured once in a
+/// CUDA graph and replayed by the later calls with the same shapes and
+/// parameters, enabled by setting `GPU_GRAPH_REPLAY`. A replay issues a single
+/// launch instead of every copy and kernel launch of the shard.
+static bool cuda_graph_replay() {
+  static bool enabled = getenv("GPU_GRAPH_REPLAY") != nullptr;
+  return enabled;
+}
+
+/// A shard of a batched bootstrap captured in a CUDA graph. The graph copies
+/// its inputs from and its outputs to page-locked host buffers and runs on
+/// device buffers, all owned by the graph so that their addresses are stable
+/// across the replays.
+struct CudaBootstrapGraph {
+  std::mutex guard;
+  cudaGraphExec_t exec = nullptr;
+  void *stream = nullptr;
+  // The keys captured in the graph, which must be recaptured if they got
+  // evicted from the device.
+  void *fbsk_gpu = nullptr;
+  void *ksk_gpu = nullptr;
+  uint64_t *ct0_host;
+  uint64_t *glwe_ct_host;
+  uint64_t *out_host;
+  void *ct0_gpu;
+  void *ks_gpu;
+  void *out_gpu;
+  void *glwe_ct_gpu;
+  void *test_vector_idxes_gpu;
+  int8_t *pbs_buffer = nullptr;
+};
+
+/// The shapes and parameters identifying a captured shard: the context, the
+/// device and the slot of the shard, its number of samples and sizes, and the
+/// bootstrap, keyswitch and leveled prologue parameters.
+typedef std::tuple<mlir::concretelang::RuntimeContext *, uint32_t, uint32_t,
+                   uint32_t, uint64_t, uint64_t, uint32_t, uint32_t, uint32_t,
+                   uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                   uint32_t, uint64_t, uint64_t>
+    CudaBootstrapGraphKey;
+
+static CudaBootstrapGraph &
+get_cuda_bootstrap_graph(const CudaBootstrapGraphKey &key) {
+  static std::mutex guard;
+  static std::map<CudaBootstrapGraphKey, std::unique_ptr<CudaBootstrapGraph>>
+      graphs;
+  const std::lock_guard<std::mutex> lock(guard);
+  auto &graph = graphs[key];
+  if (graph == nullptr)
+    graph = std::make_unique<CudaBootstrapGraph>();
+  return *graph;
+}
+
+/// The keyswitch applied on device to the inputs of a fused batched
+/// keyswitch-bootstrap, after multiplying them by `cleartext` and adding
+/// `plaintext` to their bodies. This prologue is the composition of the
+/// leveled operations fused in the call.
+struct CudaKeyswitchParams {
+  uint32_t level;
+  uint32_t base_log;
+  uint32_t input_lwe_dim;
+  uint32_t ksk_index;
+  uint64_t cleartext = 1;
+  uint64_t plaintext = 0;
+
+  bool has_prologue() const { return cleartext != 1 || plaintext != 0; }
+};
+
+/// Applies the leveled prologue of `ks`, if any, in place on the
+/// `num_samples` ciphertexts of `ct0_gpu`.
+static void cuda_keyswitch_prologue(const CudaKeyswitchParams *ks,
+                                    void *stream, uint32_t gpu_idx,
+                                    void *ct0_gpu, uint32_t num_samples) {
+  if (ks == nullptr || !ks->has_prologue())
+    return;
+  cuda_affine_lwe_ciphertext_vector_64(stream, gpu_idx, ct0_gpu, ct0_gpu,
+                                       ks->cleartext, ks->plaintext,
+                                       ks->input_lwe_dim, num_samples);
+}
+
+/// Captures the copies and kernels of a shard of `num_samples` ciphertexts in
+/// `graph`, allocating its buffers on the first capture.
+static void capture_cuda_bootstrap_graph(
+    CudaBootstrapGraph &graph, uint32_t gpu_idx, uint32_t num_samples,
+    uint64_t ct0_size1, uint64_t out_size1, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    const CudaKeyswitchParams *ks) {
+  auto stream = (cudaStream_t *)graph.stream;
+  uint64_t ct0_size = num_samples * ct0_size1 * sizeof(uint64_t);
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1) * sizeof(uint64_t);
+  uint64_t out_size = num_samples * out_size1 * sizeof(uint64_t);
+  if (graph.exec == nullptr) {
+    cudaMallocHost((void **)&graph.ct0_host, ct0_size);
+    cudaMallocHost((void **)&graph.glwe_ct_host, glwe_ct_size);
+    cudaMallocHost((void **)&graph.out_host, out_size);
+    graph.ct0_gpu = cuda_malloc_async(ct0_size, stream, gpu_idx);
+    uint64_t ks_size = num_samples * (input_lwe_dim + 1) * sizeof(uint64_t);
+    graph.ks_gpu = (ks == nullptr)
+                       ? nullptr
+                       : cuda_malloc_async(ks_size, stream, gpu_idx);
+    graph.out_gpu = cuda_malloc_async(out_size, stream, gpu_idx);
+    graph.glwe_ct_gpu = cuda_malloc_async(glwe_ct_size, stream, gpu_idx);
+    // The test vector indexes are all 0 and never change.
+    graph.test_vector_idxes_gpu =
+        cuda_malloc_async(num_samples * sizeof(uint64_t), stream, gpu_idx);
+    cuda_memset_async(graph.test_vector_idxes_gpu, 0,
+                      num_samples * sizeof(uint64_t), stream, gpu_idx);
+    scratch_cuda_bootstrap_amortized_64(
+        graph.stream, gpu_idx, &graph.pbs_buffer, glwe_dim, poly_size,
+        num_samples, cuda_get_max_shared_memory(gpu_idx), true);
+  } else {
+    cudaGraphExecDestroy(graph.exec);
+  }
+  // Nothing but the captured work must be pending on the stream.
+  cudaStreamSynchronize(*stream);
+
+  cudaGraph_t captured;
+  cudaStreamBeginCapture(*stream, cudaStreamCaptureModeRelaxed);
+  cuda_memcpy_async_to_gpu(graph.ct0_gpu, graph.ct0_host, ct0_size, stream,
+                           gpu_idx);
+  cuda_keyswitch_prologue(ks, graph.stream, gpu_idx, graph.ct0_gpu,
+                          num_samples);
+  cuda_memcpy_async_to_gpu(graph.glwe_ct_gpu, graph.glwe_ct_host,
+                           glwe_ct_size, stream, gpu_idx);
+  uint32_t num_test_vectors = 1, lwe_idx = 0;
+  if (ks == nullptr) {
+    cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
+        graph.stream, gpu_idx, graph.out_gpu, graph.glwe_ct_gpu,
+        graph.test_vector_idxes_gpu, graph.ct0_gpu, graph.fbsk_gpu,
+        graph.pbs_buffer, input_lwe_dim, glwe_dim, poly_size, base_log, level,
+        num_samples, num_test_vectors, lwe_idx,
+        cuda_get_max_shared_memory(gpu_idx));
+  } else {
+    cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+        graph.stream, gpu_idx, graph.out_gpu, graph.glwe_ct_gpu,
+        graph.test_vector_idxes_gpu, graph.ct0_gpu, graph.ks_gpu,
+        graph.ksk_gpu, graph.fbsk_gpu, graph.pbs_buffer, ks->input_lwe_dim,
+        input_lwe_dim, glwe_dim, poly_size, ks->base_log, ks->level, base_log,
+        level, num_samples, num_test_vectors, lwe_idx,
+        cuda_get_max_shared_memory(gpu_idx));
+  }
+  cuda_memcpy_async_to_cpu(graph.out_host, graph.out_gpu, out_size, stream,
+                           gpu_idx);
+  cudaStreamEndCapture(*stream, &captured);
+  cudaGraphInstantiate(&graph.exec, captured, nullptr, nullptr, 0);
+  cudaGraphDestroy(captured);
+}
+
+/// Runs the shards of a batched bootstrap by replaying their captured graphs,
+/// capturing them on the first call with the given shapes and parameters.
+static void replay_batched_bootstrap_lwe_cuda_u64(
+    std::vector<CudaBootstrapShard> &shards, uint64_t *out_aligned,
+    uint64_t out_offset, uint64_t out_size1, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size1, uint64_t *glwe_ct,
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    const CudaKeyswitchParams *ks,
     mlir::concretelang::RuntimeContext *context) {
-  assert(bsk_index == 0 && "multiple bsk is not yet implemented on GPU");
-  assert(out_size0 == ct0_size0);
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1) * sizeof(uint64_t);
+  std::vector<CudaBootstrapGraph *> graphs;
+  std::vector<std::unique_lock<std::mutex>> locks;
+  for (size_t i = 0; i < shards.size(); i++) {
+    auto &shard = shards[i];
+    uint32_t gpu_idx = shard.gpu_idx;
+    CudaBootstrapGraphKey key{context,
+                              gpu_idx,
+                              (uint32_t)i,
+                              shard.num_samples,
+                              ct0_size1,
+                              out_size1,
+                              input_lwe_dim,
+                              poly_size,
+                              level,
+                              base_log,
+                              glwe_dim,
+                              bsk_index,
+                              ks ? ks->level : 0,
+                              ks ? ks->base_log : 0,
+                              ks ? ks->input_lwe_dim : 0,
+                              ks ? ks->ksk_index : 0,
+                              ks ? ks->cleartext : 1,
+                              ks ? ks->plaintext : 0};
+    auto &graph = get_cuda_bootstrap_graph(key);
+    locks.emplace_back(graph.guard);
+    graphs.push_back(&graph);
+    if (graph.stream == nullptr)
+      graph.stream = cuda_create_stream(gpu_idx);
+    // The keys are made resident outside of the capture, and the graph is
+    // recaptured if they moved since.
+    void *fbsk_gpu =
+        memcpy_async_bsk_to_gpu(context, input_lwe_dim, poly_size, level,
+                                glwe_dim, bsk_index, gpu_idx, graph.stream);
+    void *ksk_gpu = (ks == nullptr)
+                        ? nullptr
+                        : memcpy_async_ksk_to_gpu(
+                              context, ks->level, ks->input_lwe_dim,
+                              input_lwe_dim, ks->ksk_index, gpu_idx,
+                              graph.stream);
+    if (graph.exec == nullptr || graph.fbsk_gpu != fbsk_gpu ||
+        graph.ksk_gpu != ksk_gpu) {
+      graph.fbsk_gpu = fbsk_gpu;
+      graph.ksk_gpu = ksk_gpu;
+      capture_cuda_bootstrap_graph(graph, gpu_idx, shard.num_samples,
+                                   ct0_size1, out_size1, input_lwe_dim,
+                                   poly_size, level, base_log, glwe_dim, ks);
+    }
+    uint64_t ct0_size = shard.num_samples * ct0_size1 * sizeof(uint64_t);
+    memcpy(graph.ct0_host, ct0_aligned + ct0_offset + shard.begin * ct0_size1,
+           ct0_size);
+    memcpy(graph.glwe_ct_host, glwe_ct, glwe_ct_size);
+    cuda_bytes_to_gpu += ct0_size + glwe_ct_size;
+    cudaGraphLaunch(graph.exec, *(cudaStream_t *)graph.stream);
+  }
+  for (size_t i = 0; i < shards.size(); i++) {
+    auto &shard = shards[i];
+    uint64_t out_size = shard.num_samples * out_size1 * sizeof(uint64_t);
+    cudaStreamSynchronize(*(cudaStream_t *)graphs[i]->stream);
+    memcpy(out_aligned + out_offset + shard.begin * out_size1,
+           graphs[i]->out_host, out_size);
+    cuda_bytes_to_cpu += out_size;
+  }
+}
+
+/// Bootstraps a batch of ciphertexts sharded across the devices, first
+/// keyswitching them on device if `ks` is given.
+static void batched_bootstrap_lwe_cuda_u64(
+    uint64_t *out_aligned, uint64_t out_offset, uint64_t out_size0,
+    uint64_t out_size1, uint64_t *ct0_aligned, uint64_t ct0_offset,
+    uint64_t ct0_size1, uint64_t *tlu, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t bsk_index, const CudaKeyswitchParams *ks,
+    mlir::concretelang::RuntimeContext *context) {
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
   assert(out_size1 == glwe_dim * poly_size + 1);
-  // TODO: Multi GPU
-  uint32_t gpu_idx = 0;
+  assert(ct0_size1 ==
+         (ks != nullptr ? ks->input_lwe_dim : input_lwe_dim) + 1);
   uint32_t num_samples = out_size0;
-  uint64_t ct0_batch_size = ct0_size0 * ct0_size1;
-  uint64_t out_batch_size = out_size0 * out_size1;
-  int8_t *pbs_buffer = nullptr;
 
-  // Create the cuda stream
-  // TODO: Should be created by the compiler codegen
-  void *stream = cuda_create_stream(gpu_idx);
-  // Get the pointer on the bootstraping key on the GPU
-  void *fbsk_gpu = memcpy_async_bsk_to_gpu(context, input_lwe_dim, poly_size,
-                                           level, glwe_dim, gpu_idx, stream);
-  // Move the input and output batch of ciphertext to the GPU
-  // TODO: The allocation should be done by the compiler codegen
-  void *ct0_gpu = alloc_and_memcpy_async_to_gpu(
-      ct0_aligned, ct0_offset, ct0_batch_size, gpu_idx, (cudaStream_t *)stream);
-  void *out_gpu = cuda_malloc_async(out_batch_size * sizeof(uint64_t),
-                                    (cudaStream_t *)stream, gpu_idx);
   // Construct the glwe accumulator (on CPU)
   // TODO: Should be done outside of the bootstrap call, compile time if
   // possible. Refactor in progress
   uint64_t glwe_ct_size = poly_size * (glwe_dim + 1);
   uint64_t *glwe_ct = (uint64_t *)malloc(glwe_ct_size * sizeof(uint64_t));
-  auto tlu = tlu_aligned + tlu_offset;
 
   // Glwe trivial encryption
   for (size_t i = 0; i < poly_size * glwe_dim; i++) {
@@ -194,43 +627,216 @@ void memref_batched_bootstrap_lwe_cuda_u64(
     glwe_ct[poly_size * glwe_dim + i] = tlu[i];
   }
 
-  // Move the glwe accumulator to the GPU
-  void *glwe_ct_gpu = alloc_and_memcpy_async_to_gpu(
-      glwe_ct, 0, glwe_ct_size, gpu_idx, (cudaStream_t *)stream);
+  // The test vector indexes is set of 0, shared by all the shards.
+  uint32_t num_test_vectors = 1, lwe_idx = 0;
+  void *test_vector_idxes = malloc(num_samples * sizeof(uint64_t));
+  memset(test_vector_idxes, 0, num_samples * sizeof(uint64_t));
+
+  // Split the batch evenly across the devices, and the shard of each device
+  // across its streams.
+  uint32_t num_devices = cuda_num_devices_for_batch(num_samples);
+  uint32_t num_shards = std::min(num_devices * CUDA_STREAMS_PER_DEVICE,
+                                 std::max(num_samples, num_devices));
+  uint32_t shard_size = (num_samples + num_shards - 1) / num_shards;
+  std::vector<CudaBootstrapShard> shards;
+  CudaTransfers transfers;
+  for (uint32_t i = 0; i < num_shards; i++) {
+    uint64_t begin = (uint64_t)i * shard_size;
+    if (begin >= num_samples)
+      break;
+    CudaBootstrapShard shard;
+    shard.gpu_idx = i % num_devices;
+    shard.begin = begin;
+    shard.num_samples = std::min<uint64_t>(shard_size, num_samples - begin);
+    shard.pbs_buffer = nullptr;
+    shards.push_back(shard);
+  }
 
-  // Move test vector indexes to the GPU, the test vector indexes is set of 0
-  uint32_t num_test_vectors = 1, lwe_idx = 0,
-           test_vector_idxes_size = num_samples * sizeof(uint64_t);
-  void *test_vector_idxes = malloc(test_vector_idxes_size);
-  memset(test_vector_idxes, 0, test_vector_idxes_size);
-  void *test_vector_idxes_gpu = cuda_malloc_async(
-      test_vector_idxes_size, (cudaStream_t *)stream, gpu_idx);
-  cuda_memcpy_async_to_gpu(test_vector_idxes_gpu, test_vector_idxes,
-                           test_vector_idxes_size, (cudaStream_t *)stream,
-                           gpu_idx);
-  // Allocate PBS buffer on GPU
-  scratch_cuda_bootstrap_amortized_64(
-      stream, gpu_idx, &pbs_buffer, glwe_dim, poly_size, num_samples,
-      cuda_get_max_shared_memory(gpu_idx), true);
-  // Run the bootstrap kernel on the GPU
-  cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
-      stream, gpu_idx, out_gpu, glwe_ct_gpu, test_vector_idxes_gpu, ct0_gpu,
-      fbsk_gpu, pbs_buffer, input_lwe_dim, glwe_dim, poly_size, base_log, level,
-      num_samples, num_test_vectors, lwe_idx,
-      cuda_get_max_shared_memory(gpu_idx));
-  cleanup_cuda_bootstrap_amortized(stream, gpu_idx, &pbs_buffer);
-  // Copy the output batch of ciphertext back to CPU
-  memcpy_async_to_cpu(out_aligned, out_offset, out_batch_size, out_gpu, gpu_idx,
-                      stream);
-  // free memory that we allocated on gpu
-  cuda_drop_async(ct0_gpu, (cudaStream_t *)stream, gpu_idx);
-  cuda_drop_async(out_gpu, (cudaStream_t *)stream, gpu_idx);
-  cuda_drop_async(glwe_ct_gpu, (cudaStream_t *)stream, gpu_idx);
-  cuda_drop_async(test_vector_idxes_gpu, (cudaStream_t *)stream, gpu_idx);
-  cudaStreamSynchronize(*(cudaStream_t *)stream);
-  // Free the glwe accumulator (on CPU)
+  // The captured graphs only hold the classical PBS kernels.
+  uint32_t grouping_factor = context->bootstrap_key_grouping_factor(bsk_index);
+  if (cuda_graph_replay() && grouping_factor == 1) {
+    replay_batched_bootstrap_lwe_cuda_u64(
+        shards, out_aligned, out_offset, out_size1, ct0_aligned, ct0_offset,
+        ct0_size1, glwe_ct, input_lwe_dim, poly_size, level, base_log,
+        glwe_dim, bsk_index, ks, context);
+    free(glwe_ct);
+    free(test_vector_idxes);
+    return;
+  }
+
+  // Schedule every shard on its own stream, the devices and the streams of a
+  // device then run concurrently.
+  for (auto &shard : shards) {
+    uint32_t gpu_idx = shard.gpu_idx;
+    // TODO: Should be created by the compiler codegen
+    shard.stream = cuda_create_stream(gpu_idx);
+    auto stream = (cudaStream_t *)shard.stream;
+    // Get the pointer on the bootstraping key on the GPU, each device keeps
+    // its own replica resident.
+    void *fbsk_gpu =
+        memcpy_async_bsk_to_gpu(context, input_lwe_dim, poly_size, level,
+                                glwe_dim, bsk_index, gpu_idx, shard.stream);
+    // Move the input and output ciphertexts of the shard to the GPU
+    // TODO: The allocation should be done by the compiler codegen
+    shard.ct0_gpu = alloc_and_memcpy_async_to_gpu(
+        transfers, ct0_aligned, ct0_offset + shard.begin * ct0_size1,
+        shard.num_samples * ct0_size1, gpu_idx, stream);
+    cuda_keyswitch_prologue(ks, shard.stream, gpu_idx, shard.ct0_gpu,
+                            shard.num_samples);
+    shard.out_gpu = cuda_malloc_async(
+        shard.num_samples * out_size1 * sizeof(uint64_t), stream, gpu_idx);
+    // Move the glwe accumulator and the test vector indexes to the GPU
+    shard.glwe_ct_gpu = alloc_and_memcpy_async_to_gpu(
+        transfers, glwe_ct, 0, glwe_ct_size, gpu_idx, stream);
+    uint32_t test_vector_idxes_size = shard.num_samples * sizeof(uint64_t);
+    shard.test_vector_idxes_gpu =
+        cuda_malloc_async(test_vector_idxes_size, stream, gpu_idx);
+    transfers.to_gpu(shard.test_vector_idxes_gpu, test_vector_idxes,
+                     test_vector_idxes_size, gpu_idx, stream);
+    // Pick the PBS kernels, the fused keyswitch-bootstrap only comes in the
+    // amortized variant.
+    gpu_tuning::PBSConfig pbs_config = {gpu_tuning::PBSVariant::Amortized,
+                                        (uint32_t)cuda_get_max_shared_memory(
+                                            gpu_idx),
+                                        1};
+    if (ks == nullptr || grouping_factor > 1)
+      pbs_config = gpu_tuning::select_pbs_config(
+          gpu_idx, shard.stream, input_lwe_dim, poly_size, level, base_log,
+          glwe_dim, grouping_factor, shard.num_samples, fbsk_gpu);
+    // Allocate PBS buffer on GPU
+    gpu_tuning::scratch_pbs(pbs_config, shard.stream, gpu_idx,
+                            &shard.pbs_buffer, input_lwe_dim, glwe_dim,
+                            poly_size, level, shard.num_samples);
+    if (ks == nullptr) {
+      // Run the bootstrap kernel on the GPU
+      gpu_tuning::run_pbs(pbs_config, shard.stream, gpu_idx, shard.out_gpu,
+                          shard.glwe_ct_gpu, shard.test_vector_idxes_gpu,
+                          shard.ct0_gpu, fbsk_gpu, shard.pbs_buffer,
+                          input_lwe_dim, glwe_dim, poly_size, base_log, level,
+                          shard.num_samples, num_test_vectors, lwe_idx);
+    } else if (grouping_factor > 1) {
+      // Run the keyswitch then the multi-bit bootstrap kernels on the GPU,
+      // the keyswitched ciphertexts stay on the device.
+      void *ksk_gpu = memcpy_async_ksk_to_gpu(
+          context, ks->level, ks->input_lwe_dim, input_lwe_dim, ks->ksk_index,
+          gpu_idx, shard.stream);
+      uint64_t ks_size =
+          shard.num_samples * (input_lwe_dim + 1) * sizeof(uint64_t);
+      void *ks_gpu = cuda_malloc_async(ks_size, stream, gpu_idx);
+      cuda_keyswitch_lwe_ciphertext_vector_64(
+          shard.stream, gpu_idx, ks_gpu, shard.ct0_gpu, ksk_gpu,
+          ks->input_lwe_dim, input_lwe_dim, ks->base_log, ks->level,
+          shard.num_samples);
+      gpu_tuning::run_pbs(pbs_config, shard.stream, gpu_idx, shard.out_gpu,
+                          shard.glwe_ct_gpu, shard.test_vector_idxes_gpu,
+                          ks_gpu, fbsk_gpu, shard.pbs_buffer, input_lwe_dim,
+                          glwe_dim, poly_size, base_log, level,
+                          shard.num_samples, num_test_vectors, lwe_idx);
+      cuda_drop_async(ks_gpu, stream, gpu_idx);
+    } else {
+      // Run the keyswitch and the bootstrap kernels on the GPU, the
+      // keyswitched ciphertexts stay on the device.
+      void *ksk_gpu = memcpy_async_ksk_to_gpu(
+          context, ks->level, ks->input_lwe_dim, input_lwe_dim, ks->ksk_index,
+          gpu_idx, shard.stream);
+      uint64_t ks_size =
+          shard.num_samples * (input_lwe_dim + 1) * sizeof(uint64_t);
+      void *ks_gpu = cuda_malloc_async(ks_size, stream, gpu_idx);
+      cuda_keyswitch_bootstrap_amortized_lwe_ciphertext_vector_64(
+          shard.stream, gpu_idx, shard.out_gpu, shard.glwe_ct_gpu,
+          shard.test_vector_idxes_gpu, shard.ct0_gpu, ks_gpu, ksk_gpu,
+          fbsk_gpu, shard.pbs_buffer, ks->input_lwe_dim, input_lwe_dim,
+          glwe_dim, poly_size, ks->base_log, ks->level, base_log, level,
+          shard.num_samples, num_test_vectors, lwe_idx,
+          cuda_get_max_shared_memory(gpu_idx));
+      cuda_drop_async(ks_gpu, stream, gpu_idx);
+    }
+    gpu_tuning::cleanup_pbs(pbs_config, shard.stream, gpu_idx,
+                            &shard.pbs_buffer);
+    // Copy the output ciphertexts of the shard back to CPU
+    memcpy_async_to_cpu(transfers, out_aligned,
+                        out_offset + shard.begin * out_size1,
+                        shard.num_samples * out_size1, shard.out_gpu, gpu_idx,
+                        shard.stream);
+    // free memory that we allocated on gpu
+    cuda_drop_async(shard.ct0_gpu, stream, gpu_idx);
+    cuda_drop_async(shard.out_gpu, stream, gpu_idx);
+    cuda_drop_async(shard.glwe_ct_gpu, stream, gpu_idx);
+    cuda_drop_async(shard.test_vector_idxes_gpu, stream, gpu_idx);
+  }
+
+  for (auto &shard : shards) {
+    cudaStreamSynchronize(*(cudaStream_t *)shard.stream);
+    cuda_destroy_stream((cudaStream_t *)shard.stream, shard.gpu_idx);
+  }
+  transfers.finish();
+  // Free the glwe accumulator and the test vector indexes (on CPU)
   free(glwe_ct);
-  cuda_destroy_stream((cudaStream_t *)stream, gpu_idx);
+  free(test_vector_idxes);
+}
+
+void memref_batched_bootstrap_lwe_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint32_t input_lwe_dim, uint32_t poly_size,
+    uint32_t level, uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    mlir::concretelang::RuntimeContext *context) {
+  assert(out_size0 == ct0_size0);
+  batched_bootstrap_lwe_cuda_u64(out_aligned, out_offset, out_size0, out_size1,
+                                 ct0_aligned, ct0_offset, ct0_size1,
+                                 tlu_aligned + tlu_offset, input_lwe_dim,
+                                 poly_size, level, base_log, glwe_dim,
+                                 bsk_index, nullptr, context);
+}
+
+void memref_batched_keyswitch_bootstrap_lwe_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint32_t ks_level, uint32_t ks_base_log,
+    uint32_t ks_input_lwe_dim, uint32_t ks_output_lwe_dim, uint32_t ksk_index,
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    mlir::concretelang::RuntimeContext *context) {
+  assert(out_size0 == ct0_size0);
+  assert(ks_output_lwe_dim == input_lwe_dim);
+  CudaKeyswitchParams ks = {ks_level, ks_base_log, ks_input_lwe_dim,
+                            ksk_index};
+  batched_bootstrap_lwe_cuda_u64(out_aligned, out_offset, out_size0, out_size1,
+                                 ct0_aligned, ct0_offset, ct0_size1,
+                                 tlu_aligned + tlu_offset, input_lwe_dim,
+                                 poly_size, level, base_log, glwe_dim,
+                                 bsk_index, &ks, context);
+}
+
+void memref_batched_affine_keyswitch_bootstrap_lwe_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint64_t cleartext, uint64_t plaintext,
+    uint32_t ks_level, uint32_t ks_base_log, uint32_t ks_input_lwe_dim,
+    uint32_t ks_output_lwe_dim, uint32_t ksk_index, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t bsk_index, mlir::concretelang::RuntimeContext *context) {
+  assert(out_size0 == ct0_size0);
+  assert(ks_output_lwe_dim == input_lwe_dim);
+  CudaKeyswitchParams ks = {ks_level,  ks_base_log, ks_input_lwe_dim,
+                            ksk_index, cleartext,   plaintext};
+  batched_bootstrap_lwe_cuda_u64(out_aligned, out_offset, out_size0, out_size1,
+                                 ct0_aligned, ct0_offset, ct0_size1,
+                                 tlu_aligned + tlu_offset, input_lwe_dim,
+                                 poly_size, level, base_log, glwe_dim,
+                                 bsk_index, &ks, context);
 }
 
 void memref_batched_mapped_bootstrap_lwe_cuda_u64(
@@ -244,7 +850,7 @@ void memref_batched_mapped_bootstrap_lwe_cuda_u64(
     uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
     uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context) {
-  assert(bsk_index == 0 && "multiple bsk is not yet implemented on GPU");
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
   assert(out_size0 == ct0_size0);
   assert(out_size1 == glwe_dim * poly_size + 1);
   assert((out_size0 == tlu_size0 || tlu_size0 == 1) &&
@@ -252,7 +858,6 @@ void memref_batched_mapped_bootstrap_lwe_cuda_u64(
   // TODO: Multi GPU
   uint32_t gpu_idx = 0;
   uint32_t num_samples = out_size0;
-  uint32_t num_lut_vectors = tlu_size0;
   uint64_t ct0_batch_size = ct0_size0 * ct0_size1;
   uint64_t out_batch_size = out_size0 * out_size1;
   int8_t *pbs_buffer = nullptr;
@@ -261,73 +866,210 @@ void memref_batched_mapped_bootstrap_lwe_cuda_u64(
   // TODO: Should be created by the compiler codegen
   void *stream = cuda_create_stream(gpu_idx);
   // Get the pointer on the bootstraping key on the GPU
-  void *fbsk_gpu = memcpy_async_bsk_to_gpu(context, input_lwe_dim, poly_size,
-                                           level, glwe_dim, gpu_idx, stream);
+  void *fbsk_gpu =
+      memcpy_async_bsk_to_gpu(context, input_lwe_dim, poly_size, level,
+                              glwe_dim, bsk_index, gpu_idx, stream);
   // Move the input and output batch of ciphertext to the GPU
   // TODO: The allocation should be done by the compiler codegen
+  CudaTransfers transfers;
   void *ct0_gpu = alloc_and_memcpy_async_to_gpu(
-      ct0_aligned, ct0_offset, ct0_batch_size, gpu_idx, (cudaStream_t *)stream);
+      transfers, ct0_aligned, ct0_offset, ct0_batch_size, gpu_idx, stream);
   void *out_gpu = cuda_malloc_async(out_batch_size * sizeof(uint64_t),
                                     (cudaStream_t *)stream, gpu_idx);
-  // Construct the glwe accumulator (on CPU)
-  // TODO: Should be done outside of the bootstrap call, compile time if
-  // possible. Refactor in progress
-  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1) * num_lut_vectors;
-  uint64_t *glwe_ct = (uint64_t *)malloc(glwe_ct_size * sizeof(uint64_t));
-  auto tlu = tlu_aligned + tlu_offset;
 
-  // Glwe trivial encryption
-  size_t pos = 0, postlu = 0;
-  for (size_t l = 0; l < num_lut_vectors; ++l) {
-    for (size_t i = 0; i < poly_size * glwe_dim; i++) {
-      glwe_ct[pos++] = 0;
-    }
-    for (size_t i = 0; i < poly_size; i++) {
-      glwe_ct[pos++] = tlu[postlu++];
-    }
+  // Mapped lookup tables repeat a few distinct tables over the whole batch,
+  // so only the distinct ones are sent to the GPU, each ciphertext selecting
+  // its own through the test vector indexes.
+  auto tlu = tlu_aligned + tlu_offset;
+  auto lut_less = [&](const uint64_t *a, const uint64_t *b) {
+    return std::lexicographical_compare(a, a + poly_size, b, b + poly_size);
+  };
+  std::map<const uint64_t *, uint64_t, decltype(lut_less)> lut_ids(lut_less);
+  std::vector<uint64_t> lut_bodies;
+  std::vector<uint64_t> test_vector_idxes(num_samples);
+  for (size_t i = 0; i < num_samples; ++i) {
+    const uint64_t *lut = tlu + (tlu_size0 == 1 ? 0 : i * poly_size);
+    auto inserted = lut_ids.emplace(lut, lut_ids.size());
+    if (inserted.second)
+      lut_bodies.insert(lut_bodies.end(), lut, lut + poly_size);
+    test_vector_idxes[i] = inserted.first->second;
   }
+  uint32_t num_lut_vectors = lut_ids.size();
 
-  // Move the glwe accumulator to the GPU
-  void *glwe_ct_gpu = alloc_and_memcpy_async_to_gpu(
-      glwe_ct, 0, glwe_ct_size, gpu_idx, (cudaStream_t *)stream);
+  // Move the bodies of the distinct tables to the GPU and expand them there
+  // into the trivially encrypted glwe accumulators
+  void *lut_bodies_gpu = alloc_and_memcpy_async_to_gpu(
+      transfers, lut_bodies.data(), 0, lut_bodies.size(), gpu_idx, stream);
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1) * num_lut_vectors;
+  void *glwe_ct_gpu = cuda_malloc_async(glwe_ct_size * sizeof(uint64_t),
+                                        (cudaStream_t *)stream, gpu_idx);
+  cuda_glwe_trivial_encrypt_lut_vector_64(stream, gpu_idx, glwe_ct_gpu,
+                                          lut_bodies_gpu, num_lut_vectors,
+                                          glwe_dim, poly_size);
 
-  // Move test vector indexes to the GPU, the test vector indexes is set of 0
+  // Move test vector indexes to the GPU
   uint32_t lwe_idx = 0, test_vector_idxes_size = num_samples * sizeof(uint64_t);
-  uint64_t *test_vector_idxes = (uint64_t *)malloc(test_vector_idxes_size);
-  if (num_lut_vectors == 1) {
-    memset((void *)test_vector_idxes, 0, test_vector_idxes_size);
-  } else {
-    assert(num_lut_vectors == num_samples);
-    for (size_t i = 0; i < num_lut_vectors; ++i)
-      test_vector_idxes[i] = i;
-  }
   void *test_vector_idxes_gpu = cuda_malloc_async(
       test_vector_idxes_size, (cudaStream_t *)stream, gpu_idx);
-  cuda_memcpy_async_to_gpu(test_vector_idxes_gpu, (void *)test_vector_idxes,
-                           test_vector_idxes_size, (cudaStream_t *)stream,
-                           gpu_idx);
+  transfers.to_gpu(test_vector_idxes_gpu, test_vector_idxes.data(),
+                   test_vector_idxes_size, gpu_idx, stream);
   // Allocate PBS buffer on GPU
-  scratch_cuda_bootstrap_amortized_64(
-      stream, gpu_idx, &pbs_buffer, glwe_dim, poly_size, num_samples,
-      cuda_get_max_shared_memory(gpu_idx), true);
+  auto pbs_config = gpu_tuning::select_pbs_config(
+      gpu_idx, stream, input_lwe_dim, poly_size, level, base_log, glwe_dim,
+      context->bootstrap_key_grouping_factor(bsk_index), num_samples,
+      fbsk_gpu);
+  gpu_tuning::scratch_pbs(pbs_config, stream, gpu_idx, &pbs_buffer,
+                          input_lwe_dim, glwe_dim, poly_size, level,
+                          num_samples);
   // Run the bootstrap kernel on the GPU
-  cuda_bootstrap_amortized_lwe_ciphertext_vector_64(
-      stream, gpu_idx, out_gpu, glwe_ct_gpu, test_vector_idxes_gpu, ct0_gpu,
-      fbsk_gpu, pbs_buffer, input_lwe_dim, glwe_dim, poly_size, base_log, level,
-      num_samples, num_lut_vectors, lwe_idx,
-      cuda_get_max_shared_memory(gpu_idx));
-  cleanup_cuda_bootstrap_amortized(stream, gpu_idx, &pbs_buffer);
+  gpu_tuning::run_pbs(pbs_config, stream, gpu_idx, out_gpu, glwe_ct_gpu,
+                      test_vector_idxes_gpu, ct0_gpu, fbsk_gpu, pbs_buffer,
+                      input_lwe_dim, glwe_dim, poly_size, base_log, level,
+                      num_samples, num_lut_vectors, lwe_idx);
+  gpu_tuning::cleanup_pbs(pbs_config, stream, gpu_idx, &pbs_buffer);
   // Copy the output batch of ciphertext back to CPU
-  memcpy_async_to_cpu(out_aligned, out_offset, out_batch_size, out_gpu, gpu_idx,
-                      stream);
+  memcpy_async_to_cpu(transfers, out_aligned, out_offset, out_batch_size,
+                      out_gpu, gpu_idx, stream);
   // free memory that we allocated on gpu
   cuda_drop_async(ct0_gpu, (cudaStream_t *)stream, gpu_idx);
   cuda_drop_async(out_gpu, (cudaStream_t *)stream, gpu_idx);
   cuda_drop_async(glwe_ct_gpu, (cudaStream_t *)stream, gpu_idx);
+  cuda_drop_async(lut_bodies_gpu, (cudaStream_t *)stream, gpu_idx);
   cuda_drop_async(test_vector_idxes_gpu, (cudaStream_t *)stream, gpu_idx);
   cudaStreamSynchronize(*(cudaStream_t *)stream);
-  // Free the glwe accumulator (on CPU)
-  free(glwe_ct);
+  transfers.finish();
+  cuda_destroy_stream((cudaStream_t *)stream, gpu_idx);
+}
+
+/// Returns whether the CUDA WoP-PBS supports the parameters, following the
+/// checks of `cuda_wop_pbs_64`.
+static bool cuda_supports_wop_pbs(uint32_t glwe_dim, uint32_t poly_size,
+                                  uint32_t bsk_level_count,
+                                  uint64_t crt_decomp_size,
+                                  uint64_t total_bits, uint32_t gpu_idx) {
+  int number_of_sm = 0;
+  cudaDeviceGetAttribute(&number_of_sm, cudaDevAttrMultiProcessorCount,
+                         gpu_idx);
+  return glwe_dim == 1 && poly_size >= 256 && poly_size <= 8192 &&
+         (poly_size & (poly_size - 1)) == 0 &&
+         crt_decomp_size <=
+             number_of_sm / 4. / (glwe_dim + 1) / bsk_level_count &&
+         total_bits >= log2(poly_size);
+}
+
+void memref_wop_pbs_crt_cuda_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size_0, uint64_t out_size_1, uint64_t out_stride_0,
+    uint64_t out_stride_1, uint64_t *in_allocated, uint64_t *in_aligned,
+    uint64_t in_offset, uint64_t in_size_0, uint64_t in_size_1,
+    uint64_t in_stride_0, uint64_t in_stride_1, uint64_t *lut_ct_allocated,
+    uint64_t *lut_ct_aligned, uint64_t lut_ct_offset, uint64_t lut_ct_size0,
+    uint64_t lut_ct_size1, uint64_t lut_ct_stride0, uint64_t lut_ct_stride1,
+    uint64_t *crt_decomp_allocated, uint64_t *crt_decomp_aligned,
+    uint64_t crt_decomp_offset, uint64_t crt_decomp_size,
+    uint64_t crt_decomp_stride, uint32_t lwe_small_dim,
+    uint32_t cbs_level_count, uint32_t cbs_base_log, uint32_t ksk_level_count,
+    uint32_t ksk_base_log, uint32_t bsk_level_count, uint32_t bsk_base_log,
+    uint32_t fpksk_level_count, uint32_t fpksk_base_log,
+    uint32_t polynomial_size, uint32_t ksk_index, uint32_t bsk_index,
+    uint32_t pksk_index, mlir::concretelang::RuntimeContext *context) {
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
+  assert(out_stride_1 == 1 && in_stride_0 == in_size_1);
+  assert(in_size_0 == crt_decomp_size && out_size_0 % crt_decomp_size == 0);
+  assert(lut_ct_size0 == out_size_0);
+  assert(out_size_1 == in_size_1);
+  assert(lut_ct_stride1 == 1 && lut_ct_stride0 == lut_ct_size1);
+  uint64_t lwe_big_size = in_size_1;
+  uint64_t lwe_big_dim = lwe_big_size - 1;
+  assert(lwe_big_dim % polynomial_size == 0);
+  uint32_t glwe_dim = lwe_big_dim / polynomial_size;
+  // TODO: Multi GPU
+  uint32_t gpu_idx = 0;
+
+  std::vector<uint32_t> number_of_bits_per_block(crt_decomp_size);
+  uint64_t total_number_of_bits = 0;
+  for (uint64_t i = 0; i < crt_decomp_size; i++) {
+    uint64_t modulus = crt_decomp_aligned[i + crt_decomp_offset];
+    number_of_bits_per_block[i] =
+        static_cast<uint32_t>(ceil(log2(static_cast<double>(modulus))));
+    total_number_of_bits += number_of_bits_per_block[i];
+  }
+
+  if (!cuda_supports_wop_pbs(glwe_dim, polynomial_size, bsk_level_count,
+                             crt_decomp_size, total_number_of_bits, gpu_idx)) {
+    memref_wop_pbs_crt_buffer(
+        out_allocated, out_aligned, out_offset, out_size_0, out_size_1,
+        out_stride_0, out_stride_1, in_allocated, in_aligned, in_offset,
+        in_size_0, in_size_1, in_stride_0, in_stride_1, lut_ct_allocated,
+        lut_ct_aligned, lut_ct_offset, lut_ct_size0, lut_ct_size1,
+        lut_ct_stride0, lut_ct_stride1, crt_decomp_allocated,
+        crt_decomp_aligned, crt_decomp_offset, crt_decomp_size,
+        crt_decomp_stride, lwe_small_dim, cbs_level_count, cbs_base_log,
+        ksk_level_count, ksk_base_log, bsk_level_count, bsk_base_log,
+        fpksk_level_count, fpksk_base_log, polynomial_size, ksk_index,
+        bsk_index, pksk_index, context);
+    return;
+  }
+
+  // Same private copy and body correction as memref_wop_pbs_crt_buffer
+  uint64_t ct_batch_size = crt_decomp_size * lwe_big_size;
+  std::vector<uint64_t> in_copy(in_aligned + in_offset,
+                                in_aligned + in_offset + ct_batch_size);
+  for (uint64_t i = 0; i < crt_decomp_size; i++) {
+    uint64_t nb_bits_to_extract = number_of_bits_per_block[i];
+    in_copy[lwe_big_size * (i + 1) - 1] -=
+        (uint64_t(1) << (uint64_t(64) - nb_bits_to_extract - 1)) -
+        (uint64_t(1) << (uint64_t(64) - nb_bits_to_extract - 5));
+  }
+
+  void *stream = cuda_create_stream(gpu_idx);
+  // The keys stay resident on the device across the calls
+  void *bsk_gpu =
+      memcpy_async_bsk_to_gpu(context, lwe_small_dim, polynomial_size,
+                              bsk_level_count, glwe_dim, bsk_index, gpu_idx,
+                              stream);
+  void *ksk_gpu =
+      memcpy_async_ksk_to_gpu(context, ksk_level_count, lwe_big_dim,
+                              lwe_small_dim, ksk_index, gpu_idx, stream);
+  void *pksk_gpu = context->get_pksk_gpu(pksk_index, gpu_idx, stream);
+
+  CudaTransfers transfers;
+  void *in_gpu = alloc_and_memcpy_async_to_gpu(
+      transfers, in_copy.data(), 0, ct_batch_size, gpu_idx, stream);
+  void *lut_gpu = alloc_and_memcpy_async_to_gpu(
+      transfers, lut_ct_aligned, lut_ct_offset, lut_ct_size0 * lut_ct_size1,
+      gpu_idx, stream);
+  uint64_t out_batch_size = out_size_0 * lwe_big_size;
+  void *out_gpu = cuda_malloc_async(out_batch_size * sizeof(uint64_t),
+                                    (cudaStream_t *)stream, gpu_idx);
+
+  int8_t *wop_pbs_buffer = nullptr;
+  std::vector<uint32_t> delta_logs(crt_decomp_size);
+  uint32_t cbs_delta_log;
+  uint32_t max_shared_memory = cuda_get_max_shared_memory(gpu_idx);
+  // Every lookup table is vertical packed on the same circuit bootstrapped
+  // bits, in a single cmux tree
+  scratch_cuda_wop_pbs_many_lut_64(
+      stream, gpu_idx, &wop_pbs_buffer, delta_logs.data(), &cbs_delta_log,
+      glwe_dim, lwe_small_dim, polynomial_size, cbs_level_count,
+      bsk_level_count, number_of_bits_per_block.data(), crt_decomp_size,
+      out_size_0, max_shared_memory, true);
+  cuda_wop_pbs_many_lut_64(
+      stream, gpu_idx, out_gpu, in_gpu, lut_gpu, bsk_gpu, ksk_gpu, pksk_gpu,
+      wop_pbs_buffer, cbs_delta_log, glwe_dim, lwe_small_dim, polynomial_size,
+      bsk_base_log, bsk_level_count, ksk_base_log, ksk_level_count,
+      fpksk_base_log, fpksk_level_count, cbs_base_log, cbs_level_count,
+      number_of_bits_per_block.data(), delta_logs.data(), crt_decomp_size,
+      out_size_0, max_shared_memory);
+  cleanup_cuda_wop_pbs(stream, gpu_idx, &wop_pbs_buffer);
+
+  memcpy_async_to_cpu(transfers, out_aligned, out_offset, out_batch_size,
+                      out_gpu, gpu_idx, stream);
+  cuda_drop_async(in_gpu, (cudaStream_t *)stream, gpu_idx);
+  cuda_drop_async(lut_gpu, (cudaStream_t *)stream, gpu_idx);
+  cuda_drop_async(out_gpu, (cudaStream_t *)stream, gpu_idx);
+  cudaStreamSynchronize(*(cudaStream_t *)stream);
+  transfers.finish();
   cuda_destroy_stream((cudaStream_t *)stream, gpu_idx);
 }
 
@@ -418,6 +1160,61 @@ void memref_encode_expand_lut_for_bootstrap(
   return;
 }
 
+void memref_encode_expand_many_lut_for_bootstrap(
+    uint64_t *output_lut_allocated, uint64_t *output_lut_aligned,
+    uint64_t output_lut_offset, uint64_t output_lut_size,
+    uint64_t output_lut_stride, uint64_t *input_luts_allocated,
+    uint64_t *input_luts_aligned, uint64_t input_luts_offset,
+    uint64_t input_luts_size0, uint64_t input_luts_size1,
+    uint64_t input_luts_stride0, uint64_t input_luts_stride1,
+    uint32_t poly_size, uint32_t out_MESSAGE_BITS, bool is_signed) {
+
+  assert(input_luts_stride1 == 1 && "Runtime: stride not equal to 1, check "
+                                    "memref_encode_expand_many_lut_bootstrap");
+
+  assert(output_lut_stride == 1 && "Runtime: stride not equal to 1, check "
+                                   "memref_encode_expand_many_lut_bootstrap");
+
+  size_t lut_count = input_luts_size0;
+  size_t lut_size = input_luts_size1;
+  size_t mega_case_size = output_lut_size / lut_size;
+
+  assert((mega_case_size % (2 * lut_count)) == 0);
+
+  // Same half rotation as for a single lut, see
+  // memref_encode_expand_lut_for_bootstrap
+  std::function<size_t(size_t)> indexMap;
+  if (is_signed) {
+    size_t halfInputSize = lut_size / 2;
+    indexMap = [=](size_t idx) {
+      if (idx < halfInputSize) {
+        return idx + halfInputSize;
+      } else {
+        return idx - halfInputSize;
+      }
+    };
+  } else {
+    indexMap = [=](size_t idx) { return idx; };
+  }
+
+  auto lutValue = [&](size_t lut, size_t idx) -> uint64_t {
+    return input_luts_aligned[input_luts_offset + lut * input_luts_stride0 +
+                              indexMap(idx)]
+           << (64 - out_MESSAGE_BITS - 1);
+  };
+
+  // The mega cases are laid out as for a single lut, the last half mega
+  // case holding the negated first values.
+  for (size_t idx = 0; idx < output_lut_size; ++idx) {
+    size_t lut = idx % lut_count;
+    size_t message = (idx + mega_case_size / 2) / mega_case_size;
+    output_lut_aligned[output_lut_offset + idx] =
+        message == lut_size ? -lutValue(lut, 0) : lutValue(lut, message);
+  }
+
+  return;
+}
+
 void memref_encode_lut_for_crt_woppbs(
     // Output encoded/expanded lut
     uint64_t *output_lut_allocated, uint64_t *output_lut_aligned,
@@ -552,6 +1349,7 @@ void memref_add_lwe_ciphertexts_u64(
     uint64_t *ct0_aligned, uint64_t ct0_offset, uint64_t ct0_size,
     uint64_t ct0_stride, uint64_t *ct1_allocated, uint64_t *ct1_aligned,
     uint64_t ct1_offset, uint64_t ct1_size, uint64_t ct1_stride) {
+  profiler::Scope scope(profiler::Primitive::LEVELED);
   assert(out_size == ct0_size && out_size == ct1_size &&
          "size of lwe buffer are incompatible");
   size_t lwe_dimension = out_size - 1;
@@ -565,6 +1363,7 @@ void memref_add_plaintext_lwe_ciphertext_u64(
     uint64_t out_size, uint64_t out_stride, uint64_t *ct0_allocated,
     uint64_t *ct0_aligned, uint64_t ct0_offset, uint64_t ct0_size,
     uint64_t ct0_stride, uint64_t plaintext) {
+  profiler::Scope scope(profiler::Primitive::LEVELED);
   assert(out_size == ct0_size && "size of lwe buffer are incompatible");
   size_t lwe_dimension = out_size - 1;
   concrete_cpu_add_plaintext_lwe_ciphertext_u64(out_aligned + out_offset,
@@ -577,6 +1376,7 @@ void memref_mul_cleartext_lwe_ciphertext_u64(
     uint64_t out_size, uint64_t out_stride, uint64_t *ct0_allocated,
     uint64_t *ct0_aligned, uint64_t ct0_offset, uint64_t ct0_size,
     uint64_t ct0_stride, uint64_t cleartext) {
+  profiler::Scope scope(profiler::Primitive::LEVELED);
   assert(out_size == ct0_size && "size of lwe buffer are incompatible");
   size_t lwe_dimension = out_size - 1;
   concrete_cpu_mul_cleartext_lwe_ciphertext_u64(out_aligned + out_offset,
@@ -589,12 +1389,35 @@ void memref_negate_lwe_ciphertext_u64(
     uint64_t out_size, uint64_t out_stride, uint64_t *ct0_allocated,
     uint64_t *ct0_aligned, uint64_t ct0_offset, uint64_t ct0_size,
     uint64_t ct0_stride) {
+  profiler::Scope scope(profiler::Primitive::LEVELED);
   assert(out_size == ct0_size && "size of lwe buffer are incompatible");
   size_t lwe_dimension = {out_size - 1};
   concrete_cpu_negate_lwe_ciphertext_u64(
       out_aligned + out_offset, ct0_aligned + ct0_offset, lwe_dimension);
 }
 
+// Keyswitches `count` contiguous ciphertexts with a fast keyswitch key, whose
+// output key is a glwe key of polynomials of `output_poly_size`.
+static void
+fast_keyswitch_lwe_u64(uint64_t *out, const uint64_t *in, uint64_t count,
+                       uint32_t level, uint32_t base_log,
+                       uint32_t input_lwe_dim, uint32_t output_lwe_dim,
+                       uint32_t ksk_index,
+                       mlir::concretelang::RuntimeContext *context) {
+  uint32_t output_poly_size =
+      context->keyswitch_key_output_polynomial_size(ksk_index);
+  auto keyswitch_key = context->fourier_fast_keyswitch_key_buffer(ksk_index);
+  auto fft = context->fast_keyswitch_fft(ksk_index);
+  int num_threads = batch_num_threads(count);
+#pragma omp parallel for num_threads(num_threads)
+  for (uint64_t i = 0; i < count; i++) {
+    concrete_cpu_fast_keyswitch_lwe_ciphertext_u64(
+        out + i * (output_lwe_dim + 1), in + i * (input_lwe_dim + 1),
+        keyswitch_key, level, base_log, input_lwe_dim,
+        output_lwe_dim / output_poly_size, output_poly_size, fft);
+  }
+}
+
 void memref_keyswitch_lwe_u64(uint64_t *out_allocated, uint64_t *out_aligned,
                               uint64_t out_offset, uint64_t out_size,
                               uint64_t out_stride, uint64_t *ct0_allocated,
@@ -605,9 +1428,20 @@ void memref_keyswitch_lwe_u64(uint64_t *out_allocated, uint64_t *out_aligned,
                               uint32_t input_dimension,
                               uint32_t output_dimension, uint32_t ksk_index,
                               mlir::concretelang::RuntimeContext *context) {
+  profiler::Scope scope(profiler::Primitive::KEYSWITCH);
   assert(out_stride == 1 && ct0_stride == 1);
+  if (context->keyswitch_key_output_polynomial_size(ksk_index) > 0) {
+    fast_keyswitch_lwe_u64(out_aligned + out_offset, ct0_aligned + ct0_offset,
+                           1, decomposition_level_count,
+                           decomposition_base_log, input_dimension,
+                           output_dimension, ksk_index, context);
+    return;
+  }
   // Get keyswitch key
   const uint64_t *keyswitch_key = context->keyswitch_key_buffer(ksk_index);
+  scope.cost({input_dimension, output_dimension, decomposition_level_count,
+              decomposition_base_log, 0},
+             1);
   // Get stack parameter
   concrete_cpu_keyswitch_lwe_ciphertext_u64(
       out_aligned + out_offset, ct0_aligned + ct0_offset, keyswitch_key,
@@ -623,14 +1457,14 @@ void memref_batched_add_lwe_ciphertexts_u64(
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *ct1_allocated,
     uint64_t *ct1_aligned, uint64_t ct1_offset, uint64_t ct1_size0,
     uint64_t ct1_size1, uint64_t ct1_stride0, uint64_t ct1_stride1) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_add_lwe_ciphertexts_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1,
-        ct1_allocated + i * ct1_size1, ct1_aligned + i * ct1_size1, ct1_offset,
-        ct1_size1, ct1_stride1);
-  }
+  profiler::Scope scope(profiler::Primitive::LEVELED);
+  assert(out_size1 == ct0_size1 && out_size1 == ct1_size1 &&
+         "size of lwe buffer are incompatible");
+  assert(out_stride1 == 1 && ct0_stride1 == 1 && ct1_stride1 == 1);
+  concrete_cpu_batched_add_lwe_ciphertext_u64(
+      out_aligned + out_offset, out_stride0, ct0_aligned + ct0_offset,
+      ct0_stride0, ct1_aligned + ct1_offset, ct1_stride0, ct0_size0,
+      out_size1 - 1);
 }
 
 void memref_batched_add_plaintext_lwe_ciphertext_u64(
@@ -641,13 +1475,13 @@ void memref_batched_add_plaintext_lwe_ciphertext_u64(
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *ct1_allocated,
     uint64_t *ct1_aligned, uint64_t ct1_offset, uint64_t ct1_size,
     uint64_t ct1_stride) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_add_plaintext_lwe_ciphertext_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1,
-        *(ct1_aligned + ct1_offset + i * ct1_stride));
-  }
+  profiler::Scope scope(profiler::Primitive::LEVELED);
+  assert(out_size1 == ct0_size1 && "size of lwe buffer are incompatible");
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  concrete_cpu_batched_add_plaintext_lwe_ciphertext_u64(
+      out_aligned + out_offset, out_stride0, ct0_aligned + ct0_offset,
+      ct0_stride0, ct1_aligned + ct1_offset, ct1_stride, ct0_size0,
+      out_size1 - 1);
 }
 
 void memref_batched_add_plaintext_cst_lwe_ciphertext_u64(
@@ -656,13 +1490,12 @@ void memref_batched_add_plaintext_cst_lwe_ciphertext_u64(
     uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
     uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t plaintext) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_add_plaintext_lwe_ciphertext_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1,
-        plaintext);
-  }
+  profiler::Scope scope(profiler::Primitive::LEVELED);
+  assert(out_size1 == ct0_size1 && "size of lwe buffer are incompatible");
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  concrete_cpu_batched_add_plaintext_lwe_ciphertext_u64(
+      out_aligned + out_offset, out_stride0, ct0_aligned + ct0_offset,
+      ct0_stride0, &plaintext, 0, ct0_size0, out_size1 - 1);
 }
 
 void memref_batched_mul_cleartext_lwe_ciphertext_u64(
@@ -673,13 +1506,13 @@ void memref_batched_mul_cleartext_lwe_ciphertext_u64(
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *ct1_allocated,
     uint64_t *ct1_aligned, uint64_t ct1_offset, uint64_t ct1_size,
     uint64_t ct1_stride) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_mul_cleartext_lwe_ciphertext_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1,
-        *(ct1_aligned + ct1_offset + i * ct1_stride));
-  }
+  profiler::Scope scope(profiler::Primitive::LEVELED);
+  assert(out_size1 == ct0_size1 && "size of lwe buffer are incompatible");
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  concrete_cpu_batched_mul_cleartext_lwe_ciphertext_u64(
+      out_aligned + out_offset, out_stride0, ct0_aligned + ct0_offset,
+      ct0_stride0, ct1_aligned + ct1_offset, ct1_stride, ct0_size0,
+      out_size1 - 1);
 }
 
 void memref_batched_mul_cleartext_cst_lwe_ciphertext_u64(
@@ -688,13 +1521,12 @@ void memref_batched_mul_cleartext_cst_lwe_ciphertext_u64(
     uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
     uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t cleartext) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_mul_cleartext_lwe_ciphertext_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1,
-        cleartext);
-  }
+  profiler::Scope scope(profiler::Primitive::LEVELED);
+  assert(out_size1 == ct0_size1 && "size of lwe buffer are incompatible");
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  concrete_cpu_batched_mul_cleartext_lwe_ciphertext_u64(
+      out_aligned + out_offset, out_stride0, ct0_aligned + ct0_offset,
+      ct0_stride0, &cleartext, 0, ct0_size0, out_size1 - 1);
 }
 
 void memref_batched_negate_lwe_ciphertext_u64(
@@ -703,12 +1535,12 @@ void memref_batched_negate_lwe_ciphertext_u64(
     uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
     uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
     uint64_t ct0_stride0, uint64_t ct0_stride1) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_negate_lwe_ciphertext_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1);
-  }
+  profiler::Scope scope(profiler::Primitive::LEVELED);
+  assert(out_size1 == ct0_size1 && "size of lwe buffer are incompatible");
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  concrete_cpu_batched_negate_lwe_ciphertext_u64(
+      out_aligned + out_offset, out_stride0, ct0_aligned + ct0_offset,
+      ct0_stride0, ct0_size0, out_size1 - 1);
 }
 
 void memref_batched_keyswitch_lwe_u64(
@@ -719,12 +1551,67 @@ void memref_batched_keyswitch_lwe_u64(
     uint64_t ct0_stride0, uint64_t ct0_stride1, uint32_t level,
     uint32_t base_log, uint32_t input_lwe_dim, uint32_t output_lwe_dim,
     uint32_t ksk_index, mlir::concretelang::RuntimeContext *context) {
-  for (size_t i = 0; i < ct0_size0; i++) {
-    memref_keyswitch_lwe_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated + i * ct0_size1,
-        ct0_aligned + i * ct0_size1, ct0_offset, ct0_size1, ct0_stride1, level,
-        base_log, input_lwe_dim, output_lwe_dim, ksk_index, context);
+  profiler::Scope scope(profiler::Primitive::KEYSWITCH);
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  uint64_t *out = out_aligned + out_offset;
+  const uint64_t *in = ct0_aligned + ct0_offset;
+  if (context->keyswitch_key_output_polynomial_size(ksk_index) > 0) {
+    fast_keyswitch_lwe_u64(out, in, ct0_size0, level, base_log, input_lwe_dim,
+                           output_lwe_dim, ksk_index, context);
+    return;
+  }
+  const uint64_t *keyswitch_key = context->keyswitch_key_buffer(ksk_index);
+
+  // Each thread keyswitches one contiguous chunk of the batch, so that the
+  // kernel can reuse the blocks of the keyswitch key across the ciphertexts of
+  // the chunk.
+  int num_threads = batch_num_threads(ct0_size0);
+  scope.cost({input_lwe_dim, output_lwe_dim, level, base_log, 0}, ct0_size0,
+             num_threads);
+  uint64_t chunk_size = (ct0_size0 + num_threads - 1) / num_threads;
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (int t = 0; t < num_threads; t++) {
+    uint64_t begin = t * chunk_size;
+    uint64_t end = std::min(ct0_size0, begin + chunk_size);
+    if (begin >= end)
+      continue;
+    concrete_cpu_batched_keyswitch_lwe_ciphertext_u64(
+        out + begin * out_size1, in + begin * ct0_size1, end - begin,
+        keyswitch_key, level, base_log, input_lwe_dim, output_lwe_dim);
+  }
+}
+
+// Bootstraps `count` contiguous ciphertexts with a multi-bit bootstrap key.
+// Each concrete-cpu multi-bit bootstrap is itself threaded, so the threads
+// are shared between the ciphertexts of the batch and their bootstraps: a
+// single ciphertext still uses all of them. `tlus` holds either one lut for
+// the whole batch, or one lut per ciphertext.
+static void multi_bit_bootstrap_lwe_u64(
+    uint64_t *out, const uint64_t *in, uint64_t count, const uint64_t *tlus,
+    uint64_t tlu_count, uint32_t input_lwe_dim, uint32_t poly_size,
+    uint32_t level, uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    mlir::concretelang::RuntimeContext *context) {
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
+  uint32_t grouping_factor = context->bootstrap_key_grouping_factor(bsk_index);
+  uint64_t in_size = input_lwe_dim + 1;
+  uint64_t out_size = glwe_dim * poly_size + 1;
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1);
+  auto bootstrap_key = context->fourier_bootstrap_key_buffer(bsk_index);
+
+  int num_threads = batch_num_threads(count);
+  int bootstrap_threads =
+      std::max(1, batch_num_threads(UINT64_MAX) / num_threads);
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (uint64_t i = 0; i < count; i++) {
+    auto &arena = context->scratch_arena();
+    uint64_t *glwe_ct = arena.glwe(glwe_ct_size);
+    auto tlu = tlus + (tlu_count == 1 ? 0 : i) * poly_size;
+    memset(glwe_ct, 0, poly_size * glwe_dim * sizeof(uint64_t));
+    memcpy(glwe_ct + poly_size * glwe_dim, tlu, poly_size * sizeof(uint64_t));
+    concrete_cpu_multi_bit_bootstrap_lwe_ciphertext_u64(
+        out + i * out_size, in + i * in_size, glwe_ct, bootstrap_key, level,
+        base_log, glwe_dim, poly_size, input_lwe_dim, grouping_factor,
+        bootstrap_threads);
   }
 }
 
@@ -738,29 +1625,52 @@ void memref_bootstrap_lwe_u64(
     uint32_t decomposition_level_count, uint32_t decomposition_base_log,
     uint32_t glwe_dimension, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context) {
+  if (context->bootstrap_key_grouping_factor(bsk_index) > 1) {
+    multi_bit_bootstrap_lwe_u64(
+        out_aligned + out_offset, ct0_aligned + ct0_offset, 1,
+        tlu_aligned + tlu_offset, 1, input_lwe_dimension, polynomial_size,
+        decomposition_level_count, decomposition_base_log, glwe_dimension,
+        bsk_index, context);
+    return;
+  }
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
 
+  // The accumulator and the scratch are taken from the arena of the thread,
+  // which is reused by all the primitives it will execute.
+  auto &arena = context->scratch_arena();
   uint64_t glwe_ct_size = polynomial_size * (glwe_dimension + 1);
-  uint64_t *glwe_ct = (uint64_t *)malloc(glwe_ct_size * sizeof(uint64_t));
+  uint64_t *glwe_ct = arena.glwe(glwe_ct_size);
   auto tlu = tlu_aligned + tlu_offset;
 
   // Glwe trivial encryption
-  for (size_t i = 0; i < polynomial_size * glwe_dimension; i++) {
-    glwe_ct[i] = 0;
-  }
-  for (size_t i = 0; i < polynomial_size; i++) {
-    glwe_ct[polynomial_size * glwe_dimension + i] = tlu[i];
-  }
+  memset(glwe_ct, 0, polynomial_size * glwe_dimension * sizeof(uint64_t));
+  memcpy(glwe_ct + polynomial_size * glwe_dimension, tlu,
+         polynomial_size * sizeof(uint64_t));
 
   // Get fourrier bootstrap key
   const auto &fft = context->fft(bsk_index);
   auto bootstrap_key = context->fourier_bootstrap_key_buffer(bsk_index);
+
+  int bootstrap_threads = bootstrap_num_threads(1);
+  scope.cost(bootstrap_cost_parameters(input_lwe_dimension, glwe_dimension,
+                                       polynomial_size,
+                                       decomposition_level_count,
+                                       decomposition_base_log),
+             1, bootstrap_threads);
+  if (bootstrap_threads > 1) {
+    concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64(
+        out_aligned + out_offset, ct0_aligned + ct0_offset, glwe_ct,
+        bootstrap_key, decomposition_level_count, decomposition_base_log,
+        glwe_dimension, polynomial_size, input_lwe_dimension, fft,
+        BootstrapParams{(size_t)bootstrap_threads});
+    return;
+  }
   // Get stack parameter
   size_t scratch_size;
   size_t scratch_align;
   concrete_cpu_bootstrap_lwe_ciphertext_u64_scratch(
       &scratch_size, &scratch_align, glwe_dimension, polynomial_size, fft);
-  // Allocate scratch
-  auto scratch = (uint8_t *)aligned_alloc(scratch_align, scratch_size);
+  auto scratch = arena.scratch(scratch_size, scratch_align);
 
   // Bootstrap
   concrete_cpu_bootstrap_lwe_ciphertext_u64(
@@ -768,9 +1678,91 @@ void memref_bootstrap_lwe_u64(
       bootstrap_key, decomposition_level_count, decomposition_base_log,
       glwe_dimension, polynomial_size, input_lwe_dimension, fft, scratch,
       scratch_size);
+}
 
-  free(glwe_ct);
-  free(scratch);
+// Bootstraps `count` contiguous ciphertexts with the batched concrete-cpu
+// kernel, which applies each GGSW of the bootstrap key to a tile of
+// ciphertexts. The batch is split in one contiguous chunk per thread. `tlus`
+// holds either one lut for the whole batch, or one lut per ciphertext.
+static void batched_bootstrap_lwe_u64(
+    uint64_t *out, const uint64_t *in, uint64_t count, const uint64_t *tlus,
+    uint64_t tlu_count, uint32_t input_lwe_dim, uint32_t poly_size,
+    uint32_t level, uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    mlir::concretelang::RuntimeContext *context) {
+  if (context->bootstrap_key_grouping_factor(bsk_index) > 1) {
+    multi_bit_bootstrap_lwe_u64(out, in, count, tlus, tlu_count, input_lwe_dim,
+                                poly_size, level, base_log, glwe_dim,
+                                bsk_index, context);
+    return;
+  }
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
+  uint64_t in_size = input_lwe_dim + 1;
+  uint64_t out_size = glwe_dim * poly_size + 1;
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1);
+
+  const auto &fft = context->fft(bsk_index);
+  auto bootstrap_key = context->fourier_bootstrap_key_buffer(bsk_index);
+
+  auto cost_parameters = bootstrap_cost_parameters(input_lwe_dim, glwe_dim,
+                                                   poly_size, level, base_log);
+  int bootstrap_threads = bootstrap_num_threads(count);
+  if (bootstrap_threads > 1) {
+    // The batch is too narrow to occupy the threads, the idle ones are shared
+    // by the bootstraps of its ciphertexts.
+    int num_threads = batch_num_threads(count);
+    scope.cost(cost_parameters, count, num_threads * bootstrap_threads);
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+    for (uint64_t i = 0; i < count; i++) {
+      auto &arena = context->scratch_arena();
+      uint64_t *glwe_ct = arena.glwe(glwe_ct_size);
+      auto tlu = tlus + (tlu_count == 1 ? 0 : i) * poly_size;
+      memset(glwe_ct, 0, poly_size * glwe_dim * sizeof(uint64_t));
+      memcpy(glwe_ct + poly_size * glwe_dim, tlu, poly_size * sizeof(uint64_t));
+      concrete_cpu_bootstrap_lwe_ciphertext_with_params_u64(
+          out + i * out_size, in + i * in_size, glwe_ct, bootstrap_key, level,
+          base_log, glwe_dim, poly_size, input_lwe_dim, fft,
+          BootstrapParams{(size_t)bootstrap_threads});
+    }
+    return;
+  }
+
+  size_t scratch_size;
+  size_t scratch_align;
+  concrete_cpu_batched_bootstrap_lwe_ciphertext_u64_scratch(
+      &scratch_size, &scratch_align, glwe_dim, poly_size, fft);
+
+  int num_threads = batch_num_threads(count);
+  scope.cost(cost_parameters, count, num_threads);
+  uint64_t chunk_size = (count + num_threads - 1) / num_threads;
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+  for (int t = 0; t < num_threads; t++) {
+    uint64_t begin = t * chunk_size;
+    uint64_t end = std::min(count, begin + chunk_size);
+    if (begin >= end)
+      continue;
+    uint64_t chunk_count = end - begin;
+    uint64_t chunk_tlu_count = tlu_count == 1 ? 1 : chunk_count;
+    auto &arena = context->scratch_arena();
+
+    // Glwe trivial encryption of the luts of the chunk.
+    uint64_t *glwe_cts = arena.glwe(glwe_ct_size * chunk_tlu_count);
+    for (uint64_t l = 0; l < chunk_tlu_count; l++) {
+      auto glwe_ct = glwe_cts + l * glwe_ct_size;
+      auto tlu = tlus + (tlu_count == 1 ? 0 : begin + l) * poly_size;
+      for (size_t i = 0; i < poly_size * glwe_dim; i++) {
+        glwe_ct[i] = 0;
+      }
+      for (size_t i = 0; i < poly_size; i++) {
+        glwe_ct[poly_size * glwe_dim + i] = tlu[i];
+      }
+    }
+
+    auto scratch = arena.scratch(scratch_size, scratch_align);
+    concrete_cpu_batched_bootstrap_lwe_ciphertext_u64(
+        out + begin * out_size, in + begin * in_size, chunk_count, glwe_cts,
+        chunk_tlu_count, bootstrap_key, level, base_log, glwe_dim, poly_size,
+        input_lwe_dim, fft, scratch, scratch_size);
+  }
 }
 
 void memref_batched_bootstrap_lwe_u64(
@@ -783,15 +1775,13 @@ void memref_batched_bootstrap_lwe_u64(
     uint64_t tlu_stride, uint32_t input_lwe_dim, uint32_t poly_size,
     uint32_t level, uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context) {
-
-  for (size_t i = 0; i < out_size0; i++) {
-    memref_bootstrap_lwe_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated, ct0_aligned + i * ct0_size1,
-        ct0_offset, ct0_size1, ct0_stride1, tlu_allocated, tlu_aligned,
-        tlu_offset, tlu_size, tlu_stride, input_lwe_dim, poly_size, level,
-        base_log, glwe_dim, bsk_index, context);
-  }
+  assert(out_size1 == glwe_dim * poly_size + 1);
+  assert(ct0_size1 == input_lwe_dim + 1);
+  assert(tlu_size == poly_size && tlu_stride == 1);
+  batched_bootstrap_lwe_u64(out_aligned + out_offset, ct0_aligned + ct0_offset,
+                            out_size0, tlu_aligned + tlu_offset, 1,
+                            input_lwe_dim, poly_size, level, base_log,
+                            glwe_dim, bsk_index, context);
 }
 
 void memref_batched_mapped_bootstrap_lwe_u64(
@@ -806,17 +1796,141 @@ void memref_batched_mapped_bootstrap_lwe_u64(
     uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
     mlir::concretelang::RuntimeContext *context) {
   assert(out_size0 == tlu_size0 && "Number of LUTs does not match batch size");
-  for (size_t i = 0; i < out_size0; i++) {
-    memref_bootstrap_lwe_u64(
-        out_allocated + i * out_size1, out_aligned + i * out_size1, out_offset,
-        out_size1, out_stride1, ct0_allocated, ct0_aligned + i * ct0_size1,
-        ct0_offset, ct0_size1, ct0_stride1, tlu_allocated,
-        tlu_aligned + i * tlu_size1, tlu_offset, tlu_size1, tlu_stride1,
-        input_lwe_dim, poly_size, level, base_log, glwe_dim, bsk_index,
-        context);
+  assert(out_size1 == glwe_dim * poly_size + 1);
+  assert(ct0_size1 == input_lwe_dim + 1);
+  assert(tlu_size1 == poly_size && tlu_stride1 == 1);
+  batched_bootstrap_lwe_u64(out_aligned + out_offset, ct0_aligned + ct0_offset,
+                            out_size0, tlu_aligned + tlu_offset, tlu_size0,
+                            input_lwe_dim, poly_size, level, base_log,
+                            glwe_dim, bsk_index, context);
+}
+
+void memref_batched_keyswitch_bootstrap_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size0, uint64_t ct0_size1,
+    uint64_t ct0_stride0, uint64_t ct0_stride1, uint64_t *tlu_allocated,
+    uint64_t *tlu_aligned, uint64_t tlu_offset, uint64_t tlu_size,
+    uint64_t tlu_stride, uint32_t ks_level, uint32_t ks_base_log,
+    uint32_t ks_input_lwe_dim, uint32_t ks_output_lwe_dim, uint32_t ksk_index,
+    uint32_t input_lwe_dim, uint32_t poly_size, uint32_t level,
+    uint32_t base_log, uint32_t glwe_dim, uint32_t bsk_index,
+    uint32_t chunk_size, mlir::concretelang::RuntimeContext *context) {
+  assert(out_stride1 == 1 && ct0_stride1 == 1);
+  assert(out_size1 == glwe_dim * poly_size + 1);
+  assert(ct0_size1 == ks_input_lwe_dim + 1);
+  assert(ks_output_lwe_dim == input_lwe_dim);
+  assert(tlu_size == poly_size && tlu_stride == 1);
+  assert(chunk_size != 0);
+  uint64_t *out = out_aligned + out_offset;
+  const uint64_t *in = ct0_aligned + ct0_offset;
+  const uint64_t *tlu = tlu_aligned + tlu_offset;
+  uint64_t ks_size = input_lwe_dim + 1;
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1);
+
+  if (context->bootstrap_key_grouping_factor(bsk_index) > 1 ||
+      context->keyswitch_key_output_polynomial_size(ksk_index) > 0) {
+    // The multi-bit bootstraps are threaded, the whole batch is keyswitched
+    // before them, as it is with a fast keyswitch key.
+    std::vector<uint64_t> ks_out(ct0_size0 * ks_size);
+    memref_batched_keyswitch_lwe_u64(
+        ks_out.data(), ks_out.data(), 0, ct0_size0, ks_size, ks_size, 1,
+        ct0_allocated, ct0_aligned, ct0_offset, ct0_size0, ct0_size1,
+        ct0_stride0, ct0_stride1, ks_level, ks_base_log, ks_input_lwe_dim,
+        ks_output_lwe_dim, ksk_index, context);
+    multi_bit_bootstrap_lwe_u64(out, ks_out.data(), ct0_size0, tlu, 1,
+                                input_lwe_dim, poly_size, level, base_log,
+                                glwe_dim, bsk_index, context);
+    return;
+  }
+
+  const uint64_t *keyswitch_key = context->keyswitch_key_buffer(ksk_index);
+  const auto &fft = context->fft(bsk_index);
+  auto bootstrap_key = context->fourier_bootstrap_key_buffer(bsk_index);
+  size_t scratch_size;
+  size_t scratch_align;
+  concrete_cpu_batched_bootstrap_lwe_ciphertext_u64_scratch(
+      &scratch_size, &scratch_align, glwe_dim, poly_size, fft);
+
+  // The chunks are handed out dynamically, and each thread keyswitches a
+  // chunk right before bootstrapping it: the keyswitches of some chunks run
+  // while the others are bootstrapped, instead of all the threads waiting for
+  // the whole batch to be keyswitched.
+  uint64_t num_chunks = (ct0_size0 + chunk_size - 1) / chunk_size;
+  int num_threads = batch_num_threads(num_chunks);
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (uint64_t c = 0; c < num_chunks; c++) {
+    uint64_t begin = c * chunk_size;
+    uint64_t count = std::min<uint64_t>(chunk_size, ct0_size0 - begin);
+    auto &arena = context->scratch_arena();
+
+    // The accumulator is followed by the keyswitched ciphertexts of the chunk
+    uint64_t *glwe_ct = arena.glwe(glwe_ct_size + count * ks_size);
+    uint64_t *ks_out = glwe_ct + glwe_ct_size;
+    {
+      profiler::Scope scope(profiler::Primitive::KEYSWITCH);
+      concrete_cpu_batched_keyswitch_lwe_ciphertext_u64(
+          ks_out, in + begin * ct0_size1, count, keyswitch_key, ks_level,
+          ks_base_log, ks_input_lwe_dim, ks_output_lwe_dim);
+    }
+
+    profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
+    memset(glwe_ct, 0, poly_size * glwe_dim * sizeof(uint64_t));
+    memcpy(glwe_ct + poly_size * glwe_dim, tlu, poly_size * sizeof(uint64_t));
+    auto scratch = arena.scratch(scratch_size, scratch_align);
+    concrete_cpu_batched_bootstrap_lwe_ciphertext_u64(
+        out + begin * out_size1, ks_out, count, glwe_ct, 1, bootstrap_key,
+        level, base_log, glwe_dim, poly_size, input_lwe_dim, fft, scratch,
+        scratch_size);
   }
 }
 
+void memref_many_lut_bootstrap_lwe_u64(
+    uint64_t *out_allocated, uint64_t *out_aligned, uint64_t out_offset,
+    uint64_t out_size0, uint64_t out_size1, uint64_t out_stride0,
+    uint64_t out_stride1, uint64_t *ct0_allocated, uint64_t *ct0_aligned,
+    uint64_t ct0_offset, uint64_t ct0_size, uint64_t ct0_stride,
+    uint64_t *tlu_allocated, uint64_t *tlu_aligned, uint64_t tlu_offset,
+    uint64_t tlu_size, uint64_t tlu_stride, uint32_t input_lwe_dim,
+    uint32_t poly_size, uint32_t level, uint32_t base_log, uint32_t glwe_dim,
+    uint32_t bsk_index, mlir::concretelang::RuntimeContext *context) {
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
+  assert(out_size1 == glwe_dim * poly_size + 1);
+  assert(out_stride0 == out_size1 && out_stride1 == 1);
+  assert(ct0_size == input_lwe_dim + 1);
+  assert(tlu_size == poly_size && tlu_stride == 1);
+  assert(context->bootstrap_key_grouping_factor(bsk_index) == 1 &&
+         "The many lut bootstrap needs a classical bootstrap key");
+
+  auto &arena = context->scratch_arena();
+  uint64_t glwe_ct_size = poly_size * (glwe_dim + 1);
+  uint64_t *glwe_ct = arena.glwe(glwe_ct_size);
+  auto tlu = tlu_aligned + tlu_offset;
+
+  // Glwe trivial encryption
+  for (size_t i = 0; i < poly_size * glwe_dim; i++) {
+    glwe_ct[i] = 0;
+  }
+  for (size_t i = 0; i < poly_size; i++) {
+    glwe_ct[poly_size * glwe_dim + i] = tlu[i];
+  }
+
+  const auto &fft = context->fft(bsk_index);
+  auto bootstrap_key = context->fourier_bootstrap_key_buffer(bsk_index);
+  // The many lut bootstrap blind rotates like the batched one
+  size_t scratch_size;
+  size_t scratch_align;
+  concrete_cpu_batched_bootstrap_lwe_ciphertext_u64_scratch(
+      &scratch_size, &scratch_align, glwe_dim, poly_size, fft);
+  auto scratch = arena.scratch(scratch_size, scratch_align);
+
+  concrete_cpu_many_lut_bootstrap_lwe_ciphertext_u64(
+      out_aligned + out_offset, ct0_aligned + ct0_offset, glwe_ct, out_size0,
+      bootstrap_key, level, base_log, glwe_dim, poly_size, input_lwe_dim, fft,
+      scratch, scratch_size);
+}
+
 uint64_t encode_crt(int64_t plaintext, uint64_t modulus, uint64_t product) {
   return concretelang::crt::encode(plaintext, modulus, product);
 }
@@ -847,6 +1961,7 @@ void memref_wop_pbs_crt_buffer(
     uint32_t ksk_index, uint32_t bsk_index, uint32_t pksk_index,
     // runtime context that hold evluation keys
     mlir::concretelang::RuntimeContext *context) {
+  profiler::Scope scope(profiler::Primitive::BOOTSTRAP);
 
   // The compiler should only generates 2D memref<BxS>, where B is the number of
   // ciphertext block and S the lweSize.
@@ -854,8 +1969,8 @@ void memref_wop_pbs_crt_buffer(
 
   assert(out_stride_1 == 1);
   assert(in_stride_0 == in_size_1 && in_stride_0 == in_size_1);
-  // Check for the size B
-  assert(out_size_0 == in_size_0 && out_size_0 == crt_decomp_size);
+  // Check for the size B, several lookup tables can share the extracted bits
+  assert(in_size_0 == crt_decomp_size && out_size_0 % crt_decomp_size == 0);
   // Check for the size S
   assert(out_size_1 == in_size_1);
 
@@ -870,38 +1985,50 @@ void memref_wop_pbs_crt_buffer(
   uint64_t glwe_dim = lwe_big_dim / polynomial_size;
 
   // Compute the numbers of bits to extract for each block and the total one.
+  // The extracted bit should be in the following order:
+  //
+  // [msb(m%crt[n-1])..lsb(m%crt[n-1])...msb(m%crt[0])..lsb(m%crt[0])] where n
+  // is the size of the crt decomposition
   uint64_t total_number_of_bits_per_block = 0;
-  auto number_of_bits_per_block = new uint64_t[crt_decomp_size]();
-  for (uint64_t i = 0; i < crt_decomp_size; i++) {
+  std::vector<uint64_t> number_of_bits_per_block(crt_decomp_size);
+  std::vector<uint64_t> extract_bits_output_offsets(crt_decomp_size);
+  for (int64_t i = crt_decomp_size - 1; i >= 0; i--) {
     uint64_t modulus = crt_decomp_aligned[i + crt_decomp_offset];
     uint64_t nb_bit_to_extract =
         static_cast<uint64_t>(ceil(log2(static_cast<double>(modulus))));
     number_of_bits_per_block[i] = nb_bit_to_extract;
+    extract_bits_output_offsets[i] = total_number_of_bits_per_block;
 
     total_number_of_bits_per_block += nb_bit_to_extract;
   }
 
-  // Create the buffer of ciphertexts for storing the total number of bits to
-  // extract.
-  // The extracted bit should be in the following order:
-  //
-  // [msb(m%crt[n-1])..lsb(m%crt[n-1])...msb(m%crt[0])..lsb(m%crt[0])] where n
-  // is the size of the crt decomposition
-  auto extract_bits_output_buffer =
-      new uint64_t[lwe_small_size * total_number_of_bits_per_block]{0};
-
-  // We make a private copy to apply a subtraction on the body
-  auto first_ciphertext = in_aligned + in_offset;
+  // The buffer of the extracted bits and a private copy of the input, to
+  // apply a subtraction on the body, are taken from the arena of the calling
+  // thread, which only uses its scratch in the parallel region below.
+  auto &arena = context->scratch_arena();
+  auto extract_bits_size = lwe_small_size * total_number_of_bits_per_block;
   auto copy_size = crt_decomp_size * lwe_big_size;
-  std::vector<uint64_t> in_copy(first_ciphertext, first_ciphertext + copy_size);
-  // Extraction of each bit for each block
+  uint64_t *extract_bits_output_buffer =
+      arena.glwe(extract_bits_size + copy_size);
+  uint64_t *in_copy = extract_bits_output_buffer + extract_bits_size;
+  memset(extract_bits_output_buffer, 0, extract_bits_size * sizeof(uint64_t));
+  memcpy(in_copy, in_aligned + in_offset, copy_size * sizeof(uint64_t));
 
   const auto &fft = context->fft(bsk_index);
   auto bootstrap_key = context->fourier_bootstrap_key_buffer(bsk_index);
   auto keyswicth_key = context->keyswitch_key_buffer(ksk_index);
 
-  for (int64_t i = crt_decomp_size - 1, extract_bits_output_offset = 0; i >= 0;
-       extract_bits_output_offset += number_of_bits_per_block[i--]) {
+  size_t extract_scratch_size;
+  size_t extract_scratch_align;
+  concrete_cpu_extract_bit_lwe_ciphertext_u64_scratch(
+      &extract_scratch_size, &extract_scratch_align, lwe_small_dim, lwe_big_dim,
+      glwe_dim, polynomial_size, fft);
+
+  // The bits of a block are extracted one after the other, each extraction
+  // depending on the previous ones, but the blocks are independent.
+  int num_threads = batch_num_threads(crt_decomp_size);
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+  for (int64_t i = 0; i < (int64_t)crt_decomp_size; i++) {
     auto nb_bits_to_extract = number_of_bits_per_block[i];
 
     size_t delta_log = 64 - nb_bits_to_extract;
@@ -913,24 +2040,17 @@ void memref_wop_pbs_crt_buffer(
                    (uint64_t(1) << (uint64_t(64) - nb_bits_to_extract - 5));
     in_block[lwe_big_size - 1] -= sub;
 
-    size_t scratch_size;
-    size_t scratch_align;
-    concrete_cpu_extract_bit_lwe_ciphertext_u64_scratch(
-        &scratch_size, &scratch_align, lwe_small_dim, lwe_big_dim, glwe_dim,
-        polynomial_size, fft);
-    // Allocate scratch
-    auto *scratch = (uint8_t *)aligned_alloc(scratch_align, scratch_size);
+    auto *scratch = context->scratch_arena().scratch(extract_scratch_size,
+                                                     extract_scratch_align);
 
     concrete_cpu_extract_bit_lwe_ciphertext_u64(
         &extract_bits_output_buffer[lwe_small_size *
-                                    extract_bits_output_offset],
+                                    extract_bits_output_offsets[i]],
         in_block, bootstrap_key, keyswicth_key, lwe_small_dim,
         nb_bits_to_extract, lwe_big_dim, nb_bits_to_extract, delta_log,
         bsk_level_count, bsk_base_log, glwe_dim, polynomial_size, lwe_small_dim,
         ksk_level_count, ksk_base_log, lwe_big_dim, lwe_small_dim, fft, scratch,
-        scratch_size);
-
-    free(scratch);
+        extract_scratch_size);
   }
 
   size_t ct_in_count = total_number_of_bits_per_block;
@@ -949,7 +2069,7 @@ void memref_wop_pbs_crt_buffer(
       lut_size, lut_count, glwe_dim, polynomial_size, polynomial_size,
       cbs_level_count, fft);
 
-  auto *scratch = (uint8_t *)aligned_alloc(scratch_align, scratch_size);
+  auto *scratch = arena.scratch(scratch_size, scratch_align);
 
   auto fp_keyswicth_key = context->fp_keyswitch_key_buffer(pksk_index);
 
@@ -961,8 +2081,6 @@ void memref_wop_pbs_crt_buffer(
       lwe_small_dim, fpksk_level_count, fpksk_base_log, lwe_big_dim, glwe_dim,
       polynomial_size, glwe_dim + 1, cbs_level_count, cbs_base_log, fft,
       scratch, scratch_size);
-
-  free(scratch);
 }
 
 void memref_copy_one_rank(uint64_t *src_allocated, uint64_t *src_aligned,
@@ -970,6 +2088,7 @@ void memref_copy_one_rank(uint64_t *src_allocated, uint64_t *src_aligned,
                           uint64_t src_stride, uint64_t *dst_allocated,
                           uint64_t *dst_aligned, uint64_t dst_offset,
                           uint64_t dst_size, uint64_t dst_stride) {
+  profiler::Scope scope(profiler::Primitive::COPY);
   assert(src_size == dst_size && "memref_copy_one_rank size differs");
   if (src_stride == dst_stride) {
     memcpy(dst_aligned + dst_offset, src_aligned + src_offset,
@@ -986,6 +2105,13 @@ void memref_trace_ciphertext(uint64_t *ct0_allocated, uint64_t *ct0_aligned,
                              uint64_t ct0_offset, uint64_t ct0_size,
                              uint64_t ct0_stride, char *message_ptr,
                              uint32_t message_len, uint32_t msb) {
+  if (mlir::concretelang::tracing::buffered()) {
+    mlir::concretelang::tracing::record(
+        mlir::concretelang::tracing::Kind::CIPHERTEXT,
+        ct0_aligned[ct0_offset + ct0_size - 1], 64, msb, message_ptr,
+        message_len);
+    return;
+  }
   std::string message{message_ptr, (size_t)message_len};
   std::cout << message << " : ";
   std::bitset<64> bits{ct0_aligned[ct0_offset + ct0_size - 1]};
@@ -997,6 +2123,12 @@ void memref_trace_ciphertext(uint64_t *ct0_allocated, uint64_t *ct0_aligned,
 void memref_trace_plaintext(uint64_t input, uint64_t input_width,
                             char *message_ptr, uint32_t message_len,
                             uint32_t msb) {
+  if (mlir::concretelang::tracing::buffered()) {
+    mlir::concretelang::tracing::record(
+        mlir::concretelang::tracing::Kind::PLAINTEXT, input, input_width, msb,
+        message_ptr, message_len);
+    return;
+  }
   std::string message{message_ptr, (size_t)message_len};
   std::cout << message << " : ";
   std::bitset<64> bits{input};
@@ -1007,6 +2139,12 @@ void memref_trace_plaintext(uint64_t input, uint64_t input_width,
 }
 
 void memref_trace_message(char *message_ptr, uint32_t message_len) {
+  if (mlir::concretelang::tracing::buffered()) {
+    mlir::concretelang::tracing::record(
+        mlir::concretelang::tracing::Kind::MESSAGE, 0, 0, 0, message_ptr,
+        message_len);
+    return;
+  }
   std::string message{message_ptr, (size_t)message_len};
   std::cout << message << std::flush;
 }
@@ -3,10 +3,21 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
 #include <llvm/ADT/SmallSet.h>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
 #include <vector>
 
 #include "boost/outcome.h"
@@ -16,6 +27,10 @@
 #include "concretelang/Common/Protocol.h"
 #include "concretelang/Common/Transformers.h"
 #include "concretelang/Common/Values.h"
+#include "concretelang/Runtime/DFRuntime.hpp"
+#include "concretelang/Runtime/DeviceValues.h"
+#include "concretelang/Runtime/MemoryUsage.h"
+#include "concretelang/Runtime/Profiler.h"
 #include "concretelang/Runtime/context.h"
 #include "concretelang/ServerLib/ServerLib.h"
 #include "concretelang/Support/CompilerEngine.h"
@@ -25,9 +40,19 @@ using concretelang::keysets::ServerKeyset;
 using concretelang::transformers::ArgTransformer;
 using concretelang::transformers::ReturnTransformer;
 using concretelang::transformers::TransformerFactory;
+using concretelang::values::Arena;
 using concretelang::values::Value;
 using mlir::concretelang::CompilerEngine;
+using mlir::concretelang::DeviceBuffers;
+using mlir::concretelang::DeviceSettings;
+using mlir::concretelang::DeviceSettingsScope;
+using mlir::concretelang::DeviceValueScope;
+using mlir::concretelang::PreparedKeyset;
 using mlir::concretelang::RuntimeContext;
+using mlir::concretelang::RuntimeContextCache;
+namespace dfr = mlir::concretelang::dfr;
+namespace memory = mlir::concretelang::memory;
+namespace profiler = mlir::concretelang::profiler;
 
 namespace concretelang {
 namespace serverlib {
@@ -94,7 +119,7 @@ struct MemRefDescriptor {
   /// Creates a memref descriptor referencing the data contained in a tensor.
   template <typename T> static MemRefDescriptor fromTensor(Tensor<T> &input) {
     std::vector<size_t> strides;
-    size_t stride = input.values.size();
+    size_t stride = input.size();
     for (size_t dim : input.dimensions) {
       stride = (dim == 0 ? 0 : (stride / dim));
       strides.push_back(stride);
@@ -102,7 +127,7 @@ struct MemRefDescriptor {
     return MemRefDescriptor{sizeof(T) * 8,
                             std::is_signed<T>(),
                             (void *)nullptr,
-                            (void *)input.values.data(),
+                            (void *)input.data(),
                             0,
                             input.dimensions,
                             strides};
@@ -129,6 +154,11 @@ struct MemRefDescriptor {
     };
   }
 
+  /// Returns the address of the first element of the memref.
+  const void *data() const {
+    return (const char *)aligned + offset * (precision / 8);
+  }
+
   /// Returns the number of elements of the memref.
   size_t getLength() {
     size_t output = 1;
@@ -147,16 +177,15 @@ struct MemRefDescriptor {
     // We create the indexer.
     auto indexer = MultiDimIndexer(offset, sizes, strides);
 
-    // We fill a vector of vales to construct the
-    std::vector<T> values(getLength());
-    for (size_t i = 0; i < values.size(); i++) {
+    // We copy the values out of the memref, which is freed after the call.
+    return Tensor<T>::build(sizes, [&](T *values, size_t size) {
       T *memrefAligned = reinterpret_cast<T *>(aligned);
-      auto index = indexer.currentIndex();
-      values[i] = memrefAligned[index];
-      indexer.increment();
-    }
-
-    return Tensor<T>{values, sizes};
+      for (size_t i = 0; i < size; i++) {
+        auto index = indexer.currentIndex();
+        values[i] = memrefAligned[index];
+        indexer.increment();
+      }
+    });
   }
 
   void intoOpaquePtrs(llvm::MutableArrayRef<void *> &opaquePtrs) {
@@ -178,7 +207,7 @@ struct ScalarDescriptor {
   uint64_t val;
 
   template <typename T> static ScalarDescriptor fromTensor(Tensor<T> &input) {
-    T value = input.values[0];
+    T value = input.data()[0];
     size_t width = sizeof(T) * 8;
     if (width == 64) {
       return ScalarDescriptor{sizeof(T) * 8, std::is_signed<T>(),
@@ -281,6 +310,15 @@ struct InvocationDescriptor {
     }
   }
 
+  /// Returns the address of the data of a memref descriptor, or nullptr for a
+  /// scalar.
+  const void *data() const {
+    if (std::holds_alternative<MemRefDescriptor>(inner)) {
+      return std::get<MemRefDescriptor>(inner).data();
+    }
+    return nullptr;
+  }
+
   // Structure used to free memory allocated by the circuit after invocation.
   struct Liberator {
 
@@ -358,6 +396,64 @@ DynamicModule::open(const std::string &sharedLibPath) {
   return module;
 }
 
+std::shared_ptr<DynamicModule>
+DynamicModule::fromStaticCircuits(const StaticCircuit *circuits,
+                                  size_t count) {
+  std::shared_ptr<DynamicModule> module = std::make_shared<DynamicModule>();
+  for (size_t i = 0; i < count; i++) {
+    module->staticCircuits[circuits[i].name] = circuits[i].function;
+  }
+  return module;
+}
+
+Result<CircuitFunction>
+DynamicModule::lookup(const std::string &name) const {
+  if (libraryHandle == nullptr) {
+    auto circuit = staticCircuits.find(name);
+    if (circuit == staticCircuits.end()) {
+      return StringError("Circuit not found in the static circuits: ") << name;
+    }
+    return circuit->second;
+  }
+  dlerror();
+  auto function = (CircuitFunction)dlsym(
+      libraryHandle, (std::string("_mlir_concrete_") + name).c_str());
+  if (auto err = dlerror()) {
+    return StringError("Circuit symbol not found in dynamic module: ")
+           << std::string(err);
+  }
+  return function;
+}
+
+namespace {
+struct StaticProgram {
+  const char *programInfoJson;
+  const StaticCircuit *circuits;
+  size_t count;
+};
+
+/// The programs registered by the static initializers, never destroyed as
+/// they may run after the static destructors.
+std::vector<StaticProgram> &staticPrograms() {
+  static auto *programs = new std::vector<StaticProgram>();
+  return *programs;
+}
+
+Result<StaticProgram> getStaticProgram() {
+  auto &programs = staticPrograms();
+  if (programs.size() != 1) {
+    return StringError("Expected one static program linked in, found ")
+           << programs.size();
+  }
+  return programs[0];
+}
+} // namespace
+
+StaticProgramRegistration::StaticProgramRegistration(
+    const char *programInfoJson, const StaticCircuit *circuits, size_t count) {
+  staticPrograms().push_back({programInfoJson, circuits, count});
+}
+
 size_t
 getGateDescriptionSize(const Message<concreteprotocol::GateInfo> &gateInfo,
                        bool useSimulation) {
@@ -427,37 +523,348 @@ bool getGateIsSigned(const Message<concreteprotocol::GateInfo> &gateInfo) {
   assert(false);
 }
 
+namespace {
+/// Returns the bytes of the tensors of `values`.
+size_t valuesSize(const std::vector<Value> &values) {
+  size_t size = 0;
+  for (auto &value : values) {
+    size_t elementSize = 8;
+    if (value.hasElementType<uint8_t>() || value.hasElementType<int8_t>())
+      elementSize = 1;
+    else if (value.hasElementType<uint16_t>() ||
+             value.hasElementType<int16_t>())
+      elementSize = 2;
+    else if (value.hasElementType<uint32_t>() ||
+             value.hasElementType<int32_t>())
+      elementSize = 4;
+    size += value.getLength() * elementSize;
+  }
+  return size;
+}
+
+/// Fails if the arguments of a call do not fit in the memory limit, so that
+/// the call is refused rather than aborted by one of its allocations.
+/// Whether the temporaries of the calls are allocated in the arenas of the
+/// calling threads, as enabled by `SERVER_CALL_ARENA`.
+bool useCallArena() {
+  static bool enabled = []() {
+    char *env = getenv("SERVER_CALL_ARENA");
+    return env != nullptr && strcmp(env, "0") != 0;
+  }();
+  return enabled;
+}
+
+Result<void> checkMemoryLimit(const std::vector<Value> &argsBuffer) {
+  size_t size = valuesSize(argsBuffer);
+  if (!memory::fits(size)) {
+    return StringError("Calling the circuit on ")
+           << size << " bytes of arguments exceeds the memory limit of "
+           << memory::limit() << " bytes";
+  }
+  return outcome::success();
+}
+} // namespace
+
 Result<std::vector<TransportValue>>
 ServerCircuit::call(const ServerKeyset &serverKeyset,
-                    std::vector<TransportValue> &args) {
-  if (args.size() != argsBuffer.size()) {
+                    const std::vector<TransportValue> &args) const {
+  if (args.size() != argTransformers.size()) {
     return StringError("Called circuit with wrong number of arguments");
   }
+  OUTCOME_TRYV(checkKeys(serverKeyset));
+
+  // The buffers are local to the call, which makes it possible for multiple
+  // threads to call the same circuit concurrently. Their data, when in the
+  // arena of the thread, is freed all at once when the call ends.
+  std::optional<Arena::Scope> arena;
+  if (useCallArena()) {
+    arena.emplace();
+  }
+  std::vector<Value> argsBuffer(argTransformers.size());
+  std::vector<Value> returnsBuffer(returnTransformers.size());
 
   // We load the processed arguments in the args buffer.
   for (size_t i = 0; i < argsBuffer.size(); i++) {
+    profiler::Scope scope(profiler::Primitive::TRANSFORMER);
     OUTCOME_TRY(argsBuffer[i], argTransformers[i](args[i]));
   }
+  OUTCOME_TRYV(checkMemoryLimit(argsBuffer));
+  memory::Allocation argsUsage(memory::Category::CIPHERTEXTS,
+                               valuesSize(argsBuffer));
 
   // The arguments has been pushed in the arg buffer, we are now ready to
   // invoke the circuit function.
-  invoke(serverKeyset);
+  invoke(serverKeyset, argsBuffer, returnsBuffer);
+  memory::Allocation returnsUsage(memory::Category::CIPHERTEXTS,
+                                  valuesSize(returnsBuffer));
 
   // We process the return values to turn them into transport values.
   std::vector<TransportValue> returns(returnsBuffer.size());
   for (size_t i = 0; i < returnsBuffer.size(); i++) {
-    OUTCOME_TRY(returns[i], returnTransformers[i](returnsBuffer[i]));
+    profiler::Scope scope(profiler::Primitive::TRANSFORMER);
+    OUTCOME_TRY(returns[i],
+                returnTransformers[i](std::move(returnsBuffer[i])));
+  }
+
+  return returns;
+}
+
+Result<std::vector<std::vector<TransportValue>>>
+ServerCircuit::callBatch(const ServerKeyset &serverKeyset,
+                         const std::vector<std::vector<TransportValue>> &batch,
+                         size_t maxThreads) const {
+  for (auto &args : batch) {
+    if (args.size() != argTransformers.size()) {
+      return StringError("Called circuit with wrong number of arguments");
+    }
+  }
+
+  // We prepare the runtime context once for the whole batch, so that the
+  // workers don't contend on the cache.
+  std::shared_ptr<RuntimeContext> runtimeContext =
+      RuntimeContextCache::global().get(serverKeyset);
+
+  size_t numThreads = maxThreads;
+  if (numThreads == 0) {
+    numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  numThreads = std::min(numThreads, batch.size());
+
+  // Each worker picks the next pending request until the batch is exhausted.
+  std::vector<std::optional<Result<std::vector<TransportValue>>>> results(
+      batch.size());
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < batch.size(); i = next++) {
+      results[i] = call(serverKeyset, batch[i]);
+    }
+  };
+  if (numThreads <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < numThreads; t++) {
+      workers.emplace_back(worker);
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  std::vector<std::vector<TransportValue>> returns;
+  returns.reserve(batch.size());
+  for (auto &result : results) {
+    OUTCOME_TRY(auto output, std::move(*result));
+    returns.push_back(std::move(output));
+  }
+  return returns;
+}
+
+namespace {
+/// The pool of threads running the asynchronous calls of the process. The
+/// threads are started on the first call.
+class CallExecutor {
+public:
+  static CallExecutor &global() {
+    static CallExecutor executor;
+    return executor;
+  }
+
+  void post(std::function<void()> task) {
+    {
+      const std::lock_guard<std::mutex> lock(guard);
+      if (workers.empty()) {
+        start();
+      }
+      tasks.push_back(std::move(task));
+    }
+    pending.notify_one();
+  }
+
+  ~CallExecutor() {
+    {
+      const std::lock_guard<std::mutex> lock(guard);
+      stopped = true;
+    }
+    pending.notify_all();
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+private:
+  void start() {
+    size_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    char *env = getenv("SERVER_CALL_NUM_THREADS");
+    if (env != nullptr && strtoul(env, NULL, 10) != 0) {
+      numThreads = strtoul(env, NULL, 10);
+    }
+    for (size_t t = 0; t < numThreads; t++) {
+      workers.emplace_back([this]() { work(); });
+    }
+  }
+
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(guard);
+        pending.wait(lock, [&]() { return stopped || !tasks.empty(); });
+        // Pending calls are still run at exit, their callers wait on them.
+        if (tasks.empty()) {
+          return;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
   }
 
+  std::mutex guard;
+  std::condition_variable pending;
+  std::deque<std::function<void()>> tasks;
+  std::vector<std::thread> workers;
+  bool stopped = false;
+};
+} // namespace
+
+void ServerCircuit::callAsync(const ServerKeyset &serverKeyset,
+                              std::vector<TransportValue> args,
+                              CallCallback callback) const {
+  CallExecutor::global().post(
+      [circuit = *this, serverKeyset, args = std::move(args),
+       callback = std::move(callback)]() mutable {
+        callback(circuit.call(serverKeyset, args));
+      });
+}
+
+std::future<Result<std::vector<TransportValue>>>
+ServerCircuit::callAsync(const ServerKeyset &serverKeyset,
+                         std::vector<TransportValue> args) const {
+  auto promise =
+      std::make_shared<std::promise<Result<std::vector<TransportValue>>>>();
+  auto future = promise->get_future();
+  callAsync(serverKeyset, std::move(args),
+            [promise](Result<std::vector<TransportValue>> result) {
+              promise->set_value(std::move(result));
+            });
+  return future;
+}
+
+Result<std::vector<DeviceValue>>
+ServerCircuit::callOnDevice(const ServerKeyset &serverKeyset,
+                            const std::vector<DeviceValue> &args) const {
+  if (args.size() != argTransformers.size()) {
+    return StringError("Called circuit with wrong number of arguments");
+  }
+  OUTCOME_TRYV(checkKeys(serverKeyset));
+
+  std::optional<Arena::Scope> arena;
+  if (useCallArena()) {
+    arena.emplace();
+  }
+  std::vector<Value> argsBuffer(argTransformers.size());
+  std::vector<Value> returnsBuffer(returnTransformers.size());
+  DeviceBuffers argsDevice(args.size());
+  DeviceBuffers returnsDevice(returnTransformers.size());
+  for (size_t i = 0; i < argsBuffer.size(); i++) {
+    profiler::Scope scope(profiler::Primitive::TRANSFORMER);
+    OUTCOME_TRY(argsBuffer[i], argTransformers[i](args[i].value));
+    argsDevice[i] = args[i].device;
+  }
+  OUTCOME_TRYV(checkMemoryLimit(argsBuffer));
+  memory::Allocation argsUsage(memory::Category::CIPHERTEXTS,
+                               valuesSize(argsBuffer));
+
+  invoke(serverKeyset, argsBuffer, returnsBuffer, &argsDevice, &returnsDevice);
+  memory::Allocation returnsUsage(memory::Category::CIPHERTEXTS,
+                                  valuesSize(returnsBuffer));
+
+  std::vector<DeviceValue> returns(returnsBuffer.size());
+  for (size_t i = 0; i < returnsBuffer.size(); i++) {
+    profiler::Scope scope(profiler::Primitive::TRANSFORMER);
+    OUTCOME_TRY(returns[i].value,
+                returnTransformers[i](std::move(returnsBuffer[i])));
+    returns[i].device = returnsDevice[i];
+  }
   return returns;
 }
 
 Result<std::vector<TransportValue>>
-ServerCircuit::simulate(std::vector<TransportValue> &args) {
+ServerCircuit::simulate(const std::vector<TransportValue> &args) const {
   ServerKeyset emptyKeyset;
   return call(emptyKeyset, args);
 }
 
+Result<void> ServerCircuit::checkKeys(const ServerKeyset &serverKeyset) const {
+  // Older programs do not record the keys of their circuits.
+  if (useSimulation || !circuitInfo.asReader().hasKeys()) {
+    return outcome::success();
+  }
+  return serverKeyset.checkKeys(circuitInfo.asReader().getKeys());
+}
+
+void ServerCircuit::evictKeyset(const ServerKeyset &serverKeyset) {
+  RuntimeContextCache::global().evict(serverKeyset);
+}
+
+Result<void>
+ServerCircuit::prepareKeyset(const ServerKeyset &serverKeyset,
+                             const std::string &preparedKeysetPath) {
+  OUTCOME_TRY(auto preparedKeyset, PreparedKeyset::openOrWrite(
+                                       preparedKeysetPath, serverKeyset));
+  RuntimeContextCache::global().preload(serverKeyset, preparedKeyset);
+  return outcome::success();
+}
+
+void ServerCircuit::recordRuntimeStatistics(bool enabled, bool trace) {
+  profiler::set_enabled(enabled, trace);
+}
+
+std::map<std::string, profiler::Statistics>
+ServerCircuit::runtimeStatistics() {
+  std::map<std::string, profiler::Statistics> statistics;
+  auto all = profiler::statistics();
+  for (size_t i = 0; i < profiler::num_primitives; i++) {
+    if (all[i].calls > 0)
+      statistics[profiler::primitive_name((profiler::Primitive)i)] = all[i];
+  }
+  return statistics;
+}
+
+void ServerCircuit::resetRuntimeStatistics() { profiler::reset(); }
+
+std::string ServerCircuit::takeRuntimeTrace() {
+  return profiler::chrome_trace(profiler::take_events());
+}
+
+std::string ServerCircuit::runtimeCostTable() {
+  return profiler::cost_table();
+}
+
+std::map<std::string, memory::Usage> ServerCircuit::memoryUsage() {
+  std::map<std::string, memory::Usage> usage;
+  auto all = memory::usage();
+  for (size_t i = 0; i < memory::num_categories; i++)
+    usage[memory::category_name((memory::Category)i)] = all[i];
+  return usage;
+}
+
+void ServerCircuit::resetMemoryPeaks() { memory::reset_peaks(); }
+
+void ServerCircuit::setMemoryLimit(uint64_t bytes) { memory::set_limit(bytes); }
+
+dfr::DFRStatistics ServerCircuit::dataflowStatistics() {
+  return dfr::_dfr_get_statistics();
+}
+
+void ServerCircuit::resetDataflowStatistics() { dfr::_dfr_reset_statistics(); }
+
+std::string ServerCircuit::dataflowMetrics() {
+  return dfr::_dfr_statistics_prometheus();
+}
+
 std::string ServerCircuit::getName() {
   return circuitInfo.asReader().getName();
 }
@@ -470,15 +877,8 @@ Result<ServerCircuit> ServerCircuit::fromDynamicModule(
   output.circuitInfo = circuitInfo;
   output.useSimulation = useSimulation;
   output.dynamicModule = dynamicModule;
-  output.func = (void (*)(void *, ...))dlsym(
-      dynamicModule->libraryHandle,
-      (std::string("_mlir_concrete_") +
-       std::string(circuitInfo.asReader().getName().cStr()))
-          .c_str());
-  if (auto err = dlerror()) {
-    return StringError("Circuit symbol not found in dynamic module: ")
-           << std::string(err);
-  }
+  OUTCOME_TRY(output.func, dynamicModule->lookup(
+                               circuitInfo.asReader().getName().cStr()));
 
   // We prepare the args transformers used to transform transport values into
   // arg values.
@@ -520,11 +920,6 @@ Result<ServerCircuit> ServerCircuit::fromDynamicModule(
     output.returnTransformers.push_back(transformer);
   }
 
-  output.argsBuffer =
-      std::vector<Value>(circuitInfo.asReader().getInputs().size());
-  output.returnsBuffer =
-      std::vector<Value>(circuitInfo.asReader().getOutputs().size());
-
   output.argRawSize = 0;
   for (auto gateInfo : circuitInfo.asReader().getInputs()) {
     auto descriptorSize = getGateDescriptionSize(gateInfo, useSimulation);
@@ -542,12 +937,18 @@ Result<ServerCircuit> ServerCircuit::fromDynamicModule(
   return output;
 }
 
-void ServerCircuit::invoke(const ServerKeyset &serverKeyset) {
+void ServerCircuit::invoke(const ServerKeyset &serverKeyset,
+                           std::vector<Value> &argsBuffer,
+                           std::vector<Value> &returnsBuffer,
+                           const DeviceBuffers *argsDevice,
+                           DeviceBuffers *returnsDevice) const {
 
-  // We create a runtime context from the keyset, and place a pointer to it in
-  // the structure.
-  RuntimeContext runtimeContext = RuntimeContext(serverKeyset);
-  RuntimeContext *_runtimeContextPtr = &runtimeContext;
+  // We fetch the runtime context of the keyset from the cache, and place a
+  // pointer to it in the structure. The shared pointer keeps the context alive
+  // for the whole invocation even if it gets evicted concurrently.
+  std::shared_ptr<RuntimeContext> runtimeContext =
+      RuntimeContextCache::global().get(serverKeyset);
+  RuntimeContext *_runtimeContextPtr = runtimeContext.get();
 
   auto _argRaws = std::vector<void *>(this->argRawSize);
   auto _argRawMaps = std::vector<llvm::MutableArrayRef<void *>>();
@@ -569,6 +970,16 @@ void ServerCircuit::invoke(const ServerKeyset &serverKeyset) {
     currentRawIndex += descriptorSize;
   }
 
+  // The device values of the invocation are scoped to the calling thread.
+  std::optional<DeviceValueScope> deviceScope;
+  if (returnsDevice != nullptr) {
+    deviceScope.emplace();
+  }
+  std::optional<DeviceSettingsScope> settingsScope;
+  if (!deviceSettings.isDefault()) {
+    settingsScope.emplace(deviceSettings);
+  }
+
   auto _invocationRaws = std::vector<void *>();
   for (auto &arg : _argRaws) {
     _invocationRaws.push_back(&arg);
@@ -583,6 +994,11 @@ void ServerCircuit::invoke(const ServerKeyset &serverKeyset) {
         InvocationDescriptor::fromValue(argsBuffer[i]);
     // We write the descriptor in the _argRaws via the maps.
     descriptor.intoOpaquePtrs(_argRawMaps[i]);
+    // We bind the device copy of the argument to its data.
+    if (deviceScope && argsDevice != nullptr && (*argsDevice)[i] != nullptr &&
+        descriptor.data() != nullptr) {
+      deviceScope->bind(descriptor.data(), (*argsDevice)[i]);
+    }
   }
 
   func(_invocationRaws.data());
@@ -605,6 +1021,13 @@ void ServerCircuit::invoke(const ServerKeyset &serverKeyset) {
     // We generate a value from the descriptor which we store in the
     // returnsBuffer.
     returnsBuffer[i] = descriptor.intoValue();
+    // We keep the device copy of the result, if the runtime made one.
+    if (deviceScope && descriptor.data() != nullptr) {
+      (*returnsDevice)[i] = deviceScope->lookup(
+          descriptor.data(),
+          returnsBuffer[i].getLength() *
+              returnsBuffer[i].getIntegerPrecision() / 8);
+    }
     // // We push the descriptor into the output set for later freeing.
     liberator.insert(descriptor);
   }
@@ -630,6 +1053,29 @@ ServerProgram::load(const Message<concreteprotocol::ProgramInfo> &programInfo,
   return output;
 }
 
+Result<Message<concreteprotocol::ProgramInfo>>
+ServerProgram::staticProgramInfo() {
+  OUTCOME_TRY(auto program, getStaticProgram());
+  Message<concreteprotocol::ProgramInfo> programInfo;
+  OUTCOME_TRYV(programInfo.readJsonFromString(program.programInfoJson));
+  return programInfo;
+}
+
+Result<ServerProgram> ServerProgram::loadStatic(bool useSimulation) {
+  OUTCOME_TRY(auto program, getStaticProgram());
+  OUTCOME_TRY(auto programInfo, staticProgramInfo());
+  auto module =
+      DynamicModule::fromStaticCircuits(program.circuits, program.count);
+  ServerProgram output;
+  for (auto circuitInfo : programInfo.asReader().getCircuits()) {
+    OUTCOME_TRY(auto serverCircuit,
+                ServerCircuit::fromDynamicModule(circuitInfo, module,
+                                                 useSimulation));
+    output.serverCircuits.push_back(serverCircuit);
+  }
+  return output;
+}
+
 Result<ServerCircuit>
 ServerProgram::getServerCircuit(const std::string &circuitName) {
   for (auto serverCircuit : serverCircuits) {
@@ -641,5 +1087,245 @@ ServerProgram::getServerCircuit(const std::string &circuitName) {
                      "`");
 }
 
+void ServerProgram::setDeviceSettings(const DeviceSettings &settings) {
+  for (auto &circuit : serverCircuits) {
+    circuit.deviceSettings = settings;
+  }
+}
+
+Result<void> ServerProgram::warmUpKeyset(const ServerKeyset &serverKeyset) {
+  std::set<uint32_t> bootstrapKeys;
+  std::set<uint32_t> keyswitchKeys;
+  for (auto &circuit : serverCircuits) {
+    if (circuit.useSimulation) {
+      return outcome::success();
+    }
+    OUTCOME_TRYV(circuit.checkKeys(serverKeyset));
+    auto circuitInfo = circuit.circuitInfo.asReader();
+    if (!circuitInfo.hasKeys()) {
+      // Older programs do not record the keys of their circuits
+      for (size_t i = 0; i < serverKeyset.lweBootstrapKeys.size(); i++) {
+        bootstrapKeys.insert(i);
+      }
+      for (size_t i = 0; i < serverKeyset.lweKeyswitchKeys.size(); i++) {
+        keyswitchKeys.insert(i);
+      }
+      continue;
+    }
+    auto keys = circuitInfo.getKeys();
+    bootstrapKeys.insert(keys.getLweBootstrapKeys().begin(),
+                         keys.getLweBootstrapKeys().end());
+    keyswitchKeys.insert(keys.getLweKeyswitchKeys().begin(),
+                         keys.getLweKeyswitchKeys().end());
+  }
+
+  std::shared_ptr<RuntimeContext> runtimeContext =
+      RuntimeContextCache::global().get(serverKeyset);
+  std::vector<std::thread> workers;
+  for (auto keyId : bootstrapKeys) {
+    workers.emplace_back(
+        [&, keyId]() { runtimeContext->fourier_bootstrap_key_buffer(keyId); });
+  }
+  for (auto keyId : keyswitchKeys) {
+    auto info = serverKeyset.lweKeyswitchKeys[keyId].getInfo().asReader();
+    if (info.getParams().getOutputPolynomialSize() == 0) {
+      continue;
+    }
+    workers.emplace_back([&, keyId]() {
+      runtimeContext->fourier_fast_keyswitch_key_buffer(keyId);
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return outcome::success();
+}
+
+Result<std::vector<TransportValue>>
+ServerProgram::callGraph(const ServerKeyset &serverKeyset,
+                         const CallGraph &graph,
+                         const std::vector<TransportValue> &args,
+                         size_t maxThreads, OutputCallback onOutput) const {
+  if (graph.stages.empty()) {
+    return StringError("Called a call graph without stages");
+  }
+  size_t stageCount = graph.stages.size();
+
+  // We resolve the circuits and check the sources of the stages, the level of
+  // a stage being one more than the one of its latest source stage.
+  std::vector<const ServerCircuit *> circuits(stageCount);
+  std::vector<size_t> levels(stageCount, 0);
+  auto checkSource = [&](const CallGraph::Source &source,
+                         size_t user) -> Result<void> {
+    if (!source.stage.has_value()) {
+      if (source.index >= args.size()) {
+        return StringError("Used argument ")
+               << source.index << " of a call graph called on "
+               << args.size() << " arguments";
+      }
+      return outcome::success();
+    }
+    size_t stage = *source.stage;
+    if (stage >= user) {
+      return StringError("Used the returns of stage ")
+             << stage << " before they are computed";
+    }
+    size_t returnCount = circuits[stage]->returnTransformers.size();
+    if (source.index >= returnCount) {
+      return StringError("Used return ")
+             << source.index << " of stage " << stage << " which has "
+             << returnCount << " returns";
+    }
+    return outcome::success();
+  };
+  for (size_t i = 0; i < stageCount; i++) {
+    auto &stage = graph.stages[i];
+    for (auto &circuit : serverCircuits) {
+      if (stage.circuit == circuit.circuitInfo.asReader().getName().cStr()) {
+        circuits[i] = &circuit;
+        break;
+      }
+    }
+    if (circuits[i] == nullptr) {
+      return StringError("Tried to get unknown server circuit: `" +
+                         stage.circuit + "`");
+    }
+    if (stage.args.size() != circuits[i]->argTransformers.size()) {
+      return StringError("Called circuit `")
+             << stage.circuit << "` of stage " << i
+             << " with wrong number of arguments";
+    }
+    for (auto &source : stage.args) {
+      OUTCOME_TRYV(checkSource(source, i));
+      if (source.stage.has_value()) {
+        levels[i] = std::max(levels[i], levels[*source.stage] + 1);
+      }
+    }
+  }
+  std::vector<CallGraph::Source> outputs = graph.outputs;
+  if (outputs.empty()) {
+    size_t last = stageCount - 1;
+    for (size_t i = 0; i < circuits[last]->returnTransformers.size(); i++) {
+      outputs.push_back({last, i});
+    }
+  }
+  for (auto &source : outputs) {
+    OUTCOME_TRYV(checkSource(source, stageCount));
+  }
+
+  // The returns of a stage are released after the level of their last user,
+  // and never if they are outputs of the graph.
+  size_t levelCount = *std::max_element(levels.begin(), levels.end()) + 1;
+  std::vector<size_t> releaseLevels(stageCount, 0);
+  for (size_t i = 0; i < stageCount; i++) {
+    for (auto &source : graph.stages[i].args) {
+      if (source.stage.has_value()) {
+        releaseLevels[*source.stage] =
+            std::max(releaseLevels[*source.stage], levels[i]);
+      }
+    }
+  }
+  for (auto &source : outputs) {
+    if (source.stage.has_value()) {
+      releaseLevels[*source.stage] = levelCount;
+    }
+  }
+
+  // We prepare the runtime context once for the whole graph, so that its
+  // stages share it.
+  std::shared_ptr<RuntimeContext> runtimeContext;
+  if (!circuits[0]->useSimulation) {
+    runtimeContext = RuntimeContextCache::global().get(serverKeyset);
+  }
+  size_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  ServerKeyset emptyKeyset;
+  const ServerKeyset &keyset =
+      circuits[0]->useSimulation ? emptyKeyset : serverKeyset;
+
+  std::vector<std::optional<Result<std::vector<TransportValue>>>> results(
+      stageCount);
+  auto valueOf = [&](const CallGraph::Source &source) -> TransportValue {
+    if (!source.stage.has_value()) {
+      return args[source.index];
+    }
+    return results[*source.stage]->value()[source.index];
+  };
+
+  // The outputs are streamed by the stage computing them, the ones of the
+  // arguments being ready from the start.
+  std::mutex onOutputMutex;
+  std::vector<std::vector<size_t>> stageOutputs(stageCount);
+  if (onOutput) {
+    for (size_t k = 0; k < outputs.size(); k++) {
+      if (outputs[k].stage.has_value()) {
+        stageOutputs[*outputs[k].stage].push_back(k);
+      } else {
+        onOutput(k, args[outputs[k].index]);
+      }
+    }
+  }
+  for (size_t level = 0; level < levelCount; level++) {
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < stageCount; i++) {
+      if (levels[i] == level) {
+        ready.push_back(i);
+      }
+    }
+
+    // Each worker picks the next ready stage until the level is exhausted.
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+      for (size_t j = next++; j < ready.size(); j = next++) {
+        size_t i = ready[j];
+        std::vector<TransportValue> stageArgs;
+        stageArgs.reserve(graph.stages[i].args.size());
+        for (auto &source : graph.stages[i].args) {
+          stageArgs.push_back(valueOf(source));
+        }
+        results[i] = circuits[i]->call(keyset, stageArgs);
+        if (!stageOutputs[i].empty() && results[i]->has_value()) {
+          std::lock_guard<std::mutex> lock(onOutputMutex);
+          for (size_t k : stageOutputs[i]) {
+            onOutput(k, results[i]->value()[outputs[k].index]);
+          }
+        }
+      }
+    };
+    size_t numThreads = maxThreads == 0 ? hardwareThreads : maxThreads;
+    numThreads = std::min(numThreads, ready.size());
+    if (numThreads <= 1) {
+      worker();
+    } else {
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < numThreads; t++) {
+        workers.emplace_back(worker);
+      }
+      for (auto &w : workers) {
+        w.join();
+      }
+    }
+
+    for (size_t i : ready) {
+      if (results[i]->has_failure()) {
+        return StringError("Stage ")
+               << i << " of the call graph failed: "
+               << results[i]->as_failure().error().mesg;
+      }
+    }
+    for (size_t i = 0; i < stageCount; i++) {
+      if (levels[i] <= level && releaseLevels[i] == level) {
+        results[i].reset();
+      }
+    }
+  }
+
+  std::vector<TransportValue> returns;
+  returns.reserve(outputs.size());
+  for (auto &source : outputs) {
+    returns.push_back(valueOf(source));
+  }
+  return returns;
+}
+
 } // namespace serverlib
 } // namespace concretelang
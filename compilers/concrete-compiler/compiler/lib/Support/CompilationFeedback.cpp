@@ -3,8 +3,10 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
+#include <thread>
 #include <vector>
 
 #include "concrete-protocol.capnp.h"
@@ -22,7 +24,9 @@ void CircuitCompilationFeedback::fillFromCircuitInfo(
         unsigned int nElements = 1;
         for (auto dimension :
              gateInfo.asReader().getRawInfo().getShape().getDimensions()) {
-          nElements *= dimension;
+          // A dynamic dimension counts for a single element
+          if (dimension != concretelang::protocol::DYNAMIC_DIMENSION)
+            nElements *= dimension;
         }
         unsigned int gateScalarSize =
             gateInfo.asReader().getRawInfo().getIntegerPrecision() / 8;
@@ -61,6 +65,95 @@ void CircuitCompilationFeedback::fillFromCircuitInfo(
   name = circuitInfo.getName().cStr();
 }
 
+/// Returns the key of `type` used by `statistic`.
+static std::optional<int64_t> statisticKey(const Statistic &statistic,
+                                           KeyType type) {
+  for (auto &key : statistic.keys) {
+    if (key.first == type)
+      return key.second;
+  }
+  return std::nullopt;
+}
+
+/// Returns the nanoseconds of a single operation of `statistic`, nothing if
+/// it is not measured by the cost table.
+static std::optional<double>
+statisticNs(const Statistic &statistic,
+            concreteprotocol::KeysetInfo::Reader keyset,
+            const CostTable &costTable) {
+  auto secretKeys = keyset.getLweSecretKeys();
+  auto lweDimension = [&](uint32_t id) {
+    assert(id < secretKeys.size());
+    return secretKeys[id].getParams().getLweDimension();
+  };
+  switch (statistic.operation) {
+  case PrimitiveOperation::PBS: {
+    auto index = statisticKey(statistic, KeyType::BOOTSTRAP);
+    for (auto bskInfo : keyset.getLweBootstrapKeys()) {
+      if (!index || (int64_t)bskInfo.getId() != *index)
+        continue;
+      auto params = bskInfo.getParams();
+      return costTable.bootstrapNs(lweDimension(bskInfo.getInputId()),
+                                   params.getGlweDimension(),
+                                   params.getPolynomialSize(),
+                                   params.getLevelCount());
+    }
+    return std::nullopt;
+  }
+  case PrimitiveOperation::KEY_SWITCH: {
+    auto index = statisticKey(statistic, KeyType::KEY_SWITCH);
+    for (auto kskInfo : keyset.getLweKeyswitchKeys()) {
+      if (!index || (int64_t)kskInfo.getId() != *index)
+        continue;
+      return costTable.keyswitchNs(lweDimension(kskInfo.getInputId()),
+                                   lweDimension(kskInfo.getOutputId()),
+                                   kskInfo.getParams().getLevelCount());
+    }
+    return std::nullopt;
+  }
+  default:
+    return std::nullopt;
+  }
+}
+
+void CircuitCompilationFeedback::predictRuntime(
+    concreteprotocol::KeysetInfo::Reader keyset, const CostTable &costTable,
+    uint64_t workers) {
+  predictedLatency = std::nullopt;
+  predictedThroughput = std::nullopt;
+  if (workers == 0)
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  // The total and the longest nanoseconds of the operations of each depth
+  std::map<int64_t, std::pair<double, double>> depths;
+  double totalNs = 0;
+  for (auto &statistic : statistics) {
+    switch (statistic.operation) {
+    case PrimitiveOperation::PBS:
+    case PrimitiveOperation::KEY_SWITCH:
+      break;
+    case PrimitiveOperation::WOP_PBS:
+      // Not measured by the cost table
+      return;
+    default:
+      // The leveled operations are negligible
+      continue;
+    }
+    auto ns = statisticNs(statistic, keyset, costTable);
+    if (!ns || !statistic.count || !statistic.depth)
+      return;
+    auto &depth = depths[*statistic.depth];
+    depth.first += *ns * *statistic.count;
+    depth.second = std::max(depth.second, *ns);
+    totalNs += *ns * *statistic.count;
+  }
+  double latencyNs = 0;
+  for (auto &depth : depths)
+    latencyNs += std::max(depth.second.first / workers, depth.second.second);
+  predictedLatency = latencyNs * 1e-9;
+  if (totalNs > 0)
+    predictedThroughput = workers / (totalNs * 1e-9);
+}
+
 void ProgramCompilationFeedback::fillFromProgramInfo(
     const Message<concreteprotocol::ProgramInfo> &programInfo) {
   auto params = programInfo.asReader();
@@ -118,6 +211,15 @@ void ProgramCompilationFeedback::fillFromProgramInfo(
   }
 }
 
+void ProgramCompilationFeedback::predictRuntime(
+    const Message<concreteprotocol::ProgramInfo> &programInfo,
+    const CostTable &costTable, uint64_t workers) {
+  for (auto &circuitFeedback : circuitFeedbacks) {
+    circuitFeedback.predictRuntime(programInfo.asReader().getKeyset(),
+                                   costTable, workers);
+  }
+}
+
 outcome::checked<ProgramCompilationFeedback, StringError>
 ProgramCompilationFeedback::load(std::string jsonPath) {
   std::ifstream file(jsonPath);
@@ -150,6 +252,7 @@ llvm::json::Object statisticToJson(const Statistic &statistic) {
   auto object = llvm::json::Object();
   object.insert({"location", statistic.location});
   object.insert({"count", statistic.count});
+  object.insert({"depth", statistic.depth});
   switch (statistic.operation) {
   case PrimitiveOperation::PBS:
     object.insert({"operation", "PBS"});
@@ -234,6 +337,9 @@ llvm::json::Array circuitFeedbacksToJson(
          crtDecompositionToJson(circuit.crtDecompositionsOfOutputs)},
         {"statistics", statisticsToJson(circuit.statistics)},
         {"memoryUsagePerLoc", memoryUsageToJson(circuit.memoryUsagePerLoc)},
+        {"predictedLatency", circuit.predictedLatency},
+        {"predictedThroughput", circuit.predictedThroughput},
+        {"outputErrorProbabilities", circuit.outputErrorProbabilities},
     };
     object.push_back(std::move(circuitObject));
   }
@@ -249,6 +355,7 @@ toJSON(const mlir::concretelang::ProgramCompilationFeedback &program) {
       {"totalSecretKeysSize", program.totalSecretKeysSize},
       {"totalBootstrapKeysSize", program.totalBootstrapKeysSize},
       {"totalKeyswitchKeysSize", program.totalKeyswitchKeysSize},
+      {"integerRepresentation", program.integerRepresentation},
       {"circuitFeedbacks", circuitFeedbacksToJson(program.circuitFeedbacks)}};
   return programObject;
 }
@@ -333,7 +440,8 @@ bool fromJSON(const llvm::json::Value j, mlir::concretelang::Statistic &v,
 
   return O && O.map("location", v.location) &&
          O.map("operation", v.operation) && O.map("operation", v.operation) &&
-         O.map("keys", v.keys) && O.map("count", v.count);
+         O.map("keys", v.keys) && O.map("count", v.count) &&
+         O.mapOptional("depth", v.depth);
 }
 
 bool fromJSON(const llvm::json::Value j,
@@ -345,7 +453,11 @@ bool fromJSON(const llvm::json::Value j,
          O.map("totalOutputsSize", v.totalOutputsSize) &&
          O.map("crtDecompositionsOfOutputs", v.crtDecompositionsOfOutputs) &&
          O.map("statistics", v.statistics) &&
-         O.map("memoryUsagePerLoc", v.memoryUsagePerLoc);
+         O.map("memoryUsagePerLoc", v.memoryUsagePerLoc) &&
+         O.mapOptional("predictedLatency", v.predictedLatency) &&
+         O.mapOptional("predictedThroughput", v.predictedThroughput) &&
+         O.mapOptional("outputErrorProbabilities",
+                       v.outputErrorProbabilities);
 }
 
 bool fromJSON(const llvm::json::Value j,
@@ -358,6 +470,7 @@ bool fromJSON(const llvm::json::Value j,
          O.map("totalSecretKeysSize", v.totalSecretKeysSize) &&
          O.map("totalBootstrapKeysSize", v.totalBootstrapKeysSize) &&
          O.map("totalKeyswitchKeysSize", v.totalKeyswitchKeysSize) &&
+         O.mapOptional("integerRepresentation", v.integerRepresentation) &&
          O.map("circuitFeedbacks", v.circuitFeedbacks);
 }
 
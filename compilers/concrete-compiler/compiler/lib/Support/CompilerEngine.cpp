@@ -36,7 +36,9 @@
 #include "mlir/Parser/Parser.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/SMLoc.h"
 
 #include "concrete-protocol.capnp.h"
@@ -158,9 +160,8 @@ void CompilerEngine::setEnablePass(
 
 /// Returns the optimizer::Description
 llvm::Expected<std::optional<optimizer::Description>>
-CompilerEngine::getConcreteOptimizerDescription(CompilationResult &res) {
+CompilerEngine::getConcreteOptimizerDescription(mlir::ModuleOp module) {
   mlir::MLIRContext &mlirContext = *this->compilationContext->getMLIRContext();
-  mlir::ModuleOp module = res.mlirModuleRef->get();
   // If the values has been overwritten returns
   if (this->overrideMaxEintPrecision.has_value() &&
       this->overrideMaxMANP.has_value()) {
@@ -225,13 +226,15 @@ llvm::Error CompilerEngine::determineFHEParameters(CompilationResult &res) {
         mlir::concretelang::V0FHEContext{constraint, v0Params});
 
     ProgramCompilationFeedback feedback;
+    // The complexity is only known from the optimizer.
+    feedback.complexity = 0;
     res.feedback.emplace(feedback);
 
     return llvm::Error::success();
   }
   // compute parameters
   else {
-    auto descr = getConcreteOptimizerDescription(res);
+    auto descr = getConcreteOptimizerDescription(res.mlirModuleRef->get());
     if (auto err = descr.takeError()) {
       return err;
     }
@@ -256,6 +259,56 @@ llvm::Error CompilerEngine::determineFHEParameters(CompilationResult &res) {
   return llvm::Error::success();
 }
 
+/// Returns the complexity of the parameters found by the optimizer for
+/// `module`, or std::nullopt if it finds none.
+std::optional<double>
+CompilerEngine::getOptimizedComplexity(mlir::ModuleOp module) {
+  auto descr = getConcreteOptimizerDescription(module);
+  if (!descr) {
+    llvm::consumeError(descr.takeError());
+    return std::nullopt;
+  }
+  if (!descr.get().has_value())
+    return std::nullopt;
+  auto config = compilerOptions.optimizerConfig;
+  config.use_gpu_constraints = compilerOptions.emitGPUOps;
+  // Only the parameters of the selected representation are displayed
+  config.display = false;
+  ProgramCompilationFeedback feedback;
+  auto solution = getSolution(descr.get().value(), feedback, config);
+  if (!solution) {
+    llvm::consumeError(solution.takeError());
+    return std::nullopt;
+  }
+  return feedback.complexity;
+}
+
+/// Returns true if the integers of `module` should be decomposed into
+/// chunks, i.e. if the optimizer finds parameters for the chunked circuit
+/// which are cheaper than the ones of the native or CRT circuit, the
+/// optimizer choosing between the latter two by itself.
+llvm::Expected<bool>
+CompilerEngine::selectChunkedIntegers(mlir::ModuleOp module) {
+  // Parameters given by the user are not evaluated.
+  if (compilerOptions.v0Parameter.has_value() ||
+      (overrideMaxEintPrecision.has_value() && overrideMaxMANP.has_value()))
+    return false;
+  mlir::MLIRContext &mlirContext = *this->compilationContext->getMLIRContext();
+  mlir::OwningOpRef<mlir::ModuleOp> chunkedRef = module.clone();
+  mlir::ModuleOp chunked = chunkedRef.get();
+  if (pipeline::transformFHEBigInt(mlirContext, chunked, enablePass,
+                                   compilerOptions.chunkSize,
+                                   compilerOptions.chunkWidth,
+                                   compilerOptions.carryLookaheadMinChunks)
+          .failed())
+    return StreamStringError("Transforming FHE big integer ops failed");
+  auto chunkedComplexity = getOptimizedComplexity(chunked);
+  if (!chunkedComplexity.has_value())
+    return false;
+  auto complexity = getOptimizedComplexity(module);
+  return !complexity.has_value() || *chunkedComplexity < *complexity;
+}
+
 mlir::LogicalResult
 CompilerEngine::materializeOptimizerPartitionFrontiers(CompilationResult &res) {
   mlir::ModuleOp module = res.mlirModuleRef->get();
@@ -373,19 +426,106 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
     return StreamStringError("Transforming FHE boolean ops failed");
   }
 
-  if (options.chunkIntegers) {
+  bool chunkIntegers = options.chunkIntegers;
+  if (!chunkIntegers && options.autoChunkIntegers) {
+    auto chunked = this->selectChunkedIntegers(module);
+    if (auto err = chunked.takeError())
+      return std::move(err);
+    chunkIntegers = *chunked;
+  }
+
+  if (chunkIntegers) {
     if (mlir::concretelang::pipeline::transformFHEBigInt(
             mlirContext, module, enablePass, options.chunkSize,
-            options.chunkWidth)
+            options.chunkWidth, options.carryLookaheadMinChunks)
             .failed()) {
       return StreamStringError("Transforming FHE big integer ops failed");
     }
   }
 
+  // Sharing the squares of the operands of encrypted matrix multiplications
+  // must happen before the optimizer accounts for their bootstraps.
+  if (options.enableMatMulSquares) {
+    if (mlir::concretelang::pipeline::shareMatMulSquares(mlirContext, module,
+                                                         enablePass)
+            .failed()) {
+      return StreamStringError(
+          "Sharing encrypted matrix multiplication squares failed");
+    }
+  }
+
+  // On GPU, the two table lookups of each encrypted multiplication are
+  // merged into a single one, making fewer and larger batches.
+  if (options.emitGPUOps && options.batchTFHEOps) {
+    if (mlir::concretelang::pipeline::batchEncryptedMuls(mlirContext, module,
+                                                         enablePass)
+            .failed()) {
+      return StreamStringError("Batching encrypted multiplications failed");
+    }
+  }
+
+  // Fusing table lookups across layout operations reduces the number of
+  // bootstraps the optimizer accounts for.
+  if (options.enableTluFusing) {
+    if (mlir::concretelang::pipeline::fuseTableLookups(
+            mlirContext, module, options.printTluFusing, enablePass)
+            .failed()) {
+      return StreamStringError("Fusing table lookups failed");
+    }
+  }
+
+  // The roundings are replaced by table lookups before new ones are
+  // introduced, for the same cost model, to not undo them.
+  if (options.enableSingleBootstrapRounding) {
+    auto config = options.optimizerConfig;
+    auto tluCost = [config](unsigned precision) {
+      return getBootstrapComplexity(precision, config);
+    };
+    if (mlir::concretelang::pipeline::roundWithTableLookups(
+            mlirContext, module, tluCost, enablePass)
+            .failed()) {
+      return StreamStringError("Rounding with table lookups failed");
+    }
+  }
+
+  // Rounding the inputs of the table lookups lowers the precision the
+  // optimizer finds parameters for.
+  if (options.enableAutoRounding) {
+    auto config = options.optimizerConfig;
+    auto tluCost = [config](unsigned precision) {
+      return getBootstrapComplexity(precision, config);
+    };
+    if (mlir::concretelang::pipeline::autoRoundTableLookups(
+            mlirContext, module, options.autoRoundingMaxError, tluCost,
+            enablePass)
+            .failed()) {
+      return StreamStringError("Rounding table lookups failed");
+    }
+  }
+
+  // Packed table lookups are accounted for as a single bootstrap by the
+  // optimizer.
+  if (options.enableManyLut && !options.simulate && !options.emitGPUOps) {
+    if (mlir::concretelang::pipeline::packTableLookups(mlirContext, module,
+                                                       enablePass)
+            .failed()) {
+      return StreamStringError("Packing table lookups failed");
+    }
+  }
+
   // FHE High level pass to determine FHE parameters
   if (auto err = this->determineFHEParameters(res))
     return std::move(err);
 
+  if (res.feedback.has_value() && res.fheContext.has_value()) {
+    if (chunkIntegers)
+      res.feedback->integerRepresentation = "chunked";
+    else if (getCrtDecompositionFromSolution(res.fheContext->solution))
+      res.feedback->integerRepresentation = "crt";
+    else
+      res.feedback->integerRepresentation = "native";
+  }
+
   if (this->materializeOptimizerPartitionFrontiers(res).failed()) {
     return StreamStringError(
         "Could not materialize explicit optimizer partition frontiers");
@@ -397,7 +537,7 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
     std::optional<
         Message<concreteprotocol::IntegerCiphertextEncodingInfo::ChunkedMode>>
         maybeChunkInfo(std::nullopt);
-    if (options.chunkIntegers) {
+    if (chunkIntegers) {
       auto chunkedMode = Message<
           concreteprotocol::IntegerCiphertextEncodingInfo::ChunkedMode>();
       chunkedMode.asBuilder().setSize(options.chunkSize);
@@ -415,14 +555,25 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
             .failed())
       return StreamStringError(
           "Marking of FHELinalg operations for tiling failed");
+  } else if (options.fhelinalgTileCacheSize && res.fheContext.has_value()) {
+    int64_t ciphertextSize =
+        (getMaxBigLweDimensionFromSolution(res.fheContext->solution) + 1) *
+        sizeof(uint64_t);
+    if (mlir::concretelang::pipeline::markFHELinalgForCacheBlocking(
+            mlirContext, module, *options.fhelinalgTileCacheSize,
+            ciphertextSize, enablePass)
+            .failed())
+      return StreamStringError(
+          "Marking of FHELinalg operations for cache blocking failed");
   }
 
   if (target == Target::FHE)
     return std::move(res);
 
   // FHELinalg -> FHE
-  if (mlir::concretelang::pipeline::lowerFHELinalgToLinalg(mlirContext, module,
-                                                           enablePass)
+  if (mlir::concretelang::pipeline::lowerFHELinalgToLinalg(
+          mlirContext, module, enablePass, options.treeReductionMinSize,
+          options.conv2dIm2col, options.sparseMatmul)
           .failed()) {
     return StreamStringError("Lowering from FHELinalg to Linalg failed");
   }
@@ -430,12 +581,29 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
   if (target == Target::FHE_LINALG_GENERIC)
     return std::move(res);
 
+  if (!options.fhelinalgTileSizes && options.fhelinalgTileTaskCost > 0) {
+    if (mlir::concretelang::pipeline::markLinalgForTaskTiling(
+            mlirContext, module, options.fhelinalgTileTaskCost,
+            options.fhelinalgTileWorkers, enablePass)
+            .failed())
+      return StreamStringError(
+          "Marking of Linalg operations for task tiling failed");
+  }
+
   if (mlir::concretelang::pipeline::tileMarkedLinalg(mlirContext, module,
                                                      enablePass)
           .failed()) {
     return StreamStringError("Tiling of Linalg operations failed");
   }
 
+  if (options.layerStreamingTileSize > 0) {
+    if (mlir::concretelang::pipeline::streamLinalgLayers(
+            mlirContext, module, options.layerStreamingTileSize, enablePass)
+            .failed()) {
+      return StreamStringError("Streaming of Linalg layers failed");
+    }
+  }
+
   if (mlir::concretelang::pipeline::transformHighLevelFHEOps(mlirContext,
                                                              module, enablePass)
           .failed()) {
@@ -453,8 +621,12 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
     return std::move(res);
 
   // Dataflow parallelization
+  double circuitComplexity = res.feedback ? res.feedback->complexity : 0;
   if (dataflowParallelize &&
-      mlir::concretelang::pipeline::autopar(mlirContext, module, enablePass)
+      mlir::concretelang::pipeline::autopar(mlirContext, module,
+                                            circuitComplexity,
+                                            options.dataflowTaskComplexity,
+                                            enablePass)
           .failed()) {
     return StreamStringError("Dataflow parallelization failed");
   }
@@ -499,6 +671,42 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
     return StreamStringError("Normalizing TFHE keys failed");
   }
 
+  // Sharing the keyswitches of ciphertexts feeding several bootstraps, now
+  // that identical keys are known to belong to the same partition.
+  if (this->compilerOptions.optimizeTFHE &&
+      mlir::concretelang::pipeline::shareTFHEKeyswitches(mlirContext, module,
+                                                         this->enablePass)
+          .failed()) {
+    return StreamStringError("Sharing TFHE keyswitches failed");
+  }
+
+  // Evaluating the lookup tables of the same ciphertexts with a single wop
+  // pbs, on the same circuit bootstrapped bits
+  if (this->compilerOptions.optimizeTFHE &&
+      mlir::concretelang::pipeline::shareTFHEWopPBS(mlirContext, module,
+                                                    this->enablePass)
+          .failed()) {
+    return StreamStringError("Sharing TFHE wop pbs failed");
+  }
+
+  // Encoding the constant lookup tables, now that the size of their test
+  // polynomial is known, rather than at each execution
+  if (this->compilerOptions.optimizeTFHE &&
+      mlir::concretelang::pipeline::encodeTFHEConstantLuts(mlirContext, module,
+                                                           this->enablePass)
+          .failed()) {
+    return StreamStringError("Encoding TFHE constant lookup tables failed");
+  }
+
+  // Encoding the other lookup tables once for all the lookups using them,
+  // rather than on each iteration of the loops over the looked up tensors
+  if (this->compilerOptions.optimizeTFHE &&
+      mlir::concretelang::pipeline::hoistTFHELutEncodings(mlirContext, module,
+                                                          this->enablePass)
+          .failed()) {
+    return StreamStringError("Hoisting TFHE lookup table encodings failed");
+  }
+
   // Generate client parameters if requested
   if (this->generateProgramInfo) {
     if (!res.fheContext.has_value()) {
@@ -519,13 +727,31 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
           mlir::concretelang::createProgramInfoFromTfheDialect(
               module, options.optimizerConfig.security,
               options.encodings.value(), options.compressEvaluationKeys,
-              options.compressInputCiphertexts);
+              options.compressInputCiphertexts,
+              options.compressOutputCiphertexts,
+              options.bootstrapGroupingFactor);
 
       if (!programInfoOrErr)
         return programInfoOrErr.takeError();
 
       res.programInfo = std::move(*programInfoOrErr);
       res.feedback->fillFromProgramInfo(*res.programInfo);
+
+      // The multi-parameter optimizer enforces the maximum, but not the
+      // fallback strategies nor the user provided parameters.
+      uint64_t maxKeysSize =
+          options.optimizerConfig.maximum_evaluation_keys_size;
+      uint64_t keysSize = res.feedback->totalBootstrapKeysSize +
+                          res.feedback->totalKeyswitchKeysSize;
+      if (maxKeysSize != 0 && keysSize > maxKeysSize) {
+        return StreamStringError("The evaluation keys take ")
+               << keysSize << " bytes, more than the maximum of "
+               << maxKeysSize << " bytes";
+      }
+      if (options.optimizerConfig.display) {
+        llvm::errs() << "--- Evaluation keys\n"
+                     << "  " << keysSize << " bytes\n";
+      }
     }
   }
 
@@ -538,6 +764,39 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
             .failed()) {
       return StreamStringError("Extracting TFHE statistics failed");
     }
+    if (!options.predictionCostTable.empty() && res.programInfo) {
+      auto costTable = CostTable::load(options.predictionCostTable);
+      if (costTable.has_failure())
+        return StreamStringError(costTable.error().mesg);
+      res.feedback->predictRuntime(*res.programInfo, costTable.value(),
+                                   options.predictionWorkers);
+    }
+    if (options.analyzeNoise && res.programInfo &&
+        mlir::concretelang::pipeline::analyzeTFHENoise(
+            mlirContext, module, this->enablePass, res.feedback.value(),
+            *res.programInfo, options.optimizerConfig.fft_precision)
+            .failed()) {
+      return StreamStringError("Analyzing the TFHE noise failed");
+    }
+  }
+
+  auto batchTFHE = [&]() -> llvm::Error {
+    if (mlir::concretelang::pipeline::batchTFHE(mlirContext, module, enablePass,
+                                                options.maxBatchSize)
+            .failed()) {
+      return StreamStringError("Batching of TFHE operations");
+    }
+    return llvm::Error::success();
+  };
+
+  // The simulation lowers the batched operations to the batched entry points
+  // of the simulation runtime, so the batching must come first
+  if (options.simulate && options.batchTFHEOps) {
+    if (auto err = batchTFHE())
+      return std::move(err);
+
+    if (target == Target::BATCHED_TFHE)
+      return std::move(res);
   }
 
   if (options.simulate) {
@@ -551,12 +810,19 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
   if (target == Target::SIMULATED_TFHE)
     return std::move(res);
 
-  if (options.batchTFHEOps) {
-    if (mlir::concretelang::pipeline::batchTFHE(mlirContext, module, enablePass,
-                                                options.maxBatchSize)
-            .failed()) {
-      return StreamStringError("Batching of TFHE operations");
-    }
+  if (options.batchTFHEOps && !options.simulate) {
+    if (auto err = batchTFHE())
+      return std::move(err);
+  }
+
+  // Scheduling for memory once batched, as the batching orders the blocks by
+  // depth
+  if (options.maxLiveCiphertextBytes && !options.simulate &&
+      mlir::concretelang::pipeline::scheduleTFHEForMemory(
+          mlirContext, module, this->enablePass,
+          *options.maxLiveCiphertextBytes)
+          .failed()) {
+    return StreamStringError("Scheduling TFHE operations for memory failed");
   }
 
   if (target == Target::BATCHED_TFHE)
@@ -577,7 +843,8 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
   if (options.emitSDFGOps) {
     if (mlir::concretelang::pipeline::extractSDFGOps(
             mlirContext, module, enablePass,
-            options.unrollLoopsWithSDFGConvertibleOps)
+            options.unrollLoopsWithSDFGConvertibleOps,
+            options.maxUnrolledSDFGOps)
             .failed()) {
       return StreamStringError("Extraction of SDFG operations from Concrete "
                                "representation failed");
@@ -610,6 +877,16 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
     return StreamStringError("Failed to lower to std");
   }
 
+  // The buffers shared with dataflow tasks are reference counted by the
+  // runtime, they are not reused.
+  if (options.reuseBuffers && !dataflowParallelize) {
+    if (mlir::concretelang::pipeline::reuseBuffers(mlirContext, module,
+                                                   enablePass)
+            .failed()) {
+      return StreamStringError("Reusing buffers failed");
+    }
+  }
+
   if (target == Target::STD)
     return std::move(res);
 
@@ -622,7 +899,9 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
   }
 
   if (mlir::concretelang::pipeline::lowerToCAPI(mlirContext, module, enablePass,
-                                                options.emitGPUOps)
+                                                options.emitGPUOps,
+                                                options.inlineLeveledOps,
+                                                options.pipelineChunkSize)
           .failed()) {
     return StreamStringError("Failed to lower to CAPI");
   }
@@ -649,6 +928,13 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
   if (target == Target::LLVM_IR)
     return std::move(res);
 
+  if (!options.runtimeBitcode.empty()) {
+    if (auto err = mlir::concretelang::pipeline::linkRuntimeBitcode(
+            *res.llvmModule, options.runtimeBitcode)) {
+      return std::move(err);
+    }
+  }
+
   if (mlir::concretelang::pipeline::optimizeLLVMModule(llvmContext,
                                                        *res.llvmModule)
           .failed()) {
@@ -663,7 +949,11 @@ CompilerEngine::compile(mlir::ModuleOp moduleOp, Target target,
       return StreamStringError(
           "Internal Error: Please provide a library parameter");
     }
-    auto objPath = lib.value()->setCompilationResult(res);
+    EmitObjectOptions emitOptions;
+    emitOptions.cacheDir = options.objectCacheDir;
+    emitOptions.codegenThreads = options.codegenThreads;
+    emitOptions.maxOptimizedSize = options.codegenMaxOptimizedSize;
+    auto objPath = lib.value()->setCompilationResult(res, emitOptions);
     if (!objPath) {
       return StreamStringError(llvm::toString(objPath.takeError()));
     }
@@ -719,6 +1009,135 @@ CompilerEngine::compile(std::vector<std::string> inputs,
   return *outputLib.get();
 }
 
+/// Prints the fields of `options` which change the compiled library.
+static void printCachedOptions(llvm::raw_ostream &os,
+                               const CompilationOptions &options) {
+  auto printList = [&](const std::vector<int64_t> &values) {
+    for (int64_t value : values)
+      os << value << ",";
+    os << ";";
+  };
+  auto printLargeInteger = [&](const LargeIntegerParameter &param) {
+    printList(param.crtDecomposition);
+    const auto &pksk = param.wopPBS.packingKeySwitch;
+    os << pksk.inputLweDimension << " " << pksk.outputPolynomialSize << " "
+       << pksk.level << " " << pksk.baseLog << " "
+       << param.wopPBS.circuitBootstrap.level << " "
+       << param.wopPBS.circuitBootstrap.baseLog << ";";
+  };
+  if (options.v0FHEConstraints)
+    os << "constraints " << options.v0FHEConstraints->norm2 << " "
+       << options.v0FHEConstraints->p << "\n";
+  if (options.v0Parameter) {
+    const auto &param = *options.v0Parameter;
+    os << "parameter " << param.glweDimension << " "
+       << param.logPolynomialSize << " " << param.nSmall << " "
+       << param.brLevel << " " << param.brLogBase << " " << param.ksLevel
+       << " " << param.ksLogBase << " ";
+    if (param.largeInteger)
+      printLargeInteger(*param.largeInteger);
+    os << "\n";
+  }
+  if (options.largeIntegerParameter) {
+    os << "large integer ";
+    printLargeInteger(*options.largeIntegerParameter);
+    os << "\n";
+  }
+  os << "flags " << options.verifyDiagnostics << options.simulate
+     << options.autoParallelize << options.loopParallelize
+     << options.dataflowParallelize << options.compressEvaluationKeys
+     << options.compressInputCiphertexts << options.compressOutputCiphertexts
+     << options.emitGPUOps << options.batchTFHEOps << options.emitSDFGOps
+     << options.unrollLoopsWithSDFGConvertibleOps << options.optimizeTFHE
+     << options.chunkIntegers << options.autoChunkIntegers
+     << options.skipProgramInfo << options.enableTluFusing
+     << options.enableManyLut << options.enableAutoRounding
+     << options.enableSingleBootstrapRounding
+     << options.enableMatMulSquares << options.inlineLeveledOps
+     << options.reuseBuffers << options.conv2dIm2col << options.sparseMatmul
+     << "\n";
+  os << "sizes " << llvm::format("%a", options.dataflowTaskComplexity) << " "
+     << options.maxBatchSize << " " << options.pipelineChunkSize << " "
+     << options.bootstrapGroupingFactor << " "
+     << options.maxUnrolledSDFGOps << " " << options.layerStreamingTileSize
+     << " " << options.chunkSize << " " << options.chunkWidth << " "
+     << options.carryLookaheadMinChunks << " "
+     << options.treeReductionMinSize << " "
+     << options.autoRoundingMaxError << " " << options.codegenMaxOptimizedSize
+     << "\n";
+  if (options.fhelinalgTileSizes) {
+    os << "tiles ";
+    printList(*options.fhelinalgTileSizes);
+    os << "\n";
+  }
+  if (options.fhelinalgTileCacheSize)
+    os << "tile cache " << *options.fhelinalgTileCacheSize << "\n";
+  if (options.maxLiveCiphertextBytes)
+    os << "live bytes " << *options.maxLiveCiphertextBytes << "\n";
+  if (options.fhelinalgTileTaskCost > 0)
+    os << "tile task " << llvm::format("%a", options.fhelinalgTileTaskCost)
+       << " " << options.fhelinalgTileWorkers << "\n";
+  if (options.encodings) {
+    auto json = options.encodings->writeJsonToString();
+    os << "encodings " << (json.has_failure() ? "?" : json.value()) << "\n";
+  }
+  const auto &config = options.optimizerConfig;
+  os << "optimizer " << llvm::format("%a %a", config.p_error,
+                                      config.global_p_error)
+     << " " << config.strategy << " " << config.key_sharing << " "
+     << (int)config.multi_param_strategy << " " << config.security << " "
+     << llvm::format("%a", config.fallback_log_norm_woppbs) << " "
+     << config.use_gpu_constraints << " " << (int)config.encoding << " "
+     << config.ciphertext_modulus_log << " " << config.fft_precision << " "
+     << config.composable << " " << config.maximum_evaluation_keys_size << " "
+     << config.latency_workers << " "
+     << (config.cost_table ? config.cost_table : "") << "\n";
+  if (!options.predictionCostTable.empty()) {
+    os << "prediction " << options.predictionCostTable << " "
+       << options.predictionWorkers << "\n";
+  }
+  if (!options.runtimeBitcode.empty())
+    os << "runtime bitcode " << options.runtimeBitcode << "\n";
+}
+
+std::string
+CompilerEngine::libraryCacheKey(llvm::StringRef source,
+                                llvm::StringRef runtimeLibraryPath) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  // The build of the compiler stands for its version, a rebuilt compiler
+  // invalidating the cache
+  os << "concretecompiler " << __DATE__ << " " << __TIME__ << "\n";
+  printCachedOptions(os, compilerOptions);
+  if (overrideMaxEintPrecision)
+    os << "max eint precision " << *overrideMaxEintPrecision << "\n";
+  if (overrideMaxMANP)
+    os << "max manp " << *overrideMaxMANP << "\n";
+  os << "program info " << generateProgramInfo << "\n";
+  os << "runtime " << runtimeLibraryPath << "\n";
+  os << source;
+  os.flush();
+  return llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(key)),
+                     /*LowerCase=*/true);
+}
+
+/// Returns the text of the sources of `sm`, which identifies the compiled
+/// library.
+static std::string cachedSource(llvm::SourceMgr &sm) {
+  std::string source;
+  for (unsigned i = 1; i <= sm.getNumBuffers(); i++)
+    source += sm.getMemoryBuffer(i)->getBuffer().str();
+  return source;
+}
+
+static std::string cachedSource(mlir::ModuleOp module) {
+  std::string source;
+  llvm::raw_string_ostream os(source);
+  module.print(os, mlir::OpPrintingFlags().enableDebugInfo());
+  os.flush();
+  return source;
+}
+
 template <typename T>
 llvm::Expected<CompilerEngine::Library>
 compileModuleOrSource(CompilerEngine *engine, T module,
@@ -730,6 +1149,27 @@ compileModuleOrSource(CompilerEngine *engine, T module,
   auto outputLib = std::make_shared<Library>(outputDirPath, runtimeLibraryPath);
   auto target = CompilerEngine::Target::LIBRARY;
 
+  // The source is hashed before the compilation, which may modify `module`
+  std::string cacheEntryPath;
+  const std::string &cacheDir =
+      engine->getCompilationOptions().libraryCacheDir;
+  if (!cacheDir.empty()) {
+    llvm::SmallString<128> entryPath(cacheDir);
+    llvm::sys::path::append(
+        entryPath,
+        engine->libraryCacheKey(cachedSource(module), runtimeLibraryPath));
+    cacheEntryPath = entryPath.str().str();
+    auto loaded = outputLib->loadCachedArtifacts(
+        cacheEntryPath, generateSharedLib, generateStaticLib,
+        generateClientParameters, generateCompilationFeedback);
+    if (!loaded) {
+      return loaded.takeError();
+    }
+    if (*loaded) {
+      return *outputLib.get();
+    }
+  }
+
   auto compilation = engine->compile(module, target, outputLib);
   if (!compilation) {
     return compilation.takeError();
@@ -741,6 +1181,11 @@ compileModuleOrSource(CompilerEngine *engine, T module,
     return StreamStringError("Can't emit artifacts: ")
            << llvm::toString(std::move(err));
   }
+  if (!cacheEntryPath.empty()) {
+    if (auto err = outputLib->cacheArtifacts(cacheEntryPath)) {
+      return std::move(err);
+    }
+  }
   return *outputLib.get();
 }
 
@@ -780,6 +1225,14 @@ CompilerEngine::Library::getStaticLibraryPath(std::string outputDirPath) {
   return staticLibraryPath.str().str();
 }
 
+/// Returns the path of the table of the circuits of the static library
+std::string
+CompilerEngine::Library::getStaticCircuitsPath(std::string outputDirPath) {
+  llvm::SmallString<0> staticCircuitsPath(outputDirPath);
+  llvm::sys::path::append(staticCircuitsPath, "static_circuits.cpp");
+  return staticCircuitsPath.str().str();
+}
+
 /// Returns the path of the client parameter
 std::string
 CompilerEngine::Library::getProgramInfoPath(std::string outputDirPath) {
@@ -830,8 +1283,9 @@ const std::string &CompilerEngine::Library::getOutputDirPath() const {
   return outputDirPath;
 }
 
-llvm::Expected<std::string> CompilerEngine::Library::emitProgramInfoJSON() {
-  auto programInfoPath = getProgramInfoPath(outputDirPath);
+llvm::Expected<std::string>
+CompilerEngine::Library::emitProgramInfoJSON(const std::string &dirPath) {
+  auto programInfoPath = getProgramInfoPath(dirPath);
   std::error_code error;
   llvm::raw_fd_ostream out(programInfoPath, error);
   auto maybeJson = programInfo.writeJsonToString();
@@ -846,8 +1300,52 @@ llvm::Expected<std::string> CompilerEngine::Library::emitProgramInfoJSON() {
 }
 
 llvm::Expected<std::string>
-CompilerEngine::Library::emitCompilationFeedbackJSON() {
-  auto path = getCompilationFeedbackPath(outputDirPath);
+CompilerEngine::Library::emitStaticCircuitsTable(const std::string &dirPath) {
+  auto path = getStaticCircuitsPath(dirPath);
+  auto maybeJson = programInfo.writeJsonToString();
+  if (maybeJson.has_failure()) {
+    return StreamStringError(maybeJson.as_failure().error().mesg);
+  }
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error);
+  if (error) {
+    return StreamStringError("Cannot open ")
+           << path << ": " << error.message();
+  }
+  auto circuits = programInfo.asReader().getCircuits();
+  out << "// Generated by the concrete compiler, compile it in the binary the\n"
+      << "// static library is linked in, along with the server lib.\n\n"
+      << "#include \"concretelang/ServerLib/StaticCircuits.h\"\n\n";
+  for (auto circuit : circuits) {
+    out << "extern \"C\" void _mlir_concrete_" << circuit.getName().cStr()
+        << "(void **);\n";
+  }
+  out << "\nnamespace {\n"
+      << "using concretelang::serverlib::CircuitFunction;\n"
+      << "const concretelang::serverlib::StaticCircuit circuits[] = {\n";
+  for (auto circuit : circuits) {
+    out << "    {\"" << circuit.getName().cStr()
+        << "\", (CircuitFunction)_mlir_concrete_" << circuit.getName().cStr()
+        << "},\n";
+  }
+  // Zero sized arrays are not valid C++
+  if (circuits.size() == 0) {
+    out << "    {nullptr, nullptr},\n";
+  }
+  out << "};\n\n"
+      << "const char programInfo[] = R\"concrete(" << maybeJson.value()
+      << ")concrete\";\n\n"
+      << "concretelang::serverlib::StaticProgramRegistration registration(\n"
+      << "    programInfo, circuits, " << circuits.size() << ");\n"
+      << "} // namespace\n";
+  out.close();
+  return path;
+}
+
+llvm::Expected<std::string>
+CompilerEngine::Library::emitCompilationFeedbackJSON(
+    const std::string &dirPath) {
+  auto path = getCompilationFeedbackPath(dirPath);
   llvm::json::Value value(compilationFeedback);
   std::error_code error;
   llvm::raw_fd_ostream out(path, error);
@@ -878,7 +1376,8 @@ void printTluFusing(mlir::Value v1, mlir::Value v2, mlir::Value v1v2) {
 }
 
 llvm::Expected<std::string>
-CompilerEngine::Library::setCompilationResult(CompilationResult &compilation) {
+CompilerEngine::Library::setCompilationResult(
+    CompilationResult &compilation, const EmitObjectOptions &emitOptions) {
   llvm::Module *module = compilation.llvmModule.get();
   auto sourceName = module->getSourceFileName();
   if (sourceName == "" || sourceName == "LLVMDialectModule") {
@@ -886,7 +1385,8 @@ CompilerEngine::Library::setCompilationResult(CompilationResult &compilation) {
                  std::to_string(objectsPath.size()) + ".mlir";
   }
   auto objectPath = sourceName + OBJECT_EXT;
-  if (auto error = mlir::concretelang::emitObject(*module, objectPath)) {
+  if (auto error =
+          mlir::concretelang::emitObject(*module, objectPath, emitOptions)) {
     return std::move(error);
   }
 
@@ -1024,20 +1524,123 @@ llvm::Error CompilerEngine::Library::emitArtifacts(bool sharedLib,
     if (auto err = emitStatic().takeError()) {
       return err;
     }
+    if (auto err = emitStaticCircuitsTable(outputDirPath).takeError()) {
+      return err;
+    }
   }
   if (clientParameters) {
-    if (auto err = emitProgramInfoJSON().takeError()) {
+    if (auto err = emitProgramInfoJSON(outputDirPath).takeError()) {
       return err;
     }
   }
   if (compilationFeedback) {
-    if (auto err = emitCompilationFeedbackJSON().takeError()) {
+    if (auto err = emitCompilationFeedbackJSON(outputDirPath).takeError()) {
       return err;
     }
   }
   return llvm::Error::success();
 }
 
+llvm::Error CompilerEngine::Library::cacheArtifacts(std::string entryPath) {
+  // Written aside then renamed, so that concurrent compilations sharing the
+  // cache never load a partial entry
+  llvm::SmallString<128> tmpPath;
+  llvm::sys::fs::createUniquePath(entryPath + "-%%%%%%.tmp", tmpPath,
+                                  /*MakeAbsolute=*/false);
+  std::string tmpDir = tmpPath.str().str();
+  if (auto error = llvm::sys::fs::create_directories(tmpDir)) {
+    return StreamStringError("Cannot create the library cache entry ")
+           << tmpDir << ": " << error.message();
+  }
+  auto removeTmp = [&]() { llvm::sys::fs::remove_directories(tmpDir); };
+  std::vector<std::pair<std::string, std::string>> copies;
+  if (!sharedLibraryPath.empty()) {
+    copies.push_back({sharedLibraryPath, getSharedLibraryPath(tmpDir)});
+  }
+  if (!staticLibraryPath.empty()) {
+    copies.push_back({staticLibraryPath, getStaticLibraryPath(tmpDir)});
+  }
+  for (auto &copy : copies) {
+    if (auto error = llvm::sys::fs::copy_file(copy.first, copy.second)) {
+      removeTmp();
+      return StreamStringError("Cannot add ")
+             << copy.first << " to the library cache: " << error.message();
+    }
+  }
+  // The program info and the feedback are always cached, the loaded library
+  // holding them
+  if (auto err = emitProgramInfoJSON(tmpDir).takeError()) {
+    removeTmp();
+    return err;
+  }
+  if (auto err = emitCompilationFeedbackJSON(tmpDir).takeError()) {
+    removeTmp();
+    return err;
+  }
+  // An entry added meanwhile by another compilation is kept
+  if (llvm::sys::fs::rename(tmpDir, entryPath)) {
+    removeTmp();
+  }
+  return llvm::Error::success();
+}
+
+llvm::Expected<bool> CompilerEngine::Library::loadCachedArtifacts(
+    std::string entryPath, bool sharedLib, bool staticLib,
+    bool clientParameters, bool compilationFeedback) {
+  auto programInfoPath = getProgramInfoPath(entryPath);
+  auto feedbackPath = getCompilationFeedbackPath(entryPath);
+  if (!llvm::sys::fs::exists(programInfoPath) ||
+      !llvm::sys::fs::exists(feedbackPath) ||
+      (sharedLib && !llvm::sys::fs::exists(getSharedLibraryPath(entryPath))) ||
+      (staticLib && !llvm::sys::fs::exists(getStaticLibraryPath(entryPath)))) {
+    return false;
+  }
+
+  std::ifstream file(programInfoPath);
+  std::string json((std::istreambuf_iterator<char>(file)),
+                   (std::istreambuf_iterator<char>()));
+  if (file.fail() || programInfo.readJsonFromString(json).has_failure()) {
+    return StreamStringError("Cannot read the cached program info ")
+           << programInfoPath;
+  }
+  auto feedback = ProgramCompilationFeedback::load(feedbackPath);
+  if (feedback.has_failure()) {
+    return StreamStringError("Cannot read the cached compilation feedback ")
+           << feedbackPath << ": " << feedback.error().mesg;
+  }
+  this->compilationFeedback = feedback.value();
+
+  llvm::sys::fs::create_directory(outputDirPath);
+  std::vector<std::pair<std::string, std::string>> copies;
+  if (sharedLib) {
+    sharedLibraryPath = getSharedLibraryPath(outputDirPath);
+    copies.push_back({getSharedLibraryPath(entryPath), sharedLibraryPath});
+  }
+  if (staticLib) {
+    staticLibraryPath = getStaticLibraryPath(outputDirPath);
+    copies.push_back({getStaticLibraryPath(entryPath), staticLibraryPath});
+  }
+  if (clientParameters) {
+    copies.push_back({programInfoPath, getProgramInfoPath(outputDirPath)});
+  }
+  if (compilationFeedback) {
+    copies.push_back({feedbackPath, getCompilationFeedbackPath(outputDirPath)});
+  }
+  for (auto &copy : copies) {
+    if (auto error = llvm::sys::fs::copy_file(copy.first, copy.second)) {
+      return StreamStringError("Cannot copy the cached ")
+             << copy.first << ": " << error.message();
+    }
+  }
+  // The table only depends on the program info, it is not cached
+  if (staticLib) {
+    if (auto err = emitStaticCircuitsTable(outputDirPath).takeError()) {
+      return std::move(err);
+    }
+  }
+  return true;
+}
+
 CompilerEngine::Library::~Library() {
   if (cleanUp) {
     for (auto path : objectsPath) {
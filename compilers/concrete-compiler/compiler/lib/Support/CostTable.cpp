@@ -0,0 +1,103 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <cmath>
+#include <fstream>
+
+#include "concretelang/Support/CostTable.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+double keyswitchWork(double inputLweDimension, double outputLweDimension,
+                     double level) {
+  return inputLweDimension * level * (outputLweDimension + 1);
+}
+
+double bootstrapWork(double internalLweDimension, double glweDimension,
+                     double polynomialSize, double level) {
+  return internalLweDimension * level * (glweDimension + 1) *
+         (glweDimension + 1) * polynomialSize * std::log2(polynomialSize);
+}
+
+} // namespace
+
+outcome::checked<CostTable, StringError>
+CostTable::parse(llvm::StringRef table) {
+  CostTable costTable;
+  llvm::SmallVector<llvm::StringRef> lines;
+  table.split(lines, '\n');
+  for (size_t i = 0; i < lines.size(); i++) {
+    llvm::StringRef line = lines[i].split('#').first.trim();
+    if (line.empty())
+      continue;
+    llvm::SmallVector<llvm::StringRef> fields;
+    line.split(fields, ' ', -1, /*KeepEmpty=*/false);
+    llvm::SmallVector<double> values;
+    for (auto field : llvm::ArrayRef(fields).drop_front()) {
+      double value;
+      if (field.getAsDouble(value))
+        return StringError("cost table line ") << i + 1 << ": invalid number";
+      values.push_back(value);
+    }
+    if (fields[0] == "ks" && values.size() == 5) {
+      costTable.keyswitches.push_back(
+          {keyswitchWork(values[0], values[1], values[2]), values[4]});
+    } else if (fields[0] == "pbs" && values.size() == 6) {
+      costTable.bootstraps.push_back(
+          {bootstrapWork(values[0], values[1], std::exp2(values[2]),
+                         values[3]),
+           values[5]});
+    } else if (fields[0] == "ks" || fields[0] == "pbs") {
+      return StringError("cost table line ")
+             << i + 1 << ": unexpected number of fields";
+    } else {
+      return StringError("cost table line ")
+             << i + 1 << ": unknown operation";
+    }
+  }
+  if (costTable.keyswitches.empty() || costTable.bootstraps.empty())
+    return StringError("cost table needs at least one ks and one pbs measure");
+  return costTable;
+}
+
+outcome::checked<CostTable, StringError> CostTable::load(std::string path) {
+  std::ifstream file(path);
+  std::string content((std::istreambuf_iterator<char>(file)),
+                      (std::istreambuf_iterator<char>()));
+  if (file.fail())
+    return StringError("Cannot read cost table: ") << path;
+  return parse(content);
+}
+
+double CostTable::scale(const std::vector<Measure> &measures, double work) {
+  const Measure *closest = &measures.front();
+  for (const Measure &measure : measures) {
+    if (std::abs(std::log(measure.work / work)) <
+        std::abs(std::log(closest->work / work)))
+      closest = &measure;
+  }
+  return closest->ns * work / closest->work;
+}
+
+double CostTable::keyswitchNs(uint64_t inputLweDimension,
+                              uint64_t outputLweDimension,
+                              uint64_t level) const {
+  return scale(keyswitches,
+               keyswitchWork(inputLweDimension, outputLweDimension, level));
+}
+
+double CostTable::bootstrapNs(uint64_t internalLweDimension,
+                              uint64_t glweDimension, uint64_t polynomialSize,
+                              uint64_t level) const {
+  return scale(bootstraps, bootstrapWork(internalLweDimension, glweDimension,
+                                         polynomialSize, level));
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -60,7 +60,9 @@ encodingFromType(mlir::Type ty) {
     auto shapeBuilder =
         output.asBuilder().initShape().initDimensions(tensorTy.getRank());
     for (int64_t i = 0; i < tensorTy.getRank(); i++) {
-      shapeBuilder.set(i, tensorTy.getShape()[i]);
+      shapeBuilder.set(i, tensorTy.isDynamicDim(i)
+                              ? concretelang::protocol::DYNAMIC_DIMENSION
+                              : tensorTy.getShape()[i]);
     }
     return std::move(output);
   }
@@ -6,17 +6,29 @@
 #include <errno.h>
 
 #include "llvm/MC/SubtargetFeature.h"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBufferRef.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
 #include <llvm/Support/ToolOutputFile.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/TargetParser/Host.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 #include <mlir/Support/FileUtilities.h>
 
 #include <concretelang/Support/Error.h>
+#include <concretelang/Support/LLVMEmitFile.h>
 #include <concretelang/Support/Utils.h>
 
 namespace mlir {
@@ -129,12 +141,9 @@ static void packFunctionArguments(llvm::Module *module) {
   }
 }
 
-llvm::Error emitObject(llvm::Module &module, string objectPath) {
-  auto targetMachine = getTargetMachineAndSetupModule(&module);
-  if (!targetMachine) {
-    return StreamStringError("No default target machine for object generation");
-  }
-
+static llvm::Error emitModuleObject(llvm::Module &module,
+                                    llvm::TargetMachine &targetMachine,
+                                    string objectPath) {
   string Error;
   std::unique_ptr<llvm::ToolOutputFile> objectFile =
       mlir::openOutputFile(objectPath, &Error);
@@ -142,15 +151,12 @@ llvm::Error emitObject(llvm::Module &module, string objectPath) {
     return StreamStringError("Cannot create/open " + objectPath);
   }
 
-  packFunctionArguments(&module);
-
   // The legacy PassManager is mandatory for final code generation.
   // https://llvm.org/docs/NewPassManager.html#status-of-the-new-and-legacy-pass-managers
   llvm::legacy::PassManager pm;
   auto FileType = llvm::CGFT_ObjectFile;
-  targetMachine->setOptLevel(llvm::CodeGenOpt::Level::Aggressive);
-  if (targetMachine->addPassesToEmitFile(pm, objectFile->os(), nullptr,
-                                         FileType, false)) {
+  if (targetMachine.addPassesToEmitFile(pm, objectFile->os(), nullptr,
+                                        FileType, false)) {
     return StreamStringError("TheTargetMachine can't emit object file");
   }
 
@@ -162,6 +168,236 @@ llvm::Error emitObject(llvm::Module &module, string objectPath) {
   return llvm::Error::success();
 }
 
+/// Splits `module` in one module per function defined with an external
+/// linkage. The definitions with a local linkage are cloned in every module,
+/// and the other global variables are defined in the first one. Returns no
+/// modules if `module` has local mutable globals, which can't be duplicated.
+static vector<std::unique_ptr<llvm::Module>>
+splitPerFunction(llvm::Module &module) {
+  vector<std::unique_ptr<llvm::Module>> parts;
+  for (auto &global : module.globals()) {
+    if (global.hasLocalLinkage() && !global.isConstant()) {
+      return parts;
+    }
+  }
+  for (auto &func : module.functions()) {
+    if (func.isDeclaration() || func.hasLocalLinkage()) {
+      continue;
+    }
+    bool first = parts.empty();
+    llvm::ValueToValueMapTy valueMap;
+    auto part = llvm::CloneModule(
+        module, valueMap, [&](const llvm::GlobalValue *global) {
+          if (global->hasLocalLinkage())
+            return true;
+          if (llvm::isa<llvm::Function>(global))
+            return global == &func;
+          return first;
+        });
+    // Keeps the key of an unchanged function independent of the module path
+    part->setModuleIdentifier("");
+    part->setSourceFileName("");
+    parts.push_back(std::move(part));
+  }
+  return parts;
+}
+
+/// Returns the key of the object of `module` emitted by `targetMachine`.
+static string objectCacheKey(llvm::Module &module,
+                             llvm::TargetMachine &targetMachine) {
+  string ir;
+  llvm::raw_string_ostream os(ir);
+  os << targetMachine.getTargetTriple().str() << " "
+     << targetMachine.getTargetCPU() << " "
+     << targetMachine.getTargetFeatureString() << " "
+     << (int)targetMachine.getOptLevel() << "\n";
+  module.print(os, nullptr);
+  os.flush();
+  return llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(ir)),
+                     /*LowerCase=*/true);
+}
+
+/// Compiles `modules` in parallel on `threads` threads, each one in its own
+/// LLVM context.
+static llvm::Error
+emitModuleObjectsInParallel(vector<llvm::Module *> modules,
+                            vector<string> objectsPath,
+                            llvm::CodeGenOpt::Level optLevel,
+                            unsigned threads) {
+  // Modules of a same context can't be compiled concurrently, they are
+  // moved to the contexts of the threads through their bitcode.
+  vector<llvm::SmallVector<char, 0>> bitcodes(modules.size());
+  for (size_t i = 0; i < modules.size(); i++) {
+    llvm::raw_svector_ostream os(bitcodes[i]);
+    llvm::WriteBitcodeToFile(*modules[i], os);
+  }
+  vector<string> errors(modules.size());
+  llvm::ThreadPool pool(llvm::hardware_concurrency(threads));
+  for (size_t i = 0; i < modules.size(); i++) {
+    pool.async([&, i]() {
+      llvm::LLVMContext context;
+      llvm::StringRef bitcode(bitcodes[i].data(), bitcodes[i].size());
+      auto module =
+          llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, ""), context);
+      if (!module) {
+        errors[i] = llvm::toString(module.takeError());
+        return;
+      }
+      auto targetMachine = getTargetMachineAndSetupModule(module->get());
+      if (!targetMachine) {
+        errors[i] = "No default target machine for object generation";
+        return;
+      }
+      targetMachine->setOptLevel(optLevel);
+      if (auto error =
+              emitModuleObject(**module, *targetMachine, objectsPath[i])) {
+        errors[i] = llvm::toString(std::move(error));
+      }
+    });
+  }
+  pool.wait();
+  for (auto &error : errors) {
+    if (!error.empty()) {
+      return StreamStringError(error);
+    }
+  }
+  return llvm::Error::success();
+}
+
+/// Compiles `modules`, on `threads` threads if it is not 1.
+static llvm::Error emitModuleObjects(vector<llvm::Module *> modules,
+                                     vector<string> objectsPath,
+                                     llvm::TargetMachine &targetMachine,
+                                     unsigned threads) {
+  if (threads != 1 && modules.size() > 1) {
+    return emitModuleObjectsInParallel(
+        modules, objectsPath, targetMachine.getOptLevel(), threads);
+  }
+  for (size_t i = 0; i < modules.size(); i++) {
+    if (auto error =
+            emitModuleObject(*modules[i], targetMachine, objectsPath[i])) {
+      return error;
+    }
+  }
+  return llvm::Error::success();
+}
+
+/// Emits the object of `module` as the relocatable link of the objects of its
+/// functions. They are compiled on `options.codegenThreads` threads, or taken
+/// from `options.cacheDir` when they are unchanged.
+static llvm::Error emitSplitObject(llvm::Module &module,
+                                   llvm::TargetMachine &targetMachine,
+                                   string objectPath,
+                                   const EmitObjectOptions &options) {
+  bool useCache = !options.cacheDir.empty();
+  if (useCache) {
+    if (auto error = llvm::sys::fs::create_directories(options.cacheDir)) {
+      return StreamStringError("Cannot create the object cache directory ")
+             << options.cacheDir << ": " << error.message();
+    }
+  }
+  auto parts = splitPerFunction(module);
+  vector<llvm::Module *> modules;
+  for (auto &part : parts) {
+    modules.push_back(part.get());
+  }
+  if (modules.empty()) {
+    modules.push_back(&module);
+  }
+
+  // The objects of the functions, and the ones to compile in their final or
+  // temporary path
+  vector<string> partObjectsPath, cachedObjectsPath;
+  vector<llvm::Module *> missingModules;
+  vector<string> missingObjectsPath;
+  for (auto part : modules) {
+    string partPath;
+    if (useCache) {
+      llvm::SmallString<128> cachedPath(options.cacheDir);
+      llvm::sys::path::append(cachedPath,
+                              objectCacheKey(*part, targetMachine) + ".o");
+      partPath = cachedPath.str().str();
+    } else {
+      partPath = objectPath + ".part-" +
+                 std::to_string(partObjectsPath.size()) + ".o";
+    }
+    partObjectsPath.push_back(partPath);
+    if (useCache && llvm::sys::fs::exists(partPath)) {
+      continue;
+    }
+    string emittedPath = partPath;
+    if (useCache) {
+      // Emitted aside then renamed, so that concurrent compilations sharing
+      // the cache never link a partial object.
+      llvm::SmallString<128> tmpPath;
+      llvm::sys::fs::createUniquePath(partPath + "-%%%%%%.tmp", tmpPath,
+                                      /*MakeAbsolute=*/false);
+      emittedPath = tmpPath.str().str();
+      cachedObjectsPath.push_back(partPath);
+    }
+    missingModules.push_back(part);
+    missingObjectsPath.push_back(emittedPath);
+  }
+
+  if (auto error = emitModuleObjects(missingModules, missingObjectsPath,
+                                     targetMachine, options.codegenThreads)) {
+    for (auto &path : missingObjectsPath) {
+      llvm::sys::fs::remove(path);
+    }
+    return error;
+  }
+  for (size_t i = 0; i < cachedObjectsPath.size(); i++) {
+    if (auto error = llvm::sys::fs::rename(missingObjectsPath[i],
+                                           cachedObjectsPath[i])) {
+      llvm::sys::fs::remove(missingObjectsPath[i]);
+      return StreamStringError("Cannot add ")
+             << cachedObjectsPath[i] << " to the object cache: "
+             << error.message();
+    }
+  }
+
+  auto linked = emitLibrary(partObjectsPath, objectPath, "ld -r -o ");
+  if (!useCache) {
+    for (auto &path : partObjectsPath) {
+      llvm::sys::fs::remove(path);
+    }
+  }
+  return linked;
+}
+
+/// Marks the functions of `module` with more than `maxOptimizedSize`
+/// instructions to be compiled without optimization.
+static void disableOptimizationOfLargeFunctions(llvm::Module &module,
+                                                uint64_t maxOptimizedSize) {
+  for (auto &func : module.functions()) {
+    if (func.isDeclaration() || func.getInstructionCount() <= maxOptimizedSize)
+      continue;
+    func.removeFnAttr(llvm::Attribute::AlwaysInline);
+    func.addFnAttr(llvm::Attribute::NoInline);
+    func.addFnAttr(llvm::Attribute::OptimizeNone);
+  }
+}
+
+llvm::Error emitObject(llvm::Module &module, string objectPath,
+                       const EmitObjectOptions &options) {
+  auto targetMachine = getTargetMachineAndSetupModule(&module);
+  if (!targetMachine) {
+    return StreamStringError("No default target machine for object generation");
+  }
+  targetMachine->setOptLevel(llvm::CodeGenOpt::Level::Aggressive);
+
+  packFunctionArguments(&module);
+
+  if (options.maxOptimizedSize != 0) {
+    disableOptimizationOfLargeFunctions(module, options.maxOptimizedSize);
+  }
+
+  if (!options.cacheDir.empty() || options.codegenThreads != 1) {
+    return emitSplitObject(module, *targetMachine, objectPath, options);
+  }
+  return emitModuleObject(module, *targetMachine, objectPath);
+}
+
 string linkerCmd(vector<string> objectsPath, string libraryPath, string linker,
                  std::optional<vector<string>> extraArgs) {
   string cmd = linker + libraryPath;
@@ -12,7 +12,12 @@
 #include "mlir/Dialect/Bufferization/Transforms/Passes.h"
 #include "mlir/Dialect/Func/Transforms/Passes.h"
 #include "mlir/Transforms/Passes.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Linker/Linker.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Transforms/IPO/Internalize.h"
 
 #include "mlir/Dialect/Affine/Passes.h"
 #include "mlir/Dialect/Arith/Transforms/Passes.h"
@@ -36,15 +41,22 @@
 #include "concretelang/Dialect/Concrete/Transforms/Passes.h"
 #include "concretelang/Dialect/FHE/Analysis/ConcreteOptimizer.h"
 #include "concretelang/Dialect/FHE/Analysis/MANP.h"
+#include "concretelang/Dialect/FHE/Transforms/AutoRounding/AutoRounding.h"
+#include "concretelang/Dialect/FHE/Transforms/RoundToTLU/RoundToTLU.h"
 #include "concretelang/Dialect/FHE/Transforms/BigInt/BigInt.h"
 #include "concretelang/Dialect/FHE/Transforms/Boolean/Boolean.h"
 #include "concretelang/Dialect/FHE/Transforms/DynamicTLU/DynamicTLU.h"
 #include "concretelang/Dialect/FHE/Transforms/EncryptedMulToDoubleTLU/EncryptedMulToDoubleTLU.h"
+#include "concretelang/Dialect/FHE/Transforms/ManyLut/ManyLut.h"
 #include "concretelang/Dialect/FHE/Transforms/Max/Max.h"
 #include "concretelang/Dialect/FHE/Transforms/Optimizer/Optimizer.h"
+#include "concretelang/Dialect/FHELinalg/Transforms/EncryptedMulBatching.h"
+#include "concretelang/Dialect/FHELinalg/Transforms/MatMulSquares.h"
 #include "concretelang/Dialect/FHELinalg/Transforms/Tiling.h"
+#include "concretelang/Dialect/FHELinalg/Transforms/TluFusion.h"
 #include "concretelang/Dialect/RT/Analysis/Autopar.h"
 #include "concretelang/Dialect/TFHE/Analysis/ExtractStatistics.h"
+#include "concretelang/Dialect/TFHE/Analysis/NoiseAnalysis.h"
 #include "concretelang/Dialect/TFHE/Transforms/Transforms.h"
 #include "concretelang/Support/CompilerEngine.h"
 #include "concretelang/Support/Error.h"
@@ -175,12 +187,21 @@ mlir::LogicalResult materializeOptimizerPartitionFrontiers(
 }
 
 mlir::LogicalResult autopar(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                            double circuitComplexity, double taskComplexity,
                             std::function<bool(mlir::Pass *)> enablePass) {
   mlir::PassManager pm(&context);
   pipelinePrinting("AutoPar", pm, context);
 
   addPotentiallyNestedPass(
       pm, mlir::concretelang::createBuildDataflowTaskGraphPass(), enablePass);
+  if (taskComplexity > 0)
+    addPotentiallyNestedPass(
+        pm,
+        mlir::concretelang::createCoarsenDataflowTasksPass(circuitComplexity,
+                                                           taskComplexity),
+        enablePass);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createFuseDataflowTaskChainsPass(), enablePass);
   addPotentiallyNestedPass(
       pm, mlir::concretelang::createLowerDataflowTasksPass(), enablePass);
 
@@ -202,6 +223,33 @@ tileMarkedLinalg(mlir::MLIRContext &context, mlir::ModuleOp &module,
   return pm.run(module.getOperation());
 }
 
+mlir::LogicalResult
+streamLinalgLayers(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   int64_t tileSize,
+                   std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("StreamLinalgLayers", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createLinalgLayerStreamingPass(tileSize),
+      enablePass);
+
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+markLinalgForTaskTiling(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                        double taskCost, int64_t workers,
+                        std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("MarkLinalgForTaskTiling", pm, context);
+  addPotentiallyNestedPass(
+      pm,
+      mlir::concretelang::createLinalgTaskTilingMarkerPass(taskCost, workers),
+      enablePass);
+
+  return pm.run(module.getOperation());
+}
+
 mlir::LogicalResult
 markFHELinalgForTiling(mlir::MLIRContext &context, mlir::ModuleOp &module,
                        llvm::ArrayRef<int64_t> tileSizes,
@@ -214,6 +262,20 @@ markFHELinalgForTiling(mlir::MLIRContext &context, mlir::ModuleOp &module,
   return pm.run(module.getOperation());
 }
 
+mlir::LogicalResult
+markFHELinalgForCacheBlocking(mlir::MLIRContext &context,
+                              mlir::ModuleOp &module, int64_t cacheSize,
+                              int64_t ciphertextSize,
+                              std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("MarkFHELinalgForCacheBlocking", pm, context);
+  addPotentiallyNestedPass(
+      pm, createFHELinalgTilingMarkerPass(cacheSize, ciphertextSize),
+      enablePass);
+
+  return pm.run(module.getOperation());
+}
+
 mlir::LogicalResult
 transformHighLevelFHEOps(mlir::MLIRContext &context, mlir::ModuleOp &module,
                          std::function<bool(mlir::Pass *)> enablePass) {
@@ -229,11 +291,16 @@ transformHighLevelFHEOps(mlir::MLIRContext &context, mlir::ModuleOp &module,
 
 mlir::LogicalResult
 lowerFHELinalgToLinalg(mlir::MLIRContext &context, mlir::ModuleOp &module,
-                       std::function<bool(mlir::Pass *)> enablePass) {
+                       std::function<bool(mlir::Pass *)> enablePass,
+                       int64_t treeReductionMinSize, bool conv2dIm2col,
+                       bool sparseMatmul) {
   mlir::PassManager pm(&context);
   pipelinePrinting("FHELinalgToLinalg", pm, context);
   addPotentiallyNestedPass(
-      pm, mlir::concretelang::createConvertFHETensorOpsToLinalg(), enablePass);
+      pm,
+      mlir::concretelang::createConvertFHETensorOpsToLinalg(
+          treeReductionMinSize, conv2dIm2col, sparseMatmul),
+      enablePass);
   addPotentiallyNestedPass(pm, mlir::createLinalgGeneralizationPass(),
                            enablePass);
   return pm.run(module.getOperation());
@@ -265,14 +332,81 @@ transformFHEBoolean(mlir::MLIRContext &context, mlir::ModuleOp &module,
 }
 
 mlir::LogicalResult
-transformFHEBigInt(mlir::MLIRContext &context, mlir::ModuleOp &module,
-                   std::function<bool(mlir::Pass *)> enablePass,
-                   unsigned int chunkSize, unsigned int chunkWidth) {
+shareMatMulSquares(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   std::function<bool(mlir::Pass *)> enablePass) {
   mlir::PassManager pm(&context);
+  pipelinePrinting("ShareMatMulSquares", pm, context);
   addPotentiallyNestedPass(
-      pm,
-      mlir::concretelang::createFHEBigIntTransformPass(chunkSize, chunkWidth),
+      pm, mlir::concretelang::createFHELinalgMatMulSquaresPass(), enablePass);
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+batchEncryptedMuls(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("BatchEncryptedMuls", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createFHELinalgEncryptedMulBatchingPass(),
+      enablePass);
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+fuseTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                 bool report, std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("FuseTableLookups", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createFHELinalgTluFusionPass(report),
+      enablePass);
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+autoRoundTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      uint64_t maxError,
+                      std::function<double(unsigned)> tluCost,
+                      std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("AutoRoundTableLookups", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createFHEAutoRoundingPass(maxError, tluCost),
       enablePass);
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+roundWithTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      std::function<double(unsigned)> tluCost,
+                      std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("RoundWithTableLookups", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createFHERoundToTLUPass(tluCost), enablePass);
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+packTableLookups(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                 std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("PackTableLookups", pm, context);
+  addPotentiallyNestedPass(pm, mlir::concretelang::createFHEManyLutPass(),
+                           enablePass);
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+transformFHEBigInt(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                   std::function<bool(mlir::Pass *)> enablePass,
+                   unsigned int chunkSize, unsigned int chunkWidth,
+                   unsigned int carryLookaheadMinChunks) {
+  mlir::PassManager pm(&context);
+  addPotentiallyNestedPass(pm,
+                           mlir::concretelang::createFHEBigIntTransformPass(
+                               chunkSize, chunkWidth, carryLookaheadMinChunks),
+                           enablePass);
   // We want to fully unroll for loops introduced by the BigInt transform since
   // MANP doesn't support loops. This is a workaround that make the IR much
   // bigger than it should be
@@ -359,6 +493,24 @@ mlir::LogicalResult batchTFHE(mlir::MLIRContext &context,
 
   addPotentiallyNestedPass(
       pm, mlir::concretelang::createBatchingPass(maxBatchSize), enablePass);
+  // The operations left out of loop nests, e.g. in unrolled circuits
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createTFHEStraightLineBatchingPass(maxBatchSize),
+      enablePass);
+
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+scheduleTFHEForMemory(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      std::function<bool(mlir::Pass *)> enablePass,
+                      int64_t maxLiveBytes) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("TFHEMemoryScheduling", pm, context);
+
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createTFHEMemorySchedulingPass(maxLiveBytes),
+      enablePass);
 
   return pm.run(module.getOperation());
 }
@@ -389,6 +541,24 @@ extractTFHEStatistics(mlir::MLIRContext &context, mlir::ModuleOp &module,
   return pm.run(module.getOperation());
 }
 
+mlir::LogicalResult
+analyzeTFHENoise(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                 std::function<bool(mlir::Pass *)> enablePass,
+                 ProgramCompilationFeedback &feedback,
+                 const Message<concreteprotocol::ProgramInfo> &programInfo,
+                 uint32_t fftPrecision) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("TFHENoiseAnalysis", pm, context);
+
+  addPotentiallyNestedPass(
+      pm,
+      mlir::concretelang::createNoiseAnalysisPass(feedback, programInfo,
+                                                  fftPrecision),
+      enablePass);
+
+  return pm.run(module.getOperation());
+}
+
 mlir::LogicalResult
 lowerTFHEToConcrete(mlir::MLIRContext &context, mlir::ModuleOp &module,
                     std::function<bool(mlir::Pass *)> enablePass) {
@@ -425,6 +595,50 @@ mlir::LogicalResult optimizeTFHE(mlir::MLIRContext &context,
   return pm.run(module.getOperation());
 }
 
+mlir::LogicalResult
+shareTFHEKeyswitches(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                     std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("TFHEKeyswitchSharing", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createTFHEKeyswitchSharingPass(), enablePass);
+
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+shareTFHEWopPBS(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("TFHEWopPBSSharing", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createTFHEWopPBSSharingPass(), enablePass);
+
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+encodeTFHEConstantLuts(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                       std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("TFHEConstantLutEncoding", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createTFHEConstantLutEncodingPass(), enablePass);
+
+  return pm.run(module.getOperation());
+}
+
+mlir::LogicalResult
+hoistTFHELutEncodings(mlir::MLIRContext &context, mlir::ModuleOp &module,
+                      std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("TFHELutEncodingHoisting", pm, context);
+  addPotentiallyNestedPass(
+      pm, mlir::concretelang::createTFHELutEncodingHoistingPass(), enablePass);
+
+  return pm.run(module.getOperation());
+}
+
 mlir::LogicalResult simulateTFHE(mlir::MLIRContext &context,
                                  mlir::ModuleOp &module,
                                  std::function<bool(mlir::Pass *)> enablePass) {
@@ -439,11 +653,12 @@ mlir::LogicalResult simulateTFHE(mlir::MLIRContext &context,
 mlir::LogicalResult extractSDFGOps(mlir::MLIRContext &context,
                                    mlir::ModuleOp &module,
                                    std::function<bool(mlir::Pass *)> enablePass,
-                                   bool unroll) {
+                                   bool unroll, int64_t maxUnrolledOps) {
   mlir::PassManager pm(&context);
   pipelinePrinting("extract SDFG ops from Concrete", pm, context);
   addPotentiallyNestedPass(
-      pm, mlir::concretelang::createExtractSDFGOpsPass(unroll), enablePass);
+      pm, mlir::concretelang::createExtractSDFGOpsPass(unroll, maxUnrolledOps),
+      enablePass);
   LogicalResult res = pm.run(module.getOperation());
 
   return res;
@@ -519,9 +734,12 @@ mlir::LogicalResult lowerToStd(mlir::MLIRContext &context,
                              enablePass);
   }
 
-  if (parallelizeLoops)
+  if (parallelizeLoops) {
     addPotentiallyNestedPass(pm, mlir::createConvertSCFToOpenMPPass(),
                              enablePass);
+    addPotentiallyNestedPass(
+        pm, mlir::concretelang::createOpenMPLoopSchedulePass(), enablePass);
+  }
   // Lower affine
   addPotentiallyNestedPass(pm, mlir::createLowerAffinePass(), enablePass);
 
@@ -541,15 +759,30 @@ mlir::LogicalResult lowerToStd(mlir::MLIRContext &context,
   return pm.run(module);
 }
 
+mlir::LogicalResult reuseBuffers(mlir::MLIRContext &context,
+                                 mlir::ModuleOp &module,
+                                 std::function<bool(mlir::Pass *)> enablePass) {
+  mlir::PassManager pm(&context);
+  pipelinePrinting("BufferReuse", pm, context);
+  addPotentiallyNestedPass(pm, mlir::concretelang::createBufferReusePass(),
+                           enablePass);
+
+  return pm.run(module);
+}
+
 mlir::LogicalResult lowerToCAPI(mlir::MLIRContext &context,
                                 mlir::ModuleOp &module,
                                 std::function<bool(mlir::Pass *)> enablePass,
-                                bool gpu) {
+                                bool gpu, bool inlineLeveledOps,
+                                int64_t pipelineChunkSize) {
   mlir::PassManager pm(&context);
   pipelinePrinting("Lowering to CAPI", pm, context);
 
   addPotentiallyNestedPass(
-      pm, mlir::concretelang::createConvertConcreteToCAPIPass(gpu), enablePass);
+      pm,
+      mlir::concretelang::createConvertConcreteToCAPIPass(
+          gpu, inlineLeveledOps, pipelineChunkSize),
+      enablePass);
   addPotentiallyNestedPass(
       pm, mlir::concretelang::createConvertTracingToCAPIPass(), enablePass);
 
@@ -582,6 +815,87 @@ lowerLLVMDialectToLLVMIR(mlir::MLIRContext &context,
   return mlir::translateModuleToLLVMIR(module, llvmContext);
 }
 
+namespace {
+using FunctionSet = llvm::SmallPtrSetImpl<const llvm::Function *>;
+
+/// Whether `value` refers to a mutable global, directly or through a constant
+/// or a function in `stateful`.
+bool refersToState(const llvm::Value *value, const FunctionSet &stateful,
+                   llvm::SmallPtrSetImpl<const llvm::Value *> &visited) {
+  if (!visited.insert(value).second)
+    return false;
+  if (auto function = llvm::dyn_cast<llvm::Function>(value))
+    return stateful.count(function) != 0;
+  if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(value)) {
+    return !global->isConstant() ||
+           (global->hasInitializer() &&
+            refersToState(global->getInitializer(), stateful, visited));
+  }
+  if (auto constant = llvm::dyn_cast<llvm::Constant>(value)) {
+    for (auto &operand : constant->operands()) {
+      if (refersToState(operand, stateful, visited))
+        return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+llvm::Error linkRuntimeBitcode(llvm::Module &module,
+                               const std::string &bitcodePath) {
+  llvm::SMDiagnostic diagnostic;
+  std::unique_ptr<llvm::Module> runtime =
+      llvm::parseIRFile(bitcodePath, diagnostic, module.getContext());
+  if (!runtime) {
+    return StreamStringError("Cannot read the runtime bitcode ")
+           << bitcodePath << ": " << diagnostic.getMessage().str();
+  }
+
+  // A copy of the counters or caches of the runtime in the circuit would
+  // diverge from the ones of the library, so the functions using them, and
+  // their callers, are only declared
+  llvm::SmallPtrSet<const llvm::Function *, 16> stateful;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto &function : *runtime) {
+      if (function.isDeclaration() || stateful.count(&function))
+        continue;
+      llvm::SmallPtrSet<const llvm::Value *, 16> visited;
+      for (auto &instruction : llvm::instructions(function)) {
+        bool usesState = llvm::any_of(
+            instruction.operands(), [&](const llvm::Use &operand) {
+              return llvm::isa<llvm::Constant>(operand) &&
+                     refersToState(operand, stateful, visited);
+            });
+        if (usesState) {
+          stateful.insert(&function);
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+  for (auto &function : *runtime) {
+    if (stateful.count(&function) && !function.hasLocalLinkage())
+      function.deleteBody();
+  }
+
+  runtime->setDataLayout(module.getDataLayout());
+  runtime->setTargetTriple(module.getTargetTriple());
+  bool failed = llvm::Linker::linkModules(
+      module, std::move(runtime), llvm::Linker::Flags::LinkOnlyNeeded,
+      [](llvm::Module &module, const llvm::StringSet<> &linked) {
+        llvm::internalizeModule(module, [&](const llvm::GlobalValue &value) {
+          return !linked.contains(value.getName());
+        });
+      });
+  if (failed) {
+    return StreamStringError("Cannot link the runtime bitcode ")
+           << bitcodePath;
+  }
+  return llvm::Error::success();
+}
+
 mlir::LogicalResult optimizeLLVMModule(llvm::LLVMContext &llvmContext,
                                        llvm::Module &module) {
   // -O3 is done LLVMEmitFile.cpp
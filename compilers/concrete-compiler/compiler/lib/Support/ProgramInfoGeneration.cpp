@@ -4,6 +4,7 @@
 // for license information.
 
 #include <cassert>
+#include <cmath>
 #include <map>
 #include <memory>
 #include <optional>
@@ -44,6 +45,37 @@ namespace concretelang {
 const auto keyFormat = concrete::BINARY;
 typedef double Variance;
 
+/// Returns the log2 of the modulus the coefficients of an output ciphertext
+/// carrying `messageBits` bits can be switched to, or 0 if it would not be
+/// smaller than the native one.
+///
+/// Rounding each coefficient adds an error uniform on one step of the new
+/// modulus, summed over the mask by the binary secret key. This error is kept
+/// 2^10 times smaller than the distance to the decoding boundaries, so that
+/// it leaves the error probability of the circuit unchanged.
+uint32_t getCompressedModulusLog(uint32_t messageBits, uint64_t lweDimension) {
+  // The deviation of the rounding error, in steps of the new modulus
+  double deviation = std::sqrt((lweDimension / 2.0 + 1) / 12);
+  uint32_t modulusLog =
+      messageBits + 1 + 10 + (uint32_t)std::ceil(std::log2(deviation));
+  return modulusLog < 64 ? modulusLog : 0;
+}
+
+/// Returns the number of words of a ciphertext of `lweSize` coefficients
+/// compressed as described by `compression` and `modulusLog`.
+size_t getCompressedCiphertextSize(size_t lweSize,
+                                   concreteprotocol::Compression compression,
+                                   uint32_t modulusLog) {
+  switch (compression) {
+  case concreteprotocol::Compression::SEED:
+    return 3;
+  case concreteprotocol::Compression::MODULUS_SWITCH:
+    return (lweSize * modulusLog + 63) / 64;
+  default:
+    return lweSize;
+  }
+}
+
 llvm::Expected<Message<concreteprotocol::GateInfo>>
 generateGate(mlir::Type inputType,
              const Message<concreteprotocol::EncodingInfo> &inputEncodingInfo,
@@ -96,11 +128,21 @@ generateGate(mlir::Type inputType,
                              .getModuli()
                              .size());
     }
-    auto ciphertextSize = normKey.dimension + 1;
-    if (compression == concreteprotocol::Compression::SEED) {
-      ciphertextSize = 3;
+    uint32_t modulusLog = 0;
+    if (compression == concreteprotocol::Compression::MODULUS_SWITCH) {
+      // Only the native mode has a single message to keep per ciphertext
+      if (inputEncoding.getIntegerCiphertext().getMode().hasNative()) {
+        modulusLog = getCompressedModulusLog(
+            inputEncoding.getIntegerCiphertext().getWidth() + 1,
+            normKey.dimension);
+      }
+      if (modulusLog == 0) {
+        compression = concreteprotocol::Compression::NONE;
+      }
     }
-    gateDimensions.set(gateDimensionsSize - 1, ciphertextSize);
+    gateDimensions.set(gateDimensionsSize - 1,
+                       getCompressedCiphertextSize(
+                           normKey.dimension + 1, compression, modulusLog));
     lweCiphertextGateInfo.setIntegerPrecision(64);
     auto encryptionInfo = lweCiphertextGateInfo.initEncryption();
     encryptionInfo.setKeyId(normKey.index);
@@ -108,6 +150,7 @@ generateGate(mlir::Type inputType,
     encryptionInfo.setLweDimension(normKey.dimension);
     encryptionInfo.initModulus().initMod().initNative();
     lweCiphertextGateInfo.setCompression(compression);
+    lweCiphertextGateInfo.setCompressedModulusLog(modulusLog);
     lweCiphertextGateInfo.initEncoding().setInteger(
         inputEncoding.getIntegerCiphertext());
     auto rawInfo = output.asBuilder().initRawInfo();
@@ -129,11 +172,17 @@ generateGate(mlir::Type inputType,
     for (size_t i = 0; i < encodingDimensions.size(); i++) {
       gateDimensions.set(i, encodingDimensions[i]);
     }
-    auto ciphertextSize = normKey.dimension + 1;
-    if (compression == concreteprotocol::Compression::SEED) {
-      ciphertextSize = 3;
+    uint32_t modulusLog = 0;
+    if (compression == concreteprotocol::Compression::MODULUS_SWITCH) {
+      // The boolean is decoded from the 3 most significant bits
+      modulusLog = getCompressedModulusLog(3, normKey.dimension);
+      if (modulusLog == 0) {
+        compression = concreteprotocol::Compression::NONE;
+      }
     }
-    gateDimensions.set(gateDimensionsSize - 1, ciphertextSize);
+    gateDimensions.set(gateDimensionsSize - 1,
+                       getCompressedCiphertextSize(
+                           normKey.dimension + 1, compression, modulusLog));
     lweCiphertextGateInfo.setIntegerPrecision(64);
     auto encryptionInfo = lweCiphertextGateInfo.initEncryption();
     encryptionInfo.setKeyId(normKey.index);
@@ -141,6 +190,7 @@ generateGate(mlir::Type inputType,
     encryptionInfo.setLweDimension(normKey.dimension);
     encryptionInfo.initModulus().initMod().initNative();
     lweCiphertextGateInfo.setCompression(compression);
+    lweCiphertextGateInfo.setCompressedModulusLog(modulusLog);
     lweCiphertextGateInfo.initEncoding().initBoolean();
 
     auto rawInfo = output.asBuilder().initRawInfo();
@@ -181,7 +231,8 @@ generateGate(mlir::Type inputType,
 
 Message<concreteprotocol::KeysetInfo>
 extractKeysetInfo(TFHE::TFHECircuitKeys circuitKeys,
-                  concrete::SecurityCurve curve, bool compressEvaluationKeys) {
+                  concrete::SecurityCurve curve, bool compressEvaluationKeys,
+                  uint32_t bootstrapGroupingFactor) {
 
   auto output = Message<concreteprotocol::KeysetInfo>();
 
@@ -210,7 +261,8 @@ extractKeysetInfo(TFHE::TFHECircuitKeys circuitKeys,
         ksk.getInputKey().getNormalized().value().index);
     infoMessage.asBuilder().setOutputId(
         ksk.getOutputKey().getNormalized().value().index);
-    if (!compressEvaluationKeys) {
+    // The fast keyswitch keys cannot be seeded
+    if (!compressEvaluationKeys || ksk.getFastPolySize() > 0) {
       infoMessage.asBuilder().setCompression(
           concreteprotocol::Compression::NONE);
     } else {
@@ -220,8 +272,16 @@ extractKeysetInfo(TFHE::TFHECircuitKeys circuitKeys,
     auto paramsBuilder = infoMessage.asBuilder().initParams();
     paramsBuilder.setLevelCount(ksk.getLevels());
     paramsBuilder.setBaseLog(ksk.getBaseLog());
-    paramsBuilder.setVariance(curve.getVariance(
-        1, ksk.getOutputKey().getNormalized().value().dimension, 64));
+    auto outputDimension = ksk.getOutputKey().getNormalized().value().dimension;
+    if (ksk.getFastPolySize() > 0) {
+      // The fast keyswitch keys are glwe encryptions under the output key
+      paramsBuilder.setOutputPolynomialSize(ksk.getFastPolySize());
+      paramsBuilder.setVariance(
+          curve.getVariance(outputDimension / ksk.getFastPolySize(),
+                            ksk.getFastPolySize(), 64));
+    } else {
+      paramsBuilder.setVariance(curve.getVariance(1, outputDimension, 64));
+    }
     paramsBuilder.setIntegerPrecision(64);
     paramsBuilder.setInputLweDimension(
         ksk.getInputKey().getNormalized().value().dimension);
@@ -243,7 +303,8 @@ extractKeysetInfo(TFHE::TFHECircuitKeys circuitKeys,
         bsk.getInputKey().getNormalized().value().index);
     infoMessage.asBuilder().setOutputId(
         bsk.getOutputKey().getNormalized().value().index);
-    if (!compressEvaluationKeys) {
+    // The multi-bit bootstrap keys cannot be seeded
+    if (!compressEvaluationKeys || bootstrapGroupingFactor > 1) {
       infoMessage.asBuilder().setCompression(
           concreteprotocol::Compression::NONE);
     } else {
@@ -251,6 +312,8 @@ extractKeysetInfo(TFHE::TFHECircuitKeys circuitKeys,
           concreteprotocol::Compression::SEED);
     }
     auto paramsBuilder = infoMessage.asBuilder().initParams();
+    if (bootstrapGroupingFactor > 1)
+      paramsBuilder.setGroupingFactor(bootstrapGroupingFactor);
     paramsBuilder.setLevelCount(bsk.getLevels());
     paramsBuilder.setBaseLog(bsk.getBaseLog());
     paramsBuilder.setGlweDimension(bsk.getGlweDim());
@@ -307,8 +370,8 @@ extractKeysetInfo(TFHE::TFHECircuitKeys circuitKeys,
 llvm::Expected<Message<concreteprotocol::CircuitInfo>>
 extractCircuitInfo(mlir::func::FuncOp funcOp,
                    concreteprotocol::CircuitEncodingInfo::Reader encodings,
-                   concrete::SecurityCurve curve,
-                   bool compressInputCiphertexts) {
+                   concrete::SecurityCurve curve, bool compressInputCiphertexts,
+                   bool compressOutputCiphertexts) {
 
   auto output = Message<concreteprotocol::CircuitInfo>();
 
@@ -334,7 +397,9 @@ extractCircuitInfo(mlir::func::FuncOp funcOp,
   for (unsigned int i = 0; i < funcType.getNumResults(); i++) {
     auto ty = funcType.getResult(i);
     auto encoding = encodings.getOutputs()[i];
-    auto compression = concreteprotocol::Compression::NONE;
+    auto compression = compressOutputCiphertexts
+                           ? concreteprotocol::Compression::MODULUS_SWITCH
+                           : concreteprotocol::Compression::NONE;
     auto maybeGate = generateGate(ty, encoding, curve, compression);
     if (!maybeGate) {
       return maybeGate.takeError();
@@ -342,13 +407,42 @@ extractCircuitInfo(mlir::func::FuncOp funcOp,
     output.asBuilder().getOutputs().setWithCaveats(i, maybeGate->asReader());
   }
 
+  // The keys are identified by their index in the keyset of the program, see
+  // extractKeysetInfo. Callees are not followed, a circuit calling another
+  // function is assumed to use all the keys of the program.
+  bool hasCalls = funcOp
+                      .walk([](mlir::func::CallOp) {
+                        return mlir::WalkResult::interrupt();
+                      })
+                      .wasInterrupted();
+  auto circuitKeys = TFHE::extractCircuitKeys(
+      hasCalls ? funcOp->getParentOp() : funcOp.getOperation());
+  auto keysBuilder = output.asBuilder().initKeys();
+  auto bootstrapKeysBuilder =
+      keysBuilder.initLweBootstrapKeys(circuitKeys.bootstrapKeys.size());
+  for (size_t i = 0; i < circuitKeys.bootstrapKeys.size(); i++) {
+    bootstrapKeysBuilder.set(i, circuitKeys.bootstrapKeys[i].getIndex());
+  }
+  auto keyswitchKeysBuilder =
+      keysBuilder.initLweKeyswitchKeys(circuitKeys.keyswitchKeys.size());
+  for (size_t i = 0; i < circuitKeys.keyswitchKeys.size(); i++) {
+    keyswitchKeysBuilder.set(i, circuitKeys.keyswitchKeys[i].getIndex());
+  }
+  auto packingKeyswitchKeysBuilder = keysBuilder.initPackingKeyswitchKeys(
+      circuitKeys.packingKeyswitchKeys.size());
+  for (size_t i = 0; i < circuitKeys.packingKeyswitchKeys.size(); i++) {
+    packingKeyswitchKeysBuilder.set(
+        i, circuitKeys.packingKeyswitchKeys[i].getIndex());
+  }
+
   return output;
 }
 
 llvm::Expected<Message<concreteprotocol::ProgramInfo>> extractProgramInfo(
     mlir::ModuleOp module,
     const Message<concreteprotocol::ProgramEncodingInfo> &encodings,
-    concrete::SecurityCurve curve, bool compressInputCiphertexts) {
+    concrete::SecurityCurve curve, bool compressInputCiphertexts,
+    bool compressOutputCiphertexts) {
 
   auto output = Message<concreteprotocol::ProgramInfo>();
   auto circuitsCount = encodings.asReader().getCircuits().size();
@@ -367,8 +461,9 @@ llvm::Expected<Message<concreteprotocol::ProgramInfo>> extractProgramInfo(
              << functionName.cStr();
     }
 
-    auto maybeCircuitInfo = extractCircuitInfo(*funcOp, circuitEncoding, curve,
-                                               compressInputCiphertexts);
+    auto maybeCircuitInfo =
+        extractCircuitInfo(*funcOp, circuitEncoding, curve,
+                           compressInputCiphertexts, compressOutputCiphertexts);
     if (!maybeCircuitInfo) {
       return maybeCircuitInfo.takeError();
     }
@@ -383,7 +478,8 @@ llvm::Expected<Message<concreteprotocol::ProgramInfo>>
 createProgramInfoFromTfheDialect(
     mlir::ModuleOp module, int bitsOfSecurity,
     const Message<concreteprotocol::ProgramEncodingInfo> &encodings,
-    bool compressEvaluationKeys, bool compressInputCiphertexts) {
+    bool compressEvaluationKeys, bool compressInputCiphertexts,
+    bool compressOutputCiphertexts, uint32_t bootstrapGroupingFactor) {
 
   // Check that security curves exist
   const auto curve = concrete::getSecurityCurve(bitsOfSecurity, keyFormat);
@@ -394,7 +490,8 @@ createProgramInfoFromTfheDialect(
 
   // We generate the circuit infos from the module.
   auto maybeProgramInfo =
-      extractProgramInfo(module, encodings, *curve, compressInputCiphertexts);
+      extractProgramInfo(module, encodings, *curve, compressInputCiphertexts,
+                         compressOutputCiphertexts);
   if (!maybeProgramInfo) {
     return maybeProgramInfo.takeError();
   }
@@ -403,8 +500,21 @@ createProgramInfoFromTfheDialect(
   Message<concreteprotocol::ProgramInfo> output = *maybeProgramInfo;
 
   // We extract the keys of the circuit
-  auto keysetInfo = extractKeysetInfo(TFHE::extractCircuitKeys(module), *curve,
-                                      compressEvaluationKeys);
+  auto circuitKeys = TFHE::extractCircuitKeys(module);
+  if (bootstrapGroupingFactor > 1) {
+    for (auto bsk : circuitKeys.bootstrapKeys) {
+      auto inputDimension = bsk.getInputKey().getNormalized().value().dimension;
+      if (inputDimension % bootstrapGroupingFactor != 0) {
+        return StreamStringError("Cannot use a multi-bit bootstrap of grouping "
+                                 "factor ")
+               << bootstrapGroupingFactor << " with an input lwe dimension of "
+               << inputDimension;
+      }
+    }
+  }
+  auto keysetInfo = extractKeysetInfo(circuitKeys, *curve,
+                                      compressEvaluationKeys,
+                                      bootstrapGroupingFactor);
   output.asBuilder().setKeyset(keysetInfo.asReader());
 
   return output;
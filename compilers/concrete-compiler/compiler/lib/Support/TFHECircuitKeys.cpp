@@ -67,7 +67,7 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &OS,
   return OS;
 }
 
-TFHECircuitKeys extractCircuitKeys(mlir::ModuleOp moduleOp) {
+TFHECircuitKeys extractCircuitKeys(mlir::Operation *moduleOp) {
   // Gathering circuit secret keys
   SmallSet<TFHE::GLWESecretKey> secretKeys;
   auto tryInsert = [&](mlir::Type type) {
@@ -119,6 +119,12 @@ TFHECircuitKeys extractCircuitKeys(mlir::ModuleOp moduleOp) {
     secretKeys.insert(op.getKeyAttr().getOutputKey());
   });
 
+  moduleOp->walk([&](TFHE::ManyLutBootstrapGLWEOp op) {
+    bootstrapKeys.insert(op.getKeyAttr());
+    secretKeys.insert(op.getKeyAttr().getInputKey());
+    secretKeys.insert(op.getKeyAttr().getOutputKey());
+  });
+
   // Gathering circuit packing keyswitch keys
   SmallSet<TFHE::GLWEPackingKeyswitchKeyAttr> packingKeyswitchKeys;
   moduleOp->walk([&](TFHE::WopPBSGLWEOp op) {
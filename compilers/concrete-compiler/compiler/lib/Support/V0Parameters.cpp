@@ -36,7 +36,10 @@ concrete_optimizer::Options options_from_config(optimizer::Config config) {
       /* .cache_on_disk = */ config.cache_on_disk,
       /* .ciphertext_modulus_log = */ config.ciphertext_modulus_log,
       /* .fft_precision = */ config.fft_precision,
-      /* .composable = */ config.composable};
+      /* .composable = */ config.composable,
+      /* .maximum_evaluation_keys_size = */
+      config.maximum_evaluation_keys_size,
+      /* .latency_workers = */ config.latency_workers};
   return options;
 }
 
@@ -54,6 +57,11 @@ optimizer::DagSolution getV0Solution(V0FHEConstraint constraint,
   return concrete_optimizer::utils::convert_to_dag_solution(solution);
 }
 
+double getBootstrapComplexity(size_t precision, optimizer::Config config) {
+  V0FHEConstraint constraint{/*.norm2 = */ 0, /*.p = */ precision};
+  return getV0Solution(constraint, config).complexity;
+}
+
 const int MAXIMUM_OPTIMIZER_CALL = 10;
 
 template <typename Solution, typename Optimize>
@@ -352,6 +360,15 @@ getSolution(optimizer::Description &descr, ProgramCompilationFeedback &feedback,
     config.p_error = config.global_p_error;
   }
 
+  // An empty path resets the optimizer to its analytic cost model
+  auto costTableError =
+      concrete_optimizer::utils::load_cost_table(config.cost_table);
+  if (!costTableError.empty()) {
+    return StreamStringError(costTableError.c_str());
+  }
+  // An empty directory disables the solution cache
+  concrete_optimizer::utils::set_solution_cache(config.solution_cache);
+
   // This happens for programs without fhe computation
   if (!descr.dag) {
     if (config.display) {
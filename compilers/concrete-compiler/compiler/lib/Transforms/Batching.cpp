@@ -19,6 +19,7 @@
 
 #include <concretelang/Analysis/StaticLoops.h>
 #include <concretelang/Interfaces/BatchableInterface.h>
+#include <concretelang/Support/Constants.h>
 #include <concretelang/Transforms/Passes.h>
 
 namespace mlir {
@@ -1053,9 +1054,11 @@ public:
     // Find a batchable op which is embedded into a loop nest
     func.walk([&](BatchableOpInterface scalarOp) {
       // Predicate checking whether an scf.for op is a valid candidate
-      // to expand the loop nest upwards towards the outermost loop
+      // to expand the loop nest upwards towards the outermost loop. The
+      // operations of a streamed tile are batched within the tile.
       auto isCandidateLoop = [](mlir::scf::ForOp forOp) -> bool {
-        return isStaticLoop(forOp);
+        return isStaticLoop(forOp) &&
+               !forOp->hasAttr(mlir::concretelang::STREAMING_TILE_LOOP_ATTR);
       };
 
       // Only batchable operations within at least one loop are of
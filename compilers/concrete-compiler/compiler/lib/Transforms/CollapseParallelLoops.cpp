@@ -3,6 +3,8 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include "concretelang/Analysis/StaticLoops.h"
+#include "concretelang/Transforms/LoopCost.h"
 #include "concretelang/Transforms/Passes.h"
 
 #include "mlir/Dialect/Bufferization/Transforms/Bufferize.h"
@@ -16,6 +18,21 @@
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 
 namespace {
+
+/// An outermost loop with this many iterations keeps the threads busy on its
+/// own.
+const int64_t ENOUGH_PARALLEL_ITERATIONS = 256;
+
+/// Returns whether coalescing `band` helps the balance of the threads more
+/// than the delinearization of its induction variables costs.
+bool isWorthCoalescing(llvm::ArrayRef<mlir::scf::ForOp> band) {
+  std::optional<int64_t> outerTripCount =
+      mlir::concretelang::tryGetStaticTripCount(band.front());
+  if (!outerTripCount || *outerTripCount < ENOUGH_PARALLEL_ITERATIONS)
+    return true;
+  return mlir::concretelang::estimateRegionCost(band.back().getRegion()) >= 1;
+}
+
 struct CollapseParallelLoopsPass
     : public CollapseParallelLoopsBase<CollapseParallelLoopsPass> {
 
@@ -80,7 +97,8 @@ struct CollapseParallelLoopsPass
             continue;
 
           auto band = llvm::MutableArrayRef(loops.data() + start, end - start);
-          (void)mlir::coalesceLoops(band);
+          if (isWorthCoalescing(band))
+            (void)mlir::coalesceLoops(band);
           break;
         }
         // If a band was found and transformed, keep looking at the loops above
@@ -3,6 +3,8 @@
 // https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
 // for license information.
 
+#include "concretelang/Analysis/StaticLoops.h"
+#include "concretelang/Transforms/LoopCost.h"
 #include "concretelang/Transforms/Passes.h"
 
 #include "mlir/Dialect/Bufferization/Transforms/Bufferize.h"
@@ -16,8 +18,10 @@
 namespace {
 class ForOpPattern : public mlir::OpRewritePattern<mlir::scf::ForOp> {
 public:
-  ForOpPattern(::mlir::MLIRContext *context, mlir::PatternBenefit benefit = 1)
-      : ::mlir::OpRewritePattern<mlir::scf::ForOp>(context, benefit) {}
+  ForOpPattern(::mlir::MLIRContext *context, double minParallelCost,
+               mlir::PatternBenefit benefit = 1)
+      : ::mlir::OpRewritePattern<mlir::scf::ForOp>(context, benefit),
+        minParallelCost(minParallelCost) {}
 
   mlir::LogicalResult
   matchAndRewrite(mlir::scf::ForOp forOp,
@@ -28,7 +32,7 @@ public:
     }
     assert(forOp.getRegionIterArgs().size() == 0 &&
            "unexpecting iter args when loops are bufferized");
-    if (attr.getValue()) {
+    if (attr.getValue() && isWorthParallelizing(forOp)) {
       rewriter.replaceOpWithNewOp<mlir::scf::ParallelOp>(
           forOp, mlir::ValueRange{forOp.getLowerBound()},
           mlir::ValueRange{forOp.getUpperBound()}, forOp.getStep(),
@@ -59,19 +63,37 @@ public:
 
     return mlir::success();
   }
+
+private:
+  double minParallelCost;
+
+  /// A loop with static bounds is only parallelized if its cost pays for the
+  /// fork and join of the threads.
+  bool isWorthParallelizing(mlir::scf::ForOp forOp) const {
+    std::optional<int64_t> tripCount =
+        mlir::concretelang::tryGetStaticTripCount(forOp);
+    if (!tripCount)
+      return true;
+    double cost = *tripCount * mlir::concretelang::estimateRegionCost(
+                                   forOp.getRegion());
+    return *tripCount > 1 && cost >= minParallelCost;
+  }
 };
 } // namespace
 
 namespace {
 struct ForLoopToParallelPass
     : public ForLoopToParallelBase<ForLoopToParallelPass> {
+  ForLoopToParallelPass(double minParallelCost) {
+    this->minParallelCost = minParallelCost;
+  }
 
   void runOnOperation() override {
     auto func = getOperation();
     auto *context = &getContext();
     mlir::RewritePatternSet patterns(context);
     mlir::ConversionTarget target(*context);
-    patterns.add<ForOpPattern>(context);
+    patterns.add<ForOpPattern>(context, minParallelCost);
     target.addDynamicallyLegalOp<mlir::scf::ForOp>([&](mlir::scf::ForOp op) {
       auto r = op->getAttrOfType<mlir::BoolAttr>("parallel") == nullptr;
       return r;
@@ -87,6 +109,6 @@ struct ForLoopToParallelPass
 } // namespace
 
 std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
-mlir::concretelang::createForLoopToParallel() {
-  return std::make_unique<ForLoopToParallelPass>();
+mlir::concretelang::createForLoopToParallel(double minParallelCost) {
+  return std::make_unique<ForLoopToParallelPass>(minParallelCost);
 }
@@ -0,0 +1,90 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <llvm/ADT/TypeSwitch.h>
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/Dialect/SCF/IR/SCF.h>
+
+#include <concretelang/Analysis/StaticLoops.h>
+#include <concretelang/Dialect/Concrete/IR/ConcreteDialect.h>
+#include <concretelang/Dialect/Concrete/IR/ConcreteOps.h>
+#include <concretelang/Transforms/LoopCost.h>
+
+namespace mlir {
+namespace concretelang {
+
+namespace {
+
+/// Returns the number of ciphertexts of the batch buffer `value`, 1 if it is
+/// a single ciphertext or dynamic.
+double batchSize(mlir::Value value) {
+  auto type = value.getType().dyn_cast<mlir::MemRefType>();
+  if (!type || type.getRank() < 2 || type.isDynamicDim(0))
+    return 1;
+  return type.getDimSize(0);
+}
+
+/// Returns the number of iterations of `op`, 1 if it is not static.
+double tripCount(mlir::Operation &op) {
+  if (auto forOp = llvm::dyn_cast<mlir::scf::ForOp>(op))
+    return tryGetStaticTripCount(forOp).value_or(1);
+  if (auto parallelOp = llvm::dyn_cast<mlir::scf::ParallelOp>(op)) {
+    double count = 1;
+    for (auto [lb, ub, step] :
+         llvm::zip(parallelOp.getLowerBound(), parallelOp.getUpperBound(),
+                   parallelOp.getStep())) {
+      if (isConstantIndexValue(lb) && isConstantIndexValue(ub) &&
+          isConstantIndexValue(step))
+        count *= getStaticTripCount(getConstantIndexValue(lb),
+                                    getConstantIndexValue(ub),
+                                    getConstantIndexValue(step));
+    }
+    return count;
+  }
+  return 1;
+}
+
+double operationCost(mlir::Operation &op) {
+  return llvm::TypeSwitch<mlir::Operation *, double>(&op)
+      .Case<Concrete::BootstrapLweBufferOp,
+            Concrete::ManyLutBootstrapLweBufferOp>([](auto) { return 1.0; })
+      .Case<Concrete::BatchedBootstrapLweBufferOp,
+            Concrete::BatchedMappedBootstrapLweBufferOp>(
+          [](auto op) { return batchSize(op.getResult()); })
+      .Case<Concrete::KeySwitchLweBufferOp>(
+          [](auto) { return KEYSWITCH_COST; })
+      .Case<Concrete::BatchedKeySwitchLweBufferOp>([](auto op) {
+        return KEYSWITCH_COST * batchSize(op.getResult());
+      })
+      .Case<Concrete::WopPBSCRTLweBufferOp>([](auto op) {
+        return WOP_PBS_BLOCK_COST * batchSize(op.getResult());
+      })
+      // The callees are not analyzed, assume they bootstrap
+      .Case<mlir::func::CallOp>([](auto) { return 1.0; })
+      .Default([](mlir::Operation *op) {
+        if (!llvm::isa<Concrete::ConcreteDialect>(op->getDialect()))
+          return 0.0;
+        double elements = 1;
+        for (mlir::Value operand : op->getOperands())
+          elements = std::max(elements, batchSize(operand));
+        return LEVELED_OP_COST * elements;
+      });
+}
+
+} // namespace
+
+double estimateRegionCost(mlir::Region &region) {
+  double cost = 0;
+  for (mlir::Operation &op : region.getOps()) {
+    cost += operationCost(op);
+    double iterations = tripCount(op);
+    for (mlir::Region &nested : op.getRegions())
+      cost += iterations * estimateRegionCost(nested);
+  }
+  return cost;
+}
+
+} // namespace concretelang
+} // namespace mlir
@@ -0,0 +1,52 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+#include <cmath>
+
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/OpenMP/OpenMPDialect.h>
+#include <mlir/IR/Builders.h>
+
+#include "concretelang/Transforms/LoopCost.h"
+#include "concretelang/Transforms/Passes.h"
+
+namespace {
+
+/// Cost of the iterations of a chunk of a dynamically scheduled loop, in
+/// bootstraps, amortizing the dispatch of the chunk.
+const double CHUNK_COST = 1;
+
+/// For documentation see Passes.td
+struct OpenMPLoopSchedulePass
+    : public OpenMPLoopScheduleBase<OpenMPLoopSchedulePass> {
+  OpenMPLoopSchedulePass(double minDynamicCost) {
+    this->minDynamicCost = minDynamicCost;
+  }
+
+  void runOnOperation() override {
+    getOperation().walk([&](mlir::omp::WsLoopOp loop) {
+      if (loop.getScheduleValAttr())
+        return;
+      double cost = mlir::concretelang::estimateRegionCost(loop.getRegion());
+      if (cost < minDynamicCost)
+        return;
+      int64_t chunkSize = std::max<int64_t>(1, std::ceil(CHUNK_COST / cost));
+
+      mlir::OpBuilder builder(loop);
+      mlir::Value chunk = builder.create<mlir::arith::ConstantIntOp>(
+          loop.getLoc(), chunkSize, 64);
+      loop.setScheduleValAttr(mlir::omp::ClauseScheduleKindAttr::get(
+          &getContext(), mlir::omp::ClauseScheduleKind::Dynamic));
+      loop.getScheduleChunkVarMutable().assign(chunk);
+    });
+  }
+};
+
+} // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::ModuleOp>>
+mlir::concretelang::createOpenMPLoopSchedulePass(double minDynamicCost) {
+  return std::make_unique<OpenMPLoopSchedulePass>(minDynamicCost);
+}
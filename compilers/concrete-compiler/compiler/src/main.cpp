@@ -126,6 +126,12 @@ llvm::cl::opt<bool> compressEvaluationKeys(
                    "evaluation keys and ciphertexts"),
     llvm::cl::init<bool>(false));
 
+llvm::cl::opt<bool> compressOutputCiphertexts(
+    "compress-outputs",
+    llvm::cl::desc("Switch the output ciphertexts to a smaller modulus, and "
+                   "pack their coefficients"),
+    llvm::cl::init<bool>(false));
+
 llvm::cl::list<std::string> passes(
     "passes",
     llvm::cl::desc("Specify the passes to run (use only for compiler tests)"),
@@ -209,6 +215,128 @@ llvm::cl::opt<int64_t>
                                 "batch for --batch-tfhe-ops"),
                  llvm::cl::init(std::numeric_limits<int64_t>::max()));
 
+llvm::cl::opt<int64_t> maxLiveCiphertextBytes(
+    "max-live-ciphertext-bytes",
+    llvm::cl::desc("Reorder the independent TFHE operations so that their live "
+                   "ciphertexts fit in the given size in bytes when possible, "
+                   "0 to minimize them, negative to keep the order"),
+    llvm::cl::init(-1));
+
+llvm::cl::opt<int64_t> pipelineChunkSize(
+    "pipeline-chunk-size",
+    llvm::cl::desc("Pipeline the keyswitch and the bootstrap of batches on CPU "
+                   "in chunks of this many ciphertexts, 0 to disable"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<uint32_t> bootstrapGroupingFactor(
+    "bootstrap-grouping-factor",
+    llvm::cl::desc("Generate multi-bit bootstrap keys of this grouping factor, "
+                   "1 for classical keys"),
+    llvm::cl::init(1));
+
+llvm::cl::opt<bool>
+    manyLut("many-lut",
+            llvm::cl::desc("Pack the table lookups applied to the same "
+                           "ciphertext in a single bootstrap"),
+            llvm::cl::init<bool>(false));
+
+llvm::cl::opt<bool> autoRounding(
+    "auto-rounding",
+    llvm::cl::desc("Round the inputs of the table lookups to a lower "
+                   "precision when it is cheaper"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<uint64_t> autoRoundingMaxError(
+    "auto-rounding-max-error",
+    llvm::cl::desc("Maximum absolute error on the results of a table lookup "
+                   "with a rounded input, 0 for exact results"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<bool> singleBootstrapRounding(
+    "single-bootstrap-rounding",
+    llvm::cl::desc("Round with a single table lookup on the input precision "
+                   "when it is cheaper than truncating the bits one by one"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<bool> matmulSquares(
+    "matmul-squares",
+    llvm::cl::desc("Lower encrypted by encrypted matrix multiplications to "
+                   "shared square table lookups"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<bool> inlineLeveledOps(
+    "inline-leveled-ops",
+    llvm::cl::desc("Lower the leveled operations on ciphertexts to loops in "
+                   "the compiled module instead of runtime calls"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<bool> reuseBuffers(
+    "reuse-buffers",
+    llvm::cl::desc("Reuse the buffers of dead ciphertexts and hoist the "
+                   "buffers of loop iterations out of the loops"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<bool> conv2dIm2col(
+    "conv2d-im2col",
+    llvm::cl::desc("Lower the convolutions of a single group to a copy of "
+                   "their input windows to contiguous patches followed by "
+                   "a matrix product"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<bool> sparseMatmul(
+    "sparse-matmul",
+    llvm::cl::desc("Lower the matrix products by constant matrices of mostly "
+                   "zeros to loops over their non zero weights"),
+    llvm::cl::init<bool>(false));
+
+llvm::cl::opt<std::string> objectCacheDir(
+    "object-cache-dir",
+    llvm::cl::desc("Cache the objects of the compiled functions in this "
+                   "directory, the unchanged functions of a recompiled "
+                   "module reusing them"),
+    llvm::cl::init(""));
+
+llvm::cl::opt<unsigned> codegenThreads(
+    "codegen-threads",
+    llvm::cl::desc("Number of threads compiling the functions of the LLVM "
+                   "module in parallel, 0 for all the cores"),
+    llvm::cl::init(1));
+
+llvm::cl::opt<uint64_t> codegenMaxOptimizedSize(
+    "codegen-max-optimized-size",
+    llvm::cl::desc("Compile the functions with more LLVM instructions without "
+                   "optimization, 0 if unlimited"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<std::string> predictionCostTable(
+    "prediction-cost-table",
+    llvm::cl::desc("Predict the latency and throughput of the circuits in the "
+                   "compilation feedback from this cost table, measured on "
+                   "the target backend by the calibrate_cost_model tool of "
+                   "concrete-cpu"),
+    llvm::cl::init(""));
+
+llvm::cl::opt<uint64_t> predictionWorkers(
+    "prediction-workers",
+    llvm::cl::desc("Number of parallel workers (cores, or concurrent GPU "
+                   "bootstraps) of the predicted runtime, 0 for all the "
+                   "cores"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<bool> analyzeNoise(
+    "analyze-noise",
+    llvm::cl::desc("Fill the error probabilities of the outputs in the "
+                   "compilation feedback by propagating the noise variances "
+                   "through the parametrized TFHE program"),
+    llvm::cl::init(false));
+
+llvm::cl::opt<std::string> runtimeBitcode(
+    "runtime-bitcode",
+    llvm::cl::desc("Link the runtime wrappers of this bitcode, built with "
+                   "CONCRETELANG_RUNTIME_BITCODE, in the circuits so that "
+                   "their leveled operations get inlined"),
+    llvm::cl::init(""));
+
 llvm::cl::opt<bool> emitSDFGOps(
     "emit-sdfg-ops",
     llvm::cl::desc(
@@ -222,11 +350,24 @@ llvm::cl::opt<bool> unrollLoopsWithSDFGConvertibleOps(
                    "fully unrolled."),
     llvm::cl::init(false));
 
+llvm::cl::opt<int64_t> maxUnrolledSDFGOps(
+    "max-unrolled-sdfg-ops",
+    llvm::cl::desc("Do not unroll the loop nests whose unrolling would "
+                   "produce more SDFG-convertible operations than this, "
+                   "0 for no limit."),
+    llvm::cl::init(1 << 16));
+
 llvm::cl::opt<bool> dataflowParallelize(
     "parallelize-dataflow",
     llvm::cl::desc("Generate the program as a dataflow graph"),
     llvm::cl::init(false));
 
+llvm::cl::opt<double> dataflowTaskComplexity(
+    "dataflow-task-complexity",
+    llvm::cl::desc("Merge adjacent dataflow tasks until they reach this "
+                   "complexity, in the unit of the optimizer (0 to disable)"),
+    llvm::cl::init(0.0));
+
 llvm::cl::opt<bool>
     chunkIntegers("chunk-integers",
                   llvm::cl::desc("Whether to decompose integer into chunks or "
@@ -245,6 +386,19 @@ llvm::cl::opt<unsigned int> chunkWidth(
         "Chunk width while decomposing big integers into chunks, default is 2"),
     llvm::cl::init<unsigned int>(2));
 
+llvm::cl::opt<unsigned int> carryLookaheadMinChunks(
+    "carry-lookahead-min-chunks",
+    llvm::cl::desc("Compute the carries of the additions of at least this "
+                   "many chunks with a logarithmic depth of table lookups, "
+                   "default is 0 (to always ripple them)"),
+    llvm::cl::init<unsigned int>(0));
+
+llvm::cl::opt<bool> autoChunkIntegers(
+    "auto-chunk-integers",
+    llvm::cl::desc("Decompose integers into chunks if the optimizer finds it "
+                   "cheaper than the native or CRT representations"),
+    llvm::cl::init<bool>(false));
+
 llvm::cl::opt<double> pbsErrorProbability(
     "pbs-error-probability",
     llvm::cl::desc("Change the default probability of error for all pbs"),
@@ -334,12 +488,84 @@ llvm::cl::opt<bool> optimizerAllowComposition(
                    "its own output without decryptions."),
     llvm::cl::init(false));
 
+llvm::cl::opt<uint64_t> optimizerMaximumEvaluationKeysSize(
+    "optimizer-max-evaluation-keys-size",
+    llvm::cl::desc("Maximum size in bytes of all the bootstrap and keyswitch "
+                   "keys, the optimizer trading complexity for smaller keys. "
+                   "0 means no maximum."),
+    llvm::cl::init(optimizer::DEFAULT_MAXIMUM_EVALUATION_KEYS_SIZE));
+
+llvm::cl::opt<uint64_t> optimizerLatencyWorkers(
+    "optimizer-latency-workers",
+    llvm::cl::desc("Minimize the latency of the circuit run on this number "
+                   "of parallel workers (cores, or concurrent GPU bootstraps) "
+                   "instead of its total complexity. 0 means the total "
+                   "complexity is minimized."),
+    llvm::cl::init(optimizer::DEFAULT_LATENCY_WORKERS));
+
+llvm::cl::opt<uint32_t> optimizerCiphertextModulusLog(
+    "optimizer-ciphertext-modulus-log",
+    llvm::cl::desc("Optimize the parameters for this ciphertext modulus, 32 "
+                   "or 64. The parameters optimized for 32 bits also fit the "
+                   "u32 functions of concrete-cpu, which halve the size of "
+                   "the keys and ciphertexts of low precision circuits."),
+    llvm::cl::init(optimizer::DEFAULT_CIPHERTEXT_MODULUS_LOG));
+
+llvm::cl::opt<std::string> optimizerCostTable(
+    "optimizer-cost-table",
+    llvm::cl::desc("Use the cost table measured on the target machine by the "
+                   "calibrate_cost_model tool of concrete-cpu instead of the "
+                   "analytic cost model of the optimizer."),
+    llvm::cl::init(""));
+
+llvm::cl::opt<std::string> optimizerSolutionCache(
+    "optimizer-solution-cache",
+    llvm::cl::desc("Directory where the optimizer saves the solutions of the "
+                   "multi-parameter circuits, reused when an equivalent "
+                   "circuit is compiled with the same options. It can be "
+                   "shared between processes and machines."),
+    llvm::cl::init(""));
+
 llvm::cl::list<int64_t> fhelinalgTileSizes(
     "fhelinalg-tile-sizes",
     llvm::cl::desc(
         "Force tiling of FHELinalg operation with the given tile sizes"),
     llvm::cl::ZeroOrMore, llvm::cl::MiscFlags::CommaSeparated);
 
+llvm::cl::opt<int64_t> fhelinalgTileCacheSize(
+    "fhelinalg-tile-cache-size",
+    llvm::cl::desc("Tile the reduction of FHELinalg operations so that the "
+                   "ciphertexts of a tile fit in a cache of the given size in "
+                   "bytes, unless tile sizes are forced"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<double> fhelinalgTileTaskCost(
+    "fhelinalg-tile-task-cost",
+    llvm::cl::desc("Tile the matrix multiplications, convolutions and table "
+                   "lookups in dataflow tasks of about the given number of "
+                   "bootstraps, unless tile sizes are forced (0 to disable)"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<int64_t> fhelinalgTileWorkers(
+    "fhelinalg-tile-workers",
+    llvm::cl::desc("Minimum number of tiles of the operations tiled by task "
+                   "cost (0 for the number of cores)"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<int64_t> layerStreamingTileSize(
+    "layer-streaming-tile-size",
+    llvm::cl::desc("Compute the table lookups over the results of dot "
+                   "products tile by tile with their producers, with tiles of "
+                   "at most the given number of rows (0 to disable)"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<int64_t> treeReductionMinSize(
+    "tree-reduction-min-size",
+    llvm::cl::desc("Reduce the dots and full sums of at least the given "
+                   "number of elements by independent chunks, whose partial "
+                   "sums are then added (0 to disable)"),
+    llvm::cl::init(0));
+
 llvm::cl::list<size_t> v0Constraint(
     "v0-constraint",
     llvm::cl::desc(
@@ -416,18 +642,43 @@ cmdlineCompilationOptions() {
   options.autoParallelize = cmdline::autoParallelize;
   options.loopParallelize = cmdline::loopParallelize;
   options.dataflowParallelize = cmdline::dataflowParallelize;
+  options.dataflowTaskComplexity = cmdline::dataflowTaskComplexity;
   options.batchTFHEOps = cmdline::batchTFHEOps;
   options.maxBatchSize = cmdline::maxBatchSize;
+  if (cmdline::maxLiveCiphertextBytes >= 0)
+    options.maxLiveCiphertextBytes = cmdline::maxLiveCiphertextBytes;
+  options.pipelineChunkSize = cmdline::pipelineChunkSize;
+  options.bootstrapGroupingFactor = cmdline::bootstrapGroupingFactor;
   options.emitSDFGOps = cmdline::emitSDFGOps;
   options.unrollLoopsWithSDFGConvertibleOps =
       cmdline::unrollLoopsWithSDFGConvertibleOps;
+  options.maxUnrolledSDFGOps = cmdline::maxUnrolledSDFGOps;
   options.optimizeTFHE = cmdline::optimizeTFHE;
+  options.enableManyLut = cmdline::manyLut;
+  options.enableAutoRounding = cmdline::autoRounding;
+  options.autoRoundingMaxError = cmdline::autoRoundingMaxError;
+  options.enableSingleBootstrapRounding = cmdline::singleBootstrapRounding;
+  options.enableMatMulSquares = cmdline::matmulSquares;
+  options.inlineLeveledOps = cmdline::inlineLeveledOps;
+  options.reuseBuffers = cmdline::reuseBuffers;
+  options.conv2dIm2col = cmdline::conv2dIm2col;
+  options.sparseMatmul = cmdline::sparseMatmul;
+  options.objectCacheDir = cmdline::objectCacheDir;
+  options.codegenThreads = cmdline::codegenThreads;
+  options.codegenMaxOptimizedSize = cmdline::codegenMaxOptimizedSize;
+  options.predictionCostTable = cmdline::predictionCostTable;
+  options.predictionWorkers = cmdline::predictionWorkers;
+  options.analyzeNoise = cmdline::analyzeNoise;
+  options.runtimeBitcode = cmdline::runtimeBitcode;
   options.simulate = cmdline::simulate;
   options.emitGPUOps = cmdline::emitGPUOps;
   options.compressEvaluationKeys = cmdline::compressEvaluationKeys;
+  options.compressOutputCiphertexts = cmdline::compressOutputCiphertexts;
   options.chunkIntegers = cmdline::chunkIntegers;
   options.chunkSize = cmdline::chunkSize;
   options.chunkWidth = cmdline::chunkWidth;
+  options.carryLookaheadMinChunks = cmdline::carryLookaheadMinChunks;
+  options.autoChunkIntegers = cmdline::autoChunkIntegers;
   options.skipProgramInfo = cmdline::skipProgramInfo;
 
   if (!cmdline::v0Constraint.empty()) {
@@ -443,6 +694,12 @@ cmdlineCompilationOptions() {
   // Convert tile sizes to `Optional`
   if (!cmdline::fhelinalgTileSizes.empty())
     options.fhelinalgTileSizes.emplace(cmdline::fhelinalgTileSizes);
+  options.layerStreamingTileSize = cmdline::layerStreamingTileSize;
+  options.treeReductionMinSize = cmdline::treeReductionMinSize;
+  if (cmdline::fhelinalgTileCacheSize > 0)
+    options.fhelinalgTileCacheSize = cmdline::fhelinalgTileCacheSize;
+  options.fhelinalgTileTaskCost = cmdline::fhelinalgTileTaskCost;
+  options.fhelinalgTileWorkers = cmdline::fhelinalgTileWorkers;
 
   // Setup the v0 parameter options
   if (!cmdline::v0Parameter.empty()) {
@@ -505,6 +762,14 @@ cmdlineCompilationOptions() {
   options.optimizerConfig.encoding = cmdline::optimizerEncoding;
   options.optimizerConfig.cache_on_disk = !cmdline::optimizerNoCacheOnDisk;
   options.optimizerConfig.composable = cmdline::optimizerAllowComposition;
+  options.optimizerConfig.maximum_evaluation_keys_size =
+      cmdline::optimizerMaximumEvaluationKeysSize;
+  options.optimizerConfig.latency_workers = cmdline::optimizerLatencyWorkers;
+  options.optimizerConfig.ciphertext_modulus_log =
+      cmdline::optimizerCiphertextModulusLog;
+  options.optimizerConfig.cost_table = cmdline::optimizerCostTable.c_str();
+  options.optimizerConfig.solution_cache =
+      cmdline::optimizerSolutionCache.c_str();
 
   if (!std::isnan(options.optimizerConfig.global_p_error) &&
       options.optimizerConfig.strategy == optimizer::Strategy::V0) {
@@ -513,6 +778,13 @@ cmdlineCompilationOptions() {
         llvm::inconvertibleErrorCode());
   }
 
+  if (options.optimizerConfig.ciphertext_modulus_log != 32 &&
+      options.optimizerConfig.ciphertext_modulus_log != 64) {
+    return llvm::make_error<llvm::StringError>(
+        "--optimizer-ciphertext-modulus-log must be 32 or 64",
+        llvm::inconvertibleErrorCode());
+  }
+
   if (!cmdline::programEncoding.empty()) {
     auto jsonString = cmdline::programEncoding.getValue();
     auto encodings = Message<concreteprotocol::ProgramEncodingInfo>();
@@ -0,0 +1,11 @@
+// RUN: concretecompiler --action=dump-llvm-dialect --pipeline-chunk-size=8 --skip-program-info %s 2>&1| FileCheck %s
+
+//CHECK: llvm.call @memref_batched_keyswitch_bootstrap_lwe_u64
+//CHECK-NOT: llvm.call @memref_batched_keyswitch_lwe_u64
+//CHECK-NOT: llvm.call @memref_batched_bootstrap_lwe_u64
+func.func @main(%arg0: tensor<64x1025xi64>) -> tensor<64x1025xi64> {
+  %cst = arith.constant dense<[1, 2, 3, 4]> : tensor<4xi64>
+  %0 = "Concrete.batched_keyswitch_lwe_tensor"(%arg0) {baseLog = 2 : i32, kskIndex = 0 : i32, level = 5 : i32, lwe_dim_in = 1025 : i32, lwe_dim_out = 576 : i32} : (tensor<64x1025xi64>) -> tensor<64x577xi64>
+  %1 = "Concrete.batched_bootstrap_lwe_tensor"(%0, %cst) {baseLog = 2 : i32, bskIndex = 0 : i32, level = 5 : i32, polySize = 1024: i32, glweDimension = 1 : i32, inputLweDim = 576 : i32} : (tensor<64x577xi64>, tensor<4xi64>) -> tensor<64x1025xi64>
+  return %1 : tensor<64x1025xi64>
+}
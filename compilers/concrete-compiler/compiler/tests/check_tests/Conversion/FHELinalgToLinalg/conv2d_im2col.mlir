@@ -0,0 +1,34 @@
+// RUN: concretecompiler --split-input-file --action=dump-tfhe --passes fhe-tensor-ops-to-linalg --conv2d-im2col %s 2>&1 | FileCheck %s
+
+// -----
+
+// CHECK-DAG: #[[$WINDOW:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d3, d1 * 2 + d4, d2 + d5)>
+// CHECK-DAG: #[[$PATCH:.*]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2, d3, d4, d5)>
+// CHECK-DAG: #[[$LHS:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>
+// CHECK-DAG: #[[$RHS:.*]] = affine_map<(d0, d1, d2, d3) -> (d1, d3)>
+// CHECK-DAG: #[[$OUT:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<1x2x4x4x!FHE.eint<6>>, %[[a1:.*]]: tensor<3x2x2x2xi7>) -> tensor<1x3x2x3x!FHE.eint<6>> {
+// CHECK:        %[[init:.*]] = "FHE.zero_tensor"() : () -> tensor<1x3x2x3x!FHE.eint<6>>
+// CHECK:        %[[empty:.*]] = tensor.empty() : tensor<1x2x3x2x2x2x!FHE.eint<6>>
+// CHECK-NEXT:   %[[patches:.*]] = linalg.generic {indexing_maps = [#[[$WINDOW]], #[[$PATCH]]], iterator_types = ["parallel", "parallel", "parallel", "parallel", "parallel", "parallel"]} ins(%{{.*}} : tensor<1x2x4x4x!FHE.eint<6>>) outs(%[[empty]] : tensor<1x2x3x2x2x2x!FHE.eint<6>>) {
+// CHECK-NEXT:   ^bb0(%[[in:.*]]: !FHE.eint<6>, %{{.*}}: !FHE.eint<6>):
+// CHECK-NEXT:     linalg.yield %[[in]] : !FHE.eint<6>
+// CHECK-NEXT:   } -> tensor<1x2x3x2x2x2x!FHE.eint<6>>
+// CHECK-NEXT:   %[[lhs:.*]] = tensor.collapse_shape %[[patches]] {{\[\[}}0], [1, 2], [3, 4, 5]] : tensor<1x2x3x2x2x2x!FHE.eint<6>> into tensor<1x6x8x!FHE.eint<6>>
+// CHECK-NEXT:   %[[rhs:.*]] = tensor.collapse_shape %[[a1]] {{\[\[}}0], [1, 2, 3]] : tensor<3x2x2x2xi7> into tensor<3x8xi7>
+// CHECK-NEXT:   %[[out:.*]] = tensor.collapse_shape %[[init]] {{\[\[}}0], [1], [2, 3]] : tensor<1x3x2x3x!FHE.eint<6>> into tensor<1x3x6x!FHE.eint<6>>
+// CHECK-NEXT:   %[[product:.*]] = linalg.generic {indexing_maps = [#[[$LHS]], #[[$RHS]], #[[$OUT]]], iterator_types = ["parallel", "parallel", "parallel", "reduction"]} ins(%[[lhs]], %[[rhs]] : tensor<1x6x8x!FHE.eint<6>>, tensor<3x8xi7>) outs(%[[out]] : tensor<1x3x6x!FHE.eint<6>>) {
+// CHECK-NEXT:   ^bb0(%[[x:.*]]: !FHE.eint<6>, %[[w:.*]]: i7, %[[acc:.*]]: !FHE.eint<6>):
+// CHECK-NEXT:     %[[mul:.*]] = "FHE.mul_eint_int"(%[[x]], %[[w]]) : (!FHE.eint<6>, i7) -> !FHE.eint<6>
+// CHECK-NEXT:     %[[add:.*]] = "FHE.add_eint"(%[[acc]], %[[mul]]) : (!FHE.eint<6>, !FHE.eint<6>) -> !FHE.eint<6>
+// CHECK-NEXT:     linalg.yield %[[add]] : !FHE.eint<6>
+// CHECK-NEXT:   } -> tensor<1x3x6x!FHE.eint<6>>
+// CHECK-NEXT:   %[[result:.*]] = tensor.expand_shape %[[product]] {{\[\[}}0], [1], [2, 3]] : tensor<1x3x6x!FHE.eint<6>> into tensor<1x3x2x3x!FHE.eint<6>>
+// CHECK-NEXT:   return %[[result]] : tensor<1x3x2x3x!FHE.eint<6>>
+func.func @main(%input: tensor<1x2x4x4x!FHE.eint<6>>, %weight: tensor<3x2x2x2xi7>) -> tensor<1x3x2x3x!FHE.eint<6>> {
+  %0 = "FHELinalg.conv2d"(%input, %weight){
+    strides = dense<[2,1]> : tensor<2xi64>, dilations = dense<[1,1]> : tensor<2xi64>, padding = dense<[0,0,0,0]> : tensor<4xi64>
+  } : (tensor<1x2x4x4x!FHE.eint<6>>, tensor<3x2x2x2xi7>) -> tensor<1x3x2x3x!FHE.eint<6>>
+  return %0 : tensor<1x3x2x3x!FHE.eint<6>>
+}
@@ -0,0 +1,29 @@
+// RUN: concretecompiler %s --action=dump-tfhe --passes fhe-tensor-ops-to-linalg 2>&1 | FileCheck %s
+
+// CHECK-LABEL: func.func @add_eint_int_dynamic_batch
+// CHECK-SAME: (%[[Varg0:.*]]: tensor<?x4x!FHE.eint<2>>, %[[Varg1:.*]]: tensor<4xi3>) -> tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     %[[Vc0:.*]] = arith.constant 0 : index
+// CHECK-NEXT:     %[[Vdim:.*]] = tensor.dim %[[Varg0]], %[[Vc0]] : tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     %[[V0:.*]] = tensor.empty(%[[Vdim]]) : tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     %[[V1:.*]] = linalg.generic {{.*}} ins(%[[Varg0]], %[[Varg1]] : tensor<?x4x!FHE.eint<2>>, tensor<4xi3>) outs(%[[V0]] : tensor<?x4x!FHE.eint<2>>)
+// CHECK:            "FHE.add_eint_int"
+// CHECK:          } -> tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     return %[[V1]] : tensor<?x4x!FHE.eint<2>>
+func.func @add_eint_int_dynamic_batch(%arg0: tensor<?x4x!FHE.eint<2>>, %arg1: tensor<4xi3>) -> tensor<?x4x!FHE.eint<2>> {
+  %1 = "FHELinalg.add_eint_int"(%arg0, %arg1): (tensor<?x4x!FHE.eint<2>>, tensor<4xi3>) -> (tensor<?x4x!FHE.eint<2>>)
+  return %1: tensor<?x4x!FHE.eint<2>>
+}
+
+// CHECK-LABEL: func.func @apply_lookup_table_dynamic_batch
+// CHECK-SAME: (%[[Varg0:.*]]: tensor<?x4x!FHE.eint<2>>, %[[Varg1:.*]]: tensor<4xi64>) -> tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     %[[Vc0:.*]] = arith.constant 0 : index
+// CHECK-NEXT:     %[[Vdim:.*]] = tensor.dim %[[Varg0]], %[[Vc0]] : tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     %[[V0:.*]] = tensor.empty(%[[Vdim]]) : tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     %[[V1:.*]] = linalg.generic {{.*}} ins(%[[Varg0]] : tensor<?x4x!FHE.eint<2>>) outs(%[[V0]] : tensor<?x4x!FHE.eint<2>>)
+// CHECK:            "FHE.apply_lookup_table"
+// CHECK:          } -> tensor<?x4x!FHE.eint<2>>
+// CHECK-NEXT:     return %[[V1]] : tensor<?x4x!FHE.eint<2>>
+func.func @apply_lookup_table_dynamic_batch(%arg0: tensor<?x4x!FHE.eint<2>>, %arg1: tensor<4xi64>) -> tensor<?x4x!FHE.eint<2>> {
+  %1 = "FHELinalg.apply_lookup_table"(%arg0, %arg1): (tensor<?x4x!FHE.eint<2>>, tensor<4xi64>) -> (tensor<?x4x!FHE.eint<2>>)
+  return %1: tensor<?x4x!FHE.eint<2>>
+}
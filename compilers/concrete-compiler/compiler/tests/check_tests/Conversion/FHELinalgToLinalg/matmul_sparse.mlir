@@ -0,0 +1,36 @@
+// RUN: concretecompiler --split-input-file --action=dump-tfhe --passes fhe-tensor-ops-to-linalg --sparse-matmul %s 2>&1 | FileCheck %s
+
+// -----
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<2x3x!FHE.eint<6>>) -> tensor<2x2x!FHE.eint<6>> {
+// CHECK:        %[[init:.*]] = "FHE.zero_tensor"() : () -> tensor<2x2x!FHE.eint<6>>
+// CHECK:        scf.for
+// CHECK:          scf.for
+// CHECK:            %[[zero:.*]] = "FHE.zero"() : () -> !FHE.eint<6>
+// CHECK:            scf.for
+// CHECK:              "FHE.add_eint"
+// CHECK:            scf.for
+// CHECK:              "FHE.sub_eint"
+// CHECK:            scf.for
+// CHECK:              "FHE.mul_eint_int"
+// CHECK-NEXT:         "FHE.add_eint"
+// CHECK:            tensor.insert
+// CHECK-NOT:  linalg.generic
+func.func @main(%x: tensor<2x3x!FHE.eint<6>>) -> tensor<2x2x!FHE.eint<6>> {
+  %w = arith.constant dense<[[1, 0], [0, -1], [0, 3]]> : tensor<3x2xi7>
+  %0 = "FHELinalg.matmul_eint_int"(%x, %w) : (tensor<2x3x!FHE.eint<6>>, tensor<3x2xi7>) -> tensor<2x2x!FHE.eint<6>>
+  return %0 : tensor<2x2x!FHE.eint<6>>
+}
+
+// -----
+
+// A dense matrix keeps the generic lowering
+
+// CHECK:      func.func @main
+// CHECK:        linalg.generic
+// CHECK-NOT:  scf.for
+func.func @main(%x: tensor<2x3x!FHE.eint<6>>) -> tensor<2x2x!FHE.eint<6>> {
+  %w = arith.constant dense<[[1, 2], [3, -1], [2, 3]]> : tensor<3x2xi7>
+  %0 = "FHELinalg.matmul_eint_int"(%x, %w) : (tensor<2x3x!FHE.eint<6>>, tensor<3x2xi7>) -> tensor<2x2x!FHE.eint<6>>
+  return %0 : tensor<2x2x!FHE.eint<6>>
+}
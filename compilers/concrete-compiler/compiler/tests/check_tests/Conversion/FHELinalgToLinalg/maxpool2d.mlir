@@ -2,11 +2,25 @@
 
 // -----
 
+// CHECK-DAG: #[[$MAP0:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-DAG: #[[$MAP1:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3 + 1)>
+// CHECK-DAG: #[[$MAP2:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 1, d3)>
+// CHECK-DAG: #[[$MAP3:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 1, d3 + 1)>
+// CHECK-DAG: #[[$MAP4:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 2, d3)>
+// CHECK-DAG: #[[$MAP5:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 2, d3 + 1)>
+
 // CHECK:      func.func @main(%[[a0:.*]]: tensor<1x1x8x10x!FHE.eint<5>>) -> tensor<1x1x6x9x!FHE.eint<5>> {
-// CHECK-NEXT:   %[[v0:.*]] = "FHE.zero_tensor"() : () -> tensor<1x1x6x9x!FHE.eint<5>>
-// CHECK-NEXT:   %[[v1:.*]] = tensor.empty() : tensor<3x2xi64>
-// CHECK-NEXT:   %[[v2:.*]] = linalg.pooling_nchw_max {dilations = dense<1> : vector<2xi64>, max_signed = {op = "FHE.max_eint", op_attrs = {}}, strides = dense<1> : vector<2xi64>} ins(%arg0, %1 : tensor<1x1x8x10x!FHE.eint<5>>, tensor<3x2xi64>) outs(%0 : tensor<1x1x6x9x!FHE.eint<5>>) -> tensor<1x1x6x9x!FHE.eint<5>>
-// CHECK-NEXT:   return %[[v2]] : tensor<1x1x6x9x!FHE.eint<5>>
+// CHECK-NEXT:   %[[v0:.*]] = tensor.empty() : tensor<1x1x6x9x!FHE.eint<5>>
+// CHECK-NEXT:   %[[v1:.*]] = linalg.generic {indexing_maps = [#[[$MAP0]], #[[$MAP1]], #[[$MAP2]], #[[$MAP3]], #[[$MAP4]], #[[$MAP5]], #[[$MAP0]]], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%[[a0]], %[[a0]], %[[a0]], %[[a0]], %[[a0]], %[[a0]] : {{.*}}) outs(%[[v0]] : tensor<1x1x6x9x!FHE.eint<5>>) {
+// CHECK-NEXT:   ^bb0(%[[e0:.*]]: !FHE.eint<5>, %[[e1:.*]]: !FHE.eint<5>, %[[e2:.*]]: !FHE.eint<5>, %[[e3:.*]]: !FHE.eint<5>, %[[e4:.*]]: !FHE.eint<5>, %[[e5:.*]]: !FHE.eint<5>, %[[out:.*]]: !FHE.eint<5>):
+// CHECK-NEXT:     %[[m01:.*]] = "FHE.max_eint"(%[[e0]], %[[e1]]) : (!FHE.eint<5>, !FHE.eint<5>) -> !FHE.eint<5>
+// CHECK-NEXT:     %[[m23:.*]] = "FHE.max_eint"(%[[e2]], %[[e3]]) : (!FHE.eint<5>, !FHE.eint<5>) -> !FHE.eint<5>
+// CHECK-NEXT:     %[[m45:.*]] = "FHE.max_eint"(%[[e4]], %[[e5]]) : (!FHE.eint<5>, !FHE.eint<5>) -> !FHE.eint<5>
+// CHECK-NEXT:     %[[m0123:.*]] = "FHE.max_eint"(%[[m01]], %[[m23]]) : (!FHE.eint<5>, !FHE.eint<5>) -> !FHE.eint<5>
+// CHECK-NEXT:     %[[m:.*]] = "FHE.max_eint"(%[[m0123]], %[[m45]]) : (!FHE.eint<5>, !FHE.eint<5>) -> !FHE.eint<5>
+// CHECK-NEXT:     linalg.yield %[[m]] : !FHE.eint<5>
+// CHECK-NEXT:   } -> tensor<1x1x6x9x!FHE.eint<5>>
+// CHECK-NEXT:   return %[[v1]] : tensor<1x1x6x9x!FHE.eint<5>>
 // CHECK-NEXT: }
 func.func @main(%arg0: tensor<1x1x8x10x!FHE.eint<5>>) -> tensor<1x1x6x9x!FHE.eint<5>> {
   %0 = "FHELinalg.maxpool2d"(%arg0) { kernel_shape = dense<[3, 2]> : tensor<2xi64> } : (tensor<1x1x8x10x!FHE.eint<5>>) -> tensor<1x1x6x9x!FHE.eint<5>>
@@ -15,9 +29,13 @@ func.func @main(%arg0: tensor<1x1x8x10x!FHE.eint<5>>) -> tensor<1x1x6x9x!FHE.ein
 
 // -----
 
-
-// CHECK: #[[$MAP0:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
-// CHECK: #[[$MAP1:.*]] = affine_map<(d0, d1, d2, d3) -> (0)>
+// CHECK-DAG: #[[$MAP0:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+// CHECK-DAG: #[[$MAP1:.*]] = affine_map<(d0, d1, d2, d3) -> (0)>
+// CHECK-DAG: #[[$MAP2:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3 + 1)>
+// CHECK-DAG: #[[$MAP3:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3 + 2)>
+// CHECK-DAG: #[[$MAP4:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 1, d3)>
+// CHECK-DAG: #[[$MAP5:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 1, d3 + 1)>
+// CHECK-DAG: #[[$MAP6:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 + 1, d3 + 2)>
 
 // CHECK:      func.func @main(%[[a0:.*]]: tensor<1x1x6x5x!FHE.esint<6>>) -> tensor<1x1x5x3x!FHE.esint<6>> {
 // CHECK-NEXT:   %[[v0:.*]] = "FHE.zero_tensor"() : () -> tensor<1x1x5x3x!FHE.esint<6>>
@@ -28,11 +46,35 @@ func.func @main(%arg0: tensor<1x1x8x10x!FHE.eint<5>>) -> tensor<1x1x6x9x!FHE.ein
 // CHECK-NEXT:     %[[vv0:.*]] = "FHE.sub_eint_int"(%[[aa0]], %[[aa1]]) : (!FHE.esint<6>, i7) -> !FHE.esint<6>
 // CHECK-NEXT:     linalg.yield %[[vv0]] : !FHE.esint<6>
 // CHECK-NEXT:   } -> tensor<1x1x5x3x!FHE.esint<6>>
-// CHECK-NEXT:   %[[v4:.*]] = tensor.empty() : tensor<2x3xi64>
-// CHECK-NEXT:   %[[v5:.*]] = linalg.pooling_nchw_max {dilations = dense<1> : vector<2xi64>, max_signed = {op = "FHE.max_eint", op_attrs = {}}, strides = dense<1> : vector<2xi64>} ins(%arg0, %[[v4]] : tensor<1x1x6x5x!FHE.esint<6>>, tensor<2x3xi64>) outs(%[[v3]] : tensor<1x1x5x3x!FHE.esint<6>>) -> tensor<1x1x5x3x!FHE.esint<6>>
-// CHECK-NEXT:   return %[[v5]] : tensor<1x1x5x3x!FHE.esint<6>>
+// CHECK-NEXT:   %[[v4:.*]] = linalg.generic {indexing_maps = [#[[$MAP0]], #[[$MAP2]], #[[$MAP3]], #[[$MAP4]], #[[$MAP5]], #[[$MAP6]], #[[$MAP0]]], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%[[a0]], %[[a0]], %[[a0]], %[[a0]], %[[a0]], %[[a0]] : {{.*}}) outs(%[[v3]] : tensor<1x1x5x3x!FHE.esint<6>>) {
+// CHECK-NEXT:   ^bb0(%[[e0:.*]]: !FHE.esint<6>, %[[e1:.*]]: !FHE.esint<6>, %[[e2:.*]]: !FHE.esint<6>, %[[e3:.*]]: !FHE.esint<6>, %[[e4:.*]]: !FHE.esint<6>, %[[e5:.*]]: !FHE.esint<6>, %[[lowest:.*]]: !FHE.esint<6>):
+// CHECK-NEXT:     %[[m01:.*]] = "FHE.max_eint"(%[[e0]], %[[e1]]) : (!FHE.esint<6>, !FHE.esint<6>) -> !FHE.esint<6>
+// CHECK-NEXT:     %[[m23:.*]] = "FHE.max_eint"(%[[e2]], %[[e3]]) : (!FHE.esint<6>, !FHE.esint<6>) -> !FHE.esint<6>
+// CHECK-NEXT:     %[[m45:.*]] = "FHE.max_eint"(%[[e4]], %[[e5]]) : (!FHE.esint<6>, !FHE.esint<6>) -> !FHE.esint<6>
+// CHECK-NEXT:     %[[m0123:.*]] = "FHE.max_eint"(%[[m01]], %[[m23]]) : (!FHE.esint<6>, !FHE.esint<6>) -> !FHE.esint<6>
+// CHECK-NEXT:     %[[m456:.*]] = "FHE.max_eint"(%[[m45]], %[[lowest]]) : (!FHE.esint<6>, !FHE.esint<6>) -> !FHE.esint<6>
+// CHECK-NEXT:     %[[m:.*]] = "FHE.max_eint"(%[[m0123]], %[[m456]]) : (!FHE.esint<6>, !FHE.esint<6>) -> !FHE.esint<6>
+// CHECK-NEXT:     linalg.yield %[[m]] : !FHE.esint<6>
+// CHECK-NEXT:   } -> tensor<1x1x5x3x!FHE.esint<6>>
+// CHECK-NEXT:   return %[[v4]] : tensor<1x1x5x3x!FHE.esint<6>>
 // CHECK-NEXT: }
 func.func @main(%arg0: tensor<1x1x6x5x!FHE.esint<6>>) -> tensor<1x1x5x3x!FHE.esint<6>> {
   %0 = "FHELinalg.maxpool2d"(%arg0) { kernel_shape = dense<[2, 3]> : tensor<2xi64> } : (tensor<1x1x6x5x!FHE.esint<6>>) -> tensor<1x1x5x3x!FHE.esint<6>>
   return %0 : tensor<1x1x5x3x!FHE.esint<6>>
 }
+
+// -----
+
+// CHECK-DAG: #[[$MAP0:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 * 2, d3 * 2)>
+// CHECK-DAG: #[[$MAP1:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2 * 2, d3 * 2 + 1)>
+// CHECK-DAG: #[[$MAP2:.*]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+
+// CHECK:      func.func @strided(%[[a0:.*]]: tensor<1x1x4x4x!FHE.eint<5>>) -> tensor<1x1x2x2x!FHE.eint<5>> {
+// CHECK:        linalg.generic {indexing_maps = [#[[$MAP0]], #[[$MAP1]], #[[$MAP2]]]
+// CHECK:          "FHE.max_eint"
+// CHECK-NOT:      "FHE.max_eint"
+// CHECK:          linalg.yield
+func.func @strided(%arg0: tensor<1x1x4x4x!FHE.eint<5>>) -> tensor<1x1x2x2x!FHE.eint<5>> {
+  %0 = "FHELinalg.maxpool2d"(%arg0) { kernel_shape = dense<[1, 2]> : tensor<2xi64>, strides = dense<[2, 2]> : tensor<2xi64> } : (tensor<1x1x4x4x!FHE.eint<5>>) -> tensor<1x1x2x2x!FHE.eint<5>>
+  return %0 : tensor<1x1x2x2x!FHE.eint<5>>
+}
@@ -0,0 +1,46 @@
+// RUN: concretecompiler --split-input-file --action=dump-tfhe --passes fhe-tensor-ops-to-linalg --tree-reduction-min-size 8 %s 2>&1 | FileCheck %s
+
+// -----
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<10x!FHE.eint<7>>, %[[a1:.*]]: tensor<10xi8>) -> !FHE.eint<7> {
+// CHECK:        tensor.extract_slice %[[a0]][0] [8] [1] : tensor<10x!FHE.eint<7>> to tensor<8x!FHE.eint<7>>
+// CHECK:        tensor.extract_slice %[[a0]][8] [2] [1] : tensor<10x!FHE.eint<7>> to tensor<2x!FHE.eint<7>>
+// CHECK:        tensor.expand_shape {{.*}} : tensor<8x!FHE.eint<7>> into tensor<2x4x!FHE.eint<7>>
+// CHECK:        %[[partials:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]
+// CHECK:        "FHE.mul_eint_int"
+// CHECK:        } -> tensor<2x!FHE.eint<7>>
+// CHECK:        %[[leftovers:.*]] = linalg.generic {{.*}} iterator_types = ["reduction"]
+// CHECK:        "FHE.mul_eint_int"
+// CHECK:        } -> tensor<1x!FHE.eint<7>>
+// CHECK:        linalg.generic {{.*}} iterator_types = ["reduction"]} ins(%[[partials]] : tensor<2x!FHE.eint<7>>) outs(%[[leftovers]] : tensor<1x!FHE.eint<7>>)
+// CHECK-NOT:    "FHE.mul_eint_int"
+// CHECK:        } -> tensor<1x!FHE.eint<7>>
+func.func @main(%arg0: tensor<10x!FHE.eint<7>>, %arg1: tensor<10xi8>) -> !FHE.eint<7> {
+  %0 = "FHELinalg.dot_eint_int"(%arg0, %arg1) : (tensor<10x!FHE.eint<7>>, tensor<10xi8>) -> !FHE.eint<7>
+  return %0 : !FHE.eint<7>
+}
+
+// -----
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<4x4x!FHE.eint<7>>) -> !FHE.eint<7> {
+// CHECK:        tensor.collapse_shape %[[a0]] {{.*}} : tensor<4x4x!FHE.eint<7>> into tensor<16x!FHE.eint<7>>
+// CHECK-NOT:    tensor.extract_slice
+// CHECK:        tensor.expand_shape {{.*}} : tensor<16x!FHE.eint<7>> into tensor<4x4x!FHE.eint<7>>
+// CHECK:        %[[partials:.*]] = linalg.generic {{.*}} iterator_types = ["parallel", "reduction"]
+// CHECK:        } -> tensor<4x!FHE.eint<7>>
+// CHECK:        linalg.generic {{.*}} iterator_types = ["reduction"]} ins(%[[partials]] : tensor<4x!FHE.eint<7>>)
+// CHECK:        } -> tensor<1x!FHE.eint<7>>
+func.func @main(%arg0: tensor<4x4x!FHE.eint<7>>) -> !FHE.eint<7> {
+  %0 = "FHELinalg.sum"(%arg0) : (tensor<4x4x!FHE.eint<7>>) -> !FHE.eint<7>
+  return %0 : !FHE.eint<7>
+}
+
+// -----
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<4x!FHE.eint<7>>) -> !FHE.eint<7> {
+// CHECK-NOT:    tensor.expand_shape
+// CHECK:        linalg.generic {{.*}} iterator_types = ["reduction"]
+func.func @main(%arg0: tensor<4x!FHE.eint<7>>) -> !FHE.eint<7> {
+  %0 = "FHELinalg.sum"(%arg0) : (tensor<4x!FHE.eint<7>>) -> !FHE.eint<7>
+  return %0 : !FHE.eint<7>
+}
@@ -0,0 +1,20 @@
+// RUN: concretecompiler %s --action=dump-llvm-dialect --parallelize 2>&1| FileCheck %s
+
+// The loops of table lookups are scheduled dynamically
+// CHECK-LABEL: llvm.func @apply_lookup_table
+// CHECK: omp.parallel
+// CHECK: omp.wsloop schedule(dynamic
+func.func @apply_lookup_table(%arg0: tensor<2x3x4x!FHE.eint<2>>) -> tensor<2x3x4x!FHE.eint<2>> {
+  %arg1 = arith.constant dense<[0, 1, 2, 3]> : tensor<4xi64>
+  %1 = "FHELinalg.apply_lookup_table"(%arg0, %arg1): (tensor<2x3x4x!FHE.eint<2>>, tensor<4xi64>) -> (tensor<2x3x4x!FHE.eint<2>>)
+  return %1: tensor<2x3x4x!FHE.eint<2>>
+}
+
+// A few leveled operations do not pay for the fork and join of the threads
+// CHECK-LABEL: llvm.func @add_eint
+// CHECK-NOT: omp.parallel
+// CHECK: llvm.return
+func.func @add_eint(%arg0: tensor<2x3x!FHE.eint<2>>, %arg1: tensor<2x3x!FHE.eint<2>>) -> tensor<2x3x!FHE.eint<2>> {
+  %1 = "FHELinalg.add_eint"(%arg0, %arg1): (tensor<2x3x!FHE.eint<2>>, tensor<2x3x!FHE.eint<2>>) -> (tensor<2x3x!FHE.eint<2>>)
+  return %1: tensor<2x3x!FHE.eint<2>>
+}
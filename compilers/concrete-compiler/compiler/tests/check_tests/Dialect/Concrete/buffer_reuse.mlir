@@ -0,0 +1,48 @@
+// RUN: concretecompiler --passes concrete-buffer-reuse --reuse-buffers --action=dump-std --skip-program-info %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @reuse_dead_buffer
+func.func @reuse_dead_buffer(%arg0: memref<4x751xi64>) -> memref<4x751xi64> {
+  // CHECK-NEXT: %[[A:.*]] = memref.alloc() : memref<4x751xi64>
+  // CHECK-NEXT: memref.copy %arg0, %[[A]]
+  // CHECK-NEXT: %[[B:.*]] = memref.alloc() : memref<4x751xi64>
+  // CHECK-NEXT: memref.copy %[[A]], %[[B]]
+  // CHECK-NEXT: memref.copy %[[B]], %[[A]]
+  // CHECK-NEXT: %[[C:.*]] = memref.alloc() : memref<4x751xi64>
+  // CHECK-NEXT: memref.copy %[[A]], %[[C]]
+  // CHECK-NEXT: memref.dealloc %[[B]]
+  // CHECK-NEXT: memref.dealloc %[[A]]
+  // CHECK-NEXT: return %[[C]]
+  %0 = memref.alloc() : memref<4x751xi64>
+  memref.copy %arg0, %0 : memref<4x751xi64> to memref<4x751xi64>
+  %1 = memref.alloc() : memref<4x751xi64>
+  memref.copy %0, %1 : memref<4x751xi64> to memref<4x751xi64>
+  memref.dealloc %0 : memref<4x751xi64>
+  %2 = memref.alloc() : memref<4x751xi64>
+  memref.copy %1, %2 : memref<4x751xi64> to memref<4x751xi64>
+  %3 = memref.alloc() : memref<4x751xi64>
+  memref.copy %2, %3 : memref<4x751xi64> to memref<4x751xi64>
+  memref.dealloc %1 : memref<4x751xi64>
+  memref.dealloc %2 : memref<4x751xi64>
+  return %3 : memref<4x751xi64>
+}
+
+// CHECK-LABEL: func.func @hoist_loop_buffer
+func.func @hoist_loop_buffer(%arg0: memref<751xi64>, %arg1: memref<4x751xi64>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  // CHECK: %[[A:.*]] = memref.alloc() : memref<751xi64>
+  // CHECK-NEXT: scf.for
+  // CHECK-NOT: memref.alloc
+  // CHECK-NOT: memref.dealloc
+  // CHECK: }
+  // CHECK-NEXT: memref.dealloc %[[A]]
+  scf.for %i = %c0 to %c4 step %c1 {
+    %0 = memref.alloc() : memref<751xi64>
+    memref.copy %arg0, %0 : memref<751xi64> to memref<751xi64>
+    %1 = memref.subview %arg1[%i, 0] [1, 751] [1, 1] : memref<4x751xi64> to memref<751xi64, strided<[1], offset: ?>>
+    memref.copy %0, %1 : memref<751xi64> to memref<751xi64, strided<[1], offset: ?>>
+    memref.dealloc %0 : memref<751xi64>
+  }
+  return
+}
@@ -0,0 +1,21 @@
+// RUN: concretecompiler --chunk-integers --chunk-size 4 --chunk-width 2 --carry-lookahead-min-chunks 4 --passes fhe-big-int-transform --action=dump-fhe  %s 2>&1| FileCheck %s
+
+// 4 status, 2 + 2 prefix, 3 carry and 4 result lookups
+// CHECK-LABEL: func.func @add_chunked_eint(%arg0: tensor<4x!FHE.eint<4>>, %arg1: tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.eint<4>>
+func.func @add_chunked_eint(%arg0: !FHE.eint<8>, %arg1: !FHE.eint<8>) -> !FHE.eint<8> {
+  // CHECK-NOT: affine.for
+  // CHECK-COUNT-15: "FHE.apply_lookup_table"
+  // CHECK-NOT: "FHE.apply_lookup_table"
+  // CHECK: %[[V0:.*]] = tensor.from_elements {{.*}} : tensor<4x!FHE.eint<4>>
+  // CHECK-NEXT: return %[[V0]] : tensor<4x!FHE.eint<4>>
+
+  %1 = "FHE.add_eint"(%arg0, %arg1): (!FHE.eint<8>, !FHE.eint<8>) -> (!FHE.eint<8>)
+  return %1: !FHE.eint<8>
+}
+
+// CHECK-LABEL: func.func @add_ripple_chunked_eint(%arg0: tensor<3x!FHE.eint<4>>, %arg1: tensor<3x!FHE.eint<4>>) -> tensor<3x!FHE.eint<4>>
+func.func @add_ripple_chunked_eint(%arg0: !FHE.eint<6>, %arg1: !FHE.eint<6>) -> !FHE.eint<6> {
+  // CHECK: affine.for
+  %1 = "FHE.add_eint"(%arg0, %arg1): (!FHE.eint<6>, !FHE.eint<6>) -> (!FHE.eint<6>)
+  return %1: !FHE.eint<6>
+}
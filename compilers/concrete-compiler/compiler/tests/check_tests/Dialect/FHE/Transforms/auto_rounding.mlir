@@ -0,0 +1,40 @@
+// RUN: concretecompiler --auto-rounding --passes fhe-auto-rounding --action=dump-fhe --split-input-file %s 2>&1 | FileCheck %s
+
+// The table only depends on the most significant bit of its input
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<6>) -> !FHE.eint<3> {
+// CHECK:        %[[carry:.*]] = arith.constant {{[0-9]+}} : i7
+// CHECK:        %[[v0:.*]] = "FHE.sub_eint_int"(%[[a0]], %[[carry]]) : (!FHE.eint<6>, i7) -> !FHE.eint<6>
+// CHECK:        %[[v1:.*]] = "FHE.round"(%[[v0]]) : (!FHE.eint<6>) -> !FHE.eint<[[P:[1-5]]]>
+// CHECK:        %[[v2:.*]] = "FHE.apply_lookup_table"(%[[v1]], %{{.*}}) : (!FHE.eint<[[P]]>, tensor<{{[0-9]+}}xi64>) -> !FHE.eint<3>
+// CHECK:        return %[[v2]] : !FHE.eint<3>
+func.func @main(%arg0: !FHE.eint<6>) -> !FHE.eint<3> {
+  %lut = arith.constant dense<[0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5]> : tensor<64xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %lut): (!FHE.eint<6>, tensor<64xi64>) -> (!FHE.eint<3>)
+  return %0 : !FHE.eint<3>
+}
+
+// -----
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<4x!FHE.eint<6>>) -> tensor<4x!FHE.eint<3>> {
+// CHECK:        "FHELinalg.sub_eint_int"
+// CHECK:        %[[v1:.*]] = "FHELinalg.round"(%{{.*}}) : (tensor<4x!FHE.eint<6>>) -> tensor<4x!FHE.eint<[[P:[1-5]]]>>
+// CHECK:        "FHELinalg.apply_lookup_table"(%[[v1]], %{{.*}}) : (tensor<4x!FHE.eint<[[P]]>>, tensor<{{[0-9]+}}xi64>) -> tensor<4x!FHE.eint<3>>
+func.func @main(%arg0: tensor<4x!FHE.eint<6>>) -> tensor<4x!FHE.eint<3>> {
+  %lut = arith.constant dense<[0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5]> : tensor<64xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%arg0, %lut): (tensor<4x!FHE.eint<6>>, tensor<64xi64>) -> (tensor<4x!FHE.eint<3>>)
+  return %0 : tensor<4x!FHE.eint<3>>
+}
+
+// -----
+
+// Rounding the input of a table with distinct entries changes its results
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<2>) -> !FHE.eint<2> {
+// CHECK-NOT:    FHE.round
+// CHECK:        "FHE.apply_lookup_table"(%[[a0]], %{{.*}})
+func.func @main(%arg0: !FHE.eint<2>) -> !FHE.eint<2> {
+  %lut = arith.constant dense<[0, 1, 2, 3]> : tensor<4xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %lut): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<2>)
+  return %0 : !FHE.eint<2>
+}
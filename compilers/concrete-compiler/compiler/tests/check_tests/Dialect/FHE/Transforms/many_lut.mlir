@@ -0,0 +1,49 @@
+// RUN: concretecompiler --many-lut --passes fhe-many-lut --action=dump-fhe --split-input-file %s 2>&1 | FileCheck %s
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<2>) -> (!FHE.eint<3>, !FHE.eint<3>) {
+// CHECK-NEXT:   %[[v0:.*]] = arith.constant dense<{{\[\[}}0, 1, 2, 3], [3, 2, 1, 0]]> : tensor<2x4xi64>
+// CHECK-NEXT:   %[[v1:.*]]:2 = "FHE.apply_many_lookup_tables"(%[[a0]], %[[v0]]) : (!FHE.eint<2>, tensor<2x4xi64>) -> (!FHE.eint<3>, !FHE.eint<3>)
+// CHECK-NEXT:   return %[[v1]]#0, %[[v1]]#1 : !FHE.eint<3>, !FHE.eint<3>
+// CHECK-NEXT: }
+func.func @main(%arg0: !FHE.eint<2>) -> (!FHE.eint<3>, !FHE.eint<3>) {
+  %lut0 = arith.constant dense<[0, 1, 2, 3]> : tensor<4xi64>
+  %lut1 = arith.constant dense<[3, 2, 1, 0]> : tensor<4xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %lut0): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<3>)
+  %1 = "FHE.apply_lookup_table"(%arg0, %lut1): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<3>)
+  return %0, %1 : !FHE.eint<3>, !FHE.eint<3>
+}
+
+// -----
+
+// Groups of three tables are padded with their last table
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<2>) -> (!FHE.eint<2>, !FHE.eint<2>, !FHE.eint<2>) {
+// CHECK-NEXT:   %[[v0:.*]] = arith.constant dense<{{\[\[}}0, 1, 2, 3], [3, 2, 1, 0], [1, 1, 0, 0], [1, 1, 0, 0]]> : tensor<4x4xi64>
+// CHECK-NEXT:   %[[v1:.*]]:4 = "FHE.apply_many_lookup_tables"(%[[a0]], %[[v0]]) : (!FHE.eint<2>, tensor<4x4xi64>) -> (!FHE.eint<2>, !FHE.eint<2>, !FHE.eint<2>, !FHE.eint<2>)
+// CHECK-NEXT:   return %[[v1]]#0, %[[v1]]#1, %[[v1]]#2 : !FHE.eint<2>, !FHE.eint<2>, !FHE.eint<2>
+// CHECK-NEXT: }
+func.func @main(%arg0: !FHE.eint<2>) -> (!FHE.eint<2>, !FHE.eint<2>, !FHE.eint<2>) {
+  %lut0 = arith.constant dense<[0, 1, 2, 3]> : tensor<4xi64>
+  %lut1 = arith.constant dense<[3, 2, 1, 0]> : tensor<4xi64>
+  %lut2 = arith.constant dense<[1, 1, 0, 0]> : tensor<4xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %lut0): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<2>)
+  %1 = "FHE.apply_lookup_table"(%arg0, %lut1): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<2>)
+  %2 = "FHE.apply_lookup_table"(%arg0, %lut2): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<2>)
+  return %0, %1, %2 : !FHE.eint<2>, !FHE.eint<2>, !FHE.eint<2>
+}
+
+// -----
+
+// Table lookups returning different types are not packed
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<2>) -> (!FHE.eint<2>, !FHE.eint<3>) {
+// CHECK:        "FHE.apply_lookup_table"
+// CHECK:        "FHE.apply_lookup_table"
+// CHECK-NOT:    "FHE.apply_many_lookup_tables"
+func.func @main(%arg0: !FHE.eint<2>) -> (!FHE.eint<2>, !FHE.eint<3>) {
+  %lut0 = arith.constant dense<[0, 1, 2, 3]> : tensor<4xi64>
+  %lut1 = arith.constant dense<[3, 2, 1, 0]> : tensor<4xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %lut0): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<2>)
+  %1 = "FHE.apply_lookup_table"(%arg0, %lut1): (!FHE.eint<2>, tensor<4xi64>) -> (!FHE.eint<3>)
+  return %0, %1 : !FHE.eint<2>, !FHE.eint<3>
+}
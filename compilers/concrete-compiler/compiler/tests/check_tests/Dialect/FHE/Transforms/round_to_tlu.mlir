@@ -0,0 +1,39 @@
+// RUN: concretecompiler --single-bootstrap-rounding --passes fhe-round-to-tlu --action=dump-fhe --split-input-file %s 2>&1 | FileCheck %s
+
+// Rounding then looking up is composed in a single table lookup
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<3>) -> !FHE.eint<2> {
+// CHECK-NEXT:   %[[lut:.*]] = arith.constant dense<[1, 1, 3, 3, 3, 3, 1, 1]> : tensor<8xi64>
+// CHECK-NEXT:   %[[v0:.*]] = "FHE.apply_lookup_table"(%[[a0]], %[[lut]]) : (!FHE.eint<3>, tensor<8xi64>) -> !FHE.eint<2>
+// CHECK-NEXT:   return %[[v0]] : !FHE.eint<2>
+func.func @main(%arg0: !FHE.eint<3>) -> !FHE.eint<2> {
+  %lut = arith.constant dense<[1, 3]> : tensor<2xi64>
+  %0 = "FHE.round"(%arg0) : (!FHE.eint<3>) -> !FHE.eint<1>
+  %1 = "FHE.apply_lookup_table"(%0, %lut): (!FHE.eint<1>, tensor<2xi64>) -> (!FHE.eint<2>)
+  return %1 : !FHE.eint<2>
+}
+
+// -----
+
+// CHECK:      func.func @main(%[[a0:.*]]: tensor<4x!FHE.esint<4>>) -> tensor<4x!FHE.eint<2>> {
+// CHECK-NEXT:   %[[lut:.*]] = arith.constant dense<[1, 1, 3, 3, 3, 3, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1]> : tensor<16xi64>
+// CHECK-NEXT:   %[[v0:.*]] = "FHELinalg.apply_lookup_table"(%[[a0]], %[[lut]]) : (tensor<4x!FHE.esint<4>>, tensor<16xi64>) -> tensor<4x!FHE.eint<2>>
+// CHECK-NEXT:   return %[[v0]] : tensor<4x!FHE.eint<2>>
+func.func @main(%arg0: tensor<4x!FHE.esint<4>>) -> tensor<4x!FHE.eint<2>> {
+  %lut = arith.constant dense<[1, 3, 2, 0]> : tensor<4xi64>
+  %0 = "FHELinalg.round"(%arg0) : (tensor<4x!FHE.esint<4>>) -> tensor<4x!FHE.esint<2>>
+  %1 = "FHELinalg.apply_lookup_table"(%0, %lut): (tensor<4x!FHE.esint<2>>, tensor<4xi64>) -> (tensor<4x!FHE.eint<2>>)
+  return %1 : tensor<4x!FHE.eint<2>>
+}
+
+// -----
+
+// Dropping a single bit is cheaper than a bootstrap on the input precision
+
+// CHECK:      func.func @main(%[[a0:.*]]: !FHE.eint<8>) -> !FHE.eint<7> {
+// CHECK-NEXT:   %[[v0:.*]] = "FHE.round"(%[[a0]]) : (!FHE.eint<8>) -> !FHE.eint<7>
+// CHECK-NEXT:   return %[[v0]] : !FHE.eint<7>
+func.func @main(%arg0: !FHE.eint<8>) -> !FHE.eint<7> {
+  %0 = "FHE.round"(%arg0) : (!FHE.eint<8>) -> !FHE.eint<7>
+  return %0 : !FHE.eint<7>
+}
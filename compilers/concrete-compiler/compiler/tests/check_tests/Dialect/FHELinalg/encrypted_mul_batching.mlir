@@ -0,0 +1,37 @@
+// RUN: concretecompiler --split-input-file --action=dump-fhe --passes fhe-linalg-encrypted-mul-batching %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @mul
+// CHECK-NEXT:    %[[V0:.*]] = "FHELinalg.add_eint"(%arg0, %arg1) : (tensor<4x!FHE.eint<4>>, tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V1:.*]] = "FHELinalg.sub_eint"(%arg0, %arg1) : (tensor<4x!FHE.eint<4>>, tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V2:.*]] = "FHELinalg.to_signed"(%[[V0]]) : (tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.esint<4>>
+// CHECK-NEXT:    %[[V3:.*]] = "FHELinalg.to_signed"(%[[V1]]) : (tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.esint<4>>
+// CHECK-NEXT:    %[[V4:.*]] = tensor.expand_shape %[[V2]] {{\[\[}}0, 1]] : tensor<4x!FHE.esint<4>> into tensor<1x4x!FHE.esint<4>>
+// CHECK-NEXT:    %[[V5:.*]] = tensor.expand_shape %[[V3]] {{\[\[}}0, 1]] : tensor<4x!FHE.esint<4>> into tensor<1x4x!FHE.esint<4>>
+// CHECK-NEXT:    %[[V6:.*]] = "FHELinalg.concat"(%[[V4]], %[[V5]]) {axis = 0 : i64} : (tensor<1x4x!FHE.esint<4>>, tensor<1x4x!FHE.esint<4>>) -> tensor<2x4x!FHE.esint<4>>
+// CHECK-NEXT:    %[[CST:.*]] = arith.constant dense<{{\[\[}}0, 0, 1, 2, 4, 6, 9, 12, 16, 20, 25, 30, 36, 42, 49, 56], [0, 0, 1, 2, 4, 6, 9, 12, 16, 12, 9, 6, 4, 2, 1, 0]]> : tensor<2x16xi64>
+// CHECK-NEXT:    %[[MAP:.*]] = arith.constant dense<{{\[\[}}0, 0, 0, 0], [1, 1, 1, 1]]> : tensor<2x4xindex>
+// CHECK-NEXT:    %[[V7:.*]] = "FHELinalg.apply_mapped_lookup_table"(%[[V6]], %[[CST]], %[[MAP]]) : (tensor<2x4x!FHE.esint<4>>, tensor<2x16xi64>, tensor<2x4xindex>) -> tensor<2x4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V8:.*]] = tensor.extract_slice %[[V7]][0, 0] [1, 4] [1, 1] : tensor<2x4x!FHE.eint<4>> to tensor<4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V9:.*]] = tensor.extract_slice %[[V7]][1, 0] [1, 4] [1, 1] : tensor<2x4x!FHE.eint<4>> to tensor<4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V10:.*]] = "FHELinalg.sub_eint"(%[[V8]], %[[V9]]) : (tensor<4x!FHE.eint<4>>, tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.eint<4>>
+// CHECK-NEXT:    return %[[V10]] : tensor<4x!FHE.eint<4>>
+func.func @mul(%arg0: tensor<4x!FHE.eint<4>>, %arg1: tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.eint<4>> {
+  %0 = "FHELinalg.mul_eint"(%arg0, %arg1) : (tensor<4x!FHE.eint<4>>, tensor<4x!FHE.eint<4>>) -> tensor<4x!FHE.eint<4>>
+  return %0 : tensor<4x!FHE.eint<4>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @matmul
+// CHECK-NEXT:    %[[V0:.*]] = tensor.expand_shape %arg0 {{\[\[}}0], [1, 2]] : tensor<3x2x!FHE.eint<4>> into tensor<3x2x1x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V1:.*]] = tensor.expand_shape %arg1 {{\[\[}}0, 1], [2]] : tensor<2x4x!FHE.eint<4>> into tensor<1x2x4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V2:.*]] = "FHELinalg.add_eint"(%[[V0]], %[[V1]]) : (tensor<3x2x1x!FHE.eint<4>>, tensor<1x2x4x!FHE.eint<4>>) -> tensor<3x2x4x!FHE.eint<4>>
+// CHECK:         %[[V3:.*]] = "FHELinalg.apply_mapped_lookup_table"(%{{.*}}, %{{.*}}, %{{.*}}) : (tensor<2x3x2x4x!FHE.esint<4>>, tensor<2x16xi64>, tensor<2x3x2x4xindex>) -> tensor<2x3x2x4x!FHE.eint<4>>
+// CHECK:         %[[V4:.*]] = "FHELinalg.sub_eint"(%{{.*}}, %{{.*}}) : (tensor<3x2x4x!FHE.eint<4>>, tensor<3x2x4x!FHE.eint<4>>) -> tensor<3x2x4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V5:.*]] = "FHELinalg.sum"(%[[V4]]) {axes = [1], keep_dims = false} : (tensor<3x2x4x!FHE.eint<4>>) -> tensor<3x4x!FHE.eint<4>>
+// CHECK-NEXT:    return %[[V5]] : tensor<3x4x!FHE.eint<4>>
+func.func @matmul(%arg0: tensor<3x2x!FHE.eint<4>>, %arg1: tensor<2x4x!FHE.eint<4>>) -> tensor<3x4x!FHE.eint<4>> {
+  %0 = "FHELinalg.matmul_eint_eint"(%arg0, %arg1) : (tensor<3x2x!FHE.eint<4>>, tensor<2x4x!FHE.eint<4>>) -> tensor<3x4x!FHE.eint<4>>
+  return %0 : tensor<3x4x!FHE.eint<4>>
+}
+
@@ -0,0 +1,17 @@
+// RUN: concretecompiler --action=dump-fhe-no-linalg %s --optimizer-strategy=dag-mono --layer-streaming-tile-size=2 2>&1 | FileCheck %s
+
+// The 8 rows of the layer are computed in 4 tiles of 2 rows
+// CHECK:      %[[C8:.*]] = arith.constant 8 : index
+// CHECK:      %[[C2:.*]] = arith.constant 2 : index
+// CHECK:      scf.for %{{.*}} = %{{.*}} to %[[C8]] step %[[C2]]
+// CHECK:        "FHE.mul_eint_int"
+// CHECK:        "FHE.add_eint_int"
+// CHECK:        "FHE.apply_lookup_table"
+// CHECK:      } {"streaming-tile-loop"}
+func.func @main(%x: tensor<8x4x!FHE.eint<4>>, %w: tensor<4x3xi5>, %b: tensor<8x3xi5>) -> tensor<8x3x!FHE.eint<4>> {
+  %lut = arith.constant dense<[0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7]> : tensor<16xi64>
+  %0 = "FHELinalg.matmul_eint_int"(%x, %w) : (tensor<8x4x!FHE.eint<4>>, tensor<4x3xi5>) -> tensor<8x3x!FHE.eint<4>>
+  %1 = "FHELinalg.add_eint_int"(%0, %b) : (tensor<8x3x!FHE.eint<4>>, tensor<8x3xi5>) -> tensor<8x3x!FHE.eint<4>>
+  %2 = "FHELinalg.apply_lookup_table"(%1, %lut) : (tensor<8x3x!FHE.eint<4>>, tensor<16xi64>) -> tensor<8x3x!FHE.eint<4>>
+  return %2 : tensor<8x3x!FHE.eint<4>>
+}
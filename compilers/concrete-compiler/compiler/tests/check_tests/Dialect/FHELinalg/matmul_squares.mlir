@@ -0,0 +1,43 @@
+// RUN: concretecompiler --matmul-squares --split-input-file --action=dump-fhe --passes fhe-linalg-matmul-squares %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @matmul
+// CHECK:         %[[CST:.*]] = arith.constant dense<[0, 1, 4, 9, 16, 25, 36, 49, 0, 17, 36, 57, 16, 41, 4, 33]> : tensor<16xi64>
+// CHECK-NEXT:    %[[V0:.*]] = tensor.expand_shape %arg0 {{\[\[}}0], [1, 2]] : tensor<3x2x!FHE.eint<4>> into tensor<3x2x1x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V1:.*]] = tensor.expand_shape %arg1 {{\[\[}}0, 1], [2]] : tensor<2x4x!FHE.eint<4>> into tensor<1x2x4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V2:.*]] = "FHELinalg.add_eint"(%[[V0]], %[[V1]]) : (tensor<3x2x1x!FHE.eint<4>>, tensor<1x2x4x!FHE.eint<4>>) -> tensor<3x2x4x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V3:.*]] = "FHELinalg.apply_lookup_table"(%[[V2]], %[[CST]]) : (tensor<3x2x4x!FHE.eint<4>>, tensor<16xi64>) -> tensor<3x2x4x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V4:.*]] = "FHELinalg.sum"(%[[V3]]) {axes = [1], keep_dims = false} : (tensor<3x2x4x!FHE.eint<5>>) -> tensor<3x4x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V5:.*]] = "FHELinalg.apply_lookup_table"(%arg0, %[[CST]]) : (tensor<3x2x!FHE.eint<4>>, tensor<16xi64>) -> tensor<3x2x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V6:.*]] = "FHELinalg.sum"(%[[V5]]) {axes = [1], keep_dims = true} : (tensor<3x2x!FHE.eint<5>>) -> tensor<3x1x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V7:.*]] = "FHELinalg.apply_lookup_table"(%arg1, %[[CST]]) : (tensor<2x4x!FHE.eint<4>>, tensor<16xi64>) -> tensor<2x4x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V8:.*]] = "FHELinalg.sum"(%[[V7]]) {axes = [0], keep_dims = true} : (tensor<2x4x!FHE.eint<5>>) -> tensor<1x4x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V9:.*]] = "FHELinalg.sub_eint"(%[[V4]], %[[V6]]) : (tensor<3x4x!FHE.eint<5>>, tensor<3x1x!FHE.eint<5>>) -> tensor<3x4x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V10:.*]] = "FHELinalg.sub_eint"(%[[V9]], %[[V8]]) : (tensor<3x4x!FHE.eint<5>>, tensor<1x4x!FHE.eint<5>>) -> tensor<3x4x!FHE.eint<5>>
+// CHECK-NEXT:    %[[V11:.*]] = "FHELinalg.reinterpret_precision"(%[[V10]]) : (tensor<3x4x!FHE.eint<5>>) -> tensor<3x4x!FHE.eint<4>>
+// CHECK-NEXT:    return %[[V11]] : tensor<3x4x!FHE.eint<4>>
+func.func @matmul(%arg0: tensor<3x2x!FHE.eint<4>>, %arg1: tensor<2x4x!FHE.eint<4>>) -> tensor<3x4x!FHE.eint<4>> {
+  %0 = "FHELinalg.matmul_eint_eint"(%arg0, %arg1) : (tensor<3x2x!FHE.eint<4>>, tensor<2x4x!FHE.eint<4>>) -> tensor<3x4x!FHE.eint<4>>
+  return %0 : tensor<3x4x!FHE.eint<4>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @signed
+// CHECK:         %[[CST:.*]] = arith.constant dense<[0, 1, 4, 9, 16, 25, 36, 49, 0, 49, 36, 25, 16, 9, 4, 1]> : tensor<16xi64>
+// CHECK:         %[[V0:.*]] = "FHELinalg.reinterpret_precision"(%{{.*}}) : (tensor<3x3x!FHE.eint<5>>) -> tensor<3x3x!FHE.eint<4>>
+// CHECK-NEXT:    %[[V1:.*]] = "FHELinalg.to_signed"(%[[V0]]) : (tensor<3x3x!FHE.eint<4>>) -> tensor<3x3x!FHE.esint<4>>
+// CHECK-NEXT:    return %[[V1]] : tensor<3x3x!FHE.esint<4>>
+func.func @signed(%arg0: tensor<3x2x!FHE.esint<4>>, %arg1: tensor<2x3x!FHE.esint<4>>) -> tensor<3x3x!FHE.esint<4>> {
+  %0 = "FHELinalg.matmul_eint_eint"(%arg0, %arg1) : (tensor<3x2x!FHE.esint<4>>, tensor<2x3x!FHE.esint<4>>) -> tensor<3x3x!FHE.esint<4>>
+  return %0 : tensor<3x3x!FHE.esint<4>>
+}
+
+// -----
+
+// Sharing the squares does not save any bootstrap
+// CHECK-LABEL: func.func @small
+// CHECK-NEXT:    %[[V0:.*]] = "FHELinalg.matmul_eint_eint"(%arg0, %arg1)
+func.func @small(%arg0: tensor<2x3x!FHE.eint<4>>, %arg1: tensor<3x2x!FHE.eint<4>>) -> tensor<2x2x!FHE.eint<4>> {
+  %0 = "FHELinalg.matmul_eint_eint"(%arg0, %arg1) : (tensor<2x3x!FHE.eint<4>>, tensor<3x2x!FHE.eint<4>>) -> tensor<2x2x!FHE.eint<4>>
+  return %0 : tensor<2x2x!FHE.eint<4>>
+}
@@ -0,0 +1,9 @@
+// RUN: concretecompiler --action=dump-fhe %s --optimizer-strategy=dag-mono --fhelinalg-tile-cache-size=1 2>&1 | FileCheck %s --check-prefix=SMALL
+// RUN: concretecompiler --action=dump-fhe %s --optimizer-strategy=dag-mono --fhelinalg-tile-cache-size=1000000000 2>&1 | FileCheck %s --check-prefix=LARGE
+
+// SMALL: "FHELinalg.matmul_eint_int"(%arg0, %arg1) {"tile-sizes" = [0, 0, 1]}
+// LARGE: "FHELinalg.matmul_eint_int"(%arg0, %arg1) :
+func.func @main(%a: tensor<8x4x!FHE.eint<6>>, %b: tensor<4x2xi7>) -> tensor<8x2x!FHE.eint<6>> {
+  %0 = "FHELinalg.matmul_eint_int"(%a, %b) : (tensor<8x4x!FHE.eint<6>>, tensor<4x2xi7>) -> tensor<8x2x!FHE.eint<6>>
+  return %0 : tensor<8x2x!FHE.eint<6>>
+}
@@ -0,0 +1,26 @@
+// RUN: concretecompiler --action=dump-fhe-no-linalg %s --optimizer-strategy=dag-mono --fhelinalg-tile-task-cost=8 --fhelinalg-tile-workers=1 --split-input-file 2>&1 | FileCheck %s
+
+// The 30 table lookups are split in 4 tiles of at most 3 rows, the last
+// one having a single row
+// CHECK-LABEL: func.func @tiled
+// CHECK:         scf.forall (%{{.*}}) in (4)
+// CHECK:           affine.min
+// CHECK:           "FHE.apply_lookup_table"
+// CHECK:           scf.forall.in_parallel
+func.func @tiled(%x: tensor<10x3x!FHE.eint<4>>) -> tensor<10x3x!FHE.eint<4>> {
+  %lut = arith.constant dense<[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15]> : tensor<16xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%x, %lut) : (tensor<10x3x!FHE.eint<4>>, tensor<16xi64>) -> tensor<10x3x!FHE.eint<4>>
+  return %0 : tensor<10x3x!FHE.eint<4>>
+}
+
+// -----
+
+// The 6 table lookups fit in a single task
+// CHECK-LABEL: func.func @untiled
+// CHECK-NOT:     scf.forall
+// CHECK:         return
+func.func @untiled(%x: tensor<2x3x!FHE.eint<4>>) -> tensor<2x3x!FHE.eint<4>> {
+  %lut = arith.constant dense<[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15]> : tensor<16xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%x, %lut) : (tensor<2x3x!FHE.eint<4>>, tensor<16xi64>) -> tensor<2x3x!FHE.eint<4>>
+  return %0 : tensor<2x3x!FHE.eint<4>>
+}
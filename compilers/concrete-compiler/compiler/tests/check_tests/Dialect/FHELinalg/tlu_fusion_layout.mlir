@@ -0,0 +1,64 @@
+// RUN: concretecompiler --split-input-file --action=dump-fhe --passes fhe-linalg-tlu-fusion %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @transpose
+// CHECK:         %[[CST:.*]] = arith.constant dense<[3, 2, 1, 0]> : tensor<4xi64>
+// CHECK-NEXT:    %[[V0:.*]] = "FHELinalg.apply_lookup_table"(%arg0, %[[CST]]) : (tensor<2x3x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x3x!FHE.eint<2>>
+// CHECK-NEXT:    %[[V1:.*]] = "FHELinalg.transpose"(%[[V0]])
+// CHECK-NEXT:    return %[[V1]] : tensor<3x2x!FHE.eint<2>>
+func.func @transpose(%arg0: tensor<2x3x!FHE.eint<2>>) -> tensor<3x2x!FHE.eint<2>> {
+  %cst = arith.constant dense<[0, 1, 2, 3]> : tensor<4xi64>
+  %cst_0 = arith.constant dense<[3, 2, 1, 0]> : tensor<4xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%arg0, %cst) : (tensor<2x3x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x3x!FHE.eint<2>>
+  %1 = "FHELinalg.transpose"(%0) : (tensor<2x3x!FHE.eint<2>>) -> tensor<3x2x!FHE.eint<2>>
+  %2 = "FHELinalg.apply_lookup_table"(%1, %cst_0) : (tensor<3x2x!FHE.eint<2>>, tensor<4xi64>) -> tensor<3x2x!FHE.eint<2>>
+  return %2 : tensor<3x2x!FHE.eint<2>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @slice
+// CHECK:         %[[CST:.*]] = arith.constant dense<[1, 1, 3, 3]> : tensor<4xi64>
+// CHECK-NEXT:    %[[V0:.*]] = "FHELinalg.apply_lookup_table"(%arg0, %[[CST]]) : (tensor<4x!FHE.eint<2>>, tensor<4xi64>) -> tensor<4x!FHE.eint<2>>
+// CHECK-NEXT:    %[[V1:.*]] = tensor.extract_slice %[[V0]][0] [2] [1] : tensor<4x!FHE.eint<2>> to tensor<2x!FHE.eint<2>>
+// CHECK-NEXT:    return %[[V1]] : tensor<2x!FHE.eint<2>>
+func.func @slice(%arg0: tensor<4x!FHE.eint<2>>) -> tensor<2x!FHE.eint<2>> {
+  %cst = arith.constant dense<[0, 0, 1, 1]> : tensor<4xi64>
+  %cst_0 = arith.constant dense<[1, 3, 0, 0]> : tensor<4xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%arg0, %cst) : (tensor<4x!FHE.eint<2>>, tensor<4xi64>) -> tensor<4x!FHE.eint<2>>
+  %1 = tensor.extract_slice %0[0] [2] [1] : tensor<4x!FHE.eint<2>> to tensor<2x!FHE.eint<2>>
+  %2 = "FHELinalg.apply_lookup_table"(%1, %cst_0) : (tensor<2x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x!FHE.eint<2>>
+  return %2 : tensor<2x!FHE.eint<2>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @concat
+// CHECK:         %[[CST:.*]] = arith.constant dense<[2, 3, 1, 0]> : tensor<4xi64>
+// CHECK-NEXT:    %[[V0:.*]] = "FHELinalg.apply_lookup_table"(%arg0, %[[CST]]) : (tensor<2x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x!FHE.eint<3>>
+// CHECK:         %[[CST_1:.*]] = arith.constant dense<[0, 0, 0, 0]> : tensor<4xi64>
+// CHECK-NEXT:    %[[V1:.*]] = "FHELinalg.apply_lookup_table"(%arg1, %[[CST_1]]) : (tensor<2x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x!FHE.eint<3>>
+// CHECK-NEXT:    %[[V2:.*]] = "FHELinalg.concat"(%[[V0]], %[[V1]])
+// CHECK-NEXT:    return %[[V2]] : tensor<4x!FHE.eint<3>>
+func.func @concat(%arg0: tensor<2x!FHE.eint<2>>, %arg1: tensor<2x!FHE.eint<2>>) -> tensor<4x!FHE.eint<3>> {
+  %cst = arith.constant dense<[1, 2, 3, 0]> : tensor<4xi64>
+  %cst_0 = arith.constant dense<[0, 0, 0, 0]> : tensor<4xi64>
+  %cst_1 = arith.constant dense<[0, 2, 3, 1]> : tensor<4xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%arg0, %cst) : (tensor<2x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x!FHE.eint<2>>
+  %1 = "FHELinalg.apply_lookup_table"(%arg1, %cst_0) : (tensor<2x!FHE.eint<2>>, tensor<4xi64>) -> tensor<2x!FHE.eint<2>>
+  %2 = "FHELinalg.concat"(%0, %1) { axis = 0 } : (tensor<2x!FHE.eint<2>>, tensor<2x!FHE.eint<2>>) -> tensor<4x!FHE.eint<2>>
+  %3 = "FHELinalg.apply_lookup_table"(%2, %cst_1) : (tensor<4x!FHE.eint<2>>, tensor<4xi64>) -> tensor<4x!FHE.eint<3>>
+  return %3 : tensor<4x!FHE.eint<3>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @duplicate
+// CHECK:         %[[V0:.*]] = "FHELinalg.apply_lookup_table"(%arg0, %{{.*}}) : (tensor<4x!FHE.eint<2>>, tensor<4xi64>) -> tensor<4x!FHE.eint<2>>
+// CHECK-NEXT:    %[[V1:.*]] = "FHELinalg.add_eint"(%[[V0]], %[[V0]])
+func.func @duplicate(%arg0: tensor<4x!FHE.eint<2>>) -> tensor<4x!FHE.eint<2>> {
+  %cst = arith.constant dense<[0, 0, 1, 1]> : tensor<4xi64>
+  %0 = "FHELinalg.apply_lookup_table"(%arg0, %cst) : (tensor<4x!FHE.eint<2>>, tensor<4xi64>) -> tensor<4x!FHE.eint<2>>
+  %1 = "FHELinalg.apply_lookup_table"(%arg0, %cst) : (tensor<4x!FHE.eint<2>>, tensor<4xi64>) -> tensor<4x!FHE.eint<2>>
+  %2 = "FHELinalg.add_eint"(%0, %1) : (tensor<4x!FHE.eint<2>>, tensor<4x!FHE.eint<2>>) -> tensor<4x!FHE.eint<2>>
+  return %2 : tensor<4x!FHE.eint<2>>
+}
@@ -0,0 +1,51 @@
+// RUN: concretecompiler --passes tfhe-constant-lut-encoding --action=dump-normalized-tfhe --skip-program-info %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @constant_lut
+func.func @constant_lut() -> tensor<8xi64> {
+  // CHECK-NEXT: %[[CST:.*]] = arith.constant dense<[4611686018427387904, 4611686018427387904, 0, 0, 0, 0, -4611686018427387904, -4611686018427387904]> : tensor<8xi64>
+  // CHECK-NEXT: return %[[CST]]
+  %lut = arith.constant dense<[1, 0]> : tensor<2xi64>
+  %0 = "TFHE.encode_expand_lut_for_bootstrap"(%lut) {isSigned = false, outputBits = 1 : i32, polySize = 8 : i32} : (tensor<2xi64>) -> tensor<8xi64>
+  return %0 : tensor<8xi64>
+}
+
+// CHECK-LABEL: func.func @signed_constant_lut
+func.func @signed_constant_lut() -> tensor<8xi64> {
+  // CHECK-NEXT: %[[CST:.*]] = arith.constant dense<[0, 0, 4611686018427387904, 4611686018427387904, 4611686018427387904, 4611686018427387904, 0, 0]> : tensor<8xi64>
+  // CHECK-NEXT: return %[[CST]]
+  %lut = arith.constant dense<[1, 0]> : tensor<2xi64>
+  %0 = "TFHE.encode_expand_lut_for_bootstrap"(%lut) {isSigned = true, outputBits = 1 : i32, polySize = 8 : i32} : (tensor<2xi64>) -> tensor<8xi64>
+  return %0 : tensor<8xi64>
+}
+
+// CHECK-LABEL: func.func @argument_lut
+func.func @argument_lut(%lut: tensor<2xi64>) -> tensor<8xi64> {
+  // CHECK-NEXT: "TFHE.encode_expand_lut_for_bootstrap"(%arg0)
+  %0 = "TFHE.encode_expand_lut_for_bootstrap"(%lut) {isSigned = false, outputBits = 1 : i32, polySize = 8 : i32} : (tensor<2xi64>) -> tensor<8xi64>
+  return %0 : tensor<8xi64>
+}
+
+// CHECK-LABEL: func.func @constant_lut_for_crt_woppbs
+func.func @constant_lut_for_crt_woppbs() -> tensor<2x8xi64> {
+  // CHECK-NEXT: %[[CST:.*]] = arith.constant dense<{{\[}}[-9223372036854775808, 0, 0, 0, -9223372036854775808, 0, 0, 0], [6148914691236517205, 0, 0, -6148914691236517206, 0, 0, 0, 0]]> : tensor<2x8xi64>
+  // CHECK-NEXT: return %[[CST]]
+  %lut = arith.constant dense<[1, 2, 3, 0]> : tensor<4xi64>
+  %0 = "TFHE.encode_lut_for_crt_woppbs"(%lut) {crtBits = [1, 2], crtDecomposition = [2, 3], isSigned = false, modulusProduct = 6 : i32} : (tensor<4xi64>) -> tensor<2x8xi64>
+  return %0 : tensor<2x8xi64>
+}
+
+// CHECK-LABEL: func.func @signed_constant_lut_for_crt_woppbs
+func.func @signed_constant_lut_for_crt_woppbs() -> tensor<2x8xi64> {
+  // CHECK-NEXT: %[[CST:.*]] = arith.constant dense<{{\[}}[-9223372036854775808, 0, 0, -9223372036854775808, 0, 0, 0, 0], [6148914691236517205, 0, 0, -6148914691236517206, 0, 6148914691236517205, 0, 0]]> : tensor<2x8xi64>
+  // CHECK-NEXT: return %[[CST]]
+  %lut = arith.constant dense<[1, -1, 0, -2]> : tensor<4xi64>
+  %0 = "TFHE.encode_lut_for_crt_woppbs"(%lut) {crtBits = [1, 2], crtDecomposition = [2, 3], isSigned = true, modulusProduct = 6 : i32} : (tensor<4xi64>) -> tensor<2x8xi64>
+  return %0 : tensor<2x8xi64>
+}
+
+// CHECK-LABEL: func.func @argument_lut_for_crt_woppbs
+func.func @argument_lut_for_crt_woppbs(%lut: tensor<4xi64>) -> tensor<2x8xi64> {
+  // CHECK-NEXT: "TFHE.encode_lut_for_crt_woppbs"(%arg0)
+  %0 = "TFHE.encode_lut_for_crt_woppbs"(%lut) {crtBits = [1, 2], crtDecomposition = [2, 3], isSigned = false, modulusProduct = 6 : i32} : (tensor<4xi64>) -> tensor<2x8xi64>
+  return %0 : tensor<2x8xi64>
+}
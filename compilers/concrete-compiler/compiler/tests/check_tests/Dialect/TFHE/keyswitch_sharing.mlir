@@ -0,0 +1,44 @@
+// RUN: concretecompiler --passes tfhe-keyswitch-sharing --action=dump-normalized-tfhe --skip-program-info %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @fan_out
+func.func @fan_out(%arg0: !TFHE.glwe<sk<0,1,2048>>, %lut0: tensor<1024xi64>, %lut1: tensor<1024xi64>) -> (!TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>) {
+  // CHECK-NEXT: %[[KS:.*]] = "TFHE.keyswitch_glwe"(%arg0)
+  // CHECK-NEXT: %[[BS0:.*]] = "TFHE.bootstrap_glwe"(%[[KS]], %arg1)
+  // CHECK-NEXT: %[[BS1:.*]] = "TFHE.bootstrap_glwe"(%[[KS]], %arg2)
+  // CHECK-NEXT: return %[[BS0]], %[[BS1]]
+  %0 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %1 = "TFHE.bootstrap_glwe"(%0, %lut0) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 1, 2, 15>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %2 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %3 = "TFHE.bootstrap_glwe"(%2, %lut1) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 1, 2, 15>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  return %1, %3 : !TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>
+}
+
+// CHECK-LABEL: func.func @dominated_in_loop
+func.func @dominated_in_loop(%arg0: !TFHE.glwe<sk<0,1,2048>>, %lut: tensor<1024xi64>, %t: tensor<4x!TFHE.glwe<sk<0,1,2048>>>) -> (!TFHE.glwe<sk<0,1,2048>>, tensor<4x!TFHE.glwe<sk<0,1,2048>>>) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  // CHECK: %[[KS:.*]] = "TFHE.keyswitch_glwe"(%arg0)
+  // CHECK: scf.for
+  // CHECK-NOT: "TFHE.keyswitch_glwe"
+  // CHECK: "TFHE.bootstrap_glwe"(%[[KS]], %arg1)
+  // CHECK: scf.yield
+  %0 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %1 = "TFHE.bootstrap_glwe"(%0, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 1, 2, 15>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %2 = scf.for %i = %c0 to %c4 step %c1 iter_args(%acc = %t) -> (tensor<4x!TFHE.glwe<sk<0,1,2048>>>) {
+    %3 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+    %4 = "TFHE.bootstrap_glwe"(%3, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 1, 2, 15>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+    %5 = tensor.insert %4 into %acc[%i] : tensor<4x!TFHE.glwe<sk<0,1,2048>>>
+    scf.yield %5 : tensor<4x!TFHE.glwe<sk<0,1,2048>>>
+  }
+  return %1, %2 : !TFHE.glwe<sk<0,1,2048>>, tensor<4x!TFHE.glwe<sk<0,1,2048>>>
+}
+
+// CHECK-LABEL: func.func @different_keys
+func.func @different_keys(%arg0: !TFHE.glwe<sk<0,1,2048>>) -> (!TFHE.glwe<sk<1,1,750>>, !TFHE.glwe<sk<2,1,750>>) {
+  // CHECK-NEXT: "TFHE.keyswitch_glwe"(%arg0)
+  // CHECK-NEXT: "TFHE.keyswitch_glwe"(%arg0)
+  %0 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %1 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<2,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<2,1,750>>
+  return %0, %1 : !TFHE.glwe<sk<1,1,750>>, !TFHE.glwe<sk<2,1,750>>
+}
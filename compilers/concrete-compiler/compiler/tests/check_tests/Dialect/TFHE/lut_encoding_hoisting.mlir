@@ -0,0 +1,43 @@
+// RUN: concretecompiler --passes tfhe-lut-encoding-hoisting --action=dump-normalized-tfhe --skip-program-info %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @invariant_lut
+func.func @invariant_lut(%lut: tensor<2xi64>) -> tensor<4xi64> {
+  // CHECK:      %[[ENC:.*]] = "TFHE.encode_expand_lut_for_bootstrap"(%arg0)
+  // CHECK-NOT:  "TFHE.encode_expand_lut_for_bootstrap"
+  // CHECK:      scf.for
+  // CHECK-NOT:  "TFHE.encode_expand_lut_for_bootstrap"
+  // CHECK:        tensor.extract %[[ENC]]
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %init = tensor.empty() : tensor<4xi64>
+  %0 = scf.for %i = %c0 to %c4 step %c1 iter_args(%acc = %init) -> (tensor<4xi64>) {
+    %1 = "TFHE.encode_expand_lut_for_bootstrap"(%lut) {isSigned = false, outputBits = 1 : i32, polySize = 8 : i32} : (tensor<2xi64>) -> tensor<8xi64>
+    %2 = "TFHE.encode_expand_lut_for_bootstrap"(%lut) {isSigned = false, outputBits = 1 : i32, polySize = 8 : i32} : (tensor<2xi64>) -> tensor<8xi64>
+    %3 = tensor.extract %1[%i] : tensor<8xi64>
+    %4 = tensor.extract %2[%i] : tensor<8xi64>
+    %5 = arith.addi %3, %4 : i64
+    %6 = tensor.insert %5 into %acc[%i] : tensor<4xi64>
+    scf.yield %6 : tensor<4xi64>
+  }
+  return %0 : tensor<4xi64>
+}
+
+// CHECK-LABEL: func.func @variant_lut
+func.func @variant_lut(%luts: tensor<4x2xi64>) -> tensor<4xi64> {
+  // CHECK:      scf.for
+  // CHECK:        tensor.extract_slice
+  // CHECK-NEXT:   "TFHE.encode_expand_lut_for_bootstrap"
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4 = arith.constant 4 : index
+  %init = tensor.empty() : tensor<4xi64>
+  %0 = scf.for %i = %c0 to %c4 step %c1 iter_args(%acc = %init) -> (tensor<4xi64>) {
+    %lut = tensor.extract_slice %luts[%i, 0] [1, 2] [1, 1] : tensor<4x2xi64> to tensor<2xi64>
+    %1 = "TFHE.encode_expand_lut_for_bootstrap"(%lut) {isSigned = false, outputBits = 1 : i32, polySize = 8 : i32} : (tensor<2xi64>) -> tensor<8xi64>
+    %2 = tensor.extract %1[%i] : tensor<8xi64>
+    %3 = tensor.insert %2 into %acc[%i] : tensor<4xi64>
+    scf.yield %3 : tensor<4xi64>
+  }
+  return %0 : tensor<4xi64>
+}
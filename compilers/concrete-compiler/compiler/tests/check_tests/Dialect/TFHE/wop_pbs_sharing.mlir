@@ -0,0 +1,26 @@
+// RUN: concretecompiler --passes tfhe-wop-pbs-sharing --action=dump-normalized-tfhe --skip-program-info %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @fan_out
+func.func @fan_out(%arg0: tensor<2x!TFHE.glwe<sk<0,1,2048>>>, %lut0: tensor<2x64xi64>, %lut1: tensor<8xi64>) -> (tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x!TFHE.glwe<sk<0,1,2048>>>) {
+  // CHECK:      %[[LUT1:.*]] = "TFHE.encode_lut_for_crt_woppbs"(%arg2)
+  // CHECK-NEXT: %[[EMPTY:.*]] = tensor.empty() : tensor<4x64xi64>
+  // CHECK-NEXT: %[[LUTS0:.*]] = tensor.insert_slice %arg1 into %[[EMPTY]][0, 0] [2, 64] [1, 1]
+  // CHECK-NEXT: %[[LUTS1:.*]] = tensor.insert_slice %[[LUT1]] into %[[LUTS0]][2, 0] [2, 64] [1, 1]
+  // CHECK-NEXT: %[[WOP:.*]] = "TFHE.wop_pbs_glwe"(%arg0, %[[LUTS1]]) {{.*}} -> tensor<4x!TFHE.glwe<sk<0,1,2048>>>
+  // CHECK-NEXT: %[[RES0:.*]] = tensor.extract_slice %[[WOP]][0] [2] [1]
+  // CHECK-NEXT: %[[RES1:.*]] = tensor.extract_slice %[[WOP]][2] [2] [1]
+  // CHECK-NEXT: return %[[RES0]], %[[RES1]]
+  %0 = "TFHE.wop_pbs_glwe"(%arg0, %lut0) {bsk = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 2048, 1, 2, 15>, cbsBaseLog = 6 : i32, cbsLevels = 3 : i32, crtDecomposition = [7, 8], ksk = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>, pksk = #TFHE.pksk<sk<0,1,2048>, sk<0,1,2048>, 2048, 2048, 1, 2, 15>} : (tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x64xi64>) -> tensor<2x!TFHE.glwe<sk<0,1,2048>>>
+  %1 = "TFHE.encode_lut_for_crt_woppbs"(%lut1) {crtBits = [3, 3], crtDecomposition = [7, 8], isSigned = false, modulusProduct = 56 : i32} : (tensor<8xi64>) -> tensor<2x64xi64>
+  %2 = "TFHE.wop_pbs_glwe"(%arg0, %1) {bsk = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 2048, 1, 2, 15>, cbsBaseLog = 6 : i32, cbsLevels = 3 : i32, crtDecomposition = [7, 8], ksk = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>, pksk = #TFHE.pksk<sk<0,1,2048>, sk<0,1,2048>, 2048, 2048, 1, 2, 15>} : (tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x64xi64>) -> tensor<2x!TFHE.glwe<sk<0,1,2048>>>
+  return %0, %2 : tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x!TFHE.glwe<sk<0,1,2048>>>
+}
+
+// CHECK-LABEL: func.func @different_ciphertexts
+func.func @different_ciphertexts(%arg0: tensor<2x!TFHE.glwe<sk<0,1,2048>>>, %arg1: tensor<2x!TFHE.glwe<sk<0,1,2048>>>, %lut: tensor<2x64xi64>) -> (tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x!TFHE.glwe<sk<0,1,2048>>>) {
+  // CHECK-NEXT: "TFHE.wop_pbs_glwe"(%arg0, %arg2)
+  // CHECK-NEXT: "TFHE.wop_pbs_glwe"(%arg1, %arg2)
+  %0 = "TFHE.wop_pbs_glwe"(%arg0, %lut) {bsk = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 2048, 1, 2, 15>, cbsBaseLog = 6 : i32, cbsLevels = 3 : i32, crtDecomposition = [7, 8], ksk = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>, pksk = #TFHE.pksk<sk<0,1,2048>, sk<0,1,2048>, 2048, 2048, 1, 2, 15>} : (tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x64xi64>) -> tensor<2x!TFHE.glwe<sk<0,1,2048>>>
+  %1 = "TFHE.wop_pbs_glwe"(%arg1, %lut) {bsk = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 2048, 1, 2, 15>, cbsBaseLog = 6 : i32, cbsLevels = 3 : i32, crtDecomposition = [7, 8], ksk = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>, pksk = #TFHE.pksk<sk<0,1,2048>, sk<0,1,2048>, 2048, 2048, 1, 2, 15>} : (tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x64xi64>) -> tensor<2x!TFHE.glwe<sk<0,1,2048>>>
+  return %0, %1 : tensor<2x!TFHE.glwe<sk<0,1,2048>>>, tensor<2x!TFHE.glwe<sk<0,1,2048>>>
+}
@@ -0,0 +1,26 @@
+// RUN: concretecompiler --action=dump-batched-tfhe --max-live-ciphertext-bytes=0 --skip-program-info %s 2>&1| FileCheck %s --check-prefix=MIN
+// RUN: concretecompiler --action=dump-batched-tfhe --max-live-ciphertext-bytes=1000000 --skip-program-info %s 2>&1| FileCheck %s --check-prefix=FIT
+
+// MIN-LABEL: func.func @layer_then_reduction
+// MIN:      %[[B0:.*]] = "TFHE.bootstrap_glwe"(%arg0, %arg3)
+// MIN-NEXT: %[[B1:.*]] = "TFHE.bootstrap_glwe"(%arg1, %arg3)
+// MIN-NEXT: %[[S0:.*]] = "TFHE.add_glwe"(%[[B0]], %[[B1]])
+// MIN-NEXT: %[[B2:.*]] = "TFHE.bootstrap_glwe"(%arg2, %arg3)
+// MIN-NEXT: %[[S1:.*]] = "TFHE.add_glwe"(%[[S0]], %[[B2]])
+// MIN-NEXT: return %[[S1]]
+
+// FIT-LABEL: func.func @layer_then_reduction
+// FIT:      %[[B0:.*]] = "TFHE.bootstrap_glwe"(%arg0, %arg3)
+// FIT-NEXT: %[[B1:.*]] = "TFHE.bootstrap_glwe"(%arg1, %arg3)
+// FIT-NEXT: %[[B2:.*]] = "TFHE.bootstrap_glwe"(%arg2, %arg3)
+// FIT-NEXT: %[[S0:.*]] = "TFHE.add_glwe"(%[[B0]], %[[B1]])
+// FIT-NEXT: %[[S1:.*]] = "TFHE.add_glwe"(%[[S0]], %[[B2]])
+// FIT-NEXT: return %[[S1]]
+func.func @layer_then_reduction(%arg0: !TFHE.glwe<sk<1,1,750>>, %arg1: !TFHE.glwe<sk<1,1,750>>, %arg2: !TFHE.glwe<sk<1,1,750>>, %lut: tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>> {
+  %0 = "TFHE.bootstrap_glwe"(%arg0, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %1 = "TFHE.bootstrap_glwe"(%arg1, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %2 = "TFHE.bootstrap_glwe"(%arg2, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %3 = "TFHE.add_glwe"(%0, %1) : (!TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<0,1,2048>>
+  %4 = "TFHE.add_glwe"(%3, %2) : (!TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<0,1,2048>>
+  return %4 : !TFHE.glwe<sk<0,1,2048>>
+}
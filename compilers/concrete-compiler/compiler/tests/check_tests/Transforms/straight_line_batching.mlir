@@ -0,0 +1,46 @@
+// RUN: concretecompiler --split-input-file --action=dump-batched-tfhe --batch-tfhe-ops --skip-program-info %s 2>&1| FileCheck %s
+
+// CHECK-LABEL: func.func @independent_table_lookups
+// CHECK:      %[[CTS:.*]] = tensor.from_elements %arg0, %arg1
+// CHECK-NEXT: %[[KS:.*]] = "TFHE.batched_keyswitch_glwe"(%[[CTS]])
+// CHECK:      %[[KS0:.*]] = tensor.extract %[[KS]][%{{.*}}]
+// CHECK:      %[[KS1:.*]] = tensor.extract %[[KS]][%{{.*}}]
+// CHECK:      %[[KSS:.*]] = tensor.from_elements %[[KS0]], %[[KS1]]
+// CHECK-NEXT: %[[BS:.*]] = "TFHE.batched_bootstrap_glwe"(%[[KSS]], %arg2)
+// CHECK-NOT:  "TFHE.keyswitch_glwe"
+// CHECK-NOT:  "TFHE.bootstrap_glwe"
+func.func @independent_table_lookups(%arg0: !TFHE.glwe<sk<0,1,2048>>, %arg1: !TFHE.glwe<sk<0,1,2048>>, %lut: tensor<1024xi64>) -> (!TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>) {
+  %0 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %1 = "TFHE.bootstrap_glwe"(%0, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %2 = "TFHE.keyswitch_glwe"(%arg1) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %3 = "TFHE.bootstrap_glwe"(%2, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  return %1, %3 : !TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @different_lookup_tables
+// CHECK:      "TFHE.batched_keyswitch_glwe"
+// CHECK:      %[[LUTS0:.*]] = tensor.insert_slice %arg2 into %{{.*}}[0, 0] [1, 1024] [1, 1] : tensor<1024xi64> into tensor<2x1024xi64>
+// CHECK-NEXT: %[[LUTS1:.*]] = tensor.insert_slice %arg3 into %[[LUTS0]][1, 0] [1, 1024] [1, 1] : tensor<1024xi64> into tensor<2x1024xi64>
+// CHECK-NEXT: "TFHE.batched_mapped_bootstrap_glwe"(%{{.*}}, %[[LUTS1]])
+func.func @different_lookup_tables(%arg0: !TFHE.glwe<sk<0,1,2048>>, %arg1: !TFHE.glwe<sk<0,1,2048>>, %lut0: tensor<1024xi64>, %lut1: tensor<1024xi64>) -> (!TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>) {
+  %0 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %1 = "TFHE.bootstrap_glwe"(%0, %lut0) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %2 = "TFHE.keyswitch_glwe"(%arg1) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %3 = "TFHE.bootstrap_glwe"(%2, %lut1) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  return %1, %3 : !TFHE.glwe<sk<0,1,2048>>, !TFHE.glwe<sk<0,1,2048>>
+}
+
+// -----
+
+// CHECK-LABEL: func.func @dependent_table_lookups
+// CHECK-NOT: "TFHE.batched_keyswitch_glwe"
+// CHECK-NOT: "TFHE.batched_bootstrap_glwe"
+func.func @dependent_table_lookups(%arg0: !TFHE.glwe<sk<0,1,2048>>, %lut: tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>> {
+  %0 = "TFHE.keyswitch_glwe"(%arg0) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %1 = "TFHE.bootstrap_glwe"(%0, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  %2 = "TFHE.keyswitch_glwe"(%1) {key = #TFHE.ksk<sk<0,1,2048>, sk<1,1,750>, 3, 4>} : (!TFHE.glwe<sk<0,1,2048>>) -> !TFHE.glwe<sk<1,1,750>>
+  %3 = "TFHE.bootstrap_glwe"(%2, %lut) {key = #TFHE.bsk<sk<1,1,750>, sk<0,1,2048>, 1024, 2, 1, 23>} : (!TFHE.glwe<sk<1,1,750>>, tensor<1024xi64>) -> !TFHE.glwe<sk<0,1,2048>>
+  return %3 : !TFHE.glwe<sk<0,1,2048>>
+}
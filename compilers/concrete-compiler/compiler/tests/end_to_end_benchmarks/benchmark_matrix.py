@@ -0,0 +1,171 @@
+"""
+benchmark_matrix
+----------------
+
+Run the same end to end benchmarks on each backend configuration, and report
+their latencies and throughputs side by side.
+
+Each configuration runs `end_to_end_benchmark` on the given description files,
+and `end_to_end_mlbench` on the mlbench description files if given. The raw
+results are kept in the output directory, with a summary of the latency of
+each evaluation, and of the requests per second of the throughput benchmarks
+when they are run, by program and configuration.
+"""
+import argparse
+import json
+import os
+import pathlib
+import subprocess
+import sys
+
+# The options of end_to_end_benchmark, the name of the options registered by
+# end_to_end_mlbench, and the environment of each configuration
+CONFIGURATIONS = {
+    "cpu-sequential": (["--backend=cpu", "--loop-parallelize=0"], "sequential", {}),
+    "cpu-loop": (["--backend=cpu", "--loop-parallelize=1"], "loop", {}),
+    "cpu-dataflow": (["--backend=cpu", "--dataflow-parallelize=1"], "dataflow", {}),
+    "gpu-wrappers": (["--backend=cpu", "--emit-gpu-ops=1"], "gpu", {}),
+    "gpu-sdfg": (["--backend=gpu"], "sdfg", {"SDFG_NUM_GPUS": "1"}),
+    # All the available GPUs
+    "multi-gpu": (["--backend=gpu"], "sdfg", {"SDFG_NUM_GPUS": None}),
+}
+
+parser = argparse.ArgumentParser()
+parser.add_argument('descriptions', nargs='*',
+                    help='End to end description files run by end_to_end_benchmark')
+parser.add_argument('--benchmark', dest='benchmark', required=True,
+                    help='Path of end_to_end_benchmark')
+parser.add_argument('--mlbench', dest='mlbench',
+                    help='Path of end_to_end_mlbench')
+parser.add_argument('--mlbench-descriptions', dest='mlbench_descriptions', nargs='*',
+                    default=[], help='Description files run by end_to_end_mlbench')
+parser.add_argument('-c', '--configurations', dest='configurations',
+                    default=','.join(CONFIGURATIONS),
+                    help='Comma separated configurations to run, among: '
+                         + ', '.join(CONFIGURATIONS))
+parser.add_argument('--clients', dest='clients',
+                    help='Comma separated numbers of concurrent clients of the throughput '
+                         'benchmarks, which are not run if not set')
+parser.add_argument('-o', '--output-dir', dest='output_dir', default='benchmarks_matrix',
+                    help='Directory of the raw results and of the summary')
+
+
+def run(command, environment, output):
+    """
+    Run a google benchmark binary, its results being written to `output`.
+    """
+    env = dict(os.environ)
+    for name, value in environment.items():
+        if value is None:
+            env.pop(name, None)
+        else:
+            env[name] = value
+    command = command + [f"--benchmark_out={output}", "--benchmark_out_format=json"]
+    print(" ".join(command), flush=True)
+    subprocess.run(command, env=env, check=True)
+
+
+def run_configuration(args, name, output_dir):
+    """
+    Run the benchmarks of a configuration, and return the paths of their results.
+    """
+    options, mlbench_options, environment = CONFIGURATIONS[name]
+    results = []
+
+    if args.descriptions:
+        output = output_dir / f"{name}.json"
+        command = [args.benchmark] + options + ["--bench=evaluate"]
+        if args.clients:
+            command += ["--bench=throughput", f"--clients={args.clients}"]
+        run(command + args.descriptions, environment, output)
+        results.append(output)
+
+    if args.mlbench:
+        for i, description in enumerate(args.mlbench_descriptions):
+            output = output_dir / f"{name}-mlbench-{i}.json"
+            mlbench_environment = dict(environment)
+            mlbench_environment.update({
+                "BENCHMARK_NAME": "MLBench",
+                "BENCHMARK_FILE": description,
+                "BENCHMARK_STACK": "1000000000",
+            })
+            command = [args.mlbench, f"--benchmark_filter=/Evaluate/{mlbench_options}/"]
+            run(command, mlbench_environment, output)
+            results.append(output)
+
+    return results
+
+
+def parse_results(path):
+    """
+    Parse the raw results of a configuration.
+
+    :return: :class:`dict` of the latency in milliseconds ("latency_ms") and of the requests per
+        second ("requests_per_second"), by program
+    """
+    to_ms = {"ns": 1e-6, "us": 1e-3, "ms": 1.0, "s": 1e3}
+    parsed = {}
+    for result in json.loads(path.read_text())["benchmarks"]:
+        # The names are <suite>/<action>/<options>/<description>
+        parts = result["name"].split("/")
+        if len(parts) < 4:
+            continue
+        program = "/".join([parts[0]] + parts[3:])
+        action = parts[1].lower()
+        entry = parsed.setdefault(program, {})
+        if action == "evaluate":
+            entry["latency_ms"] = result["real_time"] * to_ms[result["time_unit"]]
+        elif action.startswith("throughput"):
+            requests_per_second = result.get("requests_per_second")
+            if requests_per_second is not None:
+                best = max(entry.get("requests_per_second", 0), requests_per_second)
+                entry["requests_per_second"] = best
+    return parsed
+
+
+def summarize(matrix, configurations):
+    """
+    Format the latencies and throughputs of each program as a markdown table.
+    """
+    programs = sorted({program for results in matrix.values() for program in results})
+    header = ["program"] + [f"{name} (ms, req/s)" for name in configurations]
+    lines = ["| " + " | ".join(header) + " |", "|" + "---|" * len(header)]
+    for program in programs:
+        cells = [program]
+        for name in configurations:
+            entry = matrix.get(name, {}).get(program, {})
+            latency = entry.get("latency_ms")
+            throughput = entry.get("requests_per_second")
+            cells.append(", ".join([
+                f"{latency:.3f}" if latency is not None else "-",
+                f"{throughput:.2f}" if throughput is not None else "-",
+            ]))
+        lines.append("| " + " | ".join(cells) + " |")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    args = parser.parse_args()
+    configurations = [name for name in args.configurations.split(",") if name]
+    unknown = [name for name in configurations if name not in CONFIGURATIONS]
+    if unknown:
+        print(f"Unknown configurations: {', '.join(unknown)}", file=sys.stderr)
+        sys.exit(1)
+
+    output_dir = pathlib.Path(args.output_dir)
+    output_dir.mkdir(parents=True, exist_ok=True)
+
+    matrix = {}
+    for name in configurations:
+        matrix[name] = {}
+        for path in run_configuration(args, name, output_dir):
+            matrix[name].update(parse_results(path))
+
+    (output_dir / "summary.json").write_text(json.dumps(matrix, indent=2))
+    summary = summarize(matrix, configurations)
+    (output_dir / "summary.md").write_text(summary)
+    print(summary)
+
+
+if __name__ == "__main__":
+    main()
@@ -2,9 +2,15 @@
 #include "concretelang/Common/Compat.h"
 #include "concretelang/TestLib/TestProgram.h"
 #include <concretelang/Runtime/DFRuntime.hpp>
+#include <concretelang/Runtime/Profiler.h>
 
+#include <algorithm>
 #include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
+#include <sys/resource.h>
+#include <thread>
 
 #define BENCHMARK_HAS_CXX11
 #include "llvm/Support/Path.h"
@@ -13,6 +19,7 @@
 #include "tests_tools/keySetCache.h"
 
 using namespace concretelang::testlib;
+namespace profiler = mlir::concretelang::profiler;
 
 #define check(expr)                                                            \
   if (auto E = expr.takeError()) {                                             \
@@ -20,13 +27,74 @@ using namespace concretelang::testlib;
     assert(false && "See error above");                                        \
   }
 
+/// Whether to report the tail latencies of the iterations, and of the runtime
+/// primitives for the evaluation, on top of the mean time
+static bool reportLatencies = false;
+
+static double elapsedUs(std::chrono::steady_clock::time_point start) {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count();
+}
+
+/// Returns the `p`-th percentile of `samples`, by nearest rank.
+static double percentile(std::vector<double> &samples, double p) {
+  size_t rank = std::max<size_t>(1, std::ceil(p / 100 * samples.size()));
+  std::nth_element(samples.begin(), samples.begin() + rank - 1, samples.end());
+  return samples[rank - 1];
+}
+
+/// Reports the p50, p95 and p99 of `samples`, in microseconds, as the
+/// `<prefix>p50_us`, ... counters.
+static void reportPercentiles(benchmark::State &state, std::string prefix,
+                              std::vector<double> samples) {
+  if (samples.empty())
+    return;
+  for (double p : {50, 95, 99}) {
+    std::ostringstream name;
+    name << prefix << "p" << p << "_us";
+    state.counters[name.str()] = percentile(samples, p);
+  }
+}
+
+/// Reports the latencies of the runtime primitives recorded during the
+/// iterations, with their number of calls and their share of the iterations
+/// time per iteration. The primitives running concurrently (e.g. on the
+/// dataflow workers) may add up to more than the iterations time.
+static void reportPrimitives(benchmark::State &state,
+                             const std::vector<double> &iterationsUs) {
+  double totalUs = 0;
+  for (double us : iterationsUs)
+    totalUs += us;
+  std::vector<double> samplesUs[profiler::num_primitives];
+  for (auto &event : profiler::take_events())
+    samplesUs[(size_t)event.primitive].push_back(event.duration_ns * 1e-3);
+  for (size_t i = 0; i < profiler::num_primitives; i++) {
+    auto &samples = samplesUs[i];
+    if (samples.empty())
+      continue;
+    double primitiveUs = 0;
+    for (double us : samples)
+      primitiveUs += us;
+    std::string name = profiler::primitive_name((profiler::Primitive)i);
+    reportPercentiles(state, name + "_", samples);
+    state.counters[name + "_calls"] =
+        (double)samples.size() / iterationsUs.size();
+    state.counters[name + "_share"] = primitiveUs / totalUs;
+  }
+}
+
 /// Benchmark time of the compilation
 static void BM_Compile(benchmark::State &state, EndToEndDesc description,
                        mlir::concretelang::CompilationOptions options) {
   TestProgram tc(options);
+  std::vector<double> latencies;
   for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
     assert(tc.compile(description.program));
+    latencies.push_back(elapsedUs(start));
   }
+  if (reportLatencies)
+    reportPercentiles(state, "", latencies);
 }
 
 /// Benchmark time of the key generation
@@ -35,9 +103,14 @@ static void BM_KeyGen(benchmark::State &state, EndToEndDesc description,
   TestProgram tc(options);
   assert(tc.compile(description.program));
 
+  std::vector<double> latencies;
   for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
     assert(tc.generateKeyset(0, 0, false));
+    latencies.push_back(elapsedUs(start));
   }
+  if (reportLatencies)
+    reportPercentiles(state, "", latencies);
 }
 
 /// Benchmark time of the encryption
@@ -55,13 +128,19 @@ static void BM_ExportArguments(benchmark::State &state,
 
   auto client = tc.getClientCircuit().value();
   if (mlir::concretelang::dfr::_dfr_is_root_node()) {
+    std::vector<double> latencies;
     for (auto _ : state) {
+      auto start = std::chrono::steady_clock::now();
       for (size_t i = 0; i < test.inputs.size(); i++) {
         auto input = client.prepareInput(test.inputs[i].getValue(), i).value();
         inputArguments.push_back(input);
       }
+      latencies.push_back(elapsedUs(start));
     }
     inputArguments.resize(0);
+    if (reportLatencies)
+    if (reportLatencies)
+      reportPercentiles(state, "", latencies);
   }
 }
 
@@ -91,9 +170,111 @@ static void BM_Evaluate(benchmark::State &state, EndToEndDesc description,
   // Warmup
   assert(tc.callServer(inputArguments));
 
+  // The primitives run by the remote nodes of a distributed evaluation are
+  // not recorded
+  profiler::set_enabled(reportLatencies, /*trace=*/true);
+  std::vector<double> latencies;
   for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
     assert(tc.callServer(inputArguments));
+    latencies.push_back(elapsedUs(start));
+  }
+  profiler::set_enabled(false);
+  if (reportLatencies) {
+    reportPercentiles(state, "", latencies);
+    reportPrimitives(state, latencies);
   }
+  profiler::reset();
+}
+
+/// The load of the throughput benchmark: each client sends its requests, of
+/// `batchSize` calls, one after the other, the clients being spread over
+/// `tenants` keysets.
+struct ThroughputLoad {
+  unsigned clients;
+  unsigned tenants;
+  unsigned batchSize;
+};
+
+/// Returns the peak resident memory of the process, in megabytes.
+static double maxResidentMb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024. * 1024.);
+#else
+  return usage.ru_maxrss / 1024.;
+#endif
+}
+
+/// Benchmark the throughput of concurrent clients of one server program. An
+/// iteration is one request per client, the clients running on their own
+/// threads.
+static void BM_Throughput(benchmark::State &state, EndToEndDesc description,
+                          mlir::concretelang::CompilationOptions options,
+                          ThroughputLoad load) {
+  TestProgram tc(options);
+  assert(tc.compile(description.program));
+  assert(description.tests.size() > 0);
+  auto test = description.tests[0];
+
+  // The requests of each tenant, encrypted under its own keyset, which is
+  // empty when simulating
+  std::vector<ServerKeyset> keysets;
+  std::vector<std::vector<std::vector<TransportValue>>> requests;
+  for (unsigned t = 0; t < load.tenants; t++) {
+    assert(tc.generateKeyset(t, t, false));
+    keysets.push_back(tc.getKeyset().value().server);
+    auto clientCircuit = tc.getClientCircuit().value();
+    std::vector<TransportValue> args;
+    for (size_t i = 0; i < test.inputs.size(); i++)
+      args.push_back(
+          clientCircuit.prepareInput(test.inputs[i].getValue(), i).value());
+    requests.push_back(
+        std::vector<std::vector<TransportValue>>(load.batchSize, args));
+  }
+  auto serverCircuit = tc.getServerCircuit().value();
+
+  auto request = [&](unsigned client) {
+    auto &keyset = keysets[client % load.tenants];
+    auto &batch = requests[client % load.tenants];
+    if (load.batchSize == 1) {
+      assert(serverCircuit.call(keyset, batch[0]));
+    } else {
+      // The calls of the batch are not parallelized on top of the clients
+      assert(serverCircuit.callBatch(keyset, batch, 1));
+    }
+  };
+
+  // Warmup, which also prepares the runtime context of each keyset
+  for (unsigned t = 0; t < load.tenants; t++)
+    request(t);
+
+  std::vector<std::vector<double>> latencies(load.clients);
+  for (auto _ : state) {
+    std::vector<std::thread> clients;
+    for (unsigned c = 0; c < load.clients; c++) {
+      clients.emplace_back([&, c] {
+        auto start = std::chrono::steady_clock::now();
+        request(c);
+        latencies[c].push_back(elapsedUs(start));
+      });
+    }
+    for (auto &client : clients)
+      client.join();
+  }
+
+  std::vector<double> allLatencies;
+  for (auto &clientLatencies : latencies)
+    allLatencies.insert(allLatencies.end(), clientLatencies.begin(),
+                        clientLatencies.end());
+  reportPercentiles(state, "latency_", allLatencies);
+  double numRequests = (double)state.iterations() * load.clients;
+  state.counters["requests_per_second"] =
+      benchmark::Counter(numRequests, benchmark::Counter::kIsRate);
+  state.counters["calls_per_second"] = benchmark::Counter(
+      numRequests * load.batchSize, benchmark::Counter::kIsRate);
+  state.counters["max_rss_mb"] = maxResidentMb();
 }
 
 enum Action {
@@ -101,12 +282,14 @@ enum Action {
   KEYGEN,
   ENCRYPT,
   EVALUATE,
+  THROUGHPUT,
 };
 
 void registerEndToEndBenchmark(std::string suiteName,
                                std::vector<EndToEndDesc> descriptions,
                                mlir::concretelang::CompilationOptions options,
                                std::vector<enum Action> actions,
+                               std::vector<ThroughputLoad> loads,
                                size_t stackSizeRequirement = 0,
                                int num_iterations = 0) {
   auto optionsName = getOptionsName(options);
@@ -142,7 +325,7 @@ void registerEndToEndBenchmark(std::string suiteName,
               BM_ExportArguments(st, description, options);
             });
         break;
-      case Action::EVALUATE:
+      case Action::EVALUATE: {
         auto bench = benchmark::RegisterBenchmark(
             benchName("evaluate").c_str(), [=](::benchmark::State &st) {
               BM_Evaluate(st, description, options);
@@ -151,6 +334,22 @@ void registerEndToEndBenchmark(std::string suiteName,
           bench->Iterations(num_iterations);
         break;
       }
+      case Action::THROUGHPUT:
+        for (auto load : loads) {
+          std::ostringstream name;
+          name << "throughput-c" << load.clients << "-t" << load.tenants
+               << "-b" << load.batchSize;
+          // The requests per second are relative to the wall time, the
+          // clients running concurrently
+          benchmark::RegisterBenchmark(
+              benchName(name.str()).c_str(),
+              [=](::benchmark::State &st) {
+                BM_Throughput(st, description, options, load);
+              })
+              ->UseRealTime();
+        }
+        break;
+      }
     }
   }
   setCurrentStackLimit(stackSizeRequirement);
@@ -170,25 +369,55 @@ int main(int argc, char **argv) {
       llvm::cl::values(
           clEnumValN(Action::ENCRYPT, "encrypt", "Run encrypt benchmark")),
       llvm::cl::values(
-          clEnumValN(Action::EVALUATE, "evaluate", "Run evaluate benchmark")));
+          clEnumValN(Action::EVALUATE, "evaluate", "Run evaluate benchmark")),
+      llvm::cl::values(clEnumValN(
+          Action::THROUGHPUT, "throughput",
+          "Run throughput benchmark of concurrent clients (not run by "
+          "default)")));
+  llvm::cl::opt<bool> latencies(
+      "latencies",
+      llvm::cl::desc("Report the p50/p95/p99 latencies of each benchmark, "
+                     "and of the runtime primitives for evaluate"),
+      llvm::cl::init(false));
+  llvm::cl::list<unsigned> clients(
+      "clients",
+      llvm::cl::desc("Numbers of concurrent clients of the throughput "
+                     "benchmark, one benchmark each (default: 1)"),
+      llvm::cl::CommaSeparated);
+  llvm::cl::opt<unsigned> tenants(
+      "tenants",
+      llvm::cl::desc("Number of keysets shared by the clients of the "
+                     "throughput benchmark"),
+      llvm::cl::init(1));
+  llvm::cl::opt<unsigned> batchSize(
+      "batch-size",
+      llvm::cl::desc("Number of calls of each request of the throughput "
+                     "benchmark"),
+      llvm::cl::init(1));
 
   // parse end to end test compiler options
   auto options = parseEndToEndCommandLine(argc, argv);
 
   auto descriptionFiles = std::get<1>(options);
+  reportLatencies = latencies.getValue();
 
   std::vector<enum Action> actions = clActions;
   if (actions.empty()) {
     actions = {Action::COMPILE, Action::KEYGEN, Action::ENCRYPT,
                Action::EVALUATE};
   }
+  std::vector<ThroughputLoad> loads;
+  for (unsigned numClients : clients)
+    loads.push_back({numClients, tenants.getValue(), batchSize.getValue()});
+  if (loads.empty())
+    loads.push_back({1, tenants.getValue(), batchSize.getValue()});
 
   auto stackSizeRequirement = 0;
   for (auto descFile : descriptionFiles) {
     auto suiteName = llvm::sys::path::stem(descFile.path).str();
     registerEndToEndBenchmark(suiteName, descFile.descriptions,
                               std::get<0>(options).compilationOptions, actions,
-                              stackSizeRequirement,
+                              loads, stackSizeRequirement,
                               std::get<0>(options).numIterations);
   }
   ::benchmark::RunSpecifiedBenchmarks();
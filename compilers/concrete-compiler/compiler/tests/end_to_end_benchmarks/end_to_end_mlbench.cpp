@@ -159,6 +159,9 @@ static int registerEndToEndTestFromFile(std::string prefix, std::string path,
   setCurrentStackLimit(stackSizeRequirement);
   mlir::concretelang::CompilationOptions defaul;
   registe("default", defaul);
+  mlir::concretelang::CompilationOptions sequential;
+  sequential.loopParallelize = false;
+  registe("sequential", sequential);
   mlir::concretelang::CompilationOptions loop;
   loop.loopParallelize = true;
   registe("loop", loop);
@@ -166,6 +169,10 @@ static int registerEndToEndTestFromFile(std::string prefix, std::string path,
   mlir::concretelang::CompilationOptions gpu;
   gpu.emitGPUOps = true;
   registe("gpu", gpu);
+  // The batched operations scheduled on the GPUs by the SDFG runtime
+  mlir::concretelang::CompilationOptions sdfg(
+      mlir::concretelang::Backend::GPU);
+  registe("sdfg", sdfg);
 #endif
 #ifdef CONCRETELANG_DATAFLOW_EXECUTION_ENABLED
   mlir::concretelang::CompilationOptions dataflow;
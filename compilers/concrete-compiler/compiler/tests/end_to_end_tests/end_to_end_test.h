@@ -65,6 +65,11 @@ parseEndToEndCommandLine(int argc, char **argv) {
       "emit-gpu-ops",
       llvm::cl::desc("Set the emitGPUOps compilation options to run the tests"),
       llvm::cl::init(-1));
+  llvm::cl::opt<int> emitSDFGOps(
+      "emit-sdfg-ops",
+      llvm::cl::desc("Set the emitSDFGOps compilation options to run the "
+                     "tests, 0 calling the GPU wrappers directly"),
+      llvm::cl::init(-1));
   llvm::cl::opt<int> batchTFHEOps(
       "batch-tfhe-ops",
       llvm::cl::desc(
@@ -154,6 +159,8 @@ parseEndToEndCommandLine(int argc, char **argv) {
     compilationOptions.dataflowParallelize = dataflowParallelize.getValue();
   if (emitGPUOps.getValue() != -1)
     compilationOptions.emitGPUOps = emitGPUOps.getValue();
+  if (emitSDFGOps.getValue() != -1)
+    compilationOptions.emitSDFGOps = emitSDFGOps.getValue();
   if (batchTFHEOps.getValue() != -1)
     compilationOptions.batchTFHEOps = batchTFHEOps.getValue();
   compilationOptions.simulate = simulate.getValue();
@@ -244,6 +251,8 @@ std::string getOptionsName(mlir::concretelang::CompilationOptions compilation) {
   /// GPU
   if (compilation.emitGPUOps != defaultOptions.emitGPUOps)
     os << "_gpu" << compilation.emitGPUOps;
+  if (compilation.emitSDFGOps != defaultOptions.emitSDFGOps)
+    os << "_sdfg" << compilation.emitSDFGOps;
   auto ostr = os.str();
 
   if (ostr.size() == 0) {
@@ -242,6 +242,19 @@ def test_lib_compilation_artifacts():
     assert not os.path.exists(engine.get_shared_lib_path())
 
 
+@pytest.mark.parametrize("mlir_input, args, expected_result", end_to_end_fixture[:1])
+def test_lib_compile_from_library_cache(mlir_input, args, expected_result, keyset_cache):
+    cache_dir = "./py_test_library_cache"
+    options = CompilationOptions.new()
+    options.set_library_cache_dir(cache_dir)
+    for artifact_dir in ["./py_test_library_cache_miss", "./py_test_library_cache_hit"]:
+        engine = LibrarySupport.new(artifact_dir)
+        compile_run_assert(engine, mlir_input, args, expected_result, keyset_cache, options)
+        shutil.rmtree(artifact_dir)
+    assert len(os.listdir(cache_dir)) == 1
+    shutil.rmtree(cache_dir)
+
+
 def test_multi_circuits(keyset_cache):
     from mlir._mlir_libs._concretelang._compiler import OptimizerStrategy
 
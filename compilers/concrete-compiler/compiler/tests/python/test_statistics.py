@@ -5,6 +5,7 @@ import tempfile
 
 from concrete.compiler import (
     ClientSupport,
+    CompilationOptions,
     EvaluationKeys,
     KeySet,
     LibrarySupport,
@@ -75,3 +76,63 @@ module {
             )
         )
         assert pbs_counts_per_tag_per_parameter == {}
+
+
+def test_predicted_runtime():
+    mlir = """
+
+func.func @main(%arg0: !FHE.eint<3>) -> !FHE.eint<6> {
+  %cst = arith.constant dense<[0, 1, 4, 9, 16, 25, 36, 49]> : tensor<8xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %cst) : (!FHE.eint<3>, tensor<8xi64>) -> !FHE.eint<6>
+  return %0 : !FHE.eint<6>
+}
+
+    """.strip()
+
+    with tempfile.TemporaryDirectory() as tmpdirname:
+        cost_table = f"{tmpdirname}/cost_table"
+        with open(cost_table, "w") as f:
+            f.write("ks 2048 750 3 4 20000\npbs 750 1 11 1 23 5000000\n")
+        options = CompilationOptions.new()
+        options.set_prediction_cost_table(cost_table)
+        options.set_prediction_workers(1)
+
+        support = LibrarySupport.new(str(tmpdirname))
+        compilation_result = support.compile(mlir, options)
+        compilation_feedback = support.load_compilation_feedback(
+            compilation_result
+        ).circuit("main")
+
+        # A single keyswitch and bootstrap, run one after the other
+        assert compilation_feedback.predicted_latency > 0
+        assert compilation_feedback.predicted_throughput == pytest.approx(
+            1 / compilation_feedback.predicted_latency
+        )
+
+
+def test_analyzed_noise():
+    mlir = """
+
+func.func @main(%arg0: !FHE.eint<3>, %arg1: !FHE.eint<3>) -> (!FHE.eint<6>, !FHE.eint<3>) {
+  %cst = arith.constant dense<[0, 1, 4, 9, 16, 25, 36, 49]> : tensor<8xi64>
+  %0 = "FHE.apply_lookup_table"(%arg0, %cst) : (!FHE.eint<3>, tensor<8xi64>) -> !FHE.eint<6>
+  %1 = "FHE.add_eint"(%arg0, %arg1) : (!FHE.eint<3>, !FHE.eint<3>) -> !FHE.eint<3>
+  return %0, %1 : !FHE.eint<6>, !FHE.eint<3>
+}
+
+    """.strip()
+
+    with tempfile.TemporaryDirectory() as tmpdirname:
+        options = CompilationOptions.new()
+        options.set_analyze_noise(True)
+
+        support = LibrarySupport.new(str(tmpdirname))
+        compilation_result = support.compile(mlir, options)
+        compilation_feedback = support.load_compilation_feedback(
+            compilation_result
+        ).circuit("main")
+
+        # The optimizer bounds the error probability of every bootstrap
+        probabilities = compilation_feedback.output_error_probabilities
+        assert len(probabilities) == 2
+        assert all(0 <= p < 0.01 for p in probabilities)
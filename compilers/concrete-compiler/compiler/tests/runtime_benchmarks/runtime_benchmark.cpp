@@ -0,0 +1,396 @@
+// Part of the Concrete Compiler Project, under the BSD3 License with Zama
+// Exceptions. See
+// https://github.com/zama-ai/concrete/blob/main/LICENSE.txt
+// for license information.
+
+/// Micro-benchmarks of the runtime wrappers, called directly on buffers of
+/// the right shapes rather than from compiled circuits, so that a regression
+/// of a primitive is measured apart from the compilation pipeline.
+///
+/// The keys of each parameter set are generated on the first benchmark using
+/// them, outside of the measured loop, and shared by the following ones.
+
+#include "concretelang/Common/Csprng.h"
+#include "concretelang/Common/Keysets.h"
+#include "concretelang/Common/Transformers.h"
+#include "concretelang/Common/Values.h"
+#include "concretelang/Runtime/context.h"
+#include "concretelang/Runtime/wrappers.h"
+
+#include <benchmark/benchmark.h>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using concretelang::keysets::Keyset;
+using concretelang::transformers::TransformerFactory;
+using concretelang::values::Tensor;
+using concretelang::values::Value;
+using mlir::concretelang::RuntimeContext;
+
+#define check(expr)                                                            \
+  if (expr.has_failure()) {                                                    \
+    std::cerr << "Error: " << expr.as_failure().error().mesg << "\n";          \
+    assert(false && "See error above");                                        \
+  }
+
+/// Noise does not change the timings, so every key uses the same variance
+static const double variance = std::pow(2., -100);
+
+/// The ids of the secret keys, and the index of the evaluation keys which are
+/// the only ones of their kind.
+static const uint32_t bigKeyId = 0;
+static const uint32_t smallKeyId = 1;
+static const uint32_t keyIndex = 0;
+
+struct ParameterSet {
+  std::string name;
+  uint32_t glweDimension;
+  uint32_t polynomialSize;
+  uint32_t lweDimension;
+  uint32_t pbsLevel;
+  uint32_t pbsBaseLog;
+  uint32_t ksLevel;
+  uint32_t ksBaseLog;
+  /// The circuit bootstrap and private packing keyswitch decompositions, the
+  /// set only being used by the WoP-PBS if they are not 0
+  uint32_t cbsLevel = 0;
+  uint32_t cbsBaseLog = 0;
+  uint32_t ppLevel = 0;
+  uint32_t ppBaseLog = 0;
+
+  uint32_t bigDimension() const { return glweDimension * polynomialSize; }
+};
+
+/// Parameters of v0-parameters, for the classical PBS of 2, 4, 6 and 8 bits
+/// and for the WoP-PBS of 3 bits blocks
+static const std::vector<ParameterSet> parameterSets = {
+    {"2bits", 5, 256, 670, 1, 15, 3, 4},
+    {"4bits", 2, 1024, 784, 1, 23, 3, 4},
+    {"6bits", 1, 4096, 860, 1, 22, 4, 4},
+    {"8bits", 1, 16384, 982, 2, 15, 5, 4},
+    {"wop_3bits", 2, 1024, 688, 2, 15, 6, 2, 2, 7, 1, 25},
+};
+
+/// The moduli of the CRT blocks of the WoP-PBS benchmarks
+static const std::vector<uint64_t> crtDecomposition = {7, 8};
+
+static void setSecretKeyInfo(concreteprotocol::LweSecretKeyInfo::Builder info,
+                             uint32_t id, uint32_t dimension) {
+  info.setId(id);
+  auto params = info.initParams();
+  params.setIntegerPrecision(64);
+  params.setLweDimension(dimension);
+  params.setKeyType(concreteprotocol::KeyType::BINARY);
+}
+
+static Message<concreteprotocol::KeysetInfo>
+keysetInfo(const ParameterSet &set) {
+  auto output = Message<concreteprotocol::KeysetInfo>();
+
+  auto secretKeys = output.asBuilder().initLweSecretKeys(2);
+  setSecretKeyInfo(secretKeys[bigKeyId], bigKeyId, set.bigDimension());
+  setSecretKeyInfo(secretKeys[smallKeyId], smallKeyId, set.lweDimension);
+
+  auto ksk = output.asBuilder().initLweKeyswitchKeys(1)[0];
+  ksk.setId(keyIndex);
+  ksk.setInputId(bigKeyId);
+  ksk.setOutputId(smallKeyId);
+  ksk.setCompression(concreteprotocol::Compression::NONE);
+  auto kskParams = ksk.initParams();
+  kskParams.setLevelCount(set.ksLevel);
+  kskParams.setBaseLog(set.ksBaseLog);
+  kskParams.setVariance(variance);
+  kskParams.setIntegerPrecision(64);
+  kskParams.setInputLweDimension(set.bigDimension());
+  kskParams.setOutputLweDimension(set.lweDimension);
+  kskParams.setKeyType(concreteprotocol::KeyType::BINARY);
+  kskParams.initModulus().initMod().initNative();
+
+  auto bsk = output.asBuilder().initLweBootstrapKeys(1)[0];
+  bsk.setId(keyIndex);
+  bsk.setInputId(smallKeyId);
+  bsk.setOutputId(bigKeyId);
+  bsk.setCompression(concreteprotocol::Compression::NONE);
+  auto bskParams = bsk.initParams();
+  bskParams.setLevelCount(set.pbsLevel);
+  bskParams.setBaseLog(set.pbsBaseLog);
+  bskParams.setGlweDimension(set.glweDimension);
+  bskParams.setPolynomialSize(set.polynomialSize);
+  bskParams.setInputLweDimension(set.lweDimension);
+  bskParams.setVariance(variance);
+  bskParams.setIntegerPrecision(64);
+  bskParams.setKeyType(concreteprotocol::KeyType::BINARY);
+  bskParams.initModulus().initMod().initNative();
+
+  if (set.ppLevel == 0) {
+    output.asBuilder().initPackingKeyswitchKeys(0);
+    return output;
+  }
+  auto pksk = output.asBuilder().initPackingKeyswitchKeys(1)[0];
+  pksk.setId(keyIndex);
+  pksk.setInputId(bigKeyId);
+  pksk.setOutputId(bigKeyId);
+  pksk.setCompression(concreteprotocol::Compression::NONE);
+  auto pkskParams = pksk.initParams();
+  pkskParams.setLevelCount(set.ppLevel);
+  pkskParams.setBaseLog(set.ppBaseLog);
+  pkskParams.setGlweDimension(set.glweDimension);
+  pkskParams.setPolynomialSize(set.polynomialSize);
+  pkskParams.setInputLweDimension(set.bigDimension());
+  pkskParams.setInnerLweDimension(set.bigDimension());
+  pkskParams.setVariance(variance);
+  pkskParams.setIntegerPrecision(64);
+  pkskParams.setKeyType(concreteprotocol::KeyType::BINARY);
+  pkskParams.initModulus().initMod().initNative();
+  return output;
+}
+
+/// Returns the context of the keys of `set`, generating them on the first
+/// call.
+static RuntimeContext *context(const ParameterSet &set) {
+  static std::map<std::string, std::unique_ptr<RuntimeContext>> contexts;
+  auto &context = contexts[set.name];
+  if (context == nullptr) {
+    concretelang::csprng::SecretCSPRNG secretCsprng(0);
+    concretelang::csprng::EncryptionCSPRNG encryptionCsprng(0);
+    Keyset keyset(keysetInfo(set), secretCsprng, encryptionCsprng);
+    context = std::make_unique<RuntimeContext>(keyset.server);
+  }
+  return context.get();
+}
+
+/// Runs a wrapper once so that the lazy conversions of the context, e.g. of
+/// the bootstrap key to the fourier domain, are not measured.
+template <typename F> static void warmUp(F &&wrapper) { wrapper(); }
+
+static void BM_Keyswitch(benchmark::State &state, ParameterSet set) {
+  auto ctx = context(set);
+  uint64_t inSize = set.bigDimension() + 1, outSize = set.lweDimension + 1;
+  std::vector<uint64_t> in(inSize), out(outSize);
+  for (auto _ : state) {
+    memref_keyswitch_lwe_u64(out.data(), out.data(), 0, outSize, 1, in.data(),
+                             in.data(), 0, inSize, 1, set.ksLevel,
+                             set.ksBaseLog, set.bigDimension(),
+                             set.lweDimension, keyIndex, ctx);
+  }
+}
+
+static void BM_BatchedKeyswitch(benchmark::State &state, ParameterSet set) {
+  auto ctx = context(set);
+  uint64_t batch = state.range(0);
+  uint64_t inSize = set.bigDimension() + 1, outSize = set.lweDimension + 1;
+  std::vector<uint64_t> in(batch * inSize), out(batch * outSize);
+  for (auto _ : state) {
+    memref_batched_keyswitch_lwe_u64(
+        out.data(), out.data(), 0, batch, outSize, outSize, 1, in.data(),
+        in.data(), 0, batch, inSize, inSize, 1, set.ksLevel, set.ksBaseLog,
+        set.bigDimension(), set.lweDimension, keyIndex, ctx);
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static void BM_Bootstrap(benchmark::State &state, ParameterSet set) {
+  auto ctx = context(set);
+  uint64_t inSize = set.lweDimension + 1, outSize = set.bigDimension() + 1;
+  std::vector<uint64_t> in(inSize), out(outSize), lut(set.polynomialSize);
+  auto bootstrap = [&]() {
+    memref_bootstrap_lwe_u64(
+        out.data(), out.data(), 0, outSize, 1, in.data(), in.data(), 0, inSize,
+        1, lut.data(), lut.data(), 0, lut.size(), 1, set.lweDimension,
+        set.polynomialSize, set.pbsLevel, set.pbsBaseLog, set.glweDimension,
+        keyIndex, ctx);
+  };
+  warmUp(bootstrap);
+  for (auto _ : state)
+    bootstrap();
+}
+
+static void BM_BatchedBootstrap(benchmark::State &state, ParameterSet set) {
+  auto ctx = context(set);
+  uint64_t batch = state.range(0);
+  uint64_t inSize = set.lweDimension + 1, outSize = set.bigDimension() + 1;
+  std::vector<uint64_t> in(batch * inSize), out(batch * outSize),
+      lut(set.polynomialSize);
+  auto bootstrap = [&]() {
+    memref_batched_bootstrap_lwe_u64(
+        out.data(), out.data(), 0, batch, outSize, outSize, 1, in.data(),
+        in.data(), 0, batch, inSize, inSize, 1, lut.data(), lut.data(), 0,
+        lut.size(), 1, set.lweDimension, set.polynomialSize, set.pbsLevel,
+        set.pbsBaseLog, set.glweDimension, keyIndex, ctx);
+  };
+  warmUp(bootstrap);
+  for (auto _ : state)
+    bootstrap();
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static void BM_BatchedAdd(benchmark::State &state, ParameterSet set) {
+  uint64_t batch = state.range(0), size = set.bigDimension() + 1;
+  std::vector<uint64_t> lhs(batch * size), rhs(batch * size),
+      out(batch * size);
+  for (auto _ : state) {
+    memref_batched_add_lwe_ciphertexts_u64(
+        out.data(), out.data(), 0, batch, size, size, 1, lhs.data(),
+        lhs.data(), 0, batch, size, size, 1, rhs.data(), rhs.data(), 0, batch,
+        size, size, 1);
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static void BM_BatchedMulCleartext(benchmark::State &state,
+                                   ParameterSet set) {
+  uint64_t batch = state.range(0), size = set.bigDimension() + 1;
+  std::vector<uint64_t> ct(batch * size), out(batch * size),
+      cleartexts(batch, 3);
+  for (auto _ : state) {
+    memref_batched_mul_cleartext_lwe_ciphertext_u64(
+        out.data(), out.data(), 0, batch, size, size, 1, ct.data(), ct.data(),
+        0, batch, size, size, 1, cleartexts.data(), cleartexts.data(), 0,
+        batch, 1);
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static void BM_EncodeExpandLut(benchmark::State &state, ParameterSet set) {
+  uint32_t bits = state.range(0);
+  std::vector<uint64_t> lut(1 << bits), out(set.polynomialSize);
+  for (size_t i = 0; i < lut.size(); i++)
+    lut[i] = i;
+  for (auto _ : state) {
+    memref_encode_expand_lut_for_bootstrap(out.data(), out.data(), 0,
+                                           out.size(), 1, lut.data(),
+                                           lut.data(), 0, lut.size(), 1,
+                                           set.polynomialSize, bits, false);
+  }
+}
+
+static void BM_WopPbsCrt(benchmark::State &state, ParameterSet set) {
+  auto ctx = context(set);
+  uint64_t blocks = crtDecomposition.size(), size = set.bigDimension() + 1;
+  uint64_t bits = 0;
+  for (auto modulus : crtDecomposition)
+    bits += std::ceil(std::log2(modulus));
+  std::vector<uint64_t> in(blocks * size), out(blocks * size),
+      lut(blocks << bits), crt(crtDecomposition);
+  auto wopPbs = [&]() {
+    memref_wop_pbs_crt_buffer(
+        out.data(), out.data(), 0, blocks, size, size, 1, in.data(),
+        in.data(), 0, blocks, size, size, 1, lut.data(), lut.data(), 0,
+        blocks, 1 << bits, 1 << bits, 1, crt.data(), crt.data(), 0, blocks,
+        1, set.lweDimension, set.cbsLevel, set.cbsBaseLog, set.ksLevel,
+        set.ksBaseLog, set.pbsLevel, set.pbsBaseLog, set.ppLevel,
+        set.ppBaseLog, set.polynomialSize, keyIndex, keyIndex, keyIndex, ctx);
+  };
+  warmUp(wopPbs);
+  for (auto _ : state)
+    wopPbs();
+}
+
+/// Returns the gate info of a tensor of `batch` ciphertexts of the big key.
+static Message<concreteprotocol::GateInfo> gateInfo(const ParameterSet &set,
+                                                    uint32_t batch) {
+  auto output = Message<concreteprotocol::GateInfo>();
+  auto rawInfo = output.asBuilder().initRawInfo();
+  auto rawDimensions = rawInfo.initShape().initDimensions(2);
+  rawDimensions.set(0, batch);
+  rawDimensions.set(1, set.bigDimension() + 1);
+  rawInfo.setIntegerPrecision(64);
+  rawInfo.setIsSigned(false);
+
+  auto lwe = output.asBuilder().initTypeInfo().initLweCiphertext();
+  lwe.initAbstractShape().initDimensions(1).set(0, batch);
+  lwe.setConcreteShape(rawInfo.getShape().asReader());
+  lwe.setIntegerPrecision(64);
+  auto encryption = lwe.initEncryption();
+  encryption.setKeyId(bigKeyId);
+  encryption.setVariance(variance);
+  encryption.setLweDimension(set.bigDimension());
+  encryption.initModulus().initMod().initNative();
+  lwe.setCompression(concreteprotocol::Compression::NONE);
+  auto encoding = lwe.initEncoding().initInteger();
+  encoding.setWidth(4);
+  encoding.setIsSigned(false);
+  encoding.initMode().initNative();
+  return output;
+}
+
+/// Measures the transformation of the results of a call into transport
+/// values, and back into arguments of a call.
+static void BM_Transformers(benchmark::State &state, ParameterSet set) {
+  uint32_t batch = state.range(0);
+  auto info = gateInfo(set, batch);
+  auto returnTransformer =
+      TransformerFactory::getLweCiphertextReturnTransformer(info, false);
+  check(returnTransformer);
+  auto argTransformer =
+      TransformerFactory::getLweCiphertextArgTransformer(info, false);
+  check(argTransformer);
+  auto ciphertexts = Tensor<uint64_t>::fromDimensions(
+      {batch, set.bigDimension() + 1});
+  for (auto _ : state) {
+    auto transportValue = returnTransformer.value()(Value(ciphertexts));
+    check(transportValue);
+    auto value = argTransformer.value()(transportValue.value());
+    check(value);
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static const std::vector<int64_t> batchSizes = {1, 16, 128};
+
+int main(int argc, char **argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  for (auto &set : parameterSets) {
+    auto name = [&](std::string benchmark) {
+      return benchmark + "/" + set.name;
+    };
+    if (set.ppLevel != 0) {
+      benchmark::RegisterBenchmark(name("wop_pbs_crt").c_str(), BM_WopPbsCrt,
+                                   set)
+          ->Unit(benchmark::kMillisecond);
+      continue;
+    }
+    benchmark::RegisterBenchmark(name("keyswitch").c_str(), BM_Keyswitch,
+                                 set)
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(name("batched_keyswitch").c_str(),
+                                 BM_BatchedKeyswitch, set)
+        ->ArgsProduct({batchSizes})
+        ->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark(name("bootstrap").c_str(), BM_Bootstrap, set)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(name("batched_bootstrap").c_str(),
+                                 BM_BatchedBootstrap, set)
+        ->ArgsProduct({batchSizes})
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(name("batched_add").c_str(), BM_BatchedAdd,
+                                 set)
+        ->ArgsProduct({batchSizes});
+    benchmark::RegisterBenchmark(name("batched_mul_cleartext").c_str(),
+                                 BM_BatchedMulCleartext, set)
+        ->ArgsProduct({batchSizes});
+    // The mega cases of the expanded table hold at least 2 coefficients
+    auto encodeExpandLut = benchmark::RegisterBenchmark(
+        name("encode_expand_lut").c_str(), BM_EncodeExpandLut, set);
+    for (int64_t bits : {2, 4, 6, 8})
+      if ((2 << bits) <= set.polynomialSize)
+        encodeExpandLut->Arg(bits);
+    benchmark::RegisterBenchmark(name("transformers").c_str(),
+                                 BM_Transformers, set)
+        ->ArgsProduct({batchSizes})
+        ->Unit(benchmark::kMicrosecond);
+  }
+
+  ::benchmark::RunSpecifiedBenchmarks();
+  ::benchmark::Shutdown();
+  return 0;
+}
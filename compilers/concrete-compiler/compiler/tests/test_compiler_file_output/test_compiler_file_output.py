@@ -88,3 +88,51 @@ def test_compile_many_library():
     assert 0 == result.returncode
 
     remove(ALL_ARTIFACTS, EXE)
+
+
+def test_compile_library_with_object_cache():
+    remove(ALL_ARTIFACTS)
+    object_cache = f"{TEST_PATH}/object_cache"
+    cache_option = f"--object-cache-dir={object_cache}"
+
+    run(CONCRETECOMPILER, SOURCE_1, "--action=compile", cache_option, "-o", ARTIFACTS_DIR)
+    cached_objects = sorted(os.listdir(object_cache))
+    assert len(cached_objects) > 0
+
+    # The recompilation reuses the cached objects
+    remove(ALL_ARTIFACTS)
+    run(CONCRETECOMPILER, SOURCE_1, "--action=compile", cache_option, "-o", ARTIFACTS_DIR)
+    assert sorted(os.listdir(object_cache)) == cached_objects
+
+    EXE = "./main.exe"
+    remove(EXE)
+    run(CCOMPILER, "-o", EXE, SOURCE_C_1, LIB_DYNAMIC)
+
+    result = subprocess.run([EXE], capture_output=True)
+    assert 13 == result.returncode
+
+    remove(ALL_ARTIFACTS, EXE, [f"{object_cache}/{name}" for name in cached_objects])
+    os.rmdir(object_cache)
+
+
+def test_compile_library_with_parallel_codegen():
+    remove(ALL_ARTIFACTS)
+
+    run(
+        CONCRETECOMPILER,
+        SOURCE_1,
+        "--action=compile",
+        "--codegen-threads=0",
+        "--codegen-max-optimized-size=1",
+        "-o",
+        ARTIFACTS_DIR,
+    )
+
+    EXE = "./main.exe"
+    remove(EXE)
+    run(CCOMPILER, "-o", EXE, SOURCE_C_1, LIB_DYNAMIC)
+
+    result = subprocess.run([EXE], capture_output=True)
+    assert 13 == result.returncode
+
+    remove(ALL_ARTIFACTS, EXE)
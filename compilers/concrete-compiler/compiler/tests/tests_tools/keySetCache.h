@@ -26,7 +26,12 @@ getTestKeySetCache() {
 
   llvm::errs() << "Using KeySetCache dir: " << cachePathStr << "\n";
 
-  return concretelang::keysets::KeysetCache(cachePathStr);
+  uint64_t maxSize = 0;
+  if (auto envMaxSize = std::getenv("KEY_CACHE_MAX_SIZE")) {
+    maxSize = std::strtoull(envMaxSize, nullptr, 10);
+  }
+
+  return concretelang::keysets::KeysetCache(cachePathStr, maxSize);
 }
 
 static inline std::shared_ptr<concretelang::keysets::KeysetCache>
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "concretelang/Common/Values.h"
+#include "tests_tools/assert.h"
+#include <sstream>
+
+namespace {
+using concretelang::values::Arena;
+using concretelang::values::readTransportValueChunked;
+using concretelang::values::readValueAtRest;
+using concretelang::values::Tensor;
+using concretelang::values::TransportValueReader;
+using concretelang::values::Value;
+using concretelang::values::writeTransportValueChunked;
+using concretelang::values::writeValueAtRest;
+
+Value makeValue() {
+  std::vector<uint64_t> values(1000);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = i * 0x0123456789abcdef;
+  }
+  return Value{Tensor<uint64_t>(values, {10, 100})};
+}
+
+TEST(TransportValue, chunked_roundtrip) {
+  auto value = makeValue();
+  std::stringstream stream;
+  // Chunks not aligned on the elements
+  ASSERT_OUTCOME_HAS_VALUE(
+      writeTransportValueChunked(value.intoRawTransportValue(), stream, 999));
+  ASSERT_ASSIGN_OUTCOME_VALUE(read, readTransportValueChunked(stream));
+  ASSERT_EQ(Value::fromRawTransportValue(read), value);
+}
+
+TEST(TransportValue, chunked_incremental_read) {
+  auto value = makeValue();
+  std::stringstream stream;
+  ASSERT_OUTCOME_HAS_VALUE(
+      writeTransportValueChunked(value.intoRawTransportValue(), stream, 64));
+  ASSERT_ASSIGN_OUTCOME_VALUE(reader, TransportValueReader::open(stream));
+  ASSERT_EQ(reader.getRemaining(), 1000 * sizeof(uint64_t));
+  std::vector<uint64_t> values(1000);
+  // Reads ending in the middle of the chunks, the last one being short
+  for (size_t i = 0; i < values.size(); i += 300) {
+    ASSERT_ASSIGN_OUTCOME_VALUE(
+        length, reader.read(&values[i], 300 * sizeof(uint64_t)));
+    ASSERT_EQ(length, std::min<size_t>(300, 1000 - i) * sizeof(uint64_t));
+  }
+  ASSERT_EQ(reader.getRemaining(), 0u);
+  ASSERT_EQ(values, value.getTensor<uint64_t>()->values);
+}
+
+TEST(TransportValue, chunked_truncated) {
+  std::stringstream stream;
+  ASSERT_OUTCOME_HAS_VALUE(writeTransportValueChunked(
+      makeValue().intoRawTransportValue(), stream, 64));
+  auto truncated = stream.str();
+  truncated.resize(truncated.size() - 1);
+  std::istringstream truncatedStream(truncated);
+  ASSERT_OUTCOME_HAS_FAILURE(readTransportValueChunked(truncatedStream));
+}
+
+TEST(TransportValue, arena_borrowed_roundtrip) {
+  auto value = makeValue();
+  auto expected = value.getTensor<uint64_t>().value();
+  Arena::Scope scope;
+  auto tensor = Tensor<uint64_t>::build(
+      expected.dimensions, [&](uint64_t *data, size_t) {
+        std::copy(expected.values.begin(), expected.values.end(), data);
+      });
+  ASSERT_TRUE(tensor.isBorrowed());
+  ASSERT_EQ(tensor, expected);
+  auto transportValue = Value{tensor}.intoRawTransportValue();
+  auto borrowed = Value::borrowRawTransportValue(transportValue);
+  ASSERT_TRUE(borrowed.getTensorPtr<uint64_t>()->isBorrowed());
+  ASSERT_EQ(borrowed, value);
+}
+
+TEST(TransportValue, at_rest_modulus_switched) {
+  auto value = makeValue();
+  auto transportValue = value.intoRawTransportValue();
+  auto lweInfo = transportValue.asBuilder().initTypeInfo().initLweCiphertext();
+  lweInfo.initConcreteShape().setDimensions({10, 100});
+  lweInfo.initEncryption().setLweDimension(99);
+  lweInfo.setCompression(concreteprotocol::Compression::NONE);
+  std::stringstream stream;
+  ASSERT_OUTCOME_HAS_VALUE(writeValueAtRest(transportValue, stream, 20, 999));
+  // 100 coefficients of 20 bits in 32 words
+  ASSERT_LT(stream.str().size(), 10 * 32 * sizeof(uint64_t) + 512);
+  ASSERT_ASSIGN_OUTCOME_VALUE(read, readValueAtRest(stream));
+  ASSERT_EQ(read.asReader().getTypeInfo().getLweCiphertext().getCompression(),
+            concreteprotocol::Compression::NONE);
+  auto restored = Value::fromRawTransportValue(read);
+  ASSERT_EQ(restored.getDimensions(), value.getDimensions());
+  auto expected = value.getTensor<uint64_t>()->values;
+  auto actual = restored.getTensor<uint64_t>()->values;
+  for (size_t i = 0; i < expected.size(); i++) {
+    // Within half a step of the 2^20 modulus
+    ASSERT_LE((int64_t)(actual[i] - expected[i]), (int64_t)1 << 43);
+    ASSERT_GE((int64_t)(actual[i] - expected[i]), -((int64_t)1 << 43));
+  }
+}
+
+} // namespace
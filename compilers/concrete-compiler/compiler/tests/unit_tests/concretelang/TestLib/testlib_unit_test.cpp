@@ -7,6 +7,7 @@
 #include "boost/outcome.h"
 
 #include "concretelang/Common/Error.h"
+#include "concretelang/Runtime/context.h"
 #include "concretelang/Support/CompilerEngine.h"
 #include "concretelang/TestLib/TestProgram.h"
 
@@ -127,6 +128,29 @@ func.func @main(%arg0: !FHE.eint<7>, %arg1: !FHE.eint<7>) -> !FHE.eint<7> {
   ASSERT_FALSE(res.has_value());
 }
 
+TEST(CompiledModule, call_1s_1s_reuse_runtime_context) {
+  std::string source = R"(
+func.func @main(%arg0: !FHE.eint<7>) -> !FHE.eint<7> {
+  %0 = arith.constant 1 : i8
+  %1 = "FHE.add_eint_int"(%arg0, %0): (!FHE.eint<7>, i8) -> (!FHE.eint<7>)
+  return %1: !FHE.eint<7>
+}
+)";
+  ASSERT_ASSIGN_OUTCOME_VALUE(circuit, setupTestProgram(source));
+  auto &cache = mlir::concretelang::RuntimeContextCache::global();
+  cache.clear();
+  for (auto a : values_6bits()) {
+    auto res = circuit.call({Tensor<uint64_t>(a)});
+    ASSERT_TRUE(res.has_value());
+    auto out = res.value()[0].getTensor<uint64_t>().value()[0];
+    ASSERT_EQ(out, (uint64_t)a + 1);
+    // All the calls share the context built by the first one.
+    ASSERT_EQ(cache.size(), 1u);
+  }
+  cache.clear();
+  ASSERT_EQ(cache.size(), 0u);
+}
+
 TEST(CompiledModule, call_1s_1t) {
   std::string source = R"(
 func.func @main(%arg0: !FHE.eint<7>) -> tensor<1x!FHE.eint<7>> {
@@ -48,6 +48,8 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
         fft_precision,
         complexity_model: &CpuComplexity::default(),
         composable: false,
+        maximum_evaluation_keys_size: None,
+        latency_workers: None,
     };
 
     let cache = decomposition::cache(
@@ -1,4 +1,5 @@
-use concrete_optimizer::computing_cost::cpu::CpuComplexity;
+use concrete_optimizer::computing_cost::complexity_model::ComplexityModel;
+use concrete_optimizer::computing_cost::measured::MeasuredComplexity;
 use concrete_optimizer::config;
 use concrete_optimizer::config::ProcessingUnit;
 use concrete_optimizer::dag::operator::{
@@ -9,12 +10,20 @@ use concrete_optimizer::optimization::config::{Config, SearchSpace};
 use concrete_optimizer::optimization::dag::multi_parameters::keys_spec;
 use concrete_optimizer::optimization::dag::multi_parameters::keys_spec::CircuitSolution;
 use concrete_optimizer::optimization::dag::multi_parameters::partition_cut::PartitionCut;
+use concrete_optimizer::optimization::dag::multi_parameters::solution_cache::SolutionCache;
 use concrete_optimizer::optimization::dag::solo_key::optimize_generic::{
     Encoding, Solution as DagSolution,
 };
 use concrete_optimizer::optimization::decomposition;
 use concrete_optimizer::parameters::{BrDecompositionParameters, KsDecompositionParameters};
 use concrete_optimizer::utils::cache::persistent::default_cache_dir;
+use std::sync::{Arc, Mutex};
+
+/// The measured cost model loaded by `load_cost_table`, used instead of the analytic cpu one.
+static COST_TABLE: Mutex<Option<Arc<MeasuredComplexity>>> = Mutex::new(None);
+
+/// The circuit solutions cache set by `set_solution_cache`.
+static SOLUTION_CACHE: Mutex<Option<Arc<SolutionCache>>> = Mutex::new(None);
 
 fn no_solution() -> ffi::Solution {
     ffi::Solution {
@@ -30,8 +39,53 @@ fn no_dag_solution() -> ffi::DagSolution {
     }
 }
 
+fn load_cost_table(path: &str) -> String {
+    let model = if path.is_empty() {
+        None
+    } else {
+        let table = match std::fs::read_to_string(path) {
+            Ok(table) => table,
+            Err(err) => return format!("cannot read cost table {path}: {err}"),
+        };
+        match MeasuredComplexity::parse(&table, 64) {
+            Ok(model) => Some(Arc::new(model)),
+            Err(err) => return format!("invalid cost table {path}: {err}"),
+        }
+    };
+    *COST_TABLE.lock().unwrap() = model;
+    String::new()
+}
+
+fn measured_complexity_model(options: ffi::Options) -> Option<Arc<dyn ComplexityModel>> {
+    if options.use_gpu_constraints {
+        return None;
+    }
+    let model: Arc<dyn ComplexityModel> = COST_TABLE.lock().unwrap().clone()?;
+    Some(model)
+}
+
+fn complexity_model(options: ffi::Options) -> Arc<dyn ComplexityModel> {
+    measured_complexity_model(options).unwrap_or_else(|| ProcessingUnit::Cpu.complexity_model())
+}
+
+fn set_solution_cache(dir: &str) {
+    let cache = (!dir.is_empty()).then(|| Arc::new(SolutionCache::new(dir)));
+    *SOLUTION_CACHE.lock().unwrap() = cache;
+}
+
+fn solution_cache(options: ffi::Options) -> Option<Arc<SolutionCache>> {
+    // The solutions are not keyed by the cost model.
+    if measured_complexity_model(options).is_some() {
+        return None;
+    }
+    SOLUTION_CACHE.lock().unwrap().clone()
+}
+
 fn caches_from(options: ffi::Options) -> decomposition::PersistDecompCaches {
-    if !options.cache_on_disk {
+    let measured = measured_complexity_model(options);
+    // The disk caches are only keyed by the hardware, not by the cost model.
+    let cache_on_disk = options.cache_on_disk && measured.is_none();
+    if !cache_on_disk {
         println!("optimizer: Using stateless cache.");
         let cache_dir = default_cache_dir();
         println!("optimizer: To clear the cache, remove directory {cache_dir}");
@@ -40,8 +94,8 @@ fn caches_from(options: ffi::Options) -> decomposition::PersistDecompCaches {
     decomposition::cache(
         options.security_level,
         processing_unit,
-        Some(ProcessingUnit::Cpu.complexity_model()),
-        options.cache_on_disk,
+        Some(measured.unwrap_or_else(|| ProcessingUnit::Cpu.complexity_model())),
+        cache_on_disk,
         options.ciphertext_modulus_log,
         options.fft_precision,
     )
@@ -50,6 +104,7 @@ fn caches_from(options: ffi::Options) -> decomposition::PersistDecompCaches {
 fn optimize_bootstrap(precision: u64, noise_factor: f64, options: ffi::Options) -> ffi::Solution {
     // Support composable since there is no dag
     let processing_unit = processing_unit(options);
+    let complexity_model = complexity_model(options);
 
     let config = Config {
         security_level: options.security_level,
@@ -57,8 +112,10 @@ fn optimize_bootstrap(precision: u64, noise_factor: f64, options: ffi::Options)
         key_sharing: options.key_sharing,
         ciphertext_modulus_log: options.ciphertext_modulus_log,
         fft_precision: options.fft_precision,
-        complexity_model: &CpuComplexity::default(),
+        complexity_model: &*complexity_model,
         composable: options.composable,
+        maximum_evaluation_keys_size: maximum_evaluation_keys_size(options),
+        latency_workers: latency_workers(options),
     };
 
     let sum_size = 1;
@@ -555,14 +612,17 @@ impl OperationDag {
 
     fn optimize(&self, options: ffi::Options) -> ffi::DagSolution {
         let processing_unit = processing_unit(options);
+        let complexity_model = complexity_model(options);
         let config = Config {
             security_level: options.security_level,
             maximum_acceptable_error_probability: options.maximum_acceptable_error_probability,
             key_sharing: options.key_sharing,
             ciphertext_modulus_log: options.ciphertext_modulus_log,
             fft_precision: options.fft_precision,
-            complexity_model: &CpuComplexity::default(),
+            complexity_model: &*complexity_model,
             composable: options.composable,
+            maximum_evaluation_keys_size: maximum_evaluation_keys_size(options),
+            latency_workers: latency_workers(options),
         };
 
         let search_space = SearchSpace::default(processing_unit);
@@ -609,14 +669,17 @@ impl OperationDag {
 
     fn optimize_multi(&self, options: ffi::Options) -> ffi::CircuitSolution {
         let processing_unit = processing_unit(options);
+        let complexity_model = complexity_model(options);
         let config = Config {
             security_level: options.security_level,
             maximum_acceptable_error_probability: options.maximum_acceptable_error_probability,
             key_sharing: options.key_sharing,
             ciphertext_modulus_log: options.ciphertext_modulus_log,
             fft_precision: options.fft_precision,
-            complexity_model: &CpuComplexity::default(),
+            complexity_model: &*complexity_model,
             composable: options.composable,
+            maximum_evaluation_keys_size: maximum_evaluation_keys_size(options),
+            latency_workers: latency_workers(options),
         };
         let search_space = SearchSpace::default(processing_unit);
 
@@ -628,7 +691,8 @@ impl OperationDag {
             }
             ffi::MultiParamStrategy::ByPrecision | _ => PartitionCut::for_each_precision(&self.0),
         };
-        let circuit_sol =
+        let p_cut = Some(p_cut);
+        let optimize = || {
             concrete_optimizer::optimization::dag::multi_parameters::optimize_generic::optimize(
                 &self.0,
                 config,
@@ -636,8 +700,22 @@ impl OperationDag {
                 encoding,
                 options.default_log_norm2_woppbs,
                 &caches_from(options),
-                &Some(p_cut),
+                &p_cut,
+            )
+        };
+        let circuit_sol = if let Some(cache) = solution_cache(options) {
+            let key = SolutionCache::key(
+                &self.0,
+                &config,
+                &search_space,
+                encoding,
+                options.default_log_norm2_woppbs,
+                &p_cut,
             );
+            cache.get_or_optimize(&key, optimize)
+        } else {
+            optimize()
+        };
         circuit_sol.into()
     }
 }
@@ -686,6 +764,12 @@ mod ffi {
         #[namespace = "concrete_optimizer::v0"]
         fn optimize_bootstrap(precision: u64, noise_factor: f64, options: Options) -> Solution;
 
+        #[namespace = "concrete_optimizer::utils"]
+        fn load_cost_table(path: &str) -> String;
+
+        #[namespace = "concrete_optimizer::utils"]
+        fn set_solution_cache(dir: &str);
+
         #[namespace = "concrete_optimizer::utils"]
         fn convert_to_dag_solution(solution: &Solution) -> DagSolution;
 
@@ -842,6 +926,8 @@ mod ffi {
         pub ciphertext_modulus_log: u32,
         pub fft_precision: u32,
         pub composable: bool,
+        pub maximum_evaluation_keys_size: u64,
+        pub latency_workers: u64,
     }
 
     #[namespace = "concrete_optimizer::dag"]
@@ -953,6 +1039,16 @@ mod ffi {
     }
 }
 
+fn maximum_evaluation_keys_size(options: ffi::Options) -> Option<u64> {
+    // 0 means no maximum
+    (options.maximum_evaluation_keys_size > 0).then_some(options.maximum_evaluation_keys_size)
+}
+
+fn latency_workers(options: ffi::Options) -> Option<u64> {
+    // 0 means the total complexity is minimized
+    (options.latency_workers > 0).then_some(options.latency_workers)
+}
+
 fn processing_unit(options: ffi::Options) -> ProcessingUnit {
     if options.use_gpu_constraints {
         config::ProcessingUnit::Gpu {
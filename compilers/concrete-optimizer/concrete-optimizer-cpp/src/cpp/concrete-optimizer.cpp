@@ -1095,6 +1095,8 @@ struct Options final {
   ::std::uint32_t ciphertext_modulus_log;
   ::std::uint32_t fft_precision;
   bool composable;
+  ::std::uint64_t maximum_evaluation_keys_size;
+  ::std::uint64_t latency_workers;
 
   using IsRelocatable = ::std::true_type;
 };
@@ -1257,6 +1259,10 @@ extern "C" {
 
 namespace utils {
 extern "C" {
+void concrete_optimizer$utils$cxxbridge1$load_cost_table(::rust::Str path, ::rust::String *return$) noexcept;
+
+void concrete_optimizer$utils$cxxbridge1$set_solution_cache(::rust::Str dir) noexcept;
+
 void concrete_optimizer$utils$cxxbridge1$convert_to_dag_solution(::concrete_optimizer::v0::Solution const &solution, ::concrete_optimizer::dag::DagSolution *return$) noexcept;
 
 void concrete_optimizer$utils$cxxbridge1$convert_to_circuit_solution(::concrete_optimizer::dag::DagSolution const &solution, ::concrete_optimizer::OperationDag const &dag, ::concrete_optimizer::dag::CircuitSolution *return$) noexcept;
@@ -1330,6 +1336,16 @@ namespace v0 {
 } // namespace v0
 
 namespace utils {
+::rust::String load_cost_table(::rust::Str path) noexcept {
+  ::rust::MaybeUninit<::rust::String> return$;
+  concrete_optimizer$utils$cxxbridge1$load_cost_table(path, &return$.value);
+  return ::std::move(return$.value);
+}
+
+void set_solution_cache(::rust::Str dir) noexcept {
+  concrete_optimizer$utils$cxxbridge1$set_solution_cache(dir);
+}
+
 ::concrete_optimizer::dag::DagSolution convert_to_dag_solution(::concrete_optimizer::v0::Solution const &solution) noexcept {
   ::rust::MaybeUninit<::concrete_optimizer::dag::DagSolution> return$;
   concrete_optimizer$utils$cxxbridge1$convert_to_dag_solution(solution, &return$.value);
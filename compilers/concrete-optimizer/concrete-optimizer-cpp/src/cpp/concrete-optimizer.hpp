@@ -1076,6 +1076,8 @@ struct Options final {
   ::std::uint32_t ciphertext_modulus_log;
   ::std::uint32_t fft_precision;
   bool composable;
+  ::std::uint64_t maximum_evaluation_keys_size;
+  ::std::uint64_t latency_workers;
 
   using IsRelocatable = ::std::true_type;
 };
@@ -1235,6 +1237,10 @@ namespace v0 {
 } // namespace v0
 
 namespace utils {
+::rust::String load_cost_table(::rust::Str path) noexcept;
+
+void set_solution_cache(::rust::Str dir) noexcept;
+
 ::concrete_optimizer::dag::DagSolution convert_to_dag_solution(::concrete_optimizer::v0::Solution const &solution) noexcept;
 
 ::concrete_optimizer::dag::CircuitSolution convert_to_circuit_solution(::concrete_optimizer::dag::DagSolution const &solution, ::concrete_optimizer::OperationDag const &dag) noexcept;
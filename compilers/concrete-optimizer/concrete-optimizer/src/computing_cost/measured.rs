@@ -0,0 +1,210 @@
+use super::complexity::Complexity;
+use super::complexity_model::ComplexityModel;
+use super::cpu::CpuComplexity;
+use crate::parameters::{
+    BrDecompositionParameters, CmuxParameters, GlweParameters, KeyswitchParameters,
+    KsDecompositionParameters, LweDimension, PbsParameters,
+};
+
+/// A complexity model calibrated with timings measured on the target machine.
+///
+/// The analytic cpu model is kept for its shape and corrected by the ratio between the measured
+/// and analytic costs of the closest measured operations. Ratios are relative to the average
+/// pbs one, so that the costs stay in the unit of the analytic model, the levelled operations
+/// being left unchanged.
+///
+/// The cost table has one measure per line, `#` starting a comment:
+///   ks <input_lwe_dimension> <output_lwe_dimension> <level> <log2_base> <nanoseconds>
+///   pbs <internal_lwe_dimension> <glwe_dimension> <log2_polynomial_size> <level> <log2_base>
+///       <nanoseconds>
+/// as written by the `calibrate_cost_model` example of concrete-cpu.
+#[derive(Clone)]
+pub struct MeasuredComplexity {
+    analytic: CpuComplexity,
+    ks_ratio: f64,
+    // (log2_polynomial_size, ratio), sorted by polynomial size
+    pbs_ratios: Vec<(u64, f64)>,
+}
+
+impl MeasuredComplexity {
+    pub fn parse(table: &str, ciphertext_modulus_log: u32) -> Result<Self, String> {
+        let analytic = CpuComplexity::default();
+        let mut ks_ratios = vec![];
+        let mut pbs_ratios: Vec<(u64, f64)> = vec![];
+        for (line_number, line) in table.lines().enumerate() {
+            let line = line.split('#').next().unwrap_or_default().trim();
+            if line.is_empty() {
+                continue;
+            }
+            let error = |msg: &str| format!("cost table line {}: {msg}", line_number + 1);
+            let mut fields = line.split_whitespace();
+            let kind = fields.next().unwrap_or_default();
+            let values: Vec<f64> = fields
+                .map(|field| field.parse::<f64>().map_err(|_| error("invalid number")))
+                .collect::<Result<_, _>>()?;
+            match (kind, values.as_slice()) {
+                ("ks", &[input, output, level, log2_base, ns]) => {
+                    let params = KeyswitchParameters {
+                        input_lwe_dimension: LweDimension(input as u64),
+                        output_lwe_dimension: LweDimension(output as u64),
+                        ks_decomposition_parameter: KsDecompositionParameters {
+                            level: level as u64,
+                            log2_base: log2_base as u64,
+                        },
+                    };
+                    let analytic = analytic.ks_complexity(params, ciphertext_modulus_log);
+                    ks_ratios.push(ns / analytic);
+                }
+                (
+                    "pbs",
+                    &[internal, glwe_dimension, log2_polynomial_size, level, log2_base, ns],
+                ) => {
+                    let params = PbsParameters {
+                        internal_lwe_dimension: LweDimension(internal as u64),
+                        br_decomposition_parameter: BrDecompositionParameters {
+                            level: level as u64,
+                            log2_base: log2_base as u64,
+                        },
+                        output_glwe_params: GlweParameters {
+                            log2_polynomial_size: log2_polynomial_size as u64,
+                            glwe_dimension: glwe_dimension as u64,
+                        },
+                    };
+                    let analytic = analytic.pbs_complexity(params, ciphertext_modulus_log);
+                    pbs_ratios.push((log2_polynomial_size as u64, ns / analytic));
+                }
+                ("ks" | "pbs", _) => return Err(error("unexpected number of fields")),
+                _ => return Err(error("unknown operation")),
+            }
+        }
+        if ks_ratios.is_empty() || pbs_ratios.is_empty() {
+            return Err("cost table needs at least one ks and one pbs measure".into());
+        }
+
+        let mean = |ratios: &[f64]| ratios.iter().sum::<f64>() / ratios.len() as f64;
+        let unit = mean(&pbs_ratios.iter().map(|(_, r)| *r).collect::<Vec<_>>());
+        pbs_ratios.sort_by_key(|(log2_polynomial_size, _)| *log2_polynomial_size);
+        let mut merged: Vec<(u64, f64)> = vec![];
+        for (log2_polynomial_size, _) in &pbs_ratios {
+            if merged.last().map(|(last, _)| last) == Some(log2_polynomial_size) {
+                continue;
+            }
+            let ratios: Vec<f64> = pbs_ratios
+                .iter()
+                .filter(|(size, _)| size == log2_polynomial_size)
+                .map(|(_, r)| *r)
+                .collect();
+            merged.push((*log2_polynomial_size, mean(&ratios) / unit));
+        }
+        Ok(Self {
+            analytic,
+            ks_ratio: mean(&ks_ratios) / unit,
+            pbs_ratios: merged,
+        })
+    }
+
+    /// The correction of the closest measured polynomial size.
+    fn pbs_ratio(&self, log2_polynomial_size: u64) -> f64 {
+        self.pbs_ratios
+            .iter()
+            .min_by_key(|(measured, _)| measured.abs_diff(log2_polynomial_size))
+            .map_or(1.0, |(_, ratio)| *ratio)
+    }
+}
+
+impl ComplexityModel for MeasuredComplexity {
+    fn pbs_complexity(&self, params: PbsParameters, ciphertext_modulus_log: u32) -> Complexity {
+        self.pbs_ratio(params.output_glwe_params.log2_polynomial_size)
+            * self.analytic.pbs_complexity(params, ciphertext_modulus_log)
+    }
+
+    fn cmux_complexity(&self, params: CmuxParameters, ciphertext_modulus_log: u32) -> Complexity {
+        self.pbs_ratio(params.output_glwe_params.log2_polynomial_size)
+            * self
+                .analytic
+                .cmux_complexity(params, ciphertext_modulus_log)
+    }
+
+    fn ks_complexity(
+        &self,
+        params: KeyswitchParameters,
+        ciphertext_modulus_log: u32,
+    ) -> Complexity {
+        self.ks_ratio * self.analytic.ks_complexity(params, ciphertext_modulus_log)
+    }
+
+    fn fft_complexity(&self, glwe_polynomial_size: f64, ciphertext_modulus_log: u32) -> Complexity {
+        self.pbs_ratio(glwe_polynomial_size.log2().round() as u64)
+            * self
+                .analytic
+                .fft_complexity(glwe_polynomial_size, ciphertext_modulus_log)
+    }
+
+    fn levelled_complexity(
+        &self,
+        sum_size: u64,
+        lwe_dimension: LweDimension,
+        ciphertext_modulus_log: u32,
+    ) -> Complexity {
+        self.analytic
+            .levelled_complexity(sum_size, lwe_dimension, ciphertext_modulus_log)
+    }
+
+    fn multi_bit_pbs_complexity(
+        &self,
+        params: PbsParameters,
+        ciphertext_modulus_log: u32,
+        grouping_factor: u32,
+        jit_fft: bool,
+    ) -> Complexity {
+        self.pbs_ratio(params.output_glwe_params.log2_polynomial_size)
+            * self.analytic.multi_bit_pbs_complexity(
+                params,
+                ciphertext_modulus_log,
+                grouping_factor,
+                jit_fft,
+            )
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn pbs(log2_polynomial_size: u64) -> PbsParameters {
+        PbsParameters {
+            internal_lwe_dimension: LweDimension(700),
+            br_decomposition_parameter: BrDecompositionParameters {
+                level: 2,
+                log2_base: 15,
+            },
+            output_glwe_params: GlweParameters {
+                log2_polynomial_size,
+                glwe_dimension: 1,
+            },
+        }
+    }
+
+    #[test]
+    fn ratios_are_relative_to_the_pbs() {
+        let analytic = CpuComplexity::default();
+        let pbs_10 = analytic.pbs_complexity(pbs(10), 64);
+        let pbs_11 = analytic.pbs_complexity(pbs(11), 64);
+        let table = format!(
+            "# measured\n\
+             ks 2048 700 3 4 1000\n\
+             pbs 700 1 10 2 15 {}\n\
+             pbs 700 1 11 2 15 {}\n",
+            pbs_10,
+            3.0 * pbs_11
+        );
+        let model = MeasuredComplexity::parse(&table, 64).unwrap();
+        // The larger polynomial size is 3 times slower than predicted relatively to the smaller.
+        let ratio =
+            |log2| model.pbs_complexity(pbs(log2), 64) / analytic.pbs_complexity(pbs(log2), 64);
+        approx::assert_relative_eq!(ratio(11) / ratio(10), 3.0, max_relative = 1e-9);
+        approx::assert_relative_eq!(ratio(12), ratio(11), max_relative = 1e-9);
+        assert!(MeasuredComplexity::parse("pbs 700 1 10 2 15 1", 64).is_err());
+        assert!(MeasuredComplexity::parse("ks 1 2\npbs 700 1 10 2 15 1", 64).is_err());
+    }
+}
@@ -4,4 +4,5 @@ pub mod complexity_model;
 pub mod cpu;
 mod fft;
 pub mod gpu;
+pub mod measured;
 pub mod operators;
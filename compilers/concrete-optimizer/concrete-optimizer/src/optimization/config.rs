@@ -19,6 +19,10 @@ pub struct Config<'a> {
     pub fft_precision: u32,
     pub complexity_model: &'a dyn ComplexityModel,
     pub composable: bool,
+    // maximum size in bytes of all the bootstrap and keyswitch keys, None if unlimited
+    pub maximum_evaluation_keys_size: Option<u64>,
+    // minimize the latency on this many parallel workers, None to minimize the total complexity
+    pub latency_workers: Option<u64>,
 }
 
 #[derive(Clone, Debug)]
@@ -436,6 +436,42 @@ fn sum_operations_count(all_counts: &[OperationsCount]) -> OperationsCount {
     OperationsCount { counts: sum_counts }
 }
 
+impl AnalyzedDag {
+    /// Operations on the critical path of the dag when run on `workers` parallel workers.
+    ///
+    /// Luts are scheduled by depth, the luts of a same depth being independent, and each depth
+    /// takes the time of its operations spread on the workers. The result is linear in the
+    /// operations costs, so it can replace the total operations count as optimization objective.
+    pub fn critical_path_operations_count(&self, workers: u64) -> OperationsCount {
+        let workers = workers.max(1) as f64;
+        let mut lut_depths = vec![0_usize; self.operators.len()];
+        let mut counts_per_depth: Vec<OperationsValue> = vec![];
+        for (i, op) in self.operators.iter().enumerate() {
+            let input_depth = op
+                .get_inputs_iter()
+                .map(|input| lut_depths[input.i])
+                .max()
+                .unwrap_or(0);
+            if !matches!(op, Op::Lut { .. }) {
+                lut_depths[i] = input_depth;
+                continue;
+            }
+            lut_depths[i] = input_depth + 1;
+            if counts_per_depth.len() <= input_depth {
+                counts_per_depth.push(OperationsValue::zero(self.nb_partitions));
+            }
+            counts_per_depth[input_depth] += &self.operations_count_per_instrs[i].counts;
+        }
+        let mut counts = OperationsValue::zero(self.nb_partitions);
+        for depth_counts in &counts_per_depth {
+            for (count, depth_count) in counts.iter_mut().zip(depth_counts.iter()) {
+                *count += (depth_count / workers).ceil();
+            }
+        }
+        OperationsCount { counts }
+    }
+}
+
 #[cfg(test)]
 pub mod tests {
     use super::*;
@@ -1031,6 +1067,24 @@ pub mod tests {
         );
     }
 
+    #[test]
+    fn test_critical_path_operations_count() {
+        let mut dag = unparametrized::OperationDag::new();
+        let input = dag.add_input(4, Shape::vector(4));
+        let lut1 = dag.add_lut(input, FunctionTable::UNKWOWN, 4);
+        let _lut2 = dag.add_lut(input, FunctionTable::UNKWOWN, 4);
+        let _lut3 = dag.add_lut(lut1, FunctionTable::UNKWOWN, 4);
+        dag.detect_outputs();
+        let dag = analyze(&dag);
+        assert_eq!(format!("{}", dag.operations_count), "12¢K[0] + 12¢Br[0]");
+        // lut1 and lut2 run together, then lut3
+        let critical_path = |workers| dag.critical_path_operations_count(workers).to_string();
+        assert_eq!(critical_path(1), "12¢K[0] + 12¢Br[0]");
+        assert_eq!(critical_path(2), "6¢K[0] + 6¢Br[0]");
+        assert_eq!(critical_path(8), "2¢K[0] + 2¢Br[0]");
+        assert_eq!(critical_path(64), "2¢K[0] + 2¢Br[0]");
+    }
+
     #[test]
     fn test_high_partition_number() {
         let mut dag = unparametrized::OperationDag::new();
@@ -1,9 +1,11 @@
 use std::collections::HashMap;
 
+use serde::{Deserialize, Serialize};
+
 use crate::optimization::{atomic_pattern, wop_atomic_pattern};
 use crate::parameters::{BrDecompositionParameters, KsDecompositionParameters};
 
-use crate::optimization::dag::multi_parameters::optimize::{MacroParameters, REAL_FAST_KS};
+use crate::optimization::dag::multi_parameters::optimize::{use_fast_ks, MacroParameters};
 
 pub type Id = u64;
 /* An Id is unique per key type. Starting from 0 for the first key ... */
@@ -15,7 +17,7 @@ pub type CircuitBoostrapKeyId = Id;
 pub type PrivateFunctionalPackingBoostrapKeyId = Id;
 pub const NO_KEY_ID: Id = Id::MAX;
 
-#[derive(Debug, Clone, PartialEq, Eq)]
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub struct SecretLweKey {
     /* Big and small secret keys */
     pub identifier: SecretLweKeyId,
@@ -24,7 +26,7 @@ pub struct SecretLweKey {
     pub description: String,
 }
 
-#[derive(Debug, Clone, PartialEq, Eq)]
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub struct BootstrapKey {
     /* Public TLU bootstrap keys */
     pub identifier: BootstrapKeyId,
@@ -34,7 +36,7 @@ pub struct BootstrapKey {
     pub description: String,
 }
 
-#[derive(Debug, Clone, PartialEq, Eq)]
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub struct KeySwitchKey {
     /* Public TLU keyswitch keys */
     pub identifier: KeySwitchKeyId,
@@ -44,7 +46,7 @@ pub struct KeySwitchKey {
     pub description: String,
 }
 
-#[derive(Debug, Clone, PartialEq, Eq)]
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub struct ConversionKeySwitchKey {
     /* Public conversion to make compatible ciphertext with incompatible keys.
     It's currently only between two big secret keys. */
@@ -56,7 +58,7 @@ pub struct ConversionKeySwitchKey {
     pub description: String,
 }
 
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct CircuitBoostrapKey {
     pub identifier: ConversionKeySwitchKeyId,
     pub representation_key: SecretLweKey,
@@ -64,7 +66,7 @@ pub struct CircuitBoostrapKey {
     pub description: String,
 }
 
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct PrivateFunctionalPackingBoostrapKey {
     pub identifier: PrivateFunctionalPackingBoostrapKeyId,
     pub representation_key: SecretLweKey,
@@ -72,7 +74,7 @@ pub struct PrivateFunctionalPackingBoostrapKey {
     pub description: String,
 }
 
-#[derive(Debug, Default, Clone)]
+#[derive(Debug, Default, Clone, Serialize, Deserialize)]
 pub struct CircuitKeys {
     /* All keys used in a circuit, sorted by Id for each key type */
     pub secret_keys: Vec<SecretLweKey>,
@@ -83,7 +85,7 @@ pub struct CircuitKeys {
     pub private_functional_packing_keys: Vec<PrivateFunctionalPackingBoostrapKey>,
 }
 
-#[derive(Debug, Clone)]
+#[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct InstructionKeys {
     /* Describe for each intructions what is the key of inputs/outputs.
        For tlus, it gives the internal keyswitch/pbs keys.
@@ -98,7 +100,7 @@ pub struct InstructionKeys {
     pub extra_conversion_keys: Vec<ConversionKeySwitchKeyId>,
 }
 
-#[derive(Debug, Default, Clone)]
+#[derive(Debug, Default, Clone, Serialize, Deserialize)]
 pub struct CircuitSolution {
     pub circuit_keys: CircuitKeys,
     /* instructions keys ordered by instructions index of the original dag original (i.e. in same order):
@@ -415,7 +417,10 @@ impl ExpandedCircuitKeys {
                         input_key: big_secret_keys[src].clone(),
                         output_key: big_secret_keys[dst].clone(),
                         ks_decomposition_parameter: fks.decomp,
-                        fast_keyswitch: REAL_FAST_KS,
+                        fast_keyswitch: use_fast_ks(
+                            &params.macro_params[src].unwrap().glwe_params,
+                            &params.macro_params[dst].unwrap().glwe_params,
+                        ),
                         description: cross_key("fks"),
                     });
                     identifier_fks += 1;
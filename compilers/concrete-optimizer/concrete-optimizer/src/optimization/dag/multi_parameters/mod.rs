@@ -9,6 +9,7 @@ pub mod optimize_generic;
 pub mod partition_cut;
 mod partitionning;
 mod partitions;
+pub mod solution_cache;
 mod symbolic_variance;
 mod union_find;
 mod variance_constraint;
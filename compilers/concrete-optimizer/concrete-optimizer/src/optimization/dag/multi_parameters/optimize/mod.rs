@@ -15,6 +15,7 @@ use crate::optimization::decomposition::cmux::CmuxComplexityNoise;
 use crate::optimization::decomposition::keyswitch::KsComplexityNoise;
 use crate::optimization::decomposition::{cmux, keyswitch, DecompCaches, PersistDecompCaches};
 use crate::parameters::GlweParameters;
+use rayon::prelude::{IntoParallelIterator, ParallelIterator};
 
 use crate::optimization::dag::multi_parameters::complexity::Complexity;
 use crate::optimization::dag::multi_parameters::feasible::Feasible;
@@ -169,8 +170,7 @@ fn optimize_1_fks_and_all_compatible_ks(
     let output_lwe_dim = output_glwe.sample_extract_lwe_dimension();
     // OPT: have a separate cache for fks
     let ks_pareto = caches.pareto_quantities(output_lwe_dim).to_owned();
-    // TODO: fast ks in the other direction as well
-    let use_fast_ks = REAL_FAST_KS && input_glwe.sample_extract_lwe_dimension() >= output_lwe_dim;
+    let use_fast_ks = use_fast_ks(&input_glwe, &output_glwe);
     let ks_src = fks_dst;
     let ks_input_dim = macro_parameters[fks_dst]
         .glwe_params
@@ -479,9 +479,7 @@ fn apply_fks_variance_and_cost_or_lower_bound(
             }
         }
         let ks_pareto = caches.pareto_quantities(output_glwe.sample_extract_lwe_dimension());
-        let use_fast_ks = REAL_FAST_KS
-            && input_glwe.sample_extract_lwe_dimension()
-                >= output_glwe.sample_extract_lwe_dimension();
+        let use_fast_ks = use_fast_ks(input_glwe, output_glwe);
         let cost = if use_fast_ks {
             fast_keyswitch::complexity(input_glwe, output_glwe, ks_pareto[0].decomp.level)
         } else {
@@ -614,284 +612,456 @@ fn fks_to_optimize(
 // In case fast ks are not used
 pub const REAL_FAST_KS: bool = false;
 
+/// Whether the conversion keyswitch between these big keys is a fast keyswitch, i.e. is
+/// done as a GLWE keyswitch in the polynomial ring of the output key.
+pub fn use_fast_ks(input_glwe: &GlweParameters, output_glwe: &GlweParameters) -> bool {
+    // TODO: fast ks in the other direction as well
+    REAL_FAST_KS
+        && input_glwe.sample_extract_lwe_dimension() >= output_glwe.sample_extract_lwe_dimension()
+}
+
+/// The state of the search of the parameters of a partition.
+#[derive(Clone)]
+struct MacroSearch {
+    best_parameters: Parameters,
+    best_complexity: f64,
+    best_p_error: f64,
+    best_partition_p_error: f64,
+    lb_message: Option<&'static str>,
+}
+
+impl Parameters {
+    /// The size in bytes of the bootstrap and keyswitch keys chosen so far, counted as in the
+    /// compilation feedback of the compiler.
+    fn evaluation_keys_size(&self) -> u64 {
+        const U64_BYTES: u64 = 8;
+        let macros = &self.macro_params;
+        let micros = &self.micro_params;
+        let mut size = 0;
+        for (macro_param, pbs) in macros.iter().zip(&micros.pbs) {
+            if let (Some(macro_param), Some(pbs)) = (macro_param, pbs) {
+                let glwe_size = macro_param.glwe_params.glwe_dimension + 1;
+                let out_lwe_dim = macro_param.glwe_params.sample_extract_lwe_dimension();
+                size += (macro_param.internal_dim + 1)
+                    * pbs.decomp.level
+                    * glwe_size
+                    * glwe_size
+                    * (out_lwe_dim + 1);
+            }
+        }
+        for (src, dst) in cross_partition(macros.len()) {
+            if let (Some(src_macro), Some(dst_macro)) = (macros[src], macros[dst]) {
+                let in_lwe_dim = src_macro.glwe_params.sample_extract_lwe_dimension();
+                if let Some(ks) = micros.ks[src][dst] {
+                    size += (in_lwe_dim + 1) * ks.decomp.level * (dst_macro.internal_dim + 1);
+                }
+                if let Some(fks) = micros.fks[src][dst] {
+                    let out_lwe_dim = dst_macro.glwe_params.sample_extract_lwe_dimension();
+                    size += (in_lwe_dim + 1) * fks.decomp.level * (out_lwe_dim + 1);
+                }
+            }
+        }
+        size * U64_BYTES
+    }
+}
+
+impl MacroSearch {
+    /// Takes the best of `self` and `other`, `other` having been searched after `self`.
+    /// When both are as good, the first one is kept as the sequential search would do.
+    fn merge(&mut self, other: Self) {
+        #[allow(clippy::float_cmp)]
+        let better = if other.best_parameters.is_feasible {
+            other.best_complexity < self.best_complexity
+                || (other.best_complexity == self.best_complexity
+                    && other.best_p_error < self.best_p_error)
+        } else {
+            !self.best_parameters.is_feasible
+                && other.best_partition_p_error < self.best_partition_p_error
+        };
+        if better {
+            *self = other;
+        }
+    }
+}
+
+/// The search of the parameters of a partition restricted to one glwe parameters.
+struct GlweSearch {
+    /// after all internal dimensions
+    complete: MacroSearch,
+    /// at the first internal dimension that is not feasible, where the search stops when a
+    /// feasible solution is already known
+    cut: MacroSearch,
+}
+
 #[allow(clippy::cognitive_complexity)]
 #[allow(clippy::too_many_lines)]
-fn optimize_macro(
+fn optimize_macro_glwe(
     security_level: u64,
     ciphertext_modulus_log: u32,
     fft_precision: u32,
     search_space: &SearchSpace,
     partition: PartitionIndex,
+    glwe_params: GlweParameters,
     used_tlu_keyswitch: &[Vec<bool>],
     used_conversion_keyswitch: &[Vec<bool>],
     feasible: &Feasible,
+    partition_feasible: &Feasible,
     complexity: &Complexity,
+    fks_to_optimize: &[Option<FksSrc>],
+    operations: &OperationsCV,
+    maximum_evaluation_keys_size: Option<u64>,
     caches: &mut DecompCaches,
     init_parameters: &Parameters,
-    best_complexity: f64,
-    best_p_error: f64,
-) -> Parameters {
+    init_search: &MacroSearch,
+) -> GlweSearch {
     let nb_partitions = init_parameters.macro_params.len();
-    assert!(partition < nb_partitions);
+    let GlweParameters {
+        log2_polynomial_size,
+        glwe_dimension,
+    } = glwe_params;
+    let mut search = init_search.clone();
+    let mut cut = None;
+
+    let input_variance = glwe_params.minimal_variance(ciphertext_modulus_log, security_level);
+    if glwe_dimension == 1 && log2_polynomial_size == 8 {
+        // this is insecure and so minimal variance will be above 1
+        assert!(input_variance > 1.0);
+        return GlweSearch {
+            complete: search.clone(),
+            cut: search,
+        };
+    }
 
-    let variance_modulus_switching_of = |glwe_log2_poly_size, internal_lwe_dimensions| {
-        estimate_modulus_switching_noise_with_binary_key(
-            internal_lwe_dimensions,
-            glwe_log2_poly_size,
+    for &internal_dim in &search_space.internal_lwe_dimensions {
+        let mut operations = operations.clone();
+        // OPT: fast linear noise_modulus_switching
+        let variance_modulus_switching = estimate_modulus_switching_noise_with_binary_key(
+            internal_dim,
+            log2_polynomial_size,
             ciphertext_modulus_log,
-        )
-    };
+        );
 
-    let mut best_parameters = init_parameters.clone();
-    let mut best_complexity = best_complexity;
-    let mut best_p_error = best_p_error;
-    let mut best_partition_p_error = f64::INFINITY;
+        let macro_param_partition = MacroParameters {
+            glwe_params,
+            internal_dim,
+        };
 
-    let fks_to_optimize = fks_to_optimize(nb_partitions, used_conversion_keyswitch, partition);
-    let operations = OperationsCV {
-        variance: feasible.zero_variance(),
-        cost: complexity.zero_cost(),
-    };
-    let partition_feasible = feasible.filter_constraints(partition);
+        // Heuristic to fill missing macro parameters
+        let macros: Vec<_> = (0..nb_partitions)
+            .map(|i| {
+                if i == partition {
+                    macro_param_partition
+                } else {
+                    init_parameters.macro_params[i].unwrap_or(macro_param_partition)
+                }
+            })
+            .collect();
 
-    let glwe_params_domain = search_space.glwe_dimensions.iter().flat_map(|a| {
-        search_space
-            .glwe_log_polynomial_sizes
-            .iter()
-            .map(|b| (*a, *b))
-    });
-    let mut lb_message = None;
-    for (glwe_dimension, log2_polynomial_size) in glwe_params_domain {
-        let glwe_params = GlweParameters {
-            log2_polynomial_size,
-            glwe_dimension,
-        };
+        // OPT: could be done once and than partially updated
+        apply_partitions_input_and_modulus_variance_and_cost(
+            ciphertext_modulus_log,
+            security_level,
+            nb_partitions,
+            &macros,
+            partition,
+            input_variance,
+            variance_modulus_switching,
+            &mut operations,
+        );
+
+        if !feasible.feasible(&operations.variance) {
+            if search.best_parameters.is_feasible {
+                // noise_modulus_switching is increasing with internal_dim so we can cut
+                // but as long as nothing feasible as been found we don't break to improve feasibility
+                break;
+            }
+            if cut.is_none() {
+                cut = Some(search.clone());
+            }
+        }
 
-        let input_variance = glwe_params.minimal_variance(ciphertext_modulus_log, security_level);
-        if glwe_dimension == 1 && log2_polynomial_size == 8 {
-            // this is insecure and so minimal variance will be above 1
-            assert!(input_variance > 1.0);
+        if complexity.complexity(&operations.cost) > search.best_complexity {
             continue;
         }
 
-        for &internal_dim in &search_space.internal_lwe_dimensions {
-            let mut operations = operations.clone();
-            // OPT: fast linear noise_modulus_switching
-            let variance_modulus_switching =
-                variance_modulus_switching_of(log2_polynomial_size, internal_dim);
+        // setting already chosen pbs and lower bounds
+        // OPT: could be done once and than partially updated
+        apply_pbs_variance_and_cost_or_lower_bounds(
+            &mut caches.cmux,
+            &macros,
+            &init_parameters.micro_params.pbs,
+            partition,
+            &mut operations,
+        );
 
-            let macro_param_partition = MacroParameters {
-                glwe_params,
-                internal_dim,
-            };
+        // OPT: could be done once and than partially updated
+        apply_all_ks_lower_bound(
+            &mut caches.keyswitch,
+            nb_partitions,
+            &macros,
+            used_tlu_keyswitch,
+            &mut operations,
+        );
+        // OPT: could be done once and than partially updated
+        apply_fks_variance_and_cost_or_lower_bound(
+            &mut caches.keyswitch,
+            nb_partitions,
+            &macros,
+            &init_parameters.micro_params.fks,
+            fks_to_optimize,
+            used_conversion_keyswitch,
+            &mut operations,
+            ciphertext_modulus_log,
+            fft_precision,
+        );
 
-            // Heuristic to fill missing macro parameters
-            let macros: Vec<_> = (0..nb_partitions)
-                .map(|i| {
-                    if i == partition {
-                        macro_param_partition
-                    } else {
-                        init_parameters.macro_params[i].unwrap_or(macro_param_partition)
-                    }
-                })
-                .collect();
+        let non_feasible = !feasible.feasible(&operations.variance);
+        if search.best_parameters.is_feasible && non_feasible {
+            continue;
+        }
 
-            // OPT: could be done once and than partially updated
-            apply_partitions_input_and_modulus_variance_and_cost(
-                ciphertext_modulus_log,
-                security_level,
-                nb_partitions,
-                &macros,
-                partition,
-                input_variance,
-                variance_modulus_switching,
-                &mut operations,
-            );
+        if complexity.complexity(&operations.cost) > search.best_complexity {
+            continue;
+        }
 
-            if best_parameters.is_feasible && !feasible.feasible(&operations.variance) {
-                // noise_modulus_switching is increasing with internal_dim so we can cut
-                // but as long as nothing feasible as been found we don't break to improve feasibility
-                break;
-            }
+        let cmux_pareto = caches.cmux.pareto_quantities(glwe_params);
 
-            if complexity.complexity(&operations.cost) > best_complexity {
+        if non_feasible {
+            search.lb_message = Some("Non feasible");
+            // here we optimize for feasibility only
+            // if nothing is feasible, it will give improves feasability for later iterations
+            let mut macro_params = init_parameters.macro_params.clone();
+            macro_params[partition] = Some(MacroParameters {
+                glwe_params,
+                internal_dim,
+            });
+            // optimize the feasibility only, takes all lower bounds on variance
+            // this selects both macro parameters and pbs (lowest variance) for this partition
+            let complexity = f64::INFINITY;
+            let cmux_params = cmux::lowest_noise(cmux_pareto);
+            let partition_p_error = partition_feasible.p_error(&operations.variance);
+            if partition_p_error >= search.best_partition_p_error {
                 continue;
             }
+            search.best_partition_p_error = partition_p_error;
+            let p_error = feasible.p_error(&operations.variance);
+            let global_p_error = feasible.global_p_error(&operations.variance);
+            let mut pbs = init_parameters.micro_params.pbs.clone();
+            pbs[partition] = Some(cmux_params);
+            let micro_params = MicroParameters {
+                pbs,
+                ks: vec![vec![None; nb_partitions]; nb_partitions],
+                fks: vec![vec![None; nb_partitions]; nb_partitions],
+            };
+            search.best_parameters = Parameters {
+                p_error,
+                global_p_error,
+                complexity,
+                micro_params,
+                macro_params,
+                is_lower_bound: true,
+                is_feasible: false,
+            };
+            continue;
+        }
 
-            // setting already chosen pbs and lower bounds
-            // OPT: could be done once and than partially updated
-            apply_pbs_variance_and_cost_or_lower_bounds(
-                &mut caches.cmux,
-                &macros,
-                &init_parameters.micro_params.pbs,
-                partition,
-                &mut operations,
-            );
-
-            // OPT: could be done once and than partially updated
-            apply_all_ks_lower_bound(
-                &mut caches.keyswitch,
-                nb_partitions,
-                &macros,
-                used_tlu_keyswitch,
-                &mut operations,
-            );
-            // OPT: could be done once and than partially updated
-            apply_fks_variance_and_cost_or_lower_bound(
-                &mut caches.keyswitch,
-                nb_partitions,
-                &macros,
-                &init_parameters.micro_params.fks,
-                &fks_to_optimize,
-                used_conversion_keyswitch,
-                &mut operations,
-                ciphertext_modulus_log,
-                fft_precision,
-            );
+        if complexity.complexity(&operations.cost) > search.best_complexity {
+            continue;
+        }
 
-            let non_feasible = !feasible.feasible(&operations.variance);
-            if best_parameters.is_feasible && non_feasible {
-                continue;
+        let micro_opt = optimize_1_cmux_and_dst_exclusive_fks_subset_and_all_ks(
+            partition,
+            &macros,
+            internal_dim,
+            cmux_pareto,
+            fks_to_optimize,
+            used_tlu_keyswitch,
+            &operations,
+            feasible,
+            complexity,
+            &mut caches.keyswitch,
+            search.best_complexity,
+            search.best_p_error,
+            ciphertext_modulus_log,
+            fft_precision,
+        );
+        if let Some(some_micro_params) = micro_opt {
+            // erase macros and all fks that can't be real
+            // set global is_lower_bound here, if any parameter is missing this is lower bound
+            // optimize_micro has already checked for best-ness
+            search.lb_message = None;
+            let mut macro_params = init_parameters.macro_params.clone();
+            macro_params[partition] = Some(macro_param_partition);
+            let mut is_lower_bound = macro_params.iter().any(Option::is_none);
+            if is_lower_bound {
+                search.lb_message = Some("is_lower_bound due to missing macro parameter");
             }
-
-            if complexity.complexity(&operations.cost) > best_complexity {
-                continue;
+            // copy back pbs from other partition
+            let mut all_pbs = init_parameters.micro_params.pbs.clone();
+            all_pbs[partition] = Some(some_micro_params.pbs);
+            let mut all_fks = init_parameters.micro_params.fks.clone();
+            for (dst_partition, maybe_fks) in fks_to_optimize.iter().enumerate() {
+                if let &Some(src_partition) = maybe_fks {
+                    all_fks[src_partition][dst_partition] =
+                        some_micro_params.fks[src_partition][dst_partition];
+                    assert!(used_conversion_keyswitch[src_partition][dst_partition]);
+                    assert!(all_fks[src_partition][dst_partition].is_some());
+                }
             }
-
-            let cmux_pareto = caches.cmux.pareto_quantities(glwe_params);
-
-            if non_feasible {
-                lb_message = Some("Non feasible");
-                // here we optimize for feasibility only
-                // if nothing is feasible, it will give improves feasability for later iterations
-                let mut macro_params = init_parameters.macro_params.clone();
-                macro_params[partition] = Some(MacroParameters {
-                    glwe_params,
-                    internal_dim,
-                });
-                // optimize the feasibility only, takes all lower bounds on variance
-                // this selects both macro parameters and pbs (lowest variance) for this partition
-                let complexity = f64::INFINITY;
-                let cmux_params = cmux::lowest_noise(cmux_pareto);
-                let partition_p_error = partition_feasible.p_error(&operations.variance);
-                if partition_p_error >= best_partition_p_error {
+            // As all fks cannot be re-optimized in some case, we need to check previous ones are still valid.
+            for (src_partition, dst_partition) in cross_partition(nb_partitions) {
+                if !used_conversion_keyswitch[src_partition][dst_partition] {
                     continue;
                 }
-                best_partition_p_error = partition_p_error;
-                let p_error = feasible.p_error(&operations.variance);
-                let global_p_error = feasible.global_p_error(&operations.variance);
-                let mut pbs = init_parameters.micro_params.pbs.clone();
-                pbs[partition] = Some(cmux_params);
-                let micro_params = MicroParameters {
-                    pbs,
-                    ks: vec![vec![None; nb_partitions]; nb_partitions],
-                    fks: vec![vec![None; nb_partitions]; nb_partitions],
-                };
-                best_parameters = Parameters {
-                    p_error,
-                    global_p_error,
-                    complexity,
-                    micro_params,
-                    macro_params,
-                    is_lower_bound: true,
-                    is_feasible: false,
-                };
-                continue;
+                let fks = &all_fks[src_partition][dst_partition];
+                if !is_lower_bound && fks.is_none() {
+                    search.lb_message =
+                        Some("is_lower_bound due to missing fast keyswitch parameter");
+                    is_lower_bound = true;
+                }
+                let src_glwe_param = macro_params[src_partition].map(|p| p.glwe_params);
+                let dst_glwe_param = macro_params[dst_partition].map(|p| p.glwe_params);
+                let src_glwe_param_stable = src_glwe_param == fks.map(|p| p.src_glwe_param);
+                let dst_glwe_param_stable = dst_glwe_param == fks.map(|p| p.dst_glwe_param);
+                if src_glwe_param_stable && dst_glwe_param_stable {
+                    continue;
+                }
+                if !is_lower_bound {
+                    search.lb_message =
+                        Some("is_lower_bound due to changing others fks macro param");
+                }
+                all_fks[src_partition][dst_partition] = None;
+                is_lower_bound = true;
             }
-
-            if complexity.complexity(&operations.cost) > best_complexity {
-                continue;
+            let micro_params = MicroParameters {
+                pbs: all_pbs,
+                ks: some_micro_params.ks,
+                fks: all_fks,
+            };
+            let parameters = Parameters {
+                p_error: some_micro_params.p_error,
+                global_p_error: some_micro_params.global_p_error,
+                complexity: some_micro_params.complexity,
+                micro_params,
+                macro_params,
+                is_lower_bound,
+                is_feasible: true,
+            };
+            // The keys of partial parameters are a lower bound of the final ones.
+            if let Some(maximum) = maximum_evaluation_keys_size {
+                if parameters.evaluation_keys_size() > maximum {
+                    search.lb_message = Some("evaluation keys above the maximum size");
+                    continue;
+                }
             }
+            search.best_complexity = parameters.complexity;
+            search.best_p_error = parameters.p_error;
+            search.best_parameters = parameters;
+        } else {
+            // the macro parameters are feasible
+            // but the complexity is not good enough due to previous feasible solution
+            assert!(search.best_parameters.is_feasible);
+        }
+    }
+    GlweSearch {
+        cut: cut.unwrap_or_else(|| search.clone()),
+        complete: search,
+    }
+}
+
+#[inline(never)]
+fn optimize_macro(
+    security_level: u64,
+    ciphertext_modulus_log: u32,
+    fft_precision: u32,
+    search_space: &SearchSpace,
+    partition: PartitionIndex,
+    used_tlu_keyswitch: &[Vec<bool>],
+    used_conversion_keyswitch: &[Vec<bool>],
+    feasible: &Feasible,
+    complexity: &Complexity,
+    maximum_evaluation_keys_size: Option<u64>,
+    caches: &mut DecompCaches,
+    init_parameters: &Parameters,
+    best_complexity: f64,
+    best_p_error: f64,
+) -> Parameters {
+    let nb_partitions = init_parameters.macro_params.len();
+    assert!(partition < nb_partitions);
+
+    let init_search = MacroSearch {
+        best_parameters: init_parameters.clone(),
+        best_complexity,
+        best_p_error,
+        best_partition_p_error: f64::INFINITY,
+        lb_message: None,
+    };
+
+    let fks_to_optimize = fks_to_optimize(nb_partitions, used_conversion_keyswitch, partition);
+    let operations = OperationsCV {
+        variance: feasible.zero_variance(),
+        cost: complexity.zero_cost(),
+    };
+    let partition_feasible = feasible.filter_constraints(partition);
 
-            let micro_opt = optimize_1_cmux_and_dst_exclusive_fks_subset_and_all_ks(
+    let glwe_params_domain: Vec<_> = search_space
+        .glwe_dimensions
+        .iter()
+        .flat_map(|&glwe_dimension| {
+            search_space
+                .glwe_log_polynomial_sizes
+                .iter()
+                .map(move |&log2_polynomial_size| GlweParameters {
+                    log2_polynomial_size,
+                    glwe_dimension,
+                })
+        })
+        .collect();
+
+    // Each glwe parameters is searched independently on its own copy of the caches, and the
+    // searches are merged in the order of the sequential search, so that the result does not
+    // depend on the number of threads.
+    let shared_caches: &DecompCaches = caches;
+    let glwe_searches: Vec<_> = glwe_params_domain
+        .into_par_iter()
+        .map(|glwe_params| {
+            let mut caches = shared_caches.fork();
+            let glwe_search = optimize_macro_glwe(
+                security_level,
+                ciphertext_modulus_log,
+                fft_precision,
+                search_space,
                 partition,
-                &macros,
-                internal_dim,
-                cmux_pareto,
-                &fks_to_optimize,
+                glwe_params,
                 used_tlu_keyswitch,
-                &operations,
+                used_conversion_keyswitch,
                 feasible,
+                &partition_feasible,
                 complexity,
-                &mut caches.keyswitch,
-                best_complexity,
-                best_p_error,
-                ciphertext_modulus_log,
-                fft_precision,
+                &fks_to_optimize,
+                &operations,
+                maximum_evaluation_keys_size,
+                &mut caches,
+                init_parameters,
+                &init_search,
             );
-            if let Some(some_micro_params) = micro_opt {
-                // erase macros and all fks that can't be real
-                // set global is_lower_bound here, if any parameter is missing this is lower bound
-                // optimize_micro has already checked for best-ness
-                lb_message = None;
-                let mut macro_params = init_parameters.macro_params.clone();
-                macro_params[partition] = Some(macro_param_partition);
-                let mut is_lower_bound = macro_params.iter().any(Option::is_none);
-                if is_lower_bound {
-                    lb_message = Some("is_lower_bound due to missing macro parameter");
-                }
-                // copy back pbs from other partition
-                let mut all_pbs = init_parameters.micro_params.pbs.clone();
-                all_pbs[partition] = Some(some_micro_params.pbs);
-                let mut all_fks = init_parameters.micro_params.fks.clone();
-                for (dst_partition, maybe_fks) in fks_to_optimize.iter().enumerate() {
-                    if let &Some(src_partition) = maybe_fks {
-                        all_fks[src_partition][dst_partition] =
-                            some_micro_params.fks[src_partition][dst_partition];
-                        assert!(used_conversion_keyswitch[src_partition][dst_partition]);
-                        assert!(all_fks[src_partition][dst_partition].is_some());
-                    }
-                }
-                // As all fks cannot be re-optimized in some case, we need to check previous ones are still valid.
-                for (src_partition, dst_partition) in cross_partition(nb_partitions) {
-                    if !used_conversion_keyswitch[src_partition][dst_partition] {
-                        continue;
-                    }
-                    let fks = &all_fks[src_partition][dst_partition];
-                    if !is_lower_bound && fks.is_none() {
-                        lb_message = Some("is_lower_bound due to missing fast keyswitch parameter");
-                        is_lower_bound = true;
-                    }
-                    let src_glwe_param = macro_params[src_partition].map(|p| p.glwe_params);
-                    let dst_glwe_param = macro_params[dst_partition].map(|p| p.glwe_params);
-                    let src_glwe_param_stable = src_glwe_param == fks.map(|p| p.src_glwe_param);
-                    let dst_glwe_param_stable = dst_glwe_param == fks.map(|p| p.dst_glwe_param);
-                    if src_glwe_param_stable && dst_glwe_param_stable {
-                        continue;
-                    }
-                    if !is_lower_bound {
-                        lb_message = Some("is_lower_bound due to changing others fks macro param");
-                    }
-                    all_fks[src_partition][dst_partition] = None;
-                    is_lower_bound = true;
-                }
-                let micro_params = MicroParameters {
-                    pbs: all_pbs,
-                    ks: some_micro_params.ks,
-                    fks: all_fks,
-                };
-                best_complexity = some_micro_params.complexity;
-                best_p_error = some_micro_params.p_error;
-                best_parameters = Parameters {
-                    p_error: best_p_error,
-                    global_p_error: some_micro_params.global_p_error,
-                    complexity: best_complexity,
-                    micro_params,
-                    macro_params,
-                    is_lower_bound,
-                    is_feasible: true,
-                };
-            } else {
-                // the macro parameters are feasible
-                // but the complexity is not good enough due to previous feasible solution
-                assert!(best_parameters.is_feasible);
-            }
+            (glwe_search, caches)
+        })
+        .collect();
+
+    let mut search = init_search;
+    for (glwe_search, glwe_caches) in glwe_searches {
+        caches.absorb(glwe_caches);
+        if search.best_parameters.is_feasible {
+            search.merge(glwe_search.cut);
+        } else {
+            search.merge(glwe_search.complete);
         }
     }
-    if DEBUG && lb_message.is_some() {
-        eprintln!("{}", lb_message.unwrap());
+    if DEBUG && search.lb_message.is_some() {
+        eprintln!("{}", search.lb_message.unwrap());
     }
-    best_parameters
+    search.best_parameters
 }
 
 fn cross_partition(nb_partitions: usize) -> impl Iterator<Item = (usize, usize)> {
@@ -924,7 +1094,11 @@ pub fn optimize(
     let mut caches = persistent_caches.caches();
 
     let feasible = Feasible::of(&dag.variance_constraints, kappa, None).compressed();
-    let complexity = Complexity::of(&dag.operations_count).compressed();
+    let operations_count = match config.latency_workers {
+        Some(workers) => dag.critical_path_operations_count(workers),
+        None => dag.operations_count.clone(),
+    };
+    let complexity = Complexity::of(&operations_count).compressed();
     let used_tlu_keyswitch = used_tlu_keyswitch(&dag);
     let used_conversion_keyswitch = used_conversion_keyswitch(&dag);
 
@@ -961,6 +1135,7 @@ pub fn optimize(
                 &used_conversion_keyswitch,
                 &feasible,
                 &complexity,
+                config.maximum_evaluation_keys_size,
                 &mut caches,
                 &params,
                 best_complexity,
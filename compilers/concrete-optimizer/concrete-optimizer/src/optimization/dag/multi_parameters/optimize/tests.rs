@@ -42,6 +42,8 @@ fn default_config() -> Config<'static> {
         fft_precision: 53,
         complexity_model,
         composable: false,
+        maximum_evaluation_keys_size: None,
+        latency_workers: None,
     }
 }
 
@@ -664,6 +666,8 @@ fn test_big_secret_key_sharing() {
         fft_precision: 53,
         complexity_model: &CpuComplexity::default(),
         composable: false,
+        maximum_evaluation_keys_size: None,
+        latency_workers: None,
     };
     let config_no_sharing = Config {
         key_sharing: false,
@@ -715,6 +719,8 @@ fn test_big_and_small_secret_key() {
         fft_precision: 53,
         complexity_model: &CpuComplexity::default(),
         composable: false,
+        maximum_evaluation_keys_size: None,
+        latency_workers: None,
     };
     let config_no_sharing = Config {
         key_sharing: false,
@@ -845,3 +851,30 @@ fn test_maximal_multi() {
     // note: we have a 5% relative margin since dag complexity is slightly better than v0
     assert!(sol.complexity < 1.05 * (sol_ref.complexity / expected_speedup));
 }
+
+#[test]
+fn test_maximum_evaluation_keys_size() {
+    let search_space = SearchSpace::default_cpu();
+    let (precision1, precision2) = (4, 8);
+    let p_cut = Some(PartitionCut::from_precisions(&[precision1, precision2]));
+    let dag = dag_lut_sum_of_2_partitions_2_layer(precision1, precision2, true);
+    let sol = optimize(&dag, &p_cut, LOW_PARTITION).unwrap();
+    let keys_size = sol.evaluation_keys_size();
+
+    let config = Config {
+        maximum_evaluation_keys_size: Some(keys_size - 1),
+        ..default_config()
+    };
+    let constrained_sol = super::optimize(
+        &dag,
+        config,
+        &search_space,
+        &SHARED_CACHES,
+        &p_cut,
+        LOW_PARTITION,
+    );
+    if let Ok((_, constrained_sol)) = constrained_sol {
+        assert!(constrained_sol.evaluation_keys_size() < keys_size);
+        assert!(constrained_sol.complexity >= sol.complexity);
+    }
+}
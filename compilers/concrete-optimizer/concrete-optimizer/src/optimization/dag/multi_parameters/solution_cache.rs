@@ -0,0 +1,198 @@
+use std::fs::File;
+use std::hash::Hasher;
+use std::io::{BufReader, BufWriter};
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use rustc_hash::FxHasher;
+
+use crate::dag::operator::Operator;
+use crate::dag::unparametrized::OperationDag;
+use crate::optimization::config::{Config, SearchSpace};
+use crate::optimization::dag::multi_parameters::keys_spec::CircuitSolution;
+use crate::optimization::dag::multi_parameters::partition_cut::PartitionCut;
+use crate::optimization::dag::solo_key::optimize_generic::Encoding;
+
+// to invalidate the saved solutions when the optimizer gives different ones
+const VERSION: u64 = 1;
+
+static NB_WRITES: AtomicU64 = AtomicU64::new(0);
+
+/// Solutions of whole circuits saved on disk, to skip the optimization of a recompiled circuit.
+///
+/// Each solution has its own file, named by the hash of its key, so that the directory can be
+/// filled by concurrent processes and copied between machines. The file also holds the full key,
+/// to rule out hash collisions.
+/// The key does not cover the complexity model, a cache directory is only valid for one model.
+pub struct SolutionCache {
+    dir: PathBuf,
+}
+
+impl SolutionCache {
+    pub fn new(dir: &str) -> Self {
+        Self { dir: dir.into() }
+    }
+
+    /// The key of an optimization. Operator comments are left out, so that structurally
+    /// equivalent circuits share their solution.
+    pub fn key(
+        dag: &OperationDag,
+        config: &Config,
+        search_space: &SearchSpace,
+        encoding: Encoding,
+        default_log_norm2_woppbs: f64,
+        p_cut: &Option<PartitionCut>,
+    ) -> String {
+        let mut key = format!("version {VERSION}\n");
+        for op in &dag.operators {
+            let op = if let Operator::LevelledOp {
+                inputs,
+                complexity,
+                manp,
+                out_shape,
+                ..
+            } = op
+            {
+                format!("LevelledOp {inputs:?} {complexity:?} {manp:?} {out_shape:?}\n")
+            } else {
+                format!("{op:?}\n")
+            };
+            key.push_str(&op);
+        }
+        key.push_str(&format!(
+            "{:?} {:?}\n{} {:?} {} {} {} {} {:?} {:?}\n{search_space:?}\n{encoding:?} \
+             {default_log_norm2_woppbs:?}\n{p_cut:?}\n",
+            dag.out_precisions,
+            dag.output_tags,
+            config.security_level,
+            config.maximum_acceptable_error_probability,
+            config.key_sharing,
+            config.ciphertext_modulus_log,
+            config.fft_precision,
+            config.composable,
+            config.maximum_evaluation_keys_size,
+            config.latency_workers,
+        ));
+        key
+    }
+
+    fn path(&self, key: &str) -> PathBuf {
+        let mut hasher = FxHasher::default();
+        hasher.write(key.as_bytes());
+        self.dir.join(format!("{:016x}.solution", hasher.finish()))
+    }
+
+    pub fn get(&self, key: &str) -> Option<CircuitSolution> {
+        let file = File::open(self.path(key)).ok()?;
+        let (saved_key, solution): (String, CircuitSolution) =
+            bincode::deserialize_from(BufReader::new(file)).ok()?;
+        (saved_key == key).then_some(solution)
+    }
+
+    pub fn insert(&self, key: &str, solution: &CircuitSolution) {
+        let path = self.path(key);
+        // written aside then renamed, so that a concurrent reader never sees a partial file
+        let nb_writes = NB_WRITES.fetch_add(1, Ordering::Relaxed);
+        let tmp_path = path.with_extension(format!("{}-{nb_writes}.tmp", std::process::id()));
+        let written = std::fs::create_dir_all(&self.dir)
+            .and_then(|()| File::create(&tmp_path))
+            .and_then(|file| {
+                bincode::serialize_into(BufWriter::new(file), &(key, solution))
+                    .map_err(|err| std::io::Error::new(std::io::ErrorKind::Other, err))
+            })
+            .and_then(|()| std::fs::rename(&tmp_path, &path));
+        if let Err(err) = written {
+            println!(
+                "SolutionCache::insert: Cannot write {}: {err}",
+                path.display()
+            );
+            drop(std::fs::remove_file(&tmp_path));
+        }
+    }
+
+    pub fn get_or_optimize(
+        &self,
+        key: &str,
+        optimize: impl FnOnce() -> CircuitSolution,
+    ) -> CircuitSolution {
+        if let Some(solution) = self.get(key) {
+            return solution;
+        }
+        let solution = optimize();
+        // an unfeasible circuit is changed rather than recompiled as is
+        if solution.is_feasible {
+            self.insert(key, &solution);
+        }
+        solution
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::computing_cost::cpu::CpuComplexity;
+    use crate::dag::operator::{FunctionTable, LevelledComplexity, Shape};
+
+    fn dag(comment: &str) -> OperationDag {
+        let mut dag = OperationDag::new();
+        let input = dag.add_input(4, Shape::number());
+        let sum = dag.add_levelled_op(
+            [input, input],
+            LevelledComplexity::ADDITION,
+            2.0,
+            Shape::number(),
+            comment,
+        );
+        let _lut = dag.add_lut(sum, FunctionTable::UNKWOWN, 4);
+        dag
+    }
+
+    #[test]
+    fn test_solution_cache() {
+        let complexity_model = CpuComplexity::default();
+        let config = Config {
+            security_level: 128,
+            maximum_acceptable_error_probability: 1.0 / 65536.0,
+            key_sharing: true,
+            ciphertext_modulus_log: 64,
+            fft_precision: 53,
+            complexity_model: &complexity_model,
+            composable: false,
+            maximum_evaluation_keys_size: None,
+            latency_workers: None,
+        };
+        let search_space = SearchSpace::default_cpu();
+        let key = |dag: &OperationDag, config: &Config| {
+            SolutionCache::key(dag, config, &search_space, Encoding::Auto, 8.0, &None)
+        };
+        let key1 = key(&dag("a + a"), &config);
+        assert_eq!(key1, key(&dag("sum"), &config));
+        let key2 = key(
+            &dag("a + a"),
+            &Config {
+                security_level: 132,
+                ..config
+            },
+        );
+        assert_ne!(key1, key2);
+
+        let mut dir = std::env::temp_dir();
+        dir.push(format!(
+            "optimizer-solution-cache-test-{}",
+            std::process::id()
+        ));
+        let cache = SolutionCache::new(dir.to_str().unwrap());
+        let solution = CircuitSolution {
+            complexity: 3.0,
+            is_feasible: true,
+            ..CircuitSolution::default()
+        };
+        assert!(cache.get(&key1).is_none());
+        let cached = cache.get_or_optimize(&key1, || solution.clone());
+        assert!(cached.complexity == 3.0);
+        let cached = cache.get_or_optimize(&key1, || unreachable!());
+        assert!(cached.complexity == 3.0);
+        assert!(cache.get(&key2).is_none());
+        drop(std::fs::remove_dir_all(&dir));
+    }
+}
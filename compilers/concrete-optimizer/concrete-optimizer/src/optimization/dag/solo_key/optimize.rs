@@ -481,6 +481,8 @@ pub(crate) mod tests {
             fft_precision: 53,
             complexity_model: &CpuComplexity::default(),
             composable: false,
+            maximum_evaluation_keys_size: None,
+            latency_workers: None,
         };
 
         let search_space = SearchSpace::default_cpu();
@@ -527,6 +529,8 @@ pub(crate) mod tests {
             fft_precision: 53,
             complexity_model: &CpuComplexity::default(),
             composable: false,
+            maximum_evaluation_keys_size: None,
+            latency_workers: None,
         };
 
         _ = optimize_v0(
@@ -627,6 +631,8 @@ pub(crate) mod tests {
             fft_precision: 53,
             complexity_model: &CpuComplexity::default(),
             composable: false,
+            maximum_evaluation_keys_size: None,
+            latency_workers: None,
         };
 
         let state = optimize(&dag);
@@ -24,7 +24,7 @@ impl Solution {
     }
 }
 
-#[derive(Clone, Copy)]
+#[derive(Clone, Copy, Debug)]
 pub enum Encoding {
     Auto,
     Native,
@@ -44,6 +44,24 @@ pub fn cache(
     )
 }
 
+impl DecompCaches {
+    pub fn fork(&self) -> Self {
+        Self {
+            cmux: self.cmux.fork(),
+            keyswitch: self.keyswitch.fork(),
+            pp_switch: self.pp_switch.fork(),
+            cb_pbs: self.cb_pbs.fork(),
+        }
+    }
+
+    pub fn absorb(&mut self, other: Self) {
+        self.cmux.absorb(other.cmux);
+        self.keyswitch.absorb(other.keyswitch);
+        self.pp_switch.absorb(other.pp_switch);
+        self.cb_pbs.absorb(other.cb_pbs);
+    }
+}
+
 impl PersistDecompCaches {
     pub fn new(
         security_level: u64,
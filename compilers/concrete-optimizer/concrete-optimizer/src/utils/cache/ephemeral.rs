@@ -58,4 +58,25 @@ where
     }
 }
 
+impl<ROC> Cache<ROC>
+where
+    ROC: ReadOnlyCache,
+    ROC::K: Hash + std::cmp::Eq + Copy,
+{
+    /* A copy for another thread, its new entries can be given back with `absorb` */
+    pub fn fork(&self) -> Self {
+        Self {
+            initial_content: self.initial_content.clone(),
+            updated_content: self.updated_content.clone(),
+            function: self.function.clone(),
+        }
+    }
+
+    pub fn absorb(&mut self, other: Self) {
+        for (k, v) in other.updated_content {
+            let _ = self.updated_content.entry(k).or_insert(v);
+        }
+    }
+}
+
 pub type CacheHashMap<K, V> = Cache<Map<K, V>>;
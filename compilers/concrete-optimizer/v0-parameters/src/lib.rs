@@ -127,6 +127,8 @@ pub fn all_results(args: &Args) -> Vec<Vec<Option<Solution>>> {
         fft_precision: args.fft_precision,
         complexity_model: &CpuComplexity::default(),
         composable,
+        maximum_evaluation_keys_size: None,
+        latency_workers: None,
     };
 
     let cache = decomposition::cache(
@@ -25,7 +25,12 @@ from .compilation import (
     MultiParameterStrategy,
     MultivariateStrategy,
     ParameterSelectionStrategy,
+    RequestCoalescer,
+    RoundingReport,
+    RoundingTrial,
+    RoundingTuner,
     Server,
+    ServerPool,
     Value,
     inputset,
 )
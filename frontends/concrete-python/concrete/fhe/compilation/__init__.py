@@ -5,6 +5,7 @@ Glue the compilation process together.
 from .artifacts import DebugArtifacts, FunctionDebugArtifacts, ModuleDebugArtifacts
 from .circuit import Circuit
 from .client import Client
+from .coalescer import RequestCoalescer
 from .compiler import Compiler, EncryptionStatus
 from .configuration import (
     DEFAULT_GLOBAL_P_ERROR,
@@ -22,6 +23,8 @@ from .configuration import (
 from .keys import Keys
 from .module import FheFunction, FheModule
 from .module_compiler import FunctionDef, ModuleCompiler
+from .pool import ServerPool
+from .rounding_tuner import RoundingReport, RoundingTrial, RoundingTuner
 from .server import Server
 from .specs import ClientSpecs
 from .utils import inputset
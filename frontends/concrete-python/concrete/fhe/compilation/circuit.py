@@ -8,12 +8,7 @@ from pathlib import Path
 from typing import Any, Dict, List, Optional, Tuple, Union
 
 import numpy as np
-from concrete.compiler import (
-    CompilationContext,
-    Parameter,
-    SimulatedValueDecrypter,
-    SimulatedValueExporter,
-)
+from concrete.compiler import CompilationContext, Parameter
 from mlir.ir import Module as MlirModule
 
 from ..internal.utils import assert_that
@@ -156,12 +151,12 @@ class Circuit:
 
         ordered_validated_args = validate_input_args(self.simulator.client_specs, *args)
 
-        exporter = SimulatedValueExporter.new(self.simulator.client_specs.client_parameters)
+        exporter = self.simulator.simulated_exporter()
         exported = [
             None
             if arg is None
             else Value(
-                exporter.export_tensor(position, arg.flatten().tolist(), list(arg.shape))
+                exporter.export_tensor(position, arg, list(arg.shape))
                 if isinstance(arg, np.ndarray) and arg.shape != ()
                 else exporter.export_scalar(position, int(arg))
             )
@@ -172,7 +167,7 @@ class Circuit:
         if not isinstance(results, tuple):
             results = (results,)
 
-        decrypter = SimulatedValueDecrypter.new(self.simulator.client_specs.client_parameters)
+        decrypter = self.simulator.simulated_decrypter()
         decrypted = tuple(
             decrypter.decrypt(position, result.inner) for position, result in enumerate(results)
         )
@@ -244,6 +239,27 @@ class Circuit:
 
         return self.client.encrypt(*args)
 
+    def encrypt_batch(
+        self,
+        *args: Optional[Union[np.ndarray, List]],
+    ) -> List[Optional[Union[Value, Tuple[Optional[Value], ...]]]]:
+        """
+        Encrypt a batch of samples for evaluation.
+
+        Args:
+            *args (Optional[Union[numpy.ndarray, List]]):
+                argument(s) for evaluation, each stacking the samples along its first dimension
+
+        Returns:
+            List[Optional[Union[Value, Tuple[Optional[Value], ...]]]]:
+                encrypted argument(s) of each sample
+        """
+
+        if not hasattr(self, "client"):  # pragma: no cover
+            self.enable_fhe_execution()
+
+        return self.client.encrypt_batch(*args)
+
     def run(
         self,
         *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
@@ -266,6 +282,28 @@ class Circuit:
         self.keygen(force=False)
         return self.server.run(*args, evaluation_keys=self.client.evaluation_keys)
 
+    def run_batch(
+        self,
+        batch: List[Union[Value, Tuple[Optional[Value], ...]]],
+    ) -> List[Union[Value, Tuple[Value, ...]]]:
+        """
+        Evaluate the circuit on a batch of samples, in parallel.
+
+        Args:
+            batch (List[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) of each sample
+
+        Returns:
+            List[Union[Value, Tuple[Value, ...]]]:
+                result(s) of evaluation of each sample
+        """
+
+        if not hasattr(self, "server"):  # pragma: no cover
+            self.enable_fhe_execution()
+
+        self.keygen(force=False)
+        return self.server.run_batch(batch, evaluation_keys=self.client.evaluation_keys)
+
     def decrypt(
         self,
         *results: Union[Value, Tuple[Value, ...]],
@@ -287,6 +325,27 @@ class Circuit:
 
         return self.client.decrypt(*results)
 
+    def decrypt_batch(
+        self,
+        results: List[Union[Value, Tuple[Value, ...]]],
+    ) -> List[Union[int, np.ndarray, Tuple[Union[int, np.ndarray], ...]]]:
+        """
+        Decrypt the result(s) of a batch of evaluations.
+
+        Args:
+            results (List[Union[Value, Tuple[Value, ...]]]):
+                result(s) of each evaluation
+
+        Returns:
+            List[Union[int, np.ndarray, Tuple[Union[int, np.ndarray], ...]]]:
+                decrypted result(s) of each evaluation
+        """
+
+        if not hasattr(self, "client"):  # pragma: no cover
+            self.enable_fhe_execution()
+
+        return self.client.decrypt_batch(results)
+
     def encrypt_run_decrypt(self, *args: Any) -> Any:
         """
         Encrypt inputs, run the circuit, and decrypt the outputs in one go.
@@ -368,6 +427,20 @@ class Circuit:
         """
         return self._property("size_of_outputs")()  # pragma: no cover
 
+    @property
+    def predicted_latency(self) -> Optional[float]:
+        """
+        Get the predicted seconds of a call of the circuit.
+        """
+        return self._property("predicted_latency")()  # pragma: no cover
+
+    @property
+    def predicted_throughput(self) -> Optional[float]:
+        """
+        Get the predicted calls per second of the circuit.
+        """
+        return self._property("predicted_throughput")()  # pragma: no cover
+
     @property
     def p_error(self) -> int:
         """
@@ -7,7 +7,7 @@ Declaration of `Client` class.
 import shutil
 import tempfile
 from pathlib import Path
-from typing import List, Optional, Tuple, Union
+from typing import Any, Dict, List, Optional, Tuple, Union
 
 import numpy as np
 from concrete.compiler import EvaluationKeys, ValueDecrypter, ValueExporter
@@ -28,6 +28,10 @@ class Client:
     specs: ClientSpecs
     _keys: Keys
 
+    # exporters and decrypters by function name, along with the keyset they are built for
+    _exporters: Dict[str, Tuple[Any, ValueExporter]]
+    _decrypters: Dict[str, Tuple[Any, ValueDecrypter]]
+
     def __init__(
         self,
         client_specs: ClientSpecs,
@@ -35,6 +39,8 @@ class Client:
     ):
         self.specs = client_specs
         self._keys = Keys(client_specs, keyset_cache_directory)
+        self._exporters = {}
+        self._decrypters = {}
 
     def save(self, path: Union[str, Path]):
         """
@@ -117,6 +123,36 @@ class Client:
 
         self.keys.generate(force=force, seed=seed, encryption_seed=encryption_seed)
 
+    def _exporter(self, function_name: str) -> ValueExporter:
+        """
+        Get the exporter of a function, built once per keyset as it holds the transformers of its
+        arguments.
+        """
+
+        self.keygen(force=False)
+        keyset = self.keys._keyset  # pylint: disable=protected-access
+
+        cached = self._exporters.get(function_name)
+        if cached is None or cached[0] is not keyset:
+            exporter = ValueExporter.new(keyset, self.specs.client_parameters, function_name)
+            cached = self._exporters[function_name] = (keyset, exporter)
+        return cached[1]
+
+    def _decrypter(self, function_name: str) -> ValueDecrypter:
+        """
+        Get the decrypter of a function, built once per keyset as it holds the transformers of its
+        results.
+        """
+
+        self.keygen(force=False)
+        keyset = self.keys._keyset  # pylint: disable=protected-access
+
+        cached = self._decrypters.get(function_name)
+        if cached is None or cached[0] is not keyset:
+            decrypter = ValueDecrypter.new(keyset, self.specs.client_parameters, function_name)
+            cached = self._decrypters[function_name] = (keyset, decrypter)
+        return cached[1]
+
     def encrypt(
         self,
         *args: Optional[Union[int, np.ndarray, List]],
@@ -138,15 +174,12 @@ class Client:
 
         ordered_sanitized_args = validate_input_args(self.specs, *args, function_name=function_name)
 
-        self.keygen(force=False)
-        keyset = self.keys._keyset  # pylint: disable=protected-access
-
-        exporter = ValueExporter.new(keyset, self.specs.client_parameters, function_name)
+        exporter = self._exporter(function_name)
         exported = [
             None
             if arg is None
             else Value(
-                exporter.export_tensor(position, arg.flatten().tolist(), list(arg.shape))
+                exporter.export_tensor(position, arg, list(arg.shape))
                 if isinstance(arg, np.ndarray) and arg.shape != ()
                 else exporter.export_scalar(position, int(arg))
             )
@@ -155,6 +188,45 @@ class Client:
 
         return tuple(exported) if len(exported) != 1 else exported[0]
 
+    def encrypt_batch(
+        self,
+        *args: Optional[Union[np.ndarray, List]],
+        function_name: str = "main",
+    ) -> List[Optional[Union[Value, Tuple[Optional[Value], ...]]]]:
+        """
+        Encrypt a batch of samples for evaluation.
+
+        The samples are validated at once and exported in C++, without a python loop over them.
+
+        Args:
+            *args (Optional[Union[np.ndarray, List]]):
+                argument(s) for evaluation, each stacking the samples along its first dimension
+
+            function_name (str):
+                name of the function to encrypt
+
+        Returns:
+            List[Optional[Union[Value, Tuple[Optional[Value], ...]]]]:
+                encrypted argument(s) of each sample, as `encrypt` would return them
+        """
+
+        ordered_sanitized_args = validate_input_args(
+            self.specs, *args, function_name=function_name, batched=True
+        )
+        batch_size = next((len(arg) for arg in ordered_sanitized_args if arg is not None), 0)
+
+        exporter = self._exporter(function_name)
+        exported = [
+            [None] * batch_size
+            if arg is None
+            else [
+                Value(value) for value in exporter.export_batch(position, arg, list(arg.shape[1:]))
+            ]
+            for position, arg in enumerate(ordered_sanitized_args)
+        ]
+
+        return [tuple(sample) if len(sample) != 1 else sample[0] for sample in zip(*exported)]
+
     def decrypt(
         self,
         *results: Union[Value, Tuple[Value, ...]],
@@ -182,10 +254,7 @@ class Client:
             else:
                 flattened_results.append(result)
 
-        self.keygen(force=False)
-        keyset = self.keys._keyset  # pylint: disable=protected-access
-
-        decrypter = ValueDecrypter.new(keyset, self.specs.client_parameters, function_name)
+        decrypter = self._decrypter(function_name)
         decrypted = tuple(
             decrypter.decrypt(position, result.inner)
             for position, result in enumerate(flattened_results)
@@ -193,6 +262,38 @@ class Client:
 
         return decrypted if len(decrypted) != 1 else decrypted[0]
 
+    def decrypt_batch(
+        self,
+        results: List[Union[Value, Tuple[Value, ...]]],
+        function_name: str = "main",
+    ) -> List[Union[int, np.ndarray, Tuple[Union[int, np.ndarray], ...]]]:
+        """
+        Decrypt the result(s) of a batch of evaluations, in parallel.
+
+        Args:
+            results (List[Union[Value, Tuple[Value, ...]]]):
+                result(s) of each evaluation, as returned by `Server.run_batch`
+
+            function_name (str):
+                name of the function to decrypt for
+
+        Returns:
+            List[Union[int, np.ndarray, Tuple[Union[int, np.ndarray], ...]]]:
+                decrypted result(s) of each evaluation, as `decrypt` would return them
+        """
+
+        flattened_results = [
+            result if isinstance(result, tuple) else (result,) for result in results
+        ]
+
+        decrypter = self._decrypter(function_name)
+        decrypted = [
+            decrypter.decrypt_batch(position, [result.inner for result in outputs])
+            for position, outputs in enumerate(zip(*flattened_results))
+        ]
+
+        return [tuple(sample) if len(sample) != 1 else sample[0] for sample in zip(*decrypted)]
+
     @property
     def evaluation_keys(self) -> EvaluationKeys:
         """
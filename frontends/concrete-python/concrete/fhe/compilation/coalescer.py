@@ -0,0 +1,142 @@
+"""
+Declaration of `RequestCoalescer` class.
+"""
+
+# pylint: disable=import-error,no-name-in-module
+
+import asyncio
+from typing import Any, Dict, List, Optional, Tuple, Union
+
+from concrete.compiler import EvaluationKeys
+
+from .server import Server
+from .value import Value
+
+# pylint: enable=import-error,no-name-in-module
+
+
+class RequestCoalescer:
+    """
+    RequestCoalescer class, which merges concurrent evaluations into batched evaluations.
+
+    The first request for a function opens a window, and the requests for the same function
+    and evaluation keys received during the window are evaluated together with
+    `Server.run_batch`, which keeps the hardware busy under concurrent load.
+    """
+
+    server: Server
+    window: float
+    max_batch_size: Optional[int]
+    max_threads: int
+
+    _pending: Dict[Tuple[str, int], List[Tuple[Tuple[Any, ...], asyncio.Future]]]
+
+    def __init__(
+        self,
+        server: Server,
+        window: float = 0.002,
+        max_batch_size: Optional[int] = None,
+        max_threads: int = 0,
+    ):
+        """
+        Args:
+            server (Server):
+                server to evaluate the requests with
+
+            window (float, default = 0.002):
+                maximum time in seconds a request waits for others to be merged with
+
+            max_batch_size (Optional[int], default = None):
+                maximum number of requests in a batch, the batch being evaluated as soon as it
+                is full, or no maximum if None
+
+            max_threads (int, default = 0):
+                maximum number of threads to evaluate a batch with, all the hardware threads if 0
+        """
+
+        self.server = server
+        self.window = window
+        self.max_batch_size = max_batch_size
+        self.max_threads = max_threads
+
+        self._pending = {}
+
+    async def run(
+        self,
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+        evaluation_keys: Optional[EvaluationKeys] = None,
+        function_name: str = "main",
+    ) -> Union[Value, Tuple[Value, ...]]:
+        """
+        Evaluate, within the next batch of the function.
+
+        Args:
+            *args (Optional[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) for evaluation
+
+            evaluation_keys (Optional[EvaluationKeys], default = None):
+                evaluation keys required for fhe execution
+
+            function_name (str):
+                The name of the function to run
+
+        Returns:
+            Union[Value, Tuple[Value, ...]]:
+                result(s) of evaluation
+        """
+
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+
+        # requests with different keys are for different clients, they can't be merged
+        key = (function_name, id(evaluation_keys))
+        pending = self._pending.setdefault(key, [])
+        pending.append((args, future))
+
+        if len(pending) == 1:
+            loop.call_later(self.window, self._flush, key, pending, evaluation_keys)
+        if self.max_batch_size is not None and len(pending) >= self.max_batch_size:
+            self._flush(key, pending, evaluation_keys)
+
+        return await future
+
+    def _flush(
+        self,
+        key: Tuple[str, int],
+        pending: List[Tuple[Tuple[Any, ...], asyncio.Future]],
+        evaluation_keys: Optional[EvaluationKeys],
+    ):
+        # the batch may have been flushed already, when it got full before the end of the window
+        if self._pending.get(key) is not pending:
+            return
+        del self._pending[key]
+
+        asyncio.ensure_future(self._evaluate(key[0], pending, evaluation_keys))
+
+    async def _evaluate(
+        self,
+        function_name: str,
+        pending: List[Tuple[Tuple[Any, ...], asyncio.Future]],
+        evaluation_keys: Optional[EvaluationKeys],
+    ):
+        loop = asyncio.get_running_loop()
+        try:
+            results = await loop.run_in_executor(
+                None,
+                lambda: self.server.run_batch(
+                    [args for args, _ in pending],
+                    evaluation_keys,
+                    function_name,
+                    self.max_threads,
+                ),
+            )
+        except Exception as error:  # pylint: disable=broad-except
+            for _, future in pending:
+                if not future.done():
+                    future.set_exception(error)
+            return
+
+        for (_, future), result in zip(pending, results):
+            # the awaiting task may have been cancelled in the meantime
+            if not future.done():
+                future.set_result(result)
@@ -22,7 +22,7 @@ from ..values import ValueDescription
 from .artifacts import DebugArtifacts
 from .circuit import Circuit
 from .configuration import Configuration
-from .utils import fuse, get_terminal_size
+from .utils import fuse, fuse_table_lookup_chains, get_terminal_size, sample_inputset
 
 # pylint: enable=import-error,no-name-in-module
 
@@ -301,7 +301,17 @@ class Compiler:
             self._trace(first_sample)
             assert self.graph is not None
 
-        bounds = self.graph.measure_bounds(self.inputset)
+        if self.configuration.fuse_tlu_chains:
+            fuse_table_lookup_chains(
+                self.graph,
+                self.artifacts.module_artifacts.functions["main"] if self.artifacts else None,
+            )
+
+        inputset = self.inputset
+        if self.configuration.bounds_measurement_sample_size is not None:
+            inputset = sample_inputset(inputset, self.configuration.bounds_measurement_sample_size)
+
+        bounds = self.graph.measure_bounds(inputset)
         self.graph.update_with_bounds(bounds)
 
         if self.artifacts is not None:
@@ -405,6 +415,84 @@ class Compiler:
             self.configuration = old_configuration
             self.artifacts = old_artifacts
 
+    def _search_precision_merges(self) -> Dict[int, int]:
+        """
+        Search the precisions to merge for the cheapest circuit.
+
+        Raising the values of a precision to the next one lets the optimizer use the same
+        parameters for both, which can remove keyswitches between them, but makes their
+        table lookups more expensive. The search compiles the graph with the two closest
+        precisions merged, for each pair of them, and keeps the cheapest merge
+        as long as it lowers the complexity of the circuit.
+
+        Returns:
+            Dict[int, int]:
+                precisions to merge, from the minimal one of a value to the one it is raised to
+        """
+
+        assert self.graph is not None
+
+        configuration = self.configuration.fork(
+            fhe_simulation=True,
+            fhe_execution=False,
+            optimize_bit_width_assignment=False,
+            show_graph=False,
+            show_bit_width_constraints=False,
+            show_bit_width_assignments=False,
+            show_assigned_graph=False,
+            show_mlir=False,
+            show_optimizer=False,
+            show_statistics=False,
+            verbose=False,
+        )
+
+        def evaluate(precision_merges: Dict[int, int]) -> Tuple[float, List[int]]:
+            graph = deepcopy(self.graph)
+            try:
+                mlir_context = self.compilation_context.mlir_context()
+                mlir_module = GraphConverter(configuration, precision_merges).convert(
+                    graph,
+                    mlir_context,
+                )
+                circuit = Circuit(graph, mlir_module, self.compilation_context, configuration)
+                complexity = circuit.complexity
+                circuit.cleanup()
+            except Exception:  # pylint: disable=broad-except  # pragma: no cover
+                return float("inf"), []
+
+            precisions = sorted(
+                {
+                    node.output.dtype.bit_width
+                    for node in graph.query_nodes()
+                    if node.output.is_encrypted
+                }
+            )
+            return complexity, precisions
+
+        precision_merges: Dict[int, int] = {}
+        complexity, precisions = evaluate(precision_merges)
+
+        while len(precisions) > 1:
+            candidates = []
+            for lower, upper in zip(precisions, precisions[1:]):
+                candidate = {
+                    minimal: (upper if merged == lower else merged)
+                    for minimal, merged in precision_merges.items()
+                }
+                candidate[lower] = upper
+                candidates.append((candidate, *evaluate(candidate)))
+
+            best, best_complexity, best_precisions = min(
+                candidates,
+                key=lambda candidate: candidate[1],
+            )
+            if best_complexity >= complexity:
+                break
+
+            precision_merges, complexity, precisions = best, best_complexity, best_precisions
+
+        return precision_merges
+
     # pylint: disable=too-many-branches,too-many-statements
 
     def compile(
@@ -516,9 +604,19 @@ class Compiler:
 
                     print()
 
+            precision_merges = None
+            if (
+                self.configuration.optimize_bit_width_assignment
+                and not self.configuration.single_precision
+            ):
+                precision_merges = self._search_precision_merges()
+
             # in-memory MLIR module
             mlir_context = self.compilation_context.mlir_context()
-            mlir_module = GraphConverter(self.configuration).convert(self.graph, mlir_context)
+            mlir_module = GraphConverter(self.configuration, precision_merges).convert(
+                self.graph,
+                mlir_context,
+            )
             # textual representation of the MLIR module
             mlir_str = str(mlir_module).strip()
             if self.artifacts is not None:
@@ -21,6 +21,56 @@ DEFAULT_P_ERROR = None
 DEFAULT_GLOBAL_P_ERROR = 1 / 100_000
 
 
+def _chunked_table_lookups(x_bit_width: int, y_bit_width: int) -> List[int]:
+    """
+    Get the bit-widths of the table lookups of chunked implementations, approximately.
+
+    Each chunk is extracted from both operands, and the packed chunks are mapped.
+    """
+
+    bigger_bit_width = max(x_bit_width, y_bit_width)
+    smaller_bit_width = min(x_bit_width, y_bit_width)
+
+    chunk_size = max(1, bigger_bit_width // 2)
+    if chunk_size >= smaller_bit_width:
+        number_of_chunks = 1 + int(smaller_bit_width != bigger_bit_width)
+    else:
+        chunk_size = min(chunk_size, int(np.ceil(smaller_bit_width / 2)))
+        number_of_chunks = 2 + int(2 * chunk_size < bigger_bit_width)
+
+    return [x_bit_width, y_bit_width, 2 * chunk_size] * number_of_chunks
+
+
+def _clipped_subtraction_bit_width(smaller_dtype: Integer, bigger_dtype: Integer) -> int:
+    """
+    Get the bit-width of the subtraction of the smaller operand and the clipped bigger operand.
+    """
+
+    smaller_bounds = [smaller_dtype.min(), smaller_dtype.max()]
+    clipped_bigger_bounds = [
+        np.clip(smaller_bounds[0] - 1, bigger_dtype.min(), bigger_dtype.max()),
+        np.clip(smaller_bounds[1] + 1, bigger_dtype.min(), bigger_dtype.max()),
+    ]
+
+    smaller_minus_clipped_bigger_dtype = Integer.that_can_represent(
+        [
+            smaller_bounds[0] - clipped_bigger_bounds[1],
+            smaller_bounds[1] - clipped_bigger_bounds[0],
+        ]
+    )
+    clipped_bigger_minus_smaller_dtype = Integer.that_can_represent(
+        [
+            clipped_bigger_bounds[0] - smaller_bounds[1],
+            clipped_bigger_bounds[1] - smaller_bounds[0],
+        ]
+    )
+
+    return min(
+        smaller_minus_clipped_bigger_dtype.bit_width,
+        clipped_bigger_minus_smaller_dtype.bit_width,
+    )
+
+
 class ParameterSelectionStrategy(str, Enum):
     """
     ParameterSelectionStrategy, to set optimization strategy.
@@ -246,6 +296,11 @@ class ComparisonStrategy(str, Enum):
     # - at most 13 TLUs
     # - it's complicated...
 
+    AUTO = "auto"
+    # -----------
+    # picks the strategy whose table lookups are the cheapest,
+    # counting the cost of the promotions on the other table lookups of the operands
+
     @classmethod
     def parse(cls, string: str) -> "ComparisonStrategy":
         """
@@ -493,6 +548,62 @@ class ComparisonStrategy(str, Enum):
 
         return required_x_bit_width, required_y_bit_width
 
+    def table_lookups(self, x: ValueDescription, y: ValueDescription) -> List[int]:
+        """
+        Get the bit-widths of the table lookups of the strategy, before promotions.
+
+        Args:
+            x (ValueDescription):
+                description of the lhs of the comparison
+
+            y (ValueDescription):
+                description of the rhs of the comparison
+
+        Returns:
+            List[int]:
+                bit-width of each table lookup of the strategy
+        """
+
+        assert isinstance(x.dtype, Integer)
+        assert isinstance(y.dtype, Integer)
+        assert self != ComparisonStrategy.AUTO
+
+        x_bit_width = x.dtype.bit_width
+        y_bit_width = y.dtype.bit_width
+        smaller_bit_width = min(x_bit_width, y_bit_width)
+        bigger_bit_width = max(x_bit_width, y_bit_width)
+
+        if self == ComparisonStrategy.CHUNKED:
+            return _chunked_table_lookups(x_bit_width, y_bit_width)
+
+        if self in {
+            ComparisonStrategy.THREE_TLU_BIGGER_CLIPPED_SMALLER_CASTED,
+            ComparisonStrategy.TWO_TLU_BIGGER_CLIPPED_SMALLER_PROMOTED,
+        }:
+            smaller, bigger = (x, y) if x_bit_width < y_bit_width else (y, x)
+            assert isinstance(smaller.dtype, Integer)
+            assert isinstance(bigger.dtype, Integer)
+
+            intermediate_bit_width = _clipped_subtraction_bit_width(smaller.dtype, bigger.dtype)
+            if self == ComparisonStrategy.THREE_TLU_BIGGER_CLIPPED_SMALLER_CASTED:
+                return [x_bit_width, y_bit_width, intermediate_bit_width]
+            return [bigger_bit_width, intermediate_bit_width]
+
+        subtraction_bit_width = Integer.that_can_represent(
+            [x.dtype.min() - y.dtype.max(), x.dtype.max() - y.dtype.min()]
+        ).bit_width
+
+        lookups = [subtraction_bit_width]
+        if self == ComparisonStrategy.THREE_TLU_CASTED:
+            lookups += [x_bit_width, y_bit_width]
+        elif smaller_bit_width != bigger_bit_width:
+            if self == ComparisonStrategy.TWO_TLU_BIGGER_PROMOTED_SMALLER_CASTED:
+                lookups.append(smaller_bit_width)
+            if self == ComparisonStrategy.TWO_TLU_BIGGER_CASTED_SMALLER_PROMOTED:
+                lookups.append(bigger_bit_width)
+
+        return lookups
+
 
 class BitwiseStrategy(str, Enum):
     """
@@ -563,6 +674,11 @@ class BitwiseStrategy(str, Enum):
     # - at most 9 TLUs
     # - it's complicated...
 
+    AUTO = "auto"
+    # -----------
+    # picks the strategy whose table lookups are the cheapest,
+    # counting the cost of the promotions on the other table lookups of the operands
+
     @classmethod
     def parse(cls, string: str) -> "BitwiseStrategy":
         """
@@ -691,6 +807,45 @@ class BitwiseStrategy(str, Enum):
 
         return required_x_bit_width, required_y_bit_width
 
+    def table_lookups(self, x: ValueDescription, y: ValueDescription) -> List[int]:
+        """
+        Get the bit-widths of the table lookups of the strategy, before promotions.
+
+        Args:
+            x (ValueDescription):
+                description of the lhs of the bitwise operation
+
+            y (ValueDescription):
+                description of the rhs of the bitwise operation
+
+        Returns:
+            List[int]:
+                bit-width of each table lookup of the strategy
+        """
+
+        assert isinstance(x.dtype, Integer)
+        assert isinstance(y.dtype, Integer)
+        assert self != BitwiseStrategy.AUTO
+
+        x_bit_width = x.dtype.bit_width
+        y_bit_width = y.dtype.bit_width
+        smaller_bit_width = min(x_bit_width, y_bit_width)
+        bigger_bit_width = max(x_bit_width, y_bit_width)
+
+        if self == BitwiseStrategy.CHUNKED:
+            return _chunked_table_lookups(x_bit_width, y_bit_width)
+
+        lookups = [x_bit_width + y_bit_width]
+        if self == BitwiseStrategy.THREE_TLU_CASTED:
+            lookups += [x_bit_width, y_bit_width]
+        elif smaller_bit_width != bigger_bit_width:
+            if self == BitwiseStrategy.TWO_TLU_BIGGER_PROMOTED_SMALLER_CASTED:
+                lookups.append(smaller_bit_width)
+            if self == BitwiseStrategy.TWO_TLU_BIGGER_CASTED_SMALLER_PROMOTED:
+                lookups.append(bigger_bit_width)
+
+        return lookups
+
 
 class MultivariateStrategy(str, Enum):
     """
@@ -847,6 +1002,11 @@ class MinMaxStrategy(str, Enum):
     # - at most 21 TLUs
     # - it's complicated...
 
+    AUTO = "auto"
+    # -----------
+    # picks the strategy whose table lookups are the cheapest,
+    # counting the cost of the promotions on the other table lookups of the operands
+
     @classmethod
     def parse(cls, string: str) -> "MinMaxStrategy":
         """
@@ -935,6 +1095,44 @@ class MinMaxStrategy(str, Enum):
 
         return x.dtype.bit_width, y.dtype.bit_width
 
+    def table_lookups(self, x: ValueDescription, y: ValueDescription) -> List[int]:
+        """
+        Get the bit-widths of the table lookups of the strategy, before promotions.
+
+        Args:
+            x (ValueDescription):
+                description of the lhs of the operation
+
+            y (ValueDescription):
+                description of the rhs of the operation
+
+        Returns:
+            List[int]:
+                bit-width of each table lookup of the strategy
+        """
+
+        assert isinstance(x.dtype, Integer)
+        assert isinstance(y.dtype, Integer)
+        assert self != MinMaxStrategy.AUTO
+
+        x_bit_width = x.dtype.bit_width
+        y_bit_width = y.dtype.bit_width
+
+        if self == MinMaxStrategy.CHUNKED:
+            # the selection multiplies both operands with the comparison, with two lookups each
+            selection_bit_width = max(x_bit_width, y_bit_width) + 1
+            return _chunked_table_lookups(x_bit_width, y_bit_width) + [selection_bit_width] * 4
+
+        subtraction_bit_width = Integer.that_can_represent(
+            [x.dtype.min() - y.dtype.max(), x.dtype.max() - y.dtype.min()]
+        ).bit_width
+
+        lookups = [subtraction_bit_width]
+        if self == MinMaxStrategy.THREE_TLU_CASTED:
+            lookups += [x_bit_width, y_bit_width]
+
+        return lookups
+
 
 class Configuration:
     """
@@ -957,6 +1155,7 @@ class Configuration:
     auto_parallelize: bool
     compress_evaluation_keys: bool
     compress_input_ciphertexts: bool
+    compress_output_ciphertexts: bool
     p_error: Optional[float]
     global_p_error: Optional[float]
     insecure_key_cache_location: Optional[str]
@@ -989,6 +1188,15 @@ class Configuration:
     optimize_tlu_based_on_measured_bounds: bool
     enable_tlu_fusing: bool
     print_tlu_fusing: bool
+    prediction_cost_table: Optional[str]
+    prediction_workers: int
+    optimizer_cost_table: Optional[str]
+    optimize_bit_width_assignment: bool
+    fuse_tlu_chains: bool
+    gpu_devices: Optional[List[int]]
+    gpu_memory_limit: Optional[int]
+    gpu_batch_size: Optional[int]
+    bounds_measurement_sample_size: Optional[int]
 
     def __init__(
         self,
@@ -1010,6 +1218,7 @@ class Configuration:
         auto_parallelize: bool = False,
         compress_evaluation_keys: bool = False,
         compress_input_ciphertexts: bool = False,
+        compress_output_ciphertexts: bool = False,
         p_error: Optional[float] = None,
         global_p_error: Optional[float] = None,
         auto_adjust_rounders: bool = False,
@@ -1053,6 +1262,15 @@ class Configuration:
         optimize_tlu_based_on_measured_bounds: bool = False,
         enable_tlu_fusing: bool = True,
         print_tlu_fusing: bool = False,
+        prediction_cost_table: Optional[Union[Path, str]] = None,
+        prediction_workers: int = 0,
+        optimizer_cost_table: Optional[Union[Path, str]] = None,
+        optimize_bit_width_assignment: bool = False,
+        fuse_tlu_chains: bool = False,
+        gpu_devices: Optional[List[int]] = None,
+        gpu_memory_limit: Optional[int] = None,
+        gpu_batch_size: Optional[int] = None,
+        bounds_measurement_sample_size: Optional[int] = None,
     ):
         self.verbose = verbose
         self.compiler_debug_mode = compiler_debug_mode
@@ -1077,6 +1295,7 @@ class Configuration:
         self.auto_parallelize = auto_parallelize
         self.compress_evaluation_keys = compress_evaluation_keys
         self.compress_input_ciphertexts = compress_input_ciphertexts
+        self.compress_output_ciphertexts = compress_output_ciphertexts
         self.p_error = p_error
         self.global_p_error = global_p_error
         self.auto_adjust_rounders = auto_adjust_rounders
@@ -1151,6 +1370,27 @@ class Configuration:
         self.enable_tlu_fusing = enable_tlu_fusing
         self.print_tlu_fusing = print_tlu_fusing
 
+        self.prediction_cost_table = (
+            str(prediction_cost_table)
+            if isinstance(prediction_cost_table, Path)
+            else prediction_cost_table
+        )
+        self.prediction_workers = prediction_workers
+        self.optimizer_cost_table = (
+            str(optimizer_cost_table)
+            if isinstance(optimizer_cost_table, Path)
+            else optimizer_cost_table
+        )
+
+        self.optimize_bit_width_assignment = optimize_bit_width_assignment
+        self.fuse_tlu_chains = fuse_tlu_chains
+
+        self.gpu_devices = gpu_devices
+        self.gpu_memory_limit = gpu_memory_limit
+        self.gpu_batch_size = gpu_batch_size
+
+        self.bounds_measurement_sample_size = bounds_measurement_sample_size
+
         self._validate()
 
     class Keep:
@@ -1179,6 +1419,7 @@ class Configuration:
         auto_parallelize: Union[Keep, bool] = KEEP,
         compress_evaluation_keys: Union[Keep, bool] = KEEP,
         compress_input_ciphertexts: Union[Keep, bool] = KEEP,
+        compress_output_ciphertexts: Union[Keep, bool] = KEEP,
         p_error: Union[Keep, Optional[float]] = KEEP,
         global_p_error: Union[Keep, Optional[float]] = KEEP,
         auto_adjust_rounders: Union[Keep, bool] = KEEP,
@@ -1218,6 +1459,15 @@ class Configuration:
         optimize_tlu_based_on_measured_bounds: Union[Keep, bool] = KEEP,
         enable_tlu_fusing: Union[Keep, bool] = KEEP,
         print_tlu_fusing: Union[Keep, bool] = KEEP,
+        prediction_cost_table: Union[Keep, Optional[Union[Path, str]]] = KEEP,
+        prediction_workers: Union[Keep, int] = KEEP,
+        optimizer_cost_table: Union[Keep, Optional[Union[Path, str]]] = KEEP,
+        optimize_bit_width_assignment: Union[Keep, bool] = KEEP,
+        fuse_tlu_chains: Union[Keep, bool] = KEEP,
+        gpu_devices: Union[Keep, Optional[List[int]]] = KEEP,
+        gpu_memory_limit: Union[Keep, Optional[int]] = KEEP,
+        gpu_batch_size: Union[Keep, Optional[int]] = KEEP,
+        bounds_measurement_sample_size: Union[Keep, Optional[int]] = KEEP,
     ) -> "Configuration":
         """
         Get a new configuration from another one specified changes.
@@ -1265,6 +1515,21 @@ class Configuration:
                     raise TypeError(message)
                 continue
 
+            if name == "gpu_devices":
+                attr = getattr(self, name)
+                if attr is not None and (
+                    not isinstance(attr, list)
+                    or not all(isinstance(device, int) for device in attr)
+                ):
+                    hint_type = friendly_type_format(hint)
+                    value_type = friendly_type_format(type(attr))
+                    message = (
+                        f"Unexpected type for keyword argument '{name}' "
+                        f"(expected '{hint_type}', got '{value_type}')"
+                    )
+                    raise TypeError(message)
+                continue
+
             original_hint = hint
             value = getattr(self, name)
             if str(hint).startswith("typing.Union") or str(hint).startswith("typing.Optional"):
@@ -1299,6 +1564,16 @@ class Configuration:
             message = "Composition can not be used with MONO parameter selection strategy"
             raise RuntimeError(message)
 
+        if self.gpu_devices is not None and any(device < 0 for device in self.gpu_devices):
+            message = "GPU devices cannot be negative"
+            raise RuntimeError(message)
+
+        for name in ["gpu_memory_limit", "gpu_batch_size", "bounds_measurement_sample_size"]:
+            value = getattr(self, name)
+            if value is not None and value <= 0:
+                message = f"'{name}' must be positive"
+                raise RuntimeError(message)
+
 
 def __check_fork_consistency():
     hints_init = get_type_hints(Configuration.__init__)
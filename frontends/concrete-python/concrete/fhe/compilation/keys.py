@@ -118,15 +118,14 @@ class Keys:
             message = f"Unable to load keys from {location} because it doesn't exist"
             raise ValueError(message)
 
-        keys = Keys.deserialize(bytes(location.read_bytes()))
+        # read in place rather than through bytes, as keys can be very large
+        keyset = KeySet.load(location)
 
         self.client_specs = None
         self.cache_directory = None
 
-        # pylint: disable=protected-access
         self._keyset_cache = None
-        self._keyset = keys._keyset
-        # pylint: enable=protected-access
+        self._keyset = keyset
 
     def load_if_exists_generate_and_save_otherwise(
         self,
@@ -5,15 +5,10 @@ Declaration of `FheModule` classes.
 # pylint: disable=import-error,no-member,no-name-in-module
 
 from pathlib import Path
-from typing import Any, Dict, List, NamedTuple, Optional, Tuple, Union
+from typing import Any, Callable, Dict, List, NamedTuple, Optional, Tuple, Union
 
 import numpy as np
-from concrete.compiler import (
-    CompilationContext,
-    Parameter,
-    SimulatedValueDecrypter,
-    SimulatedValueExporter,
-)
+from concrete.compiler import CompilationContext, Parameter
 from mlir.ir import Module as MlirModule
 
 from ..internal.utils import assert_that
@@ -124,14 +119,12 @@ class FheFunction:
             self.runtime.server.client_specs, *args, function_name=self.name
         )
 
-        exporter = SimulatedValueExporter.new(
-            self.runtime.server.client_specs.client_parameters, self.name
-        )
+        exporter = self.runtime.server.simulated_exporter(self.name)
         exported = [
             None
             if arg is None
             else Value(
-                exporter.export_tensor(position, arg.flatten().tolist(), list(arg.shape))
+                exporter.export_tensor(position, arg, list(arg.shape))
                 if isinstance(arg, np.ndarray) and arg.shape != ()
                 else exporter.export_scalar(position, int(arg))
             )
@@ -142,9 +135,7 @@ class FheFunction:
         if not isinstance(results, tuple):
             results = (results,)
 
-        decrypter = SimulatedValueDecrypter.new(
-            self.runtime.server.client_specs.client_parameters, self.name
-        )
+        decrypter = self.runtime.server.simulated_decrypter(self.name)
         decrypted = tuple(
             decrypter.decrypt(position, result.inner) for position, result in enumerate(results)
         )
@@ -235,6 +226,20 @@ class FheFunction:
         """
         return self.runtime.server.size_of_outputs(self.name)  # pragma: no cover
 
+    @property
+    def predicted_latency(self) -> Optional[float]:
+        """
+        Get the predicted seconds of a call of the function.
+        """
+        return self.runtime.server.predicted_latency(self.name)  # pragma: no cover
+
+    @property
+    def predicted_throughput(self) -> Optional[float]:
+        """
+        Get the predicted calls per second of the function.
+        """
+        return self.runtime.server.predicted_throughput(self.name)  # pragma: no cover
+
     # Programmable Bootstrap Statistics
 
     @property
@@ -479,6 +484,8 @@ class FheFunction:
         attributes = [
             "size_of_inputs",
             "size_of_outputs",
+            "predicted_latency",
+            "predicted_throughput",
             "programmable_bootstrap_count",
             "programmable_bootstrap_count_per_parameter",
             "programmable_bootstrap_count_per_tag",
@@ -609,6 +616,47 @@ class FheModule:
         """
         self.runtime.server.cleanup()
 
+    def run_graph(
+        self,
+        stages: List[Tuple[str, List[Union[int, Tuple[int, int]]]]],
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+        outputs: Optional[List[Union[int, Tuple[int, int]]]] = None,
+        max_threads: int = 0,
+        on_output: Optional[Callable[[int, Value], None]] = None,
+    ) -> Union[Value, Tuple[Value, ...]]:
+        """
+        Evaluate a chain of functions of the module, see `Server.run_graph`.
+
+        Args:
+            stages (List[Tuple[str, List[Union[int, Tuple[int, int]]]]]):
+                name of the function and sources of the arguments of each stage
+
+            *args (Optional[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) of the graph
+
+            outputs (Optional[List[Union[int, Tuple[int, int]]]], default = None):
+                sources of the results of the graph, all the results of the last stage if None
+
+            max_threads (int, default = 0):
+                maximum number of threads to use, all the hardware threads if 0
+
+            on_output (Optional[Callable[[int, Value], None]], default = None):
+                called with the index and the value of each output once it is computed
+
+        Returns:
+            Union[Value, Tuple[Value, ...]]:
+                result(s) of the graph
+        """
+        assert isinstance(self.runtime, ExecutionRt)
+        return self.runtime.server.run_graph(
+            stages,
+            *args,
+            outputs=outputs,
+            evaluation_keys=self.runtime.client.evaluation_keys,
+            max_threads=max_threads,
+            on_output=on_output,
+        )
+
     @property
     def size_of_secret_keys(self) -> int:
         """
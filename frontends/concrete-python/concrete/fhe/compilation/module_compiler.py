@@ -5,7 +5,9 @@ Declaration of `MultiCompiler` class.
 # pylint: disable=import-error,no-name-in-module
 
 import inspect
+import os
 import traceback
+from concurrent.futures import ThreadPoolExecutor
 from copy import deepcopy
 from pathlib import Path
 from typing import Any, Callable, Dict, Iterable, List, Optional, Tuple, Union
@@ -15,14 +17,14 @@ from concrete.compiler import CompilationContext
 
 from ..extensions import AutoRounder, AutoTruncator
 from ..mlir import GraphConverter
-from ..representation import Graph
+from ..representation import Graph, Node
 from ..tracing import Tracer
 from ..values import ValueDescription
 from .artifacts import FunctionDebugArtifacts, ModuleDebugArtifacts
 from .compiler import EncryptionStatus
 from .configuration import Configuration
 from .module import ExecutionRt, FheModule
-from .utils import fuse, get_terminal_size
+from .utils import fuse, fuse_table_lookup_chains, get_terminal_size, sample_inputset
 
 DEFAULT_OUTPUT_DIRECTORY: Path = Path(".artifacts")
 
@@ -134,15 +136,15 @@ class FunctionDef:
 
         fuse(self.graph, self.artifacts)
 
-    def evaluate(
+    def prepare(
         self,
         action: str,
         inputset: Optional[Union[Iterable[Any], Iterable[Tuple[Any, ...]]]],
         configuration: Configuration,
         artifacts: FunctionDebugArtifacts,
-    ):
+    ) -> bool:
         """
-        Trace, fuse, measure bounds, and update values in the resulting graph in one go.
+        Trace and fuse the function, leaving the bounds measurement to the caller.
 
         Args:
             action (str):
@@ -156,6 +158,10 @@ class FunctionDef:
 
             artifacts (FunctionDebugArtifacts):
                 artifact object to store informations in
+
+        Returns:
+            bool:
+                whether the bounds of the graph need to be measured on the inputset
         """
 
         if self._is_direct:
@@ -165,7 +171,7 @@ class FunctionDef:
             artifacts.add_graph("initial", self.graph)  # pragma: no cover
             fuse(self.graph, artifacts)
             artifacts.add_graph("final", self.graph)  # pragma: no cover
-            return
+            return False
 
         if inputset is not None:
             previous_inputset_length = len(self.inputset)
@@ -212,7 +218,28 @@ class FunctionDef:
             self.trace(first_sample)
             assert self.graph is not None
 
-        bounds = self.graph.measure_bounds(self.inputset)
+        if configuration.fuse_tlu_chains:
+            fuse_table_lookup_chains(self.graph, artifacts)
+
+        return True
+
+    def update_with_bounds(
+        self,
+        bounds: Dict[Node, Dict[str, Any]],
+        artifacts: FunctionDebugArtifacts,
+    ):
+        """
+        Update the values of the graph with measured bounds.
+
+        Args:
+            bounds (Dict[Node, Dict[str, Any]]):
+                bounds of the nodes of the graph, as returned by `Graph.measure_bounds`
+
+            artifacts (FunctionDebugArtifacts):
+                artifact object to store informations in
+        """
+
+        assert self.graph is not None
         self.graph.update_with_bounds(bounds)
 
         artifacts.add_graph("final", self.graph)
@@ -509,10 +536,23 @@ class ModuleCompiler:
 
         try:
             # Trace and fuse the functions
+            # (tracing relies on global state, so it stays sequential)
+            to_measure = []
             for name, function in self.functions.items():
                 inputset = inputsets[name] if inputsets is not None else None
                 function_artifacts = module_artifacts.functions[name]
-                function.evaluate("Compiling", inputset, self.configuration, function_artifacts)
+                if function.prepare("Compiling", inputset, self.configuration, function_artifacts):
+                    to_measure.append(name)
+
+            # Measure the bounds of the functions concurrently
+            # (numpy releases the gil when evaluating batches of samples)
+            bounds = self._measure_bounds(
+                to_measure, configuration.bounds_measurement_sample_size
+            )
+
+            for name, function in self.functions.items():
+                if name in bounds:
+                    function.update_with_bounds(bounds[name], module_artifacts.functions[name])
                 assert function.graph is not None
                 dbg.debug_computation_graph(name, function.graph)
 
@@ -564,6 +604,43 @@ class ModuleCompiler:
 
     # pylint: enable=too-many-branches,too-many-statements
 
+    def _measure_bounds(
+        self,
+        names: List[str],
+        sample_size: Optional[int] = None,
+    ) -> Dict[str, Dict[Node, Dict[str, Any]]]:
+        """
+        Measure the bounds of the traced functions on their inputsets, in parallel.
+
+        Args:
+            names (List[str]):
+                names of the functions to measure
+
+            sample_size (Optional[int], default = None):
+                number of samples of each inputset to measure on, see `sample_inputset`,
+                all of them if None
+
+        Returns:
+            Dict[str, Dict[Node, Dict[str, Any]]]:
+                bounds of the nodes of each function
+        """
+
+        def measure(name: str) -> Dict[Node, Dict[str, Any]]:
+            function = self.functions[name]
+            assert function.graph is not None
+            inputset = function.inputset
+            if sample_size is not None:
+                inputset = sample_inputset(inputset, sample_size)
+            return function.graph.measure_bounds(inputset)
+
+        if len(names) <= 1:
+            return {name: measure(name) for name in names}
+
+        with ThreadPoolExecutor(max_workers=min(len(names), os.cpu_count() or 1)) as executor:
+            futures = {name: executor.submit(measure, name) for name in names}
+            # errors are raised in the order of the functions, as in a sequential measurement
+            return {name: future.result() for name, future in futures.items()}
+
     def __getattr__(self, item):
         if item not in list(self.functions.keys()):
             error = f"No attribute {item}"
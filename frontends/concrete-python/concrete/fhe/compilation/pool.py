@@ -0,0 +1,397 @@
+"""
+Declaration of `ServerPool` class.
+"""
+
+# pylint: disable=import-error,no-name-in-module
+
+import multiprocessing
+import os
+import queue
+import shutil
+import tempfile
+import threading
+from concurrent.futures import Future
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Set, Tuple, Union
+
+from concrete.compiler import EvaluationKeys
+
+from .server import Server
+from .value import Value
+
+# pylint: enable=import-error,no-name-in-module
+
+
+def _serve(
+    server_path: str,
+    evaluation_keys_path: str,
+    prepared_keyset_path: str,
+    cpus: Optional[Set[int]],
+    tasks: Any,
+    results: Any,
+):
+    """
+    Evaluate the tasks of a pool, in a worker process.
+
+    The worker first sends its readiness, or why it can't start, as a result without identifier.
+    Each task is then an identifier, a function name and the serialized arguments, whose result
+    is the identifier, an error message if the evaluation failed, and the serialized results.
+    """
+
+    # the threads of the runtime are started on the first evaluation, and inherit the cpus
+    if cpus is not None and hasattr(os, "sched_setaffinity"):
+        os.sched_setaffinity(0, cpus)
+
+    try:
+        server = Server.load(server_path)
+        evaluation_keys = EvaluationKeys.load(evaluation_keys_path, prepared_keyset_path)
+        server.warm_up(evaluation_keys)
+    except Exception as error:  # pylint: disable=broad-except
+        results.put((None, str(error), None))
+        return
+    results.put((None, None, None))
+
+    while True:
+        task = tasks.get()
+        if task is None:
+            return
+
+        identifier, function_name, serialized_args = task
+        try:
+            args = [Value.deserialize(arg) for arg in serialized_args]
+            result = server.run(*args, evaluation_keys=evaluation_keys, function_name=function_name)
+            if isinstance(result, tuple):
+                serialized_result: Any = tuple(value.serialize() for value in result)
+            else:
+                serialized_result = result.serialize()
+        except Exception as error:  # pylint: disable=broad-except
+            results.put((identifier, str(error), None))
+            continue
+        results.put((identifier, None, serialized_result))
+
+
+class ServerPool:
+    """
+    ServerPool class, which evaluates the requests of a client in a pool of worker processes.
+
+    Each worker loads the server and the evaluation keys, and evaluates the requests it takes
+    from a queue shared by the pool, one at a time. The workers map the same prepared keyset,
+    so the keys in the fourier domain are held once in memory for the whole pool. Unlike the
+    threads of a single process, the workers don't contend on the allocator, and each of them,
+    being pinned to its own cpus, allocates its memory on the node of its cpus.
+
+    The workers are started with the spawn method, the parent process possibly running threads.
+    """
+
+    server_path: str
+    evaluation_keys_path: str
+    prepared_keyset_path: str
+    processes: int
+
+    _temporary_directory: Optional[str]
+    _tasks: Any
+    _results: Any
+    _workers: List[Any]
+    _pending: Dict[int, Future]
+    _next_identifier: int
+    _lock: threading.Lock
+    _collector: Optional[threading.Thread]
+    _closed: bool
+
+    def __init__(
+        self,
+        server_path: Union[str, Path],
+        evaluation_keys_path: Union[str, Path],
+        prepared_keyset_path: Optional[Union[str, Path]] = None,
+        processes: Optional[int] = None,
+        pin: bool = True,
+    ):
+        """
+        Args:
+            server_path (Union[str, Path]):
+                path of the server, as saved by `Server.save`
+
+            evaluation_keys_path (Union[str, Path]):
+                path of the serialized evaluation keys of the client
+
+            prepared_keyset_path (Optional[Union[str, Path]], default = None):
+                path of the prepared keyset shared by the workers, written if missing,
+                a temporary file removed on close if None
+
+            processes (Optional[int], default = None):
+                number of worker processes, one per available cpu if None
+
+            pin (bool, default = True):
+                whether to pin each worker to its share of the available cpus, and to limit the
+                threads of its runtime to that share
+        """
+
+        cpus = sorted(os.sched_getaffinity(0)) if hasattr(os, "sched_getaffinity") else None
+        available = len(cpus) if cpus is not None else (os.cpu_count() or 1)
+
+        self.server_path = str(server_path)
+        self.evaluation_keys_path = str(evaluation_keys_path)
+        self.processes = processes if processes is not None else available
+        if self.processes < 1:
+            message = f"Expected at least one process but got {self.processes}"
+            raise ValueError(message)
+
+        self._temporary_directory = None
+        if prepared_keyset_path is None:
+            self._temporary_directory = tempfile.mkdtemp()
+            prepared_keyset_path = Path(self._temporary_directory) / "prepared_keyset"
+        self.prepared_keyset_path = str(prepared_keyset_path)
+
+        context = multiprocessing.get_context("spawn")
+        self._tasks = context.Queue()
+        self._results = context.Queue()
+        self._workers = []
+        self._pending = {}
+        self._next_identifier = 0
+        self._lock = threading.Lock()
+        self._collector = None
+        self._closed = False
+
+        shares: List[Optional[Set[int]]] = [None] * self.processes
+        if pin and cpus is not None and len(cpus) >= self.processes:
+            # contiguous cpus, which usually are the cores of the same socket
+            size, remainder = divmod(len(cpus), self.processes)
+            start = 0
+            for i in range(self.processes):
+                end = start + size + (1 if i < remainder else 0)
+                shares[i] = set(cpus[start:end])
+                start = end
+
+        try:
+            # a single worker writes the prepared keyset, with the others only mapping it
+            first = 1 if not Path(self.prepared_keyset_path).exists() else self.processes
+            self._start(context, shares[:first])
+            self._start(context, shares[first:])
+        except Exception:
+            self.close()
+            raise
+
+        self._collector = threading.Thread(target=self._collect, daemon=True)
+        self._collector.start()
+
+    def _start(self, context: Any, shares: List[Optional[Set[int]]]):
+        """
+        Start a worker per share of cpus, and wait for them to be ready.
+        """
+
+        omp_num_threads = os.environ.get("OMP_NUM_THREADS")
+        try:
+            for share in shares:
+                # the runtime reads its number of threads when the worker loads it
+                if share is not None:
+                    os.environ["OMP_NUM_THREADS"] = str(len(share))
+                worker = context.Process(
+                    target=_serve,
+                    args=(
+                        self.server_path,
+                        self.evaluation_keys_path,
+                        self.prepared_keyset_path,
+                        share,
+                        self._tasks,
+                        self._results,
+                    ),
+                    daemon=True,
+                )
+                worker.start()
+                self._workers.append(worker)
+        finally:
+            if omp_num_threads is None:
+                os.environ.pop("OMP_NUM_THREADS", None)
+            else:
+                os.environ["OMP_NUM_THREADS"] = omp_num_threads
+
+        for _ in shares:
+            _, error, _ = self._results.get()
+            if error is not None:
+                message = f"A worker of the pool failed to start: {error}"
+                raise RuntimeError(message)
+
+    def _collect(self):
+        """
+        Complete the futures of the results sent by the workers, until the pool is closed.
+        """
+
+        while True:
+            try:
+                identifier, error, serialized_result = self._results.get(timeout=1)
+            except queue.Empty:
+                with self._lock:
+                    if self._closed:
+                        return
+                    crashed = any(not worker.is_alive() for worker in self._workers)
+                    if not crashed:
+                        continue
+                    # the task of the crashed worker is lost, and the pool can't be used anymore
+                    self._closed = True
+                    pending = list(self._pending.values())
+                    self._pending.clear()
+                for future in pending:
+                    future.set_exception(RuntimeError("A worker of the pool exited unexpectedly"))
+                return
+            except (EOFError, OSError):
+                return
+
+            if identifier is None:
+                continue
+            with self._lock:
+                future = self._pending.pop(identifier, None)
+            if future is None:
+                continue
+
+            if error is not None:
+                future.set_exception(RuntimeError(error))
+            elif isinstance(serialized_result, tuple):
+                future.set_result(tuple(Value.deserialize(value) for value in serialized_result))
+            else:
+                future.set_result(Value.deserialize(serialized_result))
+
+    def submit(
+        self,
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+        function_name: str = "main",
+    ) -> Future:
+        """
+        Queue an evaluation, for the next available worker.
+
+        Args:
+            *args (Optional[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) for evaluation
+
+            function_name (str):
+                The name of the function to run
+
+        Returns:
+            Future:
+                future of the result(s) of evaluation, which `asyncio.wrap_future` can await
+        """
+
+        return self._submit(self._serialize(*args), function_name)
+
+    @staticmethod
+    def _serialize(*args: Optional[Union[Value, Tuple[Optional[Value], ...]]]) -> List[bytes]:
+        """
+        Serialize the arguments of an evaluation, flattened.
+        """
+
+        flattened_args: List[Optional[Value]] = []
+        for arg in args:
+            if isinstance(arg, tuple):
+                flattened_args.extend(arg)
+            else:
+                flattened_args.append(arg)
+
+        serialized_args = []
+        for i, arg in enumerate(flattened_args):
+            if not isinstance(arg, Value):
+                message = f"Expected argument {i} to be an fhe.Value but it's {type(arg).__name__}"
+                raise ValueError(message)
+            serialized_args.append(arg.serialize())
+        return serialized_args
+
+    def _submit(self, serialized_args: List[bytes], function_name: str) -> Future:
+        """
+        Queue an evaluation of serialized arguments.
+        """
+
+        future: Future = Future()
+        with self._lock:
+            if self._closed:
+                message = "Expected the pool not to be closed"
+                raise RuntimeError(message)
+            identifier = self._next_identifier
+            self._next_identifier += 1
+            self._pending[identifier] = future
+            self._tasks.put((identifier, function_name, serialized_args))
+        return future
+
+    def run(
+        self,
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+        function_name: str = "main",
+    ) -> Union[Value, Tuple[Value, ...]]:
+        """
+        Evaluate, in the next available worker.
+
+        Args:
+            *args (Optional[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) for evaluation
+
+            function_name (str):
+                The name of the function to run
+
+        Returns:
+            Union[Value, Tuple[Value, ...]]:
+                result(s) of evaluation
+        """
+
+        return self.submit(*args, function_name=function_name).result()
+
+    def run_batch(
+        self,
+        batch: List[Union[Value, Tuple[Optional[Value], ...]]],
+        function_name: str = "main",
+    ) -> List[Union[Value, Tuple[Value, ...]]]:
+        """
+        Evaluate a batch of independent samples, spread over the workers.
+
+        The samples with the largest encrypted arguments are queued first, so that the workers
+        taking the smaller ones last finish close to each other.
+
+        Args:
+            batch (List[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) of each sample, as returned by `Client.encrypt_batch`
+
+            function_name (str):
+                The name of the function to run
+
+        Returns:
+            List[Union[Value, Tuple[Value, ...]]]:
+                result(s) of evaluation of each sample, in the order of the batch
+        """
+
+        samples = [self._serialize(args) for args in batch]
+        sizes = [sum(len(arg) for arg in sample) for sample in samples]
+        order = sorted(range(len(samples)), key=lambda i: sizes[i], reverse=True)
+
+        futures: List[Optional[Future]] = [None] * len(samples)
+        for i in order:
+            futures[i] = self._submit(samples[i], function_name)
+        return [future.result() for future in futures if future is not None]
+
+    def close(self):
+        """
+        Stop the workers once they evaluated the queued requests, and remove the temporary files.
+        """
+
+        with self._lock:
+            already_closed = self._closed
+            self._closed = True
+
+        if not already_closed:
+            for _ in self._workers:
+                self._tasks.put(None)
+        for worker in self._workers:
+            worker.join()
+        if self._collector is not None:
+            self._collector.join()
+
+        with self._lock:
+            pending = list(self._pending.values())
+            self._pending.clear()
+        for future in pending:
+            future.set_exception(RuntimeError("The pool was closed before the evaluation"))
+
+        if self._temporary_directory is not None:
+            shutil.rmtree(self._temporary_directory, ignore_errors=True)
+            self._temporary_directory = None
+
+    def __enter__(self) -> "ServerPool":
+        return self
+
+    def __exit__(self, *_args):
+        self.close()
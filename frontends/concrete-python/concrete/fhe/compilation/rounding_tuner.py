@@ -0,0 +1,255 @@
+"""
+Declaration of `RoundingTuner` class.
+"""
+
+from dataclasses import dataclass
+from typing import Any, Callable, Dict, Iterable, List, Optional, Tuple, Union
+
+import numpy as np
+
+from ..extensions import AutoRounder
+from .compiler import Compiler, EncryptionStatus
+from .configuration import Configuration, Exactness
+
+
+@dataclass
+class RoundingTrial:
+    """
+    RoundingTrial class, to describe a rounding setting and its measured cost and error.
+    """
+
+    lsbs_to_remove: Tuple[int, ...]
+    exactness: Tuple[Exactness, ...]
+    complexity: float
+    programmable_bootstrap_count: int
+    error: float
+
+
+@dataclass
+class RoundingReport:
+    """
+    RoundingReport class, to summarize the rounding settings tried by a `RoundingTuner`.
+    """
+
+    rounders: List[AutoRounder]
+    trials: List[RoundingTrial]
+    max_error: float
+
+    @property
+    def pareto(self) -> List[RoundingTrial]:
+        """
+        Get the trials that no other trial beats on both complexity and error, cheapest first.
+        """
+
+        result: List[RoundingTrial] = []
+        for trial in sorted(self.trials, key=lambda trial: (trial.complexity, trial.error)):
+            if len(result) == 0 or trial.error < result[-1].error:
+                result.append(trial)
+        return result
+
+    @property
+    def recommended(self) -> Optional[RoundingTrial]:
+        """
+        Get the cheapest trial within the error target, if any.
+        """
+
+        accurate = [trial for trial in self.trials if trial.error <= self.max_error]
+        return min(accurate, key=lambda trial: trial.complexity, default=None)
+
+    def apply(self, trial: Optional[RoundingTrial] = None):
+        """
+        Set the rounders to a trial, the recommended one by default.
+        """
+
+        trial = trial if trial is not None else self.recommended
+        if trial is None:
+            message = f"No rounding setting reaches an error of {self.max_error}"
+            raise ValueError(message)
+
+        for rounder, lsbs_to_remove, exactness in zip(
+            self.rounders, trial.lsbs_to_remove, trial.exactness
+        ):
+            rounder.lsbs_to_remove = lsbs_to_remove
+            rounder.exactness = exactness
+            rounder.is_adjusted = True
+
+    def format(self) -> str:
+        """
+        Get a textual representation of the pareto front, the recommended trial being marked.
+        """
+
+        recommended = self.recommended
+        lines = ["complexity      pbs  error         lsbs_to_remove / exactness"]
+        for trial in self.pareto:
+            settings = ", ".join(
+                f"{lsbs_to_remove}{'~' if exactness == Exactness.APPROXIMATE else ''}"
+                for lsbs_to_remove, exactness in zip(trial.lsbs_to_remove, trial.exactness)
+            )
+            marker = " <- recommended" if trial is recommended else ""
+            lines.append(
+                f"{trial.complexity:<15.6g} {trial.programmable_bootstrap_count:<4} "
+                f"{trial.error:<13.6g} [{settings}]{marker}"
+            )
+        return "\n".join(lines)
+
+
+class RoundingTuner:
+    """
+    RoundingTuner class, to search the rounding settings of a function for an error target.
+
+    The rounders are the `AutoRounder`s used by the function. Each trial compiles the function
+    with a setting of their `lsbs_to_remove` and `exactness`, and measures its complexity and the
+    error of its simulation on the inputset, against the function without rounding.
+
+    The search is greedy: from the exact setting, each step tries to remove one more bit of a
+    rounder, or to make it approximate, and continues from the cheapest trial within the error
+    target, even if it is not cheaper than the current one, as removing a single bit may not
+    lower the precision of the table lookups. It stops when no step is within the error target.
+    """
+
+    function: Callable
+    parameter_encryption_statuses: Dict[str, Union[str, EncryptionStatus]]
+    rounders: List[AutoRounder]
+    inputset: List[Tuple[Any, ...]]
+    max_error: float
+    error: Callable[[np.ndarray, np.ndarray], float]
+    configuration: Configuration
+
+    _trials: Dict[Tuple[Tuple[int, ...], Tuple[Exactness, ...]], RoundingTrial]
+
+    def __init__(
+        self,
+        function: Callable,
+        parameter_encryption_statuses: Dict[str, Union[str, EncryptionStatus]],
+        rounders: List[AutoRounder],
+        inputset: Union[Iterable[Any], Iterable[Tuple[Any, ...]]],
+        max_error: float,
+        error: Optional[Callable[[np.ndarray, np.ndarray], float]] = None,
+        configuration: Optional[Configuration] = None,
+    ):
+        """
+        Args:
+            function (Callable):
+                function to tune the rounding of
+
+            parameter_encryption_statuses (Dict[str, Union[str, EncryptionStatus]]):
+                encryption statuses of the parameters of the function
+
+            rounders (List[AutoRounder]):
+                rounders used by the function, whose settings are searched
+
+            inputset (Union[Iterable[Any], Iterable[Tuple[Any, ...]]]):
+                inputset to compile and measure the error with
+
+            max_error (float):
+                error target of the recommended setting
+
+            error (Optional[Callable[[np.ndarray, np.ndarray], float]], default = None):
+                error of the flattened simulated outputs against the flattened exact outputs
+                of the inputset, the mean absolute error if None
+
+            configuration (Optional[Configuration], default = None):
+                configuration to compile with, simulation being enabled for the trials
+        """
+
+        self.function = function
+        self.parameter_encryption_statuses = parameter_encryption_statuses
+        self.rounders = rounders
+        self.inputset = [sample if isinstance(sample, tuple) else (sample,) for sample in inputset]
+        self.max_error = max_error
+        self.error = error if error is not None else lambda x, y: float(np.mean(np.abs(x - y)))
+        self.configuration = (configuration or Configuration()).fork(
+            fhe_simulation=True,
+            fhe_execution=False,
+        )
+
+        self._trials = {}
+
+    def tune(self) -> RoundingReport:
+        """
+        Search the rounding settings.
+
+        Returns:
+            RoundingReport:
+                trials of the search
+        """
+
+        if not all(rounder.is_adjusted for rounder in self.rounders):
+            AutoRounder.adjust(self.function, self.inputset)
+
+        count = len(self.rounders)
+        lsbs_to_remove = (0,) * count
+        exactness = (Exactness.EXACT,) * count
+
+        expected = self._outputs(lambda sample: self._evaluate(lsbs_to_remove, exactness, sample))
+        current = self._trial(lsbs_to_remove, exactness, expected)
+
+        while True:
+            candidates = []
+            for i, rounder in enumerate(self.rounders):
+                if current.lsbs_to_remove[i] < rounder.input_bit_width - 1:
+                    more_lsbs = list(current.lsbs_to_remove)
+                    more_lsbs[i] += 1
+                    candidates.append((tuple(more_lsbs), current.exactness))
+                if current.lsbs_to_remove[i] != 0 and current.exactness[i] == Exactness.EXACT:
+                    approximate = list(current.exactness)
+                    approximate[i] = Exactness.APPROXIMATE
+                    candidates.append((current.lsbs_to_remove, tuple(approximate)))
+
+            trials = [self._trial(*candidate, expected) for candidate in candidates]
+            accurate = [trial for trial in trials if trial.error <= self.max_error]
+            best = min(accurate, key=lambda trial: trial.complexity, default=None)
+            if best is None:
+                break
+            current = best
+
+        return RoundingReport(self.rounders, list(self._trials.values()), self.max_error)
+
+    def _set(self, lsbs_to_remove: Tuple[int, ...], exactness: Tuple[Exactness, ...]):
+        for rounder, lsbs, exact in zip(self.rounders, lsbs_to_remove, exactness):
+            rounder.lsbs_to_remove = lsbs
+            rounder.exactness = exact
+            rounder.is_adjusted = True
+
+    def _evaluate(
+        self,
+        lsbs_to_remove: Tuple[int, ...],
+        exactness: Tuple[Exactness, ...],
+        sample: Tuple[Any, ...],
+    ) -> Any:
+        self._set(lsbs_to_remove, exactness)
+        return self.function(*sample)
+
+    def _outputs(self, evaluate: Callable[[Tuple[Any, ...]], Any]) -> np.ndarray:
+        flattened = []
+        for sample in self.inputset:
+            result = evaluate(sample)
+            results = result if isinstance(result, tuple) else (result,)
+            flattened += [np.array(value, dtype=np.int64).ravel() for value in results]
+        return np.concatenate(flattened)
+
+    def _trial(
+        self,
+        lsbs_to_remove: Tuple[int, ...],
+        exactness: Tuple[Exactness, ...],
+        expected: np.ndarray,
+    ) -> RoundingTrial:
+        key = (lsbs_to_remove, exactness)
+        if key in self._trials:
+            return self._trials[key]
+
+        self._set(lsbs_to_remove, exactness)
+        compiler = Compiler(self.function, self.parameter_encryption_statuses)
+        circuit = compiler.compile(self.inputset, self.configuration)
+        actual = self._outputs(lambda sample: circuit.simulate(*sample))
+
+        trial = RoundingTrial(
+            lsbs_to_remove=lsbs_to_remove,
+            exactness=exactness,
+            complexity=circuit.complexity,
+            programmable_bootstrap_count=circuit.programmable_bootstrap_count,
+            error=self.error(expected, actual),
+        )
+        circuit.cleanup()
+        self._trials[key] = trial
+        return trial
@@ -4,10 +4,15 @@ Declaration of `Server` class.
 
 # pylint: disable=import-error,no-member,no-name-in-module
 
+import asyncio
+import json
+import platform
 import shutil
+import subprocess
 import tempfile
+import zipfile
 from pathlib import Path
-from typing import Dict, List, Optional, Tuple, Union
+from typing import Callable, Dict, List, Optional, Tuple, Union
 
 # mypy: disable-error-code=attr-defined
 import concrete.compiler
@@ -21,7 +26,11 @@ from concrete.compiler import (
     Parameter,
     ProgramCompilationFeedback,
     PublicArguments,
+    PublicResult,
+    ServerCircuit,
     ServerProgram,
+    SimulatedValueDecrypter,
+    SimulatedValueExporter,
     set_compiler_logging,
     set_llvm_debug_flag,
 )
@@ -60,7 +69,10 @@ class Server:
     _support: LibrarySupport
     _compilation_result: LibraryCompilationResult
     _compilation_feedback: ProgramCompilationFeedback
-    _server_program: ServerProgram
+    _server_program: Optional[ServerProgram]
+    _simulated_exporters: Dict[str, SimulatedValueExporter]
+    _simulated_decrypters: Dict[str, SimulatedValueDecrypter]
+    _device_settings: Optional[Tuple[List[int], int, int]]
 
     _mlir: Optional[str]
     _configuration: Optional[Configuration]
@@ -71,7 +83,7 @@ class Server:
         output_dir: Optional[tempfile.TemporaryDirectory],
         support: LibrarySupport,
         compilation_result: LibraryCompilationResult,
-        server_program: ServerProgram,
+        server_program: Optional[ServerProgram],
         is_simulated: bool,
     ):
         self.client_specs = client_specs
@@ -82,6 +94,9 @@ class Server:
         self._compilation_result = compilation_result
         self._compilation_feedback = self._support.load_compilation_feedback(compilation_result)
         self._server_program = server_program
+        self._simulated_exporters = {}
+        self._simulated_decrypters = {}
+        self._device_settings = None
         self._mlir = None
 
         assert_that(
@@ -123,6 +138,7 @@ class Server:
         options.set_auto_parallelize(configuration.auto_parallelize)
         options.set_compress_evaluation_keys(configuration.compress_evaluation_keys)
         options.set_compress_input_ciphertexts(configuration.compress_input_ciphertexts)
+        options.set_compress_output_ciphertexts(configuration.compress_output_ciphertexts)
         options.set_composable(configuration.composable)
 
         if configuration.auto_parallelize or configuration.dataflow_parallelize:
@@ -182,6 +198,11 @@ class Server:
 
         options.set_enable_tlu_fusing(configuration.enable_tlu_fusing)
         options.set_print_tlu_fusing(configuration.print_tlu_fusing)
+        if configuration.prediction_cost_table is not None:
+            options.set_prediction_cost_table(configuration.prediction_cost_table)
+        if configuration.optimizer_cost_table is not None:
+            options.set_optimizer_cost_table(configuration.optimizer_cost_table)
+            options.set_prediction_workers(configuration.prediction_workers)
 
         try:
             if configuration.compiler_debug_mode:  # pragma: no cover
@@ -226,9 +247,27 @@ class Server:
         result._configuration = configuration
         # pylint: enable=protected-access
 
+        if configuration.use_gpu and (
+            configuration.gpu_devices is not None
+            or configuration.gpu_memory_limit is not None
+            or configuration.gpu_batch_size is not None
+        ):
+            result.set_device_settings(
+                configuration.gpu_devices,
+                configuration.gpu_memory_limit,
+                configuration.gpu_batch_size,
+            )
+
         return result
 
-    def save(self, path: Union[str, Path], via_mlir: bool = False):
+    def save(
+        self,
+        path: Union[str, Path],
+        via_mlir: bool = False,
+        unpacked: bool = False,
+        compact: bool = False,
+        functions: Optional[List[str]] = None,
+    ):
         """
         Save the server into the given path in zip format.
 
@@ -239,10 +278,25 @@ class Server:
             via_mlir (bool, default = False):
                 export using the MLIR code of the program,
                 this will make the export cross-platform
+
+            unpacked (bool, default = False):
+                save the server as a directory instead of a zip archive,
+                which `load` uses in place, without extracting it
+
+            compact (bool, default = False):
+                strip the symbols the library does not export from the saved library (with the
+                `strip` tool of the system), and compress the archive as much as possible,
+                which does not slow down its extraction
+
+            functions (Optional[List[str]], default = None):
+                functions the saved server exposes, all of them if None,
+                the other ones are not loaded by the server
+
+            `compact` and `functions` are ignored when saving via MLIR.
         """
 
         path = str(path)
-        if path.endswith(".zip"):
+        if path.endswith(".zip") and not unpacked:
             path = path[: len(path) - 4]
 
         if via_mlir:
@@ -260,7 +314,10 @@ class Server:
                 with open(Path(tmp) / "configuration.json", "w", encoding="utf-8") as f:
                     f.write(jsonpickle.dumps(self._configuration.__dict__))
 
-                shutil.make_archive(path, "zip", tmp)
+                if unpacked:
+                    shutil.copytree(tmp, path, dirs_exist_ok=True)
+                else:
+                    shutil.make_archive(path, "zip", tmp)
 
             return
 
@@ -274,12 +331,89 @@ class Server:
         with open(Path(self._output_dir.name) / "is_simulated", "w", encoding="utf-8") as f:
             f.write("1" if self.is_simulated else "0")
 
-        shutil.make_archive(path, "zip", self._output_dir.name)
+        if not compact and functions is None:
+            if unpacked:
+                shutil.copytree(self._output_dir.name, path, dirs_exist_ok=True)
+            else:
+                shutil.make_archive(path, "zip", self._output_dir.name)
+            return
+
+        with tempfile.TemporaryDirectory() as tmp:
+            shutil.copytree(self._output_dir.name, tmp, dirs_exist_ok=True)
+
+            if functions is not None:
+                Server._keep_functions(Path(tmp), functions)
+            if compact:
+                for library in Path(tmp).glob("sharedlib.*"):
+                    Server._strip_library(library)
+
+            if unpacked:
+                shutil.copytree(tmp, path, dirs_exist_ok=True)
+            elif compact:
+                with zipfile.ZipFile(
+                    f"{path}.zip", "w", zipfile.ZIP_DEFLATED, compresslevel=9
+                ) as archive:
+                    for file in sorted(Path(tmp).rglob("*")):
+                        archive.write(file, file.relative_to(tmp))
+            else:
+                shutil.make_archive(path, "zip", tmp)
+
+    @staticmethod
+    def _keep_functions(directory: Path, functions: List[str]):
+        """
+        Remove the functions not in `functions` from the program of a saved server.
+        """
+
+        with open(directory / "client.specs.json", "r", encoding="utf-8") as f:
+            program_info = json.load(f)
+
+        names = [circuit["name"] for circuit in program_info["circuits"]]
+        unknown = [name for name in functions if name not in names]
+        if len(unknown) > 0:
+            message = f"Cannot save unknown function(s) {', '.join(unknown)} of the server"
+            raise ValueError(message)
+
+        program_info["circuits"] = [
+            circuit for circuit in program_info["circuits"] if circuit["name"] in functions
+        ]
+        for filename in ["client.specs.json", "program_info.concrete.params.json"]:
+            with open(directory / filename, "w", encoding="utf-8") as f:
+                json.dump(program_info, f)
+
+        feedback_path = directory / "compilation_feedback.json"
+        if feedback_path.exists():
+            with open(feedback_path, "r", encoding="utf-8") as f:
+                feedback = json.load(f)
+            feedback["circuitFeedbacks"] = [
+                circuit
+                for circuit in feedback.get("circuitFeedbacks", [])
+                if circuit["name"] in functions
+            ]
+            with open(feedback_path, "w", encoding="utf-8") as f:
+                json.dump(feedback, f)
+
+    @staticmethod
+    def _strip_library(library: Path):
+        """
+        Strip the symbols a shared library does not export, the circuits staying exported.
+        """
+
+        strip = shutil.which("strip")
+        if strip is None:  # pragma: no cover
+            message = "Saving a compact server requires the `strip` tool"
+            raise RuntimeError(message)
+
+        flag = "-x" if platform.system() == "Darwin" else "--strip-unneeded"
+        subprocess.run([strip, flag, str(library)], check=True, capture_output=True)
 
     @staticmethod
     def load(path: Union[str, Path]) -> "Server":
         """
-        Load the server from the given path in zip format.
+        Load the server from the given path in zip format, or from a directory.
+
+        A directory, as saved with `unpacked=True`, is used in place: nothing is copied,
+        and the processes loading the same directory share the mapping of its library.
+        In both cases, the library is only opened on the first evaluation.
 
         Args:
             path (Union[str, Path]):
@@ -290,12 +424,17 @@ class Server:
                 server loaded from the filesystem
         """
 
-        # pylint: disable=consider-using-with
-        output_dir = tempfile.TemporaryDirectory()
-        output_dir_path = Path(output_dir.name)
-        # pylint: enable=consider-using-with
+        output_dir: Optional[tempfile.TemporaryDirectory]
+        if Path(path).is_dir():
+            output_dir = None
+            output_dir_path = Path(path)
+        else:
+            # pylint: disable=consider-using-with
+            output_dir = tempfile.TemporaryDirectory()
+            output_dir_path = Path(output_dir.name)
+            # pylint: enable=consider-using-with
 
-        shutil.unpack_archive(path, str(output_dir_path), "zip")
+            shutil.unpack_archive(path, str(output_dir_path), "zip")
 
         with open(output_dir_path / "is_simulated", "r", encoding="utf-8") as f:
             is_simulated = f.read() == "1"
@@ -318,11 +457,8 @@ class Server:
             generateStaticLib=False,
         )
         compilation_result = support.reload()
-        server_program = ServerProgram.load(support, is_simulated)
 
-        return Server(
-            client_specs, output_dir, support, compilation_result, server_program, is_simulated
-        )
+        return Server(client_specs, output_dir, support, compilation_result, None, is_simulated)
 
     def run(
         self,
@@ -352,6 +488,262 @@ class Server:
             message = "Expected evaluation keys to be provided when not in simulation mode"
             raise RuntimeError(message)
 
+        public_args = self._public_arguments(*args)
+        server_circuit = self._program().get_server_circuit(function_name)
+
+        if self.is_simulated:
+            public_result = server_circuit.simulate(public_args)
+        else:
+            public_result = server_circuit.call(public_args, evaluation_keys)
+
+        return self._result(public_result)
+
+    async def run_async(
+        self,
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+        evaluation_keys: Optional[EvaluationKeys] = None,
+        function_name: str = "main",
+    ) -> Union[Value, Tuple[Value, ...]]:
+        """
+        Evaluate, without blocking the event loop.
+
+        Args:
+            *args (Optional[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) for evaluation
+
+            evaluation_keys (Optional[EvaluationKeys], default = None):
+                evaluation keys required for fhe execution
+
+            function_name (str):
+                The name of the function to run
+
+        Returns:
+            Union[Value, Tuple[Value, ...]]:
+                result(s) of evaluation
+        """
+
+        if evaluation_keys is None and not self.is_simulated:
+            message = "Expected evaluation keys to be provided when not in simulation mode"
+            raise RuntimeError(message)
+
+        public_args = self._public_arguments(*args)
+        server_circuit = self._program().get_server_circuit(function_name)
+
+        if self.is_simulated:
+            loop = asyncio.get_running_loop()
+            public_result = await loop.run_in_executor(None, server_circuit.simulate, public_args)
+        else:
+            public_result = await server_circuit.call_async(public_args, evaluation_keys)
+
+        return self._result(public_result)
+
+    def run_batch(
+        self,
+        batch: List[Union[Value, Tuple[Optional[Value], ...]]],
+        evaluation_keys: Optional[EvaluationKeys] = None,
+        function_name: str = "main",
+        max_threads: int = 0,
+    ) -> List[Union[Value, Tuple[Value, ...]]]:
+        """
+        Evaluate a batch of independent samples, in parallel.
+
+        Args:
+            batch (List[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) of each sample, as returned by `Client.encrypt_batch`
+
+            evaluation_keys (Optional[EvaluationKeys], default = None):
+                evaluation keys required for fhe execution
+
+            function_name (str):
+                The name of the function to run
+
+            max_threads (int, default = 0):
+                maximum number of threads to use, all the hardware threads if 0
+
+        Returns:
+            List[Union[Value, Tuple[Value, ...]]]:
+                result(s) of evaluation of each sample, in the order of the batch
+        """
+
+        if evaluation_keys is None and not self.is_simulated:
+            message = "Expected evaluation keys to be provided when not in simulation mode"
+            raise RuntimeError(message)
+
+        public_args = [
+            self._public_arguments(*(args if isinstance(args, tuple) else (args,)))
+            for args in batch
+        ]
+        server_circuit = self._program().get_server_circuit(function_name)
+
+        if self.is_simulated:
+            public_results = server_circuit.simulate_batch(public_args, max_threads)
+        else:
+            public_results = server_circuit.call_batch(public_args, evaluation_keys, max_threads)
+
+        return [self._result(public_result) for public_result in public_results]
+
+    def run_graph(
+        self,
+        stages: List[Tuple[str, List[Union[int, Tuple[int, int]]]]],
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+        outputs: Optional[List[Union[int, Tuple[int, int]]]] = None,
+        evaluation_keys: Optional[EvaluationKeys] = None,
+        max_threads: int = 0,
+        on_output: Optional[Callable[[int, Value], None]] = None,
+    ) -> Union[Value, Tuple[Value, ...]]:
+        """
+        Evaluate a chain of functions, their intermediate results staying on the server.
+
+        The arguments of a stage, and the outputs, are given by their sources: an `int` is the
+        argument of the graph at that index, and a `(stage, index)` pair is the result at that
+        index of an earlier stage. The stages whose arguments are ready run in parallel.
+
+        The outputs can be streamed with `on_output`, each of them being passed to it as soon as
+        the stage computing it finishes, which lets the client decrypt the first results while
+        the other stages still run.
+
+        Args:
+            stages (List[Tuple[str, List[Union[int, Tuple[int, int]]]]]):
+                name of the function and sources of the arguments of each stage
+
+            *args (Optional[Union[Value, Tuple[Optional[Value], ...]]]):
+                argument(s) of the graph
+
+            outputs (Optional[List[Union[int, Tuple[int, int]]]], default = None):
+                sources of the results of the graph, all the results of the last stage if None
+
+            evaluation_keys (Optional[EvaluationKeys], default = None):
+                evaluation keys required for fhe execution
+
+            max_threads (int, default = 0):
+                maximum number of threads to use, all the hardware threads if 0
+
+            on_output (Optional[Callable[[int, Value], None]], default = None):
+                called with the index and the value of each output once it is computed,
+                from the threads of the stages but never concurrently
+
+        Returns:
+            Union[Value, Tuple[Value, ...]]:
+                result(s) of the graph
+        """
+
+        if evaluation_keys is None and not self.is_simulated:
+            message = "Expected evaluation keys to be provided when not in simulation mode"
+            raise RuntimeError(message)
+
+        public_args = self._public_arguments(*args)
+        public_result = self._program().call_graph(
+            [(name, list(sources)) for name, sources in stages],
+            list(outputs) if outputs is not None else [],
+            public_args,
+            None if self.is_simulated else evaluation_keys,
+            max_threads,
+            (lambda index, value: on_output(index, Value(value))) if on_output else None,
+        )
+
+        return self._result(public_result)
+
+    def warm_up(self, evaluation_keys: EvaluationKeys):
+        """
+        Prepare the evaluation keys for the next evaluations of all the functions.
+
+        The functions share the keys converted to the fourier domain, which are converted
+        concurrently here rather than on the first evaluation using each of them.
+
+        Args:
+            evaluation_keys (EvaluationKeys):
+                evaluation keys required for fhe execution
+        """
+
+        if not self.is_simulated:
+            self._program().warm_up_keyset(evaluation_keys)
+
+    def set_device_settings(
+        self,
+        devices: Optional[List[int]] = None,
+        memory_limit: Optional[int] = None,
+        batch_size: Optional[int] = None,
+    ):
+        """
+        Set how the GPU runtime uses the devices for the next evaluations.
+
+        Servers sharing the devices of a machine can be given disjoint devices, or a share of
+        the device memory, so that they do not compete for it.
+
+        Args:
+            devices (Optional[List[int]], default = None):
+                devices to schedule the evaluations on, all of them if None
+
+            memory_limit (Optional[int], default = None):
+                bytes of device memory to size the batches sent to a device for,
+                the free memory of the device if None
+
+            batch_size (Optional[int], default = None):
+                maximum number of ciphertexts of a batch sent to a device,
+                as many as fit in memory if None
+        """
+
+        self._device_settings = (list(devices or []), memory_limit or 0, batch_size or 0)
+        if self._server_program is not None:
+            self._server_program.set_device_settings(*self._device_settings)
+
+    def simulated_exporter(self, function_name: str = "main") -> SimulatedValueExporter:
+        """
+        Get the exporter of the arguments of a function in simulation, built on first use.
+
+        Args:
+            function_name (str):
+                The name of the function
+
+        Returns:
+            SimulatedValueExporter:
+                exporter of the arguments of the function
+        """
+
+        if function_name not in self._simulated_exporters:
+            self._simulated_exporters[function_name] = SimulatedValueExporter.new(
+                self.client_specs.client_parameters, function_name
+            )
+        return self._simulated_exporters[function_name]
+
+    def simulated_decrypter(self, function_name: str = "main") -> SimulatedValueDecrypter:
+        """
+        Get the decrypter of the results of a function in simulation, built on first use.
+
+        Args:
+            function_name (str):
+                The name of the function
+
+        Returns:
+            SimulatedValueDecrypter:
+                decrypter of the results of the function
+        """
+
+        if function_name not in self._simulated_decrypters:
+            self._simulated_decrypters[function_name] = SimulatedValueDecrypter.new(
+                self.client_specs.client_parameters, function_name
+            )
+        return self._simulated_decrypters[function_name]
+
+    def _program(self) -> ServerProgram:
+        """
+        Get the server program, opening its library on first use.
+        """
+
+        if self._server_program is None:
+            self._server_program = ServerProgram.load(self._support, self.is_simulated)
+            if self._device_settings is not None:
+                self._server_program.set_device_settings(*self._device_settings)
+        return self._server_program
+
+    def _public_arguments(
+        self,
+        *args: Optional[Union[Value, Tuple[Optional[Value], ...]]],
+    ) -> PublicArguments:
+        """
+        Gather the arguments of an evaluation.
+        """
+
         flattened_args: List[Optional[Value]] = []
         for arg in args:
             if isinstance(arg, tuple):
@@ -371,17 +763,169 @@ class Server:
 
             buffers.append(arg.inner)
 
-        public_args = PublicArguments.new(self.client_specs.client_parameters, buffers)
-        server_circuit = self._server_program.get_server_circuit(function_name)
+        return PublicArguments.new(self.client_specs.client_parameters, buffers)
 
-        if self.is_simulated:
-            public_result = server_circuit.simulate(public_args)
-        else:
-            public_result = server_circuit.call(public_args, evaluation_keys)
+    @staticmethod
+    def _result(public_result: PublicResult) -> Union[Value, Tuple[Value, ...]]:
+        """
+        Unpack the result(s) of an evaluation.
+        """
 
         result = tuple(Value(public_result.get_value(i)) for i in range(public_result.n_values()))
         return result if len(result) > 1 else result[0]
 
+    @staticmethod
+    def record_runtime_statistics(enabled: bool = True, trace: bool = False):
+        """
+        Start or stop recording the calls of the runtime primitives (e.g., bootstraps, keyswitches).
+
+        The recording covers all the servers of the process, it's off by default.
+
+        Args:
+            enabled (bool, default = True):
+                whether to record the calls
+
+            trace (bool, default = False):
+                whether to also keep each call as an event for `save_runtime_trace`
+        """
+
+        ServerCircuit.record_runtime_statistics(enabled, trace)
+
+    @staticmethod
+    def runtime_statistics() -> Dict[str, Dict[str, int]]:
+        """
+        Get the statistics of the runtime primitives recorded so far.
+
+        Returns:
+            Dict[str, Dict[str, int]]:
+                number of calls ("calls"), and total ("total_ns") and maximum ("max_ns")
+                durations in nanoseconds, by primitive
+        """
+
+        return ServerCircuit.runtime_statistics()
+
+    @staticmethod
+    def reset_runtime_statistics():
+        """
+        Forget the statistics and the events of the runtime primitives recorded so far.
+        """
+
+        ServerCircuit.reset_runtime_statistics()
+
+    @staticmethod
+    def save_runtime_trace(path: Union[str, Path]):
+        """
+        Save the events of the runtime primitives recorded since the last save, and forget them.
+
+        Args:
+            path (Union[str, Path]):
+                path to save the trace to, in the Chrome trace event format (e.g., for Perfetto)
+        """
+
+        Path(path).write_text(ServerCircuit.take_runtime_trace(), encoding="utf-8")
+
+    @staticmethod
+    def save_runtime_cost_table(path: Union[str, Path]):
+        """
+        Save the mean time per ciphertext of the keyswitches and bootstraps recorded so far.
+
+        The table can then be given as `optimizer_cost_table` of the configuration, for the
+        optimizer to pick the parameters of the next compilations with the measured costs.
+
+        Args:
+            path (Union[str, Path]):
+                path to save the cost table to
+        """
+
+        Path(path).write_text(ServerCircuit.runtime_cost_table(), encoding="utf-8")
+
+    @staticmethod
+    def memory_usage() -> Dict[str, Dict[str, int]]:
+        """
+        Get the memory accounted by the runtime of all the servers of the process.
+
+        Returns:
+            Dict[str, Dict[str, int]]:
+                live ("live_bytes") and peak ("peak_bytes") bytes of the evaluation keys ("keys"),
+                the arguments and results of the running calls ("ciphertexts"), the buffers of
+                the primitives ("scratch") and the keys on the GPUs ("gpu")
+        """
+
+        return ServerCircuit.memory_usage()
+
+    @staticmethod
+    def reset_memory_peaks():
+        """
+        Set the peak bytes of each category of `memory_usage` to its live bytes.
+        """
+
+        ServerCircuit.reset_memory_peaks()
+
+    @staticmethod
+    def set_memory_limit(limit: Optional[int]):
+        """
+        Limit the host memory accounted by the runtime (i.e., every category but "gpu").
+
+        A call whose arguments don't fit in the limit raises, and the process aborts if an
+        allocation made during a call exceeds it, instead of being killed when out of memory.
+
+        Args:
+            limit (Optional[int]):
+                limit in bytes, or None to remove it
+        """
+
+        ServerCircuit.set_memory_limit(limit or 0)
+
+    @staticmethod
+    def dataflow_statistics() -> Dict[str, Union[int, float, List[int], List[float]]]:
+        """
+        Get the counters of the dataflow runtime in this process, for the servers compiled with
+        `dataflow_parallelize=True`.
+
+        Tasks can only be placed on another node in a distributed execution, where each node
+        has its own counters, "node_tasks" and "node_bytes_sent" being only set on the root
+        node, and "bytes_received" and the key fetches only on the other nodes.
+
+        Returns:
+            Dict[str, Union[int, float, List[int], List[float]]]:
+                tasks created ("tasks_created") and executed ("tasks_executed"), tasks
+                ("node_tasks") and input bytes ("node_bytes_sent") sent to each node, input
+                bytes received ("bytes_received"), keys fetched on first use ("key_fetches")
+                with their total and maximum latencies ("key_fetch_total_ns",
+                "key_fetch_max_ns"), threads waiting for a worker ("pending_threads"), time
+                spent in the computations ("compute_ns"), and time spent executing tasks
+                ("worker_busy_ns") and share of the computations spent idle ("worker_idle_rate")
+                by each worker thread
+        """
+
+        statistics = ServerCircuit.dataflow_statistics()
+        compute_ns = statistics["compute_ns"]
+        statistics["worker_idle_rate"] = [
+            max(0.0, 1.0 - busy_ns / compute_ns) if compute_ns > 0 else 0.0
+            for busy_ns in statistics["worker_busy_ns"]
+        ]
+        return statistics
+
+    @staticmethod
+    def reset_dataflow_statistics():
+        """
+        Set the counters of `dataflow_statistics` to 0.
+        """
+
+        ServerCircuit.reset_dataflow_statistics()
+
+    @staticmethod
+    def dataflow_metrics() -> str:
+        """
+        Get the counters of the dataflow runtime in this process, to be scraped by Prometheus.
+
+        Returns:
+            str:
+                counters of `dataflow_statistics` in the Prometheus text exposition format
+        """
+
+        return ServerCircuit.dataflow_metrics()
+
     def cleanup(self):
         """
         Cleanup the temporary library output directory.
@@ -444,6 +988,25 @@ class Server:
         """
         return self._compilation_feedback.circuit(function).total_output_size
 
+    def predicted_latency(self, function: str = "main") -> Optional[float]:
+        """
+        Get the predicted seconds of a call of the compiled program.
+
+        It is predicted from the cost table of the configuration, None if there is none or if the
+        program has operations it does not measure.
+        """
+        return self._compilation_feedback.circuit(function).predicted_latency
+
+    def predicted_throughput(self, function: str = "main") -> Optional[float]:
+        """
+        Get the predicted calls per second of the compiled program, the workers running
+        independent calls.
+
+        It is predicted from the cost table of the configuration, None if there is none or if the
+        program has operations it does not measure.
+        """
+        return self._compilation_feedback.circuit(function).predicted_throughput
+
     # Programmable Bootstrap Statistics
 
     def programmable_bootstrap_count(self, function: str = "main") -> int:
@@ -744,6 +1307,8 @@ class Server:
         attributes = [
             "size_of_inputs",
             "size_of_outputs",
+            "predicted_latency",
+            "predicted_throughput",
             "programmable_bootstrap_count",
             "programmable_bootstrap_count_per_parameter",
             "programmable_bootstrap_count_per_tag",
@@ -65,10 +65,67 @@ def inputset(
     return result
 
 
+def sample_inputset(inputset: List[Any], size: int) -> List[Any]:
+    """
+    Select the samples of an inputset to measure the bounds on.
+
+    The boundary candidates, the samples holding the minimum or the maximum of an element of an
+    input, are always selected, as they bound the nodes computed elementwise from a single input
+    by monotonic operations, like the elementwise linear ones or the rounding. The rest is filled
+    up to `size` with a random sample of each of as many contiguous strata of the inputset, so
+    that all its parts are represented.
+
+    The bounds measured on the selection can be narrower than the ones of the whole inputset
+    for the other nodes, e.g., the sum of two inputs, which may overflow when evaluated on the
+    samples left out.
+
+    Args:
+        inputset (List[Any]):
+            inputset to sample
+
+        size (int):
+            number of samples to select, more being selected if there are more
+            boundary candidates
+
+    Returns:
+        List[Any]:
+            selected samples, in the order of the inputset
+    """
+
+    if len(inputset) <= size:
+        return inputset
+
+    samples = [sample if isinstance(sample, tuple) else (sample,) for sample in inputset]
+
+    selected: Set[int] = set()
+    for position in range(len(samples[0])):
+        try:
+            values = np.stack([np.asarray(sample[position]) for sample in samples])
+        except ValueError:
+            # the input does not have the same shape in all the samples
+            continue
+        if values.dtype.kind not in "biuf":
+            continue
+        flattened = values.reshape(len(samples), -1)
+        selected.update(np.argmin(flattened, axis=0).tolist())
+        selected.update(np.argmax(flattened, axis=0).tolist())
+
+    remaining = size - len(selected)
+    if remaining > 0:
+        rng = np.random.default_rng(0)
+        candidates = np.array([i for i in range(len(samples)) if i not in selected])
+        for stratum in np.array_split(candidates, remaining):
+            if len(stratum) > 0:
+                selected.add(int(rng.choice(stratum)))
+
+    return [inputset[i] for i in sorted(selected)]
+
+
 def validate_input_args(
     client_specs: ClientSpecs,
     *args: Optional[Union[int, np.ndarray, List]],
     function_name: str = "main",
+    batched: bool = False,
 ) -> List[Optional[Union[int, np.ndarray]]]:
     """Validate input arguments.
 
@@ -78,6 +135,9 @@ def validate_input_args(
         *args (Optional[Union[int, np.ndarray, List]]):
             argument(s) for evaluation
         function_name (str): name of the function to verify
+        batched (bool, default = False):
+            whether each argument stacks samples along its first dimension,
+            all the arguments having the same number of samples
 
     Returns:
         List[Optional[Union[int, np.ndarray]]]: ordered validated args
@@ -92,6 +152,7 @@ def validate_input_args(
         message = f"Expected {len(input_specs)} inputs but got {len(args)}"
         raise ValueError(message)
 
+    batch_size: Optional[int] = None
     sanitized_args: Dict[int, Optional[Union[int, np.ndarray]]] = {}
     for index, (arg, spec) in enumerate(zip(args, input_specs)):
         if arg is None:
@@ -137,6 +198,21 @@ def validate_input_args(
             actual_max = arg if isinstance(arg, int) else arg.max()
             actual_shape = () if isinstance(arg, int) else arg.shape
 
+            if batched:
+                # samples are validated all at once, on the whole stack
+                if len(actual_shape) == 0:
+                    message = f"Expected argument {index} to be a batch but it's a scalar"
+                    raise ValueError(message)
+                if batch_size is None:
+                    batch_size = actual_shape[0]
+                if actual_shape[0] != batch_size:
+                    message = (
+                        f"Expected argument {index} to be a batch of {batch_size} samples "
+                        f"but it has {actual_shape[0]}"
+                    )
+                    raise ValueError(message)
+                actual_shape = actual_shape[1:]
+
             is_valid = (
                 actual_min >= expected_min
                 and actual_max <= expected_max
@@ -174,7 +250,6 @@ def fuse(graph: Graph, artifacts: Optional[FunctionDebugArtifacts] = None):
             if there is a subgraph which needs to be fused cannot be fused
     """
 
-    nx_graph = graph.graph
     processed_terminal_nodes: Set[Node] = set()
 
     fusing_floats = True
@@ -201,41 +276,167 @@ def fuse(graph: Graph, artifacts: Optional[FunctionDebugArtifacts] = None):
         all_nodes, start_nodes, terminal_node = subgraph_to_fuse
         processed_terminal_nodes.add(terminal_node)
 
-        conversion_result = convert_subgraph_to_subgraph_node(
+        if replace_subgraph_with_subgraph_node(graph, all_nodes, start_nodes, terminal_node):
+            if artifacts is not None:
+                artifacts.add_graph("after-fusing", graph)
+
+
+def fuse_table_lookup_chains(graph: Graph, artifacts: Optional[FunctionDebugArtifacts] = None):
+    """
+    Fuse the chains of elementwise table lookups in a graph to single Operation.Generic nodes.
+
+    A table lookup is fused with the table lookup on its result, if it is its only use,
+    so that a chain of them ends up being a single node, evaluated as a single table lookup.
+
+    Args:
+        graph (Graph):
+            graph to search and update
+
+        artifacts (Optional[DebugArtifacts], default = None):
+            compilation artifacts to store information about the fusing process
+    """
+
+    nx_graph = graph.graph
+
+    # nodes converted to table lookups with a conversion of their own
+    specially_converted = {
+        "copy",
+        "dynamic_tlu",
+        "extract_bit_pattern",
+        "identity",
+        "relu",
+        "round_bit_pattern",
+        "truncate_bit_pattern",
+        "where",
+    }
+
+    def variable_preds_of(node: Node) -> List[Node]:
+        return [
+            pred for pred in nx_graph.predecessors(node) if pred.operation != Operation.Constant
+        ]
+
+    def is_fusable_table_lookup(node: Node) -> bool:
+        return (
+            node.converted_to_table_lookup
+            and node.properties["name"] not in specially_converted
+            and not node.properties["attributes"].get("is_multivariate", False)
+            and "bit_width_hint" not in node.properties
+            and isinstance(node.output.dtype, Integer)
+            and all(isinstance(value.dtype, Integer) for value in node.inputs)
+            and len(variable_preds_of(node)) == 1
+        )
+
+    fused_any = False
+
+    # in topological order, so that a fused node is fused again with the next table lookup
+    for second in list(nx.topological_sort(nx_graph)):
+        if second not in nx_graph or not is_fusable_table_lookup(second):
+            continue
+
+        first = variable_preds_of(second)[0]
+        if (
+            first in graph.output_nodes.values()
+            or not is_fusable_table_lookup(first)
+            or set(nx_graph.successors(first)) != {second}
+        ):
+            continue
+
+        start = variable_preds_of(first)[0]
+        if not start.output.shape == first.output.shape == second.output.shape:
+            continue
+
+        all_nodes = {start: None, first: None, second: None}
+        for node in [first, second]:
+            all_nodes.update({pred: None for pred in nx_graph.predecessors(node)})
+
+        fused_any |= replace_subgraph_with_subgraph_node(
             graph,
             all_nodes,
-            start_nodes,
-            terminal_node,
+            {start: None},
+            second,
+            prune=False,
         )
-        if conversion_result is None:
-            continue
 
-        fused_node, node_before_subgraph = conversion_result
-        nx_graph.add_node(fused_node)
+    if fused_any and artifacts is not None:
+        artifacts.add_graph("after-fusing", graph)
 
-        if terminal_node in graph.output_nodes.values():
-            output_node_to_idx: Dict[Node, List[int]] = {
-                out_node: [] for out_node in graph.output_nodes.values()
-            }
-            for output_idx, output_node in graph.output_nodes.items():
-                output_node_to_idx[output_node].append(output_idx)
 
-            for output_idx in output_node_to_idx.get(terminal_node, []):
-                graph.output_nodes[output_idx] = fused_node
+def replace_subgraph_with_subgraph_node(
+    graph: Graph,
+    all_nodes: Dict[Node, None],
+    start_nodes: Dict[Node, None],
+    terminal_node: Node,
+    prune: bool = True,
+) -> bool:
+    """
+    Replace a subgraph of a graph with a single Operation.Generic node.
+
+    Args:
+        graph (Graph):
+            graph to update
 
-        terminal_node_succ = list(nx_graph.successors(terminal_node))
-        for succ in terminal_node_succ:
-            succ_edge_data = deepcopy(nx_graph.get_edge_data(terminal_node, succ))
-            for edge_key, edge_data in succ_edge_data.items():
-                nx_graph.remove_edge(terminal_node, succ, key=edge_key)
-                new_edge_data = deepcopy(edge_data)
-                nx_graph.add_edge(fused_node, succ, key=edge_key, **new_edge_data)
+        all_nodes (Dict[Node, None]):
+            all nodes in the subgraph
 
-        nx_graph.add_edge(node_before_subgraph, fused_node, input_idx=0)
+        start_nodes (Dict[Node, None]):
+            start nodes of the subgraph
 
+        terminal_node (Node):
+            terminal node of the subgraph
+
+        prune (bool, default = True):
+            whether to prune the whole graph after the replacement,
+            instead of only removing the nodes of the subgraph without any other use
+
+    Returns:
+        bool:
+            whether the subgraph is replaced
+    """
+
+    nx_graph = graph.graph
+
+    conversion_result = convert_subgraph_to_subgraph_node(
+        graph,
+        all_nodes,
+        start_nodes,
+        terminal_node,
+    )
+    if conversion_result is None:
+        return False
+
+    fused_node, node_before_subgraph = conversion_result
+    nx_graph.add_node(fused_node)
+
+    if terminal_node in graph.output_nodes.values():
+        output_node_to_idx: Dict[Node, List[int]] = {
+            out_node: [] for out_node in graph.output_nodes.values()
+        }
+        for output_idx, output_node in graph.output_nodes.items():
+            output_node_to_idx[output_node].append(output_idx)
+
+        for output_idx in output_node_to_idx.get(terminal_node, []):
+            graph.output_nodes[output_idx] = fused_node
+
+    terminal_node_succ = list(nx_graph.successors(terminal_node))
+    for succ in terminal_node_succ:
+        succ_edge_data = deepcopy(nx_graph.get_edge_data(terminal_node, succ))
+        for edge_key, edge_data in succ_edge_data.items():
+            nx_graph.remove_edge(terminal_node, succ, key=edge_key)
+            new_edge_data = deepcopy(edge_data)
+            nx_graph.add_edge(fused_node, succ, key=edge_key, **new_edge_data)
+
+    nx_graph.add_edge(node_before_subgraph, fused_node, input_idx=0)
+
+    if prune:
         graph.prune_useless_nodes()
-        if artifacts is not None:
-            artifacts.add_graph("after-fusing", graph)
+    else:
+        # only the nodes of the subgraph can become useless
+        nx_graph.remove_node(terminal_node)
+        for node in all_nodes:
+            if node not in start_nodes and node in nx_graph and nx_graph.out_degree(node) == 0:
+                nx_graph.remove_node(node)
+
+    return True
 
 
 def find_float_subgraph_with_unique_terminal_node(
@@ -731,9 +932,14 @@ def convert_subgraph_to_subgraph_node(
     variable_input_node = variable_input_nodes[0]
     check_subgraph_fusibility(graph, all_nodes, variable_input_node)
 
-    nx_subgraph = nx.MultiDiGraph(nx_graph)
-    nodes_to_remove = [node for node in nx_subgraph.nodes() if node not in all_nodes]
-    nx_subgraph.remove_nodes_from(nodes_to_remove)
+    # copy of the subgraph only, as copying the whole graph gets slow on big graphs
+    nx_subgraph = nx.MultiDiGraph()
+    nx_subgraph.add_nodes_from(all_nodes)
+    for node in all_nodes:
+        for successor, edges in nx_graph.succ[node].items():
+            if successor in all_nodes:
+                for edge_key, edge_data in edges.items():
+                    nx_subgraph.add_edge(node, successor, key=edge_key, **edge_data)
 
     subgraph_variable_input_node = Node.input("input", deepcopy(variable_input_node.output))
     nx_subgraph.add_node(subgraph_variable_input_node)
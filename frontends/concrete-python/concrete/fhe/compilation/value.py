@@ -45,3 +45,37 @@ class Value:
         """
 
         return Value(NativeValue.deserialize(serialized_data))
+
+    def serialize_at_rest(self, compressed_modulus_log: int = 0) -> bytes:
+        """
+        Serialize data into bytes, to be stored at rest.
+
+        Ciphertexts are kept in their compressed form, seeded or modulus switched.
+
+        Args:
+            compressed_modulus_log (int, default = 0):
+                if not 0, uncompressed ciphertexts are modulus switched to that many bits,
+                which adds noise to them, and restored when deserialized
+
+        Returns:
+            bytes:
+                serialized data
+        """
+
+        return self.inner.serialize_at_rest(compressed_modulus_log)
+
+    @staticmethod
+    def deserialize_at_rest(serialized_data: bytes) -> "Value":
+        """
+        Deserialize data serialized by `serialize_at_rest`.
+
+        Args:
+            serialized_data (bytes):
+                previously serialized data
+
+        Returns:
+            Value:
+                deserialized data
+        """
+
+        return Value(NativeValue.deserialize_at_rest(serialized_data))
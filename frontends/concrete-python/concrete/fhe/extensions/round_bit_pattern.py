@@ -44,6 +44,7 @@ class AutoRounder:
     """
 
     target_msbs: int
+    exactness: Optional[Exactness]
 
     is_adjusted: bool
     input_min: int
@@ -51,7 +52,11 @@ class AutoRounder:
     input_bit_width: int
     lsbs_to_remove: int
 
-    def __init__(self, target_msbs: int = MAXIMUM_TLU_BIT_WIDTH):
+    def __init__(
+        self,
+        target_msbs: int = MAXIMUM_TLU_BIT_WIDTH,
+        exactness: Optional[Exactness] = None,
+    ):
         # pylint: disable=protected-access
         if local._is_adjusting:
             message = (
@@ -62,6 +67,7 @@ class AutoRounder:
         # pylint: enable=protected-access
 
         self.target_msbs = target_msbs
+        self.exactness = exactness
 
         self.is_adjusted = False
         self.input_min = 0
@@ -131,6 +137,7 @@ class AutoRounder:
 
         return {
             "target_msbs": self.target_msbs,
+            "exactness": None if self.exactness is None else self.exactness.value,
             "is_adjusted": self.is_adjusted,
             "input_min": self.input_min,
             "input_max": self.input_max,
@@ -144,7 +151,11 @@ class AutoRounder:
         Load previously dumped rounder.
         """
 
-        result = AutoRounder(target_msbs=properties["target_msbs"])
+        exactness = properties.get("exactness")
+        result = AutoRounder(
+            target_msbs=properties["target_msbs"],
+            exactness=None if exactness is None else Exactness(exactness),
+        )
 
         result.is_adjusted = properties["is_adjusted"]
         result.input_min = properties["input_min"]
@@ -209,7 +220,8 @@ def round_bit_pattern(
 
          lsbs_to_remove (Union[int, AutoRounder]):
             number of the least significant bits to remove
-            or an auto rounder object which will be used to determine the integer value
+            or an auto rounder object which will be used to determine the integer value,
+            and the exactness if `exactness` is None
 
         overflow_protection (bool, default = True)
             whether to adjust bit widths and lsbs to remove to avoid overflows
@@ -240,6 +252,8 @@ def round_bit_pattern(
             )
             raise RuntimeError(message)
 
+        if exactness is None:
+            exactness = lsbs_to_remove.exactness
         lsbs_to_remove = lsbs_to_remove.lsbs_to_remove
 
     if not isinstance(exactness, (Exactness, None.__class__)):
@@ -56,6 +56,9 @@ class Context:
     conversion_cache: Dict[Tuple, Conversion]
     constant_cache: Dict[MlirAttribute, MlirOperation]
 
+    type_cache: Dict[Tuple, ConversionType]
+    attribute_cache: Dict[str, MlirAttribute]
+
     configuration: Configuration
 
     def __init__(self, context: MlirContext, graph: Graph, configuration: Configuration):
@@ -68,42 +71,65 @@ class Context:
         self.conversion_cache = {}
         self.constant_cache = {}
 
+        # types and attributes are immutable and repeated a lot in large graphs
+        self.type_cache = {}
+        self.attribute_cache = {}
+
         self.configuration = configuration
 
     # types
 
+    def cached_type(self, key: Tuple, create: Callable[[], MlirType]) -> ConversionType:
+        """
+        Get the conversion type of `key`, creating its MLIR type only on first use.
+        """
+        result = self.type_cache.get(key)
+        if result is None:
+            result = ConversionType(create())
+            self.type_cache[key] = result
+        return result
+
     def i(self, width: int) -> ConversionType:
         """
         Get clear signless integer type (e.g., i3, i5).
         """
-        return ConversionType(IntegerType.get_signless(width))
+        return self.cached_type(("i", width), lambda: IntegerType.get_signless(width))
 
     def eint(self, width: int) -> ConversionType:
         """
         Get encrypted unsigned integer type (e.g., !FHE.eint<3>, !FHE.eint<5>).
         """
-        return ConversionType(EncryptedIntegerType.get(self.context, width))
+        return self.cached_type(
+            ("eint", width),
+            lambda: EncryptedIntegerType.get(self.context, width),
+        )
 
     def esint(self, width: int) -> ConversionType:
         """
         Get encrypted signed integer type (e.g., !FHE.esint<3>, !FHE.esint<5>).
         """
-        return ConversionType(EncryptedSignedIntegerType.get(self.context, width))
+        return self.cached_type(
+            ("esint", width),
+            lambda: EncryptedSignedIntegerType.get(self.context, width),
+        )
 
     def index_type(self) -> MlirType:
         """
         Get index type.
         """
-        return ConversionType(IndexType.parse("index"))
+        return self.cached_type(("index",), lambda: IndexType.parse("index"))
 
     def tensor(self, element_type: ConversionType, shape: Tuple[int, ...]) -> ConversionType:
         """
         Get tensor type (e.g., tensor<5xi3>, tensor<3x2x!FHE.eint<5>>).
         """
-        return (
-            ConversionType(RankedTensorType.get(shape, element_type.mlir))
-            if shape != ()
-            else element_type
+        if shape == ():
+            return element_type
+
+        shape = tuple(int(size) for size in shape)
+        return self.cached_type(
+            ("tensor", element_type.mlir, shape),
+            lambda: RankedTensorType.get(shape, element_type.mlir),
         )
 
     def typeof(self, value: Union[ValueDescription, Node]) -> ConversionType:
@@ -163,9 +189,16 @@ class Context:
 
         if is_tensor:
             value = value.tolist() if is_numpy else value
-            return MlirAttribute.parse(f"dense<{value}> : {resulting_type.mlir}")
+            text = f"dense<{value}> : {resulting_type.mlir}"
+        else:
+            text = f"{value} : {resulting_type.mlir}"
 
-        return MlirAttribute.parse(f"{value} : {resulting_type.mlir}")
+        # parsing dominates the cost of attributes, and the same constants come back often
+        result = self.attribute_cache.get(text)
+        if result is None:
+            result = MlirAttribute.parse(text)
+            self.attribute_cache[text] = result
+        return result
 
     def error(self, highlights: Mapping[Node, Union[str, List[str]]]):
         """
@@ -590,7 +623,7 @@ class Context:
         Idea:
             split x and y into small chunks
             compare the chunks using table lookups
-            reduce chunk comparisons to a final result
+            reduce chunk comparisons to a final result with a balanced tree
         """
 
         x_offset = 0
@@ -644,6 +677,24 @@ class Context:
 
             return Comparison.EQUAL
 
+        # chunk comparisons are reduced with a balanced tree of table lookups
+        # each node picks the first non-equal comparison of its two halves
+        # the more significant half, which comes first, is packed in the low bits
+        # so chunks which end up on the high side are shifted by the mapper
+
+        number_of_chunks = len(chunk_ranges)
+        is_high = [False] * number_of_chunks
+
+        def mark_high(start: int, end: int, high: bool):
+            if end - start == 1:
+                is_high[start] = high
+                return
+            middle = (start + end) // 2
+            mark_high(start, middle, False)
+            mark_high(middle, end, True)
+
+        mark_high(0, number_of_chunks, False)
+
         carries = self.convert_to_chunks_and_map(
             intermediate_scalar_type,
             resulting_type.shape,
@@ -652,7 +703,7 @@ class Context:
             x_offset,
             y,
             y_offset,
-            lambda i, a, b: compare(a, b) << (min(i, 1) * 2),
+            lambda i, a, b: compare(a, b) << (int(is_high[i]) * carry_bit_width),
         )
 
         carry_type = self.tensor(intermediate_scalar_type, shape=resulting_type.shape)
@@ -673,15 +724,24 @@ class Context:
             for previous_comparison in all_comparisons
         ]
 
-        carry = carries[0]
-        for next_carry in carries[1:-1]:
-            combined_carries = self.add(carry_type, next_carry, carry)
-            carry = self.tlu(carry_type, combined_carries, pick_first_not_equal_lut)
+        def pack(start: int, end: int) -> Conversion:
+            middle = (start + end) // 2
+            return self.add(
+                carry_type,
+                reduce(middle, end, high=True),
+                reduce(start, middle, high=False),
+            )
+
+        def reduce(start: int, end: int, high: bool) -> Conversion:
+            if end - start == 1:
+                return carries[start]
+            lut = pick_first_not_equal_lut
+            if high:
+                lut = [comparison << carry_bit_width for comparison in lut]
+            return self.tlu(carry_type, pack(start, end), lut)
 
         if x_was_signed != y_was_signed:
-            if len(carries) > 1:
-                combined_carries = self.add(carry_type, carries[-1], carry)
-                carry = self.tlu(carry_type, combined_carries, pick_first_not_equal_lut)
+            carry = reduce(0, number_of_chunks, high=False)
 
             signed_input = x if x_was_signed else y
             unsigned_input = x if not x_was_signed else y
@@ -746,9 +806,12 @@ class Context:
             )
         else:
             result_lut = [int(comparison in accept) for comparison in all_comparisons]
-            if len(carries) > 1:
-                carry = self.add(carry_type, carries[-1], carry)
+            if number_of_chunks > 1:
+                # the last node of the tree is fused with the result lookup
+                carry = pack(0, number_of_chunks)
                 result_lut = [result_lut[carry] for carry in pick_first_not_equal_lut]
+            else:
+                carry = carries[0]
 
             result = self.tlu(resulting_type, carry, result_lut)
 
@@ -1587,6 +1650,22 @@ class Context:
         assert resulting_type.is_encrypted
         assert self.is_bit_width_compatible(resulting_type, *elements)
 
+        # runs of elements extracted one after the other from the same tensor
+        runs: List[List[Conversion]] = []
+        for element in elements:
+            if runs and element.extracted_from is not None:
+                previous = runs[-1][-1]
+                if previous.extracted_from is not None:
+                    previous_source, previous_index = previous.extracted_from
+                    source, index = element.extracted_from
+                    if source is previous_source and index == previous_index + 1:
+                        runs[-1].append(element)
+                        continue
+            runs.append([element])
+
+        if any(len(run) > 1 for run in runs):
+            return self.array_of_runs(resulting_type, runs)
+
         sanitized_elements = []
         for element in elements:
             assert element.is_scalar
@@ -1619,6 +1698,85 @@ class Context:
             _FromElementsOp, resulting_type, *mlir_elements, original_bit_width=original_bit_width
         )
 
+    def array_of_runs(
+        self,
+        resulting_type: ConversionType,
+        runs: List[List[Conversion]],
+    ) -> Conversion:
+        """
+        Create an encrypted array from runs of elements, inserting the extracted ones as slices.
+
+        Args:
+            resulting_type (ConversionType):
+                type of the array
+
+            runs (List[List[Conversion]]):
+                elements of the array, a run of more than one element
+                being extracted one after the other from the same tensor
+
+        Returns:
+            Conversion:
+                array
+        """
+
+        size = sum(len(run) for run in runs)
+        original_bit_width = max(element.original_bit_width for run in runs for element in run)
+
+        def tensor_type(of: Conversion, shape: Tuple[int, ...]) -> ConversionType:
+            return self.typeof(
+                ValueDescription(
+                    dtype=Integer(is_signed=of.is_signed, bit_width=of.bit_width),
+                    shape=shape,
+                    is_encrypted=of.is_encrypted,
+                )
+            )
+
+        extracted_from = runs[0][0].extracted_from
+        if len(runs) == 1 and extracted_from is not None:
+            source, _ = extracted_from
+            if int(np.prod(source.shape)) == size:
+                # the array is the tensor itself, with another shape
+                result = self.reshape(source, resulting_type.shape)
+                if result.is_clear:
+                    result = self.encrypt(resulting_type, result)
+                return self.to_signedness(result, of=resulting_type)
+
+        flat_type = self.tensor(
+            (self.esint if resulting_type.is_signed else self.eint)(resulting_type.bit_width),
+            shape=(size,),
+        )
+        result = self.zeros(flat_type)
+
+        offset = 0
+        for run in runs:
+            element = run[0]
+            if len(run) > 1:
+                extracted_from = element.extracted_from
+                assert extracted_from is not None
+
+                source, start = extracted_from
+                source_size = int(np.prod(source.shape))
+
+                element = self.reshape(source, (source_size,))
+                if len(run) != source_size:
+                    element = self.index_static(
+                        tensor_type(of=element, shape=(len(run),)),
+                        element,
+                        (slice(start, start + len(run), 1),),
+                    )
+
+            result = self.assign_static(
+                flat_type,
+                result,
+                element,
+                index=(slice(offset, offset + len(run), 1),),
+            )
+            offset += len(run)
+
+        result = self.reshape(result, resulting_type.shape)
+        result.set_original_bit_width(original_bit_width)
+        return result
+
     def assign_static(
         self,
         resulting_type: ConversionType,
@@ -2335,13 +2493,23 @@ class Context:
                     indexing_element += dimension_size
                 indices.append(self.constant(self.index_type(), indexing_element).result)
 
-            return self.operation(
+            extracted = self.operation(
                 tensor.ExtractOp,
                 resulting_type,
                 x.result,
                 tuple(indices),
                 original_bit_width=x.original_bit_width,
             )
+            extracted.extracted_from = (
+                x,
+                int(
+                    np.ravel_multi_index(
+                        tuple(int(i) % size for i, size in zip(index, x.shape)),
+                        x.shape,
+                    )
+                ),
+            )
+            return extracted
 
         offsets = []
         sizes = []
@@ -2454,7 +2622,9 @@ class Context:
             resulting_type.bit_width
         )
 
-        result = self.zeros(resulting_type)
+        # elements are gathered into a single tensor.from_elements,
+        # instead of a chain of tensor.insert creating a new tensor for each element
+        elements = []
         for destination_position in np.ndindex(resulting_type.shape):
             source_position = []
             for indexing_element in index:
@@ -2471,10 +2641,12 @@ class Context:
                     message = f"invalid indexing element of type {type(indexing_element)}"
                     raise AssertionError(message)
 
-            element = self.index_static(resulting_element_type, x, tuple(source_position))
-            result = self.assign_static(resulting_type, result, element, destination_position)
+            elements.append(self.index_static(resulting_element_type, x, tuple(source_position)))
 
-        return result
+        if resulting_type.is_scalar:
+            return elements[0]
+
+        return self.array(resulting_type, elements)
 
     def less(self, resulting_type: ConversionType, x: Conversion, y: Conversion) -> Conversion:
         return self.comparison(resulting_type, x, y, accept={Comparison.LESS})
@@ -120,6 +120,9 @@ class Conversion:
 
     _original_bit_width: Optional[int]
 
+    # tensor and flat index this scalar is extracted from, if it is extracted from one
+    extracted_from: Optional[Tuple["Conversion", int]]
+
     def __init__(self, origin: Node, result: MlirOperation):
         self.origin = origin
 
@@ -128,6 +131,8 @@ class Conversion:
 
         self._original_bit_width = None
 
+        self.extracted_from = None
+
     def set_original_bit_width(self, original_bit_width: int):
         """
         Set the original bit-width of the conversion.
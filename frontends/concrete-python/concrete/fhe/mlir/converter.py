@@ -6,7 +6,7 @@ Declaration of `Converter` class.
 
 import math
 import sys
-from typing import Dict, List, Tuple, Union
+from typing import Dict, List, Optional, Tuple, Union
 
 import concrete.lang
 import concrete.lang.dialects.tracing
@@ -19,11 +19,16 @@ from mlir.ir import Location as MlirLocation
 from mlir.ir import Module as MlirModule
 
 from ..compilation.configuration import Configuration, Exactness
+from ..dtypes import Integer
 from ..representation import Graph, GraphProcessor, MultiGraphProcessor, Node, Operation
 from .context import Context
 from .conversion import Conversion
 from .processors import *  # pylint: disable=wildcard-import
-from .utils import MAXIMUM_TLU_BIT_WIDTH, construct_deduplicated_tables
+from .utils import (
+    MAXIMUM_TLU_BIT_WIDTH,
+    construct_deduplicated_tables,
+    split_multivariate_table,
+)
 
 # pylint: enable=import-error,no-name-in-module
 
@@ -34,9 +39,15 @@ class Converter:
     """
 
     configuration: Configuration
+    precision_merges: Optional[Dict[int, int]]
 
-    def __init__(self, configuration: Configuration):
+    def __init__(
+        self,
+        configuration: Configuration,
+        precision_merges: Optional[Dict[int, int]] = None,
+    ):
         self.configuration = configuration
+        self.precision_merges = precision_merges
 
     def convert_many(
         self,
@@ -226,6 +237,7 @@ class Converter:
                     shifts_with_promotion=configuration.shifts_with_promotion,
                     multivariate_strategy_preference=configuration.multivariate_strategy_preference,
                     min_max_strategy_preference=configuration.min_max_strategy_preference,
+                    precision_merges=self.precision_merges,
                 ),
                 ProcessRounding(
                     rounding_exactness=configuration.rounding_exactness,
@@ -636,6 +648,75 @@ class Converter:
 
         return table[lower_clipping_index : upper_clipping_index + 1]
 
+    def split_multivariate_tlu(
+        self,
+        ctx: Context,
+        node: Node,
+        preds: List[Conversion],
+        table: List[int],
+    ) -> Optional[Conversion]:
+        """
+        Convert a multivariate table lookup to a sum of table lookups on groups of its inputs.
+
+        Args:
+            ctx (Context):
+                conversion context
+
+            node (Node):
+                multivariate node to convert
+
+            preds (List[Conversion]):
+                conversions of the inputs of the node
+
+            table (List[int]):
+                table of the node, on its packed inputs
+
+        Returns:
+            Optional[Conversion]:
+                sum of the table lookups on the groups of inputs
+                if the node is a sum of functions of them and it is cheaper, None otherwise
+        """
+
+        bit_widths = [pred.original_bit_width for pred in preds]
+        groups = split_multivariate_table(table, bit_widths)
+        if groups is None:
+            return None
+
+        # a table lookup costs about twice as much as one with a bit less
+        split_cost = sum(2 ** sum(bit_widths[i] for i in group) for group, _ in groups)
+        if split_cost >= 2 ** sum(bit_widths):  # pragma: no cover
+            return None
+
+        resulting_type = ctx.typeof(node)
+        assert isinstance(node.output.dtype, Integer)
+        resulting_dtype = Integer(
+            is_signed=node.output.dtype.is_signed,
+            bit_width=resulting_type.bit_width,
+        )
+
+        # partial sums may not fit in the output of the node, even if their sum does
+        for _, group_table in groups:
+            if min(group_table) < resulting_dtype.min() or max(group_table) > resulting_dtype.max():
+                return None
+
+        element_type = (ctx.esint if resulting_type.is_signed else ctx.eint)(
+            resulting_type.bit_width
+        )
+
+        lookups = []
+        for group, group_table in groups:
+            group_preds = [preds[i] for i in group]
+            group_shape = sum(np.zeros(pred.shape) for pred in group_preds).shape  # type: ignore
+            lookups.append(
+                ctx.multivariate_tlu(
+                    ctx.tensor(element_type, shape=group_shape),
+                    group_preds,
+                    table=group_table,
+                )
+            )
+
+        return ctx.tree_add(resulting_type, lookups)
+
     def tlu(self, ctx: Context, node: Node, preds: List[Conversion]) -> Conversion:
         assert node.converted_to_table_lookup
 
@@ -727,6 +808,9 @@ class Converter:
 
         if is_multivariate:
             if len(tables) == 1:
+                split = self.split_multivariate_tlu(ctx, node, preds, lut_values.tolist())
+                if split is not None:
+                    return split
                 return ctx.multivariate_tlu(ctx.typeof(node), preds, table=lut_values.tolist())
 
             assert map_values is not None
@@ -3,7 +3,7 @@ Declaration of `AssignBitWidths` graph processor.
 """
 
 from itertools import chain
-from typing import Dict, List
+from typing import Dict, List, Optional, Type, Union
 
 import z3
 
@@ -28,6 +28,14 @@ class AssignBitWidths(MultiGraphProcessor):
     There is preference list for comparison strategies.
     - Strategies will be traversed in order and bit-widths
       will be assigned according to the first available strategy.
+    - The `auto` strategy picks the cheapest of the available strategies
+      for each node, see `AdditionalConstraints.cheapest_strategy`.
+
+    Precisions can be merged into bigger ones, after the minimal assignment.
+    - An encrypted value assigned a precision in `precision_merges` is raised to its merged one,
+      and bit-widths are assigned again with this additional constraint.
+    - This lets the optimizer use the same parameters for both precisions,
+      which may be cheaper than keeping them apart, see `Compiler._search_precision_merges`.
     """
 
     single_precision: bool
@@ -37,6 +45,7 @@ class AssignBitWidths(MultiGraphProcessor):
     shifts_with_promotion: bool
     multivariate_strategy_preference: List[MultivariateStrategy]
     min_max_strategy_preference: List[MinMaxStrategy]
+    precision_merges: Dict[int, int]
 
     def __init__(
         self,
@@ -47,6 +56,7 @@ class AssignBitWidths(MultiGraphProcessor):
         shifts_with_promotion: bool,
         multivariate_strategy_preference: List[MultivariateStrategy],
         min_max_strategy_preference: List[MinMaxStrategy],
+        precision_merges: Optional[Dict[int, int]] = None,
     ):
         self.single_precision = single_precision
         self.composable = composable
@@ -55,6 +65,7 @@ class AssignBitWidths(MultiGraphProcessor):
         self.shifts_with_promotion = shifts_with_promotion
         self.multivariate_strategy_preference = multivariate_strategy_preference
         self.min_max_strategy_preference = min_max_strategy_preference
+        self.precision_merges = precision_merges if precision_merges is not None else {}
 
     def apply_many(self, graphs: Dict[str, Graph]):
         optimizer = z3.Optimize()
@@ -110,6 +121,21 @@ class AssignBitWidths(MultiGraphProcessor):
         assert optimizer.check() == z3.sat
         model = optimizer.model()
 
+        if len(self.precision_merges) != 0:
+            optimizer.push()
+            for node, bit_width in bit_widths.items():
+                if node.output.is_encrypted:
+                    merged_bit_width = self.precision_merges.get(model[bit_width].as_long())
+                    if merged_bit_width is not None:
+                        optimizer.add(bit_width >= merged_bit_width)
+
+            if optimizer.check() == z3.sat:
+                model = optimizer.model()
+            else:  # pragma: no cover
+                optimizer.pop()
+                assert optimizer.check() == z3.sat
+                model = optimizer.model()
+
         for node, bit_width in bit_widths.items():
             assert isinstance(node.output.dtype, Integer)
             new_bit_width = model[bit_width].as_long()
@@ -225,6 +251,47 @@ class AdditionalConstraints:
         node.bit_width_constraints.append(constraint)
         self.optimizer.add(constraint)
 
+    def cheapest_strategy(
+        self,
+        node: Node,
+        x: Node,
+        y: Node,
+        strategy_type: Type[Union[ComparisonStrategy, BitwiseStrategy, MinMaxStrategy]],
+    ) -> Union[ComparisonStrategy, BitwiseStrategy, MinMaxStrategy]:
+        """
+        Get the available strategy of the node whose table lookups are the cheapest.
+
+        The cost of a table lookup doubles with each bit of precision, as for the bootstraps,
+        and the promotion of an operand also adds the cost of its other table lookups
+        getting more precise.
+        """
+
+        def cost(strategy) -> int:
+            total = sum(2**bit_width for bit_width in strategy.table_lookups(x.output, y.output))
+
+            promotions = strategy.promotions(x.output, y.output)
+            for operand, promoted_bit_width in zip((x, y), promotions):
+                assert isinstance(operand.output.dtype, Integer)
+                bit_width = operand.output.dtype.bit_width
+                if promoted_bit_width <= bit_width:
+                    continue
+
+                other_table_lookups = sum(
+                    1
+                    for user in self.graph.graph.successors(operand)
+                    if user is not node and user.converted_to_table_lookup
+                )
+                total += other_table_lookups * (2**promoted_bit_width - 2**bit_width)
+
+            return total
+
+        candidates = [
+            strategy
+            for strategy in strategy_type
+            if strategy != strategy_type.AUTO and strategy.can_be_used(x.output, y.output)
+        ]
+        return min(candidates, key=cost)
+
     # ==========
     # Conditions
     # ==========
@@ -276,6 +343,9 @@ class AdditionalConstraints:
         ]
 
         for strategy in strategies + fallback:
+            if strategy == ComparisonStrategy.AUTO:
+                strategy = self.cheapest_strategy(node, x, y, ComparisonStrategy)
+
             if strategy.can_be_used(x.output, y.output):
                 new_x_bit_width, new_y_bit_width = strategy.promotions(x.output, y.output)
                 self.constraint(node, self.bit_widths[x] >= new_x_bit_width)
@@ -302,6 +372,9 @@ class AdditionalConstraints:
         ]
 
         for strategy in strategies + fallback:
+            if strategy == BitwiseStrategy.AUTO:
+                strategy = self.cheapest_strategy(node, x, y, BitwiseStrategy)
+
             if strategy.can_be_used(x.output, y.output):
                 new_x_bit_width, new_y_bit_width = strategy.promotions(x.output, y.output)
                 self.constraint(node, self.bit_widths[x] >= new_x_bit_width)
@@ -376,6 +449,9 @@ class AdditionalConstraints:
         ]
 
         for strategy in strategies + fallback:
+            if strategy == MinMaxStrategy.AUTO:
+                strategy = self.cheapest_strategy(node, x, y, MinMaxStrategy)
+
             if strategy.can_be_used(x.output, y.output):
                 new_x_bit_width, new_y_bit_width = strategy.promotions(x.output, y.output)
                 self.constraint(node, self.bit_widths[x] >= new_x_bit_width)
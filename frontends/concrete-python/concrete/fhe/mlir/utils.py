@@ -139,6 +139,77 @@ def construct_table_multivariate(node: Node, preds: List[Node]) -> List[Any]:
     return table
 
 
+def split_multivariate_table(
+    table: List[int],
+    bit_widths: List[int],
+) -> Optional[List[Tuple[List[int], List[int]]]]:
+    """
+    Split the table of a multivariate node into the tables of a sum of functions of its inputs.
+
+    Inputs are grouped together if the table has a mixed difference on them,
+    meaning the effect of one depends on the value of the other.
+    Each group then gets the table of the function on its packed inputs, the other inputs being 0,
+    and the first one is the only one to keep the value of the table at 0.
+
+    Args:
+        table (List[int]):
+            table of the multivariate node, on its packed inputs
+
+        bit_widths (List[int]):
+            bit-widths of the inputs in the packing, first input being the least significant
+
+    Returns:
+        Optional[List[Tuple[List[int], List[int]]]]:
+            groups of input indices with their tables on their packed inputs
+            if the table is the sum of at least two of them, None otherwise
+    """
+
+    count = len(bit_widths)
+
+    # axes are in reverse order of the inputs, so that the first input is the least significant
+    values = np.array(table, dtype=np.int64).reshape(
+        tuple(2**bit_width for bit_width in reversed(bit_widths))
+    )
+
+    def at_zero(indices: List[int]) -> np.ndarray:
+        result = values
+        for index in indices:
+            result = np.take(result, [0], axis=(count - 1 - index))
+        return result
+
+    groups = list(range(count))
+
+    def find(index: int) -> int:
+        while groups[index] != index:
+            index = groups[index]
+        return index
+
+    for i in range(count):
+        for j in range(i + 1, count):
+            if find(i) == find(j):
+                continue
+            mixed_difference = values - at_zero([i]) - at_zero([j]) + at_zero([i, j])
+            if np.any(mixed_difference != 0):
+                groups[find(j)] = find(i)
+
+    members: DefaultDict[int, List[int]] = defaultdict(list)
+    for index in range(count):
+        members[find(index)].append(index)
+
+    if len(members) < 2:
+        return None
+
+    origin = at_zero(list(range(count)))
+
+    result = []
+    for group_index, group in enumerate(members.values()):
+        others = [index for index in range(count) if index not in group]
+        group_values = at_zero(others) - (origin if group_index != 0 else 0)
+        result.append((group, [int(value) for value in group_values.ravel()]))
+
+    return result
+
+
 def construct_table(node: Node, preds: List[Node], configuration: Configuration) -> List[Any]:
     """
     Construct the lookup table for an Operation.Generic node.
@@ -2,6 +2,7 @@
 Declaration of `Graph` class.
 """
 
+import itertools
 import math
 import os
 import re
@@ -22,6 +23,9 @@ from .operation import Operation
 
 P_ERROR_PER_ERROR_SIZE_CACHE: Dict[float, Dict[int, float]] = {}
 
+# number of inputset samples evaluated at once during bound measurement
+BOUND_MEASUREMENT_BATCH_SIZE = 1024
+
 
 class Graph:
     """
@@ -203,6 +207,102 @@ class Graph:
 
         return node_results
 
+    def evaluate_batch(self, *args: np.ndarray) -> Dict[Node, np.ndarray]:
+        """
+        Perform the computation `Graph` represents on a batch of samples in a single pass.
+
+        Batchable nodes (see `Node.is_batchable`) are evaluated on the whole batch at once,
+        the other nodes being evaluated sample by sample.
+
+        Args:
+            *args (np.ndarray):
+                inputs to the computation, each stacking the samples along its first axis
+
+        Returns:
+            Dict[Node, np.ndarray]:
+                nodes and their values during computation, stacked along the first axis
+        """
+
+        batch_size = len(args[0])
+        node_results, unbatched_results = self._evaluate_batch(*args)
+        for node, value in unbatched_results.items():
+            node_results[node] = np.broadcast_to(value, (batch_size, *np.shape(value)))
+        return node_results
+
+    def _evaluate_batch(
+        self,
+        *args: np.ndarray,
+    ) -> Tuple[Dict[Node, np.ndarray], Dict[Node, Any]]:
+        """
+        Perform the computation `Graph` represents on a batch of samples in a single pass.
+
+        Returns:
+            Tuple[Dict[Node, np.ndarray], Dict[Node, Any]]:
+                values of the nodes that depend on the inputs, stacked along the first axis,
+                and values of the nodes that are the same for all the samples
+        """
+
+        assert len(args) == len(self.input_nodes) and len(args) > 0
+        batch_size = len(args[0])
+
+        def align(value: np.ndarray, rank: int) -> np.ndarray:
+            # insert axes after the batch axis so that samples broadcast like single values
+            missing = rank - (value.ndim - 1)
+            return value.reshape(value.shape[:1] + (1,) * missing + value.shape[1:])
+
+        node_results: Dict[Node, np.ndarray] = {}
+        unbatched_results: Dict[Node, Any] = {}
+        for node in nx.topological_sort(self.graph):
+            if node.operation == Operation.Input:
+                batch = args[self.input_indices[node]]
+                if batch.shape != (batch_size, *node.output.shape):
+                    message = (
+                        f"Expected a batch of {batch_size} samples of shape {node.output.shape}"
+                    )
+                    raise ValueError(message)
+                node_results[node] = batch
+                continue
+
+            preds = self.ordered_preds_of(node)
+            if all(pred in unbatched_results for pred in preds):
+                # constants and their transformations are the same for all the samples
+                unbatched_results[node] = node(*[unbatched_results[pred] for pred in preds])
+                continue
+
+            if node.is_batchable:
+                rank = len(node.output.shape)
+                result = node.evaluator(
+                    *[
+                        unbatched_results[pred]
+                        if pred in unbatched_results
+                        else align(node_results[pred], rank)
+                        for pred in preds
+                    ]
+                )
+                if (
+                    isinstance(result, np.ndarray)
+                    and result.shape == (batch_size, *node.output.shape)
+                    and result.dtype.kind in "biuf"
+                ):
+                    node_results[node] = result
+                    continue
+
+            node_results[node] = np.array(
+                [
+                    node(
+                        *[
+                            deepcopy(unbatched_results[pred])
+                            if pred in unbatched_results
+                            else deepcopy(node_results[pred][index])
+                            for pred in preds
+                        ]
+                    )
+                    for index in range(batch_size)
+                ]
+            )
+
+        return node_results, unbatched_results
+
     def draw(
         self,
         *,
@@ -654,41 +754,76 @@ class Graph:
                 bounds of each node in the `Graph`
         """
 
-        bounds = {}
-
-        inputset_iterator = iter(inputset)
-
-        sample = next(inputset_iterator)
-        if not isinstance(sample, tuple):
-            sample = (sample,)
+        bounds: Dict[Node, Dict[str, Union[np.integer, np.floating]]] = {}
 
-        index = 0
-        try:
-            evaluation = self.evaluate(*sample)
+        def update_bounds(evaluation: Dict[Node, Any]):
             for node, value in evaluation.items():
-                bounds[node] = {
-                    "min": value.min(),
-                    "max": value.max(),
-                }
-
-            for sample in inputset_iterator:
-                index += 1
-                if not isinstance(sample, tuple):
-                    sample = (sample,)
-
-                evaluation = self.evaluate(*sample)
-                for node, value in evaluation.items():
+                if node not in bounds:
+                    bounds[node] = {"min": value.min(), "max": value.max()}
+                else:
                     bounds[node] = {
                         "min": np.minimum(bounds[node]["min"], value.min()),
                         "max": np.maximum(bounds[node]["max"], value.max()),
                     }
 
-        except Exception as error:
-            message = f"Bound measurement using inputset[{index}] failed"
-            raise RuntimeError(message) from error
+        inputset_iterator = iter(inputset)
+
+        index = 0
+        while True:
+            samples = [
+                sample if isinstance(sample, tuple) else (sample,)
+                for sample in itertools.islice(inputset_iterator, BOUND_MEASUREMENT_BATCH_SIZE)
+            ]
+            if len(samples) == 0:
+                break
+
+            # the whole batch is evaluated in a single pass when possible,
+            # sample by sample otherwise, which also locates the failing sample
+            batch = self._stack_samples(samples)
+            if batch is not None:
+                try:
+                    node_results, unbatched_results = self._evaluate_batch(*batch)
+                    # values shared by all the samples are measured once
+                    update_bounds({**node_results, **unbatched_results})
+                    index += len(samples)
+                    continue
+                except Exception:  # pylint: disable=broad-except
+                    pass
+
+            for sample in samples:
+                try:
+                    update_bounds(self.evaluate(*sample))
+                except Exception as error:
+                    message = f"Bound measurement using inputset[{index}] failed"
+                    raise RuntimeError(message) from error
+                index += 1
 
         return bounds
 
+    def _stack_samples(self, samples: List[Tuple[Any, ...]]) -> Optional[List[np.ndarray]]:
+        """
+        Stack the inputs of the samples along a new leading axis, if they can be.
+        """
+
+        if len(self.input_nodes) == 0 or any(
+            len(sample) != len(self.input_nodes) for sample in samples
+        ):
+            return None
+
+        batch = []
+        for position in range(len(self.input_nodes)):
+            try:
+                stacked = np.array([sample[position] for sample in samples])
+            except Exception:  # pylint: disable=broad-except
+                return None
+
+            if stacked.dtype.kind not in "biuf":
+                return None
+
+            batch.append(stacked)
+
+        return batch
+
     def update_with_bounds(self, bounds: Dict[Node, Dict[str, Union[np.integer, np.floating]]]):
         """
         Update `ValueDescription`s within the `Graph` according to measured bounds.
@@ -462,5 +462,25 @@ class Node:
             "zeros",
         ]
 
+    @property
+    def is_batchable(self) -> bool:
+        """
+        Get whether the node can be evaluated on a batch of samples in a single call.
+
+        Element-wise numpy ufuncs broadcast over an extra leading axis, as long as the inputs
+        are aligned on the rank of the output, which other operations do not.
+
+        Returns:
+            bool:
+                True if the node can be evaluated on a batch of samples, False otherwise
+        """
+
+        return (
+            self.operation == Operation.Generic
+            and isinstance(self.evaluator, GenericEvaluator)
+            and isinstance(self.evaluator.operation, np.ufunc)
+            and self.evaluator.operation.signature is None
+        )
+
     def __lt__(self, other) -> bool:
         return self.created_at < other.created_at
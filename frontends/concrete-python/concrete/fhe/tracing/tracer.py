@@ -466,6 +466,10 @@ class Tracer:
         (https://numpy.org/doc/stable/user/basics.dispatch.html#basics-dispatch)
         """
 
+        if func is np.take:
+            tracer = args[0] if isinstance(args[0], Tracer) else self.sanitize(args[0])
+            return tracer.take(*args[1:], **kwargs)
+
         if func is np.broadcast_to:
             sanitized_args = [self.sanitize(args[0])]
             if len(args) > 1:
@@ -733,6 +737,57 @@ class Tracer:
 
         return Tracer._trace_numpy_operation(np.around, self, decimals=decimals)
 
+    def take(self, indices: Any, axis: Optional[int] = None) -> "Tracer":
+        """
+        Trace numpy.ndarray.take(indices, axis).
+
+        Taking is traced as a single indexing, a slice if the indices are evenly spaced.
+        """
+
+        if isinstance(indices, Tracer):
+            message = "Function 'np.take' is not supported with traced indices"
+            raise RuntimeError(message)
+
+        indices = np.array(indices)
+        if not np.issubdtype(indices.dtype, np.integer):
+            message = f"{self} cannot be taken with {format_indexing_element(indices)}"
+            raise ValueError(message)
+
+        x = self
+        if axis is None:
+            x = self.flatten()
+            axis = 0
+
+        if axis < 0:
+            axis += len(x.shape)
+
+        dimension_size = x.shape[axis]
+        indices = np.where(indices < 0, indices + dimension_size, indices)
+
+        leading: Tuple[slice, ...] = (slice(None, None, None),) * axis
+        if indices.ndim == 0:
+            return x[leading + (int(indices),)]
+
+        if indices.ndim == 1 and len(indices) > 1:
+            steps = np.diff(indices)
+            if steps[0] > 0 and np.all(steps == steps[0]):
+                start, step = int(indices[0]), int(steps[0])
+                return x[leading + (slice(start, int(indices[-1]) + 1, step),)]
+
+        resulting_shape = x.shape[:axis] + indices.shape + x.shape[axis + 1 :]
+        grid = np.indices(resulting_shape)
+
+        index = []
+        for dimension in range(len(x.shape)):
+            if dimension < axis:
+                index.append(grid[dimension])
+            elif dimension == axis:
+                index.append(indices[tuple(grid[axis : axis + indices.ndim])])
+            else:
+                index.append(grid[dimension - 1 + indices.ndim])
+
+        return x[tuple(index)]
+
     def transpose(self, axes: Optional[Tuple[int, ...]] = None) -> "Tracer":
         """
         Trace numpy.ndarray.transpose().
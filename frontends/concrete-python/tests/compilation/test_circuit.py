@@ -2,6 +2,8 @@
 Tests of `Circuit` class.
 """
 
+import asyncio
+import json
 import tempfile
 from pathlib import Path
 
@@ -245,12 +247,23 @@ def test_client_server_api(helpers):
         server_path = tmp_dir_path / "server.zip"
         circuit.server.save(server_path)
 
+        unpacked_server_path = tmp_dir_path / "server"
+        circuit.server.save(unpacked_server_path, unpacked=True)
+
+        compact_server_path = tmp_dir_path / "compact_server.zip"
+        circuit.server.save(compact_server_path, compact=True, functions=["main"])
+
+        with pytest.raises(ValueError):
+            circuit.server.save(tmp_dir_path / "unknown.zip", functions=["unknown"])
+
         client_path = tmp_dir_path / "client.zip"
         circuit.client.save(client_path)
 
         circuit.cleanup()
 
         server = Server.load(server_path)
+        unpacked_server = Server.load(unpacked_server_path)
+        compact_server = Server.load(compact_server_path)
 
         serialized_client_specs = server.client_specs.serialize()
         client_specs = ClientSpecs.deserialize(serialized_client_specs)
@@ -260,7 +273,7 @@ def test_client_server_api(helpers):
             Client.load(client_path, configuration.insecure_key_cache_location),
         ]
 
-        for client in clients:
+        for client, server_to_run in zip(clients * 2, [server, unpacked_server, compact_server]):
             arg = client.encrypt([3, 8, 1])
 
             serialized_arg = arg.serialize()
@@ -269,7 +282,9 @@ def test_client_server_api(helpers):
             deserialized_arg = Value.deserialize(serialized_arg)
             deserialized_evaluation_keys = EvaluationKeys.deserialize(serialized_evaluation_keys)
 
-            result = server.run(deserialized_arg, evaluation_keys=deserialized_evaluation_keys)
+            result = server_to_run.run(
+                deserialized_arg, evaluation_keys=deserialized_evaluation_keys
+            )
             serialized_result = result.serialize()
 
             deserialized_result = Value.deserialize(serialized_result)
@@ -283,6 +298,198 @@ def test_client_server_api(helpers):
         assert str(excinfo.value) == "Loaded server objects cannot be saved again via MLIR"
 
         server.cleanup()
+        unpacked_server.cleanup()
+        assert unpacked_server_path.exists()
+
+
+def test_circuit_batch_api(helpers):
+    """
+    Test batched encryption, evaluation and decryption.
+    """
+
+    configuration = helpers.configuration()
+
+    @fhe.compiler({"x": "encrypted", "y": "encrypted"})
+    def function(x, y):
+        return x + y, y + 1
+
+    inputset = [(np.random.randint(0, 10, size=(3,)), np.random.randint(0, 10)) for _ in range(10)]
+    circuit = function.compile(inputset, configuration.fork())
+
+    xs = np.random.randint(0, 10, size=(4, 3))
+    ys = np.random.randint(0, 10, size=(4,))
+
+    args = circuit.encrypt_batch(xs, ys)
+    assert len(args) == 4
+
+    results = circuit.run_batch(args)
+    outputs = circuit.decrypt_batch(results)
+
+    for x, y, (sum_, y_) in zip(xs, ys, outputs):
+        assert np.array_equal(sum_, x + y)
+        assert y_ == y + 1
+
+    with pytest.raises(ValueError) as excinfo:
+        circuit.encrypt_batch(xs, ys[:2])
+
+    assert str(excinfo.value) == "Expected argument 1 to be a batch of 4 samples but it has 2"
+
+
+def test_server_runtime_statistics(helpers):
+    """
+    Test the recording of the runtime primitives of the evaluations.
+    """
+
+    configuration = helpers.configuration()
+
+    @fhe.compiler({"x": "encrypted"})
+    def function(x):
+        return (x**2) + 1
+
+    inputset = range(10)
+    circuit = function.compile(inputset, configuration.fork(fhe_simulation=False))
+
+    Server.reset_runtime_statistics()
+    circuit.encrypt_run_decrypt(3)
+    assert Server.runtime_statistics() == {}
+
+    Server.record_runtime_statistics(trace=True)
+    try:
+        assert circuit.encrypt_run_decrypt(3) == 10
+    finally:
+        Server.record_runtime_statistics(enabled=False)
+
+    statistics = Server.runtime_statistics()
+    assert statistics["bootstrap"]["calls"] >= 1
+    assert statistics["transformer"]["calls"] == 2
+    assert statistics["bootstrap"]["max_ns"] <= statistics["bootstrap"]["total_ns"]
+
+    with tempfile.TemporaryDirectory() as path:
+        trace = Path(path) / "trace.json"
+        Server.save_runtime_trace(trace)
+        events = json.loads(trace.read_text(encoding="utf-8"))["traceEvents"]
+
+        cost_table = Path(path) / "cost_table.txt"
+        Server.save_runtime_cost_table(cost_table)
+        lines = cost_table.read_text(encoding="utf-8").splitlines()
+        assert any(line.startswith("pbs ") and len(line.split()) == 7 for line in lines)
+
+        recompiled = function.compile(
+            inputset,
+            configuration.fork(fhe_simulation=False, optimizer_cost_table=cost_table),
+        )
+        assert recompiled.encrypt_run_decrypt(3) == 10
+
+    assert {event["name"] for event in events} >= {"bootstrap", "transformer"}
+
+    Server.reset_runtime_statistics()
+    assert Server.runtime_statistics() == {}
+
+
+def test_server_memory_usage(helpers):
+    """
+    Test the memory accounting of the runtime, and its limit.
+    """
+
+    configuration = helpers.configuration()
+
+    @fhe.compiler({"x": "encrypted"})
+    def function(x):
+        return (x**2) + 1
+
+    inputset = range(10)
+    circuit = function.compile(inputset, configuration.fork(fhe_simulation=False))
+
+    assert circuit.encrypt_run_decrypt(3) == 10
+    Server.reset_memory_peaks()
+    assert circuit.encrypt_run_decrypt(3) == 10
+
+    usage = Server.memory_usage()
+    assert set(usage.keys()) == {"keys", "ciphertexts", "scratch", "gpu"}
+    assert usage["keys"]["live_bytes"] > 0
+    assert usage["ciphertexts"]["live_bytes"] == 0
+    assert usage["ciphertexts"]["peak_bytes"] > 0
+
+    Server.set_memory_limit(1)
+    try:
+        with pytest.raises(RuntimeError) as excinfo:
+            circuit.encrypt_run_decrypt(3)
+    finally:
+        Server.set_memory_limit(None)
+
+    assert "exceeds the memory limit of 1 bytes" in str(excinfo.value)
+    assert circuit.encrypt_run_decrypt(3) == 10
+
+
+def test_server_run_async(helpers):
+    """
+    Test asynchronous evaluation, with and without coalescing.
+    """
+
+    configuration = helpers.configuration()
+
+    @fhe.compiler({"x": "encrypted"})
+    def function(x):
+        return x + 42
+
+    inputset = [np.random.randint(0, 10, size=(3,)) for _ in range(10)]
+    circuit = function.compile(inputset, configuration.fork())
+    circuit.keygen()
+
+    xs = np.random.randint(0, 10, size=(5, 3))
+    args = [circuit.encrypt(x) for x in xs]
+    evaluation_keys = circuit.client.evaluation_keys
+
+    coalescer = fhe.RequestCoalescer(circuit.server, window=0.01, max_batch_size=4)
+
+    async def run_all():
+        single = await circuit.server.run_async(args[0], evaluation_keys=evaluation_keys)
+        coalesced = await asyncio.gather(
+            *(coalescer.run(arg, evaluation_keys=evaluation_keys) for arg in args)
+        )
+        return [single, *coalesced]
+
+    results = asyncio.run(run_all())
+    for x, result in zip([xs[0], *xs], results):
+        assert np.array_equal(circuit.decrypt(result), x + 42)
+
+
+def test_server_pool(helpers):
+    """
+    Test evaluation in a pool of worker processes.
+    """
+
+    configuration = helpers.configuration()
+
+    @fhe.compiler({"x": "encrypted"})
+    def function(x):
+        return x**2
+
+    inputset = range(10)
+    circuit = function.compile(inputset, configuration.fork(fhe_simulation=False))
+    circuit.keygen()
+
+    xs = [3, 0, 7, 5, 9]
+    args = [circuit.encrypt(x) for x in xs]
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        tmp_dir_path = Path(tmp_dir)
+        server_path = tmp_dir_path / "server.zip"
+        circuit.server.save(server_path)
+        evaluation_keys_path = tmp_dir_path / "evaluation_keys.bin"
+        evaluation_keys_path.write_bytes(circuit.client.evaluation_keys.serialize())
+
+        with fhe.ServerPool(server_path, evaluation_keys_path, processes=2) as pool:
+            assert circuit.decrypt(pool.run(args[0])) == xs[0] ** 2
+            results = pool.run_batch(args)
+
+            with pytest.raises(RuntimeError):
+                pool.run(args[0], function_name="unknown")
+
+    assert [circuit.decrypt(result) for result in results] == [x**2 for x in xs]
+
+    with pytest.raises(RuntimeError, match="Expected the pool not to be closed"):
+        pool.run(args[0])
 
 
 def test_client_server_api_crt(helpers):
@@ -432,6 +639,20 @@ def test_dataflow_circuit(helpers):
 
     assert circuit.encrypt_run_decrypt(5, 6) == 28
 
+    Server.reset_dataflow_statistics()
+    assert circuit.encrypt_run_decrypt(5, 6) == 28
+
+    statistics = Server.dataflow_statistics()
+    assert statistics["tasks_created"] > 0
+    assert statistics["tasks_executed"] == statistics["tasks_created"]
+    assert sum(statistics["node_tasks"]) == statistics["tasks_created"]
+    assert statistics["compute_ns"] > 0
+    assert all(0.0 <= rate <= 1.0 for rate in statistics["worker_idle_rate"])
+
+    metrics = Server.dataflow_metrics()
+    assert "# TYPE concrete_dfr_tasks_created_total counter" in metrics
+    assert f"concrete_dfr_tasks_executed_total {statistics['tasks_executed']}" in metrics
+
 
 def test_circuit_sim_disabled(helpers):
     """
@@ -434,3 +434,76 @@ def test_compiler_enable_fusing(helpers):
         helpers.configuration().fork(enable_tlu_fusing=False),
     )
     assert circuit4.programmable_bootstrap_count == 6
+
+
+def test_compiler_optimize_bit_width_assignment(helpers):
+    """
+    Test compiling with the cost-driven bit-width assignment.
+    """
+
+    def f(x, y):
+        return (x**2) + fhe.univariate(lambda y: y // 2)(y)
+
+    inputset = [(x, y) for x in range(4) for y in range(0, 64, 7)]
+    configuration = helpers.configuration().fork(single_precision=False)
+
+    compiler1 = Compiler(f, {"x": "encrypted", "y": "encrypted"})
+    circuit1 = compiler1.compile(inputset, configuration)
+
+    compiler2 = Compiler(f, {"x": "encrypted", "y": "encrypted"})
+    circuit2 = compiler2.compile(
+        inputset,
+        configuration.fork(optimize_bit_width_assignment=True),
+    )
+
+    assert circuit2.complexity <= circuit1.complexity
+
+    for sample in [(0, 0), (3, 63), (2, 17)]:
+        helpers.check_execution(circuit2, f, list(sample))
+
+
+def test_compiler_fuse_tlu_chains(helpers):
+    """
+    Test compiling with the chains of table lookups fused.
+    """
+
+    def f(x):
+        y = (x**2) // 3
+        z = fhe.univariate(lambda v: v % 5)(y) + 1
+        return np.abs(z - 4) + y
+
+    inputset = fhe.inputset(fhe.tensor[fhe.uint4, 3])  # type: ignore
+
+    compiler1 = Compiler(f, {"x": "encrypted"})
+    graph1 = compiler1.trace(inputset, helpers.configuration())
+
+    compiler2 = Compiler(f, {"x": "encrypted"})
+    graph2 = compiler2.trace(inputset, helpers.configuration().fork(fuse_tlu_chains=True))
+
+    # `x**2` and `// 3` are fused, `v % 5` is not as `y` has another use
+    assert len(graph2.graph.nodes) < len(graph1.graph.nodes)
+
+    circuit = compiler2.compile(inputset, helpers.configuration().fork(fuse_tlu_chains=True))
+    helpers.check_execution(circuit, f, np.array([0, 7, 15]))
+
+
+def test_compiler_bounds_measurement_sample_size(helpers):
+    """
+    Test compiling with the bounds measured on a sample of the inputset.
+    """
+
+    def f(x):
+        return (2 * x + 3) // 3
+
+    inputset = fhe.inputset(fhe.tensor[fhe.uint5, 2], size=1000)  # type: ignore
+    configuration = helpers.configuration()
+
+    compiler1 = Compiler(f, {"x": "encrypted"})
+    graph1 = compiler1.trace(inputset, configuration)
+
+    compiler2 = Compiler(f, {"x": "encrypted"})
+    graph2 = compiler2.trace(inputset, configuration.fork(bounds_measurement_sample_size=10))
+
+    # the elementwise operations are monotonic in the input, so the sampled bounds are exact
+    for node1, node2 in zip(graph1.query_nodes(ordered=True), graph2.query_nodes(ordered=True)):
+        assert node1.bounds == node2.bounds
@@ -30,6 +30,16 @@ from ..conftest import USE_MULTI_PRECISION
             RuntimeError,
             "Insecure key cache cannot be enabled without specifying its location",
         ),
+        pytest.param(
+            {"use_gpu": True, "gpu_devices": [0, -1]},
+            RuntimeError,
+            "GPU devices cannot be negative",
+        ),
+        pytest.param(
+            {"use_gpu": True, "gpu_memory_limit": 0},
+            RuntimeError,
+            "'gpu_memory_limit' must be positive",
+        ),
     ],
 )
 def test_configuration_bad_init(kwargs, expected_error, expected_message):
@@ -138,7 +148,8 @@ FORK_NAME = "fork" if sys.version_info < (3, 10) else "Configuration.fork"
             "two-tlu-bigger-casted-smaller-promoted, "
             "three-tlu-bigger-clipped-smaller-casted, "
             "two-tlu-bigger-clipped-smaller-promoted, "
-            "chunked"
+            "chunked, "
+            "auto"
             ")",
         ),
         pytest.param(
@@ -154,7 +165,8 @@ FORK_NAME = "fork" if sys.version_info < (3, 10) else "Configuration.fork"
             "three-tlu-casted, "
             "two-tlu-bigger-promoted-smaller-casted, "
             "two-tlu-bigger-casted-smaller-promoted, "
-            "chunked"
+            "chunked, "
+            "auto"
             ")",
         ),
         pytest.param(
@@ -175,7 +187,7 @@ FORK_NAME = "fork" if sys.version_info < (3, 10) else "Configuration.fork"
         pytest.param(
             {"min_max_strategy_preference": "bad"},
             ValueError,
-            "'bad' is not a valid 'MinMaxStrategy' (one-tlu-promoted, three-tlu-casted, chunked)",
+            "'bad' is not a valid 'MinMaxStrategy' (one-tlu-promoted, three-tlu-casted, chunked, auto)",
         ),
         pytest.param(
             {"additional_pre_processors": "bad"},
@@ -147,3 +147,63 @@ def test_encrypted_execution(helpers):
         x_enc = module.inc.run(x_enc)
     x_dec = module.inc.decrypt(x_enc)
     assert x_dec == 15
+
+
+def test_run_graph(helpers):
+    """
+    Test that running a chain of functions on the server works.
+    """
+
+    @fhe.module()
+    class Module:
+        @fhe.function({"x": "encrypted"})
+        def inc(x):
+            return (x + 1) % 20
+
+        @fhe.function({"x": "encrypted", "y": "encrypted"})
+        def add_sub(x, y):
+            return (x + y) % 20, (x - y) % 20
+
+    inputset = [np.random.randint(1, 20, size=()) for _ in range(100)]
+    inputset2 = [(np.random.randint(1, 20), np.random.randint(1, 20)) for _ in range(100)]
+    configuration = helpers.configuration().fork(
+        p_error=0.1,
+        parameter_selection_strategy="v0",
+        composable=True,
+    )
+    module = Module.compile(
+        {"inc": inputset, "add_sub": inputset2},
+        configuration,
+    )
+
+    x_enc = module.inc.encrypt(5)
+    y_enc = module.inc.encrypt(3)
+
+    # the two first stages run in parallel
+    stages = [
+        ("inc", [0]),
+        ("inc", [1]),
+        ("add_sub", [(0, 0), (1, 0)]),
+        ("inc", [(2, 1)]),
+    ]
+
+    result_enc = module.run_graph(stages, x_enc, y_enc)
+    assert module.inc.decrypt(result_enc) == 3
+
+    x_inc_enc, result_enc = module.run_graph(stages, x_enc, y_enc, outputs=[(0, 0), (3, 0)])
+    assert module.inc.decrypt(x_inc_enc) == 6
+    assert module.inc.decrypt(result_enc) == 3
+
+    # the outputs are streamed in the order their stages finish
+    streamed = []
+    module.run_graph(
+        stages,
+        x_enc,
+        y_enc,
+        outputs=[(3, 0), (0, 0)],
+        on_output=lambda index, value: streamed.append((index, module.inc.decrypt(value))),
+    )
+    assert streamed == [(1, 6), (0, 3)]
+
+    with pytest.raises(RuntimeError, match="before they are computed"):
+        module.run_graph([("inc", [(0, 0)])], x_enc)
@@ -0,0 +1,41 @@
+"""
+Tests of `RoundingTuner` class.
+"""
+
+import numpy as np
+
+from concrete import fhe
+
+
+def test_rounding_tuner(helpers):
+    """
+    Test `tune` method of `RoundingTuner` class.
+    """
+
+    configuration = helpers.configuration()
+
+    rounder = fhe.AutoRounder()
+
+    def f(x):
+        return fhe.round_bit_pattern(x, rounder) // 2
+
+    inputset = [np.random.randint(0, 2**6) for _ in range(20)]
+
+    tuner = fhe.RoundingTuner(
+        f, {"x": "encrypted"}, [rounder], inputset, max_error=2.0, configuration=configuration
+    )
+    report = tuner.tune()
+
+    pareto = report.pareto
+    assert len(pareto) != 0
+    assert all(a.complexity <= b.complexity for a, b in zip(pareto, pareto[1:]))
+    assert all(a.error > b.error for a, b in zip(pareto, pareto[1:]))
+
+    recommended = report.recommended
+    assert recommended is not None
+    assert recommended.error <= 2.0
+    assert "<- recommended" in report.format()
+
+    report.apply()
+    assert rounder.lsbs_to_remove == recommended.lsbs_to_remove[0]
+    assert rounder.exactness == recommended.exactness[0]
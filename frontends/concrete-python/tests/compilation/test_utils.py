@@ -91,3 +91,26 @@ def test_inputset(inputs, ranges, shapes, size):
                 assert shape == value.shape
                 assert value.min() >= range_[0]
                 assert value.max() < range_[1]
+
+
+def test_sample_inputset():
+    """
+    Test `sample_inputset` keeps the boundary candidates of the inputs.
+    """
+
+    # pylint: disable=import-outside-toplevel
+    from concrete.fhe.compilation.utils import sample_inputset
+
+    # pylint: enable=import-outside-toplevel
+
+    inputset = [(np.random.randint(0, 100, size=(3,)), i) for i in range(1000)]
+    sampled = sample_inputset(inputset, 20)
+
+    assert len(sampled) == 20
+    for position in range(2):
+        values = np.array([sample[position] for sample in inputset])
+        sampled_values = np.array([sample[position] for sample in sampled])
+        assert np.array_equal(values.min(axis=0), sampled_values.min(axis=0))
+        assert np.array_equal(values.max(axis=0), sampled_values.max(axis=0))
+
+    assert sample_inputset(inputset[:10], 20) == inputset[:10]
@@ -2,6 +2,7 @@
 Tests of execution of array operation.
 """
 
+import numpy as np
 import pytest
 
 from concrete import fhe
@@ -66,6 +67,29 @@ from concrete import fhe
             },
             id="fhe.array([x, y]) + fhe.array([x, y])",
         ),
+        pytest.param(
+            lambda x: fhe.array([x[0, 0], x[0, 1], x[1, 0], x[1, 1]]),
+            {
+                "x": {"range": [0, 10], "status": "encrypted", "shape": (2, 2)},
+            },
+            id="fhe.array([x[0, 0], x[0, 1], x[1, 0], x[1, 1]])",
+        ),
+        pytest.param(
+            lambda x, y: fhe.array([[x[1], x[2], y], [x[0], y, x[3]]]),
+            {
+                "x": {"range": [0, 10], "status": "encrypted", "shape": (4,)},
+                "y": {"range": [0, 10], "status": "clear", "shape": ()},
+            },
+            id="fhe.array([[x[1], x[2], y], [x[0], y, x[3]]])",
+        ),
+        pytest.param(
+            lambda x, y: fhe.array([x[0], x[1], y[0], y[1]]),
+            {
+                "x": {"range": [0, 10], "status": "encrypted", "shape": (2,)},
+                "y": {"range": [0, 10], "status": "clear", "shape": (2,)},
+            },
+            id="fhe.array([x[0], x[1], y[0], y[1]])",
+        ),
     ],
 )
 def test_array(function, parameters, helpers):
@@ -83,3 +107,21 @@ def test_array(function, parameters, helpers):
 
     sample = helpers.generate_sample(parameters)
     helpers.check_execution(circuit, function, sample)
+
+
+def test_array_of_extracted_elements(helpers):
+    """
+    Test array of elements extracted from the same tensor is built from slices of it.
+    """
+
+    @fhe.compiler({"x": "encrypted"})
+    def function(x):
+        return fhe.array([x[0], x[1], x[2], x[3], x[0], x[1]])
+
+    inputset = [np.random.randint(0, 10, size=(4,)) for _ in range(100)]
+    circuit = function.compile(inputset, helpers.configuration())
+
+    assert "tensor.from_elements" not in circuit.mlir
+    assert "tensor.insert_slice" in circuit.mlir
+
+    helpers.check_execution(circuit, function, np.array([1, 2, 3, 4]))
@@ -62,6 +62,7 @@ cases += [
                 fhe.BitwiseStrategy.THREE_TLU_CASTED,
                 fhe.BitwiseStrategy.TWO_TLU_BIGGER_PROMOTED_SMALLER_CASTED,
                 fhe.BitwiseStrategy.TWO_TLU_BIGGER_CASTED_SMALLER_PROMOTED,
+                fhe.BitwiseStrategy.AUTO,
             ]
         ),
     )
@@ -85,6 +85,7 @@ for _ in range(35):
                     fhe.ComparisonStrategy.THREE_TLU_BIGGER_CLIPPED_SMALLER_CASTED,
                     fhe.ComparisonStrategy.TWO_TLU_BIGGER_CLIPPED_SMALLER_PROMOTED,
                     fhe.ComparisonStrategy.CHUNKED,
+                    fhe.ComparisonStrategy.AUTO,
                 ]
             ),
         ]
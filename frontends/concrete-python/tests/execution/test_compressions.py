@@ -60,3 +60,31 @@ def test_circuit_compress_evaluation_keys(helpers):
     evaluation_keys_compressed = circuit_with_compression.client.evaluation_keys
 
     assert len(evaluation_keys_compressed.serialize()) < len(evaluation_keys.serialize())
+
+
+def test_circuit_compress_output_ciphertexts(helpers):
+    """
+    Test running circuit with compressed output ciphertexts
+    """
+
+    configuration = helpers.configuration()
+
+    @fhe.compiler({"x": "encrypted", "y": "encrypted"})
+    def function(x, y):
+        return (x + y) ** 2
+
+    inputset = fhe.inputset(fhe.uint4, fhe.uint4, size=10)
+    circuit_without_compression = function.compile(
+        inputset, configuration.fork(compress_output_ciphertexts=False)
+    )
+    circuit_with_compression = function.compile(
+        inputset, configuration.fork(compress_output_ciphertexts=True)
+    )
+
+    result = circuit_without_compression.run(*circuit_without_compression.encrypt(3, 4))
+    result_compressed = circuit_with_compression.run(*circuit_with_compression.encrypt(3, 4))
+
+    assert len(result_compressed.serialize()) < len(result.serialize())
+
+    assert circuit_with_compression.decrypt(result_compressed) == 49
+    assert circuit_without_compression.decrypt(result) == 49
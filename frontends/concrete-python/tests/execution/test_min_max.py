@@ -122,6 +122,7 @@ for lhs_bit_width in range(1, 5):
             strategies += [
                 fhe.MinMaxStrategy.CHUNKED,
             ]
+        strategies.append(fhe.MinMaxStrategy.AUTO)
 
         for lhs_is_signed in [False, True]:
             for rhs_is_signed in [False, True]:
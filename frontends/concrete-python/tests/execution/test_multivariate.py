@@ -30,6 +30,13 @@ def multi(x, y, z):
     return result
 
 
+def separable(x, y, z):
+    """
+    Multivariate function that is a sum of functions of (x, y) and of z.
+    """
+    return x * y + z * z
+
+
 cases = [
     [
         ("x_if_y_else_zero", lambda x, y: fhe.multivariate(x_if_y_else_zero)(x, y)),
@@ -137,6 +144,48 @@ cases = [
         ],
         fhe.MultivariateStrategy.PROMOTED,
     ],
+    [
+        ("separable", lambda x, y, z: fhe.multivariate(separable)(x, y, z)),
+        [
+            ValueDescription(
+                Integer(is_signed=False, bit_width=3),
+                shape=(2,),
+                is_encrypted=True,
+            ),
+            ValueDescription(
+                Integer(is_signed=True, bit_width=2),
+                shape=(),
+                is_encrypted=True,
+            ),
+            ValueDescription(
+                Integer(is_signed=True, bit_width=2),
+                shape=(2,),
+                is_encrypted=True,
+            ),
+        ],
+        fhe.MultivariateStrategy.CASTED,
+    ],
+    [
+        ("separable", lambda x, y, z: fhe.multivariate(separable)(x, y, z)),
+        [
+            ValueDescription(
+                Integer(is_signed=False, bit_width=3),
+                shape=(),
+                is_encrypted=True,
+            ),
+            ValueDescription(
+                Integer(is_signed=False, bit_width=2),
+                shape=(),
+                is_encrypted=True,
+            ),
+            ValueDescription(
+                Integer(is_signed=False, bit_width=2),
+                shape=(),
+                is_encrypted=True,
+            ),
+        ],
+        fhe.MultivariateStrategy.PROMOTED,
+    ],
 ]
 
 
@@ -187,3 +236,25 @@ def test_multivariate(operation, values, strategy, helpers):
     ]
     for sample in samples:
         helpers.check_execution(circuit, function, sample, retries=5)
+
+
+def test_separable_multivariate(helpers):
+    """
+    Test multivariate extension splits a sum of functions of groups of its inputs.
+    """
+
+    @fhe.compiler({"x": "encrypted", "y": "encrypted", "z": "encrypted"})
+    def function(x, y, z):
+        return fhe.multivariate(separable)(x, y, z)
+
+    configuration = helpers.configuration().fork(
+        multivariate_strategy_preference=fhe.MultivariateStrategy.CASTED,
+    )
+    inputset = [(x, y, z) for x in range(8) for y in range(4) for z in range(4)]
+    circuit = function.compile(inputset, configuration)
+
+    # x and y are packed to 5-bits and z is looked up alone, instead of packing all to 7-bits
+    assert "eint<7>" not in circuit.mlir
+
+    for sample in [(0, 0, 0), (7, 3, 3), (5, 2, 1)]:
+        helpers.check_execution(circuit, function, list(sample), retries=5)
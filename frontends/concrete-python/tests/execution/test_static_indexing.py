@@ -208,6 +208,31 @@ from concrete import fhe
             lambda x: x[[[0, 3], [0, 3]], 0],
             id="x[[[0, 3], [0, 3]], 0] where x.shape == (5, 4)",
         ),
+        pytest.param(
+            (5, 4),
+            lambda x: np.take(x, [4, 0, -1], axis=0),
+            id="np.take(x, [4, 0, -1], axis=0) where x.shape == (5, 4)",
+        ),
+        pytest.param(
+            (5, 4),
+            lambda x: np.take(x, [[1, 3], [2, 2]], axis=1),
+            id="np.take(x, [[1, 3], [2, 2]], axis=1) where x.shape == (5, 4)",
+        ),
+        pytest.param(
+            (5, 4),
+            lambda x: np.take(x, [1, 3], axis=-1),
+            id="np.take(x, [1, 3], axis=-1) where x.shape == (5, 4)",
+        ),
+        pytest.param(
+            (5, 4),
+            lambda x: np.take(x, [7, 0, 19]),
+            id="np.take(x, [7, 0, 19]) where x.shape == (5, 4)",
+        ),
+        pytest.param(
+            (5, 4),
+            lambda x: x.take(2, axis=0),
+            id="x.take(2, axis=0) where x.shape == (5, 4)",
+        ),
     ],
 )
 def test_static_indexing(shape, function, helpers):
@@ -12,7 +12,7 @@ def test_dump_load_auto_rounder():
     Test 'dump_dict' and 'load_dict' methods of AutoRounder.
     """
 
-    rounder = fhe.AutoRounder(target_msbs=3)
+    rounder = fhe.AutoRounder(target_msbs=3, exactness=fhe.Exactness.APPROXIMATE)
     rounder.is_adjusted = True
     rounder.input_min = 10
     rounder.input_max = 20
@@ -22,6 +22,7 @@ def test_dump_load_auto_rounder():
     dumped = rounder.dump_dict()
     assert dumped == {
         "target_msbs": 3,
+        "exactness": "approximate",
         "is_adjusted": True,
         "input_min": 10,
         "input_max": 20,
@@ -32,6 +33,7 @@ def test_dump_load_auto_rounder():
     loaded = fhe.AutoRounder.load_dict(dumped)
 
     assert loaded.target_msbs == 3
+    assert loaded.exactness == fhe.Exactness.APPROXIMATE
     assert loaded.is_adjusted
     assert loaded.input_min == 10
     assert loaded.input_max == 20
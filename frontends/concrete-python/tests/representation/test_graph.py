@@ -451,3 +451,32 @@ def test_graph_processors(helpers):
     assert pre_processor1.input_bit_width == 3
     assert post_processor1.input_bit_width == 8 if configuration.single_precision else 4
     assert post_processor2.node_count == 5
+
+
+@pytest.mark.parametrize(
+    "function,inputset",
+    [
+        pytest.param(
+            f,
+            list(range(16)),
+            id="scalar",
+        ),
+        pytest.param(
+            lambda x: np.sum((x + np.array([1, 2, 3])) * 2, axis=0) - 1,
+            [np.random.randint(0, 8, size=(2, 3)) for _ in range(10)],
+            id="tensor",
+        ),
+    ],
+)
+def test_graph_evaluate_batch(function, inputset, helpers):
+    """
+    Test `evaluate_batch` method of `Graph` class.
+    """
+
+    configuration = helpers.configuration()
+    graph = fhe.Compiler(function, {"x": "encrypted"}).trace(inputset, configuration)
+
+    evaluation = graph.evaluate_batch(np.array(inputset))
+    for index, sample in enumerate(inputset):
+        for node, value in graph.evaluate(sample).items():
+            assert np.array_equal(evaluation[node][index], value)